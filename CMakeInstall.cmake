@@ -177,6 +177,9 @@ function(print_install_overview)
     MESSAGE(STATUS "Support for GigE via aravis:   " ${TCAM_BUILD_ARAVIS})
     MESSAGE(STATUS "Support for USB cameras:       " ${TCAM_BUILD_V4L2})
     MESSAGE(STATUS "Support for LibUsb cameras:    " ${TCAM_BUILD_LIBUSB})
+    MESSAGE(STATUS "OpenCL backend for tcamconvert:" ${TCAM_BUILD_OPENCL})
+    MESSAGE(STATUS "mem2mem backend for tcamconvert:" ${TCAM_BUILD_V4L2_M2M})
+    MESSAGE(STATUS "USDT tracepoints:              " ${TCAM_ENABLE_USDT})
     MESSAGE(STATUS "Build additional utilities:    " ${TCAM_BUILD_TOOLS})
     MESSAGE(STATUS "Build documentation            " ${TCAM_BUILD_DOCUMENTATION})
     MESSAGE(STATUS "Build tests                    " ${TCAM_BUILD_TESTS})
@@ -24,6 +24,10 @@ option(TCAM_BUILD_TOOLS    "Build additional utilities"           ON)
 option(TCAM_BUILD_DOCUMENTATION "Build internal code documentation"    ON)
 option(TCAM_BUILD_TESTS    "Build tests."                         OFF)
 option(TCAM_BUILD_VIRTCAM  "Build virtual camera backend" ON)
+option(TCAM_BUILD_OPENCL   "Build the OpenCL backend of tcamconvert" OFF)
+option(TCAM_BUILD_V4L2_M2M "Build the V4L2 mem2mem backend of tcamconvert" OFF)
+option(TCAM_ENABLE_USDT    "Add USDT tracepoints to the frame path when sys/sdt.h is available" ON)
+option(TCAM_LOG_STRIP_DEBUG "Remove trace and debug log messages from Release and MinSizeRel builds" ON)
 
 option(TCAM_INTERNAL_ARAVIS "Use internal aravis dependency instead of system libraries" ON)
 option(TCAM_ARAVIS_USB_VISION "Use aravis usb vision backend. Disables v4l2." ON)
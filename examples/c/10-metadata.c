@@ -90,32 +90,48 @@ static GstFlowReturn callback(GstElement* sink, void* user_data  __attribute__((
         // if you need the associated caps
         // GstCaps* c = gst_sample_get_caps(sample);
 
-        GstMeta* meta = gst_buffer_get_meta(buffer, g_type_from_name("TcamStatisticsMetaApi"));
+        // tcamsrc always attaches the fixed layout TcamStatisticsValuesMeta
+        GstMeta* values_meta =
+            gst_buffer_get_meta(buffer, g_type_from_name("TcamStatisticsValuesMetaApi"));
 
-        if (meta)
+        if (values_meta)
         {
-            printf("We have meta\n");
+            const TcamStatisticsValues* values = &((TcamStatisticsValuesMeta*)values_meta)->values;
+
+            printf("frame_count: %" G_GUINT64_FORMAT "\n", values->frame_count);
+            printf("frames_dropped: %" G_GUINT64_FORMAT "\n", values->frames_dropped);
+            printf("capture_time_ns: %" G_GUINT64_FORMAT "\n", values->capture_time_ns);
+            printf("camera_time_ns: %" G_GUINT64_FORMAT "\n", values->camera_time_ns);
+            printf("is_damaged: %s\n", values->is_damaged ? "true" : "false");
         }
         else
         {
             g_warning("No meta data available\n");
         }
 
-        GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+        // the GstStructure based TcamStatisticsMeta is only attached
+        // when tcamsrc has the property statistics-structure=true
+        // or TCAM_STATISTICS_STRUCTURE is set
+        GstMeta* meta = gst_buffer_get_meta(buffer, g_type_from_name("TcamStatisticsMetaApi"));
+
+        if (meta)
+        {
+            GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
 
-        // this prints all contained fields
-        gst_structure_foreach(struc, meta_struc_print, NULL);
+            // this prints all contained fields
+            gst_structure_foreach(struc, meta_struc_print, NULL);
 
-        // to only print selective fields
-        // read the documentation
-        // https://www.theimagingsource.com/documentation/tiscamera/tcam-gstreamer.html#metadata
-        // concerning available fields and call them manually by name
+            // to only print selective fields
+            // read the documentation
+            // https://www.theimagingsource.com/documentation/tiscamera/tcam-gstreamer.html#metadata
+            // concerning available fields and call them manually by name
 
-        /*
-          guint64 frame_count = 0;
-          gst_structure_get_uint64(struc, "frame_count", &frame_count);
-          printf("frame_count: %ul\n", frame_count);
-        */
+            /*
+              guint64 frame_count = 0;
+              gst_structure_get_uint64(struc, "frame_count", &frame_count);
+              printf("frame_count: %ul\n", frame_count);
+            */
+        }
 
         // delete our reference so that gstreamer can handle the sample
         gst_sample_unref(sample);
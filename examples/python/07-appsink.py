@@ -24,10 +24,11 @@ import sys
 import gi
 import time
 
+import tcam_numpy
+
 gi.require_version("Gst", "1.0")
-gi.require_version("GstVideo", "1.0")
 
-from gi.repository import Gst, GstVideo
+from gi.repository import Gst
 
 framecount = 0
 
@@ -47,39 +48,27 @@ def callback(appsink, user_data):
 
         gst_buffer = sample.get_buffer()
 
-        try:
-            (ret, buffer_map) = gst_buffer.map(Gst.MapFlags.READ)
-
-            video_info = GstVideo.VideoInfo()
-            video_info.from_caps(caps)
-
-            stride = video_info.finfo.bits / 8
-
-            pixel_offset = int(video_info.width / 2 * stride +
-                               video_info.width * video_info.height / 2 * stride)
+        # wraps the mapped buffer without copying it
+        # the buffer is unmapped once frame is no longer referenced
+        frame = tcam_numpy.buffer_to_ndarray(gst_buffer, caps)
 
-            # this is only one pixel
-            # when dealing with formats like BGRx
-            # pixel_data will have to consist out of
-            # pixel_offset   => B
-            # pixel_offset+1 => G
-            # pixel_offset+2 => R
-            # pixel_offset+3 => x
-            pixel_data = buffer_map.data[pixel_offset]
-            timestamp = gst_buffer.pts
+        height, width = frame.shape[0], frame.shape[1]
 
-            global framecount
+        # this is only one pixel
+        # when dealing with formats like BGRx
+        # pixel_data will consist of [B, G, R, x]
+        pixel_data = frame[height // 2, width // 2]
+        timestamp = gst_buffer.pts
 
-            output_str = "Captured frame {}, Pixel Value={} Timestamp={}".format(framecount,
-                                                                                 pixel_data,
-                                                                                 timestamp)
+        global framecount
 
-            print(output_str, end="\r")  # print with \r to rewrite line
+        output_str = "Captured frame {}, Pixel Value={} Timestamp={}".format(framecount,
+                                                                             pixel_data,
+                                                                             timestamp)
 
-            framecount += 1
+        print(output_str, end="\r")  # print with \r to rewrite line
 
-        finally:
-            gst_buffer.unmap(buffer_map)
+        framecount += 1
 
     return Gst.FlowReturn.OK
 
@@ -36,47 +36,71 @@ from gi.repository import Gst, GstVideo, GObject, GLib
 # load tiscamera GstMeta library
 clib = ctypes.CDLL("libtcamgststatistics.so")
 
-# declare input/output type for our helper function
-clib.tcam_statistics_get_structure.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
-clib.tcam_statistics_get_structure.restype = ctypes.c_bool
 
-# allocate a c-string with length 320 bytes
-# this _should_ be long enough to hold any
-# GstStructure string that will be retrieved
-# if not change this to a higher number
-meta_out_buffer_size = 320
-meta_out_buffer = ctypes.create_string_buffer(meta_out_buffer_size)
+class TcamStatisticsValues(ctypes.Structure):
+    """
+    Mirror of the c struct TcamStatisticsValues
+    """
+    _fields_ = [("frame_count", ctypes.c_uint64),
+                ("frames_dropped", ctypes.c_uint64),
+                ("capture_time_ns", ctypes.c_uint64),
+                ("camera_time_ns", ctypes.c_uint64),
+                ("is_damaged", ctypes.c_int),
+                ("dequeue_time_ns", ctypes.c_uint64),
+                ("auto_pass_begin_ns", ctypes.c_uint64),
+                ("auto_pass_end_ns", ctypes.c_uint64),
+                ("sink_push_time_ns", ctypes.c_uint64),
+                ("gst_push_time_ns", ctypes.c_uint64),
+                ("tcamconvert_begin_ns", ctypes.c_uint64),
+                ("tcamconvert_end_ns", ctypes.c_uint64),
+                ("completed_buffers", ctypes.c_uint64),
+                ("failed_buffers", ctypes.c_uint64),
+                ("underruns", ctypes.c_uint64),
+                ("resent_packets", ctypes.c_uint64),
+                ("missing_packets", ctypes.c_uint64),
+                ("timestamp_source", ctypes.c_uint32),
+                ("dropped_no_buffer", ctypes.c_uint64),
+                ("dropped_transport", ctypes.c_uint64),
+                ("dropped_incomplete", ctypes.c_uint64),
+                ("settings_id", ctypes.c_uint64),
+                ("has_roi_origin", ctypes.c_int),
+                ("roi_origin_x", ctypes.c_int32),
+                ("roi_origin_y", ctypes.c_int32)]
+
+
+# declare input/output type for our helper function
+clib.tcam_statistics_values_meta_get_values.argtypes = [ctypes.c_void_p,
+                                                        ctypes.POINTER(TcamStatisticsValues),
+                                                        ctypes.c_size_t]
+clib.tcam_statistics_values_meta_get_values.restype = ctypes.c_int
 
 
 def get_meta(gst_buffer):
     """
     Check Gst.Buffer for a valid Gst.Meta object
-    and return the contained Gst.Structure
+    and return the contained statistics
+
+    The GstStructure based TcamStatisticsMetaApi is only attached
+    when tcamsrc has statistics-structure=true.
+    This example uses the fixed layout meta that is always available.
 
     Parameters:
     Gst.Buffer
 
     Returns:
-    Gst.Structure or None in case of error
+    TcamStatisticsValues or None in case of error
     """
-    meta = gst_buffer.get_meta("TcamStatisticsMetaApi")
+    meta = gst_buffer.get_meta("TcamStatisticsValuesMetaApi")
 
     if not meta:
         return None
 
-    # fill meta_out_buffer with the result of gst_structure_get_string(meta->structure)
-    ret = clib.tcam_statistics_get_structure(hash(meta), meta_out_buffer, meta_out_buffer_size)
-
-    # ret is a bool indicating successfull string copy
+    values = TcamStatisticsValues()
+    ret = clib.tcam_statistics_values_meta_get_values(hash(meta),
+                                                      ctypes.byref(values),
+                                                      ctypes.sizeof(values))
     if ret:
-        # ret is bytecode
-        # decode it to get a valide str object
-        # ret.decode("utf-8")
-        structure_string = ctypes.string_at(meta_out_buffer).decode("utf-8")
-        struc = Gst.Structure.from_string(structure_string)
-        # Gst.Structure.from_string returns a tuple
-        # we only want the actual Gst.Structure
-        return struc[0]
+        return values
     return None
 
 
@@ -98,19 +122,8 @@ def callback(appsink, user_data):
         tcam_meta = get_meta(gst_buffer)
         if tcam_meta:
 
-            def print_structure(field_id, value, user_data):
-                """
-                """
-
-                name = GLib.quark_to_string(field_id)
-
-                print(f"{name} => {value}")
-
-                # return true as we want to continue iterating
-                return True
-
-            # call print structure for all members of the Gst.Structure
-            tcam_meta.foreach(print_structure, None)
+            for name, _ in TcamStatisticsValues._fields_:
+                print(f"{name} => {getattr(tcam_meta, name)}")
 
         else:
             print("No meta")
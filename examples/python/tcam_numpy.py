@@ -0,0 +1,297 @@
+# Copyright 2022 The Imaging Source Europe GmbH
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Helper for accessing the images of a Gst.Buffer as numpy arrays
+# without copying them.
+#
+# Gst.Buffer.map() in python returns a copy of the image data.
+# This module maps the buffer through the C api instead and wraps the
+# mapped memory. The buffer stays referenced and mapped until the last
+# array that uses the memory is freed.
+#
+# Usage:
+#
+#   import tcam_numpy
+#
+#   sample = appsink.emit("pull-sample")
+#   frame = tcam_numpy.buffer_to_ndarray(sample.get_buffer(), sample.get_caps())
+#   stats = tcam_numpy.get_statistics(sample.get_buffer())
+#
+#   # packed formats are returned as bytes, unpack() creates a uint16 copy
+#   image = tcam_numpy.unpack(frame, "GRAY12p")
+#
+
+import ctypes
+import ctypes.util
+import weakref
+
+import numpy as np
+
+_gst = ctypes.CDLL(ctypes.util.find_library("gstreamer-1.0") or "libgstreamer-1.0.so.0")
+
+
+class _GstMapInfo(ctypes.Structure):
+    """
+    Mirror of the c struct GstMapInfo
+    """
+    _fields_ = [("memory", ctypes.c_void_p),
+                ("flags", ctypes.c_int),
+                ("data", ctypes.c_void_p),
+                ("size", ctypes.c_size_t),
+                ("maxsize", ctypes.c_size_t),
+                ("user_data", ctypes.c_void_p * 4),
+                ("_gst_reserved", ctypes.c_void_p * 4)]
+
+
+_GST_MAP_READ = 1
+
+_gst.gst_buffer_map.argtypes = [ctypes.c_void_p, ctypes.POINTER(_GstMapInfo), ctypes.c_int]
+_gst.gst_buffer_map.restype = ctypes.c_int
+_gst.gst_buffer_unmap.argtypes = [ctypes.c_void_p, ctypes.POINTER(_GstMapInfo)]
+_gst.gst_buffer_unmap.restype = None
+_gst.gst_mini_object_ref.argtypes = [ctypes.c_void_p]
+_gst.gst_mini_object_ref.restype = ctypes.c_void_p
+_gst.gst_mini_object_unref.argtypes = [ctypes.c_void_p]
+_gst.gst_mini_object_unref.restype = None
+
+
+class TcamStatisticsValues(ctypes.Structure):
+    """
+    Mirror of the c struct TcamStatisticsValues
+    """
+    _fields_ = [("frame_count", ctypes.c_uint64),
+                ("frames_dropped", ctypes.c_uint64),
+                ("capture_time_ns", ctypes.c_uint64),
+                ("camera_time_ns", ctypes.c_uint64),
+                ("is_damaged", ctypes.c_int),
+                ("dequeue_time_ns", ctypes.c_uint64),
+                ("auto_pass_begin_ns", ctypes.c_uint64),
+                ("auto_pass_end_ns", ctypes.c_uint64),
+                ("sink_push_time_ns", ctypes.c_uint64),
+                ("gst_push_time_ns", ctypes.c_uint64),
+                ("tcamconvert_begin_ns", ctypes.c_uint64),
+                ("tcamconvert_end_ns", ctypes.c_uint64),
+                ("completed_buffers", ctypes.c_uint64),
+                ("failed_buffers", ctypes.c_uint64),
+                ("underruns", ctypes.c_uint64),
+                ("resent_packets", ctypes.c_uint64),
+                ("missing_packets", ctypes.c_uint64),
+                ("timestamp_source", ctypes.c_uint32),
+                ("dropped_no_buffer", ctypes.c_uint64),
+                ("dropped_transport", ctypes.c_uint64),
+                ("dropped_incomplete", ctypes.c_uint64),
+                ("settings_id", ctypes.c_uint64),
+                ("has_roi_origin", ctypes.c_int),
+                ("roi_origin_x", ctypes.c_int32),
+                ("roi_origin_y", ctypes.c_int32)]
+
+
+_stats_lib = None
+
+
+def _get_stats_lib():
+    global _stats_lib
+    if _stats_lib is None:
+        _stats_lib = ctypes.CDLL("libtcamgststatistics.so")
+        _stats_lib.tcam_statistics_values_meta_get_values.argtypes = [
+            ctypes.c_void_p,
+            ctypes.POINTER(TcamStatisticsValues),
+            ctypes.c_size_t]
+        _stats_lib.tcam_statistics_values_meta_get_values.restype = ctypes.c_int
+    return _stats_lib
+
+
+# format string of the caps => (dtype, channels, bits per pixel, packing)
+# packing is None when every pixel is one element of dtype
+_FORMATS = {}
+
+
+def _add_formats(names, dtype, channels, bits, packing=None):
+    for name in names:
+        _FORMATS[name] = (dtype, channels, bits, packing)
+
+
+_BAYER = ("rggb", "grbg", "gbrg", "bggr")
+
+_add_formats(("BGRx",), np.uint8, 4, 32)
+_add_formats(("BGR",), np.uint8, 3, 24)
+_add_formats(("RGBx64",), np.uint16, 4, 64)
+_add_formats(("YUY2", "UYVY"), np.uint8, 2, 16)
+
+_add_formats(("GRAY8", "polarized-GRAY8-v0", "polarized-bggr8-v0") + _BAYER,
+             np.uint8, 1, 8)
+_add_formats(("GRAY10", "GRAY12", "GRAY16_LE", "polarized-GRAY16-v0", "polarized-bggr16-v0",
+              "pwl-rggb12", "pwl-rggb16H12")
+             + tuple(b + "10" for b in _BAYER)
+             + tuple(b + "12" for b in _BAYER)
+             + tuple(b + "16" for b in _BAYER),
+             np.uint16, 1, 16)
+_add_formats(("GREYf",) + tuple(b + "f" for b in _BAYER), np.float32, 1, 32)
+
+_add_formats(("GRAY10sp",) + tuple(b + "10sp" for b in _BAYER), np.uint8, 1, 10, "10sp")
+_add_formats(("GRAY10m",) + tuple(b + "10m" for b in _BAYER), np.uint8, 1, 10, "10m")
+_add_formats(("GRAY12p", "polarized-GRAY12p-v0", "polarized-bggr12p-v0")
+             + tuple(b + "12p" for b in _BAYER),
+             np.uint8, 1, 12, "12p")
+_add_formats(("GRAY12sp", "polarized-GRAY12sp-v0", "polarized-bggr12sp-v0")
+             + tuple(b + "12sp" for b in _BAYER),
+             np.uint8, 1, 12, "12sp")
+_add_formats(("GRAY12m", "pwl-rggb12m") + tuple(b + "12m" for b in _BAYER),
+             np.uint8, 1, 12, "12m")
+
+
+def _release(buffer_ptr, map_info):
+    _gst.gst_buffer_unmap(buffer_ptr, ctypes.byref(map_info))
+    _gst.gst_mini_object_unref(buffer_ptr)
+
+
+def _map_buffer(gst_buffer):
+    """
+    Map gst_buffer for reading and return a ctypes array of the mapped memory.
+    The buffer is unmapped and unreferenced when the array is freed.
+    """
+    # PyGObject returns the address of the wrapped struct as hash
+    buffer_ptr = _gst.gst_mini_object_ref(hash(gst_buffer))
+
+    map_info = _GstMapInfo()
+    if not _gst.gst_buffer_map(buffer_ptr, ctypes.byref(map_info), _GST_MAP_READ):
+        _gst.gst_mini_object_unref(buffer_ptr)
+        raise RuntimeError("Unable to map buffer")
+
+    memory = (ctypes.c_uint8 * map_info.size).from_address(map_info.data)
+    weakref.finalize(memory, _release, buffer_ptr, map_info)
+    return memory
+
+
+def buffer_to_ndarray(gst_buffer, caps):
+    """
+    Wrap the image of gst_buffer as read only numpy array without copying it.
+
+    Multi channel formats have the shape (height, width, channels),
+    single channel formats (height, width).
+    Packed formats are returned as uint8 array of shape (height, line length in bytes),
+    use unpack() to get the pixel values.
+
+    The buffer stays mapped as long as the array or a view of it exists.
+
+    Parameters:
+    gst_buffer: Gst.Buffer
+    caps: Gst.Caps of the buffer
+
+    Returns:
+    numpy.ndarray
+    """
+    structure = caps.get_structure(0)
+    width = structure.get_value("width")
+    height = structure.get_value("height")
+    fmt = structure.get_value("format")
+
+    if fmt not in _FORMATS:
+        raise ValueError("Format '{}' is not supported".format(fmt))
+
+    dtype, channels, bits, packing = _FORMATS[fmt]
+
+    memory = _map_buffer(gst_buffer)
+
+    line_length = width * bits // 8
+    stride = line_length
+    # GStreamer formats like BGR may have padded lines
+    if height > 0 and len(memory) % height == 0 and len(memory) // height > stride:
+        stride = len(memory) // height
+
+    if len(memory) < stride * (height - 1) + line_length:
+        raise ValueError("Buffer is too small for {}x{} {}".format(width, height, fmt))
+
+    item_size = np.dtype(dtype).itemsize
+    if packing is None:
+        shape = (height, width, channels) if channels > 1 else (height, width)
+        strides = (stride, item_size * channels, item_size) if channels > 1 else (stride,
+                                                                                   item_size)
+    else:
+        shape = (height, line_length)
+        strides = (stride, 1)
+
+    array = np.ndarray(shape=shape, dtype=dtype, buffer=memory, strides=strides)
+    array.flags.writeable = False
+    return array
+
+
+def unpack(array, fmt):
+    """
+    Unpack the array of a packed format into uint16 pixel values.
+
+    The values keep their bit depth, GRAY12p returns values in 0..4095.
+    This allocates a new array, formats that are not packed are returned unchanged.
+
+    Parameters:
+    array: numpy.ndarray returned by buffer_to_ndarray
+    fmt: format string of the caps
+
+    Returns:
+    numpy.ndarray of shape (height, width)
+    """
+    packing = _FORMATS[fmt][3]
+    if packing is None:
+        return array
+
+    height = array.shape[0]
+
+    if packing in ("12p", "12sp", "12m"):
+        b = array.reshape(height, -1, 3).astype(np.uint16)
+        out = np.empty((height, b.shape[1], 2), dtype=np.uint16)
+        if packing == "12p":
+            out[..., 0] = (b[..., 0] << 4) | (b[..., 1] & 0x0F)
+            out[..., 1] = (b[..., 2] << 4) | (b[..., 1] >> 4)
+        elif packing == "12sp":
+            out[..., 0] = b[..., 0] | ((b[..., 1] & 0x0F) << 8)
+            out[..., 1] = (b[..., 1] >> 4) | (b[..., 2] << 4)
+        else:
+            out[..., 0] = (b[..., 0] << 4) | (b[..., 2] & 0x0F)
+            out[..., 1] = (b[..., 1] << 4) | (b[..., 2] >> 4)
+    else:
+        b = array.reshape(height, -1, 5).astype(np.uint16)
+        out = np.empty((height, b.shape[1], 4), dtype=np.uint16)
+        if packing == "10sp":
+            out[..., 0] = b[..., 0] | ((b[..., 1] & 0x03) << 8)
+            out[..., 1] = (b[..., 1] >> 2) | ((b[..., 2] & 0x0F) << 6)
+            out[..., 2] = (b[..., 2] >> 4) | ((b[..., 3] & 0x3F) << 4)
+            out[..., 3] = (b[..., 3] >> 6) | (b[..., 4] << 2)
+        else:
+            for i in range(4):
+                out[..., i] = (b[..., i] << 2) | ((b[..., 4] >> (2 * i)) & 0x03)
+
+    return out.reshape(height, -1)
+
+
+def get_statistics(gst_buffer):
+    """
+    Read the statistics tcamsrc attached to gst_buffer.
+
+    Parameters:
+    gst_buffer: Gst.Buffer
+
+    Returns:
+    TcamStatisticsValues or None when the buffer carries no statistics
+    """
+    meta = gst_buffer.get_meta("TcamStatisticsValuesMetaApi")
+    if not meta:
+        return None
+
+    values = TcamStatisticsValues()
+    if _get_stats_lib().tcam_statistics_values_meta_get_values(hash(meta),
+                                                               ctypes.byref(values),
+                                                               ctypes.sizeof(values)):
+        return values
+    return None
@@ -83,6 +83,8 @@ namespace cpu
         CPU_ARM_A7              = 0x0002,  // supported by ARM Cortex-A7 processors (raspberry pi 2 + 3) (Note: this is not AARCH32)
         CPU_ARM_A8              = 0x0004,  // supported by ARM Cortex-A8 processors, this is AARCH32
         CPU_ARM_A64             = 0x0008,  // supported by ARM Cortex-A8+ processors 64-bit OS, this also known as AARCH64
+        CPU_ARM_SVE             = 0x0010,  // scalable vector extension, only detected at runtime on AARCH64
+        CPU_ARM_SVE2            = 0x0020,  // SVE2, ARMv9 servers (Neoverse N2/V2, Graviton 4, Grace)
 
         // Each step contains the previous + a new flag
         // even though a cpu might have features, a specification of this uses the lowest denominator
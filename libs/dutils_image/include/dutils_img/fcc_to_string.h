@@ -132,6 +132,8 @@ namespace img
         case fourcc::YUV8PLANAR:	                    return "YUV8 planar";
         case fourcc::YUV16PLANAR:                    return "YUV16 planar";
         case fourcc::YUVF32PLANAR:                   return "YUV32 planar";
+        case fourcc::RGBF32PLANAR:                   return "RGB32 float planar";
+        case fourcc::RGBF16PLANAR:                   return "RGB16 float planar";
 
             // Polarization formats:
         case fourcc::POLARIZATION_MONO8_90_45_135_0:			return "Polarization Mono8 90 45 135 0";
@@ -143,6 +143,8 @@
 #define FOURCC_YUV8PLANAR	    mmioFOURCC('Y', 'U', '8', 'p')		// internal, YUV planar, Y U V planes, all 8 bit, no sub-sampling
 #define FOURCC_YUV16PLANAR	    mmioFOURCC('Y', 'U', 'G', 'p')		// internal, YUV planar, Y U V planes, 16 bit, little endian, no sub-sampling
 #define FOURCC_YUVF32PLANAR	    mmioFOURCC('Y', 'U', 'f', 'p')		// internal, YUV planar, Y U V planes, all float, no sub-sampling, float range [0.f;1.f] (may be greater for unclipped)
+#define FOURCC_RGBF32PLANAR	    mmioFOURCC('R', 'G', 'f', 'p')		// internal, RGB planar, R G B planes, all float, no sub-sampling, normalized tensor values (unbounded)
+#define FOURCC_RGBF16PLANAR	    mmioFOURCC('R', 'G', 'h', 'p')		// internal, RGB planar, R G B planes, all IEEE half float, no sub-sampling, normalized tensor values (unbounded)
 
 // Compression formats, used by GigE3L
 #define FOURCC_BY8_GR_NIBBLE_RLE_COMPRESSED     mmioFOURCC( 'C', 'B', 'Y', '0' ) // deprecated
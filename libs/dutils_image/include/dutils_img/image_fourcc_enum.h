@@ -95,6 +95,8 @@ namespace img
 		YUV8PLANAR = FOURCC_YUV8PLANAR,
 		YUV16PLANAR = FOURCC_YUV16PLANAR,
 		YUVF32PLANAR = FOURCC_YUVF32PLANAR,
+		RGBF32PLANAR = FOURCC_RGBF32PLANAR,
+		RGBF16PLANAR = FOURCC_RGBF16PLANAR,
 
 		MJPG = FOURCC_MJPG,
 
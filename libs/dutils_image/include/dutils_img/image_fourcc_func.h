@@ -138,6 +138,8 @@ namespace img
         case fourcc::YUV8PLANAR:	                    return 24;
         case fourcc::YUV16PLANAR:                    return 48;
         case fourcc::YUVF32PLANAR:                   return 96;
+        case fourcc::RGBF32PLANAR:                   return 96;
+        case fourcc::RGBF16PLANAR:                   return 48;
 
         case fourcc::MJPG:                           return 24;
 
@@ -416,6 +418,8 @@ namespace img
         case img::fourcc::YUV8PLANAR:	                    return 3;
         case img::fourcc::YUV16PLANAR:                    return 3;
         case img::fourcc::YUVF32PLANAR:                   return 3;
+        case img::fourcc::RGBF32PLANAR:                   return 3;
+        case img::fourcc::RGBF16PLANAR:                   return 3;
         case img::fourcc::POLARIZATION_ADI_PLANAR_MONO8:  return 4;
         case img::fourcc::POLARIZATION_ADI_PLANAR_MONO16: return 4;
         case img::fourcc::YV12:   return 3;
@@ -447,6 +451,8 @@ namespace img
             case fourcc::YUV8PLANAR:    return planar_info{ 3, { { img::fourcc::MONO8, 8 },       { img::fourcc::RAW8, 8 },     { img::fourcc::RAW8, 8 } } };
             case fourcc::YUV16PLANAR:   return planar_info{ 3, { { img::fourcc::MONO16, 16 },     { img::fourcc::RAW16, 16 },   { img::fourcc::RAW16, 16 } } };
             case fourcc::YUVF32PLANAR:  return planar_info{ 3, { { img::fourcc::MONOFloat, 32 },  { img::fourcc::RAW32, 32 },   { img::fourcc::RAW32, 32 } } };
+            case fourcc::RGBF32PLANAR:  return planar_info{ 3, { { img::fourcc::RAW32, 32 },      { img::fourcc::RAW32, 32 },   { img::fourcc::RAW32, 32 } } };
+            case fourcc::RGBF16PLANAR:  return planar_info{ 3, { { img::fourcc::RAW16, 16 },      { img::fourcc::RAW16, 16 },   { img::fourcc::RAW16, 16 } } };
 
             case fourcc::NV12:          return planar_info{ 2, { { img::fourcc::MONO8, 8 },       { img::fourcc::RAW16, 16, 0.5f, 0.5f } } };
             case fourcc::YV12:          return planar_info{ 3, { { img::fourcc::MONO8, 8 },       { img::fourcc::RAW8, 8, 0.5f, 0.5f },     { img::fourcc::RAW8, 8, 0.5f, 0.5f } } };
@@ -491,6 +497,8 @@ namespace img
         case img::fourcc::YUV8PLANAR:	    return dim_x * 1;
         case img::fourcc::YUV16PLANAR:    return dim_x * 2;
         case img::fourcc::YUVF32PLANAR:   return dim_x * 4;
+        case img::fourcc::RGBF32PLANAR:   return dim_x * 4;
+        case img::fourcc::RGBF16PLANAR:   return dim_x * 2;
 
         case img::fourcc::POLARIZATION_ADI_PLANAR_MONO8:  return dim_x * 1;
         case img::fourcc::POLARIZATION_ADI_PLANAR_MONO16: return dim_x * 2;
@@ -89,6 +89,7 @@ namespace auto_alg
             int         focus_range_min = 0;        // minimum focus range as provided by the device/user
             int         focus_range_max = 0;        // maximum  ^^
             int         focus_device_speed = 500;   // Legacy and GigECam = 500 (will most likely never change ...)
+            int         focus_min_wait_time = 300;  // Minimum time in ms to wait after each focus change, devices with fast lenses (e.g. liquid lenses) can lower this
             int         auto_step_divisor = 4;      // Legacy cam = 4, GigECam this is read from  IInteger 'FocusAutoStepDivisor' otherwise 4
             bool        suggest_sweep = false;      // Legacy cam = false, GigECam this is read from IInteger 'FocusAutoSweepHint' otherwise false
         } run_cmd_params;
@@ -62,6 +62,8 @@ namespace auto_alg
         bool					enable_highlight_reduction = false; // only used, when exposure/gain/iris is enabled
 
         hdr_gain_selection      hdr_gain{};   // only used when pwl is the input format
+
+        bool                    image_statistics_histogram = false; // fill image_statistics::histogram for bayer 8-bit, costs a dense brightness pass when the auto functions did not make one
     };
 
     struct wb_results
@@ -73,6 +75,28 @@ namespace auto_alg
         int		temperature = 0;
     };
 
+    /*
+     * What the auto functions sampled of the image, for consumers that check the image quality.
+     * Filled by runs that sample the image, i.e. when an auto function is enabled, other runs leave valid false.
+     * The values are taken after the software color matrix and, when the brightness was calculated, the software whitebalance.
+     */
+    struct image_statistics
+    {
+        bool        valid = false;
+
+        float       brightness = 0.f;           // mean luminance of the samples, [0;1]
+        float       saturated_fraction = 0.f;   // fraction of the samples with a luminance >= 240 / 255
+
+        float       mean_r = 0.f;               // mean channel values of the samples [0;1], mono images set all three to brightness
+        float       mean_g = 0.f;
+        float       mean_b = 0.f;
+        uint32_t    sample_count = 0;           // 0 for mono images, their samples are not kept
+
+        // luminance histogram of the dense brightness sampling, histogram_count == 0 when there is none
+        uint32_t    histogram[256];
+        uint32_t    histogram_count = 0;
+    };
+
     struct auto_pass_results
     {
         bool    exposure_changed = false;
@@ -92,6 +116,8 @@ namespace auto_alg
         float   hdr_gain_selection_value = 0.f;
 
         float   image_brightness = 0;
+
+        image_statistics    statistics;
     };
 
     struct timing_params
@@ -99,6 +125,18 @@ namespace auto_alg
         uint32_t     min_frame_count_between_runs = 2;          // The count of frames to at least wait between runs
         uint32_t     max_frame_count_between_runs = 5;          // The count of frames to at max wait between runs
         uint32_t     max_frame_time_between_runs_us = 100'000;  // The max time between runs (after min_frame_count)
+
+        // After a run that changed a value, the next one is done after min_frame_count_between_runs.
+        // After settled_run_count runs without a change the algorithms are considered settled,
+        // then the following limits replace the max limits above until a value or an auto parameter changes again.
+        uint32_t     settled_run_count = 4;
+        uint32_t     max_frame_count_between_runs_settled = 30;
+        uint32_t     max_frame_time_between_runs_settled_us = 500'000;
+
+        // The count of frames until a new exposure or gain value is visible in the image.
+        // Brightness changes that are far from the reference jump directly to the predicted exposure and gain,
+        // the brightness is not adjusted again until this many frames passed after such a jump.
+        uint32_t     exposure_pipeline_delay_frames = 2;
     };
 
     /** This is the central function which executes the auto algorithm functions on the input img_descriptor
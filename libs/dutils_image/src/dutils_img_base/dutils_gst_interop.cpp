@@ -91,6 +91,12 @@ namespace
         { img::fourcc::MJPG,                    "image/jpeg", nullptr, },
         { img::fourcc::NV12,                    g_gst_video_raw, "NV12", },
         { img::fourcc::YV12,                    g_gst_video_raw, "YV12", },
+        { img::fourcc::I420,                    g_gst_video_raw, "I420", },
+        { img::fourcc::YUV8PLANAR,              g_gst_video_raw, "Y444", },
+        { img::fourcc::YUV16PLANAR,             g_gst_video_raw, "Y444_16LE", },
+        { img::fourcc::YUVF32PLANAR,            g_gst_video_tis, "Y444f", },
+        { img::fourcc::RGBF32PLANAR,            g_gst_video_tis, "RGBPf", },
+        { img::fourcc::RGBF16PLANAR,            g_gst_video_tis, "RGBPf16", },
 
         { img::fourcc::POLARIZATION_MONO8_90_45_135_0,          g_gst_video_raw,    "polarized-GRAY8-v0", },
         { img::fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0,  g_gst_video_raw,    "polarized-GRAY12p-v0", },
@@ -4,6 +4,8 @@
 
 #include "interop_private.h"
 
+#include <cstring>
+
 namespace
 {
 //
@@ -560,6 +562,16 @@ void    write_text_line( TIter iter, const int start_x, const int dim_x, const T
 }
 
 
+// formats where every pixel owns whole bytes, a rendered line can be copied to the next one
+template<img::fourcc Tfcc>
+constexpr bool  has_pixel_aligned_lines() noexcept
+{
+    return Tfcc == img::fourcc::BGRA32 || Tfcc == img::fourcc::BGR24 || Tfcc == img::fourcc::BGRA64
+        || Tfcc == img::fourcc::MONO8 || Tfcc == img::fourcc::MONO16
+        || Tfcc == img::fourcc::RAW8 || Tfcc == img::fourcc::RAW16
+        || Tfcc == img::fourcc::MONO10 || Tfcc == img::fourcc::MONO12;
+}
+
 template<img::fourcc Tfcc>
 void	render_worker( const img::img_descriptor& data, const img::point start_pos, const int scaling, const char* text, const size_t text_len,
     rgba in_background_color, rgba in_foreground_color, const int pixel_per_line_to_write )
@@ -576,12 +588,30 @@ void	render_worker( const img::img_descriptor& data, const img::point start_pos,
         return;
     }
 
+    // The scaled copies of a font row are identical. With opaque colors nothing of the image shines through,
+    // so the row is rasterized once and the copies are plain memcpy's of the first line.
+    bool copy_scaled_rows = false;
+    size_t line_bytes = 0;
+    if constexpr( has_pixel_aligned_lines<Tfcc>() )
+    {
+        copy_scaled_rows = scaling > 1 && !is_transparent( foreground_color ) && !is_transparent( background_color );
+        line_bytes = (size_t)pixel_per_line_to_write * sizeof( *make_line_iter<Tfcc>( data, 0 ) );
+    }
+
     for( int row = 0; row < 8; row++ )  // this loops over the 8 rows a text lines contains
     {
+        const int first_y = cursor_y;
         for( int scalerY = 0; scalerY < scaling; ++scalerY )    // this loops over the scaling factor
         {
-            // write the text line
-            write_text_line( make_line_iter<Tfcc>( data, cursor_y ), start_pos.x, data.dim.cx, foreground_color, background_color, text, text_len, row, scaling );
+            if( scalerY == 0 || !copy_scaled_rows )
+            {
+                // write the text line
+                write_text_line( make_line_iter<Tfcc>( data, cursor_y ), start_pos.x, data.dim.cx, foreground_color, background_color, text, text_len, row, scaling );
+            }
+            else
+            {
+                memcpy( make_line_iter<Tfcc>( data, cursor_y ) + start_pos.x, make_line_iter<Tfcc>( data, first_y ) + start_pos.x, line_bytes );
+            }
 
             if( ++cursor_y == data.dim.cy ) { // reached dim_y, so quit
                 return;
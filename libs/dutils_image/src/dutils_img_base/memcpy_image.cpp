@@ -9,8 +9,15 @@
 
 #include <algorithm>
 
+#include <cstdio>
 #include <cstring>
 
+#if defined DUTILS_ARCH_ARM_A64
+#include <arm_neon.h>
+#elif !defined DUTILS_ARCH_ARM
+#include <emmintrin.h>      // sse2 is part of x86_64, so this needs no runtime check
+#endif
+
 namespace
 {
 
@@ -19,6 +26,58 @@ static FORCEINLINE void     internal_memcpy( void* dst, void* src, int bytes ) n
     memcpy( dst, src, (size_t) bytes );
 }
 
+// Copies with non-temporal stores. stream_fence() must be called before the data is handed to another thread.
+static void     internal_memcpy_stream( void* dst, void* src, int bytes ) noexcept
+{
+#if defined DUTILS_ARCH_ARM_A64 || !defined DUTILS_ARCH_ARM
+    auto* dst_ptr = static_cast<uint8_t*>( dst );
+    auto* src_ptr = static_cast<const uint8_t*>( src );
+    auto len = static_cast<size_t>( bytes );
+
+    // streaming stores write whole cache lines when dst is aligned
+    const auto head = std::min( len, static_cast<size_t>( static_cast<uint8_t*>( simd::adjust_pointer_to_nxt_align<16>( dst_ptr ) ) - dst_ptr ) );
+    memcpy( dst_ptr, src_ptr, head );
+    dst_ptr += head;
+    src_ptr += head;
+    len -= head;
+
+    for( ; len >= 64; len -= 64, dst_ptr += 64, src_ptr += 64 )
+    {
+#if defined DUTILS_ARCH_ARM_A64
+        const uint8x16_t v0 = vld1q_u8( src_ptr + 0 );
+        const uint8x16_t v1 = vld1q_u8( src_ptr + 16 );
+        const uint8x16_t v2 = vld1q_u8( src_ptr + 32 );
+        const uint8x16_t v3 = vld1q_u8( src_ptr + 48 );
+        __asm__ volatile(
+            "stnp %q1, %q2, [%0]\n\t"
+            "stnp %q3, %q4, [%0, #32]"
+            :
+            : "r"( dst_ptr ), "w"( v0 ), "w"( v1 ), "w"( v2 ), "w"( v3 )
+            : "memory" );
+#else
+        const __m128i v0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_ptr + 0 ) );
+        const __m128i v1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_ptr + 16 ) );
+        const __m128i v2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_ptr + 32 ) );
+        const __m128i v3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_ptr + 48 ) );
+        _mm_stream_si128( reinterpret_cast<__m128i*>( dst_ptr + 0 ), v0 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>( dst_ptr + 16 ), v1 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>( dst_ptr + 32 ), v2 );
+        _mm_stream_si128( reinterpret_cast<__m128i*>( dst_ptr + 48 ), v3 );
+#endif
+    }
+    memcpy( dst_ptr, src_ptr, len );
+#else
+    memcpy( dst, src, (size_t) bytes );
+#endif
+}
+
+static FORCEINLINE void     stream_fence() noexcept
+{
+#if !defined DUTILS_ARCH_ARM
+    _mm_sfence();
+#endif
+}
+
 inline void	flip_image_params( uint8_t*& ptr, int& pitch, int dim_y ) noexcept
 {
     ptr = (ptr + pitch * (dim_y - 1));
@@ -44,16 +103,37 @@ static bool     is_linear_memcpy_able( const img::img_descriptor& dst, const img
     return bytes_per_line == src.pitch();
 }
 
+using copy_func = void (*)( void* dst, void* src, int bytes ) noexcept;
+
+template<copy_func TCopy = internal_memcpy>
 static void copy_image_lines( uint8_t* dst_ptr, int dst_pitch, uint8_t* src_ptr, int src_pitch, int bytes_per_line, int dim_y ) noexcept
 {
     for( int y = 0; y < dim_y; ++y )
     {
-        internal_memcpy( dst_ptr + dst_pitch * y, src_ptr + src_pitch * y, bytes_per_line );
+        TCopy( dst_ptr + dst_pitch * y, src_ptr + src_pitch * y, bytes_per_line );
     }
 }
+
+template<copy_func TCopy>
+static void    copy_plane( img::img_plane dst, img::img_plane src, int dim_y, int bytes_per_line ) noexcept
+{
+    assert( bytes_per_line >= 0 );
+    if( dim_y < 0 ) {
+        dim_y = -dim_y;
+        dst = flip_image_params( dst, dim_y );
+    }
+
+    if( dst.pitch == src.pitch && dst.pitch == bytes_per_line ) {
+        TCopy( dst.plane_ptr, src.plane_ptr, dim_y * bytes_per_line );
+    }
+    else
+    {
+        copy_image_lines<TCopy>( static_cast<uint8_t*>( dst.plane_ptr ), dst.pitch, static_cast<uint8_t*>( src.plane_ptr ), src.pitch, bytes_per_line, dim_y );
+    }
 }
 
-void img::memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+template<copy_func TCopy>
+static void    copy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
 {
     if( src.type != dst.type || src.dimensions() != dst.dimensions() ) {
         return;
@@ -61,7 +141,7 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
 
     if( src.pitch() == 0 && dst.pitch() == 0 ) {
         auto min_len = std::min( src.data_length, dst.data_length );
-        internal_memcpy( dst.data(), src.data(), min_len );
+        TCopy( dst.data(), src.data(), min_len );
         return;
     }
 
@@ -71,7 +151,7 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
         for( int plane_idx = 0; plane_idx < plane_info.plane_count; ++plane_idx )
         {
             int bytes_per_line = img::planar::get_plane_pitch_minimum( src.fourcc_type(), src.dim.cx, plane_idx );
-            memcpy_image( dst.plane( plane_idx ), src.plane( plane_idx ), src.dim.cy, bytes_per_line );
+            copy_plane<TCopy>( dst.plane( plane_idx ), src.plane( plane_idx ), src.dim.cy, bytes_per_line );
         }
     }
     else
@@ -80,32 +160,77 @@ void img::memcpy_image( const img::img_descriptor& dst, const img::img_descripto
         if( is_linear_memcpy_able( dst, src, bytes_per_line ) )
         {
             auto len_to_copy = std::min( src.data_length, dst.data_length );
-            internal_memcpy( dst.data(), src.data(), len_to_copy );
+            TCopy( dst.data(), src.data(), len_to_copy );
             return;
         }
 
-        copy_image_lines( dst.data(), dst.pitch(), src.data(), src.pitch(), bytes_per_line, dst.dim.cy );
+        copy_image_lines<TCopy>( dst.data(), dst.pitch(), src.data(), src.pitch(), bytes_per_line, dst.dim.cy );
     }
 }
 
-void    img::memcpy_image( img_plane dst, img_plane src, int dim_y, int bytes_per_line ) noexcept
+#if defined __linux__
+// reads /sys/devices/system/cpu/cpu0/cache/index<index>/size, e.g. "32768K"
+static size_t  read_sysfs_cache_size( int index ) noexcept
 {
-    assert( bytes_per_line >= 0 );
-    if( dim_y < 0 ) {
-        dim_y = -dim_y;
-        dst = flip_image_params( dst, dim_y );
+    char path[64] = {};
+    snprintf( path, sizeof( path ), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index );
+
+    FILE* f = fopen( path, "r" );
+    if( f == nullptr ) {
+        return 0;
     }
 
-    if( dst.pitch == src.pitch && dst.pitch == bytes_per_line ) {
-        internal_memcpy( dst.plane_ptr, src.plane_ptr, dim_y * bytes_per_line );
+    unsigned long long value = 0;
+    char unit = 0;
+    const int cnt = fscanf( f, "%llu%c", &value, &unit );
+    fclose( f );
+    if( cnt < 1 ) {
+        return 0;
     }
-    else
-    {
-        for( int y = 0; y < dim_y; ++y )
-        {
-            internal_memcpy( static_cast<uint8_t*>( dst.plane_ptr ) + dst.pitch * y, static_cast<uint8_t*>( src.plane_ptr ) + src.pitch * y, bytes_per_line );
-        }
+    if( unit == 'K' ) {
+        value *= 1024;
+    } else if( unit == 'M' ) {
+        value *= 1024 * 1024;
     }
+    return static_cast<size_t>( value );
+}
+#endif
+
+static size_t  query_last_level_cache_size() noexcept
+{
+    size_t max_size = 0;
+#if defined __linux__
+    for( int index = 0; index < 8; ++index ) {
+        max_size = std::max( max_size, read_sysfs_cache_size( index ) );
+    }
+#endif
+    if( max_size == 0 ) {
+        max_size = 8 * 1024 * 1024;
+    }
+    return max_size;
+}
+}
+
+void img::memcpy_image( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+{
+    copy_image<internal_memcpy>( dst, src );
+}
+
+void img::memcpy_image_streaming( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept
+{
+    copy_image<internal_memcpy_stream>( dst, src );
+    stream_fence();
+}
+
+size_t  img::get_last_level_cache_size() noexcept
+{
+    static const size_t cache_size = query_last_level_cache_size();
+    return cache_size;
+}
+
+void    img::memcpy_image( img_plane dst, img_plane src, int dim_y, int bytes_per_line ) noexcept
+{
+    copy_plane<internal_memcpy>( dst, src, dim_y, bytes_per_line );
 }
 
 void img::memcpy_image( void* dst_ptr, int dst_pitch, void* src_ptr, int src_pitch, int bytes_per_line, int dim_y, bool bFlip ) noexcept
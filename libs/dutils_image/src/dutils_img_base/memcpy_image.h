@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <dutils_img/image_transform_base.h>
 
@@ -15,6 +16,15 @@ namespace img
     void	memcpy_image( img::img_plane dst, img::img_plane src, int dim_y, int byter_per_line ) noexcept;
     void	memcpy_image( void* dst_ptr, int dst_pitch, void* src_ptr, int src_pitch, int bytes_per_line, int dim_y, bool bFlip ) noexcept;
 
+    /* Same as memcpy_image( dst, src ), but writes dst with non-temporal stores, so the copy does not evict the cache.
+     * Use this for frames larger than the last level cache, which are not read again by the copying thread.
+     * Falls back to memcpy on platforms without streaming stores.
+     */
+    void	memcpy_image_streaming( const img::img_descriptor& dst, const img::img_descriptor& src ) noexcept;
+
+    // Size of the largest cpu cache in bytes, a conservative guess when the platform does not report it.
+    size_t  get_last_level_cache_size() noexcept;
+
     void    fill_image( const img::img_descriptor& data, uint8_t byte_value ) noexcept;
 }
 
@@ -0,0 +1,932 @@
+
+/*
+ * Micro benchmark for the dutils_img_filter kernels.
+ *
+ * Every variant the cpu supports is run on the same random input as the c variant of its kernel group
+ * and compared to it. Integer outputs must be byte exact, float outputs are compared with a tolerance
+ * because the library is built with -ffast-math. Half float outputs may differ by one rounding step for the same reason.
+ *
+ * The results are written as json to stdout, the exit code is 1 when a variant did not match the c variant.
+ *
+ *  dutils_img_bench [--filter <substring>] [--size <width>x<height>]... [--min-time <ms>]
+ *
+ * Sizes that do not consist of whole pixel groups of a format pair, e.g. widths that are not a multiple of 4
+ * for 10-bit packed formats, are skipped for that pair.
+ */
+
+#include "../dutils_img_filter/by_edge/by_edge.h"
+#include "../dutils_img_filter/codec/lossless/lossless_codec.h"
+#include "../dutils_img_filter/filter/whitebalance/wb_apply.h"
+#include "../dutils_img_filter/transform/bayer_binning/transform_bayer_binning.h"
+#include "../dutils_img_filter/transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
+#include "../dutils_img_filter/transform/fcc1x_packed/transform_fcc1x_to_fcc8.h"
+#include "../dutils_img_filter/transform/fcc8_fcc16/transform_fcc8_fcc16.h"
+#include "../dutils_img_filter/transform/fcc8_fcc16/transform_fccXX_to_fcc8_lut.h"
+#include "../dutils_img_filter/transform/fcc8_fcc16/transform_fccXX_to_fccfloat.h"
+#include "../dutils_img_filter/transform/mono_to_bgr/transform_mono_to_bgr.h"
+#include "../dutils_img_filter/transform/polarization/transform_polarization.h"
+#include "../dutils_img_filter/transform/pwl/transform_pwl_functions.h"
+#include "../dutils_img_filter/transform/tensor/transform_tensor.h"
+
+#include <dutils_img/fcc_to_string.h>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if !defined DUTILS_ARCH_ARM
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+    using namespace img_filter;
+
+    using kernel_func = std::function<void( const img::img_descriptor& dst, const img::img_descriptor& src )>;
+    using kernel_getter = std::function<kernel_func( const img::img_type& dst, const img::img_type& src )>;
+
+    struct kernel_variant
+    {
+        const char*     name;
+        unsigned int    required_features;
+        kernel_getter   get;
+    };
+
+    struct format_pair
+    {
+        img::fourcc     src;
+        img::fourcc     dst;
+    };
+
+    struct kernel_group
+    {
+        const char*                     name;
+        bool                            in_place;       // the kernel only uses dst, which is filled from src before verification
+        std::vector<format_pair>        formats;
+        std::vector<kernel_variant>     variants;       // the first entry is the c reference
+
+        int                             int_tolerance = 0;  // allowed difference of integer outputs to the c reference
+        int                             dst_divisor = 1;    // dst dimensions are the src dimensions divided by this
+    };
+
+    const whitebalance_params bench_wb_params = { true, 1.5f, 1.f, 2.25f, 1.f };
+
+    kernel_getter   wrap( transform_function_type( *getter )( const img::img_type&, const img::img_type& ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            return [func]( const img::img_descriptor& d, const img::img_descriptor& s ) { func( d, s ); };
+        };
+    }
+
+    kernel_getter   wrap( transform_function_param_type( *getter )( const img::img_type&, const img::img_type& ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            return [func]( const img::img_descriptor& d, const img::img_descriptor& s ) {
+                filter_params params = { bench_wb_params };
+                func( d, s, params );
+            };
+        };
+    }
+
+    // the tables are shared by all variants, so they only differ in the lookups
+    kernel_getter   wrap_tone_curve( transform_function_param_type( *getter )( const img::img_type&, const img::img_type& ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            static const auto lut_data = []
+            {
+                fcc8_tone_curve_params curve;
+                curve.gamma = 2.2f;
+                curve.contrast = 0.25f;
+                curve.tonemapping.enable = true;
+                curve.tonemapping.intensity = 2.f;
+
+                auto data = std::make_shared<fccXX_to_fcc8_lut_data>();
+                transform::update_fccXX_to_fcc8_lut_data( *data, curve, bench_wb_params );
+                return data;
+            }();
+            return [func]( const img::img_descriptor& d, const img::img_descriptor& s ) {
+                filter_params params = { bench_wb_params, nullptr, lut_data.get() };
+                func( d, s, params );
+            };
+        };
+    }
+
+    kernel_getter   wrap( transform::by_edge::function_type( *getter )( img::img_type, img::img_type ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            return [func]( const img::img_descriptor& d, const img::img_descriptor& s ) {
+                const transform::by_edge::options opt = { {}, false, false };
+                func( d, s, opt );
+            };
+        };
+    }
+
+    // debayers with the c kernel, so the variants only differ in the yuv conversion
+    kernel_getter   wrap( transform::by_edge::yuv_function_type( *getter )( img::img_type, img::img_type ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            transform::by_edge::yuv_options opt;
+            opt.colorimetry.matrix = transform::by_edge::yuv_colorimetry::matrix_type::bt709;
+            if( img::is_byfloat_fcc( src.fourcc_type() ) ) {
+                opt.byfloat_to_bgrfloat = transform::by_edge::get_transform_byfloat_to_bgrfloat_c( img::make_img_type( img::fourcc::BGRFloat, dst.dim ), src );
+            } else {
+                opt.by8_to_bgra = transform::by_edge::get_transform_by8_to_dst_c( img::make_img_type( img::fourcc::BGRA32, dst.dim ), src );
+            }
+            return [func, opt]( const img::img_descriptor& d, const img::img_descriptor& s ) { func( d, s, opt ); };
+        };
+    }
+
+    // debayers with the c kernel and normalizes with the common ImageNet values
+    kernel_getter   wrap( transform::tensor::function_type( *getter )( img::img_type, img::img_type ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            auto func = getter( dst, src );
+            if( !func ) {
+                return nullptr;
+            }
+            transform::tensor::options opt;
+            opt.norm = { { 0.485f, 0.456f, 0.406f }, { 0.229f, 0.224f, 0.225f } };
+            if( dst.dim == src.dim ) {
+                opt.byfloat_to_bgrfloat = transform::by_edge::get_transform_byfloat_to_bgrfloat_c( img::make_img_type( img::fourcc::BGRFloat, dst.dim ), src );
+            }
+            return [func, opt]( const img::img_descriptor& d, const img::img_descriptor& s ) { func( d, s, opt ); };
+        };
+    }
+
+    kernel_getter   wrap( whitebalance::func_type( *getter )( img::img_type ) )
+    {
+        return [getter]( const img::img_type& dst, const img::img_type& /*src*/ ) -> kernel_func
+        {
+            auto func = getter( dst );
+            if( !func ) {
+                return nullptr;
+            }
+            return [func]( const img::img_descriptor& d, const img::img_descriptor& /*s*/ ) { func( d, bench_wb_params ); };
+        };
+    }
+
+    // the reference of the codec round trips, so the verification checks that nothing is lost
+    kernel_func     copy_image( const img::img_type& dst, const img::img_type& src )
+    {
+        if( dst != src ) {
+            return nullptr;
+        }
+        return []( const img::img_descriptor& d, const img::img_descriptor& s ) {
+            for( int y = 0; y < s.dim.cy; ++y ) {
+                memcpy( img::get_line_start( d, y ), img::get_line_start( s, y ), img::calc_minimum_pitch( s.to_img_type() ) );
+            }
+        };
+    }
+
+    // encodes src into a buffer and decodes it into dst
+    kernel_getter   wrap( codec::lossless::encode_function_type( *get_encode )( const img::img_type& ), codec::lossless::decode_function_type( *get_decode )( const img::img_type& ) )
+    {
+        return [get_encode, get_decode]( const img::img_type& dst, const img::img_type& src ) -> kernel_func
+        {
+            if( dst != src ) {
+                return nullptr;
+            }
+            auto encode = get_encode( src );
+            auto decode = get_decode( dst );
+            if( !encode || !decode ) {
+                return nullptr;
+            }
+            auto buffer = std::make_shared<std::vector<uint8_t>>( codec::lossless::calc_max_encoded_size( src ) );
+            return [encode, decode, buffer]( const img::img_descriptor& d, const img::img_descriptor& s ) {
+                const size_t size = encode( s, buffer->data(), buffer->size() );
+                if( size == 0 || !decode( d, buffer->data(), size ) ) {
+                    std::fill( d.data(), d.data() + d.size(), uint8_t{ 0 } );
+                }
+            };
+        };
+    }
+
+#if defined DUTILS_ARCH_ARM
+    constexpr unsigned int neon_features = img::cpu::CPU_ARM_A7;
+    constexpr unsigned int sve2_features = img::cpu::CPU_ARM_SVE2;
+#else
+    constexpr unsigned int avx512bw_features = img::cpu::CPU_AVX512_F | img::cpu::CPU_AVX512_BW;
+    constexpr unsigned int avx512vbmi_features = avx512bw_features | img::cpu::CPU_AVX512_VBMI;
+#endif
+
+    using namespace img_filter::transform;
+    using img::fourcc;
+
+    std::vector<kernel_group>   make_kernel_groups()
+    {
+        const std::vector<format_pair> packed_to_fcc8 = {
+            { fourcc::RGGB10_SPACKED, fourcc::RGGB8 },
+            { fourcc::RGGB10_MIPI_PACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_PACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_SPACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGB8 },
+            { fourcc::MONO12_MIPI_PACKED, fourcc::MONO8 },
+            { fourcc::RGGB12, fourcc::RGGB8 },
+        };
+        const std::vector<format_pair> packed_to_fcc16 = {
+            { fourcc::RGGB10_SPACKED, fourcc::RGGB16 },
+            { fourcc::RGGB10_MIPI_PACKED, fourcc::RGGB16 },
+            { fourcc::RGGB12_PACKED, fourcc::RGGB16 },
+            { fourcc::RGGB12_SPACKED, fourcc::RGGB16 },
+            { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGB16 },
+            { fourcc::MONO12_MIPI_PACKED, fourcc::MONO16 },
+            { fourcc::RGGB12, fourcc::RGGB16 },
+        };
+        const std::vector<format_pair> fcc1x_to_fcc8_wb = {
+            { fourcc::RGGB10_SPACKED, fourcc::RGGB8 },
+            { fourcc::RGGB10_MIPI_PACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_PACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_SPACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGB8 },
+            { fourcc::RGGB12, fourcc::RGGB8 },
+            { fourcc::RGGB16, fourcc::RGGB8 },
+        };
+        const std::vector<format_pair> pwl_to_float = {
+            { fourcc::PWL_RG12_MIPI, fourcc::RGGBFloat },
+            { fourcc::PWL_RG12, fourcc::RGGBFloat },
+            { fourcc::PWL_RG16H12, fourcc::RGGBFloat },
+        };
+        const std::vector<format_pair> pwl_to_fcc8 = {
+            { fourcc::PWL_RG12_MIPI, fourcc::RGGB8 },
+            { fourcc::PWL_RG12, fourcc::RGGB8 },
+            { fourcc::PWL_RG16H12, fourcc::RGGB8 },
+        };
+
+        const std::vector<format_pair> lossless_codec_formats = {
+            { fourcc::RGGB8, fourcc::RGGB8 },
+            { fourcc::RGGB16, fourcc::RGGB16 },
+            { fourcc::RGGB12_PACKED, fourcc::RGGB12_PACKED },
+            { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGB12_MIPI_PACKED },
+            { fourcc::RGGB12_SPACKED, fourcc::RGGB12_SPACKED },
+            { fourcc::RGGB10_MIPI_PACKED, fourcc::RGGB10_MIPI_PACKED },
+            { fourcc::RGGB10_SPACKED, fourcc::RGGB10_SPACKED },
+            { fourcc::MONO12_MIPI_PACKED, fourcc::MONO12_MIPI_PACKED },
+        };
+
+        // clang-format off
+        return {
+            { "fcc1x_packed_to_fcc8", false, packed_to_fcc8, {
+                { "c", 0, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_neon_v0 ) },
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+                { "sve2", sve2_features, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_sve2 ) },
+#endif
+#else
+                { "ssse3", img::cpu::CPU_SSSE3, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_ssse3 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx2 ) },
+                { "avx512vbmi", avx512vbmi_features, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx512vbmi ) },
+#endif
+            } },
+            { "fcc1x_packed_to_fcc16", false, packed_to_fcc16, {
+                { "c", 0, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0 ) },
+#else
+                { "ssse3", img::cpu::CPU_SSSE3, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_ssse3 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_avx2 ) },
+                { "avx512vbmi", avx512vbmi_features, wrap( fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_avx512vbmi ) },
+#endif
+            } },
+            { "fcc1x_to_fcc8_wb", false, fcc1x_to_fcc8_wb, {
+                { "c", 0, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_v0 ) },
+                { "neon_sep", neon_features, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_sep ) },
+                { "fcc16_neon", neon_features, wrap( get_transform_fcc16_to_fcc8_wb_neon ) },
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+                { "sve2", sve2_features, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_sve2 ) },
+                { "fcc16_sve2", sve2_features, wrap( get_transform_fcc16_to_fcc8_wb_sve2 ) },
+#endif
+#else
+                { "ssse3", img::cpu::CPU_SSSE3, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_ssse3 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( fcc1x_packed::get_transform_fcc1x_to_fcc8_avx2 ) },
+#endif
+            } },
+            { "fcc8_to_fcc16", false, { { fourcc::RGGB8, fourcc::RGGB16 }, { fourcc::MONO8, fourcc::MONO16 } }, {
+                { "c", 0, wrap( get_transform_fcc8_to_fcc16_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( get_transform_fcc8_to_fcc16_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( get_transform_fcc8_to_fcc16_sse41 ) },
+#endif
+            } },
+            { "fcc16_to_fcc8", false, { { fourcc::RGGB16, fourcc::RGGB8 }, { fourcc::MONO16, fourcc::MONO8 } }, {
+                { "c", 0, wrap( get_transform_fcc16_to_fcc8_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( get_transform_fcc16_to_fcc8_neon ) },
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+                { "sve2", sve2_features, wrap( get_transform_fcc16_to_fcc8_sve2 ) },
+#endif
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( get_transform_fcc16_to_fcc8_sse41 ) },
+#endif
+            } },
+            { "fccXX_to_fcc8_lut", false, {
+                    { fourcc::RGGB10, fourcc::RGGB8 }, { fourcc::BGGR12, fourcc::BGGR8 }, { fourcc::GBRG16, fourcc::GBRG8 },
+                    { fourcc::MONO16, fourcc::MONO8 }, { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGB8 } }, {
+                { "c", 0, wrap_tone_curve( get_transform_fccXX_to_fcc8_lut_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap_tone_curve( get_transform_fccXX_to_fcc8_lut_avx2 ) },
+#endif
+            } },
+            { "mono_to_bgr", false, { { fourcc::MONO8, fourcc::BGRA32 }, { fourcc::MONO8, fourcc::BGR24 } }, {
+                { "c", 0, wrap( get_transform_mono_to_bgr_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( get_transform_mono_to_bgr_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( get_transform_mono_to_bgr_sse41 ) },
+#endif
+            } },
+            { "pwl_to_fccfloat", false, pwl_to_float, {
+                { "c", 0, wrap( pwl::get_transform_pwl_to_fccfloat_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( pwl::get_transform_pwl_to_fccfloat_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( pwl::get_transform_pwl_to_fccfloat_sse41 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( pwl::get_transform_pwl_to_fccfloat_avx2 ) },
+#endif
+            } },
+            { "pwl12_to_fcc8", false, pwl_to_fcc8, {
+                { "c", 0, wrap( pwl::get_transform_pwl12_to_fcc8_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( pwl::get_transform_pwl12_to_fcc8_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( pwl::get_transform_pwl12_to_fcc8_sse41 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( pwl::get_transform_pwl12_to_fcc8_avx2 ) },
+#endif
+            } },
+            // the simd variants round the averages up (pavgb/vrhadd), the c variant truncates
+            // every bayer pattern has its own line loop, so all four are measured
+            { "by8_to_dst", false, {
+                    { fourcc::RGGB8, fourcc::BGRA32 }, { fourcc::GRBG8, fourcc::BGRA32 }, { fourcc::GBRG8, fourcc::BGRA32 }, { fourcc::BGGR8, fourcc::BGRA32 },
+                    { fourcc::RGGB8, fourcc::BGR24 }, { fourcc::GRBG8, fourcc::BGR24 }, { fourcc::GBRG8, fourcc::BGR24 }, { fourcc::BGGR8, fourcc::BGR24 },
+                }, {
+                { "c", 0, wrap( by_edge::get_transform_by8_to_dst_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( by_edge::get_transform_by8_to_dst_neon ) },
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+                { "sve2", sve2_features, wrap( by_edge::get_transform_by8_to_dst_sve2 ) },
+#endif
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( by_edge::get_transform_by8_to_dst_sse41 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( by_edge::get_transform_by8_to_dst_avx2 ) },
+                { "avx512bw", avx512bw_features, wrap( by_edge::get_transform_by8_to_dst_avx512bw ) },
+#endif
+            }, 1 },
+            { "by8_to_yuv", false, { { fourcc::RGGB8, fourcc::NV12 }, { fourcc::RGGB8, fourcc::I420 }, { fourcc::RGGB8, fourcc::YUY2 } }, {
+                { "c", 0, wrap( by_edge::get_transform_by8_to_yuv_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( by_edge::get_transform_by8_to_yuv_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( by_edge::get_transform_by8_to_yuv_sse41 ) },
+#endif
+            } },
+            { "by8_binning2", false, { { fourcc::RGGB8, fourcc::RGGB8 } }, {
+                { "c", 0, wrap( bayer_binning::get_transform_by8_binning_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( bayer_binning::get_transform_by8_binning_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( bayer_binning::get_transform_by8_binning_sse41 ) },
+#endif
+            }, 0, 2 },
+            { "by8_binning4", false, { { fourcc::RGGB8, fourcc::RGGB8 } }, {
+                { "c", 0, wrap( bayer_binning::get_transform_by8_binning_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( bayer_binning::get_transform_by8_binning_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( bayer_binning::get_transform_by8_binning_sse41 ) },
+#endif
+            }, 0, 4 },
+            { "polarization", false, {
+                    { fourcc::POLARIZATION_MONO8_90_45_135_0, fourcc::POLARIZATION_ADI_MONO8 },
+                    { fourcc::POLARIZATION_MONO8_90_45_135_0, fourcc::POLARIZATION_PACKED8 },
+                    { fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0, fourcc::POLARIZATION_ADI_MONO16 },
+                    { fourcc::POLARIZATION_MONO16_90_45_135_0, fourcc::POLARIZATION_ADI_MONO16 },
+                    { fourcc::POLARIZATION_MONO16_90_45_135_0, fourcc::POLARIZATION_PACKED16 } }, {
+                { "c", 0, wrap( polarization::get_transform_polarization_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "sse41", img::cpu::CPU_SSE41, wrap( polarization::get_transform_polarization_sse41 ) },
+#endif
+            } },
+            { "byfloat_to_bgrfloat", false, { { fourcc::RGGBFloat, fourcc::BGRFloat } }, {
+                { "c", 0, wrap( by_edge::get_transform_byfloat_to_bgrfloat_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( by_edge::get_transform_byfloat_to_bgrfloat_neon ) },
+#else
+                { "avx2", img::cpu::CPU_AVX2, wrap( by_edge::get_transform_byfloat_to_bgrfloat_avx2 ) },
+#endif
+            } },
+            { "by16_to_bgra64", false, { { fourcc::RGGB16, fourcc::BGRA64 }, { fourcc::GBRG16, fourcc::BGRA64 } }, {
+                { "c", 0, wrap( by_edge::get_transform_by16_to_bgra64_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( by_edge::get_transform_by16_to_bgra64_neon ) },
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( by_edge::get_transform_by16_to_bgra64_sse41 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( by_edge::get_transform_by16_to_bgra64_avx2 ) },
+#endif
+            } },
+            { "fccXX_to_fccfloat_wb", false, { { fourcc::RGGB12, fourcc::RGGBFloat }, { fourcc::RGGB16, fourcc::RGGBFloat }, { fourcc::RGGB12_MIPI_PACKED, fourcc::RGGBFloat } }, {
+                { "c", 0, wrap( get_transform_fccXX_to_fccfloat_wb_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( get_transform_fccXX_to_fccfloat_wb_avx2 ) },
+#endif
+            } },
+            { "byfloat_to_yuv_planar", false, {
+                    { fourcc::RGGBFloat, fourcc::YUV8PLANAR },
+                    { fourcc::RGGBFloat, fourcc::YUV16PLANAR },
+                    { fourcc::RGGBFloat, fourcc::YUVF32PLANAR } }, {
+                { "c", 0, wrap( by_edge::get_transform_byfloat_to_yuv_planar_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( by_edge::get_transform_byfloat_to_yuv_planar_avx2 ) },
+#endif
+            } },
+            { "byfloat_to_tensor", false, { { fourcc::RGGBFloat, fourcc::RGBF32PLANAR }, { fourcc::RGGBFloat, fourcc::RGBF16PLANAR } }, {
+                { "c", 0, wrap( tensor::get_transform_byfloat_to_tensor_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( tensor::get_transform_byfloat_to_tensor_avx2 ) },
+#endif
+            } },
+            { "byfloat_to_tensor_binning2", false, { { fourcc::RGGBFloat, fourcc::RGBF32PLANAR }, { fourcc::RGGBFloat, fourcc::RGBF16PLANAR } }, {
+                { "c", 0, wrap( tensor::get_transform_byfloat_to_tensor_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( tensor::get_transform_byfloat_to_tensor_avx2 ) },
+#endif
+            }, 0, 2 },
+            { "byfloat_to_tensor_binning4", false, { { fourcc::RGGBFloat, fourcc::RGBF32PLANAR }, { fourcc::RGGBFloat, fourcc::RGBF16PLANAR } }, {
+                { "c", 0, wrap( tensor::get_transform_byfloat_to_tensor_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( tensor::get_transform_byfloat_to_tensor_avx2 ) },
+#endif
+            }, 0, 4 },
+            { "wb", true, { { fourcc::RGGB8, fourcc::RGGB8 }, { fourcc::RGGB16, fourcc::RGGB16 }, { fourcc::RGGBFloat, fourcc::RGGBFloat } }, {
+                { "c", 0, wrap( whitebalance::get_apply_img_c ) },
+#if defined DUTILS_ARCH_ARM
+                { "neon", neon_features, wrap( whitebalance::get_apply_img_neon ) },
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+                { "sve2", sve2_features, wrap( whitebalance::get_apply_img_sve2 ) },
+#endif
+#else
+                { "sse41", img::cpu::CPU_SSE41, wrap( whitebalance::get_apply_img_sse41 ) },
+                { "avx2", img::cpu::CPU_AVX2, wrap( whitebalance::get_apply_img_avx2 ) },
+#endif
+            } },
+            // random input is not compressible, so this measures the worst case
+            { "lossless_codec_roundtrip", false, lossless_codec_formats, {
+                { "copy", 0, copy_image },
+                { "c", 0, wrap( codec::lossless::get_encode_c, codec::lossless::get_decode_c ) },
+#if !defined DUTILS_ARCH_ARM
+                { "avx2", img::cpu::CPU_AVX2, wrap( codec::lossless::get_encode_avx2, codec::lossless::get_decode_avx2 ) },
+#endif
+            } },
+        };
+        // clang-format on
+    }
+
+    bool    is_float_fcc( img::fourcc fcc ) noexcept
+    {
+        return img::is_byfloat_fcc( fcc ) || fcc == fourcc::BGRFloat || fcc == fourcc::MONOFloat || fcc == fourcc::YUVF32PLANAR
+            || fcc == fourcc::RGBF32PLANAR;
+    }
+
+    // the kernels only process whole pixel groups, e.g. the 4 pixels in 5 bytes of 10-bit packed formats or the 2x2 bayer cells
+    img::dim    get_pixel_group( img::fourcc fcc ) noexcept
+    {
+        img::dim group = { 1, 1 };
+        if( img::is_bayer_fcc( fcc ) || img::is_pwl_fcc( fcc ) || img::is_polarization_cam_format( fcc ) || fcc == fourcc::NV12
+            || fcc == fourcc::I420 ) {
+            group = { 2, 2 };
+        } else if( fcc == fourcc::MONO12_PACKED || fcc == fourcc::MONO12_SPACKED || fcc == fourcc::MONO12_MIPI_PACKED
+            || fcc == fourcc::YUY2 ) {
+            group = { 2, 1 };
+        }
+        if( img::is_by10_packed_fcc( fcc ) || fcc == fourcc::MONO10_SPACKED || fcc == fourcc::MONO10_MIPI_PACKED ) {
+            group.cx = 4;
+        }
+        return group;
+    }
+
+    bool    is_whole_pixel_groups( img::fourcc fcc, img::dim dim ) noexcept
+    {
+        const auto group = get_pixel_group( fcc );
+        return dim.cx % group.cx == 0 && dim.cy % group.cy == 0;
+    }
+
+    struct image_buffer
+    {
+        img::img_type           type;
+        std::vector<uint8_t>    data;
+
+        explicit image_buffer( const img::img_type& t ) : type( t ), data( static_cast<size_t>( t.buffer_length ) ) {}
+
+        img::img_descriptor     desc() noexcept {
+            return img::make_img_desc_from_linear_memory( type, data.data() );
+        }
+    };
+
+    // random input, the unused bits of 16-bit containers are cleared, so all variants see valid data
+    void    fill_random( image_buffer& buf, std::mt19937& rng )
+    {
+        const auto fcc = buf.type.fourcc_type();
+        if( is_float_fcc( fcc ) )
+        {
+            std::uniform_real_distribution<float> dist( 0.f, 1.f );
+            auto* ptr = reinterpret_cast<float*>( buf.data.data() );
+            std::generate( ptr, ptr + buf.data.size() / sizeof( float ), [&] { return dist( rng ); } );
+            return;
+        }
+
+        std::uniform_int_distribution<int> dist( 0, 0xFF );
+        std::generate( buf.data.begin(), buf.data.end(), [&] { return static_cast<uint8_t>( dist( rng ) ); } );
+
+        uint16_t mask = 0xFFFF;
+        if( img::is_by10_fcc( fcc ) || fcc == fourcc::MONO10 ) {
+            mask = 0x03FF;
+        } else if( img::is_by12_fcc( fcc ) || fcc == fourcc::MONO12 || fcc == fourcc::PWL_RG12 ) {
+            mask = 0x0FFF;
+        }
+        if( mask != 0xFFFF )
+        {
+            auto* ptr = reinterpret_cast<uint16_t*>( buf.data.data() );
+            std::for_each( ptr, ptr + buf.data.size() / sizeof( uint16_t ), [mask]( uint16_t& v ) { v &= mask; } );
+        }
+    }
+
+    struct compare_result
+    {
+        bool    equal = true;
+        double  max_diff = 0;
+    };
+
+    // IEEE half, infinity and NaN are returned as 65536.f
+    float   half_to_float( uint16_t h ) noexcept
+    {
+        const int exponent = (h >> 10) & 0x1F;
+        const int mantissa = h & 0x3FF;
+
+        float v = 65536.f;
+        if( exponent == 0 ) {
+            v = std::ldexp( static_cast<float>( mantissa ), -24 );
+        } else if( exponent < 31 ) {
+            v = std::ldexp( static_cast<float>( mantissa | 0x400 ), exponent - 25 );
+        }
+        return (h & 0x8000) ? -v : v;
+    }
+
+    compare_result  compare_to_reference( const image_buffer& ref, const image_buffer& res, int int_tolerance )
+    {
+        compare_result rval;
+        if( res.type.fourcc_type() == fourcc::RGBF16PLANAR )
+        {
+            // a float sum that rounded differently can move the half value by one step, which is 2^-10 of the value
+            const auto* a = reinterpret_cast<const uint16_t*>( ref.data.data() );
+            const auto* b = reinterpret_cast<const uint16_t*>( res.data.data() );
+            for( size_t i = 0; i < ref.data.size() / sizeof( uint16_t ); ++i )
+            {
+                if( a[i] == b[i] ) {
+                    continue;
+                }
+                const float fa = half_to_float( a[i] );
+                const float fb = half_to_float( b[i] );
+                const float diff = std::fabs( fa - fb );
+                rval.max_diff = std::max( rval.max_diff, static_cast<double>( diff ) );
+                if( diff > std::max( 1e-4f, std::max( std::fabs( fa ), std::fabs( fb ) ) / 1024.f ) ) {
+                    rval.equal = false;
+                }
+            }
+            return rval;
+        }
+        if( is_float_fcc( res.type.fourcc_type() ) )
+        {
+            const auto* a = reinterpret_cast<const float*>( ref.data.data() );
+            const auto* b = reinterpret_cast<const float*>( res.data.data() );
+            for( size_t i = 0; i < ref.data.size() / sizeof( float ); ++i ) {
+                rval.max_diff = std::max( rval.max_diff, static_cast<double>( std::fabs( a[i] - b[i] ) ) );
+            }
+            rval.equal = rval.max_diff <= 1e-4;
+            return rval;
+        }
+        for( size_t i = 0; i < ref.data.size(); ++i ) {
+            rval.max_diff = std::max( rval.max_diff, static_cast<double>( std::abs( ref.data[i] - res.data[i] ) ) );
+        }
+        rval.equal = rval.max_diff <= int_tolerance;
+        return rval;
+    }
+
+    /* Counts the cpu cycles of the calling thread.
+     * Uses perf events when available, on x86 it falls back to the time stamp counter, which runs at the nominal frequency.
+     */
+    class cycle_counter
+    {
+    public:
+        cycle_counter()
+        {
+#if defined __linux__
+            perf_event_attr attr = {};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof( attr );
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = static_cast<int>( syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0 ) );
+            if( fd_ >= 0 ) {
+                ioctl( fd_, PERF_EVENT_IOC_ENABLE, 0 );
+                return;
+            }
+#endif
+        }
+        ~cycle_counter()
+        {
+#if defined __linux__
+            if( fd_ >= 0 ) {
+                close( fd_ );
+            }
+#endif
+        }
+
+        cycle_counter( const cycle_counter& ) = delete;
+        cycle_counter& operator=( const cycle_counter& ) = delete;
+
+        const char* source() const noexcept
+        {
+            if( fd_ >= 0 ) {
+                return "perf";
+            }
+#if !defined DUTILS_ARCH_ARM
+            return "tsc";
+#else
+            return "none";
+#endif
+        }
+
+        // 0 when there is no counter
+        uint64_t    read() const noexcept
+        {
+#if defined __linux__
+            if( fd_ >= 0 ) {
+                uint64_t val = 0;
+                if( ::read( fd_, &val, sizeof( val ) ) == sizeof( val ) ) {
+                    return val;
+                }
+                return 0;
+            }
+#endif
+#if !defined DUTILS_ARCH_ARM
+            return __rdtsc();
+#else
+            return 0;
+#endif
+        }
+
+    private:
+        int fd_ = -1;
+    };
+
+    struct bench_options
+    {
+        std::string             filter;
+        std::vector<img::dim>   sizes = { { 640, 480 }, { 1920, 1080 }, { 4096, 3000 } };
+        double                  min_time_ms = 200;
+    };
+
+    struct bench_result
+    {
+        std::string     kernel;
+        std::string     variant;
+        img::fourcc     src;
+        img::fourcc     dst;
+        img::dim        dim;
+
+        int             iterations = 0;
+        double          ms_per_frame = 0;       // median
+        double          gb_per_s = 0;           // bytes read + bytes written
+        double          pixels_per_cycle = 0;   // 0 when there is no cycle counter
+        bool            verified = false;
+        double          max_diff = 0;
+    };
+
+    bench_result    run_variant( const kernel_func& func, image_buffer& dst, image_buffer& src, const bench_options& opt, const cycle_counter& counter )
+    {
+        using clock = std::chrono::steady_clock;
+
+        func( dst.desc(), src.desc() );     // warm up
+
+        std::vector<double> times;
+        uint64_t cycles = 0;
+        const auto start = clock::now();
+        do
+        {
+            const auto c0 = counter.read();
+            const auto t0 = clock::now();
+            func( dst.desc(), src.desc() );
+            const auto t1 = clock::now();
+            cycles += counter.read() - c0;
+
+            times.push_back( std::chrono::duration<double, std::milli>( t1 - t0 ).count() );
+        } while( times.size() < 3 || std::chrono::duration<double, std::milli>( clock::now() - start ).count() < opt.min_time_ms );
+
+        std::sort( times.begin(), times.end() );
+
+        bench_result res;
+        res.iterations = static_cast<int>( times.size() );
+        res.ms_per_frame = times[times.size() / 2];
+
+        const double bytes = static_cast<double>( src.data.size() ) + static_cast<double>( dst.data.size() );
+        res.gb_per_s = bytes / (res.ms_per_frame * 1e6);
+        if( cycles != 0 ) {
+            const double pixels = static_cast<double>( dst.type.dim.cx ) * dst.type.dim.cy;
+            res.pixels_per_cycle = pixels * res.iterations / static_cast<double>( cycles );
+        }
+        return res;
+    }
+
+    void    prepare_dst( const kernel_group& group, image_buffer& dst, const image_buffer& src )
+    {
+        if( group.in_place ) {
+            dst.data = src.data;
+        } else {
+            std::fill( dst.data.begin(), dst.data.end(), uint8_t{ 0 } );
+        }
+    }
+
+    std::vector<bench_result>   run_group( const kernel_group& group, const bench_options& opt, const cycle_counter& counter, std::mt19937& rng )
+    {
+        const unsigned int features = img_lib::cpu::get_features();
+
+        std::vector<bench_result> results;
+        for( const auto& dim : opt.sizes )
+        {
+            for( const auto& fmt : group.formats )
+            {
+                const img::dim dst_dim = { dim.cx / group.dst_divisor, dim.cy / group.dst_divisor };
+                if( !is_whole_pixel_groups( fmt.src, dim ) || !is_whole_pixel_groups( fmt.dst, dst_dim ) )
+                {
+                    fprintf( stderr, "%s: skipping %dx%d, %s -> %s needs whole pixel groups\n", group.name, dim.cx, dim.cy,
+                        img::fcc_to_string( fmt.src ).c_str(), img::fcc_to_string( fmt.dst ).c_str() );
+                    continue;
+                }
+                const auto src_type = img::make_img_type( fmt.src, dim );
+                const auto dst_type = img::make_img_type( fmt.dst, dst_dim );
+
+                const auto ref_func = group.variants.front().get( dst_type, src_type );
+                if( !ref_func ) {
+                    continue;
+                }
+
+                image_buffer src( src_type );
+                fill_random( src, rng );
+
+                image_buffer ref( dst_type );
+                prepare_dst( group, ref, src );
+                ref_func( ref.desc(), src.desc() );
+
+                for( const auto& variant : group.variants )
+                {
+                    if( (features & variant.required_features) != variant.required_features ) {
+                        continue;
+                    }
+                    const auto func = variant.get( dst_type, src_type );
+                    if( !func ) {
+                        continue;
+                    }
+
+                    image_buffer dst( dst_type );
+                    prepare_dst( group, dst, src );
+                    func( dst.desc(), src.desc() );
+                    const auto cmp = compare_to_reference( ref, dst, group.int_tolerance );
+
+                    auto res = run_variant( func, dst, src, opt, counter );
+                    res.kernel = group.name;
+                    res.variant = variant.name;
+                    res.src = fmt.src;
+                    res.dst = fmt.dst;
+                    res.dim = dim;
+                    res.verified = cmp.equal;
+                    res.max_diff = cmp.max_diff;
+                    results.push_back( res );
+                }
+            }
+        }
+        return results;
+    }
+
+    void    print_json( const std::vector<bench_result>& results, const cycle_counter& counter )
+    {
+        printf( "{\n" );
+        printf( "  \"cpu_features\": \"0x%x\",\n", img_lib::cpu::get_features() );
+        printf( "  \"cycle_counter\": \"%s\",\n", counter.source() );
+        printf( "  \"results\": [\n" );
+        for( size_t i = 0; i < results.size(); ++i )
+        {
+            const auto& r = results[i];
+            printf( "    { \"kernel\": \"%s\", \"variant\": \"%s\", \"src\": \"%s\", \"dst\": \"%s\", \"width\": %d, \"height\": %d, "
+                    "\"iterations\": %d, \"ms_per_frame\": %.4f, \"gb_per_s\": %.3f, \"pixels_per_cycle\": %.4f, \"verified\": %s, \"max_diff\": %g }%s\n",
+                r.kernel.c_str(), r.variant.c_str(), img::fcc_to_string( r.src ).c_str(), img::fcc_to_string( r.dst ).c_str(), r.dim.cx, r.dim.cy,
+                r.iterations, r.ms_per_frame, r.gb_per_s, r.pixels_per_cycle, r.verified ? "true" : "false", r.max_diff,
+                i + 1 < results.size() ? "," : "" );
+        }
+        printf( "  ]\n" );
+        printf( "}\n" );
+    }
+
+    bool    parse_args( int argc, char** argv, bench_options& opt )
+    {
+        bool sizes_set = false;
+        for( int i = 1; i < argc; ++i )
+        {
+            const std::string arg = argv[i];
+            if( i + 1 >= argc ) {
+                return false;
+            }
+            const char* val = argv[++i];
+            if( arg == "--filter" ) {
+                opt.filter = val;
+            } else if( arg == "--min-time" ) {
+                opt.min_time_ms = std::atof( val );
+            } else if( arg == "--size" ) {
+                img::dim dim = {};
+                if( sscanf( val, "%dx%d", &dim.cx, &dim.cy ) != 2 || dim.cx <= 0 || dim.cy <= 0 ) {
+                    return false;
+                }
+                if( !sizes_set ) {
+                    opt.sizes.clear();
+                    sizes_set = true;
+                }
+                opt.sizes.push_back( dim );
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    bench_options opt;
+    if( !parse_args( argc, argv, opt ) ) {
+        fprintf( stderr, "usage: %s [--filter <substring>] [--size <width>x<height>]... [--min-time <ms>]\n", argv[0] );
+        return 2;
+    }
+
+    const cycle_counter counter;
+    std::mt19937 rng( 42 );
+
+    std::vector<bench_result> results;
+    for( const auto& group : make_kernel_groups() )
+    {
+        if( !opt.filter.empty() && std::string( group.name ).find( opt.filter ) == std::string::npos ) {
+            continue;
+        }
+        auto group_results = run_group( group, opt, counter, rng );
+        results.insert( results.end(), group_results.begin(), group_results.end() );
+    }
+
+    print_json( results, counter );
+
+    const bool all_verified = std::all_of( results.begin(), results.end(), []( const bench_result& r ) { return r.verified; } );
+    return all_verified ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+
+#include "by16_edge_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+    constexpr int pixels_per_step = 16;
+
+    FORCEINLINE __m256i     abs_diff_epu16( __m256i a, __m256i b ) noexcept
+    {
+        return _mm256_or_si256( _mm256_subs_epu16( a, b ), _mm256_subs_epu16( b, a ) );
+    }
+
+    // stores 16 pixels as b g r a quadruples
+    FORCEINLINE void    store_bgra_16px( uint16_t* dst, __m256i b, __m256i g, __m256i r ) noexcept
+    {
+        const __m256i a = _mm256_set1_epi16( -1 );
+
+        // the unpacks work per 128-bit lane, o0 holds the pixels 0, 1 and 8, 9, o1 2, 3 and 10, 11 ...
+        const __m256i bg_lo = _mm256_unpacklo_epi16( b, g );
+        const __m256i bg_hi = _mm256_unpackhi_epi16( b, g );
+        const __m256i ra_lo = _mm256_unpacklo_epi16( r, a );
+        const __m256i ra_hi = _mm256_unpackhi_epi16( r, a );
+
+        const __m256i o0 = _mm256_unpacklo_epi32( bg_lo, ra_lo );
+        const __m256i o1 = _mm256_unpackhi_epi32( bg_lo, ra_lo );
+        const __m256i o2 = _mm256_unpacklo_epi32( bg_hi, ra_hi );
+        const __m256i o3 = _mm256_unpackhi_epi32( bg_hi, ra_hi );
+
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 0 ), _mm256_permute2x128_si256( o0, o1, 0x20 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 16 ), _mm256_permute2x128_si256( o2, o3, 0x20 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 32 ), _mm256_permute2x128_si256( o0, o1, 0x31 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + 48 ), _mm256_permute2x128_si256( o2, o3, 0x31 ) );
+    }
+
+    FORCEINLINE __m256i     load( const uint16_t* src ) noexcept
+    {
+        return _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src ) );
+    }
+
+    // both the color and the green pixel formulas are calculated for all lanes and then selected per lane
+    template<by_pattern pattern>
+    FORCEINLINE void    conv_16px( const line_data& lines, int x ) noexcept
+    {
+        const __m256i p_m1 = load( lines.prv + x - 1 );
+        const __m256i p_0 = load( lines.prv + x + 0 );
+        const __m256i p_p1 = load( lines.prv + x + 1 );
+        const __m256i c_m1 = load( lines.cur + x - 1 );
+        const __m256i c_0 = load( lines.cur + x + 0 );
+        const __m256i c_p1 = load( lines.cur + x + 1 );
+        const __m256i n_m1 = load( lines.nxt + x - 1 );
+        const __m256i n_0 = load( lines.nxt + x + 0 );
+        const __m256i n_p1 = load( lines.nxt + x + 1 );
+
+        const __m256i lr = _mm256_avg_epu16( c_m1, c_p1 );
+        const __m256i ob = _mm256_avg_epu16( p_0, n_0 );
+        const __m256i diag = _mm256_avg_epu16( _mm256_avg_epu16( p_m1, p_p1 ), _mm256_avg_epu16( n_m1, n_p1 ) );
+
+        // there is no unsigned 16-bit compare, the differences are compared with flipped sign bits
+        const __m256i sign = _mm256_set1_epi16( -0x8000 );
+        const __m256i dH = _mm256_xor_si256( abs_diff_epu16( c_m1, c_p1 ), sign );
+        const __m256i dV = _mm256_xor_si256( abs_diff_epu16( p_0, n_0 ), sign );
+        const __m256i around = _mm256_avg_epu16( lr, ob );
+        const __m256i edge = _mm256_blendv_epi8( _mm256_blendv_epi8( around, ob, _mm256_cmpgt_epi16( dH, dV ) ), lr, _mm256_cmpgt_epi16( dV, dH ) );
+
+        // is_color_pixel selects the lanes at even x, otherwise the odd ones, the mask applies to both 128-bit lanes
+        constexpr int color_lanes = is_color_pixel( pattern ) ? 0x55 : 0xAA;
+
+        const __m256i v_h = _mm256_blend_epi16( lr, c_0, color_lanes );
+        const __m256i v_v = _mm256_blend_epi16( ob, diag, color_lanes );
+        const __m256i g = _mm256_blend_epi16( c_0, edge, color_lanes );
+
+        if constexpr( is_red_line( pattern ) ) {
+            store_bgra_16px( lines.out_line + x * 4, v_v, g, v_h );
+        } else {
+            store_bgra_16px( lines.out_line + x * 4, v_h, g, v_v );
+        }
+    }
+
+    struct line_avx2
+    {
+        // the loads read one pixel past the 16 pixels of a step, the last pixel pair is done by convert_line
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            for( ; (x + pixels_per_step) <= (dim_x - 2); x += pixels_per_step )
+            {
+                conv_16px<pattern>( lines, x );
+            }
+            return x;
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_bgra64_avx2( img::img_type dst, img::img_type src )
+{
+    if( !by16_edge_internal::can_transform_by16_to_bgra64( dst, src ) ) {
+        return nullptr;
+    }
+    return &by16_edge_internal::by16_edge_image_loop<line_avx2>;
+}
@@ -0,0 +1,24 @@
+
+#include "by16_edge_internal.h"
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+    struct line_c
+    {
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            return conv_line_c<pattern>( lines, x, dim_x );
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_bgra64_c( img::img_type dst, img::img_type src )
+{
+    if( !by16_edge_internal::can_transform_by16_to_bgra64( dst, src ) ) {
+        return nullptr;
+    }
+    return &by16_edge_internal::by16_edge_image_loop<line_c>;
+}
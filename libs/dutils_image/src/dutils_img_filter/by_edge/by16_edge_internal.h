@@ -0,0 +1,194 @@
+#pragma once
+
+#include "by_edge.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <cstdint>
+
+/*
+ * Edge sensing debayer for 16-bit bayer images into BGRA64.
+ *
+ * This follows the by8 algorithm (by8_pixelops.h) without the green averaging and color matrix options,
+ * like the float variant. All averages are rounding averages of two values, (a + b + 1) / 2, so that
+ * the simd variants (pavgw, vrhadd) produce the same results as the c code without widening to 32 bits.
+ * The simd variants provide the inner part of a line, the borders are always done by the code in this file.
+ */
+
+namespace by16_edge_internal
+{
+    using namespace img::by_transform;
+
+    struct line_data
+    {
+        const uint16_t*     prv;
+        const uint16_t*     cur;
+        const uint16_t*     nxt;
+
+        uint16_t*           out_line;       // BGRA64, 4 values per pixel
+    };
+
+    struct pixel
+    {
+        uint16_t r, g, b;
+    };
+
+    inline line_data init_src_param( int y, const img::img_descriptor& dst, const img::img_descriptor& src, int offset_prev, int offset_next ) noexcept
+    {
+        return line_data{
+            img::get_line_start<const uint16_t>( src, y + offset_prev ),
+            img::get_line_start<const uint16_t>( src, y + 0 ),
+            img::get_line_start<const uint16_t>( src, y + offset_next ),
+            img::get_line_start<uint16_t>( dst, y ),
+        };
+    }
+
+    constexpr bool  is_red_line( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::GR;
+    }
+    constexpr bool  is_color_pixel( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::BG;
+    }
+
+    constexpr uint16_t  avg( int a, int b ) noexcept
+    {
+        return static_cast<uint16_t>((a + b + 1) >> 1);
+    }
+
+    FORCEINLINE uint16_t    calc_green_edge( const uint16_t* prv, const uint16_t* cur, const uint16_t* nxt ) noexcept
+    {
+        const uint16_t lr = avg( cur[-1], cur[+1] );
+        const uint16_t ob = avg( prv[0], nxt[0] );
+
+        const int dH = cur[-1] > cur[+1] ? cur[-1] - cur[+1] : cur[+1] - cur[-1];
+        const int dV = prv[0] > nxt[0] ? prv[0] - nxt[0] : nxt[0] - prv[0];
+        if( dH < dV ) {
+            return lr;
+        } else if( dH > dV ) {
+            return ob;
+        }
+        return avg( lr, ob );
+    }
+
+    template<by_pattern pattern>
+    FORCEINLINE pixel   conv_pixel( const line_data& lines, int x ) noexcept
+    {
+        const uint16_t* prv = lines.prv + x;
+        const uint16_t* cur = lines.cur + x;
+        const uint16_t* nxt = lines.nxt + x;
+
+        uint16_t v_h, v_v, g;
+        if constexpr( is_color_pixel( pattern ) )
+        {
+            v_h = cur[0];
+            v_v = avg( avg( prv[-1], prv[+1] ), avg( nxt[-1], nxt[+1] ) );
+            g = calc_green_edge( prv, cur, nxt );
+        }
+        else
+        {
+            v_h = avg( cur[-1], cur[+1] );
+            v_v = avg( prv[0], nxt[0] );
+            g = cur[0];
+        }
+
+        if constexpr( is_red_line( pattern ) ) {
+            return pixel{ v_h, g, v_v };
+        } else {
+            return pixel{ v_v, g, v_h };
+        }
+    }
+
+    FORCEINLINE void    store( uint16_t* out_line, int x, pixel val ) noexcept
+    {
+        out_line[x * 4 + 0] = val.b;
+        out_line[x * 4 + 1] = val.g;
+        out_line[x * 4 + 2] = val.r;
+        out_line[x * 4 + 3] = 0xFFFF;
+    }
+
+    template<by_pattern pattern>
+    FORCEINLINE int     conv_line_c( const line_data& lines, int x, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = by_pattern_alg::next_pixel( pattern );
+
+        for( ; x < (dim_x - 2); x += 2 )
+        {
+            store( lines.out_line, x + 0, conv_pixel<pattern>( lines, x + 0 ) );
+            store( lines.out_line, x + 1, conv_pixel<nxt_pattern>( lines, x + 1 ) );
+        }
+        return x;
+    }
+
+    // TLine::conv<pattern>( lines, x, dim_x ) converts the pixels from x on and returns the first x it did not convert
+    template<class TLine, by_pattern pattern>
+    void    convert_line( const line_data& lines, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = by_pattern_alg::next_pixel( pattern );
+
+        pixel tmp = conv_pixel<nxt_pattern>( lines, 0 + 1 );
+        store( lines.out_line, 0 + 0, tmp );
+        store( lines.out_line, 0 + 1, tmp );
+
+        int x = TLine::template conv<pattern>( lines, 2, dim_x );
+        x = conv_line_c<pattern>( lines, x, dim_x );
+
+        // x = dim_cx - 2
+        tmp = conv_pixel<pattern>( lines, x + 0 );
+        store( lines.out_line, x + 0, tmp );
+        store( lines.out_line, x + 1, tmp );
+    }
+
+    template<class TLine>
+    void    transform_line( by_pattern pattern, const line_data& lines, int dim_x ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    convert_line<TLine, by_pattern::BG>( lines, dim_x );    break;
+        case by_pattern::GB:    convert_line<TLine, by_pattern::GB>( lines, dim_x );    break;
+        case by_pattern::GR:    convert_line<TLine, by_pattern::GR>( lines, dim_x );    break;
+        case by_pattern::RG:    convert_line<TLine, by_pattern::RG>( lines, dim_x );    break;
+        };
+    }
+
+    template<class TLine>
+    void    by16_edge_image_loop( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& /*in_opt*/ )
+    {
+        const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+        const by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
+        const by_pattern pattern_nxt = by_pattern_alg::next_line( pattern_cur );
+
+        const int dim_y = src.dim.cy;
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
+            transform_line<TLine>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx );
+        }
+        else {
+            transform_line<TLine>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx );
+        }
+        int y = 1;
+        for( ; y < (dim_y - 1); y += 2 )
+        {
+            transform_line<TLine>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx );
+            transform_line<TLine>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx );
+        }
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
+            transform_line<TLine>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx );
+        }
+        else {
+            transform_line<TLine>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx );
+        }
+    }
+
+    inline bool can_transform_by16_to_bgra64( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_by16_fcc( src.fourcc_type() ) || dst.fourcc_type() != img::fourcc::BGRA64 ) {
+            return false;
+        }
+        if( dst.dim != src.dim ) {
+            return false;
+        }
+        return dst.dim.cx >= 4 && dst.dim.cy >= 2;
+    }
+}
@@ -0,0 +1,73 @@
+
+#include "../simd_helper/use_simd_A64.h"
+
+#include "by16_edge_internal.h"
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+    constexpr int pixels_per_step = 8;
+
+    // both the color and the green pixel formulas are calculated for all lanes and then selected per lane
+    template<by_pattern pattern>
+    FORCEINLINE void    conv_8px( const line_data& lines, int x ) noexcept
+    {
+        const uint16x8_t p_m1 = vld1q_u16( lines.prv + x - 1 );
+        const uint16x8_t p_0 = vld1q_u16( lines.prv + x + 0 );
+        const uint16x8_t p_p1 = vld1q_u16( lines.prv + x + 1 );
+        const uint16x8_t c_m1 = vld1q_u16( lines.cur + x - 1 );
+        const uint16x8_t c_0 = vld1q_u16( lines.cur + x + 0 );
+        const uint16x8_t c_p1 = vld1q_u16( lines.cur + x + 1 );
+        const uint16x8_t n_m1 = vld1q_u16( lines.nxt + x - 1 );
+        const uint16x8_t n_0 = vld1q_u16( lines.nxt + x + 0 );
+        const uint16x8_t n_p1 = vld1q_u16( lines.nxt + x + 1 );
+
+        const uint16x8_t lr = vrhaddq_u16( c_m1, c_p1 );
+        const uint16x8_t ob = vrhaddq_u16( p_0, n_0 );
+        const uint16x8_t diag = vrhaddq_u16( vrhaddq_u16( p_m1, p_p1 ), vrhaddq_u16( n_m1, n_p1 ) );
+
+        const uint16x8_t dH = vabdq_u16( c_m1, c_p1 );
+        const uint16x8_t dV = vabdq_u16( p_0, n_0 );
+        const uint16x8_t around = vrhaddq_u16( lr, ob );
+        const uint16x8_t edge = vbslq_u16( vcltq_u16( dH, dV ), lr, vbslq_u16( vcgtq_u16( dH, dV ), ob, around ) );
+
+        // is_color_pixel selects the lanes at even x, otherwise the odd ones
+        const uint16x8_t color_lanes = is_color_pixel( pattern )
+            ? uint16x8_t{ 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0 }
+            : uint16x8_t{ 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF, 0, 0xFFFF };
+
+        const uint16x8_t v_h = vbslq_u16( color_lanes, c_0, lr );
+        const uint16x8_t v_v = vbslq_u16( color_lanes, diag, ob );
+        const uint16x8_t g = vbslq_u16( color_lanes, edge, c_0 );
+        const uint16x8_t a = vdupq_n_u16( 0xFFFF );
+
+        if constexpr( is_red_line( pattern ) ) {
+            vst4q_u16( lines.out_line + x * 4, uint16x8x4_t{ v_v, g, v_h, a } );
+        } else {
+            vst4q_u16( lines.out_line + x * 4, uint16x8x4_t{ v_h, g, v_v, a } );
+        }
+    }
+
+    struct line_neon
+    {
+        // the loads read one pixel past the 8 pixels of a step, the last pixel pair is done by convert_line
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            for( ; (x + pixels_per_step) <= (dim_x - 2); x += pixels_per_step )
+            {
+                conv_8px<pattern>( lines, x );
+            }
+            return x;
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_bgra64_neon( img::img_type dst, img::img_type src )
+{
+    if( !by16_edge_internal::can_transform_by16_to_bgra64( dst, src ) ) {
+        return nullptr;
+    }
+    return &by16_edge_internal::by16_edge_image_loop<line_neon>;
+}
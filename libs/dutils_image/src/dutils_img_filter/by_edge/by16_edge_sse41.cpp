@@ -0,0 +1,98 @@
+
+#include "by16_edge_internal.h"
+
+#include <smmintrin.h>
+
+namespace
+{
+    using namespace by16_edge_internal;
+
+    constexpr int pixels_per_step = 8;
+
+    FORCEINLINE __m128i     abs_diff_epu16( __m128i a, __m128i b ) noexcept
+    {
+        return _mm_or_si128( _mm_subs_epu16( a, b ), _mm_subs_epu16( b, a ) );
+    }
+
+    // stores 8 pixels as b g r a quadruples
+    FORCEINLINE void    store_bgra_8px( uint16_t* dst, __m128i b, __m128i g, __m128i r ) noexcept
+    {
+        const __m128i a = _mm_set1_epi16( -1 );
+
+        const __m128i bg_lo = _mm_unpacklo_epi16( b, g );
+        const __m128i bg_hi = _mm_unpackhi_epi16( b, g );
+        const __m128i ra_lo = _mm_unpacklo_epi16( r, a );
+        const __m128i ra_hi = _mm_unpackhi_epi16( r, a );
+
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 0 ), _mm_unpacklo_epi32( bg_lo, ra_lo ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 8 ), _mm_unpackhi_epi32( bg_lo, ra_lo ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 16 ), _mm_unpacklo_epi32( bg_hi, ra_hi ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + 24 ), _mm_unpackhi_epi32( bg_hi, ra_hi ) );
+    }
+
+    FORCEINLINE __m128i     load( const uint16_t* src ) noexcept
+    {
+        return _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+    }
+
+    // both the color and the green pixel formulas are calculated for all lanes and then selected per lane
+    template<by_pattern pattern>
+    FORCEINLINE void    conv_8px( const line_data& lines, int x ) noexcept
+    {
+        const __m128i p_m1 = load( lines.prv + x - 1 );
+        const __m128i p_0 = load( lines.prv + x + 0 );
+        const __m128i p_p1 = load( lines.prv + x + 1 );
+        const __m128i c_m1 = load( lines.cur + x - 1 );
+        const __m128i c_0 = load( lines.cur + x + 0 );
+        const __m128i c_p1 = load( lines.cur + x + 1 );
+        const __m128i n_m1 = load( lines.nxt + x - 1 );
+        const __m128i n_0 = load( lines.nxt + x + 0 );
+        const __m128i n_p1 = load( lines.nxt + x + 1 );
+
+        const __m128i lr = _mm_avg_epu16( c_m1, c_p1 );
+        const __m128i ob = _mm_avg_epu16( p_0, n_0 );
+        const __m128i diag = _mm_avg_epu16( _mm_avg_epu16( p_m1, p_p1 ), _mm_avg_epu16( n_m1, n_p1 ) );
+
+        // there is no unsigned 16-bit compare, the differences are compared with flipped sign bits
+        const __m128i sign = _mm_set1_epi16( -0x8000 );
+        const __m128i dH = _mm_xor_si128( abs_diff_epu16( c_m1, c_p1 ), sign );
+        const __m128i dV = _mm_xor_si128( abs_diff_epu16( p_0, n_0 ), sign );
+        const __m128i around = _mm_avg_epu16( lr, ob );
+        const __m128i edge = _mm_blendv_epi8( _mm_blendv_epi8( around, ob, _mm_cmpgt_epi16( dH, dV ) ), lr, _mm_cmplt_epi16( dH, dV ) );
+
+        // is_color_pixel selects the lanes at even x, otherwise the odd ones
+        constexpr int color_lanes = is_color_pixel( pattern ) ? 0x55 : 0xAA;
+
+        const __m128i v_h = _mm_blend_epi16( lr, c_0, color_lanes );
+        const __m128i v_v = _mm_blend_epi16( ob, diag, color_lanes );
+        const __m128i g = _mm_blend_epi16( c_0, edge, color_lanes );
+
+        if constexpr( is_red_line( pattern ) ) {
+            store_bgra_8px( lines.out_line + x * 4, v_v, g, v_h );
+        } else {
+            store_bgra_8px( lines.out_line + x * 4, v_h, g, v_v );
+        }
+    }
+
+    struct line_sse41
+    {
+        // the loads read one pixel past the 8 pixels of a step, the last pixel pair is done by convert_line
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            for( ; (x + pixels_per_step) <= (dim_x - 2); x += pixels_per_step )
+            {
+                conv_8px<pattern>( lines, x );
+            }
+            return x;
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by16_to_bgra64_sse41( img::img_type dst, img::img_type src )
+{
+    if( !by16_edge_internal::can_transform_by16_to_bgra64( dst, src ) ) {
+        return nullptr;
+    }
+    return &by16_edge_internal::by16_edge_image_loop<line_sse41>;
+}
@@ -0,0 +1,452 @@
+
+#include "by_edge.h"
+#include "by_edge_internal.h"
+
+#include "../../dutils_img_base/alignment_helper.h"
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <type_traits>
+
+/*
+ * AVX2 variant of by8_edge_sse4_1_v0.cpp
+ *
+ * Instead of assembling the neighbour registers with alignr (which only works per 128-bit lane for ymm registers)
+ * the left and right neighbours are loaded directly from the line with unaligned loads.
+ * All per pixel operations are element wise, so the 128-bit lane split only matters for the final store.
+ *
+ * Loads for the output range [x;x+32[ read [x-1;x+33[, so the first and the last pixel of each line are
+ * copied from their neighbour, like the SSE4.1 version does.
+ */
+
+namespace
+{
+    using namespace by_edge_internal;
+    using namespace img::by_transform::by_pattern_alg;
+
+    constexpr int pixels_per_step = 32;
+
+    struct alg_context_avx2
+    {
+        __m256i         clr_mtx[9];
+
+        bool use_color_matrix;
+        bool use_avg_green;
+    };
+
+    using alg_context = alg_context_avx2;
+
+FORCEINLINE __m256i     load_u( const uint8_t* p )
+{
+    return _mm256_loadu_si256( reinterpret_cast<const __m256i*>(p) );
+}
+
+template<bool use_nt_stores>
+FORCEINLINE void        store_reg( void* p, __m256i v )
+{
+    if constexpr( use_nt_stores ) {
+        _mm256_stream_si256( reinterpret_cast<__m256i*>(p), v );
+    } else {
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>(p), v );
+    }
+}
+
+template<bool use_nt_stores>
+FORCEINLINE void    store_bgra32( const line_data& lines, int x, __m256i r, __m256i g, __m256i b )
+{
+    const __m256i full_ff = _mm256_set1_epi8( -1 );
+
+    // per 128-bit lane: bgra_0 = pixel [0;4[ and [16;20[, bgra_1 = [4;8[ and [20;24[ ...
+    auto bg_lo = _mm256_unpacklo_epi8( b, g );
+    auto bg_hi = _mm256_unpackhi_epi8( b, g );
+    auto rf_lo = _mm256_unpacklo_epi8( r, full_ff );
+    auto rf_hi = _mm256_unpackhi_epi8( r, full_ff );
+
+    auto bgra_0 = _mm256_unpacklo_epi16( bg_lo, rf_lo );
+    auto bgra_1 = _mm256_unpackhi_epi16( bg_lo, rf_lo );
+    auto bgra_2 = _mm256_unpacklo_epi16( bg_hi, rf_hi );
+    auto bgra_3 = _mm256_unpackhi_epi16( bg_hi, rf_hi );
+
+    auto* p_out_line = reinterpret_cast<BGRA32*>(lines.out_line) + x;
+    store_reg<use_nt_stores>( p_out_line + 0, _mm256_permute2x128_si256( bgra_0, bgra_1, 0x20 ) );
+    store_reg<use_nt_stores>( p_out_line + 8, _mm256_permute2x128_si256( bgra_2, bgra_3, 0x20 ) );
+    store_reg<use_nt_stores>( p_out_line + 16, _mm256_permute2x128_si256( bgra_0, bgra_1, 0x31 ) );
+    store_reg<use_nt_stores>( p_out_line + 24, _mm256_permute2x128_si256( bgra_2, bgra_3, 0x31 ) );
+}
+
+FORCEINLINE __m256i     shuffle_mask( __m128i mask )
+{
+    return _mm256_broadcastsi128_si256( mask );
+}
+
+// the same shuffles as simd::sse::storage::rgb_SoA_epi8_to_rgb24_full, for both 128-bit lanes at once
+FORCEINLINE void    store_bgr24( const line_data& lines, int x, __m256i r, __m256i g, __m256i b )
+{
+    const auto bg_lo = _mm256_unpacklo_epi8( b, g );
+    const auto bg_hi = _mm256_unpackhi_epi8( b, g );
+    const auto bg_mi = _mm256_alignr_epi8( bg_hi, bg_lo, 8 );
+
+    const auto bg_0 = shuffle_mask( _mm_setr_epi8( 0x00, 0x01, -1, 0x02, 0x03, -1, 0x04, 0x05, -1, 0x06, 0x07, -1, 0x08, 0x09, -1, 0x0A ) );
+    const auto r_0 = shuffle_mask( _mm_setr_epi8( -1, -1, 0x00, -1, -1, 0x01, -1, -1, 0x02, -1, -1, 0x03, -1, -1, 0x04, -1 ) );
+    const auto bg_1 = shuffle_mask( _mm_setr_epi8( 0x03, -1, 0x04, 0x05, -1, 0x06, 0x07, -1, 0x08, 0x09, -1, 0x0A, 0x0B, -1, 0x0C, 0x0D ) );
+    const auto r_1 = shuffle_mask( _mm_setr_epi8( -1, 0x05, -1, -1, 0x06, -1, -1, 0x07, -1, -1, 0x08, -1, -1, 0x09, -1, -1 ) );
+    const auto bg_2 = shuffle_mask( _mm_setr_epi8( -1, 0x06, 0x07, -1, 0x08, 0x09, -1, 0x0A, 0x0B, -1, 0x0C, 0x0D, -1, 0x0E, 0x0F, -1 ) );
+    const auto r_2 = shuffle_mask( _mm_setr_epi8( 0x0A, -1, -1, 0x0B, -1, -1, 0x0C, -1, -1, 0x0D, -1, -1, 0x0E, -1, -1, 0x0F ) );
+
+    // per 128-bit lane: pix_0 = bytes [0;16[ of the 16 pixels of the lane, pix_1 = [16;32[, pix_2 = [32;48[
+    const auto pix_0 = _mm256_or_si256( _mm256_shuffle_epi8( bg_lo, bg_0 ), _mm256_shuffle_epi8( r, r_0 ) );
+    const auto pix_1 = _mm256_or_si256( _mm256_shuffle_epi8( bg_mi, bg_1 ), _mm256_shuffle_epi8( r, r_1 ) );
+    const auto pix_2 = _mm256_or_si256( _mm256_shuffle_epi8( bg_hi, bg_2 ), _mm256_shuffle_epi8( r, r_2 ) );
+
+    auto* p_out = reinterpret_cast<uint8_t*>(reinterpret_cast<BGR24*>(lines.out_line) + x);
+    store_reg<false>( p_out + 0, _mm256_permute2x128_si256( pix_0, pix_1, 0x20 ) );
+    store_reg<false>( p_out + 32, _mm256_permute2x128_si256( pix_2, pix_0, 0x30 ) );
+    store_reg<false>( p_out + 64, _mm256_permute2x128_si256( pix_1, pix_2, 0x31 ) );
+}
+
+FORCEINLINE __m256i     mask_0x00FF()
+{
+    return _mm256_set1_epi16( 0x00FF );
+}
+
+FORCEINLINE __m256i     mask_0xFF00()
+{
+    return _mm256_set1_epi16( static_cast<short>(0xFF00) );
+}
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn_epu16( const alg_context& ctx, __m256i r, __m256i g, __m256i b )
+{
+    auto t0 = _mm256_mullo_epi16( r, ctx.clr_mtx[base_index + 0] );
+    auto t1 = _mm256_mullo_epi16( g, ctx.clr_mtx[base_index + 1] );
+    auto t2 = _mm256_mullo_epi16( b, ctx.clr_mtx[base_index + 2] );
+
+    auto sum = _mm256_add_epi16( _mm256_add_epi16( t0, t1 ), t2 );
+    auto val = _mm256_srai_epi16( sum, 6 );
+
+    return _mm256_max_epi16( val, _mm256_setzero_si256() );        // saturate values < 0 to 0
+}
+
+template<int base_index>
+FORCEINLINE __m256i     apply_color_matrix_chn( const alg_context& ctx, __m256i r, __m256i g, __m256i b )
+{
+    // unpack and pack work per 128-bit lane, so the element order is restored by packus
+    auto lo_r = _mm256_unpacklo_epi8( r, _mm256_setzero_si256() );
+    auto lo_g = _mm256_unpacklo_epi8( g, _mm256_setzero_si256() );
+    auto lo_b = _mm256_unpacklo_epi8( b, _mm256_setzero_si256() );
+
+    auto hi_r = _mm256_unpackhi_epi8( r, _mm256_setzero_si256() );
+    auto hi_g = _mm256_unpackhi_epi8( g, _mm256_setzero_si256() );
+    auto hi_b = _mm256_unpackhi_epi8( b, _mm256_setzero_si256() );
+
+    auto val_lo = apply_color_matrix_chn_epu16<base_index>( ctx, lo_r, lo_g, lo_b );
+    auto val_hi = apply_color_matrix_chn_epu16<base_index>( ctx, hi_r, hi_g, hi_b );
+
+    return _mm256_packus_epi16( val_lo, val_hi );
+}
+
+FORCEINLINE void        apply_color_matrix( const alg_context& ctx, __m256i& r, __m256i& g, __m256i& b )
+{
+    auto in_r = r;
+    auto in_g = g;
+    auto in_b = b;
+
+    r = apply_color_matrix_chn<0>( ctx, in_r, in_g, in_b );
+    g = apply_color_matrix_chn<3>( ctx, in_r, in_g, in_b );
+    b = apply_color_matrix_chn<6>( ctx, in_r, in_g, in_b );
+}
+
+FORCEINLINE __m256i calc_x_from_xg_line( __m256i cur_p0, __m256i cur_p2 )
+{
+    auto avg_line = _mm256_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm256_slli_epi16( cur_p2, 8 );
+
+    return _mm256_blendv_epi8( tmp2, avg_line, mask_0x00FF() );
+}
+
+FORCEINLINE __m256i calc_x_from_gx_line( __m256i cur_p0, __m256i cur_p2 )
+{
+    auto avg_line = _mm256_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm256_srli_epi16( cur_p0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, avg_line, mask_0xFF00() );
+}
+
+FORCEINLINE __m256i calc_y_from_xg_line( __m256i prv_p0, __m256i prv_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto prv_avg_line = _mm256_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm256_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm256_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm256_avg_epu8( nxt_p0, prv_p0 );
+    auto tmp2 = _mm256_srli_epi16( tmp0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, tmp1, mask_0xFF00() );
+}
+
+FORCEINLINE __m256i calc_y_from_gx_line( __m256i prv_p0, __m256i prv_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto prv_avg_line = _mm256_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm256_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm256_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm256_avg_epu8( nxt_p2, prv_p2 );
+    auto tmp2 = _mm256_slli_epi16( tmp0, 8 );
+
+    return _mm256_blendv_epi8( tmp2, tmp1, mask_0x00FF() );
+}
+
+FORCEINLINE __m256i calc_edge_g( __m256i cur_g_p0, __m256i cur_g_p2, __m256i prv_g, __m256i nxt_g )
+{
+    auto sum_lr = _mm256_avg_epu8( cur_g_p0, cur_g_p2 );
+    auto sum_ab = _mm256_avg_epu8( prv_g, nxt_g );
+    auto sum_al = _mm256_avg_epu8( sum_lr, sum_ab );
+
+    auto dif_lr = _mm256_abs_epi16( _mm256_sub_epi16( cur_g_p0, cur_g_p2 ) );
+    auto dif_ab = _mm256_abs_epi16( _mm256_sub_epi16( prv_g, nxt_g ) );
+
+    auto cmp_lt = _mm256_cmpgt_epi16( dif_ab, dif_lr );        // dif_lr < dif_ab
+    auto cmp_eq = _mm256_cmpeq_epi16( dif_lr, dif_ab );
+
+    auto tmp0 = _mm256_blendv_epi8( sum_ab, sum_lr, cmp_lt );
+    return _mm256_blendv_epi8( tmp0, sum_al, cmp_eq );
+}
+
+FORCEINLINE __m256i calc_g_from_xg_line( __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm256_srli_epi16( cur_p2, 8 );
+
+    auto prv_g = _mm256_and_si256( prv_p2, mask_0x00FF() );
+    auto nxt_g = _mm256_and_si256( nxt_p2, mask_0x00FF() );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm256_slli_epi16( tmp1, 8 );
+    return _mm256_or_si256( cur_g_p0, tmp2 );
+}
+
+FORCEINLINE __m256i calc_g_from_gx_line( __m256i prv, __m256i cur_p0, __m256i cur_p2, __m256i nxt )
+{
+    auto cur_g_p0 = _mm256_and_si256( cur_p0, mask_0x00FF() );
+    auto cur_g_p2 = _mm256_and_si256( cur_p2, mask_0x00FF() );
+
+    auto prv_g = _mm256_srli_epi16( prv, 8 );
+    auto nxt_g = _mm256_srli_epi16( nxt, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm256_slli_epi16( cur_g_p2, 8 );
+
+    return _mm256_or_si256( tmp1, tmp2 );
+}
+
+FORCEINLINE __m256i calc_avgG_value( __m256i prv_g_p0, __m256i prv_g_p2, __m256i nxt_g_p0, __m256i nxt_g_p2, __m256i cur_g )
+{
+    const __m256i mask_0x0007 = _mm256_set1_epi16( 0x0007 );
+
+    auto dif_lr = _mm256_abs_epi16( _mm256_sub_epi16( prv_g_p0, prv_g_p2 ) );
+    auto dif_ab = _mm256_abs_epi16( _mm256_sub_epi16( prv_g_p0, nxt_g_p0 ) );
+
+    auto t0 = _mm256_avg_epu8( prv_g_p0, prv_g_p2 );
+    auto t1 = _mm256_avg_epu8( nxt_g_p0, nxt_g_p2 );
+
+    auto sum_all = _mm256_avg_epu8( t0, t1 );
+    sum_all = _mm256_avg_epu8( sum_all, cur_g );
+
+    auto diff_gt_7 = _mm256_cmpgt_epi16( mask_0x0007, dif_ab );
+    auto diff_lr_7 = _mm256_cmpgt_epi16( mask_0x0007, dif_lr );
+
+    auto cond_true = _mm256_and_si256( diff_gt_7, diff_lr_7 );
+
+    return _mm256_blendv_epi8( cur_g, sum_all, cond_true );
+}
+
+FORCEINLINE __m256i calc_g_from_xg_line_avgG( __m256i prv_p0, __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm256_srli_epi16( cur_p2, 8 );
+
+    auto prv_g_p0 = _mm256_and_si256( prv_p0, mask_0x00FF() );
+    auto nxt_g_p0 = _mm256_and_si256( nxt_p0, mask_0x00FF() );
+
+    auto prv_g_p2 = _mm256_and_si256( prv_p2, mask_0x00FF() );
+    auto nxt_g_p2 = _mm256_and_si256( nxt_p2, mask_0x00FF() );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p2, nxt_g_p2 );
+    auto tmp2 = _mm256_slli_epi16( tmp1, 8 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p0 );
+
+    return _mm256_or_si256( g_even, tmp2 );
+}
+
+FORCEINLINE __m256i calc_g_from_gx_line_avgG( __m256i prv_p0, __m256i prv_p2, __m256i cur_p0, __m256i cur_p2, __m256i nxt_p0, __m256i nxt_p2 )
+{
+    auto cur_g_p0 = _mm256_and_si256( cur_p0, mask_0x00FF() );
+    auto cur_g_p2 = _mm256_and_si256( cur_p2, mask_0x00FF() );
+
+    auto prv_g_p0 = _mm256_srli_epi16( prv_p0, 8 );
+    auto nxt_g_p0 = _mm256_srli_epi16( nxt_p0, 8 );
+
+    auto prv_g_p2 = _mm256_srli_epi16( prv_p2, 8 );
+    auto nxt_g_p2 = _mm256_srli_epi16( nxt_p2, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p0, nxt_g_p0 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p2 );
+    auto tmp2 = _mm256_slli_epi16( g_even, 8 );
+
+    return _mm256_or_si256( tmp1, tmp2 );
+}
+
+// pat is the pattern of the pixel at lines.lines[n] + x - 1
+template<class TOut, by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+FORCEINLINE void    conv_step( const alg_context& clr, const line_data& lines, int x )
+{
+    auto prv_p0 = load_u( lines.lines[0] + x - 1 );
+    auto cur_p0 = load_u( lines.lines[1] + x - 1 );
+    auto nxt_p0 = load_u( lines.lines[2] + x - 1 );
+
+    auto prv_p2 = load_u( lines.lines[0] + x + 1 );
+    auto cur_p2 = load_u( lines.lines[1] + x + 1 );
+    auto nxt_p2 = load_u( lines.lines[2] + x + 1 );
+
+    __m256i x_chn, y_chn, g_chn;
+    if constexpr( is_gx_line( pat ) )
+    {
+        x_chn = calc_x_from_gx_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_gx_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if constexpr( use_avg_green ) {
+            g_chn = calc_g_from_gx_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_gx_line( prv_p0, cur_p0, cur_p2, nxt_p0 );
+        }
+    } else {
+        x_chn = calc_x_from_xg_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_xg_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if constexpr( use_avg_green ) {
+            g_chn = calc_g_from_xg_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_xg_line( prv_p2, cur_p0, cur_p2, nxt_p2 );
+        }
+    }
+
+    __m256i r, g = g_chn, b;
+    if constexpr( is_red_line( pat ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+
+    if constexpr( use_mtx ) {
+        apply_color_matrix( clr, r, g, b );
+    }
+
+    if constexpr( std::is_same_v<TOut, BGR24> ) {
+        store_bgr24( lines, x, r, g, b );
+    } else {
+        store_bgra32<use_nt_store>( lines, x, r, g, b );
+    }
+}
+
+template<class TOut, by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+void	    conv_line( const alg_context& clr, const line_data& lines, int dim_x )
+{
+    constexpr auto nxt_pattern = next_pixel( pat );
+
+    // writes [1;33[, reads [0;34[
+    conv_step<TOut, pat, use_mtx, use_avg_green, false>( clr, lines, 1 );
+
+    // x is even, so the pixel at x - 1 has the pattern of the 2nd pixel
+    int x = pixels_per_step;
+    for( ; x + pixels_per_step < dim_x; x += pixels_per_step )
+    {
+        conv_step<TOut, nxt_pattern, use_mtx, use_avg_green, use_nt_store>( clr, lines, x );
+    }
+
+    // writes [dim_x - 33;dim_x - 1[, reads [dim_x - 34;dim_x[
+    conv_step<TOut, pat, use_mtx, use_avg_green, false>( clr, lines, dim_x - pixels_per_step - 1 );
+
+    auto* out_line = reinterpret_cast<TOut*>(lines.out_line);
+    out_line[0] = out_line[1];
+    out_line[dim_x - 1] = out_line[dim_x - 2];
+}
+
+alg_context     fill_context( const img_filter::transform::by_edge::options& in_opt )
+{
+    auto ctx = alg_context{ {}, in_opt.use_color_matrix, in_opt.use_avg_green };
+    for( int i = 0; i < 9; ++i )
+    {
+        ctx.clr_mtx[i] = _mm256_set1_epi16( in_opt.color_mtx.fac[i] );
+    }
+    return ctx;
+}
+
+// the pattern, the color matrix and the green averaging are resolved once per image
+template<typename TRGBStr, bool use_mtx, bool use_avg_green, bool use_nt_stores>
+static void by_edge_image_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
+{
+    by8_edge_line_loop( dst, src, [&]( auto pattern, const line_data& lines ) {
+        conv_line<TRGBStr, decltype( pattern )::value, use_mtx, use_avg_green, use_nt_stores>( ctx, lines, src.dim.cx );
+    } );
+}
+
+template<typename TRGBStr, bool use_nt_stores>
+static void by_edge_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
+{
+    if( ctx.use_color_matrix ) {
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, true, true, use_nt_stores>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, true, false, use_nt_stores>( dst, src, ctx );
+        }
+    } else {
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, false, true, use_nt_stores>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, false, false, use_nt_stores>( dst, src, ctx );
+        }
+    }
+}
+
+template<typename TRGBStr>
+static void by_edge_image_loop_avx2( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& options )
+{
+    auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+    auto ctx = fill_context( options );
+
+    if( simd::is_aligned_for_avx_stream( dst ) ) {
+        by_edge_image_loop<TRGBStr, true>( dst, src, ctx );
+        _mm_sfence();
+    } else {
+        by_edge_image_loop<TRGBStr, false>( dst, src, ctx );
+    }
+}
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by8_to_dst_avx2( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    // the line loop needs at least 2 steps and an even line length
+    if( dst.dim.cx < (pixels_per_step + 2) || (dst.dim.cx % 2) != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32: return &by_edge_image_loop_avx2<BGRA32>;
+    case img::fourcc::BGR24: return &by_edge_image_loop_avx2<BGR24>;
+    default:
+        break;
+    };
+
+    return nullptr;
+}
@@ -0,0 +1,424 @@
+
+#include "by_edge.h"
+#include "by_edge_internal.h"
+
+#include "../../dutils_img_base/alignment_helper.h"
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <type_traits>
+
+/*
+ * AVX-512BW variant of by8_edge_avx2_v0.cpp
+ *
+ * The byte/word blends of the SSE/AVX2 versions are replaced by mask register blends,
+ * otherwise the algorithm is identical. One step converts 64 pixels.
+ */
+
+namespace
+{
+    using namespace by_edge_internal;
+    using namespace img::by_transform::by_pattern_alg;
+
+    constexpr int pixels_per_step = 64;
+
+    // selects the even/odd bytes of each 16-bit element
+    constexpr __mmask64 mask_lo_bytes = 0x5555'5555'5555'5555ull;
+    constexpr __mmask64 mask_hi_bytes = 0xAAAA'AAAA'AAAA'AAAAull;
+
+    struct alg_context_avx512
+    {
+        __m512i         clr_mtx[9];
+
+        bool use_color_matrix;
+        bool use_avg_green;
+    };
+
+    using alg_context = alg_context_avx512;
+
+FORCEINLINE __m512i     load_u( const uint8_t* p )
+{
+    return _mm512_loadu_si512( p );
+}
+
+template<bool use_nt_stores>
+FORCEINLINE void        store_reg( void* p, __m512i v )
+{
+    if constexpr( use_nt_stores ) {
+        _mm512_stream_si512( reinterpret_cast<__m512i*>(p), v );
+    } else {
+        _mm512_storeu_si512( p, v );
+    }
+}
+
+// _mm512_shuffle_i64x2 passes _mm512_undefined_epi32() as merge source, which makes GCC 12 emit
+// hundreds of -Wmaybe-uninitialized warnings (GCC bug 105593). With a full mask the merge source is unused.
+template<int imm>
+FORCEINLINE __m512i     shuffle_i64x2( __m512i a, __m512i b )
+{
+    return _mm512_mask_shuffle_i64x2( a, static_cast<__mmask8>( 0xFF ), a, b, imm );
+}
+
+template<bool use_nt_stores>
+FORCEINLINE void    store_bgra32( const line_data& lines, int x, __m512i r, __m512i g, __m512i b )
+{
+    const __m512i full_ff = _mm512_set1_epi8( -1 );
+
+    // per 128-bit lane: bgra_0 = pixel [0;4[, [16;20[, [32;36[, [48;52[, bgra_1 = [4;8[, [20;24[ ...
+    auto bg_lo = _mm512_unpacklo_epi8( b, g );
+    auto bg_hi = _mm512_unpackhi_epi8( b, g );
+    auto rf_lo = _mm512_unpacklo_epi8( r, full_ff );
+    auto rf_hi = _mm512_unpackhi_epi8( r, full_ff );
+
+    auto bgra_0 = _mm512_unpacklo_epi16( bg_lo, rf_lo );
+    auto bgra_1 = _mm512_unpackhi_epi16( bg_lo, rf_lo );
+    auto bgra_2 = _mm512_unpacklo_epi16( bg_hi, rf_hi );
+    auto bgra_3 = _mm512_unpackhi_epi16( bg_hi, rf_hi );
+
+    // transpose the 4x4 matrix of 128-bit lanes
+    auto t0 = shuffle_i64x2<0x44>( bgra_0, bgra_1 );     // [0;4[, [16;20[, [4;8[, [20;24[
+    auto t1 = shuffle_i64x2<0x44>( bgra_2, bgra_3 );     // [8;12[, [24;28[, [12;16[, [28;32[
+    auto t2 = shuffle_i64x2<0xEE>( bgra_0, bgra_1 );
+    auto t3 = shuffle_i64x2<0xEE>( bgra_2, bgra_3 );
+
+    auto* p_out_line = reinterpret_cast<BGRA32*>(lines.out_line) + x;
+    store_reg<use_nt_stores>( p_out_line + 0, shuffle_i64x2<0x88>( t0, t1 ) );
+    store_reg<use_nt_stores>( p_out_line + 16, shuffle_i64x2<0xDD>( t0, t1 ) );
+    store_reg<use_nt_stores>( p_out_line + 32, shuffle_i64x2<0x88>( t2, t3 ) );
+    store_reg<use_nt_stores>( p_out_line + 48, shuffle_i64x2<0xDD>( t2, t3 ) );
+}
+
+FORCEINLINE __m512i     lo_bytes( __m512i v )
+{
+    return _mm512_and_si512( v, _mm512_set1_epi16( 0x00FF ) );
+}
+
+template<int base_index>
+FORCEINLINE __m512i     apply_color_matrix_chn_epu16( const alg_context& ctx, __m512i r, __m512i g, __m512i b )
+{
+    auto t0 = _mm512_mullo_epi16( r, ctx.clr_mtx[base_index + 0] );
+    auto t1 = _mm512_mullo_epi16( g, ctx.clr_mtx[base_index + 1] );
+    auto t2 = _mm512_mullo_epi16( b, ctx.clr_mtx[base_index + 2] );
+
+    auto sum = _mm512_add_epi16( _mm512_add_epi16( t0, t1 ), t2 );
+    auto val = _mm512_srai_epi16( sum, 6 );
+
+    return _mm512_max_epi16( val, _mm512_setzero_si512() );        // saturate values < 0 to 0
+}
+
+template<int base_index>
+FORCEINLINE __m512i     apply_color_matrix_chn( const alg_context& ctx, __m512i r, __m512i g, __m512i b )
+{
+    // unpack and pack work per 128-bit lane, so the element order is restored by packus
+    auto lo_r = _mm512_unpacklo_epi8( r, _mm512_setzero_si512() );
+    auto lo_g = _mm512_unpacklo_epi8( g, _mm512_setzero_si512() );
+    auto lo_b = _mm512_unpacklo_epi8( b, _mm512_setzero_si512() );
+
+    auto hi_r = _mm512_unpackhi_epi8( r, _mm512_setzero_si512() );
+    auto hi_g = _mm512_unpackhi_epi8( g, _mm512_setzero_si512() );
+    auto hi_b = _mm512_unpackhi_epi8( b, _mm512_setzero_si512() );
+
+    auto val_lo = apply_color_matrix_chn_epu16<base_index>( ctx, lo_r, lo_g, lo_b );
+    auto val_hi = apply_color_matrix_chn_epu16<base_index>( ctx, hi_r, hi_g, hi_b );
+
+    return _mm512_packus_epi16( val_lo, val_hi );
+}
+
+FORCEINLINE void        apply_color_matrix( const alg_context& ctx, __m512i& r, __m512i& g, __m512i& b )
+{
+    auto in_r = r;
+    auto in_g = g;
+    auto in_b = b;
+
+    r = apply_color_matrix_chn<0>( ctx, in_r, in_g, in_b );
+    g = apply_color_matrix_chn<3>( ctx, in_r, in_g, in_b );
+    b = apply_color_matrix_chn<6>( ctx, in_r, in_g, in_b );
+}
+
+FORCEINLINE __m512i calc_x_from_xg_line( __m512i cur_p0, __m512i cur_p2 )
+{
+    auto avg_line = _mm512_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm512_slli_epi16( cur_p2, 8 );
+
+    return _mm512_mask_blend_epi8( mask_lo_bytes, tmp2, avg_line );
+}
+
+FORCEINLINE __m512i calc_x_from_gx_line( __m512i cur_p0, __m512i cur_p2 )
+{
+    auto avg_line = _mm512_avg_epu8( cur_p0, cur_p2 );
+    auto tmp2 = _mm512_srli_epi16( cur_p0, 8 );
+
+    return _mm512_mask_blend_epi8( mask_hi_bytes, tmp2, avg_line );
+}
+
+FORCEINLINE __m512i calc_y_from_xg_line( __m512i prv_p0, __m512i prv_p2, __m512i nxt_p0, __m512i nxt_p2 )
+{
+    auto prv_avg_line = _mm512_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm512_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm512_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm512_avg_epu8( nxt_p0, prv_p0 );
+    auto tmp2 = _mm512_srli_epi16( tmp0, 8 );
+
+    return _mm512_mask_blend_epi8( mask_hi_bytes, tmp2, tmp1 );
+}
+
+FORCEINLINE __m512i calc_y_from_gx_line( __m512i prv_p0, __m512i prv_p2, __m512i nxt_p0, __m512i nxt_p2 )
+{
+    auto prv_avg_line = _mm512_avg_epu8( prv_p0, prv_p2 );
+    auto nxt_avg_line = _mm512_avg_epu8( nxt_p0, nxt_p2 );
+    auto tmp1 = _mm512_avg_epu8( prv_avg_line, nxt_avg_line );
+
+    auto tmp0 = _mm512_avg_epu8( nxt_p2, prv_p2 );
+    auto tmp2 = _mm512_slli_epi16( tmp0, 8 );
+
+    return _mm512_mask_blend_epi8( mask_lo_bytes, tmp2, tmp1 );
+}
+
+FORCEINLINE __m512i calc_edge_g( __m512i cur_g_p0, __m512i cur_g_p2, __m512i prv_g, __m512i nxt_g )
+{
+    auto sum_lr = _mm512_avg_epu8( cur_g_p0, cur_g_p2 );
+    auto sum_ab = _mm512_avg_epu8( prv_g, nxt_g );
+    auto sum_al = _mm512_avg_epu8( sum_lr, sum_ab );
+
+    auto dif_lr = _mm512_abs_epi16( _mm512_sub_epi16( cur_g_p0, cur_g_p2 ) );
+    auto dif_ab = _mm512_abs_epi16( _mm512_sub_epi16( prv_g, nxt_g ) );
+
+    auto cmp_lt = _mm512_cmplt_epi16_mask( dif_lr, dif_ab );
+    auto cmp_eq = _mm512_cmpeq_epi16_mask( dif_lr, dif_ab );
+
+    auto tmp0 = _mm512_mask_blend_epi16( cmp_lt, sum_ab, sum_lr );
+    return _mm512_mask_blend_epi16( cmp_eq, tmp0, sum_al );
+}
+
+FORCEINLINE __m512i calc_g_from_xg_line( __m512i prv_p2, __m512i cur_p0, __m512i cur_p2, __m512i nxt_p2 )
+{
+    auto cur_g_p0 = _mm512_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm512_srli_epi16( cur_p2, 8 );
+
+    auto prv_g = lo_bytes( prv_p2 );
+    auto nxt_g = lo_bytes( nxt_p2 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm512_slli_epi16( tmp1, 8 );
+    return _mm512_or_si512( cur_g_p0, tmp2 );
+}
+
+FORCEINLINE __m512i calc_g_from_gx_line( __m512i prv, __m512i cur_p0, __m512i cur_p2, __m512i nxt )
+{
+    auto cur_g_p0 = lo_bytes( cur_p0 );
+    auto cur_g_p2 = lo_bytes( cur_p2 );
+
+    auto prv_g = _mm512_srli_epi16( prv, 8 );
+    auto nxt_g = _mm512_srli_epi16( nxt, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g, nxt_g );
+    auto tmp2 = _mm512_slli_epi16( cur_g_p2, 8 );
+
+    return _mm512_or_si512( tmp1, tmp2 );
+}
+
+FORCEINLINE __m512i calc_avgG_value( __m512i prv_g_p0, __m512i prv_g_p2, __m512i nxt_g_p0, __m512i nxt_g_p2, __m512i cur_g )
+{
+    const __m512i mask_0x0007 = _mm512_set1_epi16( 0x0007 );
+
+    auto dif_lr = _mm512_abs_epi16( _mm512_sub_epi16( prv_g_p0, prv_g_p2 ) );
+    auto dif_ab = _mm512_abs_epi16( _mm512_sub_epi16( prv_g_p0, nxt_g_p0 ) );
+
+    auto t0 = _mm512_avg_epu8( prv_g_p0, prv_g_p2 );
+    auto t1 = _mm512_avg_epu8( nxt_g_p0, nxt_g_p2 );
+
+    auto sum_all = _mm512_avg_epu8( t0, t1 );
+    sum_all = _mm512_avg_epu8( sum_all, cur_g );
+
+    auto cond_true = _mm512_cmplt_epi16_mask( dif_ab, mask_0x0007 ) & _mm512_cmplt_epi16_mask( dif_lr, mask_0x0007 );
+
+    return _mm512_mask_blend_epi16( cond_true, cur_g, sum_all );
+}
+
+FORCEINLINE __m512i calc_g_from_xg_line_avgG( __m512i prv_p0, __m512i prv_p2, __m512i cur_p0, __m512i cur_p2, __m512i nxt_p0, __m512i nxt_p2 )
+{
+    auto cur_g_p0 = _mm512_srli_epi16( cur_p0, 8 );
+    auto cur_g_p2 = _mm512_srli_epi16( cur_p2, 8 );
+
+    auto prv_g_p0 = lo_bytes( prv_p0 );
+    auto nxt_g_p0 = lo_bytes( nxt_p0 );
+
+    auto prv_g_p2 = lo_bytes( prv_p2 );
+    auto nxt_g_p2 = lo_bytes( nxt_p2 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p2, nxt_g_p2 );
+    auto tmp2 = _mm512_slli_epi16( tmp1, 8 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p0 );
+
+    return _mm512_or_si512( g_even, tmp2 );
+}
+
+FORCEINLINE __m512i calc_g_from_gx_line_avgG( __m512i prv_p0, __m512i prv_p2, __m512i cur_p0, __m512i cur_p2, __m512i nxt_p0, __m512i nxt_p2 )
+{
+    auto cur_g_p0 = lo_bytes( cur_p0 );
+    auto cur_g_p2 = lo_bytes( cur_p2 );
+
+    auto prv_g_p0 = _mm512_srli_epi16( prv_p0, 8 );
+    auto nxt_g_p0 = _mm512_srli_epi16( nxt_p0, 8 );
+
+    auto prv_g_p2 = _mm512_srli_epi16( prv_p2, 8 );
+    auto nxt_g_p2 = _mm512_srli_epi16( nxt_p2, 8 );
+
+    auto tmp1 = calc_edge_g( cur_g_p0, cur_g_p2, prv_g_p0, nxt_g_p0 );
+
+    auto g_even = calc_avgG_value( prv_g_p0, prv_g_p2, nxt_g_p0, nxt_g_p2, cur_g_p2 );
+    auto tmp2 = _mm512_slli_epi16( g_even, 8 );
+
+    return _mm512_or_si512( tmp1, tmp2 );
+}
+
+// pat is the pattern of the pixel at lines.lines[n] + x - 1
+template<class TOut, by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+FORCEINLINE void    conv_step( const alg_context& clr, const line_data& lines, int x )
+{
+    auto prv_p0 = load_u( lines.lines[0] + x - 1 );
+    auto cur_p0 = load_u( lines.lines[1] + x - 1 );
+    auto nxt_p0 = load_u( lines.lines[2] + x - 1 );
+
+    auto prv_p2 = load_u( lines.lines[0] + x + 1 );
+    auto cur_p2 = load_u( lines.lines[1] + x + 1 );
+    auto nxt_p2 = load_u( lines.lines[2] + x + 1 );
+
+    __m512i x_chn, y_chn, g_chn;
+    if constexpr( is_gx_line( pat ) )
+    {
+        x_chn = calc_x_from_gx_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_gx_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if constexpr( use_avg_green ) {
+            g_chn = calc_g_from_gx_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_gx_line( prv_p0, cur_p0, cur_p2, nxt_p0 );
+        }
+    } else {
+        x_chn = calc_x_from_xg_line( cur_p0, cur_p2 );
+        y_chn = calc_y_from_xg_line( prv_p0, prv_p2, nxt_p0, nxt_p2 );
+
+        if constexpr( use_avg_green ) {
+            g_chn = calc_g_from_xg_line_avgG( prv_p0, prv_p2, cur_p0, cur_p2, nxt_p0, nxt_p2 );
+        } else {
+            g_chn = calc_g_from_xg_line( prv_p2, cur_p0, cur_p2, nxt_p2 );
+        }
+    }
+
+    __m512i r, g = g_chn, b;
+    if constexpr( is_red_line( pat ) ) {
+        r = x_chn;
+        b = y_chn;
+    } else {
+        r = y_chn;
+        b = x_chn;
+    }
+
+    if constexpr( use_mtx ) {
+        apply_color_matrix( clr, r, g, b );
+    }
+
+    static_assert(std::is_same_v<TOut, BGRA32>, "Only BGRA32 is implemented");
+    store_bgra32<use_nt_store>( lines, x, r, g, b );
+}
+
+template<class TOut, by_pattern pat, bool use_mtx, bool use_avg_green, bool use_nt_store>
+void	    conv_line( const alg_context& clr, const line_data& lines, int dim_x )
+{
+    constexpr auto nxt_pattern = next_pixel( pat );
+
+    // writes [1;65[, reads [0;66[
+    conv_step<TOut, pat, use_mtx, use_avg_green, false>( clr, lines, 1 );
+
+    // x is even, so the pixel at x - 1 has the pattern of the 2nd pixel
+    int x = pixels_per_step;
+    for( ; x + pixels_per_step < dim_x; x += pixels_per_step )
+    {
+        conv_step<TOut, nxt_pattern, use_mtx, use_avg_green, use_nt_store>( clr, lines, x );
+    }
+
+    // writes [dim_x - 65;dim_x - 1[, reads [dim_x - 66;dim_x[
+    conv_step<TOut, pat, use_mtx, use_avg_green, false>( clr, lines, dim_x - pixels_per_step - 1 );
+
+    auto* out_line = reinterpret_cast<TOut*>(lines.out_line);
+    out_line[0] = out_line[1];
+    out_line[dim_x - 1] = out_line[dim_x - 2];
+}
+
+alg_context     fill_context( const img_filter::transform::by_edge::options& in_opt )
+{
+    auto ctx = alg_context{ {}, in_opt.use_color_matrix, in_opt.use_avg_green };
+    for( int i = 0; i < 9; ++i )
+    {
+        ctx.clr_mtx[i] = _mm512_set1_epi16( in_opt.color_mtx.fac[i] );
+    }
+    return ctx;
+}
+
+// the pattern, the color matrix and the green averaging are resolved once per image
+template<typename TRGBStr, bool use_mtx, bool use_avg_green, bool use_nt_stores>
+static void by_edge_image_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
+{
+    by8_edge_line_loop( dst, src, [&]( auto pattern, const line_data& lines ) {
+        conv_line<TRGBStr, decltype( pattern )::value, use_mtx, use_avg_green, use_nt_stores>( ctx, lines, src.dim.cx );
+    } );
+}
+
+template<typename TRGBStr, bool use_nt_stores>
+static void by_edge_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
+{
+    if( ctx.use_color_matrix ) {
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, true, true, use_nt_stores>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, true, false, use_nt_stores>( dst, src, ctx );
+        }
+    } else {
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, false, true, use_nt_stores>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, false, false, use_nt_stores>( dst, src, ctx );
+        }
+    }
+}
+
+template<typename TRGBStr>
+static void by_edge_image_loop_avx512( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& options )
+{
+    auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+    auto ctx = fill_context( options );
+
+    if( simd::is_aligned_for_stream<64>( dst.data(), dst.pitch() ) ) {
+        by_edge_image_loop<TRGBStr, true>( dst, src, ctx );
+        _mm_sfence();
+    } else {
+        by_edge_image_loop<TRGBStr, false>( dst, src, ctx );
+    }
+}
+
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by8_to_dst_avx512bw( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    // the line loop needs at least 2 steps and an even line length
+    if( dst.dim.cx < (pixels_per_step + 2) || (dst.dim.cx % 2) != 0 || dst.dim.cy < 2 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32: return &by_edge_image_loop_avx512<BGRA32>;
+    default:
+        break;
+    };
+
+    return nullptr;
+}
@@ -130,68 +130,35 @@ void	convert_by8_to_rgb_edge( const alg_context& clr, const line_data& lines, in
     store<TOut>( lines.out_line, x + 1, tmp );
 }
 
-template<class TOutDataType,bool use_mtx,bool avg_greenx>
-static void transform_line_( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+// the pattern, the color matrix and the green averaging are resolved once per image
+template<typename TRGBStr, bool use_mtx, bool use_avg_green>
+static void by_edge_image_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
 {
-    switch( pattern )
-    {
-    case by_pattern::BG:    convert_by8_to_rgb_edge<by_pattern::BG, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::GB:    convert_by8_to_rgb_edge<by_pattern::GB, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::GR:    convert_by8_to_rgb_edge<by_pattern::GR, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    case by_pattern::RG:    convert_by8_to_rgb_edge<by_pattern::RG, TOutDataType,use_mtx, avg_greenx>( ctx, lines, dim_x );    break;
-    };
+    by8_edge_line_loop( dst, src, [&]( auto pattern, const line_data& lines ) {
+        convert_by8_to_rgb_edge<decltype( pattern )::value, TRGBStr, use_mtx, use_avg_green>( ctx, lines, src.dim.cx );
+    } );
 }
 
-template<class TOutDataType>
-static void transform_line( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+template<typename TRGBStr>
+static void by_edge_image_loop( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& in_opt )
 {
-    if( ctx.use_color_matrix ) {
-        if( ctx.use_avg_green ) {
-            transform_line_<TOutDataType, true,true>( pattern, lines, dim_x, ctx );
+    const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+    if( in_opt.use_color_matrix ) {
+        if( in_opt.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, true, true>( dst, src, in_opt );
         } else  {
-            transform_line_<TOutDataType, true,false>( pattern, lines, dim_x, ctx );
+            by_edge_image_loop_<TRGBStr, true, false>( dst, src, in_opt );
         }
     } else {
-        if( ctx.use_avg_green ) {
-            transform_line_<TOutDataType, false,true>( pattern, lines, dim_x, ctx );
+        if( in_opt.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, false, true>( dst, src, in_opt );
         } else  {
-            transform_line_<TOutDataType, false,false>( pattern, lines, dim_x, ctx );
+            by_edge_image_loop_<TRGBStr, false, false>( dst, src, in_opt );
         }
     }
 }
 
-
-template<typename TRGBStr>
-static void by_edge_image_loop( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& in_opt )
-{
-    const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
-
-    const by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
-    const by_pattern pattern_nxt = img::by_transform::by_pattern_alg::next_line( pattern_cur );
-
-    const int dim_y = src.dim.cy;
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx, in_opt );
-    }
-    else {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-    int y = 1;
-    for( ; y < (dim_y - 1); y += 2 )
-    {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-        transform_line<TRGBStr>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx, in_opt );
-    }
-    else {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-}
-
 }
 
 template<class TOutDataType, bool b0, bool b1>
@@ -405,43 +405,25 @@ void	    conv_line( const alg_context& clr, const line_data& lines_, int dim_x )
     }
 }
 
-template<class TOut,bool ... TboolParams>
-void	convert_by8_to_rgb_edge_neonv7( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+template<class TOut, by_pattern pattern, bool ... TboolParams>
+void	convert_by8_to_rgb_edge_neonv7( const line_data& lines, int dim_x, const alg_context& ctx )
 {
-    if( pattern == by_pattern::BG ) {
-        conv_line<TOut, by_pattern::BG, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::GB ) {
-        conv_line<TOut, by_pattern::GB, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::GR ) {
-        conv_line<TOut, by_pattern::GR, TboolParams...>( ctx, lines, dim_x );
-    } else if( pattern == by_pattern::RG ) {
-        conv_line<TOut, by_pattern::RG, TboolParams...>( ctx, lines, dim_x );
-    }
+    conv_line<TOut, pattern, TboolParams...>( ctx, lines, dim_x );
 
     uint8_t* out_line = reinterpret_cast<uint8_t*>(lines.out_line);
     memcpy( out_line, out_line + sizeof( TOut ), sizeof( TOut ) );
 }
 
-template<class TOutDataType>
-static void transform_line( by_pattern pattern, const line_data& lines, int dim_x, const alg_context& ctx )
+// the pattern, the color matrix and the green averaging are resolved once per image
+template<typename TRGBStr, bool use_mtx, bool use_avg_green>
+static void by_edge_image_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
 {
-    if( ctx.use_color_matrix ) {
-        if( ctx.use_avg_green ) {
-            convert_by8_to_rgb_edge_neonv7<TOutDataType, true,true>( pattern, lines, dim_x, ctx );
-        } else  {
-            convert_by8_to_rgb_edge_neonv7<TOutDataType, true,false>( pattern, lines, dim_x, ctx );
-        }
-    } else {
-        if( ctx.use_avg_green ) {
-            convert_by8_to_rgb_edge_neonv7<TOutDataType, false,true>( pattern, lines, dim_x, ctx );
-        } else  {
-            convert_by8_to_rgb_edge_neonv7<TOutDataType, false,false>( pattern, lines, dim_x, ctx );
-        }
-    }
+    by8_edge_line_loop( dst, src, [&]( auto pattern, const line_data& lines ) {
+        convert_by8_to_rgb_edge_neonv7<TRGBStr, decltype( pattern )::value, use_mtx, use_avg_green>( lines, src.dim.cx, ctx );
+    } );
 }
 
 
-
 alg_context_sse     fill_context( const img_filter::transform::by_edge::options& in_opt )
 {
     auto ctx = alg_context_sse{ {}, in_opt.use_color_matrix, in_opt.use_avg_green };
@@ -458,29 +440,20 @@ static void by_edge_image_loop_neon( img::img_descriptor dst_, img::img_descript
 {
     auto dst = flip_image_in_img_desc_if_allowed( dst_ );
 
-    by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
-    by_pattern pattern_nxt = img::by_transform::by_pattern_alg::next_line( pattern_cur );
-
-    auto in_opt = fill_context( options );
-
-    int dim_y = src.dim.cy;
+    auto ctx = fill_context( options );
 
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx, in_opt );
-    } else {
-        transform_line<TRGBStr>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-    int y = 1;
-    for( ; y < (dim_y - 1); y += 2 )
-    {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx, in_opt );
-        transform_line<TRGBStr>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx, in_opt );
-    }
-
-    if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx, in_opt );
+    if( ctx.use_color_matrix ) {
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, true, true>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, true, false>( dst, src, ctx );
+        }
     } else {
-        transform_line<TRGBStr>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx, in_opt );
+        if( ctx.use_avg_green ) {
+            by_edge_image_loop_<TRGBStr, false, true>( dst, src, ctx );
+        } else  {
+            by_edge_image_loop_<TRGBStr, false, false>( dst, src, ctx );
+        }
     }
 }
 
@@ -0,0 +1,227 @@
+#include "by_edge_internal.h"
+
+#include <arm_sve.h>
+
+#include <algorithm>
+#include <cstring>
+
+/*
+ * SVE2 variant of the by8 edge debayering. Each 16-bit lane holds one pixel, so the step is the vector
+ * length of the cpu and the tail of a line is done with a predicate. The formulas are the ones of
+ * by8_pixelops.h with the same truncation, so the results match the c variant.
+ * The line is converted from pixel 1 on, the even lanes have the pattern of the odd pixels.
+ */
+
+namespace
+{
+    using namespace by_edge_internal;
+    using namespace img::by_transform::by_pattern_alg;
+
+    using alg_context = img_filter::transform::by_edge::options;
+
+    // edgesensing_aroundgreen
+    FORCEINLINE svuint16_t  calc_g_around( svbool_t pt, svuint16_t cur_l, svuint16_t cur_r, svuint16_t prv_c, svuint16_t nxt_c, svuint16_t lr, svuint16_t ob ) noexcept
+    {
+        const svuint16_t d_h = svabd_u16_x( pt, cur_l, cur_r );
+        const svuint16_t d_v = svabd_u16_x( pt, prv_c, nxt_c );
+
+        const svuint16_t sum = svadd_u16_x( pt, svadd_u16_x( pt, cur_l, cur_r ), svadd_u16_x( pt, prv_c, nxt_c ) );
+        const svuint16_t around = svlsr_n_u16_x( pt, sum, 2 );
+
+        return svsel_u16( svcmplt_u16( pt, d_h, d_v ), lr, svsel_u16( svcmpgt_u16( pt, d_h, d_v ), ob, around ) );
+    }
+
+    // edgesensing_ongreen
+    FORCEINLINE svuint16_t  calc_g_on_green( svbool_t pt, svuint16_t prv_l, svuint16_t prv_r, svuint16_t nxt_l, svuint16_t cur_c, svuint16_t diag_sum ) noexcept
+    {
+        const svuint16_t d_h = svabd_u16_x( pt, prv_l, prv_r );
+        const svuint16_t d_v = svabd_u16_x( pt, prv_l, nxt_l );
+
+        const svbool_t is_flat = svand_b_z( pt, svcmplt_n_u16( pt, d_h, 0x07 ), svcmplt_n_u16( pt, d_v, 0x07 ) );
+
+        const svuint16_t avg = svlsr_n_u16_x( pt, svadd_u16_x( pt, diag_sum, svlsl_n_u16_x( pt, cur_c, 2 ) ), 3 );
+
+        return svsel_u16( is_flat, avg, cur_c );
+    }
+
+    /*
+     * The pixels [x;x + svcnth()[ as { r, g, b }, the sve types cannot be members of a struct, so the channels are returned as a tuple.
+     * p_green selects the lanes with a green pixel, the others are red or blue depending on the line.
+     */
+    template<bool is_red_line, bool use_avg_green>
+    FORCEINLINE svuint16x3_t    calc_pixels( svbool_t pg, const line_data& lines, int x, svbool_t p_green ) noexcept
+    {
+        const svbool_t pt = svptrue_b16();
+
+        const uint8_t* prv = lines.lines[0] + x;
+        const uint8_t* cur = lines.lines[1] + x;
+        const uint8_t* nxt = lines.lines[2] + x;
+
+        const svuint16_t prv_l = svld1ub_u16( pg, prv - 1 );
+        const svuint16_t prv_c = svld1ub_u16( pg, prv );
+        const svuint16_t prv_r = svld1ub_u16( pg, prv + 1 );
+        const svuint16_t cur_l = svld1ub_u16( pg, cur - 1 );
+        const svuint16_t cur_c = svld1ub_u16( pg, cur );
+        const svuint16_t cur_r = svld1ub_u16( pg, cur + 1 );
+        const svuint16_t nxt_l = svld1ub_u16( pg, nxt - 1 );
+        const svuint16_t nxt_c = svld1ub_u16( pg, nxt );
+        const svuint16_t nxt_r = svld1ub_u16( pg, nxt + 1 );
+
+        const svuint16_t lr = svhadd_u16_x( pt, cur_l, cur_r );          // CALC_LR
+        const svuint16_t ob = svhadd_u16_x( pt, prv_c, nxt_c );          // CALC_OB
+
+        const svuint16_t diag_sum = svadd_u16_x( pt, svadd_u16_x( pt, prv_l, prv_r ), svadd_u16_x( pt, nxt_l, nxt_r ) );
+        const svuint16_t diag = svlsr_n_u16_x( pt, diag_sum, 2 );       // CALC_DIAGONAL
+
+        svuint16_t g_on_green = cur_c;
+        if constexpr( use_avg_green ) {
+            g_on_green = calc_g_on_green( pt, prv_l, prv_r, nxt_l, cur_c, diag_sum );
+        }
+        const svuint16_t g = svsel_u16( p_green, g_on_green, calc_g_around( pt, cur_l, cur_r, prv_c, nxt_c, lr, ob ) );
+
+        // the color of the line is left/right of the green pixels, the other color above/below
+        const svuint16_t x_chn = svsel_u16( p_green, lr, cur_c );
+        const svuint16_t y_chn = svsel_u16( p_green, ob, diag );
+
+        if constexpr( is_red_line ) {
+            return svcreate3_u16( x_chn, g, y_chn );
+        } else {
+            return svcreate3_u16( y_chn, g, x_chn );
+        }
+    }
+
+    // ((r * fac[0] + g * fac[1] + b * fac[2]) / 64 clipped to [0;0xFF], the bottom and top lanes are widened separately
+    FORCEINLINE svuint16_t  apply_color_matrix_chn( const int16_t* fac, svint16_t r, svint16_t g, svint16_t b ) noexcept
+    {
+        const svint32_t even = svmlalb_n_s32( svmlalb_n_s32( svmullb_n_s32( r, fac[0] ), g, fac[1] ), b, fac[2] );
+        const svint32_t odd = svmlalt_n_s32( svmlalt_n_s32( svmullt_n_s32( r, fac[0] ), g, fac[1] ), b, fac[2] );
+
+        const svuint16_t res = svqshrunt_n_s32( svqshrunb_n_s32( even, 6 ), odd, 6 );
+        return svmin_n_u16_x( svptrue_b16(), res, 0xFF );
+    }
+
+    FORCEINLINE svuint16x3_t    apply_color_matrix( const img::color_matrix_int& mtx, svuint16x3_t px ) noexcept
+    {
+        const svint16_t r = svreinterpret_s16_u16( svget3_u16( px, 0 ) );
+        const svint16_t g = svreinterpret_s16_u16( svget3_u16( px, 1 ) );
+        const svint16_t b = svreinterpret_s16_u16( svget3_u16( px, 2 ) );
+
+        return svcreate3_u16(
+            apply_color_matrix_chn( mtx.fac_3x3[0], r, g, b ),
+            apply_color_matrix_chn( mtx.fac_3x3[1], r, g, b ),
+            apply_color_matrix_chn( mtx.fac_3x3[2], r, g, b )
+        );
+    }
+
+    template<class TOutStruct>
+    void    store( svbool_t pg, const line_data& lines, int x, int count, svuint16x3_t px ) = delete;
+
+    // the low and the high word of each BGRA32 pixel are interleaved by the structure store
+    template<>
+    FORCEINLINE void    store<BGRA32>( svbool_t pg, const line_data& lines, int x, int /*count*/, svuint16x3_t px )
+    {
+        const svbool_t pt = svptrue_b16();
+
+        const svuint16_t bg = svorr_u16_x( pt, svget3_u16( px, 2 ), svlsl_n_u16_x( pt, svget3_u16( px, 1 ), 8 ) );
+        const svuint16_t ra = svorr_n_u16_x( pt, svget3_u16( px, 0 ), 0xFF00 );
+
+        auto* out_line = static_cast<uint16_t*>( lines.out_line ) + x * 2;
+        svst2_u16( pg, out_line, svcreate2_u16( bg, ra ) );
+    }
+
+    // the pixels are narrowed into the low half of the byte vectors, count are stored
+    FORCEINLINE svuint8_t   narrow_to_low_half( svuint16_t v ) noexcept
+    {
+        return svuzp1_u8( svreinterpret_u8_u16( v ), svreinterpret_u8_u16( v ) );
+    }
+
+    template<>
+    FORCEINLINE void    store<BGR24>( svbool_t /*pg*/, const line_data& lines, int x, int count, svuint16x3_t px )
+    {
+        const svbool_t pg_u8 = svwhilelt_b8( 0, count );
+
+        const svuint8_t r = narrow_to_low_half( svget3_u16( px, 0 ) );
+        const svuint8_t g = narrow_to_low_half( svget3_u16( px, 1 ) );
+        const svuint8_t b = narrow_to_low_half( svget3_u16( px, 2 ) );
+
+        auto* out_line = static_cast<uint8_t*>( lines.out_line ) + x * sizeof( BGR24 );
+        svst3_u8( pg_u8, out_line, svcreate3_u8( b, g, r ) );
+    }
+
+    template<class TOut, by_pattern pattern, bool use_mtx, bool use_avg_green>
+    void    convert_by8_to_rgb_edge_sve2( const alg_context& ctx, const line_data& lines, int dim_x )
+    {
+        constexpr auto lane_even_pattern = next_pixel( pattern );
+        constexpr bool lane_even_is_green = lane_even_pattern == by_pattern::GR || lane_even_pattern == by_pattern::GB;
+
+        const svbool_t pt = svptrue_b16();
+        const svbool_t p_even = svtrn1_b16( pt, svpfalse_b() );
+        const svbool_t p_green = lane_even_is_green ? p_even : svnot_b_z( pt, p_even );
+
+        const int step = static_cast<int>( svcnth() );
+        const int x_end = dim_x - 1;
+        for( int x = 1; x < x_end; x += step )
+        {
+            const svbool_t pg = svwhilelt_b16( x, x_end );
+
+            svuint16x3_t px = calc_pixels<is_red_line( pattern ), use_avg_green>( pg, lines, x, p_green );
+            if constexpr( use_mtx ) {
+                px = apply_color_matrix( ctx.color_mtx, px );
+            }
+            store<TOut>( pg, lines, x, std::min( step, x_end - x ), px );
+        }
+
+        // the first and the last pixel are copies of their neighbours, like in the c variant
+        auto* out_line = static_cast<uint8_t*>( lines.out_line );
+        memcpy( out_line, out_line + sizeof( TOut ), sizeof( TOut ) );
+        memcpy( out_line + (dim_x - 1) * sizeof( TOut ), out_line + (dim_x - 2) * sizeof( TOut ), sizeof( TOut ) );
+    }
+
+    // the pattern, the color matrix and the green averaging are resolved once per image
+    template<typename TRGBStr, bool use_mtx, bool use_avg_green>
+    static void by_edge_image_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, const alg_context& ctx )
+    {
+        by8_edge_line_loop( dst, src, [&]( auto pattern, const line_data& lines ) {
+            convert_by8_to_rgb_edge_sve2<TRGBStr, decltype( pattern )::value, use_mtx, use_avg_green>( ctx, lines, src.dim.cx );
+        } );
+    }
+
+    template<typename TRGBStr>
+    static void by_edge_image_loop_sve2( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& in_opt )
+    {
+        const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+        if( in_opt.use_color_matrix ) {
+            if( in_opt.use_avg_green ) {
+                by_edge_image_loop_<TRGBStr, true, true>( dst, src, in_opt );
+            } else  {
+                by_edge_image_loop_<TRGBStr, true, false>( dst, src, in_opt );
+            }
+        } else {
+            if( in_opt.use_avg_green ) {
+                by_edge_image_loop_<TRGBStr, false, true>( dst, src, in_opt );
+            } else  {
+                by_edge_image_loop_<TRGBStr, false, false>( dst, src, in_opt );
+            }
+        }
+    }
+}
+
+// dim.cx must be even, the border pixels are copied like in the c variant, which also relies on that
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_by8_to_dst_sve2( img::img_type dst, img::img_type src )
+{
+    if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx < 4 || dst.dim.cy < 2 || (dst.dim.cx % 2) != 0 ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGRA32: return &by_edge_image_loop_sve2<BGRA32>;
+    case img::fourcc::BGR24: return &by_edge_image_loop_sve2<BGR24>;
+    default:
+        return nullptr;
+    };
+}
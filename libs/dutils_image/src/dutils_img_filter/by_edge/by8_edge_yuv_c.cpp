@@ -0,0 +1,32 @@
+#include "by8_yuv_internal.h"
+
+namespace
+{
+    using namespace by8_yuv_internal;
+
+    template<img::fourcc dst_fcc>
+    void    by8_to_yuv_c( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::by_edge::yuv_options& opt )
+    {
+        by8_to_yuv_image_loop( dst, src, opt,
+            []( const img::img_descriptor& d, int y, const BGRA32* line0, const BGRA32* line1, int dim_x, const yuv_coeffs& c )
+            {
+                convert_line_pair_c<dst_fcc>( d, y, line0, line1, 0, dim_x, c );
+            } );
+    }
+}
+
+img_filter::transform::by_edge::yuv_function_type   img_filter::transform::by_edge::get_transform_by8_to_yuv_c( img::img_type dst, img::img_type src )
+{
+    if( !by8_yuv_internal::can_transform_by8_to_yuv( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::NV12:     return &by8_to_yuv_c<img::fourcc::NV12>;
+    case img::fourcc::I420:     return &by8_to_yuv_c<img::fourcc::I420>;
+    case img::fourcc::YUY2:     return &by8_to_yuv_c<img::fourcc::YUY2>;
+    default:
+        return nullptr;
+    }
+}
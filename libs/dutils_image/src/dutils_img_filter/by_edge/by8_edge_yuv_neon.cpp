@@ -0,0 +1,137 @@
+
+#include "../simd_helper/use_simd_A64.h"
+
+#include "by8_yuv_internal.h"
+
+/*
+ * 16 pixels of a line pair per step. The de-interleaving loads split the b, g, r channels,
+ * horizontal pixel pairs for the chroma are summed with pairwise adds.
+ */
+
+namespace
+{
+    using namespace by8_yuv_internal;
+
+    constexpr int pixels_per_step = 16;
+
+    FORCEINLINE int16x4_t   as_s16( uint16x4_t v ) noexcept
+    {
+        return vreinterpret_s16_u16( v );
+    }
+
+    FORCEINLINE int32x4_t   dot_4px( uint16x4_t b, uint16x4_t g, uint16x4_t r, const int16_t (&c)[3] ) noexcept
+    {
+        int32x4_t sum = vmull_n_s16( as_s16( b ), c[0] );
+        sum = vmlal_n_s16( sum, as_s16( g ), c[1] );
+        return vmlal_n_s16( sum, as_s16( r ), c[2] );
+    }
+
+    FORCEINLINE uint8x8_t   calc_y_8px( uint8x8_t b8, uint8x8_t g8, uint8x8_t r8, const yuv_coeffs& c ) noexcept
+    {
+        const uint16x8_t b = vmovl_u8( b8 );
+        const uint16x8_t g = vmovl_u8( g8 );
+        const uint16x8_t r = vmovl_u8( r8 );
+
+        const int32x4_t lo = dot_4px( vget_low_u16( b ), vget_low_u16( g ), vget_low_u16( r ), c.y );
+        const int32x4_t hi = dot_4px( vget_high_u16( b ), vget_high_u16( g ), vget_high_u16( r ), c.y );
+
+        const uint16x8_t y = vcombine_u16( vqrshrun_n_s32( lo, coeff_shift ), vqrshrun_n_s32( hi, coeff_shift ) );
+        return vqmovn_u16( vaddq_u16( y, vdupq_n_u16( static_cast<uint16_t>( c.y_offset ) ) ) );
+    }
+
+    FORCEINLINE uint8x16_t  calc_y_16px( const uint8x16x4_t& px, const yuv_coeffs& c ) noexcept
+    {
+        return vcombine_u8( calc_y_8px( vget_low_u8( px.val[0] ), vget_low_u8( px.val[1] ), vget_low_u8( px.val[2] ), c ),
+                            calc_y_8px( vget_high_u8( px.val[0] ), vget_high_u8( px.val[1] ), vget_high_u8( px.val[2] ), c ) );
+    }
+
+    // b, g, r are the sums of 1 << count_log2 pixels
+    template<int count_log2>
+    FORCEINLINE uint8x8_t   calc_chroma_8( uint16x8_t b, uint16x8_t g, uint16x8_t r, const int16_t (&c)[3] ) noexcept
+    {
+        const int32x4_t lo = vrshrq_n_s32( dot_4px( vget_low_u16( b ), vget_low_u16( g ), vget_low_u16( r ), c ), coeff_shift + count_log2 );
+        const int32x4_t hi = vrshrq_n_s32( dot_4px( vget_high_u16( b ), vget_high_u16( g ), vget_high_u16( r ), c ), coeff_shift + count_log2 );
+
+        const int16x8_t v = vcombine_s16( vmovn_s32( lo ), vmovn_s32( hi ) );
+        return vqmovun_s16( vaddq_s16( v, vdupq_n_s16( 128 ) ) );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    convert_line_pair_neon( const img::img_descriptor& dst, int y, const BGRA32* line0, const BGRA32* line1, int dim_x, const yuv_coeffs& c )
+    {
+        int x = 0;
+        if constexpr( dst_fcc == img::fourcc::YUY2 )
+        {
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                for( int i = 0; i < 2; ++i )
+                {
+                    const uint8x16x4_t px = vld4q_u8( reinterpret_cast<const uint8_t*>( (i == 0 ? line0 : line1) + x ) );
+
+                    const uint8x16_t y16 = calc_y_16px( px, c );
+                    const uint8x8x2_t y_eo = vuzp_u8( vget_low_u8( y16 ), vget_high_u8( y16 ) );
+
+                    const uint16x8_t b = vpaddlq_u8( px.val[0] );
+                    const uint16x8_t g = vpaddlq_u8( px.val[1] );
+                    const uint16x8_t r = vpaddlq_u8( px.val[2] );
+
+                    const uint8x8x4_t res = { { y_eo.val[0], calc_chroma_8<1>( b, g, r, c.u ), y_eo.val[1], calc_chroma_8<1>( b, g, r, c.v ) } };
+                    vst4_u8( img::get_line_start( dst, y + i ) + x * 2, res );
+                }
+            }
+        }
+        else
+        {
+            uint8_t* y0 = img::get_line_start_of_plane( dst, y + 0, 0 );
+            uint8_t* y1 = img::get_line_start_of_plane( dst, y + 1, 0 );
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                const uint8x16x4_t px0 = vld4q_u8( reinterpret_cast<const uint8_t*>( line0 + x ) );
+                const uint8x16x4_t px1 = vld4q_u8( reinterpret_cast<const uint8_t*>( line1 + x ) );
+
+                vst1q_u8( y0 + x, calc_y_16px( px0, c ) );
+                vst1q_u8( y1 + x, calc_y_16px( px1, c ) );
+
+                const uint16x8_t b = vaddq_u16( vpaddlq_u8( px0.val[0] ), vpaddlq_u8( px1.val[0] ) );
+                const uint16x8_t g = vaddq_u16( vpaddlq_u8( px0.val[1] ), vpaddlq_u8( px1.val[1] ) );
+                const uint16x8_t r = vaddq_u16( vpaddlq_u8( px0.val[2] ), vpaddlq_u8( px1.val[2] ) );
+
+                const uint8x8_t u = calc_chroma_8<2>( b, g, r, c.u );
+                const uint8x8_t v = calc_chroma_8<2>( b, g, r, c.v );
+
+                if constexpr( dst_fcc == img::fourcc::NV12 )
+                {
+                    vst2_u8( img::get_line_start_of_plane( dst, y / 2, 1 ) + x, uint8x8x2_t{ { u, v } } );
+                }
+                else // I420
+                {
+                    vst1_u8( img::get_line_start_of_plane( dst, y / 2, 1 ) + x / 2, u );
+                    vst1_u8( img::get_line_start_of_plane( dst, y / 2, 2 ) + x / 2, v );
+                }
+            }
+        }
+        convert_line_pair_c<dst_fcc>( dst, y, line0, line1, x, dim_x, c );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    by8_to_yuv_neon( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::by_edge::yuv_options& opt )
+    {
+        by8_to_yuv_image_loop( dst, src, opt, &convert_line_pair_neon<dst_fcc> );
+    }
+}
+
+img_filter::transform::by_edge::yuv_function_type   img_filter::transform::by_edge::get_transform_by8_to_yuv_neon( img::img_type dst, img::img_type src )
+{
+    if( !by8_yuv_internal::can_transform_by8_to_yuv( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::NV12:     return &by8_to_yuv_neon<img::fourcc::NV12>;
+    case img::fourcc::I420:     return &by8_to_yuv_neon<img::fourcc::I420>;
+    case img::fourcc::YUY2:     return &by8_to_yuv_neon<img::fourcc::YUY2>;
+    default:
+        return nullptr;
+    }
+}
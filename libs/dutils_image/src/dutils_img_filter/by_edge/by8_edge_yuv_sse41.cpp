@@ -0,0 +1,170 @@
+
+#include "../simd_helper/use_simd_sse41.h"
+
+#include "by8_yuv_internal.h"
+
+#include <cstring>
+
+/*
+ * 8 pixels of a line pair per step. The pixels are widened to 16 bit bgra, so madd + hadd
+ * calculates the dot product with the b, g, r factors for each pixel (the alpha factor is 0).
+ */
+
+namespace
+{
+    using namespace by8_yuv_internal;
+
+    constexpr int pixels_per_step = 8;
+
+    // 8 BGRA32 pixels widened to 16 bit, 2 pixels per register
+    struct bgra16_8px
+    {
+        __m128i v[4];
+    };
+
+    FORCEINLINE bgra16_8px  load_8px( const BGRA32* line, int x ) noexcept
+    {
+        const __m128i p0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( line + x + 0 ) );
+        const __m128i p1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( line + x + 4 ) );
+        const __m128i zero = _mm_setzero_si128();
+        return { { _mm_unpacklo_epi8( p0, zero ), _mm_unpackhi_epi8( p0, zero ), _mm_unpacklo_epi8( p1, zero ), _mm_unpackhi_epi8( p1, zero ) } };
+    }
+
+    FORCEINLINE __m128i     make_coeff_reg( const int16_t (&c)[3] ) noexcept
+    {
+        return _mm_setr_epi16( c[0], c[1], c[2], 0, c[0], c[1], c[2], 0 );
+    }
+
+    // 4 32-bit results for the 4 pixels in v0 and v1
+    template<int shift>
+    FORCEINLINE __m128i     dot_4px( __m128i v0, __m128i v1, __m128i coeff, __m128i offset ) noexcept
+    {
+        const __m128i sum = _mm_hadd_epi32( _mm_madd_epi16( v0, coeff ), _mm_madd_epi16( v1, coeff ) );
+        return _mm_srai_epi32( _mm_add_epi32( sum, offset ), shift );
+    }
+
+    // 8 16-bit luma values
+    FORCEINLINE __m128i     calc_y_8px( const bgra16_8px& px, __m128i coeff, __m128i offset ) noexcept
+    {
+        return _mm_packs_epi32( dot_4px<coeff_shift>( px.v[0], px.v[1], coeff, offset ), dot_4px<coeff_shift>( px.v[2], px.v[3], coeff, offset ) );
+    }
+
+    // sums of the horizontal pixel pairs in v0 and v1
+    FORCEINLINE __m128i     pair_sums( __m128i v0, __m128i v1 ) noexcept
+    {
+        return _mm_unpacklo_epi64( _mm_add_epi16( v0, _mm_srli_si128( v0, 8 ) ), _mm_add_epi16( v1, _mm_srli_si128( v1, 8 ) ) );
+    }
+
+    // interleaves the 4 u and v values to 8 16-bit values u0 v0 u1 v1 ..
+    FORCEINLINE __m128i     interleave_uv( __m128i u, __m128i v ) noexcept
+    {
+        return _mm_packs_epi32( _mm_unpacklo_epi32( u, v ), _mm_unpackhi_epi32( u, v ) );
+    }
+
+    struct coeff_regs
+    {
+        __m128i y, u, v;
+        __m128i y_offset;
+        __m128i uv_offset;
+    };
+
+    template<int count_log2>
+    coeff_regs  make_coeff_regs( const yuv_coeffs& c ) noexcept
+    {
+        constexpr int chroma_shift = coeff_shift + count_log2;
+        return {
+            make_coeff_reg( c.y ), make_coeff_reg( c.u ), make_coeff_reg( c.v ),
+            _mm_set1_epi32( (c.y_offset << coeff_shift) + (1 << (coeff_shift - 1)) ),
+            _mm_set1_epi32( (128 << chroma_shift) + (1 << (chroma_shift - 1)) ),
+        };
+    }
+
+    template<img::fourcc dst_fcc>
+    void    convert_line_pair_sse41( const img::img_descriptor& dst, int y, const BGRA32* line0, const BGRA32* line1, int dim_x, const yuv_coeffs& c )
+    {
+        int x = 0;
+        if constexpr( dst_fcc == img::fourcc::YUY2 )
+        {
+            constexpr int chroma_shift = coeff_shift + 1;
+            const auto regs = make_coeff_regs<1>( c );
+
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                for( int i = 0; i < 2; ++i )
+                {
+                    const auto px = load_8px( i == 0 ? line0 : line1, x );
+
+                    const __m128i y16 = calc_y_8px( px, regs.y, regs.y_offset );
+
+                    const __m128i s01 = pair_sums( px.v[0], px.v[1] );
+                    const __m128i s23 = pair_sums( px.v[2], px.v[3] );
+                    const __m128i u = dot_4px<chroma_shift>( s01, s23, regs.u, regs.uv_offset );
+                    const __m128i v = dot_4px<chroma_shift>( s01, s23, regs.v, regs.uv_offset );
+                    const __m128i uv16 = interleave_uv( u, v );
+
+                    const __m128i res = _mm_packus_epi16( _mm_unpacklo_epi16( y16, uv16 ), _mm_unpackhi_epi16( y16, uv16 ) );
+                    _mm_storeu_si128( reinterpret_cast<__m128i*>( img::get_line_start( dst, y + i ) + x * 2 ), res );
+                }
+            }
+        }
+        else
+        {
+            constexpr int chroma_shift = coeff_shift + 2;
+            const auto regs = make_coeff_regs<2>( c );
+
+            uint8_t* y0 = img::get_line_start_of_plane( dst, y + 0, 0 );
+            uint8_t* y1 = img::get_line_start_of_plane( dst, y + 1, 0 );
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                const auto px0 = load_8px( line0, x );
+                const auto px1 = load_8px( line1, x );
+
+                const __m128i y16 = _mm_packus_epi16( calc_y_8px( px0, regs.y, regs.y_offset ), calc_y_8px( px1, regs.y, regs.y_offset ) );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( y0 + x ), y16 );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( y1 + x ), _mm_unpackhi_epi64( y16, y16 ) );
+
+                const __m128i s01 = pair_sums( _mm_add_epi16( px0.v[0], px1.v[0] ), _mm_add_epi16( px0.v[1], px1.v[1] ) );
+                const __m128i s23 = pair_sums( _mm_add_epi16( px0.v[2], px1.v[2] ), _mm_add_epi16( px0.v[3], px1.v[3] ) );
+                const __m128i u = dot_4px<chroma_shift>( s01, s23, regs.u, regs.uv_offset );
+                const __m128i v = dot_4px<chroma_shift>( s01, s23, regs.v, regs.uv_offset );
+
+                if constexpr( dst_fcc == img::fourcc::NV12 )
+                {
+                    const __m128i uv = _mm_packus_epi16( interleave_uv( u, v ), _mm_setzero_si128() );
+                    _mm_storel_epi64( reinterpret_cast<__m128i*>( img::get_line_start_of_plane( dst, y / 2, 1 ) + x ), uv );
+                }
+                else // I420
+                {
+                    const __m128i uv = _mm_packus_epi16( _mm_packs_epi32( u, v ), _mm_setzero_si128() );
+                    const int32_t u4 = _mm_cvtsi128_si32( uv );
+                    const int32_t v4 = _mm_extract_epi32( uv, 1 );
+                    memcpy( img::get_line_start_of_plane( dst, y / 2, 1 ) + x / 2, &u4, 4 );
+                    memcpy( img::get_line_start_of_plane( dst, y / 2, 2 ) + x / 2, &v4, 4 );
+                }
+            }
+        }
+        convert_line_pair_c<dst_fcc>( dst, y, line0, line1, x, dim_x, c );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    by8_to_yuv_sse41( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::by_edge::yuv_options& opt )
+    {
+        by8_to_yuv_image_loop( dst, src, opt, &convert_line_pair_sse41<dst_fcc> );
+    }
+}
+
+img_filter::transform::by_edge::yuv_function_type   img_filter::transform::by_edge::get_transform_by8_to_yuv_sse41( img::img_type dst, img::img_type src )
+{
+    if( !by8_yuv_internal::can_transform_by8_to_yuv( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::NV12:     return &by8_to_yuv_sse41<img::fourcc::NV12>;
+    case img::fourcc::I420:     return &by8_to_yuv_sse41<img::fourcc::I420>;
+    case img::fourcc::YUY2:     return &by8_to_yuv_sse41<img::fourcc::YUY2>;
+    default:
+        return nullptr;
+    }
+}
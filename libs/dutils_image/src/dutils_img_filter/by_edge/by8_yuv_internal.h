@@ -0,0 +1,209 @@
+#pragma once
+
+#include "by_edge.h"
+
+#include <dutils_img/pixel_structs.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+ * bayer8 -> NV12/I420/YUY2 in one pass over the image.
+ *
+ * The bayer8 image is debayered in tiles of tile_lines lines into a small BGRA32 buffer with the
+ * by8_to_bgra kernel of the options, the yuv lines are then converted from that buffer while it is still in the cache.
+ * The simd variants only provide the conversion of line pairs, the borders are done by the c code in this file.
+ */
+
+namespace by8_yuv_internal
+{
+    using img::pixel_type::BGRA32;
+
+    // lines per tile, a 4096 pixel wide BGRA32 tile fits into L2
+    constexpr int tile_lines = 16;
+
+    constexpr int coeff_shift = 15;
+
+    // fixed point factors in b, g, r order, scaled by 1 << coeff_shift
+    struct yuv_coeffs
+    {
+        int16_t y[3];
+        int16_t u[3];
+        int16_t v[3];
+
+        int     y_offset;   // 16 for limited range, 0 for full range
+    };
+
+    inline yuv_coeffs  calc_yuv_coeffs( const img_filter::transform::by_edge::yuv_colorimetry& clr ) noexcept
+    {
+        using matrix_type = img_filter::transform::by_edge::yuv_colorimetry::matrix_type;
+
+        const double kr = clr.matrix == matrix_type::bt709 ? 0.2126 : 0.299;
+        const double kb = clr.matrix == matrix_type::bt709 ? 0.0722 : 0.114;
+        const double kg = 1.0 - kr - kb;
+
+        const double y_scale = clr.full_range ? 1.0 : 219.0 / 255.0;
+        const double uv_scale = clr.full_range ? 1.0 : 224.0 / 255.0;
+
+        const auto fix = []( double v ) { return static_cast<int16_t>( v * (1 << coeff_shift) + (v < 0 ? -0.5 : 0.5) ); };
+
+        const double u_b = 0.5 * uv_scale;
+        const double u_r = -kr / (1.0 - kb) * 0.5 * uv_scale;
+        const double v_r = 0.5 * uv_scale;
+        const double v_b = -kb / (1.0 - kr) * 0.5 * uv_scale;
+
+        yuv_coeffs res = {};
+        res.y[0] = fix( kb * y_scale );
+        res.y[1] = fix( kg * y_scale );
+        res.y[2] = fix( kr * y_scale );
+        res.u[0] = fix( u_b );
+        res.u[2] = fix( u_r );
+        res.u[1] = static_cast<int16_t>( -res.u[0] - res.u[2] );  // rows sum to 0, so gray stays at 128
+        res.v[2] = fix( v_r );
+        res.v[0] = fix( v_b );
+        res.v[1] = static_cast<int16_t>( -res.v[0] - res.v[2] );
+        res.y_offset = clr.full_range ? 0 : 16;
+        return res;
+    }
+
+    FORCEINLINE uint8_t    clip_u8( int v ) noexcept
+    {
+        return static_cast<uint8_t>( std::clamp( v, 0, 0xFF ) );
+    }
+
+    FORCEINLINE uint8_t    calc_y( const yuv_coeffs& c, BGRA32 px ) noexcept
+    {
+        const int sum = c.y[0] * px.b + c.y[1] * px.g + c.y[2] * px.r;
+        return clip_u8( ((sum + (1 << (coeff_shift - 1))) >> coeff_shift) + c.y_offset );
+    }
+
+    // b, g, r are the sums of count_log2 ^ 2 pixels
+    template<int count_log2>
+    FORCEINLINE uint8_t    calc_chroma( const int16_t (&c)[3], int b, int g, int r ) noexcept
+    {
+        constexpr int shift = coeff_shift + count_log2;
+
+        const int sum = c[0] * b + c[1] * g + c[2] * r;
+        return clip_u8( ((sum + (1 << (shift - 1))) >> shift) + 128 );
+    }
+
+    /*
+     * Converts the pixels [x;dim_x) of the bgra lines y and y + 1 (y is even) into dst.
+     * For YUY2 both lines keep their own chroma.
+     */
+    template<img::fourcc dst_fcc>
+    void    convert_line_pair_c( const img::img_descriptor& dst, int y, const BGRA32* line0, const BGRA32* line1, int x, int dim_x, const yuv_coeffs& c ) noexcept
+    {
+        if constexpr( dst_fcc == img::fourcc::YUY2 )
+        {
+            uint8_t* out0 = img::get_line_start( dst, y + 0 );
+            uint8_t* out1 = img::get_line_start( dst, y + 1 );
+            for( ; x < dim_x; x += 2 )
+            {
+                const BGRA32 p0 = line0[x], p1 = line0[x + 1];
+                out0[x * 2 + 0] = calc_y( c, p0 );
+                out0[x * 2 + 1] = calc_chroma<1>( c.u, p0.b + p1.b, p0.g + p1.g, p0.r + p1.r );
+                out0[x * 2 + 2] = calc_y( c, p1 );
+                out0[x * 2 + 3] = calc_chroma<1>( c.v, p0.b + p1.b, p0.g + p1.g, p0.r + p1.r );
+
+                const BGRA32 q0 = line1[x], q1 = line1[x + 1];
+                out1[x * 2 + 0] = calc_y( c, q0 );
+                out1[x * 2 + 1] = calc_chroma<1>( c.u, q0.b + q1.b, q0.g + q1.g, q0.r + q1.r );
+                out1[x * 2 + 2] = calc_y( c, q1 );
+                out1[x * 2 + 3] = calc_chroma<1>( c.v, q0.b + q1.b, q0.g + q1.g, q0.r + q1.r );
+            }
+        }
+        else
+        {
+            uint8_t* y0 = img::get_line_start_of_plane( dst, y + 0, 0 );
+            uint8_t* y1 = img::get_line_start_of_plane( dst, y + 1, 0 );
+            for( ; x < dim_x; x += 2 )
+            {
+                const BGRA32 p0 = line0[x], p1 = line0[x + 1];
+                const BGRA32 q0 = line1[x], q1 = line1[x + 1];
+
+                y0[x + 0] = calc_y( c, p0 );
+                y0[x + 1] = calc_y( c, p1 );
+                y1[x + 0] = calc_y( c, q0 );
+                y1[x + 1] = calc_y( c, q1 );
+
+                const int b = p0.b + p1.b + q0.b + q1.b;
+                const int g = p0.g + p1.g + q0.g + q1.g;
+                const int r = p0.r + p1.r + q0.r + q1.r;
+
+                if constexpr( dst_fcc == img::fourcc::NV12 )
+                {
+                    uint8_t* uv = img::get_line_start_of_plane( dst, y / 2, 1 );
+                    uv[x + 0] = calc_chroma<2>( c.u, b, g, r );
+                    uv[x + 1] = calc_chroma<2>( c.v, b, g, r );
+                }
+                else // I420
+                {
+                    img::get_line_start_of_plane( dst, y / 2, 1 )[x / 2] = calc_chroma<2>( c.u, b, g, r );
+                    img::get_line_start_of_plane( dst, y / 2, 2 )[x / 2] = calc_chroma<2>( c.v, b, g, r );
+                }
+            }
+        }
+    }
+
+    constexpr bool  can_transform_by8_to_yuv( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_by8_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+            return false;
+        }
+        if( dst.dim.cx < 4 || dst.dim.cy < 2 || (dst.dim.cx % 2) != 0 || (dst.dim.cy % 2) != 0 ) {
+            return false;
+        }
+        return img::is_fcc_in_fcclist( dst, { img::fourcc::NV12, img::fourcc::I420, img::fourcc::YUY2 } );
+    }
+
+    /*
+     * TConvLinePair is called as func( dst, y, line0, line1, dim_x, coeffs ) for every pair of lines.
+     * The src flags flags_no_wrap_beg/flags_no_wrap_end are honored, so this can run on strips.
+     */
+    template<class TConvLinePair>
+    void    by8_to_yuv_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::by_edge::yuv_options& opt, TConvLinePair conv_line_pair )
+    {
+        const yuv_coeffs coeffs = calc_yuv_coeffs( opt.colorimetry );
+
+        const int dim_x = src.dim.cx;
+        const int dim_y = src.dim.cy;
+
+        thread_local std::vector<uint8_t> tile_buffer;
+
+        const auto bgra_type = img::make_img_type( img::fourcc::BGRA32, { dim_x, tile_lines } );
+        if( tile_buffer.size() < static_cast<size_t>( bgra_type.buffer_length ) ) {
+            tile_buffer.resize( bgra_type.buffer_length );
+        }
+
+        for( int y_begin = 0; y_begin < dim_y; y_begin += tile_lines )
+        {
+            const int y_end = std::min( y_begin + tile_lines, dim_y );
+
+            auto src_tile = src;
+            src_tile.data_.planes[0].plane_ptr = img::get_line_start( src, y_begin );
+            src_tile.dim.cy = y_end - y_begin;
+            src_tile.data_length = src.pitch() * src_tile.dim.cy;
+            if( y_begin > 0 ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_beg;
+            }
+            if( y_end < dim_y ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_end;
+            }
+
+            auto bgra_tile = img::make_img_desc_from_linear_memory( img::make_img_type( img::fourcc::BGRA32, src_tile.dim ), tile_buffer.data() );
+            bgra_tile.flags |= img::img_descriptor::flags_no_flip;
+
+            opt.by8_to_bgra( bgra_tile, src_tile, opt.by8_opt );
+
+            for( int y = y_begin; y < y_end; y += 2 )
+            {
+                conv_line_pair( dst, y,
+                                img::get_line_start<const BGRA32>( bgra_tile, y - y_begin + 0 ),
+                                img::get_line_start<const BGRA32>( bgra_tile, y - y_begin + 1 ),
+                                dim_x, coeffs );
+            }
+        }
+    }
+}
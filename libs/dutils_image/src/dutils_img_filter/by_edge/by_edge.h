@@ -23,7 +23,51 @@ namespace by_edge
     function_type	get_transform_by8_to_dst_ssse3( img::img_type dst, img::img_type src );
     function_type	get_transform_by8_to_dst_sse41( img::img_type dst, img::img_type src );
     function_type	get_transform_by8_to_dst_avx2( img::img_type dst, img::img_type src );
+    function_type	get_transform_by8_to_dst_avx512bw( img::img_type dst, img::img_type src );
     function_type	get_transform_by8_to_dst_neon( img::img_type dst, img::img_type src );
+    function_type	get_transform_by8_to_dst_sve2( img::img_type dst, img::img_type src );     // check for CPU_ARM_SVE2
+
+    // float bayer to BGRFloat, in_opt is not used
+    function_type	get_transform_byfloat_to_bgrfloat_c( img::img_type dst, img::img_type src );
+    function_type	get_transform_byfloat_to_bgrfloat_avx2( img::img_type dst, img::img_type src );
+    function_type	get_transform_byfloat_to_bgrfloat_neon( img::img_type dst, img::img_type src );
+
+    // bayer16 to BGRA64, in_opt is not used
+    function_type	get_transform_by16_to_bgra64_c( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_bgra64_sse41( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_bgra64_avx2( img::img_type dst, img::img_type src );
+    function_type	get_transform_by16_to_bgra64_neon( img::img_type dst, img::img_type src );
+
+    struct yuv_colorimetry
+    {
+        enum class matrix_type { bt601, bt709 };
+
+        matrix_type     matrix = matrix_type::bt601;
+        bool            full_range = false;
+    };
+
+    struct yuv_options
+    {
+        yuv_colorimetry     colorimetry;
+
+        // debayers the bayer8 lines to BGRA32 before the yuv conversion, one of the get_transform_by8_to_dst_* kernels
+        function_type       by8_to_bgra = nullptr;
+        options             by8_opt = { {}, false, false };
+
+        // debayers the float bayer lines to BGRFloat before the planar yuv conversion, one of the get_transform_byfloat_to_bgrfloat_* kernels
+        function_type       byfloat_to_bgrfloat = nullptr;
+    };
+
+    using yuv_function_type = void (*)( img::img_descriptor dst, img::img_descriptor src, const yuv_options& in_opt );
+
+    // bayer8 to NV12, I420 or YUY2, dst and src must have even dimensions
+    yuv_function_type	get_transform_by8_to_yuv_c( img::img_type dst, img::img_type src );
+    yuv_function_type	get_transform_by8_to_yuv_sse41( img::img_type dst, img::img_type src );
+    yuv_function_type	get_transform_by8_to_yuv_neon( img::img_type dst, img::img_type src );
+
+    // float bayer to YUV8PLANAR, YUV16PLANAR or YUVF32PLANAR (4:4:4), dst and src must have even dimensions, the float planes are not clipped
+    yuv_function_type	get_transform_byfloat_to_yuv_planar_c( img::img_type dst, img::img_type src );
+    yuv_function_type	get_transform_byfloat_to_yuv_planar_avx2( img::img_type dst, img::img_type src );
 }
 }
 }
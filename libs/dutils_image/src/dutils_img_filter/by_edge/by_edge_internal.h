@@ -6,6 +6,8 @@
 #include <dutils_img/pixel_structs.h>
 #include <dutils_img/image_bayer_pattern.h>
 
+#include <type_traits>
+
 namespace by_edge_internal
 {
     using img::pixel_type::BGRA32;
@@ -41,6 +43,52 @@ namespace by_edge_internal
         return pat == by_pattern::GR || pat == by_pattern::GB;
     }
 
+    template<by_pattern pattern>
+    using pattern_tag = std::integral_constant<by_pattern, pattern>;
+
+    template<by_pattern pattern_cur, class TConvLine>
+    void    by8_edge_line_loop_( const img::img_descriptor& dst, const img::img_descriptor& src, TConvLine& conv_line )
+    {
+        constexpr auto pattern_nxt = by_pattern_alg::next_line( pattern_cur );
+
+        const int dim_y = src.dim.cy;
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
+            conv_line( pattern_tag<pattern_cur>{}, init_src_param( 0, dst, src, +1, +1 ) );
+        } else {
+            conv_line( pattern_tag<pattern_cur>{}, init_src_param( 0, dst, src, -1, +1 ) );
+        }
+        int y = 1;
+        for( ; y < (dim_y - 1); y += 2 )
+        {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y + 0, dst, src, -1, +1 ) );
+            conv_line( pattern_tag<pattern_cur>{}, init_src_param( y + 1, dst, src, -1, +1 ) );
+        }
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y, dst, src, -1, -1 ) );
+        } else {
+            conv_line( pattern_tag<pattern_nxt>{}, init_src_param( y, dst, src, -1, +1 ) );
+        }
+    }
+
+    /*
+     * The line loop of the by8 edge kernels. The pattern of src is resolved once per image, so every
+     * (pattern, output) pair gets its own loop and the lines are converted without a dispatch.
+     * conv_line is called as conv_line( pattern_tag<line_pattern>{}, line_data ) for every line.
+     */
+    template<class TConvLine>
+    void    by8_edge_line_loop( const img::img_descriptor& dst, const img::img_descriptor& src, TConvLine conv_line )
+    {
+        switch( convert_bayer_fcc_to_pattern( src.fourcc_type() ) )
+        {
+        case by_pattern::BG:    by8_edge_line_loop_<by_pattern::BG>( dst, src, conv_line );    break;
+        case by_pattern::GB:    by8_edge_line_loop_<by_pattern::GB>( dst, src, conv_line );    break;
+        case by_pattern::GR:    by8_edge_line_loop_<by_pattern::GR>( dst, src, conv_line );    break;
+        case by_pattern::RG:    by8_edge_line_loop_<by_pattern::RG>( dst, src, conv_line );    break;
+        };
+    }
+
     template<class TOut>    int	    conv_by8_line_c( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
     template<>              int	    conv_by8_line_c<BGRA32>( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
     template<>              int	    conv_by8_line_c<BGR24>( by_pattern pattern, const alg_context_c& clr, const line_data& lines, int x, int dim_x );
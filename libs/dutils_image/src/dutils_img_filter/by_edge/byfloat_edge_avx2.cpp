@@ -0,0 +1,94 @@
+
+#include "byfloat_edge_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace byfloat_edge_internal;
+
+    constexpr int pixels_per_step = 8;
+
+    FORCEINLINE __m256  abs_ps( __m256 v ) noexcept
+    {
+        return _mm256_andnot_ps( _mm256_set1_ps( -0.f ), v );
+    }
+
+    // stores 8 pixels as b g r triplets
+    FORCEINLINE void    store_bgr_8px( float* dst, __m256 b, __m256 g, __m256 r ) noexcept
+    {
+        // after the permutes, each output register picks every third element from one of the sources
+        const __m256 bp = _mm256_permutevar8x32_ps( b, _mm256_setr_epi32( 0, 3, 6, 1, 4, 7, 2, 5 ) );
+        const __m256 gp = _mm256_permutevar8x32_ps( g, _mm256_setr_epi32( 5, 0, 3, 6, 1, 4, 7, 2 ) );
+        const __m256 rp = _mm256_permutevar8x32_ps( r, _mm256_setr_epi32( 2, 5, 0, 3, 6, 1, 4, 7 ) );
+
+        const __m256 o0 = _mm256_blend_ps( _mm256_blend_ps( bp, gp, 0x92 ), rp, 0x24 );
+        const __m256 o1 = _mm256_blend_ps( _mm256_blend_ps( rp, bp, 0x92 ), gp, 0x24 );
+        const __m256 o2 = _mm256_blend_ps( _mm256_blend_ps( gp, rp, 0x92 ), bp, 0x24 );
+
+        _mm256_storeu_ps( dst + 0, o0 );
+        _mm256_storeu_ps( dst + 8, o1 );
+        _mm256_storeu_ps( dst + 16, o2 );
+    }
+
+    // both the color and the green pixel formulas are calculated for all lanes and then selected per lane
+    template<by_pattern pattern>
+    FORCEINLINE void    conv_8px( const line_data& lines, int x ) noexcept
+    {
+        const __m256 half = _mm256_set1_ps( 0.5f );
+
+        const __m256 p_m1 = _mm256_loadu_ps( lines.prv + x - 1 );
+        const __m256 p_0 = _mm256_loadu_ps( lines.prv + x + 0 );
+        const __m256 p_p1 = _mm256_loadu_ps( lines.prv + x + 1 );
+        const __m256 c_m1 = _mm256_loadu_ps( lines.cur + x - 1 );
+        const __m256 c_0 = _mm256_loadu_ps( lines.cur + x + 0 );
+        const __m256 c_p1 = _mm256_loadu_ps( lines.cur + x + 1 );
+        const __m256 n_m1 = _mm256_loadu_ps( lines.nxt + x - 1 );
+        const __m256 n_0 = _mm256_loadu_ps( lines.nxt + x + 0 );
+        const __m256 n_p1 = _mm256_loadu_ps( lines.nxt + x + 1 );
+
+        const __m256 lr = _mm256_mul_ps( _mm256_add_ps( c_m1, c_p1 ), half );
+        const __m256 ob = _mm256_mul_ps( _mm256_add_ps( p_0, n_0 ), half );
+        const __m256 diag = _mm256_mul_ps( _mm256_add_ps( _mm256_add_ps( p_m1, p_p1 ), _mm256_add_ps( n_m1, n_p1 ) ), _mm256_set1_ps( 0.25f ) );
+
+        const __m256 dH = abs_ps( _mm256_sub_ps( c_m1, c_p1 ) );
+        const __m256 dV = abs_ps( _mm256_sub_ps( p_0, n_0 ) );
+        const __m256 around = _mm256_mul_ps( _mm256_add_ps( lr, ob ), half );
+        const __m256 edge = _mm256_blendv_ps( _mm256_blendv_ps( around, ob, _mm256_cmp_ps( dH, dV, _CMP_GT_OQ ) ), lr, _mm256_cmp_ps( dH, dV, _CMP_LT_OQ ) );
+
+        // is_color_pixel selects the lanes at even x, otherwise the odd ones
+        constexpr int color_lanes = is_color_pixel( pattern ) ? 0x55 : 0xAA;
+
+        const __m256 v_h = _mm256_blend_ps( lr, c_0, color_lanes );
+        const __m256 v_v = _mm256_blend_ps( ob, diag, color_lanes );
+        const __m256 g = _mm256_blend_ps( c_0, edge, color_lanes );
+
+        if constexpr( is_red_line( pattern ) ) {
+            store_bgr_8px( lines.out_line + x * 3, v_v, g, v_h );
+        } else {
+            store_bgr_8px( lines.out_line + x * 3, v_h, g, v_v );
+        }
+    }
+
+    struct line_avx2
+    {
+        // the loads read one pixel past the 8 pixels of a step, the last pixel pair is done by convert_line
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            for( ; (x + pixels_per_step) <= (dim_x - 2); x += pixels_per_step )
+            {
+                conv_8px<pattern>( lines, x );
+            }
+            return x;
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_avx2( img::img_type dst, img::img_type src )
+{
+    if( !byfloat_edge_internal::can_transform_byfloat_to_bgrfloat( dst, src ) ) {
+        return nullptr;
+    }
+    return &byfloat_edge_internal::byfloat_edge_image_loop<line_avx2>;
+}
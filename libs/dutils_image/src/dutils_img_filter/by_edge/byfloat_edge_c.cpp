@@ -0,0 +1,24 @@
+
+#include "byfloat_edge_internal.h"
+
+namespace
+{
+    using namespace byfloat_edge_internal;
+
+    struct line_c
+    {
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            return conv_line_c<pattern>( lines, x, dim_x );
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_c( img::img_type dst, img::img_type src )
+{
+    if( !byfloat_edge_internal::can_transform_byfloat_to_bgrfloat( dst, src ) ) {
+        return nullptr;
+    }
+    return &byfloat_edge_internal::byfloat_edge_image_loop<line_c>;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "by_edge.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <cmath>
+
+/*
+ * Edge sensing debayer for float bayer images into BGRFloat.
+ *
+ * This follows the by8 algorithm (by8_pixelops.h), without the green averaging and color matrix options,
+ * which are specific to 8-bit data.
+ * The simd variants provide the inner part of a line, the borders are always done by the code in this file.
+ */
+
+namespace byfloat_edge_internal
+{
+    using namespace img::by_transform;
+
+    struct line_data
+    {
+        const float*    prv;
+        const float*    cur;
+        const float*    nxt;
+
+        float*          out_line;       // BGRFloat, 3 floats per pixel
+    };
+
+    struct pixel
+    {
+        float r, g, b;
+    };
+
+    inline line_data init_src_param( int y, const img::img_descriptor& dst, const img::img_descriptor& src, int offset_prev, int offset_next ) noexcept
+    {
+        return line_data{
+            img::get_line_start<const float>( src, y + offset_prev ),
+            img::get_line_start<const float>( src, y + 0 ),
+            img::get_line_start<const float>( src, y + offset_next ),
+            img::get_line_start<float>( dst, y ),
+        };
+    }
+
+    constexpr bool  is_red_line( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::GR;
+    }
+    constexpr bool  is_color_pixel( by_pattern pat ) noexcept {
+        return pat == by_pattern::RG || pat == by_pattern::BG;
+    }
+
+    FORCEINLINE float   calc_green_edge( const float* prv, const float* cur, const float* nxt ) noexcept
+    {
+        const float lr = (cur[-1] + cur[+1]) * 0.5f;
+        const float ob = (prv[0] + nxt[0]) * 0.5f;
+
+        const float dH = std::fabs( cur[-1] - cur[+1] );
+        const float dV = std::fabs( prv[0] - nxt[0] );
+        if( dH < dV ) {
+            return lr;
+        } else if( dH > dV ) {
+            return ob;
+        }
+        return (lr + ob) * 0.5f;
+    }
+
+    template<by_pattern pattern>
+    FORCEINLINE pixel   conv_pixel( const line_data& lines, int x ) noexcept
+    {
+        const float* prv = lines.prv + x;
+        const float* cur = lines.cur + x;
+        const float* nxt = lines.nxt + x;
+
+        float v_h, v_v, g;
+        if constexpr( is_color_pixel( pattern ) )
+        {
+            v_h = cur[0];
+            v_v = ((prv[-1] + prv[+1]) + (nxt[-1] + nxt[+1])) * 0.25f;
+            g = calc_green_edge( prv, cur, nxt );
+        }
+        else
+        {
+            v_h = (cur[-1] + cur[+1]) * 0.5f;
+            v_v = (prv[0] + nxt[0]) * 0.5f;
+            g = cur[0];
+        }
+
+        if constexpr( is_red_line( pattern ) ) {
+            return pixel{ v_h, g, v_v };
+        } else {
+            return pixel{ v_v, g, v_h };
+        }
+    }
+
+    FORCEINLINE void    store( float* out_line, int x, pixel val ) noexcept
+    {
+        out_line[x * 3 + 0] = val.b;
+        out_line[x * 3 + 1] = val.g;
+        out_line[x * 3 + 2] = val.r;
+    }
+
+    template<by_pattern pattern>
+    FORCEINLINE int     conv_line_c( const line_data& lines, int x, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = by_pattern_alg::next_pixel( pattern );
+
+        for( ; x < (dim_x - 2); x += 2 )
+        {
+            store( lines.out_line, x + 0, conv_pixel<pattern>( lines, x + 0 ) );
+            store( lines.out_line, x + 1, conv_pixel<nxt_pattern>( lines, x + 1 ) );
+        }
+        return x;
+    }
+
+    // TLine::conv<pattern>( lines, x, dim_x ) converts the pixels from x on and returns the first x it did not convert
+    template<class TLine, by_pattern pattern>
+    void    convert_line( const line_data& lines, int dim_x ) noexcept
+    {
+        constexpr auto nxt_pattern = by_pattern_alg::next_pixel( pattern );
+
+        pixel tmp = conv_pixel<nxt_pattern>( lines, 0 + 1 );
+        store( lines.out_line, 0 + 0, tmp );
+        store( lines.out_line, 0 + 1, tmp );
+
+        int x = TLine::template conv<pattern>( lines, 2, dim_x );
+        x = conv_line_c<pattern>( lines, x, dim_x );
+
+        // x = dim_cx - 2
+        tmp = conv_pixel<pattern>( lines, x + 0 );
+        store( lines.out_line, x + 0, tmp );
+        store( lines.out_line, x + 1, tmp );
+    }
+
+    template<class TLine>
+    void    transform_line( by_pattern pattern, const line_data& lines, int dim_x ) noexcept
+    {
+        switch( pattern )
+        {
+        case by_pattern::BG:    convert_line<TLine, by_pattern::BG>( lines, dim_x );    break;
+        case by_pattern::GB:    convert_line<TLine, by_pattern::GB>( lines, dim_x );    break;
+        case by_pattern::GR:    convert_line<TLine, by_pattern::GR>( lines, dim_x );    break;
+        case by_pattern::RG:    convert_line<TLine, by_pattern::RG>( lines, dim_x );    break;
+        };
+    }
+
+    template<class TLine>
+    void    byfloat_edge_image_loop( img::img_descriptor dst_, img::img_descriptor src, const img_filter::transform::by_edge::options& /*in_opt*/ )
+    {
+        const auto dst = flip_image_in_img_desc_if_allowed( dst_ );
+
+        const by_pattern pattern_cur = img::by_transform::convert_bayer_fcc_to_pattern( src.fourcc_type() );
+        const by_pattern pattern_nxt = by_pattern_alg::next_line( pattern_cur );
+
+        const int dim_y = src.dim.cy;
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_beg) ) {
+            transform_line<TLine>( pattern_cur, init_src_param( 0, dst, src, +1, +1 ), src.dim.cx );
+        }
+        else {
+            transform_line<TLine>( pattern_cur, init_src_param( 0, dst, src, -1, +1 ), src.dim.cx );
+        }
+        int y = 1;
+        for( ; y < (dim_y - 1); y += 2 )
+        {
+            transform_line<TLine>( pattern_nxt, init_src_param( y + 0, dst, src, -1, +1 ), src.dim.cx );
+            transform_line<TLine>( pattern_cur, init_src_param( y + 1, dst, src, -1, +1 ), src.dim.cx );
+        }
+
+        if( !(src.flags & img::img_descriptor::flags_no_wrap_end) ) {
+            transform_line<TLine>( pattern_nxt, init_src_param( y, dst, src, -1, -1 ), src.dim.cx );
+        }
+        else {
+            transform_line<TLine>( pattern_nxt, init_src_param( y, dst, src, -1, +1 ), src.dim.cx );
+        }
+    }
+
+    inline bool can_transform_byfloat_to_bgrfloat( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_byfloat_fcc( src.fourcc_type() ) || dst.fourcc_type() != img::fourcc::BGRFloat ) {
+            return false;
+        }
+        if( dst.dim != src.dim ) {
+            return false;
+        }
+        return dst.dim.cx >= 4 && dst.dim.cy >= 2;
+    }
+}
@@ -0,0 +1,72 @@
+
+#include "../simd_helper/use_simd_A64.h"
+
+#include "byfloat_edge_internal.h"
+
+namespace
+{
+    using namespace byfloat_edge_internal;
+
+    constexpr int pixels_per_step = 4;
+
+    // both the color and the green pixel formulas are calculated for all lanes and then selected per lane
+    template<by_pattern pattern>
+    FORCEINLINE void    conv_4px( const line_data& lines, int x ) noexcept
+    {
+        const float32x4_t half = vdupq_n_f32( 0.5f );
+
+        const float32x4_t p_m1 = vld1q_f32( lines.prv + x - 1 );
+        const float32x4_t p_0 = vld1q_f32( lines.prv + x + 0 );
+        const float32x4_t p_p1 = vld1q_f32( lines.prv + x + 1 );
+        const float32x4_t c_m1 = vld1q_f32( lines.cur + x - 1 );
+        const float32x4_t c_0 = vld1q_f32( lines.cur + x + 0 );
+        const float32x4_t c_p1 = vld1q_f32( lines.cur + x + 1 );
+        const float32x4_t n_m1 = vld1q_f32( lines.nxt + x - 1 );
+        const float32x4_t n_0 = vld1q_f32( lines.nxt + x + 0 );
+        const float32x4_t n_p1 = vld1q_f32( lines.nxt + x + 1 );
+
+        const float32x4_t lr = vmulq_f32( vaddq_f32( c_m1, c_p1 ), half );
+        const float32x4_t ob = vmulq_f32( vaddq_f32( p_0, n_0 ), half );
+        const float32x4_t diag = vmulq_f32( vaddq_f32( vaddq_f32( p_m1, p_p1 ), vaddq_f32( n_m1, n_p1 ) ), vdupq_n_f32( 0.25f ) );
+
+        const float32x4_t dH = vabdq_f32( c_m1, c_p1 );
+        const float32x4_t dV = vabdq_f32( p_0, n_0 );
+        const float32x4_t around = vmulq_f32( vaddq_f32( lr, ob ), half );
+        const float32x4_t edge = vbslq_f32( vcltq_f32( dH, dV ), lr, vbslq_f32( vcgtq_f32( dH, dV ), ob, around ) );
+
+        // is_color_pixel selects the lanes at even x, otherwise the odd ones
+        const uint32x4_t color_lanes = is_color_pixel( pattern ) ? uint32x4_t{ ~0u, 0, ~0u, 0 } : uint32x4_t{ 0, ~0u, 0, ~0u };
+
+        const float32x4_t v_h = vbslq_f32( color_lanes, c_0, lr );
+        const float32x4_t v_v = vbslq_f32( color_lanes, diag, ob );
+        const float32x4_t g = vbslq_f32( color_lanes, edge, c_0 );
+
+        if constexpr( is_red_line( pattern ) ) {
+            vst3q_f32( lines.out_line + x * 3, float32x4x3_t{ v_v, g, v_h } );
+        } else {
+            vst3q_f32( lines.out_line + x * 3, float32x4x3_t{ v_h, g, v_v } );
+        }
+    }
+
+    struct line_neon
+    {
+        // the loads read one pixel past the 4 pixels of a step, the last pixel pair is done by convert_line
+        template<by_pattern pattern>
+        static int  conv( const line_data& lines, int x, int dim_x ) noexcept
+        {
+            for( ; (x + pixels_per_step) <= (dim_x - 2); x += pixels_per_step )
+            {
+                conv_4px<pattern>( lines, x );
+            }
+            return x;
+        }
+    };
+}
+
+img_filter::transform::by_edge::function_type   img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_neon( img::img_type dst, img::img_type src )
+{
+    if( !byfloat_edge_internal::can_transform_byfloat_to_bgrfloat( dst, src ) ) {
+        return nullptr;
+    }
+    return &byfloat_edge_internal::byfloat_edge_image_loop<line_neon>;
+}
@@ -0,0 +1,105 @@
+#include "byfloat_yuv_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace byfloat_yuv_internal;
+
+    struct bgr_8px
+    {
+        __m256 b, g, r;
+    };
+
+    // 24 interleaved floats to 8 b, g and r values, the blends collect the channel, the permutes restore the order
+    FORCEINLINE bgr_8px     load_deinterleave_8px( const float* bgr ) noexcept
+    {
+        const __m256 v0 = _mm256_loadu_ps( bgr + 0 );   // b0 g0 r0 b1 g1 r1 b2 g2
+        const __m256 v1 = _mm256_loadu_ps( bgr + 8 );   // r2 b3 g3 r3 b4 g4 r4 b5
+        const __m256 v2 = _mm256_loadu_ps( bgr + 16 );  // g5 r5 b6 g6 r6 b7 g7 r7
+
+        const __m256 b = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x92 ), v2, 0x24 );
+        const __m256 g = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x24 ), v2, 0x49 );
+        const __m256 r = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x49 ), v2, 0x92 );
+
+        return bgr_8px{
+            _mm256_permutevar8x32_ps( b, _mm256_setr_epi32( 0, 3, 6, 1, 4, 7, 2, 5 ) ),
+            _mm256_permutevar8x32_ps( g, _mm256_setr_epi32( 1, 4, 7, 2, 5, 0, 3, 6 ) ),
+            _mm256_permutevar8x32_ps( r, _mm256_setr_epi32( 2, 5, 0, 3, 6, 1, 4, 7 ) ),
+        };
+    }
+
+    FORCEINLINE __m256  calc_channel( const bgr_8px& px, const float (&c)[3], float offset ) noexcept
+    {
+        // same order as convert_line_c
+        const __m256 bg = _mm256_add_ps( _mm256_mul_ps( px.b, _mm256_set1_ps( c[0] ) ), _mm256_mul_ps( px.g, _mm256_set1_ps( c[1] ) ) );
+        const __m256 r_offset = _mm256_add_ps( _mm256_mul_ps( px.r, _mm256_set1_ps( c[2] ) ), _mm256_set1_ps( offset ) );
+        return _mm256_add_ps( bg, r_offset );
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    store_8px( void* plane_line, int x, __m256 v ) noexcept
+    {
+        if constexpr( dst_fcc == img::fourcc::YUVF32PLANAR )
+        {
+            _mm256_storeu_ps( static_cast<float*>( plane_line ) + x, v );
+        }
+        else
+        {
+            constexpr float max_val = plane_traits<dst_fcc>::max_val;
+
+            const __m256 clipped = _mm256_min_ps( _mm256_max_ps( v, _mm256_setzero_ps() ), _mm256_set1_ps( 1.f ) );
+            const __m256i v32 = _mm256_cvtps_epi32( _mm256_mul_ps( clipped, _mm256_set1_ps( max_val ) ) );
+
+            // packus works per 128-bit lane, the permutes move the results of both lanes to the lower half
+            const __m256i v16 = _mm256_packus_epi32( v32, v32 );
+            if constexpr( dst_fcc == img::fourcc::YUV16PLANAR )
+            {
+                const __m256i res = _mm256_permute4x64_epi64( v16, 0x08 );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( static_cast<uint16_t*>( plane_line ) + x ), _mm256_castsi256_si128( res ) );
+            }
+            else
+            {
+                const __m256i res = _mm256_permutevar8x32_epi32( _mm256_packus_epi16( v16, v16 ), _mm256_setr_epi32( 0, 4, 0, 0, 0, 0, 0, 0 ) );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( static_cast<uint8_t*>( plane_line ) + x ), _mm256_castsi256_si128( res ) );
+            }
+        }
+    }
+
+    template<img::fourcc dst_fcc>
+    void    convert_line_avx2( dst_lines out, const float* bgr, int dim_x, const yuv_coeffs& c ) noexcept
+    {
+        int x = 0;
+        for( ; (x + 8) <= dim_x; x += 8 )
+        {
+            const bgr_8px px = load_deinterleave_8px( bgr + x * 3 );
+
+            store_8px<dst_fcc>( out.y, x, calc_channel( px, c.y, c.y_offset ) );
+            store_8px<dst_fcc>( out.u, x, calc_channel( px, c.u, c.uv_offset ) );
+            store_8px<dst_fcc>( out.v, x, calc_channel( px, c.v, c.uv_offset ) );
+        }
+        convert_line_c<dst_fcc>( out, bgr, x, dim_x, c );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    byfloat_to_yuv_planar_avx2( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::by_edge::yuv_options& opt )
+    {
+        byfloat_to_yuv_planar_image_loop( dst, src, opt, &convert_line_avx2<dst_fcc> );
+    }
+}
+
+img_filter::transform::by_edge::yuv_function_type   img_filter::transform::by_edge::get_transform_byfloat_to_yuv_planar_avx2( img::img_type dst, img::img_type src )
+{
+    if( !byfloat_yuv_internal::can_transform_byfloat_to_yuv_planar( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::YUV8PLANAR:       return &byfloat_to_yuv_planar_avx2<img::fourcc::YUV8PLANAR>;
+    case img::fourcc::YUV16PLANAR:      return &byfloat_to_yuv_planar_avx2<img::fourcc::YUV16PLANAR>;
+    case img::fourcc::YUVF32PLANAR:     return &byfloat_to_yuv_planar_avx2<img::fourcc::YUVF32PLANAR>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,32 @@
+#include "byfloat_yuv_internal.h"
+
+namespace
+{
+    using namespace byfloat_yuv_internal;
+
+    template<img::fourcc dst_fcc>
+    void    byfloat_to_yuv_planar_c( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::by_edge::yuv_options& opt )
+    {
+        byfloat_to_yuv_planar_image_loop( dst, src, opt,
+            []( dst_lines out, const float* bgr, int dim_x, const yuv_coeffs& c )
+            {
+                convert_line_c<dst_fcc>( out, bgr, 0, dim_x, c );
+            } );
+    }
+}
+
+img_filter::transform::by_edge::yuv_function_type   img_filter::transform::by_edge::get_transform_byfloat_to_yuv_planar_c( img::img_type dst, img::img_type src )
+{
+    if( !byfloat_yuv_internal::can_transform_byfloat_to_yuv_planar( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::YUV8PLANAR:       return &byfloat_to_yuv_planar_c<img::fourcc::YUV8PLANAR>;
+    case img::fourcc::YUV16PLANAR:      return &byfloat_to_yuv_planar_c<img::fourcc::YUV16PLANAR>;
+    case img::fourcc::YUVF32PLANAR:     return &byfloat_to_yuv_planar_c<img::fourcc::YUVF32PLANAR>;
+    default:
+        return nullptr;
+    }
+}
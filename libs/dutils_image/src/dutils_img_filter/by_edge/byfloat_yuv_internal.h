@@ -0,0 +1,170 @@
+#pragma once
+
+#include "by_edge.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+ * float bayer -> YUV8PLANAR/YUV16PLANAR/YUVF32PLANAR in one pass over the image.
+ *
+ * Like by8_yuv_internal.h, the bayer image is debayered in tiles into a small BGRFloat buffer with the
+ * byfloat_to_bgrfloat kernel of the options, and the yuv lines are converted from that buffer.
+ * All planes have the full resolution, so each line is converted on its own.
+ * The simd variants only provide the inner part of a line, the rest is done by the c code in this file.
+ */
+
+namespace byfloat_yuv_internal
+{
+    // lines per tile, a 4096 pixel wide BGRFloat tile fits into L2
+    constexpr int tile_lines = 8;
+
+    // factors in b, g, r order, the results are in [0;1] for [0;1] input
+    struct yuv_coeffs
+    {
+        float   y[3];
+        float   u[3];
+        float   v[3];
+
+        float   y_offset;   // 16 / 255 for limited range, 0 for full range
+        float   uv_offset;  // 0.5
+    };
+
+    inline yuv_coeffs  calc_yuv_coeffs( const img_filter::transform::by_edge::yuv_colorimetry& clr ) noexcept
+    {
+        using matrix_type = img_filter::transform::by_edge::yuv_colorimetry::matrix_type;
+
+        const float kr = clr.matrix == matrix_type::bt709 ? 0.2126f : 0.299f;
+        const float kb = clr.matrix == matrix_type::bt709 ? 0.0722f : 0.114f;
+        const float kg = 1.f - kr - kb;
+
+        const float y_scale = clr.full_range ? 1.f : 219.f / 255.f;
+        const float uv_scale = clr.full_range ? 1.f : 224.f / 255.f;
+
+        yuv_coeffs res = {};
+        res.y[0] = kb * y_scale;
+        res.y[1] = kg * y_scale;
+        res.y[2] = kr * y_scale;
+        res.u[0] = 0.5f * uv_scale;
+        res.u[2] = -kr / (1.f - kb) * 0.5f * uv_scale;
+        res.u[1] = -res.u[0] - res.u[2];    // rows sum to 0, so gray stays at 0.5
+        res.v[2] = 0.5f * uv_scale;
+        res.v[0] = -kb / (1.f - kr) * 0.5f * uv_scale;
+        res.v[1] = -res.v[0] - res.v[2];
+        res.y_offset = clr.full_range ? 0.f : 16.f / 255.f;
+        res.uv_offset = 0.5f;
+        return res;
+    }
+
+    template<img::fourcc dst_fcc> struct plane_traits;
+
+    template<> struct plane_traits<img::fourcc::YUV8PLANAR>     { using type = uint8_t;   static constexpr float max_val = 255.f; };
+    template<> struct plane_traits<img::fourcc::YUV16PLANAR>    { using type = uint16_t;  static constexpr float max_val = 65535.f; };
+    template<> struct plane_traits<img::fourcc::YUVF32PLANAR>   { using type = float;     static constexpr float max_val = 1.f; };
+
+    // the integer planes are clipped to [0;1] and rounded to nearest even, like _mm256_cvtps_epi32
+    template<img::fourcc dst_fcc>
+    FORCEINLINE auto   to_plane_value( float v ) noexcept
+    {
+        using traits = plane_traits<dst_fcc>;
+        if constexpr( dst_fcc == img::fourcc::YUVF32PLANAR ) {
+            return v;
+        } else {
+            return static_cast<typename traits::type>( std::lrint( std::clamp( v, 0.f, 1.f ) * traits::max_val ) );
+        }
+    }
+
+    struct dst_lines
+    {
+        void*   y;
+        void*   u;
+        void*   v;
+    };
+
+    inline dst_lines    get_dst_lines( const img::img_descriptor& dst, int y ) noexcept
+    {
+        return { img::get_line_start_of_plane( dst, y, 0 ), img::get_line_start_of_plane( dst, y, 1 ), img::get_line_start_of_plane( dst, y, 2 ) };
+    }
+
+    // converts the pixels [x;dim_x) of the BGRFloat line bgr
+    template<img::fourcc dst_fcc>
+    void    convert_line_c( dst_lines out, const float* bgr, int x, int dim_x, const yuv_coeffs& c ) noexcept
+    {
+        using out_type = typename plane_traits<dst_fcc>::type;
+
+        auto* out_y = static_cast<out_type*>( out.y );
+        auto* out_u = static_cast<out_type*>( out.u );
+        auto* out_v = static_cast<out_type*>( out.v );
+        for( ; x < dim_x; ++x )
+        {
+            const float b = bgr[x * 3 + 0];
+            const float g = bgr[x * 3 + 1];
+            const float r = bgr[x * 3 + 2];
+
+            // summed in the order -ffast-math reassociates to, and the simd variants use, so the results are bit exact
+            out_y[x] = to_plane_value<dst_fcc>( (c.y[0] * b + c.y[1] * g) + (c.y[2] * r + c.y_offset) );
+            out_u[x] = to_plane_value<dst_fcc>( (c.u[0] * b + c.u[1] * g) + (c.u[2] * r + c.uv_offset) );
+            out_v[x] = to_plane_value<dst_fcc>( (c.v[0] * b + c.v[1] * g) + (c.v[2] * r + c.uv_offset) );
+        }
+    }
+
+    inline bool     can_transform_byfloat_to_yuv_planar( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_byfloat_fcc( src.fourcc_type() ) || dst.dim != src.dim ) {
+            return false;
+        }
+        if( dst.dim.cx < 4 || dst.dim.cy < 2 || (dst.dim.cx % 2) != 0 || (dst.dim.cy % 2) != 0 ) {
+            return false;
+        }
+        return img::is_fcc_in_fcclist( dst, { img::fourcc::YUV8PLANAR, img::fourcc::YUV16PLANAR, img::fourcc::YUVF32PLANAR } );
+    }
+
+    /*
+     * TConvLine is called as func( dst_lines, bgr_line, dim_x, coeffs ) for every line.
+     * The src flags flags_no_wrap_beg/flags_no_wrap_end are honored, so this can run on strips.
+     */
+    template<class TConvLine>
+    void    byfloat_to_yuv_planar_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::by_edge::yuv_options& opt, TConvLine conv_line )
+    {
+        const yuv_coeffs coeffs = calc_yuv_coeffs( opt.colorimetry );
+
+        const int dim_x = src.dim.cx;
+        const int dim_y = src.dim.cy;
+
+        thread_local std::vector<uint8_t> tile_buffer;
+
+        const auto bgr_type = img::make_img_type( img::fourcc::BGRFloat, { dim_x, tile_lines } );
+        if( tile_buffer.size() < static_cast<size_t>( bgr_type.buffer_length ) ) {
+            tile_buffer.resize( bgr_type.buffer_length );
+        }
+
+        // dim_y is even, so all tiles start on the bayer pattern of src
+        for( int y_begin = 0; y_begin < dim_y; y_begin += tile_lines )
+        {
+            const int y_end = std::min( y_begin + tile_lines, dim_y );
+
+            auto src_tile = src;
+            src_tile.data_.planes[0].plane_ptr = img::get_line_start( src, y_begin );
+            src_tile.dim.cy = y_end - y_begin;
+            src_tile.data_length = src.pitch() * src_tile.dim.cy;
+            if( y_begin > 0 ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_beg;
+            }
+            if( y_end < dim_y ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_end;
+            }
+
+            auto bgr_tile = img::make_img_desc_from_linear_memory( img::make_img_type( img::fourcc::BGRFloat, src_tile.dim ), tile_buffer.data() );
+            bgr_tile.flags |= img::img_descriptor::flags_no_flip;
+
+            opt.byfloat_to_bgrfloat( bgr_tile, src_tile, opt.by8_opt );
+
+            for( int y = y_begin; y < y_end; ++y )
+            {
+                conv_line( get_dst_lines( dst, y ), img::get_line_start<const float>( bgr_tile, y - y_begin ), dim_x, coeffs );
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Lossless compression of raw bayer and mono images, meant for recording and network transport.
+ *
+ * Each sample is predicted from its same color neighbours (the MED predictor of LOCO-I, with a distance of
+ * 2 pixels/lines for bayer images), the zigzag coded residuals are bit-packed in blocks of 256 samples.
+ * The packed formats (*_PACKED, *_MIPI_PACKED, *_SPACKED) are accepted directly, the encoded frame
+ * stores their 10/12-bit values and the decoder writes the same packing again.
+ *
+ * An encoded frame is a header followed by the lines, see lossless_codec_internal.h for the layout.
+ * All variants produce the same stream, so any decoder can read the output of any encoder.
+ */
+
+namespace img_filter::codec::lossless
+{
+    // size of the frame header in bytes
+    constexpr size_t    header_size = 24;
+
+    // returns the number of bytes written to dst, 0 when dst_size is too small
+    using encode_function_type = size_t( * )( const img::img_descriptor& src, void* dst, size_t dst_size );
+
+    // returns false when src is not a valid frame for the type of dst
+    using decode_function_type = bool( * )( const img::img_descriptor& dst, const void* src, size_t src_size );
+
+    bool        is_supported_fcc( img::fourcc fcc ) noexcept;
+
+    // true when the codec can handle type, the packed formats need a width which is a multiple of their pixel group
+    bool        is_supported_type( const img::img_type& type ) noexcept;
+
+    // the worst case size of an encoded frame of type, 0 when the type is not supported
+    size_t      calc_max_encoded_size( const img::img_type& type ) noexcept;
+
+    // reads the fourcc and the dimensions from the header of an encoded frame
+    bool        read_header( const void* src, size_t src_size, img::img_type& type ) noexcept;
+
+    encode_function_type    get_encode_c( const img::img_type& src );
+    encode_function_type    get_encode_avx2( const img::img_type& src );
+
+    decode_function_type    get_decode_c( const img::img_type& dst );
+    decode_function_type    get_decode_avx2( const img::img_type& dst );
+}
@@ -0,0 +1,180 @@
+#include "lossless_codec_internal.h"
+
+#include "../../transform/fcc1x_packed/fcc1x_packed_avx2_internal.h"
+
+#include <immintrin.h>
+
+/*
+ * AVX2 variant of the encoder and of the block unpacking of the decoder. One register holds the 16 lanes
+ * of a block, so a block is packed/unpacked with n stores/loads and shifts by constants.
+ * The reconstruction of the decoder depends on the sample just decoded and stays scalar.
+ */
+
+namespace
+{
+    using namespace lossless_codec_internal;
+
+    FORCEINLINE __m256i     load_u16( const uint16_t* p ) noexcept
+    {
+        return _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ) );
+    }
+
+    FORCEINLINE void        store_u16( uint16_t* p, __m256i v ) noexcept
+    {
+        _mm256_storeu_si256( reinterpret_cast<__m256i*>( p ), v );
+    }
+
+    FORCEINLINE __m256i     predict_med_avx2( __m256i a, __m256i b, __m256i c ) noexcept
+    {
+        const __m256i mn = _mm256_min_epu16( a, b );
+        const __m256i mx = _mm256_max_epu16( a, b );
+
+        // a + b - c is in [mn;mx] when it is selected, so the wrap around does not matter
+        const __m256i grad = _mm256_sub_epi16( _mm256_add_epi16( a, b ), c );
+
+        const __m256i c_ge_mx = _mm256_cmpeq_epi16( _mm256_max_epu16( c, mx ), c );
+        const __m256i c_le_mn = _mm256_cmpeq_epi16( _mm256_min_epu16( c, mn ), c );
+
+        return _mm256_blendv_epi8( _mm256_blendv_epi8( grad, mx, c_le_mn ), mn, c_ge_mx );
+    }
+
+    template<int n>
+    FORCEINLINE void    pack_block_avx2( uint16_t* dst, const uint16_t* z ) noexcept
+    {
+        __m256i word = _mm256_setzero_si256();
+        int filled = 0;
+        int j = 0;
+        for( int i = 0; i < 16; ++i )
+        {
+            const __m256i v = load_u16( z + i * block_lanes );
+            word = _mm256_or_si256( word, _mm256_slli_epi16( v, filled ) );
+            if( filled + n >= 16 )
+            {
+                store_u16( dst + j++ * block_lanes, word );
+                word = filled + n > 16 ? _mm256_srli_epi16( v, 16 - filled ) : _mm256_setzero_si256();
+                filled -= 16;
+            }
+            filled += n;
+        }
+    }
+
+    template<int n>
+    FORCEINLINE void    unpack_block_avx2( uint16_t* z, const uint16_t* src ) noexcept
+    {
+        const __m256i mask = _mm256_set1_epi16( static_cast<short>( (1u << n) - 1 ) );
+
+        int offset = 0;
+        int j = 0;
+        __m256i word = load_u16( src );
+        for( int i = 0; i < 16; ++i )
+        {
+            __m256i v = _mm256_srli_epi16( word, offset );
+            if( offset + n >= 16 && j + 1 < n )
+            {
+                word = load_u16( src + (j + 1) * block_lanes );
+                if( offset + n > 16 ) {
+                    v = _mm256_or_si256( v, _mm256_slli_epi16( word, 16 - offset ) );
+                }
+            }
+            store_u16( z + i * block_lanes, _mm256_and_si256( v, mask ) );
+
+            offset += n;
+            if( offset >= 16 ) {
+                offset -= 16;
+                ++j;
+            }
+        }
+    }
+
+    struct kernel_avx2
+    {
+        template<line_layout layout>
+        static void     unpack_line( uint16_t* dst, const uint8_t* src_line, int width ) noexcept
+        {
+            int x = 0;
+            if constexpr( layout == line_layout::u8 )
+            {
+                for( ; x + 16 <= width; x += 16 ) {
+                    store_u16( dst + x, _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + x ) ) ) );
+                }
+            }
+            else if constexpr( layout == line_layout::u16 )
+            {
+                memcpy( dst, src_line, width * sizeof( uint16_t ) );
+                x = width;
+            }
+            else
+            {
+                constexpr auto pack_type = to_pack_type( layout );
+                constexpr int shift = layout == line_layout::fcc10_mipi || layout == line_layout::fcc10_spacked ? 6 : 4;
+
+                for( ; x + fcc1x_packed_avx2_internal::load_step_pixels_needed<pack_type>() <= width; x += 16 ) {
+                    store_u16( dst + x, _mm256_srli_epi16( fcc1x_packed_avx2_internal::load_fcc16_step<pack_type>( src_line, x ), shift ) );
+                }
+            }
+            unpack_line_c<layout>( dst, src_line, x, width );
+        }
+
+        static void     calc_residuals( uint16_t* z, const uint16_t* cur, const uint16_t* up, int width, int color_stride, int bits ) noexcept
+        {
+            const int shift = 16 - bits;
+            const __m128i shift_cnt = _mm_cvtsi32_si128( shift );
+
+            calc_residuals_c( z, cur, up, 0, std::min( color_stride, width ), color_stride, bits );
+
+            int x = color_stride;
+            for( ; x + 16 <= width; x += 16 )
+            {
+                const __m256i a = load_u16( cur + x - color_stride );
+                const __m256i b = load_u16( up + x );
+                const __m256i c = load_u16( up + x - color_stride );
+
+                const __m256i d = _mm256_sub_epi16( load_u16( cur + x ), predict_med_avx2( a, b, c ) );
+
+                // sign extended from bits and zigzag coded
+                const __m256i s = _mm256_sra_epi16( _mm256_sll_epi16( d, shift_cnt ), shift_cnt );
+                store_u16( z + x, _mm256_xor_si256( _mm256_slli_epi16( s, 1 ), _mm256_srai_epi16( s, 15 ) ) );
+            }
+            calc_residuals_c( z, cur, up, std::max( x, color_stride ), width, color_stride, bits );
+        }
+
+        static int      calc_block_bit_width( const uint16_t* z ) noexcept
+        {
+            __m256i all = _mm256_setzero_si256();
+            for( int i = 0; i < block_samples; i += block_lanes ) {
+                all = _mm256_or_si256( all, load_u16( z + i ) );
+            }
+
+            __m128i v = _mm_or_si128( _mm256_castsi256_si128( all ), _mm256_extracti128_si256( all, 1 ) );
+            v = _mm_or_si128( v, _mm_srli_si128( v, 8 ) );
+            v = _mm_or_si128( v, _mm_srli_si128( v, 4 ) );
+            v = _mm_or_si128( v, _mm_srli_si128( v, 2 ) );
+            return calc_bit_width( static_cast<uint32_t>( _mm_cvtsi128_si32( v ) ) & 0xFFFF );
+        }
+
+        static void     pack_block( uint16_t* dst, const uint16_t* z, int n ) noexcept
+        {
+            dispatch_bit_width( n, [&]( auto bits ) { pack_block_avx2<decltype( bits )::value>( dst, z ); } );
+        }
+
+        static void     unpack_block( uint16_t* z, const uint16_t* src, int n ) noexcept
+        {
+            if( n == 0 ) {
+                std::fill( z, z + block_samples, uint16_t( 0 ) );
+                return;
+            }
+            dispatch_bit_width( n, [&]( auto bits ) { unpack_block_avx2<decltype( bits )::value>( z, src ); } );
+        }
+    };
+}
+
+// CPU_AVX2 must be checked by the caller
+auto    img_filter::codec::lossless::get_encode_avx2( const img::img_type& src ) -> encode_function_type
+{
+    return select_encode<kernel_avx2>( src );
+}
+
+auto    img_filter::codec::lossless::get_decode_avx2( const img::img_type& dst ) -> decode_function_type
+{
+    return select_decode<kernel_avx2>( dst );
+}
@@ -0,0 +1,95 @@
+#include "lossless_codec_internal.h"
+
+namespace
+{
+    using namespace lossless_codec_internal;
+
+    struct kernel_c
+    {
+        template<line_layout layout>
+        static void     unpack_line( uint16_t* dst, const uint8_t* src_line, int width ) noexcept
+        {
+            unpack_line_c<layout>( dst, src_line, 0, width );
+        }
+
+        static void     calc_residuals( uint16_t* z, const uint16_t* cur, const uint16_t* up, int width, int color_stride, int bits ) noexcept
+        {
+            calc_residuals_c( z, cur, up, 0, width, color_stride, bits );
+        }
+
+        static int      calc_block_bit_width( const uint16_t* z ) noexcept
+        {
+            uint32_t all = 0;
+            for( int i = 0; i < block_samples; ++i ) {
+                all |= z[i];
+            }
+            return calc_bit_width( all );
+        }
+
+        static void     pack_block( uint16_t* dst, const uint16_t* z, int n ) noexcept
+        {
+            dispatch_bit_width( n, [&]( auto bits ) { pack_block_c<decltype( bits )::value>( dst, z ); } );
+        }
+
+        static void     unpack_block( uint16_t* z, const uint16_t* src, int n ) noexcept
+        {
+            if( n == 0 ) {
+                std::fill( z, z + block_samples, uint16_t( 0 ) );
+                return;
+            }
+            dispatch_bit_width( n, [&]( auto bits ) { unpack_block_c<decltype( bits )::value>( z, src ); } );
+        }
+    };
+}
+
+bool    img_filter::codec::lossless::is_supported_fcc( img::fourcc fcc ) noexcept
+{
+    return get_format_info( fcc ).layout != line_layout::invalid;
+}
+
+bool    img_filter::codec::lossless::is_supported_type( const img::img_type& type ) noexcept
+{
+    const auto info = get_format_info( type.fourcc_type() );
+    if( info.layout == line_layout::invalid || type.dim.empty() ) {
+        return false;
+    }
+    return type.dim.cx % get_group_pixels( info.layout ) == 0;
+}
+
+size_t  img_filter::codec::lossless::calc_max_encoded_size( const img::img_type& type ) noexcept
+{
+    if( !is_supported_type( type ) ) {
+        return 0;
+    }
+    const auto info = get_format_info( type.fourcc_type() );
+    return header_size + calc_max_line_size( type.dim.cx, info.sample_bits ) * type.dim.cy;
+}
+
+bool    img_filter::codec::lossless::read_header( const void* src, size_t src_size, img::img_type& type ) noexcept
+{
+    if( src == nullptr || src_size < sizeof( frame_header ) ) {
+        return false;
+    }
+
+    frame_header hdr;
+    memcpy( &hdr, src, sizeof( hdr ) );
+    if( hdr.magic != frame_magic || hdr.version != frame_version ) {
+        return false;
+    }
+    if( hdr.width == 0 || hdr.height == 0 || hdr.width > 0x10000 || hdr.height > 0x10000 ) {
+        return false;
+    }
+
+    type = img::make_img_type( hdr.fourcc, img::dim{ static_cast<int>( hdr.width ), static_cast<int>( hdr.height ) } );
+    return is_supported_type( type );
+}
+
+auto    img_filter::codec::lossless::get_encode_c( const img::img_type& src ) -> encode_function_type
+{
+    return select_encode<kernel_c>( src );
+}
+
+auto    img_filter::codec::lossless::get_decode_c( const img::img_type& dst ) -> decode_function_type
+{
+    return select_decode<kernel_c>( dst );
+}
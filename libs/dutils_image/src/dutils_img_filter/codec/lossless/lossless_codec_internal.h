@@ -0,0 +1,615 @@
+#pragma once
+
+#include "lossless_codec.h"
+
+#include "../../transform/fcc1x_packed/fcc1x_packed_to_fcc_internal.h"
+#include "../../transform/fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Stream layout, all fields are little endian:
+ *
+ *  frame_header
+ *  for each line:
+ *      [u8 bit width of block 0] ... [u8 bit width of block nb - 1]        nb = ceil( width / 256 )
+ *      [n * 32 bytes of block 0] ... [n * 32 bytes of block nb - 1]
+ *
+ * The samples of a line are the values of the pixels in their native bit depth, so 10 or 12 bits for the
+ * packed formats. The 16-bit formats (also BY10/BY12/MONO10/MONO12 with their unused upper bits) are stored
+ * with 16 bits, so any content survives the round trip.
+ *
+ * Each sample v is predicted from a = left, b = up, c = up-left, where left/up are the same color neighbours
+ * at the distance color_stride (2 for bayer, 1 for mono). The first lines use an all 0 up line, the first pixels
+ * of a line are predicted by b. The residual (v - pred) mod 2^bits is sign extended and zigzag coded.
+ *
+ * A block holds 256 samples as 16 lanes with 16 values, value i of lane l is sample i * 16 + l. All values of
+ * a block are coded with the bit width n of the largest one and lane l is stored in the u16 words [j * 16 + l],
+ * j in [0;n), with value i at bit i * n of the concatenated words. So the simd variants pack one register of 16 lanes
+ * per step and all variants produce the same stream. The samples past the end of a line are 0.
+ */
+
+namespace lossless_codec_internal
+{
+    using img::fcc1x_packed::fccXX_pack_type;
+
+    constexpr uint32_t  frame_magic = 0x3143'4C54;     // "TLC1"
+    constexpr uint16_t  frame_version = 1;
+
+    constexpr int       block_lanes = 16;
+    constexpr int       block_samples = block_lanes * 16;
+
+    struct frame_header
+    {
+        uint32_t    magic;
+        uint16_t    version;
+        uint8_t     sample_bits;
+        uint8_t     color_stride;
+        uint32_t    fourcc;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    payload_size;   // bytes following the header
+    };
+
+    static_assert( sizeof( frame_header ) == img_filter::codec::lossless::header_size, "frame_header must not be padded" );
+
+    // the layout of the samples in the lines of the image
+    enum class line_layout
+    {
+        u8,
+        u16,
+        fcc12_packed,
+        fcc12_mipi,
+        fcc12_spacked,
+        fcc10_mipi,
+        fcc10_spacked,
+
+        invalid,
+    };
+
+    struct format_info
+    {
+        line_layout     layout = line_layout::invalid;
+        int             sample_bits = 0;
+        int             color_stride = 0;
+    };
+
+    constexpr format_info   get_format_info( img::fourcc fcc ) noexcept
+    {
+        if( img::is_by8_fcc( fcc ) ) {
+            return { line_layout::u8, 8, 2 };
+        }
+        if( fcc == img::fourcc::MONO8 ) {
+            return { line_layout::u8, 8, 1 };
+        }
+        if( img::is_by16_fcc( fcc ) ) {
+            return { line_layout::u16, 16, 2 };
+        }
+        if( fcc == img::fourcc::MONO16 ) {
+            return { line_layout::u16, 16, 1 };
+        }
+
+        const auto info = img::fcc1x_packed::get_fcc1x_pack_info( fcc );
+        const int color_stride = info.is_mono ? 1 : 2;
+        switch( info.pack_type )
+        {
+        case fccXX_pack_type::fcc10:
+        case fccXX_pack_type::fcc12:            return { line_layout::u16, 16, color_stride };
+        case fccXX_pack_type::fcc12_packed:     return { line_layout::fcc12_packed, 12, color_stride };
+        case fccXX_pack_type::fcc12_mipi:       return { line_layout::fcc12_mipi, 12, color_stride };
+        case fccXX_pack_type::fcc12_spacked:    return { line_layout::fcc12_spacked, 12, color_stride };
+        case fccXX_pack_type::fcc10_mipi:       return { line_layout::fcc10_mipi, 10, color_stride };
+        case fccXX_pack_type::fcc10_spacked:    return { line_layout::fcc10_spacked, 10, color_stride };
+        case fccXX_pack_type::invalid:          break;
+        };
+        return {};
+    }
+
+    // pixels per group of bytes, the width of the image must be a multiple of this
+    constexpr int   get_group_pixels( line_layout layout ) noexcept
+    {
+        switch( layout )
+        {
+        case line_layout::fcc12_packed:
+        case line_layout::fcc12_mipi:
+        case line_layout::fcc12_spacked:    return 2;
+        case line_layout::fcc10_mipi:
+        case line_layout::fcc10_spacked:    return 4;
+        default:
+            return 1;
+        }
+    }
+
+    constexpr fccXX_pack_type   to_pack_type( line_layout layout ) noexcept
+    {
+        switch( layout )
+        {
+        case line_layout::fcc12_packed:     return fccXX_pack_type::fcc12_packed;
+        case line_layout::fcc12_mipi:       return fccXX_pack_type::fcc12_mipi;
+        case line_layout::fcc12_spacked:    return fccXX_pack_type::fcc12_spacked;
+        case line_layout::fcc10_mipi:       return fccXX_pack_type::fcc10_mipi;
+        case line_layout::fcc10_spacked:    return fccXX_pack_type::fcc10_spacked;
+        default:
+            return fccXX_pack_type::invalid;
+        }
+    }
+
+    constexpr int   calc_block_count( int width ) noexcept
+    {
+        return (width + block_samples - 1) / block_samples;
+    }
+
+    constexpr size_t    calc_block_size( int bit_width ) noexcept
+    {
+        return static_cast<size_t>( bit_width ) * block_lanes * sizeof( uint16_t );
+    }
+
+    inline int      calc_bit_width( uint32_t v ) noexcept
+    {
+        int n = 0;
+        while( (v >> n) != 0 ) {
+            ++n;
+        }
+        return n;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // prediction and residuals
+
+    // the median of a, b and a + b - c, the min/max is done with masks, compilers turn std::min/max of a and b into branches
+    FORCEINLINE uint16_t    predict_med( uint16_t a, uint16_t b, uint16_t c ) noexcept
+    {
+        const int d = b - a;
+        const int b_lt_a = d & (d >> 31);
+        const int mn = a + b_lt_a;
+        const int mx = b - b_lt_a;
+        const int grad = a + b - c;
+        return static_cast<uint16_t>( std::min( std::max( grad, mn ), mx ) );
+    }
+
+    FORCEINLINE uint16_t    to_residual( uint16_t v, uint16_t pred, int bits ) noexcept
+    {
+        const int shift = 16 - bits;
+        const int d = static_cast<int16_t>( static_cast<uint16_t>( static_cast<uint32_t>( v - pred ) << shift ) ) >> shift;
+        return static_cast<uint16_t>( (static_cast<uint32_t>( d ) << 1) ^ static_cast<uint32_t>( d >> 15 ) );
+    }
+
+    FORCEINLINE uint16_t    from_residual( uint16_t z, uint16_t pred, uint32_t mask ) noexcept
+    {
+        const uint32_t d = (z >> 1u) ^ (0u - (z & 1u));
+        return static_cast<uint16_t>( (pred + d) & mask );
+    }
+
+    // residuals of the samples [x_begin;width) of cur, up is the line color_stride lines above
+    FORCEINLINE void    calc_residuals_c( uint16_t* z, const uint16_t* cur, const uint16_t* up, int x_begin, int width, int color_stride, int bits ) noexcept
+    {
+        int x = x_begin;
+        for( ; x < std::min( color_stride, width ); ++x )
+        {
+            z[x] = to_residual( cur[x], up[x], bits );
+        }
+        for( ; x < width; ++x )
+        {
+            z[x] = to_residual( cur[x], predict_med( cur[x - color_stride], up[x], up[x - color_stride] ), bits );
+        }
+    }
+
+    /*
+     * The left neighbour is the sample just decoded, so this is serial in all variants. The last sample of each of
+     * the color_stride chains is kept in a local, going through cur would add the store forwarding to the chain.
+     */
+    template<int color_stride>
+    FORCEINLINE void    reconstruct_line_c( uint16_t* cur, const uint16_t* z, const uint16_t* up, int width, int bits ) noexcept
+    {
+        static_assert( color_stride == 1 || color_stride == 2, "color_stride not implemented" );
+
+        const uint32_t mask = (1u << bits) - 1;
+
+        const auto decode = [&]( int x, uint16_t left ) { return from_residual( z[x], predict_med( left, up[x], up[x - color_stride] ), mask ); };
+
+        uint16_t left0 = from_residual( z[0], up[0], mask );
+        uint16_t left1 = 0;
+        cur[0] = left0;
+        if constexpr( color_stride == 2 ) {
+            if( width > 1 ) {
+                left1 = from_residual( z[1], up[1], mask );
+                cur[1] = left1;
+            }
+        }
+
+        int x = color_stride;
+        for( ; x + color_stride <= width; x += color_stride )
+        {
+            left0 = decode( x, left0 );
+            cur[x] = left0;
+            if constexpr( color_stride == 2 ) {
+                left1 = decode( x + 1, left1 );
+                cur[x + 1] = left1;
+            }
+        }
+        if( x < width ) {
+            cur[x] = decode( x, left0 );
+        }
+    }
+
+    FORCEINLINE void    reconstruct_line_c( uint16_t* cur, const uint16_t* z, const uint16_t* up, int width, int color_stride, int bits ) noexcept
+    {
+        if( color_stride == 1 ) {
+            reconstruct_line_c<1>( cur, z, up, width, bits );
+        } else {
+            reconstruct_line_c<2>( cur, z, up, width, bits );
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // bit packing
+
+    // word j of lane l is at dst[j * 16 + l], all shifts are constant after unrolling
+    template<int n>
+    FORCEINLINE void    pack_block_c( uint16_t* dst, const uint16_t* z ) noexcept
+    {
+        for( int l = 0; l < block_lanes; ++l )
+        {
+            uint16_t word = 0;
+            int filled = 0;
+            int j = 0;
+            for( int i = 0; i < 16; ++i )
+            {
+                const uint16_t v = z[i * block_lanes + l];
+                word = static_cast<uint16_t>( word | (v << filled) );
+                if( filled + n >= 16 )
+                {
+                    dst[j++ * block_lanes + l] = word;
+                    word = filled + n > 16 ? static_cast<uint16_t>( v >> (16 - filled) ) : 0;
+                    filled -= 16;
+                }
+                filled += n;
+            }
+        }
+    }
+
+    template<int n>
+    FORCEINLINE void    unpack_block_c( uint16_t* z, const uint16_t* src ) noexcept
+    {
+        constexpr uint16_t mask = static_cast<uint16_t>( (1u << n) - 1 );
+
+        for( int l = 0; l < block_lanes; ++l )
+        {
+            int offset = 0;
+            int j = 0;
+            for( int i = 0; i < 16; ++i )
+            {
+                uint32_t v = src[j * block_lanes + l] >> offset;
+                if( offset + n > 16 ) {
+                    v |= static_cast<uint32_t>( src[(j + 1) * block_lanes + l] ) << (16 - offset);
+                }
+                z[i * block_lanes + l] = static_cast<uint16_t>( v & mask );
+
+                offset += n;
+                if( offset >= 16 ) {
+                    offset -= 16;
+                    ++j;
+                }
+            }
+        }
+    }
+
+    /*
+     * Calls func( std::integral_constant<int, n>{} ) for the bit width n in [1;16], so the block
+     * functions are instantiated for each width. n == 0 has no data.
+     */
+    template<class TFunc>
+    FORCEINLINE void    dispatch_bit_width( int n, TFunc&& func )
+    {
+        switch( n )
+        {
+        case 1:     func( std::integral_constant<int, 1>{} ); break;
+        case 2:     func( std::integral_constant<int, 2>{} ); break;
+        case 3:     func( std::integral_constant<int, 3>{} ); break;
+        case 4:     func( std::integral_constant<int, 4>{} ); break;
+        case 5:     func( std::integral_constant<int, 5>{} ); break;
+        case 6:     func( std::integral_constant<int, 6>{} ); break;
+        case 7:     func( std::integral_constant<int, 7>{} ); break;
+        case 8:     func( std::integral_constant<int, 8>{} ); break;
+        case 9:     func( std::integral_constant<int, 9>{} ); break;
+        case 10:    func( std::integral_constant<int, 10>{} ); break;
+        case 11:    func( std::integral_constant<int, 11>{} ); break;
+        case 12:    func( std::integral_constant<int, 12>{} ); break;
+        case 13:    func( std::integral_constant<int, 13>{} ); break;
+        case 14:    func( std::integral_constant<int, 14>{} ); break;
+        case 15:    func( std::integral_constant<int, 15>{} ); break;
+        case 16:    func( std::integral_constant<int, 16>{} ); break;
+        default:
+            break;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // line unpack/repack
+
+    // the samples [x_begin;width) of src_line in their native bit depth
+    template<line_layout layout>
+    FORCEINLINE void    unpack_line_c( uint16_t* dst, const uint8_t* src_line, int x_begin, int width ) noexcept
+    {
+        using namespace fcc1x_packed_internal;
+
+        for( int x = x_begin; x < width; ++x )
+        {
+            if constexpr( layout == line_layout::u8 )                       dst[x] = src_line[x];
+            else if constexpr( layout == line_layout::u16 )                 dst[x] = reinterpret_cast<const uint16_t*>( src_line )[x];
+            else if constexpr( layout == line_layout::fcc12_packed )        dst[x] = calc_fcc12_packed_to_fcc16( src_line, x ) >> 4;
+            else if constexpr( layout == line_layout::fcc12_mipi )          dst[x] = calc_fcc12_mipi_to_fcc16( src_line, x ) >> 4;
+            else if constexpr( layout == line_layout::fcc12_spacked )       dst[x] = calc_fcc12_spacked_to_fcc16( src_line, x ) >> 4;
+            else if constexpr( layout == line_layout::fcc10_mipi )          dst[x] = calc_fcc10_packed_mipi_to_fcc16( src_line, x ) >> 6;
+            else if constexpr( layout == line_layout::fcc10_spacked )       dst[x] = calc_fcc10_spacked_to_fcc16( src_line, x ) >> 6;
+        }
+    }
+
+    // the inverse of unpack_line_c, width is a multiple of the group pixels of layout
+    template<line_layout layout>
+    FORCEINLINE void    repack_line_c( uint8_t* dst_line, const uint16_t* src, int width ) noexcept
+    {
+        if constexpr( layout == line_layout::u8 )
+        {
+            for( int x = 0; x < width; ++x ) {
+                dst_line[x] = static_cast<uint8_t>( src[x] );
+            }
+        }
+        else if constexpr( layout == line_layout::u16 )
+        {
+            memcpy( dst_line, src, width * sizeof( uint16_t ) );
+        }
+        else if constexpr( layout == line_layout::fcc10_mipi || layout == line_layout::fcc10_spacked )
+        {
+            for( int x = 0; x < width; x += 4 )
+            {
+                const uint32_t v0 = src[x + 0], v1 = src[x + 1], v2 = src[x + 2], v3 = src[x + 3];
+                uint8_t* dst = dst_line + (x / 4) * 5;
+                if constexpr( layout == line_layout::fcc10_mipi )
+                {
+                    dst[0] = static_cast<uint8_t>( v0 >> 2 );
+                    dst[1] = static_cast<uint8_t>( v1 >> 2 );
+                    dst[2] = static_cast<uint8_t>( v2 >> 2 );
+                    dst[3] = static_cast<uint8_t>( v3 >> 2 );
+                    dst[4] = static_cast<uint8_t>( (v0 & 3) | (v1 & 3) << 2 | (v2 & 3) << 4 | (v3 & 3) << 6 );
+                }
+                else
+                {
+                    const uint64_t bits = uint64_t( v0 ) | uint64_t( v1 ) << 10 | uint64_t( v2 ) << 20 | uint64_t( v3 ) << 30;
+                    for( int k = 0; k < 5; ++k ) {
+                        dst[k] = static_cast<uint8_t>( bits >> (k * 8) );
+                    }
+                }
+            }
+        }
+        else
+        {
+            for( int x = 0; x < width; x += 2 )
+            {
+                const uint32_t v0 = src[x + 0], v1 = src[x + 1];
+                uint8_t* dst = dst_line + (x / 2) * 3;
+                if constexpr( layout == line_layout::fcc12_packed )
+                {
+                    dst[0] = static_cast<uint8_t>( v0 >> 4 );
+                    dst[1] = static_cast<uint8_t>( (v0 & 0xF) | (v1 & 0xF) << 4 );
+                    dst[2] = static_cast<uint8_t>( v1 >> 4 );
+                }
+                else if constexpr( layout == line_layout::fcc12_mipi )
+                {
+                    dst[0] = static_cast<uint8_t>( v0 >> 4 );
+                    dst[1] = static_cast<uint8_t>( v1 >> 4 );
+                    dst[2] = static_cast<uint8_t>( (v0 & 0xF) | (v1 & 0xF) << 4 );
+                }
+                else
+                {
+                    dst[0] = static_cast<uint8_t>( v0 & 0xFF );
+                    dst[1] = static_cast<uint8_t>( (v0 >> 8) | (v1 & 0xF) << 4 );
+                    dst[2] = static_cast<uint8_t>( v1 >> 4 );
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // frame loops
+
+    // the sample lines of the last color_stride + 1 lines, an all 0 line for the first lines and the residuals of one line
+    struct line_buffers
+    {
+        line_buffers( int width, int color_stride )
+            : line_count_( color_stride + 1 ), line_length_( calc_block_count( width ) * block_samples )
+        {
+            thread_local std::vector<uint16_t> buffer;
+
+            const size_t size = static_cast<size_t>( line_length_ ) * (line_count_ + 2);
+            if( buffer.size() < size ) {
+                buffer.resize( size );
+            }
+            data_ = buffer.data();
+
+            // the 0 line and the residuals past the end of a line
+            std::fill( data_, data_ + 2 * line_length_, uint16_t( 0 ) );
+        }
+
+        uint16_t*   residuals() const noexcept { return data_ + line_length_; }
+        uint16_t*   line( int y ) const noexcept { return data_ + static_cast<size_t>( 2 + y % line_count_ ) * line_length_; }
+        uint16_t*   up_line( int y, int color_stride ) const noexcept { return y < color_stride ? data_ : line( y - color_stride ); }
+
+    private:
+        int         line_count_;
+        int         line_length_;
+        uint16_t*   data_;
+    };
+
+    inline frame_header     make_header( const img::img_type& type, const format_info& info ) noexcept
+    {
+        frame_header hdr = {};
+        hdr.magic = frame_magic;
+        hdr.version = frame_version;
+        hdr.sample_bits = static_cast<uint8_t>( info.sample_bits );
+        hdr.color_stride = static_cast<uint8_t>( info.color_stride );
+        hdr.fourcc = type.type;
+        hdr.width = static_cast<uint32_t>( type.dim.cx );
+        hdr.height = static_cast<uint32_t>( type.dim.cy );
+        return hdr;
+    }
+
+    inline size_t   calc_max_line_size( int width, int sample_bits ) noexcept
+    {
+        return calc_block_count( width ) * (1 + calc_block_size( sample_bits ));
+    }
+
+    /*
+     * TKernel provides the simd parts:
+     *      template<line_layout> static void unpack_line( uint16_t* dst, const uint8_t* src_line, int width );
+     *      static void calc_residuals( uint16_t* z, const uint16_t* cur, const uint16_t* up, int width, int color_stride, int bits );
+     *      static int  calc_block_bit_width( const uint16_t* z );
+     *      static void pack_block( uint16_t* dst, const uint16_t* z, int n );
+     *      static void unpack_block( uint16_t* z, const uint16_t* src, int n );
+     */
+    template<class TKernel, line_layout layout>
+    size_t      encode_frame( const img::img_descriptor& src, void* dst, size_t dst_size )
+    {
+        const auto info = get_format_info( src.fourcc_type() );
+        const int width = src.dim.cx;
+        const int block_count = calc_block_count( width );
+
+        if( dst_size < img_filter::codec::lossless::calc_max_encoded_size( src.to_img_type() ) ) {
+            return 0;
+        }
+
+        line_buffers buffers{ width, info.color_stride };
+
+        auto* out = static_cast<uint8_t*>( dst ) + sizeof( frame_header );
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            uint16_t* cur = buffers.line( y );
+            uint16_t* z = buffers.residuals();
+
+            TKernel::template unpack_line<layout>( cur, img::get_line_start<const uint8_t>( src, y ), width );
+            TKernel::calc_residuals( z, cur, buffers.up_line( y, info.color_stride ), width, info.color_stride, info.sample_bits );
+
+            uint8_t* bit_widths = out;
+            out += block_count;
+            for( int b = 0; b < block_count; ++b )
+            {
+                const int n = TKernel::calc_block_bit_width( z + b * block_samples );
+
+                // packed into an aligned u16 buffer, the stream itself has no alignment
+                alignas(32) uint16_t packed[block_samples];
+                TKernel::pack_block( packed, z + b * block_samples, n );
+
+                bit_widths[b] = static_cast<uint8_t>( n );
+                memcpy( out, packed, calc_block_size( n ) );
+                out += calc_block_size( n );
+            }
+        }
+
+        frame_header hdr = make_header( src.to_img_type(), info );
+        hdr.payload_size = static_cast<uint32_t>( out - static_cast<uint8_t*>( dst ) - sizeof( frame_header ) );
+        memcpy( dst, &hdr, sizeof( hdr ) );
+
+        return out - static_cast<uint8_t*>( dst );
+    }
+
+    template<class TKernel, line_layout layout>
+    bool        decode_frame( const img::img_descriptor& dst, const void* src, size_t src_size )
+    {
+        const auto info = get_format_info( dst.fourcc_type() );
+        const int width = dst.dim.cx;
+        const int block_count = calc_block_count( width );
+
+        if( src_size < sizeof( frame_header ) ) {
+            return false;
+        }
+
+        frame_header hdr;
+        memcpy( &hdr, src, sizeof( hdr ) );
+
+        const auto expected = make_header( dst.to_img_type(), info );
+        if( hdr.magic != expected.magic || hdr.version != expected.version || hdr.fourcc != expected.fourcc
+            || hdr.width != expected.width || hdr.height != expected.height
+            || hdr.sample_bits != expected.sample_bits || hdr.color_stride != expected.color_stride ) {
+            return false;
+        }
+        if( hdr.payload_size > src_size - sizeof( frame_header ) ) {
+            return false;
+        }
+
+        line_buffers buffers{ width, info.color_stride };
+
+        const auto* in = static_cast<const uint8_t*>( src ) + sizeof( frame_header );
+        const auto* in_end = in + hdr.payload_size;
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            if( in_end - in < block_count ) {
+                return false;
+            }
+            const uint8_t* bit_widths = in;
+            in += block_count;
+
+            uint16_t* z = buffers.residuals();
+            for( int b = 0; b < block_count; ++b )
+            {
+                const int n = bit_widths[b];
+                if( n > info.sample_bits || static_cast<size_t>( in_end - in ) < calc_block_size( n ) ) {
+                    return false;
+                }
+
+                alignas(32) uint16_t packed[block_samples];
+                memcpy( packed, in, calc_block_size( n ) );
+                TKernel::unpack_block( z + b * block_samples, packed, n );
+
+                in += calc_block_size( n );
+            }
+
+            uint16_t* cur = buffers.line( y );
+            reconstruct_line_c( cur, z, buffers.up_line( y, info.color_stride ), width, info.color_stride, info.sample_bits );
+            repack_line_c<layout>( img::get_line_start<uint8_t>( dst, y ), cur, width );
+        }
+        return in == in_end;
+    }
+
+    template<class TKernel>
+    img_filter::codec::lossless::encode_function_type   select_encode( const img::img_type& type ) noexcept
+    {
+        if( !img_filter::codec::lossless::is_supported_type( type ) ) {
+            return nullptr;
+        }
+        switch( get_format_info( type.fourcc_type() ).layout )
+        {
+        case line_layout::u8:               return &encode_frame<TKernel, line_layout::u8>;
+        case line_layout::u16:              return &encode_frame<TKernel, line_layout::u16>;
+        case line_layout::fcc12_packed:     return &encode_frame<TKernel, line_layout::fcc12_packed>;
+        case line_layout::fcc12_mipi:       return &encode_frame<TKernel, line_layout::fcc12_mipi>;
+        case line_layout::fcc12_spacked:    return &encode_frame<TKernel, line_layout::fcc12_spacked>;
+        case line_layout::fcc10_mipi:       return &encode_frame<TKernel, line_layout::fcc10_mipi>;
+        case line_layout::fcc10_spacked:    return &encode_frame<TKernel, line_layout::fcc10_spacked>;
+        case line_layout::invalid:          return nullptr;
+        };
+        return nullptr;
+    }
+
+    template<class TKernel>
+    img_filter::codec::lossless::decode_function_type   select_decode( const img::img_type& type ) noexcept
+    {
+        if( !img_filter::codec::lossless::is_supported_type( type ) ) {
+            return nullptr;
+        }
+        switch( get_format_info( type.fourcc_type() ).layout )
+        {
+        case line_layout::u8:               return &decode_frame<TKernel, line_layout::u8>;
+        case line_layout::u16:              return &decode_frame<TKernel, line_layout::u16>;
+        case line_layout::fcc12_packed:     return &decode_frame<TKernel, line_layout::fcc12_packed>;
+        case line_layout::fcc12_mipi:       return &decode_frame<TKernel, line_layout::fcc12_mipi>;
+        case line_layout::fcc12_spacked:    return &decode_frame<TKernel, line_layout::fcc12_spacked>;
+        case line_layout::fcc10_mipi:       return &decode_frame<TKernel, line_layout::fcc10_mipi>;
+        case line_layout::fcc10_spacked:    return &decode_frame<TKernel, line_layout::fcc10_spacked>;
+        case line_layout::invalid:          return nullptr;
+        };
+        return nullptr;
+    }
+}
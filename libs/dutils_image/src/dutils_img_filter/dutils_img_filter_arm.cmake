@@ -5,6 +5,12 @@ add_library( dutils_img_filter_neon STATIC
 	"by_edge/by_edge.h"
 	"by_edge/by_edge_internal.h"
 	"by_edge/by8_edge_neonv8_v0.cpp"
+	"by_edge/byfloat_edge_internal.h"
+	"by_edge/byfloat_edge_neon.cpp"
+	"by_edge/by16_edge_internal.h"
+	"by_edge/by16_edge_neon.cpp"
+	"by_edge/by8_yuv_internal.h"
+	"by_edge/by8_edge_yuv_neon.cpp"
 
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_neon_v0.cpp"
@@ -19,10 +25,20 @@ add_library( dutils_img_filter_neon STATIC
 	"filter/whitebalance/wb_apply_neon.cpp"
 	"filter/whitebalance/wb_apply_by8_neon.cpp"
 	"filter/whitebalance/wb_apply_by16_neon.cpp"
+	"filter/whitebalance/wb_apply_byfloat_neon.cpp"
+
+	"filter/flat_field/flat_field.h"
+	"filter/flat_field/flat_field_neon.cpp"
+
+	"filter/frame_accumulate/frame_accumulate.h"
+	"filter/frame_accumulate/frame_accumulate_neon.cpp"
 
 	"transform/mono_to_bgr/transform_mono_to_bgr_neon.cpp"
+	"transform/bayer_binning/transform_bayer_binning_neon.cpp"
 
 	"transform/fcc8_fcc16/transform_fcc8_fcc16_neon_v0.cpp"
+
+	"transform/pwl/transform_pwl_neon.cpp"
 )
 
 target_link_libraries( dutils_img_filter_neon
@@ -35,6 +51,27 @@ PRIVATE
 
 if( ${CMAKE_SYSTEM_PROCESSOR} MATCHES "aarch64" )
 
+# the SVE2 kernels are only called after a runtime check of img::cpu features, so the rest of the library stays ARMv8.0
+include( CheckCXXCompilerFlag )
+check_cxx_compiler_flag( "-march=armv8-a+sve2" DUTILS_IMG_COMPILER_HAS_SVE2 )
+
+if( DUTILS_IMG_COMPILER_HAS_SVE2 )
+
+	set( dutils_img_filter_sve2_sources
+		"by_edge/by8_edge_sve2.cpp"
+		"transform/fcc1x_packed/transform_fcc1x_to_fcc8_sve2.cpp"
+		"transform/fcc8_fcc16/transform_fcc8_fcc16_sve2.cpp"
+		"filter/whitebalance/wb_apply_sve2.cpp"
+	)
+
+	target_sources( dutils_img_filter_neon PRIVATE ${dutils_img_filter_sve2_sources} )
+	set_source_files_properties( ${dutils_img_filter_sve2_sources} PROPERTIES COMPILE_FLAGS "-march=armv8-a+sve2" )
+
+	# users of the library only list the sve2 kernels when they were built
+	target_compile_definitions( dutils_img_filter_neon PUBLIC DUTILS_IMG_FILTER_HAS_SVE2=1 )
+
+endif()
+
 elseif( ${CMAKE_SYSTEM_PROCESSOR} MATCHES "arm" )
 
 target_compile_options( dutils_img_filter_neon PUBLIC -mfpu=neon-vfpv4 )	# This is needed as a minimum for building this neon code in arm32 mode
@@ -5,18 +5,55 @@ add_library( dutils_img_filter_sse41 STATIC
 	"by_edge/by_edge.h"
 	"by_edge/by_edge_internal.h"
 	"by_edge/by8_edge_sse4_1_v0.cpp"
+	"by_edge/by8_edge_avx2_v0.cpp"
+	"by_edge/by8_edge_avx512bw_v0.cpp"
+	"by_edge/byfloat_edge_internal.h"
+	"by_edge/byfloat_edge_avx2.cpp"
+	"by_edge/by16_edge_internal.h"
+	"by_edge/by16_edge_sse41.cpp"
+	"by_edge/by16_edge_avx2.cpp"
+	"by_edge/by8_yuv_internal.h"
+	"by_edge/by8_edge_yuv_sse41.cpp"
+	"by_edge/byfloat_yuv_internal.h"
+	"by_edge/byfloat_edge_yuv_avx2.cpp"
 
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_ssse3_v0.cpp"
 	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_ssse3_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_avx2_internal.h"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc8_avx2_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc16_avx2_v0.cpp"
+	"transform/fcc1x_packed/fcc1x_packed_to_fcc_avx512vbmi_v0.cpp"
+	"transform/fcc1x_packed/transform_fcc1x_to_fcc8_ssse3.cpp"
+	"transform/fcc1x_packed/transform_fcc1x_to_fcc8_avx2.cpp"
 
 	"transform/fcc8_fcc16/transform_fcc8_fcc16_sse4_v0.cpp"
+	"transform/fcc8_fcc16/transform_fccXX_to_fcc8_lut_avx2.cpp"
+	"transform/fcc8_fcc16/transform_fccXX_to_fccfloat_avx2.cpp"
+
+	"transform/tensor/transform_tensor_avx2.cpp"
+
+	"transform/pwl/transform_pwl_sse41.cpp"
+	"transform/pwl/transform_pwl_avx2.cpp"
 
 	"filter/whitebalance/wb_apply.h"
 	"filter/whitebalance/wb_apply_sse41.cpp"
 	"filter/whitebalance/wb_apply_by16_sse4_1.cpp"
 	"filter/whitebalance/wb_apply_by8_sse2.cpp"
+	"filter/whitebalance/wb_apply_byfloat_avx2.cpp"
+
+	"filter/flat_field/flat_field.h"
+	"filter/flat_field/flat_field_sse41.cpp"
+	"filter/flat_field/flat_field_avx2.cpp"
+
+	"filter/frame_accumulate/frame_accumulate.h"
+	"filter/frame_accumulate/frame_accumulate_sse41.cpp"
+	"filter/frame_accumulate/frame_accumulate_avx2.cpp"
 
 	"transform/mono_to_bgr/transform_mono_to_bgr_sse41.cpp"
+	"transform/bayer_binning/transform_bayer_binning_sse41.cpp"
+	"transform/polarization/transform_polarization_sse41.cpp"
+
+	"codec/lossless/lossless_codec_avx2.cpp"
 )
 
 target_link_libraries( dutils_img_filter_sse41
@@ -27,6 +64,35 @@ PRIVATE
 	dutils_img::project_warnings
 )
 
-target_compile_options( dutils_img_filter_sse41 PUBLIC -msse4.1 )
+# PRIVATE, code linking this must stay runnable on cpus without sse4.1
+target_compile_options( dutils_img_filter_sse41 PRIVATE -msse4.1 )
+
+# these are only called after a runtime check of img::cpu features
+set_source_files_properties( "transform/fcc1x_packed/fcc1x_packed_to_fcc16_ssse3_v0.cpp" PROPERTIES COMPILE_FLAGS "-mno-sse4.1 -mssse3" )
+set_source_files_properties( "transform/fcc1x_packed/fcc1x_packed_to_fcc8_ssse3_v0.cpp" PROPERTIES COMPILE_FLAGS "-mno-sse4.1 -mssse3" )
+set_source_files_properties( "transform/fcc1x_packed/transform_fcc1x_to_fcc8_ssse3.cpp" PROPERTIES COMPILE_FLAGS "-mno-sse4.1 -mssse3" )
+set_source_files_properties( "transform/fcc1x_packed/transform_fcc1x_to_fcc8_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/fcc1x_packed/fcc1x_packed_to_fcc8_avx2_v0.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/fcc1x_packed/fcc1x_packed_to_fcc16_avx2_v0.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/fcc1x_packed/fcc1x_packed_to_fcc_avx512vbmi_v0.cpp" PROPERTIES COMPILE_FLAGS "-mavx512f -mavx512bw -mavx512vbmi" )
+set_source_files_properties( "transform/pwl/transform_pwl_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/fcc8_fcc16/transform_fccXX_to_fcc8_lut_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/fcc8_fcc16/transform_fccXX_to_fccfloat_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "transform/tensor/transform_tensor_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2 -mf16c" )
+set_source_files_properties( "by_edge/by8_edge_avx2_v0.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "by_edge/byfloat_edge_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "by_edge/by16_edge_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "by_edge/byfloat_edge_yuv_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "filter/whitebalance/wb_apply_byfloat_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "filter/flat_field/flat_field_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "filter/frame_accumulate/frame_accumulate_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "codec/lossless/lossless_codec_avx2.cpp" PROPERTIES COMPILE_FLAGS "-mavx2" )
+set_source_files_properties( "by_edge/by8_edge_avx512bw_v0.cpp" PROPERTIES COMPILE_FLAGS "-mavx512f -mavx512bw" )
+
+# with -ffast-math gcc replaces vector divisions by rcpps and a newton step, scalar divisions stay exact.
+# These kernels have to match their c variants bit for bit.
+if( CMAKE_CXX_COMPILER_ID STREQUAL "GNU" )
+	set_source_files_properties( "transform/polarization/transform_polarization_sse41.cpp" PROPERTIES COMPILE_FLAGS "-mno-recip" )
+endif()
 
 add_library( dutils_img::img_filter_optimized ALIAS dutils_img_filter_sse41 )
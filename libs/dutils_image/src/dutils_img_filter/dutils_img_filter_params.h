@@ -27,11 +27,45 @@ namespace img_filter
     }
 
     struct pwl12_to_fcc8_wb_map_data;
+    struct fccXX_to_fcc8_lut_data;
+    struct defect_pixel_map;
+    struct flat_field_data;
+
+    /**
+     * Finds the position of views and strips of a frame through their plane_ptr.
+     * frame_offset is the position of the frame itself, e.g. of a ROI in the full image.
+     */
+    struct frame_locator
+    {
+        const uint8_t*  frame_ptr = nullptr;
+        int             frame_pitch = 0;
+        int             frame_bits_per_pixel = 0;
+        img::point      frame_offset;
+
+        static frame_locator    make( const img::img_descriptor& frame, img::point offset = {} ) noexcept
+        {
+            return frame_locator{ img::get_line_start( frame, 0 ), frame.pitch(), img::get_bits_per_pixel( frame.fourcc_type() ), offset };
+        }
+
+        img::point      locate( const img::img_descriptor& view ) const noexcept
+        {
+            const auto offset = img::get_line_start( view, 0 ) - frame_ptr;
+            const auto y = static_cast<int>( offset / frame_pitch );
+            const auto x = static_cast<int>( (offset % frame_pitch) * 8 / frame_bits_per_pixel );
+            return img::point{ frame_offset.x + x, frame_offset.y + y };
+        }
+    };
 
     struct filter_params
     {
         whitebalance_params             whitebalance;
         pwl12_to_fcc8_wb_map_data*      pwl12_to_fcc8_wb_lut = nullptr;
+        fccXX_to_fcc8_lut_data*         fccXX_to_fcc8_lut = nullptr;
+
+        // corrected after unpacking, frame locates the unpacked strips in the maps
+        const frame_locator*            frame = nullptr;
+        const defect_pixel_map*         defect_pixels = nullptr;
+        const flat_field_data*          flat_field = nullptr;
     };
 
     struct bayer_pattern_parameters
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+#include <vector>
+
+namespace img_filter
+{
+    /**
+     * Defect pixels of a sensor, in coordinates of the full frame.
+     * Sorted by y, then x, without duplicates, see defect_pixel::normalize.
+     */
+    struct defect_pixel_map
+    {
+        std::vector<img::point> pixels;
+    };
+
+namespace defect_pixel
+{
+    void    normalize( defect_pixel_map& map );
+
+    // the unpacked bayer formats, 8/16 bit and float
+    bool    can_correct( img::fourcc fcc ) noexcept;
+
+    /**
+     * Corrects the defects within img in place, pos is the position of img in the coordinates of map.
+     * Defects are replaced by the median of the same color pixels 2 pixels away,
+     * only the neighbours inside img that are no defects themselves are used.
+     * The cost depends on the number of defects within img, not on the size of img.
+     */
+    void    correct( const img::img_descriptor& img, img::point pos, const defect_pixel_map& map ) noexcept;
+}
+}
@@ -0,0 +1,86 @@
+#include "defect_pixel.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    constexpr bool  less_yx( const img::point& lhs, const img::point& rhs ) noexcept
+    {
+        return lhs.y != rhs.y ? lhs.y < rhs.y : lhs.x < rhs.x;
+    }
+
+    bool    is_defect( const img_filter::defect_pixel_map& map, img::point pt ) noexcept
+    {
+        return std::binary_search( map.pixels.begin(), map.pixels.end(), pt, less_yx );
+    }
+
+    template<typename TPixel>
+    void    correct_pixels( const img::img_descriptor& img, img::point pos, const img_filter::defect_pixel_map& map ) noexcept
+    {
+        static const constexpr img::point neighbours[] = {
+            { -2, -2 }, { 0, -2 }, { 2, -2 },
+            { -2,  0 },            { 2,  0 },
+            { -2,  2 }, { 0,  2 }, { 2,  2 },
+        };
+
+        const auto first = std::lower_bound( map.pixels.begin(), map.pixels.end(), pos, less_yx );
+        for( auto it = first; it != map.pixels.end() && it->y < pos.y + img.dim.cy; ++it )
+        {
+            const int x = it->x - pos.x;
+            const int y = it->y - pos.y;
+            if( x < 0 || x >= img.dim.cx ) {
+                continue;
+            }
+
+            TPixel values[std::size( neighbours )];
+            int count = 0;
+            for( const auto& n : neighbours )
+            {
+                const int nx = x + n.x;
+                const int ny = y + n.y;
+                if( nx < 0 || ny < 0 || nx >= img.dim.cx || ny >= img.dim.cy ) {
+                    continue;
+                }
+                if( is_defect( map, { it->x + n.x, it->y + n.y } ) ) {
+                    continue;
+                }
+                values[count++] = img::get_line_start<TPixel>( img, ny )[nx];
+            }
+            if( count == 0 ) {
+                continue;
+            }
+
+            // the upper median for an even count, no averaging keeps the type generic
+            std::nth_element( values, values + count / 2, values + count );
+            img::get_line_start<TPixel>( img, y )[x] = values[count / 2];
+        }
+    }
+}
+
+void    img_filter::defect_pixel::normalize( defect_pixel_map& map )
+{
+    std::sort( map.pixels.begin(), map.pixels.end(), less_yx );
+    map.pixels.erase( std::unique( map.pixels.begin(), map.pixels.end() ), map.pixels.end() );
+}
+
+bool    img_filter::defect_pixel::can_correct( img::fourcc fcc ) noexcept
+{
+    return img::is_by8_fcc( fcc ) || img::is_by16_fcc( fcc ) || img::is_byfloat_fcc( fcc );
+}
+
+void    img_filter::defect_pixel::correct( const img::img_descriptor& img, img::point pos, const defect_pixel_map& map ) noexcept
+{
+    if( map.pixels.empty() ) {
+        return;
+    }
+
+    const auto fcc = img.fourcc_type();
+    if( img::is_by8_fcc( fcc ) ) {
+        correct_pixels<uint8_t>( img, pos, map );
+    } else if( img::is_by16_fcc( fcc ) ) {
+        correct_pixels<uint16_t>( img, pos, map );
+    } else if( img::is_byfloat_fcc( fcc ) ) {
+        correct_pixels<float>( img, pos, map );
+    }
+}
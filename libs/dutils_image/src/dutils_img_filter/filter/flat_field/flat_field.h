@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace img_filter
+{
+    /**
+     * Gain grid for lens shading (vignetting) and color shading, e.g. computed from a flat field capture.
+     * The grid points are the centers of cols x rows equal cells over the frame, independent of its size.
+     * Every grid point has one gain per position in the 2x2 bayer block, so the map fits any bayer pattern
+     * as long as the frames start at the same pattern position as the flat field capture.
+     */
+    struct flat_field_map
+    {
+        int     cols = 0;
+        int     rows = 0;
+
+        // indexed by (y % 2) * 2 + (x % 2), each rows * cols gains
+        std::vector<float>  gains[4];
+    };
+
+namespace flat_field
+{
+    // gains are stored in 1 / (1 << gain_shift) steps and fit into int16_t, so the kernels interpolate in 16 bit lanes
+    static const constexpr int      gain_shift = 11;
+    static const constexpr float    max_gain = 15.f;
+
+    /**
+     * Multiplies count pixels of line by gain = gains_a + (gains_b - gains_a) * weight_b / 256, weight_b in [0;255].
+     * Results are clipped to the range of the format.
+     */
+    using line_func = void (*)( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count );
+
+    line_func   get_line_func_c( img::fourcc fcc );         // by8, by16 and bayer float
+    line_func   get_line_func_sse41( img::fourcc fcc );     // by8 and by16
+    line_func   get_line_func_avx2( img::fourcc fcc );      // by8 and by16
+    line_func   get_line_func_neon( img::fourcc fcc );      // by8 and by16
+
+    struct line_funcs
+    {
+        line_func   by8 = nullptr;
+        line_func   by16 = nullptr;
+        line_func   byfloat = nullptr;
+    };
+}
+
+    /**
+     * flat_field_map expanded for frames of one dim, see flat_field::prepare.
+     * Holds the gain of every pixel of a line for each grid row and line parity,
+     * a line interpolates between the rows of the grid rows above and below it.
+     */
+    struct flat_field_data
+    {
+        img::dim                    frame_dim;
+        int                         rows = 0;
+        // [y % 2][row][x]
+        std::vector<uint16_t>       gains;
+
+        flat_field::line_funcs      funcs;
+    };
+
+namespace flat_field
+{
+    // the unpacked bayer formats, 8/16 bit and float
+    bool    can_apply( img::fourcc fcc ) noexcept;
+
+    /**
+     * Builds the map from a flat field capture, an image of an evenly lit, unstructured target.
+     * flat has to be a 8 or 16 bit bayer or mono image of the same sensor.
+     * Each bayer position is normalized to its brightest cell, gains are clipped to [1;max_gain].
+     */
+    flat_field_map  make_map( const img::img_descriptor& flat, int cols, int rows );
+
+    // expands map for frames of frame_dim
+    void    prepare( flat_field_data& data, const flat_field_map& map, img::dim frame_dim, const line_funcs& funcs );
+
+    /**
+     * Applies the gains in place, pos is the position of img in the frame data was prepared for.
+     * Formats without a line_func in data are left alone.
+     */
+    void    apply( const img::img_descriptor& img, img::point pos, const flat_field_data& data ) noexcept;
+}
+}
@@ -0,0 +1,71 @@
+#include "flat_field_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace img_filter::flat_field;
+
+    FORCEINLINE
+    __m256i     gain_avx2_step_( const uint16_t* gains_a, const uint16_t* gains_b, __m256i weight ) noexcept
+    {
+        const __m256i a = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( gains_a ) );
+        const __m256i b = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( gains_b ) );
+
+        return _mm256_add_epi16( a, _mm256_mulhrs_epi16( _mm256_sub_epi16( b, a ), weight ) );
+    }
+
+    void    apply_line_by8_avx2( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint8_t* dst = static_cast<uint8_t*>( line );
+        const __m256i weight = _mm256_set1_epi16( static_cast<int16_t>( weight_b << 7 ) );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + x ) );
+            const __m256i gain = gain_avx2_step_( gains_a + x, gains_b + x, weight );
+
+            const __m256i src = _mm256_slli_epi16( _mm256_cvtepu8_epi16( pixels ), 16 - gain_shift );
+            const __m256i res = _mm256_mulhi_epu16( src, gain );
+
+            // packus works per 128 bit lane, so pack the two halves with sse
+            const __m128i res8 = _mm_packus_epi16( _mm256_castsi256_si128( res ), _mm256_extracti128_si256( res, 1 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), res8 );
+        }
+        detail::apply_by8( dst, gains_a, gains_b, weight_b, x, count );
+    }
+
+    void    apply_line_by16_avx2( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint16_t* dst = static_cast<uint16_t*>( line );
+        const __m256i weight = _mm256_set1_epi16( static_cast<int16_t>( weight_b << 7 ) );
+        const __m256i overflow_limit = _mm256_set1_epi16( (1 << gain_shift) - 1 );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m256i pixels = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( dst + x ) );
+            const __m256i gain = gain_avx2_step_( gains_a + x, gains_b + x, weight );
+
+            const __m256i hi = _mm256_mulhi_epu16( pixels, gain );
+            const __m256i lo = _mm256_mullo_epi16( pixels, gain );
+            const __m256i res = _mm256_or_si256( _mm256_slli_epi16( hi, 16 - gain_shift ), _mm256_srli_epi16( lo, gain_shift ) );
+
+            const __m256i overflow = _mm256_cmpgt_epi16( hi, overflow_limit );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + x ), _mm256_or_si256( res, overflow ) );
+        }
+        detail::apply_by16( dst, gains_a, gains_b, weight_b, x, count );
+    }
+}
+
+img_filter::flat_field::line_func   img_filter::flat_field::get_line_func_avx2( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) ) {
+        return &apply_line_by8_avx2;
+    }
+    if( img::is_by16_fcc( fcc ) ) {
+        return &apply_line_by16_avx2;
+    }
+    return nullptr;
+}
@@ -0,0 +1,205 @@
+#include "flat_field_internal.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    using namespace img_filter::flat_field;
+
+    void    apply_line_by8_c( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        detail::apply_by8( static_cast<uint8_t*>( line ), gains_a, gains_b, weight_b, 0, count );
+    }
+
+    void    apply_line_by16_c( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        detail::apply_by16( static_cast<uint16_t*>( line ), gains_a, gains_b, weight_b, 0, count );
+    }
+
+    void    apply_line_byfloat_c( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        constexpr float scale = 1.f / (1 << gain_shift);
+
+        float* dst = static_cast<float*>( line );
+        for( int x = 0; x < count; ++x )
+        {
+            const float val = dst[x] * (detail::interpolate_gain( gains_a[x], gains_b[x], weight_b ) * scale);
+            dst[x] = val > 1.f ? 1.f : val;
+        }
+    }
+
+    // position of the coordinate in a grid of count points at the centers of count cells over size
+    struct grid_pos
+    {
+        int     idx0;
+        int     idx1;
+        float   weight1;
+    };
+
+    grid_pos    to_grid_pos( int coord, int size, int count ) noexcept
+    {
+        const float pos = (coord + 0.5f) * count / size - 0.5f;
+        if( pos <= 0.f ) {
+            return { 0, 0, 0.f };
+        }
+        if( pos >= count - 1 ) {
+            return { count - 1, count - 1, 0.f };
+        }
+        const int idx0 = static_cast<int>( pos );
+        return { idx0, idx0 + 1, pos - idx0 };
+    }
+
+    template<typename TPixel>
+    void    sum_cells( const img::img_descriptor& flat, int cols, int rows, std::vector<double>( &sums )[4], std::vector<int>( &counts )[4] )
+    {
+        for( int y = 0; y < flat.dim.cy; ++y )
+        {
+            const auto* line = img::get_line_start<const TPixel>( flat, y );
+            const int row = y * rows / flat.dim.cy;
+            for( int x = 0; x < flat.dim.cx; ++x )
+            {
+                const int plane = (y % 2) * 2 + (x % 2);
+                const int cell = row * cols + x * cols / flat.dim.cx;
+                sums[plane][cell] += line[x];
+                counts[plane][cell] += 1;
+            }
+        }
+    }
+}
+
+img_filter::flat_field::line_func   img_filter::flat_field::get_line_func_c( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) ) {
+        return &apply_line_by8_c;
+    }
+    if( img::is_by16_fcc( fcc ) ) {
+        return &apply_line_by16_c;
+    }
+    if( img::is_byfloat_fcc( fcc ) ) {
+        return &apply_line_byfloat_c;
+    }
+    return nullptr;
+}
+
+bool    img_filter::flat_field::can_apply( img::fourcc fcc ) noexcept
+{
+    return img::is_by8_fcc( fcc ) || img::is_by16_fcc( fcc ) || img::is_byfloat_fcc( fcc );
+}
+
+img_filter::flat_field_map  img_filter::flat_field::make_map( const img::img_descriptor& flat, int cols, int rows )
+{
+    const int bits_per_pixel = img::get_bits_per_pixel( flat.fourcc_type() );
+    const bool is_8bit = img::is_by8_fcc( flat.fourcc_type() ) || (img::is_mono_fcc( flat.fourcc_type() ) && bits_per_pixel == 8);
+    const bool is_16bit = img::is_by16_fcc( flat.fourcc_type() ) || (img::is_mono_fcc( flat.fourcc_type() ) && bits_per_pixel == 16);
+    if( !is_8bit && !is_16bit ) {
+        return {};
+    }
+    if( flat.dim.cx < 2 || flat.dim.cy < 2 ) {
+        return {};
+    }
+    // every cell needs all 4 bayer positions
+    cols = std::clamp( cols, 1, flat.dim.cx / 2 );
+    rows = std::clamp( rows, 1, flat.dim.cy / 2 );
+
+    std::vector<double> sums[4];
+    std::vector<int> counts[4];
+    for( int plane = 0; plane < 4; ++plane )
+    {
+        sums[plane].assign( cols * rows, 0. );
+        counts[plane].assign( cols * rows, 0 );
+    }
+
+    if( is_8bit ) {
+        sum_cells<uint8_t>( flat, cols, rows, sums, counts );
+    } else {
+        sum_cells<uint16_t>( flat, cols, rows, sums, counts );
+    }
+
+    flat_field_map map;
+    map.cols = cols;
+    map.rows = rows;
+    for( int plane = 0; plane < 4; ++plane )
+    {
+        std::vector<double>& means = sums[plane];
+        for( size_t cell = 0; cell < means.size(); ++cell ) {
+            means[cell] /= std::max( counts[plane][cell], 1 );
+        }
+        const double brightest = *std::max_element( means.begin(), means.end() );
+
+        map.gains[plane].resize( means.size() );
+        for( size_t cell = 0; cell < means.size(); ++cell )
+        {
+            // black cells get the highest gain, these are outside of the image circle anyway
+            const double gain = means[cell] > 0. ? brightest / means[cell] : double( max_gain );
+            map.gains[plane][cell] = static_cast<float>( std::clamp( gain, 1., double( max_gain ) ) );
+        }
+    }
+    return map;
+}
+
+void    img_filter::flat_field::prepare( flat_field_data& data, const flat_field_map& map, img::dim frame_dim, const line_funcs& funcs )
+{
+    data.frame_dim = frame_dim;
+    data.rows = map.rows;
+    data.funcs = funcs;
+    data.gains.assign( size_t( 2 ) * map.rows * frame_dim.cx, 0 );
+
+    std::vector<grid_pos> columns( frame_dim.cx );
+    for( int x = 0; x < frame_dim.cx; ++x ) {
+        columns[x] = to_grid_pos( x, frame_dim.cx, map.cols );
+    }
+
+    for( int parity = 0; parity < 2; ++parity )
+    {
+        for( int row = 0; row < map.rows; ++row )
+        {
+            uint16_t* dst = data.gains.data() + (size_t( parity ) * map.rows + row) * frame_dim.cx;
+            for( int x = 0; x < frame_dim.cx; ++x )
+            {
+                const auto& plane = map.gains[parity * 2 + (x % 2)];
+                const auto& col = columns[x];
+
+                const float g0 = plane[row * map.cols + col.idx0];
+                const float g1 = plane[row * map.cols + col.idx1];
+                const float gain = g0 + (g1 - g0) * col.weight1;
+
+                dst[x] = static_cast<uint16_t>( std::lround( std::clamp( gain, 0.f, max_gain ) * (1 << gain_shift) ) );
+            }
+        }
+    }
+}
+
+void    img_filter::flat_field::apply( const img::img_descriptor& img, img::point pos, const flat_field_data& data ) noexcept
+{
+    line_func func = nullptr;
+    if( img::is_by8_fcc( img.fourcc_type() ) ) {
+        func = data.funcs.by8;
+    } else if( img::is_by16_fcc( img.fourcc_type() ) ) {
+        func = data.funcs.by16;
+    } else if( img::is_byfloat_fcc( img.fourcc_type() ) ) {
+        func = data.funcs.byfloat;
+    }
+    if( func == nullptr || data.rows == 0 || pos.x < 0 || pos.x >= data.frame_dim.cx ) {
+        return;
+    }
+
+    const int count = std::min( img.dim.cx, data.frame_dim.cx - pos.x );
+    const int lines = std::min( img.dim.cy, data.frame_dim.cy - pos.y );
+    for( int y = std::max( 0, -pos.y ); y < lines; ++y )
+    {
+        const int frame_y = pos.y + y;
+        const auto row = to_grid_pos( frame_y, data.frame_dim.cy, data.rows );
+
+        const uint16_t* parity_gains = data.gains.data() + size_t( frame_y % 2 ) * data.rows * data.frame_dim.cx;
+        const uint16_t* gains_a = parity_gains + size_t( row.idx0 ) * data.frame_dim.cx + pos.x;
+        const uint16_t* gains_b = parity_gains + size_t( row.idx1 ) * data.frame_dim.cx + pos.x;
+
+        int weight_b = static_cast<int>( row.weight1 * 256.f + 0.5f );
+        if( weight_b > 255 ) {
+            gains_a = gains_b;
+            weight_b = 0;
+        }
+        func( img::get_line_start( img, y ), gains_a, gains_b, weight_b, count );
+    }
+}
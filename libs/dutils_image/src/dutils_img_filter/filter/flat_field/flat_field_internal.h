@@ -0,0 +1,33 @@
+#pragma once
+
+#include "flat_field.h"
+
+// scalar versions of the kernels, the simd kernels use them for the end of the lines and have to match them bit exact
+namespace img_filter::flat_field::detail
+{
+    FORCEINLINE int     interpolate_gain( int gain_a, int gain_b, int weight_b ) noexcept
+    {
+        // same rounding as _mm_mulhrs_epi16/vqrdmulhq_s16 with weight_b << 7
+        return gain_a + (((gain_b - gain_a) * (weight_b << 7) + 0x4000) >> 15);
+    }
+
+    FORCEINLINE void    apply_by8( uint8_t* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int begin, int count ) noexcept
+    {
+        for( int x = begin; x < count; ++x )
+        {
+            const int gain = interpolate_gain( gains_a[x], gains_b[x], weight_b );
+            const int val = (line[x] * gain) >> gain_shift;
+            line[x] = static_cast<uint8_t>( val > 0xFF ? 0xFF : val );
+        }
+    }
+
+    FORCEINLINE void    apply_by16( uint16_t* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int begin, int count ) noexcept
+    {
+        for( int x = begin; x < count; ++x )
+        {
+            const unsigned gain = static_cast<unsigned>( interpolate_gain( gains_a[x], gains_b[x], weight_b ) );
+            const unsigned val = (line[x] * gain) >> gain_shift;
+            line[x] = static_cast<uint16_t>( val > 0xFFFF ? 0xFFFF : val );
+        }
+    }
+}
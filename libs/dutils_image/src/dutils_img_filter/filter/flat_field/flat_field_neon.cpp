@@ -0,0 +1,68 @@
+#include "flat_field_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+namespace
+{
+    using namespace img_filter::flat_field;
+
+    FORCEINLINE
+    uint16x8_t  gain_neon_step_( const uint16_t* gains_a, const uint16_t* gains_b, int16x8_t weight ) noexcept
+    {
+        const int16x8_t a = vreinterpretq_s16_u16( vld1q_u16( gains_a ) );
+        const int16x8_t b = vreinterpretq_s16_u16( vld1q_u16( gains_b ) );
+
+        // vqrdmulhq_s16 rounds like _mm_mulhrs_epi16, so all kernels produce the same gains
+        return vreinterpretq_u16_s16( vaddq_s16( a, vqrdmulhq_s16( vsubq_s16( b, a ), weight ) ) );
+    }
+
+    void    apply_line_by8_neon( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint8_t* dst = static_cast<uint8_t*>( line );
+        const int16x8_t weight = vdupq_n_s16( static_cast<int16_t>( weight_b << 7 ) );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            const uint16x8_t pixels = vmovl_u8( vld1_u8( dst + x ) );
+            const uint16x8_t gain = gain_neon_step_( gains_a + x, gains_b + x, weight );
+
+            const uint32x4_t tmp_lo = vmull_u16( vget_low_u16( pixels ), vget_low_u16( gain ) );
+            const uint32x4_t tmp_hi = vmull_high_u16( pixels, gain );
+
+            const uint16x8_t res = vcombine_u16( vshrn_n_u32( tmp_lo, gain_shift ), vshrn_n_u32( tmp_hi, gain_shift ) );
+            vst1_u8( dst + x, vqmovn_u16( res ) );
+        }
+        detail::apply_by8( dst, gains_a, gains_b, weight_b, x, count );
+    }
+
+    void    apply_line_by16_neon( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint16_t* dst = static_cast<uint16_t*>( line );
+        const int16x8_t weight = vdupq_n_s16( static_cast<int16_t>( weight_b << 7 ) );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            const uint16x8_t pixels = vld1q_u16( dst + x );
+            const uint16x8_t gain = gain_neon_step_( gains_a + x, gains_b + x, weight );
+
+            const uint32x4_t tmp_lo = vmull_u16( vget_low_u16( pixels ), vget_low_u16( gain ) );
+            const uint32x4_t tmp_hi = vmull_high_u16( pixels, gain );
+
+            vst1q_u16( dst + x, vcombine_u16( vqshrn_n_u32( tmp_lo, gain_shift ), vqshrn_n_u32( tmp_hi, gain_shift ) ) );
+        }
+        detail::apply_by16( dst, gains_a, gains_b, weight_b, x, count );
+    }
+}
+
+img_filter::flat_field::line_func   img_filter::flat_field::get_line_func_neon( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) ) {
+        return &apply_line_by8_neon;
+    }
+    if( img::is_by16_fcc( fcc ) ) {
+        return &apply_line_by16_neon;
+    }
+    return nullptr;
+}
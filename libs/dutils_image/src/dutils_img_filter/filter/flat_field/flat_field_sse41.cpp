@@ -0,0 +1,76 @@
+#include "flat_field_internal.h"
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+namespace
+{
+    using namespace img_filter::flat_field;
+
+    FORCEINLINE
+    __m128i     gain_sse41_step_( const uint16_t* gains_a, const uint16_t* gains_b, __m128i weight ) noexcept
+    {
+        const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( gains_a ) );
+        const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( gains_b ) );
+
+        // the gains fit into int16_t, so the difference does too
+        return _mm_add_epi16( a, _mm_mulhrs_epi16( _mm_sub_epi16( b, a ), weight ) );
+    }
+
+    void    apply_line_by8_sse41( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint8_t* dst = static_cast<uint8_t*>( line );
+        const __m128i weight = _mm_set1_epi16( static_cast<int16_t>( weight_b << 7 ) );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + x ) );
+
+            const __m128i gain_lo = gain_sse41_step_( gains_a + x, gains_b + x, weight );
+            const __m128i gain_hi = gain_sse41_step_( gains_a + x + 8, gains_b + x + 8, weight );
+
+            // (p << (16 - gain_shift)) * gain >> 16 == p * gain >> gain_shift
+            const __m128i lo = _mm_slli_epi16( _mm_cvtepu8_epi16( pixels ), 16 - gain_shift );
+            const __m128i hi = _mm_slli_epi16( _mm_unpackhi_epi8( pixels, _mm_setzero_si128() ), 16 - gain_shift );
+
+            const __m128i res = _mm_packus_epi16( _mm_mulhi_epu16( lo, gain_lo ), _mm_mulhi_epu16( hi, gain_hi ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), res );
+        }
+        detail::apply_by8( dst, gains_a, gains_b, weight_b, x, count );
+    }
+
+    void    apply_line_by16_sse41( void* line, const uint16_t* gains_a, const uint16_t* gains_b, int weight_b, int count )
+    {
+        uint16_t* dst = static_cast<uint16_t*>( line );
+        const __m128i weight = _mm_set1_epi16( static_cast<int16_t>( weight_b << 7 ) );
+        const __m128i overflow_limit = _mm_set1_epi16( (1 << gain_shift) - 1 );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst + x ) );
+            const __m128i gain = gain_sse41_step_( gains_a + x, gains_b + x, weight );
+
+            // the 32 bit product split in 16 bit halves, shifted down by gain_shift
+            const __m128i hi = _mm_mulhi_epu16( pixels, gain );
+            const __m128i lo = _mm_mullo_epi16( pixels, gain );
+            const __m128i res = _mm_or_si128( _mm_slli_epi16( hi, 16 - gain_shift ), _mm_srli_epi16( lo, gain_shift ) );
+
+            // hi is below 0x8000 as gain is, so the signed compare works
+            const __m128i overflow = _mm_cmpgt_epi16( hi, overflow_limit );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), _mm_or_si128( res, overflow ) );
+        }
+        detail::apply_by16( dst, gains_a, gains_b, weight_b, x, count );
+    }
+}
+
+img_filter::flat_field::line_func   img_filter::flat_field::get_line_func_sse41( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) ) {
+        return &apply_line_by8_sse41;
+    }
+    if( img::is_by16_fcc( fcc ) ) {
+        return &apply_line_by16_sse41;
+    }
+    return nullptr;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../../dutils_img_base.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Temporal accumulation of 8/16 bit bayer and mono frames, to average a group of frames
+ * or to fuse an exposure bracket into one frame with a higher dynamic range.
+ *
+ * Frames are added line by line to a per pixel 32 bit sum, so strips of a frame can be added in parallel.
+ * Averaging divides the sums by the number of frames. Fusing only adds the pixels of a frame that are
+ * below the saturation level and marks the frame in a 16 bit mask per pixel. The fused value is then the sum of
+ * the pixels divided by the sum of the exposures they were taken with, which weights every frame with its exposure.
+ */
+
+namespace img_filter::frame_accumulate
+{
+    constexpr int   max_average_frames = 256;       // 16 bit sums stay below 1 << 24, so float keeps them exact
+    constexpr int   max_fused_frames = 8;           // masks index a table of 1 << frames scales
+
+    // first overwrites sums instead of adding to them
+    using add_line_func = void (*)( uint32_t* sums, const void* src_line, int count, bool first );
+
+    // adds the pixels below saturation to sums and sets frame_bit in their masks
+    using add_masked_line_func = void (*)( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first );
+
+    // dst_line = sums * scale, rounded and clipped to the range of the format
+    using scale_line_func = void (*)( void* dst_line, const uint32_t* sums, int count, float scale );
+
+    struct line_funcs
+    {
+        add_line_func           add = nullptr;
+        add_masked_line_func    add_masked = nullptr;
+        scale_line_func         scale = nullptr;
+    };
+
+    // all members are nullptr for formats other than 8/16 bit bayer and mono
+    line_funcs  get_line_funcs_c( img::fourcc fcc );
+    line_funcs  get_line_funcs_sse41( img::fourcc fcc );
+    line_funcs  get_line_funcs_avx2( img::fourcc fcc );
+    line_funcs  get_line_funcs_neon( img::fourcc fcc );
+
+    bool        is_supported_fcc( img::fourcc fcc ) noexcept;
+
+    // the 16 bit format of the same bayer pattern or mono, the output format of fuse
+    img::fourcc get_fused_fcc( img::fourcc fcc ) noexcept;
+
+    struct accumulator
+    {
+        img::img_type           type;
+        std::vector<uint32_t>   sums;       // type.dim.cx * type.dim.cy
+        std::vector<uint16_t>   masks;      // only allocated for fusing
+    };
+
+    void    init( accumulator& acc, const img::img_type& type, bool fuse );
+
+    /**
+     * Adds the lines of strip, a view of a frame of acc.type starting at line y.
+     * frame_index is the position of the frame in its group, the first frame of a group overwrites the sums.
+     */
+    void    add( accumulator& acc, const img::img_descriptor& strip, int y, int frame_index, const line_funcs& funcs ) noexcept;
+
+    // saturation is the first pixel value that is not added
+    void    add_masked( accumulator& acc, const img::img_descriptor& strip, int y, int frame_index, uint32_t saturation, const line_funcs& funcs ) noexcept;
+
+    // dst_strip has the format of acc.type
+    void    write_average( const img::img_descriptor& dst_strip, int y, const accumulator& acc, int frames, const line_funcs& funcs ) noexcept;
+
+    /**
+     * Fills scales with the factor of each mask value, it needs 1 << frames entries.
+     * exposures are the relative exposure times of the frames of a group,
+     * the result is scaled so that the saturation of the shortest exposure maps to 0xFFFF.
+     */
+    void    make_fuse_scales( float* scales, const float* exposures, int frames, uint32_t max_value ) noexcept;
+
+    // dst_strip has get_fused_fcc( acc.type.fourcc_type() ), pixels that were saturated in every frame become 0xFFFF
+    void    write_fused( const img::img_descriptor& dst_strip, int y, const accumulator& acc, const float* scales ) noexcept;
+}
@@ -0,0 +1,158 @@
+#include "frame_accumulate_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace img_filter::frame_accumulate;
+
+    FORCEINLINE
+    void    add_avx2_step_( uint32_t* sums, __m256i values, bool first ) noexcept
+    {
+        auto* ptr = reinterpret_cast<__m256i*>( sums );
+        _mm256_storeu_si256( ptr, first ? values : _mm256_add_epi32( _mm256_loadu_si256( ptr ), values ) );
+    }
+
+    // adds 16 pixels, given as uint16_t
+    FORCEINLINE
+    void    add16_avx2_step_( uint32_t* sums, __m256i pixels, bool first ) noexcept
+    {
+        add_avx2_step_( sums + 0, _mm256_cvtepu16_epi32( _mm256_castsi256_si128( pixels ) ), first );
+        add_avx2_step_( sums + 8, _mm256_cvtepu16_epi32( _mm256_extracti128_si256( pixels, 1 ) ), first );
+    }
+
+    FORCEINLINE
+    void    or_masks_avx2_step_( uint16_t* masks, __m256i bits, bool first ) noexcept
+    {
+        auto* ptr = reinterpret_cast<__m256i*>( masks );
+        _mm256_storeu_si256( ptr, first ? bits : _mm256_or_si256( _mm256_loadu_si256( ptr ), bits ) );
+    }
+
+    void    add_line_by8_avx2( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+            add16_avx2_step_( sums + x, _mm256_cvtepu8_epi16( pixels ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_line_by16_avx2( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            add16_avx2_step_( sums + x, _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + x ) ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_masked_line_by8_avx2( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+        if( saturation == 0 || saturation > 0xFF ) {
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const __m128i last_valid = _mm_set1_epi8( static_cast<char>( saturation - 1 ) );
+        const __m256i bit = _mm256_set1_epi16( static_cast<short>( frame_bit ) );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+            const __m128i valid = _mm_cmpeq_epi8( _mm_min_epu8( pixels, last_valid ), pixels );
+
+            add16_avx2_step_( sums + x, _mm256_cvtepu8_epi16( _mm_and_si128( pixels, valid ) ), first );
+            or_masks_avx2_step_( masks + x, _mm256_and_si256( _mm256_cvtepi8_epi16( valid ), bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    void    add_masked_line_by16_avx2( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+        if( saturation == 0 || saturation > 0xFFFF ) {
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const __m256i last_valid = _mm256_set1_epi16( static_cast<short>( saturation - 1 ) );
+        const __m256i bit = _mm256_set1_epi16( static_cast<short>( frame_bit ) );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m256i pixels = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src + x ) );
+            const __m256i valid = _mm256_cmpeq_epi16( _mm256_min_epu16( pixels, last_valid ), pixels );
+
+            add16_avx2_step_( sums + x, _mm256_and_si256( pixels, valid ), first );
+            or_masks_avx2_step_( masks + x, _mm256_and_si256( valid, bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    FORCEINLINE
+    __m256i     scale8_avx2_step_( const uint32_t* sums, __m256 scale, __m256 max_value ) noexcept
+    {
+        const __m256 val = _mm256_cvtepi32_ps( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( sums ) ) );
+        return _mm256_cvttps_epi32( _mm256_min_ps( _mm256_add_ps( _mm256_mul_ps( val, scale ), _mm256_set1_ps( 0.5f ) ), max_value ) );
+    }
+
+    // 16 sums to 16 uint16_t in order, saturated
+    FORCEINLINE
+    __m256i     scale16_avx2_step_( const uint32_t* sums, __m256 scale, __m256 max_value ) noexcept
+    {
+        const __m256i lo = scale8_avx2_step_( sums + 0, scale, max_value );
+        const __m256i hi = scale8_avx2_step_( sums + 8, scale, max_value );
+
+        // packus works per 128 bit lane
+        return _mm256_permute4x64_epi64( _mm256_packus_epi32( lo, hi ), 0xD8 );
+    }
+
+    void    scale_line_by8_avx2( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint8_t*>( dst_line );
+        const __m256 scale_v = _mm256_set1_ps( scale );
+        const __m256 max_value = _mm256_set1_ps( 255.f );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m256i res = scale16_avx2_step_( sums + x, scale_v, max_value );
+            const __m128i res8 = _mm_packus_epi16( _mm256_castsi256_si128( res ), _mm256_extracti128_si256( res, 1 ) );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), res8 );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+
+    void    scale_line_by16_avx2( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint16_t*>( dst_line );
+        const __m256 scale_v = _mm256_set1_ps( scale );
+        const __m256 max_value = _mm256_set1_ps( 65535.f );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst + x ), scale16_avx2_step_( sums + x, scale_v, max_value ) );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+}
+
+img_filter::frame_accumulate::line_funcs    img_filter::frame_accumulate::get_line_funcs_avx2( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) || fcc == img::fourcc::MONO8 ) {
+        return { &add_line_by8_avx2, &add_masked_line_by8_avx2, &scale_line_by8_avx2 };
+    }
+    if( img::is_by16_fcc( fcc ) || fcc == img::fourcc::MONO16 ) {
+        return { &add_line_by16_avx2, &add_masked_line_by16_avx2, &scale_line_by16_avx2 };
+    }
+    return {};
+}
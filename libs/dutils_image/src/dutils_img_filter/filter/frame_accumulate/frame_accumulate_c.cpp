@@ -0,0 +1,160 @@
+#include "frame_accumulate_internal.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    using namespace img_filter::frame_accumulate;
+
+    template<typename TPixel>
+    void    add_line_c( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        detail::add_line( sums, static_cast<const TPixel*>( src_line ), 0, count, first );
+    }
+
+    template<typename TPixel>
+    void    add_masked_line_c( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        detail::add_masked_line( sums, masks, static_cast<const TPixel*>( src_line ), 0, count, saturation, frame_bit, first );
+    }
+
+    template<typename TPixel>
+    void    scale_line_c( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        detail::scale_line( static_cast<TPixel*>( dst_line ), sums, 0, count, scale );
+    }
+
+    bool    is_8bit_fcc( img::fourcc fcc ) noexcept
+    {
+        return img::is_by8_fcc( fcc ) || fcc == img::fourcc::MONO8;
+    }
+
+    bool    is_16bit_fcc( img::fourcc fcc ) noexcept
+    {
+        return img::is_by16_fcc( fcc ) || fcc == img::fourcc::MONO16;
+    }
+}
+
+img_filter::frame_accumulate::line_funcs    img_filter::frame_accumulate::get_line_funcs_c( img::fourcc fcc )
+{
+    if( is_8bit_fcc( fcc ) ) {
+        return { &add_line_c<uint8_t>, &add_masked_line_c<uint8_t>, &scale_line_c<uint8_t> };
+    }
+    if( is_16bit_fcc( fcc ) ) {
+        return { &add_line_c<uint16_t>, &add_masked_line_c<uint16_t>, &scale_line_c<uint16_t> };
+    }
+    return {};
+}
+
+bool    img_filter::frame_accumulate::is_supported_fcc( img::fourcc fcc ) noexcept
+{
+    return is_8bit_fcc( fcc ) || is_16bit_fcc( fcc );
+}
+
+img::fourcc     img_filter::frame_accumulate::get_fused_fcc( img::fourcc fcc ) noexcept
+{
+    if( img::is_by8_fcc( fcc ) || img::is_by16_fcc( fcc ) ) {
+        return img::by_transform::convert_bayer_fcc_to_bayer16_fcc( fcc );
+    }
+    if( fcc == img::fourcc::MONO8 || fcc == img::fourcc::MONO16 ) {
+        return img::fourcc::MONO16;
+    }
+    return img::fourcc::FCC_NULL;
+}
+
+void    img_filter::frame_accumulate::init( accumulator& acc, const img::img_type& type, bool fuse )
+{
+    const size_t pixels = size_t( type.dim.cx ) * type.dim.cy;
+
+    acc.type = type;
+    acc.sums.assign( pixels, 0 );
+    if( fuse ) {
+        acc.masks.assign( pixels, 0 );
+    } else {
+        acc.masks = {};
+    }
+}
+
+void    img_filter::frame_accumulate::add( accumulator& acc, const img::img_descriptor& strip, int y, int frame_index, const line_funcs& funcs ) noexcept
+{
+    assert( strip.dim.cx == acc.type.dim.cx && y + strip.dim.cy <= acc.type.dim.cy );
+
+    const int width = acc.type.dim.cx;
+    for( int line = 0; line < strip.dim.cy; ++line )
+    {
+        uint32_t* sums = acc.sums.data() + size_t( y + line ) * width;
+        funcs.add( sums, img::get_line_start( strip, line ), width, frame_index == 0 );
+    }
+}
+
+void    img_filter::frame_accumulate::add_masked( accumulator& acc, const img::img_descriptor& strip, int y, int frame_index, uint32_t saturation, const line_funcs& funcs ) noexcept
+{
+    assert( strip.dim.cx == acc.type.dim.cx && y + strip.dim.cy <= acc.type.dim.cy );
+    assert( !acc.masks.empty() && frame_index < max_fused_frames );
+
+    const int width = acc.type.dim.cx;
+    const auto frame_bit = static_cast<uint16_t>( 1 << frame_index );
+    for( int line = 0; line < strip.dim.cy; ++line )
+    {
+        const size_t offset = size_t( y + line ) * width;
+        funcs.add_masked( acc.sums.data() + offset, acc.masks.data() + offset, img::get_line_start( strip, line ), width, saturation, frame_bit, frame_index == 0 );
+    }
+}
+
+void    img_filter::frame_accumulate::write_average( const img::img_descriptor& dst_strip, int y, const accumulator& acc, int frames, const line_funcs& funcs ) noexcept
+{
+    const int width = acc.type.dim.cx;
+    const float scale = 1.f / static_cast<float>( std::max( frames, 1 ) );
+    for( int line = 0; line < dst_strip.dim.cy; ++line )
+    {
+        const uint32_t* sums = acc.sums.data() + size_t( y + line ) * width;
+        funcs.scale( img::get_line_start( dst_strip, line ), sums, width, scale );
+    }
+}
+
+void    img_filter::frame_accumulate::make_fuse_scales( float* scales, const float* exposures, int frames, uint32_t max_value ) noexcept
+{
+    assert( frames > 0 && frames <= max_fused_frames );
+
+    const float shortest = *std::min_element( exposures, exposures + frames );
+    const float output_scale = 65535.f / static_cast<float>( max_value );
+
+    scales[0] = 0.f;
+    for( int mask = 1; mask < (1 << frames); ++mask )
+    {
+        float exposure_sum = 0.f;
+        for( int i = 0; i < frames; ++i )
+        {
+            if( mask & (1 << i) ) {
+                exposure_sum += exposures[i] / shortest;
+            }
+        }
+        scales[mask] = output_scale / exposure_sum;
+    }
+}
+
+void    img_filter::frame_accumulate::write_fused( const img::img_descriptor& dst_strip, int y, const accumulator& acc, const float* scales ) noexcept
+{
+    assert( !acc.masks.empty() );
+
+    const int width = acc.type.dim.cx;
+    for( int line = 0; line < dst_strip.dim.cy; ++line )
+    {
+        const size_t offset = size_t( y + line ) * width;
+        const uint32_t* sums = acc.sums.data() + offset;
+        const uint16_t* masks = acc.masks.data() + offset;
+
+        auto* dst = img::get_line_start<uint16_t>( dst_strip, line );
+        for( int x = 0; x < width; ++x )
+        {
+            if( masks[x] == 0 )
+            {
+                dst[x] = 0xFFFF;
+                continue;
+            }
+            const float val = static_cast<float>( sums[x] ) * scales[masks[x]] + 0.5f;
+            dst[x] = static_cast<uint16_t>( val < 65535.f ? val : 65535.f );
+        }
+    }
+}
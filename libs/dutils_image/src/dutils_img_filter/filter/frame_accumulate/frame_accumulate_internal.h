@@ -0,0 +1,57 @@
+#pragma once
+
+#include "frame_accumulate.h"
+
+// scalar versions of the kernels, the simd kernels use them for the end of the lines
+namespace img_filter::frame_accumulate::detail
+{
+    template<typename TPixel>
+    FORCEINLINE void    add_line( uint32_t* sums, const TPixel* src, int begin, int count, bool first ) noexcept
+    {
+        if( first )
+        {
+            for( int x = begin; x < count; ++x ) {
+                sums[x] = src[x];
+            }
+        }
+        else
+        {
+            for( int x = begin; x < count; ++x ) {
+                sums[x] += src[x];
+            }
+        }
+    }
+
+    template<typename TPixel>
+    FORCEINLINE void    add_masked_line( uint32_t* sums, uint16_t* masks, const TPixel* src, int begin, int count, uint32_t saturation, uint16_t frame_bit, bool first ) noexcept
+    {
+        for( int x = begin; x < count; ++x )
+        {
+            const bool valid = src[x] < saturation;
+            const uint32_t value = valid ? src[x] : 0;
+            const uint16_t bit = valid ? frame_bit : 0;
+            if( first )
+            {
+                sums[x] = value;
+                masks[x] = bit;
+            }
+            else
+            {
+                sums[x] += value;
+                masks[x] |= bit;
+            }
+        }
+    }
+
+    template<typename TPixel>
+    FORCEINLINE void    scale_line( TPixel* dst, const uint32_t* sums, int begin, int count, float scale ) noexcept
+    {
+        constexpr float max_value = static_cast<float>( TPixel( ~TPixel( 0 ) ) );
+
+        for( int x = begin; x < count; ++x )
+        {
+            const float val = static_cast<float>( sums[x] ) * scale + 0.5f;
+            dst[x] = static_cast<TPixel>( val < max_value ? val : max_value );
+        }
+    }
+}
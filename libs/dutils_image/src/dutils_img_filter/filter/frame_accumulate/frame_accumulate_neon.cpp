@@ -0,0 +1,159 @@
+#include "frame_accumulate_internal.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+namespace
+{
+    using namespace img_filter::frame_accumulate;
+
+    FORCEINLINE
+    void    add_neon_step_( uint32_t* sums, uint32x4_t values, bool first ) noexcept
+    {
+        vst1q_u32( sums, first ? values : vaddq_u32( vld1q_u32( sums ), values ) );
+    }
+
+    // adds 8 pixels, given as uint16_t
+    FORCEINLINE
+    void    add8_neon_step_( uint32_t* sums, uint16x8_t pixels, bool first ) noexcept
+    {
+        add_neon_step_( sums + 0, vmovl_u16( vget_low_u16( pixels ) ), first );
+        add_neon_step_( sums + 4, vmovl_high_u16( pixels ), first );
+    }
+
+    FORCEINLINE
+    void    or_masks_neon_step_( uint16_t* masks, uint16x8_t bits, bool first ) noexcept
+    {
+        vst1q_u16( masks, first ? bits : vorrq_u16( vld1q_u16( masks ), bits ) );
+    }
+
+    void    add_line_by8_neon( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const uint8x16_t pixels = vld1q_u8( src + x );
+            add8_neon_step_( sums + x + 0, vmovl_u8( vget_low_u8( pixels ) ), first );
+            add8_neon_step_( sums + x + 8, vmovl_high_u8( pixels ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_line_by16_neon( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            add8_neon_step_( sums + x, vld1q_u16( src + x ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_masked_line_by8_neon( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+        if( saturation > 0xFF ) {
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const uint8x16_t saturation_v = vdupq_n_u8( static_cast<uint8_t>( saturation ) );
+        const uint16x8_t bit = vdupq_n_u16( frame_bit );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const uint8x16_t pixels = vld1q_u8( src + x );
+            const uint8x16_t valid = vcltq_u8( pixels, saturation_v );
+            const uint8x16_t values = vandq_u8( pixels, valid );
+
+            add8_neon_step_( sums + x + 0, vmovl_u8( vget_low_u8( values ) ), first );
+            add8_neon_step_( sums + x + 8, vmovl_high_u8( values ), first );
+
+            // sign extension widens the 0xFF of valid to 0xFFFF
+            const int8x16_t valid_s = vreinterpretq_s8_u8( valid );
+            or_masks_neon_step_( masks + x + 0, vandq_u16( vreinterpretq_u16_s16( vmovl_s8( vget_low_s8( valid_s ) ) ), bit ), first );
+            or_masks_neon_step_( masks + x + 8, vandq_u16( vreinterpretq_u16_s16( vmovl_high_s8( valid_s ) ), bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    void    add_masked_line_by16_neon( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+        if( saturation > 0xFFFF ) {
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const uint16x8_t saturation_v = vdupq_n_u16( static_cast<uint16_t>( saturation ) );
+        const uint16x8_t bit = vdupq_n_u16( frame_bit );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            const uint16x8_t pixels = vld1q_u16( src + x );
+            const uint16x8_t valid = vcltq_u16( pixels, saturation_v );
+
+            add8_neon_step_( sums + x, vandq_u16( pixels, valid ), first );
+            or_masks_neon_step_( masks + x, vandq_u16( valid, bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    FORCEINLINE
+    uint32x4_t  scale4_neon_step_( const uint32_t* sums, float32x4_t scale, float32x4_t max_value ) noexcept
+    {
+        // no fused multiply add, the rounding has to match the c version
+        const float32x4_t val = vaddq_f32( vmulq_f32( vcvtq_f32_u32( vld1q_u32( sums ) ), scale ), vdupq_n_f32( 0.5f ) );
+        return vcvtq_u32_f32( vminq_f32( val, max_value ) );
+    }
+
+    // 8 sums to 8 uint16_t, saturated
+    FORCEINLINE
+    uint16x8_t  scale8_neon_step_( const uint32_t* sums, float32x4_t scale, float32x4_t max_value ) noexcept
+    {
+        return vcombine_u16( vqmovn_u32( scale4_neon_step_( sums + 0, scale, max_value ) ),
+                             vqmovn_u32( scale4_neon_step_( sums + 4, scale, max_value ) ) );
+    }
+
+    void    scale_line_by8_neon( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint8_t*>( dst_line );
+        const float32x4_t scale_v = vdupq_n_f32( scale );
+        const float32x4_t max_value = vdupq_n_f32( 255.f );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            vst1_u8( dst + x, vqmovn_u16( scale8_neon_step_( sums + x, scale_v, max_value ) ) );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+
+    void    scale_line_by16_neon( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint16_t*>( dst_line );
+        const float32x4_t scale_v = vdupq_n_f32( scale );
+        const float32x4_t max_value = vdupq_n_f32( 65535.f );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            vst1q_u16( dst + x, scale8_neon_step_( sums + x, scale_v, max_value ) );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+}
+
+img_filter::frame_accumulate::line_funcs    img_filter::frame_accumulate::get_line_funcs_neon( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) || fcc == img::fourcc::MONO8 ) {
+        return { &add_line_by8_neon, &add_masked_line_by8_neon, &scale_line_by8_neon };
+    }
+    if( img::is_by16_fcc( fcc ) || fcc == img::fourcc::MONO16 ) {
+        return { &add_line_by16_neon, &add_masked_line_by16_neon, &scale_line_by16_neon };
+    }
+    return {};
+}
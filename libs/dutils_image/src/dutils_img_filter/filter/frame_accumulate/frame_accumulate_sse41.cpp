@@ -0,0 +1,161 @@
+#include "frame_accumulate_internal.h"
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+namespace
+{
+    using namespace img_filter::frame_accumulate;
+
+    FORCEINLINE
+    void    add_sse41_step_( uint32_t* sums, __m128i values, bool first ) noexcept
+    {
+        auto* ptr = reinterpret_cast<__m128i*>( sums );
+        _mm_storeu_si128( ptr, first ? values : _mm_add_epi32( _mm_loadu_si128( ptr ), values ) );
+    }
+
+    // adds 8 pixels, given as uint16_t
+    FORCEINLINE
+    void    add8_sse41_step_( uint32_t* sums, __m128i pixels, bool first ) noexcept
+    {
+        add_sse41_step_( sums + 0, _mm_cvtepu16_epi32( pixels ), first );
+        add_sse41_step_( sums + 4, _mm_unpackhi_epi16( pixels, _mm_setzero_si128() ), first );
+    }
+
+    FORCEINLINE
+    void    or_masks_sse41_step_( uint16_t* masks, __m128i bits, bool first ) noexcept
+    {
+        auto* ptr = reinterpret_cast<__m128i*>( masks );
+        _mm_storeu_si128( ptr, first ? bits : _mm_or_si128( _mm_loadu_si128( ptr ), bits ) );
+    }
+
+    void    add_line_by8_sse41( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+            add8_sse41_step_( sums + x + 0, _mm_cvtepu8_epi16( pixels ), first );
+            add8_sse41_step_( sums + x + 8, _mm_unpackhi_epi8( pixels, _mm_setzero_si128() ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_line_by16_sse41( uint32_t* sums, const void* src_line, int count, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            add8_sse41_step_( sums + x, _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) ), first );
+        }
+        detail::add_line( sums, src, x, count, first );
+    }
+
+    void    add_masked_line_by8_sse41( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint8_t*>( src_line );
+        if( saturation == 0 || saturation > 0xFF ) {
+            // nothing or everything is saturated, no need for a fast path
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const __m128i last_valid = _mm_set1_epi8( static_cast<char>( saturation - 1 ) );
+        const __m128i bit = _mm_set1_epi16( static_cast<short>( frame_bit ) );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+            const __m128i valid = _mm_cmpeq_epi8( _mm_min_epu8( pixels, last_valid ), pixels );
+            const __m128i values = _mm_and_si128( pixels, valid );
+
+            add8_sse41_step_( sums + x + 0, _mm_cvtepu8_epi16( values ), first );
+            add8_sse41_step_( sums + x + 8, _mm_unpackhi_epi8( values, _mm_setzero_si128() ), first );
+
+            // sign extension widens the 0xFF of valid to 0xFFFF
+            or_masks_sse41_step_( masks + x + 0, _mm_and_si128( _mm_cvtepi8_epi16( valid ), bit ), first );
+            or_masks_sse41_step_( masks + x + 8, _mm_and_si128( _mm_cvtepi8_epi16( _mm_srli_si128( valid, 8 ) ), bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    void    add_masked_line_by16_sse41( uint32_t* sums, uint16_t* masks, const void* src_line, int count, uint32_t saturation, uint16_t frame_bit, bool first )
+    {
+        const auto* src = static_cast<const uint16_t*>( src_line );
+        if( saturation == 0 || saturation > 0xFFFF ) {
+            detail::add_masked_line( sums, masks, src, 0, count, saturation, frame_bit, first );
+            return;
+        }
+        const __m128i last_valid = _mm_set1_epi16( static_cast<short>( saturation - 1 ) );
+        const __m128i bit = _mm_set1_epi16( static_cast<short>( frame_bit ) );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            const __m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + x ) );
+            const __m128i valid = _mm_cmpeq_epi16( _mm_min_epu16( pixels, last_valid ), pixels );
+
+            add8_sse41_step_( sums + x, _mm_and_si128( pixels, valid ), first );
+            or_masks_sse41_step_( masks + x, _mm_and_si128( valid, bit ), first );
+        }
+        detail::add_masked_line( sums, masks, src, x, count, saturation, frame_bit, first );
+    }
+
+    // 8 sums to 8 uint16_t, saturated
+    FORCEINLINE
+    __m128i     scale8_sse41_step_( const uint32_t* sums, __m128 scale, __m128 max_value ) noexcept
+    {
+        const __m128 half = _mm_set1_ps( 0.5f );
+
+        const __m128 lo = _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( sums + 0 ) ) );
+        const __m128 hi = _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( sums + 4 ) ) );
+
+        const __m128i res_lo = _mm_cvttps_epi32( _mm_min_ps( _mm_add_ps( _mm_mul_ps( lo, scale ), half ), max_value ) );
+        const __m128i res_hi = _mm_cvttps_epi32( _mm_min_ps( _mm_add_ps( _mm_mul_ps( hi, scale ), half ), max_value ) );
+        return _mm_packus_epi32( res_lo, res_hi );
+    }
+
+    void    scale_line_by8_sse41( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint8_t*>( dst_line );
+        const __m128 scale_v = _mm_set1_ps( scale );
+        const __m128 max_value = _mm_set1_ps( 255.f );
+
+        int x = 0;
+        for( ; x < (count - 15); x += 16 )
+        {
+            const __m128i lo = scale8_sse41_step_( sums + x + 0, scale_v, max_value );
+            const __m128i hi = scale8_sse41_step_( sums + x + 8, scale_v, max_value );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), _mm_packus_epi16( lo, hi ) );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+
+    void    scale_line_by16_sse41( void* dst_line, const uint32_t* sums, int count, float scale )
+    {
+        auto* dst = static_cast<uint16_t*>( dst_line );
+        const __m128 scale_v = _mm_set1_ps( scale );
+        const __m128 max_value = _mm_set1_ps( 65535.f );
+
+        int x = 0;
+        for( ; x < (count - 7); x += 8 )
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + x ), scale8_sse41_step_( sums + x, scale_v, max_value ) );
+        }
+        detail::scale_line( dst, sums, x, count, scale );
+    }
+}
+
+img_filter::frame_accumulate::line_funcs    img_filter::frame_accumulate::get_line_funcs_sse41( img::fourcc fcc )
+{
+    if( img::is_by8_fcc( fcc ) || fcc == img::fourcc::MONO8 ) {
+        return { &add_line_by8_sse41, &add_masked_line_by8_sse41, &scale_line_by8_sse41 };
+    }
+    if( img::is_by16_fcc( fcc ) || fcc == img::fourcc::MONO16 ) {
+        return { &add_line_by16_sse41, &add_masked_line_by16_sse41, &scale_line_by16_sse41 };
+    }
+    return {};
+}
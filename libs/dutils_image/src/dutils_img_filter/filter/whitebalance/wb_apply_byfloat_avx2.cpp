@@ -0,0 +1,109 @@
+#include "wb_apply.h"
+
+#include <immintrin.h>
+
+#include <cassert>
+
+namespace {
+
+FORCEINLINE
+__m256	    wb_byf_avx2_step_( __m256 src, __m256 mul ) noexcept
+{
+    return _mm256_min_ps( _mm256_mul_ps( src, mul ), _mm256_set1_ps( 1.f ) );
+}
+
+FORCEINLINE
+static void    wb_byf_line_avx2_loop( float* line, int dim_x, __m256 f0 ) noexcept
+{
+    for( int x = 0; x < (dim_x - 7); x += 8 )
+    {
+        const __m256 res = wb_byf_avx2_step_( _mm256_loadu_ps( line + x ), f0 );
+
+        _mm256_storeu_ps( line + x, res );
+    }
+}
+
+FORCEINLINE
+static void    wb_byf_line_avx2( float* line, int dim_x, __m256 f0, __m256 f1 ) noexcept
+{
+    assert( dim_x >= 8 );
+
+    if( dim_x % 8 == 0 )
+    {
+        wb_byf_line_avx2_loop( line, dim_x, f0 );
+    }
+    else
+    {
+        // loaded before the loop, so the overlapping pixels are only balanced once
+        const __m256 last = _mm256_loadu_ps( line + dim_x - 8 );
+
+        wb_byf_line_avx2_loop( line, dim_x, f0 );
+
+        if( dim_x % 2 == 0 ) {
+            _mm256_storeu_ps( line + dim_x - 8, wb_byf_avx2_step_( last, f0 ) );
+        } else {
+            _mm256_storeu_ps( line + dim_x - 8, wb_byf_avx2_step_( last, f1 ) );
+        }
+    }
+}
+
+static void	wb_byf_image_avx2( img::img_descriptor dst, __m256 factor00, __m256 factor01, __m256 factor10, __m256 factor11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        float* dst_line0 = img::get_line_start<float>( dst, y + 0 );
+        float* dst_line1 = img::get_line_start<float>( dst, y + 1 );
+
+        wb_byf_line_avx2( dst_line0, dst.dim.cx, factor00, factor01 );
+        wb_byf_line_avx2( dst_line1, dst.dim.cx, factor10, factor11 );
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        float* dst_line0 = img::get_line_start<float>( dst, y + 0 );
+        wb_byf_line_avx2( dst_line0, dst.dim.cx, factor00, factor01 );
+    }
+}
+
+FORCEINLINE
+static __m256 fill_factors( float fac0, float fac1 ) noexcept
+{
+    return _mm256_setr_ps( fac0, fac1, fac0, fac1, fac0, fac1, fac0, fac1 );
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_byfloat_avx2( const img::img_descriptor& dst, const apply_params& params )
+{
+    if( params.wb_rr == 1.f && params.wb_gr == 1.f && params.wb_bb == 1.f && params.wb_gb == 1.f ) {
+        return;
+    }
+    assert( dst.dim.cx >= 8 );
+
+    const __m256 bg = fill_factors( params.wb_bb, params.wb_gb );
+    const __m256 gb = fill_factors( params.wb_gb, params.wb_bb );
+    const __m256 gr = fill_factors( params.wb_gr, params.wb_rr );
+    const __m256 rg = fill_factors( params.wb_rr, params.wb_gr );
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGGRFloat:	wb_byf_image_avx2( dst, bg, gb, gr, rg ); break;
+    case img::fourcc::GBRGFloat:	wb_byf_image_avx2( dst, gb, bg, rg, gr ); break;
+    case img::fourcc::GRBGFloat:	wb_byf_image_avx2( dst, gr, rg, bg, gb ); break;
+    case img::fourcc::RGGBFloat:	wb_byf_image_avx2( dst, rg, gr, gb, bg ); break;
+    default:
+        break;
+    };
+}
+
+auto    img_filter::whitebalance::get_apply_img_avx2( img::img_type dst ) -> img_filter::whitebalance::func_type
+{
+    if( dst.dim.cx < 16 ) {
+        return nullptr;
+    }
+
+    if( img::is_byfloat_fcc( dst.fourcc_type() ) ) {
+        return detail::apply_wb_byfloat_avx2;
+    }
+    return nullptr;
+}
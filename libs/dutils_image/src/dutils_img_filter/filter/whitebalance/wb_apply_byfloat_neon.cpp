@@ -0,0 +1,93 @@
+#include "wb_apply.h"
+
+#include "../../simd_helper/use_simd_A64.h"
+
+#include <cassert>
+
+namespace
+{
+
+FORCEINLINE
+float32x4_t	    wb_byf_neon_step_( float32x4_t src, float32x4_t mul ) noexcept
+{
+    return vminq_f32( vmulq_f32( src, mul ), vdupq_n_f32( 1.f ) );
+}
+
+FORCEINLINE
+static void    wb_byf_line_neon_loop( float* line, int dim_x, float32x4_t f0 ) noexcept
+{
+    for( int x = 0; x < (dim_x - 7); x += 8 )
+    {
+        const float32x4_t res0 = wb_byf_neon_step_( vld1q_f32( line + x + 0 ), f0 );
+        const float32x4_t res1 = wb_byf_neon_step_( vld1q_f32( line + x + 4 ), f0 );
+
+        vst1q_f32( line + x + 0, res0 );
+        vst1q_f32( line + x + 4, res1 );
+    }
+}
+
+FORCEINLINE
+static void    wb_byf_line_neon( float* line, int dim_x, float32x4_t f0, float32x4_t f1 ) noexcept
+{
+    assert( dim_x >= 8 );
+
+    if( dim_x % 8 == 0 )
+    {
+        wb_byf_line_neon_loop( line, dim_x, f0 );
+    }
+    else
+    {
+        // loaded before the loop, so the overlapping pixels are only balanced once
+        const float32x4_t last0 = vld1q_f32( line + dim_x - 8 );
+        const float32x4_t last1 = vld1q_f32( line + dim_x - 4 );
+
+        wb_byf_line_neon_loop( line, dim_x, f0 );
+
+        const float32x4_t f = (dim_x % 2 == 0) ? f0 : f1;
+        vst1q_f32( line + dim_x - 8, wb_byf_neon_step_( last0, f ) );
+        vst1q_f32( line + dim_x - 4, wb_byf_neon_step_( last1, f ) );
+    }
+}
+
+static void	wb_byf_image_neon( img::img_descriptor dst, float32x4_t factor00, float32x4_t factor01, float32x4_t factor10, float32x4_t factor11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        float* dst_line0 = img::get_line_start<float>( dst, y + 0 );
+        float* dst_line1 = img::get_line_start<float>( dst, y + 1 );
+
+        wb_byf_line_neon( dst_line0, dst.dim.cx, factor00, factor01 );
+        wb_byf_line_neon( dst_line1, dst.dim.cx, factor10, factor11 );
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        float* dst_line0 = img::get_line_start<float>( dst, y + 0 );
+        wb_byf_line_neon( dst_line0, dst.dim.cx, factor00, factor01 );
+    }
+}
+
+}
+
+void		img_filter::whitebalance::detail::apply_wb_byfloat_neon( const img::img_descriptor& dst, const apply_params& params )
+{
+    if( params.wb_rr == 1.f && params.wb_gr == 1.f && params.wb_bb == 1.f && params.wb_gb == 1.f ) {
+        return;
+    }
+    assert( dst.dim.cx >= 8 );
+
+    const float32x4_t bg = float32x4_t{ params.wb_bb, params.wb_gb, params.wb_bb, params.wb_gb };
+    const float32x4_t gb = float32x4_t{ params.wb_gb, params.wb_bb, params.wb_gb, params.wb_bb };
+    const float32x4_t gr = float32x4_t{ params.wb_gr, params.wb_rr, params.wb_gr, params.wb_rr };
+    const float32x4_t rg = float32x4_t{ params.wb_rr, params.wb_gr, params.wb_rr, params.wb_gr };
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::BGGRFloat:	wb_byf_image_neon( dst, bg, gb, gr, rg ); break;
+    case img::fourcc::GBRGFloat:	wb_byf_image_neon( dst, gb, bg, rg, gr ); break;
+    case img::fourcc::GRBGFloat:	wb_byf_image_neon( dst, gr, rg, bg, gb ); break;
+    case img::fourcc::RGGBFloat:	wb_byf_image_neon( dst, rg, gr, gb, bg ); break;
+    default:
+        break;
+    };
+}
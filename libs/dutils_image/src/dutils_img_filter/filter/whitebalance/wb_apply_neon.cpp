@@ -11,6 +11,8 @@ auto    img_filter::whitebalance::get_apply_img_neon( img::img_type dst ) -> img
         return wrap_apply_func_to_u8<&detail::apply_wb_by8_neon>;
     } else if( img::is_by16_fcc( dst.fourcc_type() ) ) {
         return wrap_apply_func_to_u8<&detail::apply_wb_by16_neon>;
+    } else if( img::is_byfloat_fcc( dst.fourcc_type() ) ) {
+        return detail::apply_wb_byfloat_neon;
     }
     return nullptr;
 }
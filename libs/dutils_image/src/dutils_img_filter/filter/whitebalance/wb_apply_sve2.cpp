@@ -0,0 +1,106 @@
+#include "wb_apply.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <arm_sve.h>
+
+/*
+ * SVE2 variants of the by8/by16 white balance, the lines are processed in vector length chunks and
+ * the tail is done with a predicate, so this works for every SVE vector length.
+ * The even pixels are multiplied with the bottom, the odd pixels with the top half of the factor pairs.
+ */
+
+namespace
+{
+
+// factor_00 for the even, factor_01 for the odd pixels of the line
+void    wb_by8_line_sve2( uint8_t* line, int dim_x, uint8_t factor_00, uint8_t factor_01 ) noexcept
+{
+    const svuint8_t fac = svreinterpret_u8_u16( svdup_n_u16( static_cast<uint16_t>( factor_01 << 8 | factor_00 ) ) );
+
+    for( int x = 0; x < dim_x; x += static_cast<int>( svcntb() ) )
+    {
+        const svbool_t pg = svwhilelt_b8( x, dim_x );
+
+        const svuint8_t src = svld1_u8( pg, line + x );
+
+        const svuint16_t tmp_even = svmullb_u16( src, fac );
+        const svuint16_t tmp_odd = svmullt_u16( src, fac );
+
+        const svuint8_t res = svqshrnt_n_u16( svqshrnb_n_u16( tmp_even, 6 ), tmp_odd, 6 );   // (src * fac) / 64 with saturation
+
+        svst1_u8( pg, line + x, res );
+    }
+}
+
+void    wb_by16_line_sve2( uint16_t* line, int dim_x, uint8_t factor_00, uint8_t factor_01 ) noexcept
+{
+    const svuint16_t fac = svreinterpret_u16_u32( svdup_n_u32( static_cast<uint32_t>( factor_01 ) << 16 | factor_00 ) );
+
+    for( int x = 0; x < dim_x; x += static_cast<int>( svcnth() ) )
+    {
+        const svbool_t pg = svwhilelt_b16( x, dim_x );
+
+        const svuint16_t src = svld1_u16( pg, line + x );
+
+        const svuint32_t tmp_even = svmullb_u32( src, fac );
+        const svuint32_t tmp_odd = svmullt_u32( src, fac );
+
+        const svuint16_t res = svqshrnt_n_u32( svqshrnb_n_u32( tmp_even, 6 ), tmp_odd, 6 );
+
+        svst1_u16( pg, line + x, res );
+    }
+}
+
+template<typename TPixel, void (*wb_line)( TPixel*, int, uint8_t, uint8_t ) noexcept>
+void    wb_image_sve2( const img::img_descriptor& dst, uint8_t factor_00, uint8_t factor_01, uint8_t factor_10, uint8_t factor_11 ) noexcept
+{
+    int y = 0;
+    for( ; y < (dst.dim.cy - 1); y += 2 )
+    {
+        wb_line( img::get_line_start<TPixel>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );
+        wb_line( img::get_line_start<TPixel>( dst, y + 1 ), dst.dim.cx, factor_10, factor_11 );
+    }
+    if( y == (dst.dim.cy - 1) )
+    {
+        wb_line( img::get_line_start<TPixel>( dst, y + 0 ), dst.dim.cx, factor_00, factor_01 );
+    }
+}
+
+template<typename TPixel, void (*wb_line)( TPixel*, int, uint8_t, uint8_t ) noexcept>
+void    wb_image_by_pattern_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb ) noexcept
+{
+    if( wb_r == 64 && wb_gr == 64 && wb_b == 64 && wb_gb == 64 ) {
+        return;
+    }
+
+    switch( img::by_transform::convert_bayer_fcc_to_pattern( dst.fourcc_type() ) )
+    {
+    case img::by_transform::by_pattern::BG:    wb_image_sve2<TPixel, wb_line>( dst, wb_b, wb_gb, wb_gr, wb_r ); break;
+    case img::by_transform::by_pattern::GB:    wb_image_sve2<TPixel, wb_line>( dst, wb_gb, wb_b, wb_r, wb_gr ); break;
+    case img::by_transform::by_pattern::GR:    wb_image_sve2<TPixel, wb_line>( dst, wb_gr, wb_r, wb_b, wb_gb ); break;
+    case img::by_transform::by_pattern::RG:    wb_image_sve2<TPixel, wb_line>( dst, wb_r, wb_gr, wb_gb, wb_b ); break;
+    };
+}
+
+}
+
+void    img_filter::whitebalance::detail::apply_wb_by8_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    wb_image_by_pattern_sve2<uint8_t, &wb_by8_line_sve2>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+void    img_filter::whitebalance::detail::apply_wb_by16_sve2( const img::img_descriptor& dst, uint8_t wb_r, uint8_t wb_gr, uint8_t wb_b, uint8_t wb_gb )
+{
+    wb_image_by_pattern_sve2<uint16_t, &wb_by16_line_sve2>( dst, wb_r, wb_gr, wb_b, wb_gb );
+}
+
+auto    img_filter::whitebalance::get_apply_img_sve2( img::img_type dst ) -> img_filter::whitebalance::func_type
+{
+    if( img::is_by8_fcc( dst.fourcc_type() ) ) {
+        return wrap_apply_func_to_u8<&detail::apply_wb_by8_sve2>;
+    } else if( img::is_by16_fcc( dst.fourcc_type() ) ) {
+        return wrap_apply_func_to_u8<&detail::apply_wb_by16_sve2>;
+    }
+    return nullptr;
+}
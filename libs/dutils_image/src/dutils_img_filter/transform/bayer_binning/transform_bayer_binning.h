@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../transform_base.h"
+
+namespace img_filter {
+namespace transform {
+namespace bayer_binning
+{
+    /*
+     * Bayer8 -> bayer8 at 1/2 or 1/4 of the width and height.
+     * Each dst pixel is the average of the 2x2 or 4x4 src pixels of the same color in its superpixel,
+     * so the bayer pattern is kept and the result can be debayered as usual.
+     */
+    transform_function_type     get_transform_by8_binning_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_by8_binning_sse41( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_by8_binning_neon( const img::img_type& dst, const img::img_type& src );
+
+    // 2 or 4 when dst is a valid binned dim of src, otherwise 0
+    constexpr int   get_binning_factor( img::dim dst, img::dim src ) noexcept
+    {
+        if( dst.cx <= 0 || dst.cy <= 0 || (dst.cx % 2) != 0 || (dst.cy % 2) != 0 ) {
+            return 0;
+        }
+        for( int factor : { 2, 4 } )
+        {
+            if( dst.cx * factor == src.cx && dst.cy * factor == src.cy ) {
+                return factor;
+            }
+        }
+        return 0;
+    }
+}
+}
+}
@@ -0,0 +1,31 @@
+#include "transform_bayer_binning_internal.h"
+
+namespace
+{
+    using namespace transform_bayer_binning_internal;
+
+    template<int factor>
+    void    transform_by8_binning_c( img::img_descriptor dst, img::img_descriptor src )
+    {
+        by8_binning_image_loop<factor>( dst, src,
+            []( uint8_t* dst_line, const uint8_t* const (&src_lines)[factor], int dim_x )
+            {
+                bin_line_c<factor>( dst_line, src_lines, 0, dim_x );
+            } );
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::bayer_binning::get_transform_by8_binning_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_bayer_binning_internal::can_transform_by8_binning( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( get_binning_factor( dst.dim, src.dim ) )
+    {
+    case 2:     return &transform_by8_binning_c<2>;
+    case 4:     return &transform_by8_binning_c<4>;
+    default:
+        return nullptr;
+    }
+}
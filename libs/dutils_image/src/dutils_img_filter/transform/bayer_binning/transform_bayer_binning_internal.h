@@ -0,0 +1,59 @@
+#pragma once
+
+#include "transform_bayer_binning.h"
+
+namespace transform_bayer_binning_internal
+{
+    constexpr bool  can_transform_by8_binning( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_by8_fcc( src.fourcc_type() ) || dst.fourcc_type() != src.fourcc_type() ) {
+            return false;
+        }
+        return img_filter::transform::bayer_binning::get_binning_factor( dst.dim, src.dim ) != 0;
+    }
+
+    // first src line of the dst line y, the other lines of the bin follow every 2nd line
+    template<int factor>
+    constexpr int   src_line_of( int y ) noexcept
+    {
+        return (y / 2) * 2 * factor + (y % 2);
+    }
+
+    // dst pixels [x;dim_x) of the dst line, src_lines are the factor lines of the bin
+    template<int factor>
+    FORCEINLINE void    bin_line_c( uint8_t* dst_line, const uint8_t* const (&src_lines)[factor], int x, int dim_x ) noexcept
+    {
+        constexpr int count = factor * factor;
+
+        for( ; x < dim_x; ++x )
+        {
+            const int src_x = (x / 2) * 2 * factor + (x % 2);
+
+            int sum = 0;
+            for( int k = 0; k < factor; ++k ) {
+                for( int j = 0; j < factor; ++j ) {
+                    sum += src_lines[k][src_x + j * 2];
+                }
+            }
+            dst_line[x] = static_cast<uint8_t>( (sum + count / 2) / count );
+        }
+    }
+
+    /*
+     * TBinLine is called as func( dst_line, src_lines, dim_x ) for every dst line.
+     */
+    template<int factor, class TBinLine>
+    void    by8_binning_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, TBinLine bin_line )
+    {
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            const int src_y = src_line_of<factor>( y );
+
+            const uint8_t* src_lines[factor];
+            for( int k = 0; k < factor; ++k ) {
+                src_lines[k] = img::get_line_start( src, src_y + k * 2 );
+            }
+            bin_line( img::get_line_start( dst, y ), src_lines, dst.dim.cx );
+        }
+    }
+}
@@ -0,0 +1,83 @@
+
+#include "../../simd_helper/use_simd_A64.h"
+
+#include "transform_bayer_binning_internal.h"
+
+/*
+ * The de-interleaving loads split even and odd pixels, pairwise adds sum the pixels of one dst pixel.
+ * 16 dst pixels per step.
+ */
+
+namespace
+{
+    using namespace transform_bayer_binning_internal;
+
+    constexpr int pixels_per_step = 16;
+
+    // sums of the src pixels of the 8 even and 8 odd dst pixels of a step in one src line
+    template<int factor>
+    FORCEINLINE uint16x8x2_t    sum_16px( const uint8_t* src ) noexcept
+    {
+        if constexpr( factor == 2 )
+        {
+            const uint8x16x2_t v = vld2q_u8( src );
+            return { { vpaddlq_u8( v.val[0] ), vpaddlq_u8( v.val[1] ) } };
+        }
+        else
+        {
+            const uint8x16x2_t v0 = vld2q_u8( src + 0 );
+            const uint8x16x2_t v1 = vld2q_u8( src + 32 );
+
+            const uint16x8_t e0 = vpaddlq_u8( v0.val[0] );
+            const uint16x8_t o0 = vpaddlq_u8( v0.val[1] );
+            const uint16x8_t e1 = vpaddlq_u8( v1.val[0] );
+            const uint16x8_t o1 = vpaddlq_u8( v1.val[1] );
+            return { {
+                vcombine_u16( vpadd_u16( vget_low_u16( e0 ), vget_high_u16( e0 ) ), vpadd_u16( vget_low_u16( e1 ), vget_high_u16( e1 ) ) ),
+                vcombine_u16( vpadd_u16( vget_low_u16( o0 ), vget_high_u16( o0 ) ), vpadd_u16( vget_low_u16( o1 ), vget_high_u16( o1 ) ) ),
+            } };
+        }
+    }
+
+    template<int factor>
+    void    bin_line_neon( uint8_t* dst_line, const uint8_t* const (&src_lines)[factor], int dim_x ) noexcept
+    {
+        constexpr int count_log2 = factor == 2 ? 2 : 4;
+
+        int x = 0;
+        for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+        {
+            uint16x8x2_t sum = sum_16px<factor>( src_lines[0] + x * factor );
+            for( int k = 1; k < factor; ++k )
+            {
+                const uint16x8x2_t s = sum_16px<factor>( src_lines[k] + x * factor );
+                sum.val[0] = vaddq_u16( sum.val[0], s.val[0] );
+                sum.val[1] = vaddq_u16( sum.val[1], s.val[1] );
+            }
+            const uint8x8x2_t res = { { vrshrn_n_u16( sum.val[0], count_log2 ), vrshrn_n_u16( sum.val[1], count_log2 ) } };
+            vst2_u8( dst_line + x, res );
+        }
+        bin_line_c<factor>( dst_line, src_lines, x, dim_x );
+    }
+
+    template<int factor>
+    void    transform_by8_binning_neon( img::img_descriptor dst, img::img_descriptor src )
+    {
+        by8_binning_image_loop<factor>( dst, src, &bin_line_neon<factor> );
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::bayer_binning::get_transform_by8_binning_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_bayer_binning_internal::can_transform_by8_binning( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( get_binning_factor( dst.dim, src.dim ) )
+    {
+    case 2:     return &transform_by8_binning_neon<2>;
+    case 4:     return &transform_by8_binning_neon<4>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,84 @@
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+#include "transform_bayer_binning_internal.h"
+
+/*
+ * The src bytes are shuffled so that pixels of the same color and dst pixel are neighbours,
+ * maddubs with 1 then sums them. 16 dst pixels per step.
+ */
+
+namespace
+{
+    using namespace transform_bayer_binning_internal;
+
+    constexpr int pixels_per_step = 16;
+
+    // sums of the src pixels of 8 dst pixels in one src line, from 8 * factor bytes
+    template<int factor>
+    FORCEINLINE __m128i     sum_8px( const uint8_t* src ) noexcept
+    {
+        const __m128i ones = _mm_set1_epi8( 1 );
+        if constexpr( factor == 2 )
+        {
+            const __m128i shuffle = _mm_setr_epi8( 0, 2, 1, 3, 4, 6, 5, 7, 8, 10, 9, 11, 12, 14, 13, 15 );
+            const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+            return _mm_maddubs_epi16( _mm_shuffle_epi8( v, shuffle ), ones );
+        }
+        else
+        {
+            // even/odd pixel pairs, hadd completes the sums of 4
+            const __m128i shuffle = _mm_setr_epi8( 0, 2, 4, 6, 1, 3, 5, 7, 8, 10, 12, 14, 9, 11, 13, 15 );
+            const __m128i v0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) + 0 );
+            const __m128i v1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) + 1 );
+            return _mm_hadd_epi16( _mm_maddubs_epi16( _mm_shuffle_epi8( v0, shuffle ), ones ),
+                                   _mm_maddubs_epi16( _mm_shuffle_epi8( v1, shuffle ), ones ) );
+        }
+    }
+
+    template<int factor>
+    FORCEINLINE __m128i     bin_8px( const uint8_t* const (&src_lines)[factor], int src_x ) noexcept
+    {
+        constexpr int count_log2 = factor == 2 ? 2 : 4;
+
+        __m128i sum = sum_8px<factor>( src_lines[0] + src_x );
+        for( int k = 1; k < factor; ++k ) {
+            sum = _mm_add_epi16( sum, sum_8px<factor>( src_lines[k] + src_x ) );
+        }
+        return _mm_srli_epi16( _mm_add_epi16( sum, _mm_set1_epi16( 1 << (count_log2 - 1) ) ), count_log2 );
+    }
+
+    template<int factor>
+    void    bin_line_sse41( uint8_t* dst_line, const uint8_t* const (&src_lines)[factor], int dim_x ) noexcept
+    {
+        int x = 0;
+        for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+        {
+            const __m128i lo = bin_8px<factor>( src_lines, x * factor );
+            const __m128i hi = bin_8px<factor>( src_lines, (x + 8) * factor );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst_line + x ), _mm_packus_epi16( lo, hi ) );
+        }
+        bin_line_c<factor>( dst_line, src_lines, x, dim_x );
+    }
+
+    template<int factor>
+    void    transform_by8_binning_sse41( img::img_descriptor dst, img::img_descriptor src )
+    {
+        by8_binning_image_loop<factor>( dst, src, &bin_line_sse41<factor> );
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::bayer_binning::get_transform_by8_binning_sse41( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_bayer_binning_internal::can_transform_by8_binning( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( get_binning_factor( dst.dim, src.dim ) )
+    {
+    case 2:     return &transform_by8_binning_sse41<2>;
+    case 4:     return &transform_by8_binning_sse41<4>;
+    default:
+        return nullptr;
+    }
+}
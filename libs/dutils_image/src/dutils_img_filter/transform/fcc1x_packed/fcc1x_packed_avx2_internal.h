@@ -0,0 +1,190 @@
+#pragma once
+
+#include "fcc1x_packed_to_fcc_internal.h"
+#include "fcc1x_packed_to_fcc8_internal.h"
+#include "fcc1x_packed_to_fcc16_internal.h"
+
+#include "../../../dutils_img_base/interop_private.h"
+
+#include <immintrin.h>
+
+/*
+ * Unpack steps shared by the AVX2 kernels, only include this from files compiled with -mavx2.
+ *
+ * pshufb only shuffles within 128-bit lanes, so for the packed formats each lane is loaded separately
+ * with the 8 pixels it converts and the ssse3 shuffle masks are used in both lanes.
+ */
+
+namespace fcc1x_packed_avx2_internal
+{
+    using namespace fcc1x_packed_internal;
+    using img::fcc1x_packed::fccXX_pack_type;
+
+    template<fccXX_pack_type pack_type>
+    constexpr bool  is_fcc16_pack_type() noexcept
+    {
+        return pack_type == fccXX_pack_type::fcc12 || pack_type == fccXX_pack_type::fcc10;
+    }
+
+    template<fccXX_pack_type pack_type>
+    constexpr int   src_offset( int x ) noexcept
+    {
+        if constexpr( is_fcc16_pack_type<pack_type>() ) {
+            return x * 2;
+        } else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked || pack_type == fccXX_pack_type::fcc10_mipi ) {
+            return (x / 4) * 5;
+        } else {
+            return (x / 2) * 3;
+        }
+    }
+
+    // pixels from x on which must be in the line for one load_fcc16_step, the lane loads of the packed formats read 16 bytes, but use less
+    template<fccXX_pack_type pack_type>
+    constexpr int   load_step_pixels_needed() noexcept
+    {
+        if constexpr( is_fcc16_pack_type<pack_type>() ) {
+            return 16;
+        }
+        return 16 + 8;
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE uint16_t    calc_fcc16( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12 )                 return calc_fcc12_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )       return calc_fcc12_mipi_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_packed )     return calc_fcc12_packed_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_spacked )    return calc_fcc12_spacked_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10 )            return calc_fcc10_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked )    return calc_fcc10_spacked_to_fcc16( src_line, x );
+        else                                                                return calc_fcc10_packed_mipi_to_fcc16( src_line, x );
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE uint8_t     calc_fcc8( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12 )                 return calc_fcc12_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )       return calc_fcc12_mipi_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_packed )     return calc_fcc12_packed_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_spacked )    return calc_fcc12_spacked_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10 )            return calc_fcc10_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked )    return calc_fcc10_spacked_to_fcc8( src_line, x );
+        else                                                                return calc_fcc10_mipi_to_fcc8( src_line, x );
+    }
+
+    // same 16 byte shuffle mask in both lanes
+    FORCEINLINE __m256i     make_lane_mask( char m0, char m1, char m2, char m3, char m4, char m5, char m6, char m7,
+                                            char m8, char m9, char m10, char m11, char m12, char m13, char m14, char m15 ) noexcept
+    {
+        return _mm256_broadcastsi128_si256( _mm_setr_epi8( m0, m1, m2, m3, m4, m5, m6, m7, m8, m9, m10, m11, m12, m13, m14, m15 ) );
+    }
+
+    FORCEINLINE __m256i     unpack_fcc12_nibble_pairs( __m256i v0, __m256i scatter_upper, __m256i scatter_nibbles ) noexcept
+    {
+        const __m256i upper = _mm256_shuffle_epi8( v0, scatter_upper );
+        const __m256i nibbles = _mm256_shuffle_epi8( v0, scatter_nibbles );
+
+        const __m256i lo_even = _mm256_and_si256( _mm256_slli_epi16( nibbles, 4 ), _mm256_set1_epi32( 0x0000'00F0 ) );
+        const __m256i lo_odd = _mm256_and_si256( nibbles, _mm256_set1_epi32( 0x00F0'0000 ) );
+
+        return _mm256_or_si256( upper, _mm256_or_si256( lo_even, lo_odd ) );
+    }
+
+    // shifts u16 lane k of each 4 pixel group left by 6 - 2k
+    FORCEINLINE __m256i     shift_by_group_position( __m256i v ) noexcept
+    {
+        return _mm256_mullo_epi16( v, _mm256_setr_epi16( 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1 ) );
+    }
+
+    // the 16 bytes with the lane of pixel x and pixel x + 8
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE __m256i     load_lanes( const uint8_t* src_line, int x ) noexcept
+    {
+        const __m128i lo = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + src_offset<pack_type>( x + 0 ) ) );
+        const __m128i hi = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + src_offset<pack_type>( x + 8 ) ) );
+        return _mm256_inserti128_si256( _mm256_castsi128_si256( lo ), hi, 1 );
+    }
+
+    // 16 pixel starting at x as fcc16
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE __m256i     load_fcc16_step( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( is_fcc16_pack_type<pack_type>() )
+        {
+            const __m256i v0 = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( src_line + src_offset<pack_type>( x ) ) );
+            return _mm256_slli_epi16( v0, pack_type == fccXX_pack_type::fcc12 ? 4 : 6 );
+        }
+        else
+        {
+            const __m256i v0 = load_lanes<pack_type>( src_line, x );
+
+            if constexpr( pack_type == fccXX_pack_type::fcc12_packed )
+            {
+                const __m256i scatter_upper = make_lane_mask( -1, 0, -1, 2, -1, 3, -1, 5, -1, 6, -1, 8, -1, 9, -1, 11 );
+                const __m256i scatter_nibbles = make_lane_mask( 1, -1, 1, -1, 4, -1, 4, -1, 7, -1, 7, -1, 10, -1, 10, -1 );
+                return unpack_fcc12_nibble_pairs( v0, scatter_upper, scatter_nibbles );
+            }
+            else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )
+            {
+                const __m256i scatter_upper = make_lane_mask( -1, 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10 );
+                const __m256i scatter_nibbles = make_lane_mask( 2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1 );
+                return unpack_fcc12_nibble_pairs( v0, scatter_upper, scatter_nibbles );
+            }
+            else if constexpr( pack_type == fccXX_pack_type::fcc12_spacked )
+            {
+                const __m256i scatter = make_lane_mask( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 );
+                const __m256i tmp = _mm256_shuffle_epi8( v0, scatter );
+
+                const __m256i even = _mm256_and_si256( _mm256_slli_epi16( tmp, 4 ), _mm256_set1_epi32( 0x0000'FFFF ) );
+                const __m256i odd = _mm256_and_si256( tmp, _mm256_set1_epi32( static_cast<int>( 0xFFF0'0000 ) ) );
+                return _mm256_or_si256( even, odd );
+            }
+            else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked )
+            {
+                const __m256i scatter = make_lane_mask( 0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9 );
+                const __m256i tmp = _mm256_shuffle_epi8( v0, scatter );
+
+                const __m256i shifted = shift_by_group_position( tmp );
+                return _mm256_and_si256( shifted, _mm256_set1_epi16( static_cast<short>( 0xFFC0 ) ) );
+            }
+            else if constexpr( pack_type == fccXX_pack_type::fcc10_mipi )
+            {
+                const __m256i scatter_upper = make_lane_mask( -1, 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8 );
+                const __m256i scatter_lower = make_lane_mask( 4, -1, 4, -1, 4, -1, 4, -1, 9, -1, 9, -1, 9, -1, 9, -1 );
+
+                const __m256i upper = _mm256_shuffle_epi8( v0, scatter_upper );
+                const __m256i lower = _mm256_shuffle_epi8( v0, scatter_lower );
+
+                const __m256i shifted = shift_by_group_position( lower );
+                return _mm256_or_si256( upper, _mm256_and_si256( shifted, _mm256_set1_epi16( 0x00C0 ) ) );
+            }
+            else
+            {
+                static_assert(pack_type == fccXX_pack_type::fcc12_packed, "pack type not implemented");
+            }
+        }
+    }
+
+    // 16 pixel starting at x as fcc8 in the low bytes of the u16 lanes, the high bytes are 0
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE __m256i     load_fcc8_step( const uint8_t* src_line, int x ) noexcept
+    {
+        // the formats with the upper 8 bits in whole bytes only need one shuffle
+        if constexpr( pack_type == fccXX_pack_type::fcc12_packed )
+        {
+            return _mm256_shuffle_epi8( load_lanes<pack_type>( src_line, x ), make_lane_mask( 0, -1, 2, -1, 3, -1, 5, -1, 6, -1, 8, -1, 9, -1, 11, -1 ) );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )
+        {
+            return _mm256_shuffle_epi8( load_lanes<pack_type>( src_line, x ), make_lane_mask( 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1 ) );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_mipi )
+        {
+            return _mm256_shuffle_epi8( load_lanes<pack_type>( src_line, x ), make_lane_mask( 0, -1, 1, -1, 2, -1, 3, -1, 5, -1, 6, -1, 7, -1, 8, -1 ) );
+        }
+        else
+        {
+            return _mm256_srli_epi16( load_fcc16_step<pack_type>( src_line, x ), 8 );
+        }
+    }
+}
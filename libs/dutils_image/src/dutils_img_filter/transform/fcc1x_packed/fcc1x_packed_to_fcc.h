@@ -23,11 +23,16 @@ namespace fcc1x_packed
     // Note: this transforms any of the fcc10/fcc12/or fcc16L12 formats to its equiv fcc16 format
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_c( const img::img_type& dst, const img::img_type& src );
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_ssse3( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_fcc10or12_packed_to_fcc16_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_fcc10or12_packed_to_fcc16_avx512vbmi( const img::img_type& dst, const img::img_type& src );   // only 12_packed, 12_mipi and 10_mipi
     transform_function_type     get_transform_fcc10or12_packed_to_fcc16_neon_v0( const img::img_type& dst, const img::img_type& src );
 
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_ssse3( const img::img_type& dst, const img::img_type& src );
+	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src );
+	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_avx512vbmi( const img::img_type& dst, const img::img_type& src );    // only 12_packed, 12_mipi and 10_mipi
 	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_neon_v0( const img::img_type& dst, const img::img_type& src );
+	transform_function_type     get_transform_fcc10or12_packed_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src );    // no spacked formats, check for CPU_ARM_SVE2
 
 }
 }
@@ -0,0 +1,73 @@
+#include "fcc1x_packed_to_fcc.h"
+
+#include "fcc1x_packed_avx2_internal.h"
+
+/*
+ * AVX2 variant of fcc1x_packed_to_fcc8_ssse3_v0.cpp, bit exact to fcc1x_packed_to_fcc8_c.cpp.
+ * Each step converts 32 pixels, the rest of the line is done with the c pixel functions.
+ */
+
+using namespace fcc1x_packed_avx2_internal;
+
+namespace
+{
+    using namespace img::fcc1x_packed;
+
+    template<fccXX_pack_type pack_type>
+    void transform_fcc1x_packed_to_fcc8_avx2_line( uint8_t* dst_line, const uint8_t* src_line, int width ) noexcept
+    {
+        int x = 0;
+        for( ; x + 16 + load_step_pixels_needed<pack_type>() <= width; x += 32 )
+        {
+            const __m256i v0 = load_fcc8_step<pack_type>( src_line, x + 0 );
+            const __m256i v1 = load_fcc8_step<pack_type>( src_line, x + 16 );
+
+            // packus works per lane, restore pixel order afterwards
+            const __m256i packed = _mm256_permute4x64_epi64( _mm256_packus_epi16( v0, v1 ), 0b11'01'10'00 );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst_line + x ), packed );
+        }
+        for( ; x < width; ++x )
+        {
+            dst_line[x] = calc_fcc8<pack_type>( src_line, x );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void transform_fcc1x_packed_to_fcc8_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            transform_fcc1x_packed_to_fcc8_avx2_line<pack_type>( img::get_line_start<uint8_t>( dst, y ), img::get_line_start<const uint8_t>( src, y ), src.dim.cx );
+        }
+    }
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:                return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc12>;
+    case fccXX_pack_type::fcc12_packed:         return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc12_mipi:           return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc12_spacked:        return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc12_spacked>;
+
+    case fccXX_pack_type::fcc10:                return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc10>;
+    case fccXX_pack_type::fcc10_spacked:        return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc10_spacked>;
+    case fccXX_pack_type::fcc10_mipi:           return ::transform_fcc1x_packed_to_fcc8_avx2_v0<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::invalid:              return nullptr;
+    };
+
+    return nullptr;
+}
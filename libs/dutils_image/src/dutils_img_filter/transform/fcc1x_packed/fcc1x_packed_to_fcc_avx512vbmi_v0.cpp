@@ -0,0 +1,233 @@
+#include "fcc1x_packed_to_fcc.h"
+
+#include "fcc1x_packed_to_fcc8_internal.h"
+#include "fcc1x_packed_to_fcc16_internal.h"
+
+#include "../../../dutils_img_base/interop_private.h"
+
+#include <immintrin.h>
+
+#include <array>
+
+/*
+ * AVX-512 VBMI variants for the formats where the upper 8 bits of a pixel are whole bytes (12_packed, 12_mipi, 10_mipi).
+ *
+ * vpermb gathers bytes across the whole register, so no lane splitting is necessary. For fcc8 one vpermt2b
+ * collects 64 pixels from 2 registers, for fcc16 one vpermb puts the high and the low bits byte of 32 pixels
+ * into their u16 and a variable shift moves the low bits into place.
+ * The loads past the used bytes are masked, the rest of the line is done with the c pixel functions.
+ */
+
+using namespace fcc1x_packed_internal;
+
+namespace
+{
+    using namespace img::fcc1x_packed;
+
+    template<fccXX_pack_type pack_type>
+    constexpr int   bytes_per_group = pack_type == fccXX_pack_type::fcc10_mipi ? 5 : 3;
+
+    template<fccXX_pack_type pack_type>
+    constexpr int   pixels_per_group = pack_type == fccXX_pack_type::fcc10_mipi ? 4 : 2;
+
+    // offset in the group of the byte with the upper 8 bits of pixel k
+    template<fccXX_pack_type pack_type>
+    constexpr int   upper_byte_offset( int k ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12_packed ) {
+            return k == 0 ? 0 : 2;
+        }
+        return k;
+    }
+
+    // offset in the group of the byte with the lower bits
+    template<fccXX_pack_type pack_type>
+    constexpr int   lower_bits_offset() noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12_packed ) {
+            return 1;
+        } else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi ) {
+            return 2;
+        }
+        return 4;
+    }
+
+    template<fccXX_pack_type pack_type>
+    constexpr std::array<uint8_t, 64>   make_fcc8_index() noexcept
+    {
+        constexpr int ppg = pixels_per_group<pack_type>;
+
+        std::array<uint8_t, 64> rval = {};
+        for( int i = 0; i < 64; ++i ) {
+            rval[i] = static_cast<uint8_t>( (i / ppg) * bytes_per_group<pack_type> + upper_byte_offset<pack_type>( i % ppg ) );
+        }
+        return rval;
+    }
+
+    // the low byte of u16 i gets the lower bits byte, the high byte the upper 8 bits of pixel i
+    template<fccXX_pack_type pack_type>
+    constexpr std::array<uint8_t, 64>   make_fcc16_index() noexcept
+    {
+        constexpr int ppg = pixels_per_group<pack_type>;
+
+        std::array<uint8_t, 64> rval = {};
+        for( int i = 0; i < 32; ++i ) {
+            const int group_start = (i / ppg) * bytes_per_group<pack_type>;
+            rval[i * 2 + 0] = static_cast<uint8_t>( group_start + lower_bits_offset<pack_type>() );
+            rval[i * 2 + 1] = static_cast<uint8_t>( group_start + upper_byte_offset<pack_type>( i % ppg ) );
+        }
+        return rval;
+    }
+
+    constexpr __mmask64     make_load_mask( int bytes ) noexcept
+    {
+        return bytes >= 64 ? ~__mmask64( 0 ) : (__mmask64( 1 ) << bytes) - 1;
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE uint8_t     calc_fcc8( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12_packed )      return calc_fcc12_packed_to_fcc8( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )   return calc_fcc12_mipi_to_fcc8( src_line, x );
+        else                                                            return calc_fcc10_mipi_to_fcc8( src_line, x );
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE uint16_t    calc_fcc16( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12_packed )      return calc_fcc12_packed_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )   return calc_fcc12_mipi_to_fcc16( src_line, x );
+        else                                                            return calc_fcc10_packed_mipi_to_fcc16( src_line, x );
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_fcc1x_packed_to_fcc8_avx512vbmi_line( uint8_t* dst_line, const uint8_t* src_line, int width ) noexcept
+    {
+        constexpr int src_bytes_per_step = (64 / pixels_per_group<pack_type>) * bytes_per_group<pack_type>;     // 96 or 80
+        constexpr __mmask64 load_mask_hi = make_load_mask( src_bytes_per_step - 64 );
+
+        static constexpr auto index_arr = make_fcc8_index<pack_type>();
+        const __m512i index = _mm512_loadu_si512( index_arr.data() );
+
+        int x = 0;
+        for( ; x + 64 <= width; x += 64 )
+        {
+            const uint8_t* src = src_line + (x / pixels_per_group<pack_type>) * bytes_per_group<pack_type>;
+
+            const __m512i v0 = _mm512_loadu_si512( src );
+            const __m512i v1 = _mm512_maskz_loadu_epi8( load_mask_hi, src + 64 );
+
+            _mm512_storeu_si512( dst_line + x, _mm512_permutex2var_epi8( v0, index, v1 ) );
+        }
+        for( ; x < width; ++x )
+        {
+            dst_line[x] = calc_fcc8<pack_type>( src_line, x );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_fcc1x_packed_to_fcc16_avx512vbmi_line( uint16_t* dst_line, const uint8_t* src_line, int width ) noexcept
+    {
+        constexpr int src_bytes_per_step = (32 / pixels_per_group<pack_type>) * bytes_per_group<pack_type>;     // 48 or 40
+        constexpr __mmask64 load_mask = make_load_mask( src_bytes_per_step );
+
+        static constexpr auto index_arr = make_fcc16_index<pack_type>();
+        const __m512i index = _mm512_loadu_si512( index_arr.data() );
+
+        // moves the lower bits of pixel k of a group to the bits right below the upper byte
+        const __m512i lower_shift = pack_type == fccXX_pack_type::fcc10_mipi ? _mm512_set1_epi64( 0x0000'0002'0004'0006 ) : _mm512_set1_epi32( 0x0000'0004 );
+        const __m512i lower_mask = _mm512_set1_epi16( pack_type == fccXX_pack_type::fcc10_mipi ? 0x00C0 : 0x00F0 );
+
+        int x = 0;
+        for( ; x + 32 <= width; x += 32 )
+        {
+            const uint8_t* src = src_line + (x / pixels_per_group<pack_type>) * bytes_per_group<pack_type>;
+
+            const __m512i packed = _mm512_maskz_loadu_epi8( load_mask, src );
+            // not _mm512_permutexvar_epi8, its undefined merge source makes GCC 12 emit -Wmaybe-uninitialized (GCC bug 105593)
+            const __m512i tmp = _mm512_mask_permutexvar_epi8( packed, static_cast<__mmask64>( -1 ), index, packed );
+
+            const __m512i upper = _mm512_and_si512( tmp, _mm512_set1_epi16( static_cast<short>( 0xFF00 ) ) );
+            const __m512i lower = _mm512_and_si512( _mm512_sllv_epi16( tmp, lower_shift ), lower_mask );
+
+            _mm512_storeu_si512( dst_line + x, _mm512_or_si512( upper, lower ) );
+        }
+        for( ; x < width; ++x )
+        {
+            dst_line[x] = calc_fcc16<pack_type>( src_line, x );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_fcc1x_packed_to_fcc8_avx512vbmi_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            transform_fcc1x_packed_to_fcc8_avx512vbmi_line<pack_type>( img::get_line_start<uint8_t>( dst, y ), img::get_line_start<const uint8_t>( src, y ), src.dim.cx );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_fcc1x_packed_to_fcc16_avx512vbmi_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            transform_fcc1x_packed_to_fcc16_avx512vbmi_line<pack_type>( img::get_line_start<uint16_t>( dst, y ), img::get_line_start<const uint8_t>( src, y ), src.dim.cx );
+        }
+    }
+}
+
+// CPU_AVX512_F, CPU_AVX512_BW and CPU_AVX512_VBMI must be checked by the caller
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx512vbmi( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12_packed:         return ::transform_fcc1x_packed_to_fcc8_avx512vbmi_v0<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc12_mipi:           return ::transform_fcc1x_packed_to_fcc8_avx512vbmi_v0<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc10_mipi:           return ::transform_fcc1x_packed_to_fcc8_avx512vbmi_v0<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::fcc12:
+    case fccXX_pack_type::fcc12_spacked:
+    case fccXX_pack_type::fcc10:
+    case fccXX_pack_type::fcc10_spacked:
+    case fccXX_pack_type::invalid:              return nullptr;
+    };
+    return nullptr;
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_avx512vbmi( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc16( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12_packed:         return ::transform_fcc1x_packed_to_fcc16_avx512vbmi_v0<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc12_mipi:           return ::transform_fcc1x_packed_to_fcc16_avx512vbmi_v0<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc10_mipi:           return ::transform_fcc1x_packed_to_fcc16_avx512vbmi_v0<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::fcc12:
+    case fccXX_pack_type::fcc12_spacked:
+    case fccXX_pack_type::fcc10:
+    case fccXX_pack_type::fcc10_spacked:
+    case fccXX_pack_type::invalid:              return nullptr;
+    };
+    return nullptr;
+}
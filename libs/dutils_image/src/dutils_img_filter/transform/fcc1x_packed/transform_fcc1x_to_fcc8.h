@@ -10,9 +10,13 @@ namespace img_filter::transform::fcc1x_packed
     transform_function_param_type     get_transform_fcc1x_to_fcc8_ref( const img::img_type& dst, const img::img_type& src );
     transform_function_param_type     get_transform_fcc1x_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
     transform_function_param_type     get_transform_fcc1x_to_fcc8_ssse3( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type     get_transform_fcc1x_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src );
     transform_function_param_type     get_transform_fcc1x_to_fcc8_neon_v0( const img::img_type& dst, const img::img_type& src );
     transform_function_param_type     get_transform_fcc1x_to_fcc8_neon_v1( const img::img_type& dst, const img::img_type& src );
 
     transform_function_param_type     get_transform_fcc1x_to_fcc8_neon_sep( const img::img_type& dst, const img::img_type& src );
 
+    // only the 10/12-bit unpacked, 12-bit packed, 12-bit mipi and 10-bit mipi formats, check for CPU_ARM_SVE2
+    transform_function_param_type     get_transform_fcc1x_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src );
+
 }
@@ -0,0 +1,115 @@
+#include "transform_fcc1x_to_fcc8.h"
+
+#include "fcc1x_packed_to_fcc.h"
+#include "fcc1x_packed_avx2_internal.h"
+
+#include <algorithm>
+
+/*
+ * AVX2 variant of transform_fcc1x_to_fcc8_ssse3.cpp, bit exact to transform_fcc1x_to_fcc8_c.cpp.
+ * The unpack steps are in fcc1x_packed_avx2_internal.h.
+ */
+
+using namespace fcc1x_packed_avx2_internal;
+
+namespace
+{
+    using namespace img::fcc1x_packed;
+
+    constexpr int pixels_per_step = 32;
+
+    // the last load of a step starts at x + 16
+    template<fccXX_pack_type pack_type>
+    constexpr int simd_pixels_needed() noexcept
+    {
+        return 16 + load_step_pixels_needed<pack_type>();
+    }
+
+    FORCEINLINE uint8_t     apply_wb_c( uint16_t val, int fac ) noexcept
+    {
+        const auto res = (val * fac) >> (6 + 8);
+        return (res > 0xFF) ? 0xFF : static_cast<uint8_t>(res);
+    }
+
+    FORCEINLINE __m256i     apply_wb( __m256i val, __m256i mul ) noexcept
+    {
+        return _mm256_min_epu16( _mm256_mulhi_epu16( val, mul ), _mm256_set1_epi16( 0xFF ) );
+    }
+
+    template<fccXX_pack_type pack_type>
+    void transform_wb_fcc1x_to_fcc8_avx2_line( uint8_t* dst_line, const uint8_t* src_line, int width, int fac_even, int fac_odd ) noexcept
+    {
+        const int mul_even = std::clamp( fac_even * 4, 0, 0xFFFF );
+        const int mul_odd = std::clamp( fac_odd * 4, 0, 0xFFFF );
+        const __m256i mul = _mm256_set1_epi32( (mul_odd << 16) | mul_even );
+
+        int x = 0;
+        for( ; x + simd_pixels_needed<pack_type>() <= width; x += pixels_per_step )
+        {
+            const __m256i v0 = apply_wb( load_fcc16_step<pack_type>( src_line, x + 0 ), mul );
+            const __m256i v1 = apply_wb( load_fcc16_step<pack_type>( src_line, x + 16 ), mul );
+
+            // packus works per lane, restore pixel order afterwards
+            const __m256i packed = _mm256_permute4x64_epi64( _mm256_packus_epi16( v0, v1 ), 0b11'01'10'00 );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst_line + x ), packed );
+        }
+        for( ; x < width; ++x )
+        {
+            dst_line[x] = apply_wb_c( calc_fcc16<pack_type>( src_line, x ), (x % 2) ? fac_odd : fac_even );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void transform_wb_fcc1x_to_fcc8_avx2( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        assert( dst.dim == src.dim );
+
+        img_filter::bayer_pattern_parameters wb_params{ src.fourcc_type(), params };
+
+        const int wb_x0y0 = static_cast<int>(wb_params.wb_x0y0 * 64);
+        const int wb_x1y0 = static_cast<int>(wb_params.wb_x1y0 * 64);
+        const int wb_x0y1 = static_cast<int>(wb_params.wb_x0y1 * 64);
+        const int wb_x1y1 = static_cast<int>(wb_params.wb_x1y1 * 64);
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<const uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            if( y % 2 == 0 ) {
+                transform_wb_fcc1x_to_fcc8_avx2_line<pack_type>( dst_line, src_line, src.dim.cx, wb_x0y0, wb_x1y0 );
+            } else {
+                transform_wb_fcc1x_to_fcc8_avx2_line<pack_type>( dst_line, src_line, src.dim.cx, wb_x0y1, wb_x1y1 );
+            }
+        }
+    }
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc12>;
+    case fccXX_pack_type::fcc12_mipi:       return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc12_packed:     return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc12_spacked:    return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc12_spacked>;
+
+    case fccXX_pack_type::fcc10:            return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc10>;
+    case fccXX_pack_type::fcc10_spacked:    return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc10_spacked>;
+    case fccXX_pack_type::fcc10_mipi:       return ::transform_wb_fcc1x_to_fcc8_avx2<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
@@ -0,0 +1,232 @@
+#include "transform_fcc1x_to_fcc8.h"
+
+#include "../../simd_helper/use_simd_ssse3.h"
+
+#include "fcc1x_packed_to_fcc16_internal.h"
+#include "fcc1x_packed_to_fcc.h"
+
+#include <algorithm>
+
+/*
+ * Fused unpack + white balance, bit exact to transform_fcc1x_to_fcc8_c.cpp.
+ *
+ * The source is expanded to fcc16 (the value in the upper bits of an u16) and multiplied with the white balance
+ * factor * 64 * 4, so mulhi returns (val * factor * 64) >> 14 like the c version.
+ * Results are clamped to 0xFF before packus, which would treat values >= 0x8000 as negative.
+ */
+
+using namespace fcc1x_packed_internal;
+
+using namespace simd::sse;
+
+namespace
+{
+    using namespace img::fcc1x_packed;
+
+    constexpr int pixels_per_step = 16;
+
+    // byte offset of pixel x in the src line, x is a multiple of the pixel group size of the pack type
+    template<fccXX_pack_type pack_type>
+    constexpr int src_offset( int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12 || pack_type == fccXX_pack_type::fcc10 ) {
+            return x * 2;
+        } else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked || pack_type == fccXX_pack_type::fcc10_mipi ) {
+            return (x / 4) * 5;
+        } else {
+            return (x / 2) * 3;
+        }
+    }
+
+    // the packed loads read 16 bytes, but use less, so stop early enough to stay within the line
+    template<fccXX_pack_type pack_type>
+    constexpr int simd_pixels_needed() noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12 || pack_type == fccXX_pack_type::fcc10 ) {
+            return pixels_per_step;
+        }
+        return pixels_per_step + 8;
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE uint16_t    calc_fcc16( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc12 )                 return calc_fcc12_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )       return calc_fcc12_mipi_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_packed )     return calc_fcc12_packed_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_spacked )    return calc_fcc12_spacked_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10 )            return calc_fcc10_to_fcc16( src_line, x );
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked )    return calc_fcc10_spacked_to_fcc16( src_line, x );
+        else                                                                return calc_fcc10_packed_mipi_to_fcc16( src_line, x );
+    }
+
+    // 12 bit values, 2 pixel in 3 bytes, upper 8 bits of both pixels in separate bytes, the low nibbles in a shared byte
+    FORCEINLINE __m128i     unpack_fcc12_nibble_pairs( __m128i v0, __m128i scatter_upper, __m128i scatter_nibbles ) noexcept
+    {
+        const __m128i upper = _mm_shuffle_epi8( v0, scatter_upper );                   // u16 = (P << 8)
+        const __m128i nibbles = _mm_shuffle_epi8( v0, scatter_nibbles );               // u16 = shared byte, for both pixels
+
+        const __m128i lo_even = _mm_and_si128( _mm_slli_epi16( nibbles, 4 ), _mm_set1_epi32( 0x0000'00F0 ) );
+        const __m128i lo_odd = _mm_and_si128( nibbles, _mm_set1_epi32( 0x00F0'0000 ) );
+
+        return _mm_or_si128( upper, _mm_or_si128( lo_even, lo_odd ) );
+    }
+
+    // 8 pixel starting at x as fcc16
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE __m128i     load_fcc16_step( const uint8_t* src_line, int x ) noexcept
+    {
+        const __m128i v0 = load_si128u( src_line + src_offset<pack_type>( x ) );
+
+        if constexpr( pack_type == fccXX_pack_type::fcc12 )
+        {
+            return _mm_slli_epi16( v0, 4 );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc10 )
+        {
+            return _mm_slli_epi16( v0, 6 );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_packed )
+        {
+            // p[0] = (src[0] << 8) | ((src[1] & 0x0F) << 4), p[1] = (src[2] << 8) | (src[1] & 0xF0)
+            const __m128i scatter_upper = INIT_M128i_REG( 0x80, 0, 0x80, 2, 0x80, 3, 0x80, 5, 0x80, 6, 0x80, 8, 0x80, 9, 0x80, 11 );
+            const __m128i scatter_nibbles = INIT_M128i_REG( 1, 0x80, 1, 0x80, 4, 0x80, 4, 0x80, 7, 0x80, 7, 0x80, 10, 0x80, 10, 0x80 );
+            return unpack_fcc12_nibble_pairs( v0, scatter_upper, scatter_nibbles );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi )
+        {
+            // p[0] = (src[0] << 8) | ((src[2] & 0x0F) << 4), p[1] = (src[1] << 8) | (src[2] & 0xF0)
+            const __m128i scatter_upper = INIT_M128i_REG( 0x80, 0, 0x80, 1, 0x80, 3, 0x80, 4, 0x80, 6, 0x80, 7, 0x80, 9, 0x80, 10 );
+            const __m128i scatter_nibbles = INIT_M128i_REG( 2, 0x80, 2, 0x80, 5, 0x80, 5, 0x80, 8, 0x80, 8, 0x80, 11, 0x80, 11, 0x80 );
+            return unpack_fcc12_nibble_pairs( v0, scatter_upper, scatter_nibbles );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_spacked )
+        {
+            // p[0] = (src[0] << 4) | ((src[1] & 0x0F) << 12), p[1] = (src[1] & 0xF0) | (src[2] << 8)
+            const __m128i scatter = INIT_M128i_REG( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 );
+            const __m128i tmp = _mm_shuffle_epi8( v0, scatter );
+
+            const __m128i even = _mm_and_si128( _mm_slli_epi16( tmp, 4 ), _mm_set1_epi32( 0x0000'FFFF ) );
+            const __m128i odd = _mm_and_si128( tmp, _mm_set1_epi32( static_cast<int>( 0xFFF0'0000 ) ) );
+            return _mm_or_si128( even, odd );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_spacked )
+        {
+            // 4 pixel in 5 bytes, little endian, pixel k in bits [10k;10k+10[
+            const __m128i scatter = INIT_M128i_REG( 0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9 );
+            const __m128i tmp = _mm_shuffle_epi8( v0, scatter );
+
+            // mullo as per lane shift left by 6 - 2k
+            const __m128i shifted = _mm_mullo_epi16( tmp, _mm_setr_epi16( 64, 16, 4, 1, 64, 16, 4, 1 ) );
+            return _mm_and_si128( shifted, _mm_set1_epi16( static_cast<short>( 0xFFC0 ) ) );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_mipi )
+        {
+            // upper 8 bits of 4 pixel in src[0..3], the low 2 bits of pixel k in bits [2k;2k+2[ of src[4]
+            const __m128i scatter_upper = INIT_M128i_REG( 0x80, 0, 0x80, 1, 0x80, 2, 0x80, 3, 0x80, 5, 0x80, 6, 0x80, 7, 0x80, 8 );
+            const __m128i scatter_lower = INIT_M128i_REG( 4, 0x80, 4, 0x80, 4, 0x80, 4, 0x80, 9, 0x80, 9, 0x80, 9, 0x80, 9, 0x80 );
+
+            const __m128i upper = _mm_shuffle_epi8( v0, scatter_upper );
+            const __m128i lower = _mm_shuffle_epi8( v0, scatter_lower );
+
+            const __m128i shifted = _mm_mullo_epi16( lower, _mm_setr_epi16( 64, 16, 4, 1, 64, 16, 4, 1 ) );
+            return _mm_or_si128( upper, _mm_and_si128( shifted, _mm_set1_epi16( 0x00C0 ) ) );
+        }
+        else
+        {
+            static_assert(pack_type == fccXX_pack_type::fcc12, "pack type not implemented");
+        }
+    }
+
+    FORCEINLINE uint8_t     apply_wb_c( uint16_t val, int fac ) noexcept
+    {
+        const auto res = (val * fac) >> (6 + 8);
+        return (res > 0xFF) ? 0xFF : static_cast<uint8_t>(res);
+    }
+
+    FORCEINLINE __m128i     make_wb_multiplier( int fac_even, int fac_odd ) noexcept
+    {
+        const int mul_even = std::clamp( fac_even * 4, 0, 0xFFFF );
+        const int mul_odd = std::clamp( fac_odd * 4, 0, 0xFFFF );
+        return _mm_set1_epi32( (mul_odd << 16) | mul_even );
+    }
+
+    // min( (val * mul) >> 16, 0xFF ), min_epu16 is sse4.1
+    FORCEINLINE __m128i     apply_wb( __m128i val, __m128i mul ) noexcept
+    {
+        const __m128i res = _mm_mulhi_epu16( val, mul );
+        return _mm_sub_epi16( res, _mm_subs_epu16( res, _mm_set1_epi16( 0xFF ) ) );
+    }
+
+    template<fccXX_pack_type pack_type>
+    void transform_wb_fcc1x_to_fcc8_ssse3_line( uint8_t* dst_line, const uint8_t* src_line, int width, int fac_even, int fac_odd ) noexcept
+    {
+        const __m128i mul = make_wb_multiplier( fac_even, fac_odd );
+
+        int x = 0;
+        for( ; x + simd_pixels_needed<pack_type>() <= width; x += pixels_per_step )
+        {
+            const __m128i v0 = apply_wb( load_fcc16_step<pack_type>( src_line, x + 0 ), mul );
+            const __m128i v1 = apply_wb( load_fcc16_step<pack_type>( src_line, x + 8 ), mul );
+
+            store_u( dst_line + x, _mm_packus_epi16( v0, v1 ) );
+        }
+        for( ; x < width; ++x )
+        {
+            dst_line[x] = apply_wb_c( calc_fcc16<pack_type>( src_line, x ), (x % 2) ? fac_odd : fac_even );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void transform_wb_fcc1x_to_fcc8_ssse3( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        assert( dst.dim == src.dim );
+
+        img_filter::bayer_pattern_parameters wb_params{ src.fourcc_type(), params };
+
+        const int wb_x0y0 = static_cast<int>(wb_params.wb_x0y0 * 64);
+        const int wb_x1y0 = static_cast<int>(wb_params.wb_x1y0 * 64);
+        const int wb_x0y1 = static_cast<int>(wb_params.wb_x0y1 * 64);
+        const int wb_x1y1 = static_cast<int>(wb_params.wb_x1y1 * 64);
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<const uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            if( y % 2 == 0 ) {
+                transform_wb_fcc1x_to_fcc8_ssse3_line<pack_type>( dst_line, src_line, src.dim.cx, wb_x0y0, wb_x1y0 );
+            } else {
+                transform_wb_fcc1x_to_fcc8_ssse3_line<pack_type>( dst_line, src_line, src.dim.cx, wb_x0y1, wb_x1y1 );
+            }
+        }
+    }
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_ssse3( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc12>;
+    case fccXX_pack_type::fcc12_mipi:       return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc12_packed:     return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc12_spacked:    return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc12_spacked>;
+
+    case fccXX_pack_type::fcc10:            return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc10>;
+    case fccXX_pack_type::fcc10_spacked:    return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc10_spacked>;
+    case fccXX_pack_type::fcc10_mipi:       return ::transform_wb_fcc1x_to_fcc8_ssse3<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
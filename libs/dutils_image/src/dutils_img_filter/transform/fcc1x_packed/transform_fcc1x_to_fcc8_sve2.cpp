@@ -0,0 +1,223 @@
+
+#include "transform_fcc1x_to_fcc8.h"
+
+#include "fcc1x_packed_to_fcc.h"
+#include "fcc1x_packed_to_fcc_internal.h"
+
+#include <arm_sve.h>
+
+#include <algorithm>
+#include <cassert>
+
+/*
+ * SVE2 variant of the unpack + white balance for the formats where the 8-bit values are whole bytes or
+ * shifted words of the source. The steps have the vector length of the cpu, the tail of a line is done
+ * with predicates. The other pack types are left to the NEON variants.
+ * The plain unpack uses the same lines with the neutral factor 64, (val * 64) / 64 is exact.
+ */
+
+namespace
+{
+    using namespace img::fcc1x_packed;
+
+    // fac holds one factor per byte lane, (val * fac) / 64 with saturation
+    FORCEINLINE
+    svuint8_t   apply_wb_u8( svuint8_t val, svuint8_t fac ) noexcept
+    {
+        return svqshrnt_n_u16( svqshrnb_n_u16( svmullb_u16( val, fac ), 6 ), svmullt_u16( val, fac ), 6 );
+    }
+
+    // the factors of the even pixels in the bottom, the factors of the odd pixels in the top byte lanes
+    FORCEINLINE
+    svuint8_t   make_wb_factor_pair( uint8_t wb_even_pixel, uint8_t wb_odd_pixel ) noexcept
+    {
+        return svreinterpret_u8_u16( svdup_n_u16( static_cast<uint16_t>( wb_odd_pixel << 8 | wb_even_pixel ) ) );
+    }
+
+    struct wb_line_factors
+    {
+        uint8_t     even_pixel;
+        uint8_t     odd_pixel;
+    };
+
+    // 16-bit pixels, the structure load splits the even and the odd pixels
+    template<int shift>
+    void    transform_wb_fcc10or12_to_fcc8_sve2_line( uint8_t* dst_line, const uint8_t* src_line, int width, wb_line_factors wb ) noexcept
+    {
+        const svuint8_t fac = make_wb_factor_pair( wb.even_pixel, wb.odd_pixel );
+
+        auto* src_pixels = reinterpret_cast<const uint16_t*>( src_line );
+        for( int x = 0; x < width; x += static_cast<int>( svcntb() ) )
+        {
+            const svbool_t pg_dst = svwhilelt_b8( x, width );
+            const svbool_t pg_src = svwhilelt_b16( x / 2, width / 2 );
+
+            const svuint16x2_t src = svld2_u16( pg_src, src_pixels + x );
+
+            const svuint8_t val = svshrnt_n_u16( svshrnb_n_u16( svget2_u16( src, 0 ), shift ), svget2_u16( src, 1 ), shift );
+
+            svst1_u8( pg_dst, dst_line + x, apply_wb_u8( val, fac ) );
+        }
+    }
+
+    // 2 pixels in 3 bytes, the high bytes are at [0] and [2] for fcc12_packed, at [0] and [1] for fcc12_mipi
+    template<bool is_mipi>
+    void    transform_wb_fcc12m_or_12p_to_fcc8_sve2_line( uint8_t* dst_line, const uint8_t* src_line, int width, wb_line_factors wb ) noexcept
+    {
+        constexpr int idx_odd_pix = is_mipi ? 1 : 2;
+
+        const svuint8_t fac_even = svdup_n_u8( wb.even_pixel );
+        const svuint8_t fac_odd = svdup_n_u8( wb.odd_pixel );
+
+        const int pairs = width / 2;
+        for( int i = 0; i < pairs; i += static_cast<int>( svcntb() ) )
+        {
+            const svbool_t pg = svwhilelt_b8( i, pairs );
+
+            const svuint8x3_t src = svld3_u8( pg, src_line + i * 3 );
+
+            const svuint8_t res_even = apply_wb_u8( svget3_u8( src, 0 ), fac_even );
+            const svuint8_t res_odd = apply_wb_u8( svget3_u8( src, idx_odd_pix ), fac_odd );
+
+            svst2_u8( pg, dst_line + i * 2, svcreate2_u8( res_even, res_odd ) );
+        }
+    }
+
+    // 4 pixels in 5 bytes, the first 4 bytes are the high bytes. The table lookup compacts the groups of one step,
+    // which is limited to 51 groups to keep the indices in a byte for the 2048-bit vectors.
+    void    transform_wb_fcc10m_to_fcc8_sve2_line( uint8_t* dst_line, const uint8_t* src_line, int width, wb_line_factors wb ) noexcept
+    {
+        const svuint8_t fac = make_wb_factor_pair( wb.even_pixel, wb.odd_pixel );
+
+        const int groups_per_step = std::min( static_cast<int>( svcntb() ) / 5, 51 );
+        const int pixels_per_step = groups_per_step * 4;
+
+        const svbool_t pt = svptrue_b8();
+        const svuint8_t lane = svindex_u8( 0, 1 );
+        const svuint8_t idx = svadd_u8_x( pt, svmul_n_u8_x( pt, svlsr_n_u8_x( pt, lane, 2 ), 5 ), svand_n_u8_x( pt, lane, 3 ) );   // (lane / 4) * 5 + lane % 4
+
+        for( int x = 0, src_offset = 0; x < width; x += pixels_per_step, src_offset += groups_per_step * 5 )
+        {
+            const int count = std::min( pixels_per_step, width - x );
+
+            const svbool_t pg_dst = svwhilelt_b8( 0, count );
+            const svbool_t pg_src = svwhilelt_b8( 0, ((count + 3) / 4) * 5 );
+
+            const svuint8_t val = svtbl_u8( svld1_u8( pg_src, src_line + src_offset ), idx );
+
+            svst1_u8( pg_dst, dst_line + x, apply_wb_u8( val, fac ) );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    FORCEINLINE
+    void    transform_wb_fcc1x_to_fcc8_sve2_line( uint8_t* dst_line, const uint8_t* src_line, int width, wb_line_factors wb ) noexcept
+    {
+        if constexpr( pack_type == fccXX_pack_type::fcc10 || pack_type == fccXX_pack_type::fcc12 )
+        {
+            transform_wb_fcc10or12_to_fcc8_sve2_line<pack_type == fccXX_pack_type::fcc10 ? 2 : 4>( dst_line, src_line, width, wb );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc12_mipi || pack_type == fccXX_pack_type::fcc12_packed )
+        {
+            transform_wb_fcc12m_or_12p_to_fcc8_sve2_line<pack_type == fccXX_pack_type::fcc12_mipi>( dst_line, src_line, width, wb );
+        }
+        else if constexpr( pack_type == fccXX_pack_type::fcc10_mipi )
+        {
+            transform_wb_fcc10m_to_fcc8_sve2_line( dst_line, src_line, width, wb );
+        }
+        else
+        {
+            static_assert(pack_type == fccXX_pack_type::fcc12_mipi, "pack type not implemented");
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_wb_fcc1x_to_fcc8_sve2( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        assert( dst.dim.cx % 2 == 0 );
+
+        img_filter::bayer_pattern_parameters wb_params{ src.fourcc_type(), params };
+
+        const wb_line_factors wb_even_line = { static_cast<uint8_t>(wb_params.wb_x0y0 * (64)), static_cast<uint8_t>(wb_params.wb_x1y0 * (64)) };
+        const wb_line_factors wb_odd_line = { static_cast<uint8_t>(wb_params.wb_x0y1 * (64)), static_cast<uint8_t>(wb_params.wb_x1y1 * (64)) };
+
+        for( int y = 0; y < src.dim.cy; y += 2 )
+        {
+            transform_wb_fcc1x_to_fcc8_sve2_line<pack_type>( img::get_line_start<uint8_t>( dst, y + 0 ), img::get_line_start<const uint8_t>( src, y + 0 ), dst.dim.cx, wb_even_line );
+            transform_wb_fcc1x_to_fcc8_sve2_line<pack_type>( img::get_line_start<uint8_t>( dst, y + 1 ), img::get_line_start<const uint8_t>( src, y + 1 ), dst.dim.cx, wb_odd_line );
+        }
+    }
+
+    template<fccXX_pack_type pack_type>
+    void    transform_fcc1x_to_fcc8_sve2( img::img_descriptor dst, img::img_descriptor src )
+    {
+        assert( dst.dim.cx % 2 == 0 );
+
+        constexpr wb_line_factors wb_neutral = { 64, 64 };
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            transform_wb_fcc1x_to_fcc8_sve2_line<pack_type>( img::get_line_start<uint8_t>( dst, y ), img::get_line_start<const uint8_t>( src, y ), dst.dim.cx, wb_neutral );
+        }
+    }
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx % 2 != 0 ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return ::transform_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12>;
+    case fccXX_pack_type::fcc12_mipi:       return ::transform_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc12_packed:     return ::transform_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc10:            return ::transform_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc10>;
+    case fccXX_pack_type::fcc10_mipi:       return ::transform_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::fcc12_spacked:
+    case fccXX_pack_type::fcc10_spacked:
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
+
+auto img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+    if( dst.dim.cx % 2 != 0 || dst.dim.cy % 2 != 0 ) {
+        return nullptr;
+    }
+
+    using namespace img::fcc1x_packed;
+
+    if( !is_accepted_dst_fcc8( dst.fourcc_type() ) ) {
+        return nullptr;
+    }
+
+    switch( get_fcc1x_pack_type( src.fourcc_type() ) )
+    {
+    case fccXX_pack_type::fcc12:            return ::transform_wb_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12>;
+    case fccXX_pack_type::fcc12_mipi:       return ::transform_wb_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12_mipi>;
+    case fccXX_pack_type::fcc12_packed:     return ::transform_wb_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc12_packed>;
+    case fccXX_pack_type::fcc10:            return ::transform_wb_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc10>;
+    case fccXX_pack_type::fcc10_mipi:       return ::transform_wb_fcc1x_to_fcc8_sve2<fccXX_pack_type::fcc10_mipi>;
+
+    case fccXX_pack_type::fcc12_spacked:
+    case fccXX_pack_type::fcc10_spacked:
+    case fccXX_pack_type::invalid:          return nullptr;
+    };
+    return nullptr;
+}
@@ -53,6 +53,8 @@ namespace img_filter::transform
     transform_function_type      get_transform_fcc16_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_fcc16_to_fcc8_sse41( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_fcc16_to_fcc8_neon( const img::img_type& dst, const img::img_type& src );
+    transform_function_type      get_transform_fcc16_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src );
 
     transform_function_param_type   get_transform_fcc16_to_fcc8_wb_neon( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type   get_transform_fcc16_to_fcc8_wb_sve2( const img::img_type& dst, const img::img_type& src );
 }
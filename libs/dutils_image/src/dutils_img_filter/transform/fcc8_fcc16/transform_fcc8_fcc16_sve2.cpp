@@ -0,0 +1,99 @@
+
+#include "transform_fcc8_fcc16_internal.h"
+
+#include <arm_sve.h>
+
+#include <cassert>
+
+namespace
+{
+    // the high bytes of the pixels [x;x + svcntb()[, the structure load splits the low and high bytes
+    FORCEINLINE
+    svuint8_t   load_fcc16_high_bytes( svbool_t pg, const uint16_t* src_line, int x ) noexcept
+    {
+        return svget2_u8( svld2_u8( pg, reinterpret_cast<const uint8_t*>( src_line + x ) ), 1 );
+    }
+
+    void    transform_fcc16_to_fcc8_sve2( img::img_descriptor dst, img::img_descriptor src )
+    {
+        const int dim_x = dst.dim.cx;
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<const uint16_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            for( int x = 0; x < dim_x; x += static_cast<int>( svcntb() ) )
+            {
+                const svbool_t pg = svwhilelt_b8( x, dim_x );
+
+                svst1_u8( pg, dst_line + x, load_fcc16_high_bytes( pg, src_line, x ) );
+            }
+        }
+    }
+
+    // mul holds the factor of the even pixels in the bottom and the factor of the odd pixels in the top bytes
+    FORCEINLINE
+    void    transform_fcc16_to_fcc8_wb_sve2_line( uint8_t* dst_line, const uint16_t* src_line, int dim_x, svuint8_t mul ) noexcept
+    {
+        for( int x = 0; x < dim_x; x += static_cast<int>( svcntb() ) )
+        {
+            const svbool_t pg = svwhilelt_b8( x, dim_x );
+
+            const svuint8_t val = load_fcc16_high_bytes( pg, src_line, x );
+
+            const svuint8_t res = svqshrnt_n_u16( svqshrnb_n_u16( svmullb_u16( val, mul ), 6 ), svmullt_u16( val, mul ), 6 );
+
+            svst1_u8( pg, dst_line + x, res );
+        }
+    }
+
+    FORCEINLINE
+    svuint8_t   make_wb_factor_pair( float wb_even_pixel, float wb_odd_pixel ) noexcept
+    {
+        const auto even = static_cast<uint8_t>( wb_even_pixel * 64 );
+        const auto odd = static_cast<uint8_t>( wb_odd_pixel * 64 );
+        return svreinterpret_u8_u16( svdup_n_u16( static_cast<uint16_t>( odd << 8 | even ) ) );
+    }
+
+    void    transform_fcc16_to_fcc8_wb_sve2( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        assert( dst.dim.cy % 2 == 0 );
+
+        img_filter::bayer_pattern_parameters wb_params{ src.fourcc_type(), params };
+
+        const svuint8_t wb_even_line = make_wb_factor_pair( wb_params.wb_x0y0, wb_params.wb_x1y0 );
+        const svuint8_t wb_odd_line = make_wb_factor_pair( wb_params.wb_x0y1, wb_params.wb_x1y1 );
+
+        for( int y = 0; y < src.dim.cy; y += 2 )
+        {
+            transform_fcc16_to_fcc8_wb_sve2_line( img::get_line_start<uint8_t>( dst, y + 0 ), img::get_line_start<const uint16_t>( src, y + 0 ), dst.dim.cx, wb_even_line );
+            transform_fcc16_to_fcc8_wb_sve2_line( img::get_line_start<uint8_t>( dst, y + 1 ), img::get_line_start<const uint16_t>( src, y + 1 ), dst.dim.cx, wb_odd_line );
+        }
+    }
+}
+
+auto img_filter::transform::get_transform_fcc16_to_fcc8_sve2( const img::img_type& dst, const img::img_type& src ) -> transform_function_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+    if( can_convert_fcc16_to_fcc8( dst, src ) ) {
+        return transform_fcc16_to_fcc8_sve2;
+    }
+    return nullptr;
+}
+
+auto img_filter::transform::get_transform_fcc16_to_fcc8_wb_sve2( const img::img_type& dst, const img::img_type& src ) -> transform_function_param_type
+{
+    if( src.dim != dst.dim ) {
+        return nullptr;
+    }
+    if( src.dim.cy % 2 != 0 ) {
+        return nullptr;
+    }
+    if( can_convert_fcc16_to_fcc8( dst, src ) ) {
+        return transform_fcc16_to_fcc8_wb_sve2;
+    }
+    return nullptr;
+}
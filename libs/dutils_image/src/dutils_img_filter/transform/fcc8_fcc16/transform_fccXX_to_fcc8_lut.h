@@ -0,0 +1,58 @@
+
+#pragma once
+
+#include "../transform_base.h"
+#include <dutils_img/image_transform_data_structs.h>
+
+namespace img_filter
+{
+    /**
+     * Tone curve applied while 10/12/16 bit mono and bayer images are reduced to 8 bit.
+     * Order: white balance, global brightness, tone mapping, gamma, contrast
+     */
+    struct fcc8_tone_curve_params
+    {
+        float   gamma = 1.f;                        // [0.1;10], out = in ^ (1 / gamma)
+        float   contrast = 0.f;                     // [-1;+1], slope around middle grey is 1 + contrast
+
+        // only enable, intensity and global_brightness_factor are used
+        // intensity > 0 lifts the shadows and compresses the highlights, < 0 does the opposite
+        img::tonemapping_params     tonemapping;
+    };
+
+    constexpr bool  is_neutral( const fcc8_tone_curve_params& params ) noexcept
+    {
+        return params.gamma == 1.f && params.contrast == 0.f && !params.tonemapping.enable;
+    }
+
+    struct fccXX_to_fcc8_lut_data
+    {
+        img_filter::whitebalance_params calc_wb_params{ true, -1.f };   // force to something invalid
+        fcc8_tone_curve_params          calc_curve_params{ -1.f, 0.f, {} };
+
+        // indexed by the upper 12 bit of a pixel
+        uint8_t lut_rr[4096];
+        uint8_t lut_gr[4096];
+        uint8_t lut_bb[4096];
+        uint8_t lut_gb[4096];
+        uint8_t lut_mono[4096];     // without white balance
+
+        // the avx2 gathers read 4 bytes starting at the last entry of lut_mono
+        uint8_t lut_gather_padding[3] = {};
+    };
+
+namespace transform
+{
+    // only recomputes the tables when the white balance or the curve changed
+    void    update_fccXX_to_fcc8_lut_data( fccXX_to_fcc8_lut_data& data, const fcc8_tone_curve_params& curve_params, const img_filter::whitebalance_params& wb_params );
+
+    /**
+     * MONO/bayer 10/12 (also packed), 16 bit to the 8 bit variant through the tables of params.fccXX_to_fcc8_lut.
+     * When that is nullptr a thread local table for params.whitebalance and a neutral curve is used.
+     * Bayer strips must start on an even line.
+     */
+    transform_function_param_type      get_transform_fccXX_to_fcc8_lut_c( const img::img_type& dst, const img::img_type& src );
+    // only the unpacked 10/12/16 bit formats
+    transform_function_param_type      get_transform_fccXX_to_fcc8_lut_avx2( const img::img_type& dst, const img::img_type& src );
+}
+}
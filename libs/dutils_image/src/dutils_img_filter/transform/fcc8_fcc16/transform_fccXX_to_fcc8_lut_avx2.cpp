@@ -0,0 +1,105 @@
+
+#include "transform_fccXX_to_fcc8_lut_internal.h"
+
+#include <immintrin.h>
+
+#include <cstddef>
+
+/*
+ * 8 pixels of the 16 bit containers are widened to 32-bit table indices and looked up with one gather.
+ * The gathers read 4 bytes from the byte tables of fccXX_to_fcc8_lut_data and keep the lowest.
+ * The offsets of the tables of even and odd pixels are added to the indices, like in transform_pwl_avx2.cpp.
+ */
+
+using transform_fccXX_lut_internal::src_layout;
+
+namespace
+{
+    constexpr int pixels_per_step = 32;
+
+    // pixels [x;x+8) as 32-bit indices of the upper 12 bit
+    template<src_layout layout>
+    FORCEINLINE __m256i     unpack_8px( const uint8_t* src_line, int x ) noexcept
+    {
+        const __m256i v = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + x * 2 ) ) );
+        if constexpr( layout == src_layout::fcc16 ) {
+            return _mm256_srli_epi32( v, 4 );
+        } else if constexpr( layout == src_layout::fcc12 ) {
+            return _mm256_and_si256( v, _mm256_set1_epi32( 0x0FFF ) );
+        } else {
+            return _mm256_and_si256( _mm256_slli_epi32( v, 2 ), _mm256_set1_epi32( 0x0FFF ) );
+        }
+    }
+
+    FORCEINLINE __m256i     gather_8px_fcc8( const uint8_t* tables, __m256i idx, __m256i table_offsets ) noexcept
+    {
+        const __m256i v = _mm256_i32gather_epi32( reinterpret_cast<const int*>( tables ), _mm256_add_epi32( idx, table_offsets ), 1 );
+        return _mm256_and_si256( v, _mm256_set1_epi32( 0xFF ) );
+    }
+
+    FORCEINLINE __m256i     make_table_offsets( const uint8_t* tables, transform_fccXX_lut_internal::line_luts luts ) noexcept
+    {
+        const int even = static_cast<int>( luts.lut_even - tables );
+        const int odd = static_cast<int>( luts.lut_odd - tables );
+        return _mm256_setr_epi32( even, odd, even, odd, even, odd, even, odd );
+    }
+
+    template<src_layout layout>
+    void    transform_fccXX_to_fcc8_lut_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const auto& data = transform_fccXX_lut_internal::get_lut_data( params );
+        const auto* tables = reinterpret_cast<const uint8_t*>( &data );
+
+        const auto luts_even_line = transform_fccXX_lut_internal::get_line_luts( data, dst.fourcc_type(), 0 );
+        const auto luts_odd_line = transform_fccXX_lut_internal::get_line_luts( data, dst.fourcc_type(), 1 );
+
+        const __m256i offsets_even_line = make_table_offsets( tables, luts_even_line );
+        const __m256i offsets_odd_line = make_table_offsets( tables, luts_odd_line );
+
+        // packus interleaves the 128-bit lanes, this restores the pixel order
+        const __m256i lane_order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            const bool even_line = y % 2 == 0;
+            const __m256i table_offsets = even_line ? offsets_even_line : offsets_odd_line;
+
+            int x = 0;
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                const __m256i g0 = gather_8px_fcc8( tables, unpack_8px<layout>( src_line, x + 0 ), table_offsets );
+                const __m256i g1 = gather_8px_fcc8( tables, unpack_8px<layout>( src_line, x + 8 ), table_offsets );
+                const __m256i g2 = gather_8px_fcc8( tables, unpack_8px<layout>( src_line, x + 16 ), table_offsets );
+                const __m256i g3 = gather_8px_fcc8( tables, unpack_8px<layout>( src_line, x + 24 ), table_offsets );
+
+                const __m256i p01 = _mm256_packus_epi32( g0, g1 );
+                const __m256i p23 = _mm256_packus_epi32( g2, g3 );
+                const __m256i res = _mm256_permutevar8x32_epi32( _mm256_packus_epi16( p01, p23 ), lane_order );
+
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst_line + x ), res );
+            }
+            transform_fccXX_lut_internal::transform_fccXX_to_fcc8_lut_line_c<layout>( dst_line, src_line, x, dim_x,
+                even_line ? luts_even_line : luts_odd_line );
+        }
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::get_transform_fccXX_to_fcc8_lut_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_fccXX_lut_internal::can_transform_fccXX_to_fcc8_lut( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_fccXX_lut_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::fcc10:         return transform_fccXX_to_fcc8_lut_avx2_v0<src_layout::fcc10>;
+    case src_layout::fcc12:         return transform_fccXX_to_fcc8_lut_avx2_v0<src_layout::fcc12>;
+    case src_layout::fcc16:         return transform_fccXX_to_fcc8_lut_avx2_v0<src_layout::fcc16>;
+    default:
+        return nullptr;
+    }
+}
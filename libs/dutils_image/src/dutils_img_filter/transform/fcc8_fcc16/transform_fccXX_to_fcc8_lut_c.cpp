@@ -0,0 +1,109 @@
+
+#include "transform_fccXX_to_fcc8_lut_internal.h"
+
+#include <cmath>
+
+using transform_fccXX_lut_internal::src_layout;
+
+namespace
+{
+    // [0;1] -> [0;1], monotonic, fixed end points
+    inline float   apply_tonemapping( float v, const img::tonemapping_params& params ) noexcept
+    {
+        v = std::min( v * (1.f + CLIP( params.global_brightness_factor, 0.f, 1.f )), 1.f );
+
+        // v * (1 + k) / (1 + k * v), k in (-1;255]
+        const float k = std::exp2( CLIP( params.intensity, -8.f, 8.f ) ) - 1.f;
+        return v * (1.f + k) / (1.f + k * v);
+    }
+
+    inline uint8_t map_to_fcc8( int lut_index, float wb, const img_filter::fcc8_tone_curve_params& params ) noexcept
+    {
+        float v = std::min( (lut_index / 4095.f) * wb, 1.f );
+
+        if( params.tonemapping.enable ) {
+            v = apply_tonemapping( v, params.tonemapping );
+        }
+        if( params.gamma != 1.f ) {
+            v = std::pow( v, 1.f / CLIP( params.gamma, 0.1f, 10.f ) );
+        }
+        if( params.contrast != 0.f ) {
+            v = (v - 0.5f) * (1.f + CLIP( params.contrast, -1.f, 1.f )) + 0.5f;
+        }
+        return static_cast<uint8_t>( CLIP( std::lround( v * 255.f ), 0l, 255l ) );
+    }
+
+    bool    operator==( const img::tonemapping_params& lhs, const img::tonemapping_params& rhs ) noexcept
+    {
+        return lhs.enable == rhs.enable && lhs.intensity == rhs.intensity && lhs.global_brightness_factor == rhs.global_brightness_factor;
+    }
+
+    bool    operator==( const img_filter::fcc8_tone_curve_params& lhs, const img_filter::fcc8_tone_curve_params& rhs ) noexcept
+    {
+        return lhs.gamma == rhs.gamma && lhs.contrast == rhs.contrast && lhs.tonemapping == rhs.tonemapping;
+    }
+
+    template<src_layout layout>
+    void    transform_fccXX_to_fcc8_lut_c_impl( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const auto& data = transform_fccXX_lut_internal::get_lut_data( params );
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            transform_fccXX_lut_internal::transform_fccXX_to_fcc8_lut_line_c<layout>( dst_line, src_line, 0, src.dim.cx,
+                transform_fccXX_lut_internal::get_line_luts( data, dst.fourcc_type(), y ) );
+        }
+    }
+}
+
+void    img_filter::transform::update_fccXX_to_fcc8_lut_data( fccXX_to_fcc8_lut_data& data,
+    const fcc8_tone_curve_params& curve_params, const img_filter::whitebalance_params& wb_params )
+{
+    const auto wb_param_data = img_filter::normalize( wb_params );
+
+    if( data.calc_curve_params == curve_params &&
+        data.calc_wb_params.apply == wb_param_data.apply &&
+        data.calc_wb_params.wb_rr == wb_param_data.wb_rr &&
+        data.calc_wb_params.wb_gr == wb_param_data.wb_gr &&
+        data.calc_wb_params.wb_bb == wb_param_data.wb_bb &&
+        data.calc_wb_params.wb_gb == wb_param_data.wb_gb )
+    {
+        return;
+    }
+
+    for( int idx = 0; idx < 4096; ++idx )
+    {
+        data.lut_rr[idx] = map_to_fcc8( idx, wb_param_data.wb_rr, curve_params );
+        data.lut_gr[idx] = map_to_fcc8( idx, wb_param_data.wb_gr, curve_params );
+        data.lut_bb[idx] = map_to_fcc8( idx, wb_param_data.wb_bb, curve_params );
+        data.lut_gb[idx] = map_to_fcc8( idx, wb_param_data.wb_gb, curve_params );
+        data.lut_mono[idx] = map_to_fcc8( idx, 1.f, curve_params );
+    }
+
+    data.calc_wb_params = wb_param_data;
+    data.calc_curve_params = curve_params;
+}
+
+img_filter::transform_function_param_type  img_filter::transform::get_transform_fccXX_to_fcc8_lut_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_fccXX_lut_internal::can_transform_fccXX_to_fcc8_lut( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_fccXX_lut_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::fcc10:         return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc10>;
+    case src_layout::fcc10_mipi:    return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc10_mipi>;
+    case src_layout::fcc10_spacked: return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc10_spacked>;
+    case src_layout::fcc12:         return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc12>;
+    case src_layout::fcc12_mipi:    return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc12_mipi>;
+    case src_layout::fcc12_packed:  return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc12_packed>;
+    case src_layout::fcc12_spacked: return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc12_spacked>;
+    case src_layout::fcc16:         return transform_fccXX_to_fcc8_lut_c_impl<src_layout::fcc16>;
+    case src_layout::invalid:       return nullptr;
+    }
+    return nullptr;
+}
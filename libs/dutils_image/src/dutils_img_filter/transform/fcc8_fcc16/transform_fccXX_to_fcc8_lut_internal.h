@@ -0,0 +1,148 @@
+
+#pragma once
+
+#include "transform_fccXX_to_fcc8_lut.h"
+#include "transform_fcc8_fcc16.h"
+
+#include "../fcc1x_packed/fcc1x_packed_to_fcc.h"
+#include "../fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+namespace transform_fccXX_lut_internal
+{
+    enum class src_layout
+    {
+        fcc10,
+        fcc10_mipi,
+        fcc10_spacked,
+        fcc12,
+        fcc12_mipi,
+        fcc12_packed,
+        fcc12_spacked,
+        fcc16,
+        invalid,
+    };
+
+    constexpr src_layout    get_src_layout( img::fourcc fcc ) noexcept
+    {
+        using img::fcc1x_packed::fccXX_pack_type;
+
+        if( img_filter::transform::convert_fcc16_to_fcc8( fcc ) != img::fourcc::FCC_NULL ) {
+            return src_layout::fcc16;
+        }
+        switch( img::fcc1x_packed::get_fcc1x_pack_type( fcc ) )
+        {
+        case fccXX_pack_type::fcc10:            return src_layout::fcc10;
+        case fccXX_pack_type::fcc10_mipi:       return src_layout::fcc10_mipi;
+        case fccXX_pack_type::fcc10_spacked:    return src_layout::fcc10_spacked;
+        case fccXX_pack_type::fcc12:            return src_layout::fcc12;
+        case fccXX_pack_type::fcc12_mipi:       return src_layout::fcc12_mipi;
+        case fccXX_pack_type::fcc12_packed:     return src_layout::fcc12_packed;
+        case fccXX_pack_type::fcc12_spacked:    return src_layout::fcc12_spacked;
+        case fccXX_pack_type::invalid:          return src_layout::invalid;
+        };
+        return src_layout::invalid;
+    }
+
+    constexpr img::fourcc   get_dst_fcc( img::fourcc src_fcc ) noexcept
+    {
+        if( auto fcc = img_filter::transform::convert_fcc16_to_fcc8( src_fcc ); fcc != img::fourcc::FCC_NULL ) {
+            return fcc;
+        }
+        return img_filter::transform::fcc1x_packed::convert_packed_fcc1x_to_fcc8( src_fcc );
+    }
+
+    constexpr bool  can_transform_fccXX_to_fcc8_lut( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || get_src_layout( src.fourcc_type() ) == src_layout::invalid ) {
+            return false;
+        }
+        return get_dst_fcc( src.fourcc_type() ) == dst.fourcc_type();
+    }
+
+    // upper 12 bit of pixel x
+    template<src_layout layout>
+    FORCEINLINE uint16_t    calc_lut_index( const void* src_line, int x ) noexcept
+    {
+        using namespace fcc1x_packed_internal;
+
+        if constexpr( layout == src_layout::fcc10 ) {
+            return calc_fcc10_to_fcc16( src_line, x ) >> 4;
+        } else if constexpr( layout == src_layout::fcc10_mipi ) {
+            return calc_fcc10_packed_mipi_to_fcc16( src_line, x ) >> 4;
+        } else if constexpr( layout == src_layout::fcc10_spacked ) {
+            return calc_fcc10_spacked_to_fcc16( src_line, x ) >> 4;
+        } else if constexpr( layout == src_layout::fcc12 ) {
+            return calc_fcc12_to_fcc16( src_line, x ) >> 4;
+        } else if constexpr( layout == src_layout::fcc12_mipi ) {
+            return calc_fcc12_mipi_to_fcc12( src_line, x );
+        } else if constexpr( layout == src_layout::fcc12_packed ) {
+            return calc_fcc12_packed_to_fcc16( src_line, x ) >> 4;
+        } else if constexpr( layout == src_layout::fcc12_spacked ) {
+            return calc_fcc12_spacked_to_fcc16( src_line, x ) >> 4;
+        } else {
+            return static_cast<const uint16_t*>( src_line )[x] >> 4;
+        }
+    }
+
+    struct line_luts
+    {
+        const uint8_t* lut_even;
+        const uint8_t* lut_odd;
+    };
+
+    FORCEINLINE const uint8_t*  get_pattern_lut( const img_filter::fccXX_to_fcc8_lut_data& data, img::by_transform::by_pattern pattern ) noexcept
+    {
+        using img::by_transform::by_pattern;
+        switch( pattern )
+        {
+        case by_pattern::BG:    return data.lut_bb;
+        case by_pattern::GB:    return data.lut_gb;
+        case by_pattern::GR:    return data.lut_gr;
+        case by_pattern::RG:    return data.lut_rr;
+        };
+        return data.lut_mono;
+    }
+
+    // dst_fcc is the 8 bit fcc of the strip, y is relative to the start of the strip
+    inline line_luts    get_line_luts( const img_filter::fccXX_to_fcc8_lut_data& data, img::fourcc dst_fcc, int y ) noexcept
+    {
+        if( !img::is_by8_fcc( dst_fcc ) ) {
+            return { data.lut_mono, data.lut_mono };
+        }
+
+        using namespace img::by_transform;
+
+        auto pattern = convert_bayer_fcc_to_pattern( dst_fcc );
+        if( y % 2 != 0 ) {
+            pattern = by_pattern_alg::next_line( pattern );
+        }
+        return { get_pattern_lut( data, pattern ), get_pattern_lut( data, by_pattern_alg::next_pixel( pattern ) ) };
+    }
+
+    inline const img_filter::fccXX_to_fcc8_lut_data&    get_lut_data( const img_filter::filter_params& params )
+    {
+        if( params.fccXX_to_fcc8_lut ) {
+            return *params.fccXX_to_fcc8_lut;
+        }
+
+        thread_local img_filter::fccXX_to_fcc8_lut_data fallback_data;
+        img_filter::transform::update_fccXX_to_fcc8_lut_data( fallback_data, img_filter::fcc8_tone_curve_params{}, params.whitebalance );
+        return fallback_data;
+    }
+
+    template<src_layout layout>
+    FORCEINLINE void    transform_fccXX_to_fcc8_lut_line_c( uint8_t* dst_line, const void* src_line, int x_begin, int dim_x, line_luts luts ) noexcept
+    {
+        int x = x_begin;
+        for( ; x < (dim_x - 1); x += 2 )
+        {
+            dst_line[x + 0] = luts.lut_even[calc_lut_index<layout>( src_line, x + 0 )];
+            dst_line[x + 1] = luts.lut_odd[calc_lut_index<layout>( src_line, x + 1 )];
+        }
+        if( x < dim_x ) {
+            dst_line[x] = luts.lut_even[calc_lut_index<layout>( src_line, x )];
+        }
+    }
+}
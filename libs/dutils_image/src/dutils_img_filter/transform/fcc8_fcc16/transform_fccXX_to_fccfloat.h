@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include "../transform_base.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+namespace img_filter::transform
+{
+    // mono/bayer fcc to the float variant with the same pattern, FCC_NULL for color formats
+    constexpr img::fourcc    convert_fccXX_to_fccfloat( img::fourcc fcc ) noexcept
+    {
+        using img::by_transform::by_pattern;
+
+        if( img::is_mono_fcc( fcc ) ) {
+            return img::fourcc::MONOFloat;
+        }
+        if( !img::is_bayer_fcc( fcc ) ) {
+            return img::fourcc::FCC_NULL;
+        }
+        switch( img::by_transform::convert_bayer_fcc_to_pattern( fcc ) )
+        {
+        case by_pattern::BG:    return img::fourcc::BGGRFloat;
+        case by_pattern::GB:    return img::fourcc::GBRGFloat;
+        case by_pattern::GR:    return img::fourcc::GRBGFloat;
+        case by_pattern::RG:    return img::fourcc::RGGBFloat;
+        };
+        return img::fourcc::FCC_NULL;
+    }
+
+    /**
+     * 10/12/16 bit formats to float in [0;1], the white balance of params is applied and clipped to 1.
+     * The values are scaled as their 16 bit container, so all bit depths share the same white point.
+     * Bayer strips must start on an even line.
+     */
+    transform_function_param_type      get_transform_fccXX_to_fccfloat_wb_c( const img::img_type& dst, const img::img_type& src );
+    // only the unpacked 10/12/16 bit formats
+    transform_function_param_type      get_transform_fccXX_to_fccfloat_wb_avx2( const img::img_type& dst, const img::img_type& src );
+}
@@ -0,0 +1,69 @@
+
+#include "transform_fccXX_to_fccfloat_internal.h"
+
+#include <immintrin.h>
+
+using transform_fccXX_float_internal::src_layout;
+
+namespace
+{
+    constexpr int pixels_per_step = 16;
+
+    // pixels [x;x+8) scaled to 16 bit
+    template<src_layout layout>
+    FORCEINLINE __m256i     unpack_8px( const uint8_t* src_line, int x ) noexcept
+    {
+        const __m256i v = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + x * 2 ) ) );
+        if constexpr( layout == src_layout::fcc16 ) {
+            return v;
+        } else if constexpr( layout == src_layout::fcc12 ) {
+            return _mm256_slli_epi32( _mm256_and_si256( v, _mm256_set1_epi32( 0x0FFF ) ), 4 );
+        } else {
+            return _mm256_slli_epi32( _mm256_and_si256( v, _mm256_set1_epi32( 0x03FF ) ), 6 );
+        }
+    }
+
+    FORCEINLINE __m256  convert_8px( __m256i v, __m256 factors ) noexcept
+    {
+        return _mm256_min_ps( _mm256_mul_ps( _mm256_cvtepi32_ps( v ), factors ), _mm256_set1_ps( 1.f ) );
+    }
+
+    template<src_layout layout>
+    void    transform_fccXX_to_fccfloat_wb_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<float>( dst, y );
+
+            const auto line_factors = transform_fccXX_float_internal::get_line_factors( src.fourcc_type(), params.whitebalance, y );
+            const __m256 factors = _mm256_setr_ps( line_factors.even, line_factors.odd, line_factors.even, line_factors.odd,
+                                                   line_factors.even, line_factors.odd, line_factors.even, line_factors.odd );
+
+            int x = 0;
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                _mm256_storeu_ps( dst_line + x + 0, convert_8px( unpack_8px<layout>( src_line, x + 0 ), factors ) );
+                _mm256_storeu_ps( dst_line + x + 8, convert_8px( unpack_8px<layout>( src_line, x + 8 ), factors ) );
+            }
+            transform_fccXX_float_internal::transform_fccXX_to_fccfloat_line_c<layout>( dst_line, src_line, x, dim_x, line_factors );
+        }
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::get_transform_fccXX_to_fccfloat_wb_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_fccXX_float_internal::can_transform_fccXX_to_fccfloat( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_fccXX_lut_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::fcc10:         return transform_fccXX_to_fccfloat_wb_avx2_v0<src_layout::fcc10>;
+    case src_layout::fcc12:         return transform_fccXX_to_fccfloat_wb_avx2_v0<src_layout::fcc12>;
+    case src_layout::fcc16:         return transform_fccXX_to_fccfloat_wb_avx2_v0<src_layout::fcc16>;
+    default:
+        return nullptr;
+    }
+}
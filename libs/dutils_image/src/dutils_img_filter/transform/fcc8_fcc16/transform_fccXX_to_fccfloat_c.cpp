@@ -0,0 +1,39 @@
+
+#include "transform_fccXX_to_fccfloat_internal.h"
+
+using transform_fccXX_float_internal::src_layout;
+
+namespace
+{
+    template<src_layout layout>
+    void    transform_fccXX_to_fccfloat_wb_c_impl( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            transform_fccXX_float_internal::transform_fccXX_to_fccfloat_line_c<layout>(
+                img::get_line_start<float>( dst, y ), img::get_line_start<uint8_t>( src, y ), 0, src.dim.cx,
+                transform_fccXX_float_internal::get_line_factors( src.fourcc_type(), params.whitebalance, y ) );
+        }
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::get_transform_fccXX_to_fccfloat_wb_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_fccXX_float_internal::can_transform_fccXX_to_fccfloat( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_fccXX_lut_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::fcc10:         return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc10>;
+    case src_layout::fcc10_mipi:    return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc10_mipi>;
+    case src_layout::fcc10_spacked: return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc10_spacked>;
+    case src_layout::fcc12:         return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc12>;
+    case src_layout::fcc12_mipi:    return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc12_mipi>;
+    case src_layout::fcc12_packed:  return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc12_packed>;
+    case src_layout::fcc12_spacked: return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc12_spacked>;
+    case src_layout::fcc16:         return transform_fccXX_to_fccfloat_wb_c_impl<src_layout::fcc16>;
+    case src_layout::invalid:       return nullptr;
+    }
+    return nullptr;
+}
@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include "transform_fccXX_to_fccfloat.h"
+#include "transform_fccXX_to_fcc8_lut_internal.h"
+
+#include <algorithm>
+
+namespace transform_fccXX_float_internal
+{
+    using transform_fccXX_lut_internal::src_layout;
+
+    constexpr float fcc16_to_float_scale = 1.f / 65535.f;
+
+    constexpr bool  can_transform_fccXX_to_fccfloat( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || transform_fccXX_lut_internal::get_src_layout( src.fourcc_type() ) == src_layout::invalid ) {
+            return false;
+        }
+        return img_filter::transform::convert_fccXX_to_fccfloat( src.fourcc_type() ) == dst.fourcc_type();
+    }
+
+    // pixel x scaled to 16 bit
+    template<src_layout layout>
+    FORCEINLINE uint16_t    calc_fcc16( const void* src_line, int x ) noexcept
+    {
+        using namespace fcc1x_packed_internal;
+
+        if constexpr( layout == src_layout::fcc10 ) {
+            return calc_fcc10_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc10_mipi ) {
+            return calc_fcc10_packed_mipi_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc10_spacked ) {
+            return calc_fcc10_spacked_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc12 ) {
+            return calc_fcc12_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc12_mipi ) {
+            return calc_fcc12_mipi_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc12_packed ) {
+            return calc_fcc12_packed_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::fcc12_spacked ) {
+            return calc_fcc12_spacked_to_fcc16( src_line, x );
+        } else {
+            return static_cast<const uint16_t*>( src_line )[x];
+        }
+    }
+
+    // scale * white balance of the even and odd pixels of a line
+    struct line_factors
+    {
+        float   even;
+        float   odd;
+    };
+
+    // y is relative to the start of the strip
+    inline line_factors     get_line_factors( img::fourcc src_fcc, const img_filter::whitebalance_params& wb, int y ) noexcept
+    {
+        if( !img::is_bayer_fcc( src_fcc ) ) {
+            return { fcc16_to_float_scale, fcc16_to_float_scale };
+        }
+
+        const img_filter::bayer_pattern_parameters factors{ img::by_transform::convert_bayer_fcc_to_pattern( src_fcc ), img_filter::normalize( wb ) };
+        if( y % 2 == 0 ) {
+            return { factors.wb_x0y0 * fcc16_to_float_scale, factors.wb_x1y0 * fcc16_to_float_scale };
+        }
+        return { factors.wb_x0y1 * fcc16_to_float_scale, factors.wb_x1y1 * fcc16_to_float_scale };
+    }
+
+    template<src_layout layout>
+    FORCEINLINE void    transform_fccXX_to_fccfloat_line_c( float* dst_line, const void* src_line, int x_begin, int dim_x, line_factors factors ) noexcept
+    {
+        int x = x_begin;
+        for( ; x < (dim_x - 1); x += 2 )
+        {
+            dst_line[x + 0] = std::min( calc_fcc16<layout>( src_line, x + 0 ) * factors.even, 1.f );
+            dst_line[x + 1] = std::min( calc_fcc16<layout>( src_line, x + 1 ) * factors.odd, 1.f );
+        }
+        if( x < dim_x ) {
+            dst_line[x] = std::min( calc_fcc16<layout>( src_line, x ) * factors.even, 1.f );
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../transform_base.h"
+
+namespace img_filter {
+namespace transform {
+namespace polarization
+{
+    /*
+     * POLARIZATION_MONO8/12 (packed, spacked)/16_90_45_135_0 -> POLARIZATION_PACKED8/16, POLARIZATION_ADI_MONO8/16.
+     *
+     * Every 2x2 block of the polarizer mosaic, line + 0 [P90][P45], line + 1 [P135][P0], is evaluated once
+     * and its result is written to all 4 dst pixels of the block, so dst has the dimensions of src.
+     * PACKED: [P0, P45, P90, P135]
+     * ADI:    [angle of linear polarization, degree of linear polarization, intensity, 0]
+     *          angle [0°;180°) -> [0;max), degree [0;1] -> [0;max], intensity is the mean of the block
+     * Width and height must be even, strips must start on an even line.
+     */
+    transform_function_type     get_transform_polarization_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_type     get_transform_polarization_sse41( const img::img_type& dst, const img::img_type& src );
+}
+}
+}
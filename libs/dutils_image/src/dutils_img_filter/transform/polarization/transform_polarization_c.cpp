@@ -0,0 +1,47 @@
+
+#include "transform_polarization_internal.h"
+
+namespace
+{
+    using namespace transform_polarization_internal;
+
+    template<src_layout layout, img::fourcc dst_fcc>
+    void    transform_polarization_c( img::img_descriptor dst, img::img_descriptor src )
+    {
+        polarization_image_loop( dst, src,
+            []( uint8_t* dst_line0, uint8_t* dst_line1, const uint8_t* src_line0, const uint8_t* src_line1, int dim_x ) {
+                transform_block_line_c<layout, dst_fcc>( dst_line0, dst_line1, src_line0, src_line1, 0, dim_x );
+            } );
+    }
+
+    template<src_layout layout>
+    img_filter::transform_function_type     select_dst( img::fourcc dst_fcc ) noexcept
+    {
+        switch( dst_fcc )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:     return &transform_polarization_c<layout, img::fourcc::POLARIZATION_PACKED8>;
+        case img::fourcc::POLARIZATION_PACKED16:    return &transform_polarization_c<layout, img::fourcc::POLARIZATION_PACKED16>;
+        case img::fourcc::POLARIZATION_ADI_MONO8:   return &transform_polarization_c<layout, img::fourcc::POLARIZATION_ADI_MONO8>;
+        case img::fourcc::POLARIZATION_ADI_MONO16:  return &transform_polarization_c<layout, img::fourcc::POLARIZATION_ADI_MONO16>;
+        default:
+            return nullptr;
+        }
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::polarization::get_transform_polarization_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_polarization_internal::can_transform_polarization( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_polarization_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::mono8:             return select_dst<src_layout::mono8>( dst.fourcc_type() );
+    case src_layout::mono12_packed:     return select_dst<src_layout::mono12_packed>( dst.fourcc_type() );
+    case src_layout::mono12_spacked:    return select_dst<src_layout::mono12_spacked>( dst.fourcc_type() );
+    case src_layout::mono16:            return select_dst<src_layout::mono16>( dst.fourcc_type() );
+    case src_layout::invalid:           return nullptr;
+    }
+    return nullptr;
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "transform_polarization.h"
+
+#include "../fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+
+namespace transform_polarization_internal
+{
+    enum class src_layout
+    {
+        mono8,
+        mono12_packed,
+        mono12_spacked,
+        mono16,
+        invalid,
+    };
+
+    constexpr src_layout    get_src_layout( img::fourcc fcc ) noexcept
+    {
+        switch( fcc )
+        {
+        case img::fourcc::POLARIZATION_MONO8_90_45_135_0:           return src_layout::mono8;
+        case img::fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0:   return src_layout::mono12_packed;
+        case img::fourcc::POLARIZATION_MONO12_SPACKED_90_45_135_0:  return src_layout::mono12_spacked;
+        case img::fourcc::POLARIZATION_MONO16_90_45_135_0:          return src_layout::mono16;
+        default:
+            return src_layout::invalid;
+        }
+    }
+
+    constexpr bool  is_polarization_dst_fcc( img::fourcc fcc ) noexcept
+    {
+        switch( fcc )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:
+        case img::fourcc::POLARIZATION_PACKED16:
+        case img::fourcc::POLARIZATION_ADI_MONO8:
+        case img::fourcc::POLARIZATION_ADI_MONO16:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    constexpr bool  can_transform_polarization( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( dst.dim != src.dim || src.dim.cx < 2 || src.dim.cy < 2 || (src.dim.cx % 2) != 0 || (src.dim.cy % 2) != 0 ) {
+            return false;
+        }
+        return get_src_layout( src.fourcc_type() ) != src_layout::invalid && is_polarization_dst_fcc( dst.fourcc_type() );
+    }
+
+    // pixel x of a src line, scaled to 16 bit
+    template<src_layout layout>
+    FORCEINLINE uint16_t    read_px16( const void* src_line, int x ) noexcept
+    {
+        using namespace fcc1x_packed_internal;
+
+        if constexpr( layout == src_layout::mono8 ) {
+            return static_cast<uint16_t>( static_cast<const uint8_t*>( src_line )[x] << 8 );
+        } else if constexpr( layout == src_layout::mono12_packed ) {
+            return calc_fcc12_packed_to_fcc16( src_line, x );
+        } else if constexpr( layout == src_layout::mono12_spacked ) {
+            return calc_fcc12_spacked_to_fcc16( src_line, x );
+        } else {
+            return static_cast<const uint16_t*>( src_line )[x];
+        }
+    }
+
+    constexpr float pi = 3.14159274f;
+    constexpr float half_pi = 1.57079637f;
+    constexpr float inv_two_pi = 0.159154937f;
+
+    /*
+     * atan2 with a polynomial for atan on [0;1], the error is below 1e-5 rad.
+     * The SIMD variants do the same operations in the same order.
+     */
+    FORCEINLINE float   atan2_approx( float y, float x ) noexcept
+    {
+        const float ax = std::fabs( x );
+        const float ay = std::fabs( y );
+
+        // x and y are whole numbers, max( mx, 1 ) only changes 0 / 0
+        const float a = std::min( ax, ay ) / std::max( std::max( ax, ay ), 1.f );
+        const float s = a * a;
+
+        // written as (p * s + 1) * a, -ffast-math factors p * s * a + a into that in the c variant only
+        float r = (((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s + 1.f) * a;
+        if( ay > ax ) {
+            r = half_pi - r;
+        }
+        if( x < 0.f ) {
+            r = pi - r;
+        }
+        if( y < 0.f ) {
+            r = -r;
+        }
+        return r;
+    }
+
+    struct adi_values
+    {
+        float   aolp;   // [0;1) for [0°;180°)
+        float   dolp;   // [0;1]
+    };
+
+    // p* are src values scaled to 16 bit
+    FORCEINLINE adi_values  calc_adi( int p0, int p45, int p90, int p135 ) noexcept
+    {
+        const float s0 = static_cast<float>( p0 + p45 + p90 + p135 ) * 0.5f;
+        const float s1 = static_cast<float>( p0 - p90 );
+        const float s2 = static_cast<float>( p45 - p135 );
+
+        // s0 is 0 or >= 0.5, where it is 0 so are s1 and s2
+        const float dolp = std::min( std::sqrt( s1 * s1 + s2 * s2 ) / std::max( s0, 0.5f ), 1.f );
+
+        // the angle of the polarization is half the angle of (s1, s2)
+        const float aolp = atan2_approx( s2, s1 ) * inv_two_pi;
+        return { aolp < 0.f ? aolp + 1.f : aolp, dolp };
+    }
+
+    // mean of the block, 16 bit
+    FORCEINLINE int     calc_intensity16( int p0, int p45, int p90, int p135 ) noexcept
+    {
+        return (p0 + p45 + p90 + p135 + 2) >> 2;
+    }
+
+    FORCEINLINE int     scale_to( float v, int max_val ) noexcept
+    {
+        return std::min( static_cast<int>( std::lrint( v * static_cast<float>( max_val ) ) ), max_val );
+    }
+
+    // writes the result of one block to the dst pixels [x;x+2) of both dst lines
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    write_block_c( uint8_t* dst_line0, uint8_t* dst_line1, int x, int p0, int p45, int p90, int p135 ) noexcept
+    {
+        if constexpr( dst_fcc == img::fourcc::POLARIZATION_PACKED8 || dst_fcc == img::fourcc::POLARIZATION_ADI_MONO8 )
+        {
+            uint8_t px[4];
+            if constexpr( dst_fcc == img::fourcc::POLARIZATION_PACKED8 ) {
+                px[0] = static_cast<uint8_t>( p0 >> 8 );
+                px[1] = static_cast<uint8_t>( p45 >> 8 );
+                px[2] = static_cast<uint8_t>( p90 >> 8 );
+                px[3] = static_cast<uint8_t>( p135 >> 8 );
+            } else {
+                const auto adi = calc_adi( p0, p45, p90, p135 );
+                px[0] = static_cast<uint8_t>( scale_to( adi.aolp, 0xFF ) );
+                px[1] = static_cast<uint8_t>( scale_to( adi.dolp, 0xFF ) );
+                px[2] = static_cast<uint8_t>( calc_intensity16( p0, p45, p90, p135 ) >> 8 );
+                px[3] = 0;
+            }
+            for( auto* dst_line : { dst_line0, dst_line1 } ) {
+                memcpy( dst_line + x * 4 + 0, px, sizeof( px ) );
+                memcpy( dst_line + x * 4 + 4, px, sizeof( px ) );
+            }
+        }
+        else
+        {
+            uint16_t px[4];
+            if constexpr( dst_fcc == img::fourcc::POLARIZATION_PACKED16 ) {
+                px[0] = static_cast<uint16_t>( p0 );
+                px[1] = static_cast<uint16_t>( p45 );
+                px[2] = static_cast<uint16_t>( p90 );
+                px[3] = static_cast<uint16_t>( p135 );
+            } else {
+                const auto adi = calc_adi( p0, p45, p90, p135 );
+                px[0] = static_cast<uint16_t>( scale_to( adi.aolp, 0xFFFF ) );
+                px[1] = static_cast<uint16_t>( scale_to( adi.dolp, 0xFFFF ) );
+                px[2] = static_cast<uint16_t>( calc_intensity16( p0, p45, p90, p135 ) );
+                px[3] = 0;
+            }
+            for( auto* dst_line : { dst_line0, dst_line1 } ) {
+                memcpy( dst_line + x * 8 + 0, px, sizeof( px ) );
+                memcpy( dst_line + x * 8 + 8, px, sizeof( px ) );
+            }
+        }
+    }
+
+    // the blocks of the pixels [x;dim_x), x is even
+    template<src_layout layout, img::fourcc dst_fcc>
+    FORCEINLINE void    transform_block_line_c( uint8_t* dst_line0, uint8_t* dst_line1, const void* src_line0, const void* src_line1, int x, int dim_x ) noexcept
+    {
+        for( ; x < dim_x; x += 2 )
+        {
+            const int p90 = read_px16<layout>( src_line0, x + 0 );
+            const int p45 = read_px16<layout>( src_line0, x + 1 );
+            const int p135 = read_px16<layout>( src_line1, x + 0 );
+            const int p0 = read_px16<layout>( src_line1, x + 1 );
+
+            write_block_c<dst_fcc>( dst_line0, dst_line1, x, p0, p45, p90, p135 );
+        }
+    }
+
+    /*
+     * TBlockLine is called as func( dst_line0, dst_line1, src_line0, src_line1, dim_x ) for every line pair.
+     */
+    template<class TBlockLine>
+    void    polarization_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, TBlockLine block_line )
+    {
+        assert( dst.dim == src.dim && (src.dim.cy % 2) == 0 );
+
+        for( int y = 0; y < src.dim.cy; y += 2 )
+        {
+            block_line( img::get_line_start( dst, y + 0 ), img::get_line_start( dst, y + 1 ),
+                img::get_line_start( src, y + 0 ), img::get_line_start( src, y + 1 ), dst.dim.cx );
+        }
+    }
+}
@@ -0,0 +1,250 @@
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+#include "transform_polarization_internal.h"
+
+/*
+ * 4 blocks (8 pixels of 2 lines) per step. The src lines are widened to 16 bit values,
+ * the 32-bit lanes then hold the even pixel in the low and the odd pixel in the high half.
+ * The results of the blocks are duplicated with unpack to the 2 dst pixels of each block.
+ */
+
+namespace
+{
+    using namespace transform_polarization_internal;
+
+    constexpr int pixels_per_step = 8;
+
+    // src pixels [x;x+8) as 16 bit values
+    template<src_layout layout>
+    FORCEINLINE __m128i     load_8px16( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( layout == src_layout::mono8 ) {
+            const __m128i v = _mm_cvtepu8_epi16( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src_line + x ) ) );
+            return _mm_slli_epi16( v, 8 );
+        } else if constexpr( layout == src_layout::mono16 ) {
+            return _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + x * 2 ) );
+        } else {
+            // 3 bytes per pixel pair, reads 4 bytes past the 12 that are used
+            const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + (x / 2) * 3 ) );
+            if constexpr( layout == src_layout::mono12_packed )
+            {
+                // even: b0 << 8 | (b1 & 0x0F) << 4, odd: b2 << 8 | (b1 & 0xF0)
+                const __m128i shuffle = _mm_setr_epi8( 1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11 );
+                const __m128i w = _mm_shuffle_epi8( v, shuffle );
+                const __m128i even = _mm_or_si128( _mm_and_si128( w, _mm_set1_epi32( 0x0000FF00 ) ), _mm_slli_epi32( _mm_and_si128( w, _mm_set1_epi32( 0x0000000F ) ), 4 ) );
+                const __m128i odd = _mm_and_si128( w, _mm_set1_epi32( static_cast<int>( 0xFFF00000 ) ) );
+                return _mm_or_si128( even, odd );
+            }
+            else
+            {
+                // even: (b1 & 0x0F) << 12 | b0 << 4, odd: b2 << 8 | (b1 & 0xF0)
+                const __m128i shuffle = _mm_setr_epi8( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 );
+                const __m128i w = _mm_shuffle_epi8( v, shuffle );
+                const __m128i even = _mm_and_si128( _mm_slli_epi32( w, 4 ), _mm_set1_epi32( 0x0000FFF0 ) );
+                const __m128i odd = _mm_and_si128( w, _mm_set1_epi32( static_cast<int>( 0xFFF00000 ) ) );
+                return _mm_or_si128( even, odd );
+            }
+        }
+    }
+
+    // bytes of src that load_8px16 touches for the pixels [x;x+8)
+    template<src_layout layout>
+    constexpr int   load_end_in_bytes( int x ) noexcept
+    {
+        if constexpr( layout == src_layout::mono8 ) {
+            return x + 8;
+        } else if constexpr( layout == src_layout::mono16 ) {
+            return (x + 8) * 2;
+        } else {
+            return (x / 2) * 3 + 16;
+        }
+    }
+
+    template<src_layout layout>
+    constexpr int   line_length_in_bytes( int dim_x ) noexcept
+    {
+        if constexpr( layout == src_layout::mono8 ) {
+            return dim_x;
+        } else if constexpr( layout == src_layout::mono16 ) {
+            return dim_x * 2;
+        } else {
+            return (dim_x / 2) * 3;
+        }
+    }
+
+    FORCEINLINE __m128  atan2_approx_sse41( __m128 y, __m128 x ) noexcept
+    {
+        const __m128 abs_mask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+        const __m128 zero = _mm_setzero_ps();
+
+        const __m128 ax = _mm_and_ps( x, abs_mask );
+        const __m128 ay = _mm_and_ps( y, abs_mask );
+
+        const __m128 a = _mm_div_ps( _mm_min_ps( ax, ay ), _mm_max_ps( _mm_max_ps( ax, ay ), _mm_set1_ps( 1.f ) ) );
+        const __m128 s = _mm_mul_ps( a, a );
+
+        __m128 r = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -0.0464964749f ), s ), _mm_set1_ps( 0.15931422f ) );
+        r = _mm_sub_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 0.327622764f ) );
+        r = _mm_mul_ps( _mm_add_ps( _mm_mul_ps( r, s ), _mm_set1_ps( 1.f ) ), a );
+
+        r = _mm_blendv_ps( r, _mm_sub_ps( _mm_set1_ps( half_pi ), r ), _mm_cmpgt_ps( ay, ax ) );
+        r = _mm_blendv_ps( r, _mm_sub_ps( _mm_set1_ps( pi ), r ), _mm_cmplt_ps( x, zero ) );
+        r = _mm_blendv_ps( r, _mm_sub_ps( zero, r ), _mm_cmplt_ps( y, zero ) );
+        return r;
+    }
+
+    struct blocks
+    {
+        __m128i p0, p45, p90, p135;     // 32-bit lanes
+    };
+
+    FORCEINLINE __m128i     scale_to_sse41( __m128 v, int max_val ) noexcept
+    {
+        return _mm_min_epi32( _mm_cvtps_epi32( _mm_mul_ps( v, _mm_set1_ps( static_cast<float>( max_val ) ) ) ), _mm_set1_epi32( max_val ) );
+    }
+
+    // aolp, dolp and intensity scaled to max_val
+    FORCEINLINE void    calc_adi_sse41( const blocks& b, int max_val, __m128i& aolp, __m128i& dolp, __m128i& intensity ) noexcept
+    {
+        const __m128i sum = _mm_add_epi32( _mm_add_epi32( b.p0, b.p45 ), _mm_add_epi32( b.p90, b.p135 ) );
+
+        const __m128 s0 = _mm_mul_ps( _mm_cvtepi32_ps( sum ), _mm_set1_ps( 0.5f ) );
+        const __m128 s1 = _mm_cvtepi32_ps( _mm_sub_epi32( b.p0, b.p90 ) );
+        const __m128 s2 = _mm_cvtepi32_ps( _mm_sub_epi32( b.p45, b.p135 ) );
+
+        const __m128 len = _mm_sqrt_ps( _mm_add_ps( _mm_mul_ps( s1, s1 ), _mm_mul_ps( s2, s2 ) ) );
+        const __m128 d = _mm_min_ps( _mm_div_ps( len, _mm_max_ps( s0, _mm_set1_ps( 0.5f ) ) ), _mm_set1_ps( 1.f ) );
+
+        __m128 a = _mm_mul_ps( atan2_approx_sse41( s2, s1 ), _mm_set1_ps( inv_two_pi ) );
+        a = _mm_add_ps( a, _mm_and_ps( _mm_cmplt_ps( a, _mm_setzero_ps() ), _mm_set1_ps( 1.f ) ) );
+
+        aolp = scale_to_sse41( a, max_val );
+        dolp = scale_to_sse41( d, max_val );
+
+        const __m128i i16 = _mm_srli_epi32( _mm_add_epi32( sum, _mm_set1_epi32( 2 ) ), 2 );
+        intensity = max_val == 0xFF ? _mm_srli_epi32( i16, 8 ) : i16;
+    }
+
+    // 4 dst pixels of 4 bytes per block
+    FORCEINLINE void    store_blocks32( uint8_t* dst_line0, uint8_t* dst_line1, int x, __m128i w ) noexcept
+    {
+        const __m128i lo = _mm_unpacklo_epi32( w, w );
+        const __m128i hi = _mm_unpackhi_epi32( w, w );
+        for( auto* dst : { dst_line0 + x * 4, dst_line1 + x * 4 } )
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 0, lo );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 1, hi );
+        }
+    }
+
+    // 4 dst pixels of 8 bytes per block, lo holds the 1st, hi the 2nd 4 bytes
+    FORCEINLINE void    store_blocks64( uint8_t* dst_line0, uint8_t* dst_line1, int x, __m128i lo, __m128i hi ) noexcept
+    {
+        const __m128i b01 = _mm_unpacklo_epi32( lo, hi );
+        const __m128i b23 = _mm_unpackhi_epi32( lo, hi );
+
+        const __m128i px0 = _mm_unpacklo_epi64( b01, b01 );
+        const __m128i px1 = _mm_unpackhi_epi64( b01, b01 );
+        const __m128i px2 = _mm_unpacklo_epi64( b23, b23 );
+        const __m128i px3 = _mm_unpackhi_epi64( b23, b23 );
+        for( auto* dst : { dst_line0 + x * 8, dst_line1 + x * 8 } )
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 0, px0 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 1, px1 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 2, px2 );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( dst ) + 3, px3 );
+        }
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    write_blocks_sse41( uint8_t* dst_line0, uint8_t* dst_line1, int x, const blocks& b ) noexcept
+    {
+        if constexpr( dst_fcc == img::fourcc::POLARIZATION_PACKED8 )
+        {
+            const __m128i mask = _mm_set1_epi32( 0xFF00 );
+            const __m128i w = _mm_or_si128(
+                _mm_or_si128( _mm_srli_epi32( b.p0, 8 ), _mm_and_si128( b.p45, mask ) ),
+                _mm_or_si128( _mm_slli_epi32( _mm_and_si128( b.p90, mask ), 8 ), _mm_slli_epi32( _mm_and_si128( b.p135, mask ), 16 ) ) );
+            store_blocks32( dst_line0, dst_line1, x, w );
+        }
+        else if constexpr( dst_fcc == img::fourcc::POLARIZATION_PACKED16 )
+        {
+            store_blocks64( dst_line0, dst_line1, x,
+                _mm_or_si128( b.p0, _mm_slli_epi32( b.p45, 16 ) ), _mm_or_si128( b.p90, _mm_slli_epi32( b.p135, 16 ) ) );
+        }
+        else if constexpr( dst_fcc == img::fourcc::POLARIZATION_ADI_MONO8 )
+        {
+            __m128i aolp, dolp, intensity;
+            calc_adi_sse41( b, 0xFF, aolp, dolp, intensity );
+            const __m128i w = _mm_or_si128( _mm_or_si128( aolp, _mm_slli_epi32( dolp, 8 ) ), _mm_slli_epi32( intensity, 16 ) );
+            store_blocks32( dst_line0, dst_line1, x, w );
+        }
+        else
+        {
+            __m128i aolp, dolp, intensity;
+            calc_adi_sse41( b, 0xFFFF, aolp, dolp, intensity );
+            store_blocks64( dst_line0, dst_line1, x, _mm_or_si128( aolp, _mm_slli_epi32( dolp, 16 ) ), intensity );
+        }
+    }
+
+    template<src_layout layout, img::fourcc dst_fcc>
+    void    transform_block_line_sse41( uint8_t* dst_line0, uint8_t* dst_line1, const uint8_t* src_line0, const uint8_t* src_line1, int dim_x ) noexcept
+    {
+        const __m128i low_mask = _mm_set1_epi32( 0xFFFF );
+        const int line_length = line_length_in_bytes<layout>( dim_x );
+
+        int x = 0;
+        for( ; (x + pixels_per_step) <= dim_x && load_end_in_bytes<layout>( x ) <= line_length; x += pixels_per_step )
+        {
+            const __m128i l0 = load_8px16<layout>( src_line0, x );     // [P90][P45]
+            const __m128i l1 = load_8px16<layout>( src_line1, x );     // [P135][P0]
+
+            const blocks b = {
+                _mm_srli_epi32( l1, 16 ),
+                _mm_srli_epi32( l0, 16 ),
+                _mm_and_si128( l0, low_mask ),
+                _mm_and_si128( l1, low_mask ),
+            };
+            write_blocks_sse41<dst_fcc>( dst_line0, dst_line1, x, b );
+        }
+        transform_block_line_c<layout, dst_fcc>( dst_line0, dst_line1, src_line0, src_line1, x, dim_x );
+    }
+
+    template<src_layout layout, img::fourcc dst_fcc>
+    void    transform_polarization_sse41( img::img_descriptor dst, img::img_descriptor src )
+    {
+        polarization_image_loop( dst, src, &transform_block_line_sse41<layout, dst_fcc> );
+    }
+
+    template<src_layout layout>
+    img_filter::transform_function_type     select_dst( img::fourcc dst_fcc ) noexcept
+    {
+        switch( dst_fcc )
+        {
+        case img::fourcc::POLARIZATION_PACKED8:     return &transform_polarization_sse41<layout, img::fourcc::POLARIZATION_PACKED8>;
+        case img::fourcc::POLARIZATION_PACKED16:    return &transform_polarization_sse41<layout, img::fourcc::POLARIZATION_PACKED16>;
+        case img::fourcc::POLARIZATION_ADI_MONO8:   return &transform_polarization_sse41<layout, img::fourcc::POLARIZATION_ADI_MONO8>;
+        case img::fourcc::POLARIZATION_ADI_MONO16:  return &transform_polarization_sse41<layout, img::fourcc::POLARIZATION_ADI_MONO16>;
+        default:
+            return nullptr;
+        }
+    }
+}
+
+img_filter::transform_function_type     img_filter::transform::polarization::get_transform_polarization_sse41( const img::img_type& dst, const img::img_type& src )
+{
+    if( !transform_polarization_internal::can_transform_polarization( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( transform_polarization_internal::get_src_layout( src.fourcc_type() ) )
+    {
+    case src_layout::mono8:             return select_dst<src_layout::mono8>( dst.fourcc_type() );
+    case src_layout::mono12_packed:     return select_dst<src_layout::mono12_packed>( dst.fourcc_type() );
+    case src_layout::mono12_spacked:    return select_dst<src_layout::mono12_spacked>( dst.fourcc_type() );
+    case src_layout::mono16:            return select_dst<src_layout::mono16>( dst.fourcc_type() );
+    case src_layout::invalid:           return nullptr;
+    }
+    return nullptr;
+}
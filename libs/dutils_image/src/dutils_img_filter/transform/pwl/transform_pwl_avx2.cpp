@@ -0,0 +1,175 @@
+
+#include "transform_pwl_to_fcc8_internal.h"
+
+#include <immintrin.h>
+
+#include <cstddef>
+
+/*
+ * The pwl values are unpacked 8 at a time and used as indices of 32-bit gathers.
+ *
+ * For fcc8 the gathers read 4 bytes from the byte tables of pwl12_to_fcc8_wb_map_data and keep the lowest.
+ * The offsets of the tables are added to the indices, so even and odd pixels are looked up in one gather.
+ */
+
+namespace
+{
+    constexpr int pixels_per_step = 32;
+
+    // the mipi loads read 4 bytes past the 48 bytes of a step
+    template<img::fourcc fcc>
+    constexpr int simd_pixels_needed() noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI ) {
+            return pixels_per_step + 3;
+        }
+        return pixels_per_step;
+    }
+
+    // 8 pixels from 12 bytes
+    FORCEINLINE __m128i     unpack_fcc12_mipi_8px( const uint8_t* src ) noexcept
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+
+        const __m128i upper = _mm_shuffle_epi8( v, _mm_setr_epi8( 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1 ) );
+        const __m128i lower = _mm_shuffle_epi8( v, _mm_setr_epi8( 2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1 ) );
+
+        // even pixels use the low nibble, odd pixels the high nibble
+        const __m128i nibbles = _mm_blend_epi16( _mm_and_si128( lower, _mm_set1_epi16( 0x0F ) ), _mm_srli_epi16( lower, 4 ), 0xAA );
+
+        return _mm_or_si128( _mm_slli_epi16( upper, 4 ), nibbles );
+    }
+
+    // pixels [x;x+8) as 32-bit indices
+    template<img::fourcc fcc>
+    FORCEINLINE __m256i     unpack_8px( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI )
+        {
+            return _mm256_cvtepu16_epi32( unpack_fcc12_mipi_8px( src_line + (x / 2) * 3 ) );
+        }
+        else
+        {
+            const __m256i v = _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src_line + x * 2 ) ) );
+            if constexpr( fcc == img::fourcc::PWL_RG16H12 ) {
+                return _mm256_srli_epi32( v, 4 );
+            } else {
+                return _mm256_and_si256( v, _mm256_set1_epi32( 0x0FFF ) );
+            }
+        }
+    }
+
+    FORCEINLINE __m256i     gather_8px_fcc8( const uint8_t* tables, __m256i idx, __m256i table_offsets ) noexcept
+    {
+        const __m256i v = _mm256_i32gather_epi32( reinterpret_cast<const int*>( tables ), _mm256_add_epi32( idx, table_offsets ), 1 );
+        return _mm256_and_si256( v, _mm256_set1_epi32( 0xFF ) );
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fcc8_avx2_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        using map_data = img_filter::pwl12_to_fcc8_wb_map_data;
+
+        const auto& data = transform_pwl_internal::get_pwl12_to_fcc8_wb_map_data( params );
+        const auto* tables = reinterpret_cast<const uint8_t*>( &data );
+
+        const __m256i offsets_even_line = _mm256_setr_epi32( offsetof( map_data, lut_rr ), offsetof( map_data, lut_gr ),
+                                                             offsetof( map_data, lut_rr ), offsetof( map_data, lut_gr ),
+                                                             offsetof( map_data, lut_rr ), offsetof( map_data, lut_gr ),
+                                                             offsetof( map_data, lut_rr ), offsetof( map_data, lut_gr ) );
+        const __m256i offsets_odd_line = _mm256_setr_epi32( offsetof( map_data, lut_gb ), offsetof( map_data, lut_bb ),
+                                                            offsetof( map_data, lut_gb ), offsetof( map_data, lut_bb ),
+                                                            offsetof( map_data, lut_gb ), offsetof( map_data, lut_bb ),
+                                                            offsetof( map_data, lut_gb ), offsetof( map_data, lut_bb ) );
+
+        // packus interleaves the 128-bit lanes, this restores the pixel order
+        const __m256i lane_order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            const __m256i table_offsets = (y % 2 == 0) ? offsets_even_line : offsets_odd_line;
+
+            int x = 0;
+            for( ; (x + simd_pixels_needed<fcc>()) <= dim_x; x += pixels_per_step )
+            {
+                const __m256i g0 = gather_8px_fcc8( tables, unpack_8px<fcc>( src_line, x + 0 ), table_offsets );
+                const __m256i g1 = gather_8px_fcc8( tables, unpack_8px<fcc>( src_line, x + 8 ), table_offsets );
+                const __m256i g2 = gather_8px_fcc8( tables, unpack_8px<fcc>( src_line, x + 16 ), table_offsets );
+                const __m256i g3 = gather_8px_fcc8( tables, unpack_8px<fcc>( src_line, x + 24 ), table_offsets );
+
+                const __m256i p01 = _mm256_packus_epi32( g0, g1 );
+                const __m256i p23 = _mm256_packus_epi32( g2, g3 );
+                const __m256i res = _mm256_permutevar8x32_epi32( _mm256_packus_epi16( p01, p23 ), lane_order );
+
+                _mm256_storeu_si256( reinterpret_cast<__m256i*>( dst_line + x ), res );
+            }
+            transform_pwl_internal::transform_pwl12_to_fcc8_line_c<fcc>( dst_line, src_line, x, dim_x, transform_pwl_internal::get_line_luts( data, y ) );
+        }
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fccfloat_avx2_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        const float* lut = transform_pwl_internal::get_lut_for_transform_pwl_to_float();
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<float>( dst, y );
+
+            int x = 0;
+            for( ; (x + simd_pixels_needed<fcc>()) <= dim_x; x += pixels_per_step )
+            {
+                for( int i = 0; i < pixels_per_step; i += 8 )
+                {
+                    const __m256 v = _mm256_i32gather_ps( lut, unpack_8px<fcc>( src_line, x + i ), 4 );
+                    _mm256_storeu_ps( dst_line + x + i, v );
+                }
+            }
+            transform_pwl_internal::transform_pwl12_to_fccfloat_line_c<fcc>( dst_line, src_line, x, dim_x, lut );
+        }
+    }
+}
+
+img_filter::transform_function_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fccfloat_avx2_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG12:             return transform_pwl12_to_fccfloat_avx2_v0<img::fourcc::PWL_RG12>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fccfloat_avx2_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fcc8_avx2_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG12:             return transform_pwl12_to_fcc8_avx2_v0<img::fourcc::PWL_RG12>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fcc8_avx2_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
@@ -15,6 +15,9 @@ namespace img_filter
         uint8_t lut_gr[4096];
         uint8_t lut_bb[4096];
         uint8_t lut_gb[4096];
+
+        // the avx2 gathers read 4 bytes starting at the last entry of lut_gb
+        uint8_t lut_gather_padding[3] = {};
     };
 
 namespace transform{
@@ -25,9 +28,16 @@ namespace pwl
     transform_function_type      get_transform_pwl_to_fccfloat_ref( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_pwl_to_fccfloat_c( const img::img_type& dst, const img::img_type& src );
     transform_function_type      get_transform_pwl_to_fccfloat_c_v1( const img::img_type& dst, const img::img_type& src );
-    //transform_function_type      get_transform_pwl_to_bayerfloat_neon( img::img_type dst, img::img_type src );
+    transform_function_type      get_transform_pwl_to_fccfloat_sse41( const img::img_type& dst, const img::img_type& src );
+    transform_function_type      get_transform_pwl_to_fccfloat_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_type      get_transform_pwl_to_fccfloat_neon( const img::img_type& dst, const img::img_type& src );
 
+    // params.pwl12_to_fcc8_wb_lut must be filled by update_pwl12_to_fcc8_wb_map_data,
+    // when it is nullptr a thread local table for params.whitebalance and a hdr_gain of 0 is used
     transform_function_param_type      get_transform_pwl12_to_fcc8_c( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc8_sse41( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc8_avx2( const img::img_type& dst, const img::img_type& src );
+    transform_function_param_type      get_transform_pwl12_to_fcc8_neon( const img::img_type& dst, const img::img_type& src );
 
 
 
@@ -0,0 +1,151 @@
+
+#include "../../simd_helper/use_simd_A64.h"
+
+#include "transform_pwl_to_fcc8_internal.h"
+
+/*
+ * neon has no gather, so only the unpacking of the pwl values is vectorized.
+ * The de-interleaving loads split even and odd pixels, so each half uses one table.
+ */
+
+namespace
+{
+    constexpr int pixels_per_step = 16;
+
+    struct pwl_values_16px
+    {
+        uint16x8_t even;
+        uint16x8_t odd;
+    };
+
+    template<img::fourcc fcc>
+    FORCEINLINE pwl_values_16px     unpack_16px( const uint8_t* src_line, int x ) noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI )
+        {
+            const uint8x8x3_t v = vld3_u8( src_line + (x / 2) * 3 );
+
+            const uint16x8_t even = vorrq_u16( vshll_n_u8( v.val[0], 4 ), vmovl_u8( vand_u8( v.val[2], vdup_n_u8( 0x0F ) ) ) );
+            const uint16x8_t odd = vorrq_u16( vshll_n_u8( v.val[1], 4 ), vmovl_u8( vshr_n_u8( v.val[2], 4 ) ) );
+            return { even, odd };
+        }
+        else
+        {
+            const uint16x8x2_t v = vld2q_u16( reinterpret_cast<const uint16_t*>( src_line ) + x );
+            if constexpr( fcc == img::fourcc::PWL_RG16H12 ) {
+                return { vshrq_n_u16( v.val[0], 4 ), vshrq_n_u16( v.val[1], 4 ) };
+            } else {
+                return { vandq_u16( v.val[0], vdupq_n_u16( 0x0FFF ) ), vandq_u16( v.val[1], vdupq_n_u16( 0x0FFF ) ) };
+            }
+        }
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fcc8_neon_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const auto& data = transform_pwl_internal::get_pwl12_to_fcc8_wb_map_data( params );
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            const auto luts = transform_pwl_internal::get_line_luts( data, y );
+
+            int x = 0;
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                const auto v = unpack_16px<fcc>( src_line, x );
+
+                uint16_t idx_even[8];
+                uint16_t idx_odd[8];
+                vst1q_u16( idx_even, v.even );
+                vst1q_u16( idx_odd, v.odd );
+
+                uint8_t res_even[8];
+                uint8_t res_odd[8];
+                for( int i = 0; i < 8; ++i )
+                {
+                    res_even[i] = luts.lut_even[idx_even[i]];
+                    res_odd[i] = luts.lut_odd[idx_odd[i]];
+                }
+                vst2_u8( dst_line + x, uint8x8x2_t{ vld1_u8( res_even ), vld1_u8( res_odd ) } );
+            }
+            transform_pwl_internal::transform_pwl12_to_fcc8_line_c<fcc>( dst_line, src_line, x, dim_x, luts );
+        }
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fccfloat_neon_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        const float* lut = transform_pwl_internal::get_lut_for_transform_pwl_to_float();
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<float>( dst, y );
+
+            int x = 0;
+            for( ; (x + pixels_per_step) <= dim_x; x += pixels_per_step )
+            {
+                const auto v = unpack_16px<fcc>( src_line, x );
+
+                uint16_t idx_even[8];
+                uint16_t idx_odd[8];
+                vst1q_u16( idx_even, v.even );
+                vst1q_u16( idx_odd, v.odd );
+
+                float res_even[8];
+                float res_odd[8];
+                for( int i = 0; i < 8; ++i )
+                {
+                    res_even[i] = lut[idx_even[i]];
+                    res_odd[i] = lut[idx_odd[i]];
+                }
+                vst2q_f32( dst_line + x + 0, float32x4x2_t{ vld1q_f32( res_even + 0 ), vld1q_f32( res_odd + 0 ) } );
+                vst2q_f32( dst_line + x + 8, float32x4x2_t{ vld1q_f32( res_even + 4 ), vld1q_f32( res_odd + 4 ) } );
+            }
+            transform_pwl_internal::transform_pwl12_to_fccfloat_line_c<fcc>( dst_line, src_line, x, dim_x, lut );
+        }
+    }
+}
+
+img_filter::transform_function_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fccfloat_neon_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG12:             return transform_pwl12_to_fccfloat_neon_v0<img::fourcc::PWL_RG12>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fccfloat_neon_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_neon( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fcc8_neon_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG12:             return transform_pwl12_to_fcc8_neon_v0<img::fourcc::PWL_RG12>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fcc8_neon_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,171 @@
+
+#include "../../simd_helper/use_simd_sse41.h"
+
+#include "transform_pwl_to_fcc8_internal.h"
+
+/*
+ * sse4.1 has no gather, so only the unpacking of the pwl values is vectorized.
+ * The table lookups are done per lane, directly from the unpacked registers.
+ * PWL_RG12 has nothing to unpack and is left to the c variant, which is faster for it.
+ */
+
+namespace
+{
+    constexpr int pixels_per_step = 16;
+
+    // the mipi loads read 4 bytes past the 24 bytes of a step
+    template<img::fourcc fcc>
+    constexpr int simd_pixels_needed() noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI ) {
+            return pixels_per_step + 3;
+        }
+        return pixels_per_step;
+    }
+
+    // 8 pixels from 12 bytes
+    FORCEINLINE __m128i     unpack_fcc12_mipi_8px( const uint8_t* src ) noexcept
+    {
+        const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+
+        const __m128i upper = _mm_shuffle_epi8( v, _mm_setr_epi8( 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1 ) );
+        const __m128i lower = _mm_shuffle_epi8( v, _mm_setr_epi8( 2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1 ) );
+
+        // even pixels use the low nibble, odd pixels the high nibble
+        const __m128i nibbles = _mm_blend_epi16( _mm_and_si128( lower, _mm_set1_epi16( 0x0F ) ), _mm_srli_epi16( lower, 4 ), 0xAA );
+
+        return _mm_or_si128( _mm_slli_epi16( upper, 4 ), nibbles );
+    }
+
+    template<img::fourcc fcc>
+    FORCEINLINE void    unpack_16px( const uint8_t* src_line, int x, __m128i& v0, __m128i& v1 ) noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI )
+        {
+            const uint8_t* src = src_line + (x / 2) * 3;
+            v0 = unpack_fcc12_mipi_8px( src );
+            v1 = unpack_fcc12_mipi_8px( src + 12 );
+        }
+        else
+        {
+            const auto* src = reinterpret_cast<const __m128i*>( src_line + x * 2 );
+            v0 = _mm_loadu_si128( src + 0 );
+            v1 = _mm_loadu_si128( src + 1 );
+            if constexpr( fcc == img::fourcc::PWL_RG16H12 ) {
+                v0 = _mm_srli_epi16( v0, 4 );
+                v1 = _mm_srli_epi16( v1, 4 );
+            } else {
+                v0 = _mm_and_si128( v0, _mm_set1_epi16( 0x0FFF ) );
+                v1 = _mm_and_si128( v1, _mm_set1_epi16( 0x0FFF ) );
+            }
+        }
+    }
+
+    FORCEINLINE void    lookup_8px_fcc8( uint8_t* dst, __m128i idx, transform_pwl_internal::pwl_line_luts luts ) noexcept
+    {
+        dst[0] = luts.lut_even[_mm_extract_epi16( idx, 0 )];
+        dst[1] = luts.lut_odd[_mm_extract_epi16( idx, 1 )];
+        dst[2] = luts.lut_even[_mm_extract_epi16( idx, 2 )];
+        dst[3] = luts.lut_odd[_mm_extract_epi16( idx, 3 )];
+        dst[4] = luts.lut_even[_mm_extract_epi16( idx, 4 )];
+        dst[5] = luts.lut_odd[_mm_extract_epi16( idx, 5 )];
+        dst[6] = luts.lut_even[_mm_extract_epi16( idx, 6 )];
+        dst[7] = luts.lut_odd[_mm_extract_epi16( idx, 7 )];
+    }
+
+    FORCEINLINE void    lookup_8px_float( float* dst, __m128i idx, const float* lut ) noexcept
+    {
+        const __m128 lo = _mm_setr_ps( lut[_mm_extract_epi16( idx, 0 )], lut[_mm_extract_epi16( idx, 1 )],
+                                       lut[_mm_extract_epi16( idx, 2 )], lut[_mm_extract_epi16( idx, 3 )] );
+        const __m128 hi = _mm_setr_ps( lut[_mm_extract_epi16( idx, 4 )], lut[_mm_extract_epi16( idx, 5 )],
+                                       lut[_mm_extract_epi16( idx, 6 )], lut[_mm_extract_epi16( idx, 7 )] );
+        _mm_storeu_ps( dst + 0, lo );
+        _mm_storeu_ps( dst + 4, hi );
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fcc8_sse41_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const auto& data = transform_pwl_internal::get_pwl12_to_fcc8_wb_map_data( params );
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            const auto luts = transform_pwl_internal::get_line_luts( data, y );
+
+            int x = 0;
+            for( ; (x + simd_pixels_needed<fcc>()) <= dim_x; x += pixels_per_step )
+            {
+                __m128i v0, v1;
+                unpack_16px<fcc>( src_line, x, v0, v1 );
+
+                lookup_8px_fcc8( dst_line + x + 0, v0, luts );
+                lookup_8px_fcc8( dst_line + x + 8, v1, luts );
+            }
+            transform_pwl_internal::transform_pwl12_to_fcc8_line_c<fcc>( dst_line, src_line, x, dim_x, luts );
+        }
+    }
+
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fccfloat_sse41_v0( img::img_descriptor dst, img::img_descriptor src )
+    {
+        const float* lut = transform_pwl_internal::get_lut_for_transform_pwl_to_float();
+
+        const int dim_x = src.dim.cx;
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<float>( dst, y );
+
+            int x = 0;
+            for( ; (x + simd_pixels_needed<fcc>()) <= dim_x; x += pixels_per_step )
+            {
+                __m128i v0, v1;
+                unpack_16px<fcc>( src_line, x, v0, v1 );
+
+                lookup_8px_float( dst_line + x + 0, v0, lut );
+                lookup_8px_float( dst_line + x + 8, v1, lut );
+            }
+            transform_pwl_internal::transform_pwl12_to_fccfloat_line_c<fcc>( dst_line, src_line, x, dim_x, lut );
+        }
+    }
+}
+
+img_filter::transform_function_type  img_filter::transform::pwl::get_transform_pwl_to_fccfloat_sse41( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc32f( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fccfloat_sse41_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fccfloat_sse41_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_sse41( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return transform_pwl12_to_fcc8_sse41_v0<img::fourcc::PWL_RG12_MIPI>;
+    case img::fourcc::PWL_RG16H12:          return transform_pwl12_to_fcc8_sse41_v0<img::fourcc::PWL_RG16H12>;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,53 @@
+
+#include "transform_pwl_to_fcc8_internal.h"
+
+namespace
+{
+    template<img::fourcc fcc>
+    void    transform_pwl12_to_fcc8_c_impl( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+    {
+        const auto& data = transform_pwl_internal::get_pwl12_to_fcc8_wb_map_data( params );
+
+        for( int y = 0; y < src.dim.cy; ++y )
+        {
+            auto* src_line = img::get_line_start<uint8_t>( src, y );
+            auto* dst_line = img::get_line_start<uint8_t>( dst, y );
+
+            transform_pwl_internal::transform_pwl12_to_fcc8_line_c<fcc>( dst_line, src_line, 0, src.dim.cx, transform_pwl_internal::get_line_luts( data, y ) );
+        }
+    }
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_mipi_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl12_to_fcc8_c_impl<img::fourcc::PWL_RG12_MIPI>( dst, src, params );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl12_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl12_to_fcc8_c_impl<img::fourcc::PWL_RG12>( dst, src, params );
+}
+
+void    img_filter::transform::pwl::detail::transform_pwl16H12_to_fcc8_c_v0( const img::img_descriptor& dst, const img::img_descriptor& src, img_filter::filter_params& params )
+{
+    transform_pwl12_to_fcc8_c_impl<img::fourcc::PWL_RG16H12>( dst, src, params );
+}
+
+img_filter::transform_function_param_type  img_filter::transform::pwl::get_transform_pwl12_to_fcc8_c( const img::img_type& dst, const img::img_type& src )
+{
+    if( dst.dim != src.dim ) {
+        return nullptr;
+    }
+    if( !transform_pwl_internal::can_transform_pwl_to_fcc8( dst, src ) ) {
+        return nullptr;
+    }
+
+    switch( src.fourcc_type() )
+    {
+    case img::fourcc::PWL_RG12_MIPI:        return detail::transform_pwl12_mipi_to_fcc8_c_v0;
+    case img::fourcc::PWL_RG12:             return detail::transform_pwl12_to_fcc8_c_v0;
+    case img::fourcc::PWL_RG16H12:          return detail::transform_pwl16H12_to_fcc8_c_v0;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "transform_pwl_functions.h"
+#include "transform_pwl_to_bayerfloat_internal.h"
+
+#include "../fcc1x_packed/fcc1x_packed_to_fcc16_internal.h"
+
+namespace transform_pwl_internal
+{
+    // PWL_RG12 only uses the lower 12 bit, the mask keeps invalid data within the tables
+    template<img::fourcc fcc>
+    FORCEINLINE uint16_t    calc_pwl12_value( const void* src_line, int x ) noexcept
+    {
+        if constexpr( fcc == img::fourcc::PWL_RG12_MIPI ) {
+            return fcc1x_packed_internal::calc_fcc12_mipi_to_fcc12( src_line, x );
+        } else if constexpr( fcc == img::fourcc::PWL_RG16H12 ) {
+            return fcc1x_packed_internal::calc_fcc16H12_to_fcc12( src_line, x );
+        } else {
+            return static_cast<const uint16_t*>( src_line )[x] & 0x0FFF;
+        }
+    }
+
+    // PWL formats are always RGGB, the strips passed to the transforms start on an even line
+    struct pwl_line_luts
+    {
+        const uint8_t* lut_even;
+        const uint8_t* lut_odd;
+    };
+
+    FORCEINLINE pwl_line_luts   get_line_luts( const img_filter::pwl12_to_fcc8_wb_map_data& data, int y ) noexcept
+    {
+        if( y % 2 == 0 ) {
+            return { data.lut_rr, data.lut_gr };
+        }
+        return { data.lut_gb, data.lut_bb };
+    }
+
+    inline const img_filter::pwl12_to_fcc8_wb_map_data&     get_pwl12_to_fcc8_wb_map_data( const img_filter::filter_params& params )
+    {
+        if( params.pwl12_to_fcc8_wb_lut ) {
+            return *params.pwl12_to_fcc8_wb_lut;
+        }
+
+        thread_local img_filter::pwl12_to_fcc8_wb_map_data fallback_data;
+        img_filter::transform::pwl::update_pwl12_to_fcc8_wb_map_data( fallback_data, img::pwl_transform_params{}, params.whitebalance );
+        return fallback_data;
+    }
+
+    template<img::fourcc fcc>
+    FORCEINLINE void    transform_pwl12_to_fcc8_line_c( uint8_t* dst_line, const void* src_line, int x_begin, int dim_x, pwl_line_luts luts ) noexcept
+    {
+        int x = x_begin;
+        for( ; x < (dim_x - 1); x += 2 )
+        {
+            dst_line[x + 0] = luts.lut_even[calc_pwl12_value<fcc>( src_line, x + 0 )];
+            dst_line[x + 1] = luts.lut_odd[calc_pwl12_value<fcc>( src_line, x + 1 )];
+        }
+        if( x < dim_x ) {
+            dst_line[x] = luts.lut_even[calc_pwl12_value<fcc>( src_line, x )];
+        }
+    }
+
+    template<img::fourcc fcc>
+    FORCEINLINE void    transform_pwl12_to_fccfloat_line_c( float* dst_line, const void* src_line, int x_begin, int dim_x, const float* lut ) noexcept
+    {
+        for( int x = x_begin; x < dim_x; ++x )
+        {
+            dst_line[x] = lut[calc_pwl12_value<fcc>( src_line, x )];
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../transform_base.h"
+#include "../../by_edge/by_edge.h"
+
+namespace img_filter::transform::tensor
+{
+    // per channel in r, g, b order, dst = (src - mean) / std_dev for src in [0;1]
+    struct normalization
+    {
+        float   mean[3] = { 0.f, 0.f, 0.f };
+        float   std_dev[3] = { 1.f, 1.f, 1.f };
+    };
+
+    struct options
+    {
+        normalization   norm;
+
+        // debayers the float bayer lines to BGRFloat when dst and src have the same dim, one of the by_edge::get_transform_byfloat_to_bgrfloat_* kernels
+        by_edge::function_type  byfloat_to_bgrfloat = nullptr;
+    };
+
+    using function_type = void (*)( img::img_descriptor dst, img::img_descriptor src, const options& opt );
+
+    // planar float rgb, the layout tensor consumers expect for one image (CHW)
+    constexpr bool  is_tensor_fcc( img::fourcc fcc ) noexcept
+    {
+        return fcc == img::fourcc::RGBF32PLANAR || fcc == img::fourcc::RGBF16PLANAR;
+    }
+
+    /**
+     * Float bayer to normalized RGBF32PLANAR or RGBF16PLANAR, the planes are in r, g, b order and not clipped.
+     * With the same dim as src, the image is debayered with opt.byfloat_to_bgrfloat.
+     * With 1/2 or 1/4 of the dim of src, each dst pixel is the average of the colors of its 1 or 2x2 bayer quads.
+     * dst must have even dimensions. The src flags flags_no_wrap_beg/flags_no_wrap_end are honored.
+     */
+    function_type   get_transform_byfloat_to_tensor_c( img::img_type dst, img::img_type src );
+    function_type   get_transform_byfloat_to_tensor_avx2( img::img_type dst, img::img_type src );
+}
@@ -0,0 +1,171 @@
+#include "transform_tensor_internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+    using namespace transform_tensor_internal;
+
+    struct rgb_8px
+    {
+        __m256 r, g, b;
+    };
+
+    // 24 interleaved floats to 8 b, g and r values, the blends collect the channel, the permutes restore the order
+    FORCEINLINE rgb_8px     load_deinterleave_8px( const float* bgr ) noexcept
+    {
+        const __m256 v0 = _mm256_loadu_ps( bgr + 0 );   // b0 g0 r0 b1 g1 r1 b2 g2
+        const __m256 v1 = _mm256_loadu_ps( bgr + 8 );   // r2 b3 g3 r3 b4 g4 r4 b5
+        const __m256 v2 = _mm256_loadu_ps( bgr + 16 );  // g5 r5 b6 g6 r6 b7 g7 r7
+
+        const __m256 b = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x92 ), v2, 0x24 );
+        const __m256 g = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x24 ), v2, 0x49 );
+        const __m256 r = _mm256_blend_ps( _mm256_blend_ps( v0, v1, 0x49 ), v2, 0x92 );
+
+        return rgb_8px{
+            _mm256_permutevar8x32_ps( r, _mm256_setr_epi32( 2, 5, 0, 3, 6, 1, 4, 7 ) ),
+            _mm256_permutevar8x32_ps( g, _mm256_setr_epi32( 1, 4, 7, 2, 5, 0, 3, 6 ) ),
+            _mm256_permutevar8x32_ps( b, _mm256_setr_epi32( 0, 3, 6, 1, 4, 7, 2, 5 ) ),
+        };
+    }
+
+    // the lanes of shuffle_ps hold the 64-bit halves in the order 0 2 1 3
+    FORCEINLINE __m256  fix_lane_order( __m256 v ) noexcept
+    {
+        return _mm256_castpd_ps( _mm256_permute4x64_pd( _mm256_castps_pd( v ), 0xD8 ) );
+    }
+
+    // the even and odd pixels of 16 floats
+    FORCEINLINE void    load_even_odd( const float* line, __m256& even, __m256& odd ) noexcept
+    {
+        const __m256 v0 = _mm256_loadu_ps( line + 0 );
+        const __m256 v1 = _mm256_loadu_ps( line + 8 );
+
+        even = fix_lane_order( _mm256_shuffle_ps( v0, v1, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+        odd = fix_lane_order( _mm256_shuffle_ps( v0, v1, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+    }
+
+    // the colors of the 8 quads starting at quad column qx of one quad row, g is the sum of both greens
+    template<bool r_odd>
+    FORCEINLINE rgb_8px     load_quads( const float* line_r, const float* line_b, int qx ) noexcept
+    {
+        __m256 even_r, odd_r, even_b, odd_b;
+        load_even_odd( line_r + qx * 2, even_r, odd_r );
+        load_even_odd( line_b + qx * 2, even_b, odd_b );
+
+        if constexpr( r_odd ) {
+            return rgb_8px{ odd_r, _mm256_add_ps( even_r, odd_b ), even_b };
+        } else {
+            return rgb_8px{ even_r, _mm256_add_ps( odd_r, even_b ), odd_b };
+        }
+    }
+
+    template<int factor, bool r_odd>
+    FORCEINLINE rgb_8px     sum_quad_rows( const bin_lines<factor>& lines, int qx ) noexcept
+    {
+        rgb_8px sum = load_quads<r_odd>( lines.line_r[0], lines.line_b[0], qx );
+        for( int k = 1; k < factor / 2; ++k )
+        {
+            const rgb_8px row = load_quads<r_odd>( lines.line_r[k], lines.line_b[k], qx );
+            sum = rgb_8px{ _mm256_add_ps( sum.r, row.r ), _mm256_add_ps( sum.g, row.g ), _mm256_add_ps( sum.b, row.b ) };
+        }
+        return sum;
+    }
+
+    // adjacent pairs of a and b, the results of a before the ones of b
+    FORCEINLINE __m256  add_pairs( __m256 a, __m256 b ) noexcept
+    {
+        return fix_lane_order( _mm256_hadd_ps( a, b ) );
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    store_8px( void* plane_line, int x, __m256 v, float scale, float offset ) noexcept
+    {
+        const __m256 res = _mm256_add_ps( _mm256_mul_ps( v, _mm256_set1_ps( scale ) ), _mm256_set1_ps( offset ) );
+        if constexpr( dst_fcc == img::fourcc::RGBF16PLANAR ) {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( static_cast<uint16_t*>( plane_line ) + x ), _mm256_cvtps_ph( res, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ) );
+        } else {
+            _mm256_storeu_ps( static_cast<float*>( plane_line ) + x, res );
+        }
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    store_rgb_8px( dst_lines out, int x, const rgb_8px& px, const coeffs& c ) noexcept
+    {
+        store_8px<dst_fcc>( out.r, x, px.r, c.scale[0], c.offset[0] );
+        store_8px<dst_fcc>( out.g, x, px.g, c.scale[1], c.offset[1] );
+        store_8px<dst_fcc>( out.b, x, px.b, c.scale[2], c.offset[2] );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    convert_bgr_line_avx2( dst_lines out, const float* bgr, int dim_x, const coeffs& c ) noexcept
+    {
+        int x = 0;
+        for( ; (x + 8) <= dim_x; x += 8 )
+        {
+            store_rgb_8px<dst_fcc>( out, x, load_deinterleave_8px( bgr + x * 3 ), c );
+        }
+        convert_bgr_line_c<dst_fcc>( out, bgr, x, dim_x, c );
+    }
+
+    template<img::fourcc dst_fcc, int factor, bool r_odd>
+    void    bin_line_avx2( dst_lines out, const bin_lines<factor>& lines, int dim_x, const coeffs& c ) noexcept
+    {
+        int x = 0;
+        for( ; (x + 8) <= dim_x; x += 8 )
+        {
+            if constexpr( factor == 2 )
+            {
+                store_rgb_8px<dst_fcc>( out, x, sum_quad_rows<factor, r_odd>( lines, x ), c );
+            }
+            else
+            {
+                // 2 quad columns per dst pixel
+                const rgb_8px lo = sum_quad_rows<factor, r_odd>( lines, x * 2 + 0 );
+                const rgb_8px hi = sum_quad_rows<factor, r_odd>( lines, x * 2 + 8 );
+                store_rgb_8px<dst_fcc>( out, x, rgb_8px{ add_pairs( lo.r, hi.r ), add_pairs( lo.g, hi.g ), add_pairs( lo.b, hi.b ) }, c );
+            }
+        }
+        bin_line_c<dst_fcc, factor, r_odd>( out, lines, x, dim_x, c );
+    }
+
+    template<img::fourcc dst_fcc>
+    void    byfloat_to_tensor_avx2( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::tensor::options& opt )
+    {
+        byfloat_to_tensor_image_loop( dst, src, opt, &convert_bgr_line_avx2<dst_fcc> );
+    }
+
+    template<img::fourcc dst_fcc, int factor, bool r_odd>
+    void    byfloat_binned_to_tensor_avx2( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::tensor::options& opt )
+    {
+        byfloat_binned_to_tensor_image_loop<factor>( dst, src, opt, &bin_line_avx2<dst_fcc, factor, r_odd> );
+    }
+
+    template<img::fourcc dst_fcc>
+    img_filter::transform::tensor::function_type    get_func( int factor, bool r_odd )
+    {
+        switch( factor )
+        {
+        case 1:     return &byfloat_to_tensor_avx2<dst_fcc>;
+        case 2:     return r_odd ? &byfloat_binned_to_tensor_avx2<dst_fcc, 2, true> : &byfloat_binned_to_tensor_avx2<dst_fcc, 2, false>;
+        case 4:     return r_odd ? &byfloat_binned_to_tensor_avx2<dst_fcc, 4, true> : &byfloat_binned_to_tensor_avx2<dst_fcc, 4, false>;
+        default:
+            return nullptr;
+        }
+    }
+}
+
+// all cpus with AVX2 also have F16C, so this is only compiled with -mf16c and checked for CPU_AVX2
+img_filter::transform::tensor::function_type    img_filter::transform::tensor::get_transform_byfloat_to_tensor_avx2( img::img_type dst, img::img_type src )
+{
+    const int factor = transform_tensor_internal::get_tensor_factor( dst, src );
+    const bool r_odd = transform_tensor_internal::is_red_on_odd_column( src.fourcc_type() );
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::RGBF32PLANAR:     return get_func<img::fourcc::RGBF32PLANAR>( factor, r_odd );
+    case img::fourcc::RGBF16PLANAR:     return get_func<img::fourcc::RGBF16PLANAR>( factor, r_odd );
+    default:
+        return nullptr;
+    }
+}
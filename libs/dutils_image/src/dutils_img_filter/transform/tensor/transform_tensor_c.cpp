@@ -0,0 +1,53 @@
+#include "transform_tensor_internal.h"
+
+namespace
+{
+    using namespace transform_tensor_internal;
+
+    template<img::fourcc dst_fcc>
+    void    byfloat_to_tensor_c( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::tensor::options& opt )
+    {
+        byfloat_to_tensor_image_loop( dst, src, opt,
+            []( dst_lines out, const float* bgr, int dim_x, const coeffs& c )
+            {
+                convert_bgr_line_c<dst_fcc>( out, bgr, 0, dim_x, c );
+            } );
+    }
+
+    template<img::fourcc dst_fcc, int factor, bool r_odd>
+    void    byfloat_binned_to_tensor_c( img::img_descriptor dst, img::img_descriptor src, const img_filter::transform::tensor::options& opt )
+    {
+        byfloat_binned_to_tensor_image_loop<factor>( dst, src, opt,
+            []( dst_lines out, const bin_lines<factor>& lines, int dim_x, const coeffs& c )
+            {
+                bin_line_c<dst_fcc, factor, r_odd>( out, lines, 0, dim_x, c );
+            } );
+    }
+
+    template<img::fourcc dst_fcc>
+    img_filter::transform::tensor::function_type    get_func( int factor, bool r_odd )
+    {
+        switch( factor )
+        {
+        case 1:     return &byfloat_to_tensor_c<dst_fcc>;
+        case 2:     return r_odd ? &byfloat_binned_to_tensor_c<dst_fcc, 2, true> : &byfloat_binned_to_tensor_c<dst_fcc, 2, false>;
+        case 4:     return r_odd ? &byfloat_binned_to_tensor_c<dst_fcc, 4, true> : &byfloat_binned_to_tensor_c<dst_fcc, 4, false>;
+        default:
+            return nullptr;
+        }
+    }
+}
+
+img_filter::transform::tensor::function_type    img_filter::transform::tensor::get_transform_byfloat_to_tensor_c( img::img_type dst, img::img_type src )
+{
+    const int factor = transform_tensor_internal::get_tensor_factor( dst, src );
+    const bool r_odd = transform_tensor_internal::is_red_on_odd_column( src.fourcc_type() );
+
+    switch( dst.fourcc_type() )
+    {
+    case img::fourcc::RGBF32PLANAR:     return get_func<img::fourcc::RGBF32PLANAR>( factor, r_odd );
+    case img::fourcc::RGBF16PLANAR:     return get_func<img::fourcc::RGBF16PLANAR>( factor, r_odd );
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "transform_tensor.h"
+#include "../bayer_binning/transform_bayer_binning.h"
+
+#include <dutils_img/image_bayer_pattern.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/*
+ * float bayer -> RGBF32PLANAR/RGBF16PLANAR in one pass over the image.
+ *
+ * Without binning, the bayer image is debayered in tiles into a small BGRFloat buffer with the
+ * byfloat_to_bgrfloat kernel of the options, like byfloat_yuv_internal.h does.
+ * With binning, the bayer quads of a bin are averaged directly, so no debayering is done.
+ * The simd variants only provide the inner part of a line, the rest is done by the c code in this file.
+ */
+
+namespace transform_tensor_internal
+{
+    // lines per tile, a 4096 pixel wide BGRFloat tile fits into L2
+    constexpr int tile_lines = 8;
+
+    // dst = src * scale + offset, in r, g, b order
+    // for binning, scale includes the 1 / count of the summed values
+    struct coeffs
+    {
+        float   scale[3];
+        float   offset[3];
+    };
+
+    // factor 1 for debayered input, the binning factor otherwise
+    inline coeffs   calc_coeffs( const img_filter::transform::tensor::normalization& norm, int factor ) noexcept
+    {
+        const float quad_count = factor == 1 ? 1.f : static_cast<float>( (factor / 2) * (factor / 2) );
+        const float value_count[3] = { quad_count, factor == 1 ? 1.f : quad_count * 2.f, quad_count };
+
+        coeffs res = {};
+        for( int i = 0; i < 3; ++i )
+        {
+            // the properties do not allow 0, this only keeps the values finite
+            const float std_dev = std::max( norm.std_dev[i], 1e-6f );
+            res.scale[i] = 1.f / (std_dev * value_count[i]);
+            res.offset[i] = -norm.mean[i] / std_dev;
+        }
+        return res;
+    }
+
+    // IEEE half with round to nearest even, same as _mm256_cvtps_ph( v, _MM_FROUND_TO_NEAREST_INT ) for all but the NaN payloads
+    FORCEINLINE uint16_t    float_to_half( float value ) noexcept
+    {
+        constexpr uint32_t f32_infinity = 255u << 23;
+        constexpr uint32_t f16_overflow = (127u + 16u) << 23;        // 65536.f, everything above rounds to infinity
+        constexpr uint32_t f16_min_normal = 113u << 23;              // 2^-14
+        constexpr uint32_t denorm_magic_bits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        uint32_t bits;
+        memcpy( &bits, &value, sizeof( bits ) );
+
+        const uint32_t sign = bits & 0x8000'0000u;
+        bits ^= sign;
+
+        uint32_t res;
+        if( bits >= f16_overflow )
+        {
+            res = bits > f32_infinity ? 0x7E00 : 0x7C00;
+        }
+        else if( bits < f16_min_normal )
+        {
+            // the float adds round the mantissa bits that drop out
+            float denorm_magic;
+            memcpy( &denorm_magic, &denorm_magic_bits, sizeof( denorm_magic ) );
+
+            float abs_value;
+            memcpy( &abs_value, &bits, sizeof( abs_value ) );
+            abs_value += denorm_magic;
+
+            memcpy( &res, &abs_value, sizeof( res ) );
+            res -= denorm_magic_bits;
+        }
+        else
+        {
+            const uint32_t mantissa_odd = (bits >> 13) & 1;
+            bits += ((15u - 127u) << 23) + 0xFFF;
+            bits += mantissa_odd;
+            res = bits >> 13;
+        }
+        return static_cast<uint16_t>( res | (sign >> 16) );
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE auto    to_plane_value( float v ) noexcept
+    {
+        if constexpr( dst_fcc == img::fourcc::RGBF16PLANAR ) {
+            return float_to_half( v );
+        } else {
+            return v;
+        }
+    }
+
+    template<img::fourcc dst_fcc>
+    using plane_type = std::conditional_t<dst_fcc == img::fourcc::RGBF16PLANAR, uint16_t, float>;
+
+    struct dst_lines
+    {
+        void*   r;
+        void*   g;
+        void*   b;
+    };
+
+    inline dst_lines    get_dst_lines( const img::img_descriptor& dst, int y ) noexcept
+    {
+        return { img::get_line_start_of_plane( dst, y, 0 ), img::get_line_start_of_plane( dst, y, 1 ), img::get_line_start_of_plane( dst, y, 2 ) };
+    }
+
+    template<img::fourcc dst_fcc>
+    FORCEINLINE void    store_pixel( dst_lines out, int x, float r, float g, float b, const coeffs& c ) noexcept
+    {
+        static_cast<plane_type<dst_fcc>*>( out.r )[x] = to_plane_value<dst_fcc>( r * c.scale[0] + c.offset[0] );
+        static_cast<plane_type<dst_fcc>*>( out.g )[x] = to_plane_value<dst_fcc>( g * c.scale[1] + c.offset[1] );
+        static_cast<plane_type<dst_fcc>*>( out.b )[x] = to_plane_value<dst_fcc>( b * c.scale[2] + c.offset[2] );
+    }
+
+    // converts the pixels [x;dim_x) of the BGRFloat line bgr
+    template<img::fourcc dst_fcc>
+    void    convert_bgr_line_c( dst_lines out, const float* bgr, int x, int dim_x, const coeffs& c ) noexcept
+    {
+        for( ; x < dim_x; ++x )
+        {
+            store_pixel<dst_fcc>( out, x, bgr[x * 3 + 2], bgr[x * 3 + 1], bgr[x * 3 + 0], c );
+        }
+    }
+
+    /*
+     * The lines of one bin, reordered so that the red pixels are on line_r and the blue pixels on line_b
+     * of each quad row. The line functions get r_odd when the red pixels are on the odd columns.
+     */
+    template<int factor>
+    struct bin_lines
+    {
+        const float*    line_r[factor / 2];
+        const float*    line_b[factor / 2];
+    };
+
+    // the bayer pattern of the first line of src, src strips start on a multiple of 2 * factor lines
+    inline bool     is_red_on_odd_line( img::fourcc src_fcc ) noexcept
+    {
+        using img::by_transform::by_pattern;
+        const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern( src_fcc );
+        return pattern == by_pattern::BG || pattern == by_pattern::GB;
+    }
+    inline bool     is_red_on_odd_column( img::fourcc src_fcc ) noexcept
+    {
+        using img::by_transform::by_pattern;
+        const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern( src_fcc );
+        return pattern == by_pattern::BG || pattern == by_pattern::GR;
+    }
+
+    template<int factor>
+    inline bin_lines<factor>    get_bin_lines( const img::img_descriptor& src, int dst_y, bool red_on_odd_line ) noexcept
+    {
+        bin_lines<factor> res;
+        for( int k = 0; k < factor / 2; ++k )
+        {
+            const int y = dst_y * factor + k * 2;
+            res.line_r[k] = img::get_line_start<const float>( src, red_on_odd_line ? y + 1 : y );
+            res.line_b[k] = img::get_line_start<const float>( src, red_on_odd_line ? y : y + 1 );
+        }
+        return res;
+    }
+
+    // dst pixels [x;dim_x), sums the quads in the same order as the simd variants
+    template<img::fourcc dst_fcc, int factor, bool r_odd>
+    void    bin_line_c( dst_lines out, const bin_lines<factor>& lines, int x, int dim_x, const coeffs& c ) noexcept
+    {
+        constexpr int quads = factor / 2;
+        constexpr int r_col = r_odd ? 1 : 0;
+        constexpr int b_col = r_odd ? 0 : 1;
+
+        for( ; x < dim_x; ++x )
+        {
+            float r = 0.f;
+            float g = 0.f;
+            float b = 0.f;
+            for( int j = 0; j < quads; ++j )
+            {
+                const int src_x = (x * quads + j) * 2;
+
+                float quad_r = 0.f;
+                float quad_g = 0.f;
+                float quad_b = 0.f;
+                for( int k = 0; k < quads; ++k )
+                {
+                    quad_r += lines.line_r[k][src_x + r_col];
+                    quad_g += lines.line_r[k][src_x + b_col] + lines.line_b[k][src_x + r_col];
+                    quad_b += lines.line_b[k][src_x + b_col];
+                }
+                r += quad_r;
+                g += quad_g;
+                b += quad_b;
+            }
+            store_pixel<dst_fcc>( out, x, r, g, b, c );
+        }
+    }
+
+    // 1 for debayering, the binning factor otherwise, 0 when dst and src do not fit
+    inline int      get_tensor_factor( const img::img_type& dst, const img::img_type& src ) noexcept
+    {
+        if( !img::is_byfloat_fcc( src.fourcc_type() ) || !img_filter::transform::tensor::is_tensor_fcc( dst.fourcc_type() ) ) {
+            return 0;
+        }
+        if( dst.dim.cx < 4 || dst.dim.cy < 2 || (dst.dim.cx % 2) != 0 || (dst.dim.cy % 2) != 0 ) {
+            return 0;
+        }
+        if( dst.dim == src.dim ) {
+            return 1;
+        }
+        return img_filter::transform::bayer_binning::get_binning_factor( dst.dim, src.dim );
+    }
+
+    /*
+     * TConvLine is called as func( dst_lines, bgr_line, dim_x, coeffs ) for every line.
+     * The src flags flags_no_wrap_beg/flags_no_wrap_end are honored, so this can run on strips.
+     */
+    template<class TConvLine>
+    void    byfloat_to_tensor_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::tensor::options& opt, TConvLine conv_line )
+    {
+        const coeffs c = calc_coeffs( opt.norm, 1 );
+
+        const int dim_x = src.dim.cx;
+        const int dim_y = src.dim.cy;
+
+        thread_local std::vector<uint8_t> tile_buffer;
+
+        const auto bgr_type = img::make_img_type( img::fourcc::BGRFloat, { dim_x, tile_lines } );
+        if( tile_buffer.size() < static_cast<size_t>( bgr_type.buffer_length ) ) {
+            tile_buffer.resize( bgr_type.buffer_length );
+        }
+
+        // dim_y is even, so all tiles start on the bayer pattern of src
+        for( int y_begin = 0; y_begin < dim_y; y_begin += tile_lines )
+        {
+            const int y_end = std::min( y_begin + tile_lines, dim_y );
+
+            auto src_tile = src;
+            src_tile.data_.planes[0].plane_ptr = img::get_line_start( src, y_begin );
+            src_tile.dim.cy = y_end - y_begin;
+            src_tile.data_length = src.pitch() * src_tile.dim.cy;
+            if( y_begin > 0 ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_beg;
+            }
+            if( y_end < dim_y ) {
+                src_tile.flags |= img::img_descriptor::flags_no_wrap_end;
+            }
+
+            auto bgr_tile = img::make_img_desc_from_linear_memory( img::make_img_type( img::fourcc::BGRFloat, src_tile.dim ), tile_buffer.data() );
+            bgr_tile.flags |= img::img_descriptor::flags_no_flip;
+
+            img_filter::transform::by_edge::options by_opt = { {}, false, false };
+            opt.byfloat_to_bgrfloat( bgr_tile, src_tile, by_opt );
+
+            for( int y = y_begin; y < y_end; ++y )
+            {
+                conv_line( get_dst_lines( dst, y ), img::get_line_start<const float>( bgr_tile, y - y_begin ), dim_x, c );
+            }
+        }
+    }
+
+    /*
+     * TBinLine is called as func( dst_lines, bin_lines, dim_x, coeffs ) for every dst line.
+     */
+    template<int factor, class TBinLine>
+    void    byfloat_binned_to_tensor_image_loop( const img::img_descriptor& dst, const img::img_descriptor& src, const img_filter::transform::tensor::options& opt, TBinLine bin_line )
+    {
+        const coeffs c = calc_coeffs( opt.norm, factor );
+        const bool red_on_odd_line = is_red_on_odd_line( src.fourcc_type() );
+
+        for( int y = 0; y < dst.dim.cy; ++y )
+        {
+            bin_line( get_dst_lines( dst, y ), get_bin_lines<factor>( src, y, red_on_odd_line ), dst.dim.cx, c );
+        }
+    }
+}
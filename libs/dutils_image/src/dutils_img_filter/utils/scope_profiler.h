@@ -1,7 +1,9 @@
 
 #pragma once
 
-#ifdef SCOPE_PROFILER_ENABLED_
+// The scopes are only recorded when a profiler is registered for the calling thread,
+// see register_threadlocal_profiler. Define SCOPE_PROFILER_DISABLED_ to compile them out.
+#ifndef SCOPE_PROFILER_DISABLED_
 
 #include "scope_profiler_profiling.h"
 
@@ -17,4 +19,4 @@
 #else
 #	define PROFILER_START_SCOPED(name)
 #   define PROFILER_START_SCOPED_FUNC(func)
-#endif  // SCOPE_PROFILER_ENABLED_
+#endif  // SCOPE_PROFILER_DISABLED_
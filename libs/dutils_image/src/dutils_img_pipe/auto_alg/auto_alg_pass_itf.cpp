@@ -4,6 +4,7 @@
 #include "auto_alg_pass_itf.h"
 
 #include "auto_alg.h"
+#include "image_sampling_u8.h"
 #include "auto_wb_temperature.h"
 #include "auto_wb_temperature_sensor_data.h"
 
@@ -40,10 +41,48 @@ namespace detail {
         int64_t     max_frame_number_distance_ = 5;
         uint64_t    max_frame_time_distance_ = 100'000;
 
+        uint32_t    settled_run_count_ = 4;
+        int64_t     max_frame_number_distance_settled_ = 30;
+        uint64_t    max_frame_time_distance_settled_ = 500'000;
+
         int64_t     frame_number_ = 0;
         int64_t     last_frame_number_ = 0;
         uint64_t    last_frame_time_ = 0;
 
+        int64_t     exposure_pipeline_delay_frames_ = 2;
+        // frame number of the last predictive exposure/gain jump, -1 when the brightness reflects it
+        int64_t     predictive_step_frame_number_ = -1;
+
+        // count of consecutive runs that did not change any value
+        uint32_t    runs_without_change_ = 0;
+
+        // the parameters that restart the convergence when they change
+        struct control_inputs
+        {
+            bool        exposure_auto = false;
+            bool        gain_auto = false;
+            bool        iris_auto = false;
+            bool        wb_auto = false;
+            bool        wb_one_push = false;
+            bool        highlight_reduction = false;
+            int         reference = 128;
+            img::rect   brightness_roi = {};
+
+            bool operator==( const control_inputs& op2 ) const noexcept
+            {
+                return exposure_auto == op2.exposure_auto && gain_auto == op2.gain_auto && iris_auto == op2.iris_auto
+                    && wb_auto == op2.wb_auto && wb_one_push == op2.wb_one_push && highlight_reduction == op2.highlight_reduction
+                    && reference == op2.reference
+                    && brightness_roi.left == op2.brightness_roi.left && brightness_roi.top == op2.brightness_roi.top
+                    && brightness_roi.right == op2.brightness_roi.right && brightness_roi.bottom == op2.brightness_roi.bottom;
+            }
+        } last_inputs_;
+
+        bool    is_settled() const noexcept
+        {
+            return runs_without_change_ >= settled_run_count_;
+        }
+
 
         struct {
             int		current_reference = 128;
@@ -59,6 +98,7 @@ namespace detail {
         auto_alg::impl::auto_sample_points  points_for_wb_temperature;
 
         auto_alg::impl::image_sampling_data image_sampling_points;
+        auto_alg::impl::brightness_histogram brightness_hist = {};
 
 
 		void    reset( auto_alg::timing_params params )
@@ -71,6 +111,16 @@ namespace detail {
             max_frame_number_distance_ = params.max_frame_count_between_runs;
             max_frame_time_distance_ = params.max_frame_time_between_runs_us;
 
+            settled_run_count_ = params.settled_run_count;
+            max_frame_number_distance_settled_ = params.max_frame_count_between_runs_settled;
+            max_frame_time_distance_settled_ = params.max_frame_time_between_runs_settled_us;
+
+            exposure_pipeline_delay_frames_ = params.exposure_pipeline_delay_frames;
+            predictive_step_frame_number_ = -1;
+
+            runs_without_change_ = 0;
+            last_inputs_ = {};
+
 			auto_ref.calculated_reference = 128;
 			auto_ref.current_reference = 128;
 			wb_temperature.one_push_step_count = 0;
@@ -168,7 +218,27 @@ static auto_alg::impl::gain_exposure_iris_values		auto_alg_for_brightness_adjust
         iris_tmp.auto_enabled = false;
     }
 
-    auto_alg::impl::gain_exposure_iris_values res = auto_alg::impl::calc_auto_gain_exposure_iris( brightness_params.brightness, reference / 255.f, exp.gain, exp.exposure, iris_tmp );
+    auto_alg::impl::gain_exposure_iris_values res;
+    if( state.predictive_step_frame_number_ >= 0 )
+    {
+        const int64_t frames_since_step = exp.frame_number - state.predictive_step_frame_number_;
+        if( frames_since_step >= 0 && frames_since_step < state.exposure_pipeline_delay_frames_ ) {
+            // the image does not show the last jump yet, adjusting now would overshoot
+            return { exp.exposure.val, exp.gain.value, exp.iris.val };
+        }
+        state.predictive_step_frame_number_ = -1;
+    }
+
+    res = { exp.exposure.val, exp.gain.value, exp.iris.val };
+    if( !iris_tmp.auto_enabled
+        && auto_alg::impl::calc_predictive_gain_exposure( brightness_params.brightness, reference / 255.f, std::max( brightness_params.factor_y_vgt240, 0.f ), exp.gain, exp.exposure, res ) )
+    {
+        state.predictive_step_frame_number_ = exp.frame_number;
+    }
+    else
+    {
+        res = auto_alg::impl::calc_auto_gain_exposure_iris( brightness_params.brightness, reference / 255.f, exp.gain, exp.exposure, iris_tmp );
+    }
     if( exp.iris.is_pwm_iris && exp.iris.auto_enabled )
     {
         float corrected_brightness = brightness_params.brightness * 255;
@@ -339,6 +409,9 @@ struct color_img_auto_results
     auto_alg::impl::resulting_brightness    brightness_res = auto_alg::impl::resulting_brightness::invalid();
     auto_alg::wb_results                    wb_res{};
     auto_alg::impl::auto_hdr_gain_result  pwl_res{};
+
+    bool                                    sampled = false;        // state.image_sampling_points are from this run
+    bool                                    has_histogram = false;  // state.brightness_hist is from this run
 };
 
 
@@ -353,6 +426,7 @@ static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_sta
     if( !auto_alg::impl::auto_sample_by_img( img_data, state.image_sampling_points ) ) {
         return rval;
     }
+    rval.sampled = true;
 
     // 2. apply color matrix values to it
     apply_software_clrmtx_to_sampling_data( state.image_sampling_points, params.clr );
@@ -392,6 +466,17 @@ static color_img_auto_results     exec_color_image_auto( auto_alg::auto_pass_sta
 
     // this calculates the brightness information for the later auto-exposure/gain steps
 
+    if( auto_alg::impl::can_calc_brightness_histogram_u8( img_data.fourcc_type() ) && !params.clr.enabled )
+    {
+        // the sample grid is enough for the whitebalance, but small bright objects make the brightness of the grid jump
+        const auto wb_factors = params.wb.is_software_whitebalance ? rval.wb_res.channels : auto_alg::wb_channel_factors{};
+
+        auto_alg::impl::calc_brightness_histogram_u8( img_data, wb_factors, state.brightness_hist );
+        rval.brightness_res = auto_alg::impl::calc_resulting_brightness( state.brightness_hist );
+        rval.has_histogram = true;
+        return rval;
+    }
+
     rval.brightness_res = calc_resulting_brightness_params( state.image_sampling_points );
     return rval;
 }
@@ -444,15 +529,129 @@ static color_img_auto_results     exec_brightness_and_wb_calc( auto_alg::auto_pa
     return {};
 }
 
+static void     calc_sample_means( const auto_alg::impl::image_sampling_data& points, auto_alg::image_statistics& stats ) noexcept
+{
+    float r = 0.f, g = 0.f, b = 0.f;
+    int cnt = 0;
+    if( points.is_float )
+    {
+        cnt = points.points_float.cnt;
+        for( int idx = 0; idx < cnt; ++idx ) {
+            r += points.points_float.samples[idx].r;
+            g += points.points_float.samples[idx].g;
+            b += points.points_float.samples[idx].b;
+        }
+    }
+    else
+    {
+        int accu_r = 0, accu_g = 0, accu_b = 0;
+        cnt = points.points_int.cnt;
+        for( int idx = 0; idx < cnt; ++idx ) {
+            const auto pix = points.points_int.samples[idx].to_pixel();
+            accu_r += pix.r;
+            accu_g += pix.g;
+            accu_b += pix.b;
+        }
+        r = accu_r / 255.f;
+        g = accu_g / 255.f;
+        b = accu_b / 255.f;
+    }
+    if( cnt <= 0 ) {
+        return;
+    }
+
+    const float div = 1.f / cnt;
+    stats.mean_r = r * div;
+    stats.mean_g = g * div;
+    stats.mean_b = b * div;
+    stats.sample_count = static_cast<uint32_t>( cnt );
+}
+
+static auto_alg::image_statistics   calc_image_statistics( auto_alg::auto_pass_state& state,
+                                                            const color_img_auto_results& results,
+                                                            const img::img_descriptor& img_data,
+                                                            const auto_alg::auto_pass_params& params )
+{
+    auto_alg::image_statistics rval;
+
+    auto brightness_res = results.brightness_res;
+    if( results.sampled )
+    {
+        calc_sample_means( state.image_sampling_points, rval );
+        if( brightness_res.brightness < 0.f ) {
+            // whitebalance only runs skip the brightness, the samples are already there
+            brightness_res = calc_resulting_brightness_params( state.image_sampling_points );
+        }
+    }
+    else if( brightness_res.brightness >= 0.f )
+    {
+        // mono
+        rval.mean_r = rval.mean_g = rval.mean_b = brightness_res.brightness;
+    }
+    if( brightness_res.brightness < 0.f ) {
+        return rval;
+    }
+
+    rval.valid = true;
+    rval.brightness = brightness_res.brightness;
+    rval.saturated_fraction = brightness_res.factor_y_vgt240;
+
+    bool has_histogram = results.has_histogram;
+    if( !has_histogram && params.image_statistics_histogram && auto_alg::impl::can_calc_brightness_histogram_u8( img_data.fourcc_type() ) )
+    {
+        const auto wb_factors = params.wb.is_software_whitebalance ? results.wb_res.channels : auto_alg::wb_channel_factors{};
+        auto_alg::impl::calc_brightness_histogram_u8( img_data, wb_factors, state.brightness_hist );
+        has_histogram = true;
+    }
+    if( has_histogram )
+    {
+        std::copy( std::begin( state.brightness_hist.bins ), std::end( state.brightness_hist.bins ), std::begin( rval.histogram ) );
+        rval.histogram_count = state.brightness_hist.cnt;
+    }
+    return rval;
+}
+
+}
+
+static auto_alg::detail::auto_pass_state::control_inputs    fetch_control_inputs( const auto_alg::auto_pass_params& params ) noexcept
+{
+    return {
+        params.exposure.auto_enabled,
+        params.gain.auto_enabled,
+        params.iris.auto_enabled,
+        params.wb.auto_enabled,
+        params.wb.one_push_enabled,
+        params.enable_highlight_reduction,
+        params.exposure_reference.val,
+        params.brightness_roi,
+    };
+}
+
+static void update_settled_state( auto_alg::auto_pass_state& state, const auto_alg::auto_pass_results& res ) noexcept
+{
+    const bool any_change = res.exposure_changed || res.gain_changed || res.iris_changed || res.wb.wb_changed || res.hdr_gain_selection_changed;
+    if( any_change ) {
+        state.runs_without_change_ = 0;
+    } else if( !state.is_settled() ) {
+        state.runs_without_change_++;
+    }
 }
 
 /*
  *	Returns true when the auto algorithms will be run on this frame.
- * Note: This increments the local frame number
+ * Right after a run that changed a value this runs as soon as min_frame_number_distance_ allows,
+ * without changes the max limits apply and once settled the settled limits.
  */
-static bool is_auto_pass_run( auto_alg::auto_pass_state& state, uint64_t time_now, int64_t frame_number ) noexcept
+static bool is_auto_pass_run( auto_alg::auto_pass_state& state, const auto_alg::auto_pass_params& params ) noexcept
 {
-    const auto current_frame_number = frame_number;
+    const auto inputs = fetch_control_inputs( params );
+    if( !(inputs == state.last_inputs_) ) {
+        state.last_inputs_ = inputs;
+        state.runs_without_change_ = 0;
+    }
+
+    const auto time_now = params.time_point;
+    const auto current_frame_number = params.frame_number;
     if( state.last_frame_time_ == 0 || state.last_frame_time_ > time_now || current_frame_number < state.last_frame_number_ ) {
         // these indicate reset state or some curious time cases
         return true;
@@ -462,12 +661,20 @@ static bool is_auto_pass_run( auto_alg::auto_pass_state& state, uint64_t time_no
     if( frame_count_diff < state.min_frame_number_distance_ ) {
         return false;
     }
+    if( state.runs_without_change_ == 0 ) {
+        // still converging
+        return true;
+    }
+
+    const bool settled = state.is_settled();
+    const auto max_time_distance = settled ? state.max_frame_time_distance_settled_ : state.max_frame_time_distance_;
+    const auto max_frame_distance = settled ? state.max_frame_number_distance_settled_ : state.max_frame_number_distance_;
 
     const auto time_since_last_run = time_now - state.last_frame_time_;
-    if( time_since_last_run > state.max_frame_time_distance_ ) {
+    if( time_since_last_run > max_time_distance ) {
         return true;
     }
-    if( frame_count_diff > state.max_frame_number_distance_ ) {
+    if( frame_count_diff > max_frame_distance ) {
         return true;
     }
     return false;
@@ -476,7 +683,7 @@ static bool is_auto_pass_run( auto_alg::auto_pass_state& state, uint64_t time_no
 bool auto_alg::should_prepare_auto_pass_step( auto_pass_state& state, const auto_pass_params& params ) noexcept
 {
     state.frame_number_ = params.frame_number;
-    return is_auto_pass_run( state, params.time_point, params.frame_number ) || state.focus_onepush_provider.is_auto_alg_run_needed( params.focus_onepush_params );
+    return is_auto_pass_run( state, params ) || state.focus_onepush_provider.is_auto_alg_run_needed( params.focus_onepush_params );
 }
 
 auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, const img::img_descriptor& img_data, const auto_pass_params& params )
@@ -494,7 +701,7 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
     }
 
     if( state.frame_number_ != params.frame_number ) {
-        if( !is_auto_pass_run( state, params.time_point, params.frame_number ) ) {
+        if( !is_auto_pass_run( state, params ) ) {
             return rval;
         }
     }
@@ -523,12 +730,14 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
     // This assigns rval.wb if needed and calculates brightness as needed
     const auto results = exec_brightness_and_wb_calc( state, img_data_roi, params );
     rval.wb = results.wb_res;
+    rval.statistics = calc_image_statistics( state, results, img_data_roi, params );
     if( results.pwl_res.value_changed ) {
         rval.hdr_gain_selection_changed = true;
         rval.hdr_gain_selection_value = results.pwl_res.hdr_gain;
     }
 
     if( results.brightness_res.brightness < 0.f ) { // we can quit here if brightness is not needed
+        update_settled_state( state, rval );
         return rval;
     }
 
@@ -547,6 +756,7 @@ auto_alg::auto_pass_results	    auto_alg::auto_pass( auto_pass_state& state, con
 		rval.iris_changed = true;
 		rval.iris_value = res.iris;
 	}
+    update_settled_state( state, rval );
     return rval;
 }
 
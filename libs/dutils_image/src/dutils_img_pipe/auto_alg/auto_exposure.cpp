@@ -68,6 +68,23 @@ static float calc_gain( float dist, float gain, const auto_alg::property_cont_ga
     }
 }
 
+// Linear amplification of a gain value
+static float calc_possible_gain_factor( const auto_alg::property_cont_gain& range, float gain )
+{
+    if( range.is_gain_db ) {
+        return exp2f( gain / range.gain_db_multiplier );
+    }
+    return gain <= 0 ? 1.f : gain;
+}
+
+static float calc_gain_from_factor( const auto_alg::property_cont_gain& range, float factor )
+{
+    if( range.is_gain_db ) {
+        return CLIP( log2f( factor ) * range.gain_db_multiplier, range.min, range.max );
+    }
+    return CLIP( factor, range.min, range.max );
+}
+
 static int calc_iris( float dist, int iris, const auto_alg::property_cont_iris& range )
 {
     dist = (dist + 3.f) / 4.f;	// this dampens the change in dist factor
@@ -198,6 +215,70 @@ auto_alg::impl::gain_exposure_iris_values		auto_alg::impl::calc_auto_gain_exposu
     return rval;
 }
 
+bool auto_alg::impl::calc_predictive_gain_exposure( float brightness, float reference_value, float highlight_fraction,
+    const auto_alg::property_cont_gain& gain_desc,
+    const auto_alg::property_cont_exposure& exposure_desc,
+    gain_exposure_iris_values& rval )
+{
+    // Outside of this range the damped steps need 3 or more runs to settle
+    constexpr float predictive_dist_min = 0.8f;
+    constexpr float predictive_dist_max = 1.25f;
+    // When most of the image is clipped, the real brightness is unknown and the reduction is at least this
+    constexpr float saturated_fraction = 0.5f;
+    constexpr float saturated_dist = 0.5f;
+
+    if( !gain_desc.auto_enabled && !exposure_desc.auto_enabled ) {
+        return false;
+    }
+    if( exposure_desc.auto_enabled ) {
+        rval.exposure = CLIP( exposure_desc.val, exposure_desc.min, exposure_desc.max );
+    }
+    if( gain_desc.auto_enabled ) {
+        rval.gain = CLIP( gain_desc.value, gain_desc.min, gain_desc.max );
+    }
+
+    float dist = calc_dist( reference_value, brightness );
+    if( highlight_fraction > saturated_fraction && dist < 1.f ) {
+        dist = std::min( dist, saturated_dist );
+    }
+    if( dist >= predictive_dist_min && dist <= predictive_dist_max ) {
+        return false;
+    }
+
+    const float gain_factor = calc_possible_gain_factor( gain_desc, rval.gain );
+
+    // Lower gain first and raise exposure first, so that noise stays low
+    float remaining = dist;
+    float new_gain_factor = gain_factor;
+    if( gain_desc.auto_enabled && remaining < 1.f ) {
+        new_gain_factor = std::max( gain_factor * remaining, calc_possible_gain_factor( gain_desc, gain_desc.min ) );
+        remaining *= gain_factor / new_gain_factor;
+    }
+
+    int new_exposure = rval.exposure;
+    if( exposure_desc.auto_enabled && rval.exposure > 0 ) {
+        new_exposure = CLIP( static_cast<int>( rval.exposure * remaining ), exposure_desc.min, exposure_desc.max );
+        remaining *= rval.exposure / static_cast<float>( new_exposure );
+    }
+
+    if( gain_desc.auto_enabled && remaining > 1.f ) {
+        new_gain_factor = std::min( new_gain_factor * remaining, calc_possible_gain_factor( gain_desc, gain_desc.max ) );
+    }
+
+    if( abs( new_exposure - rval.exposure ) < (exposure_desc.granularity / 2) ) {
+        new_exposure = rval.exposure;
+    }
+
+    const float new_gain = new_gain_factor != gain_factor ? calc_gain_from_factor( gain_desc, new_gain_factor ) : rval.gain;
+    if( new_exposure == rval.exposure && new_gain == rval.gain ) {
+        return false;   // at the range limits
+    }
+
+    rval.exposure = new_exposure;
+    rval.gain = new_gain;
+    return true;
+}
+
 int auto_alg::impl::calc_auto_pwm_iris( float corrected_brightness, int reference_value, const auto_alg::property_cont_iris& iris_desc, detail::pid_controller& iris_controller )
 {
     // Don't calculate with too slow frame rates, the iris might go too fast
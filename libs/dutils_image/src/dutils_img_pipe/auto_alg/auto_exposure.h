@@ -15,5 +15,13 @@ namespace auto_alg::impl
 
 	gain_exposure_iris_values	calc_auto_gain_exposure_iris( float brightness, float reference_value, const auto_alg::property_cont_gain& gain_desc, 
 									const auto_alg::property_cont_exposure& exposure_desc, const auto_alg::property_cont_iris& iris_desc );
+
+	/** Jumps directly to the exposure and gain that should result in reference_value, assuming the image brightness is proportional to
+	 * exposure time and linear gain.
+	 * Returns false when the brightness is close enough to the reference, so that the damped steps of calc_auto_gain_exposure_iris should trim the rest.
+	 * highlight_fraction is the fraction of pixels at or near saturation, the mean brightness of these images is too low to predict the reduction.
+	 */
+	bool						calc_predictive_gain_exposure( float brightness, float reference_value, float highlight_fraction, const auto_alg::property_cont_gain& gain_desc,
+									const auto_alg::property_cont_exposure& exposure_desc, gain_exposure_iris_values& rval );
 	int							calc_auto_pwm_iris( float corrected_brightness, int reference_value, const auto_alg::property_cont_iris& iris_desc, detail::pid_controller& iris_controller );
 }
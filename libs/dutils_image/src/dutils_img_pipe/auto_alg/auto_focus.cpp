@@ -4,6 +4,7 @@
 
 
 #include <algorithm>
+#include <vector>
 
 #include "../../dutils_img_base/img_rect_tools.h"
 
@@ -64,6 +65,20 @@ inline TDataType*	get_ptr_at( void* region_base, int x, int y, int stride )
     return ((TDataType*)(((uint8_t*)region_base) + y * stride)) + x;
 }
 
+// Contrast between two neighboring 8x4 blocks from the running sums of 4 pixel wide columns, sums[i] is the sum of all columns before i
+static int max_block_contrast( const std::vector<int>& sums, int length )
+{
+    int max_contrast = 0;
+    for( int i = 0; (i+16) < length; i += 4 )
+    {
+        int a = (sums[i + 8] - sums[i]) / 16;
+        int b = (sums[i + 16] - sums[i + 8]) / 16;
+
+        max_contrast = max( abs_(a-b), max_contrast );
+    }
+    return max_contrast;
+}
+
 template<typename TChannelType>
 static int autofocus_get_contrast_( const img::img_descriptor& image, const RegionInfo& region )
 {
@@ -75,56 +90,33 @@ static int autofocus_get_contrast_( const img::img_descriptor& image, const Regi
     int step_y = region.height / (LINE_COUNT + 1) + 1;
     int step_x = region.width / (LINE_COUNT + 1) + 1;
 
+    // Every line and column is summed up once, instead of once for each block position it is part of
+    std::vector<int> line( std::max( region.width, region.height ) );
+    std::vector<int> sums( line.size() + 1 );
+
     int sharpness = 0;
     for( int y = step_y; (y+4) < region.height; y += step_y )
     {
-        int max_contrast = 0;
-
-        for( int x = 0; (x+16) < region.width; x += 4 )
-        {
-            int a = 0;
-            for( int i = 0; i < 8; ++i )
-                for( int j = 0; j < 4; ++j )
-                    a += *get_ptr_at<TChannelType>( region_start, x + i, y + j, stride );
-
-            a /= 16;
-
-            int b = 0;
-            for( int i = 8; i < 16; ++i )
-                for( int j = 0; j< 4;++j )
-                    b += *get_ptr_at<TChannelType>( region_start, x + i, y + j, stride );
-
-            b /= 16;
-
-            int contrast = abs_(a-b);
-            max_contrast = max(contrast, max_contrast);
+        const TChannelType* l0 = get_ptr_at<TChannelType>( region_start, 0, y, stride );
+        const TChannelType* l1 = get_ptr_at<TChannelType>( region_start, 0, y + 1, stride );
+        const TChannelType* l2 = get_ptr_at<TChannelType>( region_start, 0, y + 2, stride );
+        const TChannelType* l3 = get_ptr_at<TChannelType>( region_start, 0, y + 3, stride );
+        for( int x = 0; x < region.width; ++x ) {
+            line[x] = l0[x] + l1[x] + l2[x] + l3[x];
         }
-        sharpness += max_contrast;
+        for( int x = 0; x < region.width; ++x ) {
+            sums[x + 1] = sums[x] + line[x];
+        }
+        sharpness += max_block_contrast( sums, region.width );
     }
     for( int x = step_x; (x+4) < region.width; x += step_x )
     {
-        int max_contrast = 0;
-
-        for( int y = 0; (y+16) < region.height; y += 4 )
+        for( int y = 0; y < region.height; ++y )
         {
-            int a = 0;
-            for( int i = 0; i < 8; ++i )
-                for( int j = 0; j< 4;++j )
-                    a += *get_ptr_at<TChannelType>( region_start, x + j, y + i, stride );
-
-            a /= 16;
-
-            int b = 0;
-            for( int i = 8; i < 16; ++i )
-                for( int j = 0; j< 4;++j )
-                    b += *get_ptr_at<TChannelType>( region_start, x + j, y + i, stride );
-
-            b /= 16;
-
-            int contrast = abs_(a-b);
-            max_contrast = max(contrast, max_contrast);
+            const TChannelType* p = get_ptr_at<TChannelType>( region_start, x, y, stride );
+            sums[y + 1] = sums[y] + p[0] + p[1] + p[2] + p[3];
         }
-        sharpness += max_contrast;
+        sharpness += max_block_contrast( sums, region.height );
     }
     return sharpness;
 }
@@ -279,7 +271,7 @@ void auto_alg::impl::auto_focus::setup_run( int focus_val, const auto_alg::auto_
     focus_min_ = params.focus_range_min;
     focus_max_ = params.focus_range_max;
     max_time_to_wait_for_focus_change_ = params.focus_device_speed;
-    min_time_to_wait_for_focus_change_ = 300;
+    min_time_to_wait_for_focus_change_ = params.focus_min_wait_time;
     auto_step_divisor_ = params.auto_step_divisor;
     sweep_suggested_ = params.suggest_sweep;
 
@@ -477,6 +469,8 @@ bool	auto_alg::impl::auto_focus::analyze_frame_( const img::img_descriptor& img,
         }
     }
 
+    int sq = 0;
+
     // In sweep mode, look for the region with the highest sharpness on every frame
     if( (data.state == data_holder::sweep_1) || (data.state == data_holder::sweep_2) )
     {
@@ -486,9 +480,13 @@ bool	auto_alg::impl::auto_focus::analyze_frame_( const img::img_descriptor& img,
         data.y = newROI.y;
         data.width = newROI.width;
         data.height = newROI.height;
-    }
 
-    int sq = get_sharpness( img );
+        sq = newROI.sharpness;
+    }
+    else
+    {
+        sq = get_sharpness( img );
+    }
 
     if( (data.state == data_holder::sweep_1) || (data.state == data_holder::sweep_2) )
     {
@@ -2,6 +2,7 @@
 #include "auto_wb_temperature.h"
 
 #include <cmath>
+#include <cstdint>
 
 using namespace auto_alg;
 
@@ -16,8 +17,17 @@ auto_alg::wb_channel_factors GetFactorsFromTemperature( int temperature, const w
 	if( temperature > 10000 ) {
 		temperature = 10000;
 	}
-	int index = (temperature - 2500) / 100;
-	return arr[index];
+	const int index = (temperature - 2500) / 100;
+	const int rest = (temperature - 2500) % 100;
+	if( rest == 0 ) {
+		return arr[index];
+	}
+
+	// the faded temperatures are between the entries of the table
+	const float w = rest / 100.0f;
+	const auto& lo = arr[index];
+	const auto& hi = arr[index + 1];
+	return wb_channel_factors{ lo.r + (hi.r - lo.r) * w, lo.g + (hi.g - lo.g) * w, lo.b + (hi.b - lo.b) * w };
 }
 
 
@@ -29,7 +39,30 @@ static int clip( int x )
 }
 
 
-static int SimulateWhiteBalance( const auto_alg::impl::auto_sample_points& points, wb_channel_factors factors )
+// the points converted once per search, so that each temperature only runs a branch-free loop
+struct temperature_points
+{
+	int cnt = 0;
+	uint8_t r[1500];
+	uint8_t g[1500];
+	uint8_t b[1500];
+};
+
+
+static void fill_points( temperature_points& dst, const auto_alg::impl::auto_sample_points& points )
+{
+	dst.cnt = points.cnt;
+	for( int i = 0; i < points.cnt; ++i )
+	{
+		const auto pix = points.samples[i].to_pixel();
+		dst.r[i] = pix.r;
+		dst.g[i] = pix.g;
+		dst.b[i] = pix.b;
+	}
+}
+
+
+static int SimulateWhiteBalance( const temperature_points& points, wb_channel_factors factors )
 {
 	const float min_c = 0.925f;
 	const float max_c = 1.0f / min_c;
@@ -38,26 +71,21 @@ static int SimulateWhiteBalance( const auto_alg::impl::auto_sample_points& point
 
 	for( int i = 0; i < points.cnt; ++i )
 	{
-		const auto pix = points.samples[i].to_pixel();
-
-		const int r = clip( (int)((float)pix.r * factors.r) );
-		const int g = clip( (int)((float)pix.g * factors.g) );
-		const int b = clip( (int)((float)pix.b * factors.b) );
+		const int r = clip( (int)((float)points.r[i] * factors.r) );
+		const int g = clip( (int)((float)points.g[i] * factors.g) );
+		const int b = clip( (int)((float)points.b[i] * factors.b) );
 		const int y = ((r * 79 + g * 150 + b * 27) >> 8);
-		if( y > 50 && y < 240 )
-		{
 
-			float qrg = (float)r / (float)g;
-			float qbg = (float)b / (float)g;
-			float qrb = (float)r / (float)b;
+		// r / g in ]min_c, max_c[ etc. without the divisions, a zero channel fails like before
+		const float fr = (float)r;
+		const float fg = (float)g;
+		const float fb = (float)b;
+		const bool is_white = (y > 50) & (y < 240) &
+			(fr > min_c * fb) & (fr < max_c * fb) &
+			(fb > min_c * fg) & (fb < max_c * fg) &
+			(fr > min_c * fg) & (fr < max_c * fg);
 
-			if( qrb > min_c && qrb < max_c &&
-				qbg > min_c && qbg < max_c &&
-				qrg > min_c && qrg < max_c )
-			{
-				whiteCnt++;
-			}
-		}
+		whiteCnt += is_white;
 	}
 	return whiteCnt;
 }
@@ -69,11 +97,14 @@ int		auto_alg::impl::calc_temperature_for_pixels( const auto_alg::impl::auto_sam
 	int maxWhiteTemp = -1;
 	float maxWhiteValue = -1;
 
+	temperature_points tmp_points;
+	fill_points( tmp_points, points );
+
 	//  Get temperature with most potentially white pixels
 	for( int temperature_iter = min_temperature; temperature_iter < max_temperature; temperature_iter += 100 )
 	{
 		wb_channel_factors wb_factors = GetFactorsFromTemperature( temperature_iter, arr );
-		const int white_count = SimulateWhiteBalance( points, wb_factors );
+		const int white_count = SimulateWhiteBalance( tmp_points, wb_factors );
 		const float whiteValue = (float)white_count;
 
 		// normal distribution around center
@@ -32,11 +32,10 @@ static img_filter::whitebalance::apply_params  find_average( const auto_alg::imp
 
 }
 
-static img_filter::whitebalance::apply_params        calc_empia_wb_values( const img::img_descriptor& src, auto_alg::impl::auto_sample_points& points )
+// src already has the bayer fcc of its bit depth, the sampling reduces both to 8 bit
+static img_filter::whitebalance::apply_params        calc_empia_wb_values( const img::img_descriptor& bayer_src, auto_alg::impl::auto_sample_points& points )
 {
-    img::img_descriptor by16src = img::replace_fcc( src, img::fourcc::RGGB8 );
-
-    auto_alg::impl::auto_sample_by_imgu8( by16src, points );
+    auto_alg::impl::auto_sample_by_imgu8( bayer_src, points );
     if( points.cnt == 0 ) {
         return {};
     }
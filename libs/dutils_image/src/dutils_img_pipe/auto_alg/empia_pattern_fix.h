@@ -13,6 +13,7 @@ namespace auto_alg::impl
 
 namespace img_filter {
 namespace empia_fix {
+    // src is MONO8 or MONO16 with the bayer pattern of the sensor, it is sampled like RGGB8/RGGB16
     img_filter::whitebalance::apply_params   calc_empia_wb_values( const img::img_descriptor& src, auto_alg::impl::auto_sample_points& scratch_space );
 }
 }
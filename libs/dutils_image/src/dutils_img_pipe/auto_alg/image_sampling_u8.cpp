@@ -1,6 +1,10 @@
 
 #include "image_sampling_u8.h"
 
+#include "auto_alg.h"
+
+#include <algorithm>
+#include <cstring>
 #include <dutils_img/image_bayer_pattern.h>
 #include "../../dutils_img_base/interop_private.h"
 #include "../../dutils_img_filter/transform/fcc1x_packed/fcc1x_packed_to_fcc8_internal.h"
@@ -261,3 +265,78 @@ auto_alg::impl::resulting_brightness	auto_alg::impl::auto_sample_mono_imgu8( con
 
     return auto_alg::impl::resulting_brightness::invalid();
 }
+
+
+bool auto_alg::impl::can_calc_brightness_histogram_u8( img::fourcc fcc ) noexcept
+{
+    return img::is_by8_fcc( fcc );
+}
+
+void auto_alg::impl::calc_brightness_histogram_u8( const img::img_descriptor& image, const wb_channel_factors& wb, brightness_histogram& hist ) noexcept
+{
+    constexpr int max_samples = 256 * 256;
+
+    memset( hist.bins, 0, sizeof( hist.bins ) );
+    hist.cnt = 0;
+
+    const int superpixel_columns = image.dim.cx / 2;
+    const int superpixel_lines = image.dim.cy / 2;
+    if( superpixel_columns < 1 || superpixel_lines < 1 ) {
+        return;
+    }
+
+    // the same step in both directions, so the samples stay evenly spread
+    int step = 1;
+    while( ((superpixel_columns + step - 1) / step) * ((superpixel_lines + step - 1) / step) > max_samples ) {
+        ++step;
+    }
+
+    const auto img_pat = img::by_transform::convert_bayer_fcc_to_pattern( image.fourcc_type() );
+
+    // 8 fractional bits
+    const int wb_r = static_cast<int>( wb.r * 256.f );
+    const int wb_g = static_cast<int>( wb.g * 256.f );
+    const int wb_b = static_cast<int>( wb.b * 256.f );
+
+    uint32_t cnt = 0;
+    for( int sy = 0; sy < superpixel_lines; sy += step )
+    {
+        // superpixels start on even lines and columns, so all of them have the pattern of the image
+        const uint8_t* cur_line = img::get_line_start<uint8_t>( image, sy * 2 + 0 );
+        const uint8_t* nxt_line = img::get_line_start<uint8_t>( image, sy * 2 + 1 );
+
+        for( int sx = 0; sx < superpixel_columns; sx += step )
+        {
+            const int x = sx * 2;
+            const auto e = to_auto_sample_entry( img_pat, by_sample_entries{ cur_line[x + 0], cur_line[x + 1], nxt_line[x + 0], nxt_line[x + 1] } );
+
+            const int r = std::min( 255, (e.rr * wb_r) >> 8 );
+            const int g = std::min( 255, (((e.gr + e.gb) / 2) * wb_g) >> 8 );
+            const int b = std::min( 255, (e.bb * wb_b) >> 8 );
+
+            ++hist.bins[calc_brightness_from_clr_avg( r, g, b )];
+            ++cnt;
+        }
+    }
+    hist.cnt = cnt;
+}
+
+auto_alg::impl::resulting_brightness auto_alg::impl::calc_resulting_brightness( const brightness_histogram& hist ) noexcept
+{
+    if( hist.cnt == 0 ) {
+        return resulting_brightness::invalid();
+    }
+
+    uint64_t brightness_accu = 0;
+    uint32_t gt_240_counter = 0;
+    for( int y = 0; y < 256; ++y )
+    {
+        brightness_accu += uint64_t( y ) * hist.bins[y];
+        if( y >= 240 ) {
+            gt_240_counter += hist.bins[y];
+        }
+    }
+
+    const float div = 1.f / hist.cnt;
+    return { brightness_accu / 255.f * div, gt_240_counter * div };
+}
@@ -13,5 +13,17 @@ namespace auto_alg::impl
     resulting_brightness    auto_sample_mono_imgu8( const img::img_descriptor& image );
 
     bool                    can_auto_sample_by_imgu8( img::fourcc fcc );
+
+    struct brightness_histogram
+    {
+        uint32_t    bins[256];
+        uint32_t    cnt;
+    };
+
+    // Dense alternative to the sample grid for the brightness statistics.
+    // Visits up to 256 * 256 2x2 superpixels evenly spread over the image, wb is applied before the luminance is taken.
+    bool                    can_calc_brightness_histogram_u8( img::fourcc fcc ) noexcept;
+    void                    calc_brightness_histogram_u8( const img::img_descriptor& image, const wb_channel_factors& wb, brightness_histogram& hist ) noexcept;
+    resulting_brightness    calc_resulting_brightness( const brightness_histogram& hist ) noexcept;
 }
 
@@ -1,6 +1,4 @@
 
-//#define SCOPE_PROFILER_ENABLED_
-
 #include "../../dutils_img_filter/utils/scope_profiler.h"
 
 #define DUTIL_PROFILE_SECTION( name )   PROFILER_START_SCOPED( name )
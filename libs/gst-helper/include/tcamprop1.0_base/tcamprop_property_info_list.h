@@ -101,6 +101,7 @@ namespace tcamprop1::prop_list
     extern const prop_static_info_float TonemappingIntensity;
 
     extern const prop_static_info_boolean ColorTransformationEnable;
+    extern const prop_static_info_boolean ClaimColorTransformationSoftware;
     extern const prop_static_info_float ColorTransformation_Value_Gain00;
     extern const prop_static_info_float ColorTransformation_Value_Gain01;
     extern const prop_static_info_float ColorTransformation_Value_Gain02;
@@ -4,6 +4,7 @@
 #include "tcamprop_property_info.h"
 
 #include <outcome/result.hpp>
+#include <memory>
 #include <string_view>
 #include <vector>
 #include <optional>
@@ -176,6 +177,18 @@ public:
     virtual auto set_property_value(std::string_view new_value, uint32_t flags = 0) -> std::error_code = 0;
 };
 
+/**
+ * Returned by property_list_interface::begin_write_batch.
+ * Writes done while this exists may be deferred until commit, commit reports their errors.
+ */
+class write_batch_interface
+{
+public:
+    virtual ~write_batch_interface() = default;
+
+    virtual auto commit() -> std::error_code = 0;
+};
+
 class property_list_interface
 {
 public:
@@ -184,6 +197,9 @@ public:
     virtual auto get_property_list() -> std::vector<std::string_view> = 0;
     virtual auto find_property(std::string_view name) ->tcamprop1::property_interface* = 0;
 
+    // lists whose backend can write several values in one request override this, nullptr writes every value immediately
+    virtual auto begin_write_batch() -> std::unique_ptr<write_batch_interface> { return nullptr; }
+
     template<class TItf>
     auto find_property_typed( std::string_view name ) -> TItf*
     {
@@ -27,6 +27,10 @@ namespace tcamprop1_gobj
      * After calling clear_list, the registered tcamprop1::property_list_interface is internally cleared and can be deleted (same goes for the property_interface derived interfaces handed
      * out by the property_list_interface.
      *
+     * get_tcam_property returns the same TcamPropertyBase object for every call with the same name until clear_list is called.
+     * Callers that access a property repeatedly should keep that object and use the tcam_property_* functions on it,
+     * the name based get_/set_ methods resolve the name on every call. get_values/set_values access several of these objects at once.
+     *
      * Use init_provider_interface to populate the interface methods. Because the parameter passed in interface methods is TcamPropertyProvider you have to implement a
      * convert method.
      * E.g:
@@ -68,6 +72,10 @@ namespace tcamprop1_gobj
         static void set_float( tcam_property_provider* cont, const char* name, gdouble new_val, GError** err );
         static void set_enumeration( tcam_property_provider* cont, const char* name, const gchar* new_val, GError** err );
         static void set_command( tcam_property_provider* cont, const char* name, GError** err );
+
+        // properties must have been returned by get_tcam_property, the list lock is taken once for all of them
+        static auto get_values( tcam_property_provider* cont, TcamPropertyBase** properties, guint count, GValue* values, GError** err ) -> gboolean;
+        static auto set_values( tcam_property_provider* cont, TcamPropertyBase** properties, guint count, const GValue* values, GError** err ) -> gboolean;
     private:
         std::shared_mutex   data_mtx_;
 
@@ -94,5 +102,8 @@ namespace tcamprop1_gobj
         iface->get_tcam_integer = []( TcamPropertyProvider* self, const char* name, GError** err ) { return tcam_property_provider::get_integer( get_container_func( self ), name, err ); };
         iface->get_tcam_float = []( TcamPropertyProvider* self, const char* name, GError** err ) { return tcam_property_provider::get_float( get_container_func( self ), name, err ); };
         iface->get_tcam_enumeration = []( TcamPropertyProvider* self, const char* name, GError** err ) { return tcam_property_provider::get_enumeration( get_container_func( self ), name, err ); };
+
+        iface->get_tcam_values = []( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, GValue* values, GError** err ) { return tcam_property_provider::get_values( get_container_func( self ), properties, count, values, err ); };
+        iface->set_tcam_values = []( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, const GValue* values, GError** err ) { return tcam_property_provider::set_values( get_container_func( self ), properties, count, values, err ); };
     }
 }
\ No newline at end of file
@@ -7,6 +7,51 @@
 #include <map>
 #include <limits>
 #include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+
+namespace
+{
+    /** Caps transforms convert the same few name/format pairs over and over.
+     * The structure name is already a quark, the format string is looked up with g_quark_try_string,
+     * so a hit costs one hash of the format string instead of a string search through the format table.
+     * Only strings that resolve to a fourcc are interned.
+     */
+    class fcc_quark_table
+    {
+    public:
+        img::fourcc find( const GstStructure& structure, const char* format )
+        {
+            const GQuark name_quark = gst_structure_get_name_id( &structure );
+            const GQuark format_quark = g_quark_try_string( format );
+            if( format_quark != 0 )
+            {
+                std::shared_lock lck{ mtx_ };
+                auto iter = entries_.find( { name_quark, format_quark } );
+                if( iter != entries_.end() ) {
+                    return iter->second;
+                }
+            }
+
+            const auto fcc = img_lib::gst::gst_caps_string_to_fourcc( gst_structure_get_name( &structure ), format );
+            if( fcc != img::fourcc::FCC_NULL )
+            {
+                std::unique_lock lck{ mtx_ };
+                entries_.emplace( std::make_pair( name_quark, g_quark_from_string( format ) ), fcc );
+            }
+            return fcc;
+        }
+    private:
+        std::shared_mutex mtx_;
+        std::map<std::pair<GQuark, GQuark>, img::fourcc> entries_;
+    };
+
+    img::fourcc find_fcc( const GstStructure& structure, const char* format )
+    {
+        static fcc_quark_table table;
+        return table.find( structure, format );
+    }
+}
 
 
 std::optional<img::dim> gst_helper::get_gst_struct_image_dim(const GstStructure& structure)
@@ -40,8 +85,7 @@ img::fourcc gst_helper::get_gst_struct_fcc(const GstStructure& structure)
     {
         return img::fourcc::FCC_NULL;
     }
-    return img_lib::gst::gst_caps_string_to_fourcc(gst_structure_get_name(&structure),
-                                                   format == nullptr ? "" : format);
+    return find_fcc(structure, format == nullptr ? "" : format);
 }
 
 img::img_type gst_helper::get_gst_struct_image_type(const GstStructure& structure)
@@ -153,7 +197,6 @@ auto gst_helper::convert_GstStructure_to_fcc_list( const GstStructure& strct ) -
         GST_ERROR( "GstStructure with no name" );
         return {};
     }
-    std::string_view format_type = struct_name_;
 
 
     auto gval = gst_structure_get_value( &strct, "format" );
@@ -162,9 +205,10 @@ auto gst_helper::convert_GstStructure_to_fcc_list( const GstStructure& strct ) -
     }
 
     std::vector<img::fourcc> rval;
-    auto add_fcc = [&rval,format_type]( const char* str ) {
+    auto add_fcc = [&rval,&strct]( const GValue* val ) {
+        const char* str = G_VALUE_HOLDS_STRING( val ) ? g_value_get_string( val ) : nullptr;
         if( str != nullptr ) {
-            auto fcc = img_lib::gst::gst_caps_string_to_fourcc( format_type, str );
+            auto fcc = find_fcc( strct, str );
             if( fcc != img::fourcc::FCC_NULL ) {
                 rval.push_back( fcc );
             }
@@ -173,13 +217,22 @@ auto gst_helper::convert_GstStructure_to_fcc_list( const GstStructure& strct ) -
 
     if( G_VALUE_TYPE( gval ) == G_TYPE_STRING )
     {
-        add_fcc( g_value_get_string( gval ) );
+        add_fcc( gval );
     }
-    else if( G_VALUE_TYPE( gval ) == GST_TYPE_LIST || G_VALUE_TYPE( gval ) == GST_TYPE_ARRAY )
+    else if( G_VALUE_TYPE( gval ) == GST_TYPE_LIST )
     {
-        for( auto&& entry : gst_helper::gst_list_or_array_to_GValue_vector( *gval ) )
-        {
-            add_fcc( g_value_get_string( entry ) );
+        const guint count = gst_value_list_get_size( gval );
+        rval.reserve( count );
+        for( guint i = 0; i < count; ++i ) {
+            add_fcc( gst_value_list_get_value( gval, i ) );
+        }
+    }
+    else if( G_VALUE_TYPE( gval ) == GST_TYPE_ARRAY )
+    {
+        const guint count = gst_value_array_get_size( gval );
+        rval.reserve( count );
+        for( guint i = 0; i < count; ++i ) {
+            add_fcc( gst_value_array_get_value( gval, i ) );
         }
     }
     else
@@ -76,6 +76,7 @@ static const constexpr tcamprop1::prop_static_info_find_result static_prop_list[
     to_( lst::TonemappingGlobalBrightness ),
     to_( lst::TonemappingIntensity ),
     to_( lst::ColorTransformationEnable ),
+    to_( lst::ClaimColorTransformationSoftware ),
     to_( lst::ColorTransformation_Value_Gain00 ),
     to_( lst::ColorTransformation_Value_Gain01 ),
     to_( lst::ColorTransformation_Value_Gain02 ),
@@ -324,6 +324,11 @@ const prop_static_info_boolean lst::ColorTransformationEnable = make_Boolean(
     "Activates the selected Color Transformation module."
 );
 
+const prop_static_info_boolean lst::ClaimColorTransformationSoftware = make_Boolean(
+    "ClaimColorTransformationSoftware",
+    "Color Correction", {}, {}, Visibility_t::Invisible
+);
+
 const prop_static_info_float lst::ColorTransformation_Value_Gain00 = make_Float(
     "ColorTransformation_Value_Gain00",
     "Color Correction", "Color Transformation Value Gain00",
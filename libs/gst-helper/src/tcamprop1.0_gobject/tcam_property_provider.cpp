@@ -5,6 +5,7 @@
 #include "tcam_propnode_impl.h"
 #include <gst-helper/gvalue_helper.h>
 
+#include <string_view>
 #include <unordered_map>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 
@@ -12,14 +13,8 @@ static bool is_err( GError** err ) {
     return err && *err;
 }
 
-static TcamPropertyBase* tcamprop_impl_create_node( tcamprop1::property_list_interface& prop_list_itf, const tcamprop1_gobj::impl::guard_state_handle& guard_handle, std::string_view name, GError** err )
+static TcamPropertyBase* tcamprop_impl_create_node( tcamprop1::property_interface* prop_itf_ptr, const tcamprop1_gobj::impl::guard_state_handle& guard_handle, GError** err )
 {
-    auto prop_itf_ptr = prop_list_itf.find_property( name );
-    if( prop_itf_ptr == nullptr ) {
-        tcamprop1_gobj::set_gerror( err, tcamprop1::status::property_is_not_implemented );
-        return nullptr;
-    }
-
     auto prop_state_opt = prop_itf_ptr->get_property_state();
     if( prop_state_opt.has_error() )
     {
@@ -85,6 +80,119 @@ static GSList* tcamprop_impl_fetch_names( tcamprop1::property_list_interface& pr
     return names;
 }
 
+static GType tcamprop_impl_value_type( tcamprop1::prop_type type )
+{
+    switch( type )
+    {
+    case tcamprop1::prop_type::Boolean:     return G_TYPE_BOOLEAN;
+    case tcamprop1::prop_type::Integer:     return G_TYPE_INT64;
+    case tcamprop1::prop_type::Float:       return G_TYPE_DOUBLE;
+    case tcamprop1::prop_type::Enumeration: return G_TYPE_STRING;
+    case tcamprop1::prop_type::String:      return G_TYPE_STRING;
+    case tcamprop1::prop_type::Command:     break;
+    }
+    return G_TYPE_INVALID;
+}
+
+template<class TItf>
+static auto tcamprop_impl_cast( tcamprop1::property_interface* itf ) -> TItf&
+{
+    return *static_cast<TItf*>( itf );
+}
+
+static bool tcamprop_impl_read_value( tcamprop1::property_interface* itf, GValue* value, GError** err )
+{
+    auto value_type = tcamprop_impl_value_type( itf->get_property_type() );
+    if( value_type == G_TYPE_INVALID ) {
+        tcamprop1_gobj::set_gerror( err, tcamprop1::status::parameter_type_incompatible );
+        return false;
+    }
+    if( G_VALUE_TYPE( value ) == G_TYPE_INVALID ) {
+        g_value_init( value, value_type );
+    } else if( G_VALUE_TYPE( value ) != value_type ) {
+        tcamprop1_gobj::set_gerror( err, tcamprop1::status::parameter_type_incompatible );
+        return false;
+    }
+
+    auto assign = [&]( auto&& res, auto&& setter ) -> bool
+    {
+        if( res.has_error() ) {
+            tcamprop1_gobj::set_gerror( err, res.error() );
+            return false;
+        }
+        setter( res.value() );
+        return true;
+    };
+
+    switch( itf->get_property_type() )
+    {
+    case tcamprop1::prop_type::Boolean:
+        return assign( tcamprop_impl_cast<tcamprop1::property_interface_boolean>( itf ).get_property_value(),
+                       [&]( bool v ) { g_value_set_boolean( value, v ); } );
+    case tcamprop1::prop_type::Integer:
+        return assign( tcamprop_impl_cast<tcamprop1::property_interface_integer>( itf ).get_property_value(),
+                       [&]( int64_t v ) { g_value_set_int64( value, v ); } );
+    case tcamprop1::prop_type::Float:
+        return assign( tcamprop_impl_cast<tcamprop1::property_interface_float>( itf ).get_property_value(),
+                       [&]( double v ) { g_value_set_double( value, v ); } );
+    case tcamprop1::prop_type::Enumeration:
+        return assign( tcamprop_impl_cast<tcamprop1::property_interface_enumeration>( itf ).get_property_value(),
+                       [&]( std::string_view v ) { g_value_take_string( value, g_strndup( v.data(), v.size() ) ); } );
+    case tcamprop1::prop_type::String:
+        return assign( tcamprop_impl_cast<tcamprop1::property_interface_string>( itf ).get_property_value(),
+                       [&]( const std::string& v ) { g_value_set_string( value, v.c_str() ); } );
+    case tcamprop1::prop_type::Command:
+        break;
+    }
+    return false;
+}
+
+static bool tcamprop_impl_write_value( tcamprop1::property_interface* itf, const GValue* value, GError** err )
+{
+    auto type = itf->get_property_type();
+    if( type != tcamprop1::prop_type::Command && G_VALUE_TYPE( value ) != tcamprop_impl_value_type( type ) ) {
+        tcamprop1_gobj::set_gerror( err, tcamprop1::status::parameter_type_incompatible );
+        return false;
+    }
+
+    std::error_code errc;
+    switch( type )
+    {
+    case tcamprop1::prop_type::Boolean:
+        errc = tcamprop_impl_cast<tcamprop1::property_interface_boolean>( itf ).set_property_value( g_value_get_boolean( value ) );
+        break;
+    case tcamprop1::prop_type::Integer:
+        errc = tcamprop_impl_cast<tcamprop1::property_interface_integer>( itf ).set_property_value( g_value_get_int64( value ) );
+        break;
+    case tcamprop1::prop_type::Float:
+        errc = tcamprop_impl_cast<tcamprop1::property_interface_float>( itf ).set_property_value( g_value_get_double( value ) );
+        break;
+    case tcamprop1::prop_type::Enumeration:
+    case tcamprop1::prop_type::String:
+    {
+        auto str = g_value_get_string( value );
+        if( str == nullptr ) {
+            tcamprop1_gobj::set_gerror( err, tcamprop1::status::parameter_null );
+            return false;
+        }
+        if( type == tcamprop1::prop_type::Enumeration ) {
+            errc = tcamprop_impl_cast<tcamprop1::property_interface_enumeration>( itf ).set_property_value( str );
+        } else {
+            errc = tcamprop_impl_cast<tcamprop1::property_interface_string>( itf ).set_property_value( str );
+        }
+        break;
+    }
+    case tcamprop1::prop_type::Command:
+        errc = tcamprop_impl_cast<tcamprop1::property_interface_command>( itf ).execute_command();
+        break;
+    }
+    if( errc ) {
+        tcamprop1_gobj::set_gerror( err, errc );
+        return false;
+    }
+    return true;
+}
+
 namespace tcamprop1_gobj::impl
 {
     class tcam_property_provider_impl_data
@@ -103,9 +211,10 @@ namespace tcamprop1_gobj::impl
                 g_object_unref( e.second );
             }
             flyweight_container_.clear();
+            handle_container_.clear();
         }
 
-        TcamPropertyBase* find_or_create_entry( const std::string& name, GError** err )
+        TcamPropertyBase* find_or_create_entry( std::string_view name, GError** err )
         {
             tcamprop1_gobj::impl::guard_state_raii lck{ guard_ };
             if( !lck ) {
@@ -120,17 +229,75 @@ namespace tcamprop1_gobj::impl
                 return rval;
             }
 
-            auto new_node = tcamprop_impl_create_node( *prop_list_itf_, guard_, name, err );
+            auto prop_itf_ptr = prop_list_itf_->find_property( name );
+            if( prop_itf_ptr == nullptr ) {
+                tcamprop1_gobj::set_gerror( err, tcamprop1::status::property_is_not_implemented );
+                return nullptr;
+            }
+
+            auto new_node = tcamprop_impl_create_node( prop_itf_ptr, guard_, err );
             if( new_node == nullptr ) {
                 return nullptr;
             }
 
-            /*auto [iter,added] =*/ flyweight_container_.emplace( name, new_node );
+            // the name of the property_interface stays valid until the list is cleared, which happens after this is destroyed
+            /*auto [iter,added] =*/ flyweight_container_.emplace( prop_itf_ptr->get_property_name(), new_node );
+            handle_container_.emplace( new_node, prop_itf_ptr );
 
             g_object_ref( new_node );
             return new_node;
         }
 
+        // handles not handed out by this provider, e.g. from before the last clear_list, are rejected
+        template<class TValue, class TFunc>
+        bool batch_access( TcamPropertyBase** properties, guint count, TValue* values, TFunc&& func, GError** err )
+        {
+            tcamprop1_gobj::impl::guard_state_raii lck{ guard_ };
+            if( !lck ) {
+                tcamprop1_gobj::set_gerror( err, tcamprop1::status::device_closed );
+                return false;
+            }
+            return batch_access_unguarded( properties, count, values, std::forward<TFunc>( func ), err );
+        }
+
+        template<class TValue, class TFunc>
+        bool batch_access_unguarded( TcamPropertyBase** properties, guint count, TValue* values, TFunc&& func, GError** err )
+        {
+            for( guint i = 0; i < count; ++i )
+            {
+                auto f = handle_container_.find( properties[i] );
+                if( f == handle_container_.end() ) {
+                    tcamprop1_gobj::set_gerror( err, TCAM_ERROR_PARAMETER_INVALID, "Property was not retrieved from this provider" );
+                    return false;
+                }
+                if( !func( f->second, &values[i], err ) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // all writes go to the device in one request, when the list supports batching
+        bool batch_write( TcamPropertyBase** properties, guint count, const GValue* values, GError** err )
+        {
+            tcamprop1_gobj::impl::guard_state_raii lck{ guard_ };
+            if( !lck ) {
+                tcamprop1_gobj::set_gerror( err, tcamprop1::status::device_closed );
+                return false;
+            }
+            auto batch = prop_list_itf_->begin_write_batch();
+            bool rval = batch_access_unguarded( properties, count, values, &tcamprop_impl_write_value, err );
+            if( batch ) {
+                // the values written before a failing one are still committed, as without batching
+                auto errc = batch->commit();
+                if( errc && rval ) {
+                    tcamprop1_gobj::set_gerror( err, errc );
+                    rval = false;
+                }
+            }
+            return rval;
+        }
+
         GSList* fetch_names( GError** err )
         {
             tcamprop1_gobj::impl::guard_state_raii lck{ guard_ };
@@ -145,7 +312,10 @@ namespace tcamprop1_gobj::impl
     private:
         tcamprop1_gobj::impl::guard_state_handle            guard_ = tcamprop1_gobj::impl::create_guard_state_handle();
         tcamprop1::property_list_interface*                 prop_list_itf_ = nullptr;
-        std::unordered_map<std::string, TcamPropertyBase*>  flyweight_container_;
+        // keyed by views, so a lookup does not have to copy the name passed in
+        std::unordered_map<std::string_view, TcamPropertyBase*>  flyweight_container_;
+        // reverse of flyweight_container_ for the value access via handles
+        std::unordered_map<TcamPropertyBase*, tcamprop1::property_interface*>  handle_container_;
     };
 }
 
@@ -192,7 +362,7 @@ TcamPropertyBase* tcamprop1_gobj::tcam_property_provider::fetch_item( const char
         return nullptr;
     }
 
-    auto ptr = data_->find_or_create_entry( std::string{ name }, err );
+    auto ptr = data_->find_or_create_entry( std::string_view{ name }, err );
     if( is_err( err ) || ptr == nullptr ) {
         return nullptr;
     }
@@ -200,6 +370,36 @@ TcamPropertyBase* tcamprop1_gobj::tcam_property_provider::fetch_item( const char
 }
 
 
+auto tcamprop1_gobj::tcam_property_provider::get_values( tcam_property_provider* cont, TcamPropertyBase** properties, guint count, GValue* values, GError** err ) -> gboolean
+{
+    if( !cont ) {
+        set_gerror( err, tcamprop1::status::device_closed );
+        return FALSE;
+    }
+
+    std::shared_lock lck0{ cont->data_mtx_ };
+    if( cont->data_ == nullptr ) {
+        set_gerror( err, tcamprop1::status::device_not_opened );
+        return FALSE;
+    }
+    return cont->data_->batch_access( properties, count, values, &tcamprop_impl_read_value, err );
+}
+
+auto tcamprop1_gobj::tcam_property_provider::set_values( tcam_property_provider* cont, TcamPropertyBase** properties, guint count, const GValue* values, GError** err ) -> gboolean
+{
+    if( !cont ) {
+        set_gerror( err, tcamprop1::status::device_closed );
+        return FALSE;
+    }
+
+    std::shared_lock lck0{ cont->data_mtx_ };
+    if( cont->data_ == nullptr ) {
+        set_gerror( err, tcamprop1::status::device_not_opened );
+        return FALSE;
+    }
+    return cont->data_->batch_write( properties, count, values, err );
+}
+
 auto    tcamprop1_gobj::tcam_property_provider::get_tcam_property_names( tcam_property_provider* cont, GError** err ) -> GSList*
 {
     if( !cont ) {
@@ -7,6 +7,7 @@
 #include <gst-helper/gobject_ptr.h>
 #include <tcamprop1.0_gobject/tcam_gerror.h>
 #include <tcam-property-1.0.h>
+#include <algorithm>
 #include <cassert>
 #include <fmt/format.h>
 
@@ -16,6 +17,8 @@ namespace
     {
         std::string				name;
         gvalue::gvalue_wrapper	val;
+
+        gobject_helper::gobject_ptr<TcamPropertyBase>   prop;
     };
 
     enum class apply_entry_result {
@@ -24,20 +27,81 @@ namespace
         failure_because_locked,
     };
 
-    auto    apply_entry( TcamPropertyProvider* prop_provider, const gst_apply_entry& entry, const tcamprop1_gobj::report_error_function& report_func ) -> apply_entry_result
+    // Returns true when the property already holds the value of the entry, so writing it can be skipped
+    bool    entry_is_current( TcamPropertyBase* prop, const gvalue::gvalue_wrapper& val )
     {
         GError* err = nullptr;
-        auto ptr = gobject_helper::make_ptr( tcam_property_provider_get_tcam_property( prop_provider, entry.name.c_str(), &err ) );
+        bool ret = false;
+
+        switch( tcam_property_base_get_property_type( prop ) )
+        {
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            if( auto actual_val = val.fetch_typed<bool>(); actual_val ) {
+                ret = (tcam_property_boolean_get_value( TCAM_PROPERTY_BOOLEAN( prop ), &err ) != FALSE) == actual_val.value();
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_INTEGER:
+        {
+            if( auto actual_val = val.fetch_typed<int64_t>(); actual_val ) {
+                ret = tcam_property_integer_get_value( TCAM_PROPERTY_INTEGER( prop ), &err ) == actual_val.value();
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            if( auto actual_val = val.fetch_typed<double>(); actual_val ) {
+                ret = tcam_property_float_get_value( TCAM_PROPERTY_FLOAT( prop ), &err ) == actual_val.value();
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        {
+            // entries given as index are always written
+            if( val.type() == G_TYPE_STRING )
+            {
+                auto actual_val = val.fetch_typed<std::string>();
+                const char* current = tcam_property_enumeration_get_value( TCAM_PROPERTY_ENUMERATION( prop ), &err );
+                ret = actual_val && current && actual_val.value() == current;
+            }
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+            return false;
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            if( auto actual_val = val.fetch_typed<std::string>(); actual_val )
+            {
+                char* current = tcam_property_string_get_value( TCAM_PROPERTY_STRING( prop ), &err );
+                ret = current && actual_val.value() == current;
+                g_free( current );
+            }
+            break;
+        }
+        }
+
         if( err )
         {
-            report_func( *err, entry.name, entry.val.get() );
             g_error_free( err );
-            return apply_entry_result::failure;
+            return false;
         }
+        return ret;
+    }
+
+    // Auto modes and switches lock other properties, writing them first saves a retry round
+    bool    is_written_first( TcamPropertyBase* prop )
+    {
+        auto type = tcam_property_base_get_property_type( prop );
+        return type == TCAM_PROPERTY_TYPE_ENUMERATION || type == TCAM_PROPERTY_TYPE_BOOLEAN;
+    }
+
+    auto    apply_entry( const gst_apply_entry& entry, const tcamprop1_gobj::report_error_function& report_func ) -> apply_entry_result
+    {
+        GError* err = nullptr;
+        auto& ptr = entry.prop;
         assert( ptr != nullptr );
 
-        if (tcam_property_base_get_access(ptr.get()) == TCAM_PROPERTY_ACCESS_RO)
-            return apply_entry_result::failure;
         if (!tcam_property_base_is_available(ptr.get(), nullptr))
             return apply_entry_result::failure_because_locked;
 
@@ -169,11 +233,35 @@ void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, cons
 
     gst_structure_foreach( &data_struct, func, &struct_list );
 
+    // resolve every entry once and drop the ones that already have the requested value
+    std::vector<gst_apply_entry>	write_list;
+    write_list.reserve( struct_list.size() );
+    for( auto& e : struct_list )
+    {
+        GError* err = nullptr;
+        e.prop = gobject_helper::make_ptr( tcam_property_provider_get_tcam_property( prop_provider, e.name.c_str(), &err ) );
+        if( err )
+        {
+            report_func( *err, e.name, e.val.get() );
+            g_error_free( err );
+            continue;
+        }
+        if( tcam_property_base_get_access( e.prop.get() ) == TCAM_PROPERTY_ACCESS_RO ) {
+            continue;
+        }
+        if( tcam_property_base_is_available( e.prop.get(), nullptr ) && entry_is_current( e.prop.get(), e.val ) ) {
+            continue;
+        }
+        write_list.push_back( std::move( e ) );
+    }
+    struct_list = std::move( write_list );
 
     if( struct_list.empty() ) {
         return;
     }
 
+    std::stable_partition( struct_list.begin(), struct_list.end(), []( const gst_apply_entry& e ) { return is_written_first( e.prop.get() ); } );
+
     bool at_least_one_success = false;
     do
     {
@@ -183,9 +271,9 @@ void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, cons
 
         for( auto& e : struct_list )
         {
-            auto res = apply_entry( prop_provider, e, report_func );
+            auto res = apply_entry( e, report_func );
             if( res == apply_entry_result::failure_because_locked ) {
-                retry_list.push_back( e );
+                retry_list.push_back( std::move( e ) );
             }
             else if( res == apply_entry_result::success ) {
                 at_least_one_success = true;
@@ -220,7 +220,10 @@ struct _TcamPropertyProviderInterface
     gdouble         (*get_tcam_float)(TcamPropertyProvider* self, const gchar* name, GError** err);
     const gchar*    (*get_tcam_enumeration)(TcamPropertyProvider* self, const gchar* name, GError** err);
 
-    gpointer    padding[12];
+    gboolean        (*get_tcam_values)(TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, GValue* values, GError** err);
+    gboolean        (*set_tcam_values)(TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, const GValue* values, GError** err);
+
+    gpointer    padding[10];
 };
 
 G_END_DECLS
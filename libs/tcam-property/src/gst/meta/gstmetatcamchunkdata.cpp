@@ -0,0 +1,362 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gstmetatcamchunkdata.h"
+
+#include <cstring>
+
+namespace
+{
+constexpr gsize trailer_size = 2 * sizeof(guint32);
+
+guint64 read_uint(const guint8* ptr, gsize length, bool is_little_endian)
+{
+    guint64 rval = 0;
+    for (gsize i = 0; i < length; ++i)
+    {
+        const guint64 byte = is_little_endian ? ptr[length - 1 - i] : ptr[i];
+        rval = (rval << 8) | byte;
+    }
+    return rval;
+}
+
+// walks the trailers from the end, callback returns false to stop
+// returns false when a trailer is damaged
+template<class TFunc> bool walk_chunks(const TcamChunkDataMeta& meta, TFunc&& func)
+{
+    if (meta.data == nullptr)
+    {
+        return true;
+    }
+
+    gsize pos = meta.size;
+    while (pos >= trailer_size)
+    {
+        const guint8* trailer = meta.data + pos - trailer_size;
+        const auto id = static_cast<guint32>(read_uint(trailer, 4, meta.is_little_endian));
+        const auto length = static_cast<gsize>(read_uint(trailer + 4, 4, meta.is_little_endian));
+        if (length > pos - trailer_size)
+        {
+            return false;
+        }
+
+        pos -= trailer_size + length;
+        if (!func(id, meta.data + pos, length))
+        {
+            return true;
+        }
+    }
+    return true;
+}
+
+bool find_chunk(const TcamChunkDataMeta& meta,
+                guint32 chunk_id,
+                const guint8*& chunk_data,
+                gsize& chunk_size)
+{
+    bool found = false;
+    walk_chunks(meta,
+                [&](guint32 id, const guint8* data, gsize size)
+                {
+                    if (id != chunk_id)
+                    {
+                        return true;
+                    }
+                    chunk_data = data;
+                    chunk_size = size;
+                    found = true;
+                    return false;
+                });
+    return found;
+}
+
+// the register has to be completely inside of the chunk
+const guint8* find_register(const TcamChunkDataMeta* meta,
+                            guint32 chunk_id,
+                            gsize offset,
+                            gsize length)
+{
+    const guint8* chunk_data = nullptr;
+    gsize chunk_size = 0;
+    if (!meta || !find_chunk(*meta, chunk_id, chunk_data, chunk_size))
+    {
+        return nullptr;
+    }
+    if (offset > chunk_size || length > chunk_size - offset)
+    {
+        return nullptr;
+    }
+    return chunk_data + offset;
+}
+
+// end of the first chunk incl. its trailer, the image in a chunk payload
+// 0 when the trailers are damaged
+gsize find_image_chunk_end(const TcamChunkDataMeta& meta)
+{
+    gsize image_end = 0;
+    const bool ok = walk_chunks(meta,
+                                [&](guint32 /*id*/, const guint8* data, gsize size)
+                                {
+                                    if (data == meta.data)
+                                    {
+                                        image_end = size + trailer_size;
+                                    }
+                                    return true;
+                                });
+    return ok ? image_end : 0;
+}
+} // namespace
+
+
+GType tcam_chunk_data_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = {"id", "val", NULL};
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamChunkDataMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_chunk_data_meta_init(GstMeta* meta,
+                                          gpointer /* params */,
+                                          GstBuffer* /* buffer */)
+{
+    TcamChunkDataMeta* tcam = (TcamChunkDataMeta*)meta;
+
+    tcam->data = nullptr;
+    tcam->size = 0;
+    tcam->is_little_endian = FALSE;
+    tcam->owned_data = nullptr;
+
+    return TRUE;
+}
+
+
+static gboolean tcam_chunk_data_meta_transform(GstBuffer* trans_buffer,
+                                               GstMeta* meta,
+                                               GstBuffer* /* buffer */,
+                                               GQuark type,
+                                               gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamChunkDataMeta* tcam = (TcamChunkDataMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        // trans_buffer may already have one, e.g. when it is from the same pool
+        TcamChunkDataMeta* trans_tcam = gst_buffer_get_tcam_chunk_data_meta(trans_buffer);
+        if (!trans_tcam)
+        {
+            trans_tcam = gst_buffer_add_tcam_chunk_data_meta(trans_buffer);
+        }
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        tcam_chunk_data_meta_set_data(trans_tcam, nullptr, 0, tcam->is_little_endian);
+
+        // the source memory is not kept alive by the copy
+        // the image chunk is skipped, the trailers of the others still lead to the start
+        const gsize begin = find_image_chunk_end(*tcam);
+        if (begin != 0 && begin < tcam->size)
+        {
+            trans_tcam->owned_data = (guint8*)g_malloc(tcam->size - begin);
+            memcpy(trans_tcam->owned_data, tcam->data + begin, tcam->size - begin);
+            trans_tcam->data = trans_tcam->owned_data;
+            trans_tcam->size = tcam->size - begin;
+        }
+    }
+    return TRUE;
+}
+
+
+static void tcam_chunk_data_meta_free(GstMeta* meta, GstBuffer* /* buffer */)
+{
+    TcamChunkDataMeta* tcam = (TcamChunkDataMeta*)meta;
+
+    g_free(tcam->owned_data);
+    tcam->owned_data = nullptr;
+    tcam->data = nullptr;
+}
+
+
+const GstMetaInfo* tcam_chunk_data_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_CHUNK_DATA_META_API_TYPE,
+                                                  "TcamChunkDataMeta",
+                                                  sizeof(TcamChunkDataMeta),
+                                                  tcam_chunk_data_meta_init,
+                                                  tcam_chunk_data_meta_free,
+                                                  tcam_chunk_data_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamChunkDataMeta* gst_buffer_add_tcam_chunk_data_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamChunkDataMeta*)gst_buffer_add_meta(buffer, TCAM_CHUNK_DATA_META_INFO, nullptr);
+}
+
+
+void tcam_chunk_data_meta_set_data(TcamChunkDataMeta* meta,
+                                   const guint8* data,
+                                   gsize size,
+                                   gboolean is_little_endian)
+{
+    g_return_if_fail(meta);
+
+    g_free(meta->owned_data);
+    meta->owned_data = nullptr;
+
+    meta->data = data;
+    meta->size = data ? size : 0;
+    meta->is_little_endian = is_little_endian;
+}
+
+
+gboolean tcam_chunk_data_meta_get_chunk(const TcamChunkDataMeta* meta,
+                                        guint index,
+                                        guint32* chunk_id,
+                                        const guint8** chunk_data,
+                                        gsize* chunk_size)
+{
+    if (!meta)
+    {
+        return FALSE;
+    }
+
+    guint current = 0;
+    bool found = false;
+    walk_chunks(*meta,
+                [&](guint32 id, const guint8* data, gsize size)
+                {
+                    if (current++ != index)
+                    {
+                        return true;
+                    }
+                    if (chunk_id)
+                    {
+                        *chunk_id = id;
+                    }
+                    if (chunk_data)
+                    {
+                        *chunk_data = data;
+                    }
+                    if (chunk_size)
+                    {
+                        *chunk_size = size;
+                    }
+                    found = true;
+                    return false;
+                });
+    return found;
+}
+
+
+gboolean tcam_chunk_data_meta_find_chunk(const TcamChunkDataMeta* meta,
+                                         guint32 chunk_id,
+                                         const guint8** chunk_data,
+                                         gsize* chunk_size)
+{
+    const guint8* data = nullptr;
+    gsize size = 0;
+    if (!meta || !find_chunk(*meta, chunk_id, data, size))
+    {
+        return FALSE;
+    }
+    if (chunk_data)
+    {
+        *chunk_data = data;
+    }
+    if (chunk_size)
+    {
+        *chunk_size = size;
+    }
+    return TRUE;
+}
+
+
+gboolean tcam_chunk_data_meta_read_uint(const TcamChunkDataMeta* meta,
+                                        guint32 chunk_id,
+                                        gsize offset,
+                                        gsize length,
+                                        gboolean is_little_endian,
+                                        guint64* value)
+{
+    if (!value || length == 0 || length > sizeof(guint64))
+    {
+        return FALSE;
+    }
+
+    const guint8* reg = find_register(meta, chunk_id, offset, length);
+    if (!reg)
+    {
+        return FALSE;
+    }
+
+    *value = read_uint(reg, length, is_little_endian);
+    return TRUE;
+}
+
+
+gboolean tcam_chunk_data_meta_read_float(const TcamChunkDataMeta* meta,
+                                         guint32 chunk_id,
+                                         gsize offset,
+                                         gsize length,
+                                         gboolean is_little_endian,
+                                         gdouble* value)
+{
+    if (!value || (length != sizeof(gfloat) && length != sizeof(gdouble)))
+    {
+        return FALSE;
+    }
+
+    const guint8* reg = find_register(meta, chunk_id, offset, length);
+    if (!reg)
+    {
+        return FALSE;
+    }
+
+    const guint64 bits = read_uint(reg, length, is_little_endian);
+    if (length == sizeof(gfloat))
+    {
+        const auto bits32 = static_cast<guint32>(bits);
+        gfloat tmp;
+        memcpy(&tmp, &bits32, sizeof(tmp));
+        *value = tmp;
+    }
+    else
+    {
+        memcpy(value, &bits, sizeof(*value));
+    }
+    return TRUE;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_META_TCAM_CHUNK_DATA_H
+#define GST_META_TCAM_CHUNK_DATA_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+/*
+ * GenICam chunk data of a frame, added by tcammainsrc when 'chunk-data' is set.
+ *
+ * The chunks are not copied or parsed when the frame arrives.
+ * data points to the memory the camera wrote, which the GstBuffer keeps alive
+ * until it is returned to the pool.
+ * Copies of the meta, e.g. through tcamconvert, copy all chunks except the image.
+ *
+ * Every chunk is followed by a trailer of two 32-bit values, the chunk id and the chunk length,
+ * so the chunks can only be found by walking the trailers from the end.
+ * This only happens when one of the functions below is called.
+ *
+ * The chunk id, the offset and the length of a value, e.g. ChunkExposureTime,
+ * come from the GenICam description of the camera:
+ * the ChunkID of the port and the Address/Length of the register.
+ */
+typedef struct _GstMetaTcamChunkData TcamChunkDataMeta;
+
+struct _GstMetaTcamChunkData
+{
+    GstMeta meta;
+
+    const guint8* data; // nullptr when the frame has no chunk data
+    gsize size;
+    gboolean is_little_endian; // byte order of the trailers; big endian for GigE Vision
+
+    guint8* owned_data; // set when data is a copy
+};
+
+GType tcam_chunk_data_meta_api_get_type(void);
+#define TCAM_CHUNK_DATA_META_API_TYPE (tcam_chunk_data_meta_api_get_type())
+
+#define gst_buffer_get_tcam_chunk_data_meta(b) \
+    ((TcamChunkDataMeta*)gst_buffer_get_meta((b), TCAM_CHUNK_DATA_META_API_TYPE))
+
+const GstMetaInfo* tcam_chunk_data_meta_get_info(void);
+#define TCAM_CHUNK_DATA_META_INFO (tcam_chunk_data_meta_get_info())
+
+// the returned meta references no data
+TcamChunkDataMeta* gst_buffer_add_tcam_chunk_data_meta(GstBuffer* buffer);
+
+/*
+ * References data without copying it, data has to stay valid as long as the meta uses it.
+ * Frees a previous copy.
+ */
+void tcam_chunk_data_meta_set_data(TcamChunkDataMeta* meta,
+                                   const guint8* data,
+                                   gsize size,
+                                   gboolean is_little_endian);
+
+/*
+ * Chunk at position index, 0 is the last chunk of the frame.
+ * FALSE when there are less chunks or the trailers are damaged.
+ */
+gboolean tcam_chunk_data_meta_get_chunk(const TcamChunkDataMeta* meta,
+                                        guint index,
+                                        guint32* chunk_id,
+                                        const guint8** chunk_data,
+                                        gsize* chunk_size);
+
+// first chunk with chunk_id, starting at the end of the frame
+gboolean tcam_chunk_data_meta_find_chunk(const TcamChunkDataMeta* meta,
+                                         guint32 chunk_id,
+                                         const guint8** chunk_data,
+                                         gsize* chunk_size);
+
+/*
+ * Reads an unsigned integer register of 1 to 8 bytes at offset within the chunk.
+ * The register byte order is given by the GenICam description, it is not the trailer byte order.
+ */
+gboolean tcam_chunk_data_meta_read_uint(const TcamChunkDataMeta* meta,
+                                        guint32 chunk_id,
+                                        gsize offset,
+                                        gsize length,
+                                        gboolean is_little_endian,
+                                        guint64* value);
+
+// float register of 4 or 8 bytes
+gboolean tcam_chunk_data_meta_read_float(const TcamChunkDataMeta* meta,
+                                         guint32 chunk_id,
+                                         gsize offset,
+                                         gsize length,
+                                         gboolean is_little_endian,
+                                         gdouble* value);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_META_TCAM_CHUNK_DATA_H */
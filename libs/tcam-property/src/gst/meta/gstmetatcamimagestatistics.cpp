@@ -0,0 +1,115 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gstmetatcamimagestatistics.h"
+
+#include <cstring>
+
+
+GType tcam_image_statistics_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = {"id", "val", NULL};
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamImageStatisticsMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_image_statistics_meta_init(GstMeta* meta,
+                                                gpointer /* params */,
+                                                GstBuffer* /* buffer */)
+{
+    tcam_image_statistics_meta_clear((TcamImageStatisticsMeta*)meta);
+
+    return TRUE;
+}
+
+
+static gboolean tcam_image_statistics_meta_transform(GstBuffer* trans_buffer,
+                                                     GstMeta* meta,
+                                                     GstBuffer* /* buffer */,
+                                                     GQuark type,
+                                                     gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamImageStatisticsMeta* tcam = (TcamImageStatisticsMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        // trans_buffer may already have one, e.g. when it is from the same pool
+        TcamImageStatisticsMeta* trans_tcam =
+            gst_buffer_get_tcam_image_statistics_meta(trans_buffer);
+        if (!trans_tcam)
+        {
+            trans_tcam = gst_buffer_add_tcam_image_statistics_meta(trans_buffer);
+        }
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        // everything behind the GstMeta header is plain data
+        memcpy((guint8*)trans_tcam + sizeof(GstMeta),
+               (const guint8*)tcam + sizeof(GstMeta),
+               sizeof(TcamImageStatisticsMeta) - sizeof(GstMeta));
+    }
+    return TRUE;
+}
+
+
+static void tcam_image_statistics_meta_free(GstMeta* /* meta */, GstBuffer* /* buffer */) {}
+
+
+const GstMetaInfo* tcam_image_statistics_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_IMAGE_STATISTICS_META_API_TYPE,
+                                                  "TcamImageStatisticsMeta",
+                                                  sizeof(TcamImageStatisticsMeta),
+                                                  tcam_image_statistics_meta_init,
+                                                  tcam_image_statistics_meta_free,
+                                                  tcam_image_statistics_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamImageStatisticsMeta* gst_buffer_add_tcam_image_statistics_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamImageStatisticsMeta*)gst_buffer_add_meta(
+        buffer, TCAM_IMAGE_STATISTICS_META_INFO, nullptr);
+}
+
+
+void tcam_image_statistics_meta_clear(TcamImageStatisticsMeta* meta)
+{
+    g_return_if_fail(meta);
+
+    memset((guint8*)meta + sizeof(GstMeta), 0, sizeof(TcamImageStatisticsMeta) - sizeof(GstMeta));
+}
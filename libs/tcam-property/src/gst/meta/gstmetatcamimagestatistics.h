@@ -0,0 +1,83 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_META_TCAM_IMAGE_STATISTICS_H
+#define GST_META_TCAM_IMAGE_STATISTICS_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+/*
+ * What the software auto functions sampled of an image, added by tcammainsrc when
+ * 'image-statistics' is set. The auto functions only run every few frames and only while
+ * one of them is enabled, frame_count tells which frame the values describe.
+ * Values are in [0;1], taken after the software color matrix and whitebalance.
+ */
+typedef struct _GstMetaTcamImageStatistics TcamImageStatisticsMeta;
+
+struct _GstMetaTcamImageStatistics
+{
+    GstMeta meta;
+
+    gboolean valid; // FALSE until the auto functions sampled an image of the stream
+    guint64 frame_count; // of the sampled frame
+
+    gfloat brightness; // mean luminance
+    gfloat saturated_fraction; // fraction of the samples with a luminance >= 240 / 255
+
+    gfloat mean_r;
+    gfloat mean_g;
+    gfloat mean_b;
+    guint sample_count;
+
+    // luminance, 8-bit bayer only, see 'image-statistics-histogram'
+    guint histogram[256];
+    guint histogram_count; // 0 when there is no histogram
+};
+
+GType tcam_image_statistics_meta_api_get_type(void);
+#define TCAM_IMAGE_STATISTICS_META_API_TYPE (tcam_image_statistics_meta_api_get_type())
+
+#define gst_buffer_get_tcam_image_statistics_meta(b) \
+    ((TcamImageStatisticsMeta*)gst_buffer_get_meta((b), TCAM_IMAGE_STATISTICS_META_API_TYPE))
+
+const GstMetaInfo* tcam_image_statistics_meta_get_info(void);
+#define TCAM_IMAGE_STATISTICS_META_INFO (tcam_image_statistics_meta_get_info())
+
+// the returned meta is not valid
+TcamImageStatisticsMeta* gst_buffer_add_tcam_image_statistics_meta(GstBuffer* buffer);
+
+// marks the meta as not valid
+void tcam_image_statistics_meta_clear(TcamImageStatisticsMeta* meta);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_META_TCAM_IMAGE_STATISTICS_H */
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gstmetatcammissinglines.h"
+
+#include <cstring>
+
+namespace
+{
+bool is_missing(const TcamMissingLinesMeta& meta, guint line)
+{
+    return (meta.bitmap[line / 8] & (1u << (line % 8))) != 0;
+}
+
+guint count_bits(const guint8* bitmap, guint line_count)
+{
+    guint count = 0;
+    for (guint line = 0; line < line_count; ++line)
+    {
+        if ((bitmap[line / 8] & (1u << (line % 8))) != 0)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+} // namespace
+
+
+GType tcam_missing_lines_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = {"id", "val", NULL};
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamMissingLinesMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_missing_lines_meta_init(GstMeta* meta,
+                                             gpointer /* params */,
+                                             GstBuffer* /* buffer */)
+{
+    TcamMissingLinesMeta* tcam = (TcamMissingLinesMeta*)meta;
+
+    tcam->bitmap = nullptr;
+    tcam->line_count = 0;
+    tcam->missing_count = 0;
+    tcam->concealed_count = 0;
+    tcam->capacity = 0;
+
+    return TRUE;
+}
+
+
+static gboolean tcam_missing_lines_meta_transform(GstBuffer* trans_buffer,
+                                                  GstMeta* meta,
+                                                  GstBuffer* /* buffer */,
+                                                  GQuark type,
+                                                  gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamMissingLinesMeta* tcam = (TcamMissingLinesMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        // trans_buffer may already have one, e.g. when it is from the same pool
+        TcamMissingLinesMeta* trans_tcam = gst_buffer_get_tcam_missing_lines_meta(trans_buffer);
+        if (!trans_tcam)
+        {
+            trans_tcam = gst_buffer_add_tcam_missing_lines_meta(trans_buffer);
+        }
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        tcam_missing_lines_meta_set(trans_tcam,
+                                    tcam->bitmap,
+                                    tcam->bitmap ? (tcam->line_count + 7) / 8 : 0,
+                                    tcam->line_count,
+                                    tcam->concealed_count);
+    }
+    return TRUE;
+}
+
+
+static void tcam_missing_lines_meta_free(GstMeta* meta, GstBuffer* /* buffer */)
+{
+    TcamMissingLinesMeta* tcam = (TcamMissingLinesMeta*)meta;
+
+    g_free(tcam->bitmap);
+    tcam->bitmap = nullptr;
+    tcam->capacity = 0;
+}
+
+
+const GstMetaInfo* tcam_missing_lines_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_MISSING_LINES_META_API_TYPE,
+                                                  "TcamMissingLinesMeta",
+                                                  sizeof(TcamMissingLinesMeta),
+                                                  tcam_missing_lines_meta_init,
+                                                  tcam_missing_lines_meta_free,
+                                                  tcam_missing_lines_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamMissingLinesMeta* gst_buffer_add_tcam_missing_lines_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamMissingLinesMeta*)gst_buffer_add_meta(
+        buffer, TCAM_MISSING_LINES_META_INFO, nullptr);
+}
+
+
+void tcam_missing_lines_meta_set(TcamMissingLinesMeta* meta,
+                                 const guint8* bitmap,
+                                 gsize size,
+                                 guint line_count,
+                                 guint concealed_count)
+{
+    g_return_if_fail(meta);
+
+    // the previous bitmap is kept, it is reused by the next incomplete frame
+    if (!bitmap || size == 0 || line_count == 0)
+    {
+        if (meta->bitmap)
+        {
+            memset(meta->bitmap, 0, meta->capacity);
+        }
+        meta->line_count = 0;
+        meta->missing_count = 0;
+        meta->concealed_count = 0;
+        return;
+    }
+
+    line_count = MIN(line_count, (guint)(size * 8));
+    const gsize needed = (line_count + 7) / 8;
+    if (meta->capacity < needed)
+    {
+        g_free(meta->bitmap);
+        meta->bitmap = (guint8*)g_malloc(needed);
+        meta->capacity = needed;
+    }
+    memcpy(meta->bitmap, bitmap, needed);
+
+    meta->line_count = line_count;
+    meta->missing_count = count_bits(meta->bitmap, line_count);
+    meta->concealed_count = concealed_count;
+}
+
+
+gboolean tcam_missing_lines_meta_is_line_missing(const TcamMissingLinesMeta* meta, guint line)
+{
+    if (!meta || !meta->bitmap || line >= meta->line_count)
+    {
+        return FALSE;
+    }
+    return is_missing(*meta, line);
+}
+
+
+gboolean tcam_missing_lines_meta_get_range(const TcamMissingLinesMeta* meta,
+                                           guint index,
+                                           guint* first_line,
+                                           guint* line_count)
+{
+    if (!meta || !meta->bitmap || meta->missing_count == 0)
+    {
+        return FALSE;
+    }
+
+    guint current = 0;
+    guint line = 0;
+    while (line < meta->line_count)
+    {
+        if (!is_missing(*meta, line))
+        {
+            ++line;
+            continue;
+        }
+
+        guint end = line;
+        while (end < meta->line_count && is_missing(*meta, end)) { ++end; }
+
+        if (current++ == index)
+        {
+            if (first_line)
+            {
+                *first_line = line;
+            }
+            if (line_count)
+            {
+                *line_count = end - line;
+            }
+            return TRUE;
+        }
+        line = end;
+    }
+    return FALSE;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_META_TCAM_MISSING_LINES_H
+#define GST_META_TCAM_MISSING_LINES_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+/*
+ * Lines of an incomplete frame that did not arrive, added by tcammainsrc when 'missing-lines' is set.
+ * Only GigE cameras report them, and only frames that are delivered despite missing packets.
+ *
+ * The lines are found with packet granularity, a missing packet may mark one line
+ * more than it actually covered.
+ * Lines that tcammainsrc filled with nearby lines, see 'conceal-max-lines', stay marked.
+ */
+typedef struct _GstMetaTcamMissingLines TcamMissingLinesMeta;
+
+struct _GstMetaTcamMissingLines
+{
+    GstMeta meta;
+
+    // one bit per line, the lsb of bitmap[0] is line 0
+    guint8* bitmap;
+    guint line_count; // lines described by bitmap, 0 when the frame is complete
+    guint missing_count; // set bits in bitmap
+    guint concealed_count; // missing lines that were filled with nearby lines
+
+    gsize capacity; // allocated size of bitmap
+};
+
+GType tcam_missing_lines_meta_api_get_type(void);
+#define TCAM_MISSING_LINES_META_API_TYPE (tcam_missing_lines_meta_api_get_type())
+
+#define gst_buffer_get_tcam_missing_lines_meta(b) \
+    ((TcamMissingLinesMeta*)gst_buffer_get_meta((b), TCAM_MISSING_LINES_META_API_TYPE))
+
+const GstMetaInfo* tcam_missing_lines_meta_get_info(void);
+#define TCAM_MISSING_LINES_META_INFO (tcam_missing_lines_meta_get_info())
+
+// the returned meta describes a complete frame
+TcamMissingLinesMeta* gst_buffer_add_tcam_missing_lines_meta(GstBuffer* buffer);
+
+/*
+ * Copies bitmap, the memory of the meta is reused.
+ * bitmap == nullptr or size == 0 marks the frame as complete.
+ */
+void tcam_missing_lines_meta_set(TcamMissingLinesMeta* meta,
+                                 const guint8* bitmap,
+                                 gsize size,
+                                 guint line_count,
+                                 guint concealed_count);
+
+gboolean tcam_missing_lines_meta_is_line_missing(const TcamMissingLinesMeta* meta, guint line);
+
+/*
+ * Range of consecutive missing lines at position index, 0 is the top most range.
+ * FALSE when there are less ranges.
+ */
+gboolean tcam_missing_lines_meta_get_range(const TcamMissingLinesMeta* meta,
+                                           guint index,
+                                           guint* first_line,
+                                           guint* line_count);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_META_TCAM_MISSING_LINES_H */
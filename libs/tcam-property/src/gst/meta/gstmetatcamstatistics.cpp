@@ -152,3 +152,113 @@ gboolean tcam_statistics_get_structure(TcamStatisticsMeta* meta, char* out_buffe
 
     return TRUE;
 }
+
+
+GType tcam_statistics_values_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = {"id", "val", NULL};
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamStatisticsValuesMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_statistics_values_meta_init(GstMeta* meta,
+                                                 gpointer /* params */,
+                                                 GstBuffer* /* buffer */)
+{
+    TcamStatisticsValuesMeta* tcam = (TcamStatisticsValuesMeta*)meta;
+
+    memset(&tcam->values, 0, sizeof(tcam->values));
+
+    return TRUE;
+}
+
+
+static gboolean tcam_statistics_values_meta_transform(GstBuffer* trans_buffer,
+                                                      GstMeta* meta,
+                                                      GstBuffer* /* buffer */,
+                                                      GQuark type,
+                                                      gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamStatisticsValuesMeta* tcam = (TcamStatisticsValuesMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        // trans_buffer may already have one, e.g. when it is from the same pool
+        TcamStatisticsValuesMeta* trans_tcam = gst_buffer_get_tcam_statistics_values_meta(trans_buffer);
+        if (!trans_tcam)
+        {
+            trans_tcam = gst_buffer_add_tcam_statistics_values_meta(trans_buffer);
+            if (trans_tcam)
+            {
+                // stays when trans_buffer returns to its pool, so the next copy reuses it
+                // instead of adding a new meta for every frame
+                GST_META_FLAG_SET(trans_tcam, GST_META_FLAG_POOLED);
+            }
+        }
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        trans_tcam->values = tcam->values;
+    }
+    return TRUE;
+}
+
+
+static void tcam_statistics_values_meta_free(GstMeta* /* meta */, GstBuffer* /* buffer */)
+{
+    // no owned memory
+}
+
+
+const GstMetaInfo* tcam_statistics_values_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_STATISTICS_VALUES_META_API_TYPE,
+                                                  "TcamStatisticsValuesMeta",
+                                                  sizeof(TcamStatisticsValuesMeta),
+                                                  tcam_statistics_values_meta_init,
+                                                  tcam_statistics_values_meta_free,
+                                                  tcam_statistics_values_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamStatisticsValuesMeta* gst_buffer_add_tcam_statistics_values_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamStatisticsValuesMeta*)gst_buffer_add_meta(
+        buffer, TCAM_STATISTICS_VALUES_META_INFO, nullptr);
+}
+
+
+gboolean tcam_statistics_values_meta_get_values(const TcamStatisticsValuesMeta* meta,
+                                                TcamStatisticsValues* out_values,
+                                                size_t out_values_size)
+{
+    if (!meta || !out_values)
+    {
+        return FALSE;
+    }
+
+    memcpy(out_values, &meta->values, MIN(out_values_size, sizeof(meta->values)));
+
+    return TRUE;
+}
@@ -57,6 +57,85 @@ TcamStatisticsMeta* gst_buffer_add_tcam_statistics_meta(GstBuffer* buffer,
 
 gboolean tcam_statistics_get_structure(TcamStatisticsMeta*, char* out_buffer, size_t out_buffer_size);
 
+
+/*
+ * Binary form of the statistics.
+ * tcammainsrc always adds this meta, the GstStructure form above is only added
+ * when the tcammainsrc property 'statistics-structure' is set.
+ * The layout is fixed, new fields are only appended.
+ */
+typedef struct _TcamStatisticsValues
+{
+    guint64 frame_count; // current frame number
+    guint64 frames_dropped; // number of frames that where not delivered
+    guint64 capture_time_ns; // capture time reported by lib
+    guint64 camera_time_ns; // capture time reported by camera; 0 if not supported
+    gboolean is_damaged; // the buffer had lost packages or other problems
+
+    // CLOCK_MONOTONIC stamps, 0 unless TCAM_LATENCY_TRACING is set
+    guint64 dequeue_time_ns;
+    guint64 auto_pass_begin_ns;
+    guint64 auto_pass_end_ns;
+    guint64 sink_push_time_ns;
+    guint64 gst_push_time_ns;
+    guint64 tcamconvert_begin_ns;
+    guint64 tcamconvert_end_ns;
+
+    // transport counters since stream start, 0 unless the device is a GigE camera
+    guint64 completed_buffers;
+    guint64 failed_buffers; // timed out or missing packets
+    guint64 underruns; // no buffer was queued when a frame arrived
+    guint64 resent_packets;
+    guint64 missing_packets; // not received, even after resends
+
+    // point in time capture_time_ns refers to
+    // 0 unknown, 1 end of frame, 2 start of exposure, 3 start of frame, 4 system time at dequeue
+    guint32 timestamp_source;
+
+    // frames_dropped split by cause, the sum can be below frames_dropped
+    guint64 dropped_no_buffer; // no buffer was queued, the consumer returned them too late
+    guint64 dropped_transport; // lost on the way, e.g. a sequence gap while buffers were queued
+    guint64 dropped_incomplete; // incomplete frames that were dropped
+
+    // id of the last scheduled property write executed before the frame was received, 0 if none
+    guint64 settings_id;
+
+    // sensor position of the first pixel, only valid when has_roi_origin is set
+    gboolean has_roi_origin;
+    gint32 roi_origin_x;
+    gint32 roi_origin_y;
+} TcamStatisticsValues;
+
+typedef struct _GstMetaTcamStatisticsValues TcamStatisticsValuesMeta;
+
+struct _GstMetaTcamStatisticsValues
+{
+    GstMeta meta;
+
+    TcamStatisticsValues values;
+};
+
+GType tcam_statistics_values_meta_api_get_type(void);
+#define TCAM_STATISTICS_VALUES_META_API_TYPE (tcam_statistics_values_meta_api_get_type())
+
+#define gst_buffer_get_tcam_statistics_values_meta(b) \
+    ((TcamStatisticsValuesMeta*)gst_buffer_get_meta((b), TCAM_STATISTICS_VALUES_META_API_TYPE))
+
+const GstMetaInfo* tcam_statistics_values_meta_get_info(void);
+#define TCAM_STATISTICS_VALUES_META_INFO (tcam_statistics_values_meta_get_info())
+
+// the values of the returned meta are zeroed
+TcamStatisticsValuesMeta* gst_buffer_add_tcam_statistics_values_meta(GstBuffer* buffer);
+
+/*
+ * Copies at most out_values_size bytes of the values,
+ * pass sizeof(TcamStatisticsValues) so that older consumers keep working when fields are appended.
+ * For bindings that cannot use gst_buffer_get_tcam_statistics_values_meta, e.g. python ctypes.
+ */
+gboolean tcam_statistics_values_meta_get_values(const TcamStatisticsValuesMeta* meta,
+                                                TcamStatisticsValues* out_values,
+                                                size_t out_values_size);
+
 G_END_DECLS
 
 #if __cplusplus
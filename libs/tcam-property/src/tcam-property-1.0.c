@@ -1053,4 +1053,184 @@ const gchar* tcam_property_provider_get_tcam_enumeration( TcamPropertyProvider*
         rval = iface->get_tcam_enumeration( self, name, err );
     }
     return rval;
-}
\ No newline at end of file
+}
+static GType tcam_property_value_type( TcamPropertyType type )
+{
+    switch( type )
+    {
+    case TCAM_PROPERTY_TYPE_BOOLEAN:        return G_TYPE_BOOLEAN;
+    case TCAM_PROPERTY_TYPE_INTEGER:        return G_TYPE_INT64;
+    case TCAM_PROPERTY_TYPE_FLOAT:          return G_TYPE_DOUBLE;
+    case TCAM_PROPERTY_TYPE_ENUMERATION:    return G_TYPE_STRING;
+    case TCAM_PROPERTY_TYPE_STRING:         return G_TYPE_STRING;
+    case TCAM_PROPERTY_TYPE_COMMAND:        break;
+    }
+    return G_TYPE_INVALID;
+}
+
+static gboolean tcam_property_get_value_generic( TcamPropertyBase* prop, GValue* value, GError** err )
+{
+    GType value_type = tcam_property_value_type( tcam_property_base_get_property_type( prop ) );
+    if( value_type == G_TYPE_INVALID )
+    {
+        g_set_error( err, tcam_error_quark(), TCAM_ERROR_PROPERTY_TYPE_INCOMPATIBLE, "Error: %s has no value", tcam_property_base_get_name( prop ) );
+        return FALSE;
+    }
+    if( G_VALUE_TYPE( value ) == G_TYPE_INVALID )
+    {
+        g_value_init( value, value_type );
+    }
+    else if( G_VALUE_TYPE( value ) != value_type )
+    {
+        g_set_error( err, tcam_error_quark(), TCAM_ERROR_PROPERTY_TYPE_INCOMPATIBLE, "Error: GValue for %s holds the wrong type", tcam_property_base_get_name( prop ) );
+        return FALSE;
+    }
+
+    GError* local_err = NULL;
+    switch( tcam_property_base_get_property_type( prop ) )
+    {
+    case TCAM_PROPERTY_TYPE_BOOLEAN:
+        g_value_set_boolean( value, tcam_property_boolean_get_value( TCAM_PROPERTY_BOOLEAN( prop ), &local_err ) );
+        break;
+    case TCAM_PROPERTY_TYPE_INTEGER:
+        g_value_set_int64( value, tcam_property_integer_get_value( TCAM_PROPERTY_INTEGER( prop ), &local_err ) );
+        break;
+    case TCAM_PROPERTY_TYPE_FLOAT:
+        g_value_set_double( value, tcam_property_float_get_value( TCAM_PROPERTY_FLOAT( prop ), &local_err ) );
+        break;
+    case TCAM_PROPERTY_TYPE_ENUMERATION:
+        g_value_set_string( value, tcam_property_enumeration_get_value( TCAM_PROPERTY_ENUMERATION( prop ), &local_err ) );
+        break;
+    case TCAM_PROPERTY_TYPE_STRING:
+        g_value_take_string( value, tcam_property_string_get_value( TCAM_PROPERTY_STRING( prop ), &local_err ) );
+        break;
+    case TCAM_PROPERTY_TYPE_COMMAND:
+        break;
+    }
+    if( local_err )
+    {
+        g_propagate_error( err, local_err );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean tcam_property_set_value_generic( TcamPropertyBase* prop, const GValue* value, GError** err )
+{
+    TcamPropertyType type = tcam_property_base_get_property_type( prop );
+    if( type != TCAM_PROPERTY_TYPE_COMMAND && G_VALUE_TYPE( value ) != tcam_property_value_type( type ) )
+    {
+        g_set_error( err, tcam_error_quark(), TCAM_ERROR_PROPERTY_TYPE_INCOMPATIBLE, "Error: GValue for %s holds the wrong type", tcam_property_base_get_name( prop ) );
+        return FALSE;
+    }
+
+    GError* local_err = NULL;
+    switch( type )
+    {
+    case TCAM_PROPERTY_TYPE_BOOLEAN:
+        tcam_property_boolean_set_value( TCAM_PROPERTY_BOOLEAN( prop ), g_value_get_boolean( value ), &local_err );
+        break;
+    case TCAM_PROPERTY_TYPE_INTEGER:
+        tcam_property_integer_set_value( TCAM_PROPERTY_INTEGER( prop ), g_value_get_int64( value ), &local_err );
+        break;
+    case TCAM_PROPERTY_TYPE_FLOAT:
+        tcam_property_float_set_value( TCAM_PROPERTY_FLOAT( prop ), g_value_get_double( value ), &local_err );
+        break;
+    case TCAM_PROPERTY_TYPE_ENUMERATION:
+        tcam_property_enumeration_set_value( TCAM_PROPERTY_ENUMERATION( prop ), g_value_get_string( value ), &local_err );
+        break;
+    case TCAM_PROPERTY_TYPE_STRING:
+        tcam_property_string_set_value( TCAM_PROPERTY_STRING( prop ), g_value_get_string( value ), &local_err );
+        break;
+    case TCAM_PROPERTY_TYPE_COMMAND:
+        tcam_property_command_set_command( TCAM_PROPERTY_COMMAND( prop ), &local_err );
+        break;
+    }
+    if( local_err )
+    {
+        g_propagate_error( err, local_err );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * tcam_property_provider_get_tcam_values:
+ * @self: a #TcamPropertyProvider
+ * @properties: (array length=count): properties previously retrieved from @self via tcam_property_provider_get_tcam_property
+ * @count: number of entries in @properties and @values
+ * @values: (array length=count): one #GValue per property
+ * @err: return location for a GError, or NULL
+ *
+ * Reads the values of several properties in one call.
+ * Uninitialized entries of @values are initialized to the type of the property,
+ * boolean as G_TYPE_BOOLEAN, integer as G_TYPE_INT64, float as G_TYPE_DOUBLE and enumeration and string as G_TYPE_STRING.
+ * Initialized entries must hold that type, so the same array can be passed again on every poll.
+ * Command properties have no value and fail.
+ *
+ * Stops at the first property that fails, the values before it are valid.
+ *
+ * Returns: TRUE if all values were read.
+ */
+gboolean    tcam_property_provider_get_tcam_values( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, GValue* values, GError** err )
+{
+    g_return_val_if_fail( self != NULL, FALSE );
+    g_return_val_if_fail( properties != NULL || count == 0, FALSE );
+    g_return_val_if_fail( values != NULL || count == 0, FALSE );
+    g_return_val_if_fail( err == NULL || *err == NULL, FALSE );
+    g_return_val_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ), FALSE );
+
+    TcamPropertyProviderInterface* iface = TCAM_PROPERTY_PROVIDER_GET_IFACE( self );
+    if( iface->get_tcam_values )
+    {
+        return iface->get_tcam_values( self, properties, count, values, err );
+    }
+
+    for( guint i = 0; i < count; ++i )
+    {
+        if( !tcam_property_get_value_generic( properties[i], &values[i], err ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * tcam_property_provider_set_tcam_values:
+ * @self: a #TcamPropertyProvider
+ * @properties: (array length=count): properties previously retrieved from @self via tcam_property_provider_get_tcam_property
+ * @count: number of entries in @properties and @values
+ * @values: (array length=count): one #GValue per property, with the types described in tcam_property_provider_get_tcam_values
+ * @err: return location for a GError, or NULL
+ *
+ * Sets the values of several properties in one call, in the order they are given.
+ * The value of command properties is ignored, they are executed.
+ *
+ * Stops at the first property that fails, the properties before it have been set.
+ *
+ * Returns: TRUE if all values were set.
+ */
+gboolean    tcam_property_provider_set_tcam_values( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, const GValue* values, GError** err )
+{
+    g_return_val_if_fail( self != NULL, FALSE );
+    g_return_val_if_fail( properties != NULL || count == 0, FALSE );
+    g_return_val_if_fail( values != NULL || count == 0, FALSE );
+    g_return_val_if_fail( err == NULL || *err == NULL, FALSE );
+    g_return_val_if_fail( TCAM_IS_PROPERTY_PROVIDER( self ), FALSE );
+
+    TcamPropertyProviderInterface* iface = TCAM_PROPERTY_PROVIDER_GET_IFACE( self );
+    if( iface->set_tcam_values )
+    {
+        return iface->set_tcam_values( self, properties, count, values, err );
+    }
+
+    for( guint i = 0; i < count; ++i )
+    {
+        if( !tcam_property_set_value_generic( properties[i], &values[i], err ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
@@ -82,6 +82,9 @@ gint64          tcam_property_provider_get_tcam_integer( TcamPropertyProvider* s
 gdouble         tcam_property_provider_get_tcam_float( TcamPropertyProvider* self, const gchar* name, GError** err );
 const gchar*    tcam_property_provider_get_tcam_enumeration( TcamPropertyProvider* self, const gchar* name, GError** err );
 
+gboolean        tcam_property_provider_get_tcam_values( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, GValue* values, GError** err );
+gboolean        tcam_property_provider_set_tcam_values( TcamPropertyProvider* self, TcamPropertyBase** properties, guint count, const GValue* values, GError** err );
+
 G_END_DECLS
 
 #endif /* TCAMPROP_1_0_IMPL_H */
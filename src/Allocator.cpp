@@ -15,7 +15,17 @@
  */
 
 #include "Allocator.h"
+
+#include "logging.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace
 {
@@ -34,7 +44,13 @@ namespace
         {
             return nullptr;
         }
-        return malloc(length);
+        // malloc only guarantees 16 bytes, large blocks are mmapped and start 16 bytes into a page
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, tcam::default_buffer_alignment, length) != 0)
+        {
+            return nullptr;
+        }
+        return ptr;
     }
 
     void free(tcam::TCAM_MEMORY_TYPE, void* ptr, size_t, int /*fd*/) final
@@ -57,6 +73,252 @@ namespace
     }
     };
 
+
+constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+// from <numaif.h>, which would require libnuma
+constexpr int mpol_bind = 2;
+
+
+struct PageAllocator : public tcam::AllocatorInterface,
+                       public std::enable_shared_from_this<PageAllocator>
+{
+    explicit PageAllocator(const tcam::allocator_options& opt) : options_(opt)
+    {
+        options_.prefault = options_.prefault || options_.use_huge_pages;
+    }
+
+    std::vector<tcam::TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { tcam::TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(tcam::TCAM_MEMORY_TYPE t, size_t length, int /*fd*/) final
+    {
+        if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+        {
+            return nullptr;
+        }
+
+        const size_t mapped_length = mapping_length(length);
+
+        void* ptr = MAP_FAILED;
+
+        if (options_.use_huge_pages)
+        {
+            ptr = mmap(nullptr,
+                       mapped_length,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                       -1,
+                       0);
+            if (ptr == MAP_FAILED)
+            {
+                SPDLOG_DEBUG("No hugetlb pages available ({}). Using transparent huge pages.",
+                             strerror(errno));
+            }
+        }
+
+        if (ptr == MAP_FAILED)
+        {
+            ptr = mmap(nullptr,
+                       mapped_length,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1,
+                       0);
+            if (ptr == MAP_FAILED)
+            {
+                SPDLOG_ERROR("mmap failed ({}): {}", errno, strerror(errno));
+                return nullptr;
+            }
+            if (options_.use_huge_pages)
+            {
+                madvise(ptr, mapped_length, MADV_HUGEPAGE);
+            }
+        }
+
+        // binding has to happen before the first touch
+        if (options_.numa_node >= 0)
+        {
+            bind_to_node(ptr, mapped_length);
+        }
+
+        if (options_.prefault)
+        {
+            prefault(ptr, mapped_length);
+        }
+
+        return ptr;
+    }
+
+    void free(tcam::TCAM_MEMORY_TYPE, void* ptr, size_t length, int /*fd*/) final
+    {
+        if (!ptr)
+        {
+            return;
+        }
+
+        const size_t mapped_length = mapping_length(length);
+
+        if (options_.prefault)
+        {
+            munlock(ptr, mapped_length);
+        }
+        if (munmap(ptr, mapped_length) == -1)
+        {
+            SPDLOG_ERROR("munmap failed ({}): {}", errno, strerror(errno));
+        }
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> allocate(size_t buffer_count,
+                                                        tcam::TCAM_MEMORY_TYPE t,
+                                                        size_t length,
+                                                        int /*fd*/) final
+    {
+        if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+        {
+            return {};
+        }
+
+        std::vector<std::shared_ptr<tcam::Memory>> buffer;
+        buffer.reserve(buffer_count);
+        for (unsigned int i = 0; i < buffer_count; ++i)
+        {
+            try
+            {
+                buffer.push_back(std::make_shared<tcam::Memory>(
+                    shared_from_this(), tcam::TCAM_MEMORY_TYPE_USERPTR, length));
+            }
+            catch (const std::runtime_error& e)
+            {
+                SPDLOG_ERROR("Unable to allocate buffer {}: {}", i, e.what());
+                break;
+            }
+        }
+        return buffer;
+    }
+
+private:
+    tcam::allocator_options options_;
+
+    size_t mapping_length(size_t length) const
+    {
+        // free has to be able to reconstruct the size
+        // always round to the huge page size, even when falling back to THP
+        const size_t page = options_.use_huge_pages ? huge_page_size : (size_t)sysconf(_SC_PAGESIZE);
+
+        return ((length + page - 1) / page) * page;
+    }
+
+    void bind_to_node(void* ptr, size_t length) const
+    {
+        unsigned long nodemask = 1UL << options_.numa_node;
+
+        if (options_.numa_node >= (int)(sizeof(nodemask) * 8)
+            || syscall(SYS_mbind, ptr, length, mpol_bind, &nodemask, sizeof(nodemask) * 8, 0) != 0)
+        {
+            SPDLOG_WARN("Unable to bind buffer to numa node {}: {}", options_.numa_node, strerror(errno));
+        }
+    }
+
+    static void prefault(void* ptr, size_t length)
+    {
+        if (mlock(ptr, length) != 0)
+        {
+            // RLIMIT_MEMLOCK is commonly too small, touch the pages instead
+            SPDLOG_DEBUG("mlock failed ({}). Touching pages instead.", strerror(errno));
+
+            const size_t page = sysconf(_SC_PAGESIZE);
+            auto p = static_cast<volatile char*>(ptr);
+            for (size_t offset = 0; offset < length; offset += page) { p[offset] = 0; }
+        }
+    }
+};
+
+
+struct UserAllocator : public tcam::AllocatorInterface,
+                       public std::enable_shared_from_this<UserAllocator>
+{
+    explicit UserAllocator(tcam::user_allocator_callbacks cb) : callbacks_(std::move(cb)) {}
+
+    ~UserAllocator()
+    {
+        // every Memory holds a reference, nothing is allocated anymore
+        if (callbacks_.release)
+        {
+            callbacks_.release();
+        }
+    }
+
+    std::vector<tcam::TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { tcam::TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(tcam::TCAM_MEMORY_TYPE t, size_t length, int /*fd*/) final
+    {
+        if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+        {
+            return nullptr;
+        }
+
+        void* ptr = callbacks_.allocate(length);
+        if (!ptr)
+        {
+            SPDLOG_ERROR("User allocator was unable to provide {} bytes", length);
+        }
+        else if (reinterpret_cast<uintptr_t>(ptr) % tcam::default_buffer_alignment != 0)
+        {
+            // the image kernels depend on it
+            SPDLOG_ERROR("User allocator returned memory that is not {} byte aligned",
+                         tcam::default_buffer_alignment);
+            callbacks_.free(ptr, length);
+            return nullptr;
+        }
+        return ptr;
+    }
+
+    void free(tcam::TCAM_MEMORY_TYPE, void* ptr, size_t length, int /*fd*/) final
+    {
+        if (ptr)
+        {
+            callbacks_.free(ptr, length);
+        }
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> allocate(size_t buffer_count,
+                                                        tcam::TCAM_MEMORY_TYPE t,
+                                                        size_t length,
+                                                        int /*fd*/) final
+    {
+        if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+        {
+            return {};
+        }
+
+        std::vector<std::shared_ptr<tcam::Memory>> buffer;
+        buffer.reserve(buffer_count);
+        for (unsigned int i = 0; i < buffer_count; ++i)
+        {
+            try
+            {
+                buffer.push_back(std::make_shared<tcam::Memory>(
+                    shared_from_this(), tcam::TCAM_MEMORY_TYPE_USERPTR, length));
+            }
+            catch (const std::runtime_error& e)
+            {
+                SPDLOG_ERROR("Unable to allocate buffer {}: {}", i, e.what());
+                break;
+            }
+        }
+        return buffer;
+    }
+
+private:
+    tcam::user_allocator_callbacks callbacks_;
+};
+
 } // namespace
 
 std::shared_ptr<tcam::AllocatorInterface> tcam::get_default_allocator()
@@ -64,3 +326,20 @@ std::shared_ptr<tcam::AllocatorInterface> tcam::get_default_allocator()
     return std::make_shared<DefaultAllocator>();
 
 }
+
+
+std::shared_ptr<tcam::AllocatorInterface> tcam::get_page_allocator(const allocator_options& options)
+{
+    return std::make_shared<PageAllocator>(options);
+}
+
+
+std::shared_ptr<tcam::AllocatorInterface> tcam::get_user_allocator(
+    user_allocator_callbacks callbacks)
+{
+    if (!callbacks.allocate || !callbacks.free)
+    {
+        return nullptr;
+    }
+    return std::make_shared<UserAllocator>(std::move(callbacks));
+}
@@ -23,6 +23,7 @@
 #include <vector>
 #include <cstdio> // size_t
 #include <algorithm>
+#include <functional>
 #include <memory>
 
 
@@ -45,6 +46,41 @@ public:
 
 };
 
+// userptr memory of the default allocator starts at a multiple of this,
+// the cache line size and the width of an AVX-512 register.
+// Image kernels may use aligned loads/stores for the first line.
+constexpr size_t default_buffer_alignment = 64;
+
 std::shared_ptr<AllocatorInterface> get_default_allocator();
 
+
+struct allocator_options
+{
+    // back buffers with 2 MiB huge pages
+    // falls back to transparent huge pages when no hugetlb pages are reserved
+    bool use_huge_pages = false;
+    // fault in all pages on allocation and lock them into RAM
+    bool prefault = false;
+    // bind buffers to this numa node, -1 lets the kernel decide
+    int numa_node = -1;
+};
+
+// page aligned userptr allocator
+// intended for high bandwidth streams where TLB misses
+// and first touch page faults are noticeable
+// use_huge_pages implies prefault
+std::shared_ptr<AllocatorInterface> get_page_allocator(const allocator_options& options);
+
+
+// userptr memory provided by the application, e.g. pinned memory of a gpu api
+struct user_allocator_callbacks
+{
+    std::function<void*(size_t)> allocate;
+    std::function<void(void*, size_t)> free;
+    // called once the allocator and all of its memory are gone, may be empty
+    std::function<void()> release;
+};
+
+std::shared_ptr<AllocatorInterface> get_user_allocator(user_allocator_callbacks callbacks);
+
 } // namespace tcam
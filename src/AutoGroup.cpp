@@ -0,0 +1,38 @@
+#include "AutoGroup.h"
+
+using namespace tcam;
+
+
+std::shared_ptr<AutoGroup> AutoGroup::get(const std::string& name)
+{
+    static std::mutex instance_mtx;
+    static std::map<std::string, std::weak_ptr<AutoGroup>> instances;
+
+    std::scoped_lock lock(instance_mtx);
+
+    auto& entry = instances[name];
+    auto obj = entry.lock();
+    if (!obj)
+    {
+        obj = std::shared_ptr<AutoGroup>(new AutoGroup());
+        entry = obj;
+    }
+    return obj;
+}
+
+
+void AutoGroup::publish(const values& v)
+{
+    std::scoped_lock lock(mtx_);
+
+    const auto seq = values_.seq + 1;
+    values_ = v;
+    values_.seq = seq;
+}
+
+
+AutoGroup::values AutoGroup::get_values() const
+{
+    std::scoped_lock lock(mtx_);
+    return values_;
+}
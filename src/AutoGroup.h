@@ -0,0 +1,60 @@
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+// Cameras of a rig that share the results of one auto pass.
+//
+// The master runs the software auto functions and publishes the values it wrote,
+// the other members skip their own pass and write the published values
+// on their next frame, so all cameras get the same exposure, gain and whitebalance.
+//
+// Groups are found by name, like the AutoPassWorker they exist
+// while one device holds a reference.
+class AutoGroup
+{
+public:
+    struct values
+    {
+        // increases with every publish, 0 before the master published anything
+        uint64_t seq = 0;
+
+        int exposure = 0;
+        bool has_exposure = false;
+        float gain = 0.f;
+        bool has_gain = false;
+        int iris = 0;
+        bool has_iris = false;
+        float wb_r = 1.f;
+        float wb_g = 1.f;
+        float wb_b = 1.f;
+        bool has_wb = false;
+    };
+
+    static std::shared_ptr<AutoGroup> get(const std::string& name);
+
+    // seq of v is ignored
+    void publish(const values& v);
+
+    values get_values() const;
+
+private:
+    AutoGroup() = default;
+
+    mutable std::mutex mtx_;
+    values values_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -0,0 +1,122 @@
+#include "AutoPassWorker.h"
+
+#include "logging.h"
+#include "scope_tracing.h"
+#include "utils.h"
+
+using namespace tcam;
+
+std::weak_ptr<AutoPassWorker> AutoPassWorker::instance_ptr;
+
+namespace
+{
+
+// One thread is enough for the usual case of a handful of cameras.
+// Setups with many devices can raise this.
+unsigned int get_thread_count()
+{
+    auto env_count = tcam::get_environment_variable_int("TCAM_AUTO_PASS_THREADS");
+
+    if (env_count && env_count.value() > 0)
+    {
+        return env_count.value();
+    }
+    return 1;
+}
+
+} // namespace
+
+
+AutoPassWorker::AutoPassWorker(unsigned int thread_count)
+{
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        threads_.emplace_back(&AutoPassWorker::run, this);
+    }
+}
+
+
+AutoPassWorker::~AutoPassWorker()
+{
+    {
+        std::scoped_lock lock(mtx_);
+        continue_thread_ = false;
+    }
+    cv_.notify_all();
+
+    for (auto& t : threads_)
+    {
+        try
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+        catch (const std::system_error& err)
+        {
+            SPDLOG_ERROR("Unable to join thread. Exception: {}", err.what());
+        }
+    }
+}
+
+
+std::shared_ptr<AutoPassWorker> AutoPassWorker::get_instance()
+{
+    static std::mutex instance_mtx;
+    std::scoped_lock lock(instance_mtx);
+
+    auto obj = instance_ptr.lock();
+
+    if (!obj)
+    {
+        obj = std::shared_ptr<AutoPassWorker>(new AutoPassWorker(get_thread_count()));
+
+        instance_ptr = obj;
+    }
+
+    return obj;
+}
+
+
+bool AutoPassWorker::submit(std::function<void()>&& job)
+{
+    {
+        std::scoped_lock lock(mtx_);
+        if (!continue_thread_)
+        {
+            return false;
+        }
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+
+void AutoPassWorker::run()
+{
+    tcam::set_thread_name("tcam_autopass");
+    tcam::apply_thread_config(tcam::thread_role::auto_pass);
+
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mtx_);
+            cv_.wait(lock, [this] { return !continue_thread_ || !jobs_.empty(); });
+
+            // pending jobs are still executed,
+            // their owners may be waiting for them to finish
+            if (jobs_.empty())
+            {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        TCAM_TRACE_SCOPE("AutoPassWorker job");
+        job();
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+// Thread pool that runs the software auto algorithms and the resulting
+// device writes outside of the backend delivery threads.
+//
+// Like the Indexer this is a pseudo singleton.
+// All open devices share the same threads, they are stopped
+// once the last user releases its reference.
+class AutoPassWorker
+{
+public:
+    static std::shared_ptr<AutoPassWorker> get_instance();
+
+    ~AutoPassWorker();
+
+    // returns false when the job could not be queued
+    bool submit(std::function<void()>&& job);
+
+private:
+    static std::weak_ptr<AutoPassWorker> instance_ptr;
+
+    explicit AutoPassWorker(unsigned int thread_count);
+
+    void run();
+
+    bool continue_thread_ = true;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
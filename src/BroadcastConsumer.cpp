@@ -0,0 +1,264 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BroadcastConsumer.h"
+
+#include "logging.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace tcam;
+using namespace tcam::broadcast;
+
+namespace
+{
+
+std::error_code last_error() noexcept
+{
+    return std::error_code(errno, std::generic_category());
+}
+
+} // namespace
+
+
+outcome::result<std::shared_ptr<BroadcastConsumer>> BroadcastConsumer::connect(
+    const std::string& name,
+    consumer_policy policy)
+{
+    auto consumer = std::shared_ptr<BroadcastConsumer>(new BroadcastConsumer());
+
+    OUTCOME_TRY(consumer->init(name, policy));
+
+    return consumer;
+}
+
+
+outcome::result<void> BroadcastConsumer::init(const std::string& name, consumer_policy policy)
+{
+    policy_ = policy;
+
+    const std::string socket_name = make_socket_name(name);
+
+    struct sockaddr_un addr = {};
+    if (socket_name.size() + 1 > sizeof(addr.sun_path))
+    {
+        return status::InvalidParameter;
+    }
+
+    socket_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (socket_fd_ < 0)
+    {
+        return last_error();
+    }
+
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path + 1, socket_name.data(), socket_name.size());
+    const socklen_t addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + socket_name.size();
+
+    if (::connect(socket_fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len) != 0)
+    {
+        SPDLOG_ERROR("Unable to connect to broadcast '{}': {}", name, strerror(errno));
+        return status::DeviceCouldNotBeOpened;
+    }
+
+    const connect_request request = { ring_version, policy };
+    if (send(socket_fd_, &request, sizeof(request), MSG_NOSIGNAL) != sizeof(request))
+    {
+        return last_error();
+    }
+
+    connect_reply reply = {};
+    struct iovec iov = { &reply, sizeof(reply) };
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(socket_fd_, &msg, MSG_CMSG_CLOEXEC) != sizeof(reply)
+        || reply.version != ring_version)
+    {
+        SPDLOG_ERROR("Broadcast '{}' sent an invalid reply", name);
+        return status::DeviceCouldNotBeOpened;
+    }
+
+    int memfd = -1;
+    if (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+    {
+        memcpy(&memfd, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    if (reply.consumer_index < 0 || reply.consumer_index >= static_cast<int>(max_consumers)
+        || memfd < 0)
+    {
+        SPDLOG_ERROR("Broadcast '{}' has no room for another consumer", name);
+        if (memfd >= 0)
+        {
+            close(memfd);
+        }
+        return status::ResourceNotLockable;
+    }
+
+    struct stat st = {};
+    if (fstat(memfd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ring_header))
+    {
+        close(memfd);
+        return status::DeviceCouldNotBeOpened;
+    }
+    map_size_ = st.st_size;
+
+    // the consumer writes its cursor and held mask into the header
+    map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+    if (map_ == MAP_FAILED)
+    {
+        map_ = nullptr;
+        return last_error();
+    }
+
+    header_ = static_cast<ring_header*>(map_);
+    if (header_->magic != ring_magic || header_->version != ring_version
+        || header_->slot_count == 0 || header_->slot_count > max_slots
+        || header_->data_offset + header_->slot_stride * header_->slot_count > map_size_)
+    {
+        SPDLOG_ERROR("Broadcast '{}' uses an incompatible ring", name);
+        return status::DeviceCouldNotBeOpened;
+    }
+
+    entry_ = &header_->consumers[reply.consumer_index];
+
+    format_ = VideoFormat(header_->fourcc,
+                          tcam_image_size { header_->width, header_->height },
+                          {},
+                          header_->framerate);
+
+    return outcome::success();
+}
+
+
+BroadcastConsumer::~BroadcastConsumer()
+{
+    // the producer clears the held mask when it sees the hangup
+    if (socket_fd_ >= 0)
+    {
+        close(socket_fd_);
+    }
+    if (map_)
+    {
+        munmap(map_, map_size_);
+    }
+}
+
+
+uint64_t BroadcastConsumer::get_frames_dropped() const noexcept
+{
+    return entry_->frames_dropped.load(std::memory_order_relaxed);
+}
+
+
+void BroadcastConsumer::notify_producer() noexcept
+{
+    // only blocking consumers are waited for
+    if (policy_ == consumer_policy::block)
+    {
+        header_->release_futex.fetch_add(1, std::memory_order_release);
+        futex_wake_all(header_->release_futex);
+    }
+}
+
+
+outcome::result<BroadcastConsumer::frame> BroadcastConsumer::acquire(int timeout_ms)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    const uint64_t slot_count = header_->slot_count;
+
+    while (true)
+    {
+        // read before write_seq, so that a frame published in between ends the wait
+        const uint32_t futex_val = header_->frame_futex.load(std::memory_order_acquire);
+        const uint64_t write_seq = header_->write_seq.load(std::memory_order_acquire);
+
+        uint64_t r = entry_->read_seq.load(std::memory_order_relaxed);
+        if (r < write_seq)
+        {
+            if (write_seq - r > slot_count)
+            {
+                entry_->frames_dropped.fetch_add(write_seq - slot_count - r,
+                                                 std::memory_order_relaxed);
+                r = write_seq - slot_count;
+            }
+
+            const unsigned int slot_index =
+                header_->entries[r % slot_count].load(std::memory_order_acquire);
+            const uint64_t bit = uint64_t(1) << slot_index;
+
+            entry_->read_seq.store(r + 1, std::memory_order_release);
+
+            // counterpart of the seq check in BroadcastSink::push_image
+            entry_->held_mask.fetch_or(bit);
+            const auto& slot = header_->slots[slot_index];
+            if (slot.seq.load() != r)
+            {
+                // overwritten in the meantime
+                entry_->held_mask.fetch_and(~bit);
+                entry_->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+                notify_producer();
+                continue;
+            }
+            notify_producer();
+
+            frame f;
+            f.seq = r;
+            f.slot = slot_index;
+            f.data =
+                static_cast<uint8_t*>(map_) + header_->data_offset + header_->slot_stride * slot_index;
+            f.length = slot.data_length;
+            f.statistics = slot.statistics;
+            return f;
+        }
+
+        if (!header_->producer_alive.load(std::memory_order_acquire))
+        {
+            return status::DeviceLost;
+        }
+
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            return status::Timeout;
+        }
+        futex_wait(header_->frame_futex, futex_val, remaining.count());
+    }
+}
+
+
+void BroadcastConsumer::release(const frame& f) noexcept
+{
+    entry_->held_mask.fetch_and(~(uint64_t(1) << f.slot));
+    notify_producer();
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "VideoFormat.h"
+#include "broadcast_ring.h"
+#include "error.h"
+
+#include <memory>
+#include <string>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Reads the frames a BroadcastSink in another process publishes.
+ *
+ * Frames point into the shared ring and stay valid until they are released,
+ * the producer does not overwrite a frame that is held.
+ * acquire is meant to be called from one thread, release may be called from any thread.
+ */
+class BroadcastConsumer
+{
+public:
+    struct frame
+    {
+        uint64_t seq = 0;
+        unsigned int slot = 0;
+
+        const void* data = nullptr;
+        size_t length = 0;
+        tcam_stream_statistics statistics = {};
+    };
+
+    static outcome::result<std::shared_ptr<BroadcastConsumer>> connect(
+        const std::string& name,
+        broadcast::consumer_policy policy);
+
+    BroadcastConsumer(const BroadcastConsumer&) = delete;
+    BroadcastConsumer& operator=(const BroadcastConsumer&) = delete;
+
+    ~BroadcastConsumer();
+
+    /**
+     * Wait for the next frame.
+     * @return status::Timeout when no frame arrived in timeout_ms,
+     *         status::DeviceLost when the producer stopped
+     */
+    outcome::result<frame> acquire(int timeout_ms);
+    void release(const frame& f) noexcept;
+
+    VideoFormat get_format() const noexcept
+    {
+        return format_;
+    }
+
+    // frames that were overwritten before this consumer read them
+    uint64_t get_frames_dropped() const noexcept;
+
+private:
+    BroadcastConsumer() = default;
+
+    outcome::result<void> init(const std::string& name, broadcast::consumer_policy policy);
+
+    // wakes a producer that waits for a blocking consumer
+    void notify_producer() noexcept;
+
+    int socket_fd_ = -1;
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    broadcast::ring_header* header_ = nullptr;
+    broadcast::consumer_entry* entry_ = nullptr;
+
+    broadcast::consumer_policy policy_ = broadcast::consumer_policy::drop;
+    VideoFormat format_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
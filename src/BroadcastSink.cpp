@@ -0,0 +1,471 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BroadcastSink.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace tcam;
+using namespace tcam::broadcast;
+
+namespace
+{
+
+constexpr size_t page_size = 4096;
+
+constexpr size_t round_up(size_t value, size_t align) noexcept
+{
+    return (value + align - 1) / align * align;
+}
+
+std::error_code last_error() noexcept
+{
+    return std::error_code(errno, std::generic_category());
+}
+
+} // namespace
+
+
+outcome::result<std::shared_ptr<BroadcastSink>> BroadcastSink::create(const std::string& name,
+                                                                       const VideoFormat& format,
+                                                                       unsigned int slot_count)
+{
+    auto sink = std::shared_ptr<BroadcastSink>(new BroadcastSink());
+
+    OUTCOME_TRY(sink->init(name, format, slot_count));
+
+    return sink;
+}
+
+
+outcome::result<void> BroadcastSink::init(const std::string& name,
+                                          const VideoFormat& format,
+                                          unsigned int slot_count)
+{
+    consumer_fds_.fill(-1);
+
+    const std::string socket_name = make_socket_name(name);
+
+    struct sockaddr_un addr = {};
+    if (name.empty() || slot_count == 0 || slot_count > max_slots
+        || socket_name.size() + 1 > sizeof(addr.sun_path))
+    {
+        return status::InvalidParameter;
+    }
+
+    const size_t slot_stride = round_up(format.get_required_buffer_size(), page_size);
+    const size_t data_offset = round_up(sizeof(ring_header), page_size);
+    map_size_ = data_offset + slot_stride * slot_count;
+
+    memfd_ = memfd_create(socket_name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd_ < 0)
+    {
+        return last_error();
+    }
+    if (ftruncate(memfd_, map_size_) != 0)
+    {
+        return last_error();
+    }
+    // consumers cannot shrink the memory under the producer
+    fcntl(memfd_, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+    map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+    if (map_ == MAP_FAILED)
+    {
+        map_ = nullptr;
+        return last_error();
+    }
+
+    // the memory is zeroed, so all atomics start at 0
+    header_ = new (map_) ring_header {};
+    header_->magic = ring_magic;
+    header_->version = ring_version;
+    header_->slot_count = slot_count;
+    header_->slot_stride = slot_stride;
+    header_->data_offset = data_offset;
+    header_->fourcc = format.get_fourcc();
+    header_->width = format.get_size().width;
+    header_->height = format.get_size().height;
+    header_->framerate = format.get_framerate();
+    for (auto& slot : header_->slots) { slot.seq.store(invalid_seq, std::memory_order_relaxed); }
+    header_->producer_alive.store(1, std::memory_order_release);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0)
+    {
+        return last_error();
+    }
+
+    addr.sun_family = AF_UNIX;
+    // sun_path[0] stays 0, which makes this an abstract name
+    memcpy(addr.sun_path + 1, socket_name.data(), socket_name.size());
+    const socklen_t addr_len = offsetof(struct sockaddr_un, sun_path) + 1 + socket_name.size();
+
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len) != 0)
+    {
+        SPDLOG_ERROR("Unable to create broadcast '{}': {}", name, strerror(errno));
+        return last_error();
+    }
+    if (listen(listen_fd_, max_consumers) != 0)
+    {
+        return last_error();
+    }
+
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (stop_fd_ < 0)
+    {
+        return last_error();
+    }
+
+    listener_thread_ = std::thread(&BroadcastSink::listener_thread_main, this);
+
+    SPDLOG_INFO("Broadcasting {} as '{}' with {} slots", format.to_string(), name, slot_count);
+
+    return outcome::success();
+}
+
+
+BroadcastSink::~BroadcastSink()
+{
+    if (stop_fd_ >= 0)
+    {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = write(stop_fd_, &one, sizeof(one));
+    }
+    if (listener_thread_.joinable())
+    {
+        listener_thread_.join();
+    }
+
+    if (header_)
+    {
+        header_->producer_alive.store(0, std::memory_order_release);
+        header_->frame_futex.fetch_add(1, std::memory_order_release);
+        futex_wake_all(header_->frame_futex);
+    }
+
+    for (int fd : consumer_fds_)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    // the consumers keep their own mappings, the memory lives until the last one is gone
+    if (map_)
+    {
+        munmap(map_, map_size_);
+    }
+    for (int fd : { stop_fd_, listen_fd_, memfd_ })
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+
+uint64_t BroadcastSink::get_frames_dropped() const noexcept
+{
+    return header_->frames_dropped.load(std::memory_order_relaxed);
+}
+
+
+uint64_t BroadcastSink::get_held_mask() const noexcept
+{
+    uint64_t mask = 0;
+    for (const auto& c : header_->consumers)
+    {
+        mask |= c.held_mask.load();
+    }
+    return mask;
+}
+
+
+int BroadcastSink::find_free_slot(bool respect_block_consumers) const noexcept
+{
+    uint64_t oldest_unread = invalid_seq;
+    if (respect_block_consumers)
+    {
+        for (const auto& c : header_->consumers)
+        {
+            if (c.active.load(std::memory_order_acquire) && c.policy == consumer_policy::block)
+            {
+                oldest_unread = std::min(oldest_unread, c.read_seq.load(std::memory_order_acquire));
+            }
+        }
+    }
+
+    const uint64_t held = get_held_mask();
+
+    int best = -1;
+    uint64_t best_seq = invalid_seq;
+    for (unsigned int i = 0; i < header_->slot_count; ++i)
+    {
+        if (held & (uint64_t(1) << i))
+        {
+            continue;
+        }
+        // only this thread writes the slot seqs
+        const uint64_t seq = header_->slots[i].seq.load(std::memory_order_relaxed);
+        if (seq == invalid_seq)
+        {
+            return i;
+        }
+        if (seq >= oldest_unread)
+        {
+            continue;
+        }
+        if (best < 0 || seq < best_seq)
+        {
+            best = i;
+            best_seq = seq;
+        }
+    }
+    return best;
+}
+
+
+void BroadcastSink::push_image(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    const uint64_t n = header_->write_seq.load(std::memory_order_relaxed);
+
+    int index = find_free_slot(true);
+    if (index < 0)
+    {
+        // backpressure, wait until the blocking consumers read or release their slots
+        const auto deadline = std::chrono::steady_clock::now() + block_timeout_;
+        while (index < 0)
+        {
+            const uint32_t futex_val = header_->release_futex.load(std::memory_order_acquire);
+            index = find_free_slot(true);
+            if (index >= 0)
+            {
+                break;
+            }
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0)
+            {
+                break;
+            }
+            futex_wait(header_->release_futex, futex_val, remaining.count());
+        }
+    }
+    if (index < 0)
+    {
+        // the blocking consumers are too slow, they lose the oldest frame
+        index = find_free_slot(false);
+    }
+    if (index < 0)
+    {
+        header_->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& slot = header_->slots[index];
+    const uint64_t previous_seq = slot.seq.load(std::memory_order_relaxed);
+
+    // consumers set their held bit before they check the seq,
+    // so either they see invalid_seq or the held bit is visible here
+    slot.seq.store(invalid_seq);
+    if (get_held_mask() & (uint64_t(1) << index))
+    {
+        slot.seq.store(previous_seq);
+        header_->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto dst = static_cast<uint8_t*>(map_) + header_->data_offset + header_->slot_stride * index;
+    const size_t length = std::min<size_t>(buffer->get_valid_data_length(), header_->slot_stride);
+
+    memcpy(dst, buffer->get_image_buffer_ptr(), length);
+    slot.data_length = length;
+    slot.statistics = buffer->get_statistics();
+
+    slot.seq.store(n, std::memory_order_release);
+    header_->entries[n % header_->slot_count].store(index, std::memory_order_release);
+    header_->write_seq.store(n + 1, std::memory_order_release);
+
+    header_->frame_futex.fetch_add(1, std::memory_order_release);
+    futex_wake_all(header_->frame_futex);
+}
+
+
+void BroadcastSink::listener_thread_main()
+{
+    tcam::set_thread_name("tcam_broadcast");
+
+    while (true)
+    {
+        std::array<struct pollfd, 2 + max_consumers> fds = {};
+        fds[0] = { stop_fd_, POLLIN, 0 };
+        fds[1] = { listen_fd_, POLLIN, 0 };
+        for (unsigned int i = 0; i < max_consumers; ++i)
+        {
+            // negative fds are ignored by poll
+            fds[2 + i] = { consumer_fds_[i], POLLIN, 0 };
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            SPDLOG_ERROR("poll failed: {}", strerror(errno));
+            return;
+        }
+
+        if (fds[0].revents)
+        {
+            return;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            accept_consumer();
+        }
+        for (unsigned int i = 0; i < max_consumers; ++i)
+        {
+            // consumers send nothing after the connect request, so any event is the hangup
+            if (consumer_fds_[i] >= 0 && fds[2 + i].revents)
+            {
+                drop_consumer(i);
+            }
+        }
+    }
+}
+
+
+void BroadcastSink::accept_consumer()
+{
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    struct timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    connect_request request = {};
+    if (recv(fd, &request, sizeof(request), 0) != sizeof(request) || request.version != ring_version)
+    {
+        SPDLOG_WARN("Ignoring broadcast consumer with invalid request");
+        close(fd);
+        return;
+    }
+
+    connect_reply reply = { ring_version, -1 };
+    for (unsigned int i = 0; i < max_consumers; ++i)
+    {
+        if (consumer_fds_[i] < 0)
+        {
+            reply.consumer_index = i;
+            break;
+        }
+    }
+
+    if (reply.consumer_index >= 0)
+    {
+        struct ucred cred = {};
+        socklen_t cred_len = sizeof(cred);
+        getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len);
+
+        auto& c = header_->consumers[reply.consumer_index];
+        c.policy = request.policy == consumer_policy::block ? consumer_policy::block :
+                                                              consumer_policy::drop;
+        c.pid = cred.pid;
+        c.held_mask.store(0);
+        c.frames_dropped.store(0);
+        c.read_seq.store(header_->write_seq.load(std::memory_order_acquire));
+        c.active.store(1, std::memory_order_release);
+    }
+
+    struct iovec iov = { &reply, sizeof(reply) };
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    if (reply.consumer_index >= 0)
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &memfd_, sizeof(int));
+    }
+
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof(reply) || reply.consumer_index < 0)
+    {
+        if (reply.consumer_index < 0)
+        {
+            SPDLOG_WARN("Rejecting broadcast consumer, all {} entries are in use", max_consumers);
+        }
+        else
+        {
+            header_->consumers[reply.consumer_index].active.store(0, std::memory_order_release);
+        }
+        close(fd);
+        return;
+    }
+
+    consumer_fds_[reply.consumer_index] = fd;
+
+    SPDLOG_DEBUG("Broadcast consumer {} connected, pid {}",
+                 reply.consumer_index,
+                 header_->consumers[reply.consumer_index].pid);
+}
+
+
+void BroadcastSink::drop_consumer(unsigned int index)
+{
+    auto& c = header_->consumers[index];
+
+    SPDLOG_DEBUG("Broadcast consumer {} disconnected, it dropped {} frames",
+                 index,
+                 c.frames_dropped.load(std::memory_order_relaxed));
+
+    // a crashed consumer cannot release its slots, so that is done here
+    c.active.store(0, std::memory_order_release);
+    c.held_mask.store(0, std::memory_order_release);
+
+    close(consumer_fds_[index]);
+    consumer_fds_[index] = -1;
+
+    // push_image might wait for this consumer
+    header_->release_futex.fetch_add(1, std::memory_order_release);
+    futex_wake_all(header_->release_futex);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "SinkInterface.h"
+#include "broadcast_ring.h"
+#include "error.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Publishes the images of a stream to other processes.
+ *
+ * Every image pushed is copied once into a slot of a memfd backed ring,
+ * consumers map the memfd and read the slots without copying, see BroadcastConsumer.
+ * Consumers find the ring through the abstract unix socket named after name.
+ *
+ * push_image does not keep the ImageBuffer, so this can be called from the
+ * ImageSink callback before the buffer is passed on.
+ */
+class BroadcastSink : public IImageBufferSink
+{
+public:
+    static constexpr unsigned int default_slot_count = 8;
+
+    /**
+     * @param slot_count number of frames in the ring, at most broadcast::max_slots
+     * @return error when the socket name is in use or the memory could not be created
+     */
+    static outcome::result<std::shared_ptr<BroadcastSink>> create(
+        const std::string& name,
+        const VideoFormat& format,
+        unsigned int slot_count = default_slot_count);
+
+    BroadcastSink(const BroadcastSink&) = delete;
+    BroadcastSink& operator=(const BroadcastSink&) = delete;
+
+    ~BroadcastSink() override;
+
+    void push_image(const std::shared_ptr<ImageBuffer>&) final;
+
+    // how long push_image waits for consumers with consumer_policy::block
+    void set_block_timeout(std::chrono::milliseconds timeout) noexcept
+    {
+        block_timeout_ = timeout;
+    }
+
+    // frames that were not published because all slots were held
+    uint64_t get_frames_dropped() const noexcept;
+
+private:
+    BroadcastSink() = default;
+
+    outcome::result<void> init(const std::string& name, const VideoFormat& format, unsigned int slot_count);
+
+    int find_free_slot(bool respect_block_consumers) const noexcept;
+    uint64_t get_held_mask() const noexcept;
+
+    void listener_thread_main();
+    void accept_consumer();
+    void drop_consumer(unsigned int index);
+
+    int memfd_ = -1;
+    int listen_fd_ = -1;
+    // wakes the listener thread for shutdown
+    int stop_fd_ = -1;
+
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    broadcast::ring_header* header_ = nullptr;
+
+    // connections of the consumers, only touched by the listener thread
+    std::array<int, broadcast::max_consumers> consumer_fds_ {};
+
+    std::chrono::milliseconds block_timeout_ { 1000 };
+
+    std::thread listener_thread_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
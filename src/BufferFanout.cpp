@@ -0,0 +1,169 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BufferFanout.h"
+
+#include "logging.h"
+#include "scope_tracing.h"
+
+#include <algorithm>
+
+using namespace tcam;
+
+
+void BufferFanout::set_requeue_target(std::weak_ptr<IImageBufferPool> target)
+{
+    std::scoped_lock lck { mtx_ };
+    target_ = std::move(target);
+}
+
+
+int BufferFanout::add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers)
+{
+    if (!sink)
+    {
+        return -1;
+    }
+
+    auto entry = std::make_shared<tap>();
+    entry->sink = std::move(sink);
+    entry->max_buffers = std::max(max_buffers, 1u);
+
+    std::scoped_lock lck { mtx_ };
+    entry->id = next_id_++;
+    taps_.push_back(entry);
+    tap_count_ = taps_.size();
+    return entry->id;
+}
+
+
+void BufferFanout::remove_tap(int id)
+{
+    std::scoped_lock lck { mtx_ };
+    taps_.erase(std::remove_if(taps_.begin(),
+                               taps_.end(),
+                               [id](const auto& entry) { return entry->id == id; }),
+                taps_.end());
+    tap_count_ = taps_.size();
+}
+
+
+uint64_t BufferFanout::get_frames_dropped(int id) const
+{
+    std::scoped_lock lck { mtx_ };
+    for (const auto& entry : taps_)
+    {
+        if (entry->id == id)
+        {
+            return entry->dropped;
+        }
+    }
+    return 0;
+}
+
+
+void BufferFanout::push_image(const std::shared_ptr<ImageBuffer>& buffer,
+                              IImageBufferSink& primary)
+{
+    if (tap_count_ == 0)
+    {
+        primary.push_image(buffer);
+        return;
+    }
+
+    TCAM_TRACE_SCOPE("BufferFanout::push_image");
+
+    std::vector<std::shared_ptr<tap>> receivers;
+    {
+        std::scoped_lock lck { mtx_ };
+        receivers.reserve(taps_.size());
+        for (const auto& entry : taps_)
+        {
+            if (entry->held >= entry->max_buffers)
+            {
+                entry->dropped++;
+                continue;
+            }
+            entry->held++;
+            receivers.push_back(entry);
+        }
+
+        if (!receivers.empty())
+        {
+            holders_[buffer.get()] = receivers.size() + 1;
+            tracked_ = holders_.size();
+        }
+    }
+
+    primary.push_image(buffer);
+
+    std::weak_ptr<BufferFanout> weak_self = weak_from_this();
+    for (auto& entry : receivers)
+    {
+        // the deleter returns the reference of the tap, the buffer itself lives on in the device
+        auto tap_buffer = std::shared_ptr<ImageBuffer>(
+            buffer.get(),
+            [original = buffer, entry, weak_self](ImageBuffer*)
+            {
+                entry->held--;
+                if (auto self = weak_self.lock())
+                {
+                    self->release(original);
+                }
+            });
+
+        entry->sink->push_image(tap_buffer);
+    }
+}
+
+
+void BufferFanout::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    release(buffer);
+}
+
+
+void BufferFanout::release(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    std::shared_ptr<IImageBufferPool> target;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        if (tracked_ != 0)
+        {
+            auto iter = holders_.find(buffer.get());
+            if (iter != holders_.end() && --iter->second != 0)
+            {
+                return;
+            }
+            if (iter != holders_.end())
+            {
+                holders_.erase(iter);
+                tracked_ = holders_.size();
+            }
+        }
+        target = target_.lock();
+    }
+
+    if (target)
+    {
+        target->requeue_buffer(buffer);
+    }
+    else
+    {
+        SPDLOG_DEBUG("No device to requeue the buffer to.");
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "SinkInterface.h"
+#include "compiler_defines.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+// Hands the images of one stream to the primary sink and to additional taps.
+//
+// All of them receive the same ImageBuffer, nothing is copied.
+// The buffer is given back to the device when the primary sink requeued it
+// and every tap dropped its reference.
+// A tap holds at most max_buffers images, while it is full new images are not given to it
+// and counted as dropped, so a slow tap can not starve the device of buffers.
+//
+// Without taps push_image only forwards to the primary sink.
+class BufferFanout : public IImageBufferPool, public std::enable_shared_from_this<BufferFanout>
+{
+public:
+    void set_requeue_target(std::weak_ptr<IImageBufferPool> target);
+
+    // taps must not write to the images and have to drop them before the stream is freed
+    int add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers);
+
+    // images the tap still holds are returned when it drops them
+    void remove_tap(int id);
+
+    // 0 for unknown taps
+    uint64_t get_frames_dropped(int id) const;
+
+    void push_image(const std::shared_ptr<ImageBuffer>& buffer, IImageBufferSink& primary);
+
+    // called by the primary sink
+    void requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer) final;
+
+private:
+    struct tap
+    {
+        int id = 0;
+        std::shared_ptr<IImageBufferSink> sink;
+        unsigned int max_buffers = 1;
+        std::atomic<unsigned int> held = 0;
+        std::atomic<uint64_t> dropped = 0;
+    };
+
+    void release(const std::shared_ptr<ImageBuffer>& buffer);
+
+    mutable std::mutex mtx_;
+    std::vector<std::shared_ptr<tap>> taps_;
+    int next_id_ = 1;
+    std::atomic<size_t> tap_count_ = 0;
+
+    // references that still have to be released, the primary sink included
+    std::unordered_map<ImageBuffer*, unsigned int> holders_;
+    std::atomic<size_t> tracked_ = 0;
+
+    std::weak_ptr<IImageBufferPool> target_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
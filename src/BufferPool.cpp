@@ -18,6 +18,7 @@
 #include "BufferPool.h"
 
 #include <algorithm>
+#include <stdexcept>
 
 #include "logging.h"
 
@@ -36,10 +37,30 @@ tcam::BufferPool::BufferPool(TCAM_MEMORY_TYPE t, std::shared_ptr<AllocatorInterf
 tcam::BufferPool::~BufferPool() {}
 
 
+bool tcam::BufferPool::can_reuse_memory(size_t count, size_t required_size) const
+{
+    // mmap and dmabuf memory belongs to the v4l2 buffer queue
+    // and does not survive a format change
+    if (memory_type_ != TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return false;
+    }
+
+    return !memory_.empty() && memory_.size() == count && memory_size_ >= required_size;
+}
+
+
 outcome::result<void> tcam::BufferPool::configure(const VideoFormat& format,
                                                   size_t buffer_count)
 {
-    auto ret = clear();
+    release_buffer();
+
+    if (!can_reuse_memory(buffer_count,
+                          std::max(format.get_required_buffer_size(), min_buffer_size_)))
+    {
+        memory_.clear();
+        memory_size_ = 0;
+    }
 
     format_ = format;
     count_ = buffer_count;
@@ -50,56 +71,170 @@ outcome::result<void> tcam::BufferPool::configure(const VideoFormat& format,
 outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
                                                  size_t buffer_count)
 {
+    OUTCOME_TRY(configure(format, buffer_count));
 
-    auto memory = allocator_->allocate(buffer_count, memory_type_, format.get_required_buffer_size());
+    return allocate();
+}
 
-    if (memory.size() != buffer_count)
+outcome::result<void> tcam::BufferPool::allocate()
+{
+    if (memory_type_ == TCAM_MEMORY_TYPE_DMA_IMPORT)
     {
-        SPDLOG_ERROR("Could only allocate {} of {} requested buffer", memory.size(), buffer_count);
-        return status::UndefinedError;
+        // memory has to be provided via import_dma
+        if (buffer_.size() != count_ || buffer_.empty())
+        {
+            SPDLOG_ERROR("No dmabuf file descriptors have been imported.");
+            return status::UndefinedError;
+        }
+        return outcome::success();
+    }
+
+    const size_t required_size = std::max(format_.get_required_buffer_size(), min_buffer_size_);
+
+    if (can_reuse_memory(count_, required_size))
+    {
+        SPDLOG_DEBUG("Reusing {} buffer of {} bytes", memory_.size(), memory_size_);
+    }
+    else
+    {
+        // free the old memory before allocating, peak usage would be doubled otherwise
+        memory_.clear();
+        memory_size_ = 0;
+
+        auto memory = allocator_->allocate(count_, memory_type_, required_size);
+
+        if (memory.size() != count_)
+        {
+            SPDLOG_ERROR("Could only allocate {} of {} requested buffer", memory.size(), count_);
+            return status::UndefinedError;
+        }
+
+        memory_ = std::move(memory);
+        memory_size_ = required_size;
     }
 
     buffer_.clear();
-    buffer_.reserve(memory.size());
+    buffer_.reserve(memory_.size());
 
-    for (auto& m : memory)
+    for (auto& m : memory_)
     {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format, m));
+        buffer_.push_back(std::make_shared<ImageBuffer>(format_, m));
+        buffer_.back()->set_pool_index(buffer_.size() - 1);
     }
 
     return outcome::success();
 }
 
-outcome::result<void> tcam::BufferPool::allocate()
+
+outcome::result<void> tcam::BufferPool::import_dma(const VideoFormat& format,
+                                                   const std::vector<int>& fds)
 {
+    if (memory_type_ != TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        SPDLOG_ERROR("BufferPool is not configured for dmabuf import.");
+        return status::UndefinedError;
+    }
+
+    std::vector<std::shared_ptr<ImageBuffer>> buffer;
+    buffer.reserve(fds.size());
+
+    for (int fd : fds)
+    {
+        if (fd < 0)
+        {
+            SPDLOG_ERROR("Invalid dmabuf file descriptor.");
+            return status::UndefinedError;
+        }
+
+        try
+        {
+            auto mem = std::make_shared<Memory>(allocator_,
+                                                TCAM_MEMORY_TYPE_DMA_IMPORT,
+                                                format.get_required_buffer_size(),
+                                                nullptr,
+                                                fd);
+            buffer.push_back(std::make_shared<ImageBuffer>(format, mem));
+            buffer.back()->set_pool_index(buffer.size() - 1);
+        }
+        catch (const std::runtime_error& e)
+        {
+            SPDLOG_ERROR("Unable to import dmabuf fd {}: {}", fd, e.what());
+            return status::UndefinedError;
+        }
+    }
+
+    format_ = format;
+    count_ = buffer.size();
+    buffer_ = std::move(buffer);
 
-    auto memory = allocator_->allocate(count_, memory_type_, format_.get_required_buffer_size());
+    return outcome::success();
+}
 
-    if (memory.size() != count_)
+
+outcome::result<void> tcam::BufferPool::import_userptr(
+    const VideoFormat& format,
+    const std::vector<std::pair<void*, size_t>>& memory)
+{
+    if (memory_type_ != TCAM_MEMORY_TYPE_USERPTR)
     {
-        SPDLOG_ERROR("Could only allocate {} of {} requested buffer", memory.size(), count_);
+        SPDLOG_ERROR("BufferPool is not configured for userptr import.");
         return status::UndefinedError;
     }
 
-    buffer_.clear();
-    buffer_.reserve(memory.size());
+    const size_t required_size = format.get_required_buffer_size();
+
+    std::vector<std::shared_ptr<Memory>> imported;
+    imported.reserve(memory.size());
 
-    for (auto& m : memory)
+    for (const auto& [ptr, size] : memory)
     {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format_, m));
+        if (!ptr || size < required_size)
+        {
+            SPDLOG_ERROR("Imported memory is too small. Has {} bytes, requires {}.",
+                         size,
+                         required_size);
+            return status::UndefinedError;
+        }
+
+        try
+        {
+            imported.push_back(std::make_shared<Memory>(
+                allocator_, TCAM_MEMORY_TYPE_USERPTR, size, ptr, -1, true));
+        }
+        catch (const std::runtime_error& e)
+        {
+            SPDLOG_ERROR("Unable to import memory: {}", e.what());
+            return status::UndefinedError;
+        }
     }
 
-    return outcome::success();
+    release_buffer();
+
+    format_ = format;
+    count_ = imported.size();
+    // allocate() reuses this memory as long as format and count fit
+    memory_ = std::move(imported);
+    memory_size_ = required_size;
+
+    return allocate();
 }
 
 
 outcome::result<void> tcam::BufferPool::clear()
 {
     buffer_.clear();
+    memory_.clear();
+    memory_size_ = 0;
 
     return outcome::success();
 }
 
+
+void tcam::BufferPool::release_buffer()
+{
+    buffer_.clear();
+}
+
 std::vector<std::weak_ptr<tcam::ImageBuffer>> tcam::BufferPool::get_buffer()
 {
     std::vector<std::weak_ptr<tcam::ImageBuffer>> ret;
@@ -110,3 +245,10 @@ std::vector<std::weak_ptr<tcam::ImageBuffer>> tcam::BufferPool::get_buffer()
 
     return ret;
 }
+
+size_t tcam::BufferPool::get_memory_size() const
+{
+    size_t ret = 0;
+    for (const auto& mem : memory_) { ret += mem->length(); }
+    return ret;
+}
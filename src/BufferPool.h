@@ -22,6 +22,7 @@
 #include "error.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace tcam
@@ -33,6 +34,11 @@ namespace tcam
 // some backends need to configure the format 
 // BEFORE any memory can be allocated (e.g. v4l2::mmap)
 // setting a format may invalidate queued memory
+//
+// userptr memory is kept when the pool is reconfigured.
+// As long as the buffer count is unchanged and the new format
+// does not require more memory, allocate() reuses it
+// instead of allocating again.
 class BufferPool
 {
 
@@ -45,6 +51,15 @@ private:
 
     std::vector<std::shared_ptr<ImageBuffer>> buffer_;
 
+    // memory backing buffer_, kept over reconfiguration
+    std::vector<std::shared_ptr<Memory>> memory_;
+    size_t memory_size_ = 0;
+
+    // the device may need more than the format, e.g. for chunk data
+    size_t min_buffer_size_ = 0;
+
+    bool can_reuse_memory(size_t count, size_t required_size) const;
+
 public:
     BufferPool(TCAM_MEMORY_TYPE, std::shared_ptr<AllocatorInterface>);
     ~BufferPool();
@@ -53,15 +68,66 @@ public:
     outcome::result<void> configure(const VideoFormat& format, size_t buffer_count);
     outcome::result<void> allocate(const VideoFormat& format, size_t buffer_count);
     outcome::result<void> allocate();
+
+    // lower bound for the size of allocated buffer, set by the device before allocate()
+    // has no effect on imported memory
+    void set_min_buffer_size(size_t size)
+    {
+        min_buffer_size_ = size;
+    }
+
+    // wrap externally allocated dmabuf file descriptors
+    // only valid for TCAM_MEMORY_TYPE_DMA_IMPORT
+    // the descriptors remain owned by the caller
+    outcome::result<void> import_dma(const VideoFormat& format, const std::vector<int>& fds);
+
+    // wrap externally allocated memory, e.g. the buffers of a downstream GStreamer pool
+    // only valid for TCAM_MEMORY_TYPE_USERPTR
+    // the memory remains owned by the caller and has to outlive the buffers
+    outcome::result<void> import_userptr(const VideoFormat& format,
+                                         const std::vector<std::pair<void*, size_t>>& memory);
+
+    // release buffer and memory
     outcome::result<void> clear();
 
+    // release buffer, keep memory for the next allocate()
+    void release_buffer();
+
+    // kept for backends that do not track the pool index
     std::vector<std::weak_ptr<ImageBuffer>> get_buffer();
 
+    // The pool index is the identity of a buffer, see ImageBuffer::get_pool_index.
+    // The pool keeps the buffer alive until it is reconfigured, cleared or released,
+    // so per frame paths can use the reference instead of locking a weak_ptr.
+    size_t get_buffer_count() const noexcept
+    {
+        return buffer_.size();
+    }
+    const std::shared_ptr<ImageBuffer>& get_buffer_at(size_t pool_index) const
+    {
+        return buffer_.at(pool_index);
+    }
+
+    // buffer is the current buffer with its pool index
+    bool is_current(const ImageBuffer& buffer) const noexcept
+    {
+        const size_t i = buffer.get_pool_index();
+        return i < buffer_.size() && buffer_[i].get() == &buffer;
+    }
+
     TCAM_MEMORY_TYPE get_memory_type() const
     {
         return memory_type_;
     }
 
+    // memory held by the pool, including memory kept over reconfiguration
+    // for imported memory this is what the owner allocated
+    size_t get_memory_count() const
+    {
+        return memory_.size();
+    }
+    size_t get_memory_size() const;
+
 }; // class BufferPool
 
 } // namespace tcam
@@ -18,6 +18,8 @@
 
 #include "CaptureDeviceImpl.h"
 #include "DeviceIndex.h"
+#include "DeviceInterface.h"
+#include "devicelibrary.h"
 #include "logging.h"
 #include "utils.h"
 
@@ -68,6 +70,18 @@ std::shared_ptr<tcam::property::IPropertyBase> CaptureDevice::get_property(const
 }
 
 
+std::unique_ptr<tcam::property::IPropertyTransaction> CaptureDevice::begin_property_transaction()
+{
+    return impl->begin_property_transaction();
+}
+
+
+std::shared_ptr<tcam::property::PropertyChangeNotifier> CaptureDevice::get_property_change_notifier()
+{
+    return impl->get_property_change_notifier();
+}
+
+
 std::vector<VideoFormatDescription> CaptureDevice::get_available_video_formats() const
 {
     return impl->get_available_video_formats();
@@ -114,6 +128,72 @@ void CaptureDevice::set_drop_incomplete_frames(bool b)
     impl->set_drop_incomplete_frames(b);
 }
 
+void CaptureDevice::set_transport_options(const tcam_transport_options& options)
+{
+    impl->set_transport_options(options);
+}
+
+void CaptureDevice::register_device_event_callback(tcam_device_event_callback callback,
+                                                   void* user_data)
+{
+    impl->register_device_event_callback(callback, user_data);
+}
+
+outcome::result<void> CaptureDevice::enable_device_events(const std::vector<std::string>& names)
+{
+    return impl->enable_device_events(names);
+}
+
+outcome::result<void> CaptureDevice::set_heartbeat_timeout(std::chrono::milliseconds timeout)
+{
+    return impl->set_heartbeat_timeout(timeout);
+}
+
+void CaptureDevice::set_salvage_options(const tcam_salvage_options& options)
+{
+    impl->set_salvage_options(options);
+}
+
+void CaptureDevice::set_chunk_mode(bool b)
+{
+    impl->set_chunk_mode(b);
+}
+
+void CaptureDevice::set_decimation_options(const tcam_decimation_options& options)
+{
+    impl->set_decimation_options(options);
+}
+
+void CaptureDevice::set_image_statistics_histogram(bool b)
+{
+    impl->set_image_statistics_histogram(b);
+}
+
+void CaptureDevice::set_auto_group(const std::string& name, bool is_master)
+{
+    impl->set_auto_group(name, is_master);
+}
+
+void CaptureDevice::set_locality_placement(bool b)
+{
+    impl->set_locality_placement(b);
+}
+
+int CaptureDevice::get_numa_node()
+{
+    return impl->get_numa_node();
+}
+
+std::optional<tcam_transport_statistics> CaptureDevice::get_transport_statistics()
+{
+    return impl->get_transport_statistics();
+}
+
+size_t CaptureDevice::get_staging_memory_size()
+{
+    return impl->get_staging_memory_size();
+}
+
 outcome::result<tcam::framerate_info> CaptureDevice::get_framerate_info(const VideoFormat& fmt)
 {
     return impl->get_framerate_info(fmt);
@@ -124,6 +204,57 @@ std::shared_ptr<tcam::AllocatorInterface> CaptureDevice::get_allocator()
     return impl->get_allocator();
 }
 
+uint64_t CaptureDevice::schedule_property_write(
+    uint64_t after_frame,
+    std::function<outcome::result<void>()> write)
+{
+    return impl->schedule_property_write(after_frame, std::move(write));
+}
+
+void CaptureDevice::clear_scheduled_property_writes()
+{
+    impl->clear_scheduled_property_writes();
+}
+
+void CaptureDevice::queue_property_write(const std::string& name,
+                                         std::function<outcome::result<void>()> write,
+                                         std::function<void(const outcome::result<void>&)> done)
+{
+    impl->queue_property_write(name, std::move(write), std::move(done));
+}
+
+std::future<outcome::result<void>> CaptureDevice::queue_property_write(
+    const std::string& name,
+    std::function<outcome::result<void>()> write)
+{
+    return impl->queue_property_write(name, std::move(write));
+}
+
+void CaptureDevice::wait_for_property_writes()
+{
+    impl->wait_for_property_writes();
+}
+
+outcome::result<void> CaptureDevice::move_roi(int64_t offset_x, int64_t offset_y)
+{
+    return impl->move_roi(offset_x, offset_y);
+}
+
+int CaptureDevice::add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers)
+{
+    return impl->add_tap(std::move(sink), max_buffers);
+}
+
+void CaptureDevice::remove_tap(int id)
+{
+    impl->remove_tap(id);
+}
+
+uint64_t CaptureDevice::get_tap_frames_dropped(int id) const
+{
+    return impl->get_tap_frames_dropped(id);
+}
+
 std::shared_ptr<CaptureDevice> tcam::open_device(const std::string& serial, TCAM_DEVICE_TYPE type)
 {
     auto _open = [](const DeviceInfo& info) -> std::shared_ptr<CaptureDevice> {
@@ -139,14 +270,40 @@ std::shared_ptr<CaptureDevice> tcam::open_device(const std::string& serial, TCAM
     };
 
 
-    DeviceIndex index;
-    for (const auto& d : index.get_device_list())
+    // a known serial is asked for directly,
+    // the backends only look at the matching device instead of building their lists
+    if (!serial.empty())
     {
-        if ((d.get_serial().compare(serial) == 0 || serial.empty())
-            && (type == TCAM_DEVICE_TYPE_UNKNOWN || d.get_device_type() == type))
+        for (auto backend : get_backend_list())
         {
-            return _open(d);
+            if (type != TCAM_DEVICE_TYPE_UNKNOWN && backend->get_type() != type)
+            {
+                continue;
+            }
+
+            std::optional<DeviceInfo> info;
+            try
+            {
+                info = backend->find_device(serial);
+            }
+            catch (const std::exception& err)
+            {
+                SPDLOG_DEBUG("Direct lookup of {} failed: {}", serial, err.what());
+            }
+
+            if (info)
+            {
+                return _open(info.value());
+            }
         }
     }
+
+    // only enumerates the backend that is asked for
+    // and does not wait for other backends once the serial is found
+    DeviceIndex index;
+    if (auto d = index.find_device(serial, type); d)
+    {
+        return _open(d.value());
+    }
     return nullptr;
 }
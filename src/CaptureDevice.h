@@ -19,13 +19,18 @@
 
 #include "DeviceInfo.h"
 #include "ImageSink.h"
+#include "PropertyChangeNotifier.h"
 #include "PropertyInterfaces.h"
 #include "SinkInterface.h"
 #include "VideoFormat.h"
 #include "VideoFormatDescription.h"
 #include "compiler_defines.h"
 
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -68,12 +73,36 @@ public:
 
     bool register_device_lost_callback(tcam_device_lost_callback callback, void* user_data);
 
+    // events are delivered from a thread of the device, register before enable_device_events
+    void register_device_event_callback(tcam_device_event_callback callback, void* user_data);
+
+    /**
+     * @brief Let the device send events, e.g. "ExposureEnd" or "FrameTriggerWait"
+     * Only GigE Vision devices support events, others return status::NotImplemented.
+     * Events that are not in names are disabled, an empty list disables all.
+     */
+    outcome::result<void> enable_device_events(const std::vector<std::string>& names);
+
+    // GigE Vision: time without control traffic after which the device drops the connection
+    outcome::result<void> set_heartbeat_timeout(std::chrono::milliseconds timeout);
 
     // property related:
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties();
     std::shared_ptr<tcam::property::IPropertyBase> get_property(const std::string& name);
 
+    /**
+     * Collect the property writes of the calling thread until the returned
+     * transaction is committed or destroyed. Use this when setting many properties at once.
+     */
+    std::unique_ptr<tcam::property::IPropertyTransaction> begin_property_transaction();
+
+    /**
+     * Names of properties whose value or locked state changed,
+     * fed by the software auto functions and by writes through the property objects of this device.
+     */
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> get_property_change_notifier();
+
 
     // videoformat related:
 
@@ -123,8 +152,113 @@ public:
 
     void set_drop_incomplete_frames(bool b);
 
+    void set_transport_options(const tcam_transport_options& options);
+
+    void set_salvage_options(const tcam_salvage_options& options);
+
+    // applied on the next configure_stream
+    void set_chunk_mode(bool b);
+
+    // frames that are skipped before they reach the sink, has to be set before start_stream
+    void set_decimation_options(const tcam_decimation_options& options);
+
+    /**
+     * Fill the histogram of the image statistics, see ImageBuffer::get_image_statistics.
+     * Costs a dense pass over 8-bit bayer images when the auto functions do not make one.
+     */
+    void set_image_statistics_histogram(bool b);
+
+    /**
+     * Share the software auto functions with the other devices of the group name,
+     * e.g. the cameras of a stereo rig. The master runs the auto functions,
+     * the other devices write the exposure, gain, iris and whitebalance it chose
+     * for the auto functions they have enabled, clipped to their own ranges.
+     * An empty name leaves the group. Has to be set before start_stream.
+     */
+    void set_auto_group(const std::string& name, bool is_master);
+
+    /**
+     * Run the stream threads of the backend on the cpus of get_numa_node(),
+     * applied on the next start_stream. Explicit cpus of set_thread_config take precedence.
+     * Buffers are placed by the allocator, see allocator_options::numa_node.
+     * Threads shared by several devices, e.g. the v4l2 event loop, are not moved.
+     */
+    void set_locality_placement(bool b);
+
+    // numa node of the usb host controller or network interface of the device, -1 when unknown
+    int get_numa_node();
+
+    std::optional<tcam_transport_statistics> get_transport_statistics();
+
+    // usb transfer staging etc., the memory of the BufferPool is not included
+    size_t get_staging_memory_size();
+
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    /**
+     * @brief Execute a property write from the stream thread once a frame was received
+     * @param after_frame - frame_count of the frame after which write is executed,
+     *                      0 for the next frame; frame numbers restart with every stream
+     * @param write - e.g. a lambda that calls IPropertyFloat::set_value
+     * The camera applies the value with its own latency, chunk data like ChunkExposureTime
+     * tells which frame was taken with it. settings_id of tcam_stream_statistics is the id
+     * of the last write that was executed before a frame was received.
+     * Pending writes are dropped by stop_stream.
+     * @return id of the write
+     */
+    uint64_t schedule_property_write(uint64_t after_frame,
+                                     std::function<outcome::result<void>()> write);
+
+    void clear_scheduled_property_writes();
+
+    /**
+     * @brief Write a property from the control thread of this device, the caller does not wait
+     * @param name - property that is written; a queued write for the same name that did not
+     *               start yet is replaced by this one
+     * @param write - e.g. a lambda that calls IPropertyFloat::set_value
+     * @param done - called from the control thread with the result of write,
+     *               or with the result of the write that replaced it
+     * Writes are executed in the order they were queued, the writes that are queued together
+     * are sent in one transaction. write and done must not hold the last reference to this device.
+     */
+    void queue_property_write(const std::string& name,
+                              std::function<outcome::result<void>()> write,
+                              std::function<void(const outcome::result<void>&)> done);
+
+    // like above, the future receives the result
+    std::future<outcome::result<void>> queue_property_write(
+        const std::string& name,
+        std::function<outcome::result<void>()> write);
+
+    // blocks until all queued property writes are executed
+    void wait_for_property_writes();
+
+    /**
+     * @brief Move the ROI of the running stream to a new sensor position
+     * Writes OffsetX and OffsetY together, format, buffers and caps stay as they are.
+     * Fails when the offsets are not writable, e.g. while OffsetAutoCenter is On,
+     * or when the position is outside of their range or not on their step.
+     * Frames received afterwards carry the new origin in tcam_stream_statistics.
+     * The camera can still deliver frames exposed at the old position,
+     * chunk data like ChunkOffsetX tells the exact position where available.
+     */
+    outcome::result<void> move_roi(int64_t offset_x, int64_t offset_y);
+
+    /**
+     * @brief Give the images of the stream to an additional sink
+     * The tap receives the same buffers as the sink of configure_stream, nothing is copied.
+     * It must not write to them and has to drop them before free_stream is called.
+     * A buffer returns to the device when every sink is done with it,
+     * while the tap holds max_buffers images new ones are not given to it.
+     * @return id of the tap, -1 when sink is nullptr
+     */
+    int add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers = 1);
+
+    void remove_tap(int id);
+
+    // images the tap did not receive because it held max_buffers images
+    uint64_t get_tap_frames_dropped(int id) const;
+
 private:
     std::shared_ptr<CaptureDeviceImpl> impl;
 
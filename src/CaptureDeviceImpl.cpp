@@ -16,9 +16,13 @@
 
 #include "CaptureDeviceImpl.h"
 
+#include "latency_tracing.h"
+#include "scope_tracing.h"
+#include "usdt_probes.h"
 #include "logging.h"
 
 #include <exception>
+#include <tcamprop1.0_base/tcamprop_property_info_list.h>
 
 using namespace tcam;
 
@@ -43,6 +47,32 @@ bool prevent_software_properties (const DeviceInfo& dev)
     return false;
 }
 
+
+uint64_t pack_roi_origin(int64_t x, int64_t y) noexcept
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+
+outcome::result<void> check_offset(const tcam::property::IPropertyInteger& prop, int64_t value)
+{
+    using tcam::property::PropertyFlags;
+
+    const auto flags = prop.get_flags();
+    if (!(flags & PropertyFlags::Available) || (flags & PropertyFlags::Locked))
+    {
+        return tcam::status::PropertyNotWriteable;
+    }
+
+    const auto range = prop.get_range();
+    if (value < range.min || value > range.max
+        || (range.stp > 1 && (value - range.min) % range.stp != 0))
+    {
+        return tcam::status::PropertyValueOutOfBounds;
+    }
+    return outcome::success();
+}
+
 } // namepsace
 
 
@@ -73,9 +103,28 @@ CaptureDeviceImpl::CaptureDeviceImpl(const DeviceInfo& device_desc)
     }
     apply_software_properties_ = !prevent_software_properties(device_desc);
 
+    metrics_ = tcam::metrics::get_stream(device_desc.get_serial(),
+                                         device_desc.get_device_type_as_string());
+
+    std::weak_ptr<DeviceInterface> weak_dev = device_;
+    auto begin_transaction = [weak_dev]() -> std::unique_ptr<tcam::property::IPropertyTransaction>
+    {
+        if (auto dev = weak_dev.lock())
+        {
+            return dev->begin_property_transaction();
+        }
+        return nullptr;
+    };
+
+    write_queue_ = std::make_shared<tcam::property::PropertyWriteQueue>(begin_transaction);
+
     if (apply_software_properties_)
     {
-        property_filter_.setup(device_->get_properties(), available_output_formats_);
+        property_filter_.setup(device_->get_properties(),
+                               available_output_formats_,
+                               begin_transaction,
+                               change_notifier_,
+                               write_queue_);
     }
     const auto serial = device_->get_device_description().get_serial();
     index_.register_device_lost(deviceindex_lost_cb, this, serial);
@@ -85,9 +134,13 @@ CaptureDeviceImpl::~CaptureDeviceImpl()
 {
     stop_stream();
 
+    // executes the writes that are still queued
+    write_queue_.reset();
+
     available_output_formats_.clear();
 
-    index_.remove_device_lost(deviceindex_lost_cb);
+    // only the registration of this instance, other devices use the same callback
+    index_.remove_callbacks(this);
 
     device_.reset();
 }
@@ -110,6 +163,22 @@ bool CaptureDeviceImpl::register_device_lost_callback(tcam_device_lost_callback
     return device_->register_device_lost_callback(callback, user_data);
 }
 
+void CaptureDeviceImpl::register_device_event_callback(tcam_device_event_callback callback,
+                                                       void* user_data)
+{
+    device_->register_device_event_callback(callback, user_data);
+}
+
+outcome::result<void> CaptureDeviceImpl::enable_device_events(const std::vector<std::string>& names)
+{
+    return device_->enable_device_events(names);
+}
+
+outcome::result<void> CaptureDeviceImpl::set_heartbeat_timeout(std::chrono::milliseconds timeout)
+{
+    return device_->set_heartbeat_timeout(timeout);
+}
+
 void CaptureDeviceImpl::deviceindex_lost_cb(const DeviceInfo& info, void* user_data)
 {
     auto self = (CaptureDeviceImpl*)user_data;
@@ -135,6 +204,11 @@ std::vector<std::shared_ptr<tcam::property::IPropertyBase>> CaptureDeviceImpl::g
     }
 }
 
+std::unique_ptr<tcam::property::IPropertyTransaction> CaptureDeviceImpl::begin_property_transaction()
+{
+    return device_->begin_property_transaction();
+}
+
 std::vector<VideoFormatDescription> CaptureDeviceImpl::get_available_video_formats() const
 {
     return available_output_formats_;
@@ -164,11 +238,20 @@ bool CaptureDeviceImpl::configure_stream(const VideoFormat& format,
     {
         property_filter_.setVideoFormat(device_->get_active_video_format());
     }
+
+    const size_t required_buffer_size = device_->get_required_buffer_size();
+
     // if no pool is provided allocate an internal
     // default to userptr as all devices support that
     if (!pool)
     {
-        pool_ = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+        // keep the internal pool, its memory can be reused by the new format
+        if (!pool_ || !internal_pool_)
+        {
+            pool_ = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+            internal_pool_ = true;
+        }
+        pool_->set_min_buffer_size(required_buffer_size);
         auto ret = pool_->allocate(device_->get_active_video_format(), 10);
 
         // TODO: error handling
@@ -182,6 +265,8 @@ bool CaptureDeviceImpl::configure_stream(const VideoFormat& format,
     {
         SPDLOG_INFO("External pool");
         pool_ = pool;
+        internal_pool_ = false;
+        pool_->set_min_buffer_size(required_buffer_size);
         auto ret = pool_->allocate();
 
         if (!ret)
@@ -218,11 +303,20 @@ bool CaptureDeviceImpl::start_stream()
         return false;
     }
 
-    if (!sink_->start_stream(device_))
+    fanout_->set_requeue_target(device_);
+
+    // the first frame of a stream is always delivered
+    decimation_count_ = decimation_.frame_interval;
+    decimation_auto_count_ = 0;
+    decimation_next_ns_ = 0;
+
+    if (!sink_->start_stream(fanout_))
     {
         return false;
     }
 
+    update_roi_origin();
+
     if (!device_->start_stream(shared_from_this()))
     {
         SPDLOG_ERROR("Unable to start stream from device.");
@@ -237,6 +331,14 @@ bool CaptureDeviceImpl::start_stream()
 void CaptureDeviceImpl::stop_stream()
 {
     device_->stop_stream();
+
+    // frame numbers restart with the next stream
+    scheduler_.clear();
+
+    if (apply_software_properties_)
+    {
+        property_filter_.wait_for_pending();
+    }
     //device_->release_buffers();
     //sink_.reset();
 }
@@ -246,14 +348,219 @@ void CaptureDeviceImpl::set_drop_incomplete_frames(bool b)
     device_->set_drop_incomplete_frames(b);
 }
 
+void CaptureDeviceImpl::set_transport_options(const tcam_transport_options& options)
+{
+    device_->set_transport_options(options);
+}
+
+void CaptureDeviceImpl::set_salvage_options(const tcam_salvage_options& options)
+{
+    device_->set_salvage_options(options);
+}
+
+void CaptureDeviceImpl::set_chunk_mode(bool b)
+{
+    device_->set_chunk_mode(b);
+}
+
+void CaptureDeviceImpl::set_decimation_options(const tcam_decimation_options& options)
+{
+    decimation_ = options;
+    decimation_active_ = options.frame_interval > 1 || options.max_rate > 0.0;
+}
+
+void CaptureDeviceImpl::set_image_statistics_histogram(bool b)
+{
+    property_filter_.set_image_statistics_histogram(b);
+}
+
+void CaptureDeviceImpl::set_auto_group(const std::string& name, bool is_master)
+{
+    property_filter_.set_auto_group(name, is_master);
+}
+
+void CaptureDeviceImpl::set_locality_placement(bool b)
+{
+    device_->set_locality_placement(b);
+}
+
+int CaptureDeviceImpl::get_numa_node()
+{
+    return device_->get_numa_node();
+}
+
+std::optional<tcam_transport_statistics> CaptureDeviceImpl::get_transport_statistics()
+{
+    return device_->get_transport_statistics();
+}
+
+size_t CaptureDeviceImpl::get_staging_memory_size()
+{
+    return device_->get_staging_memory_size();
+}
+
 void CaptureDeviceImpl::push_image(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    TCAM_TRACE_SCOPE("CaptureDeviceImpl::push_image");
+
+    const bool has_scheduled_writes = !scheduler_.is_idle();
+    const uint64_t roi_origin = roi_origin_.load(std::memory_order_relaxed);
+    if (has_scheduled_writes || roi_origin != no_roi_origin)
+    {
+        auto stats = buffer->get_statistics();
+        if (roi_origin != no_roi_origin)
+        {
+            stats.has_roi_origin = true;
+            stats.roi_origin_x = static_cast<int32_t>(roi_origin >> 32);
+            stats.roi_origin_y = static_cast<int32_t>(roi_origin & 0xFFFFFFFF);
+        }
+        if (has_scheduled_writes)
+        {
+            // writes due after this frame can not have affected it
+            stats.settings_id = scheduler_.get_last_applied();
+        }
+        buffer->set_statistics(stats);
+
+        if (has_scheduled_writes)
+        {
+            scheduler_.apply(stats.frame_count);
+        }
+    }
+
+    if (decimation_active_ && decimate(buffer))
+    {
+        // goes back to the device directly, neither the sink nor the taps see it
+        fanout_->requeue_buffer(buffer);
+        return;
+    }
+
+    if (!tcam::latency::is_enabled())
+    {
+        if (apply_software_properties_)
+        {
+            TCAM_TRACE_SCOPE("software properties");
+            TCAM_USDT_PROBE(auto_pass_begin, buffer->get_frame_count(), buffer.get());
+            property_filter_.apply(buffer);
+            TCAM_USDT_PROBE(auto_pass_end, buffer->get_frame_count(), buffer.get());
+        }
+
+        fanout_->push_image(buffer, *sink_);
+        return;
+    }
+
+    auto stats = buffer->get_statistics();
+
     if (apply_software_properties_)
     {
-        property_filter_.apply(*buffer);
+        stats.auto_pass_begin_ns = tcam::latency::now_ns();
+        TCAM_TRACE_SCOPE("software properties");
+        TCAM_USDT_PROBE(auto_pass_begin, stats.frame_count, buffer.get());
+        property_filter_.apply(buffer);
+        TCAM_USDT_PROBE(auto_pass_end, stats.frame_count, buffer.get());
+        stats.auto_pass_end_ns = tcam::latency::now_ns();
+    }
+
+    stats.sink_push_time_ns = tcam::latency::now_ns();
+    buffer->set_statistics(stats);
+
+    // TCAM_METRICS implies latency tracing, the stamps are needed for the histograms
+    if (metrics_)
+    {
+        update_metrics(stats);
     }
 
-    sink_->push_image(buffer);
+    fanout_->push_image(buffer, *sink_);
+}
+
+bool CaptureDeviceImpl::decimate(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    bool deliver = ++decimation_count_ >= decimation_.frame_interval;
+
+    if (deliver && decimation_.max_rate > 0.0)
+    {
+        uint64_t now = buffer->get_statistics().capture_time_ns;
+        if (now == 0)
+        {
+            now = tcam::latency::now_ns();
+        }
+
+        const auto period = static_cast<uint64_t>(1'000'000'000.0 / decimation_.max_rate);
+        if (now < decimation_next_ns_)
+        {
+            deliver = false;
+        }
+        else
+        {
+            // keeps the average rate when the camera frames do not line up with the period,
+            // after a gap the schedule starts over
+            decimation_next_ns_ += period;
+            if (decimation_next_ns_ <= now)
+            {
+                decimation_next_ns_ = now + period;
+            }
+        }
+    }
+
+    if (deliver)
+    {
+        decimation_count_ = 0;
+        return false;
+    }
+
+    if (apply_software_properties_ && decimation_.auto_interval > 0
+        && ++decimation_auto_count_ >= decimation_.auto_interval)
+    {
+        decimation_auto_count_ = 0;
+        TCAM_TRACE_SCOPE("software properties");
+        property_filter_.apply(buffer);
+    }
+    return true;
+}
+
+bool CaptureDeviceImpl::wants_partial_images() const
+{
+    return sink_ && sink_->wants_partial_images();
+}
+
+void CaptureDeviceImpl::push_partial_image(const std::shared_ptr<ImageBuffer>& buffer,
+                                           unsigned int lines_complete)
+{
+    sink_->push_partial_image(buffer, lines_complete);
+}
+
+bool CaptureDeviceImpl::wants_frame_incoming() const
+{
+    return sink_ && sink_->wants_frame_incoming();
+}
+
+void CaptureDeviceImpl::push_frame_incoming(uint64_t sequence, uint64_t timestamp_ns)
+{
+    sink_->push_frame_incoming(sequence, timestamp_ns);
+}
+
+void CaptureDeviceImpl::update_metrics(const tcam_stream_statistics& stats)
+{
+    // only called from the thread delivering the images
+    metrics_->frames_delivered.inc();
+    metrics_->frames_dropped.set(stats.frames_dropped);
+    metrics_->frames_dropped_no_buffer.set(stats.drops.no_buffer);
+    metrics_->frames_dropped_transport.set(stats.drops.transport);
+    metrics_->frames_dropped_incomplete.set(stats.drops.incomplete);
+    if (stats.is_damaged)
+    {
+        metrics_->frames_damaged.inc();
+    }
+
+    if (stats.has_transport_statistics)
+    {
+        metrics_->resent_packets.set(stats.transport.resent_packets);
+        metrics_->missing_packets.set(stats.transport.missing_packets);
+        metrics_->failed_buffers.set(stats.transport.failed_buffers);
+        metrics_->underruns.set(stats.transport.underruns);
+    }
+
+    metrics_->latency_auto_pass.observe(stats.auto_pass_begin_ns, stats.auto_pass_end_ns);
+    metrics_->latency_backend.observe(stats.dequeue_time_ns, stats.sink_push_time_ns);
 }
 
 outcome::result<tcam::framerate_info> CaptureDeviceImpl::get_framerate_info(const VideoFormat& fmt)
@@ -265,3 +572,107 @@ std::shared_ptr<tcam::AllocatorInterface> CaptureDeviceImpl::get_allocator()
 {
     return device_->get_allocator();
 }
+
+uint64_t CaptureDeviceImpl::schedule_property_write(
+    uint64_t after_frame,
+    tcam::property::PropertyScheduler::write_function write)
+{
+    return scheduler_.schedule(after_frame, std::move(write));
+}
+
+void CaptureDeviceImpl::clear_scheduled_property_writes()
+{
+    scheduler_.clear();
+}
+
+void CaptureDeviceImpl::queue_property_write(
+    const std::string& name,
+    tcam::property::PropertyWriteQueue::write_function write,
+    tcam::property::PropertyWriteQueue::completion_function done)
+{
+    write_queue_->submit(name, std::move(write), std::move(done));
+}
+
+std::future<outcome::result<void>> CaptureDeviceImpl::queue_property_write(
+    const std::string& name,
+    tcam::property::PropertyWriteQueue::write_function write)
+{
+    return write_queue_->submit(name, std::move(write));
+}
+
+void CaptureDeviceImpl::wait_for_property_writes()
+{
+    write_queue_->wait_idle();
+}
+
+void CaptureDeviceImpl::update_roi_origin()
+{
+    using namespace tcamprop1::prop_list;
+
+    const auto properties = device_->get_properties();
+    auto offset_x = tcam::property::find_property<tcam::property::IPropertyInteger>(
+        properties, OffsetX.name);
+    auto offset_y = tcam::property::find_property<tcam::property::IPropertyInteger>(
+        properties, OffsetY.name);
+
+    if (!offset_x || !offset_y)
+    {
+        roi_origin_ = no_roi_origin;
+        return;
+    }
+    auto x = offset_x->get_value();
+    auto y = offset_y->get_value();
+    roi_origin_ = (x && y) ? pack_roi_origin(x.value(), y.value()) : no_roi_origin;
+}
+
+outcome::result<void> CaptureDeviceImpl::move_roi(int64_t offset_x, int64_t offset_y)
+{
+    TCAM_TRACE_SCOPE("CaptureDeviceImpl::move_roi");
+
+    using namespace tcamprop1::prop_list;
+
+    // the device properties, the software properties do not wrap the offsets
+    const auto properties = device_->get_properties();
+    auto prop_x = tcam::property::find_property<tcam::property::IPropertyInteger>(
+        properties, OffsetX.name);
+    auto prop_y = tcam::property::find_property<tcam::property::IPropertyInteger>(
+        properties, OffsetY.name);
+    if (!prop_x || !prop_y)
+    {
+        return tcam::status::PropertyNotImplemented;
+    }
+
+    // checked before anything is written, a rejected move must not leave half of it applied
+    OUTCOME_TRY(check_offset(*prop_x, offset_x));
+    OUTCOME_TRY(check_offset(*prop_y, offset_y));
+
+    {
+        // v4l2 sends both values with one VIDIOC_S_EXT_CTRLS
+        auto transaction = device_->begin_property_transaction();
+        OUTCOME_TRY(prop_x->set_value(offset_x));
+        OUTCOME_TRY(prop_y->set_value(offset_y));
+        OUTCOME_TRY(transaction->commit());
+    }
+
+    roi_origin_ = pack_roi_origin(offset_x, offset_y);
+
+    // the device properties do not report their writes
+    change_notifier_->notify(OffsetX.name);
+    change_notifier_->notify(OffsetY.name);
+    return outcome::success();
+}
+
+int CaptureDeviceImpl::add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers)
+{
+    return fanout_->add_tap(std::move(sink), max_buffers);
+}
+
+void CaptureDeviceImpl::remove_tap(int id)
+{
+    fanout_->remove_tap(id);
+}
+
+uint64_t CaptureDeviceImpl::get_tap_frames_dropped(int id) const
+{
+    return fanout_->get_frames_dropped(id);
+}
@@ -17,15 +17,22 @@
 #ifndef TCAM_CAPTUREDEVICEIMPL_H
 #define TCAM_CAPTUREDEVICEIMPL_H
 
+#include "BufferFanout.h"
 #include "DeviceIndex.h"
 #include "DeviceInfo.h"
 #include "DeviceInterface.h"
 #include "ImageSink.h"
 #include "VideoFormat.h"
+#include "PropertyChangeNotifier.h"
 #include "PropertyFilter.h"
+#include "PropertyScheduler.h"
+#include "PropertyWriteQueue.h"
 #include "BufferPool.h"
+#include "metrics.h"
 
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -67,10 +74,23 @@ public:
 
     bool register_device_lost_callback(tcam_device_lost_callback callback, void* user_data);
 
+    void register_device_event_callback(tcam_device_event_callback callback, void* user_data);
+
+    outcome::result<void> enable_device_events(const std::vector<std::string>& names);
+
+    outcome::result<void> set_heartbeat_timeout(std::chrono::milliseconds timeout);
+
     // property related:
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties();
 
+    std::unique_ptr<tcam::property::IPropertyTransaction> begin_property_transaction();
+
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> get_property_change_notifier() const
+    {
+        return change_notifier_;
+    }
+
     /**
      * @return vector containing all available video format settings
      */
@@ -121,12 +141,59 @@ public:
 
     void set_drop_incomplete_frames(bool b);
 
+    void set_transport_options(const tcam_transport_options& options);
+
+    void set_salvage_options(const tcam_salvage_options& options);
+
+    void set_chunk_mode(bool b);
+
+    // has to be set while no stream is running
+    void set_decimation_options(const tcam_decimation_options& options);
+
+    void set_image_statistics_histogram(bool b);
+
+    // has to be set while no stream is running
+    void set_auto_group(const std::string& name, bool is_master);
+
+    void set_locality_placement(bool b);
+    int get_numa_node();
+
+    std::optional<tcam_transport_statistics> get_transport_statistics();
+
+    size_t get_staging_memory_size();
+
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
     std::shared_ptr<tcam::AllocatorInterface> get_allocator();
 
+    uint64_t schedule_property_write(uint64_t after_frame,
+                                     tcam::property::PropertyScheduler::write_function write);
+    void clear_scheduled_property_writes();
+
+    void queue_property_write(const std::string& name,
+                              tcam::property::PropertyWriteQueue::write_function write,
+                              tcam::property::PropertyWriteQueue::completion_function done);
+    std::future<outcome::result<void>> queue_property_write(
+        const std::string& name,
+        tcam::property::PropertyWriteQueue::write_function write);
+    void wait_for_property_writes();
+
+    outcome::result<void> move_roi(int64_t offset_x, int64_t offset_y);
+
+    int add_tap(std::shared_ptr<IImageBufferSink> sink, unsigned int max_buffers);
+    void remove_tap(int id);
+    uint64_t get_tap_frames_dropped(int id) const;
+
 private:
     void push_image(const std::shared_ptr<ImageBuffer>& buffer) final;
+    bool wants_partial_images() const final;
+    void push_partial_image(const std::shared_ptr<ImageBuffer>& buffer,
+                            unsigned int lines_complete) final;
+    bool wants_frame_incoming() const final;
+    void push_frame_incoming(uint64_t sequence, uint64_t timestamp_ns) final;
+
+    // true when buffer shall not be delivered
+    bool decimate(const std::shared_ptr<ImageBuffer>& buffer);
 
     static void deviceindex_lost_cb(const DeviceInfo&, void* user_data);
 
@@ -145,11 +212,39 @@ private:
     std::vector<VideoFormatDescription> available_output_formats_;
 
     std::shared_ptr<ImageSink> sink_;
+    std::shared_ptr<BufferFanout> fanout_ = std::make_shared<BufferFanout>();
     std::shared_ptr<BufferPool> pool_ = nullptr;
+    bool internal_pool_ = false;
+
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> change_notifier_ =
+        std::make_shared<tcam::property::PropertyChangeNotifier>();
+
+    tcam::property::PropertyScheduler scheduler_;
+
+    // shared with the auto functions, released before device_
+    std::shared_ptr<tcam::property::PropertyWriteQueue> write_queue_;
+
+    // OffsetX in the upper, OffsetY in the lower 32 bits, so that frames never see half a move
+    // no_roi_origin when the device has no offsets
+    static constexpr uint64_t no_roi_origin = UINT64_MAX;
+    std::atomic<uint64_t> roi_origin_ = no_roi_origin;
+    // reads the offsets of the device into roi_origin_
+    void update_roi_origin();
+
+    // only touched by the stream thread while streaming
+    tcam_decimation_options decimation_;
+    bool decimation_active_ = false;
+    unsigned int decimation_count_ = 0;
+    unsigned int decimation_auto_count_ = 0;
+    uint64_t decimation_next_ns_ = 0;
 
     bool apply_software_properties_ = true;
     tcam::stream::filter::SoftwarePropertyWrapper property_filter_;
 
+    // nullptr when TCAM_METRICS is not set
+    std::shared_ptr<tcam::metrics::stream_metrics> metrics_;
+    void update_metrics(const tcam_stream_statistics& stats);
+
 }; /* class CaptureDeviceImpl */
 
 } /* namespace tcam */
@@ -0,0 +1,185 @@
+#include "DeliveryWorker.h"
+
+#include "logging.h"
+#include "scope_tracing.h"
+#include "utils.h"
+
+#include <algorithm>
+
+using namespace tcam;
+
+std::weak_ptr<DeliveryWorker> DeliveryWorker::instance_ptr;
+
+namespace
+{
+
+unsigned int get_thread_count()
+{
+    auto env_count = tcam::get_environment_variable_int("TCAM_DELIVERY_THREADS");
+
+    if (env_count && env_count.value() > 0)
+    {
+        return env_count.value();
+    }
+    return 0;
+}
+
+} // namespace
+
+
+DeliveryWorker::DeliveryWorker(unsigned int thread_count)
+{
+    for (unsigned int i = 0; i < thread_count; ++i)
+    {
+        threads_.emplace_back(&DeliveryWorker::run, this);
+    }
+}
+
+
+DeliveryWorker::~DeliveryWorker()
+{
+    {
+        std::scoped_lock lock(mtx_);
+        continue_thread_ = false;
+    }
+    cv_.notify_all();
+
+    for (auto& t : threads_)
+    {
+        try
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+        catch (const std::system_error& err)
+        {
+            SPDLOG_ERROR("Unable to join thread. Exception: {}", err.what());
+        }
+    }
+}
+
+
+std::shared_ptr<DeliveryWorker> DeliveryWorker::get_instance()
+{
+    static std::mutex instance_mtx;
+    std::scoped_lock lock(instance_mtx);
+
+    auto obj = instance_ptr.lock();
+
+    if (!obj)
+    {
+        obj = std::shared_ptr<DeliveryWorker>(new DeliveryWorker(std::max(get_thread_count(), 1u)));
+
+        instance_ptr = obj;
+    }
+
+    return obj;
+}
+
+
+bool DeliveryWorker::is_enabled()
+{
+    return get_thread_count() > 0;
+}
+
+
+int DeliveryWorker::add_client()
+{
+    std::scoped_lock lock(mtx_);
+
+    const int id = next_id_++;
+    clients_[id];
+    return id;
+}
+
+
+void DeliveryWorker::remove_client(int id)
+{
+    std::unique_lock lock(mtx_);
+
+    auto iter = clients_.find(id);
+    if (iter == clients_.end())
+    {
+        return;
+    }
+
+    iter->second.jobs.clear();
+    ready_.erase(std::remove(ready_.begin(), ready_.end(), id), ready_.end());
+
+    cv_done_.wait(lock, [&iter] { return !iter->second.is_running; });
+
+    clients_.erase(iter);
+}
+
+
+bool DeliveryWorker::submit(int id, std::function<void()>&& job)
+{
+    {
+        std::scoped_lock lock(mtx_);
+        if (!continue_thread_)
+        {
+            return false;
+        }
+
+        auto iter = clients_.find(id);
+        if (iter == clients_.end())
+        {
+            return false;
+        }
+
+        auto& c = iter->second;
+        c.jobs.push_back(std::move(job));
+        if (!c.is_running && c.jobs.size() == 1)
+        {
+            ready_.push_back(id);
+        }
+    }
+    cv_.notify_one();
+    return true;
+}
+
+
+void DeliveryWorker::run()
+{
+    tcam::set_thread_name("tcam_delivery");
+    tcam::apply_thread_config(tcam::thread_role::delivery);
+
+    std::unique_lock lock(mtx_);
+    while (true)
+    {
+        cv_.wait(lock, [this] { return !continue_thread_ || !ready_.empty(); });
+
+        if (ready_.empty())
+        {
+            return;
+        }
+
+        const int id = ready_.front();
+        ready_.pop_front();
+
+        // clients are only erased while they are not running
+        auto& c = clients_.at(id);
+
+        std::function<void()> job = std::move(c.jobs.front());
+        c.jobs.pop_front();
+        c.is_running = true;
+
+        lock.unlock();
+        {
+            TCAM_TRACE_SCOPE("DeliveryWorker job");
+            job();
+        }
+        lock.lock();
+
+        c.is_running = false;
+        // back of the queue, the other clients are served first
+        if (!c.jobs.empty())
+        {
+            ready_.push_back(id);
+            cv_.notify_one();
+        }
+        cv_done_.notify_all();
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+// Thread pool that completes the frames of several devices,
+// so that the backend receive threads only deal with the transport.
+//
+// Every device is a client with its own queue.
+// The clients are served round robin, one job of a client at a time,
+// so the frames of a device keep their order and a busy device
+// can not starve the others.
+// A job holds one of the buffers of its device,
+// a device that falls behind runs out of buffers instead of growing its queue.
+//
+// Like the AutoPassWorker this is a pseudo singleton.
+class DeliveryWorker
+{
+public:
+    static std::shared_ptr<DeliveryWorker> get_instance();
+
+    // TCAM_DELIVERY_THREADS > 0
+    static bool is_enabled();
+
+    ~DeliveryWorker();
+
+    int add_client();
+
+    // pending jobs are discarded, waits for a running job of the client
+    // must not be called from a job
+    void remove_client(int id);
+
+    // returns false when the client is unknown
+    bool submit(int id, std::function<void()>&& job);
+
+private:
+    static std::weak_ptr<DeliveryWorker> instance_ptr;
+
+    explicit DeliveryWorker(unsigned int thread_count);
+
+    void run();
+
+    struct client
+    {
+        std::deque<std::function<void()>> jobs;
+        bool is_running = false;
+    };
+
+    bool continue_thread_ = true;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable cv_done_;
+
+    int next_id_ = 1;
+    std::map<int, client> clients_;
+    // clients with pending jobs that are not running
+    std::deque<int> ready_;
+
+    std::vector<std::thread> threads_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -30,19 +30,20 @@ DeviceIndex::DeviceIndex()
 
 DeviceIndex::~DeviceIndex()
 {
-    for (auto& cb : callbacks) { indexer_->remove_device_lost(cb); }
+    for (auto& cb : callbacks) { indexer_->remove_device_lost(cb.callback); }
+    for (auto& cb : added_callbacks_) { indexer_->remove_device_added(cb.callback); }
 }
 
 void DeviceIndex::register_device_lost(dev_callback c, void* user_data)
 {
-    callbacks.push_back(c);
+    callbacks.push_back({ c, user_data });
 
     indexer_->register_device_lost(c, user_data);
 }
 
 void DeviceIndex::register_device_lost(dev_callback c, void* user_data, const std::string& serial)
 {
-    callbacks.push_back(c);
+    callbacks.push_back({ c, user_data });
 
     indexer_->register_device_lost(c, user_data, serial);
 }
@@ -54,7 +55,7 @@ void DeviceIndex::remove_device_lost(dev_callback callback)
     auto it = std::begin(callbacks); //std::begin is a free function in C++11
     for (const auto& value : callbacks)
     {
-        if (value == callback)
+        if (value.callback == callback)
         {
             callbacks.erase(it);
             break;
@@ -63,6 +64,37 @@ void DeviceIndex::remove_device_lost(dev_callback callback)
     }
 }
 
+void DeviceIndex::register_device_added(dev_callback c, void* user_data)
+{
+    added_callbacks_.push_back({ c, user_data });
+
+    indexer_->register_device_added(c, user_data);
+}
+
+void DeviceIndex::remove_device_added(dev_callback callback)
+{
+    indexer_->remove_device_added(callback);
+
+    auto it = std::find_if(added_callbacks_.begin(),
+                           added_callbacks_.end(),
+                           [callback](const registration& r) { return r.callback == callback; });
+    if (it != added_callbacks_.end())
+    {
+        added_callbacks_.erase(it);
+    }
+}
+
+void DeviceIndex::remove_callbacks(void* user_data)
+{
+    indexer_->remove_callbacks(user_data);
+
+    auto matches = [user_data](const registration& r) { return r.user_data == user_data; };
+    callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), matches), callbacks.end());
+    added_callbacks_.erase(
+        std::remove_if(added_callbacks_.begin(), added_callbacks_.end(), matches),
+        added_callbacks_.end());
+}
+
 std::vector<DeviceInfo> DeviceIndex::get_device_list() const
 {
     if (!indexer_)
@@ -73,3 +105,15 @@ std::vector<DeviceInfo> DeviceIndex::get_device_list() const
 
     return indexer_->get_device_list();
 }
+
+std::optional<DeviceInfo> DeviceIndex::find_device(const std::string& serial,
+                                                   TCAM_DEVICE_TYPE type) const
+{
+    if (!indexer_)
+    {
+        SPDLOG_ERROR("No Indexer present. Unable to search for device");
+        return std::nullopt;
+    }
+
+    return indexer_->find_device(serial, type);
+}
@@ -21,6 +21,7 @@
 #include "base_types.h"
 
 #include <memory>
+#include <optional>
 #include <vector>
 #include <string>
 
@@ -53,6 +54,14 @@ public:
 
     std::vector<DeviceInfo> get_device_list() const;
 
+    /**
+     * @name find_device
+     * @param serial - serial of the wanted device, empty for the first device
+     * @param type - only this backend is enumerated, TCAM_DEVICE_TYPE_UNKNOWN for all
+     * @brief Returns without waiting for backends that are not needed for the answer
+     */
+    std::optional<DeviceInfo> find_device(const std::string& serial,
+                                          TCAM_DEVICE_TYPE type = TCAM_DEVICE_TYPE_UNKNOWN) const;
 
     /**
      * @name register_device_lost
@@ -77,10 +86,42 @@ public:
      * @brief
      */
     void remove_device_lost(dev_callback callback);
+
+    /**
+     * @name register_device_added
+     * @param callback - function pointer to use
+     * @brief callback is invoked for every device that appears after registration
+     */
+    void register_device_added(dev_callback callback, void* user_data);
+
+    /**
+     * @name remove_device_added
+     * @param callback - function pointer to use
+     * @brief
+     */
+    void remove_device_added(dev_callback callback);
+
+    /**
+     * @name remove_callbacks
+     * @param user_data - user_data the callbacks were registered with
+     * @brief Removes all lost and added callbacks of user_data.
+     *        Callbacks that are currently executed are waited for,
+     *        so user_data can be freed afterwards.
+     *        Must not be called while holding a lock one of the callbacks takes.
+     */
+    void remove_callbacks(void* user_data);
+
 private:
     std::shared_ptr<Indexer> indexer_;
 
-    std::vector<dev_callback> callbacks;
+    struct registration
+    {
+        dev_callback callback;
+        void* user_data;
+    };
+
+    std::vector<registration> callbacks;
+    std::vector<registration> added_callbacks_;
 };
 
 } /* namespace tcam */
@@ -17,6 +17,7 @@
 #include "DeviceInterface.h"
 
 #include "base_types.h"
+#include "devicelibrary.h"
 #include "logging.h"
 
 #include <algorithm>
@@ -43,37 +44,39 @@
 using namespace tcam;
 
 
-std::vector<DeviceInfo> tcam::get_device_list()
+std::vector<BackendInterface*> tcam::get_backend_list()
 {
-    std::vector<DeviceInfo> ret;
+    std::vector<BackendInterface*> ret;
 
 #ifdef HAVE_ARAVIS
-
-    auto arv_list = AravisBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), arv_list.begin(), arv_list.end());
-
+    ret.push_back(AravisBackend::get_instance());
 #endif
 
 #ifdef HAVE_V4L2
-
-    auto v4l2_list = V4L2Backend::get_instance()->get_device_list();
-    ret.insert(ret.end(), v4l2_list.begin(), v4l2_list.end());
-
+    ret.push_back(V4L2Backend::get_instance());
 #endif
 
 #ifdef HAVE_LIBUSB
-
-    auto usb_list = LibUsbBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), usb_list.begin(), usb_list.end());
-
+    ret.push_back(LibUsbBackend::get_instance());
 #endif
 
 #ifdef HAVE_VIRTCAM
+    ret.push_back(virtcam::VirtBackend::get_instance());
+#endif
 
-    auto virtcam_list = virtcam::VirtBackend::get_instance()->get_device_list();
-    ret.insert(ret.end(), virtcam_list.begin(), virtcam_list.end());
+    return ret;
+}
 
-#endif
+
+std::vector<DeviceInfo> tcam::get_device_list()
+{
+    std::vector<DeviceInfo> ret;
+
+    for (auto backend : get_backend_list())
+    {
+        auto lst = backend->get_device_list();
+        ret.insert(ret.end(), lst.begin(), lst.end());
+    }
 
     return ret;
 }
@@ -145,16 +148,34 @@ std::shared_ptr<DeviceInterface> tcam::open_device_interface(const DeviceInfo& d
 
 outcome::result<tcam::framerate_info> DeviceInterface::get_framerate_info(const VideoFormat& fmt)
 {
-    for (auto&& desc : get_available_video_formats())
+    std::scoped_lock lck { framerate_table_mutex_ };
+
+    // caps queries ask for every resolution, e.g. while a slider is moved
+    if (!framerate_table_)
     {
-        if (desc.get_fourcc() == fmt.get_fourcc())
-        {
-            auto lst = desc.get_framerates(fmt);
-            if (!lst.empty())
-            {
-                return tcam::framerate_info { lst };
-            }
-        }
+        framerate_table_.emplace(get_available_video_formats());
+    }
+
+    if (auto lst = framerate_table_->find(fmt))
+    {
+        return tcam::framerate_info { *lst };
     }
     return tcam::status::FormatInvalid;
 }
+
+namespace
+{
+class immediate_property_transaction : public tcam::property::IPropertyTransaction
+{
+public:
+    outcome::result<void> commit() final
+    {
+        return outcome::success();
+    }
+};
+} // namespace
+
+std::unique_ptr<tcam::property::IPropertyTransaction> DeviceInterface::begin_property_transaction()
+{
+    return std::make_unique<immediate_property_transaction>();
+}
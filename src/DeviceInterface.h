@@ -26,8 +26,13 @@
 #include "VideoFormat.h"
 #include "VideoFormatDescription.h"
 #include "compiler_defines.h"
+#include "framerate_table.h"
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -36,9 +41,13 @@ namespace tcam
 {
 
 class DeviceInterface;
+class BackendInterface;
 
     std::vector<DeviceInfo> get_device_list();
 
+    // all backends this library was built with
+    std::vector<BackendInterface*> get_backend_list();
+
     // open device interface correlating to device
     // returns nullptr and logs error on failure
     std::shared_ptr<DeviceInterface> open_device_interface(const DeviceInfo& device);
@@ -109,13 +118,98 @@ public:
         return true;
     }
 
+    // callbacks have to be registered before enable_device_events
+    void register_device_event_callback(tcam_device_event_callback callback, void* user_data)
+    {
+        event_callbacks.push_back({ callback, user_data });
+    }
+
+    /**
+     * Let the device send the given events, e.g. "ExposureEnd", "FrameTriggerWait"
+     * Events that were enabled before and are not in names are disabled.
+     * An empty list disables all events.
+     */
+    virtual outcome::result<void> enable_device_events(const std::vector<std::string>& names)
+    {
+        if (names.empty())
+        {
+            return outcome::success();
+        }
+        return tcam::status::NotImplemented;
+    }
+
+    // time without control traffic after which the device ends the connection
+    virtual outcome::result<void> set_heartbeat_timeout(std::chrono::milliseconds /*timeout*/)
+    {
+        return tcam::status::NotImplemented;
+    }
+
     void set_drop_incomplete_frames(bool b)
     {
         drop_incomplete_frames_ = b;
     }
 
+    // applied on the next start_stream
+    void set_transport_options(const tcam_transport_options& options)
+    {
+        transport_options_ = options;
+    }
+
+    // applied on the next start_stream
+    // has no effect while incomplete frames are dropped
+    void set_salvage_options(const tcam_salvage_options& options)
+    {
+        salvage_options_ = options;
+    }
+
+    // applied on the next set_video_format
+    // images then carry the GenICam chunk data, see ImageBuffer::get_chunk_data_info
+    // devices without chunk support ignore this
+    void set_chunk_mode(bool b)
+    {
+        chunk_mode_ = b;
+    }
+
+    // the size the buffers for the active video format need,
+    // larger than the image when the device appends data to it
+    virtual size_t get_required_buffer_size()
+    {
+        return get_active_video_format().get_required_buffer_size();
+    }
+
+    // std::nullopt when the device has no transport statistics or is not streaming
+    virtual std::optional<tcam_transport_statistics> get_transport_statistics()
+    {
+        return std::nullopt;
+    }
+
+    // memory the backend allocates next to the BufferPool, e.g. usb transfer staging
+    virtual size_t get_staging_memory_size()
+    {
+        return 0;
+    }
+
+    // numa node of the usb host controller or network interface the device is attached to,
+    // -1 when it is unknown
+    virtual int get_numa_node()
+    {
+        return -1;
+    }
+
+    // applied on the next start_stream
+    // the stream threads the backend starts for this device run on the cpus of get_numa_node()
+    void set_locality_placement(bool b)
+    {
+        locality_placement_ = b;
+    }
+
+    // default implementation looks fmt up in a table of get_available_video_formats,
+    // which is built on the first call, the formats must not change afterwards
     virtual outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    // default implementation writes every property immediately
+    virtual std::unique_ptr<tcam::property::IPropertyTransaction> begin_property_transaction();
+
 protected:
     DeviceInfo device;
 
@@ -126,7 +220,22 @@ protected:
         for (const auto& cc : lost_callbacks) { cc.callback(&dev, cc.user_data); }
     }
 
+    void notify_device_event(const tcam_device_event& event)
+    {
+        for (const auto& cc : event_callbacks) { cc.callback(&event, cc.user_data); }
+    }
+
     bool drop_incomplete_frames_ = true;
+    tcam_transport_options transport_options_;
+    tcam_salvage_options salvage_options_;
+    bool chunk_mode_ = false;
+    bool locality_placement_ = false;
+
+    // node for apply_thread_config, -1 without locality placement
+    int get_placement_numa_node()
+    {
+        return locality_placement_ ? get_numa_node() : -1;
+    }
 
 private:
     struct callback_container
@@ -136,6 +245,17 @@ private:
     };
 
     std::vector<callback_container> lost_callbacks;
+
+    struct event_callback_container
+    {
+        tcam_device_event_callback callback;
+        void* user_data;
+    };
+
+    std::vector<event_callback_container> event_callbacks;
+
+    std::mutex framerate_table_mutex_;
+    std::optional<framerate_table> framerate_table_;
 }; /* class Camera_Interface */
 
 
@@ -0,0 +1,624 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DirectCapture.h"
+
+#include "Allocator.h"
+#include "BufferPool.h"
+#include "CaptureDevice.h"
+#include "ImageBuffer.h"
+#include "ImageSink.h"
+#include "logging.h"
+
+#include <chrono>
+#include <dutils_img/dutils_img.h>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+
+#include "../libs/dutils_image/src/dutils_img_filter/codec/lossless/lossless_codec.h"
+
+using namespace tcam;
+
+namespace
+{
+// raw buffers of a compressed ring, they only hold the frames waiting for the encoder
+constexpr size_t encode_buffer_count = 8;
+
+img_filter::codec::lossless::encode_function_type select_encode(const img::img_type& type)
+{
+#if !defined DUTILS_ARCH_ARM
+    if ((img_lib::cpu::get_features() & img::cpu::CPU_AVX2) != 0)
+    {
+        if (auto func = img_filter::codec::lossless::get_encode_avx2(type))
+        {
+            return func;
+        }
+    }
+#endif
+    return img_filter::codec::lossless::get_encode_c(type);
+}
+} // namespace
+
+outcome::result<std::unique_ptr<DirectCapture>> DirectCapture::open(const std::string& serial,
+                                                                     TCAM_DEVICE_TYPE type)
+{
+    auto dev = tcam::open_device(serial, type);
+    if (!dev)
+    {
+        return status::DeviceCouldNotBeOpened;
+    }
+
+    auto self = std::unique_ptr<DirectCapture>(new DirectCapture());
+    self->device_ = dev;
+    self->format_ = dev->get_active_video_format();
+
+    dev->register_device_lost_callback(&DirectCapture::device_lost_callback, self.get());
+
+    return self;
+}
+
+
+DirectCapture::~DirectCapture()
+{
+    stop();
+}
+
+
+std::vector<VideoFormatDescription> DirectCapture::get_available_video_formats() const
+{
+    return device_->get_available_video_formats();
+}
+
+
+outcome::result<void> DirectCapture::set_video_format(const VideoFormat& format)
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        if (is_streaming_)
+        {
+            SPDLOG_ERROR("The video format cannot be changed while streaming.");
+            return status::ResourceNotLockable;
+        }
+    }
+
+    if (!device_->set_video_format(format))
+    {
+        return status::FormatInvalid;
+    }
+    format_ = device_->get_active_video_format();
+    return outcome::success();
+}
+
+
+VideoFormat DirectCapture::get_video_format() const
+{
+    return format_;
+}
+
+
+outcome::result<void> DirectCapture::start(size_t buffer_count)
+{
+    callback_ = nullptr;
+    if (!pool_)
+    {
+        pool_ = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+    }
+    return start_stream(buffer_count, pool_);
+}
+
+
+outcome::result<void> DirectCapture::start(frame_callback cb, size_t buffer_count)
+{
+    if (!cb)
+    {
+        return status::InvalidParameter;
+    }
+    callback_ = std::move(cb);
+    if (!pool_)
+    {
+        pool_ = std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, device_->get_allocator());
+    }
+    return start_stream(buffer_count, pool_);
+}
+
+
+outcome::result<void> DirectCapture::start_burst(size_t frame_count)
+{
+    if (!burst_pool_)
+    {
+        // huge pages imply prefaulted, locked memory, so no page fault hits the stream thread
+        allocator_options opt;
+        opt.use_huge_pages = true;
+        opt.numa_node = device_->get_numa_node();
+        burst_pool_ =
+            std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, get_page_allocator(opt));
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        if (is_streaming_)
+        {
+            return status::ResourceNotLockable;
+        }
+        callback_ = nullptr;
+        burst_.clear();
+        burst_.reserve(frame_count);
+        burst_count_ = frame_count;
+    }
+
+    auto res = start_stream(frame_count, burst_pool_);
+    if (!res)
+    {
+        std::scoped_lock lck { mtx_ };
+        burst_count_ = 0;
+    }
+    return res;
+}
+
+
+outcome::result<std::vector<DirectCapture::frame>> DirectCapture::wait_for_burst(int timeout_ms)
+{
+    std::vector<std::shared_ptr<ImageBuffer>> buffers;
+    {
+        std::unique_lock lck { mtx_ };
+        if (burst_count_ == 0 || !is_streaming_)
+        {
+            return status::UndefinedError;
+        }
+
+        cv_.wait_for(lck,
+                     std::chrono::milliseconds(timeout_ms),
+                     [this] { return burst_.size() >= burst_count_ || device_lost_; });
+
+        if (device_lost_)
+        {
+            return status::DeviceLost;
+        }
+        if (burst_.size() < burst_count_)
+        {
+            return status::Timeout;
+        }
+        buffers = std::move(burst_);
+        burst_.clear();
+        burst_count_ = 0;
+    }
+
+    // the buffers stay with the frames, the device has none left to write to
+    stop();
+
+    std::vector<frame> frames;
+    frames.reserve(buffers.size());
+    for (auto& buffer : buffers)
+    {
+        frame f;
+        f.data = buffer->get_image_buffer_ptr();
+        f.length = buffer->get_valid_data_length();
+        f.statistics = buffer->get_statistics();
+        f.image_statistics = buffer->get_image_statistics();
+        f.buffer = std::move(buffer);
+        frames.push_back(std::move(f));
+    }
+    return frames;
+}
+
+
+outcome::result<void> DirectCapture::start_ring(size_t frame_count, bool compress)
+{
+    if (frame_count == 0)
+    {
+        return status::InvalidParameter;
+    }
+
+    img_filter::codec::lossless::encode_function_type encode = nullptr;
+    if (compress)
+    {
+        const auto type = format_.get_img_type();
+        if (img_filter::codec::lossless::is_supported_type(type))
+        {
+            encode = select_encode(type);
+        }
+        if (!encode)
+        {
+            SPDLOG_ERROR("{} cannot be compressed.", format_.to_string());
+            return status::FormatInvalid;
+        }
+        encoded_max_size_ = img_filter::codec::lossless::calc_max_encoded_size(type);
+    }
+
+    if (!burst_pool_)
+    {
+        allocator_options opt;
+        opt.use_huge_pages = true;
+        opt.numa_node = device_->get_numa_node();
+        burst_pool_ =
+            std::make_shared<BufferPool>(TCAM_MEMORY_TYPE_USERPTR, get_page_allocator(opt));
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        if (is_streaming_)
+        {
+            return status::ResourceNotLockable;
+        }
+        callback_ = nullptr;
+        ring_.clear();
+        encoded_ring_.clear();
+        encode_queue_.clear();
+        ring_count_ = frame_count;
+        ring_compress_ = compress;
+    }
+
+    size_t buffer_count = frame_count + 2;
+    if (compress)
+    {
+        encode_ = [encode](const ImageBuffer& buffer, void* dst, size_t dst_size)
+        { return encode(buffer.get_img_descriptor(), dst, dst_size); };
+        encode_thread_ = std::thread(&DirectCapture::encode_loop, this);
+        buffer_count = encode_buffer_count;
+    }
+
+    // the spare buffers are written while the oldest frame of a full ring is requeued
+    auto res = start_stream(buffer_count, burst_pool_);
+    if (!res)
+    {
+        stop_encoder();
+        std::scoped_lock lck { mtx_ };
+        ring_count_ = 0;
+    }
+    return res;
+}
+
+
+outcome::result<std::vector<DirectCapture::frame>> DirectCapture::dump_ring()
+{
+    std::deque<std::shared_ptr<ImageBuffer>> buffers;
+    {
+        std::scoped_lock lck { mtx_ };
+        if (ring_count_ == 0 || !is_streaming_)
+        {
+            return status::UndefinedError;
+        }
+        if (ring_compress_)
+        {
+            std::vector<frame> frames;
+            frames.reserve(encoded_ring_.size());
+            for (auto& e : encoded_ring_)
+            {
+                frame f;
+                f.data = e.data->data();
+                f.length = e.length;
+                f.statistics = e.statistics;
+                f.image_statistics = std::move(e.image_statistics);
+                f.compressed = true;
+                f.encoded = std::move(e.data);
+                frames.push_back(std::move(f));
+            }
+            encoded_ring_.clear();
+            return frames;
+        }
+        buffers.swap(ring_);
+    }
+
+    std::vector<frame> frames;
+    frames.reserve(buffers.size());
+    for (auto& buffer : buffers)
+    {
+        frame f;
+        f.data = buffer->get_image_buffer_ptr();
+        f.length = buffer->get_valid_data_length();
+        f.statistics = buffer->get_statistics();
+        f.image_statistics = buffer->get_image_statistics();
+        f.buffer = std::move(buffer);
+        frames.push_back(std::move(f));
+    }
+    return frames;
+}
+
+
+outcome::result<void> DirectCapture::start_stream(size_t buffer_count,
+                                                  const std::shared_ptr<BufferPool>& pool)
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        if (is_streaming_)
+        {
+            return status::ResourceNotLockable;
+        }
+        if (device_lost_)
+        {
+            return status::DeviceLost;
+        }
+    }
+
+    if (buffer_count == 0)
+    {
+        return status::InvalidParameter;
+    }
+
+    // the memory of the last stream is reused when format and count still fit
+    OUTCOME_TRY(pool->configure(format_, buffer_count));
+
+    sink_ = std::make_shared<ImageSink>(
+        [this](const std::shared_ptr<ImageBuffer>& buffer) { push_image(buffer); },
+        format_,
+        buffer_count);
+
+    if (!device_->configure_stream(format_, sink_, pool))
+    {
+        sink_.reset();
+        return status::FormatInvalid;
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        is_streaming_ = true;
+    }
+
+    if (!device_->start_stream())
+    {
+        {
+            std::scoped_lock lck { mtx_ };
+            is_streaming_ = false;
+        }
+        device_->free_stream();
+        sink_.reset();
+        return status::UndefinedError;
+    }
+
+    return outcome::success();
+}
+
+
+void DirectCapture::stop()
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        if (!is_streaming_)
+        {
+            return;
+        }
+        is_streaming_ = false;
+        ready_.clear();
+        burst_.clear();
+        burst_count_ = 0;
+        ring_.clear();
+        ring_count_ = 0;
+    }
+    cv_.notify_all();
+
+    // the encoder requeues into the stream, it has to end first
+    stop_encoder();
+
+    device_->stop_stream();
+    device_->free_stream();
+
+    {
+        // frames the application still holds are dropped with release
+        std::scoped_lock lck { mtx_ };
+        ready_.clear();
+    }
+    sink_.reset();
+}
+
+
+outcome::result<DirectCapture::frame> DirectCapture::acquire(int timeout_ms)
+{
+    std::unique_lock lck { mtx_ };
+
+    const bool has_frame =
+        cv_.wait_for(lck,
+                     std::chrono::milliseconds(timeout_ms),
+                     [this] { return !ready_.empty() || !is_streaming_ || device_lost_; });
+
+    if (!ready_.empty())
+    {
+        auto buffer = std::move(ready_.front());
+        ready_.pop_front();
+
+        frame f;
+        f.data = buffer->get_image_buffer_ptr();
+        f.length = buffer->get_valid_data_length();
+        f.statistics = buffer->get_statistics();
+        f.image_statistics = buffer->get_image_statistics();
+        f.buffer = std::move(buffer);
+        return f;
+    }
+    if (device_lost_)
+    {
+        return status::DeviceLost;
+    }
+    if (!is_streaming_)
+    {
+        return status::UndefinedError;
+    }
+    if (!has_frame)
+    {
+        return status::Timeout;
+    }
+    return status::UndefinedError;
+}
+
+
+void DirectCapture::release(const frame& f) noexcept
+{
+    if (!f.buffer)
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        if (!is_streaming_)
+        {
+            // the buffer belonged to a stream that is already stopped
+            return;
+        }
+    }
+    requeue(f.buffer);
+}
+
+
+void DirectCapture::push_image(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    if (callback_)
+    {
+        frame f;
+        f.data = buffer->get_image_buffer_ptr();
+        f.length = buffer->get_valid_data_length();
+        f.statistics = buffer->get_statistics();
+        f.image_statistics = buffer->get_image_statistics();
+        f.buffer = buffer;
+
+        callback_(f);
+
+        requeue(buffer);
+        return;
+    }
+
+    std::shared_ptr<ImageBuffer> oldest;
+    {
+        std::scoped_lock lck { mtx_ };
+        if (ring_count_ != 0 && ring_compress_)
+        {
+            // encoding takes longer than a frame period may allow, see encode_loop
+            encode_queue_.push_back(buffer);
+            encode_cv_.notify_one();
+            return;
+        }
+        if (ring_count_ != 0)
+        {
+            ring_.push_back(buffer);
+            if (ring_.size() <= ring_count_)
+            {
+                return;
+            }
+            oldest = std::move(ring_.front());
+            ring_.pop_front();
+        }
+        else if (burst_count_ != 0)
+        {
+            // burst buffers stay with the burst, the device runs dry after the last one
+            if (burst_.size() < burst_count_)
+            {
+                burst_.push_back(buffer);
+                if (burst_.size() == burst_count_)
+                {
+                    cv_.notify_all();
+                }
+            }
+            return;
+        }
+        if (is_streaming_)
+        {
+            ready_.push_back(buffer);
+            cv_.notify_one();
+            return;
+        }
+    }
+    requeue(oldest ? oldest : buffer);
+}
+
+
+void DirectCapture::encode_loop()
+{
+    while (true)
+    {
+        std::shared_ptr<ImageBuffer> buffer;
+        std::shared_ptr<std::vector<uint8_t>> mem;
+        {
+            std::unique_lock lck { mtx_ };
+            encode_cv_.wait(lck, [this] { return !encode_queue_.empty() || !ring_compress_; });
+            if (!ring_compress_)
+            {
+                return;
+            }
+            buffer = std::move(encode_queue_.front());
+            encode_queue_.pop_front();
+            if (!encode_free_.empty())
+            {
+                mem = std::move(encode_free_.back());
+                encode_free_.pop_back();
+            }
+        }
+        if (!mem)
+        {
+            mem = std::make_shared<std::vector<uint8_t>>(encoded_max_size_);
+        }
+
+        encoded_frame f;
+        f.length = encode_(*buffer, mem->data(), mem->size());
+        f.statistics = buffer->get_statistics();
+        f.image_statistics = buffer->get_image_statistics();
+        f.data = std::move(mem);
+
+        // the raw frame is no longer needed
+        requeue(buffer);
+
+        std::scoped_lock lck { mtx_ };
+        if (f.length == 0)
+        {
+            SPDLOG_WARN("Unable to encode frame {}.", f.statistics.frame_count);
+            encode_free_.push_back(std::move(f.data));
+            continue;
+        }
+        encoded_ring_.push_back(std::move(f));
+        if (encoded_ring_.size() > ring_count_)
+        {
+            encode_free_.push_back(std::move(encoded_ring_.front().data));
+            encoded_ring_.pop_front();
+        }
+    }
+}
+
+
+void DirectCapture::stop_encoder()
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        ring_compress_ = false;
+        encode_queue_.clear();
+        encoded_ring_.clear();
+    }
+    encode_cv_.notify_all();
+    if (encode_thread_.joinable())
+    {
+        encode_thread_.join();
+    }
+    encode_free_.clear();
+    encode_ = nullptr;
+}
+
+
+void DirectCapture::requeue(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    std::scoped_lock lck { requeue_mtx_ };
+    if (sink_)
+    {
+        sink_->requeue_buffer(buffer);
+    }
+}
+
+
+void DirectCapture::device_lost_callback(const tcam_device_info* /*info*/, void* user_data)
+{
+    auto self = static_cast<DirectCapture*>(user_data);
+
+    SPDLOG_ERROR("Device lost while capturing.");
+    {
+        std::scoped_lock lck { self->mtx_ };
+        self->device_lost_ = true;
+    }
+    self->cv_.notify_all();
+}
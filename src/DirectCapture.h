@@ -0,0 +1,227 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "VideoFormat.h"
+#include "VideoFormatDescription.h"
+#include "base_types.h"
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+class BufferPool;
+class CaptureDevice;
+class ImageBuffer;
+class ImageSink;
+
+/**
+ * Raw frames of a device without GStreamer.
+ *
+ * The device writes into the memory of its own BufferPool, frames hand out that memory.
+ * Either a callback receives every frame on the thread of the backend
+ * and the buffer is requeued when it returns,
+ * or frames are taken with acquire and have to be handed back with release.
+ * While the application holds a frame the device cannot use its buffer,
+ * so hold fewer frames than start() allocated.
+ *
+ * acquire is meant to be called from one thread, release may be called from any thread.
+ *
+ * For short events faster than the application can process, start_burst captures
+ * a fixed number of frames into buffers that are all allocated up front
+ * and hands them out together once the last one arrived.
+ * start_ring keeps recording the last frames instead, dump_ring hands them out
+ * when something of interest happened. The ring may hold losslessly compressed frames,
+ * so that it covers a longer time with the same memory.
+ */
+class DirectCapture
+{
+public:
+    struct frame
+    {
+        const void* data = nullptr;
+        size_t length = 0;
+        tcam_stream_statistics statistics = {};
+        // latest auto function statistics, nullptr without software auto functions
+        std::shared_ptr<const tcam_image_statistics> image_statistics;
+
+        // keeps the memory alive, hand the frame to release() when done
+        std::shared_ptr<ImageBuffer> buffer;
+
+        // frames of a compressed ring, data is a frame of img_filter::codec::lossless
+        // and encoded keeps it alive instead of buffer
+        bool compressed = false;
+        std::shared_ptr<const std::vector<uint8_t>> encoded;
+    };
+
+    // called on the thread of the backend, keep it short
+    using frame_callback = std::function<void(const frame&)>;
+
+    static outcome::result<std::unique_ptr<DirectCapture>> open(
+        const std::string& serial,
+        TCAM_DEVICE_TYPE type = TCAM_DEVICE_TYPE_UNKNOWN);
+
+    DirectCapture(const DirectCapture&) = delete;
+    DirectCapture& operator=(const DirectCapture&) = delete;
+
+    ~DirectCapture();
+
+    // for properties, the stream is managed by this object
+    CaptureDevice& get_device() noexcept
+    {
+        return *device_;
+    }
+
+    std::vector<VideoFormatDescription> get_available_video_formats() const;
+
+    // only while stopped
+    outcome::result<void> set_video_format(const VideoFormat& format);
+    VideoFormat get_video_format() const;
+
+    /**
+     * Start streaming into buffer_count buffers.
+     * Frames are taken with acquire.
+     */
+    outcome::result<void> start(size_t buffer_count = 4);
+    // every frame is passed to cb, acquire is not used
+    outcome::result<void> start(frame_callback cb, size_t buffer_count = 4);
+    void stop();
+
+    /**
+     * Capture frame_count frames at the rate of the device into frame_count buffers.
+     * The buffers are allocated before the stream starts, backed by locked huge pages
+     * on the numa node of the device. Frames are neither requeued nor handed out
+     * until frame_count frames arrived, afterwards the device drops frames for lack of buffers.
+     * acquire and callbacks are not used.
+     */
+    outcome::result<void> start_burst(size_t frame_count);
+
+    /**
+     * Wait until the burst is complete and stop the stream.
+     * @return the frames in the order they arrived, their memory is reused by the next burst,
+     *         status::Timeout when the burst is not complete after timeout_ms, the burst continues,
+     *         status::DeviceLost when the device disappeared
+     *         status::UndefinedError when no burst is running
+     */
+    outcome::result<std::vector<frame>> wait_for_burst(int timeout_ms);
+
+    /**
+     * Record continuously into the same kind of buffers as start_burst,
+     * only the last frame_count frames are kept, older ones are requeued.
+     * For the last T seconds use T times the frame rate.
+     * Two buffers more than frame_count are allocated,
+     * so the device keeps running while the ring is full.
+     * acquire and callbacks are not used.
+     *
+     * With compress the ring holds losslessly encoded frames, only raw bayer and mono
+     * formats can be compressed, status::FormatInvalid otherwise.
+     * Frames are encoded on a thread of their own, the thread of the backend only hands
+     * them over. A few raw buffers are allocated for the frames waiting to be encoded,
+     * when encoding cannot keep up the device drops frames for lack of buffers.
+     */
+    outcome::result<void> start_ring(size_t frame_count, bool compress = false);
+
+    /**
+     * Take the frames of the ring, oldest first, and start an empty ring.
+     * Hand every frame to release(), until then the device can only use the buffers
+     * that are not held, so release them before the next event is expected.
+     * @return status::UndefinedError when no ring is recording
+     */
+    outcome::result<std::vector<frame>> dump_ring();
+
+    /**
+     * Wait for the next frame.
+     * @return status::Timeout when no frame arrived in timeout_ms,
+     *         status::DeviceLost when the device disappeared
+     *         status::UndefinedError when the stream is not running
+     */
+    outcome::result<frame> acquire(int timeout_ms);
+    void release(const frame& f) noexcept;
+
+private:
+    DirectCapture() = default;
+
+    static void device_lost_callback(const tcam_device_info* info, void* user_data);
+
+    void push_image(const std::shared_ptr<ImageBuffer>& buffer);
+    void requeue(const std::shared_ptr<ImageBuffer>& buffer);
+    void encode_loop();
+    void stop_encoder();
+    outcome::result<void> start_stream(size_t buffer_count,
+                                       const std::shared_ptr<BufferPool>& pool);
+
+    std::shared_ptr<CaptureDevice> device_;
+    std::shared_ptr<ImageSink> sink_;
+    std::shared_ptr<BufferPool> pool_;
+    std::shared_ptr<BufferPool> burst_pool_;
+
+    VideoFormat format_;
+    frame_callback callback_;
+
+    // frames that arrived and were not acquired yet
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<ImageBuffer>> ready_;
+    bool is_streaming_ = false;
+    bool device_lost_ = false;
+
+    // frames of the running burst, burst_count_ is 0 outside of bursts
+    std::vector<std::shared_ptr<ImageBuffer>> burst_;
+    size_t burst_count_ = 0;
+
+    // last frames of the running ring, ring_count_ is 0 when no ring records
+    std::deque<std::shared_ptr<ImageBuffer>> ring_;
+    size_t ring_count_ = 0;
+
+    // compressed ring, ring_ is not used then
+    struct encoded_frame
+    {
+        std::shared_ptr<std::vector<uint8_t>> data;
+        size_t length = 0;
+        tcam_stream_statistics statistics = {};
+        std::shared_ptr<const tcam_image_statistics> image_statistics;
+    };
+    bool ring_compress_ = false;
+    std::deque<encoded_frame> encoded_ring_;
+    // raw frames handed over by push_image
+    std::deque<std::shared_ptr<ImageBuffer>> encode_queue_;
+    // memory of frames that dropped out of the ring
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> encode_free_;
+    std::condition_variable encode_cv_;
+    std::function<size_t(const ImageBuffer&, void* dst, size_t dst_size)> encode_;
+    size_t encoded_max_size_ = 0;
+    std::thread encode_thread_;
+
+    // backends expect their requeues to be serialized
+    std::mutex requeue_mtx_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -22,6 +22,7 @@
 #include "Memory.h"
 
 #include <memory>
+#include <vector>
 
 
 namespace img
@@ -91,6 +92,14 @@ public:
         return buffer_->length();
     }
 
+    /// @name get_file_descriptor
+    /// @brief Get the DMA file descriptor of the internal memory
+    /// @return file descriptor; -1 if the memory is not DMA backed
+    int get_file_descriptor() const noexcept
+    {
+        return buffer_->file_descriptor();
+    }
+
     /// @name get_image_size
     /// @brief Get size of the image in bytes
     /// @return size of the image in bytes
@@ -114,6 +123,77 @@ public:
         statistics_ = stats;
     }
 
+    /// @name get_chunk_data_info
+    /// @brief Where the chunk data of the image is, it stays in the buffer memory
+    /// @return length == 0 when the device did not deliver chunks with this image
+    tcam_chunk_data_info get_chunk_data_info() const noexcept
+    {
+        return chunk_data_;
+    }
+
+    void set_chunk_data_info(const tcam_chunk_data_info& info) noexcept
+    {
+        chunk_data_ = info;
+    }
+
+    /// @name get_missing_lines
+    /// @brief One bit per image line, set when the line misses data, the lsb of byte 0 is line 0
+    /// @return empty when the image is complete or the device does not know which lines are missing
+    const std::vector<uint8_t>& get_missing_lines() const noexcept
+    {
+        return missing_lines_;
+    }
+
+    /// @name get_concealed_line_count
+    /// @brief Missing lines that were filled with nearby lines of the same image
+    uint32_t get_concealed_line_count() const noexcept
+    {
+        return concealed_line_count_;
+    }
+
+    // keeps the capacity, the bitmap does not allocate once the buffer saw a damaged image
+    void set_missing_lines(const std::vector<uint8_t>& lines, uint32_t concealed_count)
+    {
+        missing_lines_.assign(lines.begin(), lines.end());
+        concealed_line_count_ = concealed_count;
+    }
+
+    /// @name get_image_statistics
+    /// @brief Latest statistics of the auto functions when the buffer was delivered
+    /// @return nullptr when the auto functions did not sample an image yet
+    const std::shared_ptr<const tcam_image_statistics>& get_image_statistics() const noexcept
+    {
+        return image_statistics_;
+    }
+
+    void set_image_statistics(std::shared_ptr<const tcam_image_statistics> stats) noexcept
+    {
+        image_statistics_ = std::move(stats);
+    }
+
+    /// @name get_frame_count
+    /// @brief Shortcut for get_statistics().frame_count without copying the statistics
+    uint64_t get_frame_count() const noexcept
+    {
+        return statistics_.frame_count;
+    }
+
+    /// @name get_pool_index
+    /// @brief Position of this buffer in the BufferPool it belongs to
+    /// Backends use it to find their bookkeeping for a buffer without searching.
+    /// @return index; invalid_pool_index when the buffer does not belong to a pool
+    size_t get_pool_index() const noexcept
+    {
+        return pool_index_;
+    }
+
+    void set_pool_index(size_t index) noexcept
+    {
+        pool_index_ = index;
+    }
+
+    static constexpr size_t invalid_pool_index = static_cast<size_t>(-1);
+
     /// @name copy_block
     /// @brief write data to the internal buffer
     /// @param data - pointer to the data that shall be written
@@ -125,8 +205,13 @@ public:
 private:
     VideoFormat format_;
     tcam_stream_statistics statistics_ = {};
+    tcam_chunk_data_info chunk_data_ = {};
+    std::vector<uint8_t> missing_lines_;
+    uint32_t concealed_line_count_ = 0;
+    std::shared_ptr<const tcam_image_statistics> image_statistics_;
 
     size_t valid_data_length_ = 0;
+    size_t pool_index_ = invalid_pool_index;
     std::shared_ptr<Memory> buffer_ = nullptr;
 
     const bool is_own_memory_ = false;
@@ -17,6 +17,8 @@
 #include "ImageSink.h"
 
 #include "logging.h"
+#include "scope_tracing.h"
+#include "usdt_probes.h"
 
 #include <cassert>
 
@@ -42,18 +44,59 @@ void ImageSink::stop_stream()
 
 void ImageSink::push_image(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    TCAM_TRACE_SCOPE("ImageSink::push_image");
+    TCAM_USDT_PROBE(sink_push, buffer->get_frame_count(), buffer.get());
     sh_callback_(buffer);
 }
 
+void ImageSink::set_partial_image_callback(const partial_image_cb& cb)
+{
+    partial_callback_ = cb;
+}
+
+bool ImageSink::wants_partial_images() const
+{
+    return partial_callback_ != nullptr;
+}
+
+void ImageSink::push_partial_image(const std::shared_ptr<ImageBuffer>& buffer,
+                                   unsigned int lines_complete)
+{
+    if (partial_callback_)
+    {
+        partial_callback_(buffer, lines_complete);
+    }
+}
+
+void ImageSink::set_frame_incoming_callback(const frame_incoming_cb& cb)
+{
+    frame_incoming_callback_ = cb;
+}
+
+bool ImageSink::wants_frame_incoming() const
+{
+    return frame_incoming_callback_ != nullptr;
+}
+
+void ImageSink::push_frame_incoming(uint64_t sequence, uint64_t timestamp_ns)
+{
+    if (frame_incoming_callback_)
+    {
+        frame_incoming_callback_(sequence, timestamp_ns);
+    }
+}
+
 void ImageSink::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    TCAM_USDT_PROBE(requeue, buffer->get_frame_count(), buffer.get());
+
     if (auto ptr = requeue_pool_.lock())
     {
         ptr->requeue_buffer(buffer);
     }
     else
     {
-        SPDLOG_ERROR("Could not requeue buffer. No Source.");
+        TCAM_ERROR_RATE_LIMITED("Could not requeue buffer. No Source.");
     }
 }
 
@@ -79,6 +79,9 @@ class ImageSink : public IImageBufferSink
 {
 public:
     using image_buffer_cb = std::function<void(const std::shared_ptr<tcam::ImageBuffer>& buffer)>;
+    using partial_image_cb =
+        std::function<void(const std::shared_ptr<tcam::ImageBuffer>& buffer, unsigned int lines)>;
+    using frame_incoming_cb = std::function<void(uint64_t sequence, uint64_t timestamp_ns)>;
 
 public:
     explicit ImageSink(const image_buffer_cb& cb, const tcam::VideoFormat& format, size_t count);
@@ -88,6 +91,18 @@ public:
 
     void push_image(const std::shared_ptr<ImageBuffer>&) final;
 
+    // has to be set before the stream starts, see IImageBufferSink::push_partial_image
+    void set_partial_image_callback(const partial_image_cb& cb);
+
+    bool wants_partial_images() const final;
+    void push_partial_image(const std::shared_ptr<ImageBuffer>&, unsigned int lines_complete) final;
+
+    // has to be set before the stream starts, see IImageBufferSink::push_frame_incoming
+    void set_frame_incoming_callback(const frame_incoming_cb& cb);
+
+    bool wants_frame_incoming() const final;
+    void push_frame_incoming(uint64_t sequence, uint64_t timestamp_ns) final;
+
     void requeue_buffer(const std::shared_ptr<ImageBuffer>&);
 
     std::vector<std::shared_ptr<ImageBuffer>> get_buffer_collection();
@@ -98,6 +113,8 @@ private:
     std::weak_ptr<IImageBufferPool> requeue_pool_;
 
     image_buffer_cb sh_callback_;
+    partial_image_cb partial_callback_;
+    frame_incoming_cb frame_incoming_callback_;
 
     ImageSinkBufferPool buffer_list_;
 };
@@ -4,23 +4,116 @@
 #include "logging.h"
 #include "utils.h"
 #include "DeviceInterface.h"
+#include "devicelibrary.h"
 
 #include <algorithm>
+#include <future>
+#include <optional>
 
 using namespace tcam;
 
+namespace
+{
+
+// one plug event causes multiple udev/libusb events
+// wait a moment so that a single enumeration covers all of them
+constexpr auto hotplug_settle_time = std::chrono::milliseconds(50);
+
+// a backend that takes longer does not hold back the others,
+// its list is taken over whenever the enumeration finishes
+constexpr auto enumeration_deadline = std::chrono::seconds(3);
+
+// device list of the last Indexer instance
+// a new instance starts with it instead of waiting for the first enumeration
+// when pipelines are restarted
+constexpr auto warm_cache_max_age = std::chrono::seconds(10);
+
+struct warm_cache
+{
+    std::mutex mtx;
+    bool valid = false;
+    std::chrono::steady_clock::time_point time;
+    // backends that had a list, devices contains their entries
+    std::vector<TCAM_DEVICE_TYPE> types;
+    std::vector<DeviceInfo> devices;
+};
+
+warm_cache& get_warm_cache()
+{
+    static warm_cache cache;
+    return cache;
+}
+
+std::mutex active_indexer_mtx;
+Indexer* active_indexer = nullptr;
+
+bool matches_type(TCAM_DEVICE_TYPE type, TCAM_DEVICE_TYPE filter)
+{
+    return filter == TCAM_DEVICE_TYPE_UNKNOWN || type == filter;
+}
+
+} // namespace
+
 std::weak_ptr<Indexer> Indexer::indexer_ptr;
 
 Indexer::Indexer()
-    : continue_thread_(true), wait_period_(2), have_list_(false)
+    : continue_thread_(true), wait_period_(2)
 {
+    // only the list, the backends initialize themselves on first use
+    for (auto backend : tcam::get_backend_list())
+    {
+        backend_state state;
+        state.backend = backend;
+        state.type = backend->get_type();
+        backends_.push_back(std::move(state));
+    }
+
+    {
+        auto& cache = get_warm_cache();
+        std::scoped_lock lck(cache.mtx);
+
+        if (cache.valid && std::chrono::steady_clock::now() - cache.time < warm_cache_max_age)
+        {
+            device_list_ = cache.devices;
+            for (const auto& d : device_list_)
+            {
+                known_devices_.try_emplace(d.get_serial(), generation_);
+            }
+            for (auto& b : backends_)
+            {
+                b.has_list = std::find(cache.types.begin(), cache.types.end(), b.type)
+                             != cache.types.end();
+                std::copy_if(cache.devices.begin(),
+                             cache.devices.end(),
+                             std::back_inserter(b.devices),
+                             [&b](const DeviceInfo& d) { return d.get_device_type() == b.type; });
+            }
+        }
+    }
+
+    {
+        std::scoped_lock lck(active_indexer_mtx);
+        active_indexer = this;
+    }
+
     work_thread_ = std::thread(&Indexer::update_device_list_thread, this);
 }
 
 
 Indexer::~Indexer()
 {
-    continue_thread_ = false;
+    {
+        std::scoped_lock lck(active_indexer_mtx);
+        if (active_indexer == this)
+        {
+            active_indexer = nullptr;
+        }
+    }
+
+    {
+        std::scoped_lock lock(mtx_);
+        continue_thread_ = false;
+    }
     wait_for_next_run_.notify_all();
 
     try
@@ -34,6 +127,25 @@ Indexer::~Indexer()
     {
         SPDLOG_ERROR("Unable to join thread. Exception: {}", err.what());
     }
+
+    auto& cache = get_warm_cache();
+    std::scoped_lock lck(cache.mtx);
+
+    cache.types.clear();
+    for (const auto& b : backends_)
+    {
+        if (b.has_list)
+        {
+            cache.types.push_back(b.type);
+        }
+    }
+
+    if (!cache.types.empty())
+    {
+        cache.valid = true;
+        cache.time = std::chrono::steady_clock::now();
+        cache.devices = device_list_;
+    }
 }
 
 
@@ -59,81 +171,308 @@ std::shared_ptr<Indexer> Indexer::get_instance()
 }
 
 
+void Indexer::notify_hotplug()
+{
+    // backends keep their callback for the lifetime of the process
+    // an Indexer that is destroyed does not deregister and cannot remove
+    // the registration of its successor
+    std::scoped_lock lck(active_indexer_mtx);
+
+    if (!active_indexer)
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lock(active_indexer->mtx_);
+        active_indexer->hotplug_pending_ = true;
+    }
+    active_indexer->wait_for_next_run_.notify_all();
+}
+
+
+void Indexer::activate(TCAM_DEVICE_TYPE type) const
+{
+    bool changed = false;
+    for (auto& b : backends_)
+    {
+        if (!b.active && matches_type(b.type, type))
+        {
+            b.active = true;
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        activation_pending_ = true;
+        wait_for_next_run_.notify_all();
+    }
+}
+
+
+bool Indexer::has_list(TCAM_DEVICE_TYPE type) const
+{
+    return std::all_of(backends_.begin(),
+                       backends_.end(),
+                       [type](const backend_state& b)
+                       { return !matches_type(b.type, type) || b.has_list; });
+}
+
+
 void Indexer::update_device_list_thread()
 {
     tcam::set_thread_name("tcam_indexer");
-    auto first_list = fetch_device_list_backend();
+    tcam::apply_thread_config(tcam::thread_role::indexer);
 
     std::unique_lock<std::mutex> lock(mtx_);
-    device_list_ = first_list;
-    have_list_ = true;
-    wait_for_list_.notify_all();
+
+    auto next_poll = std::chrono::steady_clock::now() + std::chrono::seconds(wait_period_);
 
     while (continue_thread_)
     {
-        wait_for_next_run_.wait_for(lock, std::chrono::seconds(wait_period_));
+        wait_for_next_run_.wait_until(lock,
+                                      next_poll,
+                                      [this]
+                                      {
+                                          return !continue_thread_ || hotplug_pending_
+                                                 || activation_pending_;
+                                      });
         if (!continue_thread_)
         {
             break;
         }
 
-        lock.unlock();
-
-        auto tmp_dev_list = fetch_device_list_backend();
-
-        lock.lock();
+        const bool events = hotplug_pending_;
+        if (events)
+        {
+            wait_for_next_run_.wait_for(
+                lock, hotplug_settle_time, [this] { return !continue_thread_; });
+            if (!continue_thread_)
+            {
+                break;
+            }
+            hotplug_pending_ = false;
+        }
+        activation_pending_ = false;
 
-        std::vector<DeviceInfo> lost_list;
+        const bool poll = std::chrono::steady_clock::now() >= next_poll;
+        if (poll)
+        {
+            next_poll = std::chrono::steady_clock::now() + std::chrono::seconds(wait_period_);
+        }
 
-        for (const auto& d : device_list_)
+        // backends that were just requested are set up and enumerated right away
+        std::vector<backend_state*> fresh;
+        std::vector<backend_state*> selected;
+        for (auto& b : backends_)
         {
-            auto f = [&d](const DeviceInfo& info)
+            if (!b.active)
             {
-                if (d.get_serial().compare(info.get_serial()) == 0)
+                continue;
+            }
+            if (!b.initialized)
+            {
+                fresh.push_back(&b);
+                selected.push_back(&b);
+            }
+            else if (b.pending.valid())
+            {
+                // a run that missed its deadline is collected with the next run
+                if (events || poll)
                 {
-                    return true;
+                    selected.push_back(&b);
                 }
-                return false;
-            };
-
-            auto found = std::find_if(tmp_dev_list.begin(), tmp_dev_list.end(), f);
-
-            if (found == tmp_dev_list.end())
+            }
+            else if (b.event_driven ? events : poll)
             {
-                SPDLOG_INFO(
-                    "Lost device {} - {}. Contacting callbacks", d.get_name(), d.get_serial());
-                lost_list.push_back(d);
+                selected.push_back(&b);
             }
         }
 
-        device_list_ = std::move(tmp_dev_list);
-
-        auto cbs = callbacks_;
+        if (selected.empty())
+        {
+            continue;
+        }
 
         lock.unlock();
 
-        for (auto&& d : lost_list)
+        for (auto b : fresh)
         {
-            for (auto& c : cbs)
-            {
-                if (c.serial.empty() || c.serial.compare(d.get_serial()) == 0)
-                {
-                    c.callback(d, c.data);
-                }
-            }
+            b->event_driven = b->backend->set_hotplug_callback(&Indexer::notify_hotplug);
+            b->initialized = true;
+
+            SPDLOG_DEBUG(
+                "Backend {} is {}", (int)b->type, b->event_driven ? "event driven" : "polled");
         }
 
-        lock.lock();
+        fetch_device_list_backend(selected, lock);
     }
 }
 
 
-std::vector<DeviceInfo> Indexer::fetch_device_list_backend() const
+void Indexer::publish_device_list(std::unique_lock<std::mutex>& lock)
 {
-    auto tmp_dev_list = tcam::get_device_list();
-
+    std::vector<DeviceInfo> tmp_dev_list;
+    for (const auto& b : backends_)
+    {
+        tmp_dev_list.insert(tmp_dev_list.end(), b.devices.begin(), b.devices.end());
+    }
     sort_device_list(tmp_dev_list);
-    return tmp_dev_list;
+
+    apply_device_list(std::move(tmp_dev_list), lock);
+    wait_for_list_.notify_all();
+}
+
+
+void Indexer::apply_device_list(std::vector<DeviceInfo>&& new_list,
+                                std::unique_lock<std::mutex>& lock)
+{
+    // every device of new_list is stamped with the current generation,
+    // known devices that keep an older stamp are gone
+    ++generation_;
+
+    std::vector<DeviceInfo> added_list;
+    for (const auto& d : new_list)
+    {
+        auto [it, inserted] = known_devices_.try_emplace(d.get_serial(), generation_);
+        if (inserted)
+        {
+            added_list.push_back(d);
+        }
+        else
+        {
+            it->second = generation_;
+        }
+    }
+
+    std::vector<DeviceInfo> lost_list;
+    for (const auto& d : device_list_)
+    {
+        auto known = known_devices_.find(d.get_serial());
+        if (known != known_devices_.end() && known->second != generation_)
+        {
+            SPDLOG_INFO(
+                "Lost device {} - {}. Contacting callbacks", d.get_name(), d.get_serial());
+            lost_list.push_back(d);
+            known_devices_.erase(known);
+        }
+    }
+
+    device_list_ = std::move(new_list);
+
+    if (lost_list.empty() && added_list.empty())
+    {
+        return;
+    }
+
+    // the callbacks may register/remove callbacks themselves
+    std::vector<std::pair<const DeviceInfo*, callback_data>> lost_cbs;
+    for (const auto& d : lost_list)
+    {
+        for (const auto& c : callbacks_) { lost_cbs.emplace_back(&d, c); }
+
+        auto [begin, end] = serial_callbacks_.equal_range(d.get_serial());
+        for (auto it = begin; it != end; ++it) { lost_cbs.emplace_back(&d, it->second); }
+    }
+    auto added_cbs = added_list.empty() ? std::vector<callback_data>() : added_callbacks_;
+    callbacks_running_ = true;
+
+    lock.unlock();
+
+    for (auto& [d, c] : lost_cbs) { c.callback(*d, c.data); }
+
+    for (auto&& d : added_list)
+    {
+        SPDLOG_DEBUG("New device {} - {}", d.get_name(), d.get_serial());
+
+        for (auto& c : added_cbs)
+        {
+            c.callback(d, c.data);
+        }
+    }
+
+    lock.lock();
+    callbacks_running_ = false;
+    callbacks_done_.notify_all();
+}
+
+
+void Indexer::fetch_device_list_backend(const std::vector<backend_state*>& selected,
+                                        std::unique_lock<std::mutex>& lock)
+{
+    auto fetch = [](BackendInterface* backend) -> std::optional<std::vector<DeviceInfo>>
+    {
+        try
+        {
+            return backend->get_device_list();
+        }
+        catch (const std::exception& e)
+        {
+            SPDLOG_ERROR("Unable to retrieve device list: {}", e.what());
+        }
+        return std::nullopt;
+    };
+
+    // aravis blocks for the duration of its discovery,
+    // the local backends should not wait for that
+    std::vector<backend_state*> waiting;
+    for (auto b : selected)
+    {
+        // still busy with the run that missed its deadline, collected when it finishes
+        if (!b->pending.valid())
+        {
+            b->pending = std::async(std::launch::async, fetch, b->backend);
+        }
+        waiting.push_back(b);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + enumeration_deadline;
+
+    // every backend is published on its own, readers looking for one device can stop early
+    while (!waiting.empty())
+    {
+        for (auto it = waiting.begin(); it != waiting.end();)
+        {
+            auto b = *it;
+            if (b->pending.wait_for(std::chrono::milliseconds(5)) != std::future_status::ready)
+            {
+                ++it;
+                continue;
+            }
+
+            auto lst = b->pending.get();
+
+            lock.lock();
+            if (lst)
+            {
+                b->devices = std::move(lst.value());
+            }
+            b->has_list = true;
+            publish_device_list(lock);
+            lock.unlock();
+
+            it = waiting.erase(it);
+        }
+
+        if (!waiting.empty() && std::chrono::steady_clock::now() >= deadline)
+        {
+            lock.lock();
+            for (auto b : waiting)
+            {
+                SPDLOG_WARN("Backend {} did not finish its enumeration within {}s.",
+                            (int)b->type,
+                            enumeration_deadline.count());
+                // readers do not wait any longer, the previous devices are kept
+                b->has_list = true;
+            }
+            wait_for_list_.notify_all();
+            lock.unlock();
+            break;
+        }
+    }
+
+    lock.lock();
 }
 
 
@@ -147,16 +486,16 @@ void Indexer::sort_device_list(std::vector<DeviceInfo>& lst)
       sorted serials, if no name is given
     */
 
+    // has to be a strict weak ordering, std::sort may run out of bounds otherwise
     auto compareDeviceInfo = [](const DeviceInfo& info1, const DeviceInfo& info2)
     {
-        if (info1.get_device_type() >= info2.get_device_type())
+        const auto type1 = info1.get_device_type();
+        const auto type2 = info2.get_device_type();
+        if (type1 != type2)
         {
-            if (info1.get_serial() > info2.get_serial())
-            {
-                return false;
-            }
+            return type1 < type2;
         }
-        return true;
+        return info1.get_serial() < info2.get_serial();
     };
 
     std::sort(lst.begin(), lst.end(), compareDeviceInfo);
@@ -165,14 +504,45 @@ void Indexer::sort_device_list(std::vector<DeviceInfo>& lst)
 
 std::vector<DeviceInfo> Indexer::get_device_list() const
 {
+    // the first call enumerates all backends,
+    // the wait ends when every backend delivered its first list or missed its deadline
+    std::unique_lock<std::mutex> lock(mtx_);
+    activate(TCAM_DEVICE_TYPE_UNKNOWN);
+    wait_for_list_.wait(lock, [this] { return has_list(TCAM_DEVICE_TYPE_UNKNOWN); });
+    return device_list_;
+}
 
-    // wait for work_thread to deliver first valid list
-    // since get_aravis_device_list is a blocking function
-    // our thread would retrieve an empty list without this wait loop
 
+std::optional<DeviceInfo> Indexer::find_device(const std::string& serial,
+                                               TCAM_DEVICE_TYPE type) const
+{
     std::unique_lock<std::mutex> lock(mtx_);
-    while (!have_list_) { wait_for_list_.wait_for(lock, std::chrono::seconds(wait_period_)); }
-    return device_list_;
+    activate(type);
+
+    std::optional<DeviceInfo> ret;
+    wait_for_list_.wait(lock,
+                        [this, &serial, type, &ret]
+                        {
+                            const bool complete = has_list(type);
+                            // without serial the first device of the complete list is taken,
+                            // otherwise the result depends on which backend finishes first
+                            if (serial.empty() && !complete)
+                            {
+                                return false;
+                            }
+
+                            for (const auto& d : device_list_)
+                            {
+                                if ((serial.empty() || d.get_serial() == serial)
+                                    && matches_type(d.get_device_type(), type))
+                                {
+                                    ret = d;
+                                    return true;
+                                }
+                            }
+                            return complete;
+                        });
+    return ret;
 }
 
 
@@ -186,7 +556,12 @@ void Indexer::register_device_lost(dev_callback cb, void* user_data)
 void Indexer::register_device_lost(dev_callback cb, void* user_data, const std::string& serial)
 {
     std::lock_guard<std::mutex> lock(mtx_);
-    callbacks_.push_back({ cb, user_data, serial });
+    if (serial.empty())
+    {
+        callbacks_.push_back({ cb, user_data, "" });
+        return;
+    }
+    serial_callbacks_.emplace(serial, callback_data { cb, user_data, serial });
 }
 
 
@@ -194,16 +569,22 @@ void Indexer::remove_device_lost(dev_callback callback)
 {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    auto it = std::begin(callbacks_); //std::begin is a free function in C++11
-    for (auto& value : callbacks_)
+    auto it = std::find_if(callbacks_.begin(),
+                           callbacks_.end(),
+                           [callback](const callback_data& c) { return c.callback == callback; });
+    if (it != callbacks_.end())
     {
+        callbacks_.erase(it);
+        return;
+    }
 
-        if (value.callback == callback)
-        {
-            callbacks_.erase(it);
-            break;
-        }
-        it++; //at the end OR make sure you do this in each iteration
+    auto serial_it = std::find_if(serial_callbacks_.begin(),
+                                  serial_callbacks_.end(),
+                                  [callback](const auto& entry)
+                                  { return entry.second.callback == callback; });
+    if (serial_it != serial_callbacks_.end())
+    {
+        serial_callbacks_.erase(serial_it);
     }
 }
 
@@ -212,14 +593,57 @@ void Indexer::remove_device_lost(dev_callback callback, const std::string& seria
 {
     std::lock_guard<std::mutex> lock(mtx_);
 
-    auto it = std::begin(callbacks_);
-    for (auto& value : callbacks_)
+    auto [begin, end] = serial_callbacks_.equal_range(serial);
+    for (auto it = begin; it != end; ++it)
     {
-        if (value.callback == callback && value.serial.compare(serial) == 0)
+        if (it->second.callback == callback)
         {
-            callbacks_.erase(it);
+            serial_callbacks_.erase(it);
             break;
         }
-        it++;
+    }
+}
+
+
+void Indexer::register_device_added(dev_callback cb, void* user_data)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    added_callbacks_.push_back({ cb, user_data, "" });
+}
+
+
+void Indexer::remove_device_added(dev_callback callback)
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+
+    auto it = std::find_if(added_callbacks_.begin(),
+                           added_callbacks_.end(),
+                           [callback](const callback_data& c) { return c.callback == callback; });
+    if (it != added_callbacks_.end())
+    {
+        added_callbacks_.erase(it);
+    }
+}
+
+
+void Indexer::remove_callbacks(void* user_data)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    auto matches = [user_data](const callback_data& c) { return c.data == user_data; };
+    callbacks_.erase(std::remove_if(callbacks_.begin(), callbacks_.end(), matches),
+                     callbacks_.end());
+    for (auto it = serial_callbacks_.begin(); it != serial_callbacks_.end();)
+    {
+        it = matches(it->second) ? serial_callbacks_.erase(it) : std::next(it);
+    }
+    added_callbacks_.erase(
+        std::remove_if(added_callbacks_.begin(), added_callbacks_.end(), matches),
+        added_callbacks_.end());
+
+    // the callbacks are executed from copies, user_data may still be in use
+    if (std::this_thread::get_id() != work_thread_.get_id())
+    {
+        callbacks_done_.wait(lock, [this] { return !callbacks_running_; });
     }
 }
@@ -6,9 +6,12 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "compiler_defines.h"
@@ -25,6 +28,8 @@ typedef void (*dev_callback)(const DeviceInfo&, void* user_data);
 #endif /* dev_callback */
 
 
+class BackendInterface;
+
 class Indexer
 {
 public:
@@ -32,6 +37,13 @@ public:
 
     std::vector<DeviceInfo> get_device_list() const;
 
+    /**
+     * Only enumerates the backend of type, TCAM_DEVICE_TYPE_UNKNOWN means all backends.
+     * Returns as soon as a backend reports serial, an empty serial
+     * takes the first device after all relevant backends finished.
+     */
+    std::optional<DeviceInfo> find_device(const std::string& serial, TCAM_DEVICE_TYPE type) const;
+
     void register_device_lost(dev_callback cb, void* user_data);
 
     void register_device_lost(dev_callback cb, void* user_data, const std::string& serial);
@@ -39,6 +51,14 @@ public:
     void remove_device_lost(dev_callback callback);
     void remove_device_lost(dev_callback callback, const std::string& serial);
 
+    // called from the indexer thread for every device that appears after registration
+    void register_device_added(dev_callback cb, void* user_data);
+    void remove_device_added(dev_callback callback);
+
+    // removes every lost and added callback that was registered with user_data
+    // waits for callbacks that are currently executed, unless called from one of them
+    void remove_callbacks(void* user_data);
+
 private:
     // The Indexer is a pseudo singleton
     // It stores a weak_ptr to itself and returns it,
@@ -53,21 +73,65 @@ private:
     Indexer();
     ~Indexer();
 
+    struct backend_state
+    {
+        BackendInterface* backend = nullptr;
+        TCAM_DEVICE_TYPE type = TCAM_DEVICE_TYPE_UNKNOWN;
+
+        // guarded by mtx_
+        // requested by get_device_list/find_device, the backend stays untouched until then
+        bool active = false;
+        // the first enumeration finished or missed its deadline
+        bool has_list = false;
+        std::vector<DeviceInfo> devices;
+
+        // only used by work_thread_
+        bool initialized = false;
+        // changes are reported through BackendInterface::set_hotplug_callback
+        bool event_driven = false;
+        std::future<std::optional<std::vector<DeviceInfo>>> pending;
+    };
+
+    // forwards hotplug events of all backends to the current instance
+    static void notify_hotplug();
+
+    // marks the backends of type as requested; lock is held by the caller
+    void activate(TCAM_DEVICE_TYPE type) const;
+    // all backends of type have a list; lock is held by the caller
+    bool has_list(TCAM_DEVICE_TYPE type) const;
+
     void update_device_list_thread();
-    std::vector<DeviceInfo> fetch_device_list_backend() const;
+    // enumerates the selected backends in parallel and publishes every list as it arrives
+    // lock is released while the backends work
+    void fetch_device_list_backend(const std::vector<backend_state*>& selected,
+                                   std::unique_lock<std::mutex>& lock);
+    // combines the lists of all backends; lock is held by the caller
+    void publish_device_list(std::unique_lock<std::mutex>& lock);
+    // takes over new_list and informs callbacks about added and lost devices
+    // lock is held by the caller
+    void apply_device_list(std::vector<DeviceInfo>&& new_list, std::unique_lock<std::mutex>& lock);
     static void sort_device_list(std::vector<DeviceInfo>& lst);
 
     bool continue_thread_ = true;
     mutable std::mutex mtx_;
+    // backends without hotplug support are polled in this interval
     unsigned int wait_period_ = 2;
-    std::atomic<bool> have_list_ = false;
+    bool hotplug_pending_ = false;
+    mutable bool activation_pending_ = false;
     std::thread work_thread_;
 
+    // see backend_state for which thread may touch which field
+    mutable std::vector<backend_state> backends_;
+
     mutable std::condition_variable wait_for_list_;
     mutable std::condition_variable wait_for_next_run_;
 
     std::vector<DeviceInfo> device_list_;
 
+    // serial -> generation of the last device list that contained it
+    std::unordered_map<std::string, uint64_t> known_devices_;
+    uint64_t generation_ = 0;
+
     struct callback_data
     {
         dev_callback callback;
@@ -75,7 +139,15 @@ private:
         std::string serial;
     };
 
+    // lost callbacks for every device
     std::vector<callback_data> callbacks_;
+    // lost callbacks for one device, keyed by serial
+    std::unordered_multimap<std::string, callback_data> serial_callbacks_;
+    std::vector<callback_data> added_callbacks_;
+
+    // set while work_thread_ executes callbacks
+    bool callbacks_running_ = false;
+    std::condition_variable callbacks_done_;
 };
 
 
@@ -24,8 +24,10 @@
 tcam::Memory::Memory(std::shared_ptr<AllocatorInterface> alloc,
                      TCAM_MEMORY_TYPE t,
                      size_t length,
-                     void* ptr)
-    : type_(t), ptr_(ptr), length_(length), allocator_(alloc)
+                     void* ptr,
+                     int fd,
+                     bool external)
+    : type_(t), ptr_(ptr), length_(length), external_(external && ptr), fd_(fd), allocator_(alloc)
 {
     auto types = allocator_->get_supported_memory_types();
     if (std::find(types.begin(), types.end(), t) == types.end())
@@ -35,7 +37,7 @@ tcam::Memory::Memory(std::shared_ptr<AllocatorInterface> alloc,
 
     if (!ptr)
     {
-        ptr_ = allocator_->allocate(type_, length_);
+        ptr_ = allocator_->allocate(type_, length_, fd_);
 
         if (!ptr_)
         {
@@ -49,8 +51,9 @@ tcam::Memory::~Memory()
 {
     if (ptr_ && !external_)
     {
-        allocator_->free(type_, ptr_, length_);
+        allocator_->free(type_, ptr_, length_, fd_);
         ptr_ = nullptr;
         length_ = 0;
+        fd_ = -1;
     }
 }
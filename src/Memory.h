@@ -56,13 +56,17 @@ public:
     //   t: Memory type to use
     //   length: size of the memory block
     //   ptr: Pointer to existing memory, optional
+    //   fd: DMA file descriptor backing the memory, optional
+    //   external: ptr is owned by somebody else and is not freed through alloc
     // throws:
     //   std::runtime_error in case of fatal error
     //
     Memory(std::shared_ptr<AllocatorInterface> alloc,
            TCAM_MEMORY_TYPE t,
            size_t length,
-           void* ptr = nullptr);
+           void* ptr = nullptr,
+           int fd = -1,
+           bool external = false);
 
     // Memory(TCAM_MEMORY_TYPE t, void* ptr, size_t length)
     //     : type_(t), ptr_(ptr), length_(length), external_(true)
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PropertyChangeNotifier.h"
+
+#include "property_dependencies.h"
+
+#include <algorithm>
+
+using namespace tcam::property;
+
+
+void PropertyChangeNotifier::notify(std::string_view name)
+{
+    std::scoped_lock lck { mtx_ };
+
+    // only a handful of names change between two takes, a linear search is fine
+    if (std::find(names_.begin(), names_.end(), name) == names_.end())
+    {
+        names_.emplace_back(name);
+    }
+    pending_.store(true, std::memory_order_release);
+}
+
+
+void PropertyChangeNotifier::notify_with_dependents(std::string_view name)
+{
+    notify(name);
+
+    if (auto entry = find_dependency_entry(name))
+    {
+        for (const auto& dep : entry->dependent_property_names) { notify(dep); }
+    }
+}
+
+
+std::vector<std::string> PropertyChangeNotifier::take()
+{
+    std::vector<std::string> ret;
+
+    std::scoped_lock lck { mtx_ };
+    ret.swap(names_);
+    pending_.store(false, std::memory_order_release);
+
+    return ret;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::property
+{
+
+/**
+ * Collects the names of properties whose value or locked state changed.
+ *
+ * Producers call notify from any thread, e.g. the auto functions for every frame.
+ * A consumer takes the collected names at its own rate,
+ * so a property that changed several times in between is reported once.
+ */
+class PropertyChangeNotifier
+{
+public:
+    void notify(std::string_view name);
+
+    // name changed its value, which may lock or unlock other properties, see property_dependencies.h
+    void notify_with_dependents(std::string_view name);
+
+    bool has_pending() const noexcept
+    {
+        return pending_.load(std::memory_order_acquire);
+    }
+
+    // returns the names collected since the last call
+    std::vector<std::string> take();
+
+private:
+    std::mutex mtx_;
+    std::vector<std::string> names_;
+    std::atomic<bool> pending_ = false;
+};
+
+} // namespace tcam::property
+
+VISIBILITY_POP
@@ -1,10 +1,12 @@
 
 #include "PropertyFilter.h"
 
+#include "AutoPassWorker.h"
 #include "ImageBuffer.h"
 #include "SoftwareProperties.h"
 #include "VideoFormatDescription.h"
 #include "logging.h"
+#include "utils.h"
 
 #include <dutils_img/image_fourcc_func.h>
 
@@ -28,18 +30,69 @@ static bool has_bayer_format(const std::vector<VideoFormatDescription>& device_f
 
 void SoftwarePropertyWrapper::setup(
     const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& props,
-    const std::vector<VideoFormatDescription>& device_formats)
+    const std::vector<VideoFormatDescription>& device_formats,
+    tcam::property::transaction_factory begin_transaction,
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> change_notifier,
+    std::shared_ptr<tcam::property::PropertyWriteQueue> write_queue)
 {
     bool has_bayer = has_bayer_format(device_formats);
-    m_impl = tcam::property::SoftwareProperties::create(props, has_bayer);
+    m_impl =
+        tcam::property::SoftwareProperties::create(props, has_bayer, std::move(begin_transaction));
+    m_impl->set_change_notifier(std::move(change_notifier));
+    m_impl->set_write_queue(write_queue);
+
+    if (tcam::is_environment_variable_set("TCAM_AUTO_PASS_ASYNC"))
+    {
+        SPDLOG_DEBUG("Running auto functions asynchronously.");
+        m_worker = tcam::AutoPassWorker::get_instance();
+    }
 }
 
 
-void SoftwarePropertyWrapper::apply(ImageBuffer& buffer)
+void SoftwarePropertyWrapper::apply(const std::shared_ptr<ImageBuffer>& buffer)
 {
-    img::img_descriptor src = buffer.get_img_descriptor();
+    if (m_impl->is_auto_group_member())
+    {
+        // only writes when the master published new values, that is cheap enough for this thread
+        m_impl->group_pass(buffer->get_frame_count());
+    }
+    else if (m_worker)
+    {
+        m_impl->auto_pass_async(*m_worker, buffer);
+    }
+    else
+    {
+        m_impl->auto_pass(buffer->get_img_descriptor(), buffer->get_frame_count());
+    }
+
+    // the asynchronous pass delivers the statistics of an earlier frame
+    buffer->set_image_statistics(m_impl->get_image_statistics());
+}
+
 
-    m_impl->auto_pass(src);
+void SoftwarePropertyWrapper::set_image_statistics_histogram(bool b)
+{
+    // not set up for devices without software properties
+    if (m_impl)
+    {
+        m_impl->set_image_statistics_histogram(b);
+    }
+}
+
+
+void SoftwarePropertyWrapper::set_auto_group(const std::string& name, bool is_master)
+{
+    if (!m_impl)
+    {
+        return;
+    }
+    m_impl->set_auto_group(name.empty() ? nullptr : tcam::AutoGroup::get(name), is_master);
+}
+
+
+void SoftwarePropertyWrapper::wait_for_pending()
+{
+    m_impl->wait_for_auto_pass();
 }
 
 void SoftwarePropertyWrapper::setVideoFormat(const VideoFormat& in)
@@ -4,6 +4,7 @@
 #include "compiler_defines.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -13,11 +14,14 @@ namespace tcam
 class VideoFormat;
 class VideoFormatDescription;
 class ImageBuffer;
+class AutoPassWorker;
 }
 
 namespace tcam::property
 {
 class SoftwareProperties;
+class PropertyChangeNotifier;
+class PropertyWriteQueue;
 }
 
 namespace tcam::stream::filter
@@ -30,9 +34,20 @@ public:
 
     void    setup(
         const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& props,
-        const std::vector<VideoFormatDescription>& device_formats);
+        const std::vector<VideoFormatDescription>& device_formats,
+        tcam::property::transaction_factory begin_transaction,
+        std::shared_ptr<tcam::property::PropertyChangeNotifier> change_notifier,
+        std::shared_ptr<tcam::property::PropertyWriteQueue> write_queue);
 
-    void apply(ImageBuffer&);
+    void apply(const std::shared_ptr<ImageBuffer>& buffer);
+
+    // wait for asynchronous auto passes that still use the current stream
+    void wait_for_pending();
+
+    void set_image_statistics_histogram(bool b);
+
+    // an empty name leaves the group
+    void set_auto_group(const std::string& name, bool is_master);
 
     void setVideoFormat(const VideoFormat& in);
 
@@ -40,6 +55,9 @@ public:
 
 private:
     std::shared_ptr<tcam::property::SoftwareProperties> m_impl;
+
+    // only set when TCAM_AUTO_PASS_ASYNC is defined
+    std::shared_ptr<tcam::AutoPassWorker> m_worker;
 };
 
 
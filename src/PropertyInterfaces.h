@@ -20,6 +20,7 @@
 #include "base_types.h"
 #include "error.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -37,7 +38,8 @@ public:
 
     virtual tcamprop1::prop_static_info get_static_info() const = 0;
 
-    std::string_view get_name() const noexcept
+    // backends that build their static info on demand override this with a cheaper lookup
+    virtual std::string_view get_name() const noexcept
     {
         return get_static_info().name;
     }
@@ -52,6 +54,25 @@ std::shared_ptr<tcam::property::IPropertyBase> find_property(
     std::string_view name);
 
 
+/**
+ * Groups property writes so that a backend can hand them to the device in one request.
+ *
+ * Writes issued by the thread that began the transaction are applied in order
+ * when commit() is called or the transaction is destroyed.
+ * Errors of deferred writes are only reported by commit().
+ * Backends without support for this write every value immediately.
+ */
+class IPropertyTransaction
+{
+public:
+    virtual ~IPropertyTransaction() = default;
+
+    virtual outcome::result<void> commit() = 0;
+};
+
+using transaction_factory = std::function<std::unique_ptr<IPropertyTransaction>()>;
+
+
 class IPropertyInteger : public IPropertyBase
 {
 public:
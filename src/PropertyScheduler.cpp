@@ -0,0 +1,81 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PropertyScheduler.h"
+
+#include "logging.h"
+#include "scope_tracing.h"
+
+#include <vector>
+
+using namespace tcam::property;
+
+
+uint64_t PropertyScheduler::schedule(uint64_t after_frame, write_function&& write)
+{
+    std::scoped_lock lck { mtx_ };
+
+    const uint64_t id = next_id_++;
+    writes_.emplace(after_frame, entry { id, std::move(write) });
+    pending_ = writes_.size();
+    return id;
+}
+
+
+void PropertyScheduler::clear()
+{
+    std::scoped_lock lck { mtx_ };
+
+    writes_.clear();
+    pending_ = 0;
+}
+
+
+void PropertyScheduler::apply(uint64_t frame_count)
+{
+    if (pending_.load(std::memory_order_acquire) == 0)
+    {
+        return;
+    }
+
+    TCAM_TRACE_SCOPE("PropertyScheduler::apply");
+
+    std::vector<entry> due;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        const auto end = writes_.upper_bound(frame_count);
+        for (auto iter = writes_.begin(); iter != end; ++iter)
+        {
+            due.push_back(std::move(iter->second));
+        }
+        writes_.erase(writes_.begin(), end);
+        pending_ = writes_.size();
+    }
+
+    // outside of the lock, a write may schedule the next one
+    for (auto& e : due)
+    {
+        if (auto res = e.write(); !res)
+        {
+            SPDLOG_WARN("Scheduled property write {} after frame {} failed: {}",
+                        e.id,
+                        frame_count,
+                        res.error().message());
+        }
+        last_applied_.store(e.id, std::memory_order_release);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::property
+{
+
+/**
+ * Property writes that are executed from the stream thread once a frame was received.
+ *
+ * That removes the delay between the application noticing a frame and its write,
+ * e.g. for exposure bracketing. The camera still applies the value with its own latency,
+ * usually on the next or second next exposure. Chunk data like ChunkExposureTime
+ * tells which frame was really taken with it.
+ * The frame is delivered after its writes, so slow writes delay it.
+ */
+class PropertyScheduler
+{
+public:
+    using write_function = std::function<outcome::result<void>()>;
+
+    /**
+     * write is executed after the frame with frame_count after_frame was received,
+     * 0 executes it after the next frame.
+     * Writes for the same frame are executed in the order they were scheduled.
+     * @return id of the write, ids start at 1 and increase
+     */
+    uint64_t schedule(uint64_t after_frame, write_function&& write);
+
+    // drops writes that were not executed yet
+    void clear();
+
+    // id of the last executed write, 0 when none was executed
+    uint64_t get_last_applied() const noexcept
+    {
+        return last_applied_.load(std::memory_order_acquire);
+    }
+
+    bool is_idle() const noexcept
+    {
+        return pending_.load(std::memory_order_acquire) == 0
+               && last_applied_.load(std::memory_order_relaxed) == 0;
+    }
+
+    // executes the writes that are due after frame frame_count, called from the stream thread
+    void apply(uint64_t frame_count);
+
+private:
+    struct entry
+    {
+        uint64_t id;
+        write_function write;
+    };
+
+    std::mutex mtx_;
+    std::multimap<uint64_t, entry> writes_;
+    uint64_t next_id_ = 1;
+
+    std::atomic<size_t> pending_ = 0;
+    std::atomic<uint64_t> last_applied_ = 0;
+};
+
+} // namespace tcam::property
+
+VISIBILITY_POP
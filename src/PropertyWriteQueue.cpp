@@ -0,0 +1,174 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PropertyWriteQueue.h"
+
+#include "logging.h"
+#include "scope_tracing.h"
+#include "utils.h"
+
+#include <memory>
+
+using namespace tcam::property;
+
+
+PropertyWriteQueue::PropertyWriteQueue(transaction_factory begin_transaction)
+    : begin_transaction_(std::move(begin_transaction))
+{
+}
+
+
+PropertyWriteQueue::~PropertyWriteQueue()
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        stop_ = true;
+    }
+    cv_.notify_all();
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+
+void PropertyWriteQueue::submit(const std::string& name,
+                                write_function&& write,
+                                completion_function&& done)
+{
+    {
+        std::scoped_lock lck { mtx_ };
+
+        entry e { name, std::move(write), {} };
+
+        if (auto iter = queued_.find(name); iter != queued_.end())
+        {
+            e.done = std::move(iter->second->done);
+            queue_.erase(iter->second);
+            queued_.erase(iter);
+        }
+        if (done)
+        {
+            e.done.push_back(std::move(done));
+        }
+
+        queue_.push_back(std::move(e));
+        queued_.emplace(name, std::prev(queue_.end()));
+
+        if (!thread_.joinable())
+        {
+            thread_ = std::thread(&PropertyWriteQueue::run, this);
+        }
+    }
+    cv_.notify_one();
+}
+
+
+std::future<outcome::result<void>> PropertyWriteQueue::submit(const std::string& name,
+                                                              write_function&& write)
+{
+    auto promise = std::make_shared<std::promise<outcome::result<void>>>();
+    auto future = promise->get_future();
+
+    submit(name,
+           std::move(write),
+           [promise](const outcome::result<void>& res) { promise->set_value(res); });
+
+    return future;
+}
+
+
+void PropertyWriteQueue::wait_idle()
+{
+    std::unique_lock lck { mtx_ };
+    idle_cv_.wait(lck, [this] { return queue_.empty() && !executing_; });
+}
+
+
+void PropertyWriteQueue::run()
+{
+    tcam::set_thread_name("tcam_propwrite");
+
+    while (true)
+    {
+        std::list<entry> batch;
+        {
+            std::unique_lock lck { mtx_ };
+            cv_.wait(lck, [this] { return stop_ || !queue_.empty(); });
+
+            // queued writes are still executed on shutdown, their callers may wait for them
+            if (queue_.empty())
+            {
+                break;
+            }
+
+            batch.swap(queue_);
+            queued_.clear();
+            executing_ = true;
+        }
+
+        execute(batch);
+
+        {
+            std::scoped_lock lck { mtx_ };
+            executing_ = false;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+
+void PropertyWriteQueue::execute(std::list<entry>& batch)
+{
+    TCAM_TRACE_SCOPE("PropertyWriteQueue::execute");
+
+    std::unique_ptr<IPropertyTransaction> transaction;
+    if (begin_transaction_ && batch.size() > 1)
+    {
+        transaction = begin_transaction_();
+    }
+
+    std::vector<outcome::result<void>> results;
+    results.reserve(batch.size());
+    for (auto& e : batch) { results.push_back(e.write()); }
+
+    if (transaction)
+    {
+        // errors of deferred writes are only known now
+        if (auto res = transaction->commit(); !res)
+        {
+            for (auto& r : results)
+            {
+                if (r)
+                {
+                    r = res;
+                }
+            }
+        }
+    }
+
+    auto res_iter = results.begin();
+    for (auto& e : batch)
+    {
+        const auto& res = *res_iter++;
+        if (!res)
+        {
+            SPDLOG_DEBUG("Queued write of {} failed: {}", e.name, res.error().message());
+        }
+        for (auto& done : e.done) { done(res); }
+    }
+}
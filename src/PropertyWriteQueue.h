@@ -0,0 +1,100 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "PropertyInterfaces.h"
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::property
+{
+
+/**
+ * Property writes that are executed by the control thread of a device, the caller does not wait
+ * for the ioctl, GenICam register write or usb control transfer.
+ *
+ * A queued write for a name that did not start yet is replaced by the next write for that name,
+ * so a slider or the auto functions only cost the last value.
+ * The replacement is executed at the position of the newer write.
+ * Everything that is queued when the thread wakes up is written in one transaction.
+ * The thread is started with the first write.
+ */
+class PropertyWriteQueue
+{
+public:
+    using write_function = std::function<outcome::result<void>()>;
+    using completion_function = std::function<void(const outcome::result<void>&)>;
+
+    // begin_transaction may be empty or return nullptr, the writes are then executed one by one
+    explicit PropertyWriteQueue(transaction_factory begin_transaction = {});
+    // executes the writes that are still queued
+    ~PropertyWriteQueue();
+
+    PropertyWriteQueue(const PropertyWriteQueue&) = delete;
+    PropertyWriteQueue& operator=(const PropertyWriteQueue&) = delete;
+
+    /**
+     * done is called from the control thread with the result of write,
+     * or with the result of the write that replaced it. done may be empty.
+     */
+    void submit(const std::string& name, write_function&& write, completion_function&& done);
+
+    std::future<outcome::result<void>> submit(const std::string& name, write_function&& write);
+
+    // blocks until every write that was queued before the call is executed
+    // must not be called from a write or completion
+    void wait_idle();
+
+private:
+    struct entry
+    {
+        std::string name;
+        write_function write;
+        // of this write and of the writes it replaced
+        std::vector<completion_function> done;
+    };
+
+    void run();
+    void execute(std::list<entry>& batch);
+
+    transaction_factory begin_transaction_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::list<entry> queue_;
+    std::map<std::string, std::list<entry>::iterator, std::less<>> queued_;
+    bool executing_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace tcam::property
+
+VISIBILITY_POP
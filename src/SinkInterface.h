@@ -32,6 +32,35 @@ public:
     virtual ~IImageBufferSink() = default;
 
     virtual void push_image(const std::shared_ptr<ImageBuffer>&) = 0;
+
+    // Backends that can report partial frames only call push_partial_image when this is true.
+    virtual bool wants_partial_images() const
+    {
+        return false;
+    }
+
+    /**
+     * The first lines_complete lines of the frame that is assembled in buffer are final.
+     * Called from the thread of the backend while the rest of the frame is still transferred.
+     * push_image follows for the complete frame, software properties are only applied there.
+     */
+    virtual void push_partial_image(const std::shared_ptr<ImageBuffer>& /*buffer*/,
+                                    unsigned int /*lines_complete*/)
+    {
+    }
+
+    // Backends that receive a start of frame event only call push_frame_incoming when this is true.
+    virtual bool wants_frame_incoming() const
+    {
+        return false;
+    }
+
+    /**
+     * The device started to transmit the frame with the driver sequence number sequence.
+     * timestamp_ns is the CLOCK_MONOTONIC time of the event.
+     * Called from the thread of the backend, the image follows with push_image.
+     */
+    virtual void push_frame_incoming(uint64_t /*sequence*/, uint64_t /*timestamp_ns*/) {}
 };
 
 class IImageBufferPool
@@ -2,6 +2,8 @@
 
 #include "SoftwareProperties.h"
 
+#include "AutoPassWorker.h"
+#include "ImageBuffer.h"
 #include "SoftwarePropertiesImpl.h"
 #include "logging.h"
 
@@ -45,9 +47,11 @@ tcam::property::SoftwareProperties::SoftwareProperties(
 
 std::shared_ptr<tcam::property::SoftwareProperties> tcam::property::SoftwareProperties::create(
     const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
-    bool has_bayer)
+    bool has_bayer,
+    transaction_factory begin_transaction)
 {
     auto ptr = std::make_shared<SoftwareProperties>(dev_properties);
+    ptr->m_begin_transaction = std::move(begin_transaction);
     ptr->generate_public_properties(has_bayer);
     return ptr;
 }
@@ -60,82 +64,433 @@ static uint64_t time_now_in_us() noexcept
 }
 
 
-void tcam::property::SoftwareProperties::auto_pass(const img::img_descriptor& image)
+void tcam::property::SoftwareProperties::publish_auto_pass_params()
 {
-    auto_alg::auto_pass_params tmp_params;
+    auto& snapshot = m_auto_params_buffer.back();
+
+    snapshot.params = m_auto_params;
+    snapshot.params.exposure.max = m_exposure_auto_upper_limit;
+
+    if (m_active_brightness_roi)
+    {
+        snapshot.params.brightness_roi = { m_brightness_left,
+                                           m_brightness_top,
+                                           m_brightness_left + m_brightness_width,
+                                           m_brightness_top + m_brightness_height };
+    }
+    else
     {
-        std::scoped_lock lock(m_property_mtx);
+        snapshot.params.brightness_roi = {};
+    }
+    snapshot.params.focus_onepush_params.run_cmd_params.roi = {
+        m_focus_left, m_focus_top, m_focus_left + m_focus_width, m_focus_top + m_focus_height
+    };
 
-        tmp_params = m_auto_params;
+    snapshot.focus_run_cmd_seq = m_focus_run_cmd_seq;
+    snapshot.results_seq = m_merged_results_seq;
 
-        m_auto_params.focus_onepush_params.is_run_cmd = false;
-        tmp_params.exposure.max = m_exposure_auto_upper_limit;
+    m_auto_params_buffer.publish();
+}
 
-        if (m_active_brightness_roi)
-        {
-            tmp_params.brightness_roi = { m_brightness_left,
-                                          m_brightness_top,
-                                          m_brightness_left + m_brightness_width,
-                                          m_brightness_top + m_brightness_height };
-        }
-        else
-        {
-            tmp_params.brightness_roi = {};
-        }
-        tmp_params.focus_onepush_params.run_cmd_params.roi = {
-            m_focus_left, m_focus_top, m_focus_left + m_focus_width, m_focus_top + m_focus_height
-        };
+
+void tcam::property::SoftwareProperties::merge_auto_pass_results()
+{
+    if (!m_auto_results_buffer.update())
+    {
+        return;
     }
 
+    const auto& res = m_auto_results_buffer.front();
+    auto is_new = [this](uint64_t seq)
+    {
+        return seq > m_merged_results_seq;
+    };
+
+    if (is_new(res.exposure_seq))
+    {
+        m_auto_params.exposure.val = res.exposure_val;
+    }
+    if (is_new(res.gain_seq))
+    {
+        m_auto_params.gain.value = res.gain_val;
+    }
+    if (is_new(res.iris_seq))
+    {
+        m_auto_params.iris.val = res.iris_val;
+    }
+    if (is_new(res.focus_seq))
+    {
+        m_auto_params.focus_onepush_params.device_focus_val = res.focus_val;
+    }
+    if (is_new(res.wb_seq))
+    {
+        m_auto_params.wb.channels = res.wb_channels;
+    }
+    if (is_new(res.wb_one_push_done_seq))
+    {
+        m_auto_params.wb.one_push_enabled = false;
+    }
+
+    m_merged_results_seq = res.seq;
+}
+
+
+auto_alg::auto_pass_params tcam::property::SoftwareProperties::prepare_auto_pass_params()
+{
+    // never waits for the property setters, the parameters they published last are used
+    m_auto_params_buffer.update();
+    const auto& snapshot = m_auto_params_buffer.front();
+
+    auto tmp_params = snapshot.params;
+
+    // results of earlier passes the property side has not taken over yet
+    const auto& res = m_auto_results;
+    if (res.exposure_seq > snapshot.results_seq)
+    {
+        tmp_params.exposure.val = res.exposure_val;
+    }
+    if (res.gain_seq > snapshot.results_seq)
+    {
+        tmp_params.gain.value = res.gain_val;
+    }
+    if (res.iris_seq > snapshot.results_seq)
+    {
+        tmp_params.iris.val = res.iris_val;
+    }
+    if (res.focus_seq > snapshot.results_seq)
+    {
+        tmp_params.focus_onepush_params.device_focus_val = res.focus_val;
+    }
+    if (res.wb_seq > snapshot.results_seq)
+    {
+        tmp_params.wb.channels = res.wb_channels;
+    }
+    if (res.wb_one_push_done_seq > snapshot.results_seq)
+    {
+        tmp_params.wb.one_push_enabled = false;
+    }
+
+    // a FocusAuto request runs exactly once
+    tmp_params.focus_onepush_params.is_run_cmd =
+        snapshot.focus_run_cmd_seq != m_focus_run_cmd_consumed.load(std::memory_order_relaxed);
+    m_focus_run_cmd_consumed.store(snapshot.focus_run_cmd_seq, std::memory_order_relaxed);
+
+    tmp_params.image_statistics_histogram =
+        m_image_statistics_histogram.load(std::memory_order_relaxed);
+
     tmp_params.frame_number = m_frame_counter++;
     tmp_params.time_point = time_now_in_us();
 
+    return tmp_params;
+}
+
+
+void tcam::property::SoftwareProperties::auto_pass(const img::img_descriptor& image,
+                                                   uint64_t frame_count)
+{
+    auto tmp_params = prepare_auto_pass_params();
+
     auto auto_pass_ret = auto_alg::auto_pass(*p_state, image, tmp_params);
 
-    if (auto_pass_ret.exposure_changed)
+    apply_auto_pass_results(tmp_params, auto_pass_ret, frame_count);
+}
+
+
+void tcam::property::SoftwareProperties::auto_pass_async(tcam::AutoPassWorker& worker,
+                                                         const std::shared_ptr<ImageBuffer>& buffer)
+{
     {
-        m_auto_params.exposure.val = auto_pass_ret.exposure_value;
-        auto set_exp = m_dev_exposure->set_value(auto_pass_ret.exposure_value);
-        if (!set_exp)
+        std::scoped_lock lock(m_async_mtx);
+        if (m_async_pending)
         {
-            SPDLOG_ERROR("Unable to set exposure: {}", set_exp.error().message());
+            // the worker is still busy with an older frame
+            // skip this one, the algorithms only need every n-th frame anyway
+            m_frame_counter++;
+            return;
         }
     }
 
-    if (auto_pass_ret.gain_changed)
+    // no job is in flight, so p_state is exclusively ours until we submit one
+    auto tmp_params = prepare_auto_pass_params();
+
+    if (!auto_alg::should_prepare_auto_pass_step(*p_state, tmp_params))
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lock(m_async_mtx);
+        m_async_pending = true;
+    }
+
+    // The buffer reference keeps the memory alive while the worker samples it.
+    // The contents may already be requeued to the device, which only
+    // influences the statistics of this single run.
+    auto job = [self = shared_from_this(), buffer, tmp_params]()
     {
-        m_auto_params.gain.value = auto_pass_ret.gain_value;
-        auto set_gain = m_dev_gain->set_value(auto_pass_ret.gain_value);
-        if (!set_gain)
+        auto auto_pass_ret =
+            auto_alg::auto_pass(*self->p_state, buffer->get_img_descriptor(), tmp_params);
+
+        self->apply_auto_pass_results(tmp_params, auto_pass_ret, buffer->get_frame_count());
+
         {
-            SPDLOG_ERROR("Unable to set gain: {}", set_gain.error().message());
+            std::scoped_lock lock(self->m_async_mtx);
+            self->m_async_pending = false;
         }
+        self->m_async_cv.notify_all();
+    };
+
+    if (!worker.submit(std::move(job)))
+    {
+        std::scoped_lock lock(m_async_mtx);
+        m_async_pending = false;
     }
+}
 
-    if (auto_pass_ret.iris_changed)
+
+void tcam::property::SoftwareProperties::group_pass(uint64_t frame_count)
+{
+    const auto values = m_group->get_values();
+    if (values.seq == m_group_seq)
+    {
+        return;
+    }
+    m_group_seq = values.seq;
+
+    auto tmp_params = prepare_auto_pass_params();
+
+    // the values of the master are clipped to the ranges of this device
+    auto_alg::auto_pass_results res = {};
+    if (values.has_exposure && tmp_params.exposure.auto_enabled)
+    {
+        res.exposure_value =
+            std::clamp(values.exposure, tmp_params.exposure.min, tmp_params.exposure.max);
+        res.exposure_changed = res.exposure_value != tmp_params.exposure.val;
+    }
+    if (values.has_gain && tmp_params.gain.auto_enabled)
+    {
+        res.gain_value = std::clamp(values.gain, tmp_params.gain.min, tmp_params.gain.max);
+        res.gain_changed = res.gain_value != tmp_params.gain.value;
+    }
+    if (values.has_iris && tmp_params.iris.auto_enabled)
+    {
+        res.iris_value = std::clamp(values.iris, tmp_params.iris.min, tmp_params.iris.max);
+        res.iris_changed = res.iris_value != tmp_params.iris.val;
+    }
+    if (values.has_wb && tmp_params.wb.auto_enabled)
+    {
+        res.wb.channels = { values.wb_r, values.wb_g, values.wb_b };
+        res.wb.wb_changed = values.wb_r != tmp_params.wb.channels.r
+                            || values.wb_g != tmp_params.wb.channels.g
+                            || values.wb_b != tmp_params.wb.channels.b;
+    }
+
+    apply_auto_pass_results(tmp_params, res, frame_count);
+}
+
+
+void tcam::property::SoftwareProperties::wait_for_auto_pass()
+{
+    {
+        std::unique_lock lock(m_async_mtx);
+        m_async_cv.wait(lock, [this] { return !m_async_pending; });
+    }
+
+    if (auto queue = m_write_queue.lock())
+    {
+        queue->wait_idle();
+    }
+}
+
+
+template<class TProp, class TValue>
+void tcam::property::SoftwareProperties::write_auto_result(
+    const std::shared_ptr<TProp>& prop,
+    TValue value,
+    bool (*is_auto)(const auto_alg::auto_pass_params&),
+    bool log_as_error)
+{
+    auto report = [log_as_error](std::string_view name, const outcome::result<void>& res)
     {
-        m_auto_params.iris.val = auto_pass_ret.iris_value;
-        auto set_iris = m_dev_iris->set_value(auto_pass_ret.iris_value);
-        if (!set_iris)
+        if (res)
         {
-            SPDLOG_ERROR("Unable to set iris: {}", set_iris.error().message());
+            return;
         }
+        if (log_as_error)
+        {
+            SPDLOG_ERROR("Unable to set {}: {}", name, res.error().message());
+        }
+        else
+        {
+            SPDLOG_DEBUG("Unable to set {}: {}", name, res.error().message());
+        }
+    };
+
+    auto queue = m_write_queue.lock();
+    if (!queue)
+    {
+        report(prop->get_name(), prop->set_value(value));
+        return;
     }
 
-    if (auto_pass_ret.focus_changed)
+    std::weak_ptr<SoftwareProperties> weak_self = weak_from_this();
+    const std::string name { prop->get_name() };
+    queue->submit(
+        name,
+        [weak_self, prop, value, is_auto]() -> outcome::result<void>
+        {
+            auto self = weak_self.lock();
+            if (!self)
+            {
+                return outcome::success();
+            }
+            std::scoped_lock lock(self->m_property_mtx);
+            if (is_auto && !is_auto(self->m_auto_params))
+            {
+                return outcome::success();
+            }
+            return prop->set_value(value);
+        },
+        [report, name](const outcome::result<void>& res) { report(name, res); });
+}
+
+
+auto tcam::property::SoftwareProperties::acquire_image_statistics()
+    -> std::shared_ptr<tcam_image_statistics>
+{
+    // buffers in flight keep their statistics, so a few entries cover the whole queue
+    static const constexpr size_t max_pool_size = 16;
+
+    for (auto& entry : m_image_statistics_pool)
+    {
+        if (entry.use_count() == 1)
+        {
+            return entry;
+        }
+    }
+
+    auto stats = std::make_shared<tcam_image_statistics>();
+    if (m_image_statistics_pool.size() < max_pool_size)
     {
-        m_auto_params.focus_onepush_params.device_focus_val = auto_pass_ret.focus_value;
-        auto set_foc = m_dev_focus->set_value(auto_pass_ret.focus_value);
-        if (!set_foc)
+        m_image_statistics_pool.push_back(stats);
+    }
+    return stats;
+}
+
+
+void tcam::property::SoftwareProperties::apply_auto_pass_results(
+    const auto_alg::auto_pass_params& params,
+    const auto_alg::auto_pass_results& auto_pass_ret,
+    uint64_t frame_count)
+{
+    if (auto_pass_ret.statistics.valid)
+    {
+        const auto& in = auto_pass_ret.statistics;
+
+        auto stats = acquire_image_statistics();
+        *stats = {};
+        stats->frame_count = frame_count;
+        stats->brightness = in.brightness;
+        stats->saturated_fraction = in.saturated_fraction;
+        stats->mean_r = in.mean_r;
+        stats->mean_g = in.mean_g;
+        stats->mean_b = in.mean_b;
+        stats->sample_count = in.sample_count;
+        if (in.histogram_count != 0)
         {
-            SPDLOG_ERROR("Unable to set focus: {}", set_foc.error().message());
+            std::copy(std::begin(in.histogram), std::end(in.histogram), stats->histogram);
+            stats->histogram_count = in.histogram_count;
         }
+        std::atomic_store(&m_image_statistics,
+                          std::shared_ptr<const tcam_image_statistics>(std::move(stats)));
+    }
+
+    // most passes change nothing, they should not cost a transaction
+    const bool writes_device = auto_pass_ret.exposure_changed || auto_pass_ret.gain_changed
+                               || auto_pass_ret.iris_changed || auto_pass_ret.focus_changed
+                               || (auto_pass_ret.wb.wb_changed && m_wb.is_dev_wb());
+
+    // the write queue batches the writes itself
+    std::unique_ptr<IPropertyTransaction> transaction;
+    if (writes_device && m_begin_transaction && m_write_queue.expired())
+    {
+        transaction = m_begin_transaction();
+    }
+
+    // only the auto pass writes m_auto_results, the property side picks them up
+    // through m_auto_results_buffer, so no lock is needed here
+    auto& res = m_auto_results;
+    const uint64_t seq = res.seq + 1;
+    bool any_changed = false;
+
+    if (auto_pass_ret.exposure_changed)
+    {
+        res.exposure_seq = seq;
+        res.exposure_val = auto_pass_ret.exposure_value;
+        any_changed = true;
+
+        write_auto_result(
+            m_dev_exposure,
+            auto_pass_ret.exposure_value,
+            [](const auto_alg::auto_pass_params& p) { return p.exposure.auto_enabled; },
+            true);
+        notify_changed("ExposureTime");
+    }
+
+    if (auto_pass_ret.gain_changed)
+    {
+        res.gain_seq = seq;
+        res.gain_val = auto_pass_ret.gain_value;
+        any_changed = true;
+
+        write_auto_result(
+            m_dev_gain,
+            auto_pass_ret.gain_value,
+            [](const auto_alg::auto_pass_params& p) { return p.gain.auto_enabled; },
+            true);
+        notify_changed("Gain");
+    }
+
+    if (auto_pass_ret.iris_changed)
+    {
+        res.iris_seq = seq;
+        res.iris_val = auto_pass_ret.iris_value;
+        any_changed = true;
+
+        write_auto_result(
+            m_dev_iris,
+            auto_pass_ret.iris_value,
+            [](const auto_alg::auto_pass_params& p) { return p.iris.auto_enabled; },
+            true);
+        notify_changed("Iris");
+    }
+
+    if (auto_pass_ret.focus_changed)
+    {
+        res.focus_seq = seq;
+        res.focus_val = auto_pass_ret.focus_value;
+        any_changed = true;
+
+        // one push, nothing can disable it afterwards
+        write_auto_result(m_dev_focus, auto_pass_ret.focus_value, nullptr, true);
+        notify_changed("Focus");
     }
 
     if (auto_pass_ret.wb.wb_changed)
     {
-        m_auto_params.wb.channels = auto_pass_ret.wb.channels;
-        m_auto_params.wb.one_push_enabled = auto_pass_ret.wb.one_push_still_running;
+        if (params.wb.one_push_enabled && !auto_pass_ret.wb.one_push_still_running)
+        {
+            // BalanceWhiteAuto falls back from Once to Off
+            res.wb_one_push_done_seq = seq;
+            notify_changed("BalanceWhiteAuto");
+        }
+        notify_changed("BalanceWhiteRed");
+        notify_changed("BalanceWhiteGreen");
+        notify_changed("BalanceWhiteBlue");
+
+        res.wb_seq = seq;
+        res.wb_channels = auto_pass_ret.wb.channels;
+        any_changed = true;
 
         // SPDLOG_DEBUG("WB r: {}", auto_pass_ret.wb.channels.r);
         // SPDLOG_DEBUG("WB g: {}", auto_pass_ret.wb.channels.g);
@@ -143,31 +498,61 @@ void tcam::property::SoftwareProperties::auto_pass(const img::img_descriptor& im
 
         if (m_wb.is_dev_wb())
         {
-            auto res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteRed,
-                                                auto_pass_ret.wb.channels.r);
-
-            if (!res)
-            {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
-            }
-            res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteGreen,
-                                           auto_pass_ret.wb.channels.g);
-            if (!res)
+            // the last result of a one push run is written after it ended
+            bool (*is_auto)(const auto_alg::auto_pass_params&) = nullptr;
+            if (params.wb.auto_enabled)
             {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
+                is_auto = [](const auto_alg::auto_pass_params& p) { return p.wb.auto_enabled; };
             }
+            write_auto_result(m_wb.m_dev_wb_r, auto_pass_ret.wb.channels.r, is_auto, false);
+            write_auto_result(m_wb.m_dev_wb_g, auto_pass_ret.wb.channels.g, is_auto, false);
+            write_auto_result(m_wb.m_dev_wb_b, auto_pass_ret.wb.channels.b, is_auto, false);
+        }
+    }
 
-            res = set_whitebalance_channel(emulated::software_prop::BalanceWhiteBlue,
-                                           auto_pass_ret.wb.channels.b);
-            if (!res)
-            {
-                SPDLOG_DEBUG("Setting whitebalance caused an error: {}",
-                             res.as_failure().error().message());
-            }
+    if (transaction)
+    {
+        if (auto res = transaction->commit(); !res)
+        {
+            SPDLOG_ERROR("Unable to write auto pass results: {}", res.error().message());
         }
     }
+
+    if (any_changed && m_group && m_group_master)
+    {
+        // whole values, a member that joined late or missed a publish does not fall behind
+        AutoGroup::values group_values;
+        group_values.exposure =
+            auto_pass_ret.exposure_changed ? auto_pass_ret.exposure_value : params.exposure.val;
+        group_values.has_exposure = params.exposure.auto_enabled;
+        group_values.gain =
+            auto_pass_ret.gain_changed ? auto_pass_ret.gain_value : params.gain.value;
+        group_values.has_gain = params.gain.auto_enabled;
+        group_values.iris = auto_pass_ret.iris_changed ? auto_pass_ret.iris_value : params.iris.val;
+        group_values.has_iris = params.iris.auto_enabled;
+        const auto& wb =
+            auto_pass_ret.wb.wb_changed ? auto_pass_ret.wb.channels : params.wb.channels;
+        group_values.wb_r = wb.r;
+        group_values.wb_g = wb.g;
+        group_values.wb_b = wb.b;
+        group_values.has_wb = params.wb.auto_enabled;
+        m_group->publish(group_values);
+    }
+
+    if (any_changed)
+    {
+        res.seq = seq;
+        m_auto_results_buffer.back() = res;
+        m_auto_results_buffer.publish();
+    }
+}
+
+void tcam::property::SoftwareProperties::notify_changed(std::string_view name)
+{
+    if (m_change_notifier)
+    {
+        m_change_notifier->notify_with_dependents(name);
+    }
 }
 
 void tcam::property::SoftwareProperties::generate_public_properties(bool has_bayer)
@@ -189,9 +574,12 @@ void tcam::property::SoftwareProperties::generate_public_properties(bool has_bay
         }
     }
 
-    generate_color_transformation();
+    generate_color_transformation(has_bayer);
 
     m_properties = m_properties;
+
+    std::scoped_lock lock(m_property_mtx);
+    publish_auto_pass_params();
 }
 
 outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
@@ -199,6 +587,8 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
 {
     std::scoped_lock lock(m_property_mtx);
 
+    merge_auto_pass_results();
+
     switch (prop_id)
     {
         case emulated::software_prop::ExposureTime:
@@ -253,7 +643,7 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
         case emulated::software_prop::Focus:
             return m_auto_params.focus_onepush_params.device_focus_val;
         case emulated::software_prop::FocusAuto:
-            return m_auto_params.focus_onepush_params.is_run_cmd;
+            return m_focus_run_cmd_seq != m_focus_run_cmd_consumed.load(std::memory_order_relaxed);
         case emulated::software_prop::FocusAutoTop:
             return m_focus_top;
         case emulated::software_prop::FocusAutoLeft:
@@ -276,8 +666,14 @@ outcome::result<int64_t> tcam::property::SoftwareProperties::get_int(
         }
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
             return m_wb.m_wb_is_claimed;
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+            return m_clr.m_is_claimed;
         case emulated::software_prop::ColorTransformEnable:
         {
+            if (m_clr.m_is_software)
+            {
+                return m_clr.m_enable;
+            }
             auto res = m_dev_color_transform_enable->get_value();
             if (res.has_failure())
             {
@@ -295,6 +691,16 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
 {
     std::scoped_lock lock(m_property_mtx);
 
+    merge_auto_pass_results();
+    auto ret = set_int_impl(prop_id, new_val);
+    publish_auto_pass_params();
+    return ret;
+}
+
+outcome::result<void> tcam::property::SoftwareProperties::set_int_impl(
+    emulated::software_prop prop_id,
+    int64_t new_val)
+{
     switch (prop_id)
     {
         case emulated::software_prop::ExposureTime:
@@ -421,12 +827,15 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
         }
         case emulated::software_prop::FocusAuto:
         {
-            m_auto_params.focus_onepush_params.is_run_cmd = new_val;
-            m_auto_params.focus_onepush_params.run_cmd_params.roi = { m_focus_left,
-                                                                      m_focus_top,
-                                                                      m_focus_left + m_focus_width,
-                                                                      m_focus_top
-                                                                          + m_focus_height };
+            if (new_val)
+            {
+                m_focus_run_cmd_seq++;
+            }
+            else
+            {
+                // drop a request the auto pass has not seen yet
+                m_focus_run_cmd_seq = m_focus_run_cmd_consumed.load(std::memory_order_relaxed);
+            }
             return outcome::success();
         }
         case emulated::software_prop::FocusAutoTop:
@@ -484,8 +893,18 @@ outcome::result<void> tcam::property::SoftwareProperties::set_int(emulated::soft
             m_wb.m_wb_is_claimed = new_val;
             return outcome::success();
         }
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+        {
+            m_clr.m_is_claimed = new_val;
+            return outcome::success();
+        }
         case emulated::software_prop::ColorTransformEnable:
         {
+            if (m_clr.m_is_software)
+            {
+                m_clr.m_enable = new_val;
+                return outcome::success();
+            }
             return m_dev_color_transform_enable->set_value(new_val);
         }
     }
@@ -499,6 +918,8 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
 {
     std::scoped_lock lock(m_property_mtx);
 
+    merge_auto_pass_results();
+
     switch (prop_id)
     {
         case emulated::software_prop::ExposureAuto:
@@ -523,6 +944,7 @@ outcome::result<double> tcam::property::SoftwareProperties::get_double(
         case emulated::software_prop::BalanceWhiteAuto:
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
         case emulated::software_prop::ColorTransformEnable:
+        case emulated::software_prop::ClaimColorTransformationSoftware:
             return tcam::status::PropertyNotImplemented;
 
         case emulated::software_prop::ExposureTime:
@@ -592,6 +1014,16 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
 {
     std::scoped_lock lock(m_property_mtx);
 
+    merge_auto_pass_results();
+    auto ret = set_double_impl(prop_id, new_val);
+    publish_auto_pass_params();
+    return ret;
+}
+
+outcome::result<void> tcam::property::SoftwareProperties::set_double_impl(
+    emulated::software_prop prop_id,
+    double new_val)
+{
     switch (prop_id)
     {
         case emulated::software_prop::ExposureAuto:
@@ -616,6 +1048,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_double(
         case emulated::software_prop::BalanceWhiteAuto:
         case emulated::software_prop::ClaimBalanceWhiteSoftware:
         case emulated::software_prop::ColorTransformEnable:
+        case emulated::software_prop::ClaimColorTransformationSoftware:
             return tcam::status::PropertyNotImplemented;
 
         case emulated::software_prop::ExposureTime:
@@ -783,6 +1216,15 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
         case emulated::software_prop::ColorTransformGreenToBlue:
         case emulated::software_prop::ColorTransformBlueToBlue:
         {
+            if (m_clr.m_is_software)
+            {
+                // nobody applies the matrix
+                if (!m_clr.m_is_claimed)
+                {
+                    return PropertyFlags::Implemented;
+                }
+                return add_locked(!m_clr.m_enable);
+            }
             auto res = m_dev_color_transform_enable->get_value();
             if (!res)
             {
@@ -791,7 +1233,15 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
             return add_locked(!res.value());
         }
         case emulated::software_prop::ColorTransformEnable:
+        {
+            if (m_clr.m_is_software && !m_clr.m_is_claimed)
+            {
+                return PropertyFlags::Implemented;
+            }
             return default_flags;
+        }
+        case emulated::software_prop::ClaimColorTransformationSoftware:
+            return default_flags | PropertyFlags::Hidden;
     }
     return PropertyFlags::None;
 }
@@ -799,6 +1249,8 @@ tcam::property::PropertyFlags tcam::property::SoftwareProperties::get_flags(
 
 void tcam::property::SoftwareProperties::update_to_new_format(const tcam::VideoFormat& new_format)
 {
+    wait_for_auto_pass();
+
     m_frame_counter = 0;
     m_format = new_format;
 
@@ -834,6 +1286,9 @@ void tcam::property::SoftwareProperties::update_to_new_format(const tcam::VideoF
         m_prop_focus_width->set_range(x_range);
         m_prop_focus_height->set_range(y_range);
     }
+
+    std::scoped_lock lock(m_property_mtx);
+    publish_auto_pass_params();
 }
 
 void property::SoftwareProperties::add_prop_entry(prop_ptr_vec& v,
@@ -2,16 +2,30 @@
 
 #pragma once
 
+#include "AutoGroup.h"
+#include "PropertyChangeNotifier.h"
 #include "PropertyInterfaces.h"
+#include "PropertyWriteQueue.h"
 #include "SoftwarePropertiesBase.h"
 #include "SoftwarePropertiesImpl.h"
 #include "VideoFormat.h"
 #include "compiler_defines.h"
+#include "triple_buffer.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <dutils_img_pipe/auto_alg_pass.h>
 #include <memory>
 #include <mutex>
 #include <vector>
+
+namespace tcam
+{
+class ImageBuffer;
+class AutoPassWorker;
+} // namespace tcam
+
 namespace tcam::property
 {
 
@@ -37,14 +51,56 @@ public:
 public:
     static std::shared_ptr<SoftwareProperties> create(
         const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& dev_properties,
-        bool has_bayer);
+        bool has_bayer,
+        transaction_factory begin_transaction);
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties()
     {
         return m_properties;
     }
 
-    void auto_pass(const img::img_descriptor& image);
+    void auto_pass(const img::img_descriptor& image, uint64_t frame_count);
+
+    // Hands the frame to worker instead of running the algorithms
+    // and the device writes on the calling thread.
+    // Frames that arrive while a previous pass is still running are skipped.
+    void auto_pass_async(tcam::AutoPassWorker& worker, const std::shared_ptr<ImageBuffer>& buffer);
+
+    // blocks until no asynchronous auto pass is in flight
+    void wait_for_auto_pass();
+
+    // statistics of the last auto pass that sampled an image, nullptr before the first one
+    std::shared_ptr<const tcam_image_statistics> get_image_statistics() const
+    {
+        return std::atomic_load(&m_image_statistics);
+    }
+
+    /**
+     * Share the auto functions with the other devices of group, nullptr leaves the group.
+     * The master runs the auto passes and publishes what it wrote,
+     * the others write the published values for the auto functions they have enabled
+     * with group_pass instead of running their own passes. Only while no stream is running.
+     */
+    void set_auto_group(std::shared_ptr<tcam::AutoGroup> group, bool is_master)
+    {
+        m_group = std::move(group);
+        m_group_master = is_master;
+        m_group_seq = 0;
+    }
+
+    bool is_auto_group_member() const noexcept
+    {
+        return m_group && !m_group_master;
+    }
+
+    // writes the values the master of the group published since the last call
+    void group_pass(uint64_t frame_count);
+
+    // let the auto passes fill tcam_image_statistics::histogram, see auto_pass_params
+    void set_image_statistics_histogram(bool b) noexcept
+    {
+        m_image_statistics_histogram.store(b, std::memory_order_relaxed);
+    }
 
     outcome::result<int64_t> get_int(emulated::software_prop prop_id) final;
     outcome::result<void> set_int(emulated::software_prop prop_id, int64_t new_val) final;
@@ -54,12 +110,48 @@ public:
 
     tcam::property::PropertyFlags get_flags(emulated::software_prop) const final;
 
+    void notify_changed(std::string_view name) final;
+
+    // receives the properties changed by writes and by the auto functions,
+    // has to be set before the first auto pass
+    void set_change_notifier(std::shared_ptr<PropertyChangeNotifier> notifier)
+    {
+        m_change_notifier = std::move(notifier);
+    }
+
+    // the auto functions hand their device writes to queue instead of blocking the pass,
+    // only a weak reference is kept, without a queue the writes are executed directly
+    void set_write_queue(const std::shared_ptr<PropertyWriteQueue>& queue)
+    {
+        m_write_queue = queue;
+    }
+
     void update_to_new_format(const tcam::VideoFormat& new_format);
 
 private:
 
     static constexpr int ROI_STEP_SIZE = 4;
 
+    auto_alg::auto_pass_params prepare_auto_pass_params();
+    void apply_auto_pass_results(const auto_alg::auto_pass_params& params,
+                                 const auto_alg::auto_pass_results& auto_pass_ret,
+                                 uint64_t frame_count);
+
+    // a queued write is skipped when is_auto reports that the auto function was disabled
+    // in the meantime, so that it does not overwrite a manual value
+    template<class TProp, class TValue>
+    void write_auto_result(const std::shared_ptr<TProp>& prop,
+                           TValue value,
+                           bool (*is_auto)(const auto_alg::auto_pass_params&),
+                           bool log_as_error);
+
+    // both require m_property_mtx
+    void publish_auto_pass_params();
+    void merge_auto_pass_results();
+
+    outcome::result<void> set_int_impl(emulated::software_prop prop_id, int64_t new_val);
+    outcome::result<void> set_double_impl(emulated::software_prop prop_id, double new_val);
+
     // encapsulation for internal property generation
     void generate_public_properties(bool has_bayer);
 
@@ -78,7 +170,8 @@ private:
     outcome::result<void> set_whitebalance_channel(emulated::software_prop prop_id,
                                                    double new_value);
 
-    void generate_color_transformation();
+    void generate_color_transformation(bool has_bayer);
+    void generate_software_color_transformation();
 
     outcome::result<double> get_device_color_transform(emulated::software_prop prop_id);
 
@@ -92,6 +185,13 @@ private:
 
     mutable std::mutex m_property_mtx;
 
+    // used to write the results of one auto pass in a single device request
+    transaction_factory m_begin_transaction;
+
+    std::shared_ptr<PropertyChangeNotifier> m_change_notifier;
+
+    std::weak_ptr<PropertyWriteQueue> m_write_queue;
+
     tcam_image_size sensor_dimensions_ = {};
 
     std::shared_ptr<tcam::property::IPropertyFloat> m_dev_exposure = nullptr;
@@ -148,15 +248,79 @@ private:
     std::shared_ptr<tcam::property::IPropertyFloat> m_dev_color_transform_value = nullptr;
     std::shared_ptr<tcam::property::IPropertyEnum> m_dev_color_transform_value_selector = nullptr;
 
+    // devices without a color transformation get these, tcamconvert applies them while debayering
+    struct software_color_transform
+    {
+        bool m_is_software = false;
+        bool m_is_claimed = false;
+        bool m_enable = false;
+        // Gain00 .. Gain22, row is the output channel
+        std::array<double, 9> m_values = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    };
+    software_color_transform m_clr;
+
     // general stuff
 
     auto_alg::auto_pass_params m_auto_params;
     bool m_active_brightness_roi = false;
+
+    // Parameters for the next auto pass.
+    // Written by the property setters under m_property_mtx, read by the auto pass.
+    struct auto_params_snapshot
+    {
+        auto_alg::auto_pass_params params;
+        uint64_t focus_run_cmd_seq = 0;
+        // latest auto pass results that are already contained in params
+        uint64_t results_seq = 0;
+    };
+    triple_buffer<auto_params_snapshot> m_auto_params_buffer;
+
+    uint64_t m_focus_run_cmd_seq = 0;
+    std::atomic<uint64_t> m_focus_run_cmd_consumed = 0;
+
+    // Values written by the auto passes, each with the number of the pass that changed it last.
+    // Owned by the auto pass, taken over by the property side under m_property_mtx.
+    struct auto_results_snapshot
+    {
+        uint64_t seq = 0;
+
+        uint64_t exposure_seq = 0;
+        int exposure_val = 0;
+        uint64_t gain_seq = 0;
+        float gain_val = 0;
+        uint64_t iris_seq = 0;
+        int iris_val = 0;
+        uint64_t focus_seq = 0;
+        int focus_val = 0;
+        uint64_t wb_seq = 0;
+        auto_alg::wb_channel_factors wb_channels = {};
+        uint64_t wb_one_push_done_seq = 0;
+    };
+    auto_results_snapshot m_auto_results;
+    triple_buffer<auto_results_snapshot> m_auto_results_buffer;
+    uint64_t m_merged_results_seq = 0;
+
     auto_alg::state_ptr p_state;
     tcam::VideoFormat m_format;
 
     int64_t m_frame_counter = 0;
 
+    // replaced by every auto pass that sampled an image, read by the stream thread
+    std::shared_ptr<const tcam_image_statistics> m_image_statistics;
+    std::atomic<bool> m_image_statistics_histogram = false;
+    // statistics are reused once neither m_image_statistics nor a buffer references them
+    std::vector<std::shared_ptr<tcam_image_statistics>> m_image_statistics_pool;
+    std::shared_ptr<tcam_image_statistics> acquire_image_statistics();
+
+    std::shared_ptr<tcam::AutoGroup> m_group;
+    bool m_group_master = false;
+    // seq of the group values the last group_pass wrote
+    uint64_t m_group_seq = 0;
+
+    std::mutex m_async_mtx;
+    std::condition_variable m_async_cv;
+    bool m_async_pending = false;
+
 
     template<class Tprop_info_type, typename... Tparams>
     auto make_prop_entry(emulated::software_prop id,
@@ -58,6 +58,7 @@ enum class software_prop
     ColorTransformRedToBlue,
     ColorTransformGreenToBlue,
     ColorTransformBlueToBlue,
+    ClaimColorTransformationSoftware,
 };
 
 struct prop_range_integer_def
@@ -111,6 +112,9 @@ public:
     virtual outcome::result<double> get_double(software_prop id) = 0;
     virtual outcome::result<void> set_double(software_prop id, double new_value) = 0;
     virtual tcam::property::PropertyFlags get_flags(software_prop id) const = 0;
+
+    // called by the property objects after a successful write
+    virtual void notify_changed(std::string_view /*name*/) {}
 };
 
 } // namespace tcam::property::emulated
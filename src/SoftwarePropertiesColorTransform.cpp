@@ -52,9 +52,32 @@ static std::string_view to_transform_name(tcam::property::emulated::software_pro
 }
 
 
+// index of the GainXY factor in SoftwareProperties::software_color_transform::m_values
+static size_t to_transform_index(tcam::property::emulated::software_prop prop)
+{
+    auto name = to_transform_name(prop);
+    return (name[4] - '0') * 3 + (name[5] - '0');
+}
+
+
+namespace
+{
+
+// tcamconvert applies the matrix in 1/64 fixed point, rows that sum up beyond 2.0 are scaled down
+static constexpr auto software_color_transform_range =
+    tcam::property::emulated::prop_range_float_def { -2.0, 2.0, 0.01, 0.0 };
+
+} // namespace
+
+
 outcome::result<double> tcam::property::SoftwareProperties::get_device_color_transform(
     emulated::software_prop prop_id)
 {
+    if (m_clr.m_is_software)
+    {
+        return m_clr.m_values.at(to_transform_index(prop_id));
+    }
+
     auto channel = to_transform_name(prop_id);
 
     auto res = m_dev_color_transform_value_selector->set_value(channel);
@@ -72,6 +95,17 @@ outcome::result<void> tcam::property::SoftwareProperties::set_device_color_trans
     emulated::software_prop prop_id,
     double new_value_tmp)
 {
+    if (m_clr.m_is_software)
+    {
+        if (new_value_tmp < software_color_transform_range.range.min
+            || new_value_tmp > software_color_transform_range.range.max)
+        {
+            return tcam::status::PropertyValueOutOfBounds;
+        }
+        m_clr.m_values.at(to_transform_index(prop_id)) = new_value_tmp;
+        return outcome::success();
+    }
+
     auto channel = to_transform_name(prop_id);
 
     auto res = m_dev_color_transform_value_selector->set_value(channel);
@@ -85,7 +119,7 @@ outcome::result<void> tcam::property::SoftwareProperties::set_device_color_trans
 }
 
 
-void tcam::property::SoftwareProperties::generate_color_transformation()
+void tcam::property::SoftwareProperties::generate_color_transformation(bool has_bayer)
 {
     auto enable =
         tcam::property::find_property<IPropertyBool>(m_properties, "ColorTransformationEnable");
@@ -96,6 +130,10 @@ void tcam::property::SoftwareProperties::generate_color_transformation()
 
     if (!enable || !value || !value_selector)
     {
+        if (has_bayer && !enable)
+        {
+            generate_software_color_transformation();
+        }
         return;
     }
 
@@ -128,12 +166,12 @@ void tcam::property::SoftwareProperties::generate_color_transformation()
                    range);
 
     add_prop_entry(new_list,
-                   sp::ColorTransformBlueToRed,
+                   sp::ColorTransformGreenToRed,
                    &tcamprop1::prop_list::ColorTransformation_Value_Gain01,
                    range);
 
     add_prop_entry(new_list,
-                   sp::ColorTransformGreenToRed,
+                   sp::ColorTransformBlueToRed,
                    &tcamprop1::prop_list::ColorTransformation_Value_Gain02,
                    range);
 
@@ -172,3 +210,69 @@ void tcam::property::SoftwareProperties::generate_color_transformation()
     replace_entry(m_properties, new_enable_item);
     add_prop_entry(m_properties, "ColorTransformationEnable", new_list);
 }
+
+
+void tcam::property::SoftwareProperties::generate_software_color_transformation()
+{
+    SPDLOG_INFO("Adding ColorTransformation software based.");
+
+    m_clr = {};
+    m_clr.m_is_software = true;
+
+    auto gain_range = [](double def)
+    {
+        auto r = software_color_transform_range;
+        r.def = def;
+        return r;
+    };
+
+    prop_ptr_vec new_list;
+
+    add_prop_entry(new_list,
+                   sp::ColorTransformRedToRed,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain00,
+                   gain_range(1.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformGreenToRed,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain01,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformBlueToRed,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain02,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformRedToGreen,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain10,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformGreenToGreen,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain11,
+                   gain_range(1.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformBlueToGreen,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain12,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformRedToBlue,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain20,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformGreenToBlue,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain21,
+                   gain_range(0.0));
+    add_prop_entry(new_list,
+                   sp::ColorTransformBlueToBlue,
+                   &tcamprop1::prop_list::ColorTransformation_Value_Gain22,
+                   gain_range(1.0));
+
+    // tcamconvert claims the matrix, without it nothing would apply it
+    add_prop_entry(m_properties,
+                   sp::ClaimColorTransformationSoftware,
+                   &tcamprop1::prop_list::ClaimColorTransformationSoftware,
+                   false);
+    add_prop_entry(m_properties,
+                   sp::ColorTransformEnable,
+                   &tcamprop1::prop_list::ColorTransformationEnable,
+                   false);
+    add_prop_entry(m_properties, "ColorTransformationEnable", new_list);
+}
@@ -52,7 +52,7 @@ outcome::result<void> SoftwarePropertyIntegerImpl::set_value(int64_t new_value)
 {
     if (auto ptr = m_cam.lock())
     {
-        return ptr->set_int(m_id, new_value);
+        return notify_on_success(*ptr, ptr->set_int(m_id, new_value));
     }
     else
     {
@@ -90,7 +90,7 @@ outcome::result<void> SoftwarePropertyDoubleImpl::set_value(double new_value)
 {
     if (auto ptr = m_cam.lock())
     {
-        return ptr->set_double(m_id, new_value);
+        return notify_on_success(*ptr, ptr->set_double(m_id, new_value));
     }
     else
     {
@@ -130,7 +130,7 @@ outcome::result<void> SoftwarePropertyBoolImpl::set_value(bool new_value)
 {
     if (auto ptr = m_cam.lock())
     {
-        return ptr->set_int(m_id, new_value);
+        return notify_on_success(*ptr, ptr->set_int(m_id, new_value));
     }
 
     SPDLOG_ERROR("Unable to lock property backend for {}. Cannot write value.",
@@ -171,7 +171,7 @@ outcome::result<void> SoftwarePropertyEnumImpl::set_value(std::string_view new_v
         {
             if (auto ptr = m_cam.lock())
             {
-                return ptr->set_int(m_id, static_cast<int64_t>(idx));
+                return notify_on_success(*ptr, ptr->set_int(m_id, static_cast<int64_t>(idx)));
             }
             else
             {
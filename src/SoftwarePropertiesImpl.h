@@ -48,6 +48,16 @@ protected:
         return p_static_info->name;
     }
 
+    outcome::result<void> notify_on_success(SoftwarePropertyBackend& backend,
+                                            outcome::result<void> res) const
+    {
+        if (res)
+        {
+            backend.notify_changed(get_internal_name());
+        }
+        return res;
+    }
+
     SoftwarePropertyImplBase(software_prop id,
                              const tcamprop1::prop_static_info* info,
                              const std::shared_ptr<SoftwarePropertyBackend>& ptr)
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SoftwareTriggerGroup.h"
+
+#include "latency_tracing.h"
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+
+using namespace tcam;
+
+
+SoftwareTriggerGroup::SoftwareTriggerGroup(
+    std::vector<std::shared_ptr<tcam::property::IPropertyCommand>> commands)
+    : commands_(std::move(commands))
+{
+    for (size_t i = 1; i < commands_.size(); ++i)
+    {
+        threads_.emplace_back(&SoftwareTriggerGroup::run, this, i);
+    }
+}
+
+
+SoftwareTriggerGroup::~SoftwareTriggerGroup()
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        stop_ = true;
+    }
+    wake_cv_.notify_all();
+
+    for (auto& t : threads_)
+    {
+        t.join();
+    }
+}
+
+
+void SoftwareTriggerGroup::execute(size_t index)
+{
+    report_.issue_ns[index] = tcam::latency::now_ns();
+    auto res = commands_[index]->execute();
+    report_.complete_ns[index] = tcam::latency::now_ns();
+
+    if (!res)
+    {
+        report_.errors[index] = res.error();
+    }
+}
+
+
+void SoftwareTriggerGroup::run(size_t index)
+{
+    tcam::set_thread_name("tcam_trigger");
+
+    uint64_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lck { mtx_ };
+            wake_cv_.wait(lck, [&] { return stop_ || generation_ != seen; });
+            if (stop_)
+            {
+                return;
+            }
+            seen = generation_;
+        }
+
+        armed_.fetch_add(1, std::memory_order_release);
+        while (!go_.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        execute(index);
+
+        {
+            std::scoped_lock lck { mtx_ };
+            done_++;
+        }
+        done_cv_.notify_one();
+    }
+}
+
+
+trigger_report SoftwareTriggerGroup::fire()
+{
+    std::scoped_lock fire_lck { fire_mtx_ };
+
+    const size_t count = commands_.size();
+
+    report_ = {};
+    report_.issue_ns.resize(count);
+    report_.complete_ns.resize(count);
+    report_.errors.resize(count);
+
+    if (count == 0)
+    {
+        return report_;
+    }
+
+    armed_ = 0;
+    go_ = false;
+    {
+        std::scoped_lock lck { mtx_ };
+        done_ = 0;
+        generation_++;
+    }
+    wake_cv_.notify_all();
+
+    // the threads spin once they are awake, the release is a single store
+    while (armed_.load(std::memory_order_acquire) < threads_.size())
+    {
+        std::this_thread::yield();
+    }
+    go_.store(true, std::memory_order_release);
+
+    execute(0);
+
+    {
+        std::unique_lock lck { mtx_ };
+        done_cv_.wait(lck, [&] { return done_ == threads_.size(); });
+    }
+
+    uint64_t first_issue = UINT64_MAX;
+    uint64_t last_issue = 0;
+    uint64_t first_complete = UINT64_MAX;
+    uint64_t last_complete = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (report_.errors[i])
+        {
+            SPDLOG_WARN("Trigger {} of the group failed: {}", i, report_.errors[i].message());
+            report_.failed++;
+            continue;
+        }
+        first_issue = std::min(first_issue, report_.issue_ns[i]);
+        last_issue = std::max(last_issue, report_.issue_ns[i]);
+        first_complete = std::min(first_complete, report_.complete_ns[i]);
+        last_complete = std::max(last_complete, report_.complete_ns[i]);
+    }
+
+    if (report_.failed < count)
+    {
+        report_.issue_skew_ns = last_issue - first_issue;
+        report_.complete_skew_ns = last_complete - first_complete;
+    }
+
+    SPDLOG_TRACE("Fired {} triggers, issue skew {} ns, completion skew {} ns",
+                 count,
+                 report_.issue_skew_ns,
+                 report_.complete_skew_ns);
+    return report_;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "PropertyInterfaces.h"
+#include "compiler_defines.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+struct trigger_report
+{
+    // CLOCK_MONOTONIC, one entry per command in the order they were given to the group
+    std::vector<uint64_t> issue_ns;
+    std::vector<uint64_t> complete_ns;
+    std::vector<std::error_code> errors;
+
+    // last minus first issue/completion of the successful commands
+    uint64_t issue_skew_ns = 0;
+    uint64_t complete_skew_ns = 0;
+    size_t failed = 0;
+};
+
+/**
+ * Executes a set of commands, e.g. TriggerSoftware of several cameras, at the same time.
+ *
+ * Every command beyond the first has its own thread. fire() wakes them,
+ * waits until all of them are ready and then releases them together,
+ * so the wake up latency of the threads does not add to the skew.
+ * The calling thread executes the first command.
+ */
+class SoftwareTriggerGroup
+{
+public:
+    explicit SoftwareTriggerGroup(
+        std::vector<std::shared_ptr<tcam::property::IPropertyCommand>> commands);
+
+    SoftwareTriggerGroup(const SoftwareTriggerGroup&) = delete;
+    SoftwareTriggerGroup& operator=(const SoftwareTriggerGroup&) = delete;
+
+    ~SoftwareTriggerGroup();
+
+    size_t size() const noexcept
+    {
+        return commands_.size();
+    }
+
+    // blocks until all commands returned
+    trigger_report fire();
+
+private:
+    void run(size_t index);
+    void execute(size_t index);
+
+    std::vector<std::shared_ptr<tcam::property::IPropertyCommand>> commands_;
+
+    // only one fire() at a time
+    std::mutex fire_mtx_;
+
+    std::mutex mtx_;
+    std::condition_variable wake_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_ = 0;
+    size_t done_ = 0;
+    bool stop_ = false;
+
+    std::atomic<size_t> armed_ = 0;
+    std::atomic<bool> go_ = false;
+
+    // every thread only writes its own index
+    trigger_report report_;
+
+    std::vector<std::thread> threads_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
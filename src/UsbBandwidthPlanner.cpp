@@ -0,0 +1,278 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "UsbBandwidthPlanner.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+using namespace tcam;
+
+namespace
+{
+
+// UVC payload headers and partially filled packets at the end of a frame
+constexpr double usb_stream_overhead = 1.05;
+
+
+auto read_speed_mbps(const std::string& dir) -> uint64_t
+{
+    // e.g. 480 or 5000, 1.5 for low speed devices
+    std::ifstream f(dir + "/speed");
+    double speed = 0.0;
+    if (!(f >> speed))
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(speed);
+}
+
+
+auto is_usb_device_dir(const std::string& dir) -> bool
+{
+    // interfaces (2-1.3:1.0) have no devnum
+    return access((dir + "/devnum").c_str(), F_OK) == 0
+           && access((dir + "/speed").c_str(), F_OK) == 0;
+}
+
+
+auto basename_of(const std::string& path) -> std::string
+{
+    auto pos = path.rfind('/');
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+
+auto parent_of(const std::string& path) -> std::string
+{
+    auto pos = path.rfind('/');
+    return pos == std::string::npos ? std::string {} : path.substr(0, pos);
+}
+
+} // namespace
+
+
+std::optional<usb_location> tcam::find_usb_location(const std::string& sysfs_path)
+{
+    char* resolved = realpath(sysfs_path.c_str(), nullptr);
+    if (!resolved)
+    {
+        return std::nullopt;
+    }
+    std::string path = resolved;
+    free(resolved);
+
+    // /sys/devices/pci0000:00/0000:00:14.0/usb2/2-1/2-1.3/2-1.3:1.0/video4linux/video0
+    while (path.size() > strlen("/sys/devices") && !is_usb_device_dir(path))
+    {
+        path = parent_of(path);
+    }
+    if (path.size() <= strlen("/sys/devices"))
+    {
+        return std::nullopt;
+    }
+
+    usb_location loc;
+    loc.device = basename_of(path);
+    loc.link_speed_mbps = read_speed_mbps(path);
+
+    // the root hub is the outermost usb device
+    std::string root = path;
+    for (auto p = parent_of(path); p.size() > strlen("/sys/devices") && is_usb_device_dir(p);
+         p = parent_of(p))
+    {
+        root = p;
+    }
+
+    loc.bus = basename_of(root);
+    loc.bus_speed_mbps = read_speed_mbps(root);
+    loc.controller = basename_of(parent_of(root));
+
+    return loc;
+}
+
+
+uint64_t tcam::get_usable_usb_bandwidth_mbps(uint64_t link_speed_mbps)
+{
+    if (auto env = get_environment_variable_int("TCAM_USB_BUS_CAPACITY_MBPS"); env && *env > 0)
+    {
+        return static_cast<uint64_t>(*env);
+    }
+
+    // what bulk streams reach in practice on common host controllers
+    switch (link_speed_mbps)
+    {
+        case 480:
+            return 320;
+        case 5000:
+            return 3200;
+        case 10000:
+            return 7200;
+        case 20000:
+            return 14400;
+        default:
+            return link_speed_mbps * 6 / 10;
+    }
+}
+
+
+double tcam::get_usb_stream_bandwidth_mbps(uint64_t payload_bytes, double framerate)
+{
+    return static_cast<double>(payload_bytes) * 8.0 * framerate * usb_stream_overhead
+           / 1'000'000.0;
+}
+
+
+UsbBandwidthPlanner& UsbBandwidthPlanner::get_instance()
+{
+    static UsbBandwidthPlanner instance;
+    return instance;
+}
+
+
+usb_stream_plan UsbBandwidthPlanner::check(const usb_stream_demand& demand) const
+{
+    std::scoped_lock lck { mtx_ };
+    return calculate_one(demand, get_used_mbps(demand.location.bus));
+}
+
+
+int UsbBandwidthPlanner::add_stream(const usb_stream_demand& demand)
+{
+    std::scoped_lock lck { mtx_ };
+
+    const auto plan = calculate_one(demand, get_used_mbps(demand.location.bus));
+    if (!plan.fits)
+    {
+        SPDLOG_WARN("{}: Stream needs {:.0f} Mbit/s, {} on {} has {:.0f} Mbit/s left. "
+                    "Expect dropped frames. Use a framerate up to {:.1f}, a smaller or "
+                    "compressed format or connect the camera to another controller.",
+                    demand.serial,
+                    plan.required_mbps,
+                    demand.location.bus,
+                    demand.location.controller,
+                    plan.available_mbps,
+                    plan.max_framerate);
+    }
+    else
+    {
+        SPDLOG_DEBUG("{}: Stream needs {:.0f} of {:.0f} Mbit/s left on {} ({}).",
+                     demand.serial,
+                     plan.required_mbps,
+                     plan.available_mbps,
+                     demand.location.bus,
+                     demand.location.controller);
+    }
+
+    const int id = next_id_++;
+    streams_[id] = demand;
+    return id;
+}
+
+
+void UsbBandwidthPlanner::remove_stream(int id)
+{
+    std::scoped_lock lck { mtx_ };
+    streams_.erase(id);
+}
+
+
+std::vector<usb_bus_plan> UsbBandwidthPlanner::get_plan() const
+{
+    std::scoped_lock lck { mtx_ };
+
+    std::vector<usb_bus_plan> ret;
+    for (const auto& [id, s] : streams_)
+    {
+        auto iter = std::find_if(
+            ret.begin(), ret.end(), [&s](const auto& b) { return b.bus == s.location.bus; });
+        if (iter == ret.end())
+        {
+            usb_bus_plan bus;
+            bus.bus = s.location.bus;
+            bus.controller = s.location.controller;
+            bus.capacity_mbps = get_usable_usb_bandwidth_mbps(s.location.bus_speed_mbps);
+            iter = ret.insert(ret.end(), std::move(bus));
+        }
+
+        iter->streams.push_back(s);
+        iter->required_mbps +=
+            get_usb_stream_bandwidth_mbps(s.payload_bytes, s.framerate > 0.0 ? s.framerate : 1.0);
+    }
+    return ret;
+}
+
+
+std::vector<usb_stream_plan> UsbBandwidthPlanner::calculate(
+    const std::vector<usb_stream_demand>& streams)
+{
+    std::vector<usb_stream_plan> ret;
+    ret.reserve(streams.size());
+
+    std::map<std::string, double> used_per_bus;
+    for (const auto& s : streams)
+    {
+        auto& used = used_per_bus[s.location.bus];
+        ret.push_back(calculate_one(s, used));
+        used += ret.back().required_mbps;
+    }
+    return ret;
+}
+
+
+double UsbBandwidthPlanner::get_used_mbps(const std::string& bus) const
+{
+    double used_mbps = 0.0;
+    for (const auto& [id, s] : streams_)
+    {
+        if (s.location.bus == bus)
+        {
+            used_mbps += get_usb_stream_bandwidth_mbps(s.payload_bytes,
+                                                       s.framerate > 0.0 ? s.framerate : 1.0);
+        }
+    }
+    return used_mbps;
+}
+
+
+usb_stream_plan UsbBandwidthPlanner::calculate_one(const usb_stream_demand& demand,
+                                                   double used_mbps)
+{
+    usb_stream_plan plan;
+
+    const double framerate = demand.framerate > 0.0 ? demand.framerate : 1.0;
+    plan.required_mbps = get_usb_stream_bandwidth_mbps(demand.payload_bytes, framerate);
+
+    const double bus_mbps =
+        static_cast<double>(get_usable_usb_bandwidth_mbps(demand.location.bus_speed_mbps));
+    // a high speed camera behind a super speed hub is limited by its own link
+    const double link_mbps =
+        static_cast<double>(get_usable_usb_bandwidth_mbps(demand.location.link_speed_mbps));
+
+    plan.available_mbps = std::max(0.0, std::min(bus_mbps - used_mbps, link_mbps));
+    plan.fits = plan.required_mbps <= plan.available_mbps;
+
+    const double mbps_per_frame = get_usb_stream_bandwidth_mbps(demand.payload_bytes, 1.0);
+    plan.max_framerate = mbps_per_frame > 0.0 ? plan.available_mbps / mbps_per_frame : 0.0;
+
+    return plan;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+// where a usb device is connected, taken from sysfs
+struct usb_location
+{
+    // sysfs name of the device, e.g. 2-1.3
+    std::string device;
+    // root hub of the bus, e.g. usb2; the devices of one bus share its capacity
+    std::string bus;
+    // host controller the bus belongs to, e.g. the pci address 0000:00:14.0
+    std::string controller;
+
+    // negotiated speed of the device and of the root hub
+    uint64_t link_speed_mbps = 0;
+    uint64_t bus_speed_mbps = 0;
+};
+
+/**
+ * Location of a usb device.
+ * @param sysfs_path - any sysfs path at or below the usb device,
+ *                     e.g. /sys/class/video4linux/video0/device or /sys/bus/usb/devices/2-1.3
+ * @return std::nullopt for devices that are not connected through usb
+ */
+std::optional<usb_location> find_usb_location(const std::string& sysfs_path);
+
+/**
+ * Payload that bulk transfers reach on a link of link_speed_mbps in practice,
+ * below the signaling rate because of line coding, packet headers and flow control.
+ * TCAM_USB_BUS_CAPACITY_MBPS takes precedence.
+ */
+uint64_t get_usable_usb_bandwidth_mbps(uint64_t link_speed_mbps);
+
+// Mbit/s of a stream, including the UVC payload headers
+double get_usb_stream_bandwidth_mbps(uint64_t payload_bytes, double framerate);
+
+struct usb_stream_demand
+{
+    std::string serial;
+    usb_location location;
+
+    uint64_t payload_bytes = 0;
+    // 0 for triggered streams, they are planned with their payload only once per second
+    double framerate = 0.0;
+};
+
+struct usb_stream_plan
+{
+    bool fits = true;
+
+    double required_mbps = 0.0;
+    // what the bus and the link of the device leave for this stream
+    double available_mbps = 0.0;
+    // highest framerate that fits into available_mbps
+    double max_framerate = 0.0;
+};
+
+struct usb_bus_plan
+{
+    std::string bus;
+    std::string controller;
+    uint64_t capacity_mbps = 0;
+
+    std::vector<usb_stream_demand> streams;
+    double required_mbps = 0.0;
+};
+
+/**
+ * Process-wide plan of the usb streams on each bus.
+ *
+ * V4l2Device and the libusb devices check their stream against the streams that already run
+ * on the same root hub before they start it, a stream that does not fit is reported
+ * with the framerate it could have. Devices of other processes are not known.
+ */
+class UsbBandwidthPlanner
+{
+public:
+    static UsbBandwidthPlanner& get_instance();
+
+    // demand compared with the registered streams, nothing is registered
+    usb_stream_plan check(const usb_stream_demand& demand) const;
+
+    // warns when the stream does not fit
+    // @return registration id
+    int add_stream(const usb_stream_demand& demand);
+    void remove_stream(int id);
+
+    // registered streams grouped by bus
+    std::vector<usb_bus_plan> get_plan() const;
+
+    /**
+     * Plan for streams that are not registered, e.g. all connected cameras.
+     * Streams are added in order, a stream fits when it fits next to all previous ones.
+     */
+    static std::vector<usb_stream_plan> calculate(const std::vector<usb_stream_demand>& streams);
+
+private:
+    UsbBandwidthPlanner() = default;
+
+    static usb_stream_plan calculate_one(const usb_stream_demand& demand, double used_mbps);
+    // requires mtx_
+    double get_used_mbps(const std::string& bus) const;
+
+    mutable std::mutex mtx_;
+    int next_id_ = 1;
+    std::map<int, usb_stream_demand> streams_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
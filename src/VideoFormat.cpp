@@ -24,7 +24,10 @@
 
 using namespace tcam;
 
-VideoFormat::VideoFormat(const tcam_video_format& new_format) noexcept : format(new_format) {}
+VideoFormat::VideoFormat(const tcam_video_format& new_format) noexcept : format(new_format)
+{
+    update_sizes();
+}
 
 VideoFormat::VideoFormat(uint32_t fourcc,
                          tcam_image_size dim,
@@ -32,6 +35,7 @@ VideoFormat::VideoFormat(uint32_t fourcc,
                          double framerate) noexcept
     : format { fourcc, scale_factors, dim.width, dim.height, framerate }
 {
+    update_sizes();
 }
 
 bool VideoFormat::operator==(const VideoFormat& other) const noexcept
@@ -72,6 +76,7 @@ uint32_t VideoFormat::get_fourcc() const noexcept
 void VideoFormat::set_fourcc(uint32_t fourcc) noexcept
 {
     format.fourcc = fourcc;
+    update_sizes();
 }
 
 
@@ -95,6 +100,7 @@ void VideoFormat::set_size(unsigned int width, unsigned int height) noexcept
 {
     format.width = width;
     format.height = height;
+    update_sizes();
 }
 
 std::string VideoFormat::to_string() const
@@ -115,16 +121,21 @@ std::string VideoFormat::to_string() const
     return s;
 }
 
-uint64_t VideoFormat::get_required_buffer_size() const noexcept
+void VideoFormat::update_sizes() noexcept
 {
-    return img::calc_minimum_img_size((img::fourcc)format.fourcc,
-                                      { (int)format.width, (int)format.height });
-}
+    const auto fcc = static_cast<img::fourcc>(format.fourcc);
 
+    // formats without a known pixel size, e.g. while a format is still being assembled
+    if (!img::is_known_fcc(fcc))
+    {
+        required_buffer_size_ = 0;
+        pitch_size_ = 0;
+        return;
+    }
 
-uint32_t VideoFormat::get_pitch_size() const noexcept
-{
-    return img::calc_minimum_pitch((img::fourcc)format.fourcc, format.width);
+    required_buffer_size_ =
+        img::calc_minimum_img_size(fcc, { (int)format.width, (int)format.height });
+    pitch_size_ = img::calc_minimum_pitch(fcc, format.width);
 }
 
 std::string VideoFormat::get_fourcc_string() const
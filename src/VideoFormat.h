@@ -84,15 +84,22 @@ public:
 
     /**
      * Description for getRequiredBufferSize.
+     * Computed when fourcc or size change, cheap enough for per frame checks.
      * @return size in bytes an image with this format will have
      */
-    uint64_t get_required_buffer_size() const noexcept;
+    uint64_t get_required_buffer_size() const noexcept
+    {
+        return required_buffer_size_;
+    }
 
     /**
      * Description for getPitchSize.
      * @return the size og an image line
      */
-    uint32_t get_pitch_size() const noexcept;
+    uint32_t get_pitch_size() const noexcept
+    {
+        return pitch_size_;
+    }
 
     bool is_empty() const noexcept
     {
@@ -100,7 +107,13 @@ public:
     }
     img::img_type get_img_type() const noexcept;
 private:
+    void update_sizes() noexcept;
+
     tcam_video_format format = {};
+
+    // derived from fourcc, width and height
+    uint64_t required_buffer_size_ = 0;
+    uint32_t pitch_size_ = 0;
 };
 
 
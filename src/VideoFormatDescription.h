@@ -107,6 +107,11 @@ public:
 
     std::vector<double> get_framerates(const VideoFormat& s) const;
 
+    const std::vector<framerate_mapping>& get_framerate_mappings() const noexcept
+    {
+        return res;
+    }
+
 private:
     tcam_video_format_description format;
 
@@ -30,12 +30,58 @@
 
 using namespace tcam;
 
+namespace
+{
+
+/*
+ * Aravis only sends a unicast discovery when it is given an address
+ * while a device id that is not known to the process yet causes a full broadcast discovery.
+ * Returns nullptr when the camera at the address is not the one that was listed.
+ */
+ArvCamera* open_camera_by_address(const DeviceInfo& info)
+{
+    const std::string address = info.get_info().additional_identifier;
+    if (address.empty() || address == "USB3")
+    {
+        return nullptr;
+    }
+
+    GError* err = nullptr;
+    ArvCamera* cam = arv_camera_new(address.c_str(), &err);
+    if (err)
+    {
+        SPDLOG_DEBUG("Unable to open camera at {}: {}", address, err->message);
+        g_clear_error(&err);
+    }
+    if (!cam)
+    {
+        return nullptr;
+    }
+
+    const char* serial = arv_camera_get_device_serial_number(cam, &err);
+    g_clear_error(&err);
+
+    if (!serial || info.get_serial() != serial)
+    {
+        SPDLOG_DEBUG("Camera at {} is not {}. Searching by id.", address, info.get_serial());
+        g_object_unref(cam);
+        return nullptr;
+    }
+    return cam;
+}
+
+} // namespace
+
 AravisDevice::AravisDevice(const DeviceInfo& device_desc)
 {
     device = device_desc;
     GError* err = NULL;
 
-    this->arv_camera_ = arv_camera_new(this->device.get_info().identifier, &err);
+    this->arv_camera_ = open_camera_by_address(this->device);
+    if (!this->arv_camera_)
+    {
+        this->arv_camera_ = arv_camera_new(this->device.get_info().identifier, &err);
+    }
     if (err)
     {
         SPDLOG_ERROR("Error while creating arv_camera: {}", err->message);
@@ -73,6 +119,13 @@ AravisDevice::AravisDevice(const DeviceInfo& device_desc)
 
 AravisDevice::~AravisDevice()
 {
+    remove_from_bandwidth_scheduler();
+
+    {
+        std::scoped_lock lck { arv_camera_access_mutex_ };
+        stop_event_channel();
+    }
+
     if (arv_camera_ != NULL)
     {
         g_object_unref(arv_camera_);
@@ -407,6 +460,40 @@ outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(con
 {
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
 
+    // every write can change the framerate range, e.g. binning or exposure
+    const uint64_t write_count = backend_->get_value_cache().get_write_count();
+    if (write_count != framerate_memo_write_count_)
+    {
+        framerate_memo_.clear();
+        framerate_memo_write_count_ = write_count;
+    }
+
+    const auto size = fmt.get_size();
+    const auto scaling = fmt.get_scaling();
+    const framerate_memo_key key = { fmt.get_fourcc(),
+                                     size.width,
+                                     size.height,
+                                     scaling.binning_h,
+                                     scaling.binning_v,
+                                     scaling.skipping_h,
+                                     scaling.skipping_v };
+    if (auto iter = framerate_memo_.find(key); iter != framerate_memo_.end())
+    {
+        return iter->second;
+    }
+
+    auto ret = fetch_framerate_info(fmt);
+    if (ret.has_value())
+    {
+        framerate_memo_.emplace(key, ret.value());
+    }
+    return ret;
+}
+
+
+outcome::result<tcam::framerate_info> tcam::AravisDevice::fetch_framerate_info(
+    const VideoFormat& fmt)
+{
     if (has_test_format_interface_)
     {
         return fetch_test_itf_framerates(fmt);
@@ -494,16 +581,31 @@ outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(con
 }
 
 
-void AravisDevice::disable_chunk_mode()
+void AravisDevice::apply_chunk_mode()
 {
     GError* err = nullptr;
-    arv_camera_set_chunk_mode(arv_camera_, false, &err);
+    arv_camera_set_chunk_mode(arv_camera_, chunk_mode_, &err);
     if (err)
     {
-        SPDLOG_DEBUG("Failed to set 'ChunkModeActive' to false. Ignoring for now. Err: {}",
-                    err->message);
+        if (chunk_mode_)
+        {
+            SPDLOG_WARN("Failed to set 'ChunkModeActive' to true. Images will have no chunk data. "
+                        "Err: {}",
+                        err->message);
+        }
+        else
+        {
+            SPDLOG_DEBUG("Failed to set 'ChunkModeActive' to false. Ignoring for now. Err: {}",
+                         err->message);
+        }
         g_clear_error(&err);
+        chunks_active_ = false;
+    }
+    else
+    {
+        chunks_active_ = chunk_mode_;
     }
+    chunk_trailer_big_endian_ = arv_camera_is_gv_device(arv_camera_);
 
     auto prop_GevGVSPExtendedIDMode =
         find_cam_property<tcam::property::IPropertyEnum>("GevGVSPExtendedIDMode");
@@ -529,7 +631,7 @@ bool AravisDevice::set_video_format(const VideoFormat& new_format)
 
 //    SPDLOG_DEBUG("Setting format to '{}'", new_format.to_string());
 
-    disable_chunk_mode();
+    apply_chunk_mode();
 
     bool ret = false;
     GError* err = nullptr;
@@ -617,6 +719,9 @@ bool AravisDevice::set_video_format(const VideoFormat& new_format)
 
 set_video_format_finish:
 
+    // format changes update ranges and values of many nodes
+    backend_->get_value_cache().invalidate_all();
+
     // reset properties
     // NO FORMAT CHANGES AFTER THIS POINT
     arv_device_set_string_feature_value(
@@ -712,6 +817,21 @@ void AravisDevice::auto_set_packet_size()
     if (!env_packet_size)
     {
         GError* err = nullptr;
+
+        // the negotiation sends test packets and takes a while,
+        // skip it when an earlier session already found a size for this link
+        if (auto cached = find_session_packet_size(device); cached != 0)
+        {
+            arv_camera_gv_set_packet_size(arv_camera_, cached, &err);
+            if (!err)
+            {
+                SPDLOG_INFO("Set packet size negotiated by an earlier session: {} bytes", cached);
+                return;
+            }
+            SPDLOG_WARN("Unable to set cached packet size: {}", err->message);
+            g_clear_error(&err);
+        }
+
         guint packet_size = arv_camera_gv_auto_packet_size(this->arv_camera_, &err);
         if (err)
         {
@@ -720,6 +840,8 @@ void AravisDevice::auto_set_packet_size()
             return;
         }
         SPDLOG_INFO("Automatically set packet size to {} bytes", packet_size);
+
+        store_session_packet_size(device, packet_size);
     }
     else
     {
@@ -17,14 +17,21 @@
 #ifndef TCAM_ARAVISDEVICE_H
 #define TCAM_ARAVISDEVICE_H
 
+#include "../DeliveryWorker.h"
 #include "../DeviceInterface.h"
 #include "AravisAllocator.h"
+#include "GigeBandwidthScheduler.h"
 #include "../FormatHandlerInterface.h"
 
 #include <arv.h>
 #include <atomic>
+#include <map>
 #include <mutex>
+#include <netinet/in.h>
 #include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
 
 VISIBILITY_INTERNAL
 
@@ -87,6 +94,18 @@ public:
 
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt) final;
 
+    std::optional<tcam_transport_statistics> get_transport_statistics() final;
+
+    // numa node of the network interface, -1 for usb3 vision devices
+    int get_numa_node() final;
+
+    // includes the chunk data
+    size_t get_required_buffer_size() final;
+
+    outcome::result<void> enable_device_events(const std::vector<std::string>& names) final;
+
+    outcome::result<void> set_heartbeat_timeout(std::chrono::milliseconds timeout) final;
+
 private:
     tcam::VideoFormat read_camera_current_video_format();
 
@@ -98,10 +117,57 @@ private:
     // depending on env and auto negotiation
     void auto_set_packet_size();
 
+    // GigE bandwidth scheduling, has to be called without arv_camera_access_mutex_ being held
+    // as the scheduler applies settings to the other cameras on the interface
+    void add_to_bandwidth_scheduler();
+    void remove_from_bandwidth_scheduler();
+    auto read_stream_demand() -> std::optional<aravis::gige_stream_demand>;
+    void apply_bandwidth_schedule(const aravis::gige_stream_schedule& sched);
+
+    int bandwidth_schedule_id_ = -1;
+
+    // local interface the device is reached through, empty for usb3 vision devices
+    std::string find_interface_name();
+    // read by the INIT callback of the stream thread, see start_acquisition
+    int stream_numa_node_ = -1;
+
+    bool start_acquisition(const std::shared_ptr<IImageBufferSink>&);
+    void stop_acquisition();
+
     static void aravis_new_buffer_callback(ArvStream* stream, void* user_data);
 
+    // stream_ has to be valid
+    auto read_transport_statistics() const -> tcam_transport_statistics;
+    void apply_transport_options();
+    // packet socket or UDP socket, has to happen before the stream is created
+    void apply_gige_receive_mode();
+    // selects the usb mode of USB3 Vision devices, has to happen before the stream is created
+    void apply_usb_transport_options();
+
+    // frames above this are split into several transfers by aravis
+    static constexpr unsigned int usb_async_payload_threshold = 1024 * 1024;
+
     static void device_lost(ArvGvDevice* device, void* user_data);
 
+    // GigE Vision message channel, see AravisDeviceEvents.cpp
+    // has to be called with arv_camera_access_mutex_ being held
+    void stop_event_channel();
+    void event_loop();
+    void handle_event_packet(const uint8_t* data, size_t size, const struct sockaddr_in& sender);
+
+    int event_socket_ = -1;
+    std::thread event_thread_;
+    std::atomic<bool> event_thread_running_ = false;
+    // only changed while event_thread_ is not running
+    std::map<uint16_t, std::string> event_names_;
+    std::vector<std::string> enabled_events_;
+
+    // Control path: GenICam and GVCP access through arv_camera_, the property backend,
+    // and the setup and teardown of the stream.
+    //
+    // Lock order: arv_camera_access_mutex_ before buffer_list_mtx_.
+    // The stream path, i.e. aravis_new_buffer_callback, the delivery and requeue_buffer,
+    // never takes arv_camera_access_mutex_, so a slow property read never delays a requeue.
     std::recursive_mutex arv_camera_access_mutex_;
 
     ArvCamera* arv_camera_ = nullptr;
@@ -135,11 +201,30 @@ private:
 
     static void clear_buffer_info_arb_buffer(buffer_info& info);
 
+    // Stream path: keeps buffer_list_ and stream_ alive while buffers are requeued.
+    // requeue_buffer only takes it shared, requeues from several threads, e.g. taps and
+    // delivery workers, do not wait for each other. It is only taken exclusively while
+    // the list or the stream are replaced and when aravis frees a buffer.
     std::vector<buffer_info> buffer_list_;
-    std::mutex buffer_list_mtx_;
+    std::shared_mutex buffer_list_mtx_;
 
+    // drops_ is counted on the aravis stream thread, frames_delivered_ where the frames
+    // are completed, which can be a delivery worker; frames_dropped_ on both
     long frames_delivered_ = 0;
-    long frames_dropped_ = 0;
+    std::atomic<long> frames_dropped_ = 0;
+    tcam_drop_statistics drops_ = {};
+
+    // set when TCAM_DELIVERY_THREADS moves the completion off the aravis stream thread
+    std::shared_ptr<DeliveryWorker> delivery_worker_;
+    int delivery_client_id_ = 0;
+
+    // block id of the last buffer aravis returned, 0 before the first one
+    guint64 last_frame_id_ = 0;
+    // aravis underruns at the last block id gap
+    guint64 last_underruns_ = 0;
+
+    // frames that aravis never returned a buffer for
+    void account_frame_id_gap(ArvBuffer* buffer);
     std::atomic<bool> is_lost_ = false;
 
     struct device_scaling
@@ -171,7 +256,33 @@ private:
 
     tcam_image_size get_sensor_size() const;
 
-    void complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete);
+    // all buffers go through this, it writes the salvage canaries
+    void push_arv_buffer(ArvBuffer* buffer);
+
+    // incomplete frame salvage, see tcam_salvage_options
+    // a canary is written every salvage_packet_payload_ bytes before a buffer is queued,
+    // the canaries that are still there after an incomplete frame belong to missing packets
+    static constexpr uint64_t salvage_canary = 0x7463616d6c6f7374; // "tcamlost"
+    // IP + UDP + GVSP header, with and without the extended ids of GigE Vision 2
+    static constexpr size_t gvsp_min_overhead = 20 + 8 + 8;
+    static constexpr size_t gvsp_max_overhead = 20 + 8 + 20;
+
+    // 0 when salvage is off
+    size_t salvage_packet_payload_ = 0;
+    size_t salvage_packet_payload_max_ = 0;
+    // used where the frames are completed
+    std::vector<uint8_t> salvage_lines_;
+
+    void setup_salvage();
+    // marks the missing lines and conceals the small gaps
+    void salvage_incomplete_buffer(ImageBuffer& buffer);
+
+    // completes the buffer directly or through the delivery_worker_
+    void deliver_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete);
+    void complete_aravis_stream_buffer(ArvBuffer* buffer,
+                                       bool is_incomplete,
+                                       uint64_t dequeue_time_ns,
+                                       const tcam_drop_statistics& drops);
 
     bool has_offset_ = false;
 
@@ -183,6 +294,16 @@ private:
     bool has_FPS_enum_interface_ = false;
 
     auto fetch_test_itf_framerates(const VideoFormat& fmt) -> outcome::result<tcam::framerate_info>;
+    auto fetch_framerate_info(const VideoFormat& fmt) -> outcome::result<tcam::framerate_info>;
+
+    // answers of fetch_framerate_info, which takes a few GVCP round trips
+    // valid as long as no property was written, see property_value_cache::get_write_count
+    // guarded by arv_camera_access_mutex_
+    // fourcc, width, height, binning h/v, skipping h/v
+    using framerate_memo_key =
+        std::tuple<uint32_t, uint32_t, uint32_t, int32_t, int32_t, int32_t, int32_t>;
+    std::map<framerate_memo_key, tcam::framerate_info> framerate_memo_;
+    uint64_t framerate_memo_write_count_ = 0;
 
     bool has_genicam_property(const char* name) const;
     ArvGcNode* get_genicam_property_node(const char* name) const;
@@ -195,7 +316,16 @@ private:
         return tcam::property::find_property<TItf>(internal_properties_, name);
     }
 
-    void disable_chunk_mode();
+    // ChunkModeActive follows chunk_mode_, which chunks are sent is up to ChunkSelector/ChunkEnable
+    void apply_chunk_mode();
+
+    // the camera accepted ChunkModeActive=true
+    bool chunks_active_ = false;
+
+    // set when the stream is created
+    TCAM_GIGE_RECEIVE_MODE receive_mode_ = TCAM_GIGE_RECEIVE_MODE_UNKNOWN;
+    // GigE Vision, USB3 Vision uses little endian
+    bool chunk_trailer_big_endian_ = true;
 
 }; /* class GigeCapture */
 
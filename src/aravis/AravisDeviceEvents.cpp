@@ -0,0 +1,352 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../logging.h"
+#include "AravisDevice.h"
+#include "aravis_utils.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace tcam;
+
+// aravis does not read the GigE Vision message channel,
+// the events are received on a socket of our own
+
+namespace
+{
+
+// GigE Vision bootstrap registers
+constexpr guint64 gvbs_message_channel_count = 0x0900;
+constexpr guint64 gvbs_message_channel_port = 0x0B00;
+constexpr guint64 gvbs_message_channel_destination = 0x0B10;
+constexpr guint64 gvbs_message_channel_timeout = 0x0B14;
+constexpr guint64 gvbs_message_channel_retry_count = 0x0B18;
+
+// the device resends an event that was not acknowledged within this time
+constexpr guint32 message_channel_timeout_ms = 200;
+constexpr guint32 message_channel_retry_count = 3;
+
+constexpr uint8_t gvcp_key = 0x42;
+constexpr uint8_t gvcp_flag_ack_required = 0x01;
+constexpr uint8_t gvcp_flag_extended_ids = 0x10;
+constexpr uint16_t gvcp_event_cmd = 0x00C0;
+constexpr uint16_t gvcp_event_ack = 0x00C1;
+constexpr uint16_t gvcp_eventdata_cmd = 0x00C2;
+constexpr uint16_t gvcp_eventdata_ack = 0x00C3;
+
+constexpr size_t gvcp_header_size = 8;
+// reserved, event id, stream channel, block id, timestamp high/low
+constexpr size_t gvcp_event_size = 16;
+// size, event id, stream channel, reserved, block id 64, timestamp 64
+constexpr size_t gvcp_extended_event_size = 24;
+
+uint16_t read_u16(const uint8_t* ptr)
+{
+    return (uint16_t)((ptr[0] << 8) | ptr[1]);
+}
+
+uint32_t read_u32(const uint8_t* ptr)
+{
+    return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8) | ptr[3];
+}
+
+uint64_t read_u64(const uint8_t* ptr)
+{
+    return ((uint64_t)read_u32(ptr) << 32) | read_u32(ptr + 4);
+}
+
+} // namespace
+
+
+outcome::result<void> AravisDevice::enable_device_events(const std::vector<std::string>& names)
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    if (!arv_camera_is_gv_device(arv_camera_))
+    {
+        if (names.empty())
+        {
+            return outcome::success();
+        }
+        return tcam::status::NotImplemented;
+    }
+
+    auto dev = arv_camera_get_device(arv_camera_);
+    GError* err = nullptr;
+
+    stop_event_channel();
+
+    for (const auto& name : enabled_events_)
+    {
+        if (std::find(names.begin(), names.end(), name) != names.end())
+        {
+            continue;
+        }
+        arv_device_set_string_feature_value(dev, "EventSelector", name.c_str(), &err);
+        if (!err)
+        {
+            arv_device_set_string_feature_value(dev, "EventNotification", "Off", &err);
+        }
+        g_clear_error(&err);
+    }
+    enabled_events_.clear();
+    event_names_.clear();
+
+    if (names.empty())
+    {
+        return outcome::success();
+    }
+
+    guint32 channel_count = 0;
+    arv_device_read_register(dev, gvbs_message_channel_count, &channel_count, &err);
+    if (err || channel_count == 0)
+    {
+        g_clear_error(&err);
+        SPDLOG_WARN("Device has no message channel, events are not available.");
+        return tcam::status::NotImplemented;
+    }
+
+    for (const auto& name : names)
+    {
+        // SFNC: Event<Name> holds the id the device uses for the event
+        const auto id_name = "Event" + name;
+        gint64 id = arv_device_get_integer_feature_value(dev, id_name.c_str(), &err);
+        if (!err)
+        {
+            arv_device_set_string_feature_value(dev, "EventSelector", name.c_str(), &err);
+        }
+        if (!err)
+        {
+            arv_device_set_string_feature_value(dev, "EventNotification", "On", &err);
+        }
+        if (err)
+        {
+            SPDLOG_ERROR("Unable to enable event '{}': {}", name, err->message);
+            return tcam::aravis::consume_GError(err);
+        }
+
+        event_names_[(uint16_t)id] = name;
+        enabled_events_.push_back(name);
+    }
+
+    // the events are sent to the interface the device is controlled from
+    struct sockaddr_in addr = {};
+    GSocketAddress* interface_address =
+        arv_gv_device_get_interface_address(ARV_GV_DEVICE(arv_camera_get_device(arv_camera_)));
+    if (interface_address == nullptr
+        || !g_socket_address_to_native(interface_address, &addr, sizeof(addr), nullptr)
+        || addr.sin_family != AF_INET)
+    {
+        SPDLOG_ERROR("Unable to determine the interface address for the message channel.");
+        return tcam::status::UndefinedError;
+    }
+    addr.sin_port = 0;
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return tcam::status::UndefinedError;
+    }
+    socklen_t addr_len = sizeof(addr);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0
+        || getsockname(fd, (struct sockaddr*)&addr, &addr_len) != 0)
+    {
+        SPDLOG_ERROR("Unable to bind the message channel socket: {}", strerror(errno));
+        close(fd);
+        return tcam::status::UndefinedError;
+    }
+
+    arv_device_write_register(
+        dev, gvbs_message_channel_destination, ntohl(addr.sin_addr.s_addr), &err);
+    if (!err)
+    {
+        arv_device_write_register(
+            dev, gvbs_message_channel_timeout, message_channel_timeout_ms, &err);
+    }
+    if (!err)
+    {
+        arv_device_write_register(
+            dev, gvbs_message_channel_retry_count, message_channel_retry_count, &err);
+    }
+    if (!err)
+    {
+        // a port != 0 opens the channel
+        arv_device_write_register(dev, gvbs_message_channel_port, ntohs(addr.sin_port), &err);
+    }
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to configure the message channel: {}", err->message);
+        close(fd);
+        return tcam::aravis::consume_GError(err);
+    }
+
+    SPDLOG_DEBUG("Receiving events on port {}", ntohs(addr.sin_port));
+
+    event_socket_ = fd;
+    event_thread_running_ = true;
+    event_thread_ = std::thread(&AravisDevice::event_loop, this);
+
+    return outcome::success();
+}
+
+
+outcome::result<void> AravisDevice::set_heartbeat_timeout(std::chrono::milliseconds timeout)
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    if (!arv_camera_is_gv_device(arv_camera_))
+    {
+        return tcam::status::NotImplemented;
+    }
+
+    GError* err = nullptr;
+    arv_camera_set_integer(arv_camera_, "GevHeartbeatTimeout", timeout.count(), &err);
+    if (err)
+    {
+        SPDLOG_ERROR("Unable to set the heartbeat timeout: {}", err->message);
+        return tcam::aravis::consume_GError(err);
+    }
+    SPDLOG_DEBUG("Setting heartbeat timeout to {} ms.", timeout.count());
+    return outcome::success();
+}
+
+
+void AravisDevice::stop_event_channel()
+{
+    if (event_socket_ < 0)
+    {
+        return;
+    }
+
+    event_thread_running_ = false;
+    if (event_thread_.joinable())
+    {
+        event_thread_.join();
+    }
+
+    if (!is_lost_)
+    {
+        GError* err = nullptr;
+        arv_device_write_register(
+            arv_camera_get_device(arv_camera_), gvbs_message_channel_port, 0, &err);
+        g_clear_error(&err);
+    }
+
+    close(event_socket_);
+    event_socket_ = -1;
+}
+
+
+void AravisDevice::event_loop()
+{
+    uint8_t packet[576];
+
+    while (event_thread_running_)
+    {
+        struct pollfd pfd = { event_socket_, POLLIN, 0 };
+        if (poll(&pfd, 1, 100) <= 0)
+        {
+            continue;
+        }
+
+        struct sockaddr_in sender = {};
+        socklen_t sender_len = sizeof(sender);
+        ssize_t len = recvfrom(
+            event_socket_, packet, sizeof(packet), 0, (struct sockaddr*)&sender, &sender_len);
+        if (len < (ssize_t)gvcp_header_size)
+        {
+            continue;
+        }
+
+        handle_event_packet(packet, (size_t)len, sender);
+    }
+}
+
+
+void AravisDevice::handle_event_packet(const uint8_t* data,
+                                       size_t size,
+                                       const struct sockaddr_in& sender)
+{
+    const uint8_t flags = data[1];
+    const uint16_t command = read_u16(data + 2);
+    const size_t length = std::min<size_t>(read_u16(data + 4), size - gvcp_header_size);
+    const uint16_t req_id = read_u16(data + 6);
+
+    if (data[0] != gvcp_key || (command != gvcp_event_cmd && command != gvcp_eventdata_cmd))
+    {
+        return;
+    }
+
+    // acknowledge first, the device would resend otherwise
+    if (flags & gvcp_flag_ack_required)
+    {
+        uint8_t ack[gvcp_header_size] = {};
+        const uint16_t ack_cmd = (command == gvcp_event_cmd) ? gvcp_event_ack : gvcp_eventdata_ack;
+        ack[2] = ack_cmd >> 8;
+        ack[3] = ack_cmd & 0xFF;
+        ack[6] = req_id >> 8;
+        ack[7] = req_id & 0xFF;
+        sendto(event_socket_, ack, sizeof(ack), 0, (const struct sockaddr*)&sender, sizeof(sender));
+    }
+
+    const bool extended = flags & gvcp_flag_extended_ids;
+    const size_t entry_min = extended ? gvcp_extended_event_size : gvcp_event_size;
+
+    const uint8_t* payload = data + gvcp_header_size;
+    size_t pos = 0;
+    while (pos + entry_min <= length)
+    {
+        const uint8_t* entry = payload + pos;
+
+        tcam_device_event event = {};
+        event.event_id = read_u16(entry + 2);
+        event.stream_channel = read_u16(entry + 4);
+        size_t entry_size = entry_min;
+        if (extended)
+        {
+            entry_size = std::max<size_t>(read_u16(entry), entry_min);
+            event.block_id = read_u64(entry + 8);
+            event.timestamp = read_u64(entry + 16);
+        }
+        else
+        {
+            event.block_id = read_u16(entry + 6);
+            event.timestamp = read_u64(entry + 8);
+        }
+
+        auto iter = event_names_.find(event.event_id);
+        const std::string name =
+            (iter != event_names_.end()) ? iter->second : std::to_string(event.event_id);
+        strncpy(event.name, name.c_str(), sizeof(event.name) - 1);
+
+        notify_device_event(event);
+
+        // EVENTDATA carries one event followed by its data
+        if (command == gvcp_eventdata_cmd)
+        {
+            break;
+        }
+        pos += entry_size;
+    }
+}
@@ -75,7 +75,8 @@ static const aravis_property_name_map aravis_property_name_mapping_list[] =
 
     { "GevGVSPExtendedIDMode", map_type::priv },    // This should be controlled by aravis
 
-    // ChunkMode stuff, currently just blacklist
+    // ChunkModeActive is controlled by DeviceInterface::set_chunk_mode
+    // the chunk values are read by the consumer from the image, not through properties
     { "ChunkModeActive", map_type::priv },
     { "ChunkImage", map_type::blacklist },  // is Register
     { "ChunkBlockId", map_type::blacklist },
@@ -15,10 +15,45 @@
  */
 
 #include "../logging.h"
+#include "../scaling_cache.h"
 #include "AravisDevice.h"
 
 using namespace tcam;
 
+namespace
+{
+
+// empty when the cache is disabled or the firmware version is unknown
+std::string scaling_cache_key(ArvCamera* camera,
+                              const DeviceInfo& dev,
+                              const std::vector<tcam::property::IPropertyInteger*>& ranges)
+{
+    if (!tcam::is_scaling_cache_enabled())
+    {
+        return {};
+    }
+
+    GError* err = nullptr;
+    const char* firmware = arv_device_get_string_feature_value(
+        arv_camera_get_device(camera), "DeviceFirmwareVersion", &err);
+    if (err)
+    {
+        g_clear_error(&err);
+        return {};
+    }
+
+    // no serial, the combinations are the same for all cameras of a model
+    std::string key = fmt::format("aravis|{}|{}", dev.get_name(), firmware ? firmware : "");
+    for (const auto* prop : ranges)
+    {
+        auto range = prop->get_range();
+        key += fmt::format("|{}-{}", range.min, range.max);
+    }
+    return key;
+}
+
+} // namespace
+
 void AravisDevice::determine_scaling_type()
 {
     scale_.scale_type = ImageScalingType::Unknown;
@@ -193,7 +228,10 @@ void AravisDevice::generate_scaling_information()
 
     if (scale_.scale_type == ImageScalingType::BinningSkipping)
     {
-        auto get_value = [this](const std::string& name)
+        // an incomplete table is not cached
+        bool probe_failed = false;
+
+        auto get_value = [this, &probe_failed](const std::string& name)
         {
             GError* err = nullptr;
             auto ret = arv_device_get_integer_feature_value(
@@ -203,12 +241,13 @@ void AravisDevice::generate_scaling_information()
             {
                 SPDLOG_ERROR("Received error: {}", err->message);
                 g_clear_error(&err);
+                probe_failed = true;
             }
 
             return ret;
         };
 
-        auto set_value = [this](const std::string& name, int value)
+        auto set_value = [this, &probe_failed](const std::string& name, int value)
         {
             GError* err = nullptr;
             arv_device_set_integer_feature_value(
@@ -218,6 +257,7 @@ void AravisDevice::generate_scaling_information()
             {
                 SPDLOG_ERROR("Received error: {}", err->message);
                 g_clear_error(&err);
+                probe_failed = true;
             }
         };
 
@@ -234,6 +274,17 @@ void AravisDevice::generate_scaling_information()
         auto bh = dynamic_cast<tcam::property::IPropertyInteger*>(binning_h.get());
         auto bv = dynamic_cast<tcam::property::IPropertyInteger*>(binning_v.get());
 
+        // every combination costs 8 register accesses
+        const std::string cache_key = scaling_cache_key(arv_camera_, device, { bh, bv, sh, sv });
+        if (auto cached = tcam::load_scaling_cache(cache_key))
+        {
+            for (const auto& entry : cached.value())
+            {
+                scale_.scaling_info_list.push_back(entry.scale);
+            }
+            return;
+        }
+
         auto scale_is_known = [=](const tcam::image_scaling& s)
         {
             auto find = std::find_if(scale_.scaling_info_list.begin(),
@@ -301,6 +352,16 @@ void AravisDevice::generate_scaling_information()
                 }
             }
         }
+
+        if (!probe_failed && !cache_key.empty())
+        {
+            std::vector<tcam::cached_scaling> table;
+            for (const auto& s : scale_.scaling_info_list)
+            {
+                table.push_back({ s, 0 });
+            }
+            tcam::store_scaling_cache(cache_key, table);
+        }
     }
 }
 
@@ -15,10 +15,15 @@
  */
 
 #include "../ImageBuffer.h"
+#include "../latency_tracing.h"
+#include "../scope_tracing.h"
+#include "../usdt_probes.h"
 #include "../logging.h"
 #include "../utils.h"
 #include "AravisDevice.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -39,9 +44,6 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     GError* err = nullptr;
 
-    this->buffer_list_.clear();
-    this->buffer_list_.reserve(new_list.size());
-
     size_t payload = arv_camera_get_payload(this->arv_camera_, &err);
     if (err)
     {
@@ -50,6 +52,12 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
         return false;
     }
 
+    // requeue_buffer only takes buffer_list_mtx_
+    std::scoped_lock lck1 { buffer_list_mtx_ };
+
+    this->buffer_list_.clear();
+    this->buffer_list_.reserve(new_list.size());
+
     auto buffer_destroy_notfiy = [](void* buffer_info_ptr) {
         auto& info = *static_cast<buffer_info*>(buffer_info_ptr);
         clear_buffer_info_arb_buffer(info);
@@ -62,6 +70,8 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
     }
 
     // we build the according items in a 2 step process, so we are able to pass &info to arv_buffer_new_full
+    // the arv buffers wrap the pool memory, GVSP packets and U3V bulk transfers are received
+    // directly into it, there is no copy between aravis and the BufferPool
     for (auto&& buffer : new_list) { this->buffer_list_.push_back(buffer_info { this, buffer.lock() }); }
 
     for (auto& info : buffer_list_)
@@ -72,6 +82,27 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
     return true;
 }
 
+size_t AravisDevice::get_required_buffer_size()
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    const size_t image_size = active_video_format_.get_required_buffer_size();
+    if (!chunks_active_)
+    {
+        return image_size;
+    }
+
+    GError* err = nullptr;
+    size_t payload = arv_camera_get_payload(this->arv_camera_, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve payload: {}", err->message);
+        g_clear_error(&err);
+        return image_size;
+    }
+    return std::max(image_size, payload);
+}
+
 bool AravisDevice::release_buffers()
 {
     std::scoped_lock lck { arv_camera_access_mutex_ };
@@ -88,6 +119,7 @@ bool AravisDevice::release_buffers()
         }
     }
 
+    std::scoped_lock lck1 { buffer_list_mtx_ };
     buffer_list_.clear();
 
     return true;
@@ -95,17 +127,21 @@ bool AravisDevice::release_buffers()
 
 void AravisDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
-    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+    // arv_stream_push_buffer is thread safe,
+    // buffer_list_mtx_ only keeps the list and the stream alive
+    std::shared_lock lck { buffer_list_mtx_ };
 
-    std::scoped_lock lck { buffer_list_mtx_ };
-    for (auto& b : buffer_list_)
+    // buffer_list_ is built in pool order
+    const size_t index = buffer->get_pool_index();
+    if (this->stream_ != nullptr && index < buffer_list_.size())
     {
+        auto& b = buffer_list_.at(index);
         if (b.buffer == buffer && b.arv_buffer != nullptr)
         {
 #if !defined NDEBUG
             b.is_queued = true;
 #endif
-            arv_stream_push_buffer(this->stream_, b.arv_buffer);
+            push_arv_buffer(b.arv_buffer);
             return;
         }
     }
@@ -278,7 +314,385 @@ static bool set_stream_options(ArvStream* stream)
 }
 
 
+void AravisDevice::apply_transport_options()
+{
+    const auto& opt = transport_options_;
+
+    if (opt.socket_buffer_size >= 0)
+    {
+        g_object_set(stream_,
+                     "socket-buffer",
+                     ARV_GV_STREAM_SOCKET_BUFFER_FIXED,
+                     "socket-buffer-size",
+                     opt.socket_buffer_size,
+                     nullptr);
+    }
+    if (opt.packet_timeout_us >= 0)
+    {
+        g_object_set(stream_, "packet-timeout", (guint)opt.packet_timeout_us, nullptr);
+    }
+    if (opt.frame_retention_us >= 0)
+    {
+        g_object_set(stream_, "frame-retention", (guint)opt.frame_retention_us, nullptr);
+    }
+
+    // the packet socket uses a mmap ring, socket-buffer-size does not apply to it
+    if (receive_mode_ != TCAM_GIGE_RECEIVE_MODE_UDP_SOCKET)
+    {
+        return;
+    }
+
+    // aravis sizes the buffer automatically for one frame
+    uint64_t requested = opt.socket_buffer_size;
+    if (opt.socket_buffer_size < 0)
+    {
+        GError* err = nullptr;
+        requested = arv_camera_get_payload(arv_camera_, &err);
+        g_clear_error(&err);
+    }
+
+    const uint64_t size_max = aravis::get_socket_receive_buffer_max();
+    if (size_max != 0 && requested > size_max)
+    {
+        SPDLOG_WARN("The GigE socket receive buffer of {} bytes is limited to "
+                    "net.core.rmem_max ({}). Packets may be lost, raise it with "
+                    "'sysctl -w net.core.rmem_max={}'.",
+                    requested,
+                    size_max,
+                    requested);
+    }
+}
+
+
+void AravisDevice::apply_gige_receive_mode()
+{
+    receive_mode_ = TCAM_GIGE_RECEIVE_MODE_UNKNOWN;
+
+    ArvDevice* device = arv_camera_get_device(arv_camera_);
+    if (!ARV_IS_GV_DEVICE(device))
+    {
+        return;
+    }
+
+    const auto& opt = transport_options_;
+
+    // aravis silently falls back to the UDP socket when it can not open the packet socket
+    bool use_packet_socket = opt.packet_socket != 0 && aravis::is_packet_socket_available();
+#if defined ARAVIS_HAS_PACKET_SOCKET && !ARAVIS_HAS_PACKET_SOCKET
+    use_packet_socket = false;
+#endif
+
+    if (opt.packet_socket == 1 && !use_packet_socket)
+    {
+        SPDLOG_WARN("The GigE packet socket is not available, using the UDP socket. "
+                    "It requires CAP_NET_RAW, e.g. 'setcap cap_net_raw+ep <executable>'.");
+    }
+
+    const ArvGvStreamOption stream_option = use_packet_socket
+                                                ? ARV_GV_STREAM_OPTION_NONE
+                                                : ARV_GV_STREAM_OPTION_PACKET_SOCKET_DISABLED;
+    arv_gv_device_set_stream_options(ARV_GV_DEVICE(device), stream_option);
+
+    receive_mode_ = use_packet_socket ? TCAM_GIGE_RECEIVE_MODE_PACKET_SOCKET
+                                      : TCAM_GIGE_RECEIVE_MODE_UDP_SOCKET;
+
+    SPDLOG_INFO("GigE stream receives through the {}",
+                use_packet_socket ? "packet socket" : "UDP socket");
+}
+
+
+void AravisDevice::apply_usb_transport_options()
+{
+#if defined ARAVIS_HAS_USB && ARAVIS_HAS_USB && defined ARAVIS_CHECK_VERSION
+#if ARAVIS_CHECK_VERSION(0, 8, 17)
+    ArvDevice* device = arv_camera_get_device(arv_camera_);
+    if (!ARV_IS_UV_DEVICE(device))
+    {
+        return;
+    }
+
+    const auto& opt = transport_options_;
+
+    if (opt.usb_transfer_size > 0)
+    {
+        SPDLOG_WARN("usb-transfer-size is ignored for USB3 Vision, "
+                    "aravis sizes the transfers itself");
+    }
+
+    // aravis splits a frame into transfers of up to 1 MiB.
+    // sync mode waits for every transfer before submitting the next one,
+    // async mode submits all transfers of a frame at once.
+    bool use_async = opt.usb_transfer_count > 1;
+    if (opt.usb_transfer_count < 0)
+    {
+        GError* err = nullptr;
+        const guint payload = arv_camera_get_payload(arv_camera_, &err);
+        if (err)
+        {
+            SPDLOG_WARN("Unable to retrieve payload: {}", err->message);
+            g_clear_error(&err);
+        }
+        use_async = payload > usb_async_payload_threshold;
+    }
+
+    arv_uv_device_set_usb_mode(ARV_UV_DEVICE(device),
+                               use_async ? ARV_UV_USB_MODE_ASYNC : ARV_UV_USB_MODE_SYNC);
+
+    SPDLOG_DEBUG("USB3 Vision stream uses {} transfers", use_async ? "async" : "sync");
+#endif
+#endif
+}
+
+
+auto AravisDevice::read_transport_statistics() const -> tcam_transport_statistics
+{
+    guint64 completed = 0;
+    guint64 failures = 0;
+    guint64 underruns = 0;
+    arv_stream_get_statistics(stream_, &completed, &failures, &underruns);
+
+    guint64 resent = 0;
+    guint64 missing = 0;
+    if (ARV_IS_GV_STREAM(stream_))
+    {
+        arv_gv_stream_get_statistics(ARV_GV_STREAM(stream_), &resent, &missing);
+    }
+
+    tcam_transport_statistics stats = {};
+    stats.completed_buffers = completed;
+    stats.failed_buffers = failures;
+    stats.underruns = underruns;
+    stats.resent_packets = resent;
+    stats.missing_packets = missing;
+    stats.receive_mode = receive_mode_;
+    return stats;
+}
+
+
+std::optional<tcam_transport_statistics> AravisDevice::get_transport_statistics()
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    if (stream_ == nullptr)
+    {
+        return std::nullopt;
+    }
+    return read_transport_statistics();
+}
+
+
+std::string AravisDevice::find_interface_name()
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    if (arv_camera_ == nullptr || !arv_camera_is_gv_device(arv_camera_))
+    {
+        return {};
+    }
+
+    std::string ret;
+    GSocketAddress* interface_address =
+        arv_gv_device_get_interface_address(ARV_GV_DEVICE(arv_camera_get_device(arv_camera_)));
+    if (interface_address != nullptr && G_IS_INET_SOCKET_ADDRESS(interface_address))
+    {
+        gchar* str = g_inet_address_to_string(
+            g_inet_socket_address_get_address(G_INET_SOCKET_ADDRESS(interface_address)));
+        ret = aravis::find_interface_for_address(str);
+        g_free(str);
+    }
+    return ret;
+}
+
+
+int AravisDevice::get_numa_node()
+{
+    // usb3 vision devices are not resolved
+    const auto interface_name = find_interface_name();
+    if (interface_name.empty())
+    {
+        return -1;
+    }
+    return tcam::find_numa_node("/sys/class/net/" + interface_name + "/device");
+}
+
+
+auto AravisDevice::read_stream_demand() -> std::optional<aravis::gige_stream_demand>
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    if (arv_camera_ == nullptr || !arv_camera_is_gv_device(arv_camera_))
+    {
+        return std::nullopt;
+    }
+
+    aravis::gige_stream_demand demand;
+    demand.interface_name = find_interface_name();
+
+    if (auto speed = aravis::get_interface_speed_mbps(demand.interface_name); speed > 0)
+    {
+        demand.interface_speed_mbps = speed;
+    }
+
+    GError* err = nullptr;
+
+    demand.payload_bytes = arv_camera_get_payload(arv_camera_, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve payload: {}", err->message);
+        g_clear_error(&err);
+        return std::nullopt;
+    }
+
+    demand.packet_size = arv_camera_gv_get_packet_size(arv_camera_, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve packet size: {}", err->message);
+        g_clear_error(&err);
+        return std::nullopt;
+    }
+
+    demand.framerate = arv_camera_get_frame_rate(arv_camera_, &err);
+    if (err)
+    {
+        // treated as a stream that can use the whole camera link
+        g_clear_error(&err);
+        demand.framerate = 0.0;
+    }
+
+    auto read_optional_int = [this](const char* name, uint64_t& value)
+    {
+        if (!has_genicam_property(name))
+        {
+            return;
+        }
+        GError* error = nullptr;
+        auto res = arv_camera_get_integer(arv_camera_, name, &error);
+        if (error)
+        {
+            g_clear_error(&error);
+            return;
+        }
+        if (res > 0)
+        {
+            value = res;
+        }
+    };
+
+    read_optional_int("GevLinkSpeed", demand.camera_speed_mbps);
+    read_optional_int("GevTimestampTickFrequency", demand.tick_frequency);
+
+    return demand;
+}
+
+
+void AravisDevice::apply_bandwidth_schedule(const aravis::gige_stream_schedule& sched)
+{
+    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+
+    if (arv_camera_ == nullptr)
+    {
+        return;
+    }
+
+    auto set_int = [this](const char* name, int64_t value)
+    {
+        if (!has_genicam_property(name))
+        {
+            return;
+        }
+
+        gint64 min = 0;
+        gint64 max = 0;
+        GError* err = nullptr;
+        arv_camera_get_integer_bounds(arv_camera_, name, &min, &max, &err);
+        if (err)
+        {
+            g_clear_error(&err);
+        }
+        else
+        {
+            value = std::clamp<int64_t>(value, min, max);
+        }
+
+        arv_camera_set_integer(arv_camera_, name, value, &err);
+        if (err)
+        {
+            SPDLOG_WARN("Unable to set '{}' to {}: {}", name, value, err->message);
+            g_clear_error(&err);
+        }
+    };
+
+    // the packet size is locked while streaming
+    if (stream_ == nullptr)
+    {
+        GError* err = nullptr;
+        arv_camera_gv_set_packet_size(arv_camera_, sched.packet_size, &err);
+        if (err)
+        {
+            SPDLOG_WARN("Unable to set packet size: {}", err->message);
+            g_clear_error(&err);
+        }
+    }
+    set_int("GevSCPD", static_cast<int64_t>(sched.packet_delay_ticks));
+    set_int("GevSCFTD", static_cast<int64_t>(sched.frame_transmission_delay_ticks));
+
+    backend_->get_value_cache().invalidate_all();
+}
+
+
+void AravisDevice::add_to_bandwidth_scheduler()
+{
+    if (bandwidth_schedule_id_ != -1
+        || tcam::is_environment_variable_set("TCAM_GIGE_DISABLE_BANDWIDTH_SCHEDULER"))
+    {
+        return;
+    }
+
+    auto demand = read_stream_demand();
+    if (!demand)
+    {
+        return;
+    }
+
+    bandwidth_schedule_id_ = aravis::GigeBandwidthScheduler::get_instance().add_stream(
+        *demand, [this](const aravis::gige_stream_schedule& sched) { apply_bandwidth_schedule(sched); });
+}
+
+
+void AravisDevice::remove_from_bandwidth_scheduler()
+{
+    if (bandwidth_schedule_id_ == -1)
+    {
+        return;
+    }
+
+    aravis::GigeBandwidthScheduler::get_instance().remove_stream(bandwidth_schedule_id_);
+    bandwidth_schedule_id_ = -1;
+}
+
+
 bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
+{
+    add_to_bandwidth_scheduler();
+
+    if (!start_acquisition(sink))
+    {
+        remove_from_bandwidth_scheduler();
+        return false;
+    }
+    return true;
+}
+
+
+void AravisDevice::stop_stream()
+{
+    stop_acquisition();
+
+    remove_from_bandwidth_scheduler();
+}
+
+
+bool AravisDevice::start_acquisition(const std::shared_ptr<IImageBufferSink>& sink)
 {
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
 
@@ -303,10 +717,25 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 
 
     // install callback to initialize the capture thread as real time
-    auto stream_cb = [](void* /*user_data*/, ArvStreamCallbackType type, ArvBuffer* /*buffer*/)
+    // user_data is stream_numa_node_
+    auto stream_cb = [](void* user_data, ArvStreamCallbackType type, ArvBuffer* /*buffer*/)
     {
         if (type == ARV_STREAM_CALLBACK_TYPE_INIT)
         {
+            const int numa_node = *static_cast<const int*>(user_data);
+
+            // an explicit configuration replaces the default below
+            if (tcam::get_thread_config(tcam::thread_role::capture))
+            {
+                tcam::apply_thread_config(tcam::thread_role::capture, numa_node);
+                return;
+            }
+
+            if (numa_node >= 0 && !tcam::apply_thread_config(tcam::thread_role::capture, numa_node))
+            {
+                SPDLOG_INFO("Unable to place the aravis capture thread on numa node {}", numa_node);
+            }
+
             if (!arv_make_thread_realtime(10))
             {
                 if (!arv_make_thread_high_priority(-10))
@@ -325,11 +754,30 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
         }
     };
 
-    disable_chunk_mode();
+    apply_chunk_mode();
+
+    // ArvGvStream and ArvUvStream take their modes from the device when they are created
+    apply_gige_receive_mode();
+    apply_usb_transport_options();
 
     GError* err = nullptr;
 
-    this->stream_ = arv_camera_create_stream(this->arv_camera_, stream_cb, NULL, &err);
+    {
+        // requeue_buffer does not take arv_camera_access_mutex_
+        stream_numa_node_ = get_placement_numa_node();
+        if (stream_numa_node_ >= 0)
+        {
+            SPDLOG_INFO("Placing the capture thread of {} on numa node {}",
+                        device.get_serial(),
+                        stream_numa_node_);
+        }
+
+        ArvStream* stream =
+            arv_camera_create_stream(this->arv_camera_, stream_cb, &stream_numa_node_, &err);
+
+        std::scoped_lock lck { buffer_list_mtx_ };
+        this->stream_ = stream;
+    }
 
     if (err)
     {
@@ -346,10 +794,13 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 
     if (ARV_IS_GV_STREAM(this->stream_))
     {
-        set_stream_options(this->stream_);
+        apply_transport_options();
     }
+    set_stream_options(this->stream_);
+
+    setup_salvage();
 
-    for (auto& buf : buffer_list_) { arv_stream_push_buffer(this->stream_, buf.arv_buffer); }
+    for (auto& buf : buffer_list_) { push_arv_buffer(buf.arv_buffer); }
 
     arv_stream_set_emit_signals(this->stream_, TRUE);
 
@@ -364,23 +815,35 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 
     // a work thread is not required as aravis already pushes the images asynchronously
 
+    if (DeliveryWorker::is_enabled())
+    {
+        delivery_worker_ = DeliveryWorker::get_instance();
+        delivery_client_id_ = delivery_worker_->add_client();
+    }
+
     g_signal_connect(stream_, "new-buffer", G_CALLBACK(aravis_new_buffer_callback), this);
 
     SPDLOG_INFO("Starting actual stream...");
 
     frames_delivered_ = 0;
     frames_dropped_ = 0;
+    drops_ = {};
+    last_frame_id_ = 0;
+    last_underruns_ = 0;
 
     sink_ = sink;
 
     arv_camera_start_acquisition(this->arv_camera_, &err);
 
+    // TLParamsLocked and friends change their access mode
+    backend_->get_value_cache().invalidate_all();
+
     if (err)
     {
         SPDLOG_ERROR("Unable to start stream: {}", err->message);
         g_clear_error(&err);
 
-        stop_stream();
+        stop_acquisition();
 
         return false;
     }
@@ -389,7 +852,7 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 }
 
 
-void AravisDevice::stop_stream()
+void AravisDevice::stop_acquisition()
 {
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
 
@@ -409,8 +872,18 @@ void AravisDevice::stop_stream()
         arv_stream_set_emit_signals(this->stream_, FALSE);
     }
 
+    // the pending jobs reference arv buffers of stream_
+    if (delivery_worker_)
+    {
+        delivery_worker_->remove_client(delivery_client_id_);
+        delivery_worker_.reset();
+    }
+
     arv_camera_stop_acquisition(arv_camera_, &err);
 
+    // AcquisitionStop unlocks and resets nodes on the device side
+    backend_->get_value_cache().invalidate_all();
+
     if (err)
     {
         SPDLOG_ERROR("Unable to stop stream: {}", err->message);
@@ -420,11 +893,18 @@ void AravisDevice::stop_stream()
 
     if (this->stream_ != nullptr)
     {
-        g_object_unref(this->stream_);
-        this->stream_ = NULL;
+        ArvStream* stream = nullptr;
+        {
+            std::scoped_lock lck { buffer_list_mtx_ };
+            stream = this->stream_;
+            this->stream_ = NULL;
+        }
+        // the destroy notify of the pending arv_buffer takes buffer_list_mtx_
+        g_object_unref(stream);
     }
 
-    // releasing the stream deletes all arv_buffer objects currently pending in the arv_stream, so we cannot re-use the actaul ImageBuffers here
+    // releasing the stream deletes all arv_buffer objects currently pending in the arv_stream
+    // the memory they wrap belongs to the BufferPool and is reused by initialize_buffers
 
     sink_.reset();
 
@@ -498,44 +978,254 @@ void AravisDevice::aravis_new_buffer_callback(ArvStream* stream __attribute__((u
         return;
     }
 
+    self->account_frame_id_gap(buffer);
+
     ArvBufferStatus status = arv_buffer_get_status(buffer);
 
     if (status == ARV_BUFFER_STATUS_SUCCESS)
     {
-        self->complete_aravis_stream_buffer(buffer, false);
+        self->deliver_aravis_stream_buffer(buffer, false);
     }
     else if (status == ARV_BUFFER_STATUS_MISSING_PACKETS)
     {
         if (self->drop_incomplete_frames_)
         {
-            SPDLOG_DEBUG("Image has missing packets. Dropping incomplete frame as requested.");
+            TCAM_DEBUG_RATE_LIMITED(
+                "Image has missing packets. Dropping incomplete frame as requested.");
 
             ++self->frames_dropped_;
+            ++self->drops_.incomplete;
 
-            arv_stream_push_buffer(stream, buffer);
+            self->push_arv_buffer(buffer);
         }
         else
         {
-            SPDLOG_DEBUG("Image has missing packets. Sending incomplete buffer as requested.");
+            TCAM_DEBUG_RATE_LIMITED(
+                "Image has missing packets. Sending incomplete buffer as requested.");
 
-            self->complete_aravis_stream_buffer(buffer, true);
+            self->deliver_aravis_stream_buffer(buffer, true);
         }
     }
     else
     {
         ++self->frames_dropped_;
+        if (status == ARV_BUFFER_STATUS_TIMEOUT || status == ARV_BUFFER_STATUS_SIZE_MISMATCH)
+        {
+            ++self->drops_.incomplete;
+        }
+        else
+        {
+            ++self->drops_.transport;
+        }
 
-        arv_stream_push_buffer(self->stream_, buffer);
+        self->push_arv_buffer(buffer);
         auto ptr = translate_arv_buffer_status(status);
         if (ptr)
         {
-            SPDLOG_DEBUG("arvBufferStatus: {}", ptr);
+            TCAM_DEBUG_RATE_LIMITED("arvBufferStatus: {}", ptr);
         }
     }
 }
 
-void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete)
+void AravisDevice::account_frame_id_gap(ArvBuffer* buffer)
+{
+    const guint64 frame_id = arv_buffer_get_frame_id(buffer);
+    if (frame_id == 0)
+    {
+        // 0 is not a valid block id
+        return;
+    }
+
+    // a smaller id is a wrap around of the 16 bit GigE Vision 1 block id,
+    // the frames lost at the wrap are not counted
+    const guint64 last = last_frame_id_;
+    last_frame_id_ = frame_id;
+    if (last == 0 || frame_id <= last + 1)
+    {
+        return;
+    }
+
+    const guint64 missing = frame_id - last - 1;
+
+    // aravis counts the frames that arrived while no buffer was queued,
+    // every other frame of the gap was lost completely
+    const guint64 underruns = read_transport_statistics().underruns;
+    const guint64 no_buffer =
+        std::min(missing, underruns > last_underruns_ ? underruns - last_underruns_ : 0);
+    last_underruns_ = underruns;
+
+    drops_.no_buffer += no_buffer;
+    drops_.transport += missing - no_buffer;
+    frames_dropped_ += missing;
+
+    TCAM_DEBUG_RATE_LIMITED("{} frame(s) before block id {} were lost.", missing, frame_id);
+}
+
+
+void AravisDevice::push_arv_buffer(ArvBuffer* buffer)
 {
+    if (salvage_packet_payload_ != 0)
+    {
+        size_t size = 0;
+        auto data = static_cast<uint8_t*>(const_cast<void*>(arv_buffer_get_data(buffer, &size)));
+
+        // every packet overwrites at least one canary
+        for (size_t offset = 0; offset + sizeof(salvage_canary) <= size;
+             offset += salvage_packet_payload_)
+        {
+            memcpy(data + offset, &salvage_canary, sizeof(salvage_canary));
+        }
+    }
+    arv_stream_push_buffer(stream_, buffer);
+}
+
+
+void AravisDevice::setup_salvage()
+{
+    salvage_packet_payload_ = 0;
+
+    const auto& opt = salvage_options_;
+    if (drop_incomplete_frames_ || (!opt.report_missing_lines && opt.conceal_max_lines <= 0)
+        || !ARV_IS_GV_STREAM(stream_))
+    {
+        return;
+    }
+
+    const auto dim = active_video_format_.get_size();
+    const uint64_t image_size = active_video_format_.get_required_buffer_size();
+    if (dim.height == 0 || image_size % dim.height != 0)
+    {
+        SPDLOG_INFO("Missing lines can not be determined for {}.",
+                    active_video_format_.get_fourcc_string());
+        return;
+    }
+
+    GError* err = nullptr;
+    const guint packet_size = arv_camera_gv_get_packet_size(arv_camera_, &err);
+    if (err)
+    {
+        SPDLOG_WARN("Unable to retrieve packet size: {}", err->message);
+        g_clear_error(&err);
+        return;
+    }
+
+    if (packet_size <= gvsp_max_overhead + sizeof(salvage_canary))
+    {
+        return;
+    }
+    salvage_packet_payload_ = packet_size - gvsp_max_overhead;
+    salvage_packet_payload_max_ = packet_size - gvsp_min_overhead;
+}
+
+
+void AravisDevice::salvage_incomplete_buffer(ImageBuffer& buffer)
+{
+    const size_t height = active_video_format_.get_size().height;
+    const size_t line_size = active_video_format_.get_required_buffer_size() / height;
+    const size_t image_size = line_size * height;
+
+    auto data = static_cast<uint8_t*>(buffer.get_image_buffer_ptr());
+
+    salvage_lines_.assign((height + 7) / 8, 0);
+
+    auto set_line = [this](size_t line)
+    {
+        salvage_lines_[line / 8] |= static_cast<uint8_t>(1u << (line % 8));
+    };
+    auto is_missing = [this](size_t line)
+    {
+        return (salvage_lines_[line / 8] & (1u << (line % 8))) != 0;
+    };
+
+    // the packet size is only known up to the GVSP header,
+    // so the packet that left a canary untouched is somewhere around it
+    const size_t range = salvage_packet_payload_max_;
+    for (size_t offset = 0; offset + sizeof(salvage_canary) <= image_size;
+         offset += salvage_packet_payload_)
+    {
+        if (memcmp(data + offset, &salvage_canary, sizeof(salvage_canary)) != 0)
+        {
+            continue;
+        }
+
+        const size_t first = offset >= range ? offset - range + 1 : 0;
+        const size_t last = std::min(offset + range, image_size) - 1;
+        for (size_t line = first / line_size; line <= last / line_size; ++line) { set_line(line); }
+    }
+
+    const int max_gap = salvage_options_.conceal_max_lines;
+    uint32_t concealed = 0;
+    size_t line = 0;
+    while (line < height)
+    {
+        if (!is_missing(line))
+        {
+            ++line;
+            continue;
+        }
+        size_t gap_end = line;
+        while (gap_end < height && is_missing(gap_end)) { ++gap_end; }
+
+        // two lines apart, Bayer patterns keep their color
+        if (gap_end - line <= static_cast<size_t>(max_gap))
+        {
+            if (line >= 2)
+            {
+                for (size_t l = line; l < gap_end; ++l)
+                {
+                    memcpy(data + l * line_size, data + (l - 2) * line_size, line_size);
+                }
+                concealed += gap_end - line;
+            }
+            else if (gap_end + 2 <= height)
+            {
+                for (size_t l = gap_end; l-- > line;)
+                {
+                    memcpy(data + l * line_size, data + (l + 2) * line_size, line_size);
+                }
+                concealed += gap_end - line;
+            }
+        }
+        line = gap_end;
+    }
+
+    buffer.set_missing_lines(salvage_lines_, concealed);
+}
+
+
+void AravisDevice::deliver_aravis_stream_buffer(ArvBuffer* buffer, bool is_incomplete)
+{
+    // called directly after arv_stream_pop_buffer
+    const uint64_t dequeue_time_ns = tcam::latency::stamp();
+
+    if (!delivery_worker_)
+    {
+        complete_aravis_stream_buffer(buffer, is_incomplete, dequeue_time_ns, drops_);
+        return;
+    }
+
+    // drops_ is only written on this thread, the job gets a copy
+    auto job = [this, buffer, is_incomplete, dequeue_time_ns, drops = drops_]
+    {
+        complete_aravis_stream_buffer(buffer, is_incomplete, dequeue_time_ns, drops);
+    };
+    if (!delivery_worker_->submit(delivery_client_id_, std::move(job)))
+    {
+        ++frames_dropped_;
+        ++drops_.no_buffer;
+
+        push_arv_buffer(buffer);
+    }
+}
+
+
+void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer,
+                                                 bool is_incomplete,
+                                                 uint64_t dequeue_time_ns,
+                                                 const tcam_drop_statistics& drops)
+{
+    TCAM_TRACE_SCOPE("AravisDevice::complete_aravis_stream_buffer");
+
     // receives the actual ImageBuffer from the ArvBuffer
     std::shared_ptr<ImageBuffer> completed_buffer;
     {
@@ -554,8 +1244,9 @@ void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_inco
     {
         ++frames_dropped_;
 
-        SPDLOG_ERROR("Failed to find the associated ImageBuffer for the completed arv buffer.");
-        arv_stream_push_buffer(stream_, buffer);
+        TCAM_ERROR_RATE_LIMITED(
+            "Failed to find the associated ImageBuffer for the completed arv buffer.");
+        push_arv_buffer(buffer);
         return;
     }
 
@@ -572,17 +1263,46 @@ void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_inco
         stats.camera_time_ns = arv_buffer_get_timestamp(buffer);
         stats.frame_count = frames_delivered_;
         stats.frames_dropped = frames_dropped_;
+        stats.drops = drops;
         stats.is_damaged = is_incomplete;
+        stats.dequeue_time_ns = dequeue_time_ns;
+        stats.has_transport_statistics = true;
+        stats.transport = read_transport_statistics();
 
         completed_buffer->set_statistics(stats);
+
+        tcam_chunk_data_info chunk_info = {};
+        if (chunks_active_ && arv_buffer_has_chunks(buffer))
+        {
+            // the image is the first chunk, the trailers of all chunks follow it
+            // nothing is parsed here, the consumer looks at the chunks it is interested in
+            chunk_info.offset = 0;
+            chunk_info.length = image_size;
+            chunk_info.is_little_endian = !chunk_trailer_big_endian_;
+
+            image_size = std::min(image_size, active_video_format_.get_required_buffer_size());
+        }
+        completed_buffer->set_chunk_data_info(chunk_info);
         completed_buffer->set_valid_data_length(image_size);
+
+        if (is_incomplete && salvage_packet_payload_ != 0)
+        {
+            salvage_incomplete_buffer(*completed_buffer);
+        }
+        else
+        {
+            completed_buffer->set_missing_lines({}, 0);
+        }
+
+        TCAM_USDT_PROBE(frame_dequeue, stats.frame_count, completed_buffer.get());
+
         ptr->push_image(completed_buffer);
     }
     else
     {
         ++frames_dropped_;
 
-        SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
+        TCAM_ERROR_RATE_LIMITED("ImageSink expired. Unable to deliver images.");
 
         requeue_buffer(completed_buffer);
     }
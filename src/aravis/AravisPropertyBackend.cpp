@@ -17,6 +17,7 @@
 #include "AravisPropertyBackend.h"
 
 #include "../logging.h"
+#include "../utils.h"
 #include "AravisDevice.h"
 #include "aravis_utils.h"
 
@@ -24,8 +25,79 @@
 
 using namespace tcam::aravis;
 
+namespace
+{
+
+// GenICam values change rarely on their own,
+// a short bound keeps polling UIs from flooding the control channel
+constexpr int default_cache_max_age_ms = 100;
+
+std::chrono::milliseconds get_cache_max_age()
+{
+    auto env = tcam::get_environment_variable_int("TCAM_ARV_PROPERTY_CACHE_MS");
+    if (env && env.value() >= 0)
+    {
+        return std::chrono::milliseconds(env.value());
+    }
+    return std::chrono::milliseconds(default_cache_max_age_ms);
+}
+
+bool is_selector(ArvGcFeatureNode* node)
+{
+    return ARV_IS_GC_SELECTOR(node) && arv_gc_selector_is_selector(ARV_GC_SELECTOR(node));
+}
+
+} // namespace
+
+
+void property_value_cache::put(ArvGcFeatureNode* node, value_type value)
+{
+    if (max_age_.count() == 0)
+    {
+        return;
+    }
+    entries_[node] = entry { std::move(value), std::chrono::steady_clock::now() };
+}
+
+
+void property_value_cache::on_write(ArvGcFeatureNode* node)
+{
+    ++write_count_;
+
+    if (entries_.empty())
+    {
+        return;
+    }
+
+    if (!is_selector(node))
+    {
+        // Any other write can change further nodes through pInvalidator/pValue links
+        // or the locks from property_dependencies.
+        // Dropping everything is cheaper than walking the node graph.
+        invalidate_all();
+        return;
+    }
+
+    entries_.erase(node);
+
+    for (auto feature = arv_gc_selector_get_selected_features(ARV_GC_SELECTOR(node));
+         feature != nullptr;
+         feature = feature->next)
+    {
+        entries_.erase(static_cast<ArvGcFeatureNode*>(feature->data));
+    }
+}
+
+
+bool property_value_cache::is_redundant_selector_write(ArvGcFeatureNode* node, int64_t value) const
+{
+    auto cached = get<int64_t>(node);
+    return cached && cached.value() == value && is_selector(node);
+}
+
+
 AravisPropertyBackend::AravisPropertyBackend(tcam::AravisDevice& parent)
-    : parent_(parent)
+    : parent_(parent), value_cache_(get_cache_max_age())
 {
 }
 
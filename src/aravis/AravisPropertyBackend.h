@@ -19,8 +19,14 @@
 #include "../error.h"
 
 #include <arv.h>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <tcamprop1.0_base/tcamprop_base.h>
+#include <variant>
 
 namespace tcam
 {
@@ -34,6 +40,69 @@ bool is_private_setting(std::string_view name);
 tcamprop1::Visibility_t to_Visibility(ArvGcVisibility v) noexcept;
 tcamprop1::Access_t to_Access(ArvGcAccessMode v) noexcept;
 
+/**
+ * Read-through cache for the values of GenICam feature nodes.
+ * Saves the GVCP round trip when properties are polled.
+ *
+ * Not thread safe, only use while holding AravisPropertyBackend::get_mutex().
+ */
+class property_value_cache
+{
+public:
+    using value_type = std::variant<int64_t, double, bool, std::string>;
+
+    // a max_age of 0 disables the cache
+    explicit property_value_cache(std::chrono::milliseconds max_age) : max_age_(max_age) {}
+
+    template<class T> std::optional<T> get(ArvGcFeatureNode* node) const
+    {
+        auto iter = entries_.find(node);
+        if (iter == entries_.end()
+            || std::chrono::steady_clock::now() - iter->second.time > max_age_)
+        {
+            return std::nullopt;
+        }
+        if (auto ptr = std::get_if<T>(&iter->second.value))
+        {
+            return *ptr;
+        }
+        return std::nullopt;
+    }
+
+    void put(ArvGcFeatureNode* node, value_type value);
+
+    // has to be called after every write to node
+    void on_write(ArvGcFeatureNode* node);
+
+    // the device changed in a way the cache cannot track, e.g. a new video format
+    void invalidate_all() noexcept
+    {
+        ++write_count_;
+        entries_.clear();
+    }
+
+    // changes with every write, also when the cache is disabled
+    // lets other caches of device state notice changes, can be read without the lock
+    uint64_t get_write_count() const noexcept
+    {
+        return write_count_;
+    }
+
+    // writes to selectors that already hold the value can be skipped
+    bool is_redundant_selector_write(ArvGcFeatureNode* node, int64_t value) const;
+
+private:
+    struct entry
+    {
+        value_type value;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::chrono::milliseconds max_age_;
+    std::map<ArvGcFeatureNode*, entry> entries_;
+    std::atomic<uint64_t> write_count_ = 0;
+};
+
 class AravisPropertyBackend
 {
 public:
@@ -41,8 +110,15 @@ public:
 
     std::recursive_mutex& get_mutex() noexcept;
 
+    property_value_cache& get_value_cache() noexcept
+    {
+        return value_cache_;
+    }
+
 private:
     AravisDevice& parent_;
+
+    property_value_cache value_cache_;
 };
 
 } // namespace tcam::aravis
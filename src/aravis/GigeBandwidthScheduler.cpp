@@ -0,0 +1,296 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "GigeBandwidthScheduler.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cmath>
+#include <fstream>
+#include <ifaddrs.h>
+#include <linux/if_ether.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace tcam::aravis;
+
+namespace
+{
+
+// IP + UDP + GVSP header, part of the packet size
+constexpr unsigned int gvsp_packet_overhead = 20 + 8 + 8;
+// ethernet header, FCS, preamble and inter frame gap, not part of the packet size
+constexpr unsigned int ethernet_wire_overhead = 14 + 4 + 8 + 12;
+// leader and trailer packets
+constexpr uint64_t gvsp_frame_packets = 2;
+
+// the rest is left for resends and the control channel
+constexpr double usable_interface_fraction = 0.9;
+
+
+auto calc_wire_bits_per_frame(const gige_stream_demand& demand) -> double
+{
+    const unsigned int payload_per_packet =
+        std::max(demand.packet_size, gvsp_packet_overhead + 1) - gvsp_packet_overhead;
+    const uint64_t packets =
+        (demand.payload_bytes + payload_per_packet - 1) / payload_per_packet + gvsp_frame_packets;
+
+    return static_cast<double>(packets) * (demand.packet_size + ethernet_wire_overhead) * 8.0;
+}
+
+
+auto calc_demand_bits_per_second(const gige_stream_demand& demand) -> double
+{
+    if (demand.framerate <= 0.0)
+    {
+        // e.g. trigger mode, assume the camera can saturate its own link
+        return demand.camera_speed_mbps * 1'000'000.0;
+    }
+    return calc_wire_bits_per_frame(demand) * demand.framerate;
+}
+
+} // namespace
+
+
+GigeBandwidthScheduler& GigeBandwidthScheduler::get_instance()
+{
+    static GigeBandwidthScheduler instance;
+    return instance;
+}
+
+
+int GigeBandwidthScheduler::add_stream(const gige_stream_demand& demand, apply_func apply)
+{
+    std::scoped_lock lck { mtx_ };
+
+    const int id = next_id_++;
+    entries_[id] = entry { demand, std::move(apply) };
+
+    reschedule(demand.interface_name);
+
+    return id;
+}
+
+
+void GigeBandwidthScheduler::remove_stream(int id)
+{
+    std::scoped_lock lck { mtx_ };
+
+    auto iter = entries_.find(id);
+    if (iter == entries_.end())
+    {
+        return;
+    }
+
+    const std::string interface_name = iter->second.demand.interface_name;
+    entries_.erase(iter);
+
+    reschedule(interface_name);
+}
+
+
+std::vector<gige_stream_schedule> GigeBandwidthScheduler::calculate(
+    const std::vector<gige_stream_demand>& streams)
+{
+    std::vector<gige_stream_schedule> ret(streams.size());
+    if (streams.empty())
+    {
+        return ret;
+    }
+
+    const double usable_bits_per_second =
+        streams.front().interface_speed_mbps * 1'000'000.0 * usable_interface_fraction;
+
+    double total_demand = 0.0;
+    double max_framerate = 0.0;
+    for (const auto& s : streams)
+    {
+        total_demand += calc_demand_bits_per_second(s);
+        max_framerate = std::max(max_framerate, s.framerate);
+    }
+
+    // the frame starts are spread over the shortest frame period
+    const double slot_seconds = max_framerate > 0.0 ? 1.0 / max_framerate / streams.size() : 0.0;
+
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        const auto& s = streams.at(i);
+        auto& sched = ret.at(i);
+
+        sched.packet_size = s.packet_size;
+
+        const double camera_bits_per_second = s.camera_speed_mbps * 1'000'000.0;
+        const double share = total_demand > 0.0 ?
+                                 usable_bits_per_second * calc_demand_bits_per_second(s) / total_demand :
+                                 usable_bits_per_second;
+
+        sched.bandwidth_mbps = std::min(share, camera_bits_per_second) / 1'000'000.0;
+
+        if (share > 0.0 && share < camera_bits_per_second)
+        {
+            const double packet_bits = (s.packet_size + ethernet_wire_overhead) * 8.0;
+            // GevSCPD is the gap between the end of a packet and the start of the next one
+            const double delay_seconds = packet_bits / share - packet_bits / camera_bits_per_second;
+
+            sched.packet_delay_ticks =
+                static_cast<uint64_t>(std::floor(delay_seconds * s.tick_frequency));
+        }
+
+        sched.frame_transmission_delay_ticks =
+            static_cast<uint64_t>(std::floor(slot_seconds * i * s.tick_frequency));
+    }
+    return ret;
+}
+
+
+void GigeBandwidthScheduler::reschedule(const std::string& interface_name)
+{
+    std::vector<entry*> affected;
+    std::vector<gige_stream_demand> demands;
+    for (auto& [id, e] : entries_)
+    {
+        if (e.demand.interface_name == interface_name)
+        {
+            affected.push_back(&e);
+            demands.push_back(e.demand);
+        }
+    }
+
+    if (affected.empty())
+    {
+        return;
+    }
+
+    double total_demand = 0.0;
+    for (const auto& d : demands) { total_demand += calc_demand_bits_per_second(d); }
+
+    const double usable_mbps = demands.front().interface_speed_mbps * usable_interface_fraction;
+    if (total_demand / 1'000'000.0 > usable_mbps)
+    {
+        SPDLOG_WARN("GigE streams on '{}' need {:.0f} Mbit/s, only {:.0f} Mbit/s are available. "
+                    "Expect dropped frames.",
+                    interface_name,
+                    total_demand / 1'000'000.0,
+                    usable_mbps);
+    }
+
+    auto schedules = calculate(demands);
+
+    for (size_t i = 0; i < affected.size(); ++i)
+    {
+        const auto& sched = schedules.at(i);
+
+        SPDLOG_DEBUG("GigE stream {}/{} on '{}': {:.0f} Mbit/s, packet size {}, "
+                     "packet delay {} ticks, frame transmission delay {} ticks",
+                     i + 1,
+                     affected.size(),
+                     interface_name,
+                     sched.bandwidth_mbps,
+                     sched.packet_size,
+                     sched.packet_delay_ticks,
+                     sched.frame_transmission_delay_ticks);
+
+        affected.at(i)->apply(sched);
+    }
+}
+
+
+std::string tcam::aravis::find_interface_for_address(const std::string& address)
+{
+    struct in_addr addr = {};
+    if (inet_pton(AF_INET, address.c_str(), &addr) != 1)
+    {
+        return {};
+    }
+
+    struct ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) != 0)
+    {
+        return {};
+    }
+
+    std::string ret;
+    for (auto iter = addrs; iter != nullptr; iter = iter->ifa_next)
+    {
+        if (iter->ifa_addr == nullptr || iter->ifa_addr->sa_family != AF_INET)
+        {
+            continue;
+        }
+        if (((struct sockaddr_in*)iter->ifa_addr)->sin_addr.s_addr == addr.s_addr)
+        {
+            ret = iter->ifa_name;
+            break;
+        }
+    }
+
+    freeifaddrs(addrs);
+    return ret;
+}
+
+
+uint64_t tcam::aravis::get_interface_speed_mbps(const std::string& interface_name)
+{
+    if (auto env = tcam::get_environment_variable_int("TCAM_GIGE_INTERFACE_SPEED_MBPS");
+        env && *env > 0)
+    {
+        return *env;
+    }
+
+    if (interface_name.empty())
+    {
+        return 0;
+    }
+
+    std::ifstream f("/sys/class/net/" + interface_name + "/speed");
+
+    // -1 when the link is down or the driver does not know
+    long speed = -1;
+    if (!(f >> speed) || speed <= 0)
+    {
+        return 0;
+    }
+    return speed;
+}
+
+
+bool tcam::aravis::is_packet_socket_available()
+{
+    // same socket aravis opens for its packet socket receive thread
+    int fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (fd < 0)
+    {
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+
+uint64_t tcam::aravis::get_socket_receive_buffer_max()
+{
+    std::ifstream f("/proc/sys/net/core/rmem_max");
+
+    uint64_t size = 0;
+    if (!(f >> size))
+    {
+        return 0;
+    }
+    return size;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAM_ARAVIS_GIGEBANDWIDTHSCHEDULER_H
+#define TCAM_ARAVIS_GIGEBANDWIDTHSCHEDULER_H
+
+#include "../compiler_defines.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::aravis
+{
+
+struct gige_stream_demand
+{
+    // host interface the camera is reached through, streams on the same interface share its capacity
+    std::string interface_name;
+    // capacity of interface_name
+    uint64_t interface_speed_mbps = 1000;
+    // line rate of the camera, GevLinkSpeed
+    uint64_t camera_speed_mbps = 1000;
+
+    uint64_t payload_bytes = 0;
+    double framerate = 0.0;
+    // GevSCPSPacketSize, includes the IP/UDP/GVSP headers
+    unsigned int packet_size = 1500;
+    // ticks per second of GevSCPD and GevSCFTD, GevTimestampTickFrequency
+    uint64_t tick_frequency = 1'000'000'000;
+};
+
+struct gige_stream_schedule
+{
+    unsigned int packet_size = 0;
+    // inter-packet delay, GevSCPD
+    uint64_t packet_delay_ticks = 0;
+    // delay of the first packet of a frame, GevSCFTD
+    uint64_t frame_transmission_delay_ticks = 0;
+
+    double bandwidth_mbps = 0.0;
+};
+
+/**
+ * Process-wide scheduler for the GigE streams that share a host interface.
+ *
+ * Every stream gets a part of the interface capacity proportional to its
+ * payload * framerate, the inter-packet delay paces the stream to that part.
+ * The frame transmission delays spread the frame starts over the shortest frame period,
+ * so that streams that are triggered together do not burst at the same time.
+ *
+ * Adding or removing a stream reschedules all streams of that interface.
+ * The apply callbacks are invoked with the scheduler lock held,
+ * so callers must not hold locks that an apply callback takes.
+ */
+class GigeBandwidthScheduler
+{
+public:
+    using apply_func = std::function<void(const gige_stream_schedule&)>;
+
+    static GigeBandwidthScheduler& get_instance();
+
+    /**
+     * Add a stream and apply the new schedule to all streams on its interface.
+     * @return registration id
+     */
+    int add_stream(const gige_stream_demand& demand, apply_func apply);
+
+    /**
+     * Remove a stream and reschedule the remaining ones.
+     * After this returns the apply callback of id is no longer called.
+     */
+    void remove_stream(int id);
+
+    // streams must use the same interface
+    static std::vector<gige_stream_schedule> calculate(const std::vector<gige_stream_demand>& streams);
+
+private:
+    GigeBandwidthScheduler() = default;
+
+    struct entry
+    {
+        gige_stream_demand demand;
+        apply_func apply;
+    };
+
+    void reschedule(const std::string& interface_name);
+
+    std::mutex mtx_;
+
+    int next_id_ = 1;
+    // ordered by id, so earlier streams keep the earlier transmission slots
+    std::map<int, entry> entries_;
+};
+
+/**
+ * Name of the host interface that has the IPv4 address address.
+ * @return empty when no interface matches
+ */
+std::string find_interface_for_address(const std::string& address);
+
+/**
+ * Link speed of a host interface as reported by sysfs.
+ * The environment variable TCAM_GIGE_INTERFACE_SPEED_MBPS takes precedence.
+ * @return 0 when unknown
+ */
+uint64_t get_interface_speed_mbps(const std::string& interface_name);
+
+/**
+ * The process may open packet sockets (CAP_NET_RAW),
+ * which aravis uses to receive GVSP without a syscall per packet.
+ */
+bool is_packet_socket_available();
+
+/**
+ * net.core.rmem_max, the kernel clamps larger socket receive buffers to it.
+ * @return 0 when unknown
+ */
+uint64_t get_socket_receive_buffer_max();
+
+} // namespace tcam::aravis
+
+VISIBILITY_POP
+
+#endif /* TCAM_ARAVIS_GIGEBANDWIDTHSCHEDULER_H */
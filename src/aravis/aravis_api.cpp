@@ -31,3 +31,9 @@ std::vector<tcam::DeviceInfo> tcam::AravisBackend::get_device_list()
 {
     return get_gige_device_list();
 }
+
+
+std::optional<tcam::DeviceInfo> tcam::AravisBackend::find_device(const std::string& serial)
+{
+    return find_gige_device(serial);
+}
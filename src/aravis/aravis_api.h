@@ -28,6 +28,7 @@ public:
     TCAM_DEVICE_TYPE get_type() const final {return TCAM_DEVICE_TYPE_ARAVIS;};
     std::shared_ptr<DeviceInterface> open_device (const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
 
     static BackendInterface* get_instance()
     {
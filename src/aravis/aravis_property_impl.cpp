@@ -222,7 +222,7 @@ tcam::property::PropertyFlags prop_base_impl::get_flags_impl() const
         return tcam::property::PropertyFlags::None;
     }
     assert(feature_node_);
-    return arv_gc_get_tcam_flags(feature_node_, access_mode_);
+    return arv_gc_get_tcam_flags(feature_node_, get_static_info_locked().access);
 }
 
 aravis_backend_guard prop_base_impl::acquire_backend_guard() const noexcept
@@ -230,22 +230,47 @@ aravis_backend_guard prop_base_impl::acquire_backend_guard() const noexcept
     return aravis_backend_guard { backend_ };
 }
 
-tcamprop1::prop_static_info_str prop_base_impl::build_static_info(
-    std::string_view category,
-    std::string_view name_override) const noexcept
+tcamprop1::prop_static_info prop_base_impl::get_static_info_impl() const
 {
-    auto res = get_static_feature_node_info(feature_node_);
-    if (!name_override.empty())
-        res.name = name_override;
-    res.iccategory = category;
-    return res;
+    aravis_backend_guard lck = acquire_backend_guard();
+    if (!lck)
+    {
+        // the node is gone with the backend, only name and category are known
+        return static_info_.to_prop_static_info();
+    }
+    return get_static_info_locked().to_prop_static_info();
+}
+
+const tcamprop1::prop_static_info_str& prop_base_impl::get_static_info_locked() const
+{
+    if (static_info_valid_)
+    {
+        return static_info_;
+    }
+
+    // name is left alone, get_name() hands out views of it without the guard
+    auto info = get_static_feature_node_info(feature_node_);
+    static_info_.display_name = std::move(info.display_name);
+    static_info_.description = std::move(info.description);
+    static_info_.visibility = info.visibility;
+    static_info_.access = info.access;
+    update_with_tcamprop1_static_info(static_info_.name, static_info_, type_);
+
+    static_info_valid_ = true;
+    return static_info_;
 }
 
 prop_base_impl::prop_base_impl(const std::shared_ptr<AravisPropertyBackend>& cam,
-                               ArvGcFeatureNode* feature_node)
-    : backend_ { cam }, feature_node_ { feature_node }
+                               ArvGcFeatureNode* feature_node,
+                               std::string_view name_override,
+                               std::string_view category,
+                               tcamprop1::prop_type type)
+    : backend_ { cam }, feature_node_ { feature_node }, type_ { type }
 {
-    access_mode_ = to_Access(arv_gc_feature_node_get_actual_access_mode(feature_node_));
+    static_info_.name = name_override.empty()
+                            ? to_stdstring(arv_gc_feature_node_get_name(feature_node_))
+                            : std::string { name_override };
+    static_info_.iccategory = category;
 }
 
 AravisPropertyIntegerImpl::AravisPropertyIntegerImpl(
@@ -253,14 +278,12 @@ AravisPropertyIntegerImpl::AravisPropertyIntegerImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_ { ARV_GC_INTEGER(node) }
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::Integer),
+      arv_gc_node_ { ARV_GC_INTEGER(node) }
 {
-    static_info_ = build_static_info(category, name);
-
     unit_ = to_stdstring(arv_gc_integer_get_unit(arv_gc_node_));
     int_rep_ = to_IntRepresentation(arv_gc_integer_get_representation(arv_gc_node_));
-
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Integer);
 }
 
 outcome::result<int64_t> AravisPropertyIntegerImpl::get_value() const
@@ -272,10 +295,17 @@ outcome::result<int64_t> AravisPropertyIntegerImpl::get_value() const
         return tcam::status::ResourceNotLockable;
     }
 
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    if (auto cached = lck.cache().get<int64_t>(node))
+    {
+        return cached.value();
+    }
+
     GError* err = nullptr;
     auto rval = arv_gc_integer_get_value(arv_gc_node_, &err);
     if (err)
         return consume_GError(err);
+    lck.cache().put(node, rval);
     return rval;
 }
 
@@ -288,8 +318,15 @@ outcome::result<void> AravisPropertyIntegerImpl::set_value(int64_t new_value)
         return tcam::status::ResourceNotLockable;
     }
 
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    if (lck.cache().is_redundant_selector_write(node, new_value))
+    {
+        return outcome::success();
+    }
+
     GError* err = nullptr;
     arv_gc_integer_set_value(arv_gc_node_, new_value, &err);
+    lck.cache().on_write(node);
     if (err)
         return consume_GError(err);
     return outcome::success();
@@ -339,14 +376,12 @@ AravisPropertyDoubleImpl::AravisPropertyDoubleImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_(ARV_GC_FLOAT(node))
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::Float),
+      arv_gc_node_(ARV_GC_FLOAT(node))
 {
-    static_info_ = build_static_info(category, name);
-
     unit_ = to_stdstring(arv_gc_float_get_unit(arv_gc_node_));
     float_rep_ = to_FloatRepresentation(arv_gc_float_get_representation(arv_gc_node_));
-
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Float);
 }
 
 outcome::result<void> AravisPropertyDoubleImpl::set_value(double new_value)
@@ -359,6 +394,7 @@ outcome::result<void> AravisPropertyDoubleImpl::set_value(double new_value)
     }
     GError* err = nullptr;
     arv_gc_float_set_value(arv_gc_node_, new_value, &err);
+    lck.cache().on_write(ARV_GC_FEATURE_NODE(arv_gc_node_));
     if (err)
         return consume_GError(err);
     return outcome::success();
@@ -372,10 +408,17 @@ outcome::result<double> AravisPropertyDoubleImpl::get_value() const
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    if (auto cached = lck.cache().get<double>(node))
+    {
+        return cached.value();
+    }
+
     GError* err = nullptr;
     auto ret = arv_gc_float_get_value(arv_gc_node_, &err);
     if (err)
         return consume_GError(err);
+    lck.cache().put(node, ret);
     return ret;
 }
 
@@ -417,11 +460,10 @@ AravisPropertyBoolImpl::AravisPropertyBoolImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_(ARV_GC_BOOLEAN(node))
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::Boolean),
+      arv_gc_node_(ARV_GC_BOOLEAN(node))
 {
-    static_info_ = build_static_info(category, name);
-
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Boolean);
 }
 
 outcome::result<bool> AravisPropertyBoolImpl::get_value() const
@@ -432,10 +474,17 @@ outcome::result<bool> AravisPropertyBoolImpl::get_value() const
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    if (auto cached = lck.cache().get<bool>(node))
+    {
+        return cached.value();
+    }
+
     GError* err = nullptr;
-    auto ret = arv_gc_boolean_get_value(arv_gc_node_, &err);
+    bool ret = arv_gc_boolean_get_value(arv_gc_node_, &err);
     if (err)
         return consume_GError(err);
+    lck.cache().put(node, ret);
     return ret;
 }
 
@@ -450,6 +499,7 @@ outcome::result<void> AravisPropertyBoolImpl::set_value(bool new_value)
     }
     GError* err = nullptr;
     arv_gc_boolean_set_value(arv_gc_node_, new_value, &err);
+    lck.cache().on_write(ARV_GC_FEATURE_NODE(arv_gc_node_));
     if (err)
         return consume_GError(err);
     return outcome::success();
@@ -461,11 +511,10 @@ AravisPropertyCommandImpl::AravisPropertyCommandImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_(ARV_GC_COMMAND(node))
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::Command),
+      arv_gc_node_(ARV_GC_COMMAND(node))
 {
-    static_info_ = build_static_info(category, name);
-
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Command);
 }
 
 outcome::result<void> AravisPropertyCommandImpl::execute()
@@ -478,6 +527,7 @@ outcome::result<void> AravisPropertyCommandImpl::execute()
     }
     GError* err = nullptr;
     arv_gc_command_execute(arv_gc_node_, &err);
+    lck.cache().on_write(ARV_GC_FEATURE_NODE(arv_gc_node_));
     return consume_GError(err);
 }
 
@@ -487,9 +537,18 @@ AravisPropertyEnumImpl::AravisPropertyEnumImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_(ARV_GC_ENUMERATION(node))
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::Enumeration),
+      arv_gc_node_(ARV_GC_ENUMERATION(node))
+{
+}
+
+auto AravisPropertyEnumImpl::get_entries_locked() const -> const std::vector<enum_entry>&
 {
-    static_info_ = build_static_info(category, name);
+    if (entries_valid_)
+    {
+        return entries_;
+    }
 
     GError* err = nullptr;
     auto entries = arv_gc_enumeration_get_entries(arv_gc_node_);
@@ -513,8 +572,21 @@ AravisPropertyEnumImpl::AravisPropertyEnumImpl(
         }
         entries_.push_back(enum_entry { entry_name, value });
     }
+    entries_valid_ = true;
+    return entries_;
+}
 
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::Enumeration);
+std::vector<std::string> AravisPropertyEnumImpl::get_entries() const
+{
+    auto lck = acquire_backend_guard();
+    if (!lck)
+    {
+        return {};
+    }
+
+    std::vector<std::string> rval;
+    for (auto& e : get_entries_locked()) { rval.push_back(e.display_name); }
+    return rval;
 }
 
 outcome::result<std::string_view> AravisPropertyEnumImpl::get_default() const
@@ -530,14 +602,23 @@ outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_val
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
-    for (auto& e : entries_)
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    for (auto& e : get_entries_locked())
     {
         if (e.display_name == new_value)
         {
+            // the wb channel wrappers set the selector for every access
+            if (lck.cache().is_redundant_selector_write(node, e.value))
+            {
+                return outcome::success();
+            }
+
             GError* err = nullptr;
             arv_gc_enumeration_set_int_value(arv_gc_node_, e.value, &err);
+            lck.cache().on_write(node);
             if (err)
                 return consume_GError(err);
+            lck.cache().put(node, e.value);
             return outcome::success();
         }
     }
@@ -552,14 +633,20 @@ outcome::result<std::string_view> AravisPropertyEnumImpl::get_value() const
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
-    GError* err = nullptr;
-    auto current_value = arv_gc_enumeration_get_int_value(arv_gc_node_, &err);
-    if (err)
-        return consume_GError(err);
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    auto current_value = lck.cache().get<int64_t>(node);
+    if (!current_value)
+    {
+        GError* err = nullptr;
+        current_value = arv_gc_enumeration_get_int_value(arv_gc_node_, &err);
+        if (err)
+            return consume_GError(err);
+        lck.cache().put(node, current_value.value());
+    }
 
-    for (auto& e : entries_)
+    for (auto& e : get_entries_locked())
     {
-        if (e.value == current_value)
+        if (e.value == current_value.value())
             return e.display_name;
     }
     return tcam::status::PropertyValueOutOfBounds;
@@ -570,11 +657,10 @@ AravisPropertyStringImpl::AravisPropertyStringImpl(
     std::string_view category,
     ArvGcNode* node,
     const std::shared_ptr<AravisPropertyBackend>& backend)
-    : prop_base_impl(backend, ARV_GC_FEATURE_NODE(node)), arv_gc_node_(ARV_GC_STRING(node))
+    : prop_base_impl(
+        backend, ARV_GC_FEATURE_NODE(node), name, category, tcamprop1::prop_type::String),
+      arv_gc_node_(ARV_GC_STRING(node))
 {
-    static_info_ = build_static_info(category, name);
-
-    update_with_tcamprop1_static_info(name, static_info_, tcamprop1::prop_type::String);
 }
 
 std::error_code AravisPropertyStringImpl::set_value(std::string_view new_value)
@@ -587,6 +673,7 @@ std::error_code AravisPropertyStringImpl::set_value(std::string_view new_value)
     }
     GError* err = nullptr;
     arv_gc_string_set_value(arv_gc_node_, std::string { new_value }.c_str(), &err);
+    lck.cache().on_write(ARV_GC_FEATURE_NODE(arv_gc_node_));
     if (err)
         return consume_GError(err);
     return {};
@@ -600,12 +687,20 @@ outcome::result<std::string> AravisPropertyStringImpl::get_value() const
         SPDLOG_ERROR("Unable to lock backend.");
         return tcam::status::ResourceNotLockable;
     }
+    auto node = ARV_GC_FEATURE_NODE(arv_gc_node_);
+    if (auto cached = lck.cache().get<std::string>(node))
+    {
+        return cached.value();
+    }
+
     GError* err = nullptr;
     auto current_value = arv_gc_string_get_value(arv_gc_node_, &err);
     if (err)
         return consume_GError(err);
 
-    return std::string { current_value };
+    std::string ret { current_value };
+    lck.cache().put(node, ret);
+    return ret;
 }
 
 balance_ratio_raw_to_wb_channel::balance_ratio_raw_to_wb_channel(
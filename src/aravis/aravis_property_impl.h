@@ -54,6 +54,12 @@ struct aravis_backend_guard
         return owner_ != nullptr;
     }
 
+    // only valid when the guard holds the backend
+    property_value_cache& cache() const noexcept
+    {
+        return owner_->get_value_cache();
+    }
+
     static aravis_backend_guard acquire(const std::weak_ptr<AravisPropertyBackend>& cam) noexcept
     {
         return aravis_backend_guard { cam };
@@ -64,31 +70,45 @@ private:
     std::recursive_mutex* backend_mtx_ = nullptr;
 };
 
+/**
+ * Common part of the properties that wrap a GenICam feature node.
+ *
+ * Devices export thousands of features but applications only look at a few of them.
+ * So construction only stores name and category. Display name, description, access mode,
+ * the tcamprop1 overrides and enum entries are read from the node when they are first needed.
+ */
 class prop_base_impl
 {
 public:
     prop_base_impl(const std::shared_ptr<AravisPropertyBackend>& cam,
-                   ArvGcFeatureNode* feature_node);
+                   ArvGcFeatureNode* feature_node,
+                   std::string_view name_override,
+                   std::string_view category,
+                   tcamprop1::prop_type type);
 
 protected:
     PropertyFlags get_flags_impl() const;
 
     aravis_backend_guard acquire_backend_guard() const noexcept;
 
-    tcamprop1::prop_static_info_str build_static_info(
-        std::string_view category,
-        std::string_view name_override) const noexcept;
-
-    auto get_access_mode() const noexcept
+    std::string_view get_name_impl() const noexcept
     {
-        return access_mode_;
+        return static_info_.name;
     }
 
+    tcamprop1::prop_static_info get_static_info_impl() const;
+
+    // the caller has to hold the backend guard
+    const tcamprop1::prop_static_info_str& get_static_info_locked() const;
+
 private:
     std::weak_ptr<AravisPropertyBackend> backend_;
     ArvGcFeatureNode* feature_node_ = nullptr;
+    tcamprop1::prop_type type_;
 
-    tcamprop1::Access_t access_mode_ = tcamprop1::Access_t::RW;
+    // name and iccategory are set on construction, the rest once static_info_valid_ is set
+    mutable tcamprop1::prop_static_info_str static_info_;
+    mutable bool static_info_valid_ = false;
 };
 
 class AravisPropertyIntegerImpl : public prop_base_impl, public IPropertyInteger
@@ -99,9 +119,13 @@ public:
                               ArvGcNode* node,
                               const std::shared_ptr<AravisPropertyBackend>&);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
     PropertyFlags get_flags() const final
     {
@@ -127,7 +151,6 @@ public:
 private:
     ArvGcInteger* arv_gc_node_ = nullptr;
 
-    tcamprop1::prop_static_info_str static_info_;
     std::string unit_;
     tcamprop1::IntRepresentation_t int_rep_ = tcamprop1::IntRepresentation_t::Linear;
 };
@@ -141,9 +164,13 @@ public:
                              ArvGcNode* node,
                              const std::shared_ptr<AravisPropertyBackend>&);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
     PropertyFlags get_flags() const final
     {
@@ -168,7 +195,6 @@ public:
 private:
     ArvGcFloat* arv_gc_node_ = nullptr;
 
-    tcamprop1::prop_static_info_str static_info_;
     std::string unit_;
     tcamprop1::FloatRepresentation_t float_rep_ = tcamprop1::FloatRepresentation_t::Linear;
 };
@@ -182,9 +208,13 @@ public:
                            ArvGcNode* node,
                            const std::shared_ptr<AravisPropertyBackend>& backend);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
 
     PropertyFlags get_flags() const final
@@ -202,7 +232,6 @@ public:
 
 private:
     ArvGcBoolean* arv_gc_node_ = nullptr;
-    tcamprop1::prop_static_info_str static_info_;
 };
 
 
@@ -214,9 +243,13 @@ public:
                               ArvGcNode* node,
                               const std::shared_ptr<AravisPropertyBackend>& backend);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
 
     PropertyFlags get_flags() const final
@@ -227,7 +260,6 @@ public:
     outcome::result<void> execute() final;
 
 private:
-    tcamprop1::prop_static_info_str static_info_;
     ArvGcCommand* arv_gc_node_ = nullptr;
 };
 
@@ -239,9 +271,13 @@ public:
                            ArvGcNode* node,
                            const std::shared_ptr<AravisPropertyBackend>& backend);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
 
     PropertyFlags get_flags() const final
@@ -254,15 +290,9 @@ public:
 
     outcome::result<std::string_view> get_default() const final;
 
-    std::vector<std::string> get_entries() const final
-    {
-        std::vector<std::string> rval;
-        for (auto& e : entries_) { rval.push_back(e.display_name); }
-        return rval;
-    }
+    std::vector<std::string> get_entries() const final;
 
 private:
-    tcamprop1::prop_static_info_str static_info_;
     ArvGcEnumeration* arv_gc_node_ = nullptr;
 
     struct enum_entry
@@ -271,7 +301,11 @@ private:
         int64_t value;
     };
 
-    std::vector<enum_entry> entries_;
+    // reads the entries on first use, the caller has to hold the backend guard
+    const std::vector<enum_entry>& get_entries_locked() const;
+
+    mutable std::vector<enum_entry> entries_;
+    mutable bool entries_valid_ = false;
 };
 
 
@@ -283,9 +317,13 @@ public:
                              ArvGcNode* node,
                              const std::shared_ptr<AravisPropertyBackend>& backend);
 
+    std::string_view get_name() const noexcept final
+    {
+        return get_name_impl();
+    }
     tcamprop1::prop_static_info get_static_info() const final
     {
-        return static_info_.to_prop_static_info();
+        return get_static_info_impl();
     }
 
     PropertyFlags get_flags() const final
@@ -299,7 +337,6 @@ public:
 
 private:
     ArvGcString* arv_gc_node_ = nullptr;
-    tcamprop1::prop_static_info_str static_info_;
 };
 
 
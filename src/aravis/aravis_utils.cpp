@@ -28,11 +28,8 @@
 // gige-daemon communication
 
 #include "../../tools/tcam-gige-daemon/gige-daemon.h"
-#include "../tcam-semaphores.h"
 
-#include <sys/ipc.h>
-#include <sys/msg.h>
-#include <sys/shm.h>
+#include <mutex>
 
 using namespace tcam;
 using namespace tcam::tools;
@@ -177,71 +174,57 @@ bool is_blacklisted_gige(const std::string& manufacturer_info)
 
 static std::optional<std::vector<DeviceInfo>> fetch_gige_daemon_device_list()
 {
-    try
+    // the segment stays mapped between calls,
+    // reading the list then does not require a single syscall
+    static std::mutex mapping_mtx;
+    static const gige_daemon::tcam_gige_device_list* shared_mem_list = nullptr;
+
+    std::scoped_lock lck(mapping_mtx);
+
+    if (shared_mem_list && !gige_daemon::is_daemon_alive(*shared_mem_list))
+    {
+        // daemon stopped or was restarted with a new segment
+        gige_daemon::unmap_device_list(shared_mem_list);
+        shared_mem_list = nullptr;
+    }
+
+    if (!shared_mem_list)
     {
-        key_t shmkey = ftok(gige_daemon::LOCK_FILE, 'G');
-        if (shmkey == -1)
+        shared_mem_list = gige_daemon::map_device_list();
+
+        if (!shared_mem_list || !gige_daemon::is_daemon_alive(*shared_mem_list))
         {
             if (!not_using_gige_deamon_message_reported) // print this message only once and not every time we are queried
             {
-                SPDLOG_INFO("Failed to create shmkey. Not using gige-daemon to enumerate devices.");
+                SPDLOG_INFO("Unable to connect to gige-daemon. Using internal methods");
                 not_using_gige_deamon_message_reported = true;
             }
+            if (shared_mem_list)
+            {
+                gige_daemon::unmap_device_list(shared_mem_list);
+                shared_mem_list = nullptr;
+            }
             return std::nullopt;
         }
 
         not_using_gige_deamon_message_reported =
-            false; // reset message when fetching the lock worked
-
-        key_t shm_semaphore_key = ftok(gige_daemon::LOCK_FILE, 'S');
-        if (shm_semaphore_key == -1)
-        {
-            SPDLOG_INFO("Failed to create shmkey. errno={}.", errno);
-            return std::nullopt;
-        }
-
-        int shm_mem_id = shmget(shmkey, sizeof(gige_daemon::tcam_gige_device_list), 0644);
-        if (shm_mem_id < 0)
-        {
-            SPDLOG_INFO("Unable to connect to gige-daemon. Using internal methods");
-            return std::nullopt;
-        }
-
-        semaphore semaphore_instance = semaphore::create(shm_semaphore_key);
-        std::lock_guard<semaphore> lck(semaphore_instance);
-
-        auto ptr = shmat(shm_mem_id, NULL, 0);
-        if (ptr == ((void*)-1))
-        {
-            SPDLOG_ERROR("shmat failed to map memory. errno={}", errno);
-            return std::nullopt;
-        }
-        const gige_daemon::tcam_gige_device_list* shared_mem_list =
-            static_cast<const gige_daemon::tcam_gige_device_list*>(ptr);
-        if (shared_mem_list == nullptr)
-        {
-            SPDLOG_ERROR("shmat returned nullptr.");
-            return std::nullopt;
-        }
-
-        std::vector<DeviceInfo> ret;
+            false; // reset message when connecting worked
+    }
 
-        ret.reserve(shared_mem_list->device_count);
+    auto list = gige_daemon::read_device_list(*shared_mem_list);
+    if (!list)
+    {
+        // daemon died while updating the list, use the internal methods
+        gige_daemon::unmap_device_list(shared_mem_list);
+        shared_mem_list = nullptr;
+        return std::nullopt;
+    }
 
-        for (unsigned int i = 0; i < shared_mem_list->device_count; ++i)
-        {
-            ret.push_back(DeviceInfo(shared_mem_list->devices[i]));
-        }
+    std::vector<DeviceInfo> ret;
 
-        shmdt(shared_mem_list);
+    for (const auto& dev : *list) { ret.push_back(DeviceInfo(dev)); }
 
-        return ret;
-    }
-    catch (const std::exception& ex)
-    {
-        SPDLOG_INFO("Failed to fetch devices from gige-daemon, due to exception={}.", ex.what());
-    }
-    return std::nullopt;
+    return ret;
 }
 
 /*
@@ -259,6 +242,7 @@ struct dev_life_tracking
     int lost_count;
 };
 
+static std::mutex dev_life_tracking_mtx;
 static std::vector<dev_life_tracking> dev_life_tracking_list;
 
 
@@ -275,6 +259,8 @@ std::vector<DeviceInfo> tcam::get_gige_device_list()
         current_devices = get_aravis_device_list();
     }
 
+    std::scoped_lock lck(dev_life_tracking_mtx);
+
     // check for new devices
     // to be added to out watch current_devices
     // after everything else is done
@@ -342,6 +328,74 @@ std::vector<DeviceInfo> tcam::get_gige_device_list()
     return current_devices;
 }
 
+std::optional<DeviceInfo> tcam::find_gige_device(const std::string& serial)
+{
+    auto matches = [&serial](const DeviceInfo& d)
+    {
+        return d.get_serial() == serial;
+    };
+
+    // the gige-daemon already has the answer, reading its list is a memory access
+    if (auto dev_list = fetch_gige_daemon_device_list(); dev_list)
+    {
+        auto it = std::find_if(dev_list->begin(), dev_list->end(), matches);
+        if (it != dev_list->end())
+        {
+            return *it;
+        }
+        return std::nullopt;
+    }
+
+    // a device this process has seen during the last discovery
+    // AravisDevice then tries its address with a unicast discovery first
+    std::scoped_lock lck(dev_life_tracking_mtx);
+    for (const auto& entry : dev_life_tracking_list)
+    {
+        if (entry.lost_count == 0 && matches(entry.dev))
+        {
+            return entry.dev;
+        }
+    }
+    return std::nullopt;
+}
+
+unsigned int tcam::find_session_packet_size(const DeviceInfo& dev)
+{
+    // entries of a daemon that did not shut down cleanly are not pruned anymore
+    if (!fetch_gige_daemon_device_list())
+    {
+        return 0;
+    }
+
+    auto cache = gige_daemon::map_session_cache();
+    if (!cache)
+    {
+        return 0;
+    }
+
+    const auto& info = dev.get_info();
+    auto packet_size = gige_daemon::read_session_packet_size(
+        *cache, info.serial_number, info.additional_identifier);
+
+    gige_daemon::unmap_session_cache(cache);
+    return packet_size;
+}
+
+void tcam::store_session_packet_size(const DeviceInfo& dev, unsigned int packet_size)
+{
+    auto cache = gige_daemon::map_session_cache();
+    if (!cache)
+    {
+        return;
+    }
+
+    const auto& info = dev.get_info();
+    gige_daemon::write_session_packet_size(
+        *cache, info.serial_number, info.additional_identifier, packet_size);
+
+    gige_daemon::unmap_session_cache(cache);
+}
+
 unsigned int tcam::get_gige_device_count()
 {
     return get_gige_device_list().size();
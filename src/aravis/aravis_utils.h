@@ -22,6 +22,7 @@
 #include "../error.h" // tcam::status
 
 #include <arv.h> // ArvGcError/.../GError
+#include <optional>
 #include <string_view>
 #include <vector>
 
@@ -37,6 +38,15 @@ unsigned int get_gige_device_count();
 
 std::vector<DeviceInfo> get_gige_device_list();
 
+// serial from the gige-daemon or the last discovery of this process, no network traffic
+std::optional<DeviceInfo> find_gige_device(const std::string& serial);
+
+// packet size an earlier session negotiated with the camera at this address, 0 when unknown
+// requires a gige-daemon started with --session-cache
+unsigned int find_session_packet_size(const DeviceInfo& dev);
+
+void store_session_packet_size(const DeviceInfo& dev, unsigned int packet_size);
+
 std::vector<DeviceInfo> get_aravis_device_list();
 
 } /* namespace tcam */
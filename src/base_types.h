@@ -75,6 +75,26 @@ struct tcam_device_info
 typedef void (*tcam_device_lost_callback)(const struct tcam_device_info* info, void* user_data);
 
 
+/**
+ * Event the device sent, e.g. ExposureEnd.
+ * Only GigE Vision devices send events, through their message channel.
+ */
+struct tcam_device_event
+{
+    char name[64]; // GenICam name without the "Event" prefix, the id when it is unknown
+    uint16_t event_id;
+    uint16_t stream_channel; // 0xFFFF when the event does not belong to a stream
+    uint64_t block_id; // frame id the event belongs to, 0 when unknown
+    uint64_t timestamp; // device ticks, see GevTimestampTickFrequency
+};
+
+
+/**
+ * Called from the event thread of the device
+ */
+typedef void (*tcam_device_event_callback)(const struct tcam_device_event* event, void* user_data);
+
+
 /**
  * @name tcam_image_size
  */
@@ -252,6 +272,101 @@ struct tcam_video_format
 };
 
 
+/**
+ * How a GigE stream receives its packets.
+ */
+enum TCAM_GIGE_RECEIVE_MODE
+{
+    TCAM_GIGE_RECEIVE_MODE_UNKNOWN = 0, // not a GigE stream
+    TCAM_GIGE_RECEIVE_MODE_UDP_SOCKET = 1, // one recv syscall per packet
+    TCAM_GIGE_RECEIVE_MODE_PACKET_SOCKET = 2, // mmap ring of a packet socket, needs CAP_NET_RAW
+};
+
+
+/**
+ * Transport counters of a stream since it was started.
+ * Only backends with a packet based transport (aravis/GigE) fill these.
+ */
+struct tcam_transport_statistics
+{
+    uint64_t completed_buffers; // buffers that were received completely
+    uint64_t failed_buffers; // buffers that timed out or had missing packets
+    uint64_t underruns; // frames that arrived while no buffer was queued
+    uint64_t resent_packets; // packets that had to be requested again
+    uint64_t missing_packets; // packets that did not arrive, even after resends
+    TCAM_GIGE_RECEIVE_MODE receive_mode;
+};
+
+
+/**
+ * Transport tunables, -1 keeps the backend default.
+ * Used by aravis (GigE and USB3 Vision) and the AFU420.
+ */
+struct tcam_transport_options
+{
+    int socket_buffer_size = -1; // receive buffer of the GVSP socket in bytes
+    int packet_timeout_us = -1; // time to wait for a missing packet before requesting a resend
+    int frame_retention_us = -1; // time to wait for the missing packets of a frame
+    int packet_socket = -1; // 0 forces the UDP socket, 1 warns when no packet socket can be used
+    int usb_transfer_count = -1; // number of bulk transfers that are submitted at the same time
+    int usb_transfer_size = -1; // size of a single bulk transfer in bytes
+};
+
+
+/**
+ * What happens to incomplete frames that are delivered instead of dropped.
+ * Only used by aravis/GigE.
+ */
+struct tcam_salvage_options
+{
+    // find the lines of the missing packets, see ImageBuffer::get_missing_lines
+    bool report_missing_lines = false;
+    // gaps of up to this many lines are filled with the lines above them, 0 disables
+    int conceal_max_lines = 0;
+};
+
+
+/**
+ * Frames that are not delivered to the sink on purpose, e.g. for a preview that needs few frames.
+ * Skipped frames are requeued right away in the stream thread.
+ */
+struct tcam_decimation_options
+{
+    // deliver only every n-th frame, 0 and 1 deliver all
+    unsigned int frame_interval = 1;
+    // deliver at most this many frames per second, 0 for no limit
+    double max_rate = 0.0;
+    // software auto functions also run on every n-th skipped frame, 0 only uses delivered frames
+    unsigned int auto_interval = 0;
+};
+
+
+/**
+ * Frames the backend dropped, split by cause.
+ * The sum can be below tcam_stream_statistics::frames_dropped,
+ * e.g. frames that could not be delivered because the stream was stopped are not classified.
+ */
+struct tcam_drop_statistics
+{
+    uint64_t no_buffer; // frame arrived while no buffer was queued, the consumer returned them too late
+    uint64_t transport; // frame was lost on the way, e.g. a sequence gap while buffers were queued
+    uint64_t incomplete; // frame arrived incomplete or with a wrong size and was dropped
+};
+
+
+/**
+ * Point in time that tcam_stream_statistics::capture_time_ns refers to
+ */
+enum TCAM_TIMESTAMP_SOURCE
+{
+    TCAM_TIMESTAMP_SOURCE_UNKNOWN = 0, // backend does not report it
+    TCAM_TIMESTAMP_SOURCE_END_OF_FRAME = 1, // last byte of the frame was received
+    TCAM_TIMESTAMP_SOURCE_START_OF_EXPOSURE = 2,
+    TCAM_TIMESTAMP_SOURCE_START_OF_FRAME = 3, // first byte of the frame was received
+    TCAM_TIMESTAMP_SOURCE_SYSTEM = 4, // driver had no timestamp, taken when the buffer was dequeued
+};
+
+
 /**
  * Statistic container for additional image_buffer descriptions
  */
@@ -260,8 +375,64 @@ struct tcam_stream_statistics
     uint64_t frame_count; // current frame number
     uint64_t frames_dropped; // number of frames that where not delivered
     uint64_t capture_time_ns; // capture time reported by lib
+    TCAM_TIMESTAMP_SOURCE timestamp_source; // what capture_time_ns refers to
     uint64_t camera_time_ns; //capture time reported by camera; empty if not supported
     bool is_damaged; // flag indicating if the associated buffer had lost packages or other problems
+
+    // CLOCK_MONOTONIC stamps of the library stages
+    // 0 unless latency tracing is enabled
+    uint64_t dequeue_time_ns; // buffer was received from the driver
+    uint64_t auto_pass_begin_ns; // software properties start
+    uint64_t auto_pass_end_ns; // software properties end
+    uint64_t sink_push_time_ns; // buffer was handed to the sink
+
+    bool has_transport_statistics; // transport is filled
+    tcam_transport_statistics transport;
+
+    tcam_drop_statistics drops; // classification of frames_dropped
+
+    // id of the last scheduled property write executed before the frame was received,
+    // see CaptureDevice::schedule_property_write; 0 when none was executed
+    uint64_t settings_id;
+
+    // sensor position of the first pixel, OffsetX/OffsetY at stream start or of the last
+    // CaptureDevice::move_roi before the frame was received; false without offset properties
+    bool has_roi_origin;
+    int32_t roi_origin_x;
+    int32_t roi_origin_y;
+};
+
+
+/**
+ * Location of the GenICam chunk data that was delivered with an image.
+ * The chunks are not parsed, the consumer walks the trailers when it needs a value.
+ */
+struct tcam_chunk_data_info
+{
+    size_t offset = 0; // relative to the start of the buffer memory
+    size_t length = 0; // 0 when the image has no chunk data
+    bool is_little_endian = false; // byte order of the trailers, GigE Vision uses big endian
+};
+
+
+/**
+ * Image statistics of the auto functions, see auto_alg::image_statistics.
+ * The auto functions do not run on every frame, frame_count tells which frame was sampled.
+ */
+struct tcam_image_statistics
+{
+    uint64_t frame_count = 0; // of the sampled frame
+
+    float brightness = 0.f; // mean luminance [0;1]
+    float saturated_fraction = 0.f; // fraction of the samples with a luminance >= 240 / 255
+
+    float mean_r = 0.f; // [0;1]
+    float mean_g = 0.f;
+    float mean_b = 0.f;
+    uint32_t sample_count = 0;
+
+    uint32_t histogram[256] = {}; // luminance, 8-bit bayer only
+    uint32_t histogram_count = 0; // 0 when there is no histogram
 };
 
 
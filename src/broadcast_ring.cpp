@@ -0,0 +1,52 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "broadcast_ring.h"
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+std::string tcam::broadcast::make_socket_name(const std::string& name)
+{
+    return "tcam-broadcast-" + name;
+}
+
+
+void tcam::broadcast::futex_wake_all(std::atomic<uint32_t>& word) noexcept
+{
+    // not FUTEX_PRIVATE_FLAG, the waiters live in other processes
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+
+bool tcam::broadcast::futex_wait(std::atomic<uint32_t>& word,
+                                 uint32_t expected,
+                                 int timeout_ms) noexcept
+{
+    struct timespec timeout = {};
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (timeout_ms % 1000) * 1'000'000L;
+
+    const long ret = syscall(
+        SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+
+    // EAGAIN when the word already changed, EINTR on signals, both count as woken
+    return ret == 0 || errno != ETIMEDOUT;
+}
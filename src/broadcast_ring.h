@@ -0,0 +1,141 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "base_types.h"
+#include "compiler_defines.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+VISIBILITY_INTERNAL
+
+/*
+ * Layout of the memfd shared between a BroadcastSink and its BroadcastConsumers.
+ *
+ * The header is followed by slot_count slots of slot_stride bytes, starting at data_offset.
+ * entries[n % slot_count] names the slot of frame n, the slot seq tells if it still holds n.
+ * A consumer holds a slot with a bit in its held mask, the producer never overwrites a held slot
+ * and picks the oldest free slot instead, so one slow consumer does not stall the others.
+ * The futex words wake consumers on new frames and the producer on released frames.
+ */
+namespace tcam::broadcast
+{
+
+constexpr uint64_t ring_magic = 0x314352424d414354; // "TCAMBRC1"
+constexpr uint32_t ring_version = 1;
+
+constexpr unsigned int max_consumers = 16;
+// the held masks of the consumers are 64 bit
+constexpr unsigned int max_slots = 64;
+
+// slot seq while the producer writes the slot
+constexpr uint64_t invalid_seq = ~uint64_t(0);
+
+enum class consumer_policy : uint32_t
+{
+    drop = 0, // frames the consumer did not read in time are skipped
+    block = 1, // the producer waits for the consumer before it overwrites an unread frame
+};
+
+struct consumer_entry
+{
+    // 0 free, 1 connected
+    std::atomic<uint32_t> active;
+    consumer_policy policy;
+    int32_t pid;
+    uint32_t reserved;
+
+    // sequence of the next frame the consumer reads
+    std::atomic<uint64_t> read_seq;
+    // slots the consumer currently holds, released by the producer when the consumer disconnects
+    std::atomic<uint64_t> held_mask;
+    std::atomic<uint64_t> frames_dropped;
+};
+
+struct slot_header
+{
+    // frame in the slot, invalid_seq while it is written
+    std::atomic<uint64_t> seq;
+    uint64_t data_length;
+    tcam_stream_statistics statistics;
+};
+
+struct ring_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint64_t slot_stride;
+    uint64_t data_offset;
+
+    uint32_t fourcc;
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+    double framerate;
+
+    // sequence of the next frame, frames [write_seq - slot_count, write_seq) may be readable
+    std::atomic<uint64_t> write_seq;
+    // frames the producer could not publish because every slot was held
+    std::atomic<uint64_t> frames_dropped;
+    // slot index of frame n at n % slot_count
+    std::atomic<uint32_t> entries[max_slots];
+
+    // incremented for every published frame and when the producer closes
+    std::atomic<uint32_t> frame_futex;
+    // incremented when a consumer releases a slot or advances its read_seq
+    std::atomic<uint32_t> release_futex;
+    // 0 after the producer stopped, no new frames will come
+    std::atomic<uint32_t> producer_alive;
+    uint32_t reserved2;
+
+    consumer_entry consumers[max_consumers];
+    slot_header slots[max_slots];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the ring is shared between processes, the atomics have to be address free");
+
+// request sent by a consumer after it connected
+struct connect_request
+{
+    uint32_t version;
+    consumer_policy policy;
+};
+
+// reply of the producer, the memfd is attached as SCM_RIGHTS when accepted
+struct connect_reply
+{
+    uint32_t version;
+    // index into ring_header::consumers, -1 when the producer has no free entry
+    int32_t consumer_index;
+};
+
+// abstract unix socket address, so that no file has to be cleaned up
+std::string make_socket_name(const std::string& name);
+
+// futex wrappers for words in shared memory
+void futex_wake_all(std::atomic<uint32_t>& word) noexcept;
+// returns false on timeout
+bool futex_wait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms) noexcept;
+
+} // namespace tcam::broadcast
+
+VISIBILITY_POP
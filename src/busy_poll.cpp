@@ -0,0 +1,61 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "busy_poll.h"
+
+#include "logging.h"
+#include "utils.h"
+
+namespace
+{
+
+tcam::busy_poll_config read_busy_poll_config()
+{
+    tcam::busy_poll_config ret;
+
+    // the value is the half width of the spin window in microseconds
+    auto env = tcam::get_environment_variable_int("TCAM_BUSY_POLL");
+    if (env && env.value() > 0)
+    {
+        ret.enabled = true;
+        ret.window = std::chrono::microseconds(env.value());
+        SPDLOG_INFO("Busy polling for frames with a window of {} us", env.value());
+    }
+    return ret;
+}
+
+} // namespace
+
+
+const tcam::busy_poll_config& tcam::get_busy_poll_config()
+{
+    static const busy_poll_config config = read_busy_poll_config();
+    return config;
+}
+
+
+void tcam::frame_arrival_predictor::set_framerate(double fps) noexcept
+{
+    if (fps > 0.0)
+    {
+        period_ = std::chrono::nanoseconds(static_cast<int64_t>(1'000'000'000.0 / fps));
+    }
+    else
+    {
+        period_ = std::chrono::nanoseconds(0);
+        has_prediction_ = false;
+    }
+}
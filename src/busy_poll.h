@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Opt-in busy polling of the v4l2 and libusb capture threads, see TCAM_BUSY_POLL.
+ *
+ * The threads block until shortly before the next frame is expected
+ * and spin from there until it arrived or the window is over.
+ * Frames that miss the window, triggered streams and the first frame use blocking waits.
+ */
+struct busy_poll_config
+{
+    bool enabled = false;
+    // the spin starts this long before the expected arrival and ends this long after it
+    std::chrono::microseconds window { 0 };
+};
+
+// TCAM_BUSY_POLL is read on first use
+const busy_poll_config& get_busy_poll_config();
+
+// hint in spin loops, lets the sibling hyperthread run and saves power
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * Expected arrival of the next frame, the last arrival plus the frame period.
+ * Not thread safe.
+ */
+class frame_arrival_predictor
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit frame_arrival_predictor(std::chrono::microseconds window) noexcept : window_(window)
+    {
+    }
+
+    // 0 or less disables the prediction, e.g. for triggered streams
+    void set_framerate(double fps) noexcept;
+
+    void on_frame(clock::time_point arrival) noexcept
+    {
+        last_arrival_ = arrival;
+        has_prediction_ = period_.count() > 0;
+    }
+
+    // no frame arrived in the window, wait blocking until the next one
+    void on_miss() noexcept
+    {
+        has_prediction_ = false;
+    }
+
+    bool has_prediction() const noexcept
+    {
+        return has_prediction_;
+    }
+    clock::time_point spin_start() const noexcept
+    {
+        return last_arrival_ + period_ - window_;
+    }
+    clock::time_point spin_end() const noexcept
+    {
+        return last_arrival_ + period_ + window_;
+    }
+
+private:
+    std::chrono::microseconds window_;
+    std::chrono::nanoseconds period_ { 0 };
+    clock::time_point last_arrival_ = {};
+    bool has_prediction_ = false;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
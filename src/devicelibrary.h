@@ -18,8 +18,11 @@
 
 #include "DeviceInfo.h"
 
+#include <functional>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <string>
 
 namespace tcam
 {
@@ -37,6 +40,27 @@ public:
     virtual TCAM_DEVICE_TYPE get_type() const = 0;
     virtual std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) = 0;
     virtual std::vector<DeviceInfo> get_device_list()= 0;
+
+    /*
+     * Look for a single device without enumerating everything.
+     * Returns std::nullopt when the backend cannot answer quickly or does not know serial,
+     * the caller then has to fall back to the device list of the Indexer.
+     */
+    virtual std::optional<DeviceInfo> find_device(const std::string& /* serial */)
+    {
+        return std::nullopt;
+    }
+
+    /*
+     * Set a function that is called whenever the device list of this backend may have changed.
+     * An empty function removes the callback.
+     * The callback may be invoked from an arbitrary backend thread.
+     * Returns false when the backend cannot detect changes and has to be polled.
+     */
+    virtual bool set_hotplug_callback(std::function<void()> /* cb */)
+    {
+        return false;
+    }
 };
 
 } // namespace tcam
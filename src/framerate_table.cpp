@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "framerate_table.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+
+bool size_less(const tcam::tcam_image_size& lhs, const tcam::tcam_image_size& rhs) noexcept
+{
+    return std::tie(lhs.width, lhs.height) < std::tie(rhs.width, rhs.height);
+}
+
+} // namespace
+
+
+tcam::framerate_table::framerate_table(const std::vector<VideoFormatDescription>& formats)
+{
+    for (const auto& desc : formats)
+    {
+        const uint32_t fourcc = desc.get_fourcc();
+        auto iter = std::find_if(entries_.begin(),
+                                 entries_.end(),
+                                 [fourcc](const fourcc_entry& e) { return e.fourcc == fourcc; });
+        if (iter == entries_.end())
+        {
+            entries_.push_back(fourcc_entry { fourcc, {}, {} });
+            iter = std::prev(entries_.end());
+        }
+
+        for (const auto& mapping : desc.get_framerate_mappings())
+        {
+            if (mapping.framerates.empty())
+            {
+                continue;
+            }
+            if (mapping.resolution.type == TCAM_RESOLUTION_TYPE_FIXED)
+            {
+                iter->fixed.push_back({ mapping.resolution.min_size, mapping.framerates });
+            }
+            else
+            {
+                iter->ranges.push_back(
+                    { mapping.resolution.min_size, mapping.resolution.max_size, mapping.framerates });
+            }
+        }
+    }
+
+    for (auto& entry : entries_)
+    {
+        // stable, so that the first description of a size wins like in a linear search
+        std::stable_sort(entry.fixed.begin(),
+                         entry.fixed.end(),
+                         [](const fixed_entry& lhs, const fixed_entry& rhs)
+                         { return size_less(lhs.size, rhs.size); });
+    }
+    std::sort(entries_.begin(),
+              entries_.end(),
+              [](const fourcc_entry& lhs, const fourcc_entry& rhs)
+              { return lhs.fourcc < rhs.fourcc; });
+}
+
+
+const std::vector<double>* tcam::framerate_table::find(const VideoFormat& fmt) const
+{
+    const uint32_t fourcc = fmt.get_fourcc();
+    auto entry = std::lower_bound(entries_.begin(),
+                                  entries_.end(),
+                                  fourcc,
+                                  [](const fourcc_entry& e, uint32_t f) { return e.fourcc < f; });
+    if (entry == entries_.end() || entry->fourcc != fourcc)
+    {
+        return nullptr;
+    }
+
+    const auto size = fmt.get_size();
+
+    auto fixed = std::lower_bound(entry->fixed.begin(),
+                                  entry->fixed.end(),
+                                  size,
+                                  [](const fixed_entry& e, const tcam_image_size& s)
+                                  { return size_less(e.size, s); });
+    if (fixed != entry->fixed.end() && fixed->size == size)
+    {
+        return &fixed->framerates;
+    }
+
+    for (const auto& range : entry->ranges)
+    {
+        if (tcam::is_inside_dim_range(range.min_size, range.max_size, size))
+        {
+            return &range.framerates;
+        }
+    }
+    return nullptr;
+}
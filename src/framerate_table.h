@@ -0,0 +1,74 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "VideoFormat.h"
+#include "VideoFormatDescription.h"
+#include "compiler_defines.h"
+
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Framerates of all format descriptions, indexed by fourcc and size.
+ * Fixed resolutions are found by binary search, ranges are checked in description order.
+ * Gives the same answer as asking every VideoFormatDescription in order,
+ * except that a fixed resolution wins over a range that contains it.
+ */
+class framerate_table
+{
+public:
+    framerate_table() = default;
+    explicit framerate_table(const std::vector<VideoFormatDescription>& formats);
+
+    // nullptr when no description has framerates for fmt
+    const std::vector<double>* find(const VideoFormat& fmt) const;
+
+private:
+    struct fixed_entry
+    {
+        tcam_image_size size;
+        std::vector<double> framerates;
+    };
+
+    struct range_entry
+    {
+        tcam_image_size min_size;
+        tcam_image_size max_size;
+        std::vector<double> framerates;
+    };
+
+    struct fourcc_entry
+    {
+        uint32_t fourcc = 0;
+
+        // sorted by width, then height
+        std::vector<fixed_entry> fixed;
+        std::vector<range_entry> ranges;
+    };
+
+    // sorted by fourcc
+    std::vector<fourcc_entry> entries_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gige_action_command.h"
+
+#include "logging.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+constexpr uint16_t gvcp_port = 3956;
+constexpr uint8_t gvcp_key = 0x42;
+constexpr uint16_t gvcp_action_cmd = 0x0100;
+
+// header and payload in network byte order, no acknowledge is requested
+struct action_packet
+{
+    uint8_t key;
+    uint8_t flags;
+    uint16_t command;
+    uint16_t length;
+    uint16_t req_id;
+
+    uint32_t device_key;
+    uint32_t group_key;
+    uint32_t group_mask;
+} __attribute__((packed));
+
+static_assert(sizeof(action_packet) == 20);
+
+std::vector<in_addr> interface_broadcast_addresses()
+{
+    std::vector<in_addr> ret;
+
+    struct ifaddrs* list = nullptr;
+    if (getifaddrs(&list) != 0)
+    {
+        return ret;
+    }
+
+    for (auto ifa = list; ifa; ifa = ifa->ifa_next)
+    {
+        if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET || !ifa->ifa_broadaddr
+            || (ifa->ifa_flags & IFF_LOOPBACK) || !(ifa->ifa_flags & IFF_BROADCAST)
+            || !(ifa->ifa_flags & IFF_UP))
+        {
+            continue;
+        }
+        ret.push_back(reinterpret_cast<struct sockaddr_in*>(ifa->ifa_broadaddr)->sin_addr);
+    }
+    freeifaddrs(list);
+    return ret;
+}
+
+} // namespace
+
+
+outcome::result<void> tcam::send_gige_action_command(const gige_action_command& cmd)
+{
+    std::vector<in_addr> destinations;
+    if (cmd.destination.empty())
+    {
+        destinations = interface_broadcast_addresses();
+    }
+    else
+    {
+        in_addr addr = {};
+        if (inet_pton(AF_INET, cmd.destination.c_str(), &addr) != 1)
+        {
+            SPDLOG_ERROR("'{}' is no IPv4 address", cmd.destination);
+            return status::InvalidParameter;
+        }
+        destinations.push_back(addr);
+    }
+
+    if (destinations.empty())
+    {
+        SPDLOG_ERROR("No network interface to send the action command on");
+        return std::error_code(ENETUNREACH, std::generic_category());
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable));
+
+    // 0 is not a valid request id
+    static std::atomic<uint16_t> req_id = 0;
+    uint16_t id = ++req_id;
+    if (id == 0)
+    {
+        id = ++req_id;
+    }
+
+    action_packet packet = {};
+    packet.key = gvcp_key;
+    packet.flags = 0;
+    packet.command = htons(gvcp_action_cmd);
+    packet.length = htons(12);
+    packet.req_id = htons(id);
+    packet.device_key = htonl(cmd.device_key);
+    packet.group_key = htonl(cmd.group_key);
+    packet.group_mask = htonl(cmd.group_mask);
+
+    outcome::result<void> ret = outcome::success();
+    for (const auto& addr : destinations)
+    {
+        struct sockaddr_in dest = {};
+        dest.sin_family = AF_INET;
+        dest.sin_port = htons(gvcp_port);
+        dest.sin_addr = addr;
+
+        if (sendto(fd,
+                   &packet,
+                   sizeof(packet),
+                   0,
+                   reinterpret_cast<struct sockaddr*>(&dest),
+                   sizeof(dest))
+            != sizeof(packet))
+        {
+            SPDLOG_ERROR("Unable to send action command: {}", strerror(errno));
+            ret = std::error_code(errno, std::generic_category());
+        }
+    }
+
+    close(fd);
+    return ret;
+}
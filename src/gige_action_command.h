@@ -0,0 +1,51 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+#include "error.h"
+
+#include <cstdint>
+#include <string>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * GigE Vision ACTION_CMD.
+ * Cameras whose ActionDeviceKey, ActionGroupKey and ActionGroupMask match
+ * execute the action, e.g. a trigger with TriggerSource=Action0,
+ * all of them on the same packet.
+ */
+struct gige_action_command
+{
+    uint32_t device_key = 0;
+    uint32_t group_key = 0;
+    uint32_t group_mask = 0;
+
+    // IPv4 address the command is sent to,
+    // empty sends it to the broadcast address of every interface
+    std::string destination;
+};
+
+outcome::result<void> send_gige_action_command(const gige_action_command& cmd);
+
+} // namespace tcam
+
+VISIBILITY_POP
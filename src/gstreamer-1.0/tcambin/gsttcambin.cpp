@@ -57,6 +57,8 @@ enum
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_TOPOLOGY,
+    PROP_JPEG_DECODER,
 };
 
 
@@ -197,6 +199,8 @@ static bool tcambin_create_source(GstTcamBin* self)
     auto src_caps = gst_helper::query_caps(*gst_helper::get_static_pad(*data.src_element, "src"));
 
     data.available_caps = tcambin_filter_unsupported_caps(self, *src_caps.get());
+    data.available_caps_index =
+        std::make_unique<tcam::gst::caps_index>(*data.available_caps.get());
 
     return true;
 }
@@ -458,11 +462,19 @@ static bool tcambin_create_elements(GstTcamBin* self)
 
     if (tcam::gst::contains_jpeg(data.available_caps.get()))
     {
-        if (!create_and_add_element(&data.jpegdec, "jpegdec", name_jpeg, GST_BIN(self)))
+        if (!create_and_add_element(
+                &data.jpegdec, data.jpeg_decoder.c_str(), name_jpeg, GST_BIN(self)))
         {
-            GST_ELEMENT_ERROR(
-                self, CORE, MISSING_PLUGIN, ("Could not create element 'jpegdec'."), (NULL));
-            return false;
+            GST_WARNING_OBJECT(self,
+                               "Could not create jpeg decoder '%s'. Falling back to 'jpegdec'.",
+                               data.jpeg_decoder.c_str());
+
+            if (!create_and_add_element(&data.jpegdec, "jpegdec", name_jpeg, GST_BIN(self)))
+            {
+                GST_ELEMENT_ERROR(
+                    self, CORE, MISSING_PLUGIN, ("Could not create element 'jpegdec'."), (NULL));
+                return false;
+            }
         }
 
 
@@ -484,6 +496,13 @@ static bool tcambin_create_elements(GstTcamBin* self)
             return false;
         }
 
+        // the color conversion of a decoded 1080p stream easily takes more than one core
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(data.videoconvert), "n-threads"))
+        {
+            // 0 uses one thread per cpu
+            g_object_set(data.videoconvert, "n-threads", 0u, NULL);
+        }
+
         if (!link_elements(data.jpegdec, data.videoconvert, pipeline_string, name_videoconvert))
         {
             GST_ELEMENT_ERROR(
@@ -553,6 +572,9 @@ static bool tcambin_create_elements(GstTcamBin* self)
 
     GST_DEBUG_OBJECT(self, "Internal pipeline: %s", pipeline_string.c_str());
 
+    data.chain_topology = pipeline_string;
+    data.topology = pipeline_string;
+
     data.elements_created = true;
 
     return true;
@@ -583,6 +605,172 @@ static void set_target_pad(GstTcamBin* self)
 }
 
 
+// tcamsrc can feed the sink without any intermediate element when the sink accepts the device caps
+static bool tcambin_can_link_directly(const tcambin_data& data)
+{
+    // these may work on images that keep their format, e.g. for tone mapping
+    if (data.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_DUTILS
+        || data.conversion_info.selected_conversion == TCAM_BIN_CONVERSION_CUDA)
+    {
+        return false;
+    }
+
+    if (!data.target_caps || gst_caps_is_empty(data.target_caps.get()))
+    {
+        // without sink caps jpeg is still decoded
+        return !tcam::gst::contains_jpeg(data.src_caps.get());
+    }
+    return gst_caps_can_intersect(data.src_caps.get(), data.target_caps.get());
+}
+
+
+// answers caps queries of tcamsrc in place of the capsfilter while it is linked directly
+static gboolean tcambin_internal_pad_query(GstPad* pad, GstObject* parent, GstQuery* query)
+{
+    GstTcamBin* self = GST_TCAMBIN(pad->querydata);
+
+    gst_helper::gst_ptr<GstCaps> direct_caps;
+    GST_OBJECT_LOCK(self);
+    direct_caps = self->data->direct_caps;
+    GST_OBJECT_UNLOCK(self);
+
+    if (!direct_caps)
+    {
+        return gst_proxy_pad_query_default(pad, parent, query);
+    }
+
+    switch (GST_QUERY_TYPE(query))
+    {
+        case GST_QUERY_CAPS:
+        {
+            if (!gst_proxy_pad_query_default(pad, parent, query))
+            {
+                return FALSE;
+            }
+            GstCaps* result = nullptr;
+            gst_query_parse_caps_result(query, &result);
+
+            GstCaps* filtered = gst_caps_intersect(result, direct_caps.get());
+            gst_query_set_caps_result(query, filtered);
+            gst_caps_unref(filtered);
+            return TRUE;
+        }
+        case GST_QUERY_ACCEPT_CAPS:
+        {
+            GstCaps* caps = nullptr;
+            gst_query_parse_accept_caps(query, &caps);
+
+            if (!gst_caps_can_intersect(caps, direct_caps.get()))
+            {
+                gst_query_set_accept_caps_result(query, FALSE);
+                return TRUE;
+            }
+            return gst_proxy_pad_query_default(pad, parent, query);
+        }
+        default:
+        {
+            return gst_proxy_pad_query_default(pad, parent, query);
+        }
+    }
+}
+
+
+// the intermediate elements stay in the bin, so that their properties remain available
+static bool tcambin_link_directly(GstTcamBin* self)
+{
+    auto& data = get_tcambin_data(self);
+
+    gst_element_unlink(data.src_element.get(), data.pipeline_caps);
+
+    GST_OBJECT_LOCK(self);
+    data.direct_caps = data.src_caps;
+    GST_OBJECT_UNLOCK(self);
+
+    auto src_pad = gst_helper::get_static_pad(*data.src_element, "src");
+    if (!gst_ghost_pad_set_target(GST_GHOST_PAD(data.src_ghost_pad), src_pad.get()))
+    {
+        GST_ERROR_OBJECT(self, "Could not set tcamsrc as target for ghostpad.");
+        return false;
+    }
+
+    data.topology = "tcamsrc";
+
+    GST_INFO_OBJECT(self, "Sink accepts the device caps, linking tcamsrc directly");
+    return true;
+}
+
+
+// decoders like jpegdec with libjpeg-turbo can output BGRx themselves
+static bool tcambin_can_skip_videoconvert(const tcambin_data& data)
+{
+    if (!data.jpegdec || !data.videoconvert || !data.target_caps
+        || gst_caps_is_empty(data.target_caps.get()))
+    {
+        return false;
+    }
+
+    auto decoder_pad = gst_helper::get_static_pad(*data.jpegdec, "src");
+    auto decoder_caps = gst_helper::make_ptr(gst_pad_get_pad_template_caps(decoder_pad.get()));
+
+    return gst_caps_can_intersect(decoder_caps.get(), data.target_caps.get());
+}
+
+
+static bool tcambin_skip_videoconvert(GstTcamBin* self)
+{
+    auto& data = get_tcambin_data(self);
+
+    gst_element_unlink(data.jpegdec, data.videoconvert);
+    data.videoconvert_skipped = true;
+
+    auto decoder_pad = gst_helper::get_static_pad(*data.jpegdec, "src");
+    if (!gst_ghost_pad_set_target(GST_GHOST_PAD(data.src_ghost_pad), decoder_pad.get()))
+    {
+        GST_ERROR_OBJECT(self, "Could not set the jpeg decoder as target for ghostpad.");
+        return false;
+    }
+
+    const std::string videoconvert_link = std::string(" ! ") + name_videoconvert;
+    auto pos = data.chain_topology.rfind(videoconvert_link);
+    data.topology = data.chain_topology.substr(0, pos);
+
+    GST_INFO_OBJECT(self, "Sink accepts the output of the jpeg decoder, skipping videoconvert");
+    return true;
+}
+
+
+static void tcambin_restore_chain(GstTcamBin* self)
+{
+    auto& data = get_tcambin_data(self);
+
+    if (data.direct_caps)
+    {
+        GST_OBJECT_LOCK(self);
+        data.direct_caps.reset();
+        GST_OBJECT_UNLOCK(self);
+
+        gst_ghost_pad_set_target(GST_GHOST_PAD(data.src_ghost_pad), data.target_pad.get());
+
+        if (!gst_element_link(data.src_element.get(), data.pipeline_caps))
+        {
+            GST_ERROR_OBJECT(self, "Could not relink internal pipeline.");
+        }
+    }
+    else if (data.videoconvert_skipped)
+    {
+        data.videoconvert_skipped = false;
+
+        gst_ghost_pad_set_target(GST_GHOST_PAD(data.src_ghost_pad), data.target_pad.get());
+
+        if (!gst_element_link(data.jpegdec, data.videoconvert))
+        {
+            GST_ERROR_OBJECT(self, "Could not relink internal pipeline.");
+        }
+    }
+    data.topology = data.chain_topology;
+}
+
+
 static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstStateChange trans)
 {
     GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
@@ -631,6 +819,10 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
         }
         case GST_STATE_CHANGE_READY_TO_PAUSED:
         {
+            // links and caps of the previous run, kept while in READY
+            auto previous_src_caps = data.src_caps;
+            auto previous_target_caps = data.target_caps;
+
             auto sinkpad = gst_helper::get_peer_pad(*data.src_ghost_pad);
 
             if (sinkpad == nullptr)
@@ -673,8 +865,7 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
 
             if (data.user_caps)
             {
-                GstCaps* tmp =
-                    gst_caps_intersect(data.user_caps.get(), self->data->available_caps.get());
+                GstCaps* tmp = data.available_caps_index->intersect(*data.user_caps.get());
                 if (tmp == nullptr || gst_caps_is_empty(tmp))
                 {
                     GST_ELEMENT_ERROR(self,
@@ -720,8 +911,35 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
                 return GST_STATE_CHANGE_FAILURE;
             }
 
-            // this applies the caps to tcamsrc
-            g_object_set(self->data->pipeline_caps, "caps", self->data->src_caps.get(), NULL);
+            if (previous_src_caps && previous_target_caps
+                && gst_caps_is_equal(previous_src_caps.get(), data.src_caps.get())
+                && gst_caps_is_equal(previous_target_caps.get(), data.target_caps.get()))
+            {
+                // restart with the same caps, e.g. after changing a property in READY
+                // the capsfilter and the links are still valid
+                GST_INFO_OBJECT(self, "Caps unchanged, reusing the internal pipeline");
+            }
+            else
+            {
+                // this applies the caps to tcamsrc
+                g_object_set(self->data->pipeline_caps, "caps", self->data->src_caps.get(), NULL);
+
+                tcambin_restore_chain(self);
+                if (tcambin_can_link_directly(data))
+                {
+                    if (!tcambin_link_directly(self))
+                    {
+                        tcambin_restore_chain(self);
+                    }
+                }
+                else if (tcambin_can_skip_videoconvert(data))
+                {
+                    if (!tcambin_skip_videoconvert(self))
+                    {
+                        tcambin_restore_chain(self);
+                    }
+                }
+            }
 
             /*
              * We send this message as a means of always notifying
@@ -768,12 +986,15 @@ static GstStateChangeReturn gst_tcam_bin_change_state(GstElement* element, GstSt
         {
             data.target_set = false;
 
-            data.src_caps.reset();
-
+            // the links and caps stay,
+            // going to PAUSED again only relinks when the caps change
             break;
         }
         case GST_STATE_CHANGE_READY_TO_NULL:
         {
+            tcambin_restore_chain(self);
+            data.src_caps.reset();
+            data.target_caps.reset();
             gst_tcambin_clear_source(self);
             gst_tcambin_clear_elements(self);
             gst_ghost_pad_set_target(GST_GHOST_PAD(data.src_ghost_pad), NULL);
@@ -868,6 +1089,16 @@ static void gst_tcambin_get_property(GObject* object,
             g_value_set_enum(value, self->data->conversion_info.user_selector);
             break;
         }
+        case PROP_TOPOLOGY:
+        {
+            g_value_set_string(value, state.topology.c_str());
+            break;
+        }
+        case PROP_JPEG_DECODER:
+        {
+            g_value_set_string(value, state.jpeg_decoder.c_str());
+            break;
+        }
         case PROP_TCAM_PROPERTIES_JSON:
         {
             if (!state.is_open())
@@ -980,6 +1211,20 @@ static void gst_tcambin_set_property(GObject* object,
 
             break;
         }
+        case PROP_JPEG_DECODER:
+        {
+            if (!is_state_null(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'jpeg-decoder' is not writable in state "
+                                 ">= GST_STATE_READY.");
+                return;
+            }
+
+            const char* str = g_value_get_string(value);
+            self->data->jpeg_decoder = str && str[0] != '\0' ? str : "jpegdec";
+            break;
+        }
         case PROP_TCAMDEVICE:
         {
             if (!is_state_null(self))
@@ -1067,6 +1312,11 @@ static void gst_tcambin_init(GstTcamBin* self)
     data.src_ghost_pad = gst_ghost_pad_new_no_target("src", GST_PAD_SRC);
     gst_element_add_pad(GST_ELEMENT(self), data.src_ghost_pad);
 
+    GstProxyPad* internal_pad = gst_proxy_pad_get_internal(GST_PROXY_PAD(data.src_ghost_pad));
+    gst_pad_set_query_function_full(
+        GST_PAD(internal_pad), tcambin_internal_pad_query, self, nullptr);
+    gst_object_unref(internal_pad);
+
     GST_OBJECT_FLAG_SET(self, GST_ELEMENT_FLAG_SOURCE);
 }
 
@@ -1191,6 +1441,26 @@ static void gst_tcambin_class_init(GstTcamBinClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TOPOLOGY,
+        g_param_spec_string("topology",
+                            "Internal pipeline",
+                            "Elements the data passes through, "
+                            "'tcamsrc' when the device caps are delivered without conversion",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_JPEG_DECODER,
+        g_param_spec_string("jpeg-decoder",
+                            "Jpeg decoder",
+                            "Factory name of the element that decodes jpeg images, "
+                            "e.g. 'vajpegdec' or 'v4l2jpegdec' for hardware decoding",
+                            "jpegdec",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&src_template));
 
     gst_element_class_set_details_simple(element_class,
@@ -1,12 +1,14 @@
 
 #pragma once
 
+#include "../tcamgstbase/caps_index.h"
 #include "../tcamgstbase/tcambinconversion.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "gsttcambin.h"
 
 #include <gst-helper/helper_functions.h>
 #include <gst/gst.h>
+#include <memory>
 #include <string>
 
 
@@ -38,8 +40,12 @@ struct tcambin_data
 
     gst_helper::gst_ptr<GstElement> out_caps_filter_;
 
+    // src_caps and target_caps of the last negotiation are kept until NULL,
+    // READY_TO_PAUSED compares against them to decide whether to relink
     gst_helper::gst_ptr<GstCaps> src_caps;
     gst_helper::gst_ptr<GstCaps> available_caps;
+    // built once per source, used to match user caps
+    std::unique_ptr<tcam::gst::caps_index> available_caps_index;
     gst_helper::gst_ptr<GstCaps> target_caps;
 
     // #TODO the lifetime of these is somewhat unclear to me, maybe look through this again
@@ -51,6 +57,18 @@ struct tcambin_data
 
     tcambin_conversion conversion_info = {};
 
+    // internal pipeline as reported by the 'topology' property
+    std::string topology;
+    std::string chain_topology;
+    // set while tcamsrc is the ghost pad target, restricts the caps downstream is offered
+    // protected by the object lock of the bin
+    gst_helper::gst_ptr<GstCaps> direct_caps;
+    // jpegdec is the ghost pad target, its output is accepted by the sink
+    bool videoconvert_skipped = false;
+
+    // factory used for jpeg decoding
+    std::string jpeg_decoder = "jpegdec";
+
     bool elements_created = false;
     bool target_set = false;
 
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lossless_caps.h"
+
+#include "transform_impl.h"
+
+#include <cstring>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+#include <dutils_img_lib/dutils_gst_interop.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+
+namespace codec = img_filter::codec::lossless;
+
+auto tcamconvert::lossless::get_supported_fccs() -> std::vector<img::fourcc>
+{
+    std::vector<img::fourcc> rval;
+    for (auto fcc : tcamconvert::tcamconvert_get_all_input_fccs())
+    {
+        if (codec::is_supported_fcc(fcc))
+        {
+            rval.push_back(fcc);
+        }
+    }
+    return rval;
+}
+
+auto tcamconvert::lossless::generate_encoded_template_caps() -> gst_helper::gst_ptr<GstCaps>
+{
+    GstCaps* caps = gst_caps_new_simple(encoded_caps_name,
+                                        "width",
+                                        GST_TYPE_INT_RANGE,
+                                        1,
+                                        G_MAXINT,
+                                        "height",
+                                        GST_TYPE_INT_RANGE,
+                                        1,
+                                        G_MAXINT,
+                                        "framerate",
+                                        GST_TYPE_FRACTION_RANGE,
+                                        0,
+                                        1,
+                                        G_MAXINT,
+                                        1,
+                                        nullptr);
+    return gst_helper::make_ptr(caps);
+}
+
+GstCaps* tcamconvert::lossless::to_encoded_caps(GstCaps* raw_caps)
+{
+    GstCaps* res_caps = gst_caps_new_empty();
+
+    for (guint i = 0; i < gst_caps_get_size(raw_caps); ++i)
+    {
+        const GstStructure* structure = gst_caps_get_structure(raw_caps, i);
+
+        for (auto fcc : gst_helper::convert_GstStructure_to_fcc_list(*structure))
+        {
+            if (!codec::is_supported_fcc(fcc))
+            {
+                continue;
+            }
+            auto caps_fmt = img_lib::gst::fourcc_to_gst_caps_descr(fcc);
+            if (!caps_fmt.gst_struct_name)
+            {
+                continue;
+            }
+
+            // keeps width, height, framerate etc.
+            GstStructure* tmp_struc = gst_structure_copy(structure);
+
+            gst_structure_set_name(tmp_struc, encoded_caps_name);
+            gst_structure_remove_field(tmp_struc, "format");
+            gst_structure_set(
+                tmp_struc, "raw-type", G_TYPE_STRING, caps_fmt.gst_struct_name, nullptr);
+            if (caps_fmt.format_entry)
+            {
+                gst_structure_set(
+                    tmp_struc, "raw-format", G_TYPE_STRING, caps_fmt.format_entry, nullptr);
+            }
+
+            gst_caps_append_structure(res_caps, tmp_struc);
+        }
+    }
+    return res_caps;
+}
+
+GstCaps* tcamconvert::lossless::to_raw_caps(GstCaps* encoded_caps)
+{
+    GstCaps* res_caps = gst_caps_new_empty();
+
+    const auto supported_fccs = get_supported_fccs();
+
+    for (guint i = 0; i < gst_caps_get_size(encoded_caps); ++i)
+    {
+        const GstStructure* structure = gst_caps_get_structure(encoded_caps, i);
+        if (!gst_structure_has_name(structure, encoded_caps_name))
+        {
+            continue;
+        }
+
+        // unset in the template caps, then every supported format is possible
+        const char* raw_type = gst_structure_get_string(structure, "raw-type");
+        const char* raw_format = gst_structure_get_string(structure, "raw-format");
+
+        for (auto fcc : supported_fccs)
+        {
+            auto caps_fmt = img_lib::gst::fourcc_to_gst_caps_descr(fcc);
+            if (!caps_fmt.gst_struct_name)
+            {
+                continue;
+            }
+            if (raw_type && strcmp(raw_type, caps_fmt.gst_struct_name) != 0)
+            {
+                continue;
+            }
+            if (raw_format
+                && (!caps_fmt.format_entry || strcmp(raw_format, caps_fmt.format_entry) != 0))
+            {
+                continue;
+            }
+
+            GstStructure* tmp_struc = gst_structure_copy(structure);
+
+            gst_structure_remove_fields(tmp_struc, "raw-type", "raw-format", nullptr);
+            gst_structure_set_name(tmp_struc, caps_fmt.gst_struct_name);
+            if (caps_fmt.format_entry)
+            {
+                gst_structure_set(
+                    tmp_struc, "format", G_TYPE_STRING, caps_fmt.format_entry, nullptr);
+            }
+
+            gst_caps_append_structure(res_caps, tmp_struc);
+        }
+    }
+    return res_caps;
+}
+
+auto tcamconvert::lossless::get_raw_type_from_encoded_caps(GstCaps& encoded_caps) -> img::img_type
+{
+    GstCaps* raw_caps = to_raw_caps(&encoded_caps);
+    if (gst_caps_get_size(raw_caps) != 1)
+    {
+        gst_caps_unref(raw_caps);
+        return {};
+    }
+
+    auto type = gst_helper::get_img_type_from_fixated_gstcaps(*raw_caps);
+    gst_caps_unref(raw_caps);
+    return type;
+}
+
+#if !defined DUTILS_ARCH_ARM
+static bool has_avx2() noexcept
+{
+    static const bool rval = (img_lib::cpu::get_features() & img::cpu::CPU_AVX2) != 0;
+    return rval;
+}
+#endif
+
+auto tcamconvert::lossless::select_encode(const img::img_type& type)
+    -> img_filter::codec::lossless::encode_function_type
+{
+#if !defined DUTILS_ARCH_ARM
+    if (has_avx2())
+    {
+        if (auto func = codec::get_encode_avx2(type))
+        {
+            return func;
+        }
+    }
+#endif
+    return codec::get_encode_c(type);
+}
+
+auto tcamconvert::lossless::select_decode(const img::img_type& type)
+    -> img_filter::codec::lossless::decode_function_type
+{
+#if !defined DUTILS_ARCH_ARM
+    if (has_avx2())
+    {
+        if (auto func = codec::get_decode_avx2(type))
+        {
+            return func;
+        }
+    }
+#endif
+    return codec::get_decode_c(type);
+}
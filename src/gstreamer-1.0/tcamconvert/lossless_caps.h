@@ -0,0 +1,51 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../../libs/dutils_image/src/dutils_img_filter/codec/lossless/lossless_codec.h"
+
+#include <dutils_img/dutils_img.h>
+#include <gst-helper/gst_ptr.h>
+#include <gst/gst.h>
+#include <vector>
+
+/*
+ * Shared between tcamlosslessenc and tcamlosslessdec.
+ *
+ * The encoded caps keep all fields of the raw caps (width, height, framerate, ...),
+ * the name of the raw structure and its format are moved into "raw-type" and "raw-format".
+ */
+
+namespace tcamconvert::lossless
+{
+constexpr const char* encoded_caps_name = "image/x-tcam-lossless";
+
+auto get_supported_fccs() -> std::vector<img::fourcc>;
+
+auto generate_encoded_template_caps() -> gst_helper::gst_ptr<GstCaps>;
+
+// raw to encoded caps for the src pad direction of the encoder, encoded to raw for the decoder
+GstCaps* to_encoded_caps(GstCaps* raw_caps);
+GstCaps* to_raw_caps(GstCaps* encoded_caps);
+
+// empty when the fixated encoded caps do not describe a supported raw type
+auto get_raw_type_from_encoded_caps(GstCaps& encoded_caps) -> img::img_type;
+
+// the avx2 variants when the cpu supports them
+auto select_encode(const img::img_type& type) -> img_filter::codec::lossless::encode_function_type;
+auto select_decode(const img::img_type& type) -> img_filter::codec::lossless::decode_function_type;
+} // namespace tcamconvert::lossless
@@ -0,0 +1,838 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "m2m_transform.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+
+// /dev/video0 to /dev/video63 are probed for "auto"
+constexpr int max_probed_device_index = 64;
+constexpr int dequeue_timeout_ms = 1000;
+
+int xioctl(int fd, unsigned long request, void* arg)
+{
+    int ret;
+    do
+    {
+        ret = ioctl(fd, request, arg);
+    } while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+std::string to_error_string(const char* what)
+{
+    return std::string(what) + " failed: " + strerror(errno);
+}
+
+std::string fourcc_to_string(uint32_t fcc)
+{
+    const char str[] = { static_cast<char>(fcc & 0xFF),
+                         static_cast<char>((fcc >> 8) & 0xFF),
+                         static_cast<char>((fcc >> 16) & 0xFF),
+                         static_cast<char>((fcc >> 24) & 0xFF) };
+    return std::string(str, sizeof(str));
+}
+
+// the 10/12 bit formats of both have the value in the low bits of a 16 bit container
+uint32_t to_v4l2_src_fcc(img::fourcc fcc) noexcept
+{
+    switch (fcc)
+    {
+        case img::fourcc::BGGR8:
+            return V4L2_PIX_FMT_SBGGR8;
+        case img::fourcc::GBRG8:
+            return V4L2_PIX_FMT_SGBRG8;
+        case img::fourcc::GRBG8:
+            return V4L2_PIX_FMT_SGRBG8;
+        case img::fourcc::RGGB8:
+            return V4L2_PIX_FMT_SRGGB8;
+        case img::fourcc::BGGR10:
+            return V4L2_PIX_FMT_SBGGR10;
+        case img::fourcc::GBRG10:
+            return V4L2_PIX_FMT_SGBRG10;
+        case img::fourcc::GRBG10:
+            return V4L2_PIX_FMT_SGRBG10;
+        case img::fourcc::RGGB10:
+            return V4L2_PIX_FMT_SRGGB10;
+        case img::fourcc::BGGR12:
+            return V4L2_PIX_FMT_SBGGR12;
+        case img::fourcc::GBRG12:
+            return V4L2_PIX_FMT_SGBRG12;
+        case img::fourcc::GRBG12:
+            return V4L2_PIX_FMT_SGRBG12;
+        case img::fourcc::RGGB12:
+            return V4L2_PIX_FMT_SRGGB12;
+        case img::fourcc::BGGR16:
+            return V4L2_PIX_FMT_SBGGR16;
+        case img::fourcc::GBRG16:
+            return V4L2_PIX_FMT_SGBRG16;
+        case img::fourcc::GRBG16:
+            return V4L2_PIX_FMT_SGRBG16;
+        case img::fourcc::RGGB16:
+            return V4L2_PIX_FMT_SRGGB16;
+        default:
+            return 0;
+    }
+}
+
+uint32_t to_v4l2_dst_fcc(img::fourcc fcc) noexcept
+{
+    switch (fcc)
+    {
+        // memory order b, g, r, x
+        case img::fourcc::BGRA32:
+            return V4L2_PIX_FMT_XBGR32;
+        case img::fourcc::NV12:
+            return V4L2_PIX_FMT_NV12;
+        case img::fourcc::YUY2:
+            return V4L2_PIX_FMT_YUYV;
+        default:
+            return 0;
+    }
+}
+
+bool is_yuv_fcc(img::fourcc fcc) noexcept
+{
+    return fcc == img::fourcc::NV12 || fcc == img::fourcc::YUY2;
+}
+
+bool has_format(int fd, v4l2_buf_type type, uint32_t pixelformat)
+{
+    v4l2_fmtdesc desc = {};
+    desc.type = type;
+    for (desc.index = 0; xioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; ++desc.index)
+    {
+        if (desc.pixelformat == pixelformat)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// line of the image as the cpu kernels address it, BGRA32 is bottom up unless already flipped
+uint8_t* get_line(const img::img_descriptor& desc, int plane, int y) noexcept
+{
+    if (img::is_bottom_up_fcc(desc.fourcc_type())
+        && !(desc.flags & img::img_descriptor::flags_no_flip))
+    {
+        y = desc.dim.cy - 1 - y;
+    }
+    const auto p = desc.plane(plane);
+    return static_cast<uint8_t*>(p.plane_ptr) + static_cast<ptrdiff_t>(y) * p.pitch;
+}
+
+struct plane_layout
+{
+    int lines = 0;
+    int line_length = 0;
+};
+
+// NV12 is the only format with two planes, the uv plane follows the luma plane in one buffer
+int get_plane_count(img::fourcc fcc) noexcept
+{
+    return fcc == img::fourcc::NV12 ? 2 : 1;
+}
+
+plane_layout get_plane_layout(const img::img_type& type, int plane) noexcept
+{
+    if (plane == 0)
+    {
+        return { type.dim.cy, img::calc_minimum_pitch(type) };
+    }
+    return { type.dim.cy / 2, type.dim.cx };
+}
+
+struct control_range
+{
+    bool available = false;
+    int32_t minimum = 0;
+    int32_t maximum = 0;
+    int32_t default_value = 0;
+    // last value that was set, avoids an ioctl for every frame
+    int32_t current = 0;
+};
+
+control_range query_control(int fd, uint32_t id)
+{
+    v4l2_queryctrl qctrl = {};
+    qctrl.id = id;
+    if (xioctl(fd, VIDIOC_QUERYCTRL, &qctrl) != 0 || (qctrl.flags & V4L2_CTRL_FLAG_DISABLED)
+        || qctrl.type != V4L2_CTRL_TYPE_INTEGER || qctrl.default_value <= 0)
+    {
+        return {};
+    }
+
+    v4l2_control ctrl = {};
+    ctrl.id = id;
+    if (xioctl(fd, VIDIOC_G_CTRL, &ctrl) != 0)
+    {
+        return {};
+    }
+    return { true, qctrl.minimum, qctrl.maximum, qctrl.default_value, ctrl.value };
+}
+
+// state of an opened device, only touched by the streaming thread
+struct m2m_device
+{
+    struct queue
+    {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        uint32_t bytesperline = 0;
+        uint32_t sizeimage = 0;
+
+        v4l2_memory memory = V4L2_MEMORY_MMAP;
+        bool allocated = false;
+        bool streaming = false;
+
+        // the single mmap buffer, used when the frames are copied
+        void* mapping = MAP_FAILED;
+        size_t mapping_length = 0;
+    };
+
+    int fd = -1;
+    bool mplane = false;
+    std::string device_path;
+    std::string card;
+
+    queue output; // source images
+    queue capture; // converted images
+
+    img::img_type src_type;
+    img::img_type dst_type;
+
+    control_range red_balance;
+    control_range blue_balance;
+
+    m2m_device() = default;
+    m2m_device(const m2m_device&) = delete;
+    m2m_device& operator=(const m2m_device&) = delete;
+
+    ~m2m_device()
+    {
+        release_queue(output);
+        release_queue(capture);
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+
+    void release_queue(queue& q)
+    {
+        if (fd == -1)
+        {
+            return;
+        }
+        if (q.streaming)
+        {
+            int type = q.type;
+            xioctl(fd, VIDIOC_STREAMOFF, &type);
+            q.streaming = false;
+        }
+        if (q.mapping != MAP_FAILED)
+        {
+            munmap(q.mapping, q.mapping_length);
+            q.mapping = MAP_FAILED;
+        }
+        if (q.allocated)
+        {
+            v4l2_requestbuffers req = {};
+            req.count = 0;
+            req.type = q.type;
+            req.memory = q.memory;
+            xioctl(fd, VIDIOC_REQBUFS, &req);
+            q.allocated = false;
+        }
+    }
+
+    // returns the buffers of both queues, e.g. after a failed conversion
+    void stop_streaming()
+    {
+        for (auto* q : { &output, &capture })
+        {
+            if (q->streaming)
+            {
+                int type = q->type;
+                xioctl(fd, VIDIOC_STREAMOFF, &type);
+                q->streaming = false;
+            }
+        }
+    }
+
+    void fill_buffer(const queue& q, v4l2_buffer& buf, v4l2_plane& plane, int dmabuf_fd) const
+    {
+        buf.type = q.type;
+        buf.memory = q.memory;
+        buf.index = 0;
+        buf.field = V4L2_FIELD_NONE;
+
+        const uint32_t bytesused = q.type == output.type ? q.sizeimage : 0;
+        if (mplane)
+        {
+            buf.m.planes = &plane;
+            buf.length = 1;
+            plane.length = q.sizeimage;
+            plane.bytesused = bytesused;
+            if (q.memory == V4L2_MEMORY_DMABUF)
+            {
+                plane.m.fd = dmabuf_fd;
+            }
+        }
+        else
+        {
+            buf.length = q.sizeimage;
+            buf.bytesused = bytesused;
+            if (q.memory == V4L2_MEMORY_DMABUF)
+            {
+                buf.m.fd = dmabuf_fd;
+            }
+        }
+    }
+};
+
+// opens path when it is a mem2mem device that converts src_fcc to dst_fcc
+bool open_device(m2m_device& d, const std::string& path, uint32_t src_fcc, uint32_t dst_fcc)
+{
+    const int fd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+    d.fd = fd;
+    d.device_path = path;
+
+    v4l2_capability cap = {};
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap) != 0)
+    {
+        return false;
+    }
+    const uint32_t caps =
+        (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_STREAMING))
+    {
+        return false;
+    }
+    if (caps & V4L2_CAP_VIDEO_M2M_MPLANE)
+    {
+        d.mplane = true;
+        d.output.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+        d.capture.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    }
+    else if (caps & V4L2_CAP_VIDEO_M2M)
+    {
+        d.output.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        d.capture.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (!has_format(fd, d.output.type, src_fcc) || !has_format(fd, d.capture.type, dst_fcc))
+    {
+        return false;
+    }
+    d.card = reinterpret_cast<const char*>(cap.card);
+    return true;
+}
+
+void set_colorimetry(v4l2_format& fmt,
+                     bool mplane,
+                     img::fourcc dst_fcc,
+                     const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    using matrix_type = img_filter::transform::by_edge::yuv_colorimetry::matrix_type;
+
+    uint32_t colorspace = V4L2_COLORSPACE_SRGB;
+    uint32_t ycbcr_enc = V4L2_YCBCR_ENC_DEFAULT;
+    uint32_t quantization = V4L2_QUANTIZATION_DEFAULT;
+    if (is_yuv_fcc(dst_fcc))
+    {
+        const bool bt709 = yuv_colorimetry.matrix == matrix_type::bt709;
+        colorspace = bt709 ? V4L2_COLORSPACE_REC709 : V4L2_COLORSPACE_SMPTE170M;
+        ycbcr_enc = bt709 ? V4L2_YCBCR_ENC_709 : V4L2_YCBCR_ENC_601;
+        quantization =
+            yuv_colorimetry.full_range ? V4L2_QUANTIZATION_FULL_RANGE : V4L2_QUANTIZATION_LIM_RANGE;
+    }
+    if (mplane)
+    {
+        fmt.fmt.pix_mp.colorspace = colorspace;
+        fmt.fmt.pix_mp.ycbcr_enc = ycbcr_enc;
+        fmt.fmt.pix_mp.quantization = quantization;
+    }
+    else
+    {
+        fmt.fmt.pix.colorspace = colorspace;
+        fmt.fmt.pix.ycbcr_enc = ycbcr_enc;
+        fmt.fmt.pix.quantization = quantization;
+    }
+}
+
+// the driver may change the pitch, but not the format or the size of the image
+bool set_format(m2m_device& d,
+                m2m_device::queue& q,
+                uint32_t pixelformat,
+                const img::img_type& type,
+                const img_filter::transform::by_edge::yuv_colorimetry* yuv_colorimetry,
+                std::string& error)
+{
+    const auto width = static_cast<uint32_t>(type.dim.cx);
+    const auto height = static_cast<uint32_t>(type.dim.cy);
+    const auto pitch = static_cast<uint32_t>(img::calc_minimum_pitch(type));
+
+    v4l2_format fmt = {};
+    fmt.type = q.type;
+    if (d.mplane)
+    {
+        fmt.fmt.pix_mp.width = width;
+        fmt.fmt.pix_mp.height = height;
+        fmt.fmt.pix_mp.pixelformat = pixelformat;
+        fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+        fmt.fmt.pix_mp.num_planes = 1;
+        fmt.fmt.pix_mp.plane_fmt[0].bytesperline = pitch;
+    }
+    else
+    {
+        fmt.fmt.pix.width = width;
+        fmt.fmt.pix.height = height;
+        fmt.fmt.pix.pixelformat = pixelformat;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        fmt.fmt.pix.bytesperline = pitch;
+    }
+    if (yuv_colorimetry)
+    {
+        set_colorimetry(fmt, d.mplane, type.fourcc_type(), *yuv_colorimetry);
+    }
+
+    const v4l2_format requested = fmt;
+    if (xioctl(d.fd, VIDIOC_S_FMT, &fmt) != 0)
+    {
+        error = to_error_string("VIDIOC_S_FMT");
+        return false;
+    }
+
+    if (d.mplane)
+    {
+        const auto& pix = fmt.fmt.pix_mp;
+        if (pix.width != width || pix.height != height || pix.pixelformat != pixelformat
+            || pix.num_planes != 1 || pix.plane_fmt[0].bytesperline < pitch)
+        {
+            error = "Device does not accept the format " + fourcc_to_string(pixelformat);
+            return false;
+        }
+        q.bytesperline = pix.plane_fmt[0].bytesperline;
+        q.sizeimage = pix.plane_fmt[0].sizeimage;
+    }
+    else
+    {
+        const auto& pix = fmt.fmt.pix;
+        if (pix.width != width || pix.height != height || pix.pixelformat != pixelformat
+            || pix.bytesperline < pitch)
+        {
+            error = "Device does not accept the format " + fourcc_to_string(pixelformat);
+            return false;
+        }
+        q.bytesperline = pix.bytesperline;
+        q.sizeimage = pix.sizeimage;
+    }
+
+    // a device that cannot produce the requested yuv matrix or range would change the colors
+    if (yuv_colorimetry && is_yuv_fcc(type.fourcc_type()))
+    {
+        const bool same = d.mplane ? (fmt.fmt.pix_mp.ycbcr_enc == requested.fmt.pix_mp.ycbcr_enc
+                                      && fmt.fmt.pix_mp.quantization
+                                             == requested.fmt.pix_mp.quantization)
+                                   : (fmt.fmt.pix.ycbcr_enc == requested.fmt.pix.ycbcr_enc
+                                      && fmt.fmt.pix.quantization
+                                             == requested.fmt.pix.quantization);
+        if (!same)
+        {
+            error = "Device does not support the requested yuv colorimetry";
+            return false;
+        }
+    }
+
+    uint32_t min_size = 0;
+    for (int plane = 0; plane < get_plane_count(type.fourcc_type()); ++plane)
+    {
+        min_size += q.bytesperline * get_plane_layout(type, plane).lines;
+    }
+    if (q.sizeimage < min_size)
+    {
+        error = "Device reports an unexpected buffer size for " + fourcc_to_string(pixelformat);
+        return false;
+    }
+    return true;
+}
+
+// (re)allocates the single buffer of the queue when the memory type changes
+bool prepare_queue(m2m_device& d, m2m_device::queue& q, v4l2_memory memory, std::string& error)
+{
+    if (q.allocated && q.memory == memory)
+    {
+        return true;
+    }
+    d.release_queue(q);
+
+    v4l2_requestbuffers req = {};
+    req.count = 1;
+    req.type = q.type;
+    req.memory = memory;
+    if (xioctl(d.fd, VIDIOC_REQBUFS, &req) != 0 || req.count < 1)
+    {
+        error = to_error_string("VIDIOC_REQBUFS");
+        return false;
+    }
+    q.memory = memory;
+    q.allocated = true;
+
+    if (memory == V4L2_MEMORY_MMAP)
+    {
+        v4l2_buffer buf = {};
+        v4l2_plane plane = {};
+        buf.type = q.type;
+        buf.memory = memory;
+        buf.index = 0;
+        if (d.mplane)
+        {
+            buf.m.planes = &plane;
+            buf.length = 1;
+        }
+        if (xioctl(d.fd, VIDIOC_QUERYBUF, &buf) != 0)
+        {
+            error = to_error_string("VIDIOC_QUERYBUF");
+            return false;
+        }
+        const size_t length = d.mplane ? plane.length : buf.length;
+        const off_t offset = d.mplane ? plane.m.mem_offset : buf.m.offset;
+
+        q.mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, d.fd, offset);
+        if (q.mapping == MAP_FAILED)
+        {
+            error = to_error_string("mmap");
+            return false;
+        }
+        q.mapping_length = length;
+    }
+    return true;
+}
+
+bool start_queue(m2m_device& d, m2m_device::queue& q, std::string& error)
+{
+    if (q.streaming)
+    {
+        return true;
+    }
+    int type = q.type;
+    if (xioctl(d.fd, VIDIOC_STREAMON, &type) != 0)
+    {
+        error = to_error_string("VIDIOC_STREAMON");
+        return false;
+    }
+    q.streaming = true;
+    return true;
+}
+
+// the frame is used as it is when every line is where the device expects it
+bool can_import(const img::img_descriptor& desc,
+                const img::img_type& type,
+                const m2m_device::queue& q,
+                const tcamconvert::dmabuf_view& buf) noexcept
+{
+    if (buf.fd < 0 || buf.mapped == nullptr || buf.size < q.sizeimage)
+    {
+        return false;
+    }
+    for (int plane = 0; plane < get_plane_count(type.fourcc_type()); ++plane)
+    {
+        const auto layout = get_plane_layout(type, plane);
+        const uint8_t* expected =
+            buf.mapped + static_cast<size_t>(plane) * q.bytesperline * type.dim.cy;
+        if (layout.lines == 0)
+        {
+            continue;
+        }
+        if (get_line(desc, plane, 0) != expected
+            || get_line(desc, plane, layout.lines - 1)
+                   != expected + static_cast<size_t>(layout.lines - 1) * q.bytesperline)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void copy_to_device(const img::img_descriptor& src,
+                    const img::img_type& type,
+                    m2m_device::queue& q)
+{
+    auto* dst = static_cast<uint8_t*>(q.mapping);
+    for (int plane = 0; plane < get_plane_count(type.fourcc_type()); ++plane)
+    {
+        const auto layout = get_plane_layout(type, plane);
+        for (int y = 0; y < layout.lines; ++y)
+        {
+            memcpy(dst + static_cast<size_t>(y) * q.bytesperline,
+                   get_line(src, plane, y),
+                   layout.line_length);
+        }
+        dst += static_cast<size_t>(q.bytesperline) * type.dim.cy;
+    }
+}
+
+void copy_from_device(const img::img_descriptor& dst,
+                      const img::img_type& type,
+                      m2m_device::queue& q)
+{
+    const auto* src = static_cast<const uint8_t*>(q.mapping);
+    for (int plane = 0; plane < get_plane_count(type.fourcc_type()); ++plane)
+    {
+        const auto layout = get_plane_layout(type, plane);
+        for (int y = 0; y < layout.lines; ++y)
+        {
+            memcpy(get_line(dst, plane, y),
+                   src + static_cast<size_t>(y) * q.bytesperline,
+                   layout.line_length);
+        }
+        src += static_cast<size_t>(q.bytesperline) * type.dim.cy;
+    }
+}
+
+bool set_control(int fd, uint32_t id, control_range& range, float factor)
+{
+    const auto value = static_cast<int32_t>(std::clamp(
+        std::lround(range.default_value * factor),
+        static_cast<long>(range.minimum),
+        static_cast<long>(range.maximum)));
+    if (value == range.current)
+    {
+        return true;
+    }
+    v4l2_control ctrl = {};
+    ctrl.id = id;
+    ctrl.value = value;
+    if (xioctl(fd, VIDIOC_S_CTRL, &ctrl) != 0)
+    {
+        return false;
+    }
+    range.current = value;
+    return true;
+}
+
+// waits until the device has a buffer of the queue ready and dequeues it
+bool dequeue(m2m_device& d, m2m_device::queue& q, std::string& error)
+{
+    v4l2_buffer buf = {};
+    v4l2_plane plane = {};
+    buf.type = q.type;
+    buf.memory = q.memory;
+    if (d.mplane)
+    {
+        buf.m.planes = &plane;
+        buf.length = 1;
+    }
+
+    while (xioctl(d.fd, VIDIOC_DQBUF, &buf) != 0)
+    {
+        if (errno != EAGAIN)
+        {
+            error = to_error_string("VIDIOC_DQBUF");
+            return false;
+        }
+        pollfd pfd = { d.fd, static_cast<short>(q.type == d.output.type ? POLLOUT : POLLIN), 0 };
+        const int ret = poll(&pfd, 1, dequeue_timeout_ms);
+        if (ret == 0)
+        {
+            error = "Timeout while waiting for the mem2mem device";
+            return false;
+        }
+        if (ret < 0 && errno != EINTR)
+        {
+            error = to_error_string("poll");
+            return false;
+        }
+    }
+    if (buf.flags & V4L2_BUF_FLAG_ERROR)
+    {
+        error = "The mem2mem device reported an error for the frame";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+struct tcamconvert::m2m_transform_context::impl : m2m_device
+{
+};
+
+tcamconvert::m2m_transform_context::m2m_transform_context() = default;
+tcamconvert::m2m_transform_context::~m2m_transform_context() = default;
+
+bool tcamconvert::m2m_transform_context::setup(
+    const std::string& device,
+    img::img_type src_type,
+    img::img_type dst_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    kernel_description_.clear();
+    impl_.reset();
+
+    const uint32_t src_fcc = to_v4l2_src_fcc(src_type.fourcc_type());
+    const uint32_t dst_fcc = to_v4l2_dst_fcc(dst_type.fourcc_type());
+    if (src_fcc == 0 || dst_fcc == 0 || src_type.dim != dst_type.dim || src_type.dim.cx < 2
+        || src_type.dim.cy < 2)
+    {
+        last_error_ = "Conversion is not implemented for V4L2 mem2mem devices";
+        return false;
+    }
+
+    // a failed probe closes the device again
+    auto try_open = [src_fcc, dst_fcc](const std::string& path)
+    {
+        auto tmp = std::make_unique<impl>();
+        if (!open_device(*tmp, path, src_fcc, dst_fcc))
+        {
+            tmp.reset();
+        }
+        return tmp;
+    };
+
+    std::unique_ptr<impl> d;
+    if (device == "auto")
+    {
+        for (int i = 0; i < max_probed_device_index && !d; ++i)
+        {
+            d = try_open("/dev/video" + std::to_string(i));
+        }
+    }
+    else
+    {
+        d = try_open(device);
+    }
+    if (!d)
+    {
+        last_error_ = "No V4L2 mem2mem device converts " + fourcc_to_string(src_fcc) + " to "
+                      + fourcc_to_string(dst_fcc);
+        return false;
+    }
+
+    if (!set_format(*d, d->output, src_fcc, src_type, nullptr, last_error_)
+        || !set_format(*d, d->capture, dst_fcc, dst_type, &yuv_colorimetry, last_error_))
+    {
+        last_error_ = d->device_path + ": " + last_error_;
+        return false;
+    }
+
+    d->src_type = src_type;
+    d->dst_type = dst_type;
+    d->red_balance = query_control(d->fd, V4L2_CID_RED_BALANCE);
+    d->blue_balance = query_control(d->fd, V4L2_CID_BLUE_BALANCE);
+
+    kernel_description_ = "v4l2-m2m(" + d->card + ", " + d->device_path
+                          + "): " + fourcc_to_string(src_fcc) + "_to_" + fourcc_to_string(dst_fcc);
+    impl_ = std::move(d);
+    return true;
+}
+
+bool tcamconvert::m2m_transform_context::transform(const img::img_descriptor& src,
+                                                   const img::img_descriptor& dst,
+                                                   const img_filter::whitebalance_params& params,
+                                                   const dmabuf_view& src_buf,
+                                                   const dmabuf_view& dst_buf)
+{
+    if (!impl_ || kernel_description_.empty())
+    {
+        return false;
+    }
+    auto& d = *impl_;
+
+    const auto wb = img_filter::normalize(params);
+    const float green = (wb.wb_gr + wb.wb_gb) / 2.f;
+    const float red = green > 0.f ? wb.wb_rr / green : 1.f;
+    const float blue = green > 0.f ? wb.wb_bb / green : 1.f;
+    if (d.red_balance.available && d.blue_balance.available)
+    {
+        if (!set_control(d.fd, V4L2_CID_RED_BALANCE, d.red_balance, red)
+            || !set_control(d.fd, V4L2_CID_BLUE_BALANCE, d.blue_balance, blue))
+        {
+            last_error_ = to_error_string("VIDIOC_S_CTRL");
+            return false;
+        }
+    }
+    else if (std::abs(red - 1.f) > 0.001f || std::abs(blue - 1.f) > 0.001f)
+    {
+        last_error_ = d.device_path + " has no white balance controls";
+        return false;
+    }
+
+    const bool import_src = can_import(src, d.src_type, d.output, src_buf);
+    const bool import_dst = can_import(dst, d.dst_type, d.capture, dst_buf);
+
+    if (!prepare_queue(d, d.output, import_src ? V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP, last_error_)
+        || !prepare_queue(
+            d, d.capture, import_dst ? V4L2_MEMORY_DMABUF : V4L2_MEMORY_MMAP, last_error_))
+    {
+        d.stop_streaming();
+        return false;
+    }
+
+    if (!import_src)
+    {
+        copy_to_device(src, d.src_type, d.output);
+    }
+
+    v4l2_buffer out_buf = {};
+    v4l2_plane out_plane = {};
+    d.fill_buffer(d.output, out_buf, out_plane, src_buf.fd);
+
+    v4l2_buffer cap_buf = {};
+    v4l2_plane cap_plane = {};
+    d.fill_buffer(d.capture, cap_buf, cap_plane, dst_buf.fd);
+
+    if (xioctl(d.fd, VIDIOC_QBUF, &cap_buf) != 0 || xioctl(d.fd, VIDIOC_QBUF, &out_buf) != 0)
+    {
+        last_error_ = to_error_string("VIDIOC_QBUF");
+        d.stop_streaming();
+        return false;
+    }
+
+    if (!start_queue(d, d.capture, last_error_) || !start_queue(d, d.output, last_error_)
+        || !dequeue(d, d.capture, last_error_) || !dequeue(d, d.output, last_error_))
+    {
+        d.stop_streaming();
+        return false;
+    }
+
+    if (!import_dst)
+    {
+        copy_from_device(dst, d.dst_type, d.capture);
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/dutils_img_filter_params.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+#include <memory>
+#include <string>
+
+namespace tcamconvert
+{
+// a dmabuf backed frame, mapped is the start of the buffer in the cpu mapping
+struct dmabuf_view
+{
+    int fd = -1;
+    const uint8_t* mapped = nullptr;
+    size_t size = 0;
+};
+
+/*
+ * Conversion on a V4L2 mem2mem device, e.g. the ISP or 2D engine of an embedded SoC.
+ *
+ * Supported are bayer 8/10/12/16-bit sources to BGRx, NV12 and YUY2.
+ * The white balance is set through V4L2_CID_RED_BALANCE and V4L2_CID_BLUE_BALANCE relative to
+ * green, the default value of a control is taken as 1.0.
+ * Frames are passed as DMABUF when their layout matches the device format,
+ * otherwise they are copied from and to the mmap buffers of the device.
+ * Only built with TCAM_BUILD_V4L2_M2M, dmabuf_view is always available.
+ */
+class m2m_transform_context
+{
+public:
+    m2m_transform_context();
+    ~m2m_transform_context();
+
+    m2m_transform_context(const m2m_transform_context&) = delete;
+    m2m_transform_context& operator=(const m2m_transform_context&) = delete;
+
+    // device is a node like /dev/video12 or "auto" to probe all /dev/video* nodes
+    // false when no device implements the conversion, see last_error()
+    bool setup(const std::string& device,
+               img::img_type src_type,
+               img::img_type dst_type,
+               const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry);
+
+    // returns false when a V4L2 call failed, dst is undefined in that case
+    bool transform(const img::img_descriptor& src,
+                   const img::img_descriptor& dst,
+                   const img_filter::whitebalance_params& params,
+                   const dmabuf_view& src_buf = {},
+                   const dmabuf_view& dst_buf = {});
+
+    const std::string& kernel_description() const noexcept
+    {
+        return kernel_description_;
+    }
+    const std::string& last_error() const noexcept
+    {
+        return last_error_;
+    }
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+
+    std::string kernel_description_;
+    std::string last_error_;
+};
+} // namespace tcamconvert
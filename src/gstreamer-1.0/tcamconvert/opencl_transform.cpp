@@ -0,0 +1,515 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CL_TARGET_OPENCL_VERSION 120
+
+#include "opencl_transform.h"
+
+#include <CL/cl.h>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+
+// The kernels reproduce the c implementations of the wb/unpack and by8_to_bgra (edge, no avg green) functions
+static const char* opencl_kernel_source = R"CLC(
+// wb contains the factors of the 2x2 cell x0y0, x1y0, x0y1, x1y1, 64 ^= 1.0
+inline uint wb_factor(int x, int y, int4 wb)
+{
+    if (y & 1)
+    {
+        return (x & 1) ? wb.w : wb.z;
+    }
+    return (x & 1) ? wb.y : wb.x;
+}
+
+// 16 bit containers with the value in the low bits, shift expands them to 16 bit
+__kernel void fcc16_to_fcc8_wb(__global const uchar* src, int src_pitch, int shift,
+                               __global uchar* dst, int dst_pitch,
+                               int dim_x, int dim_y, int4 wb)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= dim_x || y >= dim_y)
+    {
+        return;
+    }
+
+    const uint val = (uint)((__global const ushort*)(src + y * src_pitch))[x] << shift;
+    dst[y * dst_pitch + x] = (uchar)min((val * wb_factor(x, y, wb)) >> 14, 0xFFu);
+}
+
+__kernel void fcc8_wb(__global const uchar* src, int src_pitch,
+                      __global uchar* dst, int dst_pitch,
+                      int dim_x, int dim_y, int4 wb)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= dim_x || y >= dim_y)
+    {
+        return;
+    }
+
+    const uint val = src[y * src_pitch + x];
+    dst[y * dst_pitch + x] = (uchar)min((val * wb_factor(x, y, wb)) >> 6, 0xFFu);
+}
+
+// the outermost columns are copies of their inner neighbours and the lines are mirrored at the borders
+__kernel void by8_to_bgra(__global const uchar* src, int src_pitch,
+                          __global uchar* dst, int dst_pitch,
+                          int dim_x, int dim_y,
+                          int red_x, int red_y, int flip)
+{
+    const int x = get_global_id(0);
+    const int y = get_global_id(1);
+    if (x >= dim_x || y >= dim_y)
+    {
+        return;
+    }
+
+    const int sx = clamp(x, 1, dim_x - 2);
+    const int y_prev = y == 0 ? 1 : y - 1;
+    const int y_next = y == dim_y - 1 ? dim_y - 2 : y + 1;
+
+    __global const uchar* prv = src + y_prev * src_pitch + sx;
+    __global const uchar* cur = src + y * src_pitch + sx;
+    __global const uchar* nxt = src + y_next * src_pitch + sx;
+
+    const int c = cur[0];
+    const int lr = (cur[-1] + cur[1]) / 2;
+    const int ob = (prv[0] + nxt[0]) / 2;
+
+    const bool on_red_line = (y & 1) == red_y;
+    const bool on_red_column = (sx & 1) == red_x;
+
+    int r;
+    int g;
+    int b;
+    if (on_red_line == on_red_column)
+    {
+        const int dh = abs(cur[-1] - cur[1]);
+        const int dv = abs(prv[0] - nxt[0]);
+        if (dh < dv)
+        {
+            g = lr;
+        }
+        else if (dh > dv)
+        {
+            g = ob;
+        }
+        else
+        {
+            g = (cur[-1] + cur[1] + prv[0] + nxt[0]) / 4;
+        }
+        const int diag = (prv[-1] + prv[1] + nxt[-1] + nxt[1]) / 4;
+
+        r = on_red_line ? c : diag;
+        b = on_red_line ? diag : c;
+    }
+    else
+    {
+        g = c;
+        r = on_red_line ? lr : ob;
+        b = on_red_line ? ob : lr;
+    }
+
+    const int out_y = flip ? dim_y - 1 - y : y;
+    vstore4((uchar4)((uchar)b, (uchar)g, (uchar)r, 0xFF), x, dst + out_y * dst_pitch);
+}
+)CLC";
+
+template<class T, cl_int (*Release)(T)> struct cl_releaser
+{
+    void operator()(T ptr) const noexcept
+    {
+        Release(ptr);
+    }
+};
+
+template<class T, cl_int (*Release)(T)>
+using cl_ptr = std::unique_ptr<std::remove_pointer_t<T>, cl_releaser<T, Release>>;
+
+using context_ptr = cl_ptr<cl_context, clReleaseContext>;
+using queue_ptr = cl_ptr<cl_command_queue, clReleaseCommandQueue>;
+using program_ptr = cl_ptr<cl_program, clReleaseProgram>;
+using kernel_ptr = cl_ptr<cl_kernel, clReleaseKernel>;
+using mem_ptr = cl_ptr<cl_mem, clReleaseMemObject>;
+
+std::string to_error_string(const char* what, cl_int err)
+{
+    return std::string(what) + " failed with OpenCL error " + std::to_string(err);
+}
+
+cl_device_id find_gpu_device()
+{
+    cl_uint platform_count = 0;
+    if (clGetPlatformIDs(0, nullptr, &platform_count) != CL_SUCCESS || platform_count == 0)
+    {
+        return nullptr;
+    }
+    std::vector<cl_platform_id> platforms(platform_count);
+    if (clGetPlatformIDs(platform_count, platforms.data(), nullptr) != CL_SUCCESS)
+    {
+        return nullptr;
+    }
+
+    for (auto platform : platforms)
+    {
+        cl_device_id device = nullptr;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) == CL_SUCCESS)
+        {
+            return device;
+        }
+    }
+    return nullptr;
+}
+
+std::string get_device_name(cl_device_id device)
+{
+    size_t len = 0;
+    if (clGetDeviceInfo(device, CL_DEVICE_NAME, 0, nullptr, &len) != CL_SUCCESS || len == 0)
+    {
+        return "unknown device";
+    }
+    std::string name(len, '\0');
+    clGetDeviceInfo(device, CL_DEVICE_NAME, len, name.data(), nullptr);
+    name.resize(name.find('\0'));
+    return name;
+}
+
+// bits of the value in the 16 bit container, 0 for unsupported formats
+int get_fcc16_value_bits(img::fourcc fcc) noexcept
+{
+    if (img::is_by10_fcc(fcc) || fcc == img::fourcc::MONO10)
+    {
+        return 10;
+    }
+    if (img::is_by12_fcc(fcc) || fcc == img::fourcc::MONO12)
+    {
+        return 12;
+    }
+    if (img::is_by16_fcc(fcc) || fcc == img::fourcc::MONO16)
+    {
+        return 16;
+    }
+    return 0;
+}
+
+// max_factor is the clip limit of the cpu implementation, 0xFF for 8 bit and 0x100 for 16 bit sources
+cl_int4 to_wb_factors(img::fourcc fcc,
+                      const img_filter::whitebalance_params& params,
+                      int max_factor) noexcept
+{
+    if (!img::is_bayer_fcc(fcc))
+    {
+        return cl_int4 { { 64, 64, 64, 64 } };
+    }
+
+    const img_filter::bayer_pattern_parameters wb { img::by_transform::convert_bayer_fcc_to_pattern(
+                                                        fcc),
+                                                    img_filter::normalize(params) };
+    auto fac = [max_factor](float val)
+    {
+        return std::clamp(static_cast<int>(val * 64), 0, max_factor);
+    };
+    return cl_int4 { { fac(wb.wb_x0y0), fac(wb.wb_x1y0), fac(wb.wb_x0y1), fac(wb.wb_x1y1) } };
+}
+
+} // namespace
+
+struct tcamconvert::opencl_transform_context::impl
+{
+    cl_device_id device = nullptr;
+    std::string device_name;
+
+    context_ptr context;
+    queue_ptr queue;
+    program_ptr program;
+
+    kernel_ptr unpack_wb_kernel;
+    kernel_ptr debayer_kernel;
+
+    mem_ptr src_buffer;
+    mem_ptr by8_buffer; // only used when debayering
+    mem_ptr dst_buffer;
+
+    img::img_type src_type;
+    img::img_type dst_type;
+    img::img_type by8_type;
+
+    int fcc16_shift = -1; // -1 for bayer8 sources
+};
+
+tcamconvert::opencl_transform_context::opencl_transform_context() = default;
+tcamconvert::opencl_transform_context::~opencl_transform_context() = default;
+
+bool tcamconvert::opencl_transform_context::setup(img::img_type src_type, img::img_type dst_type)
+{
+    kernel_description_.clear();
+
+    const auto src_fcc = src_type.fourcc_type();
+    const auto dst_fcc = dst_type.fourcc_type();
+
+    const bool src_is_fcc8 = img::is_by8_fcc(src_fcc);
+    const int value_bits = get_fcc16_value_bits(src_fcc);
+    if (src_type.dim != dst_type.dim || src_type.dim.cx < 4 || src_type.dim.cy < 2
+        || (!src_is_fcc8 && value_bits == 0))
+    {
+        last_error_ = "Conversion is not implemented for OpenCL";
+        return false;
+    }
+
+    const bool src_is_bayer = img::is_bayer_fcc(src_fcc);
+    const auto fcc8 = src_is_bayer ? img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_fcc)
+                                   : img::fourcc::MONO8;
+    const bool debayer = src_is_bayer && dst_fcc == img::fourcc::BGRA32;
+    if (dst_fcc != fcc8 && !debayer)
+    {
+        last_error_ = "Conversion is not implemented for OpenCL";
+        return false;
+    }
+
+    if (!impl_)
+    {
+        auto tmp = std::make_unique<impl>();
+
+        tmp->device = find_gpu_device();
+        if (!tmp->device)
+        {
+            last_error_ = "No OpenCL GPU device found";
+            return false;
+        }
+        tmp->device_name = get_device_name(tmp->device);
+
+        cl_int err = CL_SUCCESS;
+        tmp->context.reset(clCreateContext(nullptr, 1, &tmp->device, nullptr, nullptr, &err));
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clCreateContext", err);
+            return false;
+        }
+        tmp->queue.reset(clCreateCommandQueue(tmp->context.get(), tmp->device, 0, &err));
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clCreateCommandQueue", err);
+            return false;
+        }
+        tmp->program.reset(
+            clCreateProgramWithSource(tmp->context.get(), 1, &opencl_kernel_source, nullptr, &err));
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clCreateProgramWithSource", err);
+            return false;
+        }
+        err = clBuildProgram(tmp->program.get(), 1, &tmp->device, "", nullptr, nullptr);
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clBuildProgram", err);
+            return false;
+        }
+        impl_ = std::move(tmp);
+    }
+
+    auto& d = *impl_;
+
+    cl_int err = CL_SUCCESS;
+    d.unpack_wb_kernel.reset(
+        clCreateKernel(d.program.get(), src_is_fcc8 ? "fcc8_wb" : "fcc16_to_fcc8_wb", &err));
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clCreateKernel", err);
+        return false;
+    }
+    d.debayer_kernel.reset();
+    if (debayer)
+    {
+        d.debayer_kernel.reset(clCreateKernel(d.program.get(), "by8_to_bgra", &err));
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clCreateKernel", err);
+            return false;
+        }
+    }
+
+    d.src_type = src_type;
+    d.dst_type = dst_type;
+    d.by8_type = img::make_img_type(fcc8, src_type.dim);
+    d.fcc16_shift = src_is_fcc8 ? -1 : 16 - value_bits;
+
+    auto create_buffer = [&d, &err](cl_mem_flags flags, const img::img_type& type)
+    {
+        return mem_ptr(
+            clCreateBuffer(d.context.get(), flags, type.buffer_length, nullptr, &err));
+    };
+
+    d.src_buffer = create_buffer(CL_MEM_READ_ONLY | CL_MEM_HOST_WRITE_ONLY, src_type);
+    if (err == CL_SUCCESS)
+    {
+        d.dst_buffer = create_buffer(CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY, dst_type);
+    }
+    if (err == CL_SUCCESS && debayer)
+    {
+        d.by8_buffer = create_buffer(CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, d.by8_type);
+    }
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clCreateBuffer", err);
+        return false;
+    }
+
+    kernel_description_ = "opencl(" + d.device_name + "): ";
+    kernel_description_ += src_is_fcc8 ? "fcc8_wb" : "fcc16_to_fcc8_wb";
+    if (debayer)
+    {
+        kernel_description_ += ", by8_to_bgra";
+    }
+    return true;
+}
+
+bool tcamconvert::opencl_transform_context::transform(const img::img_descriptor& src,
+                                                      const img::img_descriptor& dst,
+                                                      const img_filter::whitebalance_params& params)
+{
+    if (!impl_ || kernel_description_.empty())
+    {
+        return false;
+    }
+    auto& d = *impl_;
+
+    const int dim_x = d.src_type.dim.cx;
+    const int dim_y = d.src_type.dim.cy;
+
+    const cl_int src_pitch = img::calc_minimum_pitch(d.src_type);
+    const cl_int by8_pitch = img::calc_minimum_pitch(d.by8_type);
+    const cl_int dst_pitch = img::calc_minimum_pitch(d.dst_type);
+
+    // the buffers are used without padding, so the rect copies take care of the pitch of the gstreamer buffers
+    const size_t origin[3] = { 0, 0, 0 };
+    const size_t src_region[3] = { static_cast<size_t>(src_pitch), static_cast<size_t>(dim_y), 1 };
+    cl_int err = clEnqueueWriteBufferRect(d.queue.get(),
+                                          d.src_buffer.get(),
+                                          CL_FALSE,
+                                          origin,
+                                          origin,
+                                          src_region,
+                                          src_pitch,
+                                          0,
+                                          src.pitch(),
+                                          0,
+                                          src.data(),
+                                          0,
+                                          nullptr,
+                                          nullptr);
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clEnqueueWriteBufferRect", err);
+        return false;
+    }
+
+    const size_t global_size[2] = { static_cast<size_t>(dim_x), static_cast<size_t>(dim_y) };
+
+    cl_mem src_mem = d.src_buffer.get();
+    cl_mem by8_mem = d.debayer_kernel ? d.by8_buffer.get() : d.dst_buffer.get();
+    const cl_int4 wb = to_wb_factors(d.src_type.fourcc_type(), params, d.fcc16_shift >= 0 ? 0x100 : 0xFF);
+
+    cl_uint arg = 0;
+    cl_kernel unpack_wb = d.unpack_wb_kernel.get();
+    err = clSetKernelArg(unpack_wb, arg++, sizeof(cl_mem), &src_mem);
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int), &src_pitch);
+    if (d.fcc16_shift >= 0)
+    {
+        const cl_int shift = d.fcc16_shift;
+        err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int), &shift);
+    }
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_mem), &by8_mem);
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int), &by8_pitch);
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int), &dim_x);
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int), &dim_y);
+    err |= clSetKernelArg(unpack_wb, arg++, sizeof(cl_int4), &wb);
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clSetKernelArg", err);
+        return false;
+    }
+    err = clEnqueueNDRangeKernel(
+        d.queue.get(), unpack_wb, 2, nullptr, global_size, nullptr, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clEnqueueNDRangeKernel", err);
+        return false;
+    }
+
+    if (d.debayer_kernel)
+    {
+        const auto pattern = img::by_transform::convert_bayer_fcc_to_pattern(d.by8_type.fourcc_type());
+
+        // position of the red pixel in the 2x2 cell
+        using img::by_transform::by_pattern;
+        const cl_int red_x = (pattern == by_pattern::RG || pattern == by_pattern::GB) ? 0 : 1;
+        const cl_int red_y = (pattern == by_pattern::RG || pattern == by_pattern::GR) ? 0 : 1;
+        // the cpu kernels write BGRA32 bottom up unless the dst is already flipped
+        const cl_int flip = (dst.flags & img::img_descriptor::flags_no_flip) ? 0 : 1;
+
+        cl_mem dst_mem = d.dst_buffer.get();
+        cl_kernel debayer = d.debayer_kernel.get();
+        arg = 0;
+        err = clSetKernelArg(debayer, arg++, sizeof(cl_mem), &by8_mem);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &by8_pitch);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_mem), &dst_mem);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &dst_pitch);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &dim_x);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &dim_y);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &red_x);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &red_y);
+        err |= clSetKernelArg(debayer, arg++, sizeof(cl_int), &flip);
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clSetKernelArg", err);
+            return false;
+        }
+        err = clEnqueueNDRangeKernel(
+            d.queue.get(), debayer, 2, nullptr, global_size, nullptr, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS)
+        {
+            last_error_ = to_error_string("clEnqueueNDRangeKernel", err);
+            return false;
+        }
+    }
+
+    const size_t dst_region[3] = { static_cast<size_t>(dst_pitch), static_cast<size_t>(dim_y), 1 };
+    err = clEnqueueReadBufferRect(d.queue.get(),
+                                  d.dst_buffer.get(),
+                                  CL_TRUE,
+                                  origin,
+                                  origin,
+                                  dst_region,
+                                  dst_pitch,
+                                  0,
+                                  dst.pitch(),
+                                  0,
+                                  dst.data(),
+                                  0,
+                                  nullptr,
+                                  nullptr);
+    if (err != CL_SUCCESS)
+    {
+        last_error_ = to_error_string("clEnqueueReadBufferRect", err);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../../libs/dutils_image/src/dutils_img_filter/dutils_img_filter_params.h"
+
+#include <dutils_img/dutils_img.h>
+#include <memory>
+#include <string>
+
+namespace tcamconvert
+{
+/*
+ * OpenCL implementation of a subset of the transform_context conversions.
+ *
+ * Supported are bayer8/16 (and the 10/12 bit formats in 16 bit containers) and mono16 sources
+ * to bayer8/mono8 and BGRA32 (bayer only). The results are the same as the ones of the c kernels.
+ * Frames are uploaded from and downloaded to mapped memory, other formats stay on the cpu.
+ */
+class opencl_transform_context
+{
+public:
+    opencl_transform_context();
+    ~opencl_transform_context();
+
+    opencl_transform_context(const opencl_transform_context&) = delete;
+    opencl_transform_context& operator=(const opencl_transform_context&) = delete;
+
+    // false when there is no OpenCL device or the conversion is not implemented, see last_error()
+    bool setup(img::img_type src_type, img::img_type dst_type);
+
+    // returns false when a OpenCL call failed, dst is undefined in that case
+    bool transform(const img::img_descriptor& src,
+                   const img::img_descriptor& dst,
+                   const img_filter::whitebalance_params& params);
+
+    const std::string& kernel_description() const noexcept
+    {
+        return kernel_description_;
+    }
+    const std::string& last_error() const noexcept
+    {
+        return last_error_;
+    }
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+
+    std::string kernel_description_;
+    std::string last_error_;
+};
+} // namespace tcamconvert
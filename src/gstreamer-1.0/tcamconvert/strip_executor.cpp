@@ -0,0 +1,244 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "strip_executor.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+
+// smaller strips cost more in synchronization than they gain
+constexpr int min_strip_height = 64;
+
+// strip boundaries are kept on even lines
+int strip_begin(int index, int count, int height) noexcept
+{
+    if (index >= count)
+    {
+        return height;
+    }
+    return ((static_cast<int64_t>(height) * index / count) / 2) * 2;
+}
+
+} // namespace
+
+img::img_descriptor tcamconvert::make_strip(const img::img_descriptor& img,
+                                            int y_begin,
+                                            int y_end,
+                                            bool is_first,
+                                            bool is_last) noexcept
+{
+    auto strip = img;
+    strip.data_.planes[0].plane_ptr = img::get_line_start(img, y_begin);
+    for (int i = 1; i < img::planar::get_plane_count(img.fourcc_type()); ++i)
+    {
+        // the chroma planes of 4:2:0 formats have half the lines, y_begin is even
+        const auto y = static_cast<int>(
+            y_begin * img::planar::get_fcc_info(img.fourcc_type(), i).scale_dim_y);
+        strip.data_.planes[i].plane_ptr = img::get_line_start(img.data_.planes[i], y);
+    }
+    strip.dim.cy = y_end - y_begin;
+    strip.data_length = std::abs(img.pitch()) * strip.dim.cy;
+    if (!is_first)
+    {
+        strip.flags |= img::img_descriptor::flags_no_wrap_beg;
+    }
+    if (!is_last)
+    {
+        strip.flags |= img::img_descriptor::flags_no_wrap_end;
+    }
+    return strip;
+}
+
+
+tcamconvert::strip_executor::~strip_executor()
+{
+    stop_workers();
+}
+
+
+void tcamconvert::strip_executor::set_thread_count(int count)
+{
+    if (count <= 0)
+    {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (count == thread_count_)
+    {
+        return;
+    }
+
+    stop_workers();
+    thread_count_ = count;
+
+    // the calling thread processes strips, too
+    start_workers(count - 1);
+}
+
+
+void tcamconvert::strip_executor::start_workers(int count)
+{
+    stop_ = false;
+    for (int i = 0; i < count; ++i) { workers_.emplace_back(&strip_executor::worker_main, this); }
+}
+
+
+void tcamconvert::strip_executor::stop_workers()
+{
+    {
+        std::scoped_lock lck(mtx_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+
+    for (auto& t : workers_)
+    {
+        if (t.joinable())
+        {
+            t.join();
+        }
+    }
+    workers_.clear();
+}
+
+
+int tcamconvert::strip_executor::strip_count_for(const img::img_descriptor& img) const noexcept
+{
+    if (workers_.empty())
+    {
+        return 1;
+    }
+    return std::clamp(img.dim.cy / min_strip_height, 1, thread_count_);
+}
+
+
+void tcamconvert::strip_executor::run(const img::img_descriptor& dst,
+                                      const img::img_descriptor& src,
+                                      binary_func func,
+                                      bool kernel_flips_dst)
+{
+    // src may have a multiple of the dst lines, e.g. for binning
+    const int src_lines_per_line = dst.dim.cy > 0 ? src.dim.cy / dst.dim.cy : 0;
+
+    const int count = std::min(strip_count_for(dst), strip_count_for(src));
+    if (count <= 1 || src_lines_per_line == 0 || dst.dim.cy * src_lines_per_line != src.dim.cy)
+    {
+        func(dst, src);
+        return;
+    }
+
+    auto dst_full = dst;
+    if (kernel_flips_dst)
+    {
+        dst_full = img::flip_image_in_img_desc_if_allowed(dst);
+        dst_full.flags |= img::img_descriptor::flags_no_flip;
+    }
+
+    const int height = dst.dim.cy;
+    execute(count,
+            [&](int index)
+            {
+                const int y_begin = strip_begin(index, count, height);
+                const int y_end = strip_begin(index + 1, count, height);
+                const bool first = index == 0;
+                const bool last = index == count - 1;
+
+                func(make_strip(dst_full, y_begin, y_end, first, last),
+                     make_strip(src,
+                                y_begin * src_lines_per_line,
+                                y_end * src_lines_per_line,
+                                first,
+                                last));
+            });
+}
+
+
+void tcamconvert::strip_executor::run(const img::img_descriptor& img, unary_func func)
+{
+    const int count = strip_count_for(img);
+    if (count <= 1)
+    {
+        func(img);
+        return;
+    }
+
+    const int height = img.dim.cy;
+    execute(count,
+            [&](int index)
+            {
+                const int y_begin = strip_begin(index, count, height);
+                const int y_end = strip_begin(index + 1, count, height);
+
+                func(make_strip(img, y_begin, y_end, index == 0, index == count - 1));
+            });
+}
+
+
+void tcamconvert::strip_executor::execute(int strip_count, function_ref<void(int)> strip_func)
+{
+    {
+        std::scoped_lock lck(mtx_);
+        job_ = &strip_func;
+        job_strip_count_ = strip_count;
+        next_strip_ = 0;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    int index;
+    while ((index = next_strip_.fetch_add(1)) < strip_count) { strip_func(index); }
+
+    std::unique_lock lck(mtx_);
+    // workers may still process the strips they fetched
+    done_cv_.wait(lck, [this] { return workers_active_ == 0; });
+    job_ = nullptr;
+}
+
+
+void tcamconvert::strip_executor::worker_main()
+{
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        const function_ref<void(int)>* job = nullptr;
+        int strip_count = 0;
+        {
+            std::unique_lock lck(mtx_);
+            start_cv_.wait(lck,
+                           [&]
+                           { return stop_ || (job_ != nullptr && generation_ != seen_generation); });
+            if (stop_)
+            {
+                return;
+            }
+            seen_generation = generation_;
+            job = job_;
+            strip_count = job_strip_count_;
+            ++workers_active_;
+        }
+
+        int index;
+        while ((index = next_strip_.fetch_add(1)) < strip_count) { (*job)(index); }
+
+        {
+            std::scoped_lock lck(mtx_);
+            --workers_active_;
+        }
+        done_cv_.notify_all();
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <dutils_img/dutils_img.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tcamconvert
+{
+
+template<typename Signature> class function_ref;
+
+/**
+ * Non owning reference to a callable, the callable has to outlive the function_ref.
+ * Unlike std::function, binding a lambda with captures never allocates,
+ * which keeps the per frame kernel calls free of heap allocations.
+ */
+template<typename R, typename... Args> class function_ref<R(Args...)>
+{
+public:
+    template<typename F,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, function_ref>>>
+    function_ref(F&& func) noexcept
+        : obj_(const_cast<void*>(static_cast<const void*>(std::addressof(func)))),
+          call_([](void* obj, Args... args) -> R
+                {
+                    return (*static_cast<std::remove_reference_t<F>*>(obj))(
+                        std::forward<Args>(args)...);
+                })
+    {
+    }
+
+    R operator()(Args... args) const
+    {
+        return call_(obj_, std::forward<Args>(args)...);
+    }
+
+private:
+    void* obj_;
+    R (*call_)(void*, Args...);
+};
+
+/**
+ * Descriptor for the lines [y_begin;y_end[ of img.
+ * For planar formats the planes are advanced by their own line count, y_begin must be even.
+ * When !is_first/!is_last the strip is marked so kernels read the lines
+ * before/after the strip instead of mirroring at the strip border.
+ */
+img::img_descriptor make_strip(const img::img_descriptor& img,
+                               int y_begin,
+                               int y_end,
+                               bool is_first,
+                               bool is_last) noexcept;
+
+/**
+ * Runs image kernels on horizontal strips of an image using a persistent set of threads.
+ *
+ * Strips start on even lines, so bayer patterns are preserved.
+ * All strips except the first/last are marked with flags_no_wrap_beg/flags_no_wrap_end,
+ * which allows kernels that need neighbour lines (e.g. debayering) to read the lines
+ * above and below their strip from the full image.
+ */
+class strip_executor
+{
+public:
+    using binary_func =
+        function_ref<void(const img::img_descriptor& dst, const img::img_descriptor& src)>;
+    using unary_func = function_ref<void(const img::img_descriptor& img)>;
+
+    strip_executor() = default;
+    ~strip_executor();
+
+    strip_executor(const strip_executor&) = delete;
+    strip_executor& operator=(const strip_executor&) = delete;
+
+    /**
+     * 0 selects one thread per core, 1 runs everything on the calling thread.
+     * Must not be called while run() is active.
+     */
+    void set_thread_count(int count);
+    int get_thread_count() const noexcept
+    {
+        return thread_count_;
+    }
+
+    /**
+     * Run func over dst and src strips and block until all strips are done.
+     * When kernel_flips_dst is set, func flips its dst unless flags_no_flip is set
+     * (flip_image_in_img_desc_if_allowed). The flip is then done once for the whole image.
+     * src may have an integer multiple of the lines of dst, its strips are scaled accordingly.
+     */
+    void run(const img::img_descriptor& dst,
+             const img::img_descriptor& src,
+             binary_func func,
+             bool kernel_flips_dst = false);
+
+    // in place variant
+    void run(const img::img_descriptor& img, unary_func func);
+
+private:
+    void start_workers(int count);
+    void stop_workers();
+    void worker_main();
+    void execute(int strip_count, function_ref<void(int)> strip_func);
+
+    int strip_count_for(const img::img_descriptor& img) const noexcept;
+
+    int thread_count_ = 1;
+
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+
+    bool stop_ = false;
+    uint64_t generation_ = 0;
+    int workers_active_ = 0;
+
+    // only valid while execute() runs
+    const function_ref<void(int)>* job_ = nullptr;
+    int job_strip_count_ = 0;
+    std::atomic<int> next_strip_ { 0 };
+};
+
+} // namespace tcamconvert
@@ -0,0 +1,887 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamaccumulate.h"
+
+#include "../../../libs/dutils_image/src/dutils_img_filter/dutils_img_filter_params.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/frame_accumulate/frame_accumulate.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../scope_tracing.h"
+#include "strip_executor.h"
+#include "transform_impl.h"
+
+#include <dutils_img/fcc_to_string.h>
+#include <dutils_img_lib/dutils_get_cpu_features.h>
+#include <dutils_img_lib/dutils_gst_interop.h>
+#include <gst-helper/gst_gvalue_helper.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst-helper/helper_functions.h>
+#include <gst/video/gstvideometa.h>
+#include <utility>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamaccumulate_debug_category);
+#define GST_CAT_DEFAULT gst_tcamaccumulate_debug_category
+
+namespace accumulate = img_filter::frame_accumulate;
+
+enum
+{
+    PROP_0,
+    PROP_MODE,
+    PROP_FRAMES,
+    PROP_EXPOSURES,
+    PROP_SATURATION,
+    PROP_N_THREADS,
+};
+
+static const int default_frames = 4;
+static const double default_saturation = 0.95;
+
+namespace tcamconvert
+{
+struct accumulate_state
+{
+    GstTcamAccumulateMode mode = GST_TCAM_ACCUMULATE_MODE_AVERAGE;
+    int frames = default_frames;
+    std::vector<float> exposures;
+    double saturation = default_saturation;
+    int thread_count = 1;
+
+    // set in set_caps
+    img::img_type src_type;
+    img::img_type dst_type;
+    accumulate::line_funcs funcs;
+    accumulate::accumulator acc;
+    float fuse_scales[1 << accumulate::max_fused_frames] = {};
+    uint32_t saturation_value = 0;
+    GstClockTime frame_duration = GST_CLOCK_TIME_NONE;
+
+    strip_executor executor;
+
+    // the group being accumulated, output is acquired with its first frame
+    int group_frames = 0;
+    GstBuffer* output = nullptr;
+    bool output_discont = false;
+
+    bool has_frame_count = false;
+    guint64 last_frame_count = 0;
+
+    bool is_fuse() const noexcept
+    {
+        return mode == GST_TCAM_ACCUMULATE_MODE_FUSE;
+    }
+
+    // number of input frames per output frame, 0 when fuse has no exposures
+    int group_size() const noexcept
+    {
+        return is_fuse() ? static_cast<int>(exposures.size()) : frames;
+    }
+
+    void drop_group() noexcept
+    {
+        if (output)
+        {
+            gst_buffer_unref(output);
+            output = nullptr;
+        }
+        group_frames = 0;
+    }
+};
+} // namespace tcamconvert
+
+#define gst_tcamaccumulate_parent_class parent_class
+G_DEFINE_TYPE(GstTCamAccumulate, gst_tcamaccumulate, GST_TYPE_BASE_TRANSFORM)
+
+
+GType gst_tcam_accumulate_mode_get_type(void)
+{
+    static GType tcam_accumulate_mode = 0;
+
+    if (!tcam_accumulate_mode)
+    {
+        static const GEnumValue modes[] = {
+            { GST_TCAM_ACCUMULATE_MODE_AVERAGE, "GST_TCAM_ACCUMULATE_MODE_AVERAGE", "average" },
+            { GST_TCAM_ACCUMULATE_MODE_FUSE, "GST_TCAM_ACCUMULATE_MODE_FUSE", "fuse" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_accumulate_mode = g_enum_register_static("GstTcamAccumulateMode", modes);
+    }
+    return tcam_accumulate_mode;
+}
+
+static auto get_supported_fccs() -> const std::vector<img::fourcc>&
+{
+    static const std::vector<img::fourcc> fccs = []
+    {
+        std::vector<img::fourcc> rval;
+        for (auto fcc : tcamconvert::tcamconvert_get_all_input_fccs())
+        {
+            if (accumulate::is_supported_fcc(fcc))
+            {
+                rval.push_back(fcc);
+            }
+        }
+        return rval;
+    }();
+    return fccs;
+}
+
+static auto select_line_funcs(img::fourcc fcc, const char*& name) -> accumulate::line_funcs
+{
+    static const unsigned int features = img_lib::cpu::get_features();
+
+#if defined DUTILS_ARCH_ARM
+    if ((features & img::cpu::CPU_ARM_A7) != 0)
+    {
+        if (auto funcs = accumulate::get_line_funcs_neon(fcc); funcs.add)
+        {
+            name = "neon";
+            return funcs;
+        }
+    }
+#else
+    if ((features & img::cpu::CPU_AVX2) != 0)
+    {
+        if (auto funcs = accumulate::get_line_funcs_avx2(fcc); funcs.add)
+        {
+            name = "avx2";
+            return funcs;
+        }
+    }
+    if ((features & img::cpu::CPU_SSE41) != 0)
+    {
+        if (auto funcs = accumulate::get_line_funcs_sse41(fcc); funcs.add)
+        {
+            name = "sse41";
+            return funcs;
+        }
+    }
+#endif
+    name = "c";
+    return accumulate::get_line_funcs_c(fcc);
+}
+
+// exposures holds the relative exposure times of one bracket
+static bool get_exposure_values(const GValue& value, std::vector<float>& exposures)
+{
+    std::vector<float> rval;
+    for (const GValue* entry : gst_helper::gst_list_or_array_to_GValue_vector(value))
+    {
+        // gst-launch parses whole numbers as int
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_DOUBLE);
+        const bool transformed = g_value_transform(entry, &tmp);
+        const double exposure = g_value_get_double(&tmp);
+        g_value_unset(&tmp);
+        if (!transformed || !(exposure > 0.0))
+        {
+            return false;
+        }
+        rval.push_back(static_cast<float>(exposure));
+    }
+    if (rval.size() == 1 || rval.size() > size_t(accumulate::max_fused_frames))
+    {
+        return false;
+    }
+    exposures = std::move(rval);
+    return true;
+}
+
+static void set_exposure_values(GValue& value, const std::vector<float>& exposures)
+{
+    for (float v : exposures)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_DOUBLE);
+        g_value_set_double(&tmp, v);
+        gst_value_array_append_value(&value, &tmp);
+        g_value_unset(&tmp);
+    }
+}
+
+static void gst_tcamaccumulate_set_property(GObject* object,
+                                            guint prop_id,
+                                            const GValue* value,
+                                            GParamSpec* pspec)
+{
+    auto self = GST_TCAMACCUMULATE(object);
+    auto& state = *self->state_;
+
+    GstState gst_state;
+    gst_element_get_state(GST_ELEMENT(self), &gst_state, nullptr, 0);
+    if (gst_state > GST_STATE_READY)
+    {
+        GST_WARNING_OBJECT(self, "%s can only be changed in READY or lower", pspec->name);
+        return;
+    }
+
+    switch (prop_id)
+    {
+        case PROP_MODE:
+        {
+            state.mode = static_cast<GstTcamAccumulateMode>(g_value_get_enum(value));
+            break;
+        }
+        case PROP_FRAMES:
+        {
+            state.frames = static_cast<int>(g_value_get_uint(value));
+            break;
+        }
+        case PROP_EXPOSURES:
+        {
+            if (!get_exposure_values(*value, state.exposures))
+            {
+                GST_WARNING_OBJECT(self,
+                                   "exposures needs 2 to %d values greater than 0",
+                                   accumulate::max_fused_frames);
+            }
+            break;
+        }
+        case PROP_SATURATION:
+        {
+            state.saturation = g_value_get_double(value);
+            break;
+        }
+        case PROP_N_THREADS:
+        {
+            state.thread_count = g_value_get_int(value);
+            state.executor.set_thread_count(state.thread_count);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+static void gst_tcamaccumulate_get_property(GObject* object,
+                                            guint prop_id,
+                                            GValue* value,
+                                            GParamSpec* pspec)
+{
+    auto self = GST_TCAMACCUMULATE(object);
+    const auto& state = *self->state_;
+
+    switch (prop_id)
+    {
+        case PROP_MODE:
+        {
+            g_value_set_enum(value, state.mode);
+            break;
+        }
+        case PROP_FRAMES:
+        {
+            g_value_set_uint(value, static_cast<guint>(state.frames));
+            break;
+        }
+        case PROP_EXPOSURES:
+        {
+            set_exposure_values(*value, state.exposures);
+            break;
+        }
+        case PROP_SATURATION:
+        {
+            g_value_set_double(value, state.saturation);
+            break;
+        }
+        case PROP_N_THREADS:
+        {
+            g_value_set_int(value, state.thread_count);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+// the output framerate is the input framerate divided by the group size
+static void transform_framerate(GstStructure* structure, GstPadDirection direction, int group_size)
+{
+    const GValue* framerate = gst_structure_get_value(structure, "framerate");
+    if (framerate == nullptr || group_size <= 1)
+    {
+        return;
+    }
+
+    if (GST_VALUE_HOLDS_FRACTION(framerate))
+    {
+        const gint num = gst_value_get_fraction_numerator(framerate);
+        const gint denom = gst_value_get_fraction_denominator(framerate);
+
+        gint res_num = 0;
+        gint res_denom = 1;
+        const bool valid = direction == GST_PAD_SINK
+                               ? gst_util_fraction_multiply(
+                                   num, denom, 1, group_size, &res_num, &res_denom)
+                               : gst_util_fraction_multiply(
+                                   num, denom, group_size, 1, &res_num, &res_denom);
+        if (valid)
+        {
+            gst_structure_set(
+                structure, "framerate", GST_TYPE_FRACTION, res_num, res_denom, nullptr);
+            return;
+        }
+    }
+    // ranges and lists are not worth transforming, any rate is then possible
+    gst_structure_set(
+        structure, "framerate", GST_TYPE_FRACTION_RANGE, 0, 1, G_MAXINT, 1, nullptr);
+}
+
+static GstCaps* gst_tcamaccumulate_transform_caps(GstBaseTransform* base,
+                                                  GstPadDirection direction,
+                                                  GstCaps* caps,
+                                                  GstCaps* filter)
+{
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+    const auto& state = *self->state_;
+
+    auto to_output_fcc = [&state](img::fourcc fcc)
+    { return state.is_fuse() ? accumulate::get_fused_fcc(fcc) : fcc; };
+
+    GstCaps* res_caps = gst_caps_new_empty();
+
+    for (guint i = 0; i < gst_caps_get_size(caps); ++i)
+    {
+        const GstStructure* structure = gst_caps_get_structure(caps, i);
+
+        for (auto fcc : gst_helper::convert_GstStructure_to_fcc_list(*structure))
+        {
+            if (!accumulate::is_supported_fcc(fcc))
+            {
+                continue;
+            }
+
+            std::vector<img::fourcc> other_fccs;
+            if (direction == GST_PAD_SINK)
+            {
+                other_fccs.push_back(to_output_fcc(fcc));
+            }
+            else
+            {
+                for (auto src_fcc : get_supported_fccs())
+                {
+                    if (to_output_fcc(src_fcc) == fcc)
+                    {
+                        other_fccs.push_back(src_fcc);
+                    }
+                }
+            }
+
+            for (auto other_fcc : other_fccs)
+            {
+                auto caps_fmt = img_lib::gst::fourcc_to_gst_caps_descr(other_fcc);
+                if (!caps_fmt.gst_struct_name)
+                {
+                    continue;
+                }
+
+                // keeps width, height etc.
+                GstStructure* tmp_struc = gst_structure_copy(structure);
+
+                gst_structure_set_name(tmp_struc, caps_fmt.gst_struct_name);
+                if (caps_fmt.format_entry)
+                {
+                    gst_structure_set(
+                        tmp_struc, "format", G_TYPE_STRING, caps_fmt.format_entry, nullptr);
+                }
+                transform_framerate(tmp_struc, direction, state.group_size());
+
+                gst_caps_append_structure(res_caps, tmp_struc);
+            }
+        }
+    }
+
+    if (filter)
+    {
+        GstCaps* tmp_caps = res_caps;
+        res_caps = gst_caps_intersect_full(filter, tmp_caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(tmp_caps);
+    }
+
+    GST_DEBUG_OBJECT(base,
+                     "dir=%s transformed %s into %s",
+                     direction == GST_PAD_SRC ? "GST_PAD_SRC" : "GST_PAD_SINK",
+                     gst_helper::to_string(*caps).c_str(),
+                     gst_helper::to_string(*res_caps).c_str());
+    return res_caps;
+}
+
+static gboolean gst_tcamaccumulate_set_caps(GstBaseTransform* base,
+                                            GstCaps* incaps,
+                                            GstCaps* outcaps)
+{
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+    auto& state = *self->state_;
+
+    auto src = gst_helper::get_img_type_from_fixated_gstcaps(*incaps);
+    auto dst = gst_helper::get_img_type_from_fixated_gstcaps(*outcaps);
+    if (src.empty() || dst.empty())
+    {
+        return FALSE;
+    }
+
+    if (state.is_fuse() && state.exposures.empty())
+    {
+        GST_ELEMENT_ERROR(self,
+                          CORE,
+                          NEGOTIATION,
+                          ("mode=fuse needs the exposures of the bracket"),
+                          (NULL));
+        return FALSE;
+    }
+
+    const char* kernel_name = nullptr;
+    state.funcs = select_line_funcs(src.fourcc_type(), kernel_name);
+    if (!state.funcs.add)
+    {
+        GST_ELEMENT_ERROR(self,
+                          STREAM,
+                          FORMAT,
+                          ("Unable to accumulate %s", img::fcc_to_string(src.type).c_str()),
+                          (NULL));
+        return FALSE;
+    }
+    GST_INFO_OBJECT(self,
+                    "Accumulating %s %dx%d with the %s kernels",
+                    img::fcc_to_string(src.type).c_str(),
+                    src.dim.cx,
+                    src.dim.cy,
+                    kernel_name);
+
+    state.drop_group();
+    state.src_type = src;
+    state.dst_type = dst;
+    accumulate::init(state.acc, src, state.is_fuse());
+
+    const uint32_t max_value = img::get_bits_per_pixel(src.fourcc_type()) == 8 ? 0xFF : 0xFFFF;
+    state.saturation_value = static_cast<uint32_t>(state.saturation * (max_value + 1));
+    if (state.is_fuse())
+    {
+        accumulate::make_fuse_scales(state.fuse_scales,
+                                     state.exposures.data(),
+                                     static_cast<int>(state.exposures.size()),
+                                     max_value);
+    }
+
+    state.frame_duration = GST_CLOCK_TIME_NONE;
+    gint fps_num = 0;
+    gint fps_denom = 1;
+    if (gst_structure_get_fraction(
+            gst_caps_get_structure(incaps, 0), "framerate", &fps_num, &fps_denom)
+        && fps_num > 0)
+    {
+        state.frame_duration = gst_util_uint64_scale_int(GST_SECOND, fps_denom, fps_num);
+    }
+    return TRUE;
+}
+
+static gboolean gst_tcamaccumulate_transform_size(GstBaseTransform* base,
+                                                  GstPadDirection direction,
+                                                  GstCaps* /*caps*/,
+                                                  gsize /*size*/,
+                                                  GstCaps* othercaps,
+                                                  gsize* othersize)
+{
+    if (direction != GST_PAD_SINK)
+    {
+        return FALSE;
+    }
+
+    auto type = gst_helper::get_img_type_from_fixated_gstcaps(*othercaps);
+    if (type.empty())
+    {
+        GST_WARNING_OBJECT(base, "Unable to get the output size");
+        return FALSE;
+    }
+    *othersize = type.buffer_length;
+    return TRUE;
+}
+
+static img::img_descriptor make_img_desc_from_input_buffer(const img::img_type& src_type,
+                                                           guint8* map_in_data,
+                                                           GstBuffer* inbuf)
+{
+    auto meta = gst_buffer_get_video_meta(inbuf);
+    if (meta != nullptr && meta->stride[0] != 0)
+    {
+        return img::make_img_desc_raw(
+            src_type, img::img_plane { map_in_data + meta->offset[0], meta->stride[0] });
+    }
+    return img::make_img_desc_from_linear_memory(src_type, map_in_data);
+}
+
+// a gap in the frame counter means the group lost a frame
+static bool is_frame_missing(tcamconvert::accumulate_state& state, GstBuffer* inbuf)
+{
+    auto meta = gst_buffer_get_tcam_statistics_values_meta(inbuf);
+    if (meta == nullptr)
+    {
+        return false;
+    }
+
+    const bool missing =
+        state.has_frame_count && meta->values.frame_count != state.last_frame_count + 1;
+    state.has_frame_count = true;
+    state.last_frame_count = meta->values.frame_count;
+    return missing;
+}
+
+static GstFlowReturn accumulate_buffer(GstTCamAccumulate* self, GstBuffer* inbuf, bool is_discont)
+{
+    TCAM_TRACE_SCOPE("tcamaccumulate accumulate");
+
+    auto& state = *self->state_;
+
+    const bool missing = is_frame_missing(state, inbuf);
+    if ((is_discont || missing) && state.group_frames > 0)
+    {
+        GST_DEBUG_OBJECT(self, "Dropping a partial group of %d frames", state.group_frames);
+        state.drop_group();
+        state.output_discont = true;
+    }
+
+    if (state.group_frames == 0)
+    {
+        // the output takes the timestamp and metadata of the first frame of the group
+        auto base_class = GST_BASE_TRANSFORM_CLASS(parent_class);
+        GstFlowReturn ret =
+            base_class->prepare_output_buffer(GST_BASE_TRANSFORM(self), inbuf, &state.output);
+        if (ret != GST_FLOW_OK)
+        {
+            state.output = nullptr;
+            return ret;
+        }
+        if (state.output_discont)
+        {
+            GST_BUFFER_FLAG_SET(state.output, GST_BUFFER_FLAG_DISCONT);
+            state.output_discont = false;
+        }
+    }
+
+    GstMapInfo map_in;
+    if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READ))
+    {
+        GST_ERROR_OBJECT(self, "Input buffer could not be mapped");
+        state.drop_group();
+        return GST_FLOW_OK;
+    }
+    if (map_in.size < static_cast<gsize>(state.src_type.buffer_length))
+    {
+        gst_buffer_unmap(inbuf, &map_in);
+
+        GST_ERROR_OBJECT(self, "Input buffer is too small");
+        state.drop_group();
+        return GST_FLOW_OK;
+    }
+
+    const auto src = make_img_desc_from_input_buffer(state.src_type, map_in.data, inbuf);
+    const auto locator = img_filter::frame_locator::make(src);
+    const int frame_index = state.group_frames;
+
+    state.executor.run(src,
+                       [&](const img::img_descriptor& strip)
+                       {
+                           const int y = locator.locate(strip).y;
+                           if (state.is_fuse())
+                           {
+                               accumulate::add_masked(state.acc,
+                                                      strip,
+                                                      y,
+                                                      frame_index,
+                                                      state.saturation_value,
+                                                      state.funcs);
+                           }
+                           else
+                           {
+                               accumulate::add(state.acc, strip, y, frame_index, state.funcs);
+                           }
+                       });
+
+    gst_buffer_unmap(inbuf, &map_in);
+
+    // the output lasts until the end of the last frame of the group
+    if (GST_BUFFER_PTS_IS_VALID(state.output) && GST_BUFFER_PTS_IS_VALID(inbuf)
+        && GST_BUFFER_DURATION_IS_VALID(inbuf))
+    {
+        GST_BUFFER_DURATION(state.output) =
+            GST_BUFFER_PTS(inbuf) + GST_BUFFER_DURATION(inbuf) - GST_BUFFER_PTS(state.output);
+    }
+
+    state.group_frames++;
+    return GST_FLOW_OK;
+}
+
+static GstFlowReturn gst_tcamaccumulate_submit_input_buffer(GstBaseTransform* base,
+                                                            gboolean is_discont,
+                                                            GstBuffer* input)
+{
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+
+    // the default implementation handles reconfiguration and qos, then queues the buffer
+    GstFlowReturn ret =
+        GST_BASE_TRANSFORM_CLASS(parent_class)->submit_input_buffer(base, is_discont, input);
+    if (ret != GST_FLOW_OK || base->queued_buf == nullptr)
+    {
+        return ret;
+    }
+
+    GstBuffer* inbuf = base->queued_buf;
+    base->queued_buf = nullptr;
+
+    ret = accumulate_buffer(self, inbuf, is_discont || GST_BUFFER_IS_DISCONT(inbuf));
+    gst_buffer_unref(inbuf);
+    return ret;
+}
+
+static GstFlowReturn gst_tcamaccumulate_generate_output(GstBaseTransform* base, GstBuffer** outbuf)
+{
+    TCAM_TRACE_SCOPE("tcamaccumulate generate_output");
+
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+    auto& state = *self->state_;
+
+    *outbuf = nullptr;
+    if (state.output == nullptr || state.group_frames < state.group_size())
+    {
+        return GST_FLOW_OK;
+    }
+
+    GstBuffer* buffer = state.output;
+    const int frames = state.group_frames;
+    state.output = nullptr;
+    state.group_frames = 0;
+
+    GstMapInfo map_out;
+    if (!gst_buffer_map(buffer, &map_out, GST_MAP_WRITE) || map_out.data == nullptr
+        || map_out.size < static_cast<gsize>(state.dst_type.buffer_length))
+    {
+        gst_buffer_unref(buffer);
+
+        GST_ERROR_OBJECT(self, "Output buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    const auto dst = img::make_img_desc_from_linear_memory(state.dst_type, map_out.data);
+    const auto locator = img_filter::frame_locator::make(dst);
+
+    state.executor.run(dst,
+                       [&](const img::img_descriptor& strip)
+                       {
+                           const int y = locator.locate(strip).y;
+                           if (state.is_fuse())
+                           {
+                               accumulate::write_fused(strip, y, state.acc, state.fuse_scales);
+                           }
+                           else
+                           {
+                               accumulate::write_average(
+                                   strip, y, state.acc, frames, state.funcs);
+                           }
+                       });
+
+    gst_buffer_unmap(buffer, &map_out);
+
+    *outbuf = buffer;
+    return GST_FLOW_OK;
+}
+
+static gboolean gst_tcamaccumulate_sink_event(GstBaseTransform* base, GstEvent* event)
+{
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+
+    switch (GST_EVENT_TYPE(event))
+    {
+        case GST_EVENT_FLUSH_STOP:
+        case GST_EVENT_EOS:
+        {
+            // a partial group is not pushed
+            self->state_->drop_group();
+            self->state_->has_frame_count = false;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+    return GST_BASE_TRANSFORM_CLASS(parent_class)->sink_event(base, event);
+}
+
+static gboolean gst_tcamaccumulate_query(GstBaseTransform* base,
+                                         GstPadDirection direction,
+                                         GstQuery* query)
+{
+    GstTCamAccumulate* self = GST_TCAMACCUMULATE(base);
+
+    if (!GST_BASE_TRANSFORM_CLASS(parent_class)->query(base, direction, query))
+    {
+        return FALSE;
+    }
+
+    // an output frame has to wait for the remaining frames of its group
+    const auto& state = *self->state_;
+    if (direction == GST_PAD_SRC && GST_QUERY_TYPE(query) == GST_QUERY_LATENCY
+        && GST_CLOCK_TIME_IS_VALID(state.frame_duration) && state.group_size() > 1)
+    {
+        gboolean live;
+        GstClockTime min_latency;
+        GstClockTime max_latency;
+        gst_query_parse_latency(query, &live, &min_latency, &max_latency);
+
+        const GstClockTime group_latency = state.frame_duration * (state.group_size() - 1);
+        min_latency += group_latency;
+        if (GST_CLOCK_TIME_IS_VALID(max_latency))
+        {
+            max_latency += group_latency;
+        }
+        gst_query_set_latency(query, live, min_latency, max_latency);
+    }
+    return TRUE;
+}
+
+static gboolean gst_tcamaccumulate_stop(GstBaseTransform* base)
+{
+    auto& state = *GST_TCAMACCUMULATE(base)->state_;
+
+    state.drop_group();
+    state.has_frame_count = false;
+    state.acc = {};
+    return TRUE;
+}
+
+static void gst_tcamaccumulate_init(GstTCamAccumulate* self)
+{
+    self->state_ = new tcamconvert::accumulate_state;
+
+    gst_base_transform_set_in_place(GST_BASE_TRANSFORM(self), FALSE);
+}
+
+static void gst_tcamaccumulate_finalize(GObject* object)
+{
+    auto self = GST_TCAMACCUMULATE(object);
+
+    self->state_->drop_group();
+    delete self->state_;
+    G_OBJECT_CLASS(gst_tcamaccumulate_parent_class)->finalize(object);
+}
+
+static void gst_tcamaccumulate_class_init(GstTCamAccumulateClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseTransformClass* gst_base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamaccumulate_set_property;
+    gobject_class->get_property = gst_tcamaccumulate_get_property;
+    gobject_class->finalize = gst_tcamaccumulate_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MODE,
+        g_param_spec_enum("mode",
+                          "Mode",
+                          "average outputs the mean of a group of frames, "
+                          "fuse combines an exposure bracket into one 16 bit frame",
+                          GST_TYPE_TCAM_ACCUMULATE_MODE,
+                          GST_TCAM_ACCUMULATE_MODE_AVERAGE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FRAMES,
+        g_param_spec_uint("frames",
+                          "Frames",
+                          "Number of frames averaged into one output frame",
+                          1,
+                          accumulate::max_average_frames,
+                          default_frames,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_EXPOSURES,
+        gst_param_spec_array(
+            "exposures",
+            "Exposures",
+            "Relative exposure times of the frames of a bracket in capture order, "
+            "fuse outputs one frame per bracket, e.g. <1,4,16>",
+            g_param_spec_double("exposure",
+                                "Exposure",
+                                "Exposure time of one frame",
+                                0.0,
+                                G_MAXFLOAT,
+                                1.0,
+                                static_cast<GParamFlags>(G_PARAM_READWRITE
+                                                         | G_PARAM_STATIC_STRINGS)),
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SATURATION,
+        g_param_spec_double("saturation",
+                            "Saturation",
+                            "Fraction of the maximum value from which on pixels are not fused",
+                            0.0,
+                            1.0,
+                            default_saturation,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_N_THREADS,
+        g_param_spec_int("n-threads",
+                         "Number of threads",
+                         "Number of threads used to accumulate. 0 uses one thread per core",
+                         0,
+                         64,
+                         1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TCamAccumulate gstreamer element",
+        "Filter/Video",
+        "Averages groups of Mono/Bayer 8/16 bit frames or fuses exposure brackets",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    auto caps = gst_helper::generate_caps_with_dim(get_supported_fccs());
+
+    gst_element_class_add_pad_template(
+        gstelement_class, gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps.get()));
+    gst_element_class_add_pad_template(
+        gstelement_class, gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS, caps.get()));
+
+    gst_base_transform_class->transform_caps =
+        GST_DEBUG_FUNCPTR(gst_tcamaccumulate_transform_caps);
+    gst_base_transform_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamaccumulate_set_caps);
+    gst_base_transform_class->transform_size =
+        GST_DEBUG_FUNCPTR(gst_tcamaccumulate_transform_size);
+    gst_base_transform_class->submit_input_buffer =
+        GST_DEBUG_FUNCPTR(gst_tcamaccumulate_submit_input_buffer);
+    gst_base_transform_class->generate_output =
+        GST_DEBUG_FUNCPTR(gst_tcamaccumulate_generate_output);
+    gst_base_transform_class->sink_event = GST_DEBUG_FUNCPTR(gst_tcamaccumulate_sink_event);
+    gst_base_transform_class->query = GST_DEBUG_FUNCPTR(gst_tcamaccumulate_query);
+    gst_base_transform_class->stop = GST_DEBUG_FUNCPTR(gst_tcamaccumulate_stop);
+
+    gst_base_transform_class->passthrough_on_same_caps = FALSE;
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamaccumulate_debug_category, "tcamaccumulate", 0, "tcamaccumulate element");
+}
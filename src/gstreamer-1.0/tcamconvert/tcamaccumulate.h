@@ -0,0 +1,71 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMACCUMULATE_H_INC_
+#define TCAMACCUMULATE_H_INC_
+
+#include <gst/base/gstbasetransform.h>
+#include <gst/gst.h>
+
+namespace tcamconvert
+{
+struct accumulate_state;
+}
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMACCUMULATE (gst_tcamaccumulate_get_type())
+#define GST_TCAMACCUMULATE(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMACCUMULATE, GstTCamAccumulate))
+#define GST_TCAMACCUMULATE_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMACCUMULATE, GstTCamAccumulateClass))
+#define GST_IS_TCAMACCUMULATE(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMACCUMULATE))
+#define GST_IS_TCAMACCUMULATE_CLASS(obj) \
+    (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMACCUMULATE))
+
+#define GST_TYPE_TCAM_ACCUMULATE_MODE (gst_tcam_accumulate_mode_get_type())
+GType gst_tcam_accumulate_mode_get_type(void);
+
+typedef enum
+{
+    // mean of a group of frames, same format as the input
+    GST_TCAM_ACCUMULATE_MODE_AVERAGE = 0,
+    // exposure bracket fused into one 16 bit frame
+    GST_TCAM_ACCUMULATE_MODE_FUSE = 1,
+} GstTcamAccumulateMode;
+
+/*
+ * Averages groups of frames or fuses exposure brackets of 8/16 bit bayer and mono frames,
+ * one output buffer per group. The sums are kept in a buffer allocated in set_caps.
+ */
+typedef struct GstTCamAccumulate
+{
+    GstBaseTransform base;
+
+    tcamconvert::accumulate_state* state_;
+
+} GstTCamAccumulate;
+
+typedef struct GstTCamAccumulateClass
+{
+    GstBaseTransformClass base_class;
+} GstTCamAccumulateClass;
+
+GType gst_tcamaccumulate_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMACCUMULATE_H_INC_ */
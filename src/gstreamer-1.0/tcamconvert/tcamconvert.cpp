@@ -16,8 +16,14 @@
 
 #include "tcamconvert.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../scope_tracing.h"
 #include "../../version.h"
+#include "tcamaccumulate.h"
 #include "tcamconvert_context.h"
+#include "tcamlatencysink.h"
+#include "tcamlosslessdec.h"
+#include "tcamlosslessenc.h"
 
 #include <dutils_img/dutils_img.h>
 #include <dutils_img/fcc_to_string.h>
@@ -25,12 +31,34 @@
 #include <gst-helper/gst_gvalue_helper.h>
 #include <gst-helper/gstcaps_dutils_interop.h>
 #include <gst-helper/helper_functions.h>
+#if defined HAVE_V4L2_M2M
+#include <gst/allocators/gstdmabuf.h>
+#endif
 #include <gst/video/gstvideometa.h>
+#include <gst/video/gstvideopool.h>
+#include <gst/video/video.h>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
 #include <vector>
 
 enum
 {
     PROP_0,
+    PROP_N_THREADS,
+    PROP_KERNEL,
+    PROP_USE_GPU,
+    PROP_M2M_DEVICE,
+    PROP_GAMMA,
+    PROP_CONTRAST,
+    PROP_TONEMAPPING,
+    PROP_TONEMAPPING_INTENSITY,
+    PROP_TONEMAPPING_BRIGHTNESS,
+    PROP_TENSOR_MEAN,
+    PROP_TENSOR_STD,
+    PROP_ROIS,
+    PROP_DEFECT_PIXEL_FILE,
+    PROP_FLAT_FIELD_FILE,
 };
 
 GST_DEBUG_CATEGORY_STATIC(gst_tcamconvert_debug_category);
@@ -48,34 +76,386 @@ static tcamconvert::tcamconvert_context_base& get_gst_elem_reference(GstTCamConv
     return *self->context_;
 }
 
-/* No properties are implemented, so only a warning is produced */
-static void gst_tcamconvert_set_property(GObject* object __attribute__((unused)),
+// tensor-mean/tensor-std hold 3 values in r, g, b order
+static bool get_tensor_values(const GValue& value, float (&values)[3])
+{
+    const auto entries = gst_helper::gst_list_or_array_to_GValue_vector(value);
+    if (entries.size() != 3)
+    {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        // gst-launch parses whole numbers as int
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_DOUBLE);
+        const bool transformed = g_value_transform(entries[i], &tmp);
+        values[i] = static_cast<float>(g_value_get_double(&tmp));
+        g_value_unset(&tmp);
+        if (!transformed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void set_tensor_values(GValue& value, const float (&values)[3])
+{
+    for (float v : values)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_DOUBLE);
+        g_value_set_double(&tmp, v);
+        gst_value_array_append_value(&value, &tmp);
+        g_value_unset(&tmp);
+    }
+}
+
+// rois holds x, y, width and height of each rect
+static bool get_roi_values(const GValue& value, std::vector<img::rect>& rois)
+{
+    const auto entries = gst_helper::gst_list_or_array_to_GValue_vector(value);
+    if (entries.size() % 4 != 0)
+    {
+        return false;
+    }
+    std::vector<int> values;
+    for (auto* entry : entries)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_INT);
+        const bool transformed = g_value_transform(entry, &tmp);
+        values.push_back(g_value_get_int(&tmp));
+        g_value_unset(&tmp);
+        if (!transformed || values.back() < 0)
+        {
+            return false;
+        }
+    }
+    rois.clear();
+    for (size_t i = 0; i < values.size(); i += 4)
+    {
+        rois.push_back(img::rect { img::point { values[i + 0], values[i + 1] },
+                                   img::dim { values[i + 2], values[i + 3] } });
+    }
+    return true;
+}
+
+static void set_roi_values(GValue& value, const std::vector<img::rect>& rois)
+{
+    for (const auto& roi : rois)
+    {
+        const int values[] = { roi.left, roi.top, roi.dimensions().cx, roi.dimensions().cy };
+        for (int v : values)
+        {
+            GValue tmp = G_VALUE_INIT;
+            g_value_init(&tmp, G_TYPE_INT);
+            g_value_set_int(&tmp, v);
+            gst_value_array_append_value(&value, &tmp);
+            g_value_unset(&tmp);
+        }
+    }
+}
+
+static void gst_tcamconvert_set_property(GObject* object,
                                          guint prop_id,
-                                         const GValue* value __attribute__((unused)),
+                                         const GValue* value,
                                          GParamSpec* pspec)
 {
+    auto self = GST_TCAMCONVERT(object);
+
     switch (prop_id)
     {
+        case PROP_N_THREADS:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "n-threads can only be changed in READY or lower");
+                break;
+            }
+            get_gst_elem_reference(self).set_thread_count(g_value_get_int(value));
+            break;
+        }
+        case PROP_USE_GPU:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "use-gpu can only be changed in READY or lower");
+                break;
+            }
+            get_gst_elem_reference(self).set_use_gpu(g_value_get_boolean(value));
+            break;
+        }
+        case PROP_M2M_DEVICE:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "m2m-device can only be changed in READY or lower");
+                break;
+            }
+            const char* device = g_value_get_string(value);
+            get_gst_elem_reference(self).set_m2m_device(device ? device : "");
+            break;
+        }
+        case PROP_GAMMA:
+        case PROP_CONTRAST:
+        case PROP_TONEMAPPING:
+        case PROP_TONEMAPPING_INTENSITY:
+        case PROP_TONEMAPPING_BRIGHTNESS:
+        {
+            auto& ctx = get_gst_elem_reference(self);
+            auto curve = ctx.get_tone_curve();
+            switch (prop_id)
+            {
+                case PROP_GAMMA:
+                    curve.gamma = static_cast<float>(g_value_get_double(value));
+                    break;
+                case PROP_CONTRAST:
+                    curve.contrast = static_cast<float>(g_value_get_double(value));
+                    break;
+                case PROP_TONEMAPPING:
+                    curve.tonemapping.enable = g_value_get_boolean(value);
+                    break;
+                case PROP_TONEMAPPING_INTENSITY:
+                    curve.tonemapping.intensity = static_cast<float>(g_value_get_double(value));
+                    break;
+                case PROP_TONEMAPPING_BRIGHTNESS:
+                    curve.tonemapping.global_brightness_factor =
+                        static_cast<float>(g_value_get_double(value));
+                    break;
+            }
+            ctx.set_tone_curve(curve);
+            break;
+        }
+        case PROP_TENSOR_MEAN:
+        case PROP_TENSOR_STD:
+        {
+            auto& ctx = get_gst_elem_reference(self);
+            auto norm = ctx.get_tensor_normalization();
+
+            float values[3] = {};
+            if (!get_tensor_values(*value, values))
+            {
+                GST_WARNING_OBJECT(self, "%s needs 3 numbers in r, g, b order", pspec->name);
+                break;
+            }
+            if (prop_id == PROP_TENSOR_STD)
+            {
+                if (std::any_of(
+                        std::begin(values), std::end(values), [](float v) { return !(v > 0.f); }))
+                {
+                    GST_WARNING_OBJECT(self, "tensor-std values must be greater than 0");
+                    break;
+                }
+                std::copy(std::begin(values), std::end(values), norm.std_dev);
+            }
+            else
+            {
+                std::copy(std::begin(values), std::end(values), norm.mean);
+            }
+            ctx.set_tensor_normalization(norm);
+            break;
+        }
+        case PROP_ROIS:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "rois can only be changed in READY or lower");
+                break;
+            }
+            std::vector<img::rect> rois;
+            if (!get_roi_values(*value, rois))
+            {
+                GST_WARNING_OBJECT(self, "rois needs groups of 4 numbers: x, y, width, height");
+                break;
+            }
+            get_gst_elem_reference(self).set_rois(std::move(rois));
+            break;
+        }
+        case PROP_DEFECT_PIXEL_FILE:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self,
+                                   "defect-pixel-file can only be changed in READY or lower");
+                break;
+            }
+            const char* filename = g_value_get_string(value);
+            std::string error;
+            if (!get_gst_elem_reference(self).set_defect_pixel_file(filename ? filename : "",
+                                                                    error))
+            {
+                GST_WARNING_OBJECT(self, "%s", error.c_str());
+            }
+            break;
+        }
+        case PROP_FLAT_FIELD_FILE:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "flat-field-file can only be changed in READY or lower");
+                break;
+            }
+            const char* filename = g_value_get_string(value);
+            std::string error;
+            if (!get_gst_elem_reference(self).set_flat_field_file(filename ? filename : "", error))
+            {
+                GST_WARNING_OBJECT(self, "%s", error.c_str());
+            }
+            break;
+        }
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
-static void gst_tcamconvert_get_property(GObject* object __attribute__((unused)),
+static void gst_tcamconvert_get_property(GObject* object,
                                          guint prop_id,
-                                         GValue* value __attribute__((unused)),
+                                         GValue* value,
                                          GParamSpec* pspec)
 {
+    auto self = GST_TCAMCONVERT(object);
 
     switch (prop_id)
     {
+        case PROP_N_THREADS:
+        {
+            g_value_set_int(value, get_gst_elem_reference(self).get_thread_count());
+            break;
+        }
+        case PROP_KERNEL:
+        {
+            g_value_set_string(value, get_gst_elem_reference(self).get_kernel_description().c_str());
+            break;
+        }
+        case PROP_USE_GPU:
+        {
+            g_value_set_boolean(value, get_gst_elem_reference(self).get_use_gpu());
+            break;
+        }
+        case PROP_M2M_DEVICE:
+        {
+            g_value_set_string(value, get_gst_elem_reference(self).get_m2m_device().c_str());
+            break;
+        }
+        case PROP_GAMMA:
+        {
+            g_value_set_double(value, get_gst_elem_reference(self).get_tone_curve().gamma);
+            break;
+        }
+        case PROP_CONTRAST:
+        {
+            g_value_set_double(value, get_gst_elem_reference(self).get_tone_curve().contrast);
+            break;
+        }
+        case PROP_TONEMAPPING:
+        {
+            g_value_set_boolean(value,
+                                get_gst_elem_reference(self).get_tone_curve().tonemapping.enable);
+            break;
+        }
+        case PROP_TONEMAPPING_INTENSITY:
+        {
+            g_value_set_double(value,
+                               get_gst_elem_reference(self).get_tone_curve().tonemapping.intensity);
+            break;
+        }
+        case PROP_TONEMAPPING_BRIGHTNESS:
+        {
+            g_value_set_double(
+                value,
+                get_gst_elem_reference(self).get_tone_curve().tonemapping.global_brightness_factor);
+            break;
+        }
+        case PROP_TENSOR_MEAN:
+        {
+            set_tensor_values(*value, get_gst_elem_reference(self).get_tensor_normalization().mean);
+            break;
+        }
+        case PROP_TENSOR_STD:
+        {
+            set_tensor_values(*value,
+                              get_gst_elem_reference(self).get_tensor_normalization().std_dev);
+            break;
+        }
+        case PROP_ROIS:
+        {
+            set_roi_values(*value, get_gst_elem_reference(self).get_rois());
+            break;
+        }
+        case PROP_DEFECT_PIXEL_FILE:
+        {
+            g_value_set_string(value,
+                               get_gst_elem_reference(self).get_defect_pixel_file().c_str());
+            break;
+        }
+        case PROP_FLAT_FIELD_FILE:
+        {
+            g_value_set_string(value, get_gst_elem_reference(self).get_flat_field_file().c_str());
+            break;
+        }
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
+// yuv matrix and range of outcaps, false for yuv output without a GstVideoInfo
+static bool get_yuv_colorimetry(GstCaps& outcaps,
+                                const img::img_type& dst,
+                                const GstVideoInfo* dst_video_info,
+                                img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    if (dst.fourcc_type() == img::fourcc::YUVF32PLANAR)
+    {
+        // has no GstVideoFormat, full range unless the caps name a colorimetry
+        yuv_colorimetry.full_range = true;
+
+        GstVideoColorimetry colorimetry;
+        const char* colorimetry_str =
+            gst_structure_get_string(gst_caps_get_structure(&outcaps, 0), "colorimetry");
+        if (colorimetry_str && gst_video_colorimetry_from_string(&colorimetry, colorimetry_str))
+        {
+            if (colorimetry.matrix == GST_VIDEO_COLOR_MATRIX_BT709)
+            {
+                yuv_colorimetry.matrix =
+                    img_filter::transform::by_edge::yuv_colorimetry::matrix_type::bt709;
+            }
+            yuv_colorimetry.full_range = colorimetry.range != GST_VIDEO_COLOR_RANGE_16_235;
+        }
+    }
+    else if (img::is_yuv_format(dst.fourcc_type()))
+    {
+        // fills in the default colorimetry for the resolution when the caps have none
+        if (!dst_video_info)
+        {
+            return false;
+        }
+        if (dst_video_info->colorimetry.matrix == GST_VIDEO_COLOR_MATRIX_BT709)
+        {
+            yuv_colorimetry.matrix =
+                img_filter::transform::by_edge::yuv_colorimetry::matrix_type::bt709;
+        }
+        yuv_colorimetry.full_range =
+            dst_video_info->colorimetry.range == GST_VIDEO_COLOR_RANGE_0_255;
+    }
+    return true;
+}
+
 static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps, GstCaps* outcaps)
 {
     GstTCamConvert* self = GST_TCAMCONVERT(base);
@@ -97,7 +477,19 @@ static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps
         return FALSE;
     }
 
-    if (!elem.setup(src, dst))
+    // fails for bayer output
+    elem.dst_has_video_info_ = gst_video_info_from_caps(&elem.dst_video_info_, outcaps);
+
+    img_filter::transform::by_edge::yuv_colorimetry yuv_colorimetry;
+    if (!get_yuv_colorimetry(*outcaps,
+                             dst,
+                             elem.dst_has_video_info_ ? &elem.dst_video_info_ : nullptr,
+                             yuv_colorimetry))
+    {
+        return FALSE;
+    }
+
+    if (!elem.setup(src, dst, yuv_colorimetry))
     {
         GST_ELEMENT_ERROR(self,
                           STREAM,
@@ -108,24 +500,131 @@ static gboolean gst_tcamconvert_set_caps(GstBaseTransform* base, GstCaps* incaps
                           (NULL));
         return FALSE;
     }
+
+    GST_INFO_OBJECT(self,
+                    "Converting %s to %s with: %s",
+                    img::fcc_to_string(src.type).c_str(),
+                    img::fcc_to_string(dst.type).c_str(),
+                    elem.get_kernel_description().c_str());
+
+    elem.renegotiate_previews();
     return TRUE;
 }
 
 
-static void create_fmt(GstCaps* res_caps,
-                       const GstStructure* structure,
-                       img::fourcc fourcc,
-                       GstPadDirection direction)
+// multiplies or divides the int or int range field by factor, false when that does not result in whole, even values
+static bool scale_dimension_field(GstStructure* structure, const char* name, int factor, bool divide)
 {
-    std::vector<img::fourcc> vec;
-    if (direction == GST_PAD_SRC)
+    auto scale = [factor, divide](int value, int& res)
+    {
+        if (divide)
+        {
+            res = value / factor;
+            return value % factor == 0 && res % 2 == 0;
+        }
+        if (value > G_MAXINT / factor)
+        {
+            return false;
+        }
+        res = value * factor;
+        return value % 2 == 0;
+    };
+
+    const GValue* val = gst_structure_get_value(structure, name);
+    if (!val)
+    {
+        return false;
+    }
+    if (G_VALUE_HOLDS_INT(val))
     {
-        vec = tcamconvert::tcamconvert_get_supported_input_fccs(fourcc);
+        int res = 0;
+        if (!scale(g_value_get_int(val), res))
+        {
+            return false;
+        }
+        gst_structure_set(structure, name, G_TYPE_INT, res, nullptr);
+        return true;
+    }
+    if (GST_VALUE_HOLDS_INT_RANGE(val))
+    {
+        int min = gst_value_get_int_range_min(val);
+        int max = gst_value_get_int_range_max(val);
+        if (divide)
+        {
+            // round the range inwards to values that are a multiple of factor
+            min = ((min + factor - 1) / factor) * factor;
+            max = (max / factor) * factor;
+        }
+        else
+        {
+            max = std::min(max, G_MAXINT / factor);
+        }
+        if (min > max)
+        {
+            return false;
+        }
+        min = divide ? min / factor : min * factor;
+        max = divide ? max / factor : max * factor;
+        if (min == max)
+        {
+            gst_structure_set(structure, name, G_TYPE_INT, min, nullptr);
+        }
+        else
+        {
+            gst_structure_set(structure, name, GST_TYPE_INT_RANGE, min, max, nullptr);
+        }
+        return true;
+    }
+    return false;
+}
+
+// with ROIs the output has the stacked dim of the rects and the input has to contain all of them
+static bool set_roi_dimension_fields(GstStructure* structure,
+                                     const std::vector<img::rect>& rois,
+                                     GstPadDirection direction)
+{
+    const auto extent = tcamconvert::calc_roi_extent(rois);
+    if (direction == GST_PAD_SINK)
+    {
+        int width = 0;
+        int height = 0;
+        if ((gst_structure_get_int(structure, "width", &width) && width < extent.cx)
+            || (gst_structure_get_int(structure, "height", &height) && height < extent.cy))
+        {
+            return false;
+        }
+
+        const auto dim = tcamconvert::calc_roi_output_dim(rois);
+        gst_structure_set(
+            structure, "width", G_TYPE_INT, dim.cx, "height", G_TYPE_INT, dim.cy, nullptr);
     }
     else
     {
-        vec = tcamconvert::tcamconvert_get_supported_output_fccs(fourcc);
+        gst_structure_set(structure,
+                          "width",
+                          GST_TYPE_INT_RANGE,
+                          extent.cx,
+                          G_MAXINT,
+                          "height",
+                          GST_TYPE_INT_RANGE,
+                          extent.cy,
+                          G_MAXINT,
+                          nullptr);
     }
+    return true;
+}
+
+static void create_fmt(GstCaps* res_caps,
+                       const GstStructure* structure,
+                       img::fourcc fourcc,
+                       GstPadDirection direction,
+                       const std::vector<img::rect>& rois)
+{
+    const auto& vec = direction == GST_PAD_SRC
+                          ? tcamconvert::tcamconvert_get_supported_input_fccs(fourcc)
+                          : tcamconvert::tcamconvert_get_supported_output_fccs(fourcc);
+
+    GstCaps* binned_caps = gst_caps_new_empty();
 
     for (const auto& fcc : vec)
     {
@@ -136,10 +635,17 @@ static void create_fmt(GstCaps* res_caps,
             continue;
         }
 
+        auto src_fcc = direction == GST_PAD_SRC ? fcc : fourcc;
+        auto dst_fcc = direction == GST_PAD_SRC ? fourcc : fcc;
+        if (!rois.empty() && !tcamconvert::is_roi_dst_fcc(dst_fcc))
+        {
+            continue;
+        }
+
         // copy the incoming structure
         // and replace name and (if used) format
         // this way all additional information (width, fps, binning, etc) are preserved
-        // we do not touch these information as we do not resize, etc the GstBuffer
+        // only the binned entries below change the dimensions
 
         GstStructure* tmp_struc = gst_structure_copy(structure);
 
@@ -150,14 +656,53 @@ static void create_fmt(GstCaps* res_caps,
             gst_structure_set(tmp_struc, "format", G_TYPE_STRING, caps_fmt.format_entry, nullptr);
         }
 
+        // ROIs are not binned
+        if (!rois.empty())
+        {
+            if (set_roi_dimension_fields(tmp_struc, rois, direction))
+            {
+                gst_caps_append_structure(res_caps, tmp_struc);
+            }
+            else
+            {
+                gst_structure_free(tmp_struc);
+            }
+            continue;
+        }
+
+        if (tcamconvert::tcamconvert_can_bin(src_fcc, dst_fcc))
+        {
+            // the output of the binned conversion is smaller than the input
+            for (int factor : tcamconvert::binning_factors)
+            {
+                GstStructure* binned_struc = gst_structure_copy(tmp_struc);
+
+                const bool divide = direction == GST_PAD_SINK;
+                if (scale_dimension_field(binned_struc, "width", factor, divide)
+                    && scale_dimension_field(binned_struc, "height", factor, divide))
+                {
+                    gst_caps_append_structure(binned_caps, binned_struc);
+                }
+                else
+                {
+                    gst_structure_free(binned_struc);
+                }
+            }
+        }
+
         // gst_caps_new_full takes ownership of tmp_struc
         GstCaps* caps_to_add = gst_caps_new_full(tmp_struc, nullptr);
 
         gst_caps_append(res_caps, caps_to_add);
     }
+
+    // after the unscaled entries, so that these are preferred in the negotiation
+    gst_caps_append(res_caps, binned_caps);
 }
 
-static GstCaps* transform_caps(GstCaps* caps, GstPadDirection direction)
+static GstCaps* transform_caps(GstCaps* caps,
+                               GstPadDirection direction,
+                               const std::vector<img::rect>& rois)
 {
     GstCaps* res_caps = gst_caps_new_empty();
 
@@ -169,7 +714,7 @@ static GstCaps* transform_caps(GstCaps* caps, GstPadDirection direction)
         auto fcc_vec = gst_helper::convert_GstStructure_to_fcc_list(*structure);
 
         // for every entry in fcc_vec create a GstCaps that is appended to res_caps
-        for (auto&& fcc : fcc_vec) { create_fmt(res_caps, structure, fcc, direction); }
+        for (auto&& fcc : fcc_vec) { create_fmt(res_caps, structure, fcc, direction, rois); }
     }
 
     // res_caps = gst_caps_simplify(res_caps); // This seems to simplify in a 'curious' way, so we should not use this here
@@ -195,7 +740,19 @@ static GstCaps* gst_tcamconvert_transform_caps(GstBaseTransform* base,
         return dir == GST_PAD_SRC ? "GST_PAD_SRC" : "GST_PAD_SINK";
     };
 
-    GstCaps* res_caps = transform_caps(caps, direction);
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(base));
+
+    // fixed caps are repeated during negotiation, the other ones change with the peer
+    const bool is_fixed = gst_caps_is_fixed(caps);
+    GstCaps* res_caps = is_fixed ? elem.find_transformed_caps(direction, *caps) : nullptr;
+    if (!res_caps)
+    {
+        res_caps = transform_caps(caps, direction, elem.get_rois());
+        if (is_fixed)
+        {
+            elem.store_transformed_caps(direction, *caps, *res_caps);
+        }
+    }
     if (filter)
     {
         GstCaps* tmp_caps = res_caps;
@@ -218,6 +775,34 @@ static GstCaps* gst_tcamconvert_transform_caps(GstBaseTransform* base,
     return res_caps;
 }
 
+// tensor lines start on 64 byte boundaries for direct gpu/npu uploads,
+// the r, g and b planes follow each other
+static const constexpr int tensor_row_alignment = 64;
+
+static int calc_tensor_pitch(const img::img_type& type) noexcept
+{
+    const int min_pitch = img::calc_minimum_pitch(type.fourcc_type(), type.dim.cx);
+    return ((min_pitch + tensor_row_alignment - 1) / tensor_row_alignment) * tensor_row_alignment;
+}
+
+static size_t calc_tensor_size(const img::img_type& type) noexcept
+{
+    return static_cast<size_t>(calc_tensor_pitch(type)) * type.dim.cy * 3;
+}
+
+static img::img_descriptor make_tensor_img_desc(const img::img_type& type, guint8* data) noexcept
+{
+    const int pitch = calc_tensor_pitch(type);
+
+    img::img_planar_layout_data layout;
+    for (int i = 0; i < 3; ++i)
+    {
+        layout.planes[i] = img::img_plane { data + i * pitch * type.dim.cy, pitch };
+    }
+    return img::make_img_desc_raw(
+        type.fourcc_type(), type.dim, static_cast<int>(calc_tensor_size(type)), layout);
+}
+
 static gboolean gst_tcamconvert_get_unit_size(GstBaseTransform* trans, GstCaps* caps, gsize* size)
 {
     GstStructure* structure = gst_caps_get_structure(caps, 0);
@@ -233,6 +818,19 @@ static gboolean gst_tcamconvert_get_unit_size(GstBaseTransform* trans, GstCaps*
         return FALSE;
     }
     size_t img_size = img::calc_minimum_img_size(type.fourcc_type(), type.dim);
+    if (img_filter::transform::tensor::is_tensor_fcc(type.fourcc_type()))
+    {
+        img_size = calc_tensor_size(type);
+    }
+    else if (img::is_yuv_format(type.fourcc_type()))
+    {
+        // includes the padding of the planes
+        GstVideoInfo info;
+        if (gst_video_info_from_caps(&info, caps))
+        {
+            img_size = GST_VIDEO_INFO_SIZE(&info);
+        }
+    }
     if (img_size == 0)
     {
         GST_ELEMENT_ERROR(trans,
@@ -257,33 +855,277 @@ static gboolean gst_tcamconvert_transform_size(GstBaseTransform* trans,
     return gst_tcamconvert_get_unit_size(trans, othercaps, othersize);
 }
 
-static int get_mapped_stride(GstBuffer* buffer_) noexcept
+static GstVideoMeta* get_video_meta_with_stride(GstBuffer* buffer_) noexcept
 {
-    auto video_meta_ptr = reinterpret_cast<GstVideoMeta*>(
-        gst_buffer_get_meta(buffer_, gst_video_meta_api_get_type()));
+    auto video_meta_ptr = gst_buffer_get_video_meta(buffer_);
     if (video_meta_ptr != nullptr && video_meta_ptr->stride[0] != 0)
     {
-        return video_meta_ptr->stride[0];
+        return video_meta_ptr;
+    }
+    return nullptr;
+}
+
+static img::img_descriptor make_img_desc_from_video_meta(const img::img_type& type,
+                                                         guint8* map_data,
+                                                         const GstVideoMeta& meta)
+{
+    img::img_planar_layout_data layout;
+    for (guint i = 0; i < meta.n_planes; ++i)
+    {
+        layout.planes[i] = img::img_plane { map_data + meta.offset[i], meta.stride[i] };
     }
-    return 0;
+    return img::make_img_desc_raw(type, layout);
 }
 
 static img::img_descriptor make_img_desc_from_input_buffer(const img::img_type& src_type,
                                                            guint8* map_in_data,
                                                            GstBuffer* inbuf)
 {
-    if (int actual_src_stride = get_mapped_stride(inbuf); actual_src_stride)
+    if (auto meta = get_video_meta_with_stride(inbuf))
     {
-        return img::make_img_desc_raw(src_type, img::img_plane { map_in_data, actual_src_stride });
+        return make_img_desc_from_video_meta(src_type, map_in_data, *meta);
     }
     return img::make_img_desc_from_linear_memory(
         src_type, map_in_data); // no explicit stride mentioned, so assume linear memory
 }
 
+// the layout get_unit_size computes the size for, yuv planes follow dst_video_info
+static img::img_descriptor make_img_desc_from_layout(const img::img_type& dst_type,
+                                                     const GstVideoInfo* dst_video_info,
+                                                     guint8* map_out_data)
+{
+    if (img_filter::transform::tensor::is_tensor_fcc(dst_type.fourcc_type()))
+    {
+        return make_tensor_img_desc(dst_type, map_out_data);
+    }
+    if (!img::is_yuv_format(dst_type.fourcc_type()) || !dst_video_info)
+    {
+        return img::make_img_desc_from_linear_memory(dst_type, map_out_data);
+    }
+
+    img::img_planar_layout_data layout;
+    for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(dst_video_info); ++i)
+    {
+        layout.planes[i] =
+            img::img_plane { map_out_data + GST_VIDEO_INFO_PLANE_OFFSET(dst_video_info, i),
+                             GST_VIDEO_INFO_PLANE_STRIDE(dst_video_info, i) };
+    }
+    return img::make_img_desc_raw(dst_type, layout);
+}
+
+static img::img_descriptor make_img_desc_from_output_buffer(
+    const tcamconvert::tcamconvert_context_base& elem,
+    guint8* map_out_data,
+    GstBuffer* outbuf)
+{
+    // set by the GstVideoBufferPool from decide_allocation, may contain padding downstream asked for
+    if (auto meta = get_video_meta_with_stride(outbuf))
+    {
+        return make_img_desc_from_video_meta(elem.dst_type_, map_out_data, *meta);
+    }
+
+    auto dst = make_img_desc_from_layout(
+        elem.dst_type_, elem.dst_has_video_info_ ? &elem.dst_video_info_ : nullptr, map_out_data);
+
+    if (elem.dst_video_meta_ && elem.dst_has_video_info_)
+    {
+        // the linear layout differs from the GstVideoInfo default for widths that are not a multiple of 4
+        const GstVideoInfo& info = elem.dst_video_info_;
+
+        gsize offset[GST_VIDEO_MAX_PLANES] = {};
+        gint stride[GST_VIDEO_MAX_PLANES] = {};
+        for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(&info); ++i)
+        {
+            offset[i] = static_cast<guint8*>(dst.data_.planes[i].plane_ptr) - map_out_data;
+            stride[i] = dst.data_.planes[i].pitch;
+        }
+        gst_buffer_add_video_meta_full(outbuf,
+                                       GST_VIDEO_FRAME_FLAG_NONE,
+                                       GST_VIDEO_INFO_FORMAT(&info),
+                                       GST_VIDEO_INFO_WIDTH(&info),
+                                       GST_VIDEO_INFO_HEIGHT(&info),
+                                       GST_VIDEO_INFO_N_PLANES(&info),
+                                       offset,
+                                       stride);
+    }
+    return dst;
+}
+
+static gboolean gst_tcamconvert_propose_allocation(GstBaseTransform* base,
+                                                   GstQuery* decide_query,
+                                                   GstQuery* query)
+{
+    if (!GST_BASE_TRANSFORM_CLASS(parent_class)->propose_allocation(base, decide_query, query))
+    {
+        return FALSE;
+    }
+    // make_img_desc_from_input_buffer honors the stride of the input
+    gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+    return TRUE;
+}
+
+static gboolean gst_tcamconvert_decide_allocation(GstBaseTransform* base, GstQuery* query)
+{
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(base));
+
+    elem.dst_video_meta_ =
+        elem.dst_has_video_info_
+        && gst_query_find_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+
+    if (!elem.dst_video_meta_)
+    {
+        if (img_filter::transform::tensor::is_tensor_fcc(elem.dst_type_.fourcc_type()))
+        {
+            // the buffer starts on a tensor_row_alignment boundary like the lines
+            GstAllocator* allocator = nullptr;
+            GstAllocationParams params;
+            gst_allocation_params_init(&params);
+            const bool has_params = gst_query_get_n_allocation_params(query) > 0;
+            if (has_params)
+            {
+                gst_query_parse_nth_allocation_param(query, 0, &allocator, &params);
+            }
+            params.align = std::max(params.align, static_cast<gsize>(tensor_row_alignment - 1));
+            if (has_params)
+            {
+                gst_query_set_nth_allocation_param(query, 0, allocator, &params);
+            }
+            else
+            {
+                gst_query_add_allocation_param(query, nullptr, &params);
+            }
+            if (allocator)
+            {
+                gst_object_unref(allocator);
+            }
+        }
+        return GST_BASE_TRANSFORM_CLASS(parent_class)->decide_allocation(base, query);
+    }
+
+    GstCaps* outcaps = nullptr;
+    gst_query_parse_allocation(query, &outcaps, nullptr);
+
+    GstAllocator* allocator = nullptr;
+    GstAllocationParams params;
+    gst_allocation_params_init(&params);
+    if (gst_query_get_n_allocation_params(query) > 0)
+    {
+        gst_query_parse_nth_allocation_param(query, 0, &allocator, &params);
+    }
+
+    GstBufferPool* pool = nullptr;
+    guint size = 0;
+    guint min = 0;
+    guint max = 0;
+    if (gst_query_get_n_allocation_pools(query) > 0)
+    {
+        gst_query_parse_nth_allocation_pool(query, 0, &pool, &size, &min, &max);
+    }
+
+    // only a video pool lays out the lines as downstream wants them
+    if (pool && !gst_buffer_pool_has_option(pool, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT))
+    {
+        gst_object_unref(pool);
+        pool = nullptr;
+    }
+    if (!pool)
+    {
+        pool = gst_video_buffer_pool_new();
+    }
+
+    // the allocation alignment of downstream is used for the row pitch,
+    // e.g. 63 or 127 for the uploads of gpu elements and encoders
+    GstVideoInfo info = elem.dst_video_info_;
+    GstVideoAlignment align;
+    gst_video_alignment_reset(&align);
+    for (guint i = 0; i < GST_VIDEO_INFO_N_PLANES(&info); ++i) { align.stride_align[i] = params.align; }
+    gst_video_info_align(&info, &align);
+
+    size = std::max(size, static_cast<guint>(GST_VIDEO_INFO_SIZE(&info)));
+
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, outcaps, size, min, max);
+    gst_buffer_pool_config_set_allocator(config, allocator, &params);
+    gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+    gst_buffer_pool_config_add_option(config, GST_BUFFER_POOL_OPTION_VIDEO_ALIGNMENT);
+    gst_buffer_pool_config_set_video_alignment(config, &align);
+
+    const bool configured = gst_buffer_pool_set_config(pool, config);
+    if (allocator)
+    {
+        gst_object_unref(allocator);
+    }
+    if (!configured)
+    {
+        GST_INFO_OBJECT(base, "Unable to configure a padded video pool, using the default pool");
+        gst_object_unref(pool);
+        return GST_BASE_TRANSFORM_CLASS(parent_class)->decide_allocation(base, query);
+    }
+
+    GST_DEBUG_OBJECT(base,
+                     "Output stride %d with alignment %zu",
+                     GST_VIDEO_INFO_PLANE_STRIDE(&info, 0),
+                     params.align + 1);
+
+    if (gst_query_get_n_allocation_pools(query) > 0)
+    {
+        gst_query_set_nth_allocation_pool(query, 0, pool, size, min, max);
+    }
+    else
+    {
+        gst_query_add_allocation_pool(query, pool, size, min, max);
+    }
+    gst_object_unref(pool);
+
+    return TRUE;
+}
+
+// one region meta per rect with its place in the output, "tcam-roi" has its position in the input
+static void add_roi_metas(GstBuffer* outbuf, const std::vector<img::rect>& rois)
+{
+    guint y = 0;
+    for (size_t i = 0; i < rois.size(); ++i)
+    {
+        const auto dim = rois[i].dimensions();
+        auto meta =
+            gst_buffer_add_video_region_of_interest_meta(outbuf, "tcam-roi", 0, y, dim.cx, dim.cy);
+        meta->id = static_cast<gint>(i);
+        gst_video_region_of_interest_meta_add_param(meta,
+                                                    gst_structure_new("tcam-roi",
+                                                                      "source-x",
+                                                                      G_TYPE_INT,
+                                                                      rois[i].left,
+                                                                      "source-y",
+                                                                      G_TYPE_INT,
+                                                                      rois[i].top,
+                                                                      nullptr));
+        y += dim.cy;
+    }
+}
+
+// buffers with a single dmabuf memory can be passed to the mem2mem device without a copy
+static tcamconvert::dmabuf_view get_dmabuf_view([[maybe_unused]] GstBuffer* buffer,
+                                                [[maybe_unused]] const GstMapInfo& map)
+{
+#if defined HAVE_V4L2_M2M
+    if (gst_buffer_n_memory(buffer) == 1)
+    {
+        GstMemory* mem = gst_buffer_peek_memory(buffer, 0);
+        if (gst_is_dmabuf_memory(mem) && mem->offset == 0)
+        {
+            return { gst_dmabuf_memory_get_fd(mem), map.data, map.size };
+        }
+    }
+#endif
+    return {};
+}
+
 static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
                                                GstBuffer* inbuf,
                                                GstBuffer* outbuf)
 {
+    TCAM_TRACE_SCOPE("tcamconvert transform");
+
     auto self = GST_TCAMCONVERT(base);
     auto& elem = get_gst_elem_reference(self);
 
@@ -304,13 +1146,48 @@ static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
     }
 
     auto src = make_img_desc_from_input_buffer(elem.src_type_, map_in.data, inbuf);
-    auto dst = img::make_img_desc_from_linear_memory(elem.dst_type_, map_out.data);
+    auto dst = make_img_desc_from_output_buffer(elem, map_out.data, outbuf);
+
+    const uint64_t begin_ns = tcam::latency::stamp();
 
-    elem.transform(src, dst);
+    elem.transform(src, dst, get_dmabuf_view(inbuf, map_in), get_dmabuf_view(outbuf, map_out));
 
     gst_buffer_unmap(outbuf, &map_out);
     gst_buffer_unmap(inbuf, &map_in);
 
+    if (!elem.get_rois().empty())
+    {
+        add_roi_metas(outbuf, elem.get_rois());
+    }
+
+    if (begin_ns != 0)
+    {
+        const uint64_t end_ns = tcam::latency::now_ns();
+        elem.conversion_latency_.add(begin_ns, end_ns);
+
+        // the metas were copied from inbuf in copy_metadata
+        GstMeta* values_meta =
+            gst_buffer_get_meta(outbuf, g_type_from_name("TcamStatisticsValuesMetaApi"));
+        if (values_meta)
+        {
+            ((TcamStatisticsValuesMeta*)values_meta)->values.tcamconvert_begin_ns = begin_ns;
+            ((TcamStatisticsValuesMeta*)values_meta)->values.tcamconvert_end_ns = end_ns;
+        }
+        auto meta = (TcamStatisticsMeta*)gst_buffer_get_meta(
+            outbuf, g_type_from_name("TcamStatisticsMetaApi"));
+        if (meta && meta->structure)
+        {
+            gst_structure_set(meta->structure,
+                              "tcamconvert_begin_ns",
+                              G_TYPE_UINT64,
+                              begin_ns,
+                              "tcamconvert_end_ns",
+                              G_TYPE_UINT64,
+                              end_ns,
+                              nullptr);
+        }
+    }
+
     return GST_FLOW_OK;
 }
 
@@ -388,6 +1265,455 @@ static gboolean gst_tcamconvert_copy_metadata(GstBaseTransform* base,
     return TRUE;
 }
 
+using preview_output = tcamconvert::tcamconvert_context_base::preview_output;
+
+// stream-start of the preview, in the group of the input stream
+static void push_preview_stream_start(GstTCamConvert* self, preview_output& preview)
+{
+    GstPad* pad = preview.pad.get();
+
+    gchar* stream_id = gst_pad_create_stream_id(pad, GST_ELEMENT(self), GST_PAD_NAME(pad));
+    GstEvent* event = gst_event_new_stream_start(stream_id);
+    g_free(stream_id);
+
+    GstEvent* upstream =
+        gst_pad_get_sticky_event(GST_BASE_TRANSFORM_SINK_PAD(self), GST_EVENT_STREAM_START, 0);
+    if (upstream)
+    {
+        guint group_id = 0;
+        if (gst_event_parse_group_id(upstream, &group_id))
+        {
+            gst_event_set_group_id(event, group_id);
+        }
+        gst_event_unref(upstream);
+    }
+
+    gst_pad_push_event(pad, event);
+    preview.stream_started = true;
+}
+
+// caps of the preview from its peer and the current input, then the pool for them
+static bool negotiate_preview(GstTCamConvert* self, preview_output& preview)
+{
+    auto& elem = get_gst_elem_reference(self);
+    GstPad* pad = preview.pad.get();
+
+    preview.negotiated = false;
+
+    gst_helper::gst_ptr<GstCaps> incaps =
+        gst_helper::make_consume_ptr(gst_pad_get_current_caps(GST_BASE_TRANSFORM_SINK_PAD(self)));
+    if (!incaps)
+    {
+        return false;
+    }
+    gst_helper::gst_ptr<GstCaps> allowed =
+        gst_helper::make_consume_ptr(transform_caps(incaps.get(), GST_PAD_SINK, {}));
+    gst_helper::gst_ptr<GstCaps> outcaps =
+        gst_helper::make_consume_ptr(gst_pad_peer_query_caps(pad, allowed.get()));
+    if (!outcaps || gst_caps_is_empty(outcaps.get()))
+    {
+        GST_WARNING_OBJECT(self,
+                           "%s: no common caps with %s",
+                           GST_PAD_NAME(pad),
+                           gst_helper::to_string(*allowed).c_str());
+        return false;
+    }
+    outcaps = gst_helper::make_consume_ptr(gst_caps_fixate(outcaps.release()));
+
+    auto dst = gst_helper::get_img_type_from_fixated_gstcaps(*outcaps);
+    gsize size = 0;
+    if (dst.empty()
+        || !gst_tcamconvert_get_unit_size(GST_BASE_TRANSFORM(self), outcaps.get(), &size))
+    {
+        return false;
+    }
+
+    preview.dst_has_video_info =
+        gst_video_info_from_caps(&preview.dst_video_info, outcaps.get());
+
+    img_filter::transform::by_edge::yuv_colorimetry yuv_colorimetry;
+    if (!get_yuv_colorimetry(*outcaps,
+                             dst,
+                             preview.dst_has_video_info ? &preview.dst_video_info : nullptr,
+                             yuv_colorimetry)
+        || !elem.setup_preview(preview, dst, yuv_colorimetry))
+    {
+        GST_WARNING_OBJECT(self,
+                           "%s: failed to find conversion from %s to %s",
+                           GST_PAD_NAME(pad),
+                           img::fcc_to_string(elem.src_type_.type).c_str(),
+                           img::fcc_to_string(dst.type).c_str());
+        return false;
+    }
+
+    if (preview.pool)
+    {
+        gst_buffer_pool_set_active(preview.pool.get(), FALSE);
+    }
+    preview.pool = gst_helper::make_consume_ptr(gst_buffer_pool_new());
+
+    // tensor lines start on tensor_row_alignment boundaries, see make_tensor_img_desc
+    GstAllocationParams params;
+    gst_allocation_params_init(&params);
+    params.align = tensor_row_alignment - 1;
+
+    GstStructure* config = gst_buffer_pool_get_config(preview.pool.get());
+    gst_buffer_pool_config_set_params(config, outcaps.get(), static_cast<guint>(size), 2, 0);
+    gst_buffer_pool_config_set_allocator(config, nullptr, &params);
+    if (!gst_buffer_pool_set_config(preview.pool.get(), config)
+        || !gst_buffer_pool_set_active(preview.pool.get(), TRUE))
+    {
+        GST_WARNING_OBJECT(self, "%s: failed to activate the buffer pool", GST_PAD_NAME(pad));
+        preview.pool.reset();
+        return false;
+    }
+
+    if (!preview.stream_started)
+    {
+        push_preview_stream_start(self, preview);
+    }
+    if (!gst_pad_set_caps(pad, outcaps.get()))
+    {
+        return false;
+    }
+    if (!preview.segment_pushed)
+    {
+        // later segments are forwarded by gst_tcamconvert_sink_event
+        if (GstEvent* segment = gst_pad_get_sticky_event(
+                GST_BASE_TRANSFORM_SINK_PAD(self), GST_EVENT_SEGMENT, 0))
+        {
+            gst_pad_push_event(pad, segment);
+            preview.segment_pushed = true;
+        }
+    }
+
+    GST_INFO_OBJECT(self,
+                    "%s: converting %s to %s with: %s",
+                    GST_PAD_NAME(pad),
+                    img::fcc_to_string(elem.src_type_.type).c_str(),
+                    img::fcc_to_string(dst.type).c_str(),
+                    preview.trans.kernel_description().c_str());
+
+    preview.negotiated = true;
+    return true;
+}
+
+/*
+ * Converts inbuf for every linked preview pad, before the src pad.
+ * Called for every mode of the src pad, also in passthrough, and before an in place white balance,
+ * so the previews always read the untouched input.
+ */
+static void gst_tcamconvert_before_transform(GstBaseTransform* base, GstBuffer* inbuf)
+{
+    auto self = GST_TCAMCONVERT(base);
+    auto& elem = get_gst_elem_reference(self);
+
+    auto previews = elem.get_previews();
+    if (previews.empty())
+    {
+        return;
+    }
+
+    TCAM_TRACE_SCOPE("tcamconvert previews");
+
+    std::vector<std::pair<GstPad*, GstBuffer*>> outbufs;
+
+    GstMapInfo map_in;
+    if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READ))
+    {
+        GST_ERROR_OBJECT(self, "Input buffer could not be mapped");
+        return;
+    }
+    auto src = make_img_desc_from_input_buffer(elem.src_type_, map_in.data, inbuf);
+
+    for (auto& preview : previews)
+    {
+        GstPad* pad = preview->pad.get();
+        if (!gst_pad_is_linked(pad))
+        {
+            continue;
+        }
+        // negotiation is only retried after new input caps or a reconfigure of the peer
+        if (gst_pad_check_reconfigure(pad) || preview->need_negotiation)
+        {
+            preview->need_negotiation = false;
+            negotiate_preview(self, *preview);
+        }
+        if (!preview->negotiated)
+        {
+            continue;
+        }
+
+        GstBuffer* outbuf = nullptr;
+        if (gst_buffer_pool_acquire_buffer(preview->pool.get(), &outbuf, nullptr) != GST_FLOW_OK)
+        {
+            continue;
+        }
+
+        GstMapInfo map_out;
+        if (!gst_buffer_map(outbuf, &map_out, GST_MAP_WRITE))
+        {
+            GST_ERROR_OBJECT(self, "%s: output buffer could not be mapped", GST_PAD_NAME(pad));
+            gst_buffer_unref(outbuf);
+            continue;
+        }
+        auto dst = make_img_desc_from_layout(
+            preview->dst_type,
+            preview->dst_has_video_info ? &preview->dst_video_info : nullptr,
+            map_out.data);
+
+        elem.transform_preview(*preview, src, dst);
+
+        gst_buffer_unmap(outbuf, &map_out);
+
+        gst_tcamconvert_copy_metadata(base, inbuf, outbuf);
+        outbufs.emplace_back(pad, outbuf);
+    }
+
+    gst_buffer_unmap(inbuf, &map_in);
+
+    for (auto [pad, outbuf] : outbufs)
+    {
+        // a slow or failing preview branch must not stop the src pad
+        const GstFlowReturn ret = gst_pad_push(pad, outbuf);
+        if (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED && ret != GST_FLOW_FLUSHING)
+        {
+            GST_WARNING_OBJECT(
+                self, "%s: push returned %s", GST_PAD_NAME(pad), gst_flow_get_name(ret));
+        }
+    }
+}
+
+static gboolean gst_tcamconvert_sink_event(GstBaseTransform* base, GstEvent* event)
+{
+    auto self = GST_TCAMCONVERT(base);
+    auto& elem = get_gst_elem_reference(self);
+
+    switch (GST_EVENT_TYPE(event))
+    {
+        case GST_EVENT_SEGMENT:
+        case GST_EVENT_GAP:
+        {
+            for (auto& preview : elem.get_previews())
+            {
+                // others get the sticky segment when they negotiate
+                if (preview->negotiated)
+                {
+                    gst_pad_push_event(preview->pad.get(), gst_event_ref(event));
+                    preview->segment_pushed = true;
+                }
+            }
+            break;
+        }
+        case GST_EVENT_EOS:
+        {
+            // also to previews that never negotiated, their sinks wait for it
+            for (auto& preview : elem.get_previews())
+            {
+                if (!preview->stream_started)
+                {
+                    push_preview_stream_start(self, *preview);
+                }
+                gst_pad_push_event(preview->pad.get(), gst_event_ref(event));
+            }
+            break;
+        }
+        case GST_EVENT_FLUSH_START:
+        case GST_EVENT_FLUSH_STOP:
+        {
+            for (auto& preview : elem.get_previews())
+            {
+                if (preview->stream_started)
+                {
+                    gst_pad_push_event(preview->pad.get(), gst_event_ref(event));
+                }
+                if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP)
+                {
+                    // flush-stop removes the segment, upstream sends a new one
+                    preview->segment_pushed = false;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return GST_BASE_TRANSFORM_CLASS(parent_class)->sink_event(base, event);
+}
+
+/*
+ * GstBaseTransform only handles single buffers and pushes every result on its own.
+ * Lists, e.g. from tcammainsrc batch-size, are converted buffer by buffer through
+ * submit_input_buffer/generate_output and the results leave with one push.
+ */
+static GstFlowReturn gst_tcamconvert_chain_list(GstPad* /*pad*/,
+                                                GstObject* parent,
+                                                GstBufferList* list)
+{
+    TCAM_TRACE_SCOPE("tcamconvert chain_list");
+
+    auto base = GST_BASE_TRANSFORM(parent);
+    auto klass = GST_BASE_TRANSFORM_GET_CLASS(base);
+
+    // the list would hold a second reference and make every input buffer read only
+    const guint length = gst_buffer_list_length(list);
+    std::vector<GstBuffer*> input;
+    input.reserve(length);
+    for (guint i = 0; i < length; ++i)
+    {
+        input.push_back(gst_buffer_ref(gst_buffer_list_get(list, i)));
+    }
+    gst_buffer_list_unref(list);
+
+    GstBufferList* output = gst_buffer_list_new_sized(length);
+
+    GstFlowReturn ret = GST_FLOW_OK;
+    auto iter = input.begin();
+    for (; iter != input.end() && ret == GST_FLOW_OK; ++iter)
+    {
+        const bool is_discont = GST_BUFFER_IS_DISCONT(*iter);
+
+        ret = klass->submit_input_buffer(base, is_discont, *iter);
+        while (ret == GST_FLOW_OK)
+        {
+            GstBuffer* outbuf = nullptr;
+            ret = klass->generate_output(base, &outbuf);
+            if (!outbuf)
+            {
+                break;
+            }
+            if (ret != GST_FLOW_OK)
+            {
+                gst_buffer_unref(outbuf);
+                break;
+            }
+
+            if (is_discont && !GST_BUFFER_IS_DISCONT(outbuf))
+            {
+                outbuf = gst_buffer_make_writable(outbuf);
+                GST_BUFFER_FLAG_SET(outbuf, GST_BUFFER_FLAG_DISCONT);
+            }
+            if (base->segment.format == GST_FORMAT_TIME && GST_BUFFER_PTS_IS_VALID(outbuf))
+            {
+                base->segment.position = GST_BUFFER_PTS(outbuf);
+                if (GST_BUFFER_DURATION_IS_VALID(outbuf))
+                {
+                    base->segment.position += GST_BUFFER_DURATION(outbuf);
+                }
+            }
+            gst_buffer_list_add(output, outbuf);
+        }
+    }
+    // submit_input_buffer took the others
+    for (; iter != input.end(); ++iter) { gst_buffer_unref(*iter); }
+
+    if (ret == GST_BASE_TRANSFORM_FLOW_DROPPED)
+    {
+        ret = GST_FLOW_OK;
+    }
+
+    if (gst_buffer_list_length(output) == 0)
+    {
+        gst_buffer_list_unref(output);
+        return ret;
+    }
+
+    const GstFlowReturn push_ret = gst_pad_push_list(base->srcpad, output);
+    return ret == GST_FLOW_OK ? push_ret : ret;
+}
+
+static gboolean gst_tcamconvert_preview_query(GstPad* pad, GstObject* parent, GstQuery* query)
+{
+    if (GST_QUERY_TYPE(query) != GST_QUERY_CAPS)
+    {
+        return gst_pad_query_default(pad, parent, query);
+    }
+
+    GstCaps* filter = nullptr;
+    gst_query_parse_caps(query, &filter);
+
+    // everything the current input converts to, ROIs are not applied to previews
+    GstCaps* res_caps = nullptr;
+    if (GstCaps* incaps = gst_pad_get_current_caps(GST_BASE_TRANSFORM_SINK_PAD(parent)))
+    {
+        res_caps = transform_caps(incaps, GST_PAD_SINK, {});
+        gst_caps_unref(incaps);
+    }
+    else
+    {
+        res_caps = gst_pad_get_pad_template_caps(pad);
+    }
+    if (filter)
+    {
+        GstCaps* tmp_caps = res_caps;
+        res_caps = gst_caps_intersect_full(filter, tmp_caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(tmp_caps);
+    }
+
+    gst_query_set_caps_result(query, res_caps);
+    gst_caps_unref(res_caps);
+    return TRUE;
+}
+
+static gboolean gst_tcamconvert_preview_event(GstPad* pad, GstObject* parent, GstEvent* event)
+{
+    switch (GST_EVENT_TYPE(event))
+    {
+        // the preview negotiates on its own and does not throttle the device or the src pad
+        case GST_EVENT_RECONFIGURE:
+        case GST_EVENT_QOS:
+        {
+            gst_event_unref(event);
+            return TRUE;
+        }
+        default:
+            return gst_pad_event_default(pad, parent, event);
+    }
+}
+
+static GstPad* gst_tcamconvert_request_new_pad(GstElement* element,
+                                               GstPadTemplate* templ,
+                                               const gchar* name,
+                                               const GstCaps* /*caps*/)
+{
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(element));
+
+    unsigned int id = elem.next_preview_id_;
+    if (name && sscanf(name, "preview_%u", &id) != 1)
+    {
+        GST_WARNING_OBJECT(element, "Invalid pad name %s", name);
+        return nullptr;
+    }
+    elem.next_preview_id_ = std::max(elem.next_preview_id_, id + 1);
+
+    gchar* pad_name = g_strdup_printf("preview_%u", id);
+    GstPad* pad = gst_pad_new_from_template(templ, pad_name);
+    g_free(pad_name);
+
+    gst_pad_set_query_function(pad, GST_DEBUG_FUNCPTR(gst_tcamconvert_preview_query));
+    gst_pad_set_event_function(pad, GST_DEBUG_FUNCPTR(gst_tcamconvert_preview_event));
+
+    // activates the pad when the element is already paused or playing
+    if (!gst_element_add_pad(element, pad))
+    {
+        GST_WARNING_OBJECT(element, "Pad %s already exists", GST_PAD_NAME(pad));
+        gst_object_unref(pad);
+        return nullptr;
+    }
+    elem.add_preview(*pad);
+    return pad;
+}
+
+static void gst_tcamconvert_release_pad(GstElement* element, GstPad* pad)
+{
+    auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(element));
+
+    elem.remove_preview(*pad);
+
+    gst_pad_set_active(pad, FALSE);
+    gst_element_remove_pad(element, pad);
+}
+
 static GstStateChangeReturn gst_tcamconvert_change_state(GstElement* element, GstStateChange trans)
 {
     auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(element));
@@ -400,6 +1726,24 @@ static GstStateChangeReturn gst_tcamconvert_change_state(GstElement* element, Gs
             elem.try_connect_to_source(false);
             break;
         }
+        case GST_STATE_CHANGE_PAUSED_TO_READY:
+        {
+            if (tcam::latency::is_enabled())
+            {
+                const auto p = elem.conversion_latency_.get();
+                GST_INFO_OBJECT(element,
+                                "Conversion latency over %llu frames: p50=%llu p90=%llu "
+                                "p99=%llu max=%llu ns",
+                                (unsigned long long)p.sample_count,
+                                (unsigned long long)p.p50,
+                                (unsigned long long)p.p90,
+                                (unsigned long long)p.p99,
+                                (unsigned long long)p.max);
+            }
+            elem.conversion_latency_.clear();
+            elem.reset_previews();
+            break;
+        }
         default:
             break;
     }
@@ -424,6 +1768,7 @@ static void gst_tcamconvert_init(GstTCamConvert* self)
     gst_base_transform_set_in_place(GST_BASE_TRANSFORM(self), FALSE);
 
     auto sink_pad = gst_helper::get_static_pad(*GST_ELEMENT(self), "sink");
+    gst_pad_set_chain_list_function(sink_pad.get(), GST_DEBUG_FUNCPTR(gst_tcamconvert_chain_list));
     g_signal_connect(sink_pad.get(), "linked", G_CALLBACK(gst_tcamdutils_sink_pad_linked), self);
     g_signal_connect(
         sink_pad.get(), "unlinked", G_CALLBACK(gst_tcamdutils_sink_pad_unlinked), self);
@@ -457,6 +1802,188 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
     gobject_class->dispose = gst_tcamconvert_dispose;
     gobject_class->finalize = gst_tcamconvert_finalize;
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_N_THREADS,
+        g_param_spec_int("n-threads",
+                         "Number of threads",
+                         "Number of threads used for the conversion. 0 uses one thread per core",
+                         0,
+                         64,
+                         1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_KERNEL,
+        g_param_spec_string("kernel",
+                            "Conversion kernel",
+                            "Kernels selected for the negotiated caps and the cpu features of this "
+                            "machine. Empty before caps are set",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USE_GPU,
+        g_param_spec_boolean("use-gpu",
+                             "Use GPU",
+                             "Convert with OpenCL when possible. Ignored when tcamconvert was built "
+                             "without OpenCL support",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_M2M_DEVICE,
+        g_param_spec_string("m2m-device",
+                            "V4L2 mem2mem device",
+                            "Device node of a V4L2 mem2mem converter, 'auto' probes all devices. "
+                            "Empty converts on the cpu. Ignored when tcamconvert was built "
+                            "without mem2mem support",
+                            "auto",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_GAMMA,
+        g_param_spec_double("gamma",
+                            "Gamma",
+                            "Gamma applied when 10/12/16 bit formats are converted to 8 bit. "
+                            "Output is input ^ (1 / gamma)",
+                            0.1,
+                            10.0,
+                            1.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                                     | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CONTRAST,
+        g_param_spec_double("contrast",
+                            "Contrast",
+                            "Contrast applied when 10/12/16 bit formats are converted to 8 bit. "
+                            "0 leaves the image unchanged",
+                            -1.0,
+                            1.0,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                                     | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TONEMAPPING,
+        g_param_spec_boolean("tonemapping",
+                             "Tone mapping",
+                             "Apply a global tone mapping when 10/12/16 bit formats are converted "
+                             "to 8 bit",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                                      | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TONEMAPPING_INTENSITY,
+        g_param_spec_double("tonemapping-intensity",
+                            "Tone mapping intensity",
+                            "Values above 0 lift the shadows and compress the highlights, values "
+                            "below 0 do the opposite",
+                            -8.0,
+                            8.0,
+                            1.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                                     | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TONEMAPPING_BRIGHTNESS,
+        g_param_spec_double("tonemapping-brightness",
+                            "Tone mapping brightness",
+                            "Global brightness gain applied before the tone mapping",
+                            0.0,
+                            1.0,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                                     | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TENSOR_MEAN,
+        gst_param_spec_array(
+            "tensor-mean",
+            "Tensor mean",
+            "Mean in r, g, b order subtracted from the [0;1] values of RGBPf/RGBPf16 output, "
+            "e.g. <0.485,0.456,0.406>",
+            g_param_spec_double("mean",
+                                "Mean",
+                                "Mean of one channel",
+                                -G_MAXFLOAT,
+                                G_MAXFLOAT,
+                                0.0,
+                                static_cast<GParamFlags>(G_PARAM_READWRITE
+                                                         | G_PARAM_STATIC_STRINGS)),
+            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                     | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TENSOR_STD,
+        gst_param_spec_array(
+            "tensor-std",
+            "Tensor standard deviation",
+            "Standard deviation in r, g, b order the RGBPf/RGBPf16 output is divided by, "
+            "e.g. <0.229,0.224,0.225>",
+            g_param_spec_double("std",
+                                "Standard deviation",
+                                "Standard deviation of one channel",
+                                G_MINFLOAT,
+                                G_MAXFLOAT,
+                                1.0,
+                                static_cast<GParamFlags>(G_PARAM_READWRITE
+                                                         | G_PARAM_STATIC_STRINGS)),
+            static_cast<GParamFlags>(G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING
+                                     | G_PARAM_STATIC_STRINGS)));
+
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ROIS,
+        gst_param_spec_array(
+            "rois",
+            "Regions of interest",
+            "Only convert these rects, x, y, width and height each, "
+            "e.g. <0,0,256,256,512,512,256,256>. The rects are stacked in the output. "
+            "Empty converts the whole image",
+            g_param_spec_int("value",
+                             "Value",
+                             "x, y, width or height of a rect",
+                             0,
+                             G_MAXINT,
+                             0,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)),
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEFECT_PIXEL_FILE,
+        g_param_spec_string("defect-pixel-file",
+                            "Defect pixel file",
+                            "Text file with one defect pixel of the input per line as 'x y'. "
+                            "Bayer inputs replace them by the median of their same color "
+                            "neighbours. Empty disables the correction",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FLAT_FIELD_FILE,
+        g_param_spec_string("flat-field-file",
+                            "Flat field file",
+                            "Binary PGM of an evenly lit target, taken with the same format. "
+                            "Bayer inputs are multiplied by the inverse of its shading. "
+                            "Empty disables the correction",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
     gst_element_class_set_static_metadata(
         gstelement_class,
@@ -472,6 +1999,12 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
     gst_element_class_add_pad_template(
         gstelement_class, gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS, src_caps.get()));
 
+    // additional outputs from the same input, e.g. a binned preview next to the full image
+    // each one is its own pass over the input, not a by-product of the src conversion
+    gst_element_class_add_pad_template(
+        gstelement_class,
+        gst_pad_template_new("preview_%u", GST_PAD_SRC, GST_PAD_REQUEST, src_caps.get()));
+
 
     auto sink_caps =
         gst_helper::generate_caps_with_dim(tcamconvert::tcamconvert_get_all_input_fccs());
@@ -487,11 +2020,21 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
     gst_base_transform_class->transform = GST_DEBUG_FUNCPTR(gst_tcamconvert_transform);
     gst_base_transform_class->transform_ip = GST_DEBUG_FUNCPTR(gst_tcamconvert_transform_ip);
     gst_base_transform_class->copy_metadata = GST_DEBUG_FUNCPTR(gst_tcamconvert_copy_metadata);
+    gst_base_transform_class->propose_allocation =
+        GST_DEBUG_FUNCPTR(gst_tcamconvert_propose_allocation);
+    gst_base_transform_class->decide_allocation =
+        GST_DEBUG_FUNCPTR(gst_tcamconvert_decide_allocation);
+    gst_base_transform_class->before_transform =
+        GST_DEBUG_FUNCPTR(gst_tcamconvert_before_transform);
+    gst_base_transform_class->sink_event = GST_DEBUG_FUNCPTR(gst_tcamconvert_sink_event);
     gstelement_class->change_state = GST_DEBUG_FUNCPTR(gst_tcamconvert_change_state);
+    gstelement_class->request_new_pad = GST_DEBUG_FUNCPTR(gst_tcamconvert_request_new_pad);
+    gstelement_class->release_pad = GST_DEBUG_FUNCPTR(gst_tcamconvert_release_pad);
 
     // Mark this transform element as 'calling tranform_ip when src and sink caps are the same
-    gst_base_transform_class->passthrough_on_same_caps = TRUE;
-    //gst_base_transform_class->transform_ip_on_passthrough = TRUE;
+    // decided by update_transform_mode, same caps without white balance are a passthrough
+    gst_base_transform_class->passthrough_on_same_caps = FALSE;
+    gst_base_transform_class->transform_ip_on_passthrough = FALSE;
 
     GST_DEBUG_CATEGORY_INIT(
         gst_tcamconvert_debug_category, "tcamconvert", 0, "tcamconvert element");
@@ -500,7 +2043,15 @@ static void gst_tcamconvert_class_init(GstTCamConvertClass* klass)
 
 static gboolean plugin_init(GstPlugin* plugin)
 {
-    return gst_element_register(plugin, "tcamconvert", GST_RANK_NONE, GST_TYPE_TCAMCONVERT);
+    return gst_element_register(plugin, "tcamconvert", GST_RANK_NONE, GST_TYPE_TCAMCONVERT)
+           && gst_element_register(
+               plugin, "tcamlosslessenc", GST_RANK_NONE, GST_TYPE_TCAMLOSSLESSENC)
+           && gst_element_register(
+               plugin, "tcamlosslessdec", GST_RANK_NONE, GST_TYPE_TCAMLOSSLESSDEC)
+           && gst_element_register(
+               plugin, "tcamlatencysink", GST_RANK_NONE, GST_TYPE_TCAMLATENCYSINK)
+           && gst_element_register(
+               plugin, "tcamaccumulate", GST_RANK_NONE, GST_TYPE_TCAMACCUMULATE);
 }
 
 #ifndef PACKAGE
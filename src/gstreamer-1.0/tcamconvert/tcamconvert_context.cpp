@@ -16,7 +16,15 @@
 
 #include "tcamconvert_context.h"
 
+#include "tcamconvert.h"
+
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string_view>
 #include <gst-helper/gstelement_helper.h>
 #include <tcamprop1.0_consumer/tcamprop1_consumer.h>
 
@@ -28,6 +36,16 @@ static constexpr const char* BalanceWhiteRed_name = "BalanceWhiteRed";
 static constexpr const char* BalanceWhiteGreen_name = "BalanceWhiteGreen";
 static constexpr const char* BalanceWhiteBlue_name = "BalanceWhiteBlue";
 
+static constexpr const char* ColorTransformationEnable_name = "ColorTransformationEnable";
+// in the order of img::color_matrix_float::fac
+static constexpr const char* ColorTransformation_value_names[] = {
+    "ColorTransformation_Value_Gain00", "ColorTransformation_Value_Gain01",
+    "ColorTransformation_Value_Gain02", "ColorTransformation_Value_Gain10",
+    "ColorTransformation_Value_Gain11", "ColorTransformation_Value_Gain12",
+    "ColorTransformation_Value_Gain20", "ColorTransformation_Value_Gain21",
+    "ColorTransformation_Value_Gain22",
+};
+
 } // namespace
 
 tcamconvert::tcamconvert_context_base::tcamconvert_context_base(GstTCamConvert* self)
@@ -35,9 +53,21 @@ tcamconvert::tcamconvert_context_base::tcamconvert_context_base(GstTCamConvert*
 {
 }
 
+void tcamconvert::tcamconvert_context_base::set_thread_count(int count)
+{
+    thread_count_ = count;
+    trans_impl_.set_thread_count(count);
+}
+
 void tcamconvert::tcamconvert_context_base::init_from_source()
 {
+    // the reads below are current, changes from now on are notified
+    wb_changed_ = false;
+    clr_changed_ = false;
+
     whitebalance_params_.apply = false;
+    color_matrix_claimed_ = false;
+    color_matrix_enable_ = false;
 
     auto prop_elem = tcamprop1_consumer::get_TcamPropertyProvider(*src_element_ptr_);
     assert(prop_elem != nullptr);
@@ -69,36 +99,104 @@ void tcamconvert::tcamconvert_context_base::init_from_source()
                 wb_red_ = std::move(wb_red);
                 wb_green_ = std::move(wb_green);
                 wb_blue_ = std::move(wb_blue);
+
+                refresh_balancewhite_values();
+                wb_next_refresh_ = std::chrono::steady_clock::now() + wb_refresh_interval_;
             }
         }
     }
 
+    // only present when the device has no color transformation of its own
+    auto p_clr_claim_ptr = provider.get_property_ptr<tcamprop1::property_interface_boolean>(
+        "ClaimColorTransformationSoftware");
+    if (p_clr_claim_ptr && !p_clr_claim_ptr->set_property_value(true))
+    {
+        auto enable = provider.get_property_ptr<tcamprop1::property_interface_boolean>(
+            ColorTransformationEnable_name);
+
+        bool all_found = enable != nullptr;
+        std::array<std::unique_ptr<tcamprop1::property_interface_float>, 9> values;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = provider.get_property_ptr<tcamprop1::property_interface_float>(
+                ColorTransformation_value_names[i]);
+            all_found = all_found && values[i] != nullptr;
+        }
+
+        assert(all_found);
+        if (all_found)
+        {
+            color_matrix_claimed_ = true;
+            clr_enable_ = std::move(enable);
+            clr_values_ = std::move(values);
+
+            refresh_color_matrix_values();
+        }
+    }
+
     init_from_source_done_ = true;
+
+    update_transform_mode();
 }
 
 auto tcamconvert::tcamconvert_context_base::fetch_balancewhite_values_from_source()
-    -> img_filter::whitebalance_params
+    -> const img_filter::whitebalance_params&
 {
-    if (!src_element_ptr_)
+    if (source_notifies_.load(std::memory_order_relaxed))
     {
-        return {};
+        if (whitebalance_params_.apply && wb_changed_.exchange(false, std::memory_order_acq_rel))
+        {
+            refresh_balancewhite_values();
+        }
+        if (color_matrix_claimed_ && clr_changed_.exchange(false, std::memory_order_acq_rel))
+        {
+            refresh_color_matrix_values();
+        }
+        return whitebalance_params_;
     }
 
-    auto prop_elem = tcamprop1_consumer::get_TcamPropertyProvider(*src_element_ptr_);
-    assert(prop_elem);
-    if (!prop_elem)
+    if (whitebalance_params_.apply || color_matrix_claimed_)
     {
-        return {};
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= wb_next_refresh_)
+        {
+            wb_next_refresh_ = now + wb_refresh_interval_;
+            if (whitebalance_params_.apply)
+            {
+                refresh_balancewhite_values();
+            }
+            if (color_matrix_claimed_)
+            {
+                refresh_color_matrix_values();
+            }
+        }
     }
+    return whitebalance_params_;
+}
 
-    if (!whitebalance_params_.apply)
+void tcamconvert::tcamconvert_context_base::on_properties_changed(GstElement* /*src*/,
+                                                                  gchar** names,
+                                                                  gpointer user_data)
+{
+    auto self = static_cast<tcamconvert_context_base*>(user_data);
+    for (gchar** n = names; n && *n; ++n)
     {
-        return {};
+        const std::string_view name = *n;
+        if (name == BalanceWhiteRed_name || name == BalanceWhiteGreen_name
+            || name == BalanceWhiteBlue_name)
+        {
+            self->wb_changed_.store(true, std::memory_order_release);
+        }
+        else if (name.rfind("ColorTransformation", 0) == 0)
+        {
+            self->clr_changed_.store(true, std::memory_order_release);
+        }
     }
+}
 
-    auto factors = whitebalance_params_;
-
-    auto read_chan = [prop_elem](auto& ptr, float& val)
+void tcamconvert::tcamconvert_context_base::refresh_balancewhite_values()
+{
+    auto read_chan = [](auto& ptr, float& val)
     {
         if (!ptr)
             return;
@@ -107,12 +205,29 @@ auto tcamconvert::tcamconvert_context_base::fetch_balancewhite_values_from_sourc
             val = res.value();
         }
     };
-    read_chan(wb_red_, factors.wb_rr);
-    read_chan(wb_green_, factors.wb_gr);
-    read_chan(wb_blue_, factors.wb_bb);
-    factors.wb_gb = factors.wb_gr;
+    read_chan(wb_red_, whitebalance_params_.wb_rr);
+    read_chan(wb_green_, whitebalance_params_.wb_gr);
+    read_chan(wb_blue_, whitebalance_params_.wb_bb);
+    whitebalance_params_.wb_gb = whitebalance_params_.wb_gr;
+}
 
-    return whitebalance_params_ = factors;
+void tcamconvert::tcamconvert_context_base::refresh_color_matrix_values()
+{
+    if (auto res = clr_enable_->get_property_value(); res)
+    {
+        color_matrix_enable_ = res.value();
+    }
+    if (color_matrix_enable_)
+    {
+        for (size_t i = 0; i < clr_values_.size(); ++i)
+        {
+            if (auto res = clr_values_[i]->get_property_value(); res)
+            {
+                color_matrix_.fac[i] = static_cast<float>(res.value());
+            }
+        }
+    }
+    trans_impl_.set_color_matrix(color_matrix_enable_, color_matrix_);
 }
 
 
@@ -179,6 +294,15 @@ bool tcamconvert::tcamconvert_context_base::try_connect_to_source(bool force)
             "Source element does not have 'device-open'/'device-close' events. Failing connect");
         return false;
     }
+    // sources without the notification are polled, see fetch_balancewhite_values_from_source
+    signal_handle_properties_changed_.disconnect();
+    source_notifies_ =
+        gst_helper::has_signal(G_OBJECT(camera_src_ptr.get()), "tcam-properties-changed")
+        && signal_handle_properties_changed_.connect(
+            G_OBJECT(camera_src_ptr.get()),
+            "tcam-properties-changed",
+            G_CALLBACK(&tcamconvert_context_base::on_properties_changed),
+            this);
     src_element_ptr_ = std::move(camera_src_ptr);
 
     const auto cur_state = gst_helper::get_gststate(*src_element_ptr_, false);
@@ -197,9 +321,22 @@ void tcamconvert::tcamconvert_context_base::on_device_opened()
 void tcamconvert::tcamconvert_context_base::on_device_closed()
 {
     init_from_source_done_ = false;
+    whitebalance_params_ = {};
     wb_red_.reset();
     wb_green_.reset();
     wb_blue_.reset();
+
+    color_matrix_claimed_ = false;
+    color_matrix_enable_ = false;
+    color_matrix_ = img::color_matrix_float::get_neutral();
+    clr_enable_.reset();
+    for (auto& ptr : clr_values_)
+    {
+        ptr.reset();
+    }
+    trans_impl_.set_color_matrix(false, color_matrix_);
+
+    update_transform_mode();
 }
 
 void tcamconvert::tcamconvert_context_base::on_input_pad_linked()
@@ -212,28 +349,428 @@ void tcamconvert::tcamconvert_context_base::on_input_pad_unlinked()
     on_device_closed();
     signal_handle_device_open_.disconnect();
     signal_handle_device_close_.disconnect();
+    signal_handle_properties_changed_.disconnect();
+    source_notifies_ = false;
     src_element_ptr_ = nullptr;
 }
 
-bool tcamconvert::tcamconvert_context_base::setup(img::img_type src_type, img::img_type dst_type)
+bool tcamconvert::tcamconvert_context_base::setup(
+    img::img_type src_type,
+    img::img_type dst_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    // the kernels are set up for the whole image and only run on the rects
+    auto kernel_dst_type = dst_type;
+    if (!rois_.empty())
+    {
+        const auto extent = calc_roi_extent(rois_);
+        if (extent.cx > src_type.dim.cx || extent.cy > src_type.dim.cy
+            || dst_type.dim != calc_roi_output_dim(rois_)
+            || !is_roi_dst_fcc(dst_type.fourcc_type()))
+        {
+            return false;
+        }
+        kernel_dst_type = img::make_img_type(dst_type.fourcc_type(), src_type.dim);
+    }
+
+    trans_impl_.set_defect_pixel_map(defect_map_);
+    trans_impl_.set_flat_field_map(flat_field_map_);
+    if (!trans_impl_.setup(src_type, kernel_dst_type, yuv_colorimetry))
+    {
+        return false;
+    }
+    this->src_type_ = src_type;
+    this->dst_type_ = dst_type;
+
+#if defined HAVE_OPENCL
+    gpu_active_ = false;
+    // the OpenCL path converts whole images
+    if (use_gpu_ && rois_.empty())
+    {
+        gpu_active_ = gpu_impl_.setup(src_type, dst_type);
+        if (!gpu_active_)
+        {
+            GST_INFO_OBJECT(self_reference_,
+                            "Using the cpu for the conversion. %s",
+                            gpu_impl_.last_error().c_str());
+        }
+    }
+#endif
+#if defined HAVE_V4L2_M2M
+    m2m_active_ = false;
+    bool use_m2m = !m2m_device_.empty() && rois_.empty();
+#if defined HAVE_OPENCL
+    use_m2m = use_m2m && !gpu_active_;
+#endif
+    if (use_m2m)
+    {
+        m2m_active_ = m2m_impl_.setup(m2m_device_, src_type, dst_type, yuv_colorimetry);
+        if (!m2m_active_)
+        {
+            GST_INFO_OBJECT(self_reference_,
+                            "Not using a mem2mem device for the conversion. %s",
+                            m2m_impl_.last_error().c_str());
+        }
+    }
+#endif
+    update_transform_mode();
+    return true;
+}
+
+void tcamconvert::tcamconvert_context_base::update_transform_mode()
+{
+    auto trans = GST_BASE_TRANSFORM(self_reference_);
+    if (!trans_impl_.is_unary() || !rois_.empty())
+    {
+        gst_base_transform_set_passthrough(trans, FALSE);
+        gst_base_transform_set_in_place(trans, FALSE);
+        return;
+    }
+
+    const bool apply_wb = trans_impl_.has_filter() && whitebalance_params_.apply;
+    const bool correct_defects = trans_impl_.has_defect_pixel_correction()
+                                 && img_filter::defect_pixel::can_correct(src_type_.fourcc_type());
+    const bool correct_flat_field = trans_impl_.has_flat_field_correction()
+                                    && img_filter::flat_field::can_apply(src_type_.fourcc_type());
+    const bool modifies = apply_wb || correct_defects || correct_flat_field;
+
+    // in place makes the buffer writable, that only copies when it is shared
+    gst_base_transform_set_in_place(trans, modifies);
+    gst_base_transform_set_passthrough(trans, !modifies);
+}
+
+void tcamconvert::tcamconvert_context_base::set_rois(std::vector<img::rect> rois)
+{
+    {
+        std::lock_guard lck { caps_memo_mtx_ };
+        caps_memo_ = {};
+    }
+
+    rois_.clear();
+    for (const auto& roi : rois)
+    {
+        const auto aligned = align_roi(roi);
+        if (!img::is_empty_rect(aligned))
+        {
+            rois_.push_back(aligned);
+        }
+    }
+}
+
+bool tcamconvert::tcamconvert_context_base::set_defect_pixel_file(const std::string& filename,
+                                                                  std::string& error)
+{
+    if (filename.empty())
+    {
+        defect_pixel_file_.clear();
+        defect_map_.reset();
+        return true;
+    }
+
+    std::ifstream file(filename);
+    if (!file)
+    {
+        error = "Unable to open '" + filename + "'";
+        return false;
+    }
+
+    auto map = std::make_shared<img_filter::defect_pixel_map>();
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line))
+    {
+        line_number++;
+
+        std::istringstream iss(line);
+        img::point pt;
+        char c = 0;
+        if (!(iss >> c) || c == '#')
+        {
+            continue;
+        }
+        iss.putback(c);
+        if (!(iss >> pt.x >> pt.y) || pt.x < 0 || pt.y < 0)
+        {
+            error = filename + ":" + std::to_string(line_number) + ": expected 'x y'";
+            return false;
+        }
+        map->pixels.push_back(pt);
+    }
+    img_filter::defect_pixel::normalize(*map);
+
+    defect_pixel_file_ = filename;
+    defect_map_ = std::move(map);
+    return true;
+}
+
+namespace
+{
+
+// skips whitespace and # comments between the fields of a netpbm header
+bool read_pgm_header_value(std::istream& is, int& value)
+{
+    while (is)
+    {
+        const int c = is.peek();
+        if (c == '#')
+        {
+            is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        else if (std::isspace(c))
+        {
+            is.get();
+        }
+        else
+        {
+            break;
+        }
+    }
+    return static_cast<bool>(is >> value);
+}
+
+} // namespace
+
+bool tcamconvert::tcamconvert_context_base::set_flat_field_file(const std::string& filename,
+                                                                std::string& error)
 {
-    if (trans_impl_.setup(src_type, dst_type))
+    if (filename.empty())
     {
-        this->src_type_ = src_type;
-        this->dst_type_ = dst_type;
+        flat_field_file_.clear();
+        flat_field_map_.reset();
         return true;
     }
 
-    return false;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        error = "Unable to open '" + filename + "'";
+        return false;
+    }
+
+    char magic[2] = {};
+    int width = 0;
+    int height = 0;
+    int maxval = 0;
+    if (!file.read(magic, 2) || magic[0] != 'P' || magic[1] != '5'
+        || !read_pgm_header_value(file, width) || !read_pgm_header_value(file, height)
+        || !read_pgm_header_value(file, maxval) || width < 2 || height < 2 || maxval < 1
+        || maxval > 0xFFFF)
+    {
+        error = filename + ": expected a binary PGM (P5)";
+        return false;
+    }
+    // a single whitespace separates the header from the pixels
+    file.get();
+
+    // the bayer pattern does not matter, the map has gains for all 4 positions
+    const auto fcc = maxval > 0xFF ? img::fourcc::BGGR16 : img::fourcc::BGGR8;
+    const auto type = img::make_img_type(fcc, { width, height });
+
+    std::vector<uint8_t> buffer(type.buffer_length);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size()))
+    {
+        error = filename + ": file ends before " + std::to_string(width) + "x"
+                + std::to_string(height) + " pixels";
+        return false;
+    }
+    if (fcc == img::fourcc::BGGR16)
+    {
+        // PGM stores the most significant byte first
+        for (size_t i = 0; i + 1 < buffer.size(); i += 2)
+        {
+            std::swap(buffer[i], buffer[i + 1]);
+        }
+    }
+
+    const auto flat = img::make_img_desc_from_linear_memory(type, buffer.data());
+    auto map = std::make_shared<img_filter::flat_field_map>(img_filter::flat_field::make_map(
+        flat, flat_field_grid_cols, flat_field_grid_rows));
+
+    flat_field_file_ = filename;
+    flat_field_map_ = std::move(map);
+    return true;
+}
+
+GstCaps* tcamconvert::tcamconvert_context_base::find_transformed_caps(GstPadDirection direction,
+                                                                      GstCaps& caps)
+{
+    std::lock_guard lck { caps_memo_mtx_ };
+
+    const auto& memo = caps_memo_[direction == GST_PAD_SRC ? 0 : 1];
+    if (!memo.caps || !gst_caps_is_equal(memo.caps.get(), &caps))
+    {
+        return nullptr;
+    }
+    return gst_caps_ref(memo.result.get());
+}
+
+void tcamconvert::tcamconvert_context_base::store_transformed_caps(GstPadDirection direction,
+                                                                   GstCaps& caps,
+                                                                   GstCaps& result)
+{
+    std::lock_guard lck { caps_memo_mtx_ };
+
+    auto& memo = caps_memo_[direction == GST_PAD_SRC ? 0 : 1];
+    memo.caps = gst_helper::make_wrap_ptr(gst_caps_ref(&caps));
+    memo.result = gst_helper::make_wrap_ptr(gst_caps_ref(&result));
+}
+
+void tcamconvert::tcamconvert_context_base::set_tone_curve(
+    const img_filter::fcc8_tone_curve_params& params)
+{
+    std::lock_guard lck { tone_curve_mtx_ };
+    tone_curve_ = params;
+}
+
+img_filter::fcc8_tone_curve_params tcamconvert::tcamconvert_context_base::get_tone_curve() const
+{
+    std::lock_guard lck { tone_curve_mtx_ };
+    return tone_curve_;
+}
+
+void tcamconvert::tcamconvert_context_base::set_tensor_normalization(
+    const img_filter::transform::tensor::normalization& norm)
+{
+    std::lock_guard lck { tensor_norm_mtx_ };
+    tensor_norm_ = norm;
+}
+
+img_filter::transform::tensor::normalization
+    tcamconvert::tcamconvert_context_base::get_tensor_normalization() const
+{
+    std::lock_guard lck { tensor_norm_mtx_ };
+    return tensor_norm_;
 }
 
 void tcamconvert::tcamconvert_context_base::transform(const img::img_descriptor& src,
-                                                      const img::img_descriptor& dst)
+                                                      const img::img_descriptor& dst,
+                                                      [[maybe_unused]] const dmabuf_view& src_buf,
+                                                      [[maybe_unused]] const dmabuf_view& dst_buf)
 {
-    trans_impl_.transform(src, dst, fetch_balancewhite_values_from_source());
+    const auto& params = fetch_balancewhite_values_from_source();
+    const auto tone_curve = get_tone_curve();
+    trans_impl_.set_tone_curve(tone_curve);
+    trans_impl_.set_tensor_normalization(get_tensor_normalization());
+#if defined HAVE_OPENCL
+    // the OpenCL kernels have no color matrix, no tone curve and no defect pixel or flat field
+    // correction
+    if (gpu_active_ && !color_matrix_enable_ && img_filter::is_neutral(tone_curve)
+        && !trans_impl_.has_defect_pixel_correction() && !trans_impl_.has_flat_field_correction())
+    {
+        if (gpu_impl_.transform(src, dst, params))
+        {
+            return;
+        }
+        GST_WARNING_OBJECT(self_reference_,
+                           "OpenCL conversion failed, switching to the cpu. %s",
+                           gpu_impl_.last_error().c_str());
+        gpu_active_ = false;
+    }
+#endif
+#if defined HAVE_V4L2_M2M
+    // the same restrictions as for OpenCL
+    if (m2m_active_ && !color_matrix_enable_ && img_filter::is_neutral(tone_curve)
+        && !trans_impl_.has_defect_pixel_correction() && !trans_impl_.has_flat_field_correction())
+    {
+        if (m2m_impl_.transform(src, dst, params, src_buf, dst_buf))
+        {
+            return;
+        }
+        GST_WARNING_OBJECT(self_reference_,
+                           "mem2mem conversion failed, switching to the cpu. %s",
+                           m2m_impl_.last_error().c_str());
+        m2m_active_ = false;
+    }
+#endif
+    if (!rois_.empty())
+    {
+        trans_impl_.transform_rois(src, dst, rois_, params);
+        return;
+    }
+    trans_impl_.transform(src, dst, params);
 }
 
 void tcamconvert::tcamconvert_context_base::filter(const img::img_descriptor& src)
 {
     trans_impl_.filter(src, fetch_balancewhite_values_from_source());
 }
+
+tcamconvert::tcamconvert_context_base::preview_output::~preview_output()
+{
+    if (pool)
+    {
+        gst_buffer_pool_set_active(pool.get(), FALSE);
+    }
+}
+
+void tcamconvert::tcamconvert_context_base::add_preview(GstPad& pad)
+{
+    auto preview = std::make_shared<preview_output>();
+    preview->pad = gst_helper::make_addref_ptr(&pad);
+    preview->trans.set_thread_count(thread_count_);
+
+    std::lock_guard lck { previews_mtx_ };
+    previews_.push_back(std::move(preview));
+}
+
+void tcamconvert::tcamconvert_context_base::remove_preview(GstPad& pad)
+{
+    std::lock_guard lck { previews_mtx_ };
+    previews_.erase(std::remove_if(previews_.begin(),
+                                   previews_.end(),
+                                   [&pad](const auto& preview)
+                                   { return preview->pad.get() == &pad; }),
+                    previews_.end());
+}
+
+auto tcamconvert::tcamconvert_context_base::get_previews() const
+    -> std::vector<std::shared_ptr<preview_output>>
+{
+    std::lock_guard lck { previews_mtx_ };
+    return previews_;
+}
+
+void tcamconvert::tcamconvert_context_base::renegotiate_previews()
+{
+    for (auto& preview : get_previews()) { preview->need_negotiation = true; }
+}
+
+void tcamconvert::tcamconvert_context_base::reset_previews()
+{
+    for (auto& preview : get_previews())
+    {
+        preview->stream_started = false;
+        preview->segment_pushed = false;
+        preview->negotiated = false;
+        preview->need_negotiation = true;
+    }
+}
+
+bool tcamconvert::tcamconvert_context_base::setup_preview(
+    preview_output& preview,
+    img::img_type dst_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    preview.trans.set_thread_count(thread_count_);
+    preview.trans.set_defect_pixel_map(defect_map_);
+    preview.trans.set_flat_field_map(flat_field_map_);
+    if (!preview.trans.setup(src_type_, dst_type, yuv_colorimetry))
+    {
+        return false;
+    }
+    preview.dst_type = dst_type;
+    return true;
+}
+
+void tcamconvert::tcamconvert_context_base::transform_preview(preview_output& preview,
+                                                              const img::img_descriptor& src,
+                                                              const img::img_descriptor& dst)
+{
+    // the same white balance as the src pad, the refresh is rate limited
+    const auto& params = fetch_balancewhite_values_from_source();
+    preview.trans.set_color_matrix(color_matrix_enable_, color_matrix_);
+    preview.trans.set_tone_curve(get_tone_curve());
+    preview.trans.set_tensor_normalization(get_tensor_normalization());
+    preview.trans.transform(src, dst, params);
+}
@@ -16,14 +16,29 @@
 
 #pragma once
 
+#include "../../latency_tracing.h"
+#include "m2m_transform.h"
 #include "transform_impl.h"
 
+#if defined HAVE_OPENCL
+#include "opencl_transform.h"
+#endif
+
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <dutils_img/dutils_img.h>
 #include <dutils_img_pipe/auto_alg_pass.h>
 #include <functional>
 #include <gst-helper/gst_signal_helper.h>
 #include <gst-helper/helper_functions.h>
+#include <gst/video/video.h>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
+#include <utility>
+#include <vector>
 
 struct GstTCamConvert;
 
@@ -35,25 +50,255 @@ public:
     img::img_type src_type_;
     img::img_type dst_type_;
 
+    // gstreamer pads yuv planes, so yuv dst buffers use this layout instead of the minimum pitch
+    // only valid for video/x-raw output, see dst_has_video_info_
+    GstVideoInfo dst_video_info_ = {};
+    bool dst_has_video_info_ = false;
+    // downstream supports GstVideoMeta, dst buffers without one get the layout that was used
+    bool dst_video_meta_ = false;
+
     void on_input_pad_linked();
     void on_input_pad_unlinked();
 
 public:
     tcamconvert_context_base(GstTCamConvert* self);
 
-    bool setup(img::img_type src_type, img::img_type dst_type);
+    bool setup(img::img_type src_type,
+               img::img_type dst_type,
+               const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry = {});
 
-    void transform(const img::img_descriptor& src, const img::img_descriptor& dst);
+    // the dmabuf views are only used by the mem2mem path, they are not required
+    void transform(const img::img_descriptor& src,
+                   const img::img_descriptor& dst,
+                   const dmabuf_view& src_buf = {},
+                   const dmabuf_view& dst_buf = {});
     void filter(const img::img_descriptor& src);
 
+    /*
+     * Same format conversions are done in place when the white balance is applied
+     * and are a passthrough otherwise, e.g. when the device does the white balance itself.
+     * Called after setup() and when the source device changes.
+     */
+    void update_transform_mode();
+
     bool try_connect_to_source(bool force);
 
+    // 0 means one thread per core
+    void set_thread_count(int count);
+    int get_thread_count() const noexcept
+    {
+        return thread_count_;
+    }
+
+    // OpenCL is only used when built with TCAM_BUILD_OPENCL and it implements the conversion
+    void set_use_gpu(bool use_gpu) noexcept
+    {
+        use_gpu_ = use_gpu;
+    }
+    bool get_use_gpu() const noexcept
+    {
+        return use_gpu_;
+    }
+
+    /*
+     * V4L2 mem2mem device for the conversion, e.g. /dev/video12, "auto" probes all devices.
+     * Empty disables it. Only used when built with TCAM_BUILD_V4L2_M2M and the device
+     * implements the conversion, an active OpenCL conversion is preferred.
+     */
+    void set_m2m_device(std::string device)
+    {
+        m2m_device_ = std::move(device);
+    }
+    const std::string& get_m2m_device() const noexcept
+    {
+        return m2m_device_;
+    }
+
+    // applied when 10/12/16 bit formats are reduced to 8 bit, can be changed while playing
+    void set_tone_curve(const img_filter::fcc8_tone_curve_params& params);
+    img_filter::fcc8_tone_curve_params get_tone_curve() const;
+
+    /*
+     * Only these rects of the input are converted, see transform_context::transform_rois.
+     * dst_type_ then has the stacked dim of the rects. Empty converts the whole image.
+     * Must not be called while caps are set.
+     */
+    void set_rois(std::vector<img::rect> rois);
+    const std::vector<img::rect>& get_rois() const noexcept
+    {
+        return rois_;
+    }
+
+    /*
+     * Text file with one defect pixel per line, "x y" in coordinates of the input image.
+     * Lines starting with # are comments, an empty filename disables the correction.
+     * Must not be called while caps are set.
+     */
+    bool set_defect_pixel_file(const std::string& filename, std::string& error);
+    const std::string& get_defect_pixel_file() const noexcept
+    {
+        return defect_pixel_file_;
+    }
+
+    /*
+     * Binary PGM (P5) of an evenly lit, unstructured target, 8 or 16 bit, taken with the same
+     * sensor and format as the input. Its shading is reduced to a gain grid of
+     * flat_field_grid_cols x flat_field_grid_rows, an empty filename disables the correction.
+     * Must not be called while caps are set.
+     */
+    bool set_flat_field_file(const std::string& filename, std::string& error);
+    const std::string& get_flat_field_file() const noexcept
+    {
+        return flat_field_file_;
+    }
+
+    /*
+     * transform_caps result of the last fixed caps per direction.
+     * Negotiation, e.g. after a ROI change, asks for the same caps several times.
+     * find returns a new reference or nullptr, set_rois clears them.
+     */
+    GstCaps* find_transformed_caps(GstPadDirection direction, GstCaps& caps);
+    void store_transformed_caps(GstPadDirection direction, GstCaps& caps, GstCaps& result);
+
+    // normalization of RGBF32PLANAR/RGBF16PLANAR output, can be changed while playing
+    void set_tensor_normalization(const img_filter::transform::tensor::normalization& norm);
+    img_filter::transform::tensor::normalization get_tensor_normalization() const;
+
+    const std::string& get_kernel_description() const noexcept
+    {
+#if defined HAVE_OPENCL
+        if (gpu_active_)
+        {
+            return gpu_impl_.kernel_description();
+        }
+#endif
+#if defined HAVE_V4L2_M2M
+        if (m2m_active_)
+        {
+            return m2m_impl_.kernel_description();
+        }
+#endif
+        return trans_impl_.kernel_description();
+    }
+
+    // duration of transform(), only filled when TCAM_LATENCY_TRACING is set
+    tcam::latency::sliding_window conversion_latency_;
+
+    /*
+     * A "preview_%u" request pad. It is converted from the same input buffer as the src pad,
+     * with its own caps, e.g. a binned BGRx preview next to the full size output.
+     * trans reads the whole input again, it does not share the strips of the src conversion.
+     * The flags are only touched by the streaming thread.
+     */
+    struct preview_output
+    {
+        ~preview_output();
+
+        gst_helper::gst_ptr<GstPad> pad;
+        img::img_type dst_type;
+        // yuv layout, see dst_video_info_
+        GstVideoInfo dst_video_info = {};
+        bool dst_has_video_info = false;
+        gst_helper::gst_ptr<GstBufferPool> pool;
+
+        bool stream_started = false;
+        bool segment_pushed = false;
+        bool negotiated = false;
+        bool need_negotiation = true;
+
+        transform_context trans;
+    };
+
+    // index of the next "preview_%u" pad without a requested name
+    unsigned int next_preview_id_ = 0;
+
+    void add_preview(GstPad& pad);
+    void remove_preview(GstPad& pad);
+    // references, so that a released pad stays valid while its last buffer is pushed
+    std::vector<std::shared_ptr<preview_output>> get_previews() const;
+    // the sink caps changed, previews negotiate again with their next buffer
+    void renegotiate_previews();
+    // the stream stopped, the pads lost their sticky events
+    void reset_previews();
+
+    // whole images from src_type_, ROIs and the OpenCL path are not used for previews
+    bool setup_preview(preview_output& preview,
+                       img::img_type dst_type,
+                       const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry);
+    void transform_preview(preview_output& preview,
+                           const img::img_descriptor& src,
+                           const img::img_descriptor& dst);
+
 private:
-    img_filter::whitebalance_params whitebalance_params_;
+    int thread_count_ = 1;
+
+    // Values read from the source, the per frame path only touches this.
+    // The tcamprop reads are too expensive to do them for every buffer,
+    // they are refreshed when 'tcam-properties-changed' of the source names them.
+    // Sources without that signal are polled every wb_refresh_interval_.
+    alignas(64) img_filter::whitebalance_params whitebalance_params_;
+    std::chrono::steady_clock::time_point wb_next_refresh_ = {};
+
+    static constexpr std::chrono::milliseconds wb_refresh_interval_ { 20 };
+
+    // set from the streaming thread of the source, taken by the transform
+    std::atomic<bool> source_notifies_ = false;
+    std::atomic<bool> wb_changed_ = false;
+    std::atomic<bool> clr_changed_ = false;
 
     transform_context trans_impl_;
 
-    auto fetch_balancewhite_values_from_source() -> img_filter::whitebalance_params;
+    // aligned with align_roi
+    std::vector<img::rect> rois_;
+
+    std::string defect_pixel_file_;
+    std::shared_ptr<const img_filter::defect_pixel_map> defect_map_;
+
+    static constexpr int flat_field_grid_cols = 32;
+    static constexpr int flat_field_grid_rows = 24;
+
+    std::string flat_field_file_;
+    std::shared_ptr<const img_filter::flat_field_map> flat_field_map_;
+
+    struct caps_memo
+    {
+        gst_helper::gst_ptr<GstCaps> caps;
+        gst_helper::gst_ptr<GstCaps> result;
+    };
+    std::mutex caps_memo_mtx_;
+    // GST_PAD_SRC and GST_PAD_SINK
+    std::array<caps_memo, 2> caps_memo_;
+
+    bool use_gpu_ = false;
+#if defined HAVE_OPENCL
+    // trans_impl_ is always set up, so it can take over when a OpenCL call fails
+    opencl_transform_context gpu_impl_;
+    bool gpu_active_ = false;
+#endif
+    std::string m2m_device_ = "auto";
+#if defined HAVE_V4L2_M2M
+    // like gpu_impl_, trans_impl_ takes over when a V4L2 call fails
+    m2m_transform_context m2m_impl_;
+    bool m2m_active_ = false;
+#endif
+
+    // the software color matrix of the source, refreshed together with the white balance
+    bool color_matrix_claimed_ = false;
+    bool color_matrix_enable_ = false;
+    img::color_matrix_float color_matrix_ = img::color_matrix_float::get_neutral();
+
+    mutable std::mutex tone_curve_mtx_;
+    img_filter::fcc8_tone_curve_params tone_curve_;
+
+    mutable std::mutex tensor_norm_mtx_;
+    img_filter::transform::tensor::normalization tensor_norm_;
+
+    mutable std::mutex previews_mtx_;
+    std::vector<std::shared_ptr<preview_output>> previews_;
+
+    auto fetch_balancewhite_values_from_source() -> const img_filter::whitebalance_params&;
+    void refresh_balancewhite_values();
+    void refresh_color_matrix_values();
 
 private:
     void init_from_source();
@@ -62,14 +307,20 @@ private:
     void on_device_opened();
     void on_device_closed();
 
+    static void on_properties_changed(GstElement* src, gchar** names, gpointer user_data);
+
     gst_helper::gst_device_connect_signal signal_handle_device_open_;
     gst_helper::gst_device_connect_signal signal_handle_device_close_;
+    gst_helper::gsignal_handle signal_handle_properties_changed_;
 
     gst_helper::gst_ptr<GstElement> src_element_ptr_;
     std::unique_ptr<tcamprop1::property_interface_float>    wb_red_;
     std::unique_ptr<tcamprop1::property_interface_float>    wb_green_;
     std::unique_ptr<tcamprop1::property_interface_float>    wb_blue_;
 
+    std::unique_ptr<tcamprop1::property_interface_boolean>  clr_enable_;
+    std::array<std::unique_ptr<tcamprop1::property_interface_float>, 9> clr_values_;
+
     GstTCamConvert* self_reference_ = nullptr;
 };
 } // namespace tcamconvert
@@ -0,0 +1,325 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamlatencysink.h"
+
+#include "../../latency_stamp.h"
+#include "../../latency_tracing.h"
+
+#include <dutils_img/fcc_to_string.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst/video/gstvideometa.h>
+#include <optional>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamlatencysink_debug_category);
+#define GST_CAT_DEFAULT gst_tcamlatencysink_debug_category
+
+#define gst_tcamlatencysink_parent_class parent_class
+G_DEFINE_TYPE(GstTCamLatencySink, gst_tcamlatencysink, GST_TYPE_BASE_SINK)
+
+enum
+{
+    PROP_0,
+    PROP_WINDOW,
+    PROP_MESSAGE_INTERVAL,
+    PROP_STATISTICS,
+};
+
+static constexpr guint default_window_size = 600;
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE(
+    "sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw; video/x-bayer"));
+
+
+static GstStructure* get_statistics(GstTCamLatencySink* self)
+{
+    const auto p = self->window_->get();
+
+    GST_OBJECT_LOCK(self);
+    const guint64 frames = self->frames_;
+    const guint64 unstamped = self->unstamped_frames_;
+    GST_OBJECT_UNLOCK(self);
+
+    return gst_structure_new("tcam-latency",
+                             "frames",
+                             G_TYPE_UINT64,
+                             frames,
+                             "unstamped-frames",
+                             G_TYPE_UINT64,
+                             unstamped,
+                             "samples",
+                             G_TYPE_UINT64,
+                             p.sample_count,
+                             "p50",
+                             G_TYPE_UINT64,
+                             p.p50,
+                             "p90",
+                             G_TYPE_UINT64,
+                             p.p90,
+                             "p99",
+                             G_TYPE_UINT64,
+                             p.p99,
+                             "max",
+                             G_TYPE_UINT64,
+                             p.max,
+                             nullptr);
+}
+
+
+static void gst_tcamlatencysink_set_property(GObject* object,
+                                             guint prop_id,
+                                             const GValue* value,
+                                             GParamSpec* pspec)
+{
+    auto self = GST_TCAMLATENCYSINK(object);
+
+    switch (prop_id)
+    {
+        case PROP_WINDOW:
+        {
+            GstState state;
+            gst_element_get_state(GST_ELEMENT(self), &state, nullptr, 0);
+            if (state > GST_STATE_READY)
+            {
+                GST_WARNING_OBJECT(self, "window can only be changed in READY or lower");
+                break;
+            }
+            self->window_size_ = g_value_get_uint(value);
+            delete self->window_;
+            self->window_ = new tcam::latency::sliding_window(self->window_size_);
+            break;
+        }
+        case PROP_MESSAGE_INTERVAL:
+        {
+            self->message_interval_ = g_value_get_uint(value);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+static void gst_tcamlatencysink_get_property(GObject* object,
+                                             guint prop_id,
+                                             GValue* value,
+                                             GParamSpec* pspec)
+{
+    auto self = GST_TCAMLATENCYSINK(object);
+
+    switch (prop_id)
+    {
+        case PROP_WINDOW:
+        {
+            g_value_set_uint(value, self->window_size_);
+            break;
+        }
+        case PROP_MESSAGE_INTERVAL:
+        {
+            g_value_set_uint(value, self->message_interval_);
+            break;
+        }
+        case PROP_STATISTICS:
+        {
+            g_value_take_boxed(value, get_statistics(self));
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static gboolean gst_tcamlatencysink_set_caps(GstBaseSink* base, GstCaps* caps)
+{
+    GstTCamLatencySink* self = GST_TCAMLATENCYSINK(base);
+
+    self->type_ = gst_helper::get_img_type_from_fixated_gstcaps(*caps);
+    if (self->type_.empty() || !tcam::latency::can_stamp(self->type_))
+    {
+        // the frames are still consumed, they are counted as unstamped
+        GST_WARNING_OBJECT(self,
+                           "Frames of %s %dx%d cannot carry a latency stamp",
+                           img::fcc_to_string(self->type_.type).c_str(),
+                           self->type_.dim.cx,
+                           self->type_.dim.cy);
+    }
+    return TRUE;
+}
+
+static gboolean gst_tcamlatencysink_start(GstBaseSink* base)
+{
+    GstTCamLatencySink* self = GST_TCAMLATENCYSINK(base);
+
+    self->window_->clear();
+
+    GST_OBJECT_LOCK(self);
+    self->frames_ = 0;
+    self->unstamped_frames_ = 0;
+    GST_OBJECT_UNLOCK(self);
+    return TRUE;
+}
+
+static gboolean gst_tcamlatencysink_stop(GstBaseSink* base)
+{
+    GstTCamLatencySink* self = GST_TCAMLATENCYSINK(base);
+
+    const auto p = self->window_->get();
+    GST_INFO_OBJECT(self,
+                    "Latency over %llu frames: p50=%llu p90=%llu p99=%llu max=%llu ns",
+                    (unsigned long long)p.sample_count,
+                    (unsigned long long)p.p50,
+                    (unsigned long long)p.p90,
+                    (unsigned long long)p.p99,
+                    (unsigned long long)p.max);
+    return TRUE;
+}
+
+static GstFlowReturn gst_tcamlatencysink_render(GstBaseSink* base, GstBuffer* buffer)
+{
+    // taken first, mapping the buffer is part of the latency a real sink sees
+    const uint64_t arrival_ns = tcam::latency::now_ns();
+
+    GstTCamLatencySink* self = GST_TCAMLATENCYSINK(base);
+
+    std::optional<uint64_t> stamp;
+    GstMapInfo map;
+    if (!self->type_.empty() && gst_buffer_map(buffer, &map, GST_MAP_READ))
+    {
+        // the stamp is in the first lines, only their stride matters
+        int pitch = img::calc_minimum_pitch(self->type_.fourcc_type(), self->type_.dim.cx);
+        if (auto meta = gst_buffer_get_video_meta(buffer))
+        {
+            pitch = meta->stride[0];
+        }
+
+        if (map.size >= static_cast<gsize>(self->type_.buffer_length))
+        {
+            auto src = img::make_img_desc_raw(self->type_.fourcc_type(),
+                                              self->type_.dim,
+                                              static_cast<int>(map.size),
+                                              img::img_plane { map.data, pitch });
+            stamp = tcam::latency::read_frame_stamp(src);
+        }
+        gst_buffer_unmap(buffer, &map);
+    }
+
+    if (stamp)
+    {
+        self->window_->add(stamp.value(), arrival_ns);
+    }
+
+    GST_OBJECT_LOCK(self);
+    ++self->frames_;
+    if (!stamp)
+    {
+        ++self->unstamped_frames_;
+    }
+    const bool post_message =
+        self->message_interval_ != 0 && self->frames_ % self->message_interval_ == 0;
+    GST_OBJECT_UNLOCK(self);
+
+    if (post_message)
+    {
+        gst_element_post_message(GST_ELEMENT(self),
+                                 gst_message_new_element(GST_OBJECT(self), get_statistics(self)));
+    }
+    return GST_FLOW_OK;
+}
+
+static void gst_tcamlatencysink_init(GstTCamLatencySink* self)
+{
+    self->type_ = {};
+    self->window_size_ = default_window_size;
+    self->window_ = new tcam::latency::sliding_window(self->window_size_);
+    self->message_interval_ = 0;
+    self->frames_ = 0;
+    self->unstamped_frames_ = 0;
+
+    // the latency is measured, waiting for the clock would add to it
+    gst_base_sink_set_sync(GST_BASE_SINK(self), FALSE);
+}
+
+static void gst_tcamlatencysink_finalize(GObject* object)
+{
+    delete GST_TCAMLATENCYSINK(object)->window_;
+    G_OBJECT_CLASS(gst_tcamlatencysink_parent_class)->finalize(object);
+}
+
+static void gst_tcamlatencysink_class_init(GstTCamLatencySinkClass* klass)
+{
+    GObjectClass* gobject_class = (GObjectClass*)klass;
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseSinkClass* gst_base_sink_class = GST_BASE_SINK_CLASS(klass);
+
+    gobject_class->set_property = gst_tcamlatencysink_set_property;
+    gobject_class->get_property = gst_tcamlatencysink_get_property;
+    gobject_class->finalize = gst_tcamlatencysink_finalize;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_WINDOW,
+        g_param_spec_uint("window",
+                          "Window",
+                          "Number of frames the latency distribution is calculated from",
+                          1,
+                          G_MAXINT,
+                          default_window_size,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MESSAGE_INTERVAL,
+        g_param_spec_uint("message-interval",
+                          "Message interval",
+                          "Posts the statistics as element message every n frames, 0 disables",
+                          0,
+                          G_MAXINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STATISTICS,
+        g_param_spec_boxed("statistics",
+                           "Statistics",
+                           "Latency distribution in ns and frame counters",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TCamLatencySink gstreamer element",
+        "Sink/Video",
+        "Measures the latency of frames that carry a timestamp in their pixels",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template(gstelement_class, &sink_template);
+
+    gst_base_sink_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamlatencysink_set_caps);
+    gst_base_sink_class->start = GST_DEBUG_FUNCPTR(gst_tcamlatencysink_start);
+    gst_base_sink_class->stop = GST_DEBUG_FUNCPTR(gst_tcamlatencysink_stop);
+    gst_base_sink_class->render = GST_DEBUG_FUNCPTR(gst_tcamlatencysink_render);
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamlatencysink_debug_category, "tcamlatencysink", 0, "tcamlatencysink element");
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMLATENCYSINK_H_INC_
+#define TCAMLATENCYSINK_H_INC_
+
+#include <dutils_img/dutils_img.h>
+#include <gst/base/gstbasesink.h>
+#include <gst/gst.h>
+
+namespace tcam::latency
+{
+class sliding_window;
+}
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMLATENCYSINK (gst_tcamlatencysink_get_type())
+#define GST_TCAMLATENCYSINK(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMLATENCYSINK, GstTCamLatencySink))
+#define GST_TCAMLATENCYSINK_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMLATENCYSINK, GstTCamLatencySinkClass))
+#define GST_IS_TCAMLATENCYSINK(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMLATENCYSINK))
+#define GST_IS_TCAMLATENCYSINK_CLASS(obj) \
+    (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMLATENCYSINK))
+
+/*
+ * Reads the timestamps that TCAM_VIRTCAM_BENCHMARK=stamp=1 renders into the frames
+ * and keeps the distribution of the time from the delivery in libtcam to this sink.
+ */
+typedef struct GstTCamLatencySink
+{
+    GstBaseSink base;
+
+    // set in set_caps
+    img::img_type type_;
+
+    tcam::latency::sliding_window* window_;
+    guint window_size_;
+    guint message_interval_;
+
+    // protected by the object lock
+    guint64 frames_;
+    guint64 unstamped_frames_;
+
+} GstTCamLatencySink;
+
+typedef struct GstTCamLatencySinkClass
+{
+    GstBaseSinkClass base_class;
+} GstTCamLatencySinkClass;
+
+GType gst_tcamlatencysink_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMLATENCYSINK_H_INC_ */
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamlosslessdec.h"
+
+#include "../../scope_tracing.h"
+
+#include <dutils_img/fcc_to_string.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst-helper/helper_functions.h>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamlosslessdec_debug_category);
+#define GST_CAT_DEFAULT gst_tcamlosslessdec_debug_category
+
+#define gst_tcamlosslessdec_parent_class parent_class
+G_DEFINE_TYPE(GstTCamLosslessDec, gst_tcamlosslessdec, GST_TYPE_BASE_TRANSFORM)
+
+
+static GstCaps* gst_tcamlosslessdec_transform_caps(GstBaseTransform* base,
+                                                   GstPadDirection direction,
+                                                   GstCaps* caps,
+                                                   GstCaps* filter)
+{
+    GstCaps* res_caps = direction == GST_PAD_SINK ? tcamconvert::lossless::to_raw_caps(caps)
+                                                  : tcamconvert::lossless::to_encoded_caps(caps);
+    if (filter)
+    {
+        GstCaps* tmp_caps = res_caps;
+        res_caps = gst_caps_intersect_full(filter, tmp_caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(tmp_caps);
+    }
+
+    GST_DEBUG_OBJECT(base,
+                     "dir=%s transformed %s into %s",
+                     direction == GST_PAD_SRC ? "GST_PAD_SRC" : "GST_PAD_SINK",
+                     gst_helper::to_string(*caps).c_str(),
+                     gst_helper::to_string(*res_caps).c_str());
+    return res_caps;
+}
+
+static gboolean gst_tcamlosslessdec_set_caps(GstBaseTransform* base,
+                                             GstCaps* incaps,
+                                             GstCaps* outcaps)
+{
+    GstTCamLosslessDec* self = GST_TCAMLOSSLESSDEC(base);
+
+    auto dst = gst_helper::get_img_type_from_fixated_gstcaps(*outcaps);
+    if (dst.empty() || tcamconvert::lossless::get_raw_type_from_encoded_caps(*incaps) != dst)
+    {
+        return FALSE;
+    }
+
+    self->decode_ = nullptr;
+    if (img_filter::codec::lossless::is_supported_type(dst))
+    {
+        self->decode_ = tcamconvert::lossless::select_decode(dst);
+    }
+    if (!self->decode_)
+    {
+        GST_ELEMENT_ERROR(self,
+                          STREAM,
+                          FORMAT,
+                          ("Unable to decode %s with a width of %d",
+                           img::fcc_to_string(dst.type).c_str(),
+                           dst.dim.cx),
+                          (NULL));
+        return FALSE;
+    }
+    self->dst_type_ = dst;
+    return TRUE;
+}
+
+static gboolean gst_tcamlosslessdec_transform_size(GstBaseTransform* base,
+                                                   GstPadDirection direction,
+                                                   GstCaps* /*caps*/,
+                                                   gsize /*size*/,
+                                                   GstCaps* /*othercaps*/,
+                                                   gsize* othersize)
+{
+    GstTCamLosslessDec* self = GST_TCAMLOSSLESSDEC(base);
+    if (direction != GST_PAD_SINK || self->dst_type_.empty())
+    {
+        return FALSE;
+    }
+
+    *othersize = static_cast<gsize>(
+        img::calc_minimum_img_size(self->dst_type_.fourcc_type(), self->dst_type_.dim));
+    return *othersize != 0;
+}
+
+static GstFlowReturn gst_tcamlosslessdec_transform(GstBaseTransform* base,
+                                                   GstBuffer* inbuf,
+                                                   GstBuffer* outbuf)
+{
+    TCAM_TRACE_SCOPE("tcamlosslessdec transform");
+
+    GstTCamLosslessDec* self = GST_TCAMLOSSLESSDEC(base);
+
+    GstMapInfo map_in;
+    if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READ))
+    {
+        GST_ERROR_OBJECT(self, "Input buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    GstMapInfo map_out;
+    if (!gst_buffer_map(outbuf, &map_out, GST_MAP_WRITE) || map_out.data == nullptr)
+    {
+        gst_buffer_unmap(inbuf, &map_in);
+
+        GST_ERROR_OBJECT(self, "Output buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    // the frames carry their own type, which has to match the negotiated one
+    img::img_type frame_type;
+    bool decoded = false;
+    if (img_filter::codec::lossless::read_header(map_in.data, map_in.size, frame_type)
+        && frame_type.fourcc_type() == self->dst_type_.fourcc_type()
+        && frame_type.dim == self->dst_type_.dim
+        && map_out.size >= static_cast<gsize>(self->dst_type_.buffer_length))
+    {
+        auto dst = img::make_img_desc_from_linear_memory(self->dst_type_, map_out.data);
+
+        decoded = self->decode_(dst, map_in.data, map_in.size);
+    }
+
+    gst_buffer_unmap(outbuf, &map_out);
+    gst_buffer_unmap(inbuf, &map_in);
+
+    if (!decoded)
+    {
+        GST_ELEMENT_ERROR(self,
+                          STREAM,
+                          DECODE,
+                          ("Failed to decode buffer of %" G_GSIZE_FORMAT " bytes as %s",
+                           map_in.size,
+                           img::fcc_to_string(self->dst_type_.type).c_str()),
+                          (NULL));
+        return GST_FLOW_ERROR;
+    }
+    return GST_FLOW_OK;
+}
+
+static void gst_tcamlosslessdec_init(GstTCamLosslessDec* self)
+{
+    self->dst_type_ = {};
+    self->decode_ = nullptr;
+
+    gst_base_transform_set_in_place(GST_BASE_TRANSFORM(self), FALSE);
+}
+
+static void gst_tcamlosslessdec_class_init(GstTCamLosslessDecClass* klass)
+{
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseTransformClass* gst_base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TCamLosslessDec gstreamer element",
+        "Codec/Decoder/Video",
+        "Decodes the output of tcamlosslessenc into the original Mono/Bayer image",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    auto src_caps = gst_helper::generate_caps_with_dim(tcamconvert::lossless::get_supported_fccs());
+
+    gst_element_class_add_pad_template(
+        gstelement_class, gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS, src_caps.get()));
+
+    auto sink_caps = tcamconvert::lossless::generate_encoded_template_caps();
+
+    gst_element_class_add_pad_template(
+        gstelement_class,
+        gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS, sink_caps.get()));
+
+    gst_base_transform_class->transform_size =
+        GST_DEBUG_FUNCPTR(gst_tcamlosslessdec_transform_size);
+    gst_base_transform_class->transform_caps =
+        GST_DEBUG_FUNCPTR(gst_tcamlosslessdec_transform_caps);
+    gst_base_transform_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamlosslessdec_set_caps);
+    gst_base_transform_class->transform = GST_DEBUG_FUNCPTR(gst_tcamlosslessdec_transform);
+
+    gst_base_transform_class->passthrough_on_same_caps = FALSE;
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamlosslessdec_debug_category, "tcamlosslessdec", 0, "tcamlosslessdec element");
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMLOSSLESSDEC_H_INC_
+#define TCAMLOSSLESSDEC_H_INC_
+
+#include "lossless_caps.h"
+
+#include <gst/base/gstbasetransform.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMLOSSLESSDEC (gst_tcamlosslessdec_get_type())
+#define GST_TCAMLOSSLESSDEC(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMLOSSLESSDEC, GstTCamLosslessDec))
+#define GST_TCAMLOSSLESSDEC_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMLOSSLESSDEC, GstTCamLosslessDecClass))
+#define GST_IS_TCAMLOSSLESSDEC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMLOSSLESSDEC))
+#define GST_IS_TCAMLOSSLESSDEC_CLASS(obj) \
+    (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMLOSSLESSDEC))
+
+typedef struct GstTCamLosslessDec
+{
+    GstBaseTransform base;
+
+    // set in set_caps
+    img::img_type dst_type_;
+    img_filter::codec::lossless::decode_function_type decode_;
+
+} GstTCamLosslessDec;
+
+typedef struct GstTCamLosslessDecClass
+{
+    GstBaseTransformClass base_class;
+} GstTCamLosslessDecClass;
+
+GType gst_tcamlosslessdec_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMLOSSLESSDEC_H_INC_ */
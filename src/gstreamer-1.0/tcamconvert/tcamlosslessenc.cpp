@@ -0,0 +1,209 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tcamlosslessenc.h"
+
+#include "../../scope_tracing.h"
+
+#include <dutils_img/fcc_to_string.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst-helper/helper_functions.h>
+#include <gst/video/gstvideometa.h>
+
+GST_DEBUG_CATEGORY_STATIC(gst_tcamlosslessenc_debug_category);
+#define GST_CAT_DEFAULT gst_tcamlosslessenc_debug_category
+
+#define gst_tcamlosslessenc_parent_class parent_class
+G_DEFINE_TYPE(GstTCamLosslessEnc, gst_tcamlosslessenc, GST_TYPE_BASE_TRANSFORM)
+
+
+static GstCaps* gst_tcamlosslessenc_transform_caps(GstBaseTransform* base,
+                                                   GstPadDirection direction,
+                                                   GstCaps* caps,
+                                                   GstCaps* filter)
+{
+    GstCaps* res_caps = direction == GST_PAD_SINK ? tcamconvert::lossless::to_encoded_caps(caps)
+                                                  : tcamconvert::lossless::to_raw_caps(caps);
+    if (filter)
+    {
+        GstCaps* tmp_caps = res_caps;
+        res_caps = gst_caps_intersect_full(filter, tmp_caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(tmp_caps);
+    }
+
+    GST_DEBUG_OBJECT(base,
+                     "dir=%s transformed %s into %s",
+                     direction == GST_PAD_SRC ? "GST_PAD_SRC" : "GST_PAD_SINK",
+                     gst_helper::to_string(*caps).c_str(),
+                     gst_helper::to_string(*res_caps).c_str());
+    return res_caps;
+}
+
+static gboolean gst_tcamlosslessenc_set_caps(GstBaseTransform* base,
+                                             GstCaps* incaps,
+                                             GstCaps* /*outcaps*/)
+{
+    GstTCamLosslessEnc* self = GST_TCAMLOSSLESSENC(base);
+
+    auto src = gst_helper::get_img_type_from_fixated_gstcaps(*incaps);
+    if (src.empty())
+    {
+        return FALSE;
+    }
+
+    self->encode_ = nullptr;
+    if (img_filter::codec::lossless::is_supported_type(src))
+    {
+        self->encode_ = tcamconvert::lossless::select_encode(src);
+    }
+    if (!self->encode_)
+    {
+        GST_ELEMENT_ERROR(self,
+                          STREAM,
+                          FORMAT,
+                          ("Unable to encode %s with a width of %d",
+                           img::fcc_to_string(src.type).c_str(),
+                           src.dim.cx),
+                          (NULL));
+        return FALSE;
+    }
+    self->src_type_ = src;
+    return TRUE;
+}
+
+// the output buffer has the worst case size, transform shrinks it to the encoded size
+static gboolean gst_tcamlosslessenc_transform_size(GstBaseTransform* base,
+                                                   GstPadDirection direction,
+                                                   GstCaps* /*caps*/,
+                                                   gsize /*size*/,
+                                                   GstCaps* /*othercaps*/,
+                                                   gsize* othersize)
+{
+    GstTCamLosslessEnc* self = GST_TCAMLOSSLESSENC(base);
+    if (direction != GST_PAD_SINK || self->src_type_.empty())
+    {
+        return FALSE;
+    }
+
+    *othersize = img_filter::codec::lossless::calc_max_encoded_size(self->src_type_);
+    return *othersize != 0;
+}
+
+static img::img_descriptor make_img_desc_from_input_buffer(const img::img_type& src_type,
+                                                           guint8* map_in_data,
+                                                           GstBuffer* inbuf)
+{
+    auto meta = gst_buffer_get_video_meta(inbuf);
+    if (meta != nullptr && meta->stride[0] != 0)
+    {
+        return img::make_img_desc_raw(
+            src_type, img::img_plane { map_in_data + meta->offset[0], meta->stride[0] });
+    }
+    return img::make_img_desc_from_linear_memory(src_type, map_in_data);
+}
+
+static GstFlowReturn gst_tcamlosslessenc_transform(GstBaseTransform* base,
+                                                   GstBuffer* inbuf,
+                                                   GstBuffer* outbuf)
+{
+    TCAM_TRACE_SCOPE("tcamlosslessenc transform");
+
+    GstTCamLosslessEnc* self = GST_TCAMLOSSLESSENC(base);
+
+    GstMapInfo map_in;
+    if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READ))
+    {
+        GST_ERROR_OBJECT(self, "Input buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    GstMapInfo map_out;
+    if (!gst_buffer_map(outbuf, &map_out, GST_MAP_WRITE) || map_out.data == nullptr)
+    {
+        gst_buffer_unmap(inbuf, &map_in);
+
+        GST_ERROR_OBJECT(self, "Output buffer could not be mapped");
+        return GST_FLOW_OK;
+    }
+
+    auto src = make_img_desc_from_input_buffer(self->src_type_, map_in.data, inbuf);
+
+    size_t encoded_size = 0;
+    if (map_in.size >= src.size())
+    {
+        encoded_size = self->encode_(src, map_out.data, map_out.size);
+    }
+
+    gst_buffer_unmap(outbuf, &map_out);
+    gst_buffer_unmap(inbuf, &map_in);
+
+    if (encoded_size == 0)
+    {
+        GST_ELEMENT_ERROR(self,
+                          STREAM,
+                          ENCODE,
+                          ("Failed to encode buffer of %" G_GSIZE_FORMAT " bytes", map_in.size),
+                          (NULL));
+        return GST_FLOW_ERROR;
+    }
+
+    gst_buffer_set_size(outbuf, encoded_size);
+    return GST_FLOW_OK;
+}
+
+static void gst_tcamlosslessenc_init(GstTCamLosslessEnc* self)
+{
+    self->src_type_ = {};
+    self->encode_ = nullptr;
+
+    gst_base_transform_set_in_place(GST_BASE_TRANSFORM(self), FALSE);
+}
+
+static void gst_tcamlosslessenc_class_init(GstTCamLosslessEncClass* klass)
+{
+    GstElementClass* gstelement_class = (GstElementClass*)klass;
+    GstBaseTransformClass* gst_base_transform_class = GST_BASE_TRANSFORM_CLASS(klass);
+
+    gst_element_class_set_static_metadata(
+        gstelement_class,
+        "The Imaging Source TCamLosslessEnc gstreamer element",
+        "Codec/Encoder/Video",
+        "Lossless compression of Mono/Bayer 8/10/12/16 bit images, including the packed formats",
+        "The Imaging Source <support@theimagingsource.com>");
+
+    auto src_caps = tcamconvert::lossless::generate_encoded_template_caps();
+
+    gst_element_class_add_pad_template(
+        gstelement_class, gst_pad_template_new("src", GST_PAD_SRC, GST_PAD_ALWAYS, src_caps.get()));
+
+    auto sink_caps = gst_helper::generate_caps_with_dim(tcamconvert::lossless::get_supported_fccs());
+
+    gst_element_class_add_pad_template(
+        gstelement_class,
+        gst_pad_template_new("sink", GST_PAD_SINK, GST_PAD_ALWAYS, sink_caps.get()));
+
+    gst_base_transform_class->transform_size =
+        GST_DEBUG_FUNCPTR(gst_tcamlosslessenc_transform_size);
+    gst_base_transform_class->transform_caps =
+        GST_DEBUG_FUNCPTR(gst_tcamlosslessenc_transform_caps);
+    gst_base_transform_class->set_caps = GST_DEBUG_FUNCPTR(gst_tcamlosslessenc_set_caps);
+    gst_base_transform_class->transform = GST_DEBUG_FUNCPTR(gst_tcamlosslessenc_transform);
+
+    gst_base_transform_class->passthrough_on_same_caps = FALSE;
+
+    GST_DEBUG_CATEGORY_INIT(
+        gst_tcamlosslessenc_debug_category, "tcamlosslessenc", 0, "tcamlosslessenc element");
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAMLOSSLESSENC_H_INC_
+#define TCAMLOSSLESSENC_H_INC_
+
+#include "lossless_caps.h"
+
+#include <gst/base/gstbasetransform.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAMLOSSLESSENC (gst_tcamlosslessenc_get_type())
+#define GST_TCAMLOSSLESSENC(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAMLOSSLESSENC, GstTCamLosslessEnc))
+#define GST_TCAMLOSSLESSENC_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST((klass), GST_TYPE_TCAMLOSSLESSENC, GstTCamLosslessEncClass))
+#define GST_IS_TCAMLOSSLESSENC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAMLOSSLESSENC))
+#define GST_IS_TCAMLOSSLESSENC_CLASS(obj) \
+    (G_TYPE_CHECK_CLASS_TYPE((klass), GST_TYPE_TCAMLOSSLESSENC))
+
+typedef struct GstTCamLosslessEnc
+{
+    GstBaseTransform base;
+
+    // set in set_caps
+    img::img_type src_type_;
+    img_filter::codec::lossless::encode_function_type encode_;
+
+} GstTCamLosslessEnc;
+
+typedef struct GstTCamLosslessEncClass
+{
+    GstBaseTransformClass base_class;
+} GstTCamLosslessEncClass;
+
+GType gst_tcamlosslessenc_get_type(void);
+
+G_END_DECLS
+
+#endif /* TCAMLOSSLESSENC_H_INC_ */
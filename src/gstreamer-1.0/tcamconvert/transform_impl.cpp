@@ -1,17 +1,28 @@
 
 #include "transform_impl.h"
 
+#include "../../../libs/dutils_image/src/dutils_img_base/img_rect_tools.h"
 #include "../../../libs/dutils_image/src/dutils_img_base/memcpy_image.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/filter/whitebalance/wb_apply.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/bayer_binning/transform_bayer_binning.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/fcc1x_packed_to_fcc.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc1x_packed/transform_fcc1x_to_fcc8.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fcc8_fcc16.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fccXX_to_fcc8_lut_internal.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fccXX_to_fccfloat.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/transform/mono_to_bgr/transform_mono_to_bgr.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/polarization/transform_polarization.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/tensor/transform_tensor.h"
+
+#include <dutils_img_lib/dutils_get_cpu_features.h>
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace
@@ -58,7 +69,7 @@ static const constexpr transform_path transform_entries[] =
 {
     {
         { fourcc::MONO8 },
-        { fourcc::MONO8, fourcc::BGRA32 },
+        { fourcc::MONO8, fourcc::BGRA32, fourcc::BGR24 },
     },
     {
         {
@@ -71,11 +82,11 @@ static const constexpr transform_path transform_entries[] =
             fourcc::MONO12_PACKED,
             fourcc::MONO16,
         },
-        { fourcc::MONO8, fourcc::MONO16, fourcc::BGRA32 }
+        { fourcc::MONO8, fourcc::MONO16, fourcc::BGRA32, fourcc::BGR24 }
     },
     {
         { fourcc::BGGR8, },
-        { fourcc::BGGR8, fourcc::BGRA32 }
+        { fourcc::BGGR8, fourcc::BGRA32, fourcc::BGR24, fourcc::NV12, fourcc::I420, fourcc::YUY2 }
     },
     {
         {
@@ -88,11 +99,15 @@ static const constexpr transform_path transform_entries[] =
             fourcc::BGGR12_MIPI_PACKED,
             fourcc::BGGR16,
         },
-        { fourcc::BGGR8, fourcc::BGGR16, fourcc::BGRA32 }
+        {
+            fourcc::BGGR8, fourcc::BGGR16, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2,
+            fourcc::BGR24, fourcc::YUV8PLANAR, fourcc::YUV16PLANAR, fourcc::YUVF32PLANAR,
+            fourcc::RGBF32PLANAR, fourcc::RGBF16PLANAR, fourcc::BGRA64,
+        }
     },
     {
         { fourcc::GBRG8, },
-        { fourcc::GBRG8, fourcc::BGRA32 }
+        { fourcc::GBRG8, fourcc::BGRA32, fourcc::BGR24, fourcc::NV12, fourcc::I420, fourcc::YUY2 }
     },
     {
         {
@@ -105,11 +120,15 @@ static const constexpr transform_path transform_entries[] =
             fourcc::GBRG12_MIPI_PACKED,
             fourcc::GBRG16,
         },
-        { fourcc::GBRG8, fourcc::GBRG16, fourcc::BGRA32 }
+        {
+            fourcc::GBRG8, fourcc::GBRG16, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2,
+            fourcc::BGR24, fourcc::YUV8PLANAR, fourcc::YUV16PLANAR, fourcc::YUVF32PLANAR,
+            fourcc::RGBF32PLANAR, fourcc::RGBF16PLANAR, fourcc::BGRA64,
+        }
     },
     {
         { fourcc::RGGB8, },
-        { fourcc::RGGB8, fourcc::BGRA32 }
+        { fourcc::RGGB8, fourcc::BGRA32, fourcc::BGR24, fourcc::NV12, fourcc::I420, fourcc::YUY2 }
     },
     {
         {
@@ -122,11 +141,15 @@ static const constexpr transform_path transform_entries[] =
             fourcc::RGGB12_MIPI_PACKED,
             fourcc::RGGB16,
         },
-        { fourcc::RGGB8, fourcc::RGGB16, fourcc::BGRA32 }
+        {
+            fourcc::RGGB8, fourcc::RGGB16, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2,
+            fourcc::BGR24, fourcc::YUV8PLANAR, fourcc::YUV16PLANAR, fourcc::YUVF32PLANAR,
+            fourcc::RGBF32PLANAR, fourcc::RGBF16PLANAR, fourcc::BGRA64,
+        }
     },
     {
         { fourcc::GRBG8, },
-        { fourcc::GRBG8, fourcc::BGRA32 }
+        { fourcc::GRBG8, fourcc::BGRA32, fourcc::BGR24, fourcc::NV12, fourcc::I420, fourcc::YUY2 }
     },
     {
         {
@@ -139,11 +162,48 @@ static const constexpr transform_path transform_entries[] =
             fourcc::GRBG12_MIPI_PACKED,
             fourcc::GRBG16,
         },
-        { fourcc::GRBG8, fourcc::GRBG16, fourcc::BGRA32 }
+        {
+            fourcc::GRBG8, fourcc::GRBG16, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2,
+            fourcc::BGR24, fourcc::YUV8PLANAR, fourcc::YUV16PLANAR, fourcc::YUVF32PLANAR,
+            fourcc::RGBF32PLANAR, fourcc::RGBF16PLANAR, fourcc::BGRA64,
+        }
+    },
+    {
+        {
+            fourcc::PWL_RG12_MIPI,
+            fourcc::PWL_RG12,
+            fourcc::PWL_RG16H12,
+        },
+        {
+            fourcc::RGGB8, fourcc::BGRA32, fourcc::NV12, fourcc::I420, fourcc::YUY2,
+            fourcc::BGR24, fourcc::YUV8PLANAR, fourcc::YUV16PLANAR, fourcc::YUVF32PLANAR,
+            fourcc::RGBF32PLANAR, fourcc::RGBF16PLANAR,
+        }
+    },
+    {
+        {
+            fourcc::POLARIZATION_MONO8_90_45_135_0,
+            fourcc::POLARIZATION_MONO12_PACKED_90_45_135_0,
+            fourcc::POLARIZATION_MONO12_SPACKED_90_45_135_0,
+            fourcc::POLARIZATION_MONO16_90_45_135_0,
+        },
+        {
+            fourcc::POLARIZATION_ADI_MONO8,
+            fourcc::POLARIZATION_ADI_MONO16,
+            fourcc::POLARIZATION_PACKED8,
+            fourcc::POLARIZATION_PACKED16,
+        }
     },
 };
 // clang-format on
 
+// full resolution planes, converted through float bayer, see transform_context_mode::binary_yuv_planar
+constexpr bool is_yuv_planar_float_path_fcc(img::fourcc fcc) noexcept
+{
+    return fcc == img::fourcc::YUV8PLANAR || fcc == img::fourcc::YUV16PLANAR
+           || fcc == img::fourcc::YUVF32PLANAR;
+}
+
 void append_unique(std::vector<img::fourcc>& vec, const fcc_array2& arr)
 {
     for (auto fcc : arr)
@@ -172,123 +232,406 @@ auto tcamconvert::tcamconvert_get_all_output_fccs() -> std::vector<img::fourcc>
     return rval;
 }
 
-auto tcamconvert::tcamconvert_get_supported_input_fccs(img::fourcc dst_fcc)
-    -> std::vector<img::fourcc>
+namespace
 {
-    std::vector<img::fourcc> rval;
-    for (auto e : transform_entries)
+using fcc_map = std::map<img::fourcc, std::vector<img::fourcc>>;
+
+// transform_caps asks for every caps structure, the answers are computed once for all formats
+auto build_fcc_map(const std::vector<img::fourcc>& keys, bool key_is_dst) -> fcc_map
+{
+    fcc_map rval;
+    for (auto key : keys)
     {
-        if (e.dst_fcc.has_fcc(dst_fcc))
+        auto& vec = rval[key];
+        for (const auto& e : transform_entries)
         {
-            append_unique(rval, e.src_fcc);
+            if (key_is_dst ? e.dst_fcc.has_fcc(key) : e.src_fcc.has_fcc(key))
+            {
+                append_unique(vec, key_is_dst ? e.src_fcc : e.dst_fcc);
+            }
         }
     }
     return rval;
 }
 
+auto find_fccs(const fcc_map& map, img::fourcc fcc) -> const std::vector<img::fourcc>&
+{
+    static const std::vector<img::fourcc> empty;
+
+    auto iter = map.find(fcc);
+    return iter != map.end() ? iter->second : empty;
+}
+} // namespace
+
+auto tcamconvert::tcamconvert_get_supported_input_fccs(img::fourcc dst_fcc)
+    -> const std::vector<img::fourcc>&
+{
+    static const fcc_map map = build_fcc_map(tcamconvert_get_all_output_fccs(), true);
+    return find_fccs(map, dst_fcc);
+}
+
 auto tcamconvert::tcamconvert_get_supported_output_fccs(img::fourcc src_fcc)
-    -> std::vector<img::fourcc>
+    -> const std::vector<img::fourcc>&
 {
-    std::vector<img::fourcc> rval;
-    for (auto e : transform_entries)
+    static const fcc_map map = build_fcc_map(tcamconvert_get_all_input_fccs(), false);
+    return find_fccs(map, src_fcc);
+}
+
+bool tcamconvert::tcamconvert_can_bin(img::fourcc src_fcc, img::fourcc dst_fcc)
+{
+    if (!img::is_bayer_fcc(src_fcc) && !img::is_pwl_fcc(src_fcc))
+    {
+        return false;
+    }
+    if (dst_fcc == img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_fcc))
+    {
+        return true;
+    }
+    if (is_yuv_planar_float_path_fcc(dst_fcc))
+    {
+        return false;
+    }
+    if (img_filter::transform::tensor::is_tensor_fcc(dst_fcc))
+    {
+        // the bayer quads are averaged in float, see transform_context::setup_tensor
+        return !img::is_by8_fcc(src_fcc);
+    }
+    return dst_fcc == img::fourcc::BGRA32 || dst_fcc == img::fourcc::BGR24
+           || img::is_yuv_format(dst_fcc);
+}
+
+img::rect tcamconvert::align_roi(img::rect roi) noexcept
+{
+    roi = img::normalize(roi);
+
+    auto align_down = [](int val, int alignment)
+    {
+        return (std::max(val, 0) / alignment) * alignment;
+    };
+    const auto dim = roi.dimensions();
+    const int left = align_down(roi.left, 4);
+    const int top = align_down(roi.top, 2);
+    return img::rect { img::point { left, top },
+                       img::dim { align_down(dim.cx, 4), align_down(dim.cy, 2) } };
+}
+
+img::dim tcamconvert::calc_roi_output_dim(const std::vector<img::rect>& rois) noexcept
+{
+    img::dim rval = { 0, 0 };
+    for (const auto& roi : rois)
+    {
+        rval.cx = std::max(rval.cx, roi.dimensions().cx);
+        rval.cy += roi.dimensions().cy;
+    }
+    return rval;
+}
+
+img::dim tcamconvert::calc_roi_extent(const std::vector<img::rect>& rois) noexcept
+{
+    img::dim rval = { 0, 0 };
+    for (const auto& roi : rois)
+    {
+        rval.cx = std::max(rval.cx, roi.right);
+        rval.cy = std::max(rval.cy, roi.bottom);
+    }
+    return rval;
+}
+
+bool tcamconvert::is_roi_dst_fcc(img::fourcc dst_fcc) noexcept
+{
+    return !img::is_multi_plane_format(dst_fcc)
+           && !img_filter::transform::tensor::is_tensor_fcc(dst_fcc);
+}
+
+
+namespace
+{
+
+/*
+ * One implementation of a kernel.
+ * Lists of variants are ordered by preference, select_kernel picks the first one
+ * the cpu supports and that implements the requested conversion.
+ */
+template<class TGetter> struct kernel_variant
+{
+    const char* name;
+    unsigned int required_features;
+    TGetter get;
+};
+
+unsigned int cpu_features() noexcept
+{
+    static const unsigned int features = img_lib::cpu::get_features();
+    return features;
+}
+
+template<class TGetter, size_t N, class... TArgs>
+auto select_kernel(const kernel_variant<TGetter> (&variants)[N],
+                   std::string& selected,
+                   const TArgs&... args)
+{
+    for (const auto& variant : variants)
     {
-        if (e.src_fcc.has_fcc(src_fcc))
+        if ((cpu_features() & variant.required_features) != variant.required_features)
+        {
+            continue;
+        }
+        if (auto func = variant.get(args...); func)
         {
-            append_unique(rval, e.dst_fcc);
+            if (!selected.empty())
+            {
+                selected += ", ";
+            }
+            selected += variant.name;
+            return func;
         }
     }
-    return rval;
+    return decltype(variants[0].get(args...)) { nullptr };
 }
 
+#if defined DUTILS_ARCH_ARM
+constexpr unsigned int neon_features = img::cpu::CPU_ARM_A7;
+// the sve2 kernels are only built with a compiler that supports them, they are checked at runtime
+constexpr unsigned int sve2_features = img::cpu::CPU_ARM_SVE2;
+#else
+constexpr unsigned int avx512bw_features = img::cpu::CPU_AVX512_F | img::cpu::CPU_AVX512_BW;
+constexpr unsigned int avx512vbmi_features = avx512bw_features | img::cpu::CPU_AVX512_VBMI;
+#endif
 
-static auto find_transform_unary_wb_func(img::img_type type)
+// clang-format off
+const kernel_variant<img_filter::whitebalance::func_type (*)(img::img_type)> wb_variants[] =
 {
 #if defined DUTILS_ARCH_ARM
-    auto wb_func = img_filter::whitebalance::get_apply_img_neon(type);
-#elif defined DUTILS_ARCH_SSE41
-    auto wb_func = img_filter::whitebalance::get_apply_img_sse41(type);
-#elif
-    auto wb_func = img_filter::whitebalance::get_apply_img_c(type);
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+    { "wb_sve2", sve2_features, img_filter::whitebalance::get_apply_img_sve2 },
 #endif
-    return wb_func;
-}
+    { "wb_neon", neon_features, img_filter::whitebalance::get_apply_img_neon },
+#else
+    { "wb_avx2", img::cpu::CPU_AVX2, img_filter::whitebalance::get_apply_img_avx2 },
+    { "wb_sse41", img::cpu::CPU_SSE41, img_filter::whitebalance::get_apply_img_sse41 },
+#endif
+    { "wb_c", 0, img_filter::whitebalance::get_apply_img_c },
+};
+
+const kernel_variant<img_filter::flat_field::line_func (*)(img::fourcc)> flat_field_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+    { "flat_field_neon", neon_features, img_filter::flat_field::get_line_func_neon },
+#else
+    { "flat_field_avx2", img::cpu::CPU_AVX2, img_filter::flat_field::get_line_func_avx2 },
+    { "flat_field_sse41", img::cpu::CPU_SSE41, img_filter::flat_field::get_line_func_sse41 },
+#endif
+    { "flat_field_c", 0, img_filter::flat_field::get_line_func_c },
+};
 
+using transform_getter = img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
 
-static auto find_transform_mono_to_bgr_func(img::img_type dst_type, img::img_type src_type)
+const kernel_variant<transform_getter> mono_to_bgr_variants[] =
 {
 #if defined DUTILS_ARCH_ARM
-    auto func = img_filter::transform::get_transform_mono_to_bgr_neon(dst_type, src_type);
-#elif defined DUTILS_ARCH_SSE41
-    auto func = img_filter::transform::get_transform_mono_to_bgr_sse41(dst_type, src_type);
-#elif
-    auto func = img_filter::transform::get_transform_mono_to_bgr_c(dst_type, src_type);
+    { "mono_to_bgr_neon", neon_features, img_filter::transform::get_transform_mono_to_bgr_neon },
+#else
+    { "mono_to_bgr_sse41", img::cpu::CPU_SSE41, img_filter::transform::get_transform_mono_to_bgr_sse41 },
 #endif
-    return func;
-}
+    { "mono_to_bgr_c", 0, img_filter::transform::get_transform_mono_to_bgr_c },
+};
 
-static auto find_transform_function_type(img::img_type dst_type, img::img_type src_type)
-    -> img_filter::transform_function_type
+const kernel_variant<transform_getter> transform_variants[] =
 {
-    using func_type =
-        img_filter::transform_function_type (*)(const img::img_type&, const img::img_type&);
+#if defined DUTILS_ARCH_ARM
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+    { "fcc1x_packed_to_fcc8_sve2", sve2_features, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_sve2 },
+    { "fcc16_to_fcc8_sve2", sve2_features, img_filter::transform::get_transform_fcc16_to_fcc8_sve2 },
+#endif
+    { "fcc1x_packed_to_fcc8_neon", neon_features, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_neon_v0 },
+    { "fcc1x_packed_to_fcc16_neon", neon_features, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0 },
+    { "fcc8_to_fcc16_neon", neon_features, img_filter::transform::get_transform_fcc8_to_fcc16_neon },
+    { "fcc16_to_fcc8_neon", neon_features, img_filter::transform::get_transform_fcc16_to_fcc8_neon },
+#else
+    { "fcc1x_packed_to_fcc8_avx512vbmi", avx512vbmi_features, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx512vbmi },
+    { "fcc1x_packed_to_fcc16_avx512vbmi", avx512vbmi_features, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_avx512vbmi },
+    { "fcc1x_packed_to_fcc8_avx2", img::cpu::CPU_AVX2, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_avx2 },
+    { "fcc1x_packed_to_fcc16_avx2", img::cpu::CPU_AVX2, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_avx2 },
+    { "fcc1x_packed_to_fcc8_ssse3", img::cpu::CPU_SSSE3, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_ssse3 },
+    { "fcc1x_packed_to_fcc16_ssse3", img::cpu::CPU_SSSE3, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_ssse3 },
+    { "fcc8_to_fcc16_sse41", img::cpu::CPU_SSE41, img_filter::transform::get_transform_fcc8_to_fcc16_sse41 },
+    { "fcc16_to_fcc8_sse41", img::cpu::CPU_SSE41, img_filter::transform::get_transform_fcc16_to_fcc8_sse41 },
+#endif
+    { "fcc1x_packed_to_fcc8_c", 0, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_c },
+    { "fcc1x_packed_to_fcc16_c", 0, img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_c },
+    { "fcc8_to_fcc16_c", 0, img_filter::transform::get_transform_fcc8_to_fcc16_c },
+    { "fcc16_to_fcc8_c", 0, img_filter::transform::get_transform_fcc16_to_fcc8_c },
+};
 
-    static func_type func_list[] = {
+// unpack and white balance in one pass
+const kernel_variant<img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&)> transform_wb_variants[] =
+{
 #if defined DUTILS_ARCH_ARM
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_neon_v0,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0,
-        img_filter::transform::get_transform_fcc8_to_fcc16_neon,
-        img_filter::transform::get_transform_fcc16_to_fcc8_neon,
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+    { "fcc1x_to_fcc8_sve2", sve2_features, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_sve2 },
+#endif
+    { "fcc1x_to_fcc8_neon", neon_features, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_v0 },
+    { "pwl12_to_fcc8_neon", neon_features, img_filter::transform::pwl::get_transform_pwl12_to_fcc8_neon },
 #else
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_ssse3,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_ssse3,
-        img_filter::transform::get_transform_fcc8_to_fcc16_sse41,
-        img_filter::transform::get_transform_fcc16_to_fcc8_sse41,
+    { "fcc1x_to_fcc8_avx2", img::cpu::CPU_AVX2, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_avx2 },
+    { "fcc1x_to_fcc8_ssse3", img::cpu::CPU_SSSE3, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_ssse3 },
+    { "pwl12_to_fcc8_avx2", img::cpu::CPU_AVX2, img_filter::transform::pwl::get_transform_pwl12_to_fcc8_avx2 },
+    { "pwl12_to_fcc8_sse41", img::cpu::CPU_SSE41, img_filter::transform::pwl::get_transform_pwl12_to_fcc8_sse41 },
 #endif
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc8_c,
-        img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_c,
-        img_filter::transform::get_transform_fcc8_to_fcc16_c,
-        img_filter::transform::get_transform_fcc16_to_fcc8_c,
-    };
+    { "fcc1x_to_fcc8_c", 0, img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_c },
+    // pwl tables include the white balance, see transform_context::transform
+    { "pwl12_to_fcc8_c", 0, img_filter::transform::pwl::get_transform_pwl12_to_fcc8_c },
+};
 
-    for (auto func : func_list)
-    {
-        if (auto res = func(dst_type, src_type); res)
-        {
-            return res;
-        }
-    }
-    return nullptr;
-}
+// gamma/contrast/tone mapping and white balance through tables, used instead of the above while a tone curve is set
+const kernel_variant<img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&)> tone_curve_variants[] =
+{
+#if !defined DUTILS_ARCH_ARM
+    { "fccXX_to_fcc8_lut_avx2", img::cpu::CPU_AVX2, img_filter::transform::get_transform_fccXX_to_fcc8_lut_avx2 },
+#endif
+    { "fccXX_to_fcc8_lut_c", 0, img_filter::transform::get_transform_fccXX_to_fcc8_lut_c },
+};
+
+// avx512bw only implements BGRA32, the wider variants need a minimum width
+const kernel_variant<img_filter::transform::by_edge::function_type (*)(img::img_type, img::img_type)> by8_to_dst_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+#if defined DUTILS_IMG_FILTER_HAS_SVE2
+    { "by8_to_dst_sve2", sve2_features, img_filter::transform::by_edge::get_transform_by8_to_dst_sve2 },
+#endif
+    { "by8_to_dst_neon", neon_features, img_filter::transform::by_edge::get_transform_by8_to_dst_neon },
+#else
+    { "by8_to_dst_avx512bw", avx512bw_features, img_filter::transform::by_edge::get_transform_by8_to_dst_avx512bw },
+    { "by8_to_dst_avx2", img::cpu::CPU_AVX2, img_filter::transform::by_edge::get_transform_by8_to_dst_avx2 },
+    { "by8_to_dst_sse41", img::cpu::CPU_SSE41, img_filter::transform::by_edge::get_transform_by8_to_dst_sse41 },
+#endif
+    { "by8_to_dst_c", 0, img_filter::transform::by_edge::get_transform_by8_to_dst_c },
+};
+
+const kernel_variant<transform_getter> binning_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+    { "by8_binning_neon", neon_features, img_filter::transform::bayer_binning::get_transform_by8_binning_neon },
+#else
+    { "by8_binning_sse41", img::cpu::CPU_SSE41, img_filter::transform::bayer_binning::get_transform_by8_binning_sse41 },
+#endif
+    { "by8_binning_c", 0, img_filter::transform::bayer_binning::get_transform_by8_binning_c },
+};
 
-static auto find_transform_function_wb_type(img::img_type dst_type, img::img_type src_type)
-    -> std::function<void(const img::img_descriptor& dst,
-                          const img::img_descriptor& src,
-                          img_filter::filter_params& params)>
+const kernel_variant<transform_getter> polarization_variants[] =
 {
-    using func_type =
-        img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&);
+#if !defined DUTILS_ARCH_ARM
+    { "polarization_sse41", img::cpu::CPU_SSE41, img_filter::transform::polarization::get_transform_polarization_sse41 },
+#endif
+    { "polarization_c", 0, img_filter::transform::polarization::get_transform_polarization_c },
+};
 
-    static func_type func_list[] = {
+// the debayering is done by one of the by8_to_dst_variants, these only convert its BGRA32 lines
+const kernel_variant<img_filter::transform::by_edge::yuv_function_type (*)(img::img_type, img::img_type)> by8_to_yuv_variants[] =
+{
 #if defined DUTILS_ARCH_ARM
-        img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_neon_v0,
-    //img_filter::transform::fcc1x_packed::get_transform_fcc10or12_packed_to_fcc16_neon_v0,
-    //img_filter::transform::get_transform_fcc8_to_fcc16_neon,
-    //img_filter::transform::get_transform_fcc16_to_fcc8_wb_neon,
+    { "by8_to_yuv_neon", neon_features, img_filter::transform::by_edge::get_transform_by8_to_yuv_neon },
 #else
+    { "by8_to_yuv_sse41", img::cpu::CPU_SSE41, img_filter::transform::by_edge::get_transform_by8_to_yuv_sse41 },
 #endif
-        img_filter::transform::fcc1x_packed::get_transform_fcc1x_to_fcc8_c,
-    };
+    { "by8_to_yuv_c", 0, img_filter::transform::by_edge::get_transform_by8_to_yuv_c },
+};
+// the input of the float debayering, the white balance is applied while unpacking
+const kernel_variant<img_filter::transform_function_param_type (*)(const img::img_type&, const img::img_type&)> fccXX_to_fccfloat_wb_variants[] =
+{
+#if !defined DUTILS_ARCH_ARM
+    { "fccXX_to_fccfloat_wb_avx2", img::cpu::CPU_AVX2, img_filter::transform::get_transform_fccXX_to_fccfloat_wb_avx2 },
+#endif
+    { "fccXX_to_fccfloat_wb_c", 0, img_filter::transform::get_transform_fccXX_to_fccfloat_wb_c },
+};
+
+const kernel_variant<transform_getter> pwl_to_fccfloat_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+    { "pwl_to_fccfloat_neon", neon_features, img_filter::transform::pwl::get_transform_pwl_to_fccfloat_neon },
+#else
+    { "pwl_to_fccfloat_avx2", img::cpu::CPU_AVX2, img_filter::transform::pwl::get_transform_pwl_to_fccfloat_avx2 },
+    { "pwl_to_fccfloat_sse41", img::cpu::CPU_SSE41, img_filter::transform::pwl::get_transform_pwl_to_fccfloat_sse41 },
+#endif
+    { "pwl_to_fccfloat_c", 0, img_filter::transform::pwl::get_transform_pwl_to_fccfloat_c },
+};
+
+const kernel_variant<img_filter::transform::by_edge::function_type (*)(img::img_type, img::img_type)> byfloat_to_bgrfloat_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+    { "byfloat_to_bgrfloat_neon", neon_features, img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_neon },
+#else
+    { "byfloat_to_bgrfloat_avx2", img::cpu::CPU_AVX2, img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_avx2 },
+#endif
+    { "byfloat_to_bgrfloat_c", 0, img_filter::transform::by_edge::get_transform_byfloat_to_bgrfloat_c },
+};
+
+const kernel_variant<img_filter::transform::by_edge::function_type (*)(img::img_type, img::img_type)> by16_to_bgra64_variants[] =
+{
+#if defined DUTILS_ARCH_ARM
+    { "by16_to_bgra64_neon", neon_features, img_filter::transform::by_edge::get_transform_by16_to_bgra64_neon },
+#else
+    { "by16_to_bgra64_avx2", img::cpu::CPU_AVX2, img_filter::transform::by_edge::get_transform_by16_to_bgra64_avx2 },
+    { "by16_to_bgra64_sse41", img::cpu::CPU_SSE41, img_filter::transform::by_edge::get_transform_by16_to_bgra64_sse41 },
+#endif
+    { "by16_to_bgra64_c", 0, img_filter::transform::by_edge::get_transform_by16_to_bgra64_c },
+};
+
+// the debayering is done by one of the byfloat_to_bgrfloat_variants, these only convert its BGRFloat lines
+const kernel_variant<img_filter::transform::by_edge::yuv_function_type (*)(img::img_type, img::img_type)> byfloat_to_yuv_planar_variants[] =
+{
+#if !defined DUTILS_ARCH_ARM
+    { "byfloat_to_yuv_planar_avx2", img::cpu::CPU_AVX2, img_filter::transform::by_edge::get_transform_byfloat_to_yuv_planar_avx2 },
+#endif
+    { "byfloat_to_yuv_planar_c", 0, img_filter::transform::by_edge::get_transform_byfloat_to_yuv_planar_c },
+};
+
+// bins or debayers with one of the byfloat_to_bgrfloat_variants, normalizes and writes the planes
+const kernel_variant<img_filter::transform::tensor::function_type (*)(img::img_type, img::img_type)> byfloat_to_tensor_variants[] =
+{
+#if !defined DUTILS_ARCH_ARM
+    { "byfloat_to_tensor_avx2", img::cpu::CPU_AVX2, img_filter::transform::tensor::get_transform_byfloat_to_tensor_avx2 },
+#endif
+    { "byfloat_to_tensor_c", 0, img_filter::transform::tensor::get_transform_byfloat_to_tensor_c },
+};
+// clang-format on
+
+} // namespace
 
-    for (auto func : func_list)
+
+static auto find_transform_unary_wb_func(img::img_type type, std::string& selected)
+{
+    return select_kernel(wb_variants, selected, type);
+}
+
+
+static auto find_transform_mono_to_bgr_func(img::img_type dst_type,
+                                            img::img_type src_type,
+                                            std::string& selected)
+{
+    return select_kernel(mono_to_bgr_variants, selected, dst_type, src_type);
+}
+
+static auto find_transform_function_type(img::img_type dst_type,
+                                         img::img_type src_type,
+                                         std::string& selected)
+    -> img_filter::transform_function_type
+{
+    return select_kernel(transform_variants, selected, dst_type, src_type);
+}
+
+static auto find_transform_function_wb_only_type(img::img_type dst_type,
+                                                 img::img_type src_type,
+                                                 std::string& selected)
+    -> tcamconvert::transform_binary_wb_func
+{
+    if (auto res = select_kernel(transform_wb_variants, selected, dst_type, src_type); res)
     {
-        if (auto res = func(dst_type, src_type); res)
-        {
-            return res;
-        }
+        return res;
     }
 
-    auto transform_only_func = find_transform_function_type(dst_type, src_type);
-    auto wb_func = find_transform_unary_wb_func(dst_type);
+    auto transform_only_func = find_transform_function_type(dst_type, src_type, selected);
+    auto wb_func = find_transform_unary_wb_func(dst_type, selected);
 
     auto transform_func = [transform_only_func, wb_func](const img::img_descriptor& dst,
                                                          const img::img_descriptor& src,
@@ -300,119 +643,676 @@ static auto find_transform_function_wb_type(img::img_type dst_type, img::img_typ
     return transform_func;
 }
 
-static auto find_bayer8_to_bgra_func(const img::img_type& dst_type, const img::img_type& src_type)
-    -> tcamconvert::transform_binary_func
+// switches to a tone_curve_variants kernel for the frames that pass tables in params
+static auto find_transform_function_wb_type(img::img_type dst_type,
+                                            img::img_type src_type,
+                                            std::string& selected)
+    -> tcamconvert::transform_binary_wb_func
 {
-#if defined DUTILS_ARCH_ARM
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_neon(dst_type, src_type);
-#elif defined DUTILS_ARCH_SSE41
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_sse41(dst_type, src_type);
-#elif
-    auto func = img_filter::transform::by_edge::get_transform_by8_to_dst_c(dst_type, src_type);
-#endif
-    return [func](const img::img_descriptor& dst, const img::img_descriptor& src)
+    auto wb_func = find_transform_function_wb_only_type(dst_type, src_type, selected);
+
+    auto lut_func = select_kernel(tone_curve_variants, selected, dst_type, src_type);
+    if (!wb_func || !lut_func)
     {
-        static const img_filter::transform::by_edge::options opt = { {}, false, false };
+        return wb_func;
+    }
 
-        func(dst, src, opt);
+    return [wb_func, lut_func](const img::img_descriptor& dst,
+                               const img::img_descriptor& src,
+                               img_filter::filter_params& params)
+    {
+        if (params.fccXX_to_fcc8_lut)
+        {
+            lut_func(dst, src, params);
+        }
+        else
+        {
+            wb_func(dst, src, params);
+        }
     };
 }
 
-enum class transform_context_mode
+// opt is read for every call, so set_color_matrix takes effect without a new setup
+static auto find_bayer8_to_bgra_func(const img::img_type& dst_type,
+                                     const img::img_type& src_type,
+                                     const img_filter::transform::by_edge::options* opt,
+                                     std::string& selected) -> tcamconvert::transform_binary_func
 {
-    unary_mono,
-    unary_bayer,
-    binary_mono,
-    binary_bayer,
-    binary_rgb,
-};
+    auto func = select_kernel(by8_to_dst_variants, selected, dst_type, src_type);
+    if (!func)
+    {
+        return nullptr;
+    }
 
-static auto get_transform_context_mode(img::img_type src_type, img::img_type dst_type)
-    -> transform_context_mode
+    return [func, opt](const img::img_descriptor& dst, const img::img_descriptor& src)
+    { func(dst, src, *opt); };
+}
+
+static auto find_bayer8_to_yuv_func(const img::img_type& dst_type,
+                                    const img::img_type& src_type,
+                                    const img_filter::transform::by_edge::yuv_colorimetry& colorimetry,
+                                    const img_filter::transform::by_edge::options* by8_opt,
+                                    std::string& selected) -> tcamconvert::transform_binary_func
 {
-    enum class color_mode
+    img_filter::transform::by_edge::yuv_options opt;
+    opt.colorimetry = colorimetry;
+    opt.by8_to_bgra = select_kernel(by8_to_dst_variants,
+                                    selected,
+                                    img::make_img_type(img::fourcc::BGRA32, dst_type.dim),
+                                    src_type);
+    if (!opt.by8_to_bgra)
     {
-        bayer,
-        mono
-    };
-    auto clr_mode = img::is_mono_fcc(src_type.fourcc_type()) ? color_mode::mono : color_mode::bayer;
+        return nullptr;
+    }
 
-    if (src_type.fourcc_type() == dst_type.fourcc_type())
+    auto func = select_kernel(by8_to_yuv_variants, selected, dst_type, src_type);
+    if (!func)
     {
-        if (clr_mode == color_mode::mono)
-        {
-            return transform_context_mode::unary_mono;
-        }
-        return transform_context_mode::unary_bayer;
+        return nullptr;
     }
 
-    if (dst_type.fourcc_type() == img::fourcc::BGRA32)
+    return [func, opt, by8_opt](const img::img_descriptor& dst, const img::img_descriptor& src)
     {
-        return transform_context_mode::binary_rgb;
+        auto cur_opt = opt;
+        cur_opt.by8_opt = *by8_opt;
+        func(dst, src, cur_opt);
+    };
+}
+
+// bayerXX/pwl -> float bayer with white balance
+static auto find_transform_fccfloat_wb_func(img::img_type dst_type,
+                                            img::img_type src_type,
+                                            std::string& selected)
+    -> tcamconvert::transform_binary_wb_func
+{
+    if (!img::is_pwl_fcc(src_type.fourcc_type()))
+    {
+        // an empty function when no variant fits
+        return select_kernel(fccXX_to_fccfloat_wb_variants, selected, dst_type, src_type);
     }
 
-    if (clr_mode == color_mode::mono)
+    auto pwl_func = select_kernel(pwl_to_fccfloat_variants, selected, dst_type, src_type);
+    auto wb_func = find_transform_unary_wb_func(dst_type, selected);
+    if (!pwl_func || !wb_func)
     {
-        return transform_context_mode::binary_mono;
+        return nullptr;
     }
-    return transform_context_mode::binary_bayer;
+
+    return [pwl_func, wb_func](const img::img_descriptor& dst,
+                               const img::img_descriptor& src,
+                               img_filter::filter_params& params)
+    {
+        pwl_func(dst, src);
+        // the float white balance does not check the apply flag
+        wb_func(dst, img_filter::normalize(params.whitebalance));
+    };
 }
 
-bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type dst_type)
+static auto find_byfloat_to_yuv_planar_func(
+    const img::img_type& dst_type,
+    const img::img_type& src_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& colorimetry,
+    std::string& selected) -> tcamconvert::transform_binary_func
 {
-    transform_unary_wb_func_ = nullptr;
-    transfrom_binary_mono_func_ = nullptr;
-    transform_fccXX_to_dst_func_ = nullptr;
-
-    transform_intermediate_buffer_ = {};
+    img_filter::transform::by_edge::yuv_options opt;
+    opt.colorimetry = colorimetry;
+    opt.byfloat_to_bgrfloat = select_kernel(byfloat_to_bgrfloat_variants,
+                                            selected,
+                                            img::make_img_type(img::fourcc::BGRFloat, dst_type.dim),
+                                            src_type);
+    if (!opt.byfloat_to_bgrfloat)
+    {
+        return nullptr;
+    }
 
-    switch (get_transform_context_mode(src_type, dst_type))
+    auto func = select_kernel(byfloat_to_yuv_planar_variants, selected, dst_type, src_type);
+    if (!func)
     {
-        case transform_context_mode::unary_mono:
-            break;
-        case transform_context_mode::unary_bayer:
-        {
-            transform_unary_wb_func_ = find_transform_unary_wb_func(dst_type);
-            assert(transform_unary_wb_func_ != nullptr);
+        return nullptr;
+    }
 
-            return transform_unary_wb_func_ != nullptr;
-        }
-        case transform_context_mode::binary_mono:
-        {
-            transfrom_binary_mono_func_ = find_transform_function_type(dst_type, src_type);
-            assert(transfrom_binary_mono_func_ != nullptr);
+    return [func, opt](const img::img_descriptor& dst, const img::img_descriptor& src)
+    { func(dst, src, opt); };
+}
+
+/*
+ * Defect pixel and flat field correction of unpacked bayer lines, src_lines are the lines of the
+ * source frame they were unpacked from.
+ */
+static void apply_bayer_corrections(const img::img_descriptor& unpacked,
+                                    const img::img_descriptor& src_lines,
+                                    const img_filter::filter_params& params) noexcept
+{
+    if (!params.frame)
+    {
+        return;
+    }
+    const auto pos = params.frame->locate(src_lines);
+    if (params.defect_pixels)
+    {
+        img_filter::defect_pixel::correct(unpacked, pos, *params.defect_pixels);
+    }
+    if (params.flat_field)
+    {
+        img_filter::flat_field::apply(unpacked, pos, *params.flat_field);
+    }
+}
+
+// lines per tile in transform_byXX_to_bgra_tiled
+// 4096 pixel wide bayer8 tiles (+ neighbour lines) stay within L2
+static const constexpr int fused_tile_lines = 32;
+
+/*
+ * bayerXX -> bayer8 (+ white balance) -> BGRA32/yuv over a strip, fused per tile of fused_tile_lines lines.
+ * The bayer8 lines of a tile, including the neighbour lines needed for debayering, are only kept in
+ * a small per thread buffer, so the intermediate image is never streamed through main memory.
+ * The planar yuv path passes a float bayer fcc as by8_fcc, the BGRA64 path a bayer16 fcc.
+ */
+static void transform_byXX_to_bgra_tiled(const img::img_descriptor& dst,
+                                         const img::img_descriptor& src,
+                                         img::fourcc by8_fcc,
+                                         const tcamconvert::transform_binary_wb_func& unpack_wb_func,
+                                         const tcamconvert::transform_binary_func& debayer_func,
+                                         img_filter::filter_params& params)
+{
+    // workers and the streaming thread each keep their tile buffer
+    thread_local std::vector<uint8_t> tile_buffer;
+
+    const auto max_tile_type = img::make_img_type(by8_fcc, { src.dim.cx, fused_tile_lines + 4 });
+    if (max_tile_type.buffer_length <= 0)
+    {
+        return;
+    }
+    if (tile_buffer.size() < static_cast<size_t>(max_tile_type.buffer_length))
+    {
+        tile_buffer.resize(max_tile_type.buffer_length);
+    }
+
+    // the BGRA32/BGR24/BGRA64 debayer kernels flip dst, do that once for the strip
+    auto dst_full = dst;
+    if (img::is_bottom_up_fcc(dst.fourcc_type()))
+    {
+        dst_full = img::flip_image_in_img_desc_if_allowed(dst);
+        dst_full.flags |= img::img_descriptor::flags_no_flip;
+    }
+
+    // inner strips may read the lines of their neighbour strips
+    const bool has_line_above = src.flags & img::img_descriptor::flags_no_wrap_beg;
+    const bool has_line_below = src.flags & img::img_descriptor::flags_no_wrap_end;
+
+    const int height = src.dim.cy;
+    int y_begin = 0;
+    while (y_begin < height)
+    {
+        int y_end = std::min(y_begin + fused_tile_lines, height);
+        if (height - y_end < 2)
+        {
+            // no single line tiles at the bottom
+            y_end = height;
+        }
+
+        const bool first = y_begin == 0 && !has_line_above;
+        const bool last = y_end == height && !has_line_below;
+
+        // start on an even line, so the white balance sees the bayer pattern of by8_fcc
+        const int src_begin = first ? y_begin : y_begin - 2;
+        const int src_end = last ? y_end : y_end + 1;
+
+        auto by8_type = img::make_img_type(by8_fcc, { src.dim.cx, src_end - src_begin });
+        auto by8_lines = img::make_img_desc_from_linear_memory(by8_type, tile_buffer.data());
+
+        const auto src_lines = tcamconvert::make_strip(src, src_begin, src_end, true, true);
+        unpack_wb_func(by8_lines, src_lines, params);
+        apply_bayer_corrections(by8_lines, src_lines, params);
+
+        auto by8_tile = tcamconvert::make_strip(
+            by8_lines, y_begin - src_begin, y_end - src_begin, first, last);
+
+        debayer_func(tcamconvert::make_strip(dst_full, y_begin, y_end, true, true), by8_tile);
+
+        y_begin = y_end;
+    }
+}
+
+/*
+ * bayerXX -> bayer8 (+ white balance) -> binned bayer8 over a strip, per tile of fused_tile_lines src lines.
+ * Only the binned lines leave the per thread tile buffer.
+ * The tensor path passes a float bayer fcc as by8_fcc.
+ * src strips start on multiples of 2 * factor lines and have a multiple of 2 * factor lines.
+ */
+static void transform_byXX_binned_tiled(const img::img_descriptor& dst,
+                                        const img::img_descriptor& src,
+                                        img::fourcc by8_fcc,
+                                        int factor,
+                                        const tcamconvert::transform_binary_wb_func& unpack_wb_func,
+                                        const tcamconvert::transform_binary_func& bin_func,
+                                        img_filter::filter_params& params)
+{
+    thread_local std::vector<uint8_t> tile_buffer;
+
+    const auto max_tile_type = img::make_img_type(by8_fcc, { src.dim.cx, fused_tile_lines });
+    if (tile_buffer.size() < static_cast<size_t>(max_tile_type.buffer_length))
+    {
+        tile_buffer.resize(max_tile_type.buffer_length);
+    }
+
+    // fused_tile_lines is a multiple of 2 * factor, so all tiles keep the bayer pattern
+    for (int y_begin = 0; y_begin < src.dim.cy; y_begin += fused_tile_lines)
+    {
+        const int y_end = std::min(y_begin + fused_tile_lines, src.dim.cy);
+
+        auto by8_type = img::make_img_type(by8_fcc, { src.dim.cx, y_end - y_begin });
+        auto by8_lines = img::make_img_desc_from_linear_memory(by8_type, tile_buffer.data());
+
+        const auto src_lines = tcamconvert::make_strip(src, y_begin, y_end, true, true);
+        unpack_wb_func(by8_lines, src_lines, params);
+        apply_bayer_corrections(by8_lines, src_lines, params);
+
+        bin_func(tcamconvert::make_strip(dst, y_begin / factor, y_end / factor, true, true),
+                 by8_lines);
+    }
+}
+
+enum class transform_context_mode
+{
+    binned,
+    tensor,
+    unary_mono,
+    unary_bayer,
+    binary_mono,
+    binary_bayer,
+    binary_rgb,
+    binary_rgb64,
+    binary_yuv,
+    binary_yuv_planar,
+    polarization,
+};
+
+static auto get_transform_context_mode(img::img_type src_type, img::img_type dst_type)
+    -> transform_context_mode
+{
+    enum class color_mode
+    {
+        bayer,
+        mono
+    };
+    auto clr_mode = img::is_mono_fcc(src_type.fourcc_type()) ? color_mode::mono : color_mode::bayer;
+
+    if (img::is_polarization_cam_format(src_type.fourcc_type()))
+    {
+        return transform_context_mode::polarization;
+    }
+
+    if (img_filter::transform::tensor::is_tensor_fcc(dst_type.fourcc_type()))
+    {
+        return transform_context_mode::tensor;
+    }
+
+    if (src_type.dim != dst_type.dim)
+    {
+        return transform_context_mode::binned;
+    }
+
+    if (src_type.fourcc_type() == dst_type.fourcc_type())
+    {
+        if (clr_mode == color_mode::mono)
+        {
+            return transform_context_mode::unary_mono;
+        }
+        return transform_context_mode::unary_bayer;
+    }
+
+    if (dst_type.fourcc_type() == img::fourcc::BGRA32
+        || dst_type.fourcc_type() == img::fourcc::BGR24)
+    {
+        return transform_context_mode::binary_rgb;
+    }
+    if (dst_type.fourcc_type() == img::fourcc::BGRA64)
+    {
+        return transform_context_mode::binary_rgb64;
+    }
+    if (is_yuv_planar_float_path_fcc(dst_type.fourcc_type()))
+    {
+        return transform_context_mode::binary_yuv_planar;
+    }
+    if (img::is_yuv_format(dst_type.fourcc_type()))
+    {
+        return transform_context_mode::binary_yuv;
+    }
+
+    if (clr_mode == color_mode::mono)
+    {
+        return transform_context_mode::binary_mono;
+    }
+    return transform_context_mode::binary_bayer;
+}
+
+bool tcamconvert::transform_context::setup(
+    img::img_type src_type,
+    img::img_type dst_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    transform_unary_wb_func_ = nullptr;
+    transfrom_binary_mono_func_ = nullptr;
+    transform_fccXX_to_dst_func_ = nullptr;
+
+    transform_intermediate_buffer_ = {};
+    kernel_description_.clear();
+
+    mono_tone_curve_func_ = nullptr;
+    tone_curve_supported_ = transform_fccXX_lut_internal::get_src_layout(src_type.fourcc_type())
+                            != transform_fccXX_lut_internal::src_layout::invalid;
+
+    pwl_wb_map_.reset();
+    if (img::is_pwl_fcc(src_type.fourcc_type()))
+    {
+        pwl_wb_map_ = std::make_unique<img_filter::pwl12_to_fcc8_wb_map_data>();
+    }
+
+    use_streaming_copy_ =
+        static_cast<size_t>(src_type.buffer_length) >= img::get_last_level_cache_size();
+
+    const auto mode = get_transform_context_mode(src_type, dst_type);
+    unary_ = mode == transform_context_mode::unary_mono || mode == transform_context_mode::unary_bayer;
+
+    switch (mode)
+    {
+        case transform_context_mode::binned:
+            return setup_binned(src_type, dst_type, yuv_colorimetry);
+        case transform_context_mode::tensor:
+            return setup_tensor(src_type, dst_type);
+        case transform_context_mode::unary_mono:
+            kernel_description_ = use_streaming_copy_ ? "memcpy_streaming" : "memcpy";
+            break;
+        case transform_context_mode::unary_bayer:
+        {
+            transform_unary_wb_func_ = find_transform_unary_wb_func(dst_type, kernel_description_);
+            assert(transform_unary_wb_func_ != nullptr);
+
+            return transform_unary_wb_func_ != nullptr;
+        }
+        case transform_context_mode::binary_mono:
+        {
+            transfrom_binary_mono_func_ =
+                find_transform_function_type(dst_type, src_type, kernel_description_);
+            assert(transfrom_binary_mono_func_ != nullptr);
+
+            if (auto lut_func = select_kernel(
+                    tone_curve_variants, kernel_description_, dst_type, src_type);
+                lut_func)
+            {
+                mono_tone_curve_func_ = lut_func;
+            }
 
             return transfrom_binary_mono_func_ != nullptr;
         }
         case transform_context_mode::binary_bayer:
         {
-            transform_fccXX_to_dst_func_ = find_transform_function_wb_type(dst_type, src_type);
-            assert(transform_fccXX_to_dst_func_ != nullptr);
+            auto transform_func =
+                find_transform_function_wb_type(dst_type, src_type, kernel_description_);
+            assert(transform_func != nullptr);
+            if (!transform_func)
+            {
+                return false;
+            }
+
+            transform_fccXX_to_dst_func_ = [transform_func, this](const img::img_descriptor& dst,
+                                                                  const img::img_descriptor& src,
+                                                                  img_filter::filter_params& params)
+            {
+                executor_.run(dst,
+                              src,
+                              [&transform_func, params](const img::img_descriptor& d,
+                                                        const img::img_descriptor& s)
+                              {
+                                  auto strip_params = params;
+                                  transform_func(d, s, strip_params);
+                                  apply_bayer_corrections(d, s, params);
+                              });
+            };
+            return true;
+        }
+        case transform_context_mode::polarization:
+        {
+            // the 2x2 polarizer blocks are evaluated within a strip, strips start on even lines
+            auto polarization_func =
+                select_kernel(polarization_variants, kernel_description_, dst_type, src_type);
+            if (!polarization_func)
+            {
+                return false;
+            }
+
+            transform_fccXX_to_dst_func_ = [polarization_func, this](const img::img_descriptor& dst,
+                                                                     const img::img_descriptor& src,
+                                                                     img_filter::filter_params& /*params*/)
+            {
+                executor_.run(dst, src, polarization_func);
+            };
+            return true;
+        }
+        case transform_context_mode::binary_yuv:
+        {
+            if (!img::is_bayer_fcc(src_type.fourcc_type()) && !img::is_pwl_fcc(src_type.fourcc_type()))
+            {
+                return false;
+            }
+
+            if (img::is_by8_fcc(src_type.fourcc_type())) // Bayer8 -> yuv
+            {
+                auto wb_func = find_transform_unary_wb_func(src_type, kernel_description_);
+                assert(wb_func != nullptr);
+
+                auto transform_by8_to_yuv_func = find_bayer8_to_yuv_func(
+                    dst_type, src_type, yuv_colorimetry, &debayer_opt_, kernel_description_);
+                if (!transform_by8_to_yuv_func)
+                {
+                    return false;
+                }
+
+                transform_fccXX_to_dst_func_ =
+                    [transform_by8_to_yuv_func, wb_func, this](const img::img_descriptor& dst,
+                                                               const img::img_descriptor& src,
+                                                               img_filter::filter_params& params)
+                {
+                    executor_.run(src,
+                                  [wb_func, &params](const img::img_descriptor& strip)
+                                  { wb_func(strip, params.whitebalance); });
+                    executor_.run(dst, src, transform_by8_to_yuv_func);
+                };
+                return true;
+            }
+
+            // bayerXX -> yuv, done via bayerXX -> bayer8 -> yuv in tiles
+            const auto by8_fcc =
+                img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type());
+            auto transform_intermediate_type = img::make_img_type(by8_fcc, src_type.dim);
+
+            auto transform_byXX_to_byYY_func = find_transform_function_wb_type(
+                transform_intermediate_type, src_type, kernel_description_);
+            assert(transform_byXX_to_byYY_func != nullptr);
+
+            auto transform_by8_to_yuv_func = find_bayer8_to_yuv_func(dst_type,
+                                                                     transform_intermediate_type,
+                                                                     yuv_colorimetry,
+                                                                     &debayer_opt_,
+                                                                     kernel_description_);
+            if (!transform_by8_to_yuv_func)
+            {
+                return false;
+            }
+
+            transform_fccXX_to_dst_func_ = [transform_by8_to_yuv_func,
+                                            transform_byXX_to_byYY_func,
+                                            by8_fcc,
+                                            this](const img::img_descriptor& dst,
+                                                  const img::img_descriptor& src,
+                                                  img_filter::filter_params& params)
+            {
+                executor_.run(dst,
+                              src,
+                              [&, params](const img::img_descriptor& d, const img::img_descriptor& s)
+                              {
+                                  auto strip_params = params;
+                                  transform_byXX_to_bgra_tiled(d,
+                                                               s,
+                                                               by8_fcc,
+                                                               transform_byXX_to_byYY_func,
+                                                               transform_by8_to_yuv_func,
+                                                               strip_params);
+                              });
+            };
+            return true;
+        }
+        case transform_context_mode::binary_rgb64:
+        {
+            // bayerXX -> bayer16 (+ white balance) -> BGRA64 in tiles,
+            // without the reduction to 8 bit
+            const auto src_fcc = src_type.fourcc_type();
+            if (!img::is_bayer_fcc(src_fcc) || img::is_by8_fcc(src_fcc))
+            {
+                return false;
+            }
+
+            // the tone curve tables only exist for the 8 bit output
+            tone_curve_supported_ = false;
+
+            const auto by16_fcc = img::by_transform::convert_bayer_fcc_to_bayer16_fcc(src_fcc);
+            const auto by16_type = img::make_img_type(by16_fcc, src_type.dim);
+
+            // bayer16 is only copied into the tiles
+            img_filter::transform_function_type unpack_func = nullptr;
+            if (by16_fcc != src_fcc)
+            {
+                unpack_func = find_transform_function_type(by16_type, src_type, kernel_description_);
+                if (!unpack_func)
+                {
+                    return false;
+                }
+            }
+            auto wb_func = find_transform_unary_wb_func(by16_type, kernel_description_);
+            if (!wb_func)
+            {
+                return false;
+            }
+
+            tcamconvert::transform_binary_wb_func unpack_wb_func =
+                [unpack_func, wb_func](const img::img_descriptor& dst,
+                                       const img::img_descriptor& src,
+                                       img_filter::filter_params& params)
+            {
+                if (unpack_func)
+                {
+                    unpack_func(dst, src);
+                }
+                else
+                {
+                    img::memcpy_image(dst, src);
+                }
+                wb_func(dst, params.whitebalance);
+            };
+
+            auto debayer_func = select_kernel(
+                by16_to_bgra64_variants, kernel_description_, dst_type, by16_type);
+            if (!debayer_func)
+            {
+                return false;
+            }
+            tcamconvert::transform_binary_func transform_by16_to_bgra64_func =
+                [debayer_func, this](const img::img_descriptor& dst, const img::img_descriptor& src)
+            { debayer_func(dst, src, debayer_opt_); };
+
+            transform_fccXX_to_dst_func_ =
+                [unpack_wb_func, transform_by16_to_bgra64_func, by16_fcc, this](
+                    const img::img_descriptor& dst,
+                    const img::img_descriptor& src,
+                    img_filter::filter_params& params)
+            {
+                executor_.run(dst,
+                              src,
+                              [&, params](const img::img_descriptor& d, const img::img_descriptor& s)
+                              {
+                                  auto strip_params = params;
+                                  transform_byXX_to_bgra_tiled(d,
+                                                               s,
+                                                               by16_fcc,
+                                                               unpack_wb_func,
+                                                               transform_by16_to_bgra64_func,
+                                                               strip_params);
+                              },
+                              true);
+            };
+            return true;
+        }
+        case transform_context_mode::binary_yuv_planar:
+        {
+            // bayerXX/pwl -> float bayer (+ white balance) -> BGRFloat -> yuv in tiles,
+            // without the reduction to 8 bit
+            if (img::is_by8_fcc(src_type.fourcc_type()))
+            {
+                return false;
+            }
+
+            // the tone curve tables only exist for the 8 bit output
+            tone_curve_supported_ = false;
+
+            const auto src_fcc = src_type.fourcc_type();
+            const auto float_fcc = img::is_pwl_fcc(src_fcc)
+                                       ? img::by_transform::convert_pwl_to_fcc32f(src_fcc)
+                                       : img_filter::transform::convert_fccXX_to_fccfloat(src_fcc);
+            const auto float_type = img::make_img_type(float_fcc, src_type.dim);
+
+            auto unpack_wb_func =
+                find_transform_fccfloat_wb_func(float_type, src_type, kernel_description_);
+            auto transform_to_yuv_func = find_byfloat_to_yuv_planar_func(
+                dst_type, float_type, yuv_colorimetry, kernel_description_);
+            if (!unpack_wb_func || !transform_to_yuv_func)
+            {
+                return false;
+            }
 
-            return transform_fccXX_to_dst_func_ != nullptr;
+            transform_fccXX_to_dst_func_ = [unpack_wb_func, transform_to_yuv_func, float_fcc, this](
+                                               const img::img_descriptor& dst,
+                                               const img::img_descriptor& src,
+                                               img_filter::filter_params& params)
+            {
+                executor_.run(dst,
+                              src,
+                              [&, params](const img::img_descriptor& d, const img::img_descriptor& s)
+                              {
+                                  auto strip_params = params;
+                                  transform_byXX_to_bgra_tiled(d,
+                                                               s,
+                                                               float_fcc,
+                                                               unpack_wb_func,
+                                                               transform_to_yuv_func,
+                                                               strip_params);
+                              });
+            };
+            return true;
         }
         case transform_context_mode::binary_rgb:
         {
-            if (src_type.fourcc_type() == fourcc::MONO8) // MONO8 to BGRA32
+            if (src_type.fourcc_type() == fourcc::MONO8) // MONO8 to BGRA32/BGR24
             {
-                auto transform_to_bgra_func = find_transform_mono_to_bgr_func(dst_type, src_type);
+                auto transform_to_bgra_func =
+                    find_transform_mono_to_bgr_func(dst_type, src_type, kernel_description_);
                 assert(transform_to_bgra_func != nullptr);
 
                 transform_fccXX_to_dst_func_ =
-                    [transform_to_bgra_func](const img::img_descriptor& dst,
-                                             const img::img_descriptor& src,
-                                             img_filter::filter_params& /*params*/)
+                    [transform_to_bgra_func, this](const img::img_descriptor& dst,
+                                                   const img::img_descriptor& src,
+                                                   img_filter::filter_params& /*params*/)
                 {
                     assert(src.fourcc_type() == img::fourcc::MONO8);
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    assert(img::is_bottom_up_fcc(dst.fourcc_type()));
 
-                    transform_to_bgra_func(dst, src);
+                    executor_.run(dst, src, transform_to_bgra_func, true);
                 };
                 return transform_fccXX_to_dst_func_ != nullptr;
             }
             else if (
                 img::is_mono_fcc(
-                    src_type.fourcc_type())) // MONOXX to BGRA32, done via MONOXX -> MONO8 -> BGRA32
+                    src_type.fourcc_type())) // MONOXX to BGRA32/BGR24, done via MONO8
             {
                 auto transform_intermediate_type =
                     img::make_img_type(img::fourcc::MONO8, src_type.dim);
@@ -420,82 +1320,122 @@ bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type
                 transform_intermediate_buffer_.resize(transform_intermediate_type.buffer_length);
 
                 auto transfrom_to_mono8 =
-                    find_transform_function_type(transform_intermediate_type, src_type);
+                    find_transform_function_type(
+                        transform_intermediate_type, src_type, kernel_description_);
                 assert(transfrom_to_mono8 != nullptr);
 
+                auto to_mono8_lut_func = select_kernel(
+                    tone_curve_variants, kernel_description_, transform_intermediate_type, src_type);
+
                 auto transform_to_bgra_func =
-                    find_transform_mono_to_bgr_func(dst_type, transform_intermediate_type);
+                    find_transform_mono_to_bgr_func(
+                        dst_type, transform_intermediate_type, kernel_description_);
                 assert(transform_to_bgra_func != nullptr);
 
-                transform_fccXX_to_dst_func_ =
-                    [transform_intermediate_type, transfrom_to_mono8, transform_to_bgra_func, this](
-                        const img::img_descriptor& dst,
-                        const img::img_descriptor& src,
-                        img_filter::filter_params& /*params*/)
+                transform_fccXX_to_dst_func_ = [transfrom_to_mono8,
+                                                to_mono8_lut_func,
+                                                transform_to_bgra_func,
+                                                this](const img::img_descriptor& dst,
+                                                      const img::img_descriptor& src,
+                                                      img_filter::filter_params& params)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    assert(img::is_bottom_up_fcc(dst.fourcc_type()));
 
-                    auto mono8_img_desc = img::make_img_desc_from_linear_memory(
-                        transform_intermediate_type, transform_intermediate_buffer_.data());
+                    // src is smaller than the setup dim for ROIs, see transform_rois
+                    const auto mono8_type = img::make_img_type(img::fourcc::MONO8, src.dim);
+                    assert(transform_intermediate_buffer_.size()
+                           >= static_cast<size_t>(mono8_type.buffer_length));
 
-                    transfrom_to_mono8(mono8_img_desc, src);
-
-                    transform_to_bgra_func(dst, mono8_img_desc);
+                    auto mono8_img_desc = img::make_img_desc_from_linear_memory(
+                        mono8_type, transform_intermediate_buffer_.data());
+
+                    if (params.fccXX_to_fcc8_lut && to_mono8_lut_func)
+                    {
+                        executor_.run(mono8_img_desc,
+                                      src,
+                                      [to_mono8_lut_func, params](const img::img_descriptor& d,
+                                                                  const img::img_descriptor& s)
+                                      {
+                                          auto strip_params = params;
+                                          to_mono8_lut_func(d, s, strip_params);
+                                      });
+                    }
+                    else
+                    {
+                        executor_.run(mono8_img_desc, src, transfrom_to_mono8);
+                    }
+
+                    executor_.run(dst, mono8_img_desc, transform_to_bgra_func, true);
                 };
                 return transform_fccXX_to_dst_func_ != nullptr;
             }
-            else if (img::is_by8_fcc(src_type.fourcc_type())) // Bayer8 -> BGRA32
+            else if (img::is_by8_fcc(src_type.fourcc_type())) // Bayer8 -> BGRA32/BGR24
             {
                 auto wb_func =
-                    find_transform_unary_wb_func(src_type); // whitebalance on src image func
+                    find_transform_unary_wb_func(src_type, kernel_description_); // whitebalance on src image func
                 assert(wb_func != nullptr);
 
-                auto transform_by8_to_bgra_func = find_bayer8_to_bgra_func(dst_type, src_type);
+                auto transform_by8_to_bgra_func =
+                    find_bayer8_to_bgra_func(
+                        dst_type, src_type, &debayer_opt_, kernel_description_);
                 assert(transform_by8_to_bgra_func != nullptr);
 
                 transform_fccXX_to_dst_func_ =
-                    [transform_by8_to_bgra_func, wb_func](const img::img_descriptor& dst,
-                                                          const img::img_descriptor& src,
-                                                          img_filter::filter_params& params)
+                    [transform_by8_to_bgra_func, wb_func, this](const img::img_descriptor& dst,
+                                                                const img::img_descriptor& src,
+                                                                img_filter::filter_params& params)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
+                    assert(img::is_bottom_up_fcc(dst.fourcc_type()));
 
-                    wb_func(src, params.whitebalance);
-                    transform_by8_to_bgra_func(dst, src);
+                    // all strips have to be balanced before debayering reads neighbour lines
+                    executor_.run(src,
+                                  [wb_func, &params](const img::img_descriptor& strip)
+                                  { wb_func(strip, params.whitebalance); });
+                    executor_.run(dst, src, transform_by8_to_bgra_func, true);
                 };
                 return transform_fccXX_to_dst_func_ != nullptr;
             }
-            else if (!img::is_by8_fcc(src_type.fourcc_type())) // bayerXX -> BGRA32, done via bayerXX -> bayer8 -> BGRA32
+            else if (!img::is_by8_fcc(src_type.fourcc_type())) // bayerXX -> BGRA32/BGR24, done via bayer8
             {
-                auto transform_intermediate_type = img::make_img_type(
-                    img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type()),
-                    src_type.dim);
-
-                transform_intermediate_buffer_.resize(transform_intermediate_type.buffer_length);
+                const auto by8_fcc =
+                    img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type());
+                auto transform_intermediate_type = img::make_img_type(by8_fcc, src_type.dim);
 
                 auto transform_byXX_to_byYY_func =
-                    find_transform_function_wb_type(transform_intermediate_type, src_type);
+                    find_transform_function_wb_type(
+                        transform_intermediate_type, src_type, kernel_description_);
                 assert(transform_byXX_to_byYY_func != nullptr);
                 auto transform_by8_to_bgra_func =
-                    find_bayer8_to_bgra_func(dst_type, transform_intermediate_type);
+                    find_bayer8_to_bgra_func(dst_type,
+                                             transform_intermediate_type,
+                                             &debayer_opt_,
+                                             kernel_description_);
                 assert(transform_by8_to_bgra_func != nullptr);
 
 
                 transform_fccXX_to_dst_func_ = [transform_by8_to_bgra_func,
                                                 transform_byXX_to_byYY_func,
-                                                transform_intermediate_type,
+                                                by8_fcc,
                                                 this](const img::img_descriptor& dst,
                                                       const img::img_descriptor& src,
                                                       img_filter::filter_params& params)
                 {
-                    assert(dst.fourcc_type() == img::fourcc::BGRA32);
-
-                    auto by8_img_desc = img::make_img_desc_from_linear_memory(
-                        transform_intermediate_type, transform_intermediate_buffer_.data());
-
-                    transform_byXX_to_byYY_func(by8_img_desc, src, params);
-
-                    transform_by8_to_bgra_func(dst, by8_img_desc);
+                    assert(img::is_bottom_up_fcc(dst.fourcc_type()));
+
+                    executor_.run(dst,
+                                  src,
+                                  [&, params](const img::img_descriptor& d,
+                                              const img::img_descriptor& s)
+                                  {
+                                      auto strip_params = params;
+                                      transform_byXX_to_bgra_tiled(d,
+                                                                   s,
+                                                                   by8_fcc,
+                                                                   transform_byXX_to_byYY_func,
+                                                                   transform_by8_to_bgra_func,
+                                                                   strip_params);
+                                  },
+                                  true);
                 };
 
                 return transform_fccXX_to_dst_func_ != nullptr;
@@ -505,47 +1445,470 @@ bool tcamconvert::transform_context::setup(img::img_type src_type, img::img_type
     return true;
 }
 
+bool tcamconvert::transform_context::setup_binned(
+    img::img_type src_type,
+    img::img_type dst_type,
+    const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry)
+{
+    const int factor = img_filter::transform::bayer_binning::get_binning_factor(dst_type.dim, src_type.dim);
+    if (factor == 0 || !tcamconvert_can_bin(src_type.fourcc_type(), dst_type.fourcc_type()))
+    {
+        return false;
+    }
+
+    const auto by8_fcc = img::by_transform::convert_bayer_fcc_to_bayer8_fcc(src_type.fourcc_type());
+    const auto binned_type = img::make_img_type(by8_fcc, dst_type.dim);
+
+    // src -> white balanced, binned bayer8
+    transform_binary_wb_func bin_wb_func;
+    if (img::is_by8_fcc(src_type.fourcc_type()))
+    {
+        auto bin_func = select_kernel(binning_variants, kernel_description_, binned_type, src_type);
+        // balancing the binned image touches a fraction of the pixels
+        auto wb_func = find_transform_unary_wb_func(binned_type, kernel_description_);
+        if (!bin_func || !wb_func)
+        {
+            return false;
+        }
+
+        bin_wb_func = [bin_func, wb_func](const img::img_descriptor& dst,
+                                          const img::img_descriptor& src,
+                                          img_filter::filter_params& params)
+        {
+            bin_func(dst, src);
+            wb_func(dst, params.whitebalance);
+        };
+    }
+    else
+    {
+        const auto by8_src_type = img::make_img_type(by8_fcc, src_type.dim);
+
+        auto unpack_wb_func =
+            find_transform_function_wb_type(by8_src_type, src_type, kernel_description_);
+        auto bin_func =
+            select_kernel(binning_variants, kernel_description_, binned_type, by8_src_type);
+        if (!unpack_wb_func || !bin_func)
+        {
+            return false;
+        }
+
+        bin_wb_func = [unpack_wb_func, bin_func, by8_fcc, factor](const img::img_descriptor& dst,
+                                                                 const img::img_descriptor& src,
+                                                                 img_filter::filter_params& params)
+        {
+            transform_byXX_binned_tiled(dst, src, by8_fcc, factor, unpack_wb_func, bin_func, params);
+        };
+    }
+
+    // binned bayer8 -> dst, not needed for bayer8 dst
+    transform_binary_func debayer_func;
+    const bool debayer_flips_dst = img::is_bottom_up_fcc(dst_type.fourcc_type());
+    if (debayer_flips_dst)
+    {
+        debayer_func =
+            find_bayer8_to_bgra_func(dst_type, binned_type, &debayer_opt_, kernel_description_);
+    }
+    else if (img::is_yuv_format(dst_type.fourcc_type()))
+    {
+        debayer_func =
+            find_bayer8_to_yuv_func(
+                dst_type, binned_type, yuv_colorimetry, &debayer_opt_, kernel_description_);
+    }
+    if (dst_type.fourcc_type() != by8_fcc && !debayer_func)
+    {
+        return false;
+    }
+
+    if (debayer_func)
+    {
+        transform_intermediate_buffer_.resize(binned_type.buffer_length);
+    }
+
+    transform_fccXX_to_dst_func_ =
+        [bin_wb_func, debayer_func, debayer_flips_dst, binned_type, this](
+            const img::img_descriptor& dst,
+            const img::img_descriptor& src,
+            img_filter::filter_params& params)
+    {
+        auto binned = dst;
+        if (debayer_func)
+        {
+            binned = img::make_img_desc_from_linear_memory(binned_type,
+                                                           transform_intermediate_buffer_.data());
+        }
+
+        executor_.run(binned,
+                      src,
+                      [&bin_wb_func, params](const img::img_descriptor& d, const img::img_descriptor& s)
+                      {
+                          auto strip_params = params;
+                          bin_wb_func(d, s, strip_params);
+                      });
+
+        if (debayer_func)
+        {
+            // debayering reads the neighbour lines of the strips, so all of binned has to be done
+            executor_.run(dst, binned, debayer_func, debayer_flips_dst);
+        }
+    };
+    return true;
+}
+
+bool tcamconvert::transform_context::setup_tensor(img::img_type src_type, img::img_type dst_type)
+{
+    // bayerXX/pwl -> float bayer (+ white balance) -> binned or debayered, normalized planes in tiles
+    const auto src_fcc = src_type.fourcc_type();
+    if (img::is_by8_fcc(src_fcc) || (!img::is_bayer_fcc(src_fcc) && !img::is_pwl_fcc(src_fcc)))
+    {
+        return false;
+    }
+
+    int factor = 1;
+    if (src_type.dim != dst_type.dim)
+    {
+        factor = img_filter::transform::bayer_binning::get_binning_factor(dst_type.dim, src_type.dim);
+        if (factor == 0)
+        {
+            return false;
+        }
+    }
+
+    // the tone curve tables only exist for the 8 bit output
+    tone_curve_supported_ = false;
+
+    const auto float_fcc = img::is_pwl_fcc(src_fcc)
+                               ? img::by_transform::convert_pwl_to_fcc32f(src_fcc)
+                               : img_filter::transform::convert_fccXX_to_fccfloat(src_fcc);
+    const auto float_type = img::make_img_type(float_fcc, src_type.dim);
+
+    auto unpack_wb_func = find_transform_fccfloat_wb_func(float_type, src_type, kernel_description_);
+    auto tensor_func =
+        select_kernel(byfloat_to_tensor_variants, kernel_description_, dst_type, float_type);
+    if (!unpack_wb_func || !tensor_func)
+    {
+        return false;
+    }
+
+    img_filter::transform::tensor::options opt;
+    if (factor == 1)
+    {
+        opt.byfloat_to_bgrfloat =
+            select_kernel(byfloat_to_bgrfloat_variants,
+                          kernel_description_,
+                          img::make_img_type(img::fourcc::BGRFloat, dst_type.dim),
+                          float_type);
+        if (!opt.byfloat_to_bgrfloat)
+        {
+            return false;
+        }
+    }
+
+    transform_fccXX_to_dst_func_ = [unpack_wb_func, tensor_func, opt, float_fcc, factor, this](
+                                       const img::img_descriptor& dst,
+                                       const img::img_descriptor& src,
+                                       img_filter::filter_params& params)
+    {
+        auto frame_opt = opt;
+        frame_opt.norm = tensor_norm_;
+
+        const transform_binary_func tensor_strip_func =
+            [tensor_func, frame_opt](const img::img_descriptor& d, const img::img_descriptor& s)
+        { tensor_func(d, s, frame_opt); };
+
+        executor_.run(dst,
+                      src,
+                      [&, params](const img::img_descriptor& d, const img::img_descriptor& s)
+                      {
+                          auto strip_params = params;
+                          if (factor == 1)
+                          {
+                              transform_byXX_to_bgra_tiled(
+                                  d, s, float_fcc, unpack_wb_func, tensor_strip_func, strip_params);
+                          }
+                          else
+                          {
+                              transform_byXX_binned_tiled(d,
+                                                          s,
+                                                          float_fcc,
+                                                          factor,
+                                                          unpack_wb_func,
+                                                          tensor_strip_func,
+                                                          strip_params);
+                          }
+                      });
+    };
+    return true;
+}
+
+void tcamconvert::transform_context::set_color_matrix(bool enable,
+                                                     const img::color_matrix_float& mtx)
+{
+    // the simd kernels sum r*fac + g*fac + b*fac of 8 bit values in int16 without saturation,
+    // rows with an absolute sum above 2.0 are scaled down so that they do not wrap
+    constexpr float max_row_sum = 2.f;
+
+    debayer_opt_.use_color_matrix = enable;
+    for (int row = 0; row < 3; ++row)
+    {
+        float row_sum = 0.f;
+        for (int col = 0; col < 3; ++col)
+        {
+            row_sum += std::abs(mtx.fac_3x3[row][col]);
+        }
+        const float scale = row_sum > max_row_sum ? max_row_sum / row_sum : 1.f;
+
+        for (int col = 0; col < 3; ++col)
+        {
+            // truncate, rounding could push the row sum above the limit again
+            debayer_opt_.color_mtx.fac_3x3[row][col] =
+                static_cast<int16_t>(mtx.fac_3x3[row][col] * scale * 64.f);
+        }
+    }
+}
+
 void tcamconvert::transform_context::transform(const img::img_descriptor& src,
                                                const img::img_descriptor& dst,
                                                const img_filter::whitebalance_params& params)
 {
+    update_flat_field(src.dim);
+    transform_view(src, dst, params, {});
+}
+
+void tcamconvert::transform_context::update_flat_field(img::dim frame_dim)
+{
+    if (!flat_field_map_ || flat_field_map_->rows == 0)
+    {
+        flat_field_data_.reset();
+        return;
+    }
+    if (flat_field_data_ && flat_field_prepared_map_ == flat_field_map_
+        && flat_field_data_->frame_dim == frame_dim)
+    {
+        return;
+    }
+
+    // the flat field is not part of the conversion, so its kernels are not in kernel_description_
+    std::string selected;
+    img_filter::flat_field::line_funcs funcs;
+    funcs.by8 = select_kernel(flat_field_variants, selected, img::fourcc::BGGR8);
+    funcs.by16 = select_kernel(flat_field_variants, selected, img::fourcc::BGGR16);
+    funcs.byfloat = select_kernel(flat_field_variants, selected, img::fourcc::BGGRFloat);
+
+    if (!flat_field_data_)
+    {
+        flat_field_data_ = std::make_unique<img_filter::flat_field_data>();
+    }
+    img_filter::flat_field::prepare(*flat_field_data_, *flat_field_map_, frame_dim, funcs);
+    flat_field_prepared_map_ = flat_field_map_;
+}
+
+void tcamconvert::transform_context::transform_view(const img::img_descriptor& src,
+                                                    const img::img_descriptor& dst,
+                                                    const img_filter::whitebalance_params& params,
+                                                    img::point src_offset)
+{
+    const auto frame = img_filter::frame_locator::make(src, src_offset);
+    const bool is_bayer = img::is_bayer_fcc(src.fourcc_type());
+    const bool correct_defects = has_defect_pixel_correction() && is_bayer;
+    const bool correct_flat_field = flat_field_data_ && is_bayer;
+
     if (transform_fccXX_to_dst_func_ == nullptr && transfrom_binary_mono_func_ == nullptr)
     {
-        img::memcpy_image(dst, src);
-        if (transform_unary_wb_func_ && params.apply)
+        // the white balance reads dst again right after the copy, so it has to stay in the cache
+        if (use_streaming_copy_ && !(transform_unary_wb_func_ && params.apply))
+        {
+            executor_.run(dst,
+                          src,
+                          [](const img::img_descriptor& d, const img::img_descriptor& s)
+                          { img::memcpy_image_streaming(d, s); });
+        }
+        else
+        {
+            executor_.run(dst,
+                          src,
+                          [](const img::img_descriptor& d, const img::img_descriptor& s)
+                          { img::memcpy_image(d, s); });
+        }
+        if (correct_defects)
         {
-            transform_unary_wb_func_(dst, params);
+            img_filter::defect_pixel::correct(dst, src_offset, *defect_map_);
         }
+        if (correct_flat_field)
+        {
+            apply_flat_field(dst, src_offset);
+        }
+        apply_wb(dst, params);
     }
     else
     {
         auto dst_ = dst;
-        if (dst.fourcc_type() == img::fourcc::BGRA32)
+        if (img::is_bottom_up_fcc(dst.fourcc_type()))
         {
             dst_ = img::flip_image_in_img_desc(dst);
         }
 
+        img_filter::filter_params tmp = { params };
+
+        if (img::is_by8_fcc(src.fourcc_type()))
+        {
+            // the bayer8 paths read src directly, it is balanced in place as well
+            if (correct_defects)
+            {
+                img_filter::defect_pixel::correct(src, src_offset, *defect_map_);
+            }
+            if (correct_flat_field)
+            {
+                apply_flat_field(src, src_offset);
+            }
+        }
+        else if (correct_defects || correct_flat_field)
+        {
+            tmp.frame = &frame;
+            tmp.defect_pixels = correct_defects ? defect_map_.get() : nullptr;
+            tmp.flat_field = correct_flat_field ? flat_field_data_.get() : nullptr;
+        }
+
+        if (tone_curve_supported_ && !img_filter::is_neutral(tone_curve_))
+        {
+            if (!tone_curve_lut_)
+            {
+                tone_curve_lut_ = std::make_unique<img_filter::fccXX_to_fcc8_lut_data>();
+            }
+            // only recomputes the tables when the white balance or the curve changed
+            img_filter::transform::update_fccXX_to_fcc8_lut_data(*tone_curve_lut_, tone_curve_, params);
+            tmp.fccXX_to_fcc8_lut = tone_curve_lut_.get();
+        }
+
         if (transform_fccXX_to_dst_func_)
         {
-            img_filter::filter_params tmp = { params };
+            if (pwl_wb_map_)
+            {
+                // only recomputes the tables when the white balance changed
+                img_filter::transform::pwl::update_pwl12_to_fcc8_wb_map_data(
+                    *pwl_wb_map_, img::pwl_transform_params {}, params);
+                tmp.pwl12_to_fcc8_wb_lut = pwl_wb_map_.get();
+            }
 
             transform_fccXX_to_dst_func_(dst_, src, tmp);
         }
+        else if (tmp.fccXX_to_fcc8_lut && mono_tone_curve_func_)
+        {
+            executor_.run(dst_,
+                          src,
+                          [this, &tmp](const img::img_descriptor& d, const img::img_descriptor& s)
+                          {
+                              auto strip_params = tmp;
+                              mono_tone_curve_func_(d, s, strip_params);
+                          });
+        }
         else
         {
 
             assert(transfrom_binary_mono_func_ != nullptr);
 
-            transfrom_binary_mono_func_(dst_, src);
+            executor_.run(dst_, src, transfrom_binary_mono_func_);
         }
     }
 }
 
 void tcamconvert::transform_context::filter(const img::img_descriptor& src,
                                             const img_filter::whitebalance_params& params)
+{
+    if (has_defect_pixel_correction())
+    {
+        img_filter::defect_pixel::correct(src, {}, *defect_map_);
+    }
+    update_flat_field(src.dim);
+    if (flat_field_data_)
+    {
+        apply_flat_field(src, {});
+    }
+    apply_wb(src, params);
+}
+
+void tcamconvert::transform_context::apply_flat_field(const img::img_descriptor& img,
+                                                      img::point offset)
+{
+    const auto frame = img_filter::frame_locator::make(img, offset);
+    const auto* data = flat_field_data_.get();
+    executor_.run(img,
+                  [&frame, data](const img::img_descriptor& strip)
+                  { img_filter::flat_field::apply(strip, frame.locate(strip), *data); });
+}
+
+void tcamconvert::transform_context::apply_wb(const img::img_descriptor& src,
+                                              const img_filter::whitebalance_params& params)
 {
     if (transform_unary_wb_func_ && params.apply)
     {
-        transform_unary_wb_func_(src, params);
+        auto wb_func = transform_unary_wb_func_;
+        executor_.run(src,
+                      [wb_func, &params](const img::img_descriptor& strip)
+                      { wb_func(strip, params); });
+    }
+}
+
+void tcamconvert::transform_context::transform_rois(const img::img_descriptor& src,
+                                                    const img::img_descriptor& dst,
+                                                    const std::vector<img::rect>& rois,
+                                                    const img_filter::whitebalance_params& params)
+{
+    // 4 columns keep the pixel groups of the 10 bit packed formats
+    constexpr int halo_x = 4;
+    constexpr int halo_y = 2;
+
+    const bool needs_halo =
+        (img::is_bayer_fcc(src.fourcc_type()) || img::is_pwl_fcc(src.fourcc_type()))
+        && !img::is_bayer_fcc(dst.fourcc_type());
+    // the bayer8 kernels apply the white balance in place, overlapping rects would get it twice
+    const bool copy_src = img::is_by8_fcc(src.fourcc_type()) && !unary_;
+
+    update_flat_field(src.dim);
+
+    int dst_y = 0;
+    for (const auto& roi : rois)
+    {
+        const auto roi_dim = roi.dimensions();
+        const auto dst_view =
+            img::make_safe_img_view(dst, img::rect { img::point { 0, dst_y }, roi_dim });
+        dst_y += roi_dim.cy;
+
+        img::rect src_rect = roi;
+        if (needs_halo)
+        {
+            src_rect.left = std::max(0, roi.left - halo_x);
+            src_rect.top = std::max(0, roi.top - halo_y);
+            src_rect.right = std::min(src.dim.cx, roi.right + halo_x);
+            src_rect.bottom = std::min(src.dim.cy, roi.bottom + halo_y);
+        }
+
+        auto src_view = img::make_safe_img_view(src, src_rect);
+        if (copy_src)
+        {
+            const auto src_copy_type = img::make_img_type(src.fourcc_type(), src_rect.dimensions());
+            roi_src_buffer_.resize(src_copy_type.buffer_length);
+            auto src_copy =
+                img::make_img_desc_from_linear_memory(src_copy_type, roi_src_buffer_.data());
+            img::memcpy_image(src_copy, src_view);
+            src_view = src_copy;
+        }
+
+        if (src_rect.left == roi.left && src_rect.top == roi.top && src_rect.right == roi.right
+            && src_rect.bottom == roi.bottom)
+        {
+            transform_view(src_view, dst_view, params, src_rect.get_top_left());
+            continue;
+        }
+
+        // the halo is converted, too, and cut off afterwards
+        const auto tmp_type = img::make_img_type(dst.fourcc_type(), src_rect.dimensions());
+        roi_dst_buffer_.resize(tmp_type.buffer_length);
+        const auto tmp = img::make_img_desc_from_linear_memory(tmp_type, roi_dst_buffer_.data());
+
+        transform_view(src_view, tmp, params, src_rect.get_top_left());
+
+        const auto halo_offset = img::point { roi.left - src_rect.left, roi.top - src_rect.top };
+        img::memcpy_image(dst_view,
+                          img::make_safe_img_view(tmp, img::rect { halo_offset, roi_dim }));
     }
 }
@@ -1,17 +1,44 @@
 #pragma once
 
+#include "../../../libs/dutils_image/src/dutils_img_filter/by_edge/by_edge.h"
 #include "../../../libs/dutils_image/src/dutils_img_filter/dutils_img_filter_params.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/defect_pixel/defect_pixel.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/filter/flat_field/flat_field.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/fcc8_fcc16/transform_fccXX_to_fcc8_lut.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/pwl/transform_pwl_functions.h"
+#include "../../../libs/dutils_image/src/dutils_img_filter/transform/tensor/transform_tensor.h"
+#include "strip_executor.h"
 
 #include <dutils_img/dutils_img.h>
 #include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace tcamconvert
 {
 auto tcamconvert_get_all_input_fccs() -> std::vector<img::fourcc>;
 auto tcamconvert_get_all_output_fccs() -> std::vector<img::fourcc>;
-auto tcamconvert_get_supported_input_fccs(img::fourcc src_fcc) -> std::vector<img::fourcc>;
-auto tcamconvert_get_supported_output_fccs(img::fourcc src_fcc) -> std::vector<img::fourcc>;
+// the returned lists are built once and stay valid
+auto tcamconvert_get_supported_input_fccs(img::fourcc dst_fcc) -> const std::vector<img::fourcc>&;
+auto tcamconvert_get_supported_output_fccs(img::fourcc src_fcc)
+    -> const std::vector<img::fourcc>&;
+
+// binning_factors are the supported ratios of src to dst dim
+constexpr int binning_factors[] = { 2, 4 };
+bool tcamconvert_can_bin(img::fourcc src_fcc, img::fourcc dst_fcc);
+
+/*
+ * ROIs are converted on their own and stacked top to bottom, left aligned, in the output.
+ * align_roi rounds x and width down to multiples of 4 and y and height to multiples of 2,
+ * which keeps the bayer pattern and the pixel groups of the packed formats.
+ */
+img::rect align_roi(img::rect roi) noexcept;
+img::dim calc_roi_output_dim(const std::vector<img::rect>& rois) noexcept;
+// the input has to contain this, the right/bottom most edge of the ROIs
+img::dim calc_roi_extent(const std::vector<img::rect>& rois) noexcept;
+// planar and tensor outputs cannot be stacked
+bool is_roi_dst_fcc(img::fourcc dst_fcc) noexcept;
 
 using transform_unary_wb_func = void (*)(const img::img_descriptor& dst,
                                          const img_filter::whitebalance_params& params);
@@ -26,19 +53,160 @@ using transform_binary_wb_func = std::function<void(const img::img_descriptor& d
 
 struct transform_context
 {
-    bool setup(img::img_type src_type, img::img_type dst_type);
+    // yuv_colorimetry is only used for NV12/I420/YUY2 dst types
+    bool setup(img::img_type src_type,
+               img::img_type dst_type,
+               const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry = {});
 
     void transform(const img::img_descriptor& src,
                    const img::img_descriptor& dst,
                    const img_filter::whitebalance_params& params);
     void filter(const img::img_descriptor& src, const img_filter::whitebalance_params& params);
 
+    /*
+     * Converts only the rects of src into dst, see calc_roi_output_dim for the layout.
+     * setup() has to be called with the full src dim for src and dst.
+     * Debayering reads a halo around each rect, so the borders of the rects
+     * are the same as in a full conversion.
+     */
+    void transform_rois(const img::img_descriptor& src,
+                        const img::img_descriptor& dst,
+                        const std::vector<img::rect>& rois,
+                        const img_filter::whitebalance_params& params);
+
+    void set_thread_count(int count)
+    {
+        executor_.set_thread_count(count);
+    }
+
+    /*
+     * Color matrix applied while debayering to BGRx and yuv, other conversions ignore it.
+     * The kernels use 1/64 fixed point, factors are clamped to that.
+     */
+    void set_color_matrix(bool enable, const img::color_matrix_float& mtx);
+
+    /*
+     * Gamma, contrast and tone mapping for 10/12/16 bit sources.
+     * Applied together with the white balance where the source is reduced to 8 bit,
+     * 16 bit and passthrough outputs ignore it.
+     */
+    void set_tone_curve(const img_filter::fcc8_tone_curve_params& params) noexcept
+    {
+        tone_curve_ = params;
+    }
+
+    /*
+     * Defect pixels of bayer sources, in coordinates of the src passed to transform().
+     * They are corrected where the source is unpacked, bayer8 sources in place like the
+     * white balance. Unary conversions only correct the unpacked bayer formats.
+     * nullptr disables the correction.
+     */
+    void set_defect_pixel_map(std::shared_ptr<const img_filter::defect_pixel_map> map) noexcept
+    {
+        defect_map_ = std::move(map);
+    }
+    bool has_defect_pixel_correction() const noexcept
+    {
+        return defect_map_ && !defect_map_->pixels.empty();
+    }
+
+    /*
+     * Gain grid for the lens shading of bayer sources, applied where the defect pixels are
+     * corrected. It is expanded to the frame size on the first frame, nullptr disables it.
+     */
+    void set_flat_field_map(std::shared_ptr<const img_filter::flat_field_map> map) noexcept
+    {
+        flat_field_map_ = std::move(map);
+    }
+    bool has_flat_field_correction() const noexcept
+    {
+        return flat_field_map_ && flat_field_map_->rows > 0;
+    }
+
+    // mean and standard deviation for RGBF32PLANAR/RGBF16PLANAR dst, read on every transform()
+    void set_tensor_normalization(const img_filter::transform::tensor::normalization& norm) noexcept
+    {
+        tensor_norm_ = norm;
+    }
+
+    // src and dst type are the same, the only work is the white balance done by filter()
+    bool is_unary() const noexcept
+    {
+        return unary_;
+    }
+    bool has_filter() const noexcept
+    {
+        return transform_unary_wb_func_ != nullptr;
+    }
+
+    // names of the kernels selected by setup(), in order of use
+    const std::string& kernel_description() const noexcept
+    {
+        return kernel_description_;
+    }
+
 private:
+    // src dim is a multiple of dst dim, see binning_factors
+    bool setup_binned(img::img_type src_type,
+                      img::img_type dst_type,
+                      const img_filter::transform::by_edge::yuv_colorimetry& yuv_colorimetry);
+    // bayerXX/pwl to planar float rgb, with the same dim as src or binned
+    bool setup_tensor(img::img_type src_type, img::img_type dst_type);
+
+    // filter() without the defect pixel and flat field correction
+    void apply_wb(const img::img_descriptor& src, const img_filter::whitebalance_params& params);
+
+    // prepares flat_field_data_ for frames of frame_dim, when the map or the dim changed
+    void update_flat_field(img::dim frame_dim);
+    // in place, offset is the position of img in the frame
+    void apply_flat_field(const img::img_descriptor& img, img::point offset);
+
+    // src_offset is the position of src in the frame the defect pixel and flat field maps refer to
+    void transform_view(const img::img_descriptor& src,
+                        const img::img_descriptor& dst,
+                        const img_filter::whitebalance_params& params,
+                        img::point src_offset);
+
+    strip_executor executor_;
+
     transform_unary_wb_func transform_unary_wb_func_ = nullptr;
     transform_binary_func transfrom_binary_mono_func_;
     transform_binary_wb_func transform_fccXX_to_dst_func_;
 
+    std::string kernel_description_;
+
+    bool unary_ = false;
+
+    // passthrough copies of frames larger than the last level cache use non-temporal stores
+    bool use_streaming_copy_ = false;
+
+    // pwl -> bayer8 tables, only allocated for pwl sources
+    std::unique_ptr<img_filter::pwl12_to_fcc8_wb_map_data> pwl_wb_map_;
+
+    img_filter::fcc8_tone_curve_params tone_curve_;
+    // the source has more than 8 bit, tone_curve_lut_ is allocated on first use
+    bool tone_curve_supported_ = false;
+    std::unique_ptr<img_filter::fccXX_to_fcc8_lut_data> tone_curve_lut_;
+
+    img_filter::transform::tensor::normalization tensor_norm_;
+
+    std::shared_ptr<const img_filter::defect_pixel_map> defect_map_;
+
+    std::shared_ptr<const img_filter::flat_field_map> flat_field_map_;
+    std::shared_ptr<const img_filter::flat_field_map> flat_field_prepared_map_;
+    // nullptr without a flat field map
+    std::unique_ptr<img_filter::flat_field_data> flat_field_data_;
+    // monoXX -> MONO8 through tone_curve_lut_, transfrom_binary_mono_func_ does it otherwise
+    transform_binary_wb_func mono_tone_curve_func_;
+
+    // read by the debayer kernels on every call
+    img_filter::transform::by_edge::options debayer_opt_ = { {}, false, false };
+
 private: // byXX -> bgra stuff
     std::vector<uint8_t> transform_intermediate_buffer_;
+
+    // the rects with their halo, see transform_rois
+    std::vector<uint8_t> roi_src_buffer_;
+    std::vector<uint8_t> roi_dst_buffer_;
 };
 } // namespace tcamconvert
@@ -0,0 +1,288 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "caps_cost_model.h"
+
+#include "../../../external/json/json.hpp"
+#include "../../logging.h"
+#include "../../utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <dutils_img/fcc_to_string.h>
+#include <dutils_img/image_fourcc_func.h>
+#include <fstream>
+#include <sstream>
+
+using json = nlohmann::json;
+
+namespace
+{
+
+// framerates closer than this are treated as equal,
+// devices report e.g. 59.94 and 60 for the same bandwidth
+constexpr double fps_tolerance = 0.01;
+// host costs closer than this are treated as equal
+constexpr double cost_tolerance = 0.05;
+
+
+std::string read_benchmark_file()
+{
+    const std::string path = tcam::get_environment_variable("TCAM_CONVERSION_BENCHMARK", "");
+    if (path.empty())
+    {
+        return {};
+    }
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        SPDLOG_WARN("Unable to open conversion benchmark '{}'", path);
+        return {};
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+
+int bits_per_pixel(uint32_t fourcc)
+{
+    if (static_cast<img::fourcc>(fourcc) == img::fourcc::MJPG)
+    {
+        // compressed, the size on the wire is unknown
+        return 0;
+    }
+    return img::get_bits_per_pixel(fourcc);
+}
+
+
+// rough single threaded costs of the c kernels, for machines without a benchmark
+double estimate_ns_per_pixel(uint32_t src, uint32_t dst)
+{
+    const auto src_fcc = static_cast<img::fourcc>(src);
+    const auto dst_fcc = static_cast<img::fourcc>(dst);
+
+    if (src_fcc == img::fourcc::MJPG)
+    {
+        return 6.0;
+    }
+
+    // unpacking and shifting of 10/12/16-bit
+    const double unpack = img::get_bits_per_pixel(src_fcc) > 8 ? 0.6 : 0.0;
+
+    if (img::is_bayer_fcc(src_fcc) && !img::is_bayer_fcc(dst_fcc))
+    {
+        return 1.2 + unpack;
+    }
+    if ((img::is_bayer_fcc(src_fcc) && img::is_bayer_fcc(dst_fcc))
+        || (img::is_mono_fcc(src_fcc) && img::is_mono_fcc(dst_fcc)))
+    {
+        return 0.2 + unpack;
+    }
+    return 1.5 + unpack;
+}
+
+} // namespace
+
+
+namespace tcam::gst
+{
+
+const caps_cost_model& caps_cost_model::get_default()
+{
+    static const caps_cost_model model(read_benchmark_file());
+    return model;
+}
+
+
+caps_cost_model::caps_cost_model(const std::string& benchmark_json)
+{
+    if (benchmark_json.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        const auto j = json::parse(benchmark_json);
+
+        for (const auto& r : j.at("results"))
+        {
+            if (r.contains("verified") && !r["verified"].get<bool>())
+            {
+                continue;
+            }
+            const double pixels = r.at("width").get<double>() * r.at("height").get<double>();
+            const double ms = r.at("ms_per_frame").get<double>();
+            if (pixels <= 0 || ms <= 0)
+            {
+                continue;
+            }
+
+            measurement m = { r.at("src").get<std::string>(),
+                              r.at("dst").get<std::string>(),
+                              ms * 1'000'000 / pixels };
+
+            // only the fastest variant is of interest,
+            // tcamconvert picks it by the cpu features
+            auto iter = std::find_if(measurements_.begin(),
+                                     measurements_.end(),
+                                     [&m](const measurement& e)
+                                     { return e.src == m.src && e.dst == m.dst; });
+            if (iter == measurements_.end())
+            {
+                measurements_.push_back(m);
+            }
+            else
+            {
+                iter->ns_per_pixel = std::min(iter->ns_per_pixel, m.ns_per_pixel);
+            }
+        }
+    }
+    catch (const json::exception& e)
+    {
+        SPDLOG_WARN("Unable to parse conversion benchmark: {}", e.what());
+        measurements_.clear();
+    }
+}
+
+
+const caps_cost_model::measurement* caps_cost_model::find_measurement(uint32_t src,
+                                                                      uint32_t dst) const
+{
+    const auto src_name = img::fcc_to_string(src);
+    const auto dst_name = img::fcc_to_string(dst);
+
+    for (const auto& m : measurements_)
+    {
+        if (m.src == src_name && m.dst == dst_name)
+        {
+            return &m;
+        }
+    }
+    return nullptr;
+}
+
+
+double caps_cost_model::conversion_ns_per_pixel(uint32_t src, uint32_t dst) const
+{
+    if (src == dst || dst == 0)
+    {
+        return 0.0;
+    }
+    if (auto m = find_measurement(src, dst))
+    {
+        return m->ns_per_pixel;
+    }
+    return estimate_ns_per_pixel(src, dst);
+}
+
+
+double caps_cost_model::conversion_ns_per_pixel(uint32_t src,
+                                                const std::vector<uint32_t>& wanted) const
+{
+    if (wanted.empty() || std::find(wanted.begin(), wanted.end(), src) != wanted.end())
+    {
+        return 0.0;
+    }
+
+    double ret = conversion_ns_per_pixel(src, wanted.front());
+    for (auto dst : wanted) { ret = std::min(ret, conversion_ns_per_pixel(src, dst)); }
+    return ret;
+}
+
+
+double caps_cost_model::achievable_fps(const format_candidate& candidate,
+                                       const std::vector<uint32_t>& wanted) const
+{
+    const double ns_per_frame = conversion_ns_per_pixel(candidate.fourcc, wanted)
+                                * candidate.width * candidate.height;
+    if (ns_per_frame <= 0)
+    {
+        return candidate.fps;
+    }
+    return std::min(candidate.fps, 1'000'000'000 / ns_per_frame);
+}
+
+
+int caps_cost_model::select(const std::vector<format_candidate>& candidates,
+                            const std::vector<uint32_t>& wanted) const
+{
+    int best = -1;
+    double best_fps = 0;
+    double best_cost = 0;
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        const auto& c = candidates.at(i);
+        const double fps = achievable_fps(c, wanted);
+        const double cost = conversion_ns_per_pixel(c.fourcc, wanted);
+
+        SPDLOG_DEBUG("{} {}x{}: device {:.2f} fps, host {:.2f} ns/pixel, achievable {:.2f} fps",
+                     img::fcc_to_string(c.fourcc),
+                     c.width,
+                     c.height,
+                     c.fps,
+                     cost,
+                     fps);
+
+        if (best < 0)
+        {
+            best = static_cast<int>(i);
+            best_fps = fps;
+            best_cost = cost;
+            continue;
+        }
+
+        const auto& b = candidates.at(best);
+
+        const auto is_better = [&]()
+        {
+            const int64_t pixels = int64_t(c.width) * c.height;
+            const int64_t best_pixels = int64_t(b.width) * b.height;
+            if (pixels != best_pixels)
+            {
+                return pixels > best_pixels;
+            }
+            if (std::abs(fps - best_fps) > fps_tolerance * std::max(fps, best_fps))
+            {
+                return fps > best_fps;
+            }
+            if (std::abs(cost - best_cost) > cost_tolerance * std::max(cost, best_cost))
+            {
+                return cost < best_cost;
+            }
+            const int bits = bits_per_pixel(c.fourcc);
+            const int best_bits = bits_per_pixel(b.fourcc);
+            if (bits != 0 && best_bits != 0 && bits != best_bits)
+            {
+                return bits < best_bits;
+            }
+            return false;
+        };
+
+        if (is_better())
+        {
+            best = static_cast<int>(i);
+            best_fps = fps;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+} // namespace tcam::gst
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tcam::gst
+{
+
+/**
+ * Largest fixated caps of one device format.
+ */
+struct format_candidate
+{
+    uint32_t fourcc;
+    int width;
+    int height;
+    // highest framerate the device offers for the resolution,
+    // already limited by the bandwidth of USB/GigE
+    double fps;
+};
+
+/**
+ * Estimates the framerate a pipeline reaches with a device format
+ * after the host converted it to the wanted output format.
+ *
+ * The host cost is kept in ns per pixel for one thread.
+ * Built in estimates are used unless TCAM_CONVERSION_BENCHMARK names
+ * the json output of dutils_img_bench, then the fastest measured variant counts.
+ */
+class caps_cost_model
+{
+public:
+    // loaded once, on first use
+    static const caps_cost_model& get_default();
+
+    // @param benchmark_json output of dutils_img_bench, ignored when not parseable
+    explicit caps_cost_model(const std::string& benchmark_json = {});
+
+    // 0 when src equals dst
+    double conversion_ns_per_pixel(uint32_t src, uint32_t dst) const;
+
+    // cheapest conversion to one of wanted, 0 when src is wanted or wanted is empty
+    double conversion_ns_per_pixel(uint32_t src, const std::vector<uint32_t>& wanted) const;
+
+    // framerate limited by the device and by the host conversion to wanted
+    double achievable_fps(const format_candidate& candidate,
+                          const std::vector<uint32_t>& wanted) const;
+
+    /**
+     * Ranks by resolution, achievable framerate, host cost and bytes on the wire.
+     * Remaining ties keep the candidate that comes first.
+     * @param wanted output formats, empty when every candidate is delivered unchanged
+     * @return index into candidates; -1 when candidates is empty
+     */
+    int select(const std::vector<format_candidate>& candidates,
+               const std::vector<uint32_t>& wanted) const;
+
+private:
+    struct measurement
+    {
+        // names as written by img::fcc_to_string
+        std::string src;
+        std::string dst;
+        double ns_per_pixel;
+    };
+
+    const measurement* find_measurement(uint32_t src, uint32_t dst) const;
+
+    std::vector<measurement> measurements_;
+};
+
+} // namespace tcam::gst
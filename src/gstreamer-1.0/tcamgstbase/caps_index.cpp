@@ -0,0 +1,304 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "caps_index.h"
+
+#include "tcamgststrings.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace tcam::gst;
+
+namespace
+{
+
+int get_fixed_int(const GstStructure& struc, const char* field)
+{
+    int value = -1;
+    if (gst_structure_get_field_type(&struc, field) == G_TYPE_INT)
+    {
+        gst_structure_get_int(&struc, field, &value);
+    }
+    return value;
+}
+
+} // namespace
+
+
+caps_index::caps_index(const GstCaps& caps)
+    : caps_(gst_helper::make_wrap_ptr(gst_caps_ref(const_cast<GstCaps*>(&caps))))
+{
+    const guint size = gst_caps_get_size(&caps);
+    entries_.reserve(size);
+
+    // device caps repeat the same few formats for every resolution
+    std::map<std::pair<std::string, std::string>, uint32_t> fourcc_cache;
+
+    for (guint i = 0; i < size; ++i)
+    {
+        const GstStructure* struc = gst_caps_get_structure(&caps, i);
+
+        const char* name = gst_structure_get_name(struc);
+        const char* format = gst_structure_get_string(struc, "format");
+
+        auto key = std::make_pair(std::string(name), std::string(format ? format : ""));
+        auto iter = fourcc_cache.find(key);
+        if (iter == fourcc_cache.end())
+        {
+            iter = fourcc_cache
+                       .emplace(key, tcam_fourcc_from_gst_1_0_caps_string(name, format ? format : ""))
+                       .first;
+        }
+
+        entries_.push_back(
+            { iter->second, get_fixed_int(*struc, "width"), get_fixed_int(*struc, "height"), i });
+    }
+
+    // keeps caps order within a fourcc
+    std::stable_sort(entries_.begin(),
+                     entries_.end(),
+                     [](const entry& lhs, const entry& rhs) { return lhs.fourcc < rhs.fourcc; });
+
+    for (size_t i = 0; i < entries_.size(); ++i)
+    {
+        if (buckets_.empty() || buckets_.back().fourcc != entries_[i].fourcc)
+        {
+            buckets_.push_back({ entries_[i].fourcc, i, i, i });
+        }
+        auto& b = buckets_.back();
+        b.end = i + 1;
+
+        const auto& largest = entries_[b.largest];
+        const auto& e = entries_[i];
+        if (e.width > largest.width || (e.width == largest.width && e.height > largest.height))
+        {
+            b.largest = i;
+        }
+    }
+
+    fourccs_.reserve(buckets_.size());
+    for (const auto& b : buckets_)
+    {
+        if (b.fourcc != 0)
+        {
+            fourccs_.push_back(b.fourcc);
+        }
+    }
+}
+
+
+const caps_index::bucket* caps_index::find_bucket(uint32_t fourcc) const noexcept
+{
+    auto iter =
+        std::lower_bound(buckets_.begin(),
+                         buckets_.end(),
+                         fourcc,
+                         [](const bucket& b, uint32_t value) { return b.fourcc < value; });
+
+    if (iter == buckets_.end() || iter->fourcc != fourcc)
+    {
+        return nullptr;
+    }
+    return &*iter;
+}
+
+
+bool caps_index::has_fourcc(uint32_t fourcc) const noexcept
+{
+    return fourcc != 0 && find_bucket(fourcc) != nullptr;
+}
+
+
+int caps_index::find_largest(uint32_t fourcc) const noexcept
+{
+    auto b = find_bucket(fourcc);
+    if (!b)
+    {
+        return -1;
+    }
+    return entries_[b->largest].index;
+}
+
+
+std::vector<uint32_t> caps_index::fourccs_of(const GstStructure& filter) const
+{
+    const char* name = gst_structure_get_name(&filter);
+
+    if (!gst_structure_has_field(&filter, "format"))
+    {
+        // e.g. image/jpeg
+        uint32_t fourcc = tcam_fourcc_from_gst_1_0_caps_string(name, "");
+        if (fourcc != 0)
+        {
+            return { fourcc };
+        }
+        return {};
+    }
+
+    std::vector<uint32_t> ret;
+
+    const GType type = gst_structure_get_field_type(&filter, "format");
+    if (type == G_TYPE_STRING)
+    {
+        ret.push_back(
+            tcam_fourcc_from_gst_1_0_caps_string(name, gst_structure_get_string(&filter, "format")));
+    }
+    else if (type == GST_TYPE_LIST)
+    {
+        const GValue* list = gst_structure_get_value(&filter, "format");
+        for (guint i = 0; i < gst_value_list_get_size(list); ++i)
+        {
+            const GValue* val = gst_value_list_get_value(list, i);
+            if (G_VALUE_HOLDS_STRING(val))
+            {
+                ret.push_back(tcam_fourcc_from_gst_1_0_caps_string(name, g_value_get_string(val)));
+            }
+        }
+    }
+    else
+    {
+        // unexpected type, let GStreamer decide
+        return {};
+    }
+
+    // unknown formats end up as 0 and are looked up like every other fourcc,
+    // entries with an unknown format are kept in bucket 0
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+
+    if (ret.empty())
+    {
+        // empty list matches nothing
+        ret.push_back(0);
+    }
+    return ret;
+}
+
+
+template<class TFunc> bool caps_index::for_each_candidate(const GstStructure& filter, TFunc&& func) const
+{
+    auto fccs = fourccs_of(filter);
+
+    if (fccs.empty())
+    {
+        for (guint i = 0; i < gst_caps_get_size(caps_.get()); ++i)
+        {
+            if (!func(i))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // keep caps order over all matching buckets
+    std::vector<guint> indices;
+    for (auto fcc : fccs)
+    {
+        if (auto b = find_bucket(fcc))
+        {
+            for (size_t i = b->begin; i < b->end; ++i) { indices.push_back(entries_[i].index); }
+        }
+    }
+    if (fccs.size() > 1)
+    {
+        std::sort(indices.begin(), indices.end());
+    }
+
+    for (auto i : indices)
+    {
+        if (!func(i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+GstCaps* caps_index::intersect(const GstCaps& filter) const
+{
+    if (gst_caps_is_any(&filter))
+    {
+        return gst_caps_copy(caps_.get());
+    }
+
+    // (caps index, filter index) of all candidates, sorted to have caps order
+    std::vector<std::pair<guint, guint>> candidates;
+    for (guint f = 0; f < gst_caps_get_size(&filter); ++f)
+    {
+        for_each_candidate(*gst_caps_get_structure(&filter, f),
+                           [&](guint i)
+                           {
+                               candidates.emplace_back(i, f);
+                               return true;
+                           });
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    GstCaps* ret = gst_caps_new_empty();
+    for (auto [i, f] : candidates)
+    {
+        GstCapsFeatures* features = gst_caps_get_features(caps_.get(), i);
+        if (!gst_caps_features_is_equal(features, gst_caps_get_features(&filter, f)))
+        {
+            continue;
+        }
+
+        GstStructure* res = gst_structure_intersect(gst_caps_get_structure(caps_.get(), i),
+                                                    gst_caps_get_structure(&filter, f));
+        if (res)
+        {
+            ret = gst_caps_merge_structure_full(ret, res, gst_caps_features_copy(features));
+        }
+    }
+
+    return ret;
+}
+
+
+bool caps_index::can_intersect(const GstCaps& filter) const
+{
+    if (gst_caps_is_any(&filter))
+    {
+        return !gst_caps_is_empty(caps_.get());
+    }
+
+    for (guint f = 0; f < gst_caps_get_size(&filter); ++f)
+    {
+        const GstStructure* filter_struc = gst_caps_get_structure(&filter, f);
+        GstCapsFeatures* filter_features = gst_caps_get_features(&filter, f);
+
+        bool found = !for_each_candidate(
+            *filter_struc,
+            [&](guint i)
+            {
+                // returning false ends the search
+                return !(gst_caps_features_is_equal(gst_caps_get_features(caps_.get(), i),
+                                                    filter_features)
+                         && gst_structure_can_intersect(gst_caps_get_structure(caps_.get(), i),
+                                                        filter_struc));
+            });
+        if (found)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <gst-helper/gst_ptr.h>
+#include <gst/gst.h>
+#include <vector>
+
+namespace tcam::gst
+{
+
+/**
+ * Lookup table over the structures of device caps.
+ *
+ * Device caps contain one structure per format/resolution/scaling combination,
+ * for some cameras these are several hundred.
+ * GStreamer intersects every structure with every filter structure,
+ * the index instead resolves the fourcc of each structure once
+ * and only compares structures with a matching fourcc.
+ *
+ * The index keeps a reference to the caps but does not notice changes of them.
+ */
+class caps_index
+{
+public:
+    explicit caps_index(const GstCaps& caps);
+
+    // sorted, without duplicates
+    const std::vector<uint32_t>& fourccs() const noexcept
+    {
+        return fourccs_;
+    }
+
+    bool has_fourcc(uint32_t fourcc) const noexcept;
+
+    /**
+     * The structure with the largest fixed resolution for fourcc.
+     * Width has precedence over height, ties return the first structure in the caps.
+     * @return index into the caps; -1 when fourcc is unknown
+     */
+    int find_largest(uint32_t fourcc) const noexcept;
+
+    /**
+     * Equivalent to gst_caps_intersect_full(caps, filter, GST_CAPS_INTERSECT_FIRST),
+     * but only compares structures with a matching fourcc.
+     * The result keeps the order of caps (the device format preference);
+     * gst_caps_intersect would interleave it with the order of filter.
+     * Filter structures without a format field are compared with all structures.
+     * @return new caps, never nullptr
+     */
+    GstCaps* intersect(const GstCaps& filter) const;
+
+    bool can_intersect(const GstCaps& filter) const;
+
+    const GstCaps& caps() const noexcept
+    {
+        return *caps_;
+    }
+
+private:
+    struct entry
+    {
+        uint32_t fourcc;
+        int width; // -1 when not fixed
+        int height; // -1 when not fixed
+        guint index;
+    };
+
+    // range of entries_ with the same fourcc, in caps order
+    struct bucket
+    {
+        uint32_t fourcc;
+        size_t begin;
+        size_t end;
+        size_t largest;
+    };
+
+    const bucket* find_bucket(uint32_t fourcc) const noexcept;
+
+    // fourccs the filter structure allows, empty for all
+    std::vector<uint32_t> fourccs_of(const GstStructure& filter) const;
+
+    template<class TFunc> bool for_each_candidate(const GstStructure& filter, TFunc&& func) const;
+
+    gst_helper::gst_ptr<GstCaps> caps_;
+
+    std::vector<entry> entries_;
+    std::vector<bucket> buckets_;
+    std::vector<uint32_t> fourccs_;
+};
+
+} // namespace tcam::gst
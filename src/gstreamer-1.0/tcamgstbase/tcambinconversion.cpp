@@ -17,6 +17,7 @@
 #include "tcambinconversion.h"
 
 #include "../../logging.h"
+#include "caps_index.h"
 
 using namespace tcam::gst;
 
@@ -47,11 +48,31 @@ namespace
 {
 
 
+bool is_jpeg_only(const GstCaps* caps)
+{
+    for (guint i = 0; i < gst_caps_get_size(caps); ++i)
+    {
+        if (!gst_structure_has_name(gst_caps_get_structure(caps, i), "image/jpeg"))
+        {
+            return false;
+        }
+    }
+    return gst_caps_get_size(caps) > 0;
+}
+
+
 GstCaps* filter_by_caps_properties(const GstCaps* input, const GstCaps* filter)
 {
 
     GstStructure* filter_struc = gst_caps_get_structure(filter, 0);
 
+    // a sink that only takes jpeg gets the compressed stream of the device,
+    // even when the device offers other formats first
+    if (is_jpeg_only(filter))
+    {
+        return caps_index(*input).intersect(*filter);
+    }
+
     GstStructure* input_struc = gst_caps_get_structure(input, 0);
     if (g_strcmp0(gst_structure_get_name(input_struc), "image/jpeg") == 0)
     {
@@ -93,7 +114,9 @@ GstCaps* filter_by_caps_properties(const GstCaps* input, const GstCaps* filter)
     internal_filter = gst_caps_simplify(internal_filter);
 
 
-    GstCaps* ret = gst_caps_intersect((GstCaps*)input, (GstCaps*)internal_filter);
+    // input are the device caps, intersecting them structure by structure
+    // with the filter dominates the negotiation for cameras with many formats
+    GstCaps* ret = caps_index(*input).intersect(*internal_filter);
 
     gst_caps_unref(internal_filter);
 
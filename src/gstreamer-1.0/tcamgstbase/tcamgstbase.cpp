@@ -18,6 +18,8 @@
 
 #include "../../base_types.h"
 #include "../../logging.h"
+#include "caps_cost_model.h"
+#include "caps_index.h"
 #include "tcambinconversion.h"
 #include "tcamgststrings.h"
 
@@ -27,7 +29,6 @@
 #include <dutils_img/image_fourcc_func.h>
 #include <gst-helper/gst_gvalue_helper.h> // gst_string_list_to_vector
 #include <gst-helper/helper_functions.h>
-#include <map>
 
 
 typedef struct tcam_src_element_
@@ -214,100 +215,52 @@ bool tcam::gst::tcam_gst_raw_only_has_mono(const GstCaps* caps)
 }
 
 
+// the img:: predicates are constexpr switches, no string is involved
 static bool tcam_gst_is_mono10_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_MONO10
-        || fourcc == FOURCC_MONO10_MIPI_PACKED
-        || fourcc == FOURCC_MONO10_SPACKED)
-    {
-        return true;
-    }
-    return false;
+    return img::is_mono10_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_mono12_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_MONO12
-        || fourcc == FOURCC_MONO12_MIPI_PACKED
-        || fourcc == FOURCC_MONO12_PACKED
-        || fourcc == FOURCC_MONO12_SPACKED)
-    {
-        return true;
-    }
-    return false;
+    return img::is_mono12_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_fourcc_bayer(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG8 || fourcc == FOURCC_GRBG8 || fourcc == FOURCC_RGGB8
-        || fourcc == FOURCC_BGGR8)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by8_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_bayer10_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG10 || fourcc == FOURCC_GRBG10 || fourcc == FOURCC_RGGB10
-        || fourcc == FOURCC_BGGR10)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by10_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_bayer10_packed_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG10_SPACKED || fourcc == FOURCC_GRBG10_SPACKED
-        || fourcc == FOURCC_RGGB10_SPACKED || fourcc == FOURCC_BGGR10_SPACKED
-        || fourcc == FOURCC_GBRG10_MIPI_PACKED || fourcc == FOURCC_GRBG10_MIPI_PACKED
-        || fourcc == FOURCC_RGGB10_MIPI_PACKED || fourcc == FOURCC_BGGR10_MIPI_PACKED)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by10_packed_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_bayer12_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG12 || fourcc == FOURCC_GRBG12 || fourcc == FOURCC_RGGB12
-        || fourcc == FOURCC_BGGR12)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by12_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_bayer12_packed_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG12_MIPI_PACKED || fourcc == FOURCC_GRBG12_MIPI_PACKED
-        || fourcc == FOURCC_RGGB12_MIPI_PACKED || fourcc == FOURCC_BGGR12_MIPI_PACKED
-        || fourcc == FOURCC_GBRG12_SPACKED || fourcc == FOURCC_GRBG12_SPACKED
-        || fourcc == FOURCC_RGGB12_SPACKED || fourcc == FOURCC_BGGR12_SPACKED
-        || fourcc == FOURCC_GBRG12_PACKED || fourcc == FOURCC_GRBG12_PACKED
-        || fourcc == FOURCC_RGGB12_PACKED || fourcc == FOURCC_BGGR12_PACKED)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by12_packed_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 
 static bool tcam_gst_is_bayer16_fourcc(const uint32_t fourcc)
 {
-    if (fourcc == FOURCC_GBRG16 || fourcc == FOURCC_GRBG16 || fourcc == FOURCC_RGGB16
-        || fourcc == FOURCC_BGGR16)
-    {
-        return TRUE;
-    }
-    return FALSE;
+    return img::is_by16_fcc(static_cast<img::fourcc>(fourcc));
 }
 
 static bool tcam_gst_is_fourcc_yuv(const uint32_t fourcc)
@@ -338,118 +291,54 @@ bool tcam::gst::format_is_yuv(const char* name, const char* fmt)
 }
 
 
-bool tcam::gst::tcam_gst_is_bayer8_string(const char* format_string)
+// one lookup of the caps table, the checks then compare integers
+static uint32_t bayer_fourcc_from_format(const char* format_string)
 {
     if (format_string == nullptr)
     {
-        return false;
+        return 0;
     }
+    return tcam::gst::tcam_fourcc_from_gst_1_0_caps_string("video/x-bayer", format_string);
+}
 
-    if (strcmp(format_string, "gbrg") == 0 || strcmp(format_string, "grbg") == 0
-        || strcmp(format_string, "rggb") == 0 || strcmp(format_string, "bggr") == 0)
-    {
-        return true;
-    }
 
-    return false;
+bool tcam::gst::tcam_gst_is_bayer8_string(const char* format_string)
+{
+    return tcam_gst_is_fourcc_bayer(bayer_fourcc_from_format(format_string));
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer10_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strncmp(format_string, "gbrg10", strlen("gbrg10")) == 0
-        || strncmp(format_string, "grbg10", strlen("grbg10")) == 0
-        || strncmp(format_string, "rggb10", strlen("rggb10")) == 0
-        || strncmp(format_string, "bggr10", strlen("bggr10")) == 0)
-    {
-        return true;
-    }
-
-    return false;
+    // includes the packed variants, as gbrg10 is a prefix of their names
+    const uint32_t fourcc = bayer_fourcc_from_format(format_string);
+    return tcam_gst_is_bayer10_fourcc(fourcc) || tcam_gst_is_bayer10_packed_fourcc(fourcc);
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer10_packed_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    static constexpr std::array<std::string_view, 12> format_list = {
-        "rggb10p", "grbg10p", "gbrg10p", "bggr10p", "rggb10s", "grbg10s",
-        "gbrg10s", "bggr10s", "rggb10m", "grbg10m", "gbrg10m", "bggr10m",
-    };
-
-    if (std::find(format_list.begin(), format_list.end(), std::string_view(format_string))
-        != format_list.end())
-    {
-        return true;
-    }
-
-    return false;
+    return tcam_gst_is_bayer10_packed_fourcc(bayer_fourcc_from_format(format_string));
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer12_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strncmp(format_string, "gbrg12", strlen("gbrg12")) == 0
-        || strncmp(format_string, "grbg12", strlen("grbg12")) == 0
-        || strncmp(format_string, "rggb12", strlen("rggb12")) == 0
-        || strncmp(format_string, "bggr12", strlen("bggr12")) == 0)
-    {
-        return true;
-    }
-
-    return false;
+    // includes the packed variants, as gbrg12 is a prefix of their names
+    const uint32_t fourcc = bayer_fourcc_from_format(format_string);
+    return tcam_gst_is_bayer12_fourcc(fourcc) || tcam_gst_is_bayer12_packed_fourcc(fourcc);
 }
 
 
 bool tcam::gst::tcam_gst_is_bayer12_packed_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    static const std::array<std::string_view, 12> format_list = {
-        "rggb12p", "grbg12p", "gbrg12p", "bggr12p", "rggb12s", "grbg12s",
-        "gbrg12s", "bggr12s", "rggb12m", "grbg12m", "gbrg12m", "bggr12m",
-    };
-
-    if (std::find(format_list.begin(), format_list.end(), std::string_view(format_string))
-        != format_list.end())
-    {
-        return true;
-    }
-
-    return false;
+    return tcam_gst_is_bayer12_packed_fourcc(bayer_fourcc_from_format(format_string));
 }
 
+
 bool tcam::gst::tcam_gst_is_bayer16_string(const char* format_string)
 {
-    if (format_string == nullptr)
-    {
-        return false;
-    }
-
-    if (strcmp(format_string, "gbrg16") == 0 || strcmp(format_string, "grbg16") == 0
-        || strcmp(format_string, "rggb16") == 0 || strcmp(format_string, "bggr16") == 0)
-    {
-        return true;
-    }
-
-    return false;
+    return tcam_gst_is_bayer16_fourcc(bayer_fourcc_from_format(format_string));
 }
 
 
@@ -557,7 +446,7 @@ bool tcam::gst::gst_caps_are_bayer_only(const GstCaps* caps)
 static bool is_really_empty_caps(const GstCaps* caps)
 {
     /*
-gst_caps_is_empty acts erratic, thus we work around the issue with gst_caps_to_string:
+gst_caps_is_empty acts erratic when handed something that is not a valid GstCaps:
 
 --------
 (gdb) print (char*)gst_caps_to_string (caps)
@@ -566,15 +455,16 @@ $4 = 0x555555a8f120 "EMPTY"
 (process:5873): GStreamer-CRITICAL (recursed) **: gst_caps_is_empty: assertion 'GST_IS_CAPS (caps)' failed
 --------
 
+Check the type first instead of serializing the caps,
+gst_caps_to_string is expensive for device caps with hundreds of structures.
 */
 
-    if (caps == nullptr)
+    if (caps == nullptr || !GST_IS_CAPS(caps))
     {
         return true;
     }
 
-    auto tmp_caps_string = gst_helper::to_string(*caps);
-    if ((tmp_caps_string == "EMPTY") || gst_caps_is_any(caps))
+    if (gst_caps_is_any(caps) || gst_caps_get_size(caps) == 0)
     {
         return true;
     }
@@ -643,107 +533,129 @@ static std::vector<uint32_t> index_format_fourccs(const GstCaps* caps)
     return ret;
 }
 
-static uint32_t find_preferred_format(const std::vector<uint32_t>& vec)
+// lower is preferred, -1 for unknown formats
+static int format_rank(uint32_t fourcc)
 {
-    using namespace tcam::gst;
-
-    /**
-     * prefer bayer 8-bit over everything else
-     * if bayer 8-bit does not exist order according to the following list:
-     * color formats like BGR
-     * color formats like YUV
-     * formats like MJPEG
-     * GRAY16
-     * GRAY8
-     * pwl bayer
-     * bayer12/16
-     * polarized bayer
-     * polarized mono
-     */
-
-    if (vec.empty())
+    if (tcam_gst_is_fourcc_bayer(fourcc))
     {
         return 0;
     }
+    else if (tcam_gst_is_fourcc_rgb(fourcc))
+    {
+        return 10;
+    }
+    else if (tcam_gst_is_fourcc_yuv(fourcc))
+    {
+        return 20;
+    }
+    else if (fourcc == FOURCC_MJPG)
+    {
+        return 30;
+    }
+    else if (fourcc == FOURCC_Y800)
+    {
+        return 40;
+    }
+    else if (tcam_gst_is_mono10_fourcc(fourcc))
+    {
+        return 43;
+    }
+    else if (tcam_gst_is_mono12_fourcc(fourcc))
+    {
+        return 47;
+    }
+    else if (fourcc == FOURCC_Y16)
+    {
+        return 50;
+    }
+    else if (tcam_gst_is_bayerpwl_fourcc(fourcc))
+    {
+        return 60;
+    }
+    else if (tcam_gst_is_bayer10_fourcc(fourcc) || tcam_gst_is_bayer10_packed_fourcc(fourcc))
+    {
+        return 65;
+    }
+    else if (tcam_gst_is_bayer12_fourcc(fourcc) || tcam_gst_is_bayer12_packed_fourcc(fourcc))
+    {
+        return 70;
+    }
+    else if (tcam_gst_is_bayer16_fourcc(fourcc))
+    {
+        return 80;
+    }
+    else if (tcam_gst_is_polarized_bayer(fourcc))
+    {
+        return 90;
+    }
+    else if (tcam_gst_is_polarized_mono(fourcc))
+    {
+        return 100;
+    }
 
-    // maps are ordered
-    // assume vec contains only unique values
-    // map.begin() thus has the entry with best rank
-    // since our key are associated in the way we prefer
-    std::map<int, uint32_t> map;
+    SPDLOG_ERROR("Could not associate rank with fourcc 0x{:x} {}",
+                 fourcc,
+                 img::fcc_to_string(fourcc).c_str());
+    return -1;
+}
 
-    for (const auto& fourcc : vec)
+
+namespace
+{
+struct ranked_format
+{
+    tcam::gst::format_candidate format;
+    int rank;
+    int caps_index;
+};
+} // namespace
+
+
+/**
+ * Largest fixated caps per format, ordered by format_rank.
+ * Formats without rank are dropped.
+ */
+static std::vector<ranked_format> collect_format_candidates(const tcam::gst::caps_index& index,
+                                                            const std::vector<uint32_t>& fourccs)
+{
+    std::vector<ranked_format> ret;
+
+    for (auto fourcc : fourccs)
     {
-        if (tcam_gst_is_fourcc_bayer(fourcc))
-        {
-            //best_result = fourcc;
-            map[0] = fourcc;
-        }
-        else if (tcam_gst_is_fourcc_rgb(fourcc))
+        const int rank = format_rank(fourcc);
+        const int caps_index = index.find_largest(fourcc);
+        if (rank < 0 || caps_index < 0)
         {
-            map[10] = fourcc;
-        }
-        else if (tcam_gst_is_fourcc_yuv(fourcc))
-        {
-            map[20] = fourcc;
-        }
-        else if (fourcc == FOURCC_MJPG)
-        {
-            map[30] = fourcc;
-        }
-        else if (fourcc == FOURCC_Y800)
-        {
-            map[40] = fourcc;
-        }
-        else if (tcam_gst_is_mono10_fourcc(fourcc))
-        {
-            map[43] = fourcc;
-        }
-        else if (tcam_gst_is_mono12_fourcc(fourcc))
-        {
-            map[47] = fourcc;
-        }
-        else if (fourcc == FOURCC_Y16)
-        {
-            map[50] = fourcc;
-        }
-        else if (tcam_gst_is_bayerpwl_fourcc(fourcc))
-        {
-            map[60] = fourcc;
-        }
-        else if (tcam_gst_is_bayer10_fourcc(fourcc) || tcam_gst_is_bayer10_packed_fourcc(fourcc))
-        {
-            map[65] = fourcc;
-        }
-        else if (tcam_gst_is_bayer12_fourcc(fourcc) || tcam_gst_is_bayer12_packed_fourcc(fourcc))
-        {
-            map[70] = fourcc;
-        }
-        else if (tcam_gst_is_bayer16_fourcc(fourcc))
-        {
-            map[80] = fourcc;
-        }
-        else if (tcam_gst_is_polarized_bayer(fourcc))
-        {
-            map[90] = fourcc;
+            continue;
         }
-        else if (tcam_gst_is_polarized_mono(fourcc))
+
+        auto caps = gst_helper::make_ptr(gst_caps_copy_nth(&index.caps(), caps_index));
+        if (!tcam_gst_fixate_caps(caps.get()))
         {
-            map[100] = fourcc;
+            continue;
         }
-        else
+
+        GstStructure* s = gst_caps_get_structure(caps.get(), 0);
+
+        tcam::gst::format_candidate c = { fourcc, 0, 0, 0.0 };
+        gst_structure_get_int(s, "width", &c.width);
+        gst_structure_get_int(s, "height", &c.height);
+
+        int num = 0;
+        int den = 1;
+        if (gst_structure_get_fraction(s, "framerate", &num, &den) && den != 0)
         {
-            SPDLOG_ERROR("Could not associate rank with fourcc 0x{:x} {}",
-                         fourcc,
-                         img::fcc_to_string(fourcc).c_str());
+            c.fps = double(num) / den;
         }
-    }
-    if (map.empty())
-    {
-        return 0;
+
+        ret.push_back({ c, rank, caps_index });
     }
 
-    return map.begin()->second;
+    std::stable_sort(ret.begin(),
+                     ret.end(),
+                     [](const ranked_format& lhs, const ranked_format& rhs)
+                     { return lhs.rank < rhs.rank; });
+    return ret;
 }
 
 
@@ -753,7 +665,11 @@ GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming, const Gs
      * find_largest_caps tries to find the largest caps
      * according to the following rules:
      *
-     * 1. determine the preferred format
+     * 1. take the largest resolution and its highest framerate for every format
+     * 2. let caps_cost_model pick the format with the largest resolution
+     *    that reaches the highest framerate after the conversion to the format of filter,
+     *    ties prefer less host conversion, then fewer bytes on the wire
+     * 3. remaining ties are decided by format_rank:
      *       prefer bayer 8-bit over everything else
      *       if bayer 8-bit does not exist order according to the following list:
      *       color formats like BGR
@@ -762,11 +678,20 @@ GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming, const Gs
      *       GRAY16
      *       pwl bayer
      *       bayer12/16
-     *
-     * 2. find the largest resolution
-     * 3. for the format with the largest resolution take the highest framerate
      */
-    std::vector<uint32_t> format_fourccs = index_format_fourccs(incoming);
+    if (is_really_empty_caps(incoming))
+    {
+        return nullptr;
+    }
+
+    if (gst_caps_is_fixed(incoming))
+    {
+        return gst_caps_copy(incoming);
+    }
+
+    const caps_index index(*incoming);
+
+    std::vector<uint32_t> format_fourccs = index.fourccs();
 
     if (gst_caps_is_fixed(filter))
     {
@@ -787,108 +712,21 @@ GstCaps* tcam::gst::tcam_gst_find_largest_caps(const GstCaps* incoming, const Gs
         }
     }
 
-    uint32_t preferred_fourcc = find_preferred_format(format_fourccs);
+    // structures with ranges for width/height are only picked
+    // when the format has no fixed resolutions
+    const auto candidates = collect_format_candidates(index, format_fourccs);
 
-    if (is_really_empty_caps(incoming))
-    {
-        return nullptr;
-    }
+    std::vector<format_candidate> formats;
+    formats.reserve(candidates.size());
+    for (const auto& c : candidates) { formats.push_back(c.format); }
 
-    if (gst_caps_is_fixed(incoming))
-    {
-        return gst_caps_copy(incoming);
-    }
+    const int selected =
+        caps_cost_model::get_default().select(formats, index_format_fourccs(filter));
 
-    int largest_index = 0;
-    int largest_width = -1;
-    int largest_height = -1;
+    int largest_index = selected < 0 ? 0 : candidates.at(selected).caps_index;
     std::string binning = "1x1";
     std::string skipping = "1x1";
 
-    for (guint i = 0; i < gst_caps_get_size(incoming); ++i)
-    {
-        GstStructure* struc = gst_caps_get_structure(incoming, i);
-
-        const char* format = gst_structure_get_string(struc, "format");
-
-        uint32_t fourcc =
-            tcam_fourcc_from_gst_1_0_caps_string(gst_structure_get_name(struc), format);
-
-        // TODO: what about video/x-raw, format={GRAY8, GRAY16_LE}
-        if (fourcc != preferred_fourcc)
-        {
-            continue;
-        }
-
-        int width = -1;
-        int height = -1;
-        bool new_width = false;
-        bool new_height = false;
-
-        // will fail if width is a range so we only handle
-        // halfway fixated caps
-        if (gst_structure_get_field_type(struc, "width") == G_TYPE_INT)
-        {
-            if (gst_structure_get_int(struc, "width", &width))
-            {
-                if (largest_width < width)
-                {
-                    largest_width = width;
-                    new_width = true;
-                }
-            }
-        }
-        // else if (gst_structure_get_field_type(struc, "width") == GST_TYPE_INT_RANGE)
-        // {
-        //     const GValue* int_range = gst_structure_get_value(struc, "width");
-
-        //     width = gst_value_get_int_range_max(int_range);
-        //     if (largest_width < width)
-        //     {
-        //         largest_width = width;
-        //         new_width = true;
-        //     }
-        // }
-        else
-        {
-            SPDLOG_INFO("Field 'width' does not have a supported type. Current type: '{}'",
-                        g_type_name(gst_structure_get_field_type(struc, "width")));
-        }
-
-        if (gst_structure_get_field_type(struc, "height") == G_TYPE_INT)
-        {
-            if (gst_structure_get_int(struc, "height", &height))
-            {
-                if (largest_height <= height)
-                {
-                    largest_height = height;
-                    new_height = true;
-                }
-            }
-        }
-        // else if (gst_structure_get_field_type(struc, "height") == GST_TYPE_INT_RANGE)
-        // {
-        //     const GValue* int_range = gst_structure_get_value(struc, "height");
-
-        //     height = gst_value_get_int_range_max(int_range);
-        //     if (largest_height < height)
-        //     {
-        //         largest_height = height;
-        //         new_height = true;
-        //     }
-        // }
-        else
-        {
-            SPDLOG_INFO("Field 'height' does not have a supported type. Current type: '{}'",
-                        g_type_name(gst_structure_get_field_type(struc, "height")));
-        }
-
-        if (new_width || new_height)
-        {
-            largest_index = i;
-        }
-    }
-
     GstCaps* largest_caps = gst_caps_copy_nth(incoming, largest_index);
 
     SPDLOG_INFO("Fixating assumed largest caps: {}", gst_helper::to_string(*largest_caps).c_str());
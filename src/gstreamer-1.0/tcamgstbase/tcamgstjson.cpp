@@ -19,6 +19,10 @@
 #include "../../../external/json/json.hpp"
 #include "../../logging.h"
 
+#include <algorithm>
+#include <gst-helper/gobject_ptr.h>
+#include <gst/gst.h>
+
 // for convenience
 using json = nlohmann::json;
 
@@ -56,11 +60,11 @@ std::string tcam::gst::create_device_settings(TcamPropertyProvider* tcam)
         return true;
     };
 
-    for (unsigned int i = 0; i < g_slist_length(names); ++i)
+    for (GSList* entry = names; entry != nullptr; entry = entry->next)
     {
         GError* err_get_prop = nullptr;
 
-        const char* prop_name = static_cast<const char*>(g_slist_nth_data(names, i));
+        const char* prop_name = static_cast<const char*>(entry->data);
 
         auto prop_base = tcam_property_provider_get_tcam_property(tcam, prop_name, &err_get_prop);
         if (is_prop_error_consume(err_get_prop, prop_name))
@@ -156,7 +160,7 @@ enum class apply_single_json_entry_rval
 };
 
 static auto apply_single_json_entry(
-    TcamPropertyProvider* tcam,
+    TcamPropertyBase* prop_base,
     json::iterator iter,
     std::function<void(std::string_view, std::string_view)> report_error_func)
     -> apply_single_json_entry_rval
@@ -166,16 +170,7 @@ static auto apply_single_json_entry(
     try
     {
         GError* err = nullptr;
-        auto prop_base = tcam_property_provider_get_tcam_property(tcam, property_name.c_str(), &err);
-        if (err)
-        {
-            report_error_func(property_name, err->message);
-            g_error_free(err);
-            return apply_single_json_entry_rval::error;
-        }
-        
-        if (tcam_property_base_get_access(prop_base) == TCAM_PROPERTY_ACCESS_RO)
-            return apply_single_json_entry_rval::error;
+
         if (!tcam_property_base_is_available(prop_base, nullptr))
             return apply_single_json_entry_rval::locked_error;
 
@@ -248,8 +243,6 @@ static auto apply_single_json_entry(
             }
         }
 
-        g_object_unref(prop_base);
-
         if (err)
         {
             if (err->domain == tcam_error_quark() && err->code == TCAM_ERROR_PROPERTY_NOT_WRITEABLE)
@@ -278,6 +271,147 @@ static auto apply_single_json_entry(
 }
 
 
+namespace
+{
+
+/**
+ * Returns true when the property already holds the value of the json entry,
+ * so writing it can be skipped.
+ */
+bool json_entry_is_current(TcamPropertyBase* prop_base, const json& value)
+{
+    GError* err = nullptr;
+    bool ret = false;
+
+    switch (tcam_property_base_get_property_type(prop_base))
+    {
+        case TCAM_PROPERTY_TYPE_INTEGER:
+        {
+            if (!value.is_number_integer())
+            {
+                return false;
+            }
+            ret = tcam_property_integer_get_value(TCAM_PROPERTY_INTEGER(prop_base), &err)
+                  == value.get<int64_t>();
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            if (!value.is_number())
+            {
+                return false;
+            }
+            // saved settings contain the value the getter returned, no tolerance needed
+            ret = tcam_property_float_get_value(TCAM_PROPERTY_FLOAT(prop_base), &err)
+                  == value.get<double>();
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        {
+            if (!value.is_string())
+            {
+                return false;
+            }
+            auto current =
+                tcam_property_enumeration_get_value(TCAM_PROPERTY_ENUMERATION(prop_base), &err);
+            ret = current && value.get<std::string>() == current;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            if (!value.is_boolean() && !value.is_number_unsigned())
+            {
+                return false;
+            }
+            bool wanted = value.is_boolean() ? value.get<bool>() : value.get<uint64_t>() != 0;
+            ret = static_cast<bool>(
+                      tcam_property_boolean_get_value(TCAM_PROPERTY_BOOLEAN(prop_base), &err))
+                  == wanted;
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+        {
+            // commands are always executed
+            return false;
+        }
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            if (!value.is_string())
+            {
+                return false;
+            }
+            char* current = tcam_property_string_get_value(TCAM_PROPERTY_STRING(prop_base), &err);
+            ret = current && value.get<std::string>() == current;
+            g_free(current);
+            break;
+        }
+    }
+
+    if (err)
+    {
+        g_error_free(err);
+        return false;
+    }
+    return ret;
+}
+
+/**
+ * Enumerations and booleans are the auto modes and switches that lock other properties,
+ * writing them first saves the retry round for the values they unlock.
+ */
+bool is_written_first(TcamPropertyBase* prop_base)
+{
+    auto type = tcam_property_base_get_property_type(prop_base);
+    return type == TCAM_PROPERTY_TYPE_ENUMERATION || type == TCAM_PROPERTY_TYPE_BOOLEAN;
+}
+
+struct json_load_entry
+{
+    json::iterator iter;
+    gobject_helper::gobject_ptr<TcamPropertyBase> prop;
+};
+
+bool has_property_batch_signal(GObject* obj)
+{
+    return g_signal_lookup("begin-property-batch", G_OBJECT_TYPE(obj)) != 0;
+}
+
+gint compare_property_batch_element(gconstpointer value, gconstpointer /*user_data*/)
+{
+    auto obj = g_value_get_object(static_cast<const GValue*>(value));
+    return has_property_batch_signal(G_OBJECT(obj)) ? 0 : 1;
+}
+
+// tcammainsrc, either tcam itself or a child when tcam is a bin
+// returns a new reference or nullptr
+GstElement* find_property_batch_element(TcamPropertyProvider* tcam)
+{
+    if (has_property_batch_signal(G_OBJECT(tcam)))
+    {
+        return GST_ELEMENT(gst_object_ref(tcam));
+    }
+    if (!GST_IS_BIN(tcam))
+    {
+        return nullptr;
+    }
+
+    GstElement* ret = nullptr;
+
+    GstIterator* iter = gst_bin_iterate_recurse(GST_BIN(tcam));
+    GValue item = G_VALUE_INIT;
+    if (gst_iterator_find_custom(iter, compare_property_batch_element, &item, nullptr))
+    {
+        ret = GST_ELEMENT(g_value_dup_object(&item));
+        g_value_unset(&item);
+    }
+    gst_iterator_free(iter);
+
+    return ret;
+}
+
+} // namespace
+
+
 bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::string& json_data)
 {
     if (!tcam)
@@ -302,14 +436,43 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
         SPDLOG_WARN("Failed to write property '{}', due to: {}", property_name, error_desc);
     };
 
-    // we use a list of iterators to ease implementation of retries
-    std::vector<json::iterator> prop_entry_list;
+    // Resolve every entry once and drop the ones the device already has,
+    // recipes usually only differ in a handful of values.
+    std::vector<json_load_entry> prop_entry_list;
     prop_entry_list.reserve(props.size());
+    size_t unchanged_count = 0;
     for (auto iter = props.begin(); iter != props.end(); ++iter)
     {
-        prop_entry_list.push_back(iter);
+        GError* err = nullptr;
+        auto prop = gobject_helper::make_ptr(
+            tcam_property_provider_get_tcam_property(tcam, iter.key().c_str(), &err));
+        if (err)
+        {
+            report_error(iter.key(), err->message);
+            g_error_free(err);
+            continue;
+        }
+        if (tcam_property_base_get_access(prop.get()) == TCAM_PROPERTY_ACCESS_RO)
+        {
+            continue;
+        }
+        if (tcam_property_base_is_available(prop.get(), nullptr)
+            && json_entry_is_current(prop.get(), iter.value()))
+        {
+            unchanged_count++;
+            continue;
+        }
+        prop_entry_list.push_back(json_load_entry { iter, std::move(prop) });
     }
 
+    std::stable_partition(prop_entry_list.begin(),
+                          prop_entry_list.end(),
+                          [](const json_load_entry& e) { return is_written_first(e.prop.get()); });
+
+    SPDLOG_DEBUG("Loading {} properties, {} already have the requested value.",
+                 prop_entry_list.size() + unchanged_count,
+                 unchanged_count);
+
     /* This works like this:
      * Walk current list
      *  if one returns 'locked' as the error, add that entry to the retry-list
@@ -317,18 +480,25 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
      *  If the retry-list contains elements and at least one property could be successfully written, retry using the remaining items in the retry list.
      */
 
+    // write all values with as few device requests as possible
+    GstElement* batch_element = find_property_batch_element(tcam);
+    if (batch_element)
+    {
+        g_signal_emit_by_name(batch_element, "begin-property-batch");
+    }
+
     // we need this flag to prevent us continually re-trying the same items.
     bool at_least_one_success = false;
     do {
         at_least_one_success = false;
         // this is the list of items which were blocked by a locked flag
-        std::vector<json::iterator> retry_list;
-        for (auto&& it : prop_entry_list)
+        std::vector<json_load_entry> retry_list;
+        for (auto&& entry : prop_entry_list)
         {
-            auto res = apply_single_json_entry(tcam, it, report_error);
+            auto res = apply_single_json_entry(entry.prop.get(), entry.iter, report_error);
             if (res == apply_single_json_entry_rval::locked_error)
             {
-                retry_list.push_back(it);
+                retry_list.push_back(std::move(entry));
             }
             else if (res == apply_single_json_entry_rval::success)
             {
@@ -339,10 +509,21 @@ bool tcam::gst::load_device_settings(TcamPropertyProvider* tcam, const std::stri
         prop_entry_list = std::move(retry_list);
     } while (at_least_one_success && !prop_entry_list.empty());
 
+    if (batch_element)
+    {
+        gboolean batch_ret = TRUE;
+        g_signal_emit_by_name(batch_element, "end-property-batch", &batch_ret);
+        if (!batch_ret)
+        {
+            SPDLOG_WARN("Not all properties could be written to the device.");
+        }
+        gst_object_unref(batch_element);
+    }
+
     // generate the error message list for the properties we could not write due to being 'locked'
     for (auto&& entry : prop_entry_list)
     {
-        report_error(entry.key(), "Failed to write locked property");
+        report_error(entry.iter.key(), "Failed to write locked property");
     }
 
     return props.size() != prop_entry_list.size(); // we have at least one successfully 'set' entry
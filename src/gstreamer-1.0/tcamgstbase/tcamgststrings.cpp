@@ -32,7 +32,8 @@ struct TcamGstMapping
 
 } // namespace
 
-static const TcamGstMapping tcam_gst_caps_info[] = {
+// resolved at compile time, lookups only compare the fourcc or the caps strings
+static constexpr TcamGstMapping tcam_gst_caps_info[] = {
     {
         FOURCC_BGRA32,
         "video/x-raw, format=(string)BGRx",
@@ -347,7 +348,7 @@ std::string tcam::gst::tcam_fourcc_to_gst_1_0_caps_string(uint32_t fourcc)
 
 uint32_t tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(const char* name, const char* format)
 {
-    if (strcmp(name, "") == 0 && strcmp(format, "") == 0)
+    if (name == nullptr || (name[0] == '\0' && (format == nullptr || format[0] == '\0')))
     {
         return 0;
     }
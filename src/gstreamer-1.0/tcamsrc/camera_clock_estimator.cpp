@@ -0,0 +1,124 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "camera_clock_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam::mainsrc;
+
+
+void camera_clock_estimator::reset() noexcept
+{
+    *this = camera_clock_estimator();
+}
+
+
+void camera_clock_estimator::add_observation(uint64_t camera_ns, uint64_t host_ns) noexcept
+{
+    // the camera clock was reset, e.g. by a reconnect
+    if (valid_ && camera_ns <= last_camera_ns_)
+    {
+        reset();
+    }
+    last_camera_ns_ = camera_ns;
+
+    const observation obs = { camera_ns, host_ns };
+    if (bucket_count_ == 0 || obs.delay() < bucket_min_.delay())
+    {
+        bucket_min_ = obs;
+    }
+    bucket_count_++;
+
+    if (window_count_ == 0)
+    {
+        // no line yet, follow the smallest delay seen so far
+        camera_ref_ = bucket_min_.camera_ns;
+        host_ref_ = bucket_min_.host_ns;
+        rate_ = 1.0;
+        valid_ = true;
+    }
+
+    if (bucket_count_ == bucket_size)
+    {
+        window_[window_next_] = bucket_min_;
+        window_next_ = (window_next_ + 1) % window_size;
+        window_count_ = std::min(window_count_ + 1, window_size);
+        bucket_count_ = 0;
+
+        update_model();
+    }
+}
+
+
+void camera_clock_estimator::update_model() noexcept
+{
+    // the newest observation is the origin, this keeps the doubles small
+    const observation origin = window_[(window_next_ + window_size - 1) % window_size];
+
+    if (window_count_ < 2)
+    {
+        camera_ref_ = origin.camera_ns;
+        host_ref_ = origin.host_ns;
+        rate_ = 1.0;
+        return;
+    }
+
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (size_t i = 0; i < window_count_; ++i)
+    {
+        mean_x += static_cast<double>(static_cast<int64_t>(window_[i].camera_ns - origin.camera_ns));
+        mean_y += static_cast<double>(static_cast<int64_t>(window_[i].host_ns - origin.host_ns));
+    }
+    mean_x /= window_count_;
+    mean_y /= window_count_;
+
+    double sxx = 0.0;
+    double sxy = 0.0;
+    for (size_t i = 0; i < window_count_; ++i)
+    {
+        const double dx =
+            static_cast<double>(static_cast<int64_t>(window_[i].camera_ns - origin.camera_ns))
+            - mean_x;
+        const double dy =
+            static_cast<double>(static_cast<int64_t>(window_[i].host_ns - origin.host_ns)) - mean_y;
+        sxx += dx * dx;
+        sxy += dx * dy;
+    }
+
+    double rate = sxx > 0.0 ? sxy / sxx : 1.0;
+    rate = std::clamp(rate, 1.0 - max_drift, 1.0 + max_drift);
+
+    const double intercept = mean_y - rate * mean_x;
+
+    camera_ref_ = origin.camera_ns;
+    host_ref_ = origin.host_ns + static_cast<int64_t>(std::llround(intercept));
+    rate_ = rate;
+}
+
+
+std::optional<uint64_t> camera_clock_estimator::to_host(uint64_t camera_ns) const noexcept
+{
+    if (!valid_)
+    {
+        return std::nullopt;
+    }
+
+    const auto diff = static_cast<double>(static_cast<int64_t>(camera_ns - camera_ref_));
+    return host_ref_ + static_cast<int64_t>(std::llround(diff * rate_));
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace tcam::mainsrc
+{
+
+/**
+ * Relates the camera clock to the host clock.
+ *
+ * Every frame gives one observation, the camera time of the frame and the host time it arrived.
+ * The arrival is delayed by a varying transfer time, so only the observation with the
+ * smallest delay of every bucket is kept. A line through the kept observations of the
+ * window gives offset and drift, which maps camera times to host times without the jitter.
+ *
+ * Not thread safe.
+ */
+class camera_clock_estimator
+{
+public:
+    void reset() noexcept;
+
+    void add_observation(uint64_t camera_ns, uint64_t host_ns) noexcept;
+
+    // empty until the first observation
+    std::optional<uint64_t> to_host(uint64_t camera_ns) const noexcept;
+
+    // rate difference of the camera clock to the host clock
+    double get_drift_ppm() const noexcept
+    {
+        return (rate_ - 1.0) * 1e6;
+    }
+
+private:
+    struct observation
+    {
+        uint64_t camera_ns = 0;
+        uint64_t host_ns = 0;
+
+        int64_t delay() const noexcept
+        {
+            return static_cast<int64_t>(host_ns - camera_ns);
+        }
+    };
+
+    static constexpr size_t bucket_size = 8;
+    static constexpr size_t window_size = 32;
+    // a larger estimate means a broken camera clock, not drift
+    static constexpr double max_drift = 1e-3;
+
+    void update_model() noexcept;
+
+    observation bucket_min_;
+    size_t bucket_count_ = 0;
+
+    std::array<observation, window_size> window_ = {};
+    size_t window_count_ = 0;
+    size_t window_next_ = 0;
+
+    uint64_t last_camera_ns_ = 0;
+
+    // host = host_ref_ + (camera - camera_ref_) * rate_
+    bool valid_ = false;
+    uint64_t camera_ref_ = 0;
+    uint64_t host_ref_ = 0;
+    double rate_ = 1.0;
+};
+
+} // namespace tcam::mainsrc
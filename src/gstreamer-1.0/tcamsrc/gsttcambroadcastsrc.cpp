@@ -0,0 +1,410 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gsttcambroadcastsrc.h"
+
+#include "../../BroadcastConsumer.h"
+#include "../tcamgstbase/tcamgststrings.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+GST_DEBUG_CATEGORY_STATIC(tcam_broadcast_src_debug);
+#define GST_CAT_DEFAULT tcam_broadcast_src_debug
+
+enum
+{
+    PROP_0,
+    PROP_BROADCAST,
+    PROP_POLICY,
+    PROP_FRAMES_DROPPED,
+};
+
+// how often create() looks at the unlock flag while no frame arrives
+static const int acquire_timeout_ms = 100;
+
+struct broadcast_src_state
+{
+    std::mutex mtx;
+    std::string name;
+    GstTcamBroadcastPolicy policy = GST_TCAM_BROADCAST_POLICY_DROP;
+
+    // buffers in flight keep a reference, so the mapping outlives stop()
+    std::shared_ptr<tcam::BroadcastConsumer> consumer;
+
+    std::atomic<bool> unlock = false;
+};
+
+// user data of the wrapped memory, gives the slot back when downstream is done
+struct broadcast_frame_ref
+{
+    std::shared_ptr<tcam::BroadcastConsumer> consumer;
+    tcam::BroadcastConsumer::frame frame;
+};
+
+static GstStaticPadTemplate tcam_broadcast_src_template = GST_STATIC_PAD_TEMPLATE(
+    "src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw; video/x-bayer; image/jpeg; ANY"));
+
+G_DEFINE_TYPE(GstTcamBroadcastSrc, gst_tcam_broadcast_src, GST_TYPE_PUSH_SRC)
+
+
+GType gst_tcam_broadcast_policy_get_type(void)
+{
+    static GType tcam_broadcast_policy = 0;
+
+    if (!tcam_broadcast_policy)
+    {
+        static const GEnumValue policies[] = {
+            { GST_TCAM_BROADCAST_POLICY_DROP, "GST_TCAM_BROADCAST_POLICY_DROP", "drop" },
+            { GST_TCAM_BROADCAST_POLICY_BLOCK, "GST_TCAM_BROADCAST_POLICY_BLOCK", "block" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_broadcast_policy = g_enum_register_static("GstTcamBroadcastPolicy", policies);
+    }
+    return tcam_broadcast_policy;
+}
+
+
+static std::shared_ptr<tcam::BroadcastConsumer> get_consumer(GstTcamBroadcastSrc* self)
+{
+    std::scoped_lock lck { self->state_->mtx };
+    return self->state_->consumer;
+}
+
+
+static gboolean gst_tcam_broadcast_src_start(GstBaseSrc* src)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(src);
+    auto& state = *self->state_;
+
+    std::scoped_lock lck { state.mtx };
+
+    auto res = tcam::BroadcastConsumer::connect(
+        state.name, static_cast<tcam::broadcast::consumer_policy>(state.policy));
+    if (!res)
+    {
+        GST_ELEMENT_ERROR(self,
+                          RESOURCE,
+                          OPEN_READ,
+                          ("Unable to connect to broadcast '%s': %s",
+                           state.name.c_str(),
+                           res.error().message().c_str()),
+                          (NULL));
+        return FALSE;
+    }
+    state.consumer = res.value();
+    state.unlock = false;
+
+    GST_INFO_OBJECT(self,
+                    "Connected to broadcast '%s': %s",
+                    state.name.c_str(),
+                    state.consumer->get_format().to_string().c_str());
+    return TRUE;
+}
+
+
+static gboolean gst_tcam_broadcast_src_stop(GstBaseSrc* src)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(src);
+
+    std::scoped_lock lck { self->state_->mtx };
+    self->state_->consumer.reset();
+    return TRUE;
+}
+
+
+static GstCaps* gst_tcam_broadcast_src_get_caps(GstBaseSrc* src, GstCaps* filter)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(src);
+
+    auto consumer = get_consumer(self);
+    if (!consumer)
+    {
+        return GST_BASE_SRC_CLASS(gst_tcam_broadcast_src_parent_class)->get_caps(src, filter);
+    }
+
+    const auto format = consumer->get_format();
+    const auto caps_string = tcam::gst::tcam_fourcc_to_gst_1_0_caps_string(format.get_fourcc());
+
+    GstCaps* caps = gst_caps_from_string(caps_string.c_str());
+    if (!caps)
+    {
+        GST_ERROR_OBJECT(self, "Broadcast format %s has no caps", format.to_string().c_str());
+        return gst_caps_new_empty();
+    }
+
+    int fps_n = 0;
+    int fps_d = 1;
+    gst_util_double_to_fraction(format.get_framerate(), &fps_n, &fps_d);
+
+    gst_caps_set_simple(caps,
+                        "width",
+                        G_TYPE_INT,
+                        static_cast<int>(format.get_size().width),
+                        "height",
+                        G_TYPE_INT,
+                        static_cast<int>(format.get_size().height),
+                        "framerate",
+                        GST_TYPE_FRACTION,
+                        fps_n,
+                        fps_d,
+                        nullptr);
+
+    if (filter)
+    {
+        GstCaps* tmp = gst_caps_intersect_full(filter, caps, GST_CAPS_INTERSECT_FIRST);
+        gst_caps_unref(caps);
+        caps = tmp;
+    }
+    return caps;
+}
+
+
+static gboolean gst_tcam_broadcast_src_unlock(GstBaseSrc* src)
+{
+    GST_TCAM_BROADCAST_SRC(src)->state_->unlock = true;
+    return TRUE;
+}
+
+
+static gboolean gst_tcam_broadcast_src_unlock_stop(GstBaseSrc* src)
+{
+    GST_TCAM_BROADCAST_SRC(src)->state_->unlock = false;
+    return TRUE;
+}
+
+
+static void release_frame(gpointer user_data)
+{
+    auto ref = static_cast<broadcast_frame_ref*>(user_data);
+    ref->consumer->release(ref->frame);
+    delete ref;
+}
+
+
+static GstFlowReturn gst_tcam_broadcast_src_create(GstPushSrc* push_src, GstBuffer** buffer)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(push_src);
+
+    auto consumer = get_consumer(self);
+    if (!consumer)
+    {
+        return GST_FLOW_FLUSHING;
+    }
+
+    while (true)
+    {
+        if (self->state_->unlock)
+        {
+            return GST_FLOW_FLUSHING;
+        }
+
+        auto res = consumer->acquire(acquire_timeout_ms);
+        if (res)
+        {
+            const auto& frame = res.value();
+
+            auto ref = new broadcast_frame_ref { consumer, frame };
+
+            // the slot is only read, the producer does not touch it until it is released
+            *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                                  const_cast<void*>(frame.data),
+                                                  frame.length,
+                                                  0,
+                                                  frame.length,
+                                                  ref,
+                                                  release_frame);
+
+            GST_BUFFER_OFFSET(*buffer) = frame.seq;
+            if (frame.statistics.is_damaged)
+            {
+                GST_BUFFER_FLAG_SET(*buffer, GST_BUFFER_FLAG_CORRUPTED);
+            }
+            return GST_FLOW_OK;
+        }
+
+        if (res.error() == tcam::status::DeviceLost)
+        {
+            GST_INFO_OBJECT(self,
+                            "Broadcast ended, %" G_GUINT64_FORMAT " frames were dropped",
+                            consumer->get_frames_dropped());
+            return GST_FLOW_EOS;
+        }
+        if (res.error() != tcam::status::Timeout)
+        {
+            GST_ELEMENT_ERROR(
+                self, RESOURCE, READ, ("%s", res.error().message().c_str()), (NULL));
+            return GST_FLOW_ERROR;
+        }
+    }
+}
+
+
+static void gst_tcam_broadcast_src_set_property(GObject* object,
+                                                guint prop_id,
+                                                const GValue* value,
+                                                GParamSpec* pspec)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(object);
+    auto& state = *self->state_;
+
+    switch (prop_id)
+    {
+        case PROP_BROADCAST:
+        {
+            const char* str = g_value_get_string(value);
+
+            std::scoped_lock lck { state.mtx };
+            state.name = str ? str : "";
+            break;
+        }
+        case PROP_POLICY:
+        {
+            std::scoped_lock lck { state.mtx };
+            state.policy = static_cast<GstTcamBroadcastPolicy>(g_value_get_enum(value));
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_broadcast_src_get_property(GObject* object,
+                                                guint prop_id,
+                                                GValue* value,
+                                                GParamSpec* pspec)
+{
+    GstTcamBroadcastSrc* self = GST_TCAM_BROADCAST_SRC(object);
+    auto& state = *self->state_;
+
+    switch (prop_id)
+    {
+        case PROP_BROADCAST:
+        {
+            std::scoped_lock lck { state.mtx };
+            g_value_set_string(value, state.name.c_str());
+            break;
+        }
+        case PROP_POLICY:
+        {
+            std::scoped_lock lck { state.mtx };
+            g_value_set_enum(value, state.policy);
+            break;
+        }
+        case PROP_FRAMES_DROPPED:
+        {
+            auto consumer = get_consumer(self);
+            g_value_set_uint64(value, consumer ? consumer->get_frames_dropped() : 0);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_broadcast_src_init(GstTcamBroadcastSrc* self)
+{
+    self->state_ = new broadcast_src_state();
+
+    gst_base_src_set_live(GST_BASE_SRC(self), TRUE);
+    gst_base_src_set_format(GST_BASE_SRC(self), GST_FORMAT_TIME);
+    gst_base_src_set_do_timestamp(GST_BASE_SRC(self), TRUE);
+}
+
+
+static void gst_tcam_broadcast_src_finalize(GObject* object)
+{
+    delete GST_TCAM_BROADCAST_SRC(object)->state_;
+
+    G_OBJECT_CLASS(gst_tcam_broadcast_src_parent_class)->finalize(object);
+}
+
+
+static void gst_tcam_broadcast_src_class_init(GstTcamBroadcastSrcClass* klass)
+{
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+    GstBaseSrcClass* gstbasesrc_class = GST_BASE_SRC_CLASS(klass);
+    GstPushSrcClass* gstpushsrc_class = GST_PUSH_SRC_CLASS(klass);
+
+    gobject_class->finalize = gst_tcam_broadcast_src_finalize;
+    gobject_class->set_property = gst_tcam_broadcast_src_set_property;
+    gobject_class->get_property = gst_tcam_broadcast_src_get_property;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BROADCAST,
+        g_param_spec_string("broadcast",
+                            "Broadcast name",
+                            "Name of the broadcast, the 'broadcast' property of the tcammainsrc "
+                            "in the producing process",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_POLICY,
+        g_param_spec_enum("policy",
+                          "Policy",
+                          "drop skips frames this element did not read in time, "
+                          "block makes the producer wait for this element",
+                          GST_TYPE_TCAM_BROADCAST_POLICY,
+                          GST_TCAM_BROADCAST_POLICY_DROP,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FRAMES_DROPPED,
+        g_param_spec_uint64("frames-dropped",
+                            "Frames dropped",
+                            "Frames that were overwritten before they were read",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    GST_DEBUG_CATEGORY_INIT(
+        tcam_broadcast_src_debug, "tcambroadcastsrc", 0, "tcam broadcast consumer");
+
+    gst_element_class_set_static_metadata(element_class,
+                                          "Tcam Broadcast Source",
+                                          "Source/Video",
+                                          "Receives the stream a tcammainsrc broadcasts",
+                                          "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_pad_template(element_class,
+                                       gst_static_pad_template_get(&tcam_broadcast_src_template));
+
+    gstbasesrc_class->start = gst_tcam_broadcast_src_start;
+    gstbasesrc_class->stop = gst_tcam_broadcast_src_stop;
+    gstbasesrc_class->get_caps = gst_tcam_broadcast_src_get_caps;
+    gstbasesrc_class->unlock = gst_tcam_broadcast_src_unlock;
+    gstbasesrc_class->unlock_stop = gst_tcam_broadcast_src_unlock_stop;
+
+    gstpushsrc_class->create = gst_tcam_broadcast_src_create;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gst/base/gstpushsrc.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAM_BROADCAST_SRC (gst_tcam_broadcast_src_get_type())
+#define GST_TCAM_BROADCAST_SRC(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAM_BROADCAST_SRC, GstTcamBroadcastSrc))
+#define GST_IS_TCAM_BROADCAST_SRC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAM_BROADCAST_SRC))
+
+typedef struct _GstTcamBroadcastSrc GstTcamBroadcastSrc;
+typedef struct _GstTcamBroadcastSrcClass GstTcamBroadcastSrcClass;
+
+#define GST_TYPE_TCAM_BROADCAST_POLICY (gst_tcam_broadcast_policy_get_type())
+GType gst_tcam_broadcast_policy_get_type(void);
+
+// values are the ones of tcam::broadcast::consumer_policy
+typedef enum
+{
+    GST_TCAM_BROADCAST_POLICY_DROP = 0,
+    GST_TCAM_BROADCAST_POLICY_BLOCK = 1,
+} GstTcamBroadcastPolicy;
+
+struct broadcast_src_state;
+
+struct _GstTcamBroadcastSrc
+{
+    GstPushSrc element;
+
+    broadcast_src_state* state_;
+};
+
+struct _GstTcamBroadcastSrcClass
+{
+    GstPushSrcClass parent_class;
+};
+
+GType gst_tcam_broadcast_src_get_type(void);
+
+G_END_DECLS
@@ -16,14 +16,30 @@
 
 #include "gsttcambufferpool.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamchunkdata.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamimagestatistics.h"
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcammissinglines.h"
 #include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../usdt_probes.h"
 #include "gst/gstbufferpool.h"
 #include "gsttcammainsrc.h"
 #include "mainsrc_device_state.h"
 
+#include <algorithm>
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/video/gstvideometa.h>
+#include <cstring> // strerror
+#include <unistd.h> // dup
+
 struct tcam_pool_state
 {
     std::vector<tcam::mainsrc::buffer_info> buffer;
+
+    // only created when buffers are backed by dmabuf
+    GstAllocator* dmabuf_allocator = nullptr;
+
+    // buffers acquired from the downstream pool, indexed by the pool index of the tcam buffer
+    std::vector<GstBuffer*> imported;
 };
 
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
@@ -80,66 +96,279 @@ static void statistics_to_gst_structure(const tcam::tcam_stream_statistics& stat
                       "is_damaged",
                       G_TYPE_BOOLEAN,
                       stat.is_damaged,
+                      "timestamp_source",
+                      G_TYPE_UINT,
+                      (guint)stat.timestamp_source,
+                      "dropped_no_buffer",
+                      G_TYPE_UINT64,
+                      stat.drops.no_buffer,
+                      "dropped_transport",
+                      G_TYPE_UINT64,
+                      stat.drops.transport,
+                      "dropped_incomplete",
+                      G_TYPE_UINT64,
+                      stat.drops.incomplete,
+                      "settings_id",
+                      G_TYPE_UINT64,
+                      stat.settings_id,
+                      nullptr);
+
+    if (stat.has_roi_origin)
+    {
+        gst_structure_set(&struc,
+                          "roi_origin_x",
+                          G_TYPE_INT,
+                          stat.roi_origin_x,
+                          "roi_origin_y",
+                          G_TYPE_INT,
+                          stat.roi_origin_y,
+                          nullptr);
+    }
+
+    if (stat.has_transport_statistics)
+    {
+        gst_structure_set(&struc,
+                          "completed_buffers",
+                          G_TYPE_UINT64,
+                          stat.transport.completed_buffers,
+                          "failed_buffers",
+                          G_TYPE_UINT64,
+                          stat.transport.failed_buffers,
+                          "underruns",
+                          G_TYPE_UINT64,
+                          stat.transport.underruns,
+                          "resent_packets",
+                          G_TYPE_UINT64,
+                          stat.transport.resent_packets,
+                          "missing_packets",
+                          G_TYPE_UINT64,
+                          stat.transport.missing_packets,
+                          nullptr);
+    }
+
+    if (stat.dequeue_time_ns == 0)
+    {
+        return;
+    }
+
+    // latency tracing is enabled
+    gst_structure_set(&struc,
+                      "dequeue_time_ns",
+                      G_TYPE_UINT64,
+                      stat.dequeue_time_ns,
+                      "auto_pass_begin_ns",
+                      G_TYPE_UINT64,
+                      stat.auto_pass_begin_ns,
+                      "auto_pass_end_ns",
+                      G_TYPE_UINT64,
+                      stat.auto_pass_end_ns,
+                      "sink_push_time_ns",
+                      G_TYPE_UINT64,
+                      stat.sink_push_time_ns,
                       nullptr);
 }
 
 
-static void gst_tcam_buffer_pool_sh_callback(std::shared_ptr<tcam::ImageBuffer> buffer, void* data)
+static void statistics_to_values(const tcam::tcam_stream_statistics& stat,
+                                 TcamStatisticsValues& values)
+{
+    values.frame_count = stat.frame_count;
+    values.frames_dropped = stat.frames_dropped;
+    values.capture_time_ns = stat.capture_time_ns;
+    values.camera_time_ns = stat.camera_time_ns;
+    values.is_damaged = stat.is_damaged;
+
+    values.dequeue_time_ns = stat.dequeue_time_ns;
+    values.auto_pass_begin_ns = stat.auto_pass_begin_ns;
+    values.auto_pass_end_ns = stat.auto_pass_end_ns;
+    values.sink_push_time_ns = stat.sink_push_time_ns;
+    // filled later in the pipeline
+    values.gst_push_time_ns = 0;
+    values.tcamconvert_begin_ns = 0;
+    values.tcamconvert_end_ns = 0;
+
+    values.completed_buffers = stat.transport.completed_buffers;
+    values.failed_buffers = stat.transport.failed_buffers;
+    values.underruns = stat.transport.underruns;
+    values.resent_packets = stat.transport.resent_packets;
+    values.missing_packets = stat.transport.missing_packets;
+
+    values.timestamp_source = stat.timestamp_source;
+
+    values.dropped_no_buffer = stat.drops.no_buffer;
+    values.dropped_transport = stat.drops.transport;
+    values.dropped_incomplete = stat.drops.incomplete;
+
+    values.settings_id = stat.settings_id;
+
+    values.has_roi_origin = stat.has_roi_origin;
+    values.roi_origin_x = stat.roi_origin_x;
+    values.roi_origin_y = stat.roi_origin_y;
+}
+
+
+// the list is built in pool order, only a rebind after a reconnect may change that
+static tcam::mainsrc::buffer_info* find_buffer_info(tcam_pool_state& pool_state,
+                                                    const tcam::ImageBuffer& buffer)
+{
+    const size_t i = buffer.get_pool_index();
+    if (i < pool_state.buffer.size() && pool_state.buffer[i].tcam_buffer.get() == &buffer)
+    {
+        return &pool_state.buffer[i];
+    }
+    for (auto& info : pool_state.buffer)
+    {
+        if (info.tcam_buffer.get() == &buffer)
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+
+static void gst_tcam_buffer_pool_sh_callback(const std::shared_ptr<tcam::ImageBuffer>& buffer,
+                                             void* data)
 {
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(data);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
+    // taken first, everything below only adds to the delay the estimator filters out
+    const uint64_t arrival_ns = state->camera_timestamps_ ? tcam::latency::now_ns() : 0;
+
     if (!state->is_streaming_)
     {
         // requeue the buffer so that the backend does not run out
+        std::scoped_lock lck(state->requeue_mtx_);
         state->sink->requeue_buffer(buffer);
         return;
     }
 
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
+    // copies the image, the buffer is not kept
+    if (state->broadcast_)
+    {
+        state->broadcast_->push_image(buffer);
+    }
 
-    for (auto& info : self->state_->buffer)
+    // the buffer list is only modified while the stream is stopped, so the entry stays valid
+    tcam::mainsrc::buffer_info* entry = find_buffer_info(*self->state_, *buffer);
+    if (!entry)
+    {
+        return;
+    }
+    auto& info = *entry;
+
+    auto stats = buffer->get_statistics();
+    if (state->camera_timestamps_ && stats.camera_time_ns != 0)
+    {
+        std::scoped_lock lck { state->clock_mtx_ };
+        state->clock_estimator_.add_observation(stats.camera_time_ns, arrival_ns);
+    }
+    if (auto values_meta = gst_buffer_get_tcam_statistics_values_meta(info.gst_buffer))
+    {
+        statistics_to_values(stats, values_meta->values);
+    }
+    // compatibility form, only present with statistics-structure=true
+    if (auto meta = gst_buffer_get_tcam_statistics_meta(info.gst_buffer))
     {
-        if (info.tcam_buffer == buffer)
+        if (meta->structure)
         {
-            auto stats = buffer->get_statistics();
-            GstMeta* meta =
-                gst_buffer_get_meta(info.gst_buffer, g_type_from_name("TcamStatisticsMetaApi"));
-            if (meta)
-            {
-                GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+            statistics_to_gst_structure(stats, *meta->structure);
+        }
+    }
 
-                if (struc)
-                {
-                    statistics_to_gst_structure(stats, *struc);
-                }
-            }
+    if (auto chunk_meta = gst_buffer_get_tcam_chunk_data_meta(info.gst_buffer))
+    {
+        // zero copy, the memory is not reused before the GstBuffer is back in the pool
+        const auto chunk_info = buffer->get_chunk_data_info();
+        if (chunk_info.length != 0)
+        {
+            tcam_chunk_data_meta_set_data(
+                chunk_meta,
+                static_cast<const guint8*>(buffer->get_image_buffer_ptr()) + chunk_info.offset,
+                chunk_info.length,
+                chunk_info.is_little_endian);
+        }
+        else
+        {
+            tcam_chunk_data_meta_set_data(chunk_meta, nullptr, 0, FALSE);
+        }
+    }
+
+    if (auto lines_meta = gst_buffer_get_tcam_missing_lines_meta(info.gst_buffer))
+    {
+        const auto& lines = buffer->get_missing_lines();
+        tcam_missing_lines_meta_set(lines_meta,
+                                    lines.data(),
+                                    lines.size(),
+                                    state->format_.get_size().height,
+                                    buffer->get_concealed_line_count());
+    }
 
-            if (stats.is_damaged && !state->drop_incomplete_frames_)
+    if (auto image_meta = gst_buffer_get_tcam_image_statistics_meta(info.gst_buffer))
+    {
+        if (const auto& image_stats = buffer->get_image_statistics())
+        {
+            image_meta->valid = TRUE;
+            image_meta->frame_count = image_stats->frame_count;
+            image_meta->brightness = image_stats->brightness;
+            image_meta->saturated_fraction = image_stats->saturated_fraction;
+            image_meta->mean_r = image_stats->mean_r;
+            image_meta->mean_g = image_stats->mean_g;
+            image_meta->mean_b = image_stats->mean_b;
+            image_meta->sample_count = image_stats->sample_count;
+            image_meta->histogram_count = image_stats->histogram_count;
+            if (image_stats->histogram_count != 0)
             {
-                GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
-                gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
+                std::copy(std::begin(image_stats->histogram),
+                          std::end(image_stats->histogram),
+                          image_meta->histogram);
             }
-            // update the image size
-            // not relevant for bayer
-            // image/jpeg relies on this!
-            gst_buffer_set_size(info.gst_buffer, info.tcam_buffer->get_valid_data_length());
+        }
+        else
+        {
+            tcam_image_statistics_meta_clear(image_meta);
+        }
+    }
 
-            info.pooled = false;
-            state->queue.push(info);
+    if (stats.is_damaged && !state->drop_incomplete_frames_)
+    {
+        GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
+        gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
+    }
+    // update the image size
+    // not relevant for bayer
+    // image/jpeg relies on this!
+    gst_buffer_set_size(info.gst_buffer, info.tcam_buffer->get_valid_data_length());
 
-            state->stream_cv_.notify_all();
-            break;
-        }
+    if (info.detached)
+    {
+        // downstream still holds the GstBuffer of this memory
+        std::scoped_lock lck(state->requeue_mtx_);
+        state->sink->requeue_buffer(buffer);
+        return;
     }
 
-    lck.unlock();
+    info.pooled = false;
+    // only the entry is handed over, the ImageBuffer reference stays in the list
+    if (!state->queue.push(&info))
+    {
+        // cannot happen as long as the ring holds all buffers
+        GST_WARNING_OBJECT(GST_OBJECT(self), "Handoff ring is full. Dropping buffer.");
+        info.pooled = true;
+        std::scoped_lock lck(state->requeue_mtx_);
+        state->sink->requeue_buffer(buffer);
+    }
+    else if (state->metrics_)
+    {
+        state->metrics_->queue_pushed.inc();
+    }
 }
 
 
 static GstFlowReturn gst_tcam_buffer_pool_acquire_buffer(GstBufferPool* pool,
                                                          GstBuffer** buffer,
-                                                         GstBufferPoolAcquireParams* /*params*/)
+                                                         GstBufferPoolAcquireParams* params)
 {
     if (GST_BUFFER_POOL_IS_FLUSHING(pool))
     {
@@ -148,32 +377,35 @@ static GstFlowReturn gst_tcam_buffer_pool_acquire_buffer(GstBufferPool* pool,
 
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
-    while (true)
+
+    tcam::mainsrc::buffer_info* buffer_desc = nullptr;
+    if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT))
     {
-        if (state->queue.empty() && state->is_streaming_)
-        {
-            // wait until new buffer arrives or stop waiting when we have to shut down
-            state->stream_cv_.wait(lck);
-        }
-        if (!state->is_streaming_)
+        // batching in tcammainsrc_create, only takes what has already arrived
+        if (!state->queue.try_pop(buffer_desc))
         {
-            return GST_FLOW_FLUSHING;
+            return GST_FLOW_EOS;
         }
-        if (!state->queue.empty())
-        {
-            auto buffer_desc = state->queue.front();
-            state->queue.pop(); // remove buffer from queue
-            *buffer = buffer_desc.gst_buffer;
+    }
+    // wait until new buffer arrives or stop waiting when we have to shut down
+    else if (!state->queue.pop_wait(buffer_desc, [state] { return !state->is_streaming_; }))
+    {
+        return GST_FLOW_FLUSHING;
+    }
 
-            return GST_FLOW_OK;
-        }
+    *buffer = buffer_desc->gst_buffer;
+
+    if (state->metrics_)
+    {
+        state->metrics_->queue_popped.inc();
     }
 
-    // TOOD: return flushing only when inactive
-    // acquire may block, so we can wait indefinetly
+    // tcammainsrc_create hands the buffer to basesrc for pushing
+    TCAM_USDT_PROBE(gst_push,
+                    buffer_desc->tcam_buffer->get_frame_count(),
+                    buffer_desc->tcam_buffer.get());
 
-    return GST_FLOW_FLUSHING;
+    return GST_FLOW_OK;
 }
 
 
@@ -182,13 +414,28 @@ static void gst_tcam_buffer_pool_release_buffer(GstBufferPool* pool, GstBuffer*
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
+    std::scoped_lock lck(state->requeue_mtx_);
     for (auto& info : self->state_->buffer)
     {
         if (info.gst_buffer == buffer)
         {
             info.pooled = true;
 
+            if (info.detached)
+            {
+                // the reconnected device queued the memory when it was configured
+                info.detached = false;
+                break;
+            }
+
+            TCAM_USDT_PROBE(
+                buffer_release, info.tcam_buffer->get_frame_count(), info.tcam_buffer.get());
+
+            if (state->metrics_)
+            {
+                state->metrics_->buffers_released.inc();
+            }
+
             if (state->sink)
             {
                 state->sink->requeue_buffer(info.tcam_buffer);
@@ -199,7 +446,6 @@ static void gst_tcam_buffer_pool_release_buffer(GstBufferPool* pool, GstBuffer*
             }
         }
     }
-    lck.unlock();
 }
 
 
@@ -210,10 +456,218 @@ static gboolean gst_tcam_buffer_pool_set_config(GstBufferPool* /*bpool*/, GstStr
 }
 
 
-static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
+static GstBuffer* wrap_dmabuf(GstTcamBufferPool* self, const tcam::ImageBuffer& b)
+{
+    if (!self->state_->dmabuf_allocator)
+    {
+        self->state_->dmabuf_allocator = gst_dmabuf_allocator_new();
+    }
+
+    // the GstMemory takes ownership of the fd
+    // the tcam::Memory keeps its own copy for requeueing
+    int fd = dup(b.get_file_descriptor());
+    if (fd < 0)
+    {
+        GST_ERROR_OBJECT(self, "Unable to duplicate dmabuf fd: %s", strerror(errno));
+        return nullptr;
+    }
+
+    GstMemory* mem =
+        gst_dmabuf_allocator_alloc(self->state_->dmabuf_allocator, fd, b.get_image_buffer_size());
+    if (!mem)
+    {
+        GST_ERROR_OBJECT(self, "Unable to create dmabuf memory for fd %d", fd);
+        close(fd);
+        return nullptr;
+    }
+
+    GstBuffer* gst_buffer = gst_buffer_new();
+    gst_buffer_append_memory(gst_buffer, mem);
+
+    return gst_buffer;
+}
+
+
+static void release_imported_buffers(GstTcamBufferPool* self)
+{
+    auto& st = *self->state_;
+
+    // returns them to the downstream pool
+    for (auto* b : st.imported) { gst_buffer_unref(b); }
+    st.imported.clear();
+}
+
+
+/*
+ * Use the memory of the downstream pool as backing for the tcam::BufferPool,
+ * so that the camera writes into memory the consumer already owns.
+ * dmabuf memory is imported when the device supports it, system memory is used as userptr.
+ * Everything else, e.g. GL textures or CUDA device memory, cannot be written by the backends.
+ *
+ * @return false when the downstream buffers cannot be used, nothing is imported in that case
+ */
+static bool import_other_pool(GstTcamBufferPool* self, const tcam::VideoFormat& format, int count)
+{
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
+    auto& st = *self->state_;
+
+    if (!gst_buffer_pool_set_active(self->other_pool_, TRUE))
+    {
+        GST_INFO_OBJECT(self,
+                        "Failed to activate downstream pool. %" GST_PTR_FORMAT,
+                        (void*)self->other_pool_);
+        return false;
+    }
+
+    const size_t required_size = format.get_required_buffer_size();
+    const size_t pitch = required_size / std::max(format.get_size().height, 1u);
+
+    std::vector<int> fds;
+    std::vector<std::pair<void*, size_t>> ptrs;
+
+    auto fail = [self](const char* reason)
+    {
+        GST_INFO_OBJECT(self, "Not using downstream pool: %s", reason);
+        release_imported_buffers(self);
+        gst_buffer_pool_set_active(self->other_pool_, FALSE);
+        return false;
+    };
+
+    for (int i = 0; i < count; ++i)
+    {
+        GstBuffer* buffer = nullptr;
+        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, nullptr) != GST_FLOW_OK)
+        {
+            return fail("unable to acquire enough buffers");
+        }
+        st.imported.push_back(buffer);
+
+        if (gst_buffer_n_memory(buffer) != 1)
+        {
+            return fail("buffers consist of multiple memories");
+        }
+
+        if (auto meta = gst_buffer_get_video_meta(buffer))
+        {
+            if (meta->n_planes != 1 || meta->offset[0] != 0
+                || static_cast<size_t>(meta->stride[0]) != pitch)
+            {
+                return fail("line layout differs from the device");
+            }
+        }
+
+        GstMemory* mem = gst_buffer_peek_memory(buffer, 0);
+        if (gst_memory_get_sizes(mem, nullptr, nullptr) < required_size)
+        {
+            return fail("buffers are too small");
+        }
+
+        if (gst_is_dmabuf_memory(mem) && mem->offset == 0)
+        {
+            fds.push_back(gst_dmabuf_memory_get_fd(mem));
+        }
+        else if (gst_memory_is_type(mem, GST_ALLOCATOR_SYSMEM))
+        {
+            // system memory does not move, the pointer stays valid after unmapping.
+            // Keeping it mapped for writing would prevent downstream from mapping
+            // the memory once it is also part of the pushed buffer.
+            GstMapInfo info;
+            if (!gst_memory_map(mem, &info, GST_MAP_READWRITE))
+            {
+                return fail("unable to map memory");
+            }
+            ptrs.push_back({ info.data, info.size });
+            gst_memory_unmap(mem, &info);
+        }
+        else
+        {
+            return fail("memory type can not be written by the device");
+        }
+    }
+
+    if (!fds.empty() && !ptrs.empty())
+    {
+        return fail("mixed memory types");
+    }
+
+    const auto type = fds.empty() ? tcam::TCAM_MEMORY_TYPE_USERPTR : tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
+    auto allocator = state->get_allocator(type);
+    auto types = allocator->get_supported_memory_types();
+    if (std::find(types.begin(), types.end(), type) == types.end())
+    {
+        return fail("device does not support the memory type");
+    }
+
+    state->buffer_pool = std::make_shared<tcam::BufferPool>(type, allocator);
+
+    auto res = fds.empty() ? state->buffer_pool->import_userptr(format, ptrs) :
+                             state->buffer_pool->import_dma(format, fds);
+    if (!res)
+    {
+        state->buffer_pool.reset();
+        return fail(res.error().message().c_str());
+    }
+
+    GST_INFO_OBJECT(self,
+                    "Importing %d %s buffers from downstream pool %" GST_PTR_FORMAT,
+                    count,
+                    fds.empty() ? "system memory" : "dmabuf",
+                    (void*)self->other_pool_);
+    return true;
+}
+
+
+// the lines of the tcam buffers are not padded, unlike the default layout that GstVideoInfo assumes
+static void add_video_meta(GstTcamBufferPool* self,
+                           GstBuffer* gst_buffer,
+                           const GstVideoInfo& info,
+                           const tcam::VideoFormat& format)
+{
+    gsize offset[GST_VIDEO_MAX_PLANES] = {};
+    gint stride[GST_VIDEO_MAX_PLANES] = {};
+
+    const guint n_planes = GST_VIDEO_INFO_N_PLANES(&info);
+    if (n_planes == 1)
+    {
+        stride[0] = format.get_pitch_size();
+    }
+    else if (GST_VIDEO_INFO_SIZE(&info) == format.get_required_buffer_size())
+    {
+        for (guint i = 0; i < n_planes; ++i)
+        {
+            offset[i] = GST_VIDEO_INFO_PLANE_OFFSET(&info, i);
+            stride[i] = GST_VIDEO_INFO_PLANE_STRIDE(&info, i);
+        }
+    }
+    else
+    {
+        GST_DEBUG_OBJECT(
+            self, "Plane layout of %s is unknown, no video meta", format.to_string().c_str());
+        return;
+    }
+
+    GstVideoMeta* meta = gst_buffer_add_video_meta_full(gst_buffer,
+                                                        GST_VIDEO_FRAME_FLAG_NONE,
+                                                        GST_VIDEO_INFO_FORMAT(&info),
+                                                        GST_VIDEO_INFO_WIDTH(&info),
+                                                        GST_VIDEO_INFO_HEIGHT(&info),
+                                                        n_planes,
+                                                        offset,
+                                                        stride);
+    if (meta)
+    {
+        meta->meta.flags = static_cast<GstMetaFlags>(meta->meta.flags | GST_META_FLAG_POOLED);
+    }
+}
+
+
+// video_info is nullptr when the buffers get no GstVideoMeta
+// @return false when a buffer cannot be exported as dmabuf
+static bool prepare_gst_buffer_pool(GstTcamBufferPool* self, const GstVideoInfo* video_info)
 {
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
+    const bool use_dmabuf = state->buffer_pool->get_memory_type() == tcam::TCAM_MEMORY_TYPE_DMA;
 
     auto tcam_buffers = state->buffer_pool->get_buffer();
 
@@ -224,24 +678,110 @@ static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
             void* address = b->get_image_buffer_ptr();
             size_t size = b->get_image_buffer_size();
 
+            GstBuffer* gst_buffer = nullptr;
 
-            GstBuffer* gst_buffer = gst_buffer_new_wrapped_full(
-                static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
+            if (b->get_pool_index() < self->state_->imported.size())
+            {
+                // downstream gets its own memory back
+                GstBuffer* imported = self->state_->imported.at(b->get_pool_index());
+
+                gst_buffer = gst_buffer_new();
+                gst_buffer_append_memory(gst_buffer,
+                                         gst_memory_ref(gst_buffer_peek_memory(imported, 0)));
+            }
+            else if (use_dmabuf)
+            {
+                // io-mode=dmabuf was requested explicitly,
+                // handing out system memory instead would break DMABuf caps downstream
+                if (b->get_file_descriptor() < 0)
+                {
+                    GST_ERROR_OBJECT(self,
+                                     "Buffer %zu has no dmabuf fd, the device did not export it.",
+                                     b->get_pool_index());
+                    return false;
+                }
+                gst_buffer = wrap_dmabuf(self, *b);
+                if (!gst_buffer)
+                {
+                    return false;
+                }
+            }
+
+            if (!gst_buffer)
+            {
+                gst_buffer = gst_buffer_new_wrapped_full(
+                    static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
+            }
 
             gst_buffer_set_flags(gst_buffer, GST_BUFFER_FLAG_LIVE);
 
-            // TODO: check config and add meta data that is listed there
-            GstStructure* struc = gst_structure_new_empty("TcamStatistics");
-            auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, struc);
+            auto mark_pooled = [](GstMeta* m)
+            {
+                m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+            };
 
-            if (!meta)
+            if (auto values_meta = gst_buffer_add_tcam_statistics_values_meta(gst_buffer))
             {
-                GST_WARNING_OBJECT(self, "Unable to add meta!");
+                mark_pooled(&values_meta->meta);
             }
             else
             {
-                auto m = (GstMeta*)meta;
-                m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+                GST_WARNING_OBJECT(self, "Unable to add meta!");
+            }
+
+            // filling a GstStructure per frame is expensive, so that is opt-in
+            if (state->statistics_structure_)
+            {
+                GstStructure* struc = gst_structure_new_empty("TcamStatistics");
+                if (auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, struc))
+                {
+                    mark_pooled(&meta->meta);
+                }
+                else
+                {
+                    GST_WARNING_OBJECT(self, "Unable to add meta!");
+                }
+            }
+
+            if (state->chunk_data_)
+            {
+                if (auto chunk_meta = gst_buffer_add_tcam_chunk_data_meta(gst_buffer))
+                {
+                    mark_pooled(&chunk_meta->meta);
+                }
+                else
+                {
+                    GST_WARNING_OBJECT(self, "Unable to add meta!");
+                }
+            }
+
+            if (state->salvage_options_.report_missing_lines)
+            {
+                if (auto lines_meta = gst_buffer_add_tcam_missing_lines_meta(gst_buffer))
+                {
+                    mark_pooled(&lines_meta->meta);
+                }
+                else
+                {
+                    GST_WARNING_OBJECT(self, "Unable to add meta!");
+                }
+            }
+
+            if (state->image_statistics_)
+            {
+                if (auto image_meta = gst_buffer_add_tcam_image_statistics_meta(gst_buffer))
+                {
+                    mark_pooled(&image_meta->meta);
+                }
+                else
+                {
+                    GST_WARNING_OBJECT(self, "Unable to add meta!");
+                }
+            }
+
+            if (video_info)
+            {
+                add_video_meta(self, gst_buffer, *video_info, state->format_);
             }
 
             tcam::mainsrc::buffer_info info;
@@ -253,6 +793,12 @@ static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
             self->state_->buffer.push_back(info);
         }
     }
+
+    if (state->metrics_)
+    {
+        state->metrics_->pool_size.set(self->state_->buffer.size());
+    }
+    return true;
 }
 
 
@@ -265,27 +811,6 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-    if (self->other_pool_)
-    {
-        GstBuffer* buffer = nullptr;
-        if (!gst_buffer_pool_set_active(self->other_pool_, TRUE))
-        {
-            GST_ERROR_OBJECT(self,
-                             "Failed to activate downstream pool. %" GST_PTR_FORMAT,
-                             (void*)self->other_pool_);
-            return FALSE;
-        }
-        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, NULL) != GST_FLOW_OK)
-        {
-            GST_ERROR_OBJECT(self,
-                             "Failed to import buffer from downstream pool. %" GST_PTR_FORMAT,
-                             (void*)self->other_pool_);
-            return FALSE;
-        }
-
-        gst_buffer_unref(buffer);
-    }
-
     GstStructure* config = gst_buffer_pool_get_config(pool);
     GstCaps* caps = nullptr;
     unsigned int size;
@@ -297,7 +822,6 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
         return false;
     }
 
-    auto dev = state->device_;
 
     tcam::TCAM_MEMORY_TYPE buffer_type = tcam::mainsrc::io_mode_to_memory_type(state->io_mode_);
 
@@ -305,26 +829,54 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
 
     tcam::mainsrc::caps_to_format(*caps, format);
 
-    state->buffer_pool = std::make_shared<tcam::BufferPool>(buffer_type, dev->get_allocator());
+    if (state->active_buffers_ <= 0)
+    {
+        state->active_buffers_ = state->calc_buffer_count(format.framerate, 0, 0);
+    }
 
-    auto alloc_res =
-        state->buffer_pool->configure(tcam::VideoFormat(format), state->imagesink_buffers_);
+    // memory of a user allocator is preferred over the memory of downstream
+    const bool imported =
+        self->other_pool_ && !state->user_allocator_
+        && import_other_pool(self, tcam::VideoFormat(format), state->active_buffers_);
 
-    if (!alloc_res)
+    if (!imported)
     {
-        GST_ERROR("%s", alloc_res.error().message().c_str());
-        GST_ERROR_OBJECT(self, "%s", alloc_res.error().message().c_str());
-        return FALSE;
+        // keep the pool over restarts and renegotiation,
+        // it reuses its memory when the new format fits
+        // the pool is reset when the device or the allocator options change
+        // imported memory belongs to downstream and is never reused
+        if (!state->buffer_pool || state->buffer_pool->get_memory_type() != buffer_type
+            || state->buffer_pool_imported_)
+        {
+            state->buffer_pool =
+                std::make_shared<tcam::BufferPool>(buffer_type, state->get_allocator(buffer_type));
+        }
+
+        auto alloc_res =
+            state->buffer_pool->configure(tcam::VideoFormat(format), state->active_buffers_);
+
+        if (!alloc_res)
+        {
+            GST_ERROR("%s", alloc_res.error().message().c_str());
+            GST_ERROR_OBJECT(self, "%s", alloc_res.error().message().c_str());
+            return FALSE;
+        }
     }
+    state->buffer_pool_imported_ = imported;
 
-    // prefer user config
+    // the count is decided in decide_allocation
     // we do not want to allocate new buffers while running
     // and we have no reason to
-    min_buffers = state->imagesink_buffers_;
-    max_buffers = state->imagesink_buffers_;
+    min_buffers = state->active_buffers_;
+    max_buffers = state->active_buffers_;
 
     gst_buffer_pool_config_set_params(config, caps, size, min_buffers, max_buffers);
 
+    // fails for bayer and jpeg, these have no GstVideoMeta
+    GstVideoInfo video_info;
+    const bool with_video_meta =
+        state->downstream_video_meta_ && gst_video_info_from_caps(&video_info, caps);
+
     gst_structure_free(config);
 
     // do not flush pool
@@ -339,11 +891,61 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
     };
 
 
+    state->queue.reset(state->active_buffers_);
+
     state->sink =
-        std::make_shared<tcam::ImageSink>(cb_func, state->format_, state->imagesink_buffers_);
+        std::make_shared<tcam::ImageSink>(cb_func, state->format_, state->active_buffers_);
+    if (state->emit_frame_progress_)
+    {
+        auto src = GST_TCAM_MAINSRC(self->src_element);
+        state->sink->set_partial_image_callback(
+            [src](const std::shared_ptr<tcam::ImageBuffer>& buffer, unsigned int lines)
+            { gst_tcam_mainsrc_emit_frame_progress(src, buffer->get_image_buffer_ptr(), lines); });
+    }
+    if (state->emit_frame_incoming_)
+    {
+        auto src = GST_TCAM_MAINSRC(self->src_element);
+        state->sink->set_frame_incoming_callback(
+            [src](uint64_t sequence, uint64_t timestamp_ns)
+            { gst_tcam_mainsrc_emit_frame_incoming(src, sequence, timestamp_ns); });
+    }
     state->configure_stream();
 
-    prepare_gst_buffer_pool(self);
+    if (!prepare_gst_buffer_pool(self, with_video_meta ? &video_info : nullptr))
+    {
+        GST_ELEMENT_ERROR(self->src_element,
+                          RESOURCE,
+                          FAILED,
+                          ("Unable to export the buffers as dmabuf."),
+                          ("io-mode=dmabuf requires a device that supports dmabuf export."));
+        gst_tcam_buffer_pool_delete_buffer(self);
+        return FALSE;
+    }
+
+    state->broadcast_.reset();
+    if (!state->broadcast_name_.empty())
+    {
+        auto broadcast = tcam::BroadcastSink::create(state->broadcast_name_, state->format_);
+        if (broadcast)
+        {
+            state->broadcast_ = broadcast.value();
+        }
+        else
+        {
+            GST_ELEMENT_WARNING(self->src_element,
+                                RESOURCE,
+                                OPEN_WRITE,
+                                ("Unable to broadcast as '%s': %s",
+                                 state->broadcast_name_.c_str(),
+                                 broadcast.error().message().c_str()),
+                                (NULL));
+        }
+    }
+
+    {
+        std::scoped_lock lck { state->clock_mtx_ };
+        state->clock_estimator_.reset();
+    }
 
     state->start_stream();
     return TRUE;
@@ -361,7 +963,16 @@ static gboolean gst_tcam_buffer_pool_stop(GstBufferPool* pool)
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
     state->stop_stream();
-    state->stream_cv_.notify_all();
+    state->queue.notify();
+
+    // consumers see the end of the stream
+    state->broadcast_.reset();
+
+    GST_INFO_OBJECT(self,
+                    "Buffer handoff stalls: %" G_GUINT64_FORMAT " full, %" G_GUINT64_FORMAT
+                    " empty",
+                    state->queue.full_stalls(),
+                    state->queue.empty_stalls());
 
     return TRUE;
 }
@@ -377,13 +988,46 @@ void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self)
     }
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-    auto res = state->buffer_pool->clear();
-    if (!res)
+    // the handoff ring points into the list, the stream is stopped, so nothing pushes
+    tcam::mainsrc::buffer_info* pending = nullptr;
+    while (state->queue.try_pop(pending))
     {
-        GST_ERROR("Error while dealing with buffer pool: %s", res.as_failure().error().message().c_str());
     }
+
+    // memory stays with the pool for the next start
+    state->buffer_pool->release_buffer();
     self->state_->buffer.clear();
-    state->device_->free_stream();
+    if (state->device_)
+    {
+        state->device_->free_stream();
+    }
+
+    release_imported_buffers(self);
+}
+
+
+void gst_tcam_buffer_pool_rebind_buffer(GstTcamBufferPool* self)
+{
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
+
+    for (auto& tb : state->buffer_pool->get_buffer())
+    {
+        auto b = tb.lock();
+        if (!b)
+        {
+            continue;
+        }
+
+        for (auto& info : self->state_->buffer)
+        {
+            if (info.addr == b->get_image_buffer_ptr())
+            {
+                info.tcam_buffer = b;
+                info.detached = !info.pooled;
+                break;
+            }
+        }
+    }
 }
 
 
@@ -393,6 +1037,23 @@ static void gst_tcam_buffer_pool_dispose(GObject* object)
 
     auto self = GST_TCAM_BUFFER_POOL(object);
 
+    if (self->state_ && self->state_->dmabuf_allocator)
+    {
+        gst_object_unref(self->state_->dmabuf_allocator);
+        self->state_->dmabuf_allocator = nullptr;
+    }
+
+    if (self->state_)
+    {
+        release_imported_buffers(self);
+    }
+
+    if (self->other_pool_)
+    {
+        gst_object_unref(self->other_pool_);
+        self->other_pool_ = nullptr;
+    }
+
     delete self->state_;
     self->state_ = nullptr;
 
@@ -60,4 +60,8 @@ void gst_tcam_buffer_pool_set_other_pool(GstTcamBufferPool* pool, GstBufferPool*
 
 void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self);
 
+// point the GstBuffers at the tcam::ImageBuffers of a reconfigured device
+// the memory has to be the same, caller holds device_state::requeue_mtx_
+void gst_tcam_buffer_pool_rebind_buffer(GstTcamBufferPool* self);
+
 G_END_DECLS
@@ -19,16 +19,21 @@
 #include "../../../libs/gst-helper/include/tcamprop1.0_gobject/tcam_property_serialize.h"
 #include "../../../libs/tcam-property/src/tcam-property-1.0.h"
 #include "../../logging.h"
+#include "../../scope_tracing.h"
+#include "../../utils.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgststrings.h"
 #include "gst/gstvalue.h"
+#include <gst/allocators/gstdmabuf.h>
+#include <gst/video/gstvideometa.h>
 #include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
 #include "gsttcambufferpool.h"
 #include "mainsrc_device_state.h"
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
+#include "tcamuserallocator.h"
 
-#define GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS 10
+#define GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS -1
 
 GST_DEBUG_CATEGORY(tcam_mainsrc_debug);
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
@@ -39,6 +44,19 @@ struct destroy_transfer
     std::shared_ptr<tcam::ImageBuffer> ptr;
 };
 
+void gst_tcam_mainsrc_emit_frame_progress(GstTcamMainSrc* self, gpointer data, guint lines)
+{
+    g_signal_emit(G_OBJECT(self), gst_tcammainsrc_signals[SIGNAL_FRAME_PROGRESS], 0, data, lines);
+}
+
+void gst_tcam_mainsrc_emit_frame_incoming(GstTcamMainSrc* self,
+                                          guint64 sequence,
+                                          guint64 timestamp_ns)
+{
+    g_signal_emit(
+        G_OBJECT(self), gst_tcammainsrc_signals[SIGNAL_FRAME_INCOMING], 0, sequence, timestamp_ns);
+}
+
 static void gst_tcam_mainsrc_close_camera(GstTcamMainSrc* self);
 
 G_DEFINE_TYPE_WITH_CODE(GstTcamMainSrc,
@@ -58,7 +76,7 @@ GType gst_tcam_io_mode_get_type(void)
             { GST_TCAM_IO_AUTO, "GST_TCAM_IO_AUTO", "auto" },
             { GST_TCAM_IO_MMAP, "GST_TCAM_IO_MMAP", "mmap" },
             { GST_TCAM_IO_USERPTR, "GST_TCAM_IO_USERPTR", "userptr" },
-            //{ GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
+            { GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
             //{ GST_TCAM_IO_DMABUF_IMPORT, "GST_TCAM_IO_DMABUF_IMPORT", "dmabuf-import" },
 
             { 0, NULL, NULL }
@@ -69,10 +87,34 @@ GType gst_tcam_io_mode_get_type(void)
 }
 
 
+GType gst_tcam_timestamp_mode_get_type(void)
+{
+    static GType tcam_timestamp_mode = 0;
+
+    if (!tcam_timestamp_mode)
+    {
+        static const GEnumValue timestamp_modes[] = {
+            { GST_TCAM_TIMESTAMP_ARRIVAL, "GST_TCAM_TIMESTAMP_ARRIVAL", "arrival" },
+            { GST_TCAM_TIMESTAMP_CAMERA, "GST_TCAM_TIMESTAMP_CAMERA", "camera" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_timestamp_mode = g_enum_register_static("GstTcamTimestampMode", timestamp_modes);
+    }
+    return tcam_timestamp_mode;
+}
+
+
 enum
 {
     SIGNAL_DEVICE_OPEN,
     SIGNAL_DEVICE_CLOSE,
+    SIGNAL_BEGIN_PROPERTY_BATCH,
+    SIGNAL_END_PROPERTY_BATCH,
+    SIGNAL_PROPERTIES_CHANGED,
+    SIGNAL_FRAME_PROGRESS,
+    SIGNAL_FRAME_INCOMING,
+    SIGNAL_MOVE_ROI,
     SIGNAL_LAST,
 };
 
@@ -82,10 +124,49 @@ enum
     PROP_SERIAL,
     PROP_DEVICE_TYPE,
     PROP_CAMERA_BUFFERS,
+    PROP_LOW_MEMORY,
+    PROP_MEMORY_USAGE,
     PROP_NUM_BUFFERS,
     PROP_IO_MODE,
     PROP_DROP_INCOMPLETE_BUFFER,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_HUGE_PAGES,
+    PROP_NUMA_NODE,
+    PROP_NUMA_LOCALITY,
+    PROP_NUMA_PLACEMENT,
+    PROP_PREFAULT_BUFFERS,
+    PROP_USER_ALLOCATOR,
+    PROP_LATENCY_STATISTICS,
+    PROP_STATISTICS_STRUCTURE,
+    PROP_CHUNK_DATA,
+    PROP_MISSING_LINES,
+    PROP_CONCEAL_MAX_LINES,
+    PROP_IMAGE_STATISTICS,
+    PROP_IMAGE_STATISTICS_HISTOGRAM,
+    PROP_AUTO_GROUP,
+    PROP_AUTO_GROUP_MASTER,
+    PROP_DECIMATION,
+    PROP_DECIMATION_MAX_RATE,
+    PROP_DECIMATION_AUTO_INTERVAL,
+    PROP_TRANSPORT_STATISTICS,
+    PROP_SOCKET_BUFFER_SIZE,
+    PROP_PACKET_TIMEOUT,
+    PROP_FRAME_RETENTION,
+    PROP_PACKET_SOCKET,
+    PROP_USB_TRANSFER_COUNT,
+    PROP_USB_TRANSFER_SIZE,
+    PROP_THREAD_CONFIG,
+    PROP_BROADCAST,
+    PROP_TIMESTAMP_MODE,
+    PROP_PROPERTY_NOTIFY_INTERVAL,
+    PROP_RECONNECT_TIMEOUT,
+    PROP_DEVICE_EVENTS,
+    PROP_HEARTBEAT_TIMEOUT,
+    PROP_EMIT_FRAME_PROGRESS,
+    PROP_EMIT_FRAME_INCOMING,
+    PROP_BATCH_SIZE,
+    PROP_BATCH_TIMEOUT,
+    PROP_ASYNC_OPEN,
 };
 
 static guint gst_tcammainsrc_signals[SIGNAL_LAST] = {
@@ -294,6 +375,27 @@ static GstCaps* gst_tcam_mainsrc_get_caps(GstBaseSrc* src, GstCaps* filter __att
         GST_WARNING_OBJECT(self, "Device not initialized. Must be in state >= GST_STATE_READY.");
         return nullptr;
     }
+
+    if (self->device->io_mode_ == GST_TCAM_IO_DMABUF)
+    {
+        // buffers will be GstDmaBufMemory, which can also be mapped as system memory
+        // offer the DMABuf variant first, so that downstream that can import it does so,
+        // and keep the system memory structures for everything else
+        GstCaps* with_dmabuf = gst_caps_new_empty();
+        for (guint i = 0; i < gst_caps_get_size(caps); ++i)
+        {
+            const GstStructure* struc = gst_caps_get_structure(caps, i);
+            gst_caps_append_structure_full(
+                with_dmabuf,
+                gst_structure_copy(struc),
+                gst_caps_features_new(GST_CAPS_FEATURE_MEMORY_DMABUF, nullptr));
+            gst_caps_append_structure_full(with_dmabuf,
+                                           gst_structure_copy(struc),
+                                           gst_caps_features_copy(gst_caps_get_features(caps, i)));
+        }
+        gst_caps_unref(caps);
+        caps = with_dmabuf;
+    }
     return caps;
 }
 
@@ -359,23 +461,13 @@ static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info*
         return;
     }
 
-    auto serial = self->device->get_device_serial();
-
-    // set serial as args entry and in actual message
-    // that way users have multiple ways of accessing the serial
-    GST_ELEMENT_ERROR_WITH_DETAILS(GST_ELEMENT(self),
-                                   RESOURCE,
-                                   NOT_FOUND,
-                                   ("Device lost (%s)", serial.c_str()),
-                                   ((nullptr)),
-                                   ("serial", G_TYPE_STRING, serial.c_str(), nullptr));
-
-    self->device->is_streaming_ = false;
+    // with reconnect-timeout the pipeline keeps running while the device is reopened
+    if (self->device->begin_reconnect())
+    {
+        return;
+    }
 
-    // the device is considered lost.
-    // might as well inform via all possible channels to keep
-    // property queries, etc from appearing while everything is shutting down
-    g_signal_emit(G_OBJECT(self), gst_tcammainsrc_signals[SIGNAL_DEVICE_CLOSE], 0);
+    self->device->report_device_lost(self->device->get_device_serial());
 
     // do not send EOS here
     // this can cause a deadlock in the tcambin state handling
@@ -401,8 +493,8 @@ static bool gst_tcam_mainsrc_init_camera(GstTcamMainSrc* self)
 
     // this cb will automatically be deleted once the device is closed
     // no need for explicit cleanup
-    self->device->device_->register_device_lost_callback(gst_tcam_mainsrc_device_lost_callback,
-                                                         self);
+    // a reconnected device gets it as well
+    self->device->set_device_lost_callback(gst_tcam_mainsrc_device_lost_callback, self);
 
     // emit a signal to let other elements/users know that a device has been opened
     // and properties, etc are now usable
@@ -411,8 +503,31 @@ static bool gst_tcam_mainsrc_init_camera(GstTcamMainSrc* self)
     return true;
 }
 
+// thread of device_state::begin_async_open
+// the state change already returned, the result is posted as 'tcam-device-open'
+static bool gst_tcam_mainsrc_async_open_camera(GstTcamMainSrc* self)
+{
+    const bool opened = gst_tcam_mainsrc_init_camera(self);
+
+    const auto serial = self->device->get_device_serial();
+    auto strct = gst_structure_new("tcam-device-open",
+                                   "serial",
+                                   G_TYPE_STRING,
+                                   serial.c_str(),
+                                   "opened",
+                                   G_TYPE_BOOLEAN,
+                                   opened,
+                                   nullptr);
+    gst_element_post_message(GST_ELEMENT(self), gst_message_new_element(GST_OBJECT(self), strct));
+
+    return opened;
+}
+
 static void gst_tcam_mainsrc_close_camera(GstTcamMainSrc* self)
 {
+    // an open that is still running would fill the device_state again
+    self->device->finish_async_open();
+
     g_signal_emit(G_OBJECT(self), gst_tcammainsrc_signals[SIGNAL_DEVICE_CLOSE], 0);
 
     self->device->close();
@@ -431,7 +546,14 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         {
             if (!self->device->is_device_open())
             {
-                if (!gst_tcam_mainsrc_init_camera(self))
+                if (self->device->async_open_)
+                {
+                    // other elements can open their devices meanwhile
+                    // READY_TO_PAUSED and property access wait for the open
+                    self->device->begin_async_open(
+                        [self] { return gst_tcam_mainsrc_async_open_camera(self); });
+                }
+                else if (!gst_tcam_mainsrc_init_camera(self))
                 {
                     return GST_STATE_CHANGE_FAILURE;
                 }
@@ -440,6 +562,12 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         }
         case GST_STATE_CHANGE_READY_TO_PAUSED:
         {
+            self->device->wait_for_async_open();
+            if (!self->device->is_device_open())
+            {
+                // 'async-open' failed, the error has been posted by the open
+                return GST_STATE_CHANGE_FAILURE;
+            }
             self->device->n_buffers_delivered_ = 0;
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
@@ -447,7 +575,7 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
         {
             self->device->is_streaming_ = true;
-            self->device->stream_cv_.notify_all();
+            self->device->queue.notify();
             break;
         }
         default:
@@ -470,14 +598,16 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
         {
             self->device->is_streaming_ = false;
-            self->device->stream_cv_.notify_all();
+            self->device->queue.notify();
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
         case GST_STATE_CHANGE_PAUSED_TO_READY:
         {
-            bool stop_ret = self->device->device_->stop_stream();
-            if (!stop_ret)
+            // a reconnect would start the stream again
+            self->device->cancel_reconnect();
+
+            if (self->device->device_ && !self->device->device_->stop_stream())
             {
                 GST_ERROR("Could not stop stream.");
             }
@@ -503,6 +633,7 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         }
         case GST_STATE_CHANGE_READY_TO_NULL:
         {
+            self->device->finish_async_open();
             if (self->device->is_device_open())
             {
                 gst_tcam_mainsrc_close_camera(self);
@@ -517,8 +648,177 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
 }
 
 
+// timestamp-mode=camera, without a camera time base src stamps the buffer
+static void set_camera_timestamp(GstTcamMainSrc* self, GstBuffer* buffer)
+{
+    auto values_meta = gst_buffer_get_tcam_statistics_values_meta(buffer);
+    if (!values_meta || values_meta->values.camera_time_ns == 0)
+    {
+        GST_DEBUG_OBJECT(self, "No camera time, using the arrival time");
+        return;
+    }
+
+    std::optional<uint64_t> capture_host_ns;
+    {
+        std::scoped_lock lck { self->device->clock_mtx_ };
+        capture_host_ns = self->device->clock_estimator_.to_host(values_meta->values.camera_time_ns);
+    }
+
+    GstClock* clock = gst_element_get_clock(GST_ELEMENT(self));
+    if (!capture_host_ns || !clock)
+    {
+        if (clock)
+        {
+            gst_object_unref(clock);
+        }
+        return;
+    }
+
+    // the estimate is in CLOCK_MONOTONIC, the pipeline clock may be a different one
+    const GstClockTime clock_now = gst_clock_get_time(clock);
+    const auto age = static_cast<int64_t>(tcam::latency::now_ns() - *capture_host_ns);
+    gst_object_unref(clock);
+
+    const auto capture_time = static_cast<int64_t>(clock_now) - age;
+    const auto base_time = static_cast<int64_t>(gst_element_get_base_time(GST_ELEMENT(self)));
+
+    const GstClockTime pts = capture_time > base_time ? capture_time - base_time : 0;
+    GST_BUFFER_PTS(buffer) = pts;
+    GST_BUFFER_DTS(buffer) = pts;
+}
+
+
+static void emit_properties_changed(GstTcamMainSrc* self)
+{
+    auto names = self->device->collect_property_changes();
+    if (names.empty())
+    {
+        return;
+    }
+
+    std::vector<const gchar*> strv;
+    strv.reserve(names.size() + 1);
+    for (const auto& n : names) { strv.push_back(n.c_str()); }
+    strv.push_back(nullptr);
+
+    g_signal_emit(G_OBJECT(self), gst_tcammainsrc_signals[SIGNAL_PROPERTIES_CHANGED], 0, strv.data());
+}
+
+
+// timestamp-mode=arrival in a batch, basesrc would only stamp the first buffer of a list
+static void set_arrival_timestamp(GstTcamMainSrc* self, GstBuffer* buffer)
+{
+    GstClock* clock = gst_element_get_clock(GST_ELEMENT(self));
+    if (!clock)
+    {
+        return;
+    }
+    const GstClockTime clock_now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    const GstClockTime base_time = gst_element_get_base_time(GST_ELEMENT(self));
+
+    const GstClockTime pts = clock_now > base_time ? clock_now - base_time : 0;
+    GST_BUFFER_PTS(buffer) = pts;
+    GST_BUFFER_DTS(buffer) = pts;
+}
+
+
+// everything a buffer needs before it is pushed, except the push time stamps
+static void prepare_buffer(GstTcamMainSrc* self, GstBuffer* buffer, bool in_batch)
+{
+    if (self->device->camera_timestamps_)
+    {
+        set_camera_timestamp(self, buffer);
+    }
+    else if (in_batch && gst_base_src_get_do_timestamp(GST_BASE_SRC(self)))
+    {
+        set_arrival_timestamp(self, buffer);
+    }
+
+    if (self->device->discont_pending_.exchange(false))
+    {
+        // first buffer of a reconnected device
+        GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+    }
+}
+
+
+static void set_push_time(GstTcamMainSrc* self, GstBuffer* buffer, uint64_t gst_push_ns)
+{
+    if (auto values_meta = gst_buffer_get_tcam_statistics_values_meta(buffer))
+    {
+        values_meta->values.gst_push_time_ns = gst_push_ns;
+        self->device->add_latency_sample(values_meta->values);
+    }
+    if (auto meta = gst_buffer_get_tcam_statistics_meta(buffer); meta && meta->structure)
+    {
+        gst_structure_set(meta->structure, "gst_push_time_ns", G_TYPE_UINT64, gst_push_ns, nullptr);
+    }
+}
+
+
+static bool is_buffer_limit_reached(const device_state& state)
+{
+    return state.n_buffers_ != -1 && state.n_buffers_delivered_ >= (guint)state.n_buffers_;
+}
+
+
+/*
+ * Collects frames following first until batch-size frames are together or batch-timeout has passed.
+ * Only frames that arrive in time are taken, the list never waits for a frame it could push later.
+ * At most all but one camera buffer are held, so that the device can always fill one.
+ */
+static GstBufferList* collect_batch(GstTcamMainSrc* self, GstBufferPool* pool, GstBuffer* first)
+{
+    TCAM_TRACE_SCOPE("tcammainsrc collect_batch");
+
+    auto& state = *self->device;
+
+    guint batch_size = state.batch_size_;
+    if (state.active_buffers_ > 1)
+    {
+        batch_size = std::min(batch_size, static_cast<guint>(state.active_buffers_ - 1));
+    }
+
+    GstBufferList* list = gst_buffer_list_new_sized(batch_size);
+    gst_buffer_list_add(list, first);
+
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::microseconds(state.batch_timeout_us_);
+
+    GstBufferPoolAcquireParams params = {};
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+
+    while (gst_buffer_list_length(list) < batch_size && !is_buffer_limit_reached(state))
+    {
+        GstBuffer* buffer = nullptr;
+        const GstFlowReturn ret = gst_buffer_pool_acquire_buffer(pool, &buffer, &params);
+        if (ret == GST_FLOW_OK && buffer)
+        {
+            if (state.n_buffers_ != -1)
+            {
+                state.n_buffers_delivered_++;
+            }
+            prepare_buffer(self, buffer, true);
+            gst_buffer_list_add(list, buffer);
+            continue;
+        }
+        // EOS is the empty queue of DONTWAIT, anything else ends the batch
+        if (ret != GST_FLOW_EOS
+            || !state.queue.wait_until(deadline, [&state] { return !state.is_streaming_; }))
+        {
+            break;
+        }
+    }
+    return list;
+}
+
+
 static GstFlowReturn gst_tcam_mainsrc_create(GstPushSrc* push_src, GstBuffer** buffer)
 {
+    TCAM_TRACE_SCOPE("tcammainsrc create");
+
     GstTcamMainSrc* self = GST_TCAM_MAINSRC(push_src);
 
     if (self->device->n_buffers_ != -1)
@@ -526,7 +826,7 @@ static GstFlowReturn gst_tcam_mainsrc_create(GstPushSrc* push_src, GstBuffer** b
         /*
               TODO: self->n_buffers should have same type as ptr->get_statistics().frame_count
             */
-        if (self->device->n_buffers_delivered_ >= (guint)self->device->n_buffers_)
+        if (is_buffer_limit_reached(*self->device))
         {
             GST_INFO_OBJECT(
                 self,
@@ -541,6 +841,7 @@ start_create:
 
     GstBufferPool* src_pool = gst_base_src_get_buffer_pool(GST_BASE_SRC(push_src));
 
+    GstBufferList* batch = nullptr;
     if (src_pool)
     {
         // this blocks until we get a buffer
@@ -556,8 +857,35 @@ start_create:
             goto start_create;
         }
 
+        prepare_buffer(self, *buffer, self->device->batch_size_ > 1);
+
+        if (self->device->batch_size_ > 1)
+        {
+            batch = collect_batch(self, src_pool, *buffer);
+        }
+
         gst_object_unref(src_pool);
     }
+
+    emit_properties_changed(self);
+
+    if (tcam::latency::is_enabled())
+    {
+        const uint64_t gst_push_ns = tcam::latency::now_ns();
+
+        if (batch)
+        {
+            const guint length = gst_buffer_list_length(batch);
+            for (guint i = 0; i < length; ++i)
+            {
+                set_push_time(self, gst_buffer_list_get(batch, i), gst_push_ns);
+            }
+        }
+        else
+        {
+            set_push_time(self, *buffer, gst_push_ns);
+        }
+    }
     /* TODO: check why aravis throws an incomplete buffer error
        but the received images are still valid */
     // if (!tcam::is_image_buffer_complete(self->ptr))
@@ -567,6 +895,19 @@ start_create:
     //     goto wait_again;
     // }
 
+    if (batch && gst_buffer_list_length(batch) > 1)
+    {
+        // basesrc pushes the list with a single gst_pad_push_list
+        gst_base_src_submit_buffer_list(GST_BASE_SRC(push_src), batch);
+        *buffer = nullptr;
+    }
+    else if (batch)
+    {
+        // nothing else arrived in time, the list only holds a reference to *buffer
+        gst_buffer_ref(*buffer);
+        gst_buffer_list_unref(batch);
+    }
+
     return GST_FLOW_OK;
 }
 
@@ -637,8 +978,6 @@ static bool fetch_framerate_via_query_caps_worker(device_state& device,
     uint32_t fourcc = tcam::gst::tcam_fourcc_from_gst_1_0_caps_string(
         gst_structure_get_name(structure), format_string);
 
-    auto format_list = device.device_->get_available_video_formats();
-
     auto fps_res = device.device_->get_framerate_info(
         tcam ::VideoFormat { fourcc, { (uint32_t)width, (uint32_t)height }, scale_info });
     if (fps_res.has_error())
@@ -717,11 +1056,28 @@ static gboolean gst_tcam_mainsrc_query(GstBaseSrc* bsrc, GstQuery* query)
             }
 
             /* min latency is the time to capture one frame/field */
-            min_latency = gst_util_gdouble_to_guint64(GST_SECOND / self->fps);
+            const GstClockTime frame_time = gst_util_gdouble_to_guint64(GST_SECOND / self->fps);
+            min_latency = frame_time;
+
+            /* max latency is the time the queued buffers cover
+               before the backend has to drop images */
+            {
+                int count = self->device->active_buffers_;
+                if (count <= 0)
+                {
+                    count = self->device->calc_buffer_count(self->fps, 0, 0);
+                }
+                max_latency = frame_time * count;
+            }
 
-            /* max latency is set to NONE because cameras may enter trigger mode
-               and not deliver images for an unspecified amount of time */
-            max_latency = GST_CLOCK_TIME_NONE;
+            /* a batch holds its first frame until the batch is complete or timed out */
+            if (self->device->batch_size_ > 1)
+            {
+                const GstClockTime batch_time = frame_time * (self->device->batch_size_ - 1);
+                const GstClockTime timeout = self->device->batch_timeout_us_ * GST_USECOND;
+                min_latency += std::min(batch_time, timeout);
+                max_latency = std::max(max_latency, min_latency);
+            }
 
             GST_DEBUG_OBJECT(bsrc,
                              "report latency min %" GST_TIME_FORMAT " max %" GST_TIME_FORMAT,
@@ -846,6 +1202,9 @@ static void gst_tcam_mainsrc_init(GstTcamMainSrc* self)
     gst_base_src_set_format(GST_BASE_SRC(self), GST_FORMAT_TIME);
 
     self->device = new device_state(self);
+    self->device->statistics_structure_ =
+        tcam::is_environment_variable_set("TCAM_STATISTICS_STRUCTURE");
+    self->device->low_memory_ = tcam::is_environment_variable_set("TCAM_LOW_MEMORY");
 
     // this has to be defined in set_caps
     self->fps = 0.0;
@@ -981,6 +1340,18 @@ static void gst_tcam_mainsrc_set_property(GObject* object,
             }
             break;
         }
+        case PROP_LOW_MEMORY:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'low-memory' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.low_memory_ = g_value_get_boolean(value) != FALSE;
+            break;
+        }
         case PROP_IO_MODE:
         {
             state.io_mode_ = (GstTcamIOMode)g_value_get_enum(value);
@@ -1015,61 +1386,680 @@ static void gst_tcam_mainsrc_set_property(GObject* object,
             self->device->set_tcam_properties(strc);
             break;
         }
-        default:
+        case PROP_HUGE_PAGES:
         {
-            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'huge-pages' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            // huge pages are always pre-faulted, see get_page_allocator
+            state.allocator_options_.use_huge_pages = g_value_get_boolean(value) != FALSE;
+            // memory of the old allocator must not be reused
+            state.buffer_pool.reset();
             break;
         }
-    }
-}
-
-
-static void gst_tcam_mainsrc_get_property(GObject* object,
-                                          guint prop_id,
-                                          GValue* value,
-                                          GParamSpec* pspec)
-{
-    GstTcamMainSrc* self = GST_TCAM_MAINSRC(object);
-    auto& state = *self->device;
-
-    switch (prop_id)
-    {
-        case PROP_SERIAL:
+        case PROP_NUMA_NODE:
         {
-            g_value_set_string(value, state.get_device_serial().c_str());
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'numa-node' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.allocator_options_.numa_node = g_value_get_int(value);
+            state.buffer_pool.reset();
             break;
         }
-        case PROP_DEVICE_TYPE:
+        case PROP_NUMA_LOCALITY:
         {
-            g_value_set_string(value,
-                               tcam::tcam_device_type_to_string(state.get_device_type()).c_str());
-
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'numa-locality' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.numa_locality_ = g_value_get_boolean(value) != FALSE;
+            state.buffer_pool.reset();
             break;
         }
-        case PROP_CAMERA_BUFFERS:
+        case PROP_PREFAULT_BUFFERS:
         {
-            g_value_set_int(value, state.imagesink_buffers_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'prefault-buffers' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.allocator_options_.prefault = g_value_get_boolean(value) != FALSE;
+            state.buffer_pool.reset();
             break;
         }
-        case PROP_NUM_BUFFERS:
+        case PROP_USER_ALLOCATOR:
         {
-            g_value_set_int(value, state.n_buffers_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'user-allocator' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            auto desc = static_cast<const TcamUserAllocator*>(g_value_get_pointer(value));
+            if (!desc)
+            {
+                state.user_allocator_.reset();
+                state.buffer_pool.reset();
+                break;
+            }
+            if (desc->version != TCAM_USER_ALLOCATOR_VERSION || !desc->alloc || !desc->free)
+            {
+                GST_ERROR_OBJECT(self,
+                                 "'user-allocator' needs version %u and alloc and free functions.",
+                                 TCAM_USER_ALLOCATOR_VERSION);
+                return;
+            }
+
+            // the application may free its struct after setting it
+            const TcamUserAllocator copy = *desc;
+            tcam::user_allocator_callbacks callbacks;
+            callbacks.allocate = [copy](size_t size) { return copy.alloc(copy.user_data, size); };
+            callbacks.free = [copy](void* ptr, size_t size)
+            { copy.free(copy.user_data, ptr, size); };
+            if (copy.destroy)
+            {
+                callbacks.release = [copy]() { copy.destroy(copy.user_data); };
+            }
+
+            // buffers of the previous allocator are freed once downstream returned them
+            state.user_allocator_ = tcam::get_user_allocator(std::move(callbacks));
+            state.buffer_pool.reset();
             break;
         }
-        case PROP_IO_MODE:
+        case PROP_STATISTICS_STRUCTURE:
         {
-            g_value_set_enum(value, state.io_mode_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'statistics-structure' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            // the metas are added when the gst buffers are created on stream start
+            state.statistics_structure_ = g_value_get_boolean(value) != FALSE;
             break;
         }
-        case PROP_DROP_INCOMPLETE_BUFFER:
+        case PROP_CHUNK_DATA:
         {
-            g_value_set_boolean(value, state.drop_incomplete_frames_);
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'chunk-data' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.chunk_data_ = g_value_get_boolean(value) != FALSE;
+            if (self->device->device_)
+            {
+                self->device->device_->set_chunk_mode(state.chunk_data_);
+            }
             break;
         }
-        case PROP_TCAM_PROPERTIES_GSTSTRUCT:
+        case PROP_MISSING_LINES:
         {
-            gst_helper::gst_ptr<GstStructure> ptr = self->device->get_tcam_properties();
-            gst_value_set_structure(value, ptr.get());
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'missing-lines' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.salvage_options_.report_missing_lines = g_value_get_boolean(value) != FALSE;
+            break;
+        }
+        case PROP_CONCEAL_MAX_LINES:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'conceal-max-lines' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.salvage_options_.conceal_max_lines = g_value_get_uint(value);
+            break;
+        }
+        case PROP_IMAGE_STATISTICS:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'image-statistics' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.image_statistics_ = g_value_get_boolean(value) != FALSE;
+            break;
+        }
+        case PROP_IMAGE_STATISTICS_HISTOGRAM:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'image-statistics-histogram' is not writable "
+                                 "in state >= GST_STATE_PAUSED.");
+                return;
+            }
+            state.image_statistics_histogram_ = g_value_get_boolean(value) != FALSE;
+            break;
+        }
+        case PROP_AUTO_GROUP:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'auto-group' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            const char* str = g_value_get_string(value);
+            state.auto_group_ = str ? str : "";
+            break;
+        }
+        case PROP_AUTO_GROUP_MASTER:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'auto-group-master' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.auto_group_master_ = g_value_get_boolean(value) != FALSE;
+            break;
+        }
+        case PROP_DECIMATION:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'decimation' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.decimation_options_.frame_interval = g_value_get_uint(value);
+            break;
+        }
+        case PROP_DECIMATION_MAX_RATE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'decimation-max-rate' is not writable in state "
+                                 ">= GST_STATE_PAUSED.");
+                return;
+            }
+            state.decimation_options_.max_rate = g_value_get_double(value);
+            break;
+        }
+        case PROP_DECIMATION_AUTO_INTERVAL:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'decimation-auto-interval' is not writable in "
+                                 "state >= GST_STATE_PAUSED.");
+                return;
+            }
+            state.decimation_options_.auto_interval = g_value_get_uint(value);
+            break;
+        }
+        case PROP_THREAD_CONFIG:
+        {
+            const char* str = g_value_get_string(value);
+            if (!tcam::set_thread_config(str ? str : ""))
+            {
+                GST_ERROR_OBJECT(self, "Unable to interpret 'thread-config' '%s'", str);
+                return;
+            }
+            state.thread_config_ = str ? str : "";
+            break;
+        }
+        case PROP_BROADCAST:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'broadcast' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            const char* str = g_value_get_string(value);
+            state.broadcast_name_ = str ? str : "";
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'timestamp-mode' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.camera_timestamps_ = g_value_get_enum(value) == GST_TCAM_TIMESTAMP_CAMERA;
+            break;
+        }
+        case PROP_PROPERTY_NOTIFY_INTERVAL:
+        {
+            state.property_notify_interval_ms_ = g_value_get_uint(value);
+            break;
+        }
+        case PROP_RECONNECT_TIMEOUT:
+        {
+            state.reconnect_timeout_ms_ = g_value_get_uint(value);
+            break;
+        }
+        case PROP_DEVICE_EVENTS:
+        {
+            const char* str = g_value_get_string(value);
+            state.device_events_.clear();
+            for (auto& name : tcam::split_string(str ? str : "", ","))
+            {
+                if (!name.empty())
+                {
+                    state.device_events_.push_back(std::move(name));
+                }
+            }
+            // events can be changed while streaming
+            state.apply_device_events();
+            break;
+        }
+        case PROP_HEARTBEAT_TIMEOUT:
+        {
+            state.heartbeat_timeout_ms_ = g_value_get_uint(value);
+            if (state.device_ && state.heartbeat_timeout_ms_ != 0
+                && !state.device_->set_heartbeat_timeout(
+                    std::chrono::milliseconds(state.heartbeat_timeout_ms_)))
+            {
+                GST_WARNING_OBJECT(self, "Device does not accept 'heartbeat-timeout'.");
+            }
+            break;
+        }
+        case PROP_EMIT_FRAME_PROGRESS:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "emit-frame-progress can only be set while in "
+                                 "GST_STATE_READY or lower.");
+                return;
+            }
+            state.emit_frame_progress_ = g_value_get_boolean(value);
+            break;
+        }
+        case PROP_EMIT_FRAME_INCOMING:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "emit-frame-incoming can only be set while in "
+                                 "GST_STATE_READY or lower.");
+                return;
+            }
+            state.emit_frame_incoming_ = g_value_get_boolean(value);
+            break;
+        }
+        case PROP_BATCH_SIZE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "batch-size can only be set while in GST_STATE_READY or lower.");
+                return;
+            }
+            state.batch_size_ = g_value_get_uint(value);
+            break;
+        }
+        case PROP_BATCH_TIMEOUT:
+        {
+            state.batch_timeout_us_ = g_value_get_uint(value);
+            break;
+        }
+        case PROP_ASYNC_OPEN:
+        {
+            if (!is_state_null(self))
+            {
+                GST_WARNING_OBJECT(self,
+                                   "GObject property 'async-open' is not writable in state >= "
+                                   "GST_STATE_READY.");
+                return;
+            }
+            state.async_open_ = g_value_get_boolean(value);
+            break;
+        }
+        case PROP_SOCKET_BUFFER_SIZE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'socket-buffer-size' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.socket_buffer_size = g_value_get_int(value);
+            break;
+        }
+        case PROP_PACKET_TIMEOUT:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'packet-timeout' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.packet_timeout_us = g_value_get_int(value);
+            break;
+        }
+        case PROP_FRAME_RETENTION:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'frame-retention' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.frame_retention_us = g_value_get_int(value);
+            break;
+        }
+        case PROP_PACKET_SOCKET:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'packet-socket' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.packet_socket = g_value_get_int(value);
+            break;
+        }
+        case PROP_USB_TRANSFER_COUNT:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'usb-transfer-count' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.usb_transfer_count = g_value_get_int(value);
+            break;
+        }
+        case PROP_USB_TRANSFER_SIZE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'usb-transfer-size' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.transport_options_.usb_transfer_size = g_value_get_int(value);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_mainsrc_get_property(GObject* object,
+                                          guint prop_id,
+                                          GValue* value,
+                                          GParamSpec* pspec)
+{
+    GstTcamMainSrc* self = GST_TCAM_MAINSRC(object);
+    auto& state = *self->device;
+
+    switch (prop_id)
+    {
+        case PROP_SERIAL:
+        {
+            g_value_set_string(value, state.get_device_serial().c_str());
+            break;
+        }
+        case PROP_DEVICE_TYPE:
+        {
+            g_value_set_string(value,
+                               tcam::tcam_device_type_to_string(state.get_device_type()).c_str());
+
+            break;
+        }
+        case PROP_CAMERA_BUFFERS:
+        {
+            g_value_set_int(value, state.imagesink_buffers_);
+            break;
+        }
+        case PROP_LOW_MEMORY:
+        {
+            g_value_set_boolean(value, state.low_memory_);
+            break;
+        }
+        case PROP_MEMORY_USAGE:
+        {
+            g_value_take_boxed(value, state.get_memory_usage());
+            break;
+        }
+        case PROP_NUM_BUFFERS:
+        {
+            g_value_set_int(value, state.n_buffers_);
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            g_value_set_enum(value, state.io_mode_);
+            break;
+        }
+        case PROP_DROP_INCOMPLETE_BUFFER:
+        {
+            g_value_set_boolean(value, state.drop_incomplete_frames_);
+            break;
+        }
+        case PROP_TCAM_PROPERTIES_GSTSTRUCT:
+        {
+            gst_helper::gst_ptr<GstStructure> ptr = self->device->get_tcam_properties();
+            gst_value_set_structure(value, ptr.get());
+            break;
+        }
+        case PROP_HUGE_PAGES:
+        {
+            g_value_set_boolean(value, state.allocator_options_.use_huge_pages);
+            break;
+        }
+        case PROP_NUMA_NODE:
+        {
+            g_value_set_int(value, state.allocator_options_.numa_node);
+            break;
+        }
+        case PROP_NUMA_LOCALITY:
+        {
+            g_value_set_boolean(value, state.numa_locality_);
+            break;
+        }
+        case PROP_NUMA_PLACEMENT:
+        {
+            g_value_set_int(value, state.get_locality_numa_node());
+            break;
+        }
+        case PROP_PREFAULT_BUFFERS:
+        {
+            g_value_set_boolean(value, state.allocator_options_.prefault);
+            break;
+        }
+        case PROP_LATENCY_STATISTICS:
+        {
+            g_value_take_boxed(value, state.get_latency_statistics());
+            break;
+        }
+        case PROP_STATISTICS_STRUCTURE:
+        {
+            g_value_set_boolean(value, state.statistics_structure_);
+            break;
+        }
+        case PROP_CHUNK_DATA:
+        {
+            g_value_set_boolean(value, state.chunk_data_);
+            break;
+        }
+        case PROP_MISSING_LINES:
+        {
+            g_value_set_boolean(value, state.salvage_options_.report_missing_lines);
+            break;
+        }
+        case PROP_CONCEAL_MAX_LINES:
+        {
+            g_value_set_uint(value, state.salvage_options_.conceal_max_lines);
+            break;
+        }
+        case PROP_IMAGE_STATISTICS:
+        {
+            g_value_set_boolean(value, state.image_statistics_);
+            break;
+        }
+        case PROP_IMAGE_STATISTICS_HISTOGRAM:
+        {
+            g_value_set_boolean(value, state.image_statistics_histogram_);
+            break;
+        }
+        case PROP_AUTO_GROUP:
+        {
+            g_value_set_string(value, state.auto_group_.c_str());
+            break;
+        }
+        case PROP_AUTO_GROUP_MASTER:
+        {
+            g_value_set_boolean(value, state.auto_group_master_);
+            break;
+        case PROP_DECIMATION:
+            g_value_set_uint(value, state.decimation_options_.frame_interval);
+            break;
+        case PROP_DECIMATION_MAX_RATE:
+            g_value_set_double(value, state.decimation_options_.max_rate);
+            break;
+        case PROP_DECIMATION_AUTO_INTERVAL:
+            g_value_set_uint(value, state.decimation_options_.auto_interval);
+            break;
+        }
+        case PROP_TRANSPORT_STATISTICS:
+        {
+            g_value_take_boxed(value, state.get_transport_statistics());
+            break;
+        }
+        case PROP_THREAD_CONFIG:
+        {
+            g_value_set_string(value, state.thread_config_.c_str());
+            break;
+        }
+        case PROP_BROADCAST:
+        {
+            g_value_set_string(value, state.broadcast_name_.c_str());
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            g_value_set_enum(value,
+                             state.camera_timestamps_ ? GST_TCAM_TIMESTAMP_CAMERA
+                                                      : GST_TCAM_TIMESTAMP_ARRIVAL);
+            break;
+        }
+        case PROP_PROPERTY_NOTIFY_INTERVAL:
+        {
+            g_value_set_uint(value, state.property_notify_interval_ms_);
+            break;
+        }
+        case PROP_RECONNECT_TIMEOUT:
+        {
+            g_value_set_uint(value, state.reconnect_timeout_ms_);
+            break;
+        }
+        case PROP_DEVICE_EVENTS:
+        {
+            std::string str;
+            for (const auto& name : state.device_events_)
+            {
+                str += str.empty() ? name : "," + name;
+            }
+            g_value_set_string(value, str.c_str());
+            break;
+        }
+        case PROP_HEARTBEAT_TIMEOUT:
+        {
+            g_value_set_uint(value, state.heartbeat_timeout_ms_);
+            break;
+        }
+        case PROP_EMIT_FRAME_PROGRESS:
+        {
+            g_value_set_boolean(value, state.emit_frame_progress_);
+            break;
+        }
+        case PROP_EMIT_FRAME_INCOMING:
+        {
+            g_value_set_boolean(value, state.emit_frame_incoming_);
+            break;
+        }
+        case PROP_BATCH_SIZE:
+        {
+            g_value_set_uint(value, state.batch_size_);
+            break;
+        }
+        case PROP_BATCH_TIMEOUT:
+        {
+            g_value_set_uint(value, state.batch_timeout_us_);
+            break;
+        }
+        case PROP_ASYNC_OPEN:
+        {
+            g_value_set_boolean(value, state.async_open_);
+            break;
+        }
+        case PROP_SOCKET_BUFFER_SIZE:
+        {
+            g_value_set_int(value, state.transport_options_.socket_buffer_size);
+            break;
+        }
+        case PROP_PACKET_TIMEOUT:
+        {
+            g_value_set_int(value, state.transport_options_.packet_timeout_us);
+            break;
+        }
+        case PROP_FRAME_RETENTION:
+        {
+            g_value_set_int(value, state.transport_options_.frame_retention_us);
+            break;
+        }
+        case PROP_PACKET_SOCKET:
+        {
+            g_value_set_int(value, state.transport_options_.packet_socket);
+            break;
+        }
+        case PROP_USB_TRANSFER_COUNT:
+        {
+            g_value_set_int(value, state.transport_options_.usb_transfer_count);
+            break;
+        }
+        case PROP_USB_TRANSFER_SIZE:
+        {
+            g_value_set_int(value, state.transport_options_.usb_transfer_size);
             break;
         }
         default:
@@ -1132,25 +2122,78 @@ static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* q
             gst_object_unref(self->pool);
             self->pool = nullptr;
         }
+        // what downstream keeps for itself, e.g. a display sink holds the last rendered buffer
+        guint downstream_min = 0;
+        guint downstream_max = 0;
+        GstBufferPool* downstream_pool = nullptr;
+        if (gst_query_get_n_allocation_pools(query))
+        {
+            gst_query_parse_nth_allocation_pool(
+                query, 0, &downstream_pool, nullptr, &downstream_min, &downstream_max);
+        }
+
+        const int count =
+            self->device->calc_buffer_count(format.framerate, downstream_min, downstream_max);
+        self->device->active_buffers_ = count;
+        self->device->downstream_video_meta_ =
+            gst_query_find_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+
+        GST_INFO_OBJECT(self,
+                        "Using %d buffers, downstream requests min %u max %u",
+                        count,
+                        downstream_min,
+                        downstream_max);
+
         self->pool = gst_tcam_buffer_pool_new(GST_ELEMENT(self), caps);
-        unsigned int size = 10;
+        const guint size = tcam::VideoFormat(format).get_required_buffer_size();
 
         auto* config = gst_buffer_pool_get_config(self->pool);
 
-        gst_buffer_pool_config_set_params(config, caps, tcam::VideoFormat(format).get_required_buffer_size(), 10, 10);
+        gst_buffer_pool_config_set_params(config, caps, size, count, count);
         gst_buffer_pool_set_config(self->pool, config);
 
+        // the camera writes into the downstream buffers when their memory allows it,
+        // see import_other_pool, an explicit io-mode keeps the own allocation
+        if (downstream_pool && !GST_IS_TCAM_BUFFER_POOL(downstream_pool)
+            && self->device->io_mode_ == GST_TCAM_IO_AUTO)
+        {
+            auto* other_config = gst_buffer_pool_get_config(downstream_pool);
+            gst_buffer_pool_config_set_params(other_config, caps, size, count, count);
+
+            if (gst_buffer_pool_set_config(downstream_pool, other_config))
+            {
+                gst_tcam_buffer_pool_set_other_pool(GST_TCAM_BUFFER_POOL(self->pool),
+                                                    downstream_pool);
+            }
+            else
+            {
+                GST_INFO_OBJECT(self,
+                                "Downstream pool %" GST_PTR_FORMAT " rejects the configuration",
+                                (void*)downstream_pool);
+            }
+        }
+        if (downstream_pool)
+        {
+            gst_object_unref(downstream_pool);
+        }
+
         if (gst_query_get_n_allocation_pools(query))
         {
-            gst_query_set_nth_allocation_pool(
-                query, 0, self->pool, self->device->imagesink_buffers_, 1, 0);
+            gst_query_set_nth_allocation_pool(query, 0, self->pool, size, count, count);
         }
         else
         {
-            gst_query_add_allocation_pool(query, self->pool, size, self->device->imagesink_buffers_, 0);
+            gst_query_add_allocation_pool(query, self->pool, size, count, count);
         }
 
         self->device->device_->set_drop_incomplete_frames(self->device->drop_incomplete_frames_);
+        self->device->device_->set_transport_options(self->device->transport_options_);
+        self->device->device_->set_decimation_options(self->device->decimation_options_);
+        self->device->device_->set_locality_placement(self->device->numa_locality_);
+        if (const int node = self->device->get_locality_numa_node(); node >= 0)
+        {
+            GST_INFO_OBJECT(self, "Placing the stream on numa node %d", node);
+        }
 
 
         self->device->format_ = tcam::VideoFormat(format);
@@ -1163,6 +2206,24 @@ static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* q
 }
 
 
+static void gst_tcam_mainsrc_begin_property_batch(GstTcamMainSrc* self)
+{
+    self->device->begin_property_batch();
+}
+
+
+static gboolean gst_tcam_mainsrc_end_property_batch(GstTcamMainSrc* self)
+{
+    return self->device->end_property_batch();
+}
+
+
+static gboolean gst_tcam_mainsrc_move_roi(GstTcamMainSrc* self, gint64 offset_x, gint64 offset_y)
+{
+    return self->device->move_roi(offset_x, offset_y);
+}
+
+
 static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
 {
     GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
@@ -1197,12 +2258,34 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
         PROP_CAMERA_BUFFERS,
         g_param_spec_int("camera-buffers",
                          "Number of Buffers",
-                         "Number of buffers to use for retrieving images",
-                         1,
+                         "Number of buffers to use for retrieving images, "
+                         "-1 derives the count from framerate and downstream requirements",
+                         -1,
                          256,
                          GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LOW_MEMORY,
+        g_param_spec_boolean("low-memory",
+                             "Low memory",
+                             "With camera-buffers=-1 only queue the buffers downstream holds "
+                             "plus two for the camera, instead of covering 100 ms of frames. "
+                             "Defaults to true when TCAM_LOW_MEMORY is set.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MEMORY_USAGE,
+        g_param_spec_boxed("memory-usage",
+                           "Memory usage",
+                           "Buffers and bytes of the buffer pool and the staging memory "
+                           "the backend allocates next to it",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
     g_object_class_install_property(
         gobject_class,
         PROP_IO_MODE,
@@ -1248,6 +2331,428 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_HUGE_PAGES,
+        g_param_spec_boolean("huge-pages",
+                             "Use huge pages",
+                             "Allocate userptr buffers with pre-faulted 2 MiB huge pages.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_NUMA_NODE,
+        g_param_spec_int("numa-node",
+                         "NUMA node",
+                         "Bind userptr buffers to this NUMA node (-1 = no binding)",
+                         -1,
+                         63,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_NUMA_LOCALITY,
+        g_param_spec_boolean("numa-locality",
+                             "NUMA locality",
+                             "Place userptr buffers and the stream threads of the backend on the "
+                             "NUMA node of the usb controller or network interface of the device. "
+                             "numa-node takes precedence for the buffers.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_NUMA_PLACEMENT,
+        g_param_spec_int("numa-placement",
+                         "NUMA placement",
+                         "NUMA node numa-locality places the stream on, "
+                         "-1 when it is off, no device is open or the node is unknown",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_PREFAULT_BUFFERS,
+        g_param_spec_boolean(
+            "prefault-buffers",
+            "Pre-fault buffers",
+            "Fault in and lock page aligned userptr buffers when they are allocated.",
+            false,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USER_ALLOCATOR,
+        g_param_spec_pointer(
+            "user-allocator",
+            "User allocator",
+            "TcamUserAllocator, see tcamuserallocator.h, that provides the memory of the "
+            "userptr buffers, e.g. pinned memory for gpus. "
+            "NULL returns to the internal allocators.",
+            static_cast<GParamFlags>(G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LATENCY_STATISTICS,
+        g_param_spec_boxed("latency-statistics",
+                           "Latency statistics",
+                           "p50/p90/p99/max in ns of the pipeline stages over the last frames. "
+                           "Only filled when TCAM_LATENCY_TRACING is set.",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STATISTICS_STRUCTURE,
+        g_param_spec_boolean("statistics-structure",
+                             "Statistics as GstStructure",
+                             "Add the TcamStatisticsMeta with a GstStructure to every buffer, "
+                             "in addition to the binary TcamStatisticsValuesMeta. "
+                             "Defaults to true when TCAM_STATISTICS_STRUCTURE is set.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CHUNK_DATA,
+        g_param_spec_boolean("chunk-data",
+                             "GenICam chunk data",
+                             "Activate the chunk mode of the camera and attach the chunks "
+                             "to every buffer as TcamChunkDataMeta. "
+                             "Which chunks are sent is selected with ChunkSelector/ChunkEnable. "
+                             "Only GenICam cameras support this.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MISSING_LINES,
+        g_param_spec_boolean("missing-lines",
+                             "Report missing lines",
+                             "Attach the lines of incomplete frames that did not arrive "
+                             "to every buffer as TcamMissingLinesMeta. "
+                             "Requires drop-incomplete-buffer=false. "
+                             "Only GigE cameras support this.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CONCEAL_MAX_LINES,
+        g_param_spec_uint("conceal-max-lines",
+                          "Conceal missing lines",
+                          "Fill gaps of up to this many missing lines of incomplete frames "
+                          "with the lines above them (0 = off). "
+                          "Requires drop-incomplete-buffer=false. Only GigE cameras support this.",
+                          0,
+                          G_MAXINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_IMAGE_STATISTICS,
+        g_param_spec_boolean("image-statistics",
+                             "Image statistics",
+                             "Attach what the software auto functions sampled of the image, "
+                             "brightness, saturation and channel means, "
+                             "to every buffer as TcamImageStatisticsMeta. "
+                             "Only filled while an auto function runs in software.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_IMAGE_STATISTICS_HISTOGRAM,
+        g_param_spec_boolean("image-statistics-histogram",
+                             "Image statistics histogram",
+                             "Add a luminance histogram to TcamImageStatisticsMeta, "
+                             "only for 8-bit bayer formats. Requires image-statistics=true.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_AUTO_GROUP,
+        g_param_spec_string("auto-group",
+                            "Auto function group",
+                            "Cameras with the same group name in this process share the "
+                            "software auto functions, see auto-group-master. "
+                            "Empty (default) runs them for this camera alone.",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_AUTO_GROUP_MASTER,
+        g_param_spec_boolean("auto-group-master",
+                             "Auto function group master",
+                             "This camera runs the auto functions of its auto-group, "
+                             "the others write the exposure, gain, iris and whitebalance it chose.",
+                             false,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DECIMATION,
+        g_param_spec_uint("decimation",
+                          "Frame decimation",
+                          "Only push every n-th frame of the camera (0 and 1 = all). "
+                          "The other frames are returned to the camera right away.",
+                          0,
+                          G_MAXUINT,
+                          1,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DECIMATION_MAX_RATE,
+        g_param_spec_double("decimation-max-rate",
+                            "Maximum push rate",
+                            "Push at most this many frames per second (0 = no limit). "
+                            "The other frames are returned to the camera right away.",
+                            0.0,
+                            G_MAXDOUBLE,
+                            0.0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DECIMATION_AUTO_INTERVAL,
+        g_param_spec_uint("decimation-auto-interval",
+                          "Auto functions on skipped frames",
+                          "Also run the software auto functions on every n-th frame "
+                          "that is skipped by decimation (0 = only on pushed frames).",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TRANSPORT_STATISTICS,
+        g_param_spec_boxed("transport-statistics",
+                           "Transport statistics",
+                           "Completed/failed buffers, underruns, resent and missing packets "
+                           "of the running stream. Empty for devices without packet based transport.",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SOCKET_BUFFER_SIZE,
+        g_param_spec_int("socket-buffer-size",
+                         "GVSP socket buffer size",
+                         "Receive buffer size of the GigE stream socket in bytes (-1 = automatic)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_PACKET_TIMEOUT,
+        g_param_spec_int("packet-timeout",
+                         "GVSP packet timeout",
+                         "Time in us to wait for a missing GigE packet before requesting a resend "
+                         "(-1 = default)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FRAME_RETENTION,
+        g_param_spec_int("frame-retention",
+                         "GVSP frame retention",
+                         "Time in us to wait for the missing packets of a GigE frame (-1 = default)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_PACKET_SOCKET,
+        g_param_spec_int("packet-socket",
+                         "GVSP packet socket",
+                         "Receive GigE packets through a packet socket instead of the UDP socket. "
+                         "0 = off, 1 = on and warn when unavailable, -1 = when available",
+                         -1,
+                         1,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USB_TRANSFER_COUNT,
+        g_param_spec_int("usb-transfer-count",
+                         "USB transfer count",
+                         "Number of bulk transfers submitted at the same time. "
+                         "-1 sizes the queue from framerate and payload and grows it on stalls",
+                         -1,
+                         64,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USB_TRANSFER_SIZE,
+        g_param_spec_int("usb-transfer-size",
+                         "USB transfer size",
+                         "Size of a single bulk transfer in bytes (-1 = automatic)",
+                         -1,
+                         G_MAXINT,
+                         -1,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_THREAD_CONFIG,
+        g_param_spec_string("thread-config",
+                            "Thread configuration",
+                            "Scheduling and cpu affinity of the capture threads, "
+                            "e.g. 'capture=fifo:50@2-3;indexer=other:10'. "
+                            "Applies to all devices of the process and to threads started afterwards. "
+                            "Same format as TCAM_THREAD_CONFIG.",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BROADCAST,
+        g_param_spec_string("broadcast",
+                            "Broadcast name",
+                            "Publish the stream to other processes under this name, "
+                            "they receive it with tcambroadcastsrc. Empty disables the broadcast.",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp mode",
+                          "arrival stamps buffers when they are pushed, "
+                          "camera maps the camera time of the frame to the pipeline clock, "
+                          "which removes the transfer jitter. "
+                          "Devices without camera time fall back to arrival.",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_ARRIVAL,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_PROPERTY_NOTIFY_INTERVAL,
+        g_param_spec_uint("property-notify-interval",
+                          "Property notify interval",
+                          "Minimum time in ms between two 'tcam-properties-changed' signals, "
+                          "changes in between are collected. 0 emits with every frame that has changes.",
+                          0,
+                          G_MAXUINT,
+                          100,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_RECONNECT_TIMEOUT,
+        g_param_spec_uint("reconnect-timeout",
+                          "Reconnect timeout",
+                          "Time in ms to wait for a lost device to return while streaming. "
+                          "The device is reopened and continues the stream in the running pipeline. "
+                          "Only for userptr memory, see io-mode. 0 disables reconnecting.",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_DEVICE_EVENTS,
+        g_param_spec_string("device-events",
+                            "Device events",
+                            "Comma separated GenICam event names, "
+                            "e.g. 'ExposureEnd,FrameTriggerWait'. Every event the device sends "
+                            "is posted as 'tcam-device-event' element message. "
+                            "Only GigE Vision devices support events.",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_HEARTBEAT_TIMEOUT,
+        g_param_spec_uint("heartbeat-timeout",
+                          "Heartbeat timeout",
+                          "Time in ms without control traffic after which a GigE Vision device "
+                          "ends the connection. 0 keeps TCAM_GIGE_HEARTBEAT_MS or the default.",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_EMIT_FRAME_PROGRESS,
+        g_param_spec_boolean("emit-frame-progress",
+                             "Emit frame progress",
+                             "Emit 'frame-progress' while a frame is still transferred. "
+                             "Only devices whose backend reports partial frames emit it, "
+                             "currently the AFU420.",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_EMIT_FRAME_INCOMING,
+        g_param_spec_boolean("emit-frame-incoming",
+                             "Emit frame incoming",
+                             "Emit 'frame-incoming' when the device starts to transfer a frame. "
+                             "Only V4L2 devices whose driver sends frame sync events emit it.",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BATCH_SIZE,
+        g_param_spec_uint("batch-size",
+                          "Batch size",
+                          "Maximum number of frames pushed together as one GstBufferList. "
+                          "Lowers the per frame overhead of small ROIs with very high frame rates. "
+                          "1 pushes every frame on its own.",
+                          1,
+                          256,
+                          1,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_BATCH_TIMEOUT,
+        g_param_spec_uint("batch-timeout",
+                          "Batch timeout",
+                          "Longest time in us a batch waits for further frames after its "
+                          "first frame arrived. Only used with batch-size > 1.",
+                          0,
+                          G_MAXUINT,
+                          1000,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ASYNC_OPEN,
+        g_param_spec_boolean("async-open",
+                             "Async open",
+                             "Open the device in the background, NULL to READY returns right away. "
+                             "The result is posted as 'tcam-device-open' element message, "
+                             "'device-open' is emitted from the opening thread. "
+                             "READY to PAUSED and property access wait for the open.",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_tcammainsrc_signals[SIGNAL_DEVICE_OPEN] = g_signal_new("device-open",
                                                                G_TYPE_FROM_CLASS(klass),
                                                                G_SIGNAL_RUN_LAST,
@@ -1269,6 +2774,84 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
                                                                 0,
                                                                 G_TYPE_NONE);
 
+    // Property writes of the emitting thread between these two are sent to the device at once.
+    gst_tcammainsrc_signals[SIGNAL_BEGIN_PROPERTY_BATCH] = g_signal_new_class_handler(
+        "begin-property-batch",
+        G_TYPE_FROM_CLASS(klass),
+        static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+        G_CALLBACK(gst_tcam_mainsrc_begin_property_batch),
+        nullptr,
+        nullptr,
+        nullptr,
+        G_TYPE_NONE,
+        0);
+    gst_tcammainsrc_signals[SIGNAL_END_PROPERTY_BATCH] = g_signal_new_class_handler(
+        "end-property-batch",
+        G_TYPE_FROM_CLASS(klass),
+        static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+        G_CALLBACK(gst_tcam_mainsrc_end_property_batch),
+        nullptr,
+        nullptr,
+        nullptr,
+        G_TYPE_BOOLEAN,
+        0);
+
+    // Moves the ROI of the running stream, caps and buffers stay as they are.
+    gst_tcammainsrc_signals[SIGNAL_MOVE_ROI] = g_signal_new_class_handler(
+        "move-roi",
+        G_TYPE_FROM_CLASS(klass),
+        static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+        G_CALLBACK(gst_tcam_mainsrc_move_roi),
+        nullptr,
+        nullptr,
+        nullptr,
+        G_TYPE_BOOLEAN,
+        2,
+        G_TYPE_INT64,
+        G_TYPE_INT64);
+
+    // Names of the properties whose value or locked state changed, e.g. by the auto functions.
+    // Emitted from the streaming thread.
+    gst_tcammainsrc_signals[SIGNAL_PROPERTIES_CHANGED] =
+        g_signal_new("tcam-properties-changed",
+                     G_TYPE_FROM_CLASS(klass),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     G_TYPE_NONE,
+                     1,
+                     G_TYPE_STRV);
+
+    // Memory of the frame that is still transferred and the number of its lines that are final.
+    // Emitted from the thread of the backend, only with emit-frame-progress=true.
+    gst_tcammainsrc_signals[SIGNAL_FRAME_PROGRESS] = g_signal_new("frame-progress",
+                                                                  G_TYPE_FROM_CLASS(klass),
+                                                                  G_SIGNAL_RUN_LAST,
+                                                                  0,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  G_TYPE_NONE,
+                                                                  2,
+                                                                  G_TYPE_POINTER,
+                                                                  G_TYPE_UINT);
+
+    // Driver sequence number and CLOCK_MONOTONIC time of the start of a frame.
+    // Emitted from the thread of the backend, only with emit-frame-incoming=true.
+    gst_tcammainsrc_signals[SIGNAL_FRAME_INCOMING] = g_signal_new("frame-incoming",
+                                                                  G_TYPE_FROM_CLASS(klass),
+                                                                  G_SIGNAL_RUN_LAST,
+                                                                  0,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  nullptr,
+                                                                  G_TYPE_NONE,
+                                                                  2,
+                                                                  G_TYPE_UINT64,
+                                                                  G_TYPE_UINT64);
+
     GST_DEBUG_CATEGORY_INIT(tcam_mainsrc_debug, "tcammainsrc", 0, "tcam interface");
 
     gst_element_class_set_static_metadata(element_class,
@@ -44,10 +44,21 @@ typedef enum
     GST_TCAM_IO_AUTO = 0,
     GST_TCAM_IO_MMAP = 1,
     GST_TCAM_IO_USERPTR = 2,
-    //GST_TCAM_IO_DMABUF = 3,
+    GST_TCAM_IO_DMABUF = 3,
     //GST_TCAM_IO_DMABUF_IMPORT = 4,
 } GstTcamIOMode;
 
+#define GST_TYPE_TCAM_TIMESTAMP_MODE (gst_tcam_timestamp_mode_get_type())
+GType gst_tcam_timestamp_mode_get_type(void);
+
+typedef enum
+{
+    // do-timestamp, the time the buffer is pushed
+    GST_TCAM_TIMESTAMP_ARRIVAL = 0,
+    // camera time of the frame, mapped to the pipeline clock
+    GST_TCAM_TIMESTAMP_CAMERA = 1,
+} GstTcamTimestampMode;
+
 struct _GstTcamMainSrc
 {
     GstPushSrc element;
@@ -66,6 +77,14 @@ struct _GstTcamMainSrcClass
 
 GType gst_tcam_mainsrc_get_type(void);
 
+// emits 'frame-progress', called from the thread of the backend
+void gst_tcam_mainsrc_emit_frame_progress(GstTcamMainSrc* self, gpointer data, guint lines);
+
+// emits 'frame-incoming', called from the thread of the backend
+void gst_tcam_mainsrc_emit_frame_incoming(GstTcamMainSrc* self,
+                                          guint64 sequence,
+                                          guint64 timestamp_ns);
+
 GST_DEBUG_CATEGORY_EXTERN(tcam_mainsrc_debug);
 
 G_END_DECLS
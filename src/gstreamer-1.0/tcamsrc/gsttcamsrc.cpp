@@ -21,8 +21,10 @@
 #include "../../base_types.h"
 #include "../../logging.h"
 #include "../../public_utils.h"
+#include "../../utils.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgstjson.h"
+#include "gsttcammainsrc.h"
 #include "tcambind.h"
 #include "tcamsrc_tcamprop_impl.h"
 
@@ -46,10 +48,17 @@ struct tcamsrc_state
     std::string device_serial;
     tcam::TCAM_DEVICE_TYPE device_type = TCAM_DEVICE_TYPE_UNKNOWN;
 
-    int cam_buffers = 10;
+    int cam_buffers = -1;
     bool drop_incomplete_frames = true;
     bool do_timestamp = false;
+    GstTcamTimestampMode timestamp_mode = GST_TCAM_TIMESTAMP_ARRIVAL;
     int num_buffers = -1;
+    // 'async-open', forwarded to sources that support it
+    bool async_open = false;
+    // last value of 'thread-config', the configuration itself is process wide
+    std::string thread_config;
+    // 'user-allocator', set on every source that is opened
+    gpointer user_allocator = nullptr;
 
     gst_helper::gst_ptr<GstStructure> prop_init_gststructure_;
     std::string prop_init_json_;
@@ -81,6 +90,7 @@ enum
 {
     SIGNAL_DEVICE_OPEN,
     SIGNAL_DEVICE_CLOSE,
+    SIGNAL_PROPERTIES_CHANGED,
     SIGNAL_LAST,
 };
 
@@ -101,6 +111,10 @@ enum
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_THREAD_CONFIG,
+    PROP_TIMESTAMP_MODE,
+    PROP_ASYNC_OPEN,
+    PROP_USER_ALLOCATOR,
 };
 
 static tcamsrc::tcamsrc_state& get_element_state(GstTcamSrc* self)
@@ -140,6 +154,19 @@ static void emit_device_close(GstElement* /*object*/, void* user_data)
 }
 
 
+static void emit_device_open(GstElement* /*object*/, void* user_data)
+{
+    // 'async-open', the source emits from its opening thread
+    g_signal_emit(G_OBJECT(user_data), gst_tcamsrc_signals[SIGNAL_DEVICE_OPEN], 0);
+}
+
+
+static void emit_properties_changed(GstElement* /*object*/, gchar** names, void* user_data)
+{
+    g_signal_emit(G_OBJECT(user_data), gst_tcamsrc_signals[SIGNAL_PROPERTIES_CHANGED], 0, names);
+}
+
+
 namespace
 {
 struct device_id
@@ -271,6 +298,24 @@ static gboolean open_source_element(GstTcamSrc* self)
 
     g_signal_connect(
         G_OBJECT(new_device.get()), "device-close", G_CALLBACK(emit_device_close), self);
+    if (g_signal_lookup("tcam-properties-changed", G_OBJECT_TYPE(new_device.get())))
+    {
+        g_signal_connect(G_OBJECT(new_device.get()),
+                         "tcam-properties-changed",
+                         G_CALLBACK(emit_properties_changed),
+                         self);
+    }
+
+    // the source has to know before it is set to READY
+    const bool async_open =
+        state.async_open
+        && g_object_class_find_property(G_OBJECT_GET_CLASS(new_device.get()), "async-open");
+    if (async_open)
+    {
+        g_object_set(new_device.get(), "async-open", TRUE, nullptr);
+        g_signal_connect(
+            G_OBJECT(new_device.get()), "device-open", G_CALLBACK(emit_device_open), self);
+    }
 
     gst_element_set_name(new_device.get(), "source");
     auto state_change_res = gst_element_set_state(new_device.get(), GST_STATE_READY);
@@ -320,6 +365,17 @@ static gboolean open_source_element(GstTcamSrc* self)
 
     apply_element_property(self, PROP_DO_TIMESTAMP, &val_bool, nullptr);
 
+    GValue val_enum = G_VALUE_INIT;
+    g_value_init(&val_enum, GST_TYPE_TCAM_TIMESTAMP_MODE);
+    g_value_set_enum(&val_enum, state.timestamp_mode);
+
+    apply_element_property(self, PROP_TIMESTAMP_MODE, &val_enum, nullptr);
+
+    if (state.user_allocator && active_source_has_property(self, "user-allocator"))
+    {
+        g_object_set(state.active_source.get(), "user-allocator", state.user_allocator, nullptr);
+    }
+
     if (state.prop_init_gststructure_)
     {
         GValue tmp = G_VALUE_INIT;
@@ -344,7 +400,10 @@ static gboolean open_source_element(GstTcamSrc* self)
 
 
     // We emit the device-open notifications here after the device is __really__ open and we have setup everything surrounding that
-    g_signal_emit(G_OBJECT(self), gst_tcamsrc_signals[SIGNAL_DEVICE_OPEN], 0);
+    if (!async_open)
+    {
+        g_signal_emit(G_OBJECT(self), gst_tcamsrc_signals[SIGNAL_DEVICE_OPEN], 0);
+    }
 
     return TRUE;
 }
@@ -572,6 +631,66 @@ static void apply_element_property(GstTcamSrc* self,
             }
             break;
         }
+        case PROP_THREAD_CONFIG:
+        {
+            const char* str = g_value_get_string(value);
+            if (!tcam::set_thread_config(str ? str : ""))
+            {
+                GST_ERROR_OBJECT(self, "Unable to interpret 'thread-config' '%s'", str);
+                return;
+            }
+            state.thread_config = str ? str : "";
+            break;
+        }
+        case PROP_ASYNC_OPEN:
+        {
+            if (!is_state_null(self))
+            {
+                GST_ERROR_OBJECT(
+                    self,
+                    "GObject property 'async-open' is not writable in state >= GST_STATE_READY.");
+                return;
+            }
+            state.async_open = g_value_get_boolean(value);
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "timestamp-mode"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "timestamp-mode", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'timestamp-mode'.");
+                }
+            }
+            else
+            {
+                state.timestamp_mode = static_cast<GstTcamTimestampMode>(g_value_get_enum(value));
+            }
+            break;
+        }
+        case PROP_USER_ALLOCATOR:
+        {
+            state.user_allocator = g_value_get_pointer(value);
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "user-allocator"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "user-allocator", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'user-allocator'.");
+                }
+            }
+            break;
+        }
         case PROP_TCAMDEVICE:
         {
             if (!is_state_null(self))
@@ -763,6 +882,29 @@ static void gst_tcam_src_get_property(GObject* object,
             }
             break;
         }
+        case PROP_THREAD_CONFIG:
+        {
+            g_value_set_string(value, state.thread_config.c_str());
+            break;
+        }
+        case PROP_ASYNC_OPEN:
+        {
+            g_value_set_boolean(value, state.async_open);
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (state.is_open() && active_source_has_property(self, "timestamp-mode"))
+            {
+                g_object_get_property(
+                    G_OBJECT(state.active_source.get()), "timestamp-mode", value);
+            }
+            else
+            {
+                g_value_set_enum(value, state.timestamp_mode);
+            }
+            break;
+        }
         case PROP_TCAM_PROPERTIES_JSON:
         {
             if (!state.is_open())
@@ -911,10 +1053,11 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
         PROP_CAMERA_BUFFERS,
         g_param_spec_int("camera-buffers",
                          "Number of Buffers",
-                         "Number of buffers to use for retrieving images",
-                         1,
+                         "Number of buffers to use for retrieving images, "
+                         "-1 derives the count from framerate and downstream requirements",
+                         -1,
                          256,
-                         10,
+                         -1,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
     g_object_class_install_property(
         gobject_class,
@@ -981,6 +1124,52 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_THREAD_CONFIG,
+        g_param_spec_string(
+            "thread-config",
+            "Thread configuration",
+            "Scheduling and cpu affinity of the capture threads, "
+            "e.g. 'capture=fifo:50@2-3;indexer=other:10'. "
+            "Applies to all devices of the process and to threads started afterwards. "
+            "Same format as TCAM_THREAD_CONFIG.",
+            "",
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp mode",
+                          "arrival stamps buffers when they are pushed, "
+                          "camera maps the camera time of the frame to the pipeline clock. "
+                          "Forwarded to the source element.",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_ARRIVAL,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ASYNC_OPEN,
+        g_param_spec_boolean("async-open",
+                             "Async open",
+                             "Open the device in the background, NULL to READY returns right away. "
+                             "'device-open' is emitted from the opening thread. "
+                             "Forwarded to the source element.",
+                             FALSE,
+                             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_USER_ALLOCATOR,
+        g_param_spec_pointer("user-allocator",
+                             "User allocator",
+                             "TcamUserAllocator, see tcamuserallocator.h, that provides the memory "
+                             "of the userptr buffers. Has to stay valid while devices are opened. "
+                             "Forwarded to the source element.",
+                             static_cast<GParamFlags>(G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS)));
+
     gst_tcamsrc_signals[SIGNAL_DEVICE_OPEN] = g_signal_new("device-open",
                                                            G_TYPE_FROM_CLASS(klass),
                                                            G_SIGNAL_RUN_LAST,
@@ -1001,6 +1190,18 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
                                                             G_TYPE_NONE,
                                                             0,
                                                             G_TYPE_NONE);
+    // forwarded from the source element, see tcammainsrc
+    gst_tcamsrc_signals[SIGNAL_PROPERTIES_CHANGED] =
+        g_signal_new("tcam-properties-changed",
+                     G_TYPE_FROM_CLASS(klass),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     nullptr,
+                     nullptr,
+                     nullptr,
+                     G_TYPE_NONE,
+                     1,
+                     G_TYPE_STRV);
 
     gst_element_class_set_static_metadata(element_class,
                                           "Tcam Video Source",
@@ -0,0 +1,1012 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gsttcamsync.h"
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../SoftwareTriggerGroup.h"
+#include "../../gige_action_command.h"
+#include "gsttcammainsrc.h"
+#include "mainsrc_device_state.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+GST_DEBUG_CATEGORY_STATIC(tcam_sync_debug);
+#define GST_CAT_DEFAULT tcam_sync_debug
+
+enum
+{
+    PROP_0,
+    PROP_SYNC_MODE,
+    PROP_TOLERANCE_NS,
+    PROP_TOLERANCE_FRAMES,
+    PROP_INCOMPLETE,
+    PROP_SETS_PUSHED,
+    PROP_FRAMES_DROPPED,
+    PROP_LAST_SET_SKEW,
+    PROP_TRIGGER_MODE,
+    PROP_ACTION_DEVICE_KEY,
+    PROP_ACTION_GROUP_KEY,
+    PROP_ACTION_GROUP_MASK,
+    PROP_ACTION_DESTINATION,
+    PROP_LAST_TRIGGER_SKEW,
+};
+
+enum
+{
+    SIGNAL_TRIGGER,
+    SIGNAL_LAST,
+};
+
+static guint gst_tcam_sync_signals[SIGNAL_LAST] = {
+    0,
+};
+
+static const guint64 default_tolerance_ns = 1000000;
+
+struct sync_state
+{
+    std::atomic<GstTcamSyncMode> mode = GST_TCAM_SYNC_CAMERA_TIME;
+    std::atomic<guint64> tolerance_ns = default_tolerance_ns;
+    std::atomic<guint64> tolerance_frames = 0;
+    std::atomic<GstTcamSyncIncomplete> incomplete = GST_TCAM_SYNC_INCOMPLETE_DROP;
+
+    std::atomic<guint64> sets_pushed = 0;
+    // frames that had no partner within the tolerance or belonged to an incomplete set
+    std::atomic<guint64> frames_dropped = 0;
+    // newest minus oldest key of the last pushed set
+    std::atomic<guint64> last_set_skew = 0;
+
+    std::atomic<GstTcamSyncTrigger> trigger_mode = GST_TCAM_SYNC_TRIGGER_SOFTWARE;
+    std::atomic<guint> action_device_key = 0;
+    std::atomic<guint> action_group_key = 0;
+    std::atomic<guint> action_group_mask = 0;
+    std::atomic<guint64> last_trigger_skew = 0;
+
+    std::mutex trigger_mtx;
+    std::string action_destination;
+    // TriggerSoftware of the sources upstream of the sink pads, built on the first trigger
+    std::unique_ptr<tcam::SoftwareTriggerGroup> trigger_group;
+    size_t trigger_group_pads = 0;
+};
+
+// the first buffer queued on a sink pad
+struct pad_head
+{
+    GstAggregatorPad* pad = nullptr;
+    GstBuffer* buffer = nullptr;
+    bool eos = false;
+    guint64 key = 0;
+};
+
+static GstStaticPadTemplate tcam_sync_sink_template = GST_STATIC_PAD_TEMPLATE(
+    "sink_%u",
+    GST_PAD_SINK,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS("video/x-raw; video/x-bayer; image/jpeg; ANY"));
+
+static GstStaticPadTemplate tcam_sync_src_template = GST_STATIC_PAD_TEMPLATE(
+    "src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS("video/x-raw; video/x-bayer; image/jpeg; ANY"));
+
+G_DEFINE_TYPE(GstTcamSync, gst_tcam_sync, GST_TYPE_AGGREGATOR)
+
+
+GType gst_tcam_sync_mode_get_type(void)
+{
+    static GType tcam_sync_mode = 0;
+
+    if (!tcam_sync_mode)
+    {
+        static const GEnumValue modes[] = {
+            { GST_TCAM_SYNC_CAMERA_TIME, "GST_TCAM_SYNC_CAMERA_TIME", "camera-time" },
+            { GST_TCAM_SYNC_FRAME_COUNT, "GST_TCAM_SYNC_FRAME_COUNT", "frame-count" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_sync_mode = g_enum_register_static("GstTcamSyncMode", modes);
+    }
+    return tcam_sync_mode;
+}
+
+
+GType gst_tcam_sync_trigger_get_type(void)
+{
+    static GType tcam_sync_trigger = 0;
+
+    if (!tcam_sync_trigger)
+    {
+        static const GEnumValue modes[] = {
+            { GST_TCAM_SYNC_TRIGGER_SOFTWARE, "GST_TCAM_SYNC_TRIGGER_SOFTWARE", "software" },
+            { GST_TCAM_SYNC_TRIGGER_ACTION, "GST_TCAM_SYNC_TRIGGER_ACTION", "action" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_sync_trigger = g_enum_register_static("GstTcamSyncTrigger", modes);
+    }
+    return tcam_sync_trigger;
+}
+
+
+GType gst_tcam_sync_incomplete_get_type(void)
+{
+    static GType tcam_sync_incomplete = 0;
+
+    if (!tcam_sync_incomplete)
+    {
+        static const GEnumValue policies[] = {
+            { GST_TCAM_SYNC_INCOMPLETE_DROP, "GST_TCAM_SYNC_INCOMPLETE_DROP", "drop" },
+            { GST_TCAM_SYNC_INCOMPLETE_PUSH, "GST_TCAM_SYNC_INCOMPLETE_PUSH", "push" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_sync_incomplete = g_enum_register_static("GstTcamSyncIncomplete", policies);
+    }
+    return tcam_sync_incomplete;
+}
+
+
+static guint pad_index(GstPad* pad)
+{
+    // pads are named sink_%u
+    const char* name = GST_PAD_NAME(pad);
+    return g_ascii_strtoull(name + strlen("sink_"), nullptr, 10);
+}
+
+
+/*
+ * Returns referenced sink pads, ordered by their index,
+ * so that the n-th buffer of a set always comes from sink_n.
+ */
+static std::vector<GstAggregatorPad*> collect_pads(GstTcamSync* self)
+{
+    std::vector<GstAggregatorPad*> pads;
+
+    GST_OBJECT_LOCK(self);
+    for (GList* l = GST_ELEMENT(self)->sinkpads; l; l = l->next)
+    {
+        pads.push_back(GST_AGGREGATOR_PAD(gst_object_ref(l->data)));
+    }
+    GST_OBJECT_UNLOCK(self);
+
+    std::sort(pads.begin(),
+              pads.end(),
+              [](GstAggregatorPad* a, GstAggregatorPad* b)
+              { return pad_index(GST_PAD(a)) < pad_index(GST_PAD(b)); });
+    return pads;
+}
+
+
+static void release_heads(std::vector<pad_head>& heads)
+{
+    for (auto& h : heads)
+    {
+        if (h.buffer)
+        {
+            gst_buffer_unref(h.buffer);
+        }
+        gst_object_unref(h.pad);
+    }
+    heads.clear();
+}
+
+
+static GstFlowReturn gst_tcam_sync_aggregate(GstAggregator* agg, gboolean timeout)
+{
+    GstTcamSync* self = GST_TCAM_SYNC(agg);
+    auto& state = *self->state_;
+
+    const GstTcamSyncMode mode = state.mode;
+    const guint64 tolerance =
+        mode == GST_TCAM_SYNC_CAMERA_TIME ? state.tolerance_ns : state.tolerance_frames;
+    const bool push_incomplete = state.incomplete == GST_TCAM_SYNC_INCOMPLETE_PUSH;
+
+    std::vector<pad_head> heads;
+    for (auto pad : collect_pads(self))
+    {
+        heads.push_back({ pad, gst_aggregator_pad_peek_buffer(pad), false, 0 });
+    }
+
+    size_t present = 0;
+    size_t ended = 0;
+    guint64 newest = 0;
+
+    for (auto& h : heads)
+    {
+        if (!h.buffer)
+        {
+            h.eos = gst_aggregator_pad_is_eos(h.pad);
+            if (h.eos)
+            {
+                ended++;
+            }
+            continue;
+        }
+
+        auto meta = gst_buffer_get_tcam_statistics_values_meta(h.buffer);
+        if (!meta)
+        {
+            GST_ELEMENT_ERROR(self,
+                              STREAM,
+                              FORMAT,
+                              ("Buffer on %s has no tcam statistics", GST_PAD_NAME(h.pad)),
+                              ("tcamsync needs tcammainsrc or tcambin upstream"));
+            release_heads(heads);
+            return GST_FLOW_ERROR;
+        }
+
+        if (mode == GST_TCAM_SYNC_CAMERA_TIME && meta->values.camera_time_ns == 0)
+        {
+            GST_ELEMENT_ERROR(self,
+                              STREAM,
+                              FORMAT,
+                              ("The device on %s reports no camera time", GST_PAD_NAME(h.pad)),
+                              ("Use sync-mode=frame-count"));
+            release_heads(heads);
+            return GST_FLOW_ERROR;
+        }
+
+        h.key = mode == GST_TCAM_SYNC_CAMERA_TIME ? meta->values.camera_time_ns
+                                                  : meta->values.frame_count;
+        newest = std::max(newest, h.key);
+        present++;
+    }
+
+    // a pad that ended can not complete any further set
+    if (heads.empty() || ended == heads.size() || (ended > 0 && !push_incomplete))
+    {
+        release_heads(heads);
+        return GST_FLOW_EOS;
+    }
+
+    if (present == 0)
+    {
+        release_heads(heads);
+        return GST_FLOW_OK;
+    }
+
+    // frames without a partner in the newest frame are given up,
+    // the next frame of those pads is compared in the next call
+    bool dropped = false;
+    for (auto& h : heads)
+    {
+        if (h.buffer && h.key + tolerance < newest)
+        {
+            GST_LOG_OBJECT(self,
+                           "%s: %" G_GUINT64_FORMAT " is older than %" G_GUINT64_FORMAT
+                           ", dropping",
+                           GST_PAD_NAME(h.pad),
+                           h.key,
+                           newest);
+            gst_aggregator_pad_drop_buffer(h.pad);
+            state.frames_dropped++;
+            dropped = true;
+        }
+    }
+    if (dropped)
+    {
+        release_heads(heads);
+        return GST_FLOW_OK;
+    }
+
+    if (present < heads.size())
+    {
+        // wait for the missing frames until the latency ran out
+        if (!timeout && ended == 0)
+        {
+            release_heads(heads);
+            return GST_FLOW_OK;
+        }
+
+        if (!push_incomplete)
+        {
+            GST_DEBUG_OBJECT(
+                self, "Dropping incomplete set, %zu of %zu frames", present, heads.size());
+            for (auto& h : heads)
+            {
+                if (h.buffer)
+                {
+                    gst_aggregator_pad_drop_buffer(h.pad);
+                    state.frames_dropped++;
+                }
+            }
+            release_heads(heads);
+            return GST_FLOW_OK;
+        }
+    }
+
+    guint64 oldest = newest;
+    for (const auto& h : heads)
+    {
+        if (h.buffer)
+        {
+            oldest = std::min(oldest, h.key);
+        }
+    }
+    state.last_set_skew = newest - oldest;
+
+    GstClockTime pts = GST_CLOCK_TIME_NONE;
+    GstBufferList* list = gst_buffer_list_new_sized(heads.size());
+    for (auto& h : heads)
+    {
+        GstBuffer* buf = nullptr;
+        if (h.buffer)
+        {
+            // only this thread pops, so this is the buffer that was peeked
+            buf = gst_aggregator_pad_pop_buffer(h.pad);
+            if (!GST_CLOCK_TIME_IS_VALID(pts))
+            {
+                pts = GST_BUFFER_PTS(buf);
+            }
+        }
+        else
+        {
+            // keeps the position of the other frames
+            buf = gst_buffer_new();
+            GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_GAP);
+            GST_BUFFER_FLAG_SET(buf, GST_BUFFER_FLAG_DROPPABLE);
+        }
+        gst_buffer_list_add(list, buf);
+    }
+    release_heads(heads);
+
+    if (GST_CLOCK_TIME_IS_VALID(pts))
+    {
+        GST_AGGREGATOR_PAD(agg->srcpad)->segment.position = pts;
+    }
+    state.sets_pushed++;
+
+#if GST_CHECK_VERSION(1, 18, 0)
+    return gst_aggregator_finish_buffer_list(agg, list);
+#else
+    GstFlowReturn ret = GST_FLOW_OK;
+    for (guint i = 0; i < gst_buffer_list_length(list) && ret == GST_FLOW_OK; ++i)
+    {
+        ret = gst_aggregator_finish_buffer(agg, gst_buffer_ref(gst_buffer_list_get(list, i)));
+    }
+    gst_buffer_list_unref(list);
+    return ret;
+#endif
+}
+
+
+/*
+ * Follows the stream upstream of sinkpad, through ghost pads and elements with a "sink" pad,
+ * e.g. tcambin, tcamsrc, capsfilter and tcamconvert.
+ * Returns a referenced tcammainsrc or nullptr.
+ */
+static GstTcamMainSrc* find_upstream_mainsrc(GstPad* sinkpad)
+{
+    GstPad* pad = gst_pad_get_peer(sinkpad);
+
+    // bounds the walk in case of an unexpected topology
+    for (int hops = 0; pad && hops < 64; ++hops)
+    {
+        GstPad* next = nullptr;
+
+        if (GST_IS_GHOST_PAD(pad))
+        {
+            // src pad of a bin, continue inside
+            next = gst_ghost_pad_get_target(GST_GHOST_PAD(pad));
+        }
+        else if (GST_IS_PROXY_PAD(pad) && GST_IS_GHOST_PAD(GST_PAD_PARENT(pad)))
+        {
+            // inside of the sink pad of a bin, continue in front of the bin
+            GstProxyPad* ghost = gst_proxy_pad_get_internal(GST_PROXY_PAD(pad));
+            next = gst_pad_get_peer(GST_PAD(ghost));
+            gst_object_unref(ghost);
+        }
+        else if (GstElement* parent = gst_pad_get_parent_element(pad))
+        {
+            if (GST_IS_TCAM_MAINSRC(parent))
+            {
+                gst_object_unref(pad);
+                return GST_TCAM_MAINSRC(parent);
+            }
+
+            if (GstPad* element_sink = gst_element_get_static_pad(parent, "sink"))
+            {
+                next = gst_pad_get_peer(element_sink);
+                gst_object_unref(element_sink);
+            }
+            gst_object_unref(parent);
+        }
+
+        gst_object_unref(pad);
+        pad = next;
+    }
+
+    if (pad)
+    {
+        gst_object_unref(pad);
+    }
+    return nullptr;
+}
+
+
+// call with trigger_mtx held
+static bool build_trigger_group(GstTcamSync* self, const std::vector<GstAggregatorPad*>& pads)
+{
+    auto& state = *self->state_;
+
+    std::vector<std::shared_ptr<tcam::property::IPropertyCommand>> commands;
+    for (auto pad : pads)
+    {
+        GstTcamMainSrc* src = find_upstream_mainsrc(GST_PAD(pad));
+        if (!src)
+        {
+            GST_ERROR_OBJECT(self, "No tcammainsrc upstream of %s", GST_PAD_NAME(pad));
+            return false;
+        }
+
+        auto cmd = src->device->find_command("TriggerSoftware");
+        gst_object_unref(src);
+        if (!cmd)
+        {
+            GST_ERROR_OBJECT(
+                self, "The device upstream of %s has no TriggerSoftware", GST_PAD_NAME(pad));
+            return false;
+        }
+        commands.push_back(std::move(cmd));
+    }
+
+    state.trigger_group = std::make_unique<tcam::SoftwareTriggerGroup>(std::move(commands));
+    state.trigger_group_pads = pads.size();
+    return true;
+}
+
+
+static gboolean gst_tcam_sync_trigger(GstTcamSync* self)
+{
+    auto& state = *self->state_;
+
+    std::scoped_lock lck { state.trigger_mtx };
+
+    if (state.trigger_mode == GST_TCAM_SYNC_TRIGGER_ACTION)
+    {
+        tcam::gige_action_command cmd;
+        cmd.device_key = state.action_device_key;
+        cmd.group_key = state.action_group_key;
+        cmd.group_mask = state.action_group_mask;
+        cmd.destination = state.action_destination;
+
+        if (auto res = tcam::send_gige_action_command(cmd); !res)
+        {
+            GST_ERROR_OBJECT(self, "Action command failed: %s", res.error().message().c_str());
+            return FALSE;
+        }
+        // a single packet for all cameras
+        state.last_trigger_skew = 0;
+        return TRUE;
+    }
+
+    auto pads = collect_pads(self);
+
+    if (!state.trigger_group || state.trigger_group_pads != pads.size())
+    {
+        state.trigger_group.reset();
+        if (!build_trigger_group(self, pads))
+        {
+            for (auto pad : pads)
+            {
+                gst_object_unref(pad);
+            }
+            return FALSE;
+        }
+    }
+    for (auto pad : pads)
+    {
+        gst_object_unref(pad);
+    }
+
+    auto report = state.trigger_group->fire();
+    state.last_trigger_skew = report.issue_skew_ns;
+
+    GST_DEBUG_OBJECT(self,
+                     "Triggered %zu cameras, issue skew %" G_GUINT64_FORMAT
+                     " ns, completion skew %" G_GUINT64_FORMAT " ns",
+                     state.trigger_group->size(),
+                     report.issue_skew_ns,
+                     report.complete_skew_ns);
+
+    if (report.failed > 0)
+    {
+        GST_WARNING_OBJECT(self, "%zu triggers failed", report.failed);
+        // e.g. a device was reopened, resolve the commands again next time
+        state.trigger_group.reset();
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+static GstClockTime gst_tcam_sync_get_next_time(GstAggregator* agg)
+{
+    GstTcamSync* self = GST_TCAM_SYNC(agg);
+
+    // the timeout of a set starts with its oldest frame, the aggregator adds the latency
+    GstClockTime next = GST_CLOCK_TIME_NONE;
+    for (auto pad : collect_pads(self))
+    {
+        if (GstBuffer* buf = gst_aggregator_pad_peek_buffer(pad))
+        {
+            GstClockTime running_time =
+                gst_segment_to_running_time(&pad->segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+            if (GST_CLOCK_TIME_IS_VALID(running_time)
+                && (!GST_CLOCK_TIME_IS_VALID(next) || running_time < next))
+            {
+                next = running_time;
+            }
+            gst_buffer_unref(buf);
+        }
+        gst_object_unref(pad);
+    }
+    return next;
+}
+
+
+static GstFlowReturn gst_tcam_sync_update_src_caps(GstAggregator* agg,
+                                                   GstCaps* caps,
+                                                   GstCaps** ret)
+{
+    GstTcamSync* self = GST_TCAM_SYNC(agg);
+
+    // all frames of a set share the caps of the output
+    GstCaps* common = nullptr;
+    GstFlowReturn flow = GST_FLOW_OK;
+    for (auto pad : collect_pads(self))
+    {
+        GstCaps* pad_caps = gst_pad_get_current_caps(GST_PAD(pad));
+        if (!pad_caps)
+        {
+            flow = GST_AGGREGATOR_FLOW_NEED_DATA;
+        }
+        else if (!common)
+        {
+            common = pad_caps;
+            pad_caps = nullptr;
+        }
+        else if (!gst_caps_is_equal(common, pad_caps))
+        {
+            GST_ELEMENT_ERROR(self,
+                              CORE,
+                              NEGOTIATION,
+                              ("All inputs of tcamsync need the same caps"),
+                              ("%s has %" GST_PTR_FORMAT ", expected %" GST_PTR_FORMAT,
+                               GST_PAD_NAME(pad),
+                               pad_caps,
+                               common));
+            flow = GST_FLOW_NOT_NEGOTIATED;
+        }
+
+        if (pad_caps)
+        {
+            gst_caps_unref(pad_caps);
+        }
+        gst_object_unref(pad);
+    }
+
+    if (flow == GST_FLOW_OK && !common)
+    {
+        flow = GST_AGGREGATOR_FLOW_NEED_DATA;
+    }
+
+    if (flow == GST_FLOW_OK)
+    {
+        *ret = gst_caps_intersect(caps, common);
+        if (gst_caps_is_empty(*ret))
+        {
+            gst_caps_replace(ret, nullptr);
+            flow = GST_FLOW_NOT_NEGOTIATED;
+        }
+    }
+
+    if (common)
+    {
+        gst_caps_unref(common);
+    }
+    return flow;
+}
+
+
+static gboolean gst_tcam_sync_sink_event(GstAggregator* agg,
+                                         GstAggregatorPad* pad,
+                                         GstEvent* event)
+{
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS)
+    {
+        // the output caps are negotiated from all inputs in update_src_caps
+        gst_pad_mark_reconfigure(agg->srcpad);
+        gst_event_unref(event);
+        return TRUE;
+    }
+    return GST_AGGREGATOR_CLASS(gst_tcam_sync_parent_class)->sink_event(agg, pad, event);
+}
+
+
+static gboolean gst_tcam_sync_start(GstAggregator* agg)
+{
+    auto& state = *GST_TCAM_SYNC(agg)->state_;
+
+    state.sets_pushed = 0;
+    state.frames_dropped = 0;
+    return TRUE;
+}
+
+
+static gboolean gst_tcam_sync_stop(GstAggregator* agg)
+{
+    auto& state = *GST_TCAM_SYNC(agg)->state_;
+
+    {
+        // the devices close after this
+        std::scoped_lock lck { state.trigger_mtx };
+        state.trigger_group.reset();
+    }
+
+    GST_INFO_OBJECT(agg,
+                    "Pushed %" G_GUINT64_FORMAT " sets, dropped %" G_GUINT64_FORMAT " frames",
+                    state.sets_pushed.load(),
+                    state.frames_dropped.load());
+    return TRUE;
+}
+
+
+static void gst_tcam_sync_set_property(GObject* object,
+                                       guint prop_id,
+                                       const GValue* value,
+                                       GParamSpec* pspec)
+{
+    auto& state = *GST_TCAM_SYNC(object)->state_;
+
+    switch (prop_id)
+    {
+        case PROP_SYNC_MODE:
+        {
+            state.mode = static_cast<GstTcamSyncMode>(g_value_get_enum(value));
+            break;
+        }
+        case PROP_TOLERANCE_NS:
+        {
+            state.tolerance_ns = g_value_get_uint64(value);
+            break;
+        }
+        case PROP_TOLERANCE_FRAMES:
+        {
+            state.tolerance_frames = g_value_get_uint64(value);
+            break;
+        }
+        case PROP_INCOMPLETE:
+        {
+            state.incomplete = static_cast<GstTcamSyncIncomplete>(g_value_get_enum(value));
+            break;
+        }
+        case PROP_TRIGGER_MODE:
+        {
+            state.trigger_mode = static_cast<GstTcamSyncTrigger>(g_value_get_enum(value));
+            break;
+        }
+        case PROP_ACTION_DEVICE_KEY:
+        {
+            state.action_device_key = g_value_get_uint(value);
+            break;
+        }
+        case PROP_ACTION_GROUP_KEY:
+        {
+            state.action_group_key = g_value_get_uint(value);
+            break;
+        }
+        case PROP_ACTION_GROUP_MASK:
+        {
+            state.action_group_mask = g_value_get_uint(value);
+            break;
+        }
+        case PROP_ACTION_DESTINATION:
+        {
+            const char* str = g_value_get_string(value);
+
+            std::scoped_lock lck { state.trigger_mtx };
+            state.action_destination = str ? str : "";
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_sync_get_property(GObject* object,
+                                       guint prop_id,
+                                       GValue* value,
+                                       GParamSpec* pspec)
+{
+    auto& state = *GST_TCAM_SYNC(object)->state_;
+
+    switch (prop_id)
+    {
+        case PROP_SYNC_MODE:
+        {
+            g_value_set_enum(value, state.mode);
+            break;
+        }
+        case PROP_TOLERANCE_NS:
+        {
+            g_value_set_uint64(value, state.tolerance_ns);
+            break;
+        }
+        case PROP_TOLERANCE_FRAMES:
+        {
+            g_value_set_uint64(value, state.tolerance_frames);
+            break;
+        }
+        case PROP_INCOMPLETE:
+        {
+            g_value_set_enum(value, state.incomplete);
+            break;
+        }
+        case PROP_SETS_PUSHED:
+        {
+            g_value_set_uint64(value, state.sets_pushed);
+            break;
+        }
+        case PROP_FRAMES_DROPPED:
+        {
+            g_value_set_uint64(value, state.frames_dropped);
+            break;
+        }
+        case PROP_LAST_SET_SKEW:
+        {
+            g_value_set_uint64(value, state.last_set_skew);
+            break;
+        }
+        case PROP_TRIGGER_MODE:
+        {
+            g_value_set_enum(value, state.trigger_mode);
+            break;
+        }
+        case PROP_ACTION_DEVICE_KEY:
+        {
+            g_value_set_uint(value, state.action_device_key);
+            break;
+        }
+        case PROP_ACTION_GROUP_KEY:
+        {
+            g_value_set_uint(value, state.action_group_key);
+            break;
+        }
+        case PROP_ACTION_GROUP_MASK:
+        {
+            g_value_set_uint(value, state.action_group_mask);
+            break;
+        }
+        case PROP_ACTION_DESTINATION:
+        {
+            std::scoped_lock lck { state.trigger_mtx };
+            g_value_set_string(value, state.action_destination.c_str());
+            break;
+        }
+        case PROP_LAST_TRIGGER_SKEW:
+        {
+            g_value_set_uint64(value, state.last_trigger_skew);
+            break;
+        }
+        default:
+        {
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+        }
+    }
+}
+
+
+static void gst_tcam_sync_init(GstTcamSync* self)
+{
+    self->state_ = new sync_state();
+}
+
+
+static void gst_tcam_sync_finalize(GObject* object)
+{
+    delete GST_TCAM_SYNC(object)->state_;
+
+    G_OBJECT_CLASS(gst_tcam_sync_parent_class)->finalize(object);
+}
+
+
+static void gst_tcam_sync_class_init(GstTcamSyncClass* klass)
+{
+    GObjectClass* gobject_class = G_OBJECT_CLASS(klass);
+    GstElementClass* element_class = GST_ELEMENT_CLASS(klass);
+    GstAggregatorClass* aggregator_class = GST_AGGREGATOR_CLASS(klass);
+
+    gobject_class->finalize = gst_tcam_sync_finalize;
+    gobject_class->set_property = gst_tcam_sync_set_property;
+    gobject_class->get_property = gst_tcam_sync_get_property;
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SYNC_MODE,
+        g_param_spec_enum("sync-mode",
+                          "Sync mode",
+                          "Statistics value the frames are aligned by",
+                          GST_TYPE_TCAM_SYNC_MODE,
+                          GST_TCAM_SYNC_CAMERA_TIME,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TOLERANCE_NS,
+        g_param_spec_uint64("tolerance-ns",
+                            "Tolerance in ns",
+                            "Largest camera time difference within a set, for sync-mode=camera-time",
+                            0,
+                            G_MAXUINT64,
+                            default_tolerance_ns,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TOLERANCE_FRAMES,
+        g_param_spec_uint64("tolerance-frames",
+                            "Tolerance in frames",
+                            "Largest frame count difference within a set, for sync-mode=frame-count",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_INCOMPLETE,
+        g_param_spec_enum("incomplete",
+                          "Incomplete sets",
+                          "What happens to a set that misses frames when the latency ran out. "
+                          "push fills the missing frames with empty GAP buffers.",
+                          GST_TYPE_TCAM_SYNC_INCOMPLETE,
+                          GST_TCAM_SYNC_INCOMPLETE_DROP,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_SETS_PUSHED,
+        g_param_spec_uint64("sets-pushed",
+                            "Sets pushed",
+                            "Frame sets that were pushed downstream",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_FRAMES_DROPPED,
+        g_param_spec_uint64("frames-dropped",
+                            "Frames dropped",
+                            "Frames that could not be matched to a complete set",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LAST_SET_SKEW,
+        g_param_spec_uint64("last-set-skew",
+                            "Last set skew",
+                            "Difference between the newest and oldest frame of the last set, "
+                            "in ns or frames depending on sync-mode",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TRIGGER_MODE,
+        g_param_spec_enum("trigger-mode",
+                          "Trigger mode",
+                          "How the 'trigger' action signal triggers the cameras",
+                          GST_TYPE_TCAM_SYNC_TRIGGER,
+                          GST_TCAM_SYNC_TRIGGER_SOFTWARE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ACTION_DEVICE_KEY,
+        g_param_spec_uint("action-device-key",
+                          "Action device key",
+                          "ActionDeviceKey of the cameras, for trigger-mode=action",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ACTION_GROUP_KEY,
+        g_param_spec_uint("action-group-key",
+                          "Action group key",
+                          "ActionGroupKey of the cameras, for trigger-mode=action",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ACTION_GROUP_MASK,
+        g_param_spec_uint("action-group-mask",
+                          "Action group mask",
+                          "Matched against the ActionGroupMask of the cameras, for trigger-mode=action",
+                          0,
+                          G_MAXUINT,
+                          0,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ACTION_DESTINATION,
+        g_param_spec_string("action-destination",
+                            "Action destination",
+                            "IPv4 address the action command is sent to, "
+                            "empty uses the broadcast address of every interface",
+                            "",
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_LAST_TRIGGER_SKEW,
+        g_param_spec_uint64("last-trigger-skew",
+                            "Last trigger skew",
+                            "Time in ns between the first and the last software trigger being issued",
+                            0,
+                            G_MAXUINT64,
+                            0,
+                            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    // Triggers all cameras upstream at once, returns FALSE if one of them failed.
+    gst_tcam_sync_signals[SIGNAL_TRIGGER] =
+        g_signal_new_class_handler("trigger",
+                                   G_TYPE_FROM_CLASS(klass),
+                                   static_cast<GSignalFlags>(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+                                   G_CALLBACK(gst_tcam_sync_trigger),
+                                   nullptr,
+                                   nullptr,
+                                   nullptr,
+                                   G_TYPE_BOOLEAN,
+                                   0);
+
+    GST_DEBUG_CATEGORY_INIT(tcam_sync_debug, "tcamsync", 0, "tcam multi camera sync");
+
+    gst_element_class_set_static_metadata(element_class,
+                                          "Tcam Sync",
+                                          "Generic/Video",
+                                          "Aligns the frames of several cameras by camera time "
+                                          "or frame count and pushes them as buffer lists",
+                                          "The Imaging Source <support@theimagingsource.com>");
+
+    gst_element_class_add_static_pad_template_with_gtype(
+        element_class, &tcam_sync_sink_template, GST_TYPE_AGGREGATOR_PAD);
+    gst_element_class_add_static_pad_template_with_gtype(
+        element_class, &tcam_sync_src_template, GST_TYPE_AGGREGATOR_PAD);
+
+    aggregator_class->aggregate = gst_tcam_sync_aggregate;
+    aggregator_class->get_next_time = gst_tcam_sync_get_next_time;
+    aggregator_class->update_src_caps = gst_tcam_sync_update_src_caps;
+    aggregator_class->sink_event = gst_tcam_sync_sink_event;
+    aggregator_class->start = gst_tcam_sync_start;
+    aggregator_class->stop = gst_tcam_sync_stop;
+}
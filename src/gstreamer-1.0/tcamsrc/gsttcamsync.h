@@ -0,0 +1,76 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gst/base/gstaggregator.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TCAM_SYNC (gst_tcam_sync_get_type())
+#define GST_TCAM_SYNC(obj) (G_TYPE_CHECK_INSTANCE_CAST((obj), GST_TYPE_TCAM_SYNC, GstTcamSync))
+#define GST_IS_TCAM_SYNC(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GST_TYPE_TCAM_SYNC))
+
+typedef struct _GstTcamSync GstTcamSync;
+typedef struct _GstTcamSyncClass GstTcamSyncClass;
+
+#define GST_TYPE_TCAM_SYNC_MODE (gst_tcam_sync_mode_get_type())
+GType gst_tcam_sync_mode_get_type(void);
+
+typedef enum
+{
+    GST_TCAM_SYNC_CAMERA_TIME = 0,
+    GST_TCAM_SYNC_FRAME_COUNT = 1,
+} GstTcamSyncMode;
+
+#define GST_TYPE_TCAM_SYNC_INCOMPLETE (gst_tcam_sync_incomplete_get_type())
+GType gst_tcam_sync_incomplete_get_type(void);
+
+typedef enum
+{
+    GST_TCAM_SYNC_INCOMPLETE_DROP = 0,
+    GST_TCAM_SYNC_INCOMPLETE_PUSH = 1,
+} GstTcamSyncIncomplete;
+
+#define GST_TYPE_TCAM_SYNC_TRIGGER (gst_tcam_sync_trigger_get_type())
+GType gst_tcam_sync_trigger_get_type(void);
+
+typedef enum
+{
+    // TriggerSoftware of every camera, issued in parallel
+    GST_TCAM_SYNC_TRIGGER_SOFTWARE = 0,
+    // one GigE Vision action command for all cameras
+    GST_TCAM_SYNC_TRIGGER_ACTION = 1,
+} GstTcamSyncTrigger;
+
+struct sync_state;
+
+struct _GstTcamSync
+{
+    GstAggregator element;
+
+    sync_state* state_;
+};
+
+struct _GstTcamSyncClass
+{
+    GstAggregatorClass parent_class;
+};
+
+GType gst_tcam_sync_get_type(void);
+
+G_END_DECLS
@@ -16,16 +16,35 @@
 
 #include "mainsrc_device_state.h"
 
+#include "../../DeviceIndex.h"
 #include "../../logging.h"
+#include "../../utils.h"
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
 #include "../tcamgstbase/tcamgststrings.h"
 #include "../tcamgstbase/tcamgstbase.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <utility>
 #include <tcamprop1.0_gobject/tcam_property_serialize.h>
 
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
 
+namespace
+{
+
+// buffers queued in the backend have to cover this much delay of the pipeline
+constexpr double auto_buffer_queue_seconds = 0.1;
+// backends need a few queued buffers to not drop at low framerates
+constexpr int auto_buffer_min = 4;
+// with 'low-memory' the queue does not grow with the framerate
+constexpr int low_memory_buffer_min = 2;
+constexpr int buffer_count_max = 256;
+
+} // namespace
+
 
 tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(GstTcamIOMode mode)
 {
@@ -40,8 +59,10 @@ tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(GstTcamIOMode mode)
         {
             return tcam::TCAM_MEMORY_TYPE_MMAP;
         }
-        // case GST_TCAM_IO_DMABUF:
-        //     return tcam::TCAM_MEMORY_TYPE_DMA;
+        case GST_TCAM_IO_DMABUF:
+        {
+            return tcam::TCAM_MEMORY_TYPE_DMA;
+        }
         // case GST_TCAM_IO_DMABUF_IMPORT:
         //     return tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
     }
@@ -57,7 +78,7 @@ GstTcamIOMode tcam::mainsrc::memory_type_to_io_mode(tcam::TCAM_MEMORY_TYPE t)
         case tcam::TCAM_MEMORY_TYPE_MMAP:
             return GST_TCAM_IO_MMAP;
         case tcam::TCAM_MEMORY_TYPE_DMA:
-        //     return GST_TCAM_IO_DMABUF;
+            return GST_TCAM_IO_DMABUF;
         case tcam::TCAM_MEMORY_TYPE_DMA_IMPORT:
             break;
         //     return GST_TCAM_IO_DMABUF_IMPORT;
@@ -157,10 +178,17 @@ void device_state::set_tcam_properties(const GstStructure* ptr) noexcept
             apply_properties(*ptr);
         }
     }
+
+    if (is_streaming_)
+    {
+        save_property_state();
+    }
 }
 
 gst_helper::gst_ptr<GstStructure> device_state::get_tcam_properties() noexcept
 {
+    wait_for_async_open();
+
     if (!is_device_open())
     {
         if (!prop_init_.empty())
@@ -199,6 +227,8 @@ tcam::TCAM_DEVICE_TYPE device_state::get_device_type() const noexcept
 
 GstCaps* device_state::get_device_caps() const
 {
+    wait_for_async_open();
+
     std::lock_guard lck { device_open_mutex_ };
     if (all_caps_ == nullptr)
     {
@@ -208,6 +238,79 @@ GstCaps* device_state::get_device_caps() const
 }
 
 
+std::shared_ptr<tcam::AllocatorInterface> device_state::get_allocator(
+    tcam::TCAM_MEMORY_TYPE t) const
+{
+    if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return device_->get_allocator();
+    }
+    if (user_allocator_)
+    {
+        return user_allocator_;
+    }
+
+    auto options = allocator_options_;
+    if (options.numa_node < 0)
+    {
+        options.numa_node = get_locality_numa_node();
+    }
+    if (options.use_huge_pages || options.prefault || options.numa_node >= 0)
+    {
+        return tcam::get_page_allocator(options);
+    }
+    return device_->get_allocator();
+}
+
+
+int device_state::get_locality_numa_node() const
+{
+    if (!numa_locality_ || !device_)
+    {
+        return -1;
+    }
+    return device_->get_numa_node();
+}
+
+
+int device_state::calc_buffer_count(double framerate,
+                                    unsigned int downstream_min,
+                                    unsigned int downstream_max) const noexcept
+{
+    int count = imagesink_buffers_;
+    if (count <= 0 && low_memory_)
+    {
+        count = low_memory_buffer_min + static_cast<int>(downstream_min);
+    }
+    else if (count <= 0)
+    {
+        const int queued = static_cast<int>(std::ceil(framerate * auto_buffer_queue_seconds));
+
+        // downstream keeps downstream_min buffers, the rest is queued for the camera
+        count = std::max(auto_buffer_min, queued) + static_cast<int>(downstream_min);
+    }
+
+    // at least one buffer has to be available for the camera
+    const int required = static_cast<int>(downstream_min) + 1;
+    if (count < required)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "camera-buffers=%d is too small, downstream holds %u buffers. Using %d.",
+                           count,
+                           downstream_min,
+                           required);
+        count = required;
+    }
+
+    if (downstream_max > 0 && count > static_cast<int>(downstream_max))
+    {
+        count = std::max(static_cast<int>(downstream_max), required);
+    }
+
+    return std::clamp(count, 1, buffer_count_max);
+}
+
+
 bool device_state::configure_stream()
 {
     auto conf_res = device_->configure_stream(format_, sink, buffer_pool);
@@ -223,90 +326,314 @@ bool device_state::configure_stream()
 
 void device_state::start_stream()
 {
+    latency_auto_pass_.clear();
+    latency_backend_.clear();
+    latency_handoff_.clear();
+    latency_total_.clear();
+
     if (device_)
     {
         device_->start_stream();
     }
+
+    save_property_state();
 }
 
 
 void device_state::stop_stream()
 {
+    cancel_reconnect();
+
     if (device_ && is_streaming_)
     {
         device_->stop_stream();
     }
     is_streaming_ = false;
+
+    if (tcam::latency::is_enabled())
+    {
+        auto ptr = gst_helper::make_ptr(get_latency_statistics());
+        GST_INFO_OBJECT(parent_, "Latency: %s", gst_helper::to_string(*ptr).c_str());
+    }
+}
+
+
+void device_state::add_latency_sample(const TcamStatisticsValues& stats) noexcept
+{
+    const uint64_t dequeue = stats.dequeue_time_ns;
+    const uint64_t sink_push = stats.sink_push_time_ns;
+    const uint64_t gst_push = stats.gst_push_time_ns;
+
+    latency_auto_pass_.add(stats.auto_pass_begin_ns, stats.auto_pass_end_ns);
+    latency_backend_.add(dequeue, sink_push);
+    latency_handoff_.add(sink_push, gst_push);
+    latency_total_.add(dequeue, gst_push);
+
+    if (metrics_)
+    {
+        metrics_->latency_handoff.observe(sink_push, gst_push);
+        metrics_->latency_total.observe(dequeue, gst_push);
+    }
+}
+
+
+auto device_state::get_transport_statistics() const -> GstStructure*
+{
+    GstStructure* ret = gst_structure_new_empty("transport");
+
+    if (!device_)
+    {
+        return ret;
+    }
+
+    auto stats = device_->get_transport_statistics();
+    if (!stats)
+    {
+        return ret;
+    }
+
+    gst_structure_set(ret,
+                      "completed_buffers",
+                      G_TYPE_UINT64,
+                      stats->completed_buffers,
+                      "failed_buffers",
+                      G_TYPE_UINT64,
+                      stats->failed_buffers,
+                      "underruns",
+                      G_TYPE_UINT64,
+                      stats->underruns,
+                      "resent_packets",
+                      G_TYPE_UINT64,
+                      stats->resent_packets,
+                      "missing_packets",
+                      G_TYPE_UINT64,
+                      stats->missing_packets,
+                      nullptr);
+
+    switch (stats->receive_mode)
+    {
+        case tcam::TCAM_GIGE_RECEIVE_MODE_UDP_SOCKET:
+        {
+            gst_structure_set(ret, "receive_mode", G_TYPE_STRING, "udp-socket", nullptr);
+            break;
+        }
+        case tcam::TCAM_GIGE_RECEIVE_MODE_PACKET_SOCKET:
+        {
+            gst_structure_set(ret, "receive_mode", G_TYPE_STRING, "packet-socket", nullptr);
+            break;
+        }
+        case tcam::TCAM_GIGE_RECEIVE_MODE_UNKNOWN:
+        {
+            break;
+        }
+    }
+    return ret;
+}
+
+
+auto device_state::get_memory_usage() const -> GstStructure*
+{
+    GstStructure* ret = gst_structure_new_empty("memory");
+
+    guint64 pool_bytes = 0;
+    guint pool_buffers = 0;
+    if (auto pool = buffer_pool)
+    {
+        pool_bytes = pool->get_memory_size();
+        pool_buffers = pool->get_memory_count();
+    }
+    guint64 staging_bytes = 0;
+    if (device_)
+    {
+        staging_bytes = device_->get_staging_memory_size();
+    }
+
+    gst_structure_set(ret,
+                      "pool_buffers",
+                      G_TYPE_UINT,
+                      pool_buffers,
+                      "pool_bytes",
+                      G_TYPE_UINT64,
+                      pool_bytes,
+                      "pool_imported",
+                      G_TYPE_BOOLEAN,
+                      buffer_pool_imported_,
+                      "staging_bytes",
+                      G_TYPE_UINT64,
+                      staging_bytes,
+                      nullptr);
+    return ret;
+}
+
+
+auto device_state::get_latency_statistics() const -> GstStructure*
+{
+    GstStructure* ret = gst_structure_new_empty("latency");
+
+    auto add_stage = [ret](const char* stage, const tcam::latency::sliding_window& window)
+    {
+        const auto p = window.get();
+
+        GstStructure* s = gst_structure_new("stage",
+                                            "samples",
+                                            G_TYPE_UINT64,
+                                            p.sample_count,
+                                            "p50",
+                                            G_TYPE_UINT64,
+                                            p.p50,
+                                            "p90",
+                                            G_TYPE_UINT64,
+                                            p.p90,
+                                            "p99",
+                                            G_TYPE_UINT64,
+                                            p.p99,
+                                            "max",
+                                            G_TYPE_UINT64,
+                                            p.max,
+                                            nullptr);
+        gst_structure_set(ret, stage, GST_TYPE_STRUCTURE, s, nullptr);
+        gst_structure_free(s);
+    };
+
+    add_stage("auto-pass", latency_auto_pass_);
+    add_stage("backend", latency_backend_);
+    add_stage("handoff", latency_handoff_);
+    add_stage("total", latency_total_);
+
+    return ret;
 }
 
 
 void device_state::stop_and_clear()
 {
+    cancel_reconnect();
+
     if (device_ && is_streaming_)
     {
         device_->stop_stream();
     }
-    while (!queue.empty())
+    tcam::mainsrc::buffer_info* ptr = nullptr;
+    while (queue.try_pop(ptr))
     {
-        auto ptr = queue.front();
-        queue.pop();
+        if (metrics_)
+        {
+            // never reach downstream, keeps the queue and outstanding gauges right
+            metrics_->queue_popped.inc();
+            metrics_->buffers_released.inc();
+        }
         if (sink)
         {
-            sink->requeue_buffer(ptr.tcam_buffer);
+            sink->requeue_buffer(ptr->tcam_buffer);
         }
     }
 }
 
 void device_state::close()
 {
+    // the reconnect takes stream_mtx_ itself
+    cancel_reconnect();
+
     std::lock_guard<std::mutex> lck(stream_mtx_);
 
     // clear list to ensure property users get a no device error
     tcamprop_container_.clear_list();
     tcamprop_interface_.clear();
+    change_notifier_ = nullptr;
     if (device_)
     {
         stop_and_clear();
 
+        {
+            // commit while the device is still open
+            std::lock_guard batch_lck { property_batch_mtx_ };
+            property_batches_.clear();
+        }
+
         device_ = nullptr;
+        metrics_ = nullptr;
+        device_lost_cb_ = nullptr;
+        device_lost_user_data_ = nullptr;
+        {
+            std::lock_guard saved_lck { saved_properties_mtx_ };
+            saved_properties_.reset();
+        }
         sink = nullptr;
+        buffer_pool.reset();
         all_caps_.reset();
     }
 }
 
+auto device_state::find_command(std::string_view name) const
+    -> std::shared_ptr<tcam::property::IPropertyCommand>
+{
+    if (!device_)
+    {
+        return nullptr;
+    }
+    return std::dynamic_pointer_cast<tcam::property::IPropertyCommand>(
+        tcam::property::find_property(device_->get_properties(), name));
+}
+
+
+auto device_state::collect_property_changes() -> std::vector<std::string>
+{
+    if (!change_notifier_ || !change_notifier_->has_pending())
+    {
+        return {};
+    }
+
+    const uint64_t now = tcam::latency::now_ns();
+    if (now - last_property_notify_ns_ < uint64_t(property_notify_interval_ms_) * 1'000'000)
+    {
+        return {};
+    }
+    last_property_notify_ns_ = now;
+
+    return change_notifier_->take();
+}
+
+
 void device_state::populate_tcamprop_interface()
 {
     auto properties = device_->get_properties();
+    change_notifier_ = device_->get_property_change_notifier();
 
     tcamprop_interface_.tcamprop_properties.reserve(properties.size());
+    tcamprop_interface_.index_.reserve(properties.size());
 
     for (auto& p : properties)
     {
-        auto prop = tcam::mainsrc::make_wrapper_instance(p);
+        auto prop = tcam::mainsrc::make_wrapper_instance(p, change_notifier_);
         if (prop)
         {
-#if !NDEBUG
-            bool found = std::any_of(tcamprop_interface_.tcamprop_properties.begin(),
-                                     tcamprop_interface_.tcamprop_properties.end(),
-                                     [name = prop->get_property_name()](auto& existing_prop)
-                                     { return existing_prop->get_property_name() == name; });
-            if (found)
+            auto name = std::string(prop->get_property_name());
+            if (!tcamprop_interface_.add(std::move(prop)))
             {
-                SPDLOG_WARN("Property with name='{}' already in the property list.",
-                            prop->get_property_name());
+                SPDLOG_WARN("Property with name='{}' already in the property list.", name);
             }
-
-#endif
-            tcamprop_interface_.tcamprop_properties.push_back(std::move(prop));
         }
     }
 
+    std::weak_ptr<tcam::CaptureDevice> weak_dev = device_;
+    tcamprop_interface_.begin_transaction =
+        [weak_dev]() -> std::unique_ptr<tcam::property::IPropertyTransaction>
+    {
+        if (auto dev = weak_dev.lock())
+        {
+            return dev->begin_property_transaction();
+        }
+        return nullptr;
+    };
+
     tcamprop_container_.create_list(&tcamprop_interface_);
 }
 
 
 void device_state::apply_properties(const GstStructure& strct)
 {
+    // callers hold device_open_mutex_
+    auto batch = device_->begin_property_transaction();
+
     tcamprop1_gobj::apply_properties(
         TCAM_PROPERTY_PROVIDER(parent_),
         strct,
@@ -317,6 +644,76 @@ void device_state::apply_properties(const GstStructure& strct)
                                prop_name.c_str(),
                                err.message);
         });
+
+    if (auto res = batch->commit(); !res)
+    {
+        GST_WARNING_OBJECT(
+            parent_, "Failed to write batched properties: %s", res.error().message().c_str());
+    }
+}
+
+
+void device_state::begin_property_batch()
+{
+    std::lock_guard lck { property_batch_mtx_ };
+
+    if (device_)
+    {
+        property_batches_.push_back(device_->begin_property_transaction());
+    }
+}
+
+
+bool device_state::end_property_batch()
+{
+    std::unique_ptr<tcam::property::IPropertyTransaction> batch;
+    {
+        std::lock_guard lck { property_batch_mtx_ };
+
+        if (property_batches_.empty())
+        {
+            return true;
+        }
+        batch = std::move(property_batches_.back());
+        property_batches_.pop_back();
+    }
+
+    auto res = batch->commit();
+    if (!res)
+    {
+        GST_WARNING_OBJECT(
+            parent_, "Failed to write batched properties: %s", res.error().message().c_str());
+        return false;
+    }
+
+    if (is_streaming_)
+    {
+        save_property_state();
+    }
+    return true;
+}
+
+
+bool device_state::move_roi(gint64 offset_x, gint64 offset_y)
+{
+    if (!device_)
+    {
+        GST_WARNING_OBJECT(parent_, "Unable to move the ROI, no device is open.");
+        return false;
+    }
+
+    auto res = device_->move_roi(offset_x, offset_y);
+    if (!res)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "Unable to move the ROI to %" G_GINT64_FORMAT ", %" G_GINT64_FORMAT
+                           ": %s",
+                           offset_x,
+                           offset_y,
+                           res.error().message().c_str());
+        return false;
+    }
+    return true;
 }
 
 bool device_state::open_camera()
@@ -348,6 +745,9 @@ bool device_state::open_camera()
     device_ = dev;
     all_caps_ = caps;
 
+    const auto info = dev->get_device();
+    metrics_ = tcam::metrics::get_stream(info.get_serial(), info.get_device_type_as_string());
+
     GST_DEBUG_OBJECT(
         parent_, "Device provides the following caps: %s", gst_helper::to_string(*caps).c_str());
 
@@ -363,5 +763,413 @@ bool device_state::open_camera()
         prop_init_.reset();
     }
 
+    setup_device_link();
+
+    return true;
+}
+
+
+void device_state::setup_device_link()
+{
+    if (heartbeat_timeout_ms_ != 0)
+    {
+        if (!device_->set_heartbeat_timeout(std::chrono::milliseconds(heartbeat_timeout_ms_)))
+        {
+            GST_WARNING_OBJECT(parent_, "Device does not accept 'heartbeat-timeout'.");
+        }
+    }
+
+    device_->register_device_event_callback(&device_state::device_event_callback, this);
+    apply_device_events();
+}
+
+
+void device_state::apply_device_events()
+{
+    if (!device_)
+    {
+        return;
+    }
+
+    if (auto res = device_->enable_device_events(device_events_); !res)
+    {
+        GST_WARNING_OBJECT(parent_,
+                           "Unable to enable the device events: %s",
+                           res.error().message().c_str());
+    }
+}
+
+
+void device_state::device_event_callback(const tcam::tcam_device_event* event, void* user_data)
+{
+    auto self = static_cast<device_state*>(user_data);
+
+    // posted from the event thread of the device, the bus serializes it for the application
+    auto strct = gst_structure_new("tcam-device-event",
+                                   "name",
+                                   G_TYPE_STRING,
+                                   event->name,
+                                   "event-id",
+                                   G_TYPE_UINT,
+                                   (guint)event->event_id,
+                                   "stream-channel",
+                                   G_TYPE_UINT,
+                                   (guint)event->stream_channel,
+                                   "frame-id",
+                                   G_TYPE_UINT64,
+                                   (guint64)event->block_id,
+                                   "timestamp",
+                                   G_TYPE_UINT64,
+                                   (guint64)event->timestamp,
+                                   nullptr);
+
+    gst_element_post_message(GST_ELEMENT(self->parent_),
+                             gst_message_new_element(GST_OBJECT(self->parent_), strct));
+}
+
+
+void device_state::set_device_lost_callback(tcam::tcam_device_lost_callback cb, void* user_data)
+{
+    device_lost_cb_ = cb;
+    device_lost_user_data_ = user_data;
+
+    if (device_)
+    {
+        device_->register_device_lost_callback(cb, user_data);
+    }
+}
+
+
+void device_state::save_property_state()
+{
+    // serializing reads every property from the device, only do it when it is needed
+    if (reconnect_timeout_ms_ == 0 || !device_)
+    {
+        return;
+    }
+
+    auto ptr = gst_helper::make_ptr(gst_structure_new_empty("tcam"));
+    tcamprop1_gobj::serialize_properties(TCAM_PROPERTY_PROVIDER(parent_), *ptr);
+
+    std::lock_guard lck { saved_properties_mtx_ };
+    saved_properties_ = ptr;
+}
+
+
+void device_state::report_device_lost(const std::string& serial)
+{
+    // set serial as args entry and in actual message
+    // that way users have multiple ways of accessing the serial
+    GST_ELEMENT_ERROR_WITH_DETAILS(GST_ELEMENT(parent_),
+                                   RESOURCE,
+                                   NOT_FOUND,
+                                   ("Device lost (%s)", serial.c_str()),
+                                   ((nullptr)),
+                                   ("serial", G_TYPE_STRING, serial.c_str(), nullptr));
+
+    is_streaming_ = false;
+    queue.notify();
+
+    // the device is considered lost.
+    // might as well inform via all possible channels to keep
+    // property queries, etc from appearing while everything is shutting down
+    g_signal_emit_by_name(G_OBJECT(parent_), "device-close");
+}
+
+
+bool device_state::begin_reconnect()
+{
+    if (reconnect_timeout_ms_ == 0 || !device_)
+    {
+        return false;
+    }
+
+    // the memory of mmap and dmabuf buffers belongs to the lost device
+    if (buffer_pool && buffer_pool->get_memory_type() != tcam::TCAM_MEMORY_TYPE_USERPTR)
+    {
+        GST_WARNING_OBJECT(parent_, "Reconnecting requires io-mode=userptr.");
+        return false;
+    }
+
+    std::lock_guard lck { reconnect_mtx_ };
+
+    if (reconnect_thread_.joinable())
+    {
+        if (!reconnect_done_)
+        {
+            // the lost device reports more than once
+            return true;
+        }
+        reconnect_thread_.join();
+    }
+
+    const auto info = device_->get_device();
+
+    GST_ELEMENT_WARNING_WITH_DETAILS(
+        GST_ELEMENT(parent_),
+        RESOURCE,
+        NOT_FOUND,
+        ("Device lost (%s). Reconnecting.", info.get_serial().c_str()),
+        ((nullptr)),
+        ("serial", G_TYPE_STRING, info.get_serial().c_str(), nullptr));
+
+    // properties are unavailable until the device is back
+    g_signal_emit_by_name(G_OBJECT(parent_), "device-close");
+
+    reconnect_cancel_ = false;
+    reconnect_wakeup_ = false;
+    reconnect_done_ = false;
+    reconnect_thread_ = std::thread(
+        &device_state::reconnect_thread_main, this, info.get_serial(), info.get_device_type());
+
+    return true;
+}
+
+
+void device_state::cancel_reconnect()
+{
+    std::unique_lock lck { reconnect_mtx_ };
+
+    if (!reconnect_thread_.joinable())
+    {
+        return;
+    }
+
+    if (reconnect_thread_.get_id() == std::this_thread::get_id())
+    {
+        // e.g. a synchronous bus handler reacting to the error of a failed reconnect
+        reconnect_thread_.detach();
+        return;
+    }
+
+    reconnect_cancel_ = true;
+    lck.unlock();
+    reconnect_cv_.notify_all();
+
+    reconnect_thread_.join();
+}
+
+
+void device_state::begin_async_open(std::function<bool()> open_func)
+{
+    finish_async_open();
+
+    {
+        std::lock_guard lck { async_open_mtx_ };
+        // set before the thread exists, so wait_for_async_open cannot miss the open
+        async_open_running_ = true;
+    }
+
+    async_open_thread_ = std::thread(
+        [this, open_func = std::move(open_func)]
+        {
+            tcam::set_thread_name("tcam_open");
+
+            open_func();
+
+            {
+                std::lock_guard lck { async_open_mtx_ };
+                async_open_running_ = false;
+            }
+            async_open_cv_.notify_all();
+        });
+}
+
+
+void device_state::wait_for_async_open() const
+{
+    if (async_open_thread_.get_id() == std::this_thread::get_id())
+    {
+        // e.g. a 'device-open' handler reading properties
+        return;
+    }
+
+    std::unique_lock lck { async_open_mtx_ };
+    async_open_cv_.wait(lck, [this] { return !async_open_running_; });
+}
+
+
+void device_state::finish_async_open()
+{
+    if (!async_open_thread_.joinable())
+    {
+        return;
+    }
+
+    if (async_open_thread_.get_id() == std::this_thread::get_id())
+    {
+        // e.g. a synchronous bus handler reacting to the error of a failed open
+        async_open_thread_.detach();
+        return;
+    }
+
+    async_open_thread_.join();
+}
+
+
+void device_state::reconnect_device_added(const tcam::DeviceInfo& /*info*/, void* user_data)
+{
+    auto self = static_cast<device_state*>(user_data);
+    {
+        std::lock_guard lck { self->reconnect_mtx_ };
+        self->reconnect_wakeup_ = true;
+    }
+    self->reconnect_cv_.notify_all();
+}
+
+
+void device_state::reconnect_thread_main(std::string serial, tcam::TCAM_DEVICE_TYPE type)
+{
+    tcam::set_thread_name("tcam_reconnect");
+
+    // the device may return before the Indexer noticed that it was gone,
+    // so the event only shortens the wait and the lookup is repeated
+    constexpr auto poll_interval = std::chrono::milliseconds(100);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(reconnect_timeout_ms_);
+
+    tcam::DeviceIndex index;
+    index.register_device_added(&device_state::reconnect_device_added, this);
+
+    std::shared_ptr<tcam::CaptureDevice> dev;
+    bool cancelled = false;
+
+    while (true)
+    {
+        dev = tcam::open_device(serial, type);
+        if (dev)
+        {
+            break;
+        }
+
+        std::unique_lock lck { reconnect_mtx_ };
+        reconnect_cv_.wait_until(lck,
+                                 std::min(std::chrono::steady_clock::now() + poll_interval, deadline),
+                                 [this] { return reconnect_cancel_ || reconnect_wakeup_; });
+        reconnect_wakeup_ = false;
+        cancelled = reconnect_cancel_;
+
+        if (cancelled || std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+
+    index.remove_callbacks(this);
+
+    if (!cancelled && dev)
+    {
+        {
+            std::lock_guard lck { reconnect_mtx_ };
+            cancelled = reconnect_cancel_;
+        }
+        if (!cancelled && swap_device(dev))
+        {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+            GST_INFO_OBJECT(
+                parent_, "Reconnected device %s after %lld ms", serial.c_str(), (long long)ms);
+
+            g_signal_emit_by_name(G_OBJECT(parent_), "device-open");
+
+            reconnect_done_ = true;
+            return;
+        }
+    }
+
+    if (!cancelled)
+    {
+        GST_WARNING_OBJECT(parent_, "Unable to reconnect device %s.", serial.c_str());
+        report_device_lost(serial);
+    }
+
+    reconnect_done_ = true;
+}
+
+
+bool device_state::swap_device(const std::shared_ptr<tcam::CaptureDevice>& dev)
+{
+    std::lock_guard stream_lck { stream_mtx_ };
+    std::lock_guard open_lck { device_open_mutex_ };
+
+    if (!device_)
+    {
+        return false;
+    }
+
+    // joins the backend thread, which takes requeue_mtx_ itself
+    device_->stop_stream();
+
+    tcamprop_container_.clear_list();
+    tcamprop_interface_.clear();
+    change_notifier_ = nullptr;
+    {
+        std::lock_guard batch_lck { property_batch_mtx_ };
+        property_batches_.clear();
+    }
+
+    auto old_device = std::exchange(device_, dev);
+
+    populate_tcamprop_interface();
+
+    gst_helper::gst_ptr<GstStructure> saved;
+    {
+        std::lock_guard lck { saved_properties_mtx_ };
+        saved = saved_properties_;
+    }
+    if (saved)
+    {
+        // one transaction, v4l2 devices get all values with a single request
+        apply_properties(*saved);
+    }
+
+    device_->set_drop_incomplete_frames(drop_incomplete_frames_);
+    device_->set_transport_options(transport_options_);
+    device_->set_salvage_options(salvage_options_);
+    device_->set_chunk_mode(chunk_data_);
+    device_->set_decimation_options(decimation_options_);
+    device_->set_image_statistics_histogram(image_statistics_ && image_statistics_histogram_);
+    device_->set_auto_group(auto_group_, auto_group_master_);
+    device_->set_locality_placement(numa_locality_);
+
+    if (device_lost_cb_)
+    {
+        device_->register_device_lost_callback(device_lost_cb_, device_lost_user_data_);
+    }
+    setup_device_link();
+
+    {
+        // releases must not requeue the ImageBuffers of the lost device into the new one
+        std::lock_guard requeue_lck { requeue_mtx_ };
+
+        old_device->free_stream();
+
+        // caps, GstBuffers and memory stay, only the ImageBuffers wrapping the memory are new
+        if (!device_->configure_stream(format_, sink, buffer_pool))
+        {
+            GST_ERROR_OBJECT(parent_, "Unable to configure the stream of the reconnected device.");
+            return false;
+        }
+
+        if (parent_->pool)
+        {
+            gst_tcam_buffer_pool_rebind_buffer(GST_TCAM_BUFFER_POOL(parent_->pool));
+        }
+    }
+
+    {
+        std::scoped_lock lck { clock_mtx_ };
+        clock_estimator_.reset();
+    }
+
+    discont_pending_ = true;
+
+    if (!device_->start_stream())
+    {
+        GST_ERROR_OBJECT(parent_, "Unable to start the stream of the reconnected device.");
+        return false;
+    }
     return true;
 }
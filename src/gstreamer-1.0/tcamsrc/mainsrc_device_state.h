@@ -16,18 +16,27 @@
 
 #pragma once
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../BroadcastSink.h"
+#include "../../latency_tracing.h"
+#include "../../metrics.h"
+#include "../../spsc_ring.h"
 #include "../../tcam.h"
+#include "camera_clock_estimator.h"
 #include "gsttcambufferpool.h"
 #include "gsttcammainsrc.h"
 
 #include <condition_variable>
+#include <functional>
 #include <gst-helper/helper_functions.h>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
+#include <string_view>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 #include <tcamprop1.0_gobject/tcam_property_provider.h>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace tcam::mainsrc
@@ -46,15 +55,54 @@ struct buffer_info
     void* addr = nullptr;
     GstBuffer* gst_buffer = nullptr;
     std::shared_ptr<tcam::ImageBuffer> tcam_buffer;
-    bool pooled;
+    bool pooled = true;
+    // the device was replaced while downstream held the buffer, the new stream already queued
+    // the memory. Frames for it are dropped and the release does not requeue it.
+    bool detached = false;
 };
 
 //std::vector<buffer_info> get_buffer_collection(GstTcamBufferPool* pool);
 
+// commits a device property transaction for the TcamPropertyProvider batch writes
+struct transaction_write_batch : tcamprop1::write_batch_interface
+{
+    explicit transaction_write_batch(std::unique_ptr<tcam::property::IPropertyTransaction> t)
+        : transaction(std::move(t))
+    {
+    }
+
+    auto commit() -> std::error_code final
+    {
+        auto res = transaction->commit();
+        if (!res)
+        {
+            return res.error();
+        }
+        return {};
+    }
+
+    std::unique_ptr<tcam::property::IPropertyTransaction> transaction;
+};
+
 struct src_interface_list : tcamprop1::property_list_interface
 {
     std::vector<std::unique_ptr<tcamprop1::property_interface>> tcamprop_properties;
 
+    // every name based access of the TcamPropertyProvider resolves through find_property,
+    // the keys are the names of the entries in tcamprop_properties
+    std::unordered_map<std::string_view, tcamprop1::property_interface*> index_;
+
+    // returns false when a property with this name already exists, prop is dropped then
+    bool add(std::unique_ptr<tcamprop1::property_interface> prop)
+    {
+        auto [iter, added] = index_.emplace(prop->get_property_name(), prop.get());
+        if (added)
+        {
+            tcamprop_properties.push_back(std::move(prop));
+        }
+        return added;
+    }
+
     auto get_property_list() -> std::vector<std::string_view> final
     {
         std::vector<std::string_view> ret;
@@ -66,18 +114,36 @@ struct src_interface_list : tcamprop1::property_list_interface
     }
     auto find_property(std::string_view name) -> tcamprop1::property_interface* final
     {
-        for (const auto& v : tcamprop_properties)
+        auto iter = index_.find(name);
+        if (iter == index_.end())
+        {
+            return nullptr;
+        }
+        return iter->second;
+    }
+
+    // set_tcam_values writes go to the device as one transaction, e.g. one VIDIOC_S_EXT_CTRLS
+    tcam::property::transaction_factory begin_transaction;
+
+    auto begin_write_batch() -> std::unique_ptr<tcamprop1::write_batch_interface> final
+    {
+        if (!begin_transaction)
         {
-            if (name == v->get_property_name())
-            {
-                return v.get();
-            }
+            return nullptr;
         }
-        return nullptr;
+        auto transaction = begin_transaction();
+        if (!transaction)
+        {
+            return nullptr;
+        }
+        return std::make_unique<transaction_write_batch>(std::move(transaction));
     }
+
     void clear() noexcept
     {
+        index_.clear();
         tcamprop_properties.clear();
+        begin_transaction = nullptr;
     }
 };
 } // namespace tcam::mainsrc
@@ -92,25 +158,176 @@ public: // data members currently still used in gstmainsrc.cpp, maybe move them
     std::shared_ptr<tcam::ImageSink> sink;
 
     std::shared_ptr<tcam::BufferPool> buffer_pool;
+    // buffer_pool wraps the memory of a downstream GstBufferPool
+    bool buffer_pool_imported_ = false;
+    // downstream announced GstVideoMeta in the allocation query, video/x-raw buffers carry the layout
+    bool downstream_video_meta_ = false;
     tcam::VideoFormat format_;
 
     GstTcamIOMode io_mode_ = GST_TCAM_IO_AUTO;
 
+    // used instead of the device allocator when huge pages or numa binding are requested
+    tcam::allocator_options allocator_options_;
+    // 'numa-locality', buffers without an explicit numa node and the stream threads
+    // are placed on the node of the device
+    bool numa_locality_ = false;
+    // 'user-allocator', provides all userptr buffers when set
+    std::shared_ptr<tcam::AllocatorInterface> user_allocator_;
+
+    // node of the device with numa_locality_, -1 otherwise or when it is unknown
+    int get_locality_numa_node() const;
+
+    std::shared_ptr<tcam::AllocatorInterface> get_allocator(tcam::TCAM_MEMORY_TYPE t) const;
+
 public: // streaming stuff
     std::mutex stream_mtx_;
-    std::condition_variable stream_cv_;
     std::atomic<bool> is_streaming_ = false;
 
-    std::queue<tcam::mainsrc::buffer_info> queue;
+    // serializes buffer returns from downstream, the delivery path does not take it
+    std::mutex requeue_mtx_;
+
+    // handoff between the backend thread and create()
+    // the entries point into the buffer list of the GstTcamBufferPool,
+    // the ring has to be drained before that list is cleared
+    // call queue.notify() after changing is_streaming_
+    tcam::spsc_ring<tcam::mainsrc::buffer_info*> queue;
 
 public: // sink init properties, should be moved into this object
-    int imagesink_buffers_ = 10;
+    // 'camera-buffers', -1 sizes the pool from the framerate and the allocation query
+    int imagesink_buffers_ = -1;
+    // 'low-memory', the automatic buffer count only covers what downstream holds
+    bool low_memory_ = false;
+    // buffer count of the negotiated stream, 0 before the first allocation query
+    int active_buffers_ = 0;
+
+    // downstream_min/downstream_max are the values of the allocation query, 0 when unknown
+    int calc_buffer_count(double framerate,
+                          unsigned int downstream_min,
+                          unsigned int downstream_max) const noexcept;
     bool drop_incomplete_frames_ = true;
+    // also add the GstStructure form of the statistics, defaults to TCAM_STATISTICS_STRUCTURE being set
+    bool statistics_structure_ = false;
+    // 'chunk-data', the device sends GenICam chunks that are attached as TcamChunkDataMeta
+    bool chunk_data_ = false;
+    // GigE stream tunables, passed to the device before streaming
+    tcam::tcam_transport_options transport_options_;
+    // report_missing_lines also attaches a TcamMissingLinesMeta to every buffer
+    tcam::tcam_salvage_options salvage_options_;
+    // 'image-statistics' attaches a TcamImageStatisticsMeta to every buffer
+    bool image_statistics_ = false;
+    // 'image-statistics-histogram'
+    bool image_statistics_histogram_ = false;
+    // 'auto-group' and 'auto-group-master'
+    std::string auto_group_;
+    bool auto_group_master_ = false;
+    // 'decimation', 'decimation-max-rate' and 'decimation-auto-interval'
+    tcam::tcam_decimation_options decimation_options_;
+
+    // last value of 'thread-config', the configuration itself is process wide
+    std::string thread_config_;
+
+    // 'broadcast', the stream is published to other processes under this name when not empty
+    std::string broadcast_name_;
+    // only exists while streaming
+    std::shared_ptr<tcam::BroadcastSink> broadcast_;
+
+    // 'timestamp-mode=camera', buffers are stamped with the mapped camera time
+    bool camera_timestamps_ = false;
+    // fed with every frame by the stream thread, read when the buffer is pushed
+    std::mutex clock_mtx_;
+    tcam::mainsrc::camera_clock_estimator clock_estimator_;
+
+    // 'emit-frame-progress', the sink forwards partial frames of the backend as 'frame-progress'
+    bool emit_frame_progress_ = false;
+    // 'emit-frame-incoming', the sink forwards start of frame events as 'frame-incoming'
+    bool emit_frame_incoming_ = false;
+
+    // 'device-events', names of the GigE Vision events that are posted as 'tcam-device-event'
+    std::vector<std::string> device_events_;
+    // 'heartbeat-timeout', 0 keeps the default of the backend
+    guint heartbeat_timeout_ms_ = 0;
+
+    // enables device_events_ on the open device, logs when the device refuses
+    void apply_device_events();
+
+    // 'property-notify-interval', minimum time between two 'tcam-properties-changed' signals
+    guint property_notify_interval_ms_ = 100;
+    uint64_t last_property_notify_ns_ = 0;
+    // of the open device
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> change_notifier_;
+
+    // names of the properties that changed since the last call,
+    // empty while nothing changed or the interval has not passed yet
+    auto collect_property_changes() -> std::vector<std::string>;
+
+    // counters of the running stream, empty structure when the device has none
+    auto get_transport_statistics() const -> GstStructure*;
+
+    // buffer pool and backend staging memory
+    auto get_memory_usage() const -> GstStructure*;
+
+    // command property of the open device, e.g. TriggerSoftware for tcamsync, nullptr when there is none
+    auto find_command(std::string_view name) const
+        -> std::shared_ptr<tcam::property::IPropertyCommand>;
 
 public: // members used for num-buffers functionality
     int n_buffers_ = -1;
     uint64_t n_buffers_delivered_ = 0;
 
+public: // 'batch-size' and 'batch-timeout', frames pushed together as GstBufferList
+    // 1 pushes every frame on its own
+    guint batch_size_ = 1;
+    // longest wait in us for further frames once the first frame of a batch arrived
+    guint batch_timeout_us_ = 1000;
+
+public: // latency tracing, only filled when TCAM_LATENCY_TRACING is set
+    // feed the stamps of a delivered buffer into the windows below
+    void add_latency_sample(const TcamStatisticsValues& stats) noexcept;
+    // p50/p90/p99/max per stage in nanoseconds
+    auto get_latency_statistics() const -> GstStructure*;
+
+    tcam::latency::sliding_window latency_auto_pass_; // software properties
+    tcam::latency::sliding_window latency_backend_; // dequeue -> sink push
+    tcam::latency::sliding_window latency_handoff_; // sink push -> gst push
+    tcam::latency::sliding_window latency_total_; // dequeue -> gst push
+
+    // shared with libtcam, nullptr when TCAM_METRICS is not set
+    std::shared_ptr<tcam::metrics::stream_metrics> metrics_;
+
+public: // 'reconnect-timeout', reopening a lost device without ending the stream
+    // 0 disables the reconnect, the stream then ends with an error when the device is lost
+    guint reconnect_timeout_ms_ = 0;
+
+    // set when a reconnected device started streaming, the next buffer is flagged DISCONT
+    std::atomic<bool> discont_pending_ = false;
+
+    // the device was lost while streaming
+    // keeps caps and buffers and reopens the same serial in the background
+    // returns false when no reconnect is possible, the caller has to report the loss
+    bool begin_reconnect();
+    // stops a running reconnect, called before the stream is stopped or the device is closed
+    void cancel_reconnect();
+
+    // posts the device lost error and ends the stream
+    void report_device_lost(const std::string& serial);
+
+    // registered on every device that is opened, including the reconnected ones
+    void set_device_lost_callback(tcam::tcam_device_lost_callback cb, void* user_data);
+
+    // tcam-properties restored after a reconnect
+    // updated on stream start, after property batches and when tcam-properties is set
+    void save_property_state();
+
+public: // 'async-open', NULL->READY only starts the open, see begin_async_open
+    bool async_open_ = false;
+
+    // runs open_func in its own thread, the state change returns right away
+    void begin_async_open(std::function<bool()> open_func);
+    // blocks while an open of begin_async_open runs, returns immediately in that thread
+    void wait_for_async_open() const;
+    // waits for and joins the thread of begin_async_open
+    void finish_async_open();
+
 public: // init properties get/set methods. Note: These take the device_open_mutex_ lock internally
     bool set_device_serial(const std::string& str) noexcept;
     bool set_device_type(tcam::TCAM_DEVICE_TYPE type) noexcept;
@@ -140,6 +357,13 @@ public:
 
     void apply_properties(const GstStructure& strct);
 
+    // backing for the begin-property-batch/end-property-batch action signals
+    void begin_property_batch();
+    bool end_property_batch();
+
+    // backing for the move-roi action signal, see tcam::CaptureDevice::move_roi
+    bool move_roi(gint64 offset_x, gint64 offset_y);
+
     auto get_container() -> tcamprop1_gobj::tcam_property_provider&
     {
         return tcamprop_container_;
@@ -158,6 +382,10 @@ private:
     // cache for the device caps
     gst_helper::gst_ptr<GstCaps> all_caps_;
 
+    // open property transactions, innermost last
+    std::mutex property_batch_mtx_;
+    std::vector<std::unique_ptr<tcam::property::IPropertyTransaction>> property_batches_;
+
     // Reference to the GstElement owning this device_state instance
     GstTcamMainSrc* parent_ = nullptr;
 
@@ -166,4 +394,32 @@ private:
     tcamprop1_gobj::tcam_property_provider tcamprop_container_;
 
     void populate_tcamprop_interface();
+
+    // device_events_, heartbeat_timeout_ms_ and the event callback for a newly opened device
+    void setup_device_link();
+    static void device_event_callback(const tcam::tcam_device_event* event, void* user_data);
+
+    void reconnect_thread_main(std::string serial, tcam::TCAM_DEVICE_TYPE type);
+    // replaces the lost device with dev and resumes the stream, takes the locks itself
+    bool swap_device(const std::shared_ptr<tcam::CaptureDevice>& dev);
+    static void reconnect_device_added(const tcam::DeviceInfo& info, void* user_data);
+
+    tcam::tcam_device_lost_callback device_lost_cb_ = nullptr;
+    void* device_lost_user_data_ = nullptr;
+
+    std::thread reconnect_thread_;
+    std::atomic<bool> reconnect_done_ = false;
+    std::mutex reconnect_mtx_;
+    std::condition_variable reconnect_cv_;
+    bool reconnect_cancel_ = false;
+    // a device appeared, try to open before the next poll
+    bool reconnect_wakeup_ = false;
+
+    std::thread async_open_thread_;
+    mutable std::mutex async_open_mtx_;
+    mutable std::condition_variable async_open_cv_;
+    bool async_open_running_ = false;
+
+    std::mutex saved_properties_mtx_;
+    gst_helper::gst_ptr<GstStructure> saved_properties_;
 };
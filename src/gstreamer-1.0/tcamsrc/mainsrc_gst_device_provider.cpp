@@ -22,10 +22,8 @@
 #include "mainsrc_gst_device.h"
 
 #include <algorithm>
-#include <atomic>
-#include <condition_variable>
 #include <gst-helper/gst_ptr.h>
-#include <thread>
+#include <mutex>
 
 GST_DEBUG_CATEGORY_STATIC(tcam_deviceprovider_debug);
 #define GST_CAT_DEFAULT tcam_deviceprovider_debug
@@ -59,10 +57,9 @@ struct provider_state
     tcam::DeviceIndex index_;
     std::vector<device> known_devices_;
 
-    std::condition_variable cv_;
     std::mutex mtx_;
-    std::atomic<bool> run_updates_;
-    std::thread update_thread_;
+    // set between start and stop, while set the list follows the indexer callbacks
+    bool run_updates_ = false;
 };
 } // namespace tcammainsrc
 
@@ -161,27 +158,28 @@ static void run_update_logic(std::unique_lock<std::mutex>& /*lck*/,
     }
 }
 
-static void update_device_list(TcamMainSrcDeviceProvider* self)
+// called from the indexer thread
+// the list of the indexer is complete at this point, get_device_list does not wait
+static void device_list_changed(const tcam::DeviceInfo& /*info*/, void* user_data)
 {
-    tcam::set_thread_name( "tcam_gstdevlst" );
-    std::unique_lock<std::mutex> lck( self->state->mtx_ );
-    while (self->state->run_updates_)
+    auto self = static_cast<TcamMainSrcDeviceProvider*>(user_data);
+
+    std::unique_lock<std::mutex> lck(self->state->mtx_);
+    if (!self->state->run_updates_)
     {
-        {
-            lck.unlock();
-            auto new_list = self->state->index_.get_device_list();
-            lck.lock();
+        return;
+    }
 
-            if (!self->state->run_updates_)
-            { // recheck state to provide early shutdown
-                return;
-            }
+    run_update_logic(lck, self, self->state->index_.get_device_list());
+}
 
-            run_update_logic(lck, self, std::move(new_list));
-        }
+static void stop_updates(TcamMainSrcDeviceProvider* self)
+{
+    // waits for running callbacks, those take mtx_
+    self->state->index_.remove_callbacks(self);
 
-        self->state->cv_.wait_for(lck, std::chrono::seconds(2));
-    }
+    std::scoped_lock lck(self->state->mtx_);
+    self->state->run_updates_ = false;
 }
 
 static void tcam_mainsrc_device_provider_init(TcamMainSrcDeviceProvider* self)
@@ -198,27 +196,29 @@ static GList* tcam_mainsrc_device_provider_probe(GstDeviceProvider* provider)
 {
     TcamMainSrcDeviceProvider* self = TCAM_MAINSRC_DEVICE_PROVIDER(provider);
 
-    std::unique_lock lck(self->state->mtx_);
-
     GList* ret = NULL;
-    if (self->state->run_updates_)
     {
-        for (const auto& device_entry : self->state->known_devices_)
+        std::scoped_lock lck(self->state->mtx_);
+        if (self->state->run_updates_)
         {
-            ret = g_list_append(ret, gst_object_ref(device_entry.gstdev.get()));
+            for (const auto& device_entry : self->state->known_devices_)
+            {
+                ret = g_list_append(ret, gst_object_ref(device_entry.gstdev.get()));
+            }
+            return ret;
         }
     }
-    else
+
+    // the provider exists once per process, every tcamsrc probes it on NULL->READY
+    // the index synchronizes itself, mtx_ would make concurrent probes wait for each other
+    for (const auto& device_entry : self->state->index_.get_device_list())
     {
-        for (const auto& device_entry : self->state->index_.get_device_list())
+        auto dev = tcam_mainsrc_device_new(self->state->factory_.get(), device_entry);
+        if (dev == nullptr)
         {
-            auto dev = tcam_mainsrc_device_new(self->state->factory_.get(), device_entry);
-            if (dev == nullptr)
-            {
-                continue;
-            }
-            ret = g_list_append(ret, dev);
+            continue;
         }
+        ret = g_list_append(ret, dev);
     }
     return ret;
 }
@@ -227,10 +227,16 @@ static gboolean tcam_mainsrc_device_provider_start(GstDeviceProvider* provider)
 {
     TcamMainSrcDeviceProvider* self = TCAM_MAINSRC_DEVICE_PROVIDER(provider);
 
+    // the first call waits for all backends, afterwards the callbacks can query the list
+    self->state->index_.get_device_list();
+
+    self->state->index_.register_device_added(&device_list_changed, self);
+    self->state->index_.register_device_lost(&device_list_changed, self);
+
     std::unique_lock<std::mutex> lck(self->state->mtx_);
-    run_update_logic(lck, self, self->state->index_.get_device_list());
     self->state->run_updates_ = true;
-    self->state->update_thread_ = std::thread(update_device_list, self);
+    // changes between the first call and the registration are covered by this one
+    run_update_logic(lck, self, self->state->index_.get_device_list());
 
     return TRUE;
 }
@@ -239,11 +245,9 @@ static void tcam_mainsrc_device_provider_stop(GstDeviceProvider* provider)
 {
     TcamMainSrcDeviceProvider* self = TCAM_MAINSRC_DEVICE_PROVIDER(provider);
 
-    self->state->run_updates_ = false;
-    self->state->cv_.notify_all();
-
-    self->state->update_thread_.join();
+    stop_updates(self);
 
+    std::scoped_lock lck(self->state->mtx_);
     self->state->known_devices_.clear();
 }
 
@@ -251,13 +255,7 @@ static void tcam_mainsrc_device_provider_dispose(GObject* object)
 {
     TcamMainSrcDeviceProvider* self = TCAM_MAINSRC_DEVICE_PROVIDER(object);
 
-    if (self->state->update_thread_.joinable())
-    {
-        self->state->run_updates_ = false;
-        self->state->cv_.notify_all();
-
-        self->state->update_thread_.join();
-    }
+    stop_updates(self);
 
     self->state->factory_.reset();
     self->state->known_devices_.clear();
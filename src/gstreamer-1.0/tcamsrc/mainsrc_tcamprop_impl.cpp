@@ -26,9 +26,23 @@ namespace tcam::mainsrc
 
 template<class TBase> struct TcamPropertyBase : TBase
 {
-    TcamPropertyBase(std::shared_ptr<tcam::property::IPropertyBase> prop) : m_prop(prop) {}
+    TcamPropertyBase(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                     std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : m_prop(prop), m_notifier(std::move(notifier))
+    {
+    }
 
     std::shared_ptr<tcam::property::IPropertyBase> m_prop;
+    std::shared_ptr<tcam::property::PropertyChangeNotifier> m_notifier;
+
+    // writes of device properties are only seen here, e.g. ExposureAuto locking ExposureTime
+    void notify_changed()
+    {
+        if (m_notifier)
+        {
+            m_notifier->notify_with_dependents(m_prop->get_name());
+        }
+    }
 
     auto get_property_name() const noexcept -> std::string_view final
     {
@@ -55,8 +69,9 @@ template<class TBase> struct TcamPropertyBase : TBase
 
 struct TcamPropertyInteger : TcamPropertyBase<tcamprop1::property_interface_integer>
 {
-    TcamPropertyInteger(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyInteger(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                        std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -93,6 +108,7 @@ struct TcamPropertyInteger : TcamPropertyBase<tcamprop1::property_interface_inte
         auto ret = tmp->set_value(value);
         if (ret)
         {
+            notify_changed();
             return tcam::status::Success;
         }
         return ret.error();
@@ -114,8 +130,9 @@ struct TcamPropertyInteger : TcamPropertyBase<tcamprop1::property_interface_inte
 
 struct TcamPropertyFloat : TcamPropertyBase<tcamprop1::property_interface_float>
 {
-    TcamPropertyFloat(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyFloat(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                      std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -154,6 +171,7 @@ struct TcamPropertyFloat : TcamPropertyBase<tcamprop1::property_interface_float>
 
         if (ret)
         {
+            notify_changed();
             return tcam::status::Success;
         }
         return ret.error();
@@ -175,8 +193,9 @@ struct TcamPropertyFloat : TcamPropertyBase<tcamprop1::property_interface_float>
 
 struct TcamPropertyBoolean : TcamPropertyBase<tcamprop1::property_interface_boolean>
 {
-    TcamPropertyBoolean(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyBoolean(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                        std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -207,6 +226,7 @@ struct TcamPropertyBoolean : TcamPropertyBase<tcamprop1::property_interface_bool
 
         if (ret)
         {
+            notify_changed();
             return tcam::status::Success;
         }
         return ret.error();
@@ -216,8 +236,9 @@ struct TcamPropertyBoolean : TcamPropertyBase<tcamprop1::property_interface_bool
 
 struct TcamPropertyEnumeration : TcamPropertyBase<tcamprop1::property_interface_enumeration>
 {
-    TcamPropertyEnumeration(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyEnumeration(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                            std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -255,6 +276,7 @@ struct TcamPropertyEnumeration : TcamPropertyBase<tcamprop1::property_interface_
         auto ret = tmp->set_value(value);
         if (ret)
         {
+            notify_changed();
             return tcam::status::Success;
         }
         return ret.error();
@@ -264,8 +286,9 @@ struct TcamPropertyEnumeration : TcamPropertyBase<tcamprop1::property_interface_
 
 struct TcamPropertyCommand : TcamPropertyBase<tcamprop1::property_interface_command>
 {
-    TcamPropertyCommand(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyCommand(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                        std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -289,8 +312,9 @@ struct TcamPropertyCommand : TcamPropertyBase<tcamprop1::property_interface_comm
 
 struct TcamPropertyString : TcamPropertyBase<tcamprop1::property_interface_string>
 {
-    TcamPropertyString(std::shared_ptr<tcam::property::IPropertyBase> prop)
-        : TcamPropertyBase { prop }
+    TcamPropertyString(std::shared_ptr<tcam::property::IPropertyBase> prop,
+                       std::shared_ptr<tcam::property::PropertyChangeNotifier> notifier)
+        : TcamPropertyBase { prop, std::move(notifier) }
     {
     }
 
@@ -316,40 +340,42 @@ struct TcamPropertyString : TcamPropertyBase<tcamprop1::property_interface_strin
         {
             return err;
         }
+        notify_changed();
         return {};
     }
 };
 } // namespace tcam::mainsrc
 
 auto tcam::mainsrc::make_wrapper_instance(
-    const std::shared_ptr<tcam::property::IPropertyBase>& prop)
+    const std::shared_ptr<tcam::property::IPropertyBase>& prop,
+    const std::shared_ptr<tcam::property::PropertyChangeNotifier>& notifier)
     -> std::unique_ptr<tcamprop1::property_interface>
 {
     switch (prop->get_type())
     {
         case tcamprop1::prop_type::Integer:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyInteger>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyInteger>(prop, notifier);
         }
         case tcamprop1::prop_type::Float:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyFloat>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyFloat>(prop, notifier);
         }
         case tcamprop1::prop_type::Boolean:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyBoolean>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyBoolean>(prop, notifier);
         }
         case tcamprop1::prop_type::Enumeration:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyEnumeration>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyEnumeration>(prop, notifier);
         }
         case tcamprop1::prop_type::Command:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyCommand>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyCommand>(prop, notifier);
         }
         case tcamprop1::prop_type::String:
         {
-            return std::make_unique<tcam::mainsrc::TcamPropertyString>(prop);
+            return std::make_unique<tcam::mainsrc::TcamPropertyString>(prop, notifier);
         }
     }
     return nullptr;
@@ -364,6 +390,9 @@ static auto tcammainsrc_get_provider_impl_from_interface(TcamPropertyProvider* i
     assert(self != nullptr);
     assert(self->device != nullptr);
 
+    // with 'async-open' the list is filled by the opening thread
+    self->device->wait_for_async_open();
+
     return &self->device->get_container();
 }
 
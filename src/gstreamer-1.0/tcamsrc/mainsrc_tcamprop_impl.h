@@ -18,13 +18,15 @@
 
 #include "../../../libs/gst-helper/include/tcamprop1.0_base/tcamprop_property_interface.h"
 #include "../../../libs/tcam-property/src/tcam-property-1.0.h"
+#include "../../PropertyChangeNotifier.h"
 #include "../../PropertyInterfaces.h"
 
 #include <memory>
 
 namespace tcam::mainsrc
 {
-auto make_wrapper_instance(const std::shared_ptr<tcam::property::IPropertyBase>& prop)
+auto make_wrapper_instance(const std::shared_ptr<tcam::property::IPropertyBase>& prop,
+                           const std::shared_ptr<tcam::property::PropertyChangeNotifier>& notifier)
     -> std::unique_ptr<tcamprop1::property_interface>;
 void gst_tcam_mainsrc_tcamprop_init(TcamPropertyProviderInterface* iface);
 
@@ -3,8 +3,10 @@
 #include "../../libtcam_base.h"
 #include "../../version.h"
 #include "../tcamgstbase/spdlog_gst_sink.h"
+#include "gsttcambroadcastsrc.h"
 #include "gsttcammainsrc.h"
 #include "gsttcamsrc.h"
+#include "gsttcamsync.h"
 #include "mainsrc_gst_device_provider.h"
 
 #include <tcamprop1.0_gobject/tcam_gerror.h>
@@ -86,6 +88,9 @@ static gboolean plugin_init(GstPlugin* plugin)
         plugin, "tcammainsrcdeviceprovider", GST_RANK_PRIMARY, TCAM_TYPE_MAINSRC_DEVICE_PROVIDER);
     gst_element_register(plugin, "tcamsrc", GST_RANK_PRIMARY, GST_TYPE_TCAM_SRC);
     gst_element_register(plugin, "tcammainsrc", GST_RANK_PRIMARY, GST_TYPE_TCAM_MAINSRC);
+    gst_element_register(
+        plugin, "tcambroadcastsrc", GST_RANK_NONE, GST_TYPE_TCAM_BROADCAST_SRC);
+    gst_element_register(plugin, "tcamsync", GST_RANK_NONE, GST_TYPE_TCAM_SYNC);
 
 
     GST_DEBUG_CATEGORY_INIT(
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TCAM_USER_ALLOCATOR_H
+#define TCAM_USER_ALLOCATOR_H
+
+
+#include <glib.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+#define TCAM_USER_ALLOCATOR_VERSION 1
+
+/*
+ * Memory provided by the application for the userptr buffers of tcammainsrc,
+ * e.g. pinned memory of cudaHostAlloc, RDMA registered memory or a memfd pool.
+ * The device writes the images directly into it and the buffers pushed downstream wrap it.
+ *
+ * Set it through the 'user-allocator' property of tcamsrc or tcammainsrc in GST_STATE_READY or below.
+ * tcammainsrc copies the struct. alloc and free may be called from any thread,
+ * all buffers are freed before destroy is called.
+ */
+typedef struct _TcamUserAllocator TcamUserAllocator;
+
+struct _TcamUserAllocator
+{
+    guint version; // TCAM_USER_ALLOCATOR_VERSION
+
+    // returns size bytes aligned to at least 64 bytes, NULL on failure
+    // v4l2 devices may require page aligned memory
+    gpointer (*alloc)(gpointer user_data, gsize size);
+    void (*free)(gpointer user_data, gpointer ptr, gsize size);
+
+    gpointer user_data;
+    // called when tcammainsrc does not use the allocator anymore, may be NULL
+    GDestroyNotify destroy;
+};
+
+G_END_DECLS
+
+#if __cplusplus
+}
+#endif
+
+#endif /* TCAM_USER_ALLOCATOR_H */
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "latency_stamp.h"
+
+#include <cstring>
+#include <dutils_img/image_fourcc_func.h>
+
+namespace
+{
+
+constexpr uint8_t stamp_marker = 0xA5;
+constexpr int stamp_bits = 8 + 64 + 8;
+// smallest block that still has an undisturbed center after debayering
+constexpr int min_block_size = 4;
+
+
+// even, so that a block covers whole bayer cells
+int calc_block_size(const img::dim& dim) noexcept
+{
+    const int size = (dim.cx / stamp_bits) & ~1;
+    if (size < min_block_size || dim.cy < size)
+    {
+        return 0;
+    }
+    return size;
+}
+
+
+int calc_bits_per_pixel(img::fourcc fcc) noexcept
+{
+    if (img::is_multi_plane_format(fcc))
+    {
+        // only the first plane carries the stamp
+        return img::planar::get_fcc_info(fcc).planes[0].bits_per_pixel;
+    }
+    return img::get_bits_per_pixel(fcc);
+}
+
+
+// offset of the most significant byte of the first channel of a pixel
+int calc_sample_offset(img::fourcc fcc) noexcept
+{
+    using img::fourcc;
+    if (img::is_by16_fcc(fcc)
+        || img::is_fcc_in_fcclist(
+            fcc, { fourcc::MONO16, fourcc::RAW16, fourcc::BGRA64, fourcc::YUV16PLANAR }))
+    {
+        return 1;
+    }
+    if (fcc == fourcc::UYVY)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+
+bool is_float_fcc(img::fourcc fcc) noexcept
+{
+    using img::fourcc;
+    return img::is_byfloat_fcc(fcc)
+           || img::is_fcc_in_fcclist(
+               fcc,
+               {
+                   fourcc::MONOFloat,
+                   fourcc::YUVF32PLANAR,
+                   fourcc::RGBF32PLANAR,
+                   fourcc::RGBF16PLANAR,
+               });
+}
+
+
+uint8_t calc_checksum(uint64_t time_ns) noexcept
+{
+    uint8_t ret = 0x5A;
+    for (int i = 0; i < 8; ++i) { ret ^= static_cast<uint8_t>(time_ns >> (i * 8)); }
+    return ret;
+}
+
+
+bool get_stamp_bit(int index, uint64_t time_ns) noexcept
+{
+    if (index < 8)
+    {
+        return (stamp_marker >> (7 - index)) & 1;
+    }
+    if (index < 8 + 64)
+    {
+        return (time_ns >> (63 - (index - 8))) & 1;
+    }
+    return (calc_checksum(time_ns) >> (7 - (index - 8 - 64))) & 1;
+}
+
+} // namespace
+
+
+bool tcam::latency::can_stamp(const img::img_type& type) noexcept
+{
+    return calc_block_size(type.dim) != 0 && calc_bits_per_pixel(type.fourcc_type()) != 0
+           && !is_float_fcc(type.fourcc_type());
+}
+
+
+void tcam::latency::write_frame_stamp(const img::img_descriptor& dst, uint64_t time_ns) noexcept
+{
+    if (dst.empty() || !can_stamp(dst.to_img_type()))
+    {
+        return;
+    }
+
+    const int block = calc_block_size(dst.dim);
+    const int bits_per_pixel = calc_bits_per_pixel(dst.fourcc_type());
+
+    for (int i = 0; i < stamp_bits; ++i)
+    {
+        const int begin = (i * block * bits_per_pixel) / 8;
+        const int end = ((i + 1) * block * bits_per_pixel + 7) / 8;
+        const int value = get_stamp_bit(i, time_ns) ? 0xFF : 0x00;
+
+        for (int y = 0; y < block; ++y)
+        {
+            memset(img::get_line_start(dst, y) + begin, value, end - begin);
+        }
+    }
+}
+
+
+std::optional<uint64_t> tcam::latency::read_frame_stamp(const img::img_descriptor& src) noexcept
+{
+    if (src.empty() || !can_stamp(src.to_img_type()))
+    {
+        return std::nullopt;
+    }
+
+    const int block = calc_block_size(src.dim);
+    const int bits_per_pixel = calc_bits_per_pixel(src.fourcc_type());
+    const int sample_offset = calc_sample_offset(src.fourcc_type());
+
+    const uint8_t* line = img::get_line_start(src, block / 2);
+
+    uint8_t marker = 0;
+    uint64_t time_ns = 0;
+    uint8_t checksum = 0;
+    for (int i = 0; i < stamp_bits; ++i)
+    {
+        const int x = i * block + block / 2;
+        const bool bit = line[(x * bits_per_pixel) / 8 + sample_offset] >= 0x80;
+
+        if (i < 8)
+        {
+            marker = (marker << 1) | bit;
+        }
+        else if (i < 8 + 64)
+        {
+            time_ns = (time_ns << 1) | bit;
+        }
+        else
+        {
+            checksum = (checksum << 1) | bit;
+        }
+    }
+
+    if (marker != stamp_marker || checksum != calc_checksum(time_ns))
+    {
+        return std::nullopt;
+    }
+    return time_ns;
+}
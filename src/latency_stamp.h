@@ -0,0 +1,51 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <dutils_img/image_transform_base.h>
+#include <optional>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::latency
+{
+
+/**
+ * Timestamp that is rendered into the pixels of a frame.
+ *
+ * The stamp is a row of black and white blocks at the top left of the image:
+ * 8 marker bits, the 64 bits of the timestamp and an 8 bit checksum.
+ * Blocks are large and only their center is read, so the stamp survives debayering,
+ * format conversion and white balance. Scaling and cropping destroy it.
+ * The block size only depends on the image width, it has to be the same at write and read.
+ */
+
+// false when the image is too small to carry a stamp
+bool can_stamp(const img::img_type& type) noexcept;
+
+// overwrites the top left of dst with time_ns, does nothing when can_stamp() is false
+void write_frame_stamp(const img::img_descriptor& dst, uint64_t time_ns) noexcept;
+
+// nullopt when src carries no stamp or the checksum does not match
+std::optional<uint64_t> read_frame_stamp(const img::img_descriptor& src) noexcept;
+
+} // namespace tcam::latency
+
+VISIBILITY_POP
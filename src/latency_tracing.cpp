@@ -0,0 +1,99 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "latency_tracing.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <ctime>
+
+using namespace tcam::latency;
+
+uint64_t tcam::latency::now_ns()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+
+bool tcam::latency::is_enabled()
+{
+    // libtcam and the gstreamer plugins each carry their own copy of this,
+    // the environment is the only switch they all see
+    // the latency histograms of TCAM_METRICS need the stamps, too
+    static const bool enabled = tcam::is_environment_variable_set("TCAM_LATENCY_TRACING")
+                                || tcam::is_environment_variable_set("TCAM_METRICS");
+    return enabled;
+}
+
+
+sliding_window::sliding_window(size_t size) : samples_(std::max<size_t>(size, 1), 0) {}
+
+
+void sliding_window::add(uint64_t duration_ns)
+{
+    std::scoped_lock lck(mtx_);
+
+    samples_[next_] = duration_ns;
+    if (++next_ == samples_.size())
+    {
+        next_ = 0;
+        wrapped_ = true;
+    }
+}
+
+
+percentiles sliding_window::get() const
+{
+    std::vector<uint64_t> tmp;
+    {
+        std::scoped_lock lck(mtx_);
+        tmp.assign(samples_.begin(), wrapped_ ? samples_.end() : samples_.begin() + next_);
+    }
+
+    percentiles ret;
+    if (tmp.empty())
+    {
+        return ret;
+    }
+
+    ret.sample_count = tmp.size();
+
+    auto nth = [&tmp](unsigned int percent)
+    {
+        auto pos = tmp.begin() + (tmp.size() - 1) * percent / 100;
+        std::nth_element(tmp.begin(), pos, tmp.end());
+        return *pos;
+    };
+
+    ret.p50 = nth(50);
+    ret.p90 = nth(90);
+    ret.p99 = nth(99);
+    ret.max = *std::max_element(tmp.begin(), tmp.end());
+
+    return ret;
+}
+
+
+void sliding_window::clear()
+{
+    std::scoped_lock lck(mtx_);
+
+    next_ = 0;
+    wrapped_ = false;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::latency
+{
+
+/**
+ * Monotonic time in nanoseconds.
+ * Uses the same clock as the v4l2 buffer timestamps.
+ */
+uint64_t now_ns();
+
+/**
+ * Runtime switch for the per stage timestamps.
+ * Set by the environment variables TCAM_LATENCY_TRACING or TCAM_METRICS,
+ * the value is read once per process.
+ */
+bool is_enabled();
+
+// now_ns() when tracing is enabled, otherwise 0
+inline uint64_t stamp()
+{
+    return is_enabled() ? now_ns() : 0;
+}
+
+struct percentiles
+{
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+    uint64_t sample_count = 0;
+};
+
+/**
+ * Keeps the last N durations of a pipeline stage.
+ * add() and get() may be called from different threads.
+ */
+class sliding_window
+{
+public:
+    explicit sliding_window(size_t size = 600);
+
+    void add(uint64_t duration_ns);
+
+    // adds end - begin, ignored when one of the stamps is missing
+    void add(uint64_t begin_ns, uint64_t end_ns)
+    {
+        if (begin_ns != 0 && end_ns >= begin_ns)
+        {
+            add(end_ns - begin_ns);
+        }
+    }
+
+    percentiles get() const;
+
+    void clear();
+
+private:
+    mutable std::mutex mtx_;
+    std::vector<uint64_t> samples_;
+    size_t next_ = 0;
+    bool wrapped_ = false;
+};
+
+} // namespace tcam::latency
+
+VISIBILITY_POP
@@ -1,9 +1,11 @@
 
 #include "libtcam_base.h"
 
+#include "utils.h"
 #include "version.h"
 
 #include <cstdlib>
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 namespace
@@ -11,6 +13,9 @@ namespace
 static constexpr auto tcam_default_loglevel_release = spdlog::level::err;
 static constexpr auto tcam_default_loglevel_debug = spdlog::level::info;
 
+// messages waiting for the log thread, the oldest are overwritten when it falls behind
+static constexpr size_t async_queue_size = 4096;
+
 auto fetch_default_log_level() noexcept
 {
 #if defined _DEBUG
@@ -26,7 +31,23 @@ struct default_logger_init
 {
     default_logger_init()
     {
-        default_logger_ = std::make_shared<spdlog::logger>("libtcam");
+        // the sinks (GStreamer debug, stdout) run on a separate thread,
+        // a log storm costs the stream threads a copy of the message and no i/o
+        if (tcam::is_environment_variable_set("TCAM_LOG_SYNC"))
+        {
+            default_logger_ = std::make_shared<spdlog::logger>("libtcam");
+        }
+        else
+        {
+            thread_pool_ = std::make_shared<spdlog::details::thread_pool>(
+                async_queue_size, 1, [] { tcam::set_thread_name("tcam_log"); });
+            default_logger_ = std::make_shared<spdlog::async_logger>(
+                "libtcam",
+                spdlog::sinks_init_list {},
+                thread_pool_,
+                spdlog::async_overflow_policy::overrun_oldest);
+        }
+        default_logger_->flush_on(spdlog::level::err);
 
         spdlog::set_level(fetch_default_log_level());
         spdlog::set_error_handler(
@@ -37,6 +58,19 @@ struct default_logger_init
         spdlog::set_default_logger(default_logger_);
     }
 
+    ~default_logger_init()
+    {
+        if (!thread_pool_)
+        {
+            return;
+        }
+        // static destructors that run later still log, write those directly
+        auto sync_logger = std::make_shared<spdlog::logger>(
+            "libtcam", default_logger_->sinks().begin(), default_logger_->sinks().end());
+        sync_logger->set_level(default_logger_->level());
+        spdlog::set_default_logger(sync_logger);
+    }
+
     void add_stdout_logger_sink()
     {
         if (!has_stdout_logger)
@@ -49,6 +83,8 @@ struct default_logger_init
 
     bool has_stdout_logger = false;
 
+    // declared first, so it is destroyed last and drains the queue while the logger still exists
+    std::shared_ptr<spdlog::details::thread_pool> thread_pool_;
     std::shared_ptr<spdlog::logger> default_logger_;
 };
 
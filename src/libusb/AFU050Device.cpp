@@ -17,6 +17,8 @@
 #include "AFU050Device.h"
 
 #include "../logging.h"
+#include "../scope_tracing.h"
+#include "../usdt_probes.h"
 #include "AFU050DeviceBackend.h"
 #include "AFU050PropertyImpl.h"
 #include "UsbHandler.h"
@@ -128,35 +130,7 @@ void AFU050Device::create_formats()
 
 void AFU050Device::add_dependency_tracking()
 {
-    for (auto& p : properties_)
-    {
-        auto ptr = std::dynamic_pointer_cast<tcam::property::PropertyLock>(p);
-        if (!ptr)
-            continue;
-
-        auto dep_names = ptr->get_dependent_names();
-        if (dep_names.empty())
-        {
-            continue;
-        }
-
-        std::vector<std::weak_ptr<tcam::property::PropertyLock>> can_be_locked;
-
-        for (auto& possible_dependency : properties_)
-        {
-            if (std::find(dep_names.begin(), dep_names.end(), possible_dependency->get_name())
-                != dep_names.end())
-            {
-                can_be_locked.push_back(
-                    std::dynamic_pointer_cast<tcam::property::PropertyLock>(possible_dependency));
-            }
-        }
-
-        if (!can_be_locked.empty())
-        {
-            ptr->set_dependent_properties(std::move(can_be_locked));
-        }
-    }
+    tcam::property::link_dependent_properties(properties_);
 }
 
 
@@ -360,19 +334,18 @@ void tcam::AFU050Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
 {
     std::scoped_lock lck { buffer_list_mtx_ };
 
-    for (auto& b : buffer_list_)
+    const size_t index = buf->get_pool_index();
+    if (index < buffer_list_.size() && buffer_list_.at(index).buffer == buf)
     {
-        if (b.buffer->get_image_buffer_ptr() == buf->get_image_buffer_ptr())
-        {
-            b.is_queued = true;
-            return;
-        }
+        buffer_list_.at(index).is_queued = true;
     }
 }
 
 
 void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
 {
+    TCAM_TRACE_SCOPE("AFU050Device::transfer_callback");
+
     if (transfer->status != LIBUSB_TRANSFER_COMPLETED)
     {
         if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
@@ -386,7 +359,7 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
             libusb_free_transfer(transfer);
             return;
         }
-        SPDLOG_ERROR("libusb transfer returned with: {}", transfer->status);
+        TCAM_ERROR_RATE_LIMITED("libusb transfer returned with: {}", transfer->status);
     }
 
     if (!is_stream_on_)
@@ -434,7 +407,7 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
 
             if ((current_jpegsize_ + cplen) > JPEGBUF_SIZE)
             {
-                SPDLOG_ERROR("Image is too big. Dropping...");
+                TCAM_ERROR_RATE_LIMITED("Image is too big. Dropping...");
                 //JPEG too big, dropping
                 current_jpegbuf_index_ = 0;
                 current_jpegsize_ = 0;
@@ -453,6 +426,7 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
                 if (buffer == nullptr)
                 {
                     ++frames_dropped_;
+                    ++drops_.no_buffer;
                     SPDLOG_TRACE("Failed to fetch free buffer");
                 }
                 else
@@ -463,6 +437,7 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
                     tcam_stream_statistics stats = {};
                     stats.frame_count = frames_delivered_;
                     stats.frames_dropped = frames_dropped_;
+                    stats.drops = drops_;
 
                     auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
 
@@ -472,6 +447,9 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
                     buffer->set_valid_data_length(current_jpegsize_);
                     buffer->set_statistics(stats);
 
+                    TCAM_USDT_PROBE(frame_dequeue, stats.frame_count, buffer.get());
+                    UsbHandler::get_instance().report_frame(busy_poll_id_);
+
                     if (auto sink_ptr = listener_.lock())
                     {
                         ++frames_delivered_;
@@ -481,7 +459,7 @@ void tcam::AFU050Device::transfer_callback(libusb_transfer* transfer)
                     {
                         ++frames_dropped_;
                         requeue_buffer(buffer);
-                        SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
+                        TCAM_ERROR_RATE_LIMITED("ImageSink expired. Unable to deliver images.");
                     }
                 }
                 current_jpegbuf_index_ = 0;
@@ -539,10 +517,18 @@ bool tcam::AFU050Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
 
     frames_delivered_ = 0;
     frames_dropped_ = 0;
+    drops_ = {};
 
     current_jpegbuf_data_.clear();
     current_jpegbuf_data_.resize(JPEGBUF_SIZE);
 
+    busy_poll_id_ =
+        UsbHandler::get_instance().add_busy_poll_stream(active_video_format_.get_framerate());
+    // mjpeg, the raw frame size is the upper bound
+    const auto frame_size = active_video_format_.get_required_buffer_size();
+    bandwidth_id_ = UsbHandler::get_instance().add_bandwidth_stream(
+        device, frame_size, active_video_format_.get_framerate());
+
     for (int cnt = 0; cnt < TRANSFER_COUNT; cnt++)
     {
         uint8_t* buf = (uint8_t*)malloc(LEN_IN_BUFFER);
@@ -580,6 +566,11 @@ void tcam::AFU050Device::stop_stream()
 {
     is_stream_on_ = false;
 
+    UsbHandler::get_instance().remove_busy_poll_stream(busy_poll_id_);
+    busy_poll_id_ = -1;
+    UsbHandler::get_instance().remove_bandwidth_stream(bandwidth_id_);
+    bandwidth_id_ = -1;
+
     listener_.reset();
 
     release_buffers();
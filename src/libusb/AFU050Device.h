@@ -79,6 +79,11 @@ public:
 
     bool start_stream(const std::shared_ptr<IImageBufferSink>&) final;
 
+    int get_numa_node() final
+    {
+        return usb_device_ ? usb_device_->get_numa_node() : -1;
+    }
+
     void stop_stream() final;
 
     bool set_control(int unit, int ctrl, int len, unsigned char* value);
@@ -134,6 +139,12 @@ private:
     std::atomic_bool is_stream_on_ = false;
     long frames_delivered_ = 0;
     long frames_dropped_ = 0;
+    tcam_drop_statistics drops_ = {};
+
+    // registration with the busy polling of the UsbHandler, -1 when disabled
+    int busy_poll_id_ = -1;
+    // UsbBandwidthPlanner registration while streaming
+    int bandwidth_id_ = -1;
 
     size_t current_jpegsize_ = 0;
     int current_jpegbuf_index_ = 0;
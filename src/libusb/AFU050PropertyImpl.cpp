@@ -27,7 +27,11 @@ std::vector<std::string_view> tcam::property::AFU050PropertyLockImpl::get_depend
         if (dependent_controls_.empty())
             return;
 
-        bool new_locked_state = should_set_dependent_locked();
+        update_dependent_lock_state(should_set_dependent_locked());
+    }
+
+    void tcam::property::AFU050PropertyLockImpl::update_dependent_lock_state(bool new_locked_state)
+    {
         for (auto& dep : dependent_controls_)
         {
             if (auto d = dep.lock())
@@ -423,7 +427,10 @@ outcome::result<void> AFU050PropertyEnumImpl::set_value_int(int64_t new_value)
             SPDLOG_ERROR("Something went wrong while writing {}", m_name);
             return tcam::status::ResourceNotLockable;
         }
-        update_dependent_lock_state();
+        if (auto dep_entry = get_dependency_entry())
+        {
+            update_dependent_lock_state(dep_entry->locks_dependents(m_entries.at(new_value)));
+        }
     }
     else
     {
@@ -494,7 +501,7 @@ bool AFU050PropertyEnumImpl::should_set_dependent_locked() const
         return false;
     }
 
-    return res.value() == dep_entry->prop_enum_state_for_locked;
+    return dep_entry->locks_dependents(res.value());
 }
 
 
@@ -33,6 +33,8 @@ protected:
 
 protected:
     void update_dependent_lock_state();
+    // for callers that already know the new state, e.g. from the value they just wrote
+    void update_dependent_lock_state(bool new_locked_state);
 
     auto get_dependency_entry() const noexcept
     {
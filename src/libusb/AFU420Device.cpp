@@ -18,12 +18,16 @@
 
 #include "../logging.h"
 #include "../public_utils.h"
+#include "../scope_tracing.h"
+#include "../usdt_probes.h"
 #include "../utils.h"
 #include "AFU420DeviceBackend.h"
+#include "LibusbAllocator.h"
 #include "UsbHandler.h"
 #include "UsbSession.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <dutils_img/fcc_to_string.h>
 #include <dutils_img/image_fourcc_func.h>
@@ -33,6 +37,20 @@
 
 using namespace tcam;
 
+namespace
+{
+
+// the submitted transfers should be able to take this much data while the event thread is busy
+constexpr unsigned int default_queue_duration_ms = 100;
+
+constexpr size_t min_transfer_count = 4;
+constexpr size_t max_transfer_count = 64;
+
+constexpr size_t min_transfer_size = 64 * 1024;
+constexpr size_t max_transfer_size = 1024 * 1024;
+
+} // namespace
+
 tcam::AFU420Device::AFU420Device(const DeviceInfo& info)
 {
     device = info;
@@ -634,6 +652,16 @@ double tcam::AFU420Device::get_framerate()
 }
 
 
+std::shared_ptr<tcam::AllocatorInterface> tcam::AFU420Device::get_allocator()
+{
+    if (tcam::is_environment_variable_set("TCAM_USB_USE_DEV_MEM"))
+    {
+        return std::make_shared<tcam::libusb::LibusbAllocator>(usb_device_);
+    }
+    return get_default_allocator();
+}
+
+
 bool tcam::AFU420Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
 {
     auto buffs = pool->get_buffer();
@@ -647,6 +675,10 @@ bool tcam::AFU420Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
 bool tcam::AFU420Device::release_buffers()
 {
+    plan_buffer_.reset();
+    planned_buffers_.clear();
+    held_buffers_.clear();
+
     std::scoped_lock lck { buffers_mutex_ };
 
     buffer_list_.clear();
@@ -660,13 +692,11 @@ void AFU420Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
     buffer->set_valid_data_length(0);
 
     std::scoped_lock lck { buffers_mutex_ };
-    for (auto& b : buffer_list_)
+
+    const size_t index = buffer->get_pool_index();
+    if (index < buffer_list_.size() && buffer_list_.at(index).buffer == buffer)
     {
-        if (buffer == b.buffer)
-        {
-            b.is_queued = true;
-            break;
-        }
+        buffer_list_.at(index).is_queued = true;
     }
 }
 
@@ -674,11 +704,15 @@ void AFU420Device::push_buffer(std::shared_ptr<tcam::ImageBuffer>&& cur_buf)
 {
     assert(cur_buf != nullptr);
 
+    // incomplete frames still mark the arrival for the busy poll window
+    UsbHandler::get_instance().report_frame(busy_poll_id_);
+
     if (drop_incomplete_frames_ && (usbbulk_image_size_ - cur_buf->get_valid_data_length() != 0))
     {
         SPDLOG_TRACE("Image buffer does not contain enough data. Dropping frame...");
 
         frames_dropped_++;
+        drops_.incomplete++;
         requeue_buffer(cur_buf);
         return;
     }
@@ -686,6 +720,7 @@ void AFU420Device::push_buffer(std::shared_ptr<tcam::ImageBuffer>&& cur_buf)
     tcam_stream_statistics stats = {};
     stats.frame_count = frames_delivered_;
     stats.frames_dropped = frames_dropped_;
+    stats.drops = drops_;
 
     auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
     stats.capture_time_ns =
@@ -693,12 +728,18 @@ void AFU420Device::push_buffer(std::shared_ptr<tcam::ImageBuffer>&& cur_buf)
 
     cur_buf->set_statistics(stats);
 
-    frames_delivered_++;
+    TCAM_USDT_PROBE(frame_dequeue, stats.frame_count, cur_buf.get());
 
     if (!deliver_thread_.push(std::move(cur_buf)))
     {
+        // the sink does not keep up
+        frames_dropped_++;
+        drops_.no_buffer++;
         requeue_buffer(cur_buf);
+        return;
     }
+
+    frames_delivered_++;
 }
 
 
@@ -770,32 +811,47 @@ struct AFU420Device::header_res AFU420Device::check_and_eat_img_header(unsigned
 
 void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
 {
-    if (!is_stream_on_)
+    TCAM_TRACE_SCOPE("AFU420Device::transfer_callback");
+
+    size_t index = 0;
+    bool in_order = true;
     {
-        // do not free transfers
-        //libusb_free_transfer(xfr);
+        std::scoped_lock lck { in_flight_mutex_ };
 
-        //SPDLOG_DEBUG("stream is off");
-        return;
-    }
+        auto iter = std::find_if(in_flight_.begin(),
+                                 in_flight_.end(),
+                                 [this, xfr](size_t i)
+                                 { return transfer_items.at(i).transfer == xfr; });
+        if (iter == in_flight_.end())
+        {
+            return;
+        }
+        in_order = iter == in_flight_.begin();
+        index = *iter;
 
-    auto submit_transfer = [](struct libusb_transfer* _xfr)
-    {
-        if (libusb_submit_transfer(_xfr) < 0)
+        if (!accept_transfers_ || xfr->status == LIBUSB_TRANSFER_CANCELLED)
         {
-            SPDLOG_ERROR("error re-submitting URB\n");
+            // do not free transfers
+            transfer_items.at(index).segment = {};
+            in_flight_.erase(iter);
+            in_flight_cv_.notify_all();
+            return;
         }
-    };
+        in_flight_.erase(iter);
+    }
 
+    auto& seg = transfer_items.at(index).segment;
 
     if (xfr->status != LIBUSB_TRANSFER_COMPLETED)
     {
-        if (xfr->status == LIBUSB_TRANSFER_CANCELLED)
-        {
-            return;
-        }
         SPDLOG_WARN("transfer status {}", xfr->status);
-        submit_transfer(xfr);
+
+        // the data of this transfer is lost, the frame can not be completed
+        invalidate_plan();
+        finish_frame();
+
+        submit_transfer(index);
+        release_held_buffers();
 
         if (lost_countdown_ == 0)
         {
@@ -806,16 +862,200 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
         return;
     }
 
-    auto header = check_and_eat_img_header(xfr->buffer, xfr->length);
+    if (seg.planned && seg.generation == plan_generation_ && in_order)
+    {
+        if (!process_planned_segment(xfr, seg))
+        {
+            SPDLOG_DEBUG("Bulk stream out of sync. Falling back to copying until the next header.");
+            invalidate_plan();
+            finish_frame();
+        }
+    }
+    else
+    {
+        if (seg.planned && seg.generation == plan_generation_)
+        {
+            // completed out of order, no idea where this belongs
+            invalidate_plan();
+            finish_frame();
+        }
+        process_unplanned_segment(xfr);
+    }
+
+    lost_countdown_ = 20;
+    const size_t actual_length = xfr->actual_length;
+    submit_transfer(index);
+    release_held_buffers();
+
+    adapt_transfer_count(actual_length, current_buffer_ != nullptr);
+}
+
+
+void tcam::AFU420Device::adapt_transfer_count(size_t actual_length, bool in_frame)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    // between frames the camera sends nothing, these intervals say nothing about the queue
+    const bool measure = last_completion_in_frame_ && actual_length > 0;
+    const double interval_us =
+        std::chrono::duration<double, std::micro>(now - last_completion_).count();
+
+    last_completion_ = now;
+    last_completion_in_frame_ = in_frame;
+
+    if (!measure || transfer_count_fixed_)
+    {
+        return;
+    }
+
+    if (us_per_byte_ <= 0.0)
+    {
+        us_per_byte_ = interval_us / actual_length;
+        return;
+    }
+
+    const size_t count = transfer_items.size();
+
+    // time the thread was busy beyond what the transfer itself took
+    const double stall_us = interval_us - us_per_byte_ * actual_length;
+    // time the submitted transfers can take data
+    const double coverage_us = us_per_byte_ * count * transfer_size_;
+
+    if (stall_us > coverage_us / 2)
+    {
+        if (count >= max_transfer_count)
+        {
+            return;
+        }
+
+        const size_t wanted = std::min(
+            max_transfer_count, (size_t)std::ceil(count * 2 * stall_us / coverage_us));
+
+        SPDLOG_INFO("Bulk completion stalled for {:.0f} us, {} transfers cover {:.0f} us. "
+                    "Increasing to {} transfers.",
+                    stall_us,
+                    count,
+                    coverage_us,
+                    wanted);
+
+        for (size_t i = count; i < wanted; ++i)
+        {
+            if (!add_transfer())
+            {
+                break;
+            }
+        }
+        return;
+    }
+
+    // the stalls would otherwise hide themselves in the average
+    us_per_byte_ = 0.9 * us_per_byte_ + 0.1 * (interval_us / actual_length);
+}
+
+
+bool tcam::AFU420Device::process_planned_segment(struct libusb_transfer* xfr,
+                                                 transfer_segment& seg)
+{
+    const size_t header_size = get_packet_header_size();
+    const size_t actual_length = xfr->actual_length;
+    const size_t expected_length = std::min(seg.length, frame_size_ - seg.frame_pos);
+
+    if (actual_length > expected_length)
+    {
+        return false;
+    }
+
+    const unsigned char* data = xfr->buffer;
+    size_t data_size = actual_length;
+
+    if (seg.frame_pos == 0)
+    {
+        // in place, the header is not part of the image
+        auto header = check_and_eat_img_header(xfr->buffer, actual_length);
+        if (header.frame_id < 0)
+        {
+            return false;
+        }
+
+        // previous frame was not complete
+        finish_frame();
+
+        if (!planned_buffers_.empty() && planned_buffers_.front() == seg.buffer)
+        {
+            planned_buffers_.pop_front();
+        }
+
+        current_buffer_ = seg.buffer ? seg.buffer : get_next_buffer();
+        transfer_offset_ = 0;
+
+        if (current_buffer_ == nullptr)
+        {
+            SPDLOG_ERROR("No buffer to work with. Dropping image"); // Buffer starvation
+            frames_dropped_++;
+            drops_.no_buffer++;
+        }
+
+        data = header.buffer;
+        data_size = header.size;
+    }
+    else if (current_buffer_)
+    {
+        if (seg.frame_pos - header_size != (size_t)transfer_offset_)
+        {
+            return false;
+        }
+        if (seg.direct && seg.buffer != current_buffer_)
+        {
+            return false;
+        }
+    }
+
+    if (current_buffer_)
+    {
+        const size_t bytes_to_copy =
+            std::min(data_size, (size_t)(usbbulk_image_size_ - transfer_offset_));
+
+        if (!seg.direct)
+        {
+            current_buffer_->copy_block(data, bytes_to_copy, transfer_offset_);
+        }
+
+        transfer_offset_ += bytes_to_copy;
+
+        current_buffer_->set_valid_data_length(transfer_offset_);
+        report_partial_frame();
+    }
+
+    if (actual_length < expected_length)
+    {
+        // the camera ended the frame early, the data up to here is fine
+        finish_frame();
+        return false;
+    }
+
+    if (seg.frame_pos + actual_length >= frame_size_)
+    {
+        finish_frame();
+    }
+    return true;
+}
+
+
+void tcam::AFU420Device::process_unplanned_segment(struct libusb_transfer* xfr)
+{
+    auto header = check_and_eat_img_header(xfr->buffer, xfr->actual_length);
 
     bool is_header = header.frame_id >= 0;
-    bool is_trailer = (!is_header) && header.size < (size_t)usbbulk_chunk_size_;
+    // the frame ends with a short packet
+    bool is_trailer = xfr->actual_length < xfr->length;
 
     if (is_header)
     {
-        if (current_buffer_)
+        finish_frame();
+
+        if (zero_copy_ && !plan_valid_)
         {
-            push_buffer(std::move(current_buffer_));
+            replan_in_flight(is_trailer ? 0 : xfr->actual_length);
         }
 
         current_buffer_ = get_next_buffer();
@@ -824,7 +1064,7 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
         {
             SPDLOG_ERROR("No buffer to work with. Dropping image"); // Buffer starvation
             frames_dropped_++;
-            submit_transfer(xfr);
+            drops_.no_buffer++;
             return;
         }
 
@@ -834,7 +1074,7 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
 
     if (current_buffer_ == nullptr)
     {
-        submit_transfer(xfr); // just requeue und wait for the next header to arrive
+        // just requeue und wait for the next header to arrive
         return;
     }
 
@@ -847,25 +1087,298 @@ void tcam::AFU420Device::transfer_callback(struct libusb_transfer* xfr)
     transfer_offset_ += bytes_to_copy;
 
     current_buffer_->set_valid_data_length(transfer_offset_);
+    report_partial_frame();
 
     bool is_complete_image = transfer_offset_ >= usbbulk_image_size_;
     if (is_complete_image || is_trailer)
     {
-        if (current_buffer_)
+        finish_frame();
+    }
+}
+
+
+size_t tcam::AFU420Device::advance_frame_pos(size_t frame_pos, size_t length) const
+{
+    if (frame_size_ - frame_pos <= length)
+    {
+        // the short packet at the end of the frame completes the transfer
+        return 0;
+    }
+    return frame_pos + length;
+}
+
+
+void tcam::AFU420Device::replan_in_flight(size_t next_frame_pos)
+{
+    std::scoped_lock lck { in_flight_mutex_ };
+
+    // all submitted transfers complete in full or with the end of a frame
+    size_t pos = next_frame_pos;
+    for (auto i : in_flight_) { pos = advance_frame_pos(pos, transfer_items.at(i).segment.length); }
+
+    plan_pos_ = pos;
+    plan_buffer_.reset();
+    plan_valid_ = true;
+}
+
+
+void tcam::AFU420Device::invalidate_plan()
+{
+    if (!plan_valid_)
+    {
+        return;
+    }
+
+    plan_valid_ = false;
+    // submitted segments are now treated like copies
+    plan_generation_++;
+
+    plan_buffer_.reset();
+    for (auto& b : planned_buffers_) { held_buffers_.push_back({ std::move(b), false }); }
+    planned_buffers_.clear();
+}
+
+
+tcam::AFU420Device::transfer_segment tcam::AFU420Device::plan_segment()
+{
+    transfer_segment seg = {};
+    seg.length = transfer_size_;
+
+    if (!plan_valid_)
+    {
+        return seg;
+    }
+
+    const size_t header_size = get_packet_header_size();
+    const size_t remaining = frame_size_ - plan_pos_;
+
+    auto round_up = [this](size_t s)
+    {
+        return (s + max_packet_size_ - 1) / max_packet_size_ * max_packet_size_;
+    };
+
+    seg.planned = true;
+    seg.generation = plan_generation_;
+    seg.frame_pos = plan_pos_;
+
+    if (plan_pos_ == 0)
+    {
+        seg.length = std::min(round_up(header_size), transfer_size_);
+
+        // current and one following frame
+        plan_buffer_.reset();
+        if (planned_buffers_.size() < 2)
         {
-            push_buffer(std::move(current_buffer_));
-            current_buffer_.reset();
+            plan_buffer_ = get_next_buffer(false);
         }
-        have_header_ = false;
-        transfer_offset_ = 0;
+        if (plan_buffer_ && plan_buffer_->get_image_buffer_size() < (size_t)usbbulk_image_size_)
+        {
+            requeue_buffer(plan_buffer_);
+            plan_buffer_.reset();
+        }
+        if (plan_buffer_)
+        {
+            planned_buffers_.push_back(plan_buffer_);
+        }
+        seg.buffer = plan_buffer_;
     }
-    lost_countdown_ = 20;
-    submit_transfer(xfr);
+    else if (plan_buffer_ && remaining >= max_packet_size_)
+    {
+        // whole packets only, the short packet at the end of the frame
+        // must not be able to write behind the image
+        seg.direct = true;
+        seg.buffer = plan_buffer_;
+        seg.length = std::min(remaining / max_packet_size_ * max_packet_size_, transfer_size_);
+    }
+    else
+    {
+        seg.length = std::min(round_up(remaining), transfer_size_);
+    }
+
+    plan_pos_ = advance_frame_pos(plan_pos_, seg.length);
+
+    return seg;
+}
+
+
+bool tcam::AFU420Device::add_transfer()
+{
+    size_t index = 0;
+    {
+        std::scoped_lock lck { in_flight_mutex_ };
+
+        // capacity is reserved in start_stream, the items must not move
+        if (!accept_transfers_ || transfer_items.size() >= transfer_items.capacity())
+        {
+            return false;
+        }
+
+        transfer_items.push_back({});
+        index = transfer_items.size() - 1;
+
+        auto& item = transfer_items.back();
+        item.transfer = libusb_alloc_transfer(0);
+
+        // buffer and length are set by submit_transfer
+        libusb_fill_bulk_transfer((libusb_transfer*)item.transfer,
+                                  usb_device_->get_handle(),
+                                  LIBUSB_ENDPOINT_IN | USB_EP_BULK_VIDEO,
+                                  nullptr,
+                                  0,
+                                  AFU420Device::libusb_bulk_callback,
+                                  this,
+                                  0);
+    }
+
+    submit_transfer(index);
+    return true;
+}
+
+
+void tcam::AFU420Device::submit_transfer(size_t index)
+{
+    auto& item = transfer_items.at(index);
+    auto xfr = (struct libusb_transfer*)item.transfer;
+
+    item.segment = plan_segment();
+
+    if (item.segment.direct)
+    {
+        xfr->buffer = (unsigned char*)item.segment.buffer->get_image_buffer_ptr()
+                      + (item.segment.frame_pos - get_packet_header_size());
+    }
+    else
+    {
+        // staging is only allocated for transfers that are not written into the image directly
+        if (item.buffer.size() < item.segment.length)
+        {
+            staging_size_ += item.segment.length - item.buffer.size();
+            item.buffer.resize(item.segment.length);
+        }
+        xfr->buffer = item.buffer.data();
+    }
+    xfr->length = item.segment.length;
+
+    bool submitted = false;
+    {
+        std::scoped_lock lck { in_flight_mutex_ };
+
+        if (!accept_transfers_)
+        {
+            item.segment = {};
+            return;
+        }
+
+        if (libusb_submit_transfer(xfr) < 0)
+        {
+            TCAM_ERROR_RATE_LIMITED("error re-submitting URB");
+            item.segment = {};
+        }
+        else
+        {
+            in_flight_.push_back(index);
+            submitted = true;
+        }
+    }
+
+    if (!submitted)
+    {
+        // the stream position of the following transfers is unknown now
+        invalidate_plan();
+        finish_frame();
+    }
+}
+
+
+bool tcam::AFU420Device::is_transfer_target(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    std::scoped_lock lck { in_flight_mutex_ };
+
+    return std::any_of(in_flight_.begin(),
+                       in_flight_.end(),
+                       [this, &buffer](size_t i)
+                       { return transfer_items.at(i).segment.buffer == buffer; });
+}
+
+
+void tcam::AFU420Device::finish_frame()
+{
+    if (!current_buffer_)
+    {
+        return;
+    }
+
+    if (is_transfer_target(current_buffer_))
+    {
+        held_buffers_.push_back({ std::move(current_buffer_), true });
+    }
+    else
+    {
+        push_buffer(std::move(current_buffer_));
+    }
+    current_buffer_.reset();
+
+    have_header_ = false;
+    transfer_offset_ = 0;
+    partial_lines_ = 0;
 }
 
 
-std::shared_ptr<tcam::ImageBuffer> tcam::AFU420Device::get_next_buffer()
+void tcam::AFU420Device::report_partial_frame()
 {
+    if (!report_partial_frames_)
+    {
+        return;
+    }
+
+    const auto pitch = active_video_format.get_pitch_size();
+    if (pitch == 0)
+    {
+        return;
+    }
+
+    const auto lines = static_cast<unsigned int>(transfer_offset_) / pitch;
+    // the complete frame is delivered by push_buffer
+    if (lines <= partial_lines_ || lines >= active_video_format.get_size().height)
+    {
+        return;
+    }
+    partial_lines_ = lines;
+
+    if (auto sink = listener_.lock())
+    {
+        sink->push_partial_image(current_buffer_, lines);
+    }
+}
+
+
+void tcam::AFU420Device::release_held_buffers()
+{
+    for (auto iter = held_buffers_.begin(); iter != held_buffers_.end();)
+    {
+        if (is_transfer_target(iter->buffer))
+        {
+            ++iter;
+            continue;
+        }
+
+        if (iter->deliver)
+        {
+            push_buffer(std::move(iter->buffer));
+        }
+        else
+        {
+            requeue_buffer(iter->buffer);
+        }
+        iter = held_buffers_.erase(iter);
+    }
+}
+
+
+std::shared_ptr<tcam::ImageBuffer> tcam::AFU420Device::get_next_buffer(bool log_starvation)
+{
+    std::scoped_lock lck { buffers_mutex_ };
+
     if (buffer_list_.empty())
     {
         SPDLOG_ERROR("No buffers to work with.");
@@ -882,7 +1395,10 @@ std::shared_ptr<tcam::ImageBuffer> tcam::AFU420Device::get_next_buffer()
         }
     }
 
-    SPDLOG_ERROR("No free buffers available! {}", buffer_list_.size());
+    if (log_starvation)
+    {
+        TCAM_ERROR_RATE_LIMITED("No free buffers available! {}", buffer_list_.size());
+    }
     return nullptr;
 }
 
@@ -902,10 +1418,10 @@ bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
     // reset statistics
     frames_delivered_ = 0;
     frames_dropped_ = 0;
+    drops_ = {};
     transfer_offset_ = 0;
     have_header_ = false;
 
-    static const int num_transfers = 12;
     int chunk_size = 0;
 
     if (usb_device_->is_superspeed())
@@ -917,38 +1433,111 @@ bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
         chunk_size = 15 * 1024 * USB2_STACKUP_SIZE;
     }
 
-    transfer_items.clear();
-    transfer_items.reserve(num_transfers);
-
-    size_t buffer_size = 1024 * 1024;
-
     usbbulk_chunk_size_ = chunk_size;
 
     usbbulk_image_size_ = active_video_format.get_required_buffer_size();
 
-    for (int i = 0; i < num_transfers; ++i)
+    const int max_packet_size = usb_device_->get_max_packet_size(USB_EP_BULK_VIDEO);
+    max_packet_size_ = max_packet_size > 0 ? max_packet_size : 0;
+    frame_size_ = get_packet_header_size() + usbbulk_image_size_;
+
+    auto round_up_to_packet = [this](size_t s)
     {
-        transfer_items.push_back({});
-        transfer_items.at(i).transfer = libusb_alloc_transfer(0);
-        transfer_items.at(i).buffer.reserve(buffer_size);
+        if (max_packet_size_ == 0)
+        {
+            return s;
+        }
+        return std::max(max_packet_size_,
+                        (s + max_packet_size_ - 1) / max_packet_size_ * max_packet_size_);
+    };
 
-        struct libusb_transfer* xfr = (libusb_transfer*)transfer_items.at(i).transfer;
+    // a frame is split into a few transfers, so that the first ones are done before the frame ends
+    if (transport_options_.usb_transfer_size > 0)
+    {
+        transfer_size_ = round_up_to_packet(transport_options_.usb_transfer_size);
+    }
+    else
+    {
+        transfer_size_ = round_up_to_packet(
+            std::clamp(frame_size_ / 4, min_transfer_size, max_transfer_size));
+    }
 
-        libusb_fill_bulk_transfer(xfr,
-                                  usb_device_->get_handle(),
-                                  LIBUSB_ENDPOINT_IN | USB_EP_BULK_VIDEO,
-                                  (uint8_t*)transfer_items.at(i).buffer.data(),
-                                  transfer_items.at(i).buffer.capacity(),
-                                  AFU420Device::libusb_bulk_callback,
-                                  this,
-                                  0);
+    size_t num_transfers = 0;
+    transfer_count_fixed_ = transport_options_.usb_transfer_count > 0;
+    if (transfer_count_fixed_)
+    {
+        num_transfers = std::min((size_t)transport_options_.usb_transfer_count, max_transfer_count);
+    }
+    else
+    {
+        double fps = active_video_format.get_framerate();
+        if (fps <= 0.0)
+        {
+            fps = 1.0;
+        }
+        // header, image, tail
+        const size_t transfers_per_frame =
+            2 + (usbbulk_image_size_ + transfer_size_ - 1) / transfer_size_;
+
+        num_transfers = static_cast<size_t>(
+            std::ceil(fps * transfers_per_frame * default_queue_duration_ms / 1000.0));
+        num_transfers = std::clamp(num_transfers, min_transfer_count, max_transfer_count);
+    }
+
+    us_per_byte_ = 0.0;
+    last_completion_in_frame_ = false;
 
-        libusb_submit_transfer(xfr);
+    // without a short packet at the end the frame end is not predictable
+    zero_copy_ = max_packet_size_ > 0 && (frame_size_ % max_packet_size_) != 0
+                 && (transfer_size_ % max_packet_size_) == 0
+                 && !tcam::is_environment_variable_set("TCAM_USB_DISABLE_ZERO_COPY");
+
+    SPDLOG_DEBUG("Using {} bulk transfers of {} bytes. Zero copy is {}",
+                 num_transfers,
+                 transfer_size_,
+                 zero_copy_ ? "enabled" : "disabled");
+
+    plan_valid_ = false;
+    plan_generation_ = 0;
+    plan_pos_ = 0;
+    plan_buffer_.reset();
+    planned_buffers_.clear();
+    held_buffers_.clear();
+    {
+        std::scoped_lock lck { in_flight_mutex_ };
+        in_flight_.clear();
+
+        transfer_items.clear();
+        transfer_items.reserve(max_transfer_count);
+        staging_size_ = 0;
+
+        accept_transfers_ = true;
     }
 
     listener_ = sink;
+    report_partial_frames_ = sink && sink->wants_partial_images();
+    partial_lines_ = 0;
+
+    const int numa_node = get_placement_numa_node();
+    if (numa_node >= 0)
+    {
+        SPDLOG_INFO("Placing the delivery thread of {} on numa node {}",
+                    device.get_serial(),
+                    numa_node);
+    }
+
+    // before the first transfer can complete
+    {
+        std::scoped_lock lck { buffers_mutex_ };
+        deliver_thread_.start(sink, buffer_list_.size(), numa_node);
+    }
 
-    deliver_thread_.start(sink);
+    busy_poll_id_ = UsbHandler::get_instance().add_busy_poll_stream(
+        active_video_format.get_framerate());
+    bandwidth_id_ = UsbHandler::get_instance().add_bandwidth_stream(
+        device, frame_size_, active_video_format.get_framerate());
+
+    for (size_t i = 0; i < num_transfers; ++i) { add_transfer(); }
 
     unsigned char val = 0;
     int ret = control_write(BASIC_PC_TO_USB_START_STREAM, val);
@@ -957,6 +1546,10 @@ bool tcam::AFU420Device::start_stream(const std::shared_ptr<IImageBufferSink>& s
     {
         SPDLOG_ERROR("Stream could not be started. Aborting");
 
+        UsbHandler::get_instance().remove_busy_poll_stream(busy_poll_id_);
+        busy_poll_id_ = -1;
+        UsbHandler::get_instance().remove_bandwidth_stream(bandwidth_id_);
+        bandwidth_id_ = -1;
         listener_.reset();
 
         return false;
@@ -979,7 +1572,27 @@ void tcam::AFU420Device::stop_stream()
 
     deliver_thread_.stop();
 
-    for (auto& item : transfer_items) { libusb_cancel_transfer((libusb_transfer*)item.transfer); }
+    {
+        std::unique_lock lck { in_flight_mutex_ };
+
+        accept_transfers_ = false;
+        for (auto i : in_flight_)
+        {
+            libusb_cancel_transfer((libusb_transfer*)transfer_items.at(i).transfer);
+        }
+
+        // transfers may write into image buffers, wait for them before releasing the buffers
+        if (!in_flight_cv_.wait_for(
+                lck, std::chrono::seconds(1), [this] { return in_flight_.empty(); }))
+        {
+            SPDLOG_WARN("{} bulk transfers did not return after cancellation.", in_flight_.size());
+        }
+    }
+
+    UsbHandler::get_instance().remove_busy_poll_stream(busy_poll_id_);
+    busy_poll_id_ = -1;
+    UsbHandler::get_instance().remove_bandwidth_stream(bandwidth_id_);
+    bandwidth_id_ = -1;
 
     usb_device_->halt_endpoint(USB_EP_BULK_VIDEO);
 
@@ -997,9 +1610,12 @@ int AFU420Device::set_resolution_config(sResolutionConf conf, resolution_config_
 
     int hr = control_write(ADVANCED_PC_TO_USB_RES_FPS, test_mode, 0, serialized_conf);
 
-    uint32_t exp_max = 0, exp_min = 0;
-    control_read(exp_min, BASIC_USB_TO_PC_MIN_EXP, test_mode, 0);
-    control_read(exp_max, BASIC_USB_TO_PC_MAX_EXP, test_mode, 0);
+    // the firmware expects the exposure limits to be read after a new config,
+    // the values themselves are not used, so there is no need to wait for them
+    usb_device_->submit_control_transfer(
+        DEVICE_TO_HOST, BASIC_USB_TO_PC_MIN_EXP, test_mode, 0, std::vector<unsigned char>(4));
+    usb_device_->submit_control_transfer(
+        DEVICE_TO_HOST, BASIC_USB_TO_PC_MAX_EXP, test_mode, 0, std::vector<unsigned char>(4));
 
     return hr;
 }
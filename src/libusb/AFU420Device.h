@@ -29,6 +29,9 @@
 #include "struct_defines_rx.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <libusb-1.0/libusb.h>
 #include <memory>
 #include <mutex> // std::mutex, std::unique_lock
@@ -74,10 +77,7 @@ public:
 
     double get_framerate();
 
-    std::shared_ptr<tcam::AllocatorInterface> get_allocator() override
-    {
-        return get_default_allocator();
-    };
+    std::shared_ptr<tcam::AllocatorInterface> get_allocator() override;;
 
     bool initialize_buffers(std::shared_ptr<BufferPool> pool) final;
 
@@ -89,6 +89,16 @@ public:
 
     void stop_stream() final;
 
+    size_t get_staging_memory_size() final
+    {
+        return staging_size_;
+    }
+
+    int get_numa_node() final
+    {
+        return usb_device_ ? usb_device_->get_numa_node() : -1;
+    }
+
 
 #pragma pack(push, 1)
     struct strobe_data
@@ -162,7 +172,7 @@ private:
         set
     };
 
-    std::unique_ptr<LibusbDevice> usb_device_;
+    std::shared_ptr<LibusbDevice> usb_device_;
 
     const tcam_image_size max_sensor_dim_ = { 7716, 5360 };
     const tcam_image_size min_sensor_dim_ = { 264, 256 };
@@ -248,11 +258,17 @@ private:
     std::vector<buffer_info> buffer_list_;
     std::mutex buffers_mutex_;
 
-    std::shared_ptr<tcam::ImageBuffer> get_next_buffer();
+    std::shared_ptr<tcam::ImageBuffer> get_next_buffer(bool log_starvation = true);
 
     std::atomic_bool is_stream_on_ = false;
     size_t frames_delivered_ = 0;
     size_t frames_dropped_ = 0;
+    tcam_drop_statistics drops_ = {};
+
+    // registration with the busy polling of the UsbHandler, -1 when disabled
+    int busy_poll_id_ = -1;
+    // UsbBandwidthPlanner registration while streaming
+    int bandwidth_id_ = -1;
 
     int transfer_offset_ = 0;
     bool have_header_ = false;
@@ -260,9 +276,56 @@ private:
 
     std::weak_ptr<IImageBufferSink> listener_;
 
+    // the sink wants partial frames, evaluated in start_stream
+    bool report_partial_frames_ = false;
+    // lines of current_buffer_ that were already reported
+    unsigned int partial_lines_ = 0;
+    // report the complete lines of current_buffer_ to the sink
+    void report_partial_frame();
+
     static void LIBUSB_CALL libusb_bulk_callback(struct libusb_transfer* trans);
     void transfer_callback(struct libusb_transfer* transfer);
 
+    /*
+     * A frame is sent as header + image data and ends with a short packet.
+     *
+     * While the position of the next transfer in the frame is known (plan_valid_),
+     * transfers are submitted for one segment of the frame each: the header goes into
+     * the staging buffer of the transfer, the image data as far as it is a multiple
+     * of the max packet size directly into the ImageBuffer and the rest into the staging buffer again.
+     *
+     * Until the first header was seen or after anything unexpected happened the transfers
+     * go into their staging buffers and are copied.
+     */
+    struct transfer_segment
+    {
+        // frame_pos is known, the completion is validated against it
+        bool planned = false;
+        // the transfer writes into buffer instead of the staging buffer
+        bool direct = false;
+        unsigned int generation = 0;
+        size_t frame_pos = 0;
+        size_t length = 0;
+        std::shared_ptr<ImageBuffer> buffer;
+    };
+
+    // allocate one more transfer and submit it
+    bool add_transfer();
+    void submit_transfer(size_t index);
+    transfer_segment plan_segment();
+    // position of the next transfer after one of length length was submitted at frame_pos
+    size_t advance_frame_pos(size_t frame_pos, size_t length) const;
+    void replan_in_flight(size_t next_frame_pos);
+    void invalidate_plan();
+
+    bool process_planned_segment(struct libusb_transfer* xfr, transfer_segment& seg);
+    void process_unplanned_segment(struct libusb_transfer* xfr);
+
+    // hand current_buffer_ to the sink, once no transfer writes into it anymore
+    void finish_frame();
+    bool is_transfer_target(const std::shared_ptr<ImageBuffer>& buffer);
+    void release_held_buffers();
+
     void push_buffer(std::shared_ptr<tcam::ImageBuffer>&&);
 
     struct header_res
@@ -304,8 +367,10 @@ private:
 
     struct bulk_transfer_item
     {
+        // staging buffer, allocated on the first segment that is not written in place
         std::vector<uint8_t> buffer;
         void* transfer = nullptr;
+        transfer_segment segment;
 
         ~bulk_transfer_item()
         {
@@ -317,6 +382,46 @@ private:
     };
 
     std::vector<bulk_transfer_item> transfer_items;
+    // bytes of all staging buffers of transfer_items
+    std::atomic<size_t> staging_size_ = 0;
+
+    // indices into transfer_items in submission order, libusb completes them in that order
+    std::deque<size_t> in_flight_;
+    // cleared by stop_stream, completed transfers are not resubmitted anymore
+    bool accept_transfers_ = false;
+    std::mutex in_flight_mutex_;
+    std::condition_variable in_flight_cv_;
+
+    // the transfer count is increased when completions come in slower than the queue can hide
+    void adapt_transfer_count(size_t actual_length, bool in_frame);
+
+    bool transfer_count_fixed_ = false;
+    std::chrono::steady_clock::time_point last_completion_;
+    bool last_completion_in_frame_ = false;
+    // moving average of the completion interval per byte within a frame
+    double us_per_byte_ = 0.0;
+
+    bool zero_copy_ = false;
+    size_t max_packet_size_ = 0;
+    size_t transfer_size_ = 0;
+    // header + image
+    size_t frame_size_ = 0;
+
+    bool plan_valid_ = false;
+    unsigned int plan_generation_ = 0;
+    size_t plan_pos_ = 0;
+    std::shared_ptr<ImageBuffer> plan_buffer_;
+    // buffers taken for frames that are planned but not started yet
+    std::deque<std::shared_ptr<ImageBuffer>> planned_buffers_;
+
+    struct held_buffer
+    {
+        std::shared_ptr<ImageBuffer> buffer;
+        // push to the sink or simply requeue
+        bool deliver;
+    };
+    // buffers that are done but are still the target of submitted transfers
+    std::vector<held_buffer> held_buffers_;
 
     static const int actual_image_prefix_size_ = 4;
     int usbbulk_chunk_size_ = 0;
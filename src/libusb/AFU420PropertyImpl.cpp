@@ -27,7 +27,11 @@ void tcam::property::AFU420PropertyLockImpl::update_dependent_lock_state()
     if (dependent_controls_.empty())
         return;
 
-    bool new_locked_state = should_set_dependent_locked();
+    update_dependent_lock_state(should_set_dependent_locked());
+}
+
+void tcam::property::AFU420PropertyLockImpl::update_dependent_lock_state(bool new_locked_state)
+{
     for (auto& dep : dependent_controls_)
     {
         if (auto d = dep.lock())
@@ -302,7 +306,10 @@ outcome::result<void> AFU420PropertyEnumImpl::set_value_int(int64_t new_value)
         {
             return ret.error();
         }
-        update_dependent_lock_state();
+        if (auto dep_entry = get_dependency_entry())
+        {
+            update_dependent_lock_state(dep_entry->locks_dependents(m_entries.at(new_value)));
+        }
     }
     else
     {
@@ -373,7 +380,7 @@ bool AFU420PropertyEnumImpl::should_set_dependent_locked() const
         return false;
     }
 
-    return res.value() == dep_entry->prop_enum_state_for_locked;
+    return dep_entry->locks_dependents(res.value());
 }
 
 } // namespace tcam::property
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LibusbAllocator.h"
+
+#include "../Memory.h"
+#include "../logging.h"
+
+#include <cstdlib>
+#include <libusb-1.0/libusb.h>
+
+using namespace tcam::libusb;
+
+
+LibusbAllocator::LibusbAllocator(const std::shared_ptr<LibusbDevice>& dev) : device_(dev) {}
+
+
+void* LibusbAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int /*fd*/)
+{
+    if (t != tcam::TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return nullptr;
+    }
+
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    if (device_ && device_->get_handle())
+    {
+        unsigned char* ptr = libusb_dev_mem_alloc(device_->get_handle(), length);
+        if (ptr)
+        {
+            std::scoped_lock lck { mtx_ };
+            dev_mem_.insert(ptr);
+            return ptr;
+        }
+        SPDLOG_DEBUG("libusb_dev_mem_alloc failed for {} bytes. Falling back to malloc.", length);
+    }
+#endif
+
+    return std::malloc(length);
+}
+
+
+void LibusbAllocator::free(TCAM_MEMORY_TYPE, void* ptr, size_t length, int /*fd*/)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000105)
+    {
+        std::scoped_lock lck { mtx_ };
+        if (dev_mem_.erase(ptr) > 0)
+        {
+            libusb_dev_mem_free(device_->get_handle(), (unsigned char*)ptr, length);
+            return;
+        }
+    }
+#else
+    (void)length;
+#endif
+
+    std::free(ptr);
+}
+
+
+std::vector<std::shared_ptr<tcam::Memory>> LibusbAllocator::allocate(size_t buffer_count,
+                                                                     TCAM_MEMORY_TYPE t,
+                                                                     size_t length,
+                                                                     int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<tcam::Memory>> buffer;
+    buffer.reserve(buffer_count);
+
+    for (unsigned int i = 0; i < buffer_count; ++i)
+    {
+        buffer.push_back(
+            std::make_shared<tcam::Memory>(shared_from_this(), TCAM_MEMORY_TYPE_USERPTR, length));
+    }
+
+    return buffer;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../Allocator.h"
+#include "LibusbDevice.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+namespace tcam::libusb
+{
+
+/**
+ * Allocates image buffers with libusb_dev_mem_alloc.
+ *
+ * usbfs maps that memory into the process, bulk transfers into it
+ * need no copy from the kernel buffer.
+ * usbfs limits the amount of such memory (usbfs_memory_mb),
+ * buffers that do not fit are allocated with malloc.
+ */
+class LibusbAllocator : public AllocatorInterface,
+                        public std::enable_shared_from_this<LibusbAllocator>
+{
+public:
+    explicit LibusbAllocator(const std::shared_ptr<LibusbDevice>& dev);
+
+    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { TCAM_MEMORY_TYPE_USERPTR };
+    };
+
+    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
+
+    std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count,
+                                                  TCAM_MEMORY_TYPE,
+                                                  size_t,
+                                                  int fd = 0) final;
+
+private:
+    // keeps the device handle open until all buffers are freed
+    std::shared_ptr<LibusbDevice> device_;
+
+    std::mutex mtx_;
+    std::unordered_set<void*> dev_mem_;
+};
+
+} // namespace tcam::libusb
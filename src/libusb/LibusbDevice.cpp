@@ -17,6 +17,7 @@
 #include "LibusbDevice.h"
 
 #include "../logging.h"
+#include "../utils.h"
 #include "UsbHandler.h"
 
 #include <algorithm>
@@ -58,6 +59,8 @@ tcam::LibusbDevice::LibusbDevice(const std::shared_ptr<tcam::UsbSession>& s, lib
 
 tcam::LibusbDevice::~LibusbDevice()
 {
+    flush_control_transfers();
+
     auto open_interfaces_copy = open_interfaces_;
 
     for (int interface : open_interfaces_copy) { close_interface(interface); }
@@ -139,6 +142,35 @@ bool tcam::LibusbDevice::is_superspeed()
 }
 
 
+int tcam::LibusbDevice::get_numa_node()
+{
+    if (!device_)
+    {
+        return -1;
+    }
+
+    // usb 1-2.4 is /sys/bus/usb/devices/1-2.4
+    uint8_t ports[8] = {};
+    const int port_count = libusb_get_port_numbers(device_, ports, sizeof(ports));
+    if (port_count <= 0)
+    {
+        return -1;
+    }
+
+    std::string path =
+        "/sys/bus/usb/devices/" + std::to_string(libusb_get_bus_number(device_)) + "-";
+    for (int i = 0; i < port_count; ++i)
+    {
+        if (i != 0)
+        {
+            path += ".";
+        }
+        path += std::to_string(ports[i]);
+    }
+    return tcam::find_numa_node(path);
+}
+
+
 int tcam::LibusbDevice::get_max_packet_size(int endpoint)
 {
     if (!device_)
@@ -158,8 +190,187 @@ int tcam::LibusbDevice::internal_control_transfer(uint8_t RequestType,
                                                   unsigned int size,
                                                   unsigned int timeout)
 {
+    flush_control_transfers();
+
     return libusb_control_transfer(
-        device_handle_, RequestType, Request, Value, Index, (unsigned char*)&data, size, timeout);
+        device_handle_, RequestType, Request, Value, Index, data, size, timeout);
+}
+
+
+void tcam::LibusbDevice::submit_control_transfer(uint8_t RequestType,
+                                                 uint8_t Request,
+                                                 uint16_t Value,
+                                                 uint16_t Index,
+                                                 std::vector<unsigned char> data,
+                                                 control_callback&& callback,
+                                                 unsigned int timeout)
+{
+    std::scoped_lock lck { control_mtx_ };
+
+    if ((RequestType & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT)
+    {
+        for (auto iter = control_queue_.rbegin(); iter != control_queue_.rend(); ++iter)
+        {
+            auto& queued = **iter;
+            if (queued.request != Request)
+            {
+                continue;
+            }
+            if (queued.request_type == RequestType && queued.value == Value
+                && queued.index == Index && queued.data.size() == data.size())
+            {
+                queued.data = std::move(data);
+                queued.timeout = timeout;
+                queued.callbacks.push_back(std::move(callback));
+                return;
+            }
+            break;
+        }
+    }
+
+    auto req = std::make_unique<control_request>();
+    req->request_type = RequestType;
+    req->request = Request;
+    req->value = Value;
+    req->index = Index;
+    req->timeout = timeout;
+    req->data = std::move(data);
+    req->callbacks.push_back(std::move(callback));
+    control_queue_.push_back(std::move(req));
+
+    if (!control_in_flight_)
+    {
+        submit_next_control_transfer();
+    }
+}
+
+
+std::future<int> tcam::LibusbDevice::submit_control_transfer(uint8_t RequestType,
+                                                             uint8_t Request,
+                                                             uint16_t Value,
+                                                             uint16_t Index,
+                                                             std::vector<unsigned char> data,
+                                                             unsigned int timeout)
+{
+    auto promise = std::make_shared<std::promise<int>>();
+    auto future = promise->get_future();
+
+    submit_control_transfer(
+        RequestType,
+        Request,
+        Value,
+        Index,
+        std::move(data),
+        [promise](int ret, std::vector<unsigned char>& /*data*/) { promise->set_value(ret); },
+        timeout);
+
+    return future;
+}
+
+
+void tcam::LibusbDevice::flush_control_transfers()
+{
+    std::unique_lock lck { control_mtx_ };
+    control_cv_.wait(lck, [this] { return !control_in_flight_ && control_queue_.empty(); });
+}
+
+
+void tcam::LibusbDevice::submit_next_control_transfer()
+{
+    while (!control_queue_.empty())
+    {
+        control_in_flight_ = std::move(control_queue_.front());
+        control_queue_.pop_front();
+
+        auto& req = *control_in_flight_;
+
+        control_buffer_.resize(LIBUSB_CONTROL_SETUP_SIZE + req.data.size());
+        libusb_fill_control_setup(control_buffer_.data(),
+                                  req.request_type,
+                                  req.request,
+                                  req.value,
+                                  req.index,
+                                  req.data.size());
+        if ((req.request_type & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_OUT)
+        {
+            std::copy(req.data.begin(),
+                      req.data.end(),
+                      control_buffer_.begin() + LIBUSB_CONTROL_SETUP_SIZE);
+        }
+
+        int ret = LIBUSB_ERROR_NO_MEM;
+        if (auto transfer = libusb_alloc_transfer(0))
+        {
+            libusb_fill_control_transfer(transfer,
+                                         device_handle_,
+                                         control_buffer_.data(),
+                                         &LibusbDevice::control_transfer_callback,
+                                         this,
+                                         req.timeout);
+            ret = libusb_submit_transfer(transfer);
+            if (ret == LIBUSB_SUCCESS)
+            {
+                return;
+            }
+            libusb_free_transfer(transfer);
+        }
+
+        SPDLOG_ERROR("Unable to submit control transfer: {}", libusb_error_name(ret));
+        complete_control_transfer(ret);
+    }
+
+    control_cv_.notify_all();
+}
+
+
+void tcam::LibusbDevice::complete_control_transfer(int ret)
+{
+    auto req = std::move(control_in_flight_);
+
+    // callbacks must not queue transfers on this device, the lock is still held
+    for (auto& cb : req->callbacks) { cb(ret, req->data); }
+}
+
+
+void LIBUSB_CALL tcam::LibusbDevice::control_transfer_callback(struct libusb_transfer* transfer)
+{
+    auto self = static_cast<LibusbDevice*>(transfer->user_data);
+
+    int ret = transfer->actual_length;
+    switch (transfer->status)
+    {
+        case LIBUSB_TRANSFER_COMPLETED:
+            break;
+        case LIBUSB_TRANSFER_TIMED_OUT:
+            ret = LIBUSB_ERROR_TIMEOUT;
+            break;
+        case LIBUSB_TRANSFER_STALL:
+            ret = LIBUSB_ERROR_PIPE;
+            break;
+        case LIBUSB_TRANSFER_NO_DEVICE:
+            ret = LIBUSB_ERROR_NO_DEVICE;
+            break;
+        case LIBUSB_TRANSFER_OVERFLOW:
+            ret = LIBUSB_ERROR_OVERFLOW;
+            break;
+        default:
+            ret = LIBUSB_ERROR_IO;
+            break;
+    }
+
+    std::scoped_lock lck { self->control_mtx_ };
+
+    auto& req = *self->control_in_flight_;
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED
+        && (req.request_type & LIBUSB_ENDPOINT_DIR_MASK) == LIBUSB_ENDPOINT_IN)
+    {
+        auto begin = libusb_control_transfer_get_data(transfer);
+        std::copy(begin, begin + transfer->actual_length, req.data.begin());
+    }
+    libusb_free_transfer(transfer);
+
+    self->complete_control_transfer(ret);
+    self->submit_next_control_transfer();
 }
 
 
@@ -19,7 +19,12 @@
 
 #include "UsbSession.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -51,6 +56,9 @@ public:
      */
     bool is_superspeed();
 
+    // numa node of the host controller, -1 when unknown
+    int get_numa_node();
+
     int get_max_packet_size(int endpoint);
 
     template<typename T>
@@ -79,9 +87,71 @@ public:
         return internal_control_transfer(RequestType, Request, Value, Index, data, size, timeout);
     }
 
+    /**
+     * Called from the libusb event thread once the transfer is done.
+     * ret is the libusb result, data contains what was read for IN transfers.
+     * Must not queue further transfers on the same device.
+     */
+    using control_callback = std::function<void(int ret, std::vector<unsigned char>& data)>;
+
+    /**
+     * Queue a control transfer without waiting for it.
+     *
+     * Transfers are sent in the order they were queued, one at a time.
+     * An OUT transfer replaces a still queued one to the same Request/Value/Index
+     * when no other transfer with that Request is queued behind it,
+     * both callbacks then receive the result of the one transfer.
+     *
+     * For IN transfers data has to have the size that shall be read.
+     */
+    void submit_control_transfer(uint8_t RequestType,
+                                 uint8_t Request,
+                                 uint16_t Value,
+                                 uint16_t Index,
+                                 std::vector<unsigned char> data,
+                                 control_callback&& callback,
+                                 unsigned int timeout = 500);
+
+    std::future<int> submit_control_transfer(uint8_t RequestType,
+                                             uint8_t Request,
+                                             uint16_t Value,
+                                             uint16_t Index,
+                                             std::vector<unsigned char> data,
+                                             unsigned int timeout = 500);
+
+    /**
+     * Wait until all queued control transfers are done.
+     * Synchronous control transfers do this implicitly to keep the order.
+     */
+    void flush_control_transfers();
+
     void halt_endpoint(int endpoint);
 
 private:
+    struct control_request
+    {
+        uint8_t request_type;
+        uint8_t request;
+        uint16_t value;
+        uint16_t index;
+        unsigned int timeout;
+        std::vector<unsigned char> data;
+        std::vector<control_callback> callbacks;
+    };
+
+    std::mutex control_mtx_;
+    std::condition_variable control_cv_;
+    std::deque<std::unique_ptr<control_request>> control_queue_;
+    // transfer that is currently submitted, libusb owns the buffer until it completes
+    std::unique_ptr<control_request> control_in_flight_;
+    std::vector<unsigned char> control_buffer_;
+
+    // control_mtx_ has to be held
+    void submit_next_control_transfer();
+    void complete_control_transfer(int ret);
+
+    static void LIBUSB_CALL control_transfer_callback(struct libusb_transfer* transfer);
+
     std::shared_ptr<tcam::UsbSession> session_;
     libusb_device* device_ = nullptr;
     libusb_device_handle* device_handle_ = nullptr;
@@ -16,12 +16,19 @@
 
 #include "UsbHandler.h"
 
+#include "../UsbBandwidthPlanner.h"
 #include "../logging.h"
 #include "../utils.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <poll.h>
 #include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace tcam
 {
@@ -35,17 +42,58 @@ UsbHandler& UsbHandler::get_instance()
 
 UsbHandler::UsbHandler() : session(std::make_shared<UsbSession>()), run_event_thread(true)
 {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeup_fd_;
+    if (epoll_fd_ < 0 || wakeup_fd_ < 0
+        || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) != 0)
+    {
+        SPDLOG_WARN("Unable to set up epoll for libusb events, polling instead.");
+        if (epoll_fd_ >= 0)
+        {
+            close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+        event_thread = std::thread(&UsbHandler::handle_events_polling, this);
+        return;
+    }
+
     event_thread = std::thread(&UsbHandler::handle_events, this);
 }
 
 
 UsbHandler::~UsbHandler()
 {
+    if (hotplug_registered_)
+    {
+        libusb_hotplug_deregister_callback(session->get_session(), hotplug_handle_);
+    }
+
     run_event_thread = false;
+    if (wakeup_fd_ >= 0)
+    {
+        uint64_t one = 1;
+        if (write(wakeup_fd_, &one, sizeof(one)) < 0)
+        {
+            SPDLOG_WARN("Unable to wake the libusb event thread.");
+        }
+    }
     if (event_thread.joinable())
     {
         event_thread.join();
     }
+
+    if (epoll_fd_ >= 0)
+    {
+        close(epoll_fd_);
+    }
+    if (wakeup_fd_ >= 0)
+    {
+        close(wakeup_fd_);
+    }
 }
 
 
@@ -219,7 +267,7 @@ struct libusb_device_handle* UsbHandler::open_device(const std::string& serial)
 }
 
 
-std::vector<DeviceInfo> UsbHandler::get_device_list()
+std::vector<DeviceInfo> UsbHandler::enumerate_devices(const std::string& serial)
 {
     libusb_device** devs = nullptr;
 
@@ -239,6 +287,7 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
         int r = libusb_get_device_descriptor(devs[i], &desc);
         if (r < 0)
         {
+            libusb_free_device_list(devs, 1);
             throw std::runtime_error("Unable to retrieve device descriptor. "
                                      + std::to_string(cnt));
         }
@@ -266,13 +315,42 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
         snprintf(
             (char*)d.additional_identifier, sizeof(d.additional_identifier), "%x", desc.idProduct);
 
-        libusb_get_string_descriptor_ascii(
-            dh, desc.iProduct, (unsigned char*)d.name, sizeof(d.name));
+        // sysfs name of the device, e.g. 2-1.3 for /sys/bus/usb/devices/2-1.3
+        uint8_t ports[7] = {};
+        int port_count = libusb_get_port_numbers(devs[i], ports, sizeof(ports));
+        if (port_count > 0)
+        {
+            std::string name = std::to_string(libusb_get_bus_number(devs[i])) + "-";
+            for (int p = 0; p < port_count; ++p)
+            {
+                if (p > 0)
+                {
+                    name += ".";
+                }
+                name += std::to_string(ports[p]);
+            }
+            snprintf(d.identifier, sizeof(d.identifier), "%s", name.c_str());
+        }
+
         libusb_get_string_descriptor_ascii(
             dh, desc.iSerialNumber, (unsigned char*)d.serial_number, sizeof(d.serial_number));
 
+        if (!serial.empty() && serial.compare(d.serial_number) != 0)
+        {
+            libusb_close(dh);
+            continue;
+        }
+
+        libusb_get_string_descriptor_ascii(
+            dh, desc.iProduct, (unsigned char*)d.name, sizeof(d.name));
+
         libusb_close(dh);
         ret.push_back(DeviceInfo(d));
+
+        if (!serial.empty())
+        {
+            break;
+        }
     }
 
     libusb_free_device_list(devs, 1);
@@ -280,11 +358,323 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
     return ret;
 }
 
+
+std::vector<DeviceInfo> UsbHandler::get_device_list()
+{
+    return enumerate_devices({});
+}
+
+
+std::optional<DeviceInfo> UsbHandler::find_device(const std::string& serial)
+{
+    auto lst = enumerate_devices(serial);
+    if (lst.empty())
+    {
+        return std::nullopt;
+    }
+    return lst.front();
+}
+
+bool UsbHandler::set_hotplug_callback(std::function<void()> cb)
+{
+    std::scoped_lock lock(hotplug_mtx_);
+
+    hotplug_cb_ = std::move(cb);
+
+    if (hotplug_registered_ || !hotplug_cb_)
+    {
+        return true;
+    }
+
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+    {
+        return false;
+    }
+
+    int ret = libusb_hotplug_register_callback(
+        session->get_session(),
+        (libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED
+                               | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+        LIBUSB_HOTPLUG_NO_FLAGS,
+        0x199e,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        LIBUSB_HOTPLUG_MATCH_ANY,
+        &UsbHandler::hotplug_event,
+        this,
+        &hotplug_handle_);
+
+    if (ret != LIBUSB_SUCCESS)
+    {
+        SPDLOG_WARN("Unable to register libusb hotplug callback: {}", libusb_error_name(ret));
+        return false;
+    }
+
+    hotplug_registered_ = true;
+    return true;
+}
+
+
+int LIBUSB_CALL UsbHandler::hotplug_event(libusb_context* /*ctx*/,
+                                          libusb_device* /*dev*/,
+                                          libusb_hotplug_event /*event*/,
+                                          void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    // called from the event thread, libusb must not be used here
+    std::scoped_lock lock(self->hotplug_mtx_);
+    if (self->hotplug_cb_)
+    {
+        self->hotplug_cb_();
+    }
+
+    // keep the callback registered
+    return 0;
+}
+
+
+void LIBUSB_CALL UsbHandler::pollfd_added(int fd, short events, void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    struct epoll_event ev = {};
+    ev.events = ((events & POLLIN) ? EPOLLIN : 0) | ((events & POLLOUT) ? EPOLLOUT : 0);
+    ev.data.fd = fd;
+    if (epoll_ctl(self->epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0 && errno == EEXIST)
+    {
+        epoll_ctl(self->epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+}
+
+
+void LIBUSB_CALL UsbHandler::pollfd_removed(int fd, void* user_data)
+{
+    auto self = static_cast<UsbHandler*>(user_data);
+
+    epoll_ctl(self->epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+
+int UsbHandler::add_busy_poll_stream(double fps)
+{
+    const auto& config = get_busy_poll_config();
+    if (!config.enabled)
+    {
+        return -1;
+    }
+
+    std::scoped_lock lck { busy_poll_mtx_ };
+
+    int id = next_busy_poll_id_++;
+    auto [it, inserted] = busy_poll_streams_.emplace(id, frame_arrival_predictor(config.window));
+    it->second.set_framerate(fps);
+
+    return id;
+}
+
+
+void UsbHandler::remove_busy_poll_stream(int id)
+{
+    if (id < 0)
+    {
+        return;
+    }
+
+    std::scoped_lock lck { busy_poll_mtx_ };
+    busy_poll_streams_.erase(id);
+}
+
+
+int UsbHandler::add_bandwidth_stream(const DeviceInfo& info, uint64_t payload_bytes, double fps)
+{
+    if (info.get_identifier().empty())
+    {
+        return -1;
+    }
+
+    auto location = find_usb_location("/sys/bus/usb/devices/" + info.get_identifier());
+    if (!location)
+    {
+        return -1;
+    }
+
+    usb_stream_demand demand;
+    demand.serial = info.get_serial();
+    demand.location = *location;
+    demand.payload_bytes = payload_bytes;
+    demand.framerate = fps;
+
+    return UsbBandwidthPlanner::get_instance().add_stream(demand);
+}
+
+
+void UsbHandler::remove_bandwidth_stream(int id)
+{
+    if (id < 0)
+    {
+        return;
+    }
+    UsbBandwidthPlanner::get_instance().remove_stream(id);
+}
+
+
+void UsbHandler::report_frame(int id)
+{
+    if (id < 0)
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lck { busy_poll_mtx_ };
+        if (auto it = busy_poll_streams_.find(id); it != busy_poll_streams_.end())
+        {
+            it->second.on_frame(frame_arrival_predictor::clock::now());
+        }
+    }
+    ++busy_poll_frames_;
+}
+
+
+std::optional<std::pair<frame_arrival_predictor::clock::time_point,
+                        frame_arrival_predictor::clock::time_point>>
+    UsbHandler::next_spin_window()
+{
+    std::scoped_lock lck { busy_poll_mtx_ };
+
+    std::optional<std::pair<frame_arrival_predictor::clock::time_point,
+                            frame_arrival_predictor::clock::time_point>>
+        ret;
+    for (const auto& [id, predictor] : busy_poll_streams_)
+    {
+        if (!predictor.has_prediction())
+        {
+            continue;
+        }
+        if (!ret || predictor.spin_start() < ret->first)
+        {
+            ret = std::make_pair(predictor.spin_start(), predictor.spin_end());
+        }
+    }
+    return ret;
+}
+
+
+void UsbHandler::spin_events(libusb_context* ctx, frame_arrival_predictor::clock::time_point end)
+{
+    const uint64_t frames = busy_poll_frames_;
+
+    struct timeval zero = {};
+    while (run_event_thread && busy_poll_frames_ == frames)
+    {
+        libusb_handle_events_timeout_completed(ctx, &zero, nullptr);
+
+        auto now = frame_arrival_predictor::clock::now();
+        if (now < end)
+        {
+            cpu_relax();
+            continue;
+        }
+
+        // the streams whose window is over wait blocking for their next frame
+        std::scoped_lock lck { busy_poll_mtx_ };
+        for (auto& [id, predictor] : busy_poll_streams_)
+        {
+            if (predictor.has_prediction() && predictor.spin_end() <= now)
+            {
+                predictor.on_miss();
+            }
+        }
+        return;
+    }
+}
+
+
 void UsbHandler::handle_events()
 {
     tcam::set_thread_name("tcam_usbhand");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    auto ctx = this->session->get_session();
+
+    // notifiers first, so that no fd that is added in between is missed
+    libusb_set_pollfd_notifiers(ctx, &UsbHandler::pollfd_added, &UsbHandler::pollfd_removed, this);
+
+    if (const struct libusb_pollfd** fds = libusb_get_pollfds(ctx))
+    {
+        for (auto fd = fds; *fd != nullptr; ++fd)
+        {
+            pollfd_added((*fd)->fd, (*fd)->events, this);
+        }
+        libusb_free_pollfds(fds);
+    }
+
+    // with timerfd the timeouts of the transfers are one of the pollfds
+    const bool fds_handle_timeouts = libusb_pollfds_handle_timeouts(ctx) != 0;
+
+    constexpr int max_events = 16;
+    struct epoll_event events[max_events];
+
+    while (run_event_thread)
+    {
+        int timeout_ms = -1;
+        struct timeval next_timeout = {};
+        if (!fds_handle_timeouts && libusb_get_next_timeout(ctx, &next_timeout) == 1)
+        {
+            // round up, waking too early only leads to another wait
+            timeout_ms = (int)(next_timeout.tv_sec * 1000 + (next_timeout.tv_usec + 999) / 1000);
+        }
+
+        if (auto window = next_spin_window())
+        {
+            auto now = frame_arrival_predictor::clock::now();
+            if (now >= window->first)
+            {
+                spin_events(ctx, window->second);
+                continue;
+            }
+
+            // round down, waking too early only extends the spin
+            auto until_spin = (int)std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  window->first - now)
+                                  .count();
+            timeout_ms = timeout_ms < 0 ? until_spin : std::min(timeout_ms, until_spin);
+        }
+
+        int count = epoll_wait(epoll_fd_, events, max_events, timeout_ms);
+        if (count < 0 && errno != EINTR)
+        {
+            SPDLOG_ERROR("epoll_wait failed: {}", strerror(errno));
+            break;
+        }
+
+        if (!run_event_thread)
+        {
+            break;
+        }
+
+        // does not block, only handles what is pending
+        struct timeval zero = {};
+        libusb_handle_events_timeout_completed(ctx, &zero, nullptr);
+    }
+
+    libusb_set_pollfd_notifiers(ctx, nullptr, nullptr, nullptr);
+
+    if (run_event_thread)
+    {
+        handle_events_polling();
+    }
+}
+
+
+void UsbHandler::handle_events_polling()
+{
+    tcam::set_thread_name("tcam_usbhand");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    // bounds the time the destructor waits for this thread
     struct timeval tv = {};
-    tv.tv_usec = 200; // #TODO this seems to be an excessively short wake timeout
+    tv.tv_usec = 100 * 1000;
     while (run_event_thread)
     {
         libusb_handle_events_timeout_completed(this->session->get_session(), &tv, nullptr);
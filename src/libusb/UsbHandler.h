@@ -18,16 +18,25 @@
 #define TCAM_USBHANDLER_H
 
 #include "../DeviceInfo.h"
+#include "../busy_poll.h"
 #include "LibusbDevice.h"
 #include "UsbSession.h"
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <libusb-1.0/libusb.h>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
+VISIBILITY_INTERNAL
+
 namespace tcam
 {
 
@@ -52,6 +61,44 @@ public:
     /// @return vector of device_info of found cameras
     std::vector<DeviceInfo> get_device_list();
 
+    /// @name find_device
+    /// @param serial - serial number of the wanted camera
+    /// @return device_info of the camera; std::nullopt when it is not connected
+    /// Only the string descriptors of TIS devices are read until serial matches.
+    std::optional<DeviceInfo> find_device(const std::string& serial);
+
+    /// @name set_hotplug_callback
+    /// @param cb - called from the event thread when a TIS device arrives or leaves; empty to remove
+    /// @return false when libusb is unable to report hotplug events
+    bool set_hotplug_callback(std::function<void()> cb);
+
+    /// @name add_busy_poll_stream
+    /// @param fps - frame rate of the stream; 0 for triggered streams
+    /// @return id for report_frame and remove_busy_poll_stream; -1 when busy polling is disabled
+    /// The event thread spins on the libusb events around the expected frames, see TCAM_BUSY_POLL.
+    int add_busy_poll_stream(double fps);
+
+    /// @name remove_busy_poll_stream
+    /// @param id - as returned by add_busy_poll_stream; -1 is ignored
+    void remove_busy_poll_stream(int id);
+
+    /// @name report_frame
+    /// @param id - stream that completed a frame; -1 is ignored
+    /// Called from the transfer callbacks.
+    void report_frame(int id);
+
+    /// @name add_bandwidth_stream
+    /// @param info - device as returned by get_device_list
+    /// @param payload_bytes - size of a frame on the wire
+    /// @param fps - frame rate of the stream; 0 for triggered streams
+    /// @return id for remove_bandwidth_stream; -1 when the usb location of the device is unknown
+    /// Registers the stream with the UsbBandwidthPlanner, which warns when the bus is too busy.
+    int add_bandwidth_stream(const DeviceInfo& info, uint64_t payload_bytes, double fps);
+
+    /// @name remove_bandwidth_stream
+    /// @param id - as returned by add_bandwidth_stream; -1 is ignored
+    void remove_bandwidth_stream(int id);
+
     /// @name open_camera
     /// @param serial - string containing the serial number of the camera that shall be opened
     /// @return shared pointer to the opened usb camera; Returns nullptr on failure
@@ -64,10 +111,48 @@ private:
     std::atomic_bool run_event_thread;
     std::thread event_thread;
 
+    // the event thread sleeps in epoll_wait on the pollfds of libusb,
+    // wakeup_fd_ ends the wait on shutdown
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+
     void handle_events();
+    // fallback when no epoll could be set up
+    void handle_events_polling();
+
+    // earliest spin window over all busy poll streams; std::nullopt when all of them wait blocking
+    std::optional<std::pair<frame_arrival_predictor::clock::time_point,
+                            frame_arrival_predictor::clock::time_point>>
+        next_spin_window();
+    // handles pending events without blocking until a frame arrives or end is reached
+    void spin_events(libusb_context* ctx, frame_arrival_predictor::clock::time_point end);
+
+    std::mutex busy_poll_mtx_;
+    std::map<int, frame_arrival_predictor> busy_poll_streams_;
+    int next_busy_poll_id_ = 0;
+    // incremented by report_frame, ends the spin
+    std::atomic<uint64_t> busy_poll_frames_ = 0;
+
+    static void LIBUSB_CALL pollfd_added(int fd, short events, void* user_data);
+    static void LIBUSB_CALL pollfd_removed(int fd, void* user_data);
+
+    // all supported devices or only the first one with serial
+    std::vector<DeviceInfo> enumerate_devices(const std::string& serial);
+
+    std::mutex hotplug_mtx_;
+    std::function<void()> hotplug_cb_;
+    bool hotplug_registered_ = false;
+    libusb_hotplug_callback_handle hotplug_handle_ = {};
+
+    static int LIBUSB_CALL hotplug_event(libusb_context* ctx,
+                                         libusb_device* dev,
+                                         libusb_hotplug_event event,
+                                         void* user_data);
 
 }; /* class UsbHandler */
 
 } /* namespace tcam */
 
+VISIBILITY_POP
+
 #endif /* TCAM_USBHANDLER_H */
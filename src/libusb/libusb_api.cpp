@@ -46,3 +46,15 @@ std::vector<tcam::DeviceInfo> tcam::LibUsbBackend::get_device_list()
 {
     return tcam::libusb::get_libusb_device_list();
 }
+
+
+std::optional<tcam::DeviceInfo> tcam::LibUsbBackend::find_device(const std::string& serial)
+{
+    return UsbHandler::get_instance().find_device(serial);
+}
+
+
+bool tcam::LibUsbBackend::set_hotplug_callback(std::function<void()> cb)
+{
+    return UsbHandler::get_instance().set_hotplug_callback(std::move(cb));
+}
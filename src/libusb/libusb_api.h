@@ -31,6 +31,9 @@ public:
     };
     std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
+
+    bool set_hotplug_callback(std::function<void()> cb) final;
 
     static LibUsbBackend* get_instance()
     {
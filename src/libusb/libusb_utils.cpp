@@ -6,6 +6,8 @@
 #include "../utils.h"
 #include "UsbHandler.h"
 
+#include <algorithm>
+
 using namespace tcam;
 
 
@@ -16,14 +18,11 @@ std::vector<DeviceInfo> tcam::libusb::get_libusb_device_list()
 
 bool libusb::deliver_thread::push(std::shared_ptr<ImageBuffer>&& ptr)
 {
-    std::scoped_lock lck { mutex_ };
-    if (end_thread_)
+    if (end_thread_.load(std::memory_order_acquire))
     {
         return false;
     }
-    queue_.push_back(std::move(ptr));
-    cv_.notify_one();
-    return true;
+    return queue_.push(std::move(ptr));
 }
 
 
@@ -34,23 +33,28 @@ void libusb::deliver_thread::stop()
         return;
     }
 
-    {
-        std::scoped_lock lck { mutex_ };
-        end_thread_ = true;
-        cv_.notify_all();
-    }
+    end_thread_.store(true, std::memory_order_release);
+    queue_.notify();
 
     thread_.join();
 
     sink_.reset();
-    queue_.clear();
+
+    std::shared_ptr<ImageBuffer> ptr;
+    while (queue_.try_pop(ptr)) {}
 }
 
-void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink)
+void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink,
+                                   size_t capacity,
+                                   int numa_node)
 {
+    // no producer is active yet
+    queue_.reset(std::max<size_t>(capacity, 1));
+
     end_thread_ = false;
 
     sink_ = sink;
+    numa_node_ = numa_node;
 
     thread_ = std::thread { [this]
                             {
@@ -61,29 +65,12 @@ void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink
 void libusb::deliver_thread::thread_main()
 {
     tcam::set_thread_name("tcam-usb-dlv");
+    tcam::apply_thread_config(tcam::thread_role::delivery, numa_node_);
 
-    while (true)
+    std::shared_ptr<tcam::ImageBuffer> ptr;
+    while (queue_.pop_wait(ptr, [this] { return end_thread_.load(std::memory_order_acquire); }))
     {
-        std::shared_ptr<tcam::ImageBuffer> ptr;
-        {
-            std::unique_lock lck { mutex_ };
-            if (!end_thread_ && queue_.empty())
-            {
-                cv_.wait(lck);
-            }
-            if (end_thread_)
-            {
-                return;
-            }
-            if (!queue_.empty())
-            {
-                ptr = queue_.front();
-                queue_.erase(queue_.begin());
-            }
-        }
-        if (ptr)
-        {
-            sink_->push_image(ptr);
-        }
+        sink_->push_image(ptr);
+        ptr.reset();
     }
-}
\ No newline at end of file
+}
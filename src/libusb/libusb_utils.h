@@ -5,12 +5,12 @@
 #include "../DeviceInfo.h"
 #include "../ImageBuffer.h"
 #include "../SinkInterface.h"
+#include "../spsc_ring.h"
 
 #include <vector>
 
-#include <condition_variable>
+#include <atomic>
 #include <thread>
-#include <mutex>
 
 namespace tcam::libusb
 {
@@ -18,22 +18,30 @@ namespace tcam::libusb
 std::vector<DeviceInfo> get_libusb_device_list();
 
 
+/**
+ * Hands images from the libusb event thread to the sink.
+ *
+ * push() has to be called from a single thread and never blocks,
+ * so that the event thread can resubmit its transfers right away.
+ */
 class deliver_thread
 {
 public:
+    // false when the thread is stopped or the queue is full
     bool push(std::shared_ptr<tcam::ImageBuffer>&& ptr);
 
-    void start(const std::shared_ptr<IImageBufferSink>& list);
+    // capacity should be the number of buffers, the queue then only fills when the sink hangs
+    // numa_node >= 0 pins the thread to the cpus of that node, see apply_thread_config
+    void start(const std::shared_ptr<IImageBufferSink>& list, size_t capacity, int numa_node = -1);
     void stop();
 private:
     void thread_main();
 
     std::thread thread_;
-    std::vector<std::shared_ptr<tcam::ImageBuffer>> queue_;
-    std::condition_variable cv_;
-    std::mutex mutex_;
+    tcam::spsc_ring<std::shared_ptr<tcam::ImageBuffer>> queue_;
 
-    bool end_thread_ = false;
+    std::atomic<bool> end_thread_ = false;
+    int numa_node_ = -1;
 
     std::shared_ptr<IImageBufferSink> sink_;
 };
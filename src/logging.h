@@ -19,8 +19,98 @@
 
 #include "compiler_defines.h"
 
+// release builds define SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_INFO, see TCAM_LOG_STRIP_DEBUG
+#ifndef SPDLOG_ACTIVE_LEVEL
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <spdlog/spdlog.h>
 
+namespace tcam::log
+{
+
+/**
+ * Lets at most burst messages per interval through.
+ * Meant for call sites that may fire for every frame while a fault persists.
+ * Thread safe, does not lock.
+ */
+class rate_limiter
+{
+public:
+    static constexpr int64_t interval_ns = 1000 * 1000 * 1000;
+    static constexpr uint32_t burst = 5;
+
+    // suppressed receives the number of messages dropped since the last allowed one
+    bool allow(uint64_t& suppressed) noexcept
+    {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+
+        int64_t begin = window_begin_ns_.load(std::memory_order_relaxed);
+        if (now - begin >= interval_ns
+            && window_begin_ns_.compare_exchange_strong(begin, now, std::memory_order_relaxed))
+        {
+            in_window_.store(0, std::memory_order_relaxed);
+        }
+
+        if (in_window_.fetch_add(1, std::memory_order_relaxed) < burst)
+        {
+            suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+private:
+    std::atomic<int64_t> window_begin_ns_ { 0 };
+    std::atomic<uint32_t> in_window_ { 0 };
+    std::atomic<uint64_t> suppressed_ { 0 };
+};
+
+} // namespace tcam::log
+
+/*
+ * SPDLOG_<LEVEL> with a rate limit per call site.
+ * The first message after suppressed ones reports how many were dropped.
+ * Messages below the active level are neither formatted nor counted.
+ */
+#define TCAM_LOG_RATE_LIMITED(lvl, ...)                                                            \
+    do                                                                                             \
+    {                                                                                              \
+        if (spdlog::default_logger_raw()->should_log(lvl))                                         \
+        {                                                                                          \
+            static ::tcam::log::rate_limiter tcam_log_limiter_;                                    \
+            uint64_t tcam_log_suppressed_ = 0;                                                     \
+            if (tcam_log_limiter_.allow(tcam_log_suppressed_))                                     \
+            {                                                                                      \
+                if (tcam_log_suppressed_ == 0)                                                     \
+                {                                                                                  \
+                    SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), lvl, __VA_ARGS__);            \
+                }                                                                                  \
+                else                                                                               \
+                {                                                                                  \
+                    SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(),                               \
+                                       lvl,                                                        \
+                                       "{} ({} similar messages suppressed)",                      \
+                                       fmt::format(__VA_ARGS__),                                   \
+                                       tcam_log_suppressed_);                                      \
+                }                                                                                  \
+            }                                                                                      \
+        }                                                                                          \
+    } while (0)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define TCAM_DEBUG_RATE_LIMITED(...) TCAM_LOG_RATE_LIMITED(spdlog::level::debug, __VA_ARGS__)
+#else
+#define TCAM_DEBUG_RATE_LIMITED(...) (void)0
+#endif
+
+#define TCAM_WARN_RATE_LIMITED(...)  TCAM_LOG_RATE_LIMITED(spdlog::level::warn, __VA_ARGS__)
+#define TCAM_ERROR_RATE_LIMITED(...) TCAM_LOG_RATE_LIMITED(spdlog::level::err, __VA_ARGS__)
+
 #endif /* TCAM_LOGGING_H */
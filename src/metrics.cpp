@@ -0,0 +1,498 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+struct stream_entry
+{
+    std::string serial;
+    std::string type;
+    std::weak_ptr<tcam::metrics::stream_metrics> metrics;
+
+    // state of the previous scrape for the fps gauge
+    uint64_t last_delivered = 0;
+    std::chrono::steady_clock::time_point last_scrape = {};
+};
+
+
+class metrics_registry
+{
+public:
+    std::shared_ptr<tcam::metrics::stream_metrics> get_stream(const std::string& serial,
+                                                              const std::string& type)
+    {
+        std::scoped_lock lck { mtx_ };
+
+        for (auto it = streams_.begin(); it != streams_.end();)
+        {
+            if (it->metrics.expired())
+            {
+                it = streams_.erase(it);
+                continue;
+            }
+            if (it->serial == serial && it->type == type)
+            {
+                return it->metrics.lock();
+            }
+            ++it;
+        }
+
+        auto ret = std::make_shared<tcam::metrics::stream_metrics>();
+        streams_.push_back({ serial, type, ret });
+        return ret;
+    }
+
+    std::string render();
+
+private:
+    std::mutex mtx_;
+    std::vector<stream_entry> streams_;
+};
+
+
+metrics_registry& get_registry()
+{
+    // never destroyed, the server thread may still scrape while the process exits
+    static metrics_registry* registry = new metrics_registry();
+    return *registry;
+}
+
+
+std::string escape_label(const std::string& str)
+{
+    std::string ret;
+    ret.reserve(str.size());
+    for (char c : str)
+    {
+        if (c == '\\' || c == '"')
+        {
+            ret += '\\';
+            ret += c;
+        }
+        else if (c == '\n')
+        {
+            ret += "\\n";
+        }
+        else
+        {
+            ret += c;
+        }
+    }
+    return ret;
+}
+
+
+class text_writer
+{
+public:
+    void header(const char* name, const char* type, const char* help)
+    {
+        out_ += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    }
+
+    void value(const char* name, const std::string& labels, uint64_t value)
+    {
+        out_ += fmt::format("{}{{{}}} {}\n", name, labels, value);
+    }
+
+    void value(const char* name, const std::string& labels, double value)
+    {
+        out_ += fmt::format("{}{{{}}} {}\n", name, labels, value);
+    }
+
+    void histogram(const char* name,
+                   const std::string& labels,
+                   const tcam::metrics::latency_histogram& h)
+    {
+        const auto& bounds = tcam::metrics::latency_histogram::bounds_ns;
+
+        // the values are read while the stream thread keeps writing,
+        // +Inf and _count have to match for the scraper
+        const uint64_t count = h.count();
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < bounds.size(); ++i)
+        {
+            cumulative += h.bucket(i);
+            out_ += fmt::format(
+                "{}_bucket{{{},le=\"{}\"}} {}\n", name, labels, bounds[i] / 1e9, cumulative);
+        }
+        cumulative += h.bucket(bounds.size());
+        out_ += fmt::format(
+            "{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels, std::max(cumulative, count));
+        out_ += fmt::format("{}_sum{{{}}} {}\n", name, labels, h.sum_ns() / 1e9);
+        out_ += fmt::format("{}_count{{{}}} {}\n", name, labels, std::max(cumulative, count));
+    }
+
+    std::string release()
+    {
+        return std::move(out_);
+    }
+
+private:
+    std::string out_;
+};
+
+
+struct stream_snapshot
+{
+    std::string labels;
+    std::shared_ptr<tcam::metrics::stream_metrics> metrics;
+    double fps = 0.0;
+};
+
+
+std::string metrics_registry::render()
+{
+    std::vector<stream_snapshot> streams;
+    {
+        std::scoped_lock lck { mtx_ };
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& entry : streams_)
+        {
+            auto ptr = entry.metrics.lock();
+            if (!ptr)
+            {
+                continue;
+            }
+
+            stream_snapshot s;
+            s.labels = fmt::format("serial=\"{}\",type=\"{}\"",
+                                   escape_label(entry.serial),
+                                   escape_label(entry.type));
+
+            // average since the previous scrape
+            const uint64_t delivered = ptr->frames_delivered.get();
+            const double elapsed = std::chrono::duration<double>(now - entry.last_scrape).count();
+            if (entry.last_scrape.time_since_epoch().count() != 0 && elapsed > 0.0
+                && delivered >= entry.last_delivered)
+            {
+                s.fps = (delivered - entry.last_delivered) / elapsed;
+            }
+            entry.last_delivered = delivered;
+            entry.last_scrape = now;
+
+            s.metrics = std::move(ptr);
+            streams.push_back(std::move(s));
+        }
+    }
+
+    using sm = tcam::metrics::stream_metrics;
+
+    struct counter_desc
+    {
+        const char* name;
+        const char* help;
+        const tcam::metrics::counter sm::*member;
+    };
+
+    const counter_desc counters[] = {
+        { "tcam_frames_delivered_total",
+          "Frames delivered by the backend.",
+          &sm::frames_delivered },
+        { "tcam_frames_dropped_total",
+          "Frames dropped as reported by the backend.",
+          &sm::frames_dropped },
+        { "tcam_frames_dropped_no_buffer_total",
+          "Frames dropped because no buffer was queued, the consumer returned them too late.",
+          &sm::frames_dropped_no_buffer },
+        { "tcam_frames_dropped_transport_total",
+          "Frames lost on the way, e.g. sequence gaps while buffers were queued.",
+          &sm::frames_dropped_transport },
+        { "tcam_frames_dropped_incomplete_total",
+          "Frames dropped because they were incomplete.",
+          &sm::frames_dropped_incomplete },
+        { "tcam_frames_damaged_total",
+          "Delivered frames that are incomplete.",
+          &sm::frames_damaged },
+        { "tcam_resent_packets_total",
+          "Packets that had to be requested again.",
+          &sm::resent_packets },
+        { "tcam_missing_packets_total",
+          "Packets that did not arrive, even after resends.",
+          &sm::missing_packets },
+        { "tcam_failed_buffers_total",
+          "Buffers that timed out or had missing packets.",
+          &sm::failed_buffers },
+        { "tcam_underruns_total",
+          "Frames that arrived while no buffer was queued.",
+          &sm::underruns },
+    };
+
+    // differences of counters written by different threads may be off by one for a moment
+    auto difference = [](const tcam::metrics::counter& a, const tcam::metrics::counter& b)
+    {
+        const uint64_t va = a.get();
+        const uint64_t vb = b.get();
+        return va > vb ? va - vb : 0;
+    };
+
+    struct gauge_desc
+    {
+        const char* name;
+        const char* help;
+        std::function<uint64_t(const sm&)> value;
+    };
+
+    const gauge_desc gauges[] = {
+        { "tcam_src_queue_depth",
+          "Buffers waiting in the tcamsrc handoff queue.",
+          [&difference](const sm& m) { return difference(m.queue_pushed, m.queue_popped); } },
+        { "tcam_src_buffers_outstanding",
+          "Buffers of the tcamsrc pool that are queued or held downstream.",
+          [&difference](const sm& m) { return difference(m.queue_pushed, m.buffers_released); } },
+        { "tcam_src_pool_size",
+          "Buffers of the tcamsrc buffer pool.",
+          [](const sm& m) { return m.pool_size.get(); } },
+    };
+
+    text_writer w;
+
+    w.header("tcam_stream_fps", "gauge", "Frames per second since the previous scrape.");
+    for (const auto& s : streams)
+    {
+        w.value("tcam_stream_fps", s.labels, s.fps);
+    }
+
+    for (const auto& c : counters)
+    {
+        w.header(c.name, "counter", c.help);
+        for (const auto& s : streams)
+        {
+            w.value(c.name, s.labels, ((*s.metrics).*c.member).get());
+        }
+    }
+
+    for (const auto& g : gauges)
+    {
+        w.header(g.name, "gauge", g.help);
+        for (const auto& s : streams)
+        {
+            w.value(g.name, s.labels, g.value(*s.metrics));
+        }
+    }
+
+    const std::pair<const char*, const tcam::metrics::latency_histogram sm::*> stages[] = {
+        { "auto_pass", &sm::latency_auto_pass },
+        { "backend", &sm::latency_backend },
+        { "handoff", &sm::latency_handoff },
+        { "total", &sm::latency_total },
+    };
+
+    w.header("tcam_latency_seconds", "histogram", "Time a frame spends in a pipeline stage.");
+    for (const auto& s : streams)
+    {
+        for (const auto& [stage, member] : stages)
+        {
+            auto labels = fmt::format("{},stage=\"{}\"", s.labels, stage);
+            w.histogram("tcam_latency_seconds", labels, (*s.metrics).*member);
+        }
+    }
+
+    return w.release();
+}
+
+
+// "[address:]port", address defaults to all interfaces
+bool parse_address(const std::string& str, sockaddr_in& addr)
+{
+    addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    std::string port = str;
+    if (auto pos = str.rfind(':'); pos != std::string::npos)
+    {
+        port = str.substr(pos + 1);
+        const auto host = str.substr(0, pos);
+        if (!host.empty() && inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            return false;
+        }
+    }
+
+    try
+    {
+        const int p = std::stoi(port);
+        if (p <= 0 || p > 65535)
+        {
+            return false;
+        }
+        addr.sin_port = htons(p);
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    return true;
+}
+
+
+void send_all(int fd, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t ret = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (ret <= 0)
+        {
+            return;
+        }
+        sent += ret;
+    }
+}
+
+
+void handle_connection(int fd)
+{
+    // scrapers are expected to send small requests quickly
+    timeval timeout = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8 * 1024)
+    {
+        ssize_t ret = recv(fd, buf, sizeof(buf), 0);
+        if (ret <= 0)
+        {
+            return;
+        }
+        request.append(buf, ret);
+    }
+
+    const bool is_get = request.compare(0, 4, "GET ") == 0;
+    const auto path = request.substr(4, request.find(' ', 4) - 4);
+
+    if (!is_get || (path != "/metrics" && path != "/"))
+    {
+        send_all(fd,
+                 "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        return;
+    }
+
+    const auto body = get_registry().render();
+    send_all(fd,
+             fmt::format("HTTP/1.1 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                         "Content-Length: {}\r\n"
+                         "Connection: close\r\n\r\n",
+                         body.size()));
+    send_all(fd, body);
+}
+
+
+void start_server()
+{
+    const auto address = tcam::get_environment_variable("TCAM_METRICS", "");
+
+    sockaddr_in addr;
+    if (!parse_address(address, addr))
+    {
+        SPDLOG_ERROR("TCAM_METRICS='{}' is not [address:]port. Not serving metrics.", address);
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Unable to create metrics socket: {}", strerror(errno));
+        return;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 8) != 0)
+    {
+        SPDLOG_ERROR("Unable to serve metrics on '{}': {}", address, strerror(errno));
+        close(fd);
+        return;
+    }
+
+    SPDLOG_INFO("Serving metrics on '{}'", address);
+
+    // lives as long as the process, connections are handled one after another
+    std::thread(
+        [fd]
+        {
+            while (true)
+            {
+                int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client < 0)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                    {
+                        continue;
+                    }
+                    SPDLOG_ERROR("Metrics server stopped: {}", strerror(errno));
+                    close(fd);
+                    return;
+                }
+                handle_connection(client);
+                close(client);
+            }
+        })
+        .detach();
+}
+
+} // namespace
+
+
+bool tcam::metrics::is_enabled() noexcept
+{
+    static const bool enabled = tcam::is_environment_variable_set("TCAM_METRICS");
+    return enabled;
+}
+
+
+std::shared_ptr<tcam::metrics::stream_metrics> tcam::metrics::get_stream(const std::string& serial,
+                                                                         const std::string& type)
+{
+    if (!is_enabled())
+    {
+        return nullptr;
+    }
+
+    static std::once_flag server_started;
+    std::call_once(server_started, start_server);
+
+    return get_registry().get_stream(serial, type);
+}
+
+
+std::string tcam::metrics::render()
+{
+    return get_registry().render();
+}
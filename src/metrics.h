@@ -0,0 +1,162 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/*
+ * Streaming health metrics in the Prometheus/OpenMetrics text format.
+ *
+ * Set TCAM_METRICS to [address:]port and the process serves
+ * http://<address>:<port>/metrics once the first device is opened.
+ *
+ * Every device has its own stream_metrics.
+ * Each counter in there is only written by one thread at a time,
+ * so updates are plain relaxed stores and the frame path never takes a lock.
+ * The registry mutex is only taken when a device is opened or the metrics are scraped.
+ *
+ * The implementation lives in libtcam and is shared with the gstreamer plugins,
+ * so that one process serves all of its devices.
+ */
+namespace tcam::metrics
+{
+
+// TCAM_METRICS is set, evaluated once
+bool is_enabled() noexcept;
+
+class counter
+{
+public:
+    // only one thread may write at a time
+    void inc(uint64_t n = 1) noexcept
+    {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void set(uint64_t value) noexcept
+    {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const noexcept
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_ { 0 };
+};
+
+
+class latency_histogram
+{
+public:
+    // upper bounds of the buckets, +Inf is implicit
+    static constexpr std::array<uint64_t, 12> bounds_ns = {
+        100'000,    250'000,    500'000,     1'000'000,   2'500'000,   5'000'000,
+        10'000'000, 25'000'000, 50'000'000, 100'000'000, 250'000'000, 1'000'000'000,
+    };
+
+    // only one thread may write at a time
+    void observe(uint64_t duration_ns) noexcept
+    {
+        size_t i = 0;
+        while (i < bounds_ns.size() && duration_ns > bounds_ns[i])
+        {
+            ++i;
+        }
+        buckets_[i].inc();
+        sum_ns_.inc(duration_ns);
+        count_.inc();
+    }
+
+    // adds end - begin, ignored when one of the stamps is missing
+    void observe(uint64_t begin_ns, uint64_t end_ns) noexcept
+    {
+        if (begin_ns != 0 && end_ns >= begin_ns)
+        {
+            observe(end_ns - begin_ns);
+        }
+    }
+
+    // not cumulative, index bounds_ns.size() is the +Inf bucket
+    uint64_t bucket(size_t index) const noexcept
+    {
+        return buckets_[index].get();
+    }
+
+    uint64_t sum_ns() const noexcept
+    {
+        return sum_ns_.get();
+    }
+
+    uint64_t count() const noexcept
+    {
+        return count_.get();
+    }
+
+private:
+    std::array<counter, bounds_ns.size() + 1> buckets_;
+    counter sum_ns_;
+    counter count_;
+};
+
+
+struct stream_metrics
+{
+    // written by the thread that delivers the images of the backend
+    counter frames_delivered;
+    counter frames_dropped; // as reported by the backend
+    counter frames_dropped_no_buffer; // tcam_drop_statistics
+    counter frames_dropped_transport;
+    counter frames_dropped_incomplete;
+    counter frames_damaged;
+    counter resent_packets; // GigE only
+    counter missing_packets; // GigE only
+    counter failed_buffers; // GigE only
+    counter underruns; // GigE only
+
+    latency_histogram latency_auto_pass; // software properties
+    latency_histogram latency_backend; // dequeue -> sink push
+
+    // written by tcamsrc
+    counter queue_pushed; // backend thread, buffer entered the handoff queue
+    counter queue_popped; // streaming thread, buffer was handed to GStreamer
+    counter buffers_released; // under device_state::requeue_mtx_
+    counter pool_size; // buffers of the tcamsrc buffer pool
+
+    latency_histogram latency_handoff; // sink push -> gst push
+    latency_histogram latency_total; // dequeue -> gst push
+};
+
+
+/**
+ * Metrics of a device, created on first use.
+ * All users of one device in the process share the instance,
+ * it is exported as long as one of them keeps it.
+ * @return nullptr when is_enabled() is false
+ */
+std::shared_ptr<stream_metrics> get_stream(const std::string& serial, const std::string& type);
+
+// the metrics of all devices in the Prometheus text exposition format 0.0.4
+std::string render();
+
+} // namespace tcam::metrics
@@ -16,44 +16,30 @@
 
 #include "property_dependencies.h"
 
+#include "PropertyInterfaces.h"
+
+#include <unordered_map>
+
 namespace
 {
 
 // clang-format off
-static const tcam::property::dependency_entry dependency_list[] =
+constexpr std::string_view exposure_auto_deps[] = { "ExposureTime" };
+constexpr std::string_view exposure_auto_upper_limit_auto_deps[] = { "ExposureAutoUpperLimit" };
+constexpr std::string_view gain_auto_deps[] = { "Gain" };
+constexpr std::string_view balance_white_auto_deps[] = { "BalanceWhiteRed", "BalanceWhiteGreen", "BalanceWhiteBlue" };
+constexpr std::string_view offset_auto_center_deps[] = { "OffsetX", "OffsetY" };
+constexpr std::string_view trigger_mode_deps[] = { "TriggerSoftware" };
+
+constexpr tcam::property::dependency_entry dependency_list[] =
 {
-    {
-        "ExposureAuto",
-        { "ExposureTime" },
-        "Continuous"
-    },
-    {
-        "ExposureAutoUpperLimitAuto",
-        {"ExposureAutoUpperLimit"},
-        "Continuous"
-    },
-    {
-        "GainAuto",
-        { "Gain" },
-        "Continuous"
-    },
-    {
-        "BalanceWhiteAuto",
-        { "BalanceWhiteRed","BalanceWhiteGreen", "BalanceWhiteBlue", },
-        "Continuous"
-    },
-    {
-        "OffsetAutoCenter",
-        { "OffsetX", "OffsetY" },
-        "On"
-    },
-    {
-        "TriggerMode",
-        {"TriggerSoftware"},
-        "Off"
-    }
+    { "ExposureAuto",               exposure_auto_deps,                     "Continuous" },
+    { "ExposureAutoUpperLimitAuto", exposure_auto_upper_limit_auto_deps,    "Continuous" },
+    { "GainAuto",                   gain_auto_deps,                         "Continuous" },
+    { "BalanceWhiteAuto",           balance_white_auto_deps,                "Continuous" },
+    { "OffsetAutoCenter",           offset_auto_center_deps,                "On" },
+    { "TriggerMode",                trigger_mode_deps,                      "Off" },
 };
-
 // clang-format on
 
 } // namespace
@@ -69,3 +55,47 @@ const tcam::property::dependency_entry* tcam::property::find_dependency_entry(st
     }
     return nullptr;
 }
+
+
+void tcam::property::link_dependent_properties(
+    const std::vector<std::shared_ptr<IPropertyBase>>& properties)
+{
+    // one pass over the properties, the table is tiny compared to large devices
+    std::unordered_map<std::string_view, std::shared_ptr<PropertyLock>> relevant;
+    for (const auto& entry : dependency_list)
+    {
+        relevant.emplace(entry.name, nullptr);
+        for (auto dep : entry.dependent_property_names) { relevant.emplace(dep, nullptr); }
+    }
+
+    for (const auto& prop : properties)
+    {
+        auto iter = relevant.find(prop->get_name());
+        if (iter != relevant.end())
+        {
+            iter->second = std::dynamic_pointer_cast<PropertyLock>(prop);
+        }
+    }
+
+    for (const auto& entry : dependency_list)
+    {
+        auto& locking = relevant[entry.name];
+        if (!locking)
+        {
+            continue;
+        }
+
+        std::vector<std::weak_ptr<PropertyLock>> dependents;
+        for (auto dep : entry.dependent_property_names)
+        {
+            if (auto& ptr = relevant[dep])
+            {
+                dependents.push_back(ptr);
+            }
+        }
+        if (!dependents.empty())
+        {
+            locking->set_dependent_properties(std::move(dependents));
+        }
+    }
+}
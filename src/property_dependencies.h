@@ -22,6 +22,8 @@
 
 namespace tcam::property
 {
+class IPropertyBase;
+
 class PropertyLock
 {
 public:
@@ -47,14 +49,68 @@ public:
     }
 };
 
+// view of a constant array of names
+struct name_list
+{
+    const std::string_view* first = nullptr;
+    size_t count = 0;
+
+    template<size_t N>
+    constexpr name_list(const std::string_view (&arr)[N]) noexcept : first(arr), count(N)
+    {
+    }
+
+    constexpr auto begin() const noexcept
+    {
+        return first;
+    }
+    constexpr auto end() const noexcept
+    {
+        return first + count;
+    }
+    constexpr size_t size() const noexcept
+    {
+        return count;
+    }
+    constexpr bool contains(std::string_view name) const noexcept
+    {
+        for (auto n : *this)
+        {
+            if (n == name)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    operator std::vector<std::string_view>() const
+    {
+        return { begin(), end() };
+    }
+};
+
 struct dependency_entry
 {
     const std::string_view name;
-    const std::vector<std::string_view> dependent_property_names;
+    const name_list dependent_property_names;
     const std::string_view prop_enum_state_for_locked;
     //const bool prop_boolean_state_for_locked = false; // currently unused
+
+    // enumeration value that was written to 'name' locks the dependents
+    constexpr bool locks_dependents(std::string_view enum_value) const noexcept
+    {
+        return enum_value == prop_enum_state_for_locked;
+    }
 };
 
 const dependency_entry* find_dependency_entry(std::string_view name);
 
+/**
+ * Passes the PropertyLock objects of the dependents to every property of the table
+ * that exists in properties, via set_dependent_properties.
+ * Only the names of the table are looked up, properties without dependencies are not touched.
+ */
+void link_dependent_properties(const std::vector<std::shared_ptr<IPropertyBase>>& properties);
+
 } // namespace tcam::property
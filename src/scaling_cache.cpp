@@ -0,0 +1,181 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scaling_cache.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <cctype>
+#include <cstdio> // std::rename
+#include <fstream>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr uint32_t cache_magic = 0x43533254; // "T2SC"
+constexpr uint32_t cache_version = 1;
+
+// probing yields a few dozen entries, anything above is a broken file
+constexpr uint32_t max_entries = 4096;
+constexpr uint32_t max_key_length = 4096;
+
+std::string cache_dir()
+{
+    return tcam::get_environment_variable(
+        "TCAM_SCALING_CACHE_DIR", tcam::get_environment_variable("TCAM_V4L2_FORMAT_CACHE_DIR", ""));
+}
+
+
+// the key is stored in the file, collisions of the sanitized name are detected on load
+std::string cache_file(const std::string& key)
+{
+    std::string name = key;
+    for (auto& c : name)
+    {
+        if (!isalnum((unsigned char)c))
+        {
+            c = '_';
+        }
+    }
+    return cache_dir() + "/scaling-" + name + ".cache";
+}
+
+
+template<class T> bool read(std::istream& stream, T& value)
+{
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+}
+
+
+template<class T> void write(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // namespace
+
+
+bool tcam::is_scaling_cache_enabled()
+{
+    return !cache_dir().empty();
+}
+
+
+std::optional<std::vector<tcam::cached_scaling>> tcam::load_scaling_cache(const std::string& key)
+{
+    if (key.empty() || !is_scaling_cache_enabled())
+    {
+        return std::nullopt;
+    }
+
+    std::ifstream f(cache_file(key), std::ios::binary);
+    if (!f)
+    {
+        return std::nullopt;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t key_length = 0;
+
+    if (!read(f, magic) || magic != cache_magic || !read(f, version) || version != cache_version
+        || !read(f, key_length) || key_length > max_key_length)
+    {
+        SPDLOG_DEBUG("Ignoring invalid scaling cache for '{}'", key);
+        return std::nullopt;
+    }
+
+    std::string file_key(key_length, '\0');
+    f.read(file_key.data(), key_length);
+    if (!f.good() || file_key != key)
+    {
+        return std::nullopt;
+    }
+
+    uint32_t count = 0;
+    if (!read(f, count) || count > max_entries)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<cached_scaling> ret(count);
+    for (auto& entry : ret)
+    {
+        if (!read(f, entry.scale.binning_h) || !read(f, entry.scale.binning_v)
+            || !read(f, entry.scale.skipping_h) || !read(f, entry.scale.skipping_v)
+            || !read(f, entry.mode))
+        {
+            return std::nullopt;
+        }
+    }
+
+    SPDLOG_DEBUG("Using cached scaling table for '{}'", key);
+
+    return ret;
+}
+
+
+void tcam::store_scaling_cache(const std::string& key, const std::vector<cached_scaling>& table)
+{
+    if (key.empty() || !is_scaling_cache_enabled())
+    {
+        return;
+    }
+
+    const std::string filename = cache_file(key);
+    // another process opening a camera of the same model may read the file concurrently
+    const std::string tmp_filename = filename + "." + std::to_string(getpid());
+
+    {
+        std::ofstream f(tmp_filename, std::ios::binary | std::ios::trunc);
+        if (!f)
+        {
+            SPDLOG_WARN("Unable to write scaling cache '{}'", filename);
+            return;
+        }
+
+        write(f, cache_magic);
+        write(f, cache_version);
+        write(f, (uint32_t)key.size());
+        f.write(key.data(), key.size());
+
+        write(f, (uint32_t)table.size());
+        for (const auto& entry : table)
+        {
+            write(f, entry.scale.binning_h);
+            write(f, entry.scale.binning_v);
+            write(f, entry.scale.skipping_h);
+            write(f, entry.scale.skipping_v);
+            write(f, entry.mode);
+        }
+
+        if (!f.good())
+        {
+            f.close();
+            unlink(tmp_filename.c_str());
+            SPDLOG_WARN("Unable to write scaling cache '{}'", filename);
+            return;
+        }
+    }
+
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+        unlink(tmp_filename.c_str());
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "base_types.h"
+#include "compiler_defines.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Binning/skipping combination that was found by probing the device.
+ * mode is backend specific, e.g. the v4l2 'Override Scanning Mode' value.
+ */
+struct cached_scaling
+{
+    image_scaling scale;
+    int64_t mode = 0;
+};
+
+/**
+ * The scaling tables only depend on model and firmware,
+ * cameras of the same kind share one cache file.
+ * Enabled by setting TCAM_SCALING_CACHE_DIR or TCAM_V4L2_FORMAT_CACHE_DIR to a writable directory.
+ */
+bool is_scaling_cache_enabled();
+
+/**
+ * @param key identifies model and firmware, has to contain everything that changes the table
+ * @return cached table when a cache file for key exists
+ */
+std::optional<std::vector<cached_scaling>> load_scaling_cache(const std::string& key);
+
+void store_scaling_cache(const std::string& key, const std::vector<cached_scaling>& table);
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -0,0 +1,380 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scope_tracing.h"
+
+#include "../libs/dutils_image/src/dutils_img_filter/utils/scope_profiler_impl.h"
+#include "logging.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> tcam::tracing::detail::enabled = false;
+
+namespace
+{
+
+struct trace_event
+{
+    const char* name;
+    uint32_t name_len;
+    int64_t begin_ns;
+    int64_t end_ns;
+};
+
+
+/*
+ * Forwards the DUTIL_PROFILE_* scopes of the dutils image algorithms into the trace.
+ * Lives in the thread_buffer of the thread it is registered for.
+ */
+class dutils_profiler_adapter : public scope_profiler::profiler_interface
+{
+public:
+    void* push_layer_entry(std::string_view text, int64_t /*now*/) noexcept final
+    {
+        if (!tcam::tracing::is_enabled() || depth_ == stack_.size())
+        {
+            return nullptr;
+        }
+        auto& entry = stack_[depth_++];
+        entry = { text, tcam::tracing::now_ns() };
+        return &entry;
+    }
+
+    void pop_layer_entry(void* ptr, int64_t /*now*/) noexcept final
+    {
+        auto entry = static_cast<open_scope*>(ptr);
+        tcam::tracing::add_event(entry->name, entry->begin_ns, tcam::tracing::now_ns());
+        depth_ = entry - stack_.data();
+    }
+
+    void reset() noexcept final
+    {
+        depth_ = 0;
+    }
+
+    scope_profiler::scope_timing_lists dump_scope_timing_lists() final
+    {
+        return {};
+    }
+
+private:
+    struct open_scope
+    {
+        std::string_view name;
+        int64_t begin_ns;
+    };
+
+    std::array<open_scope, 32> stack_ = {};
+    size_t depth_ = 0;
+};
+
+
+struct thread_buffer
+{
+    explicit thread_buffer(size_t capacity) : events(capacity) {}
+
+    std::vector<trace_event> events;
+    // total number of events written, events[count % size] is the next slot
+    std::atomic<uint64_t> count = 0;
+
+    pid_t tid = 0;
+    std::string thread_name;
+
+    // the thread ended, the buffer may be handed to a new thread
+    std::atomic<bool> retired = false;
+
+    dutils_profiler_adapter dutils_adapter;
+};
+
+
+// buffers of ended threads that are kept for the trace
+constexpr size_t max_retired_buffers = 64;
+
+size_t get_buffer_capacity()
+{
+    auto env = tcam::get_environment_variable_int("TCAM_TRACE_BUFFER_EVENTS");
+    if (env && env.value() > 0)
+    {
+        return env.value();
+    }
+    return 16 * 1024;
+}
+
+
+class trace_registry
+{
+public:
+    trace_registry()
+    {
+        auto file = tcam::get_environment_variable("TCAM_TRACE", "");
+        if (!file.empty())
+        {
+            start(file);
+        }
+    }
+
+    void start(const std::string& file)
+    {
+        std::scoped_lock lck { mtx_ };
+
+        file_ = file;
+        for (auto& b : buffers_)
+        {
+            b->count = 0;
+        }
+        tcam::tracing::detail::enabled = true;
+    }
+
+    void stop()
+    {
+        std::scoped_lock lck { mtx_ };
+
+        if (!tcam::tracing::detail::enabled.exchange(false))
+        {
+            return;
+        }
+        write_file();
+    }
+
+    thread_buffer* register_thread()
+    {
+        std::scoped_lock lck { mtx_ };
+
+        thread_buffer* buffer = nullptr;
+
+        size_t retired = 0;
+        for (auto& b : buffers_)
+        {
+            retired += b->retired ? 1 : 0;
+        }
+        if (retired >= max_retired_buffers)
+        {
+            // reuse the buffer that retired first
+            for (auto& b : buffers_)
+            {
+                if (b->retired)
+                {
+                    buffer = b.get();
+                    break;
+                }
+            }
+            // keep the order of registration
+            auto it = std::find_if(
+                buffers_.begin(), buffers_.end(), [buffer](auto& b) { return b.get() == buffer; });
+            std::rotate(it, it + 1, buffers_.end());
+
+            buffer->count = 0;
+            buffer->retired = false;
+        }
+        else
+        {
+            buffers_.push_back(std::make_unique<thread_buffer>(capacity_));
+            buffer = buffers_.back().get();
+        }
+
+        buffer->tid = (pid_t)syscall(SYS_gettid);
+
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        buffer->thread_name = name;
+
+        // do not replace a profiler that somebody else registered
+        if (auto prev = scope_profiler::register_threadlocal_profiler(&buffer->dutils_adapter); prev)
+        {
+            scope_profiler::register_threadlocal_profiler(prev);
+        }
+
+        return buffer;
+    }
+
+private:
+    void write_file() const
+    {
+        FILE* f = fopen(file_.c_str(), "w");
+        if (!f)
+        {
+            SPDLOG_ERROR("Unable to write trace file '{}'", file_);
+            return;
+        }
+
+        const pid_t pid = getpid();
+
+        auto write_string = [f](const char* str, size_t len)
+        {
+            fputc('"', f);
+            for (size_t i = 0; i < len; ++i)
+            {
+                const char c = str[i];
+                if (c == '"' || c == '\\')
+                {
+                    fputc('\\', f);
+                }
+                if ((unsigned char)c >= 0x20)
+                {
+                    fputc(c, f);
+                }
+            }
+            fputc('"', f);
+        };
+
+        fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+        size_t written = 0;
+        for (const auto& b : buffers_)
+        {
+            const uint64_t count = b->count.load(std::memory_order_acquire);
+            if (count == 0)
+            {
+                continue;
+            }
+
+            fprintf(f,
+                    "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                    written++ ? ",\n" : "",
+                    pid,
+                    b->tid);
+            write_string(b->thread_name.c_str(), b->thread_name.size());
+            fprintf(f, "}}");
+
+            const size_t size = b->events.size();
+            const uint64_t first = count > size ? count - size : 0;
+            for (uint64_t i = first; i < count; ++i)
+            {
+                const auto& e = b->events[i % size];
+                fprintf(f, ",\n{\"ph\":\"X\",\"name\":");
+                write_string(e.name, e.name_len);
+                fprintf(f,
+                        ",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                        pid,
+                        b->tid,
+                        e.begin_ns / 1000.,
+                        (e.end_ns - e.begin_ns) / 1000.);
+            }
+        }
+
+        fprintf(f, "\n]}\n");
+        fclose(f);
+
+        SPDLOG_INFO("Wrote trace to '{}'", file_);
+    }
+
+    std::mutex mtx_;
+    std::string file_;
+    const size_t capacity_ = get_buffer_capacity();
+    std::vector<std::unique_ptr<thread_buffer>> buffers_;
+};
+
+
+trace_registry& get_registry()
+{
+    // never destroyed, threads may still record while the process exits
+    static trace_registry* registry = new trace_registry();
+    return *registry;
+}
+
+
+// evaluates TCAM_TRACE when the library is loaded and writes the trace on exit
+struct trace_on_exit
+{
+    trace_on_exit()
+    {
+        get_registry();
+    }
+
+    ~trace_on_exit()
+    {
+        get_registry().stop();
+    }
+} trace_on_exit_instance;
+
+
+// marks the buffer as reusable when its thread ends
+struct thread_buffer_handle
+{
+    thread_buffer* buffer = nullptr;
+
+    ~thread_buffer_handle()
+    {
+        if (buffer)
+        {
+            scope_profiler::register_threadlocal_profiler(nullptr);
+            buffer->retired = true;
+        }
+    }
+};
+
+thread_local thread_buffer_handle current_thread_buffer;
+
+} // namespace
+
+
+int64_t tcam::tracing::now_ns() noexcept
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+
+void tcam::tracing::start(const std::string& file)
+{
+    get_registry().start(file);
+}
+
+
+void tcam::tracing::stop()
+{
+    get_registry().stop();
+}
+
+
+void tcam::tracing::add_event(std::string_view name, int64_t begin_ns, int64_t end_ns) noexcept
+{
+    if (!is_enabled())
+    {
+        return;
+    }
+
+    auto& handle = current_thread_buffer;
+    if (!handle.buffer)
+    {
+        try
+        {
+            handle.buffer = get_registry().register_thread();
+        }
+        catch (const std::exception&)
+        {
+            return;
+        }
+    }
+
+    auto buffer = handle.buffer;
+    const uint64_t count = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[count % buffer->events.size()] = {
+        name.data(), (uint32_t)name.size(), begin_ns, end_ns
+    };
+    buffer->count.store(count + 1, std::memory_order_release);
+}
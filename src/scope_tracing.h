@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * Runtime scope tracer.
+ *
+ * Every thread records its scopes into its own ring buffer,
+ * the buffers are written as Chrome trace_event JSON
+ * (chrome://tracing, ui.perfetto.dev) when tracing stops or the process exits.
+ *
+ * Tracing is started by setting TCAM_TRACE to the output file
+ * or by calling start().
+ * While disabled a scope costs a single relaxed atomic load.
+ *
+ * The implementation lives in libtcam and is shared with the gstreamer plugins,
+ * so that one process writes a single trace.
+ */
+namespace tcam::tracing
+{
+
+namespace detail
+{
+extern std::atomic<bool> enabled;
+}
+
+inline bool is_enabled() noexcept
+{
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// CLOCK_MONOTONIC in ns
+int64_t now_ns() noexcept;
+
+/**
+ * Begin recording, previously recorded events are dropped.
+ * @param file - the trace is written to this file by stop()
+ */
+void start(const std::string& file);
+
+/**
+ * Stop recording and write the trace file.
+ * Scopes that are still open are not part of the trace.
+ */
+void stop();
+
+/**
+ * Record a finished scope of the calling thread.
+ * name has to outlive the trace, string literals and __func__ are fine.
+ */
+void add_event(std::string_view name, int64_t begin_ns, int64_t end_ns) noexcept;
+
+class scope
+{
+public:
+    explicit scope(std::string_view name) noexcept
+    {
+        if (is_enabled())
+        {
+            name_ = name;
+            begin_ns_ = now_ns();
+        }
+    }
+
+    ~scope()
+    {
+        if (begin_ns_ != 0)
+        {
+            add_event(name_, begin_ns_, now_ns());
+        }
+    }
+
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+
+private:
+    std::string_view name_;
+    int64_t begin_ns_ = 0;
+};
+
+} // namespace tcam::tracing
+
+#define TCAM_TRACE_CONCAT_(a, b) a##b
+#define TCAM_TRACE_CONCAT(a, b)  TCAM_TRACE_CONCAT_(a, b)
+
+// records the enclosing block under name
+#define TCAM_TRACE_SCOPE(name) \
+    ::tcam::tracing::scope TCAM_TRACE_CONCAT(tcam_trace_scope_, __LINE__) { name }
+
+#define TCAM_TRACE_FUNCTION() TCAM_TRACE_SCOPE(__func__)
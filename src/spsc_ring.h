@@ -0,0 +1,217 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+namespace tcam
+{
+
+/**
+ * Bounded lock-free ring for exactly one producer and one consumer.
+ *
+ * Used to hand images from threads that must not block, e.g. backend event threads,
+ * to the thread that delivers them.
+ * push() never blocks, a blocked consumer sleeps on a futex and is woken by push() or notify().
+ */
+template<typename T> class spsc_ring
+{
+public:
+    spsc_ring() = default;
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // Not thread safe. Only call while neither producer nor consumer are active.
+    void reset(size_t min_capacity)
+    {
+        size_t cap = 1;
+        while (cap < min_capacity)
+        {
+            cap <<= 1;
+        }
+        slots_.clear();
+        slots_.resize(cap);
+        mask_ = cap - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        full_stalls_.store(0, std::memory_order_relaxed);
+        empty_stalls_.store(0, std::memory_order_relaxed);
+    }
+
+    // producer side
+    bool push(T&& value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+        {
+            full_stalls_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+
+        wake(false);
+        return true;
+    }
+
+    // consumer side
+    bool try_pop(T& out)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        out = std::move(slots_[head & mask_]);
+        slots_[head & mask_] = T {};
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Block until an element is available.
+     * Returns false without an element once stop_requested() returns true.
+     * Whoever makes stop_requested() true has to call notify() afterwards.
+     */
+    template<class Tpred> bool pop_wait(T& out, Tpred&& stop_requested)
+    {
+        while (true)
+        {
+            if (stop_requested())
+            {
+                return false;
+            }
+            if (try_pop(out))
+            {
+                return true;
+            }
+
+            // a push after this load changes the value and futex_wait returns immediately
+            const uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+
+            if (try_pop(out))
+            {
+                return true;
+            }
+            if (stop_requested())
+            {
+                return false;
+            }
+
+            empty_stalls_.fetch_add(1, std::memory_order_relaxed);
+
+            consumer_waiting_.store(true, std::memory_order_seq_cst);
+            syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, seq, nullptr, nullptr, 0);
+            consumer_waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Block until an element is available without taking it.
+     * Returns false once deadline has passed or stop_requested() returns true.
+     */
+    template<class Tpred>
+    bool wait_until(std::chrono::steady_clock::time_point deadline, Tpred&& stop_requested)
+    {
+        while (true)
+        {
+            if (stop_requested())
+            {
+                return false;
+            }
+
+            const uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+
+            if (head_.load(std::memory_order_relaxed) != tail_.load(std::memory_order_acquire))
+            {
+                return true;
+            }
+
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::steady_clock::duration::zero())
+            {
+                return false;
+            }
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            const timespec timeout = { static_cast<time_t>(ns / 1'000'000'000),
+                                       static_cast<long>(ns % 1'000'000'000) };
+
+            consumer_waiting_.store(true, std::memory_order_seq_cst);
+            syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, seq, &timeout, nullptr, 0);
+            consumer_waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // wake a blocked consumer, e.g. when the stream is stopped
+    void notify()
+    {
+        wake(true);
+    }
+
+    // number of pushes that failed because the consumer did not keep up
+    uint64_t full_stalls() const
+    {
+        return full_stalls_.load(std::memory_order_relaxed);
+    }
+
+    // number of times the consumer had to sleep because no image was available
+    uint64_t empty_stalls() const
+    {
+        return empty_stalls_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void wake(bool force)
+    {
+        wake_seq_.fetch_add(1, std::memory_order_seq_cst);
+        if (force || consumer_waiting_.load(std::memory_order_seq_cst))
+        {
+            syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+    uint32_t* futex_word()
+    {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+        return reinterpret_cast<uint32_t*>(&wake_seq_);
+    }
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    // producer and consumer positions live on separate cache lines
+    alignas(64) std::atomic<size_t> head_ { 0 };
+    alignas(64) std::atomic<size_t> tail_ { 0 };
+
+    alignas(64) std::atomic<uint32_t> wake_seq_ { 0 };
+    std::atomic<bool> consumer_waiting_ { false };
+
+    std::atomic<uint64_t> full_stalls_ { 0 };
+    std::atomic<uint64_t> empty_stalls_ { 0 };
+};
+
+} // namespace tcam
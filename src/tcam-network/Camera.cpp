@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <arpa/inet.h>
+#include <chrono>
 #include <cstring>
 #include <errno.h>
 #include <future>
@@ -28,6 +29,7 @@
 #include <iostream>
 #include <linux/if.h>
 #include <netdb.h>
+#include <numeric>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <thread>
@@ -93,7 +95,7 @@ Camera::Camera(const Packet::ACK_DISCOVERY& _packet,
                std::shared_ptr<NetworkInterface> _interface,
                int timeoutIntervals)
     : packet(_packet), interface(_interface), timeoutCounter(timeoutIntervals),
-      timeoutCounterDefault(timeoutIntervals)
+      timeoutCounterDefault(timeoutIntervals), maxOutstandingRequests(MAX_OUTSTANDING_REQUESTS)
 {
     this->socket = interface->createSocket();
 
@@ -467,6 +469,25 @@ bool Camera::setPersistentGateway(const std::string& gateway)
 }
 
 
+bool Camera::getPersistentIPConfig(std::string& ip, std::string& subnet, std::string& gateway)
+{
+    std::vector<uint32_t> values;
+    if (!readRegisters({ Register::PERSISTANT_IPADDRESS_REGISTER,
+                         Register::PERSISTANT_SUBNETMASK_REGISTER,
+                         Register::PERSISTANT_DEFAULTGATEWAY_REGISTER },
+                       values))
+    {
+        return false;
+    }
+
+    // readRegisters returns host order, int2ip expects the wire order
+    ip = int2ip(htonl(values.at(0)));
+    subnet = int2ip(htonl(values.at(1)));
+    gateway = int2ip(htonl(values.at(2)));
+    return true;
+}
+
+
 bool Camera::forceIP(const std::string& ip, const std::string& subnet, const std::string& gateway)
 {
     uint32_t _ip = ip2int(ip);
@@ -888,6 +909,317 @@ bool Camera::sendWriteMemory(const uint32_t address, const size_t size, void* da
 }
 
 
+namespace
+{
+
+std::vector<uint8_t> createMemoryPacket(bool write,
+                                        uint32_t address,
+                                        uint32_t size,
+                                        const uint8_t* data,
+                                        unsigned short id)
+{
+    if (write)
+    {
+        std::vector<uint8_t> packet_(sizeof(Packet::CMD_WRITEMEM) + (size - sizeof(uint32_t)));
+        auto _packet = (Packet::CMD_WRITEMEM*)packet_.data();
+
+        _packet->header.magic = 0x42;
+        _packet->header.flag = Flags::NEEDACK;
+        _packet->header.command = htons(Commands::WRITEMEM_CMD);
+        _packet->header.length = htons(size + sizeof(uint32_t));
+        _packet->header.req_id = htons(id);
+
+        memcpy(&_packet->data, data, size);
+        _packet->address = htonl(address);
+
+        return packet_;
+    }
+
+    std::vector<uint8_t> packet_(sizeof(Packet::CMD_READMEM));
+    auto _packet = (Packet::CMD_READMEM*)packet_.data();
+
+    _packet->header.magic = 0x42;
+    _packet->header.flag = Flags::NEEDACK;
+    _packet->header.command = htons(Commands::READMEM_CMD);
+    _packet->header.length = htons(sizeof(Packet::CMD_READMEM) - sizeof(Packet::COMMAND_HEADER));
+    _packet->header.req_id = htons(id);
+
+    _packet->count = htons(size);
+    _packet->address = htonl(address);
+
+    return packet_;
+}
+
+} // namespace
+
+
+bool Camera::sendMemoryRequests(const std::vector<memory_request>& requests)
+{
+    struct in_flight
+    {
+        size_t index;
+        unsigned short id;
+        int retries;
+        std::vector<uint8_t> packet;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    const auto timeout = std::chrono::milliseconds(socket->getTimeout());
+
+    std::vector<in_flight> pending;
+    size_t next = 0;
+
+    try
+    {
+        while (next < requests.size() || !pending.empty())
+        {
+            while (next < requests.size() && (int)pending.size() < maxOutstandingRequests)
+            {
+                const auto& req = requests.at(next);
+
+                if ((req.size % 4) != 0 || req.size == 0 || req.size > MAX_MEMORY_BLOCK_SIZE)
+                {
+                    return false;
+                }
+
+                unsigned short id = generateRequestID();
+
+                in_flight entry = { next,
+                                    id,
+                                    tis::PACKET_RETRY_COUNT - 1,
+                                    createMemoryPacket(req.write, req.address, req.size, req.data, id),
+                                    std::chrono::steady_clock::now() };
+
+                socket->send(getCurrentIP(), entry.packet.data(), entry.packet.size());
+                pending.push_back(std::move(entry));
+                next++;
+            }
+
+            // pending is ordered by send time, the first entry times out first
+            auto now = std::chrono::steady_clock::now();
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                pending.front().sent + timeout - now);
+
+            if (wait.count() > 0)
+            {
+                uint8_t msg[1024];
+                ssize_t received = socket->receive(msg, sizeof(msg), wait.count());
+
+                if (received >= (ssize_t)sizeof(Packet::ACK_HEADER))
+                {
+                    auto header = (Packet::ACK_HEADER*)msg;
+
+                    auto iter = std::find_if(pending.begin(),
+                                             pending.end(),
+                                             [header](const in_flight& entry)
+                                             { return entry.id == ntohs(header->ack_id); });
+
+                    if (iter == pending.end())
+                    {
+                        // late answer for a request that was already resent
+                        continue;
+                    }
+
+                    const auto& req = requests.at(iter->index);
+                    unsigned int expected = req.write ? Commands::WRITEMEM_ACK : Commands::READMEM_ACK;
+                    if (ntohs(header->answer) != expected)
+                    {
+                        continue;
+                    }
+
+                    unsigned int status = ntohs(header->status);
+
+                    if (status == Status::BUSY)
+                    {
+                        // the camera rejected a concurrent request, treat it like a timeout
+                        maxOutstandingRequests = 1;
+                        iter->sent = now - timeout;
+                        std::rotate(pending.begin(), iter, iter + 1);
+                        continue;
+                    }
+                    if (status != Status::SUCCESS)
+                    {
+                        if (status == Status::ACCESS_DENIED)
+                        {
+                            std::cout << "Unable to access memory. Access Denied." << std::endl;
+                        }
+                        return false;
+                    }
+
+                    if (!req.write)
+                    {
+                        auto ack = (Packet::ACK_READMEM*)msg;
+                        if (received < (ssize_t)(sizeof(Packet::ACK_READMEM) + req.size))
+                        {
+                            return false;
+                        }
+                        memcpy(req.data, ack->data, req.size);
+                    }
+
+                    pending.erase(iter);
+                    continue;
+                }
+
+                now = std::chrono::steady_clock::now();
+                if (now < pending.front().sent + timeout)
+                {
+                    continue;
+                }
+            }
+
+            // oldest request timed out
+            // cameras that handle only one request at a time drop the others,
+            // stop sending concurrent requests to them
+            maxOutstandingRequests = 1;
+
+            auto& oldest = pending.front();
+            if (oldest.retries == 0)
+            {
+                return false;
+            }
+            oldest.retries--;
+
+            // resend with the same id, the camera may detect the duplicate
+            socket->send(getCurrentIP(), oldest.packet.data(), oldest.packet.size());
+            oldest.sent = std::chrono::steady_clock::now();
+            std::rotate(pending.begin(), pending.begin() + 1, pending.end());
+        }
+    }
+    catch (SocketSendToException& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool Camera::readMemoryBlocks(const uint32_t address,
+                              const size_t size,
+                              void* data,
+                              uint32_t block_size)
+{
+    block_size = std::min(block_size, MAX_MEMORY_BLOCK_SIZE);
+    if ((size % 4) != 0 || block_size == 0 || (block_size % 4) != 0)
+    {
+        return false;
+    }
+
+    std::vector<memory_request> requests;
+    for (size_t offset = 0; offset < size; offset += block_size)
+    {
+        requests.push_back({ false,
+                             (uint32_t)(address + offset),
+                             (uint32_t)std::min<size_t>(block_size, size - offset),
+                             (uint8_t*)data + offset });
+    }
+
+    return sendMemoryRequests(requests);
+}
+
+
+bool Camera::writeMemoryBlocks(const uint32_t address,
+                               const size_t size,
+                               void* data,
+                               uint32_t block_size)
+{
+    block_size = std::min(block_size, MAX_MEMORY_BLOCK_SIZE);
+    if ((size % 4) != 0 || block_size == 0 || (block_size % 4) != 0)
+    {
+        return false;
+    }
+
+    std::vector<memory_request> requests;
+    for (size_t offset = 0; offset < size; offset += block_size)
+    {
+        requests.push_back({ true,
+                             (uint32_t)(address + offset),
+                             (uint32_t)std::min<size_t>(block_size, size - offset),
+                             (uint8_t*)data + offset });
+    }
+
+    return sendMemoryRequests(requests);
+}
+
+
+bool Camera::readRegisters(const std::vector<uint32_t>& addresses, std::vector<uint32_t>& values)
+{
+    values.assign(addresses.size(), 0);
+
+    if (addresses.empty())
+    {
+        return true;
+    }
+
+    if (std::any_of(addresses.begin(), addresses.end(), [](uint32_t a) { return (a % 4) != 0; }))
+    {
+        return false;
+    }
+
+    std::vector<size_t> order(addresses.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(),
+              order.end(),
+              [&addresses](size_t a, size_t b) { return addresses.at(a) < addresses.at(b); });
+
+    // one READMEM per run of adjacent registers
+    struct register_run
+    {
+        uint32_t address;
+        std::vector<uint32_t> raw;
+    };
+    std::vector<register_run> runs;
+
+    for (auto idx : order)
+    {
+        uint32_t addr = addresses.at(idx);
+
+        if (!runs.empty())
+        {
+            auto& run = runs.back();
+            uint32_t end = run.address + run.raw.size() * sizeof(uint32_t);
+
+            if (addr < end)
+            {
+                // requested twice
+                continue;
+            }
+            if (addr == end && (run.raw.size() + 1) * sizeof(uint32_t) <= MAX_MEMORY_BLOCK_SIZE)
+            {
+                run.raw.push_back(0);
+                continue;
+            }
+        }
+        runs.push_back({ addr, std::vector<uint32_t>(1) });
+    }
+
+    std::vector<memory_request> requests;
+    for (auto& run : runs)
+    {
+        requests.push_back({ false,
+                             run.address,
+                             (uint32_t)(run.raw.size() * sizeof(uint32_t)),
+                             (uint8_t*)run.raw.data() });
+    }
+
+    if (!sendMemoryRequests(requests))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < addresses.size(); ++i)
+    {
+        auto run = std::find_if(runs.rbegin(),
+                                runs.rend(),
+                                [&](const register_run& r) { return r.address <= addresses.at(i); });
+        values.at(i) = ntohl(run->raw.at((addresses.at(i) - run->address) / sizeof(uint32_t)));
+    }
+
+    return true;
+}
+
+
 void Camera::sendForceIP(const uint32_t ip, const uint32_t subnet, const uint32_t gateway)
 {
     unsigned short id = generateRequestID();
@@ -54,6 +54,13 @@ std::shared_ptr<Camera> getCameraFromList(const camera_list cameras,
                                           camera_ident id_type = CAMERA_SERIAL);
 
 const int PACKET_RETRY_COUNT = 5;
+
+/// largest payload of a single READMEM/WRITEMEM packet
+const uint32_t MAX_MEMORY_BLOCK_SIZE = 512;
+
+/// number of memory requests that are sent before waiting for the first acknowledge
+const int MAX_OUTSTANDING_REQUESTS = 4;
+
 class Camera
 {
 private:
@@ -78,6 +85,17 @@ private:
     // default value from constructor
     int timeoutCounterDefault;
 
+    // reduced to 1 when the camera does not answer concurrent requests
+    int maxOutstandingRequests;
+
+    struct memory_request
+    {
+        bool write;
+        uint32_t address;
+        uint32_t size;
+        uint8_t* data;
+    };
+
 public:
     Camera(const Packet::ACK_DISCOVERY& packet,
            std::shared_ptr<NetworkInterface> _interface,
@@ -161,6 +179,14 @@ public:
     const std::string getPersistentGateway();
     bool setPersistentGateway(const std::string& ip);
 
+    /// @name getPersistentIPConfig
+    /// @param ip - will be filled with the persistent ip
+    /// @param subnet - will be filled with the persistent subnet
+    /// @param gateway - will be filled with the persistent gateway
+    /// @return true on success
+    /// @brief Reads all persistent ip registers with a single readRegisters call
+    bool getPersistentIPConfig(std::string& ip, std::string& subnet, std::string& gateway);
+
     /// @name forceIP
     /// @param ip - address to be used
     /// @param subnet - subnet address to be used
@@ -249,7 +275,44 @@ public:
     /// @return int containing the return value of write attempt
     bool sendWriteMemory(const uint32_t address, const size_t size, void* data);
 
+    /// @name readMemoryBlocks
+    /// @param address - address that shall be read
+    /// @param size - size of memory to read
+    /// @param data - pointer to container that shall be filled
+    /// @param block_size - largest size of a single request
+    /// @return true on success
+    /// @brief Reads memory of arbitrary size with multiple requests in flight
+    bool readMemoryBlocks(const uint32_t address,
+                          const size_t size,
+                          void* data,
+                          uint32_t block_size = MAX_MEMORY_BLOCK_SIZE);
+
+    /// @name writeMemoryBlocks
+    /// @param address - memory address to be written
+    /// @param size - size of data that shall be written
+    /// @param data - pointer to information that shall be written
+    /// @param block_size - largest size of a single request
+    /// @return true on success
+    /// @brief Writes memory of arbitrary size with multiple requests in flight
+    bool writeMemoryBlocks(const uint32_t address,
+                           const size_t size,
+                           void* data,
+                           uint32_t block_size = MAX_MEMORY_BLOCK_SIZE);
+
+    /// @name readRegisters
+    /// @param addresses - register addresses that shall be read
+    /// @param values - will be filled with the register values, same order as addresses
+    /// @return true on success
+    /// @brief Adjacent registers are merged into a single READMEM request
+    bool readRegisters(const std::vector<uint32_t>& addresses, std::vector<uint32_t>& values);
+
 private:
+    /// @name sendMemoryRequests
+    /// @param requests - READMEM/WRITEMEM operations that shall be executed
+    /// @return true when all requests succeeded
+    /// @brief Keeps up to maxOutstandingRequests requests in flight and matches acknowledges by id
+    bool sendMemoryRequests(const std::vector<memory_request>& requests);
+
     /// @name sendForceIP
     /// @param ip - ip address camera shall use
     /// @param netmask - netmask camera shall use
@@ -20,12 +20,15 @@
 #include "utils.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <errno.h>
 #include <iostream> // cerr
 #include <linux/if.h>
 #include <netdb.h>
+#include <sys/epoll.h>
 #include <thread>
+#include <unistd.h>
 
 namespace tis
 {
@@ -74,58 +77,157 @@ std::vector<std::shared_ptr<NetworkInterface>> detectNetworkInterfaces()
 
 void discoverCameras(std::function<void(std::shared_ptr<Camera>)> const& discover_call)
 {
-    std::vector<std::shared_ptr<Camera>> cameras;
+    discoverCameras(detectNetworkInterfaces(), discover_call, DiscoveryOptions());
+}
+
+
+void discoverCameras(std::vector<std::string> selectected_interfaces,
+                     std::function<void(std::shared_ptr<Camera>)> const& discover_call)
+{
     auto interfaces = detectNetworkInterfaces();
 
+    interfaces.erase(std::remove_if(interfaces.begin(),
+                                    interfaces.end(),
+                                    [&selectected_interfaces](const auto& inf) {
+                                        return std::find(selectected_interfaces.begin(),
+                                                         selectected_interfaces.end(),
+                                                         inf->getInterfaceName())
+                                               == selectected_interfaces.end();
+                                    }),
+                     interfaces.end());
+
+    discoverCameras(interfaces, discover_call, DiscoveryOptions());
+}
+
+
+void discoverCameras(const std::vector<std::shared_ptr<NetworkInterface>>& interfaces,
+                     const std::function<void(std::shared_ptr<Camera>)>& discover_call,
+                     const DiscoveryOptions& options)
+{
     if (interfaces.empty())
     {
         return;
     }
 
-    std::vector<std::thread> thread_list;
-    // allocate whole in one step
-    thread_list.reserve(interfaces.size());
-
-    for (auto& inf : interfaces)
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
     {
-        std::shared_ptr<NetworkInterface> ni = inf;
-        thread_list.push_back(
-            std::thread([inf, discover_call]() { sendDiscovery(inf, discover_call); }));
+        std::cerr << "Unable to create epoll instance: " << strerror(errno) << std::endl;
+        return;
     }
 
-    for (auto& thr : thread_list) { thr.join(); }
-}
+    Packet::CMD_DISCOVERY discovery_packet;
+    discovery_packet.header.command = htons(Commands::DISCOVERY_CMD);
+    discovery_packet.header.flag = Flags::NEEDACK;
+    discovery_packet.header.length = htons(0);
+    discovery_packet.header.magic = 0x42;
+    discovery_packet.header.req_id = htons(1);
 
+    // index matches interfaces
+    std::vector<std::shared_ptr<Socket>> sockets(interfaces.size());
 
-void discoverCameras(std::vector<std::string> selectected_interfaces,
-                     std::function<void(std::shared_ptr<Camera>)> const& discover_call)
-{
-    std::vector<std::shared_ptr<Camera>> cameras;
-    auto interfaces = detectNetworkInterfaces();
-
-    if (interfaces.empty())
+    for (size_t i = 0; i < interfaces.size(); ++i)
     {
-        return;
+        try
+        {
+            auto s = interfaces.at(i)->createSocket();
+            s->send("255.255.255.255", &discovery_packet, sizeof(discovery_packet), true);
+
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = i;
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, s->getFd(), &ev) == 0)
+            {
+                sockets.at(i) = s;
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << interfaces.at(i)->getInterfaceName() << ": " << e.what() << std::endl;
+        }
     }
 
-    std::vector<std::thread> thread_list;
-    // allocate whole in one step
-    thread_list.reserve(interfaces.size());
+    using clock = std::chrono::steady_clock;
+
+    const auto start = clock::now();
+    const auto deadline = start + std::chrono::milliseconds(options.timeout_ms);
+    // set with the first answer
+    auto quiet_end = clock::time_point::max();
+
+    epoll_event events[16];
 
-    for (auto& inf : interfaces)
+    while (true)
     {
-        if (std::find(selectected_interfaces.begin(),
-                      selectected_interfaces.end(),
-                      inf->getInterfaceName())
-            != selectected_interfaces.end())
+        auto now = clock::now();
+        auto end = std::min(deadline, quiet_end);
+        if (now >= end)
         {
-            std::shared_ptr<NetworkInterface> ni = inf;
-            thread_list.push_back(
-                std::thread([inf, discover_call]() { sendDiscovery(inf, discover_call); }));
+            break;
+        }
+
+        int wait_ms = std::chrono::ceil<std::chrono::milliseconds>(end - now).count();
+        int n = epoll_wait(epoll_fd, events, std::size(events), wait_ms);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (int e = 0; e < n; ++e)
+        {
+            const size_t index = events[e].data.u64;
+            const int fd = sockets.at(index)->getFd();
+
+            // drain everything that arrived on this interface
+            while (true)
+            {
+                char msg[1024];
+                ssize_t received = recvfrom(fd, msg, sizeof(msg), MSG_DONTWAIT, nullptr, nullptr);
+                if (received < 0)
+                {
+                    break;
+                }
+
+                if ((size_t)received < sizeof(Packet::ACK_DISCOVERY))
+                {
+                    continue;
+                }
+
+                auto ack = (Packet::ACK_DISCOVERY*)msg;
+                if (ntohs(ack->header.answer) != Commands::DISCOVERY_ACK)
+                {
+                    continue;
+                }
+
+                discover_call(std::make_shared<Camera>(*ack, interfaces.at(index)));
+
+                if (options.quiet_period_ms > 0)
+                {
+                    // cameras on slow links answer late,
+                    // give them as long as the latest answer took
+                    auto arrival = clock::now();
+                    auto quiet = std::max<clock::duration>(
+                        std::chrono::milliseconds(options.quiet_period_ms), arrival - start);
+                    quiet_end = arrival + quiet;
+                }
+            }
         }
     }
 
-    for (auto& thr : thread_list) { thr.join(); }
+    close(epoll_fd);
+}
+
+
+std::future<void> discoverCamerasAsync(std::function<void(std::shared_ptr<Camera>)> discover_call,
+                                       const DiscoveryOptions& options)
+{
+    return std::async(std::launch::async,
+                      [discover_call = std::move(discover_call), options]() {
+                          discoverCameras(detectNetworkInterfaces(), discover_call, options);
+                      });
 }
 
 
@@ -21,6 +21,7 @@
 #include "NetworkInterface.h"
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
@@ -31,6 +32,17 @@ VISIBILITY_DEFAULT
 
 namespace tis
 {
+
+struct DiscoveryOptions
+{
+    /// upper bound for the whole discovery in milliseconds
+    int timeout_ms = 1500;
+
+    /// minimum time without new answers before the discovery ends early;
+    /// grows with the arrival time of the latest answer; 0 always waits timeout_ms
+    int quiet_period_ms = 100;
+};
+
 /// @name detectInterfaces
 /// @return vector containing all usable network interfaces and a corresponding socket; empty on error
 std::vector<std::shared_ptr<NetworkInterface>> detectNetworkInterfaces();
@@ -45,6 +57,24 @@ void discoverCameras(const std::function<void(std::shared_ptr<Camera>)>& discove
 void discoverCameras(std::vector<std::string> selectected_interfaces,
                      std::function<void(std::shared_ptr<Camera>)> const& discover_call);
 
+/// @name discoverCameras
+/// @param interfaces - interfaces that shall be queried
+/// @param discover_call - function to call on discovery of a camera
+/// @param options - timeouts of the discovery
+/// @brief sends on all interfaces at once and calls discover_call as answers arrive;
+///        discover_call is always called from the calling thread
+void discoverCameras(const std::vector<std::shared_ptr<NetworkInterface>>& interfaces,
+                     const std::function<void(std::shared_ptr<Camera>)>& discover_call,
+                     const DiscoveryOptions& options);
+
+/// @name discoverCamerasAsync
+/// @param discover_call - function to call on discovery of a camera
+/// @param options - timeouts of the discovery
+/// @return future that becomes ready when the discovery ended;
+///         discover_call is called from a worker thread
+std::future<void> discoverCamerasAsync(std::function<void(std::shared_ptr<Camera>)> discover_call,
+                                       const DiscoveryOptions& options = DiscoveryOptions());
+
 /// @name
 /// @param interface - object describing the interface that shall be pinged
 /// @param discover_call - function to call on discovery of a camera
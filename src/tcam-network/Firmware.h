@@ -79,6 +79,18 @@ public:
         /* } */
     }
 
+
+    virtual bool write_blocks(uint32_t addr, void* pData, size_t data_size, size_t block_size)
+    {
+        return device_itf_.writeMemoryBlocks(addr, data_size, pData, (uint32_t)block_size);
+    }
+
+
+    virtual bool read_blocks(uint32_t addr, size_t data_size, void* pData, size_t block_size)
+    {
+        return device_itf_.readMemoryBlocks(addr, data_size, pData, (uint32_t)block_size);
+    }
+
 private:
     Camera& device_itf_;
 
@@ -35,30 +35,29 @@ void internalExtractFile(const std::string& packageFileName,
 
     struct zip_stat st;
     zip_stat_init(&st);
-    zip_stat(z, fileName.c_str(), 0, &st);
-
-    //Alloc memory for its uncompressed contents
-    char* contents = new char[st.size];
+    if (zip_stat(z, fileName.c_str(), 0, &st) != 0)
+    {
+        zip_close(z);
+        return;
+    }
 
-    //Read the compressed file
+    //Read the compressed file directly into dest
     zip_file* f = zip_fopen(z, fileName.c_str(), 0);
     if (f == nullptr)
     {
-        delete[] contents;
+        zip_close(z);
         return;
     }
-    zip_uint64_t ret = zip_fread(f, contents, st.size);
 
-    if (ret != st.size)
+    dest.resize(st.size);
+    zip_int64_t ret = zip_fread(f, dest.data(), st.size);
+    if (ret < 0 || (zip_uint64_t)ret != st.size)
     {
-        delete[] contents;
-        return;
+        dest.clear();
     }
 
-    dest.assign(contents, contents + st.size);
-
+    zip_fclose(f);
     zip_close(z);
-    delete[] contents;
 }
 } // namespace
 
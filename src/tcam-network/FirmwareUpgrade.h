@@ -18,6 +18,7 @@
 
 #include "gigevision.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -79,6 +80,50 @@ public:
                       unsigned int& read_count,
                       unsigned int timeout_in_ms = 2000) = 0;
 
+    /// @name write_blocks
+    /// @param addr - adddress that shall be written
+    /// @param pData - data that shall be written
+    /// @param data_size - size of pData
+    /// @param block_size - largest size of a single write
+    /// @return true on success
+    /// @brief writes consecutive blocks; devices that can pipeline requests should override this
+    virtual bool write_blocks(uint32_t addr, void* pData, size_t data_size, size_t block_size)
+    {
+        for (size_t offset = 0; offset < data_size; offset += block_size)
+        {
+            if (!write((uint32_t)(addr + offset),
+                       (uint8_t*)pData + offset,
+                       std::min(block_size, data_size - offset),
+                       0))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @name read_blocks
+    /// @param addr - address that shall be read
+    /// @param data_size - size of data that shall be read
+    /// @param pData - variable that will be filled with read value
+    /// @param block_size - largest size of a single read
+    /// @return true on success
+    /// @brief reads consecutive blocks; devices that can pipeline requests should override this
+    virtual bool read_blocks(uint32_t addr, size_t data_size, void* pData, size_t block_size)
+    {
+        for (size_t offset = 0; offset < data_size; offset += block_size)
+        {
+            unsigned int step = (unsigned int)std::min(block_size, data_size - offset);
+            unsigned int read_count = 0;
+            if (!read((uint32_t)(addr + offset), step, (uint8_t*)pData + offset, read_count)
+                || read_count != step)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
 }; /* class IFirmwareWriter */
 
 
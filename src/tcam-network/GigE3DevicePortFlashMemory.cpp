@@ -180,8 +180,9 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::WriteDeviceMemory(
     const std::vector<uint8_t>& data,
     tReportProgressFunc progressFunc)
 {
-    //const size_t StepSize = 1024 * 16;
-    const size_t StepSize = 512;
+    // progress is reported per step, each step is written as multiple requests in flight
+    const size_t StepSize = 1024 * 16;
+    const size_t BlockSize = 512;
     size_t totalBytes = data.size();
     size_t bytesRemaining = totalBytes;
     size_t bytesWritten = 0;
@@ -190,10 +191,10 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::WriteDeviceMemory(
     {
         size_t stepBytes = std::min(bytesRemaining, StepSize);
 
-        if (!dev.write((uint32_t)(address + bytesWritten),
-                       (uint32_t*)(data.data() + bytesWritten),
-                       (size_t)stepBytes,
-                       0))
+        if (!dev.write_blocks((uint32_t)(address + bytesWritten),
+                              (uint32_t*)(data.data() + bytesWritten),
+                              stepBytes,
+                              BlockSize))
         {
             return Status::WriteError;
         }
@@ -214,8 +215,8 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::ReadDeviceMemory(
     std::vector<uint8_t>& buffer,
     tReportProgressFunc progressFunc)
 {
-    //const size_t StepSize = 1024 * 16;
-    const size_t StepSize = 512;
+    const size_t StepSize = 1024 * 16;
+    const size_t BlockSize = 512;
     size_t totalBytes = buffer.size();
     size_t bytesRemaining = totalBytes;
     size_t bytesRead = 0;
@@ -224,16 +225,8 @@ FirmwareUpdate::Status GigE3::DevicePortFlashMemory::ReadDeviceMemory(
     {
         size_t stepBytes = std::min(bytesRemaining, StepSize);
 
-        unsigned int stepBytesRead = 0;
-        if (!dev.read((uint32_t)(address + bytesRead),
-                      (uint32_t)stepBytes,
-                      buffer.data() + bytesRead,
-                      stepBytesRead))
-        {
-            return Status::WriteError;
-        }
-
-        if (stepBytesRead != stepBytes)
+        if (!dev.read_blocks(
+                (uint32_t)(address + bytesRead), stepBytes, buffer.data() + bytesRead, BlockSize))
         {
             return Status::WriteError;
         }
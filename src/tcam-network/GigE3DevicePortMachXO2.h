@@ -17,7 +17,10 @@
 #pragma once
 
 #include "GigE3DevicePort.h"
+#include "JedecFile.h"
 
+#include <map>
+#include <memory>
 #include <pugi.h>
 
 namespace FirmwareUpdate
@@ -30,6 +33,9 @@ class DevicePortMachXO2 : public IDevicePort
 {
     std::string name_;
 
+    // filled by CheckItems, so the jedec files of a package are parsed only once
+    std::map<const std::vector<uint8_t>*, std::shared_ptr<const MachXO2::JedecFile>> parsed_;
+
 public:
     virtual std::string name() override
     {
@@ -23,10 +23,27 @@
 #include "GigE3UploadItem.h"
 
 #include <memory>
+#include <mutex>
 #include <pugi.h>
+#include <sys/stat.h>
 
 using namespace FirmwareUpdate;
 
+namespace
+{
+
+struct shared_package
+{
+    struct timespec mtime;
+    off_t size;
+    std::shared_ptr<const GigE3::Package> package;
+};
+
+std::mutex shared_packages_mtx;
+std::map<std::string, shared_package> shared_packages;
+
+} // namespace
+
 
 std::vector<std::string> GigE3::Package::FindModelNames(const std::string& packageFileName)
 {
@@ -54,6 +71,41 @@ std::vector<std::string> GigE3::Package::FindModelNames(const std::string& packa
 }
 
 
+std::shared_ptr<const GigE3::Package> GigE3::Package::LoadShared(
+    const std::string& packageFileName,
+    Status& status)
+{
+    struct stat st = {};
+    if (stat(packageFileName.c_str(), &st) != 0)
+    {
+        status = Status::InvalidFile;
+        return nullptr;
+    }
+
+    // held while loading, parallel callers wait for the one load instead of repeating it
+    std::scoped_lock lck { shared_packages_mtx };
+
+    auto iter = shared_packages.find(packageFileName);
+    if (iter != shared_packages.end() && iter->second.size == st.st_size
+        && iter->second.mtime.tv_sec == st.st_mtim.tv_sec
+        && iter->second.mtime.tv_nsec == st.st_mtim.tv_nsec)
+    {
+        status = Status::Success;
+        return iter->second.package;
+    }
+
+    auto package = std::make_shared<Package>();
+    status = package->Load(packageFileName);
+    if (failed(status))
+    {
+        return nullptr;
+    }
+
+    shared_packages[packageFileName] = { st.st_mtim, st.st_size, package };
+    return package;
+}
+
+
 GigE3::IDevicePort* GigE3::Package::find_port(const std::string& port_name)
 {
     for (auto&& port : ports_)
@@ -78,6 +130,18 @@ std::vector<GigE3::UploadGroup>* GigE3::Package::find_upload_groups(const std::s
 }
 
 
+const std::vector<GigE3::UploadGroup>* GigE3::Package::find_upload_groups(
+    const std::string& model_name) const
+{
+    auto it = device_types_.find(model_name);
+    if (it == device_types_.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+
 FirmwareUpdate::Status GigE3::Package::Load(const std::string& packageFileName)
 {
     packageFileName_ = packageFileName;
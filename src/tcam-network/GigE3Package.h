@@ -40,11 +40,21 @@ class Package
 public:
     static std::vector<std::string> FindModelNames(const std::string& packageFileName);
 
+    /**
+     * Loads the package once and shares it between all uploads of the process.
+     * The package is loaded again when the file changed.
+     * Shared packages are only read, so parallel uploads can use the same one.
+     * @return nullptr when the package could not be loaded, status contains the reason
+     */
+    static std::shared_ptr<const Package> LoadShared(const std::string& packageFileName,
+                                                     Status& status);
+
 public:
     Status Load(const std::string& packageFileName);
 
     IDevicePort* find_port(const std::string& port_name);
     std::vector<UploadGroup>* find_upload_groups(const std::string& model_name);
+    const std::vector<UploadGroup>* find_upload_groups(const std::string& model_name) const;
 
 private:
     std::string packageFileName_;
@@ -16,6 +16,10 @@
 
 #include "FirmwareUpgrade.h"
 
+#include <mutex>
+#include <numeric>
+#include <vector>
+
 namespace FirmwareUpdate
 {
 
@@ -63,6 +67,45 @@ struct mapItemProgress
     }
 }; /* struct mapItemProgress */
 
+
+/// Combines the progress of uploads to multiple devices that run concurrently.
+/// The functions returned by device() may be called from different threads,
+/// progressFunc is called by one of them at a time.
+class aggregateProgress
+{
+public:
+    aggregateProgress(tReportProgressFunc progressFunc, int numDevices)
+        : progressFunc_ { progressFunc }, progress_(numDevices, 0)
+    {
+    }
+
+    aggregateProgress(const aggregateProgress&) = delete;
+    aggregateProgress& operator=(const aggregateProgress&) = delete;
+
+    tReportProgressFunc device(int index)
+    {
+        return [this, index](int pct, const std::string& msg) {
+            update(index, pct, msg);
+        };
+    }
+
+private:
+    void update(int index, int pct, const std::string& msg)
+    {
+        std::lock_guard<std::mutex> lck(mutex_);
+
+        progress_.at(index) = pct;
+
+        int sum = std::accumulate(progress_.begin(), progress_.end(), 0);
+
+        progressFunc_(sum / (int)progress_.size(), msg);
+    }
+
+    std::mutex mutex_;
+    tReportProgressFunc progressFunc_;
+    std::vector<int> progress_;
+}; /* class aggregateProgress */
+
 } /* namespace GigE3 */
 
 } /* namespace FirmwareUpdate */
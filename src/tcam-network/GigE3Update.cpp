@@ -54,14 +54,15 @@ Status GigE3::upgradeFirmware(IFirmwareWriter& dev,
                               const std::string& originalModelName __attribute__((unused)),
                               tReportProgressFunc progressFunc)
 {
-    Package package;
-    auto status = package.Load(fileName);
-    if (failed(status))
+    // parsed once for all cameras that are updated with this file
+    Status status;
+    auto package = Package::LoadShared(fileName, status);
+    if (!package)
     {
         return status;
     }
 
-    auto modelUploadGroups = package.find_upload_groups(modelName);
+    auto modelUploadGroups = package->find_upload_groups(modelName);
     if (!modelUploadGroups)
     {
         return Status::NoMatchFoundInPackage;
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InterfaceMonitor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+// a link that comes up usually reports several messages in quick succession
+constexpr int settle_time_ms = 200;
+
+
+std::string interface_name(int index, const struct rtattr* attr, int attr_len, int name_type)
+{
+    for (; RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len))
+    {
+        if (attr->rta_type == name_type)
+        {
+            return std::string((const char*)RTA_DATA(attr));
+        }
+    }
+
+    // the name attribute is optional for addresses
+    char name[IF_NAMESIZE] = {};
+    if (if_indextoname(index, name))
+    {
+        return name;
+    }
+    return std::string();
+}
+
+} // namespace
+
+
+namespace tis
+{
+
+InterfaceMonitor::InterfaceMonitor()
+{
+    netlink_fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (netlink_fd_ < 0)
+    {
+        throw std::runtime_error("Unable to open netlink socket");
+    }
+
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR;
+
+    if (bind(netlink_fd_, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(netlink_fd_);
+        throw std::runtime_error("Unable to bind netlink socket");
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0)
+    {
+        close(netlink_fd_);
+        throw std::runtime_error("Unable to create eventfd");
+    }
+}
+
+
+InterfaceMonitor::~InterfaceMonitor()
+{
+    close(netlink_fd_);
+    close(wakeup_fd_);
+}
+
+
+void InterfaceMonitor::interrupt()
+{
+    uint64_t one = 1;
+    if (write(wakeup_fd_, &one, sizeof(one)) < 0)
+    {
+        // counter is already set, the waiter wakes up anyway
+    }
+}
+
+
+bool InterfaceMonitor::read_events(std::set<std::string>& changed)
+{
+    alignas(struct nlmsghdr) char buffer[8192];
+    bool received = false;
+
+    while (true)
+    {
+        ssize_t len = recv(netlink_fd_, buffer, sizeof(buffer), 0);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == ENOBUFS)
+            {
+                // events were lost, the caller rescans everything
+                changed.insert(std::string());
+                received = true;
+                continue;
+            }
+            return received;
+        }
+
+        auto hdr = (struct nlmsghdr*)buffer;
+        for (int remaining = (int)len; NLMSG_OK(hdr, remaining); hdr = NLMSG_NEXT(hdr, remaining))
+        {
+            if (hdr->nlmsg_type == RTM_NEWLINK || hdr->nlmsg_type == RTM_DELLINK)
+            {
+                auto info = (struct ifinfomsg*)NLMSG_DATA(hdr);
+                changed.insert(
+                    interface_name(info->ifi_index, IFLA_RTA(info), IFLA_PAYLOAD(hdr), IFLA_IFNAME));
+                received = true;
+            }
+            else if (hdr->nlmsg_type == RTM_NEWADDR || hdr->nlmsg_type == RTM_DELADDR)
+            {
+                auto info = (struct ifaddrmsg*)NLMSG_DATA(hdr);
+                changed.insert(
+                    interface_name(info->ifa_index, IFA_RTA(info), IFA_PAYLOAD(hdr), IFA_LABEL));
+                received = true;
+            }
+        }
+    }
+}
+
+
+bool InterfaceMonitor::wait_for_changes(int timeout_ms, std::set<std::string>& changed)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    bool received = false;
+
+    while (true)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= end)
+        {
+            return received;
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(end - now).count();
+
+        struct pollfd fds[2] = {
+            { netlink_fd_, POLLIN, 0 },
+            { wakeup_fd_, POLLIN, 0 },
+        };
+
+        if (poll(fds, 2, (int)remaining + 1) < 0 && errno != EINTR)
+        {
+            return received;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            uint64_t counter;
+            if (read(wakeup_fd_, &counter, sizeof(counter)) < 0)
+            {
+                // already reset
+            }
+            return received;
+        }
+
+        if ((fds[0].revents & POLLIN) && read_events(changed) && !received)
+        {
+            // collect the burst that usually follows the first message
+            received = true;
+            end = std::min(end, now + std::chrono::milliseconds(settle_time_ms));
+        }
+    }
+}
+
+} /* namespace tis */
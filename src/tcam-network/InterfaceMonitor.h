@@ -0,0 +1,66 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _INTERFACE_MONITOR_H_
+#define _INTERFACE_MONITOR_H_
+
+#include <set>
+#include <string>
+
+#include "../compiler_defines.h"
+
+VISIBILITY_DEFAULT
+
+namespace tis
+{
+
+/// Reports link and IPv4 address changes of the network interfaces via rtnetlink,
+/// so that discoveries only have to run when something changed.
+class InterfaceMonitor
+{
+public:
+    /// @brief throws std::runtime_error when the netlink socket can not be opened
+    InterfaceMonitor();
+    ~InterfaceMonitor();
+
+    InterfaceMonitor(const InterfaceMonitor&) = delete;
+    InterfaceMonitor& operator=(const InterfaceMonitor&) = delete;
+
+    /// @name wait_for_changes
+    /// @param timeout_ms - maximum time to wait
+    /// @param changed - receives the names of the interfaces that changed
+    /// @return true when changes were received before the timeout or an interrupt
+    /// @brief events that arrive within a short settle time are collected into one call;
+    ///        an empty name means events were lost and all interfaces may have changed
+    bool wait_for_changes(int timeout_ms, std::set<std::string>& changed);
+
+    /// @name interrupt
+    /// @brief lets a waiting or the next wait_for_changes return immediately
+    void interrupt();
+
+private:
+    // reads all pending messages, returns false when none could be read
+    bool read_events(std::set<std::string>& changed);
+
+    int netlink_fd_ = -1;
+    int wakeup_fd_ = -1;
+}; /* class InterfaceMonitor */
+
+} /* namespace tis */
+
+VISIBILITY_POP
+
+#endif /* _INTERFACE_MONITOR_H_ */
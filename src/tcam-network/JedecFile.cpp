@@ -17,6 +17,7 @@
 #include "JedecFile.h"
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 
 using namespace MachXO2;
@@ -41,22 +42,16 @@ enum class RowType
 };
 
 
-template<typename TCharIterator>
-std::string getline(TCharIterator& begin, TCharIterator end, std::string delim)
+// the file uses \r\n, begin is moved behind the delimiter
+// line is reused to avoid an allocation per line
+void getline(const uint8_t*& begin, const uint8_t* end, std::string& line)
 {
-    std::string line;
+    static const char delim[] = "\r\n";
 
-    for (; begin != end && !std::equal(delim.begin(), delim.end(), begin); ++begin)
-    {
-        line += *begin;
-    }
+    auto line_end = std::search(begin, end, delim, delim + 2);
+    line.assign(begin, line_end);
 
-    if (begin != end)
-    {
-        begin += delim.length();
-    }
-
-    return line;
+    begin = (line_end == end) ? end : line_end + 2;
 }
 
 
@@ -72,39 +67,47 @@ bool string_contains(const std::string& str, const std::string& sub)
 }
 
 
-void ParseFuseLine(const std::string& line, std::vector<uint8_t>& dest)
+constexpr size_t fuse_line_length = 128;
+
+
+// packs 8 '0'/'1' characters into a byte in one step
+// every character contributes its lowest bit, the multiplication moves
+// the bit of character i to bit 7 - i (msb_first) or bit i of the top byte without carries
+uint8_t PackBits(const char* chars, bool msb_first)
 {
-    int n = 0;
+    uint64_t word;
+    memcpy(&word, chars, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    word &= 0x0101010101010101ull;
+
+    const uint64_t magic = msb_first ? 0x8040201008040201ull : 0x0102040810204080ull;
+    return (uint8_t)((word * magic) >> 56);
+}
 
-    for (int i = 0; i < 16; i++)
-    {
-        uint8_t val = 0;
-        for (int j = 0; j < 8; j++)
-        {
-            val = (uint8_t)((val << 1) | (line[n] - '0'));
-            ++n;
-        }
 
-        dest.push_back(val);
+void ParseFuseLine(const std::string& line, std::vector<uint8_t>& dest)
+{
+    for (size_t n = 0; n < fuse_line_length; n += 8)
+    {
+        dest.push_back(PackBits(line.data() + n, true));
     }
 }
 
 
-std::vector<uint8_t> ParseFeatureRow(const std::string& line, int len)
+// the bits of the feature row are stored with the lsb of the last byte first
+std::vector<uint8_t> ParseFeatureRow(const std::string& line, size_t len)
 {
     std::vector<uint8_t> result(len);
-    int n = 8 * len - 1;
-
-    for (int i = 0; i < len; i++)
+    if (line.length() < 8 * len)
     {
-        uint8_t val = 0;
-        for (int j = 0; j < 8; j++)
-        {
-            val = (uint8_t)((val << 1) | (line[n] - '0'));
-            --n;
-        }
+        return result;
+    }
 
-        result[i] = val;
+    for (size_t i = 0; i < len; i++)
+    {
+        result[i] = PackBits(line.data() + 8 * (len - 1 - i), false);
     }
 
     return result;
@@ -157,10 +160,14 @@ JedecFile JedecFile::Parse(const std::vector<uint8_t>& data)
     std::vector<uint8_t> featureBits;
     uint32_t userCode = 0;
 
-    auto pos = data.begin();
-    while (pos != data.end())
+    std::string line;
+    bool fuses_valid = true;
+
+    const uint8_t* pos = data.data();
+    const uint8_t* end = data.data() + data.size();
+    while (pos != end)
     {
-        auto line = getline(pos, data.end(), "\r\n");
+        getline(pos, end, line);
 
         if (state == RowType::FEATURE_ROW)
             state = RowType::FEATURE_BITS;
@@ -190,6 +197,11 @@ JedecFile JedecFile::Parse(const std::vector<uint8_t>& data)
         switch (state)
         {
             case RowType::FUSE_DATA:
+                if (line.length() < fuse_line_length)
+                {
+                    fuses_valid = false;
+                    break;
+                }
                 ++pageCount;
                 if (pageCount <= devInfo.numCfgPages())
                 {
@@ -221,6 +233,7 @@ JedecFile JedecFile::Parse(const std::vector<uint8_t>& data)
         if (state == RowType::COMMENT && string_contains(line, "DEVICE NAME:"))
         {
             devInfo = DeviceInfo::Find(line);
+            configurationData.reserve(devInfo.numCfgPages() * fuse_line_length / 8);
         }
 
         if (state == RowType::DONE)
@@ -229,5 +242,15 @@ JedecFile JedecFile::Parse(const std::vector<uint8_t>& data)
         }
     }
 
-    return { devInfo.type(), userCode, configurationData, featureRow, featureBits };
+    if (!fuses_valid)
+    {
+        // a truncated fuse row would shift all following pages
+        return { DeviceType::MachXO2_Unknown, userCode, {}, {}, {} };
+    }
+
+    return { devInfo.type(),
+             userCode,
+             std::move(configurationData),
+             std::move(featureRow),
+             std::move(featureBits) };
 }
@@ -19,6 +19,7 @@
 #include "MachXO2.h"
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace MachXO2
@@ -60,8 +61,8 @@ private:
               std::vector<uint8_t> configurationData,
               std::vector<uint8_t> featureRow,
               std::vector<uint8_t> featureBits)
-        : _deviceType(devType), _userCode(uc), _configurationData(configurationData),
-          _featureRow(featureRow), _featureBits(featureBits)
+        : _deviceType(devType), _userCode(uc), _configurationData(std::move(configurationData)),
+          _featureRow(std::move(featureRow)), _featureBits(std::move(featureBits))
     {
     }
 
@@ -17,6 +17,7 @@
 #include "Socket.h"
 
 #include <exception>
+#include <poll.h>
 #include <unistd.h>
 
 namespace tis
@@ -147,4 +148,41 @@ void Socket::sendAndReceive(const std::string& destination_address,
     }
 }
 
+
+void Socket::send(const std::string& destination_address,
+                  const void* data,
+                  size_t size,
+                  const bool broadcast)
+{
+    sockaddr_in destAddr = fillAddr(destination_address, STANDARD_GVCP_PORT);
+    setBroadcast(broadcast);
+
+    ssize_t send =
+        sendto(fd, (const uint8_t*)data, size, 0, (struct sockaddr*)&destAddr, sizeof(destAddr));
+    if (send <= 0)
+    {
+        throw SocketSendToException();
+    }
+}
+
+
+ssize_t Socket::receive(void* buffer, size_t size, int timeout)
+{
+    pollfd pfd = {};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+
+    if (poll(&pfd, 1, timeout) <= 0)
+    {
+        return 0;
+    }
+
+    ssize_t ret = recvfrom(fd, buffer, size, 0, nullptr, nullptr);
+    if (ret < 0)
+    {
+        return 0;
+    }
+    return ret;
+}
+
 } /* namespace tis */
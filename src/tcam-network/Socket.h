@@ -108,6 +108,38 @@ public:
                         std::function<int(void*)> callback,
                         const bool broadcast = false);
 
+    /// @name send
+    /// @param destination_address - address that shall receive data
+    /// @param data - information that shall be sent
+    /// @param size - size of data
+    /// @param broadcast - wether this shall be broadcasted or not
+    /// @brief sends without waiting for a response; throws SocketSendToException
+    void send(const std::string& destination_address,
+              const void* data,
+              size_t size,
+              const bool broadcast = false);
+
+    /// @name receive
+    /// @param buffer - container for the received packet
+    /// @param size - size of buffer
+    /// @param timeout - maximum waiting time in milliseconds
+    /// @return number of received bytes; 0 on timeout
+    ssize_t receive(void* buffer, size_t size, int timeout);
+
+    /// @name getTimeout
+    /// @return response timeout in milliseconds
+    int getTimeout() const
+    {
+        return timeout_ms;
+    }
+
+    /// @name getFd
+    /// @return underlying file descriptor; ownership stays with the socket
+    int getFd() const
+    {
+        return fd;
+    }
+
 private:
     /// @name createSocket
     /// @return new socket fd
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+/**
+ * Hands the latest value from one writer to one reader, neither of them ever waits.
+ *
+ * The writer fills its slot and swaps it with the shared middle slot,
+ * the reader swaps its slot with the middle one when a newer value was published.
+ * Values that are replaced before the reader looked at them are lost.
+ * Several writers or several readers have to be serialized by the caller.
+ */
+template<typename T> class triple_buffer
+{
+public:
+    // writer side, the slot has unspecified contents and has to be filled completely
+    T& back() noexcept
+    {
+        return slots_[back_];
+    }
+
+    void publish() noexcept
+    {
+        back_ = middle_.exchange(back_ | dirty_bit, std::memory_order_acq_rel) & index_mask;
+    }
+
+    // reader side, returns true when front() changed
+    bool update() noexcept
+    {
+        if (!(middle_.load(std::memory_order_relaxed) & dirty_bit))
+        {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    const T& front() const noexcept
+    {
+        return slots_[front_];
+    }
+
+private:
+    static constexpr uint8_t index_mask = 0x3;
+    static constexpr uint8_t dirty_bit = 0x4;
+
+    std::array<T, 3> slots_ = {};
+
+    uint8_t back_ = 0;
+    std::atomic<uint8_t> middle_ = 1;
+    uint8_t front_ = 2;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/*
+ * Static tracepoints (USDT) on the frame path.
+ *
+ * The probes are part of every build that found sys/sdt.h.
+ * Without an attached tracer a probe is a single nop,
+ * bpftrace / perf / systemtap patch it at runtime.
+ *
+ * Every probe of the provider 'tcam' carries
+ *   arg0 - frame_count of the stream statistics, 0 when not yet known
+ *   arg1 - buffer id, the address of the tcam::ImageBuffer
+ *
+ * See doc/pages/troubleshooting.rst for the list of probes.
+ */
+
+#if defined(TCAM_HAVE_USDT)
+
+#include <sys/sdt.h>
+
+#define TCAM_USDT_PROBE(name, frame_count, buffer_id)                                              \
+    DTRACE_PROBE2(tcam, name, (uint64_t)(frame_count), (uintptr_t)(buffer_id))
+
+#else
+
+#define TCAM_USDT_PROBE(name, frame_count, buffer_id)                                              \
+    do                                                                                             \
+    {                                                                                              \
+    } while (0)
+
+#endif
@@ -19,16 +19,22 @@
 #include "logging.h"
 
 //#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdlib> // realpath
 #include <cstring>
 //#include <dutils_img/image_transform_base.h>
 #include <errno.h>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <pthread.h>
 #include <signal.h> // kill
 #include <sys/ioctl.h>
+#include <sys/resource.h> // setpriority
+#include <sys/syscall.h> // SYS_gettid
+#include <unistd.h>
 
 using namespace tcam;
 
@@ -290,3 +296,334 @@ int set_thread_name(const std::string& name, pthread_t thrd /*= pthread_self()*/
     assert(name.size() <= 16);
     return set_thread_name(name.c_str(), thrd);
 }
+
+
+namespace
+{
+
+constexpr size_t thread_role_count = 4;
+
+struct thread_config_store
+{
+    std::mutex mtx;
+    std::array<std::optional<tcam::thread_config>, thread_role_count> configs;
+};
+
+auto parse_thread_role(const std::string& str) -> std::optional<tcam::thread_role>
+{
+    if (str == "capture")
+    {
+        return tcam::thread_role::capture;
+    }
+    if (str == "delivery")
+    {
+        return tcam::thread_role::delivery;
+    }
+    if (str == "auto-pass")
+    {
+        return tcam::thread_role::auto_pass;
+    }
+    if (str == "indexer")
+    {
+        return tcam::thread_role::indexer;
+    }
+    return std::nullopt;
+}
+
+auto parse_cpu_list(const std::string& str) -> std::optional<std::vector<int>>
+{
+    std::vector<int> ret;
+    for (const auto& entry : tcam::split_string(str, ","))
+    {
+        auto range = tcam::split_string(entry, "-");
+        try
+        {
+            if (range.size() == 1)
+            {
+                ret.push_back(std::stoi(range.at(0)));
+                continue;
+            }
+            if (range.size() != 2)
+            {
+                return std::nullopt;
+            }
+            const int first = std::stoi(range.at(0));
+            const int last = std::stoi(range.at(1));
+            if (first > last)
+            {
+                return std::nullopt;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) { ret.push_back(cpu); }
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    for (int cpu : ret)
+    {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+        {
+            return std::nullopt;
+        }
+    }
+    return ret;
+}
+
+// policy[:value][@cpus]
+auto parse_thread_config(const std::string& str) -> std::optional<tcam::thread_config>
+{
+    tcam::thread_config ret;
+
+    std::string sched = str;
+    if (auto pos = str.find('@'); pos != std::string::npos)
+    {
+        auto cpus = parse_cpu_list(str.substr(pos + 1));
+        if (!cpus)
+        {
+            return std::nullopt;
+        }
+        ret.cpus = *cpus;
+        sched = str.substr(0, pos);
+    }
+
+    if (sched.empty())
+    {
+        return ret;
+    }
+
+    auto parts = tcam::split_string(sched, ":");
+    if (parts.size() > 2)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<int> value;
+    if (parts.size() == 2)
+    {
+        try
+        {
+            value = std::stoi(parts.at(1));
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    const auto& policy = parts.at(0);
+    if (policy == "fifo" || policy == "rr")
+    {
+        ret.policy = policy == "fifo" ? SCHED_FIFO : SCHED_RR;
+        ret.priority = value.value_or(1);
+        if (ret.priority < sched_get_priority_min(*ret.policy)
+            || ret.priority > sched_get_priority_max(*ret.policy))
+        {
+            return std::nullopt;
+        }
+    }
+    else if (policy == "other")
+    {
+        ret.policy = SCHED_OTHER;
+        ret.nice = value;
+        if (ret.nice && (*ret.nice < -20 || *ret.nice > 19))
+        {
+            return std::nullopt;
+        }
+    }
+    else
+    {
+        return std::nullopt;
+    }
+    return ret;
+}
+
+bool parse_thread_config_list(
+    const std::string& str,
+    std::array<std::optional<tcam::thread_config>, thread_role_count>& configs)
+{
+    for (const auto& entry : tcam::split_string(str, ";"))
+    {
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        auto pos = entry.find('=');
+        if (pos == std::string::npos)
+        {
+            SPDLOG_ERROR("Unable to interpret thread config '{}'", entry);
+            return false;
+        }
+
+        auto role = parse_thread_role(entry.substr(0, pos));
+        if (!role)
+        {
+            SPDLOG_ERROR("Unknown thread role in thread config '{}'", entry);
+            return false;
+        }
+
+        auto config = parse_thread_config(entry.substr(pos + 1));
+        if (!config)
+        {
+            SPDLOG_ERROR("Unable to interpret thread config '{}'", entry);
+            return false;
+        }
+        configs.at(static_cast<size_t>(*role)) = *config;
+    }
+    return true;
+}
+
+thread_config_store& get_thread_config_store()
+{
+    static thread_config_store* store = []
+    {
+        auto ret = new thread_config_store;
+
+        auto env = tcam::get_environment_variable("TCAM_THREAD_CONFIG", "");
+        if (!env.empty() && !parse_thread_config_list(env, ret->configs))
+        {
+            SPDLOG_ERROR("Ignoring TCAM_THREAD_CONFIG");
+        }
+        return ret;
+    }();
+    return *store;
+}
+
+} // namespace
+
+
+bool tcam::set_thread_config(const std::string& str)
+{
+    auto& store = get_thread_config_store();
+
+    std::scoped_lock lck { store.mtx };
+
+    auto configs = store.configs;
+    if (!parse_thread_config_list(str, configs))
+    {
+        return false;
+    }
+    store.configs = configs;
+    return true;
+}
+
+
+std::optional<tcam::thread_config> tcam::get_thread_config(thread_role role)
+{
+    auto& store = get_thread_config_store();
+
+    std::scoped_lock lck { store.mtx };
+    return store.configs.at(static_cast<size_t>(role));
+}
+
+
+bool tcam::apply_thread_config(thread_role role, int numa_node)
+{
+    auto config = get_thread_config(role);
+    if (!config && numa_node < 0)
+    {
+        return false;
+    }
+
+    bool ret = true;
+
+    std::vector<int> cpus;
+    if (config && !config->cpus.empty())
+    {
+        cpus = config->cpus;
+    }
+    else if (numa_node >= 0)
+    {
+        cpus = get_numa_node_cpus(numa_node);
+    }
+
+    if (!cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) { CPU_SET(cpu, &set); }
+
+        if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0)
+        {
+            SPDLOG_WARN("Unable to set thread affinity: {}", strerror(err));
+            ret = false;
+        }
+    }
+
+    if (!config)
+    {
+        return ret;
+    }
+
+    if (config->policy)
+    {
+        sched_param param = {};
+        param.sched_priority = config->priority;
+        if (int err = pthread_setschedparam(pthread_self(), *config->policy, &param); err != 0)
+        {
+            // SCHED_FIFO/SCHED_RR need CAP_SYS_NICE or an RLIMIT_RTPRIO
+            SPDLOG_WARN("Unable to set thread scheduling policy: {}", strerror(err));
+            ret = false;
+        }
+    }
+
+    if (config->nice)
+    {
+        // the nice value is per thread on linux
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), *config->nice) != 0)
+        {
+            SPDLOG_WARN("Unable to set thread nice value: {}", strerror(errno));
+            ret = false;
+        }
+    }
+    return ret;
+}
+
+
+int tcam::find_numa_node(const std::string& sysfs_path)
+{
+    char* resolved = realpath(sysfs_path.c_str(), nullptr);
+    if (!resolved)
+    {
+        return -1;
+    }
+    std::string path = resolved;
+    free(resolved);
+
+    // /sys/devices/pci0000:00/0000:00:14.0/usb1/1-2/1-2:1.0 up to the pci device
+    while (path.size() > strlen("/sys/devices"))
+    {
+        std::ifstream f(path + "/numa_node");
+        int node = -1;
+        if (f >> node)
+        {
+            return node;
+        }
+        auto pos = path.rfind('/');
+        if (pos == std::string::npos)
+        {
+            break;
+        }
+        path.resize(pos);
+    }
+    return -1;
+}
+
+
+std::vector<int> tcam::get_numa_node_cpus(int node)
+{
+    if (node < 0)
+    {
+        return {};
+    }
+
+    std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(f, list) || list.empty())
+    {
+        return {};
+    }
+    return parse_cpu_list(list).value_or(std::vector<int> {});
+}
@@ -21,9 +21,11 @@
 #include "compiler_defines.h"
 
 #include <memory>
+#include <optional>
+#include <pthread.h>
+#include <sched.h>
 #include <string>
 #include <vector>
-#include <optional>
 
 
 VISIBILITY_INTERNAL
@@ -116,6 +118,65 @@ std::optional<int> get_environment_variable_int(const std::string& name);
 int set_thread_name(const char* name, pthread_t thrd = pthread_self());
 int set_thread_name(const std::string& name, pthread_t thrd = pthread_self());
 
+/**
+ * Roles of the threads libtcam starts, every role can get its own scheduling.
+ */
+enum class thread_role
+{
+    capture, // aravis stream thread, v4l2 event loop, libusb event handler, virtcam stream/generate
+    delivery, // libusb deliver thread, shared delivery workers
+    auto_pass, // software auto functions worker
+    indexer, // device list updates
+};
+
+struct thread_config
+{
+    std::optional<int> policy; // SCHED_OTHER, SCHED_FIFO or SCHED_RR, empty keeps the inherited policy
+    int priority = 0; // 1..99 for SCHED_FIFO/SCHED_RR
+    std::optional<int> nice; // only for SCHED_OTHER
+    std::vector<int> cpus; // affinity, empty keeps the inherited mask
+};
+
+/**
+ * Parse a thread configuration and use it for threads started afterwards.
+ * Format: role=policy[:value][@cpus] separated by ';'
+ * role: capture, delivery, auto-pass, indexer
+ * policy: fifo or rr with a priority, other with a nice value
+ * cpus: comma separated list of cpus or ranges, e.g. 2-3,6
+ * Every role given replaces its previous configuration.
+ *
+ * The environment variable TCAM_THREAD_CONFIG is parsed on first use.
+ *
+ * @return false when str could not be parsed, nothing is changed in that case
+ */
+bool set_thread_config(const std::string& str);
+
+std::optional<thread_config> get_thread_config(thread_role role);
+
+/**
+ * Apply the configuration of role to the calling thread.
+ * Call this together with set_thread_name at the start of the thread.
+ *
+ * Threads that work for one device pass its numa node in the locality placement,
+ * they are pinned to the cpus of that node unless the configuration has cpus of its own.
+ *
+ * @return false when no configuration exists for role and no node is given,
+ *         or applying it failed
+ */
+bool apply_thread_config(thread_role role, int numa_node = -1);
+
+/**
+ * NUMA node of the device behind sysfs_path, e.g. /sys/class/net/eth0/device.
+ * Walks up to the first parent with a numa_node attribute,
+ * usb devices have none, their host controller has.
+ *
+ * @return -1 when the node is unknown, e.g. on machines with a single node
+ */
+int find_numa_node(const std::string& sysfs_path);
+
+// empty when node does not exist
+std::vector<int> get_numa_node_cpus(int node);
+
 } /* namespace tcam */
 
 VISIBILITY_POP
@@ -21,8 +21,10 @@
 #include "../logging.h"
 #include "../utils.h"
 
+#include <fcntl.h> /* O_RDWR */
 #include <linux/videodev2.h>
 #include <sys/mman.h> /* mmap PROT_READ*/
+#include <unistd.h> /* close */
 
 using namespace tcam;
 
@@ -50,6 +52,39 @@ bool reqbufs(int fd_,
  //   return outcome::success();
 }
 
+
+// test if the driver is able to export its mmap buffers
+bool supports_expbuf(int fd_)
+{
+    struct v4l2_requestbuffers req = {};
+
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.count = 1;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (tcam::tcam_xioctl(fd_, VIDIOC_REQBUFS, &req) == -1 || req.count < 1)
+    {
+        return false;
+    }
+
+    struct v4l2_exportbuffer expbuf = {};
+    expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    expbuf.index = 0;
+    expbuf.flags = O_RDWR | O_CLOEXEC;
+
+    bool ret = tcam::tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) != -1;
+
+    if (ret)
+    {
+        close(expbuf.fd);
+    }
+
+    req.count = 0;
+    tcam::tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
+
+    return ret;
+}
+
 } // namespace
 
 
@@ -78,6 +113,16 @@ void tcam::V4L2Allocator::query_supported_memory_types()
         memory_types_.push_back(TCAM_MEMORY_TYPE_MMAP);
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
+
+        // dmabuf export works on top of mmap buffers
+        if (supports_expbuf(fd_))
+        {
+            memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
+        }
+        else
+        {
+            SPDLOG_INFO("Device does not support dmabuf export");
+        }
     }
 
     req.memory = V4L2_MEMORY_DMABUF;
@@ -85,9 +130,7 @@ void tcam::V4L2Allocator::query_supported_memory_types()
 
     if (reqbufs(fd_, req, "DMA"))
     {
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
-        // TODO: implement dma support
+        memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
     }
@@ -194,64 +237,108 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
 }
 
 
-std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t /*length*/,
-                                                                 int fd,
+std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t length,
                                                                  size_t buffer_count)
 {
-    struct v4l2_requestbuffers rqbufs = {};
-    rqbufs.count = buffer_count;
-    rqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    rqbufs.memory = V4L2_MEMORY_DMABUF;
-
-    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &rqbufs) == -1)
+    if (buffer_count < 2)
     {
-        if (EINVAL == errno)
-        {
-            fprintf(stderr,
-                    "does not support "
-                    "dma\n");
-            exit(EXIT_FAILURE);
-        }
-        else
-        {
-            SPDLOG_ERROR("VIDIOC_REQBUFS");
-        }
+        SPDLOG_ERROR("Insufficient buffer memory for dma");
+        return {};
     }
 
-    struct v4l2_exportbuffer expbuf;
+    // exportable buffers are regular mmap buffers
+    // that the driver allocated for us
+    struct v4l2_requestbuffers req = {};
+
+    req.count = buffer_count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
 
-    memset(&expbuf, 0, sizeof(expbuf));
-    expbuf.type = rqbufs.type;
-    expbuf.index = 0;// index;
-    if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &req) == -1)
     {
-        perror("VIDIOC_EXPBUF");
-        //return -1;
+        SPDLOG_ERROR("VIDIOC_REQBUFS {}", strerror(errno));
+        return {};
     }
 
-    //int dmafd = expbuf.fd;
+    if (req.count != buffer_count)
+    {
+        SPDLOG_ERROR("Can only allocate {} dma buffer. Aborting.", req.count);
+        return {};
+    }
 
-    // this is queueing
+    std::vector<std::shared_ptr<Memory>> buffers;
+    buffers.reserve(buffer_count);
 
     for (unsigned int i = 0; i < buffer_count; ++i)
     {
         struct v4l2_buffer buf = {};
 
-        buf.index = i;
         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        //buf.m.fd = buffer[i].dbuf_fd;
-        buf.m.fd = fd;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            SPDLOG_ERROR("VIDIOC_QUERYBUF for buffer {} failed: {}", i, strerror(errno));
+            return {};
+        }
 
-        if (tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        if (buf.length < length)
         {
-            // TODO: error handling
+            SPDLOG_ERROR("Driver buffer {} too small. Has {} Needs {}", i, buf.length, length);
+            return {};
         }
+
+        struct v4l2_exportbuffer expbuf = {};
+
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        expbuf.flags = O_RDWR | O_CLOEXEC;
+
+        if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+        {
+            SPDLOG_ERROR("VIDIOC_EXPBUF for buffer {} failed: {}", i, strerror(errno));
+            return {};
+        }
+
+        // keep a cpu mapping so that software conversions
+        // and non dma aware consumers can still access the image
+        auto ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, expbuf.fd, 0);
+
+        if (ptr == MAP_FAILED)
+        {
+            SPDLOG_ERROR("mmap of dmabuf {} failed: {}", i, strerror(errno));
+            close(expbuf.fd);
+            return {};
+        }
+
+        SPDLOG_TRACE("New dma buffer {} fd: {} {}", i, expbuf.fd, fmt::ptr(ptr));
+
+        buffers.push_back(std::make_shared<Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_DMA, length, ptr, expbuf.fd));
     }
 
+    return buffers;
+}
 
 
-    return {};
+void* V4L2Allocator::map_dma_import(size_t length, int fd)
+{
+    if (fd < 0)
+    {
+        SPDLOG_ERROR("Invalid file descriptor for dmabuf import.");
+        return nullptr;
+    }
+
+    auto ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (ptr == MAP_FAILED)
+    {
+        SPDLOG_ERROR("Unable to map imported dmabuf fd {}: {}", fd, strerror(errno));
+        return nullptr;
+    }
+
+    return ptr;
 }
 
 
@@ -285,22 +372,31 @@ void tcam::V4L2Allocator::free_mmap(void* ptr, size_t length)
 }
 
 
-void tcam::V4L2Allocator::free_dma(std::vector<std::shared_ptr<ImageBuffer>> /*buffer_collection*/)
+void tcam::V4L2Allocator::free_dma(void* ptr, size_t length, int fd)
 {
+    free_mmap(ptr, length);
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
 }
 
 
-void* tcam::V4L2Allocator::allocate(TCAM_MEMORY_TYPE /*type*/,
-                                    size_t /*length*/,
-                                    int // fd
-    )
+void* tcam::V4L2Allocator::allocate(TCAM_MEMORY_TYPE type, size_t length, int fd)
 {
+    // only imported memory can be created individually
+    // everything else has to be requested from the driver in one go
+    if (type == TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        return map_dma_import(length, fd);
+    }
 
     return nullptr;
 }
 
 
-void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int /*fd*/)
+void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int fd)
 {
     switch(type)
     {
@@ -316,12 +412,14 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            //free_dma(std::vector<std::shared_ptr<ImageBuffer>>)
+            free_dma(ptr, length, fd);
             break;
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("Explicitely not supported");
+            // the file descriptor belongs to the exporter
+            // only remove our cpu mapping
+            free_mmap(ptr, length);
             break;
         }
     }
@@ -329,7 +427,7 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
 
 
 std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
-    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int fd)
+    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int /*fd*/)
 {
 
     switch (type)
@@ -344,11 +442,11 @@ std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            return allocate_dma(length, buffer_count, fd);
+            return allocate_dma(length, buffer_count);
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("Nothing to allocate. External memory");
+            SPDLOG_ERROR("Nothing to allocate. External memory has to be imported");
             return {};
         }
     }
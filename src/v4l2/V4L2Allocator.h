@@ -37,14 +37,17 @@ private:
 
     std::vector<std::shared_ptr<Memory>> allocate_mmap(size_t length, size_t buffer_count);
 
-    std::vector<std::shared_ptr<Memory>> allocate_dma(
-        size_t length, int fd, size_t buffer_count);
+    // mmap buffers that are exported as dmabuf via VIDIOC_EXPBUF
+    std::vector<std::shared_ptr<Memory>> allocate_dma(size_t length, size_t buffer_count);
+
+    // map an imported dmabuf for cpu access
+    void* map_dma_import(size_t length, int fd);
 
     void free_userptr(void*);
 
     void free_mmap(void*, size_t);
 
-    void free_dma(std::vector<std::shared_ptr<ImageBuffer>> buffer_collection);
+    void free_dma(void*, size_t, int fd);
 
 public:
     explicit V4L2Allocator(int fd)
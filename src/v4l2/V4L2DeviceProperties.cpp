@@ -130,71 +130,84 @@ void tcam::V4l2Device::update_dependency_information()
     // manually reapply some of them
     // this causes things like ExposureAuto==On to lock ExposureTime
     //
-    for (auto& prop : m_properties)
-    {
-        auto prop_lock_ptr = std::dynamic_pointer_cast<tcam::property::PropertyLock>(prop);
-        if (!prop_lock_ptr)
-            continue;
+    tcam::property::link_dependent_properties(m_properties);
+}
 
-        auto dependent_names = prop_lock_ptr->get_dependent_names();
-        if (dependent_names.empty())
-            continue;
+bool tcam::V4l2Device::load_extension_unit(const std::string& extension_file,
+                                           std::vector<tcam::uvc::description>& mappings)
+{
+    auto message_cb = [](const std::string& message)
+    {
+        SPDLOG_DEBUG("{}", message.c_str());
+    };
 
-        std::vector<std::weak_ptr<tcam::property::PropertyLock>> dependencies_to_include;
-        for (const auto& name : dependent_names)
+    if (mappings.empty())
+    {
+        if (extension_file.empty())
         {
-            auto dependency = find_property(m_properties, name);
-            if (dependency)
-            {
-                auto ptr = std::dynamic_pointer_cast<tcam::property::PropertyLock>(dependency);
-                if (ptr)
-                {
-                    dependencies_to_include.push_back(ptr);
-                }
-            }
+            SPDLOG_WARN("Unable to determine uvc extension file");
+            return false;
         }
-        if (!dependencies_to_include.empty())
+
+        mappings = tcam::uvc::load_description_file(extension_file, message_cb);
+        if (mappings.empty())
         {
-            prop_lock_ptr->set_dependent_properties(std::move(dependencies_to_include));
+            SPDLOG_WARN("Unable to load uvc extension file");
+            return false;
         }
     }
+    tcam::uvc::apply_mappings(m_fd, mappings, message_cb);
+
+    return true;
 }
 
-bool tcam::V4l2Device::load_extension_unit()
+
+std::vector<v4l2_queryctrl> tcam::V4l2Device::query_controls()
 {
-    auto message_cb = [](const std::string& message)
+    v4l2_queryctrl qctrl = {};
+    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    std::vector<v4l2_queryctrl> qctrl_av;
+
+    while (tcam::tcam_xioctl(this->m_fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
     {
-        SPDLOG_DEBUG("{}", message.c_str());
-    };
+        // ignore unnecessary control descriptions such as control "groups"
+        if (!(qctrl.flags & V4L2_CTRL_FLAG_DISABLED) && qctrl.type != V4L2_CTRL_TYPE_CTRL_CLASS)
+        {
+            qctrl_av.push_back(qctrl);
+        }
+        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+    return qctrl_av;
+}
 
-    std::string extension_file =
+
+void tcam::V4l2Device::create_properties()
+{
+    const std::string extension_file =
         tcam::uvc::determine_extension_file(this->device.get_info().additional_identifier);
+    const std::string cache_key =
+        v4l2::control_cache_key(v4l2::device_cache_key(m_fd, device), extension_file);
 
-    if (extension_file.empty())
+    std::optional<v4l2::control_cache> cached;
+    if (!cache_key.empty())
     {
-        SPDLOG_WARN("Unable to determine uvc extension file");
-        return false;
+        cached = v4l2::load_control_cache(device, cache_key);
     }
 
-    auto mappings = tcam::uvc::load_description_file(extension_file, message_cb);
-    if (mappings.empty())
+    v4l2::control_cache controls;
+    if (cached)
     {
-        SPDLOG_WARN("Unable to load uvc extension file");
-        return false;
+        controls = std::move(*cached);
     }
-    tcam::uvc::apply_mappings(m_fd, mappings, message_cb);
 
-    return true;
-}
-
-
-void tcam::V4l2Device::create_properties()
-{
-    bool extension_unit_exists = extension_unit_is_loaded();
+    // the kernel drops the mappings when the camera is unplugged, a cache does not imply them
+    bool extension_unit_exists =
+        cached ? extension_unit_is_loaded(controls.controls) : extension_unit_is_loaded();
 
     if (!extension_unit_exists)
     {
-        extension_unit_exists = load_extension_unit();
+        extension_unit_exists = load_extension_unit(extension_file, controls.extension_mappings);
     }
 
     if (!extension_unit_exists)
@@ -203,22 +216,72 @@ void tcam::V4l2Device::create_properties()
             "The property extension unit does not exist. Not all properties will be accessible.");
     }
 
-    v4l2_queryctrl qctrl = {};
-    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+    if (cached)
+    {
+        p_property_backend->set_menu_cache(controls.menus);
+    }
+    else
+    {
+        controls.controls = query_controls();
+    }
 
-    std::vector<v4l2_queryctrl> qctrl_av;
+    generate_properties(controls.controls);
 
-    while (tcam::tcam_xioctl(this->m_fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
+    // without the extension unit the controls are incomplete and not worth keeping
+    if (!cached && !cache_key.empty() && extension_unit_exists)
     {
-        // ignore unnecessary control descriptions such as control "groups"
-        if (!(qctrl.flags & V4L2_CTRL_FLAG_DISABLED) && qctrl.type != V4L2_CTRL_TYPE_CTRL_CLASS)
-        {
-            qctrl_av.push_back(qctrl);
-        }
-        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+        controls.menus = p_property_backend->get_menu_cache();
+        v4l2::store_control_cache(device, cache_key, controls);
+    }
+
+    register_stream_state_observers();
+}
+
+
+void tcam::V4l2Device::register_stream_state_observers()
+{
+    using namespace tcam::v4l2;
+
+    if (auto exposure = std::dynamic_pointer_cast<V4L2PropertyDoubleImpl>(
+            find_property(m_properties, "ExposureTime")))
+    {
+        // takes effect when the timeout is armed for the next image
+        exposure->set_write_observer([this](double value)
+                                     { m_exposure_time_us = static_cast<int64_t>(value); });
     }
 
-    generate_properties(qctrl_av);
+    if (auto trigger_mode = std::dynamic_pointer_cast<V4L2PropertyEnumImpl>(
+            find_property(m_properties, "TriggerMode")))
+    {
+        trigger_mode->set_write_observer(
+            [this](std::string_view value)
+            {
+                m_trigger_mode_enabled = (value == "On");
+                m_pending_software_triggers = 0;
+                if (m_is_stream_on)
+                {
+                    arm_stream_timeout();
+                }
+            });
+    }
+
+    if (auto trigger_software = std::dynamic_pointer_cast<V4L2PropertyCommandImpl>(
+            find_property(m_properties, "TriggerSoftware")))
+    {
+        trigger_software->set_write_observer(
+            [this]
+            {
+                if (!m_is_stream_on || !m_trigger_mode_enabled)
+                {
+                    return;
+                }
+                // a running timeout belongs to an earlier trigger
+                if (m_pending_software_triggers++ == 0)
+                {
+                    arm_stream_timeout();
+                }
+            });
+    }
 }
 
 void tcam::V4l2Device::create_videoformat_dependent_properties()
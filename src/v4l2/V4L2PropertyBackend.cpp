@@ -25,23 +25,12 @@
 tcam::v4l2::V4L2PropertyBackend::V4L2PropertyBackend(int fd) : p_fd(fd) {}
 
 
-static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request, v4l2_control* ctrl)
+namespace
 {
-    auto ret = tcam::tcam_xioctl(fd, request, ctrl);
-    if (ret >= 0)
-    {
-        return ctrl->value;
-    }
 
-    std::string_view action = "GET";
-    if (request == VIDIOC_S_CTRL)
-    {
-        action = "SET";
-    }
-
-    SPDLOG_ERROR(
-        "ioctl returned {} reported error while {} ({}): {}", ret, action, errno, strerror(errno));
-    switch (errno)
+std::error_code errno_to_status(int err)
+{
+    switch (err)
     {
         case EBUSY:
         {
@@ -63,10 +52,93 @@ static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request,
     return tcam::status::UndefinedError;
 }
 
+outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request, v4l2_control* ctrl)
+{
+    auto ret = tcam::tcam_xioctl(fd, request, ctrl);
+    if (ret >= 0)
+    {
+        return ctrl->value;
+    }
+
+    std::string_view action = "GET";
+    if (request == VIDIOC_S_CTRL)
+    {
+        action = "SET";
+    }
+
+    SPDLOG_ERROR(
+        "ioctl returned {} reported error while {} ({}): {}", ret, action, errno, strerror(errno));
+    return errno_to_status(errno);
+}
+
+} // namespace
+
+
+namespace tcam::v4l2
+{
+
+class V4L2PropertyTransaction : public tcam::property::IPropertyTransaction
+{
+public:
+    explicit V4L2PropertyTransaction(const std::shared_ptr<V4L2PropertyBackend>& backend)
+        : backend_(backend)
+    {
+        owns_batch_ = backend_->begin_batch();
+    }
+
+    ~V4L2PropertyTransaction() override
+    {
+        auto res = commit();
+        if (!res)
+        {
+            SPDLOG_ERROR("Writing batched properties failed: {}", res.error().message());
+        }
+    }
+
+    outcome::result<void> commit() final
+    {
+        if (!owns_batch_)
+        {
+            return outcome::success();
+        }
+        owns_batch_ = false;
+        return backend_->end_batch();
+    }
+
+private:
+    std::shared_ptr<V4L2PropertyBackend> backend_;
+    bool owns_batch_ = false;
+};
+
+} // namespace tcam::v4l2
+
 
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::write_control(int v4l2_id,
                                                                             int new_value)
 {
+    {
+        std::scoped_lock lck(mtx_);
+        if (is_batching())
+        {
+            // the last value of a control wins, the position of its first write is kept
+            for (auto& ctrl : pending_)
+            {
+                if (ctrl.id == (uint32_t)v4l2_id)
+                {
+                    ctrl.value = new_value;
+                    return new_value;
+                }
+            }
+
+            struct v4l2_ext_control ctrl = {};
+            ctrl.id = v4l2_id;
+            ctrl.value = new_value;
+            pending_.push_back(ctrl);
+
+            return new_value;
+        }
+    }
+
     struct v4l2_control ctrl = {};
     ctrl.id = v4l2_id;
     ctrl.value = new_value;
@@ -77,6 +149,23 @@ outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::write_control(int v4l2
 
 outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_id)
 {
+    {
+        std::scoped_lock lck(mtx_);
+        if (is_batching() && !pending_.empty())
+        {
+            for (const auto& ctrl : pending_)
+            {
+                if (ctrl.id == (uint32_t)v4l2_id)
+                {
+                    return ctrl.value;
+                }
+            }
+
+            // the value may depend on pending writes, e.g. auto controls
+            OUTCOME_TRY(flush_batch());
+        }
+    }
+
     struct v4l2_control ctrl = {};
     ctrl.id = v4l2_id;
 
@@ -84,9 +173,102 @@ outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_
 }
 
 
+std::unique_ptr<tcam::property::IPropertyTransaction> tcam::v4l2::V4L2PropertyBackend::
+    begin_transaction()
+{
+    return std::make_unique<V4L2PropertyTransaction>(shared_from_this());
+}
+
+
+bool tcam::v4l2::V4L2PropertyBackend::begin_batch()
+{
+    std::scoped_lock lck(mtx_);
+
+    if (batch_depth_ > 0 && batch_owner_ != std::this_thread::get_id())
+    {
+        return false;
+    }
+
+    batch_owner_ = std::this_thread::get_id();
+    ++batch_depth_;
+    return true;
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::end_batch()
+{
+    std::scoped_lock lck(mtx_);
+
+    if (--batch_depth_ > 0)
+    {
+        return outcome::success();
+    }
+
+    auto res = flush_batch();
+
+    batch_owner_ = {};
+    return res;
+}
+
+
+bool tcam::v4l2::V4L2PropertyBackend::is_batching() const
+{
+    return batch_depth_ > 0 && batch_owner_ == std::this_thread::get_id();
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::flush_batch()
+{
+    if (pending_.empty())
+    {
+        return outcome::success();
+    }
+
+    auto ctrls = std::move(pending_);
+    pending_.clear();
+
+    // ctrl_class 0 allows controls of different classes in one request
+    struct v4l2_ext_controls ext = {};
+    ext.count = ctrls.size();
+    ext.controls = ctrls.data();
+
+    if (tcam::tcam_xioctl(p_fd, VIDIOC_S_EXT_CTRLS, &ext) == 0)
+    {
+        return outcome::success();
+    }
+
+    // Drivers like uvcvideo roll the whole request back when one control fails.
+    // Write every control on its own so that only the broken one is lost.
+    SPDLOG_DEBUG("VIDIOC_S_EXT_CTRLS failed ({}) at index {} of {}. Writing controls one by one.",
+                 strerror(errno),
+                 ext.error_idx,
+                 ctrls.size());
+
+    outcome::result<void> ret = outcome::success();
+    for (const auto& c : ctrls)
+    {
+        struct v4l2_control ctrl = {};
+        ctrl.id = c.id;
+        ctrl.value = c.value;
+
+        auto res = v4l2_control_ioctl(p_fd, VIDIOC_S_CTRL, &ctrl);
+        if (!res && !ret.has_error())
+        {
+            ret = res.error();
+        }
+    }
+    return ret;
+}
+
+
 auto tcam::v4l2::V4L2PropertyBackend::get_menu_entries(int v4l2_id, int max)
     -> std::vector<tcam::v4l2::menu_entry>
 {
+    if (auto cached = menu_cache_.find(v4l2_id); cached != menu_cache_.end())
+    {
+        return cached->second;
+    }
+
     std::vector<tcam::v4l2::menu_entry> rval;
     for (int i = 0; i <= max; i++)
     {
@@ -99,5 +281,20 @@ auto tcam::v4l2::V4L2PropertyBackend::get_menu_entries(int v4l2_id, int max)
         }
         rval.push_back({ i, std::string((char*)qmenu.name) });
     }
+    menu_cache_[v4l2_id] = rval;
     return rval;
 }
+
+
+void tcam::v4l2::V4L2PropertyBackend::set_menu_cache(
+    std::map<int, std::vector<tcam::v4l2::menu_entry>> menus)
+{
+    menu_cache_ = std::move(menus);
+}
+
+
+auto tcam::v4l2::V4L2PropertyBackend::get_menu_cache() const
+    -> const std::map<int, std::vector<tcam::v4l2::menu_entry>>&
+{
+    return menu_cache_;
+}
@@ -16,15 +16,21 @@
 
 #pragma once
 
+#include "../PropertyInterfaces.h"
 #include "../error.h"
 #include "v4l2_genicam_conversion.h"
 
+#include <linux/videodev2.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace tcam::v4l2
 {
 
-class V4L2PropertyBackend
+class V4L2PropertyBackend : public std::enable_shared_from_this<V4L2PropertyBackend>
 {
 public:
     explicit V4L2PropertyBackend(int fd);
@@ -33,9 +39,43 @@ public:
 
     outcome::result<int64_t> read_control(int v4l2_id);
 
+    // answered from the menu cache when the control is in it, otherwise queried and added
     std::vector<tcam::v4l2::menu_entry> get_menu_entries(int v4l2_id, int max);
+
+    /**
+     * Replace the menu cache, e.g. with the entries of tcam::v4l2::load_control_cache.
+     */
+    void set_menu_cache(std::map<int, std::vector<tcam::v4l2::menu_entry>> menus);
+    const std::map<int, std::vector<tcam::v4l2::menu_entry>>& get_menu_cache() const;
+
+    /**
+     * Collect the write_control calls of the calling thread
+     * and write them with a single VIDIOC_S_EXT_CTRLS on commit.
+     * Transactions of the same thread nest, the outermost one writes.
+     * Other threads keep writing immediately.
+     */
+    std::unique_ptr<tcam::property::IPropertyTransaction> begin_transaction();
+
 private:
+    friend class V4L2PropertyTransaction;
+
+    // returns false when another thread owns the open batch
+    bool begin_batch();
+    outcome::result<void> end_batch();
+
+    // mtx_ has to be held
+    bool is_batching() const;
+    outcome::result<void> flush_batch();
+
     int p_fd = 0;
+
+    std::mutex mtx_;
+    std::thread::id batch_owner_;
+    int batch_depth_ = 0;
+    std::vector<v4l2_ext_control> pending_;
+
+    // only used while properties are created
+    std::map<int, std::vector<tcam::v4l2::menu_entry>> menu_cache_;
 };
 
 } // namespace tcam::property
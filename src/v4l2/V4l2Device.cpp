@@ -16,8 +16,16 @@
 
 #include "V4l2Device.h"
 
+#include "../latency_tracing.h"
+#include "../busy_poll.h"
+#include "../scope_tracing.h"
+#include "../usdt_probes.h"
 #include "../logging.h"
+#include "../scaling_cache.h"
+#include "../UsbBandwidthPlanner.h"
 #include "../utils.h"
+#include "V4l2EventLoop.h"
+#include "uvc_metadata.h"
 #include "v4l2_utils.h"
 
 #include <algorithm>
@@ -25,14 +33,61 @@
 #include <dutils_img/fcc_to_string.h>
 #include <errno.h>
 #include <fcntl.h> /* O_RDWR O_NONBLOCK */
-#include <libudev.h>
 #include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
 using namespace tcam;
 
 static const int lost_countdown_default = 5;
 
+// added to exposure time and frame period, covers the transfer and the scheduling of the loop
+static const int64_t stream_timeout_margin_us = 20'000;
+static const int64_t stream_startup_timeout_us = 2'000'000;
+
+
+namespace
+{
+
+// exported dma buffers are driver mmap buffers
+// only imported dma memory uses V4L2_MEMORY_DMABUF
+v4l2_memory to_v4l2_memory(TCAM_MEMORY_TYPE t)
+{
+    switch (t)
+    {
+        case TCAM_MEMORY_TYPE_USERPTR:
+            return V4L2_MEMORY_USERPTR;
+        case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
+            return V4L2_MEMORY_MMAP;
+        case TCAM_MEMORY_TYPE_DMA_IMPORT:
+            return V4L2_MEMORY_DMABUF;
+    }
+    return V4L2_MEMORY_USERPTR;
+}
+
+const char* timestamp_source_to_string(TCAM_TIMESTAMP_SOURCE src)
+{
+    switch (src)
+    {
+        case TCAM_TIMESTAMP_SOURCE_END_OF_FRAME:
+            return "end of frame";
+        case TCAM_TIMESTAMP_SOURCE_START_OF_EXPOSURE:
+            return "start of exposure";
+        case TCAM_TIMESTAMP_SOURCE_START_OF_FRAME:
+            return "start of frame";
+        case TCAM_TIMESTAMP_SOURCE_SYSTEM:
+            return "dequeue of the buffer";
+        case TCAM_TIMESTAMP_SOURCE_UNKNOWN:
+            break;
+    }
+    return "unknown point";
+}
+
+} // namespace
+
 
 V4l2Device::V4l2Device(const DeviceInfo& device_desc)
 {
@@ -48,7 +103,16 @@ V4l2Device::V4l2Device(const DeviceInfo& device_desc)
         throw std::runtime_error("Failed opening device.");
     }
 
-    m_monitor_v4l2_thread = std::thread(&V4l2Device::monitor_v4l2_thread_func, this);
+    m_timeout_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timeout_fd == -1)
+    {
+        SPDLOG_ERROR("Unable to create stream timer: {}", strerror(errno));
+        close(m_fd);
+        throw std::runtime_error("Failed creating stream timer.");
+    }
+
+    m_lost_event_id = v4l2::V4l2EventLoop::get_instance().add_device_removed_cb(
+        device.get_identifier(), [this] { on_device_removed(); });
 
     p_property_backend = std::make_shared<tcam::v4l2::V4L2PropertyBackend>(m_fd);
 
@@ -65,22 +129,23 @@ V4l2Device::V4l2Device(const DeviceInfo& device_desc)
 
 V4l2Device::~V4l2Device()
 {
+    v4l2::V4l2EventLoop::get_instance().remove(m_lost_event_id);
+
     if (m_is_stream_on)
     {
         stop_stream();
     }
 
-    this->m_stop_monitor_v4l2_thread = true;
-
     if (this->m_fd != -1)
     {
         close(m_fd);
         m_fd = -1;
     }
 
-    if (m_monitor_v4l2_thread.joinable())
+    if (m_timeout_fd != -1)
     {
-        m_monitor_v4l2_thread.join();
+        close(m_timeout_fd);
+        m_timeout_fd = -1;
     }
 }
 
@@ -264,17 +329,8 @@ bool V4l2Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     pool_ = pool;
 
-    auto b = pool_->get_buffer();
-
     this->m_buffers.clear();
-    this->m_buffers.reserve(b.size());
-
-    for (unsigned int i = 0; i < b.size(); ++i)
-    {
-        buffer_info info = { b.at(i), false };
-
-        this->m_buffers.push_back(info);
-    }
+    this->m_buffers.resize(pool_->get_buffer_count());
 
     return true;
 }
@@ -292,7 +348,7 @@ bool V4l2Device::release_buffers()
 
     req.count = 0; // free all buffers
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req.memory = V4L2_MEMORY_USERPTR;
+    req.memory = pool_ ? to_v4l2_memory(pool_->get_memory_type()) : V4L2_MEMORY_USERPTR;
 
     if (-1 == tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req))
     {
@@ -305,7 +361,7 @@ bool V4l2Device::release_buffers()
 }
 
 
-bool V4l2Device::queue_mmap(int i, std::shared_ptr<ImageBuffer> b)
+bool V4l2Device::queue_mmap(int i, const std::shared_ptr<ImageBuffer>& b)
 {
     struct v4l2_buffer buf = {};
 
@@ -325,7 +381,27 @@ bool V4l2Device::queue_mmap(int i, std::shared_ptr<ImageBuffer> b)
 }
 
 
-bool V4l2Device::queue_userptr(int i, std::shared_ptr<ImageBuffer> b)
+bool V4l2Device::queue_dma(int i, const std::shared_ptr<ImageBuffer>& b)
+{
+    struct v4l2_buffer buf = {};
+
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_DMABUF;
+    buf.index = i;
+    buf.m.fd = b->get_file_descriptor();
+    buf.length = b->get_image_buffer_size();
+
+    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf);
+    if (ret == -1)
+    {
+        SPDLOG_ERROR("Unable to queue dma buffer({}): {} fd: {}", errno, strerror(errno), buf.m.fd);
+        return false;
+    }
+    return true;
+}
+
+
+bool V4l2Device::queue_userptr(int i, const std::shared_ptr<ImageBuffer>& b)
 {
 
     struct v4l2_buffer buf = {};
@@ -349,66 +425,81 @@ bool V4l2Device::queue_userptr(int i, std::shared_ptr<ImageBuffer> b)
 
 void V4l2Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
-
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    // m_buffers is built in pool order, so the pool index is the v4l2 buffer index
+    const size_t i = buffer->get_pool_index();
+    if (i >= m_buffers.size() || !pool_->is_current(*buffer))
     {
+        SPDLOG_DEBUG("Buffer not requeued. Not part of the current buffer list.");
+        return;
+    }
 
+    {
         auto& b = m_buffers.at(i);
 
-        auto buf_ptr = b.buffer.lock();
-
-        if (!b.is_queued && buf_ptr == buffer)
+        if (!b.is_queued)
         {
             switch (pool_->get_memory_type())
             {
                 case TCAM_MEMORY_TYPE_USERPTR:
                 {
-                    if (queue_userptr(i, buf_ptr))
+                    if (queue_userptr(i, buffer))
                     {
                         b.is_queued = true;
                     }
                     break;
                 }
                 case TCAM_MEMORY_TYPE_MMAP:
+                case TCAM_MEMORY_TYPE_DMA:
                 {
-                    if (queue_mmap(i, buf_ptr))
+                    if (queue_mmap(i, buffer))
                     {
                         b.is_queued = true;
                     }
                     break;
                 }
-                case TCAM_MEMORY_TYPE_DMA:
                 case TCAM_MEMORY_TYPE_DMA_IMPORT:
                 {
-                    SPDLOG_ERROR("Queueing of DMA not implemented");
+                    if (queue_dma(i, buffer))
+                    {
+                        b.is_queued = true;
+                    }
                     break;
                 }
             }
+            if (b.is_queued)
+            {
+                m_queued_buffer_count++;
+            }
         }
     }
 }
 
 
-void V4l2Device::update_stream_timeout()
+void V4l2Device::read_stream_state()
 {
-    for (const auto& p : m_properties)
+    if (auto exposure = tcam::property::find_property<tcam::property::IPropertyFloat>(
+            m_properties, "ExposureTime"))
     {
-        if (p->get_name() == "ExposureTime")
+        if (auto val = exposure->get_value())
         {
-            auto val = std::dynamic_pointer_cast<tcam::property::IPropertyFloat>(p)->get_value();
+            m_exposure_time_us = static_cast<int64_t>(val.value());
+        }
+    }
 
-            if (val)
-            {
-                m_stream_timeout_sec = (val.value() / 1000000) + 2;
-            }
-            else
-            {
-                // TODO: implement error handling
-            }
-            break;
+    m_trigger_mode_enabled = false;
+    if (auto trigger_mode = tcam::property::find_property<tcam::property::IPropertyEnum>(
+            m_properties, "TriggerMode"))
+    {
+        if (auto val = trigger_mode->get_value())
+        {
+            m_trigger_mode_enabled = (val.value() == "On");
         }
     }
-    SPDLOG_DEBUG("Setting stream timeout to {}", m_stream_timeout_sec.load());
+    m_pending_software_triggers = 0;
+
+    SPDLOG_DEBUG("Stream timeout is {} us. Trigger mode is {}.",
+                 calc_stream_timeout_us(),
+                 m_trigger_mode_enabled ? "On" : "Off");
 }
 
 
@@ -422,16 +513,34 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
             break;
         }
         case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
         {
             SPDLOG_DEBUG("init mmap");
             init_mmap_buffers();
             break;
         }
-        case TCAM_MEMORY_TYPE_DMA:
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            SPDLOG_ERROR("MEMORY type not implemented");
-            return false;
+            SPDLOG_DEBUG("init dma import");
+            if (!init_dma_buffers())
+            {
+                SPDLOG_ERROR("Unable to import dmabuf buffers. Not starting stream.");
+                return false;
+            }
+            break;
+        }
+    }
+
+    read_stream_state();
+    register_usb_bandwidth();
+
+    // the metadata node is started first, so that the first frame already has its buffer
+    if (tcam::is_environment_variable_set("TCAM_V4L2_UVC_METADATA"))
+    {
+        auto metadata = std::make_unique<v4l2::uvc_metadata_stream>();
+        if (metadata->open(device.get_identifier()) && metadata->start())
+        {
+            m_uvc_metadata = std::move(metadata);
         }
     }
 
@@ -439,20 +548,63 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
     if (-1 == tcam_xioctl(m_fd, VIDIOC_STREAMON, &type))
     {
         SPDLOG_ERROR("Unable to set ioctl VIDIOC_STREAMON {} {}", errno, strerror(errno));
+        m_uvc_metadata.reset();
+        unregister_usb_bandwidth();
         return false;
     }
 
     m_statistics = {};
 
+    m_queued_buffer_count = std::count_if(
+        m_buffers.begin(), m_buffers.end(), [](const buffer_info& b) { return b.is_queued; });
+    m_queue_ran_empty = false;
+    m_has_last_sequence = false;
+    m_timeouts_since_last_image = 0;
+
     m_listener = sink;
 
     m_is_stream_on = true;
 
-    update_stream_timeout();
+    m_already_received_valid_image = false;
+
+    m_lost_countdown = lost_countdown_default;
+    m_log_repetition_counter = 0;
+
+    arm_stream_timeout();
+
+    if (tcam::get_busy_poll_config().enabled)
+    {
+        // the frame sync events are read by the busy poll thread as well
+        subscribe_frame_sync();
+        if (!start_busy_poll_thread())
+        {
+            stop_stream();
+            return false;
+        }
+        return true;
+    }
+
+    SPDLOG_INFO("Starting stream in event loop.");
 
-    SPDLOG_INFO("Starting stream in work thread.");
+    auto& loop = v4l2::V4l2EventLoop::get_instance();
 
-    this->m_work_thread = std::thread(&V4l2Device::stream, this);
+    m_timeout_event_id = loop.add_fd(m_timeout_fd, [this] { on_stream_timeout(); });
+    if (subscribe_frame_sync())
+    {
+        m_stream_event_id =
+            loop.add_fd(m_fd, [this] { on_frame_ready(); }, [this] { on_frame_event(); });
+    }
+    else
+    {
+        m_stream_event_id = loop.add_fd(m_fd, [this] { on_frame_ready(); });
+    }
+
+    if (m_stream_event_id == -1 || m_timeout_event_id == -1)
+    {
+        SPDLOG_ERROR("Unable to register stream with event loop.");
+        stop_stream();
+        return false;
+    }
 
     return true;
 }
@@ -467,6 +619,8 @@ void V4l2Device::stop_stream()
 
     SPDLOG_TRACE("Stopping stream...");
 
+    stop_busy_poll_thread();
+
     if (m_is_stream_on)
     {
         enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -480,10 +634,20 @@ void V4l2Device::stop_stream()
 
     m_is_stream_on = false;
 
-    if (m_work_thread.joinable())
-    {
-        m_work_thread.join();
-    }
+    // waits for callbacks that are currently running
+    auto& loop = v4l2::V4l2EventLoop::get_instance();
+    loop.remove(m_stream_event_id);
+    loop.remove(m_timeout_event_id);
+    m_stream_event_id = -1;
+    m_timeout_event_id = -1;
+
+    struct itimerspec disarm = {};
+    timerfd_settime(m_timeout_fd, 0, &disarm, nullptr);
+
+    unsubscribe_frame_sync();
+
+    m_uvc_metadata.reset();
+    unregister_usb_bandwidth();
 
     m_listener.reset();
 
@@ -491,6 +655,84 @@ void V4l2Device::stop_stream()
 }
 
 
+void V4l2Device::register_usb_bandwidth()
+{
+    // /dev/video0 is /sys/class/video4linux/video0/device
+    const auto identifier = device.get_identifier();
+    const auto pos = identifier.rfind('/');
+    if (pos == std::string::npos)
+    {
+        return;
+    }
+    auto location =
+        tcam::find_usb_location("/sys/class/video4linux/" + identifier.substr(pos + 1) + "/device");
+    if (!location)
+    {
+        return;
+    }
+
+    tcam::usb_stream_demand demand;
+    demand.serial = device.get_serial();
+    demand.location = *location;
+    // the upper bound for compressed formats
+    demand.payload_bytes = m_active_video_format.get_required_buffer_size();
+    demand.framerate = m_trigger_mode_enabled ? 0.0 : m_active_video_format.get_framerate();
+
+    auto& planner = tcam::UsbBandwidthPlanner::get_instance();
+    const auto plan = planner.check(demand);
+
+    if (!plan.fits && tcam::is_environment_variable_set("TCAM_USB_BANDWIDTH_ADJUST")
+        && !m_trigger_mode_enabled)
+    {
+        // highest framerate of the format that fits
+        double framerate = 0.0;
+        for (const auto& f : framerate_conversions)
+        {
+            if (f.fps <= plan.max_framerate)
+            {
+                framerate = std::max(framerate, f.fps);
+            }
+        }
+
+        if (framerate > 0.0 && set_framerate(framerate))
+        {
+            SPDLOG_WARN("{}: Lowered framerate from {} to {} to fit into the bandwidth of {}.",
+                        demand.serial,
+                        demand.framerate,
+                        framerate,
+                        location->bus);
+            m_active_video_format.set_framerate(framerate);
+            demand.framerate = framerate;
+        }
+    }
+
+    m_usb_bandwidth_id = planner.add_stream(demand);
+}
+
+
+void V4l2Device::unregister_usb_bandwidth()
+{
+    if (m_usb_bandwidth_id != -1)
+    {
+        tcam::UsbBandwidthPlanner::get_instance().remove_stream(m_usb_bandwidth_id);
+        m_usb_bandwidth_id = -1;
+    }
+}
+
+
+int V4l2Device::get_numa_node()
+{
+    // /dev/video0 is /sys/class/video4linux/video0/device
+    const auto identifier = device.get_identifier();
+    const auto pos = identifier.rfind('/');
+    if (pos == std::string::npos)
+    {
+        return -1;
+    }
+    return tcam::find_numa_node("/sys/class/video4linux/" + identifier.substr(pos + 1) + "/device");
+}
+
+
 void V4l2Device::notify_device_lost_func()
 {
     SPDLOG_INFO("notifying callbacks about lost device");
@@ -853,6 +1095,77 @@ bool V4l2Device::set_scaling(const image_scaling& scale)
 }
 
 
+bool V4l2Device::probe_override_scanning_modes()
+{
+    // to actually set, use 'Override Scanning Mode'
+    // to test, use ScanningModeSelector
+    // to see if stuff is a valid setting, use ScanningModeIdentifier == ScanningModeSelector
+
+    auto p = tcam::property::find_property(m_scale.properties, "Scanning Mode Selector");
+    auto identifier_b = tcam::property::find_property(m_scale.properties, "Scanning Mode Identifier");
+    auto binning_hb = tcam::property::find_property(m_scale.properties, "Scanning Mode Binning H");
+    auto binning_vb = tcam::property::find_property(m_scale.properties, "Scanning Mode Binning V");
+    auto skipping_hb = tcam::property::find_property(m_scale.properties, "Scanning Mode Skipping H");
+    auto skipping_vb = tcam::property::find_property(m_scale.properties, "Scanning Mode Skipping V");
+    //auto flags_b = tcam::property::find_property(m_scale.properties, "Scanning Mode Flags");
+
+    auto identifier = dynamic_cast<tcam::property::IPropertyInteger*>(identifier_b.get());
+    auto binning_h = dynamic_cast<tcam::property::IPropertyInteger*>(binning_hb.get());
+    auto binning_v = dynamic_cast<tcam::property::IPropertyInteger*>(binning_vb.get());
+    auto skipping_h = dynamic_cast<tcam::property::IPropertyInteger*>(skipping_hb.get());
+    auto skipping_v = dynamic_cast<tcam::property::IPropertyInteger*>(skipping_vb.get());
+    //auto flags = dynamic_cast<tcam::property::IPropertyInteger*>(flags_b.get());
+
+    auto mode = dynamic_cast<tcam::property::IPropertyInteger*>(p.get());
+    int current_value = mode->get_value().value();
+
+    bool complete = true;
+    for (int i = mode->get_range().min; i <= mode->get_range().max; i += mode->get_range().stp)
+    {
+        if (!mode->set_value(i))
+        {
+            SPDLOG_ERROR("mode could not be changed");
+            complete = false;
+            continue;
+        }
+
+        // ScanningModeIdentifier has to be equal to ScanningModeSelector
+        // if it is 1 it is the default; ignore that
+        if (identifier->get_value().value() != i || i == 1)
+        {
+            continue;
+        }
+
+        // SPDLOG_ERROR("mode: {} ident: {} bin h: {} bin v: {} skip h: {} skip v: {} flags: {}",
+        //              i, identifier->get_value().value(),
+        //              binning_h->get_value().value(), binning_v->get_value().value(),
+        //              skipping_h->get_value().value(), skipping_v->get_value().value(),
+        //              flags->get_value().value());
+
+        image_scaling new_scale = {};
+
+        new_scale.binning_h = binning_h->get_value().value();
+        new_scale.binning_v = binning_v->get_value().value();
+
+        new_scale.skipping_h = skipping_h->get_value().value();
+        new_scale.skipping_v = skipping_v->get_value().value();
+
+        m_scale.scales.push_back(new_scale);
+
+        m_scale.override_index.push_back({i, (int)m_scale.scales.size() - 1});
+
+    }
+    // restore previous setting
+    auto ret = mode->set_value(current_value);
+    if (!ret)
+    {
+        SPDLOG_ERROR("Probing override scanning mode ended with an error: {}", ret.as_failure().error().message());
+        return false;
+    }
+    return complete;
+}
+
+
 void V4l2Device::generate_scales()
 {
     if (m_scale.scale_type == Unknown)
@@ -872,67 +1185,27 @@ void V4l2Device::generate_scales()
             return;
         }
 
-        // to actually set, use 'Override Scanning Mode'
-        // to test, use ScanningModeSelector
-        // to see if stuff is a valid setting, use ScanningModeIdentifier == ScanningModeSelector
-
-        auto p = tcam::property::find_property(m_scale.properties, "Scanning Mode Selector");
-        auto identifier_b = tcam::property::find_property(m_scale.properties, "Scanning Mode Identifier");
-        auto binning_hb = tcam::property::find_property(m_scale.properties, "Scanning Mode Binning H");
-        auto binning_vb = tcam::property::find_property(m_scale.properties, "Scanning Mode Binning V");
-        auto skipping_hb = tcam::property::find_property(m_scale.properties, "Scanning Mode Skipping H");
-        auto skipping_vb = tcam::property::find_property(m_scale.properties, "Scanning Mode Skipping V");
-        //auto flags_b = tcam::property::find_property(m_scale.properties, "Scanning Mode Flags");
-
-        auto identifier = dynamic_cast<tcam::property::IPropertyInteger*>(identifier_b.get());
-        auto binning_h = dynamic_cast<tcam::property::IPropertyInteger*>(binning_hb.get());
-        auto binning_v = dynamic_cast<tcam::property::IPropertyInteger*>(binning_vb.get());
-        auto skipping_h = dynamic_cast<tcam::property::IPropertyInteger*>(skipping_hb.get());
-        auto skipping_v = dynamic_cast<tcam::property::IPropertyInteger*>(skipping_vb.get());
-        //auto flags = dynamic_cast<tcam::property::IPropertyInteger*>(flags_b.get());
-
-        auto mode = dynamic_cast<tcam::property::IPropertyInteger*>(p.get());
-        int current_value = mode->get_value().value();
-
-        for (int i = mode->get_range().min; i <= mode->get_range().max; i += mode->get_range().stp)
+        // probing writes and reads several controls per scanning mode
+        const std::string cache_key = v4l2::scaling_cache_key(m_fd, device);
+        if (auto cached = tcam::load_scaling_cache(cache_key))
         {
-            if (!mode->set_value(i))
+            for (const auto& entry : cached.value())
             {
-                SPDLOG_ERROR("mode could not be changed");
-                continue;
+                m_scale.scales.push_back(entry.scale);
+                m_scale.override_index.push_back({ (int)entry.mode, (int)m_scale.scales.size() - 1 });
             }
+            return;
+        }
 
-            // ScanningModeIdentifier has to be equal to ScanningModeSelector
-            // if it is 1 it is the default; ignore that
-            if (identifier->get_value().value() != i || i == 1)
+        // an incomplete table would be reused until the firmware changes
+        if (probe_override_scanning_modes() && !cache_key.empty())
+        {
+            std::vector<tcam::cached_scaling> table;
+            for (const auto& o : m_scale.override_index)
             {
-                continue;
+                table.push_back({ m_scale.scales.at(o.scales_index), o.override_value });
             }
-
-            // SPDLOG_ERROR("mode: {} ident: {} bin h: {} bin v: {} skip h: {} skip v: {} flags: {}",
-            //              i, identifier->get_value().value(),
-            //              binning_h->get_value().value(), binning_v->get_value().value(),
-            //              skipping_h->get_value().value(), skipping_v->get_value().value(),
-            //              flags->get_value().value());
-
-            image_scaling new_scale = {};
-
-            new_scale.binning_h = binning_h->get_value().value();
-            new_scale.binning_v = binning_v->get_value().value();
-
-            new_scale.skipping_h = skipping_h->get_value().value();
-            new_scale.skipping_v = skipping_v->get_value().value();
-
-            m_scale.scales.push_back(new_scale);
-
-            m_scale.override_index.push_back({i, (int)m_scale.scales.size() - 1});
-
-        }
-        // restore previous setting
-        auto ret = mode->set_value(current_value);
-        if (!ret)
-        {
-            SPDLOG_ERROR("Probing override scanning mode ended with an error: {}", ret.as_failure().error().message());
+            tcam::store_scaling_cache(cache_key, table);
         }
     }
 
@@ -979,74 +1252,75 @@ void V4l2Device::index_formats()
 {
     generate_scales();
 
-    struct v4l2_fmtdesc fmtdesc = {};
-    struct v4l2_frmsizeenum frms = {};
+    std::vector<v4l2::enumerated_format> formats;
 
-    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    const std::string cache_key = v4l2::device_cache_key(m_fd, device);
+    if (!cache_key.empty())
+    {
+        formats = v4l2::load_format_cache(device, cache_key).value_or(formats);
+    }
 
-    for (fmtdesc.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FMT, &fmtdesc); fmtdesc.index++)
+    if (formats.empty())
+    {
+        formats = enumerate_formats();
+
+        if (!cache_key.empty())
+        {
+            v4l2::store_format_cache(device, cache_key, formats);
+        }
+    }
+
+    for (const auto& fmt : formats)
     {
         struct tcam_video_format_description desc = {};
 
         struct v4l2_fmtdesc new_desc = {};
-        m_emulate_bayer = checkForBayer(fmtdesc, new_desc);
+        m_emulate_bayer = checkForBayer(fmt.desc, new_desc);
 
         // internal fourcc definitions are identical with v4l2
         desc.fourcc = new_desc.pixelformat;
         memcpy(desc.description, new_desc.description, sizeof(new_desc.description));
-        frms.pixel_format = fmtdesc.pixelformat;
 
         std::vector<struct framerate_mapping> rf;
 
         // needed for binning/skipping later on
         tcam_image_size sensor_size = {};
 
-        // iterate all framesizes to find largest
-        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        // find largest framesize
+        for (const auto& s : fmt.sizes)
         {
-            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
-            {
-                sensor_size.width = std::max(frms.discrete.width,sensor_size.width);
-                sensor_size.height = std::max(frms.discrete.height,sensor_size.height);
-            }
+            sensor_size.width = std::max(s.width, sensor_size.width);
+            sensor_size.height = std::max(s.height, sensor_size.height);
         }
 
-        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        for (const auto& s : fmt.sizes)
         {
-            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
-            {
-                struct tcam_resolution_description res = {};
+            struct tcam_resolution_description res = {};
 
-                res.min_size.width = frms.discrete.width;
-                res.max_size.width = frms.discrete.width;
-                res.min_size.height = frms.discrete.height;
-                res.max_size.height = frms.discrete.height;
+            res.min_size.width = s.width;
+            res.max_size.width = s.width;
+            res.min_size.height = s.height;
+            res.max_size.height = s.height;
 
-                std::vector<double> f = index_framerates(frms);
+            std::vector<double> f = index_framerates(s.intervals);
 
-                res.type = TCAM_RESOLUTION_TYPE_FIXED;
+            res.type = TCAM_RESOLUTION_TYPE_FIXED;
 
-                framerate_mapping r = { res, f };
-                rf.push_back(r);
+            framerate_mapping r = { res, f };
+            rf.push_back(r);
 
-                for (auto s : m_scale.scales)
+            for (auto scale : m_scale.scales)
+            {
+                if (scale.legal_resolution(sensor_size, res.max_size))
                 {
-                    if (s.legal_resolution(sensor_size, res.max_size))
-                    {
-                        // being here we have a valid resolution/scaling combo
-                        // copy resolution desc and add scaling
-                        auto scaled_res = res;
-                        scaled_res.scaling = s;
+                    // being here we have a valid resolution/scaling combo
+                    // copy resolution desc and add scaling
+                    auto scaled_res = res;
+                    scaled_res.scaling = scale;
 
-                        rf.push_back({scaled_res, f});
-                    }
+                    rf.push_back({scaled_res, f});
                 }
             }
-            else
-            {
-                // TIS USB cameras do not have this kind of setting
-                SPDLOG_ERROR("Encountered unknown V4L2_FRMSIZE_TYPE");
-            }
         }
 
         // algorithms, etc. use Y800 as an identifier.
@@ -1065,7 +1339,44 @@ void V4l2Device::index_formats()
 }
 
 
-std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum& frms)
+std::vector<v4l2::enumerated_format> V4l2Device::enumerate_formats()
+{
+    std::vector<v4l2::enumerated_format> ret;
+
+    struct v4l2_fmtdesc fmtdesc = {};
+    struct v4l2_frmsizeenum frms = {};
+
+    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    for (fmtdesc.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FMT, &fmtdesc); fmtdesc.index++)
+    {
+        v4l2::enumerated_format fmt = {};
+        fmt.desc = fmtdesc;
+
+        frms.pixel_format = fmtdesc.pixelformat;
+
+        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        {
+            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+            {
+                fmt.sizes.push_back(
+                    { frms.discrete.width, frms.discrete.height, enumerate_frame_intervals(frms) });
+            }
+            else
+            {
+                // TIS USB cameras do not have this kind of setting
+                SPDLOG_ERROR("Encountered unknown V4L2_FRMSIZE_TYPE");
+            }
+        }
+
+        ret.push_back(fmt);
+    }
+
+    return ret;
+}
+
+
+std::vector<v4l2_fract> V4l2Device::enumerate_frame_intervals(const struct v4l2_frmsizeenum& frms)
 {
     struct v4l2_frmivalenum frmival = {};
 
@@ -1073,23 +1384,14 @@ std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum&
     frmival.width = frms.discrete.width;
     frmival.height = frms.discrete.height;
 
-    std::vector<double> f;
+    std::vector<v4l2_fract> ret;
 
     for (frmival.index = 0; tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMEINTERVALS, &frmival) >= 0;
          frmival.index++)
     {
         if (frmival.type == V4L2_FRMIVAL_TYPE_DISCRETE)
         {
-
-            // v4l2 lists frame rates as fractions (number of seconds / frames (e.g. 1/30))
-            // we however use framerates as fps (e.g. 30/1)
-            // therefor we have to switch numerator and denominator
-
-            double frac = (double)frmival.discrete.denominator / frmival.discrete.numerator;
-            f.push_back(frac);
-
-            framerate_conv c = { frac, frmival.discrete.numerator, frmival.discrete.denominator };
-            framerate_conversions.push_back(c);
+            ret.push_back(frmival.discrete);
         }
         else
         {
@@ -1101,15 +1403,36 @@ std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum&
         }
     }
 
-    return f;
+    return ret;
 }
 
-void V4l2Device::determine_active_video_format()
+
+std::vector<double> V4l2Device::index_framerates(const std::vector<v4l2_fract>& intervals)
 {
+    std::vector<double> f;
 
-    struct v4l2_format fmt = {};
+    for (const auto& interval : intervals)
+    {
+        // v4l2 lists frame rates as fractions (number of seconds / frames (e.g. 1/30))
+        // we however use framerates as fps (e.g. 30/1)
+        // therefor we have to switch numerator and denominator
 
-    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        double frac = (double)interval.denominator / interval.numerator;
+        f.push_back(frac);
+
+        framerate_conv c = { frac, interval.numerator, interval.denominator };
+        framerate_conversions.push_back(c);
+    }
+
+    return f;
+}
+
+void V4l2Device::determine_active_video_format()
+{
+
+    struct v4l2_format fmt = {};
+
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
     int ret = tcam_xioctl(this->m_fd, VIDIOC_G_FMT, &fmt);
 
@@ -1174,157 +1497,532 @@ bool V4l2Device::extension_unit_is_loaded()
 }
 
 
-void V4l2Device::stream()
+bool V4l2Device::extension_unit_is_loaded(const std::vector<v4l2_queryctrl>& known)
 {
-    tcam::set_thread_name("tcam_v4l2_strm");
+    auto iter = std::find_if(known.begin(),
+                             known.end(),
+                             [](const v4l2_queryctrl& c) { return ((c.id >> 12) ^ 0x199e) == 0; });
+    if (iter == known.end())
+    {
+        return false;
+    }
 
-    m_already_received_valid_image = false;
-    static const int log_repetition = 10;
-    int log_repetition_counter = 0;
-    int lost_countdown = lost_countdown_default;
-    // period elapsed for current image
-    int waited_seconds = 0;
-    // maximum_waiting period
-    // do not compare waited_seconds with m_stream_timeout_sec directly
-    // m_stream_timeout_sec may be set to low values while we are
-    // still waiting for a long exposure image
-    // still 'step in between' prevents such errors
-    int waiting_period = m_stream_timeout_sec;
+    struct v4l2_queryctrl qctrl = {};
+    qctrl.id = iter->id;
+    return tcam_xioctl(this->m_fd, VIDIOC_QUERYCTRL, &qctrl) == 0;
+}
 
-    while (this->m_is_stream_on)
+
+int64_t V4l2Device::calc_stream_timeout_us() const
+{
+    const double fps = m_active_video_format.get_framerate();
+    const int64_t frame_period_us = fps > 0.0 ? static_cast<int64_t>(1'000'000.0 / fps) : 0;
+
+    int64_t timeout_us = m_exposure_time_us + frame_period_us + stream_timeout_margin_us;
+    if (!m_already_received_valid_image)
     {
-        fd_set fds;
+        // the first image also has to wait for the sensor to start
+        timeout_us += stream_startup_timeout_us;
+    }
+
+    // millisecond resolution is enough, the scheduler is not more precise
+    return (timeout_us + 999) / 1000 * 1000;
+}
 
-        FD_ZERO(&fds);
-        FD_SET(m_fd, &fds);
 
-        int select_timeout = 2;
+void V4l2Device::arm_stream_timeout()
+{
+    // do not use the wall clock, the timeout has to be independent of time adjustments
+    // a zeroed itimerspec disarms the timer
+    struct itimerspec spec = {};
 
-        /* Timeout. */
-        struct timeval tv;
-        tv.tv_sec = select_timeout;
-        tv.tv_usec = 0;
+    // hardware triggers are not known, only software triggers can be waited for
+    if (!m_trigger_mode_enabled || m_pending_software_triggers > 0)
+    {
+        const int64_t timeout_us = calc_stream_timeout_us();
+        spec.it_value.tv_sec = timeout_us / 1'000'000;
+        spec.it_value.tv_nsec = (timeout_us % 1'000'000) * 1000;
+    }
 
-        /* Wait until device gives go */
-        int ret = select(m_fd + 1, &fds, NULL, NULL, &tv);
-        if (ret == -1)
+    if (timerfd_settime(m_timeout_fd, 0, &spec, nullptr) == -1)
+    {
+        SPDLOG_ERROR("Unable to arm stream timeout: {}", strerror(errno));
+    }
+}
+
+
+void V4l2Device::check_lost_countdown()
+{
+    static const int log_repetition = 10;
+
+    if (m_lost_countdown <= 0 && m_log_repetition_counter < log_repetition)
+    {
+        SPDLOG_WARN("Did not receive image for long time.");
+        m_lost_countdown = lost_countdown_default;
+        if (m_log_repetition_counter < log_repetition)
         {
-            if (errno == EINTR)
-            {
-                continue; // intermittent wake, continue
-            }
-            else
-            {
-                /* error during select */
-                SPDLOG_ERROR("Error during select. errno: %d (%s)", errno, strerror(errno));
-                return;
-            }
+            m_log_repetition_counter++;
+        }
+        if (m_log_repetition_counter >= log_repetition)
+        {
+            SPDLOG_WARN("Stopping messages \"Did not receive image for long time.\".");
         }
+    }
+}
+
+
+void V4l2Device::on_frame_ready()
+{
+    // before we recheck any variables,
+    // just quit because stop was requested
+    if (!m_is_stream_on)
+    {
+        return;
+    }
 
-        // before we recheck any variables,
-        // just quit the loop because stop was requested
-        if (!m_is_stream_on)
+    on_dequeue_result(get_frame());
+}
+
+
+void V4l2Device::on_dequeue_result(bool received)
+{
+    if (received)
+    {
+        m_lost_countdown = lost_countdown_default; // reset lost countdown variable
+        m_log_repetition_counter = 0;
+
+        consume_pending_software_trigger();
+    }
+    else
+    {
+        m_lost_countdown--;
+    }
+
+    // the timeout is only re-armed after an image or an expired timeout
+    // the exposure time may be set to low values while we are
+    // still waiting for a long exposure image
+    arm_stream_timeout();
+
+    check_lost_countdown();
+}
+
+
+void V4l2Device::on_stream_timeout()
+{
+    uint64_t expirations = 0;
+    if (read(m_timeout_fd, &expirations, sizeof(expirations)) == -1)
+    {
+        // spurious wakeup, timer was re-armed in between
+        return;
+    }
+
+    if (!m_is_stream_on)
+    {
+        return;
+    }
+
+    if (m_trigger_mode_enabled)
+    {
+        // only armed while a software trigger is pending
+        if (!consume_pending_software_trigger())
         {
+            arm_stream_timeout();
             return;
         }
+        TCAM_ERROR_RATE_LIMITED("Timeout while waiting for the image of a software trigger.");
+    }
+    else
+    {
+        TCAM_ERROR_RATE_LIMITED("Timeout while waiting for new image buffer.");
+    }
+
+    arm_stream_timeout();
+
+    m_statistics.frames_dropped++;
+    m_timeouts_since_last_image++;
+    m_lost_countdown--;
+
+    check_lost_countdown();
+}
+
+
+bool V4l2Device::start_busy_poll_thread()
+{
+    m_busy_poll_wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_busy_poll_wakeup_fd == -1)
+    {
+        SPDLOG_ERROR("Unable to create eventfd: {}", strerror(errno));
+        return false;
+    }
+
+    SPDLOG_INFO("Starting stream with busy polling.");
 
-        if (ret == 0) // timeout encountered
+    m_busy_poll_running = true;
+    m_busy_poll_thread = std::thread(&V4l2Device::busy_poll_stream, this);
+    return true;
+}
+
+
+void V4l2Device::stop_busy_poll_thread()
+{
+    if (m_busy_poll_thread.joinable())
+    {
+        m_busy_poll_running = false;
+
+        uint64_t one = 1;
+        if (write(m_busy_poll_wakeup_fd, &one, sizeof(one)) == -1)
         {
-            if (is_trigger_mode_enabled())
+            SPDLOG_WARN("Unable to wake the busy poll thread: {}", strerror(errno));
+        }
+        m_busy_poll_thread.join();
+    }
+
+    if (m_busy_poll_wakeup_fd != -1)
+    {
+        close(m_busy_poll_wakeup_fd);
+        m_busy_poll_wakeup_fd = -1;
+    }
+}
+
+
+void V4l2Device::busy_poll_stream()
+{
+    tcam::set_thread_name("tcam_v4l2spin");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    using clock = tcam::frame_arrival_predictor::clock;
+
+    tcam::frame_arrival_predictor predictor(tcam::get_busy_poll_config().window);
+    // a removed device keeps reporting POLLERR, only the timeout and the wakeup are waited for
+    bool device_error = false;
+
+    while (m_busy_poll_running)
+    {
+        // triggered frames cannot be predicted
+        predictor.set_framerate(m_trigger_mode_enabled ? 0.0
+                                                       : m_active_video_format.get_framerate());
+
+        const auto now = clock::now();
+        if (predictor.has_prediction() && now >= predictor.spin_start())
+        {
+            bool would_block = false;
+            const bool received = get_frame(&would_block);
+            if (received || !would_block)
             {
-                continue; // timeout while trigger is enabled, just continue
+                on_dequeue_result(received);
+                if (received)
+                {
+                    predictor.on_frame(clock::now());
+                }
+                else
+                {
+                    predictor.on_miss();
+                }
             }
-
-            if (waited_seconds < waiting_period)
+            else if (clock::now() >= predictor.spin_end())
             {
-                waited_seconds += select_timeout;
+                // late frames are dequeued after a blocking wait
+                predictor.on_miss();
             }
             else
             {
-                SPDLOG_ERROR("Timeout while waiting for new image buffer.");
-                m_statistics.frames_dropped++;
-                waited_seconds = 0;
-                lost_countdown--;
+                tcam::cpu_relax();
             }
+            continue;
         }
-        else
+
+        struct pollfd fds[] = {
+            { m_busy_poll_wakeup_fd, POLLIN, 0 },
+            { m_timeout_fd, POLLIN, 0 },
+            { device_error ? -1 : m_fd, POLLIN | POLLPRI, 0 },
+        };
+
+        struct timespec wait = {};
+        struct timespec* wait_ptr = nullptr;
+        if (predictor.has_prediction())
         {
-            bool ret_value = get_frame();
-            if (ret_value)
-            {
-                lost_countdown = lost_countdown_default; // reset lost countdown variable
-                log_repetition_counter = 0;
-            }
-            else
-            {
-                lost_countdown--;
-            }
-            waiting_period = m_stream_timeout_sec;
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                predictor.spin_start() - now)
+                                .count();
+            wait.tv_sec = ns / 1'000'000'000;
+            wait.tv_nsec = ns % 1'000'000'000;
+            wait_ptr = &wait;
         }
-        if (lost_countdown <= 0 && log_repetition_counter < log_repetition)
+
+        if (ppoll(fds, std::size(fds), wait_ptr, nullptr) < 0)
         {
-            SPDLOG_WARN("Did not receive image for long time.");
-            lost_countdown = lost_countdown_default;
-            if (log_repetition_counter < log_repetition)
+            if (errno != EINTR)
             {
-                log_repetition_counter++;
+                SPDLOG_ERROR("ppoll failed: {}", strerror(errno));
+                break;
             }
-            if (log_repetition_counter >= log_repetition)
+            continue;
+        }
+
+        if (!m_busy_poll_running)
+        {
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            on_stream_timeout();
+        }
+        if (fds[2].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            device_error = true;
+        }
+        if (fds[2].revents & POLLPRI)
+        {
+            on_frame_event();
+        }
+        if ((fds[2].revents & POLLIN) && m_is_stream_on)
+        {
+            const bool received = get_frame();
+            on_dequeue_result(received);
+            if (received)
             {
-                SPDLOG_WARN("Stopping messages \"Did not receive image for long time.\".");
+                predictor.on_frame(clock::now());
             }
         }
     }
 }
 
 
-bool V4l2Device::is_trigger_mode_enabled()
+bool V4l2Device::consume_pending_software_trigger()
 {
-    for (auto& p : m_properties)
+    int pending = m_pending_software_triggers;
+    while (pending > 0)
     {
-        if (p->get_name() == "TriggerMode")
+        if (m_pending_software_triggers.compare_exchange_weak(pending, pending - 1))
         {
-            auto val = std::dynamic_pointer_cast<tcam::property::IPropertyEnum>(p)->get_value();
-            if (val)
-            {
-                if (val.value() == "On")
-                {
-                    return true;
-                }
-                return false;
-            }
+            return true;
         }
     }
     return false;
 }
 
 
-bool V4l2Device::get_frame()
+bool V4l2Device::subscribe_frame_sync()
 {
-    struct v4l2_buffer buf = {};
+    m_frame_sync_stamps = {};
+    m_frame_sync_next = 0;
 
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    struct v4l2_event_subscription sub = {};
+    sub.type = V4L2_EVENT_FRAME_SYNC;
 
-    if (pool_->get_memory_type() == TCAM_MEMORY_TYPE_USERPTR)
+    m_frame_sync_subscribed = tcam_xioctl(m_fd, VIDIOC_SUBSCRIBE_EVENT, &sub) == 0;
+    if (!m_frame_sync_subscribed && errno != EINVAL && errno != ENOTTY)
     {
-        buf.memory = V4L2_MEMORY_USERPTR;
+        SPDLOG_WARN("Unable to subscribe to frame sync events: {}", strerror(errno));
+    }
+    return m_frame_sync_subscribed;
+}
+
+
+void V4l2Device::unsubscribe_frame_sync()
+{
+    if (!m_frame_sync_subscribed)
+    {
+        return;
+    }
+
+    struct v4l2_event_subscription sub = {};
+    sub.type = V4L2_EVENT_FRAME_SYNC;
+
+    tcam_xioctl(m_fd, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
+    m_frame_sync_subscribed = false;
+}
+
+
+void V4l2Device::on_frame_event()
+{
+    if (!m_is_stream_on)
+    {
+        return;
+    }
+
+    auto listener = m_listener.lock();
+    const bool notify = listener && listener->wants_frame_incoming();
+
+    // the driver queues several events when we fall behind
+    struct v4l2_event ev = {};
+    while (tcam_xioctl(m_fd, VIDIOC_DQEVENT, &ev) == 0)
+    {
+        if (ev.type != V4L2_EVENT_FRAME_SYNC)
+        {
+            continue;
+        }
+
+        // event timestamps are always CLOCK_MONOTONIC
+        const uint64_t timestamp_ns =
+            (uint64_t)ev.timestamp.tv_sec * 1000 * 1000 * 1000 + ev.timestamp.tv_nsec;
+
+        m_frame_sync_stamps[m_frame_sync_next] = { ev.u.frame_sync.frame_sequence,
+                                                   timestamp_ns };
+        m_frame_sync_next = (m_frame_sync_next + 1) % m_frame_sync_stamps.size();
+
+        if (notify)
+        {
+            listener->push_frame_incoming(ev.u.frame_sync.frame_sequence, timestamp_ns);
+        }
+    }
+}
+
+
+uint64_t V4l2Device::find_frame_sync_stamp(uint32_t sequence) const
+{
+    for (const auto& stamp : m_frame_sync_stamps)
+    {
+        if (stamp.timestamp_ns != 0 && stamp.sequence == sequence)
+        {
+            return stamp.timestamp_ns;
+        }
+    }
+    return 0;
+}
+
+
+void V4l2Device::update_capture_time(const struct v4l2_buffer& buf)
+{
+    // v4l2 timestamps contain seconds and microseconds
+    // here they are converted to nanoseconds
+    const uint64_t buffer_ns =
+        ((uint64_t)buf.timestamp.tv_sec * 1000 * 1000 * 1000) + (buf.timestamp.tv_usec * 1000);
+
+    const auto type = buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK;
+
+    // copied timestamps come from the application of an output queue
+    if (type != V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC || buffer_ns == 0)
+    {
+        m_statistics.capture_time_ns = tcam::latency::now_ns();
+        m_statistics.timestamp_source = TCAM_TIMESTAMP_SOURCE_SYSTEM;
+        return;
+    }
+
+    if ((buf.flags & V4L2_BUF_FLAG_TSTAMP_SRC_MASK) == V4L2_BUF_FLAG_TSTAMP_SRC_SOE)
+    {
+        m_statistics.capture_time_ns = buffer_ns;
+        m_statistics.timestamp_source = TCAM_TIMESTAMP_SOURCE_START_OF_EXPOSURE;
+        return;
+    }
+
+    // end of frame timestamps include the transfer time,
+    // the frame sync event is closer to the exposure
+    if (auto sync_ns = find_frame_sync_stamp(buf.sequence); sync_ns != 0 && sync_ns <= buffer_ns)
+    {
+        m_statistics.capture_time_ns = sync_ns;
+        m_statistics.timestamp_source = TCAM_TIMESTAMP_SOURCE_START_OF_FRAME;
+        return;
+    }
+
+    m_statistics.capture_time_ns = buffer_ns;
+    m_statistics.timestamp_source = TCAM_TIMESTAMP_SOURCE_END_OF_FRAME;
+}
+
+
+void V4l2Device::update_uvc_metadata_times(const struct v4l2_buffer& buf)
+{
+    m_statistics.camera_time_ns = 0;
+
+    if (!m_uvc_metadata)
+    {
+        return;
+    }
+
+    // uvcvideo completes the metadata buffer before the video buffer of a frame
+    m_uvc_metadata->drain();
+
+    auto times = m_uvc_metadata->take(buf.sequence);
+    if (!times)
+    {
+        return;
+    }
+
+    m_statistics.camera_time_ns = times->camera_time_ns;
+    if (times->exposure_start_ns != 0)
+    {
+        m_statistics.capture_time_ns = times->exposure_start_ns;
+        m_statistics.timestamp_source = TCAM_TIMESTAMP_SOURCE_START_OF_EXPOSURE;
+    }
+}
+
+
+void V4l2Device::account_sequence_gap(const struct v4l2_buffer& buf)
+{
+    const bool had_last = m_has_last_sequence;
+    const uint32_t last = m_last_sequence;
+
+    m_has_last_sequence = true;
+    m_last_sequence = buf.sequence;
+
+    const uint64_t timeouts = m_timeouts_since_last_image;
+    m_timeouts_since_last_image = 0;
+
+    // unsigned arithmetic handles the wrap around
+    const uint32_t missing = had_last ? buf.sequence - last - 1 : 0;
+    // the empty buffers of the stream start are not counted as drops
+    if (missing == 0 || missing > (uint32_t)INT32_MAX || !m_already_received_valid_image)
+    {
+        return;
+    }
+
+    // the driver drops frames when it owns no buffer,
+    // which only happens when the consumer holds all of them
+    if (m_queue_ran_empty)
+    {
+        m_statistics.drops.no_buffer += missing;
     }
     else
     {
-        buf.memory = V4L2_MEMORY_MMAP;
+        m_statistics.drops.transport += missing;
+    }
+
+    // frames that were lost while we waited are already counted by on_stream_timeout
+    if (missing > timeouts)
+    {
+        m_statistics.frames_dropped += missing - timeouts;
     }
+
+    TCAM_DEBUG_RATE_LIMITED("{} frame(s) before sequence {} were lost, {}.",
+                            missing,
+                            buf.sequence,
+                            m_queue_ran_empty ? "no buffer was queued" : "buffers were queued");
+}
+
+
+bool V4l2Device::get_frame(bool* would_block)
+{
+    TCAM_TRACE_SCOPE("V4l2Device::get_frame");
+
+    struct v4l2_buffer buf = {};
+
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = to_v4l2_memory(pool_->get_memory_type());
+
     int ret = tcam_xioctl(m_fd, VIDIOC_DQBUF, &buf);
 
     if (ret == -1)
     {
+        if (would_block)
+        {
+            *would_block = (errno == EAGAIN);
+        }
         SPDLOG_TRACE("Unable to dequeue buffer.");
         return false;
     }
 
+    m_statistics.dequeue_time_ns = tcam::latency::stamp();
+
     auto& image_buffer = m_buffers.at(buf.index);
 
     image_buffer.is_queued = false;
 
+    account_sequence_gap(buf);
+    // only a dequeue takes a buffer from the driver,
+    // so this tells whether it owned none at some point before the next image
+    m_queue_ran_empty = (--m_queued_buffer_count <= 0);
+
     // buf.bytesused
     /* The number of bytes occupied by the data in the buffer. It depends on
        the negotiated data format and may change with each buffer for compressed
@@ -1342,25 +2040,33 @@ bool V4l2Device::get_frame()
         {
             if (m_already_received_valid_image)
             {
-                SPDLOG_ERROR("Buffer has wrong size. Got: {} Expected: {} Dropping...",
-                             buf.bytesused,
-                             this->m_active_video_format.get_required_buffer_size());
+                TCAM_ERROR_RATE_LIMITED("Buffer has wrong size. Got: {} Expected: {} Dropping...",
+                                        buf.bytesused,
+                                        this->m_active_video_format.get_required_buffer_size());
+
+                m_statistics.frames_dropped++;
+                m_statistics.drops.incomplete++;
             }
             //SPDLOG_ERROR("error requeue");
-            requeue_buffer(image_buffer.buffer.lock());
+            requeue_buffer(pool_->get_buffer_at(buf.index));
             return true;
         }
     }
+    update_capture_time(buf);
+    update_uvc_metadata_times(buf);
+    if (!m_already_received_valid_image)
+    {
+        SPDLOG_INFO("Image timestamps are taken at the {}",
+                    timestamp_source_to_string(m_statistics.timestamp_source));
+    }
     m_already_received_valid_image = true;
-    // v4l2 timestamps contain seconds and microseconds
-    // here they are converted to nanoseconds
-    m_statistics.capture_time_ns =
-        ((long long)buf.timestamp.tv_sec * 1000 * 1000 * 1000) + (buf.timestamp.tv_usec * 1000);
     m_statistics.frame_count++;
-    auto b = image_buffer.buffer.lock();
+    const auto& b = pool_->get_buffer_at(buf.index);
     b->set_statistics(m_statistics);
     b->set_valid_data_length(buf.bytesused);
 
+    TCAM_USDT_PROBE(frame_dequeue, m_statistics.frame_count, b.get());
+
     //SPDLOG_INFO("pushing new buffer");
 
     if (auto ptr = m_listener.lock())
@@ -1369,7 +2075,7 @@ bool V4l2Device::get_frame()
     }
     else
     {
-        SPDLOG_ERROR("ImageSink expired. Unable to deliver images.");
+        TCAM_ERROR_RATE_LIMITED("ImageSink expired. Unable to deliver images.");
         return false;
     }
 
@@ -1406,7 +2112,7 @@ void V4l2Device::init_userptr_buffers()
         buf.memory = V4L2_MEMORY_USERPTR;
         buf.index = i;
 
-        auto b = m_buffers.at(i).buffer.lock();
+        const auto& b = pool_->get_buffer_at(i);
 
         buf.m.userptr = (unsigned long)b->get_image_buffer_ptr();
         buf.length = b->get_image_buffer_size();
@@ -1461,7 +2167,7 @@ void V4l2Device::init_mmap_buffers()
 
     for (unsigned int i = 0; i < m_buffers.size(); ++i)
     {
-        if (queue_mmap(i, m_buffers.at(i).buffer.lock()))
+        if (queue_mmap(i, pool_->get_buffer_at(i)))
         {
             m_buffers.at(i).is_queued = true;
         }
@@ -1469,25 +2175,37 @@ void V4l2Device::init_mmap_buffers()
 }
 
 
-void V4l2Device::init_dma_buffers()
+bool V4l2Device::init_dma_buffers()
 {
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
-    {
-        struct v4l2_buffer buf = {};
+    struct v4l2_requestbuffers req = {};
 
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        buf.index = i;
-        // TODO: pass dma fd
-        // buf.m.fd = dmafd;
+    req.count = m_buffers.size();
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_DMABUF;
 
-        if (tcam_xioctl(m_fd, VIDIOC_QBUF, &buf) == -1)
+    if (-1 == tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req))
+    {
+        SPDLOG_ERROR("{} does not support dmabuf import: {}", device.get_serial(), strerror(errno));
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    {
+        if (!queue_dma(i, pool_->get_buffer_at(i)))
         {
-            perror("VIDIOC_QBUF");
-            return;
+            // the imported fds are owned by the pool, there is nothing to fall back to
+            // release the buffers already queued, so that the next start begins empty
+            req.count = 0;
+            tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req);
+            for (auto& b : m_buffers)
+            {
+                b.is_queued = false;
+            }
+            return false;
         }
-
+        m_buffers.at(i).is_queued = true;
     }
+    return true;
 }
 
 
@@ -1506,84 +2224,15 @@ tcam_image_size V4l2Device::get_sensor_size() const
 }
 
 
-void V4l2Device::monitor_v4l2_thread_func()
+void V4l2Device::on_device_removed()
 {
-    tcam::set_thread_name( "tcam_v4l2_mon" );
-    auto udev = udev_new();
-    if (!udev)
+    // the loop keeps delivering events until we deregister
+    // only report the loss once
+    if (m_device_removed.exchange(true))
     {
-        SPDLOG_ERROR("Failed to create udev context");
         return;
     }
 
-    /* Set up a monitor to monitor hidraw devices */
-    auto mon = udev_monitor_new_from_netlink(udev, "udev");
-    if (!mon)
-    {
-        SPDLOG_ERROR("Failed to create udev monitor");
-        udev_unref(udev);
-        return;
-    }
-    udev_monitor_filter_add_match_subsystem_devtype(mon, "video4linux", NULL);
-    udev_monitor_enable_receiving(mon);
-    /* Get the file descriptor (fd) for the monitor.
-       This fd will get passed to select() */
-    int udev_fd = udev_monitor_get_fd(mon);
-
-    /* This section will run continuously, calling usleep() at
-       the end of each pass. This is to demonstrate how to use
-       a udev_monitor in a non-blocking way. */
-    while (!m_stop_monitor_v4l2_thread)
-    {
-        /* Set up the call to select(). In this case, select() will
-           only operate on a single file descriptor, the one
-           associated with our udev_monitor. Note that the timeval
-           object is set to 0, which will cause select() to not
-           block. */
-        fd_set fds;
-        int select_fd = udev_fd + 1;
-
-        FD_ZERO(&fds);
-        FD_SET(udev_fd, &fds);
-
-        struct timeval tv;
-        tv.tv_sec = 1;
-        tv.tv_usec = 0;
-
-        int ret = select(select_fd, &fds, NULL, NULL, &tv);
-
-        /* Check if our file descriptor has received data. */
-        if (ret > 0 && FD_ISSET(udev_fd, &fds))
-        {
-            /* Make the call to receive the device.
-               select() ensured that this will not block. */
-            auto dev = udev_monitor_receive_device(mon);
-            if (dev)
-            {
-                if (strcmp(udev_device_get_devnode(dev), device.get_identifier().c_str()) == 0)
-                {
-                    if (strcmp(udev_device_get_action(dev), "remove") == 0)
-                    {
-                        SPDLOG_ERROR("Lost device! {}", device.get_name().c_str());
-                        this->lost_device();
-                        break;
-                    }
-                    else
-                    {
-                        SPDLOG_WARN("Received an event for device: '{}' This should not happen.",
-                                    udev_device_get_action(dev));
-                    }
-                }
-
-                udev_device_unref(dev);
-            }
-            else
-            {
-                SPDLOG_ERROR("No Device from udev_monitor_receive_device. An error occured.");
-            }
-        }
-    }
-
-    udev_monitor_unref(mon);
-    udev_unref(udev);
+    SPDLOG_ERROR("Lost device! {}", device.get_name().c_str());
+    this->lost_device();
 }
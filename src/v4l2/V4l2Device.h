@@ -23,7 +23,9 @@
 #include "../BufferPool.h"
 #include "V4L2PropertyBackend.h"
 #include "V4L2Allocator.h"
+#include "v4l2_format_cache.h"
 
+#include <array>
 #include <atomic>
 #include <condition_variable> // std::condition_variable
 #include <linux/videodev2.h>
@@ -38,6 +40,7 @@ namespace tcam
 namespace v4l2
 {
 class prop_impl_offset_auto_center;
+class uvc_metadata_stream;
 }
 
 
@@ -57,6 +60,12 @@ public:
         return m_properties;
     }
 
+    // writes are coalesced into a single VIDIOC_S_EXT_CTRLS
+    std::unique_ptr<tcam::property::IPropertyTransaction> begin_property_transaction() final
+    {
+        return p_property_backend->begin_transaction();
+    }
+
     bool set_video_format(const VideoFormat&) override;
 
     VideoFormat get_active_video_format() const override;
@@ -82,13 +91,34 @@ public:
 
     void stop_stream() final;
 
+    // the stream is handled by the shared V4l2EventLoop, only the buffers are placed on it
+    int get_numa_node() final;
+
 private:
     std::atomic<bool> m_is_stream_on { false };
 
-    std::thread m_work_thread;
-
     int m_fd = -1;
 
+    // registrations with the shared V4l2EventLoop
+    int m_stream_event_id = -1;
+    int m_timeout_event_id = -1;
+    int m_lost_event_id = -1;
+
+    // timerfd used to detect missing images
+    int m_timeout_fd = -1;
+
+    // with TCAM_BUSY_POLL the stream is handled by this thread instead of the V4l2EventLoop
+    std::thread m_busy_poll_thread;
+    std::atomic<bool> m_busy_poll_running { false };
+    // eventfd, ends the blocking waits of m_busy_poll_thread
+    int m_busy_poll_wakeup_fd = -1;
+
+    // payload header timestamps while streaming with TCAM_V4L2_UVC_METADATA, nullptr otherwise
+    std::unique_ptr<v4l2::uvc_metadata_stream> m_uvc_metadata;
+
+    // registration with the UsbBandwidthPlanner while streaming, -1 otherwise
+    int m_usb_bandwidth_id = -1;
+
     VideoFormat m_active_video_format;
 
     std::vector<VideoFormatDescription> m_available_videoformats;
@@ -111,16 +141,29 @@ private:
 
     std::shared_ptr<tcam::AllocatorInterface> allocator_ = nullptr;
 
-    std::thread m_monitor_v4l2_thread;
-    std::atomic<bool> m_stop_monitor_v4l2_thread { false };
+    std::atomic<bool> m_device_removed { false };
 
-    void monitor_v4l2_thread_func();
+    void on_device_removed();
 
     void notify_device_lost_func();
 
     void lost_device();
 
-    void update_stream_timeout();
+    // stream state that is tracked through the write observers of the properties,
+    // the event loop callbacks never read controls
+    std::atomic<bool> m_trigger_mode_enabled { false };
+    std::atomic<int64_t> m_exposure_time_us { 0 };
+    // software triggers that have not produced an image
+    std::atomic<int> m_pending_software_triggers { 0 };
+
+    void register_stream_state_observers();
+    // seeds the state above when the stream starts, the camera may have changed it on its own
+    void read_stream_state();
+    bool consume_pending_software_trigger();
+
+    // needs the buffers and read_stream_state, may lower the framerate before VIDIOC_STREAMON
+    void register_usb_bandwidth();
+    void unregister_usb_bandwidth();
 
 
     struct override_mapping
@@ -143,6 +186,9 @@ private:
 
     void determine_scaling();
     void generate_scales();
+    // fills m_scale.scales/override_index by trying every 'Scanning Mode Selector' value
+    // false when a mode could not be probed
+    bool probe_override_scanning_modes();
     bool set_scaling(const image_scaling& scale);
     image_scaling get_current_scaling();
 
@@ -154,12 +200,22 @@ private:
      */
     void index_formats();
 
-    std::vector<double> index_framerates(const struct v4l2_frmsizeenum& frms);
+    // the VIDIOC_ENUM_* part of index_formats
+    std::vector<v4l2::enumerated_format> enumerate_formats();
+    std::vector<v4l2_fract> enumerate_frame_intervals(const struct v4l2_frmsizeenum& frms);
+
+    std::vector<double> index_framerates(const std::vector<v4l2_fract>& intervals);
 
     void determine_active_video_format();
 
-    bool load_extension_unit();
+    // mappings are loaded from extension_file when empty
+    bool load_extension_unit(const std::string& extension_file,
+                             std::vector<tcam::uvc::description>& mappings);
     bool extension_unit_is_loaded();
+    // only queries the first extension unit control of known
+    bool extension_unit_is_loaded(const std::vector<v4l2_queryctrl>& known);
+
+    std::vector<v4l2_queryctrl> query_controls();
 
     void generate_properties( const std::vector<v4l2_queryctrl>& qctrl_list );
     void create_properties();
@@ -173,39 +229,84 @@ private:
     // on initial startup all buffers are received once, but empty
     // this causes unnecessary error messages
     // filter those messages until we receive one valid image
-    bool m_already_received_valid_image = false;
+    std::atomic<bool> m_already_received_valid_image = false;
 
     tcam_stream_statistics m_statistics = {};
 
+    // buffers the driver currently owns, to tell consumer lag from transport loss
+    std::atomic<int> m_queued_buffer_count { 0 };
+    // only touched from the event loop thread
+    bool m_queue_ran_empty = false;
+    bool m_has_last_sequence = false;
+    uint32_t m_last_sequence = 0;
+    // timeouts since the last image, already part of frames_dropped
+    uint64_t m_timeouts_since_last_image = 0;
+
+    // classifies the frames missing between the last and this buffer
+    void account_sequence_gap(const struct v4l2_buffer& buf);
+
+    // V4L2_EVENT_FRAME_SYNC, subscribed while streaming when the driver supports it
+    bool m_frame_sync_subscribed = false;
+
+    // the event arrives before the image, only touched from the event loop thread
+    struct frame_sync_stamp
+    {
+        uint32_t sequence = 0;
+        uint64_t timestamp_ns = 0;
+    };
+    std::array<frame_sync_stamp, 8> m_frame_sync_stamps = {};
+    size_t m_frame_sync_next = 0;
+
+    bool subscribe_frame_sync();
+    void unsubscribe_frame_sync();
+    void on_frame_event();
+    // 0 when no event was received for sequence
+    uint64_t find_frame_sync_stamp(uint32_t sequence) const;
+    // fills capture_time_ns and timestamp_source of m_statistics
+    void update_capture_time(const struct v4l2_buffer& buf);
+    // camera_time_ns and the start of exposure from the UVC payload header of buf
+    void update_uvc_metadata_times(const struct v4l2_buffer& buf);
+
     std::shared_ptr<BufferPool> pool_;
 
+    // in pool order, the ImageBuffer of an entry is pool_->get_buffer_at(index)
     struct buffer_info
     {
-        std::weak_ptr<ImageBuffer> buffer;
         bool is_queued = false;
     };
 
-    std::atomic<int> m_stream_timeout_sec { 10 };
-
     std::vector<buffer_info> m_buffers;
 
     std::weak_ptr<IImageBufferSink> m_listener;
 
     std::shared_ptr<tcam::v4l2::prop_impl_offset_auto_center>   software_auto_center_;
 
-    void stream();
+    int m_lost_countdown = 0;
+    int m_log_repetition_counter = 0;
 
-    bool get_frame();
+    void on_frame_ready();
+    // bookkeeping after a dequeue attempt that did not only find an empty queue
+    void on_dequeue_result(bool received);
+    void on_stream_timeout();
+    // exposure time and frame period, disarmed while triggered without a pending software trigger
+    void arm_stream_timeout();
+    int64_t calc_stream_timeout_us() const;
+    void check_lost_countdown();
+
+    // would_block is set when no buffer was ready, nothing else is changed in that case
+    bool get_frame(bool* would_block = nullptr);
+
+    bool start_busy_poll_thread();
+    void stop_busy_poll_thread();
+    void busy_poll_stream();
 
     void init_userptr_buffers();
     void init_mmap_buffers();
-    void init_dma_buffers();
-
-    bool queue_dma(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_mmap(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_userptr(int i, std::shared_ptr<ImageBuffer>);
+    bool init_dma_buffers();
 
-    bool is_trigger_mode_enabled();
+    bool queue_dma(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_mmap(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_userptr(int i, const std::shared_ptr<ImageBuffer>&);
 
     tcam_image_size get_sensor_size() const;
 };
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "V4l2EventLoop.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <cstring>
+#include <libudev.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace tcam::v4l2;
+
+namespace
+{
+
+// registration ids start at 1
+// these values are used for the fds owned by the loop itself
+constexpr uint64_t wakeup_event_id = 0;
+constexpr uint64_t udev_event_id = UINT64_MAX;
+
+constexpr int max_events = 16;
+
+} // namespace
+
+
+V4l2EventLoop& V4l2EventLoop::get_instance()
+{
+    static V4l2EventLoop loop;
+    return loop;
+}
+
+
+V4l2EventLoop::~V4l2EventLoop()
+{
+    stop_thread();
+}
+
+
+bool V4l2EventLoop::start_thread()
+{
+    // mtx_ is held by the caller
+    if (continue_thread_)
+    {
+        return true;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1)
+    {
+        SPDLOG_ERROR("Unable to create epoll instance: {}", strerror(errno));
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd_ == -1)
+    {
+        SPDLOG_ERROR("Unable to create eventfd: {}", strerror(errno));
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+        return false;
+    }
+
+    struct epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = wakeup_event_id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+
+    udev_ = udev_new();
+    if (udev_)
+    {
+        udev_monitor_ = udev_monitor_new_from_netlink(udev_, "udev");
+    }
+    if (udev_monitor_)
+    {
+        udev_monitor_filter_add_match_subsystem_devtype(udev_monitor_, "video4linux", NULL);
+        udev_monitor_enable_receiving(udev_monitor_);
+
+        ev.data.u64 = udev_event_id;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, udev_monitor_get_fd(udev_monitor_), &ev);
+    }
+    else
+    {
+        SPDLOG_ERROR("Failed to create udev monitor. Device loss will not be detected.");
+    }
+
+    continue_thread_ = true;
+    thread_ = std::thread(&V4l2EventLoop::run, this);
+
+    return true;
+}
+
+
+void V4l2EventLoop::stop_thread()
+{
+    {
+        std::scoped_lock lock(mtx_);
+        if (!continue_thread_)
+        {
+            return;
+        }
+        continue_thread_ = false;
+    }
+
+    uint64_t val = 1;
+    if (write(wakeup_fd_, &val, sizeof(val)) != sizeof(val))
+    {
+        SPDLOG_WARN("Unable to wake event loop: {}", strerror(errno));
+    }
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    if (udev_monitor_)
+    {
+        udev_monitor_unref(udev_monitor_);
+        udev_monitor_ = nullptr;
+    }
+    if (udev_)
+    {
+        udev_unref(udev_);
+        udev_ = nullptr;
+    }
+
+    close(wakeup_fd_);
+    wakeup_fd_ = -1;
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+}
+
+
+int V4l2EventLoop::add_fd(int fd, callback cb)
+{
+    return add_fd(fd, std::move(cb), {});
+}
+
+
+int V4l2EventLoop::add_fd(int fd, callback cb, callback priority_cb)
+{
+    std::scoped_lock lock(mtx_);
+
+    if (!start_thread())
+    {
+        return -1;
+    }
+
+    const int id = next_id_++;
+
+    struct epoll_event ev = {};
+    ev.events = priority_cb ? (EPOLLIN | EPOLLPRI) : EPOLLIN;
+    ev.data.u64 = id;
+
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        SPDLOG_ERROR("Unable to add fd {} to epoll: {}", fd, strerror(errno));
+        return -1;
+    }
+
+    entries_[id] = { fd, {}, std::move(cb), std::move(priority_cb) };
+
+    return id;
+}
+
+
+int V4l2EventLoop::add_device_removed_cb(const std::string& devnode, callback cb)
+{
+    std::scoped_lock lock(mtx_);
+
+    if (!start_thread())
+    {
+        return -1;
+    }
+
+    const int id = next_id_++;
+
+    entries_[id] = { -1, devnode, std::move(cb), {} };
+
+    return id;
+}
+
+
+int V4l2EventLoop::add_hotplug_cb(callback cb)
+{
+    std::scoped_lock lock(mtx_);
+
+    if (!start_thread())
+    {
+        return -1;
+    }
+
+    if (!udev_monitor_)
+    {
+        // hotplug events can not be delivered, the caller has to poll
+        return -1;
+    }
+
+    const int id = next_id_++;
+
+    entries_[id] = { -1, {}, std::move(cb), {} };
+
+    return id;
+}
+
+
+void V4l2EventLoop::remove(int id)
+{
+    std::unique_lock lock(mtx_);
+
+    auto iter = entries_.find(id);
+    if (iter == entries_.end())
+    {
+        return;
+    }
+
+    if (iter->second.fd != -1)
+    {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, iter->second.fd, nullptr);
+    }
+    entries_.erase(iter);
+
+    // callbacks may remove themselves, e.g. when a lost device is closed
+    if (std::this_thread::get_id() != thread_.get_id())
+    {
+        dispatch_done_.wait(lock, [this, id] { return dispatching_id_ != id; });
+    }
+}
+
+
+void V4l2EventLoop::dispatch(int id, bool priority)
+{
+    callback cb;
+    {
+        std::scoped_lock lock(mtx_);
+
+        // the registration may have been removed
+        // while its event was already pending
+        auto iter = entries_.find(id);
+        if (iter == entries_.end())
+        {
+            return;
+        }
+        cb = priority ? iter->second.priority_cb : iter->second.cb;
+        if (!cb)
+        {
+            return;
+        }
+        dispatching_id_ = id;
+    }
+
+    cb();
+
+    {
+        std::scoped_lock lock(mtx_);
+        dispatching_id_ = -1;
+    }
+    dispatch_done_.notify_all();
+}
+
+
+void V4l2EventLoop::handle_udev_event()
+{
+    auto dev = udev_monitor_receive_device(udev_monitor_);
+    if (!dev)
+    {
+        SPDLOG_ERROR("No Device from udev_monitor_receive_device. An error occured.");
+        return;
+    }
+
+    const char* devnode = udev_device_get_devnode(dev);
+    const char* action = udev_device_get_action(dev);
+
+    const bool is_hotplug =
+        action && (strcmp(action, "add") == 0 || strcmp(action, "remove") == 0);
+
+    std::vector<int> ids;
+    std::vector<int> hotplug_ids;
+    {
+        std::scoped_lock lock(mtx_);
+        for (const auto& [id, e] : entries_)
+        {
+            if (e.fd != -1)
+            {
+                continue;
+            }
+            if (e.devnode.empty())
+            {
+                if (is_hotplug)
+                {
+                    hotplug_ids.push_back(id);
+                }
+            }
+            else if (devnode && e.devnode == devnode)
+            {
+                ids.push_back(id);
+            }
+        }
+    }
+
+    if (!ids.empty())
+    {
+        if (action && strcmp(action, "remove") == 0)
+        {
+            for (auto id : ids)
+            {
+                dispatch(id);
+            }
+        }
+        else
+        {
+            SPDLOG_WARN("Received an event for device: '{}' This should not happen.",
+                        action ? action : "");
+        }
+    }
+
+    for (auto id : hotplug_ids)
+    {
+        dispatch(id);
+    }
+
+    udev_device_unref(dev);
+}
+
+
+void V4l2EventLoop::run()
+{
+    tcam::set_thread_name("tcam_v4l2_loop");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    struct epoll_event events[max_events];
+
+    while (true)
+    {
+        int count = epoll_wait(epoll_fd_, events, max_events, -1);
+
+        if (count == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue; // intermittent wake, continue
+            }
+            SPDLOG_ERROR("Error during epoll_wait. errno: {} ({})", errno, strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto id = events[i].data.u64;
+
+            if (id == wakeup_event_id)
+            {
+                uint64_t val = 0;
+                if (read(wakeup_fd_, &val, sizeof(val)) == -1)
+                {
+                    // nothing to do, the loop state is checked below
+                }
+            }
+            else if (id == udev_event_id)
+            {
+                handle_udev_event();
+            }
+            else
+            {
+                // only set for registrations with a priority callback
+                if (events[i].events & EPOLLPRI)
+                {
+                    dispatch(static_cast<int>(id), true);
+                }
+                if (events[i].events & ~EPOLLPRI)
+                {
+                    dispatch(static_cast<int>(id));
+                }
+            }
+        }
+
+        std::scoped_lock lock(mtx_);
+        if (!continue_thread_)
+        {
+            return;
+        }
+    }
+}
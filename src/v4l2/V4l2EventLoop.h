@@ -0,0 +1,127 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TCAM_V4L2_EVENTLOOP_H
+#define TCAM_V4L2_EVENTLOOP_H
+
+#include "../compiler_defines.h"
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct udev;
+struct udev_monitor;
+
+VISIBILITY_INTERNAL
+
+namespace tcam::v4l2
+{
+
+/**
+ * Single epoll based event loop that is shared by all V4l2Device instances.
+ *
+ * Devices register their video fd and timeout timerfd for streaming,
+ * and a callback for udev 'remove' events of their device node.
+ * The backend registers a hotplug callback for the device indexer.
+ * All callbacks are invoked from the loop thread.
+ */
+class V4l2EventLoop
+{
+public:
+    using callback = std::function<void()>;
+
+    static V4l2EventLoop& get_instance();
+
+    ~V4l2EventLoop();
+
+    /**
+     * Invoke cb every time fd becomes readable.
+     * @return registration id, -1 on error
+     */
+    int add_fd(int fd, callback cb);
+
+    /**
+     * Like add_fd, priority_cb is additionally invoked for EPOLLPRI,
+     * which v4l2 uses to signal pending events (VIDIOC_DQEVENT).
+     * priority_cb is invoked before cb when both are pending.
+     * @return registration id, -1 on error
+     */
+    int add_fd(int fd, callback cb, callback priority_cb);
+
+    /**
+     * Invoke cb when udev reports the removal of devnode.
+     * @return registration id, -1 on error
+     */
+    int add_device_removed_cb(const std::string& devnode, callback cb);
+
+    /**
+     * Invoke cb when udev reports that any video4linux device was added or removed.
+     * @return registration id, -1 on error
+     */
+    int add_hotplug_cb(callback cb);
+
+    /**
+     * Remove a registration.
+     * When called from outside the loop thread this waits
+     * for a currently running callback of this registration to finish.
+     */
+    void remove(int id);
+
+private:
+    V4l2EventLoop() = default;
+
+    struct entry
+    {
+        int fd = -1;
+        // empty together with fd == -1 for hotplug callbacks
+        std::string devnode;
+        callback cb;
+        callback priority_cb;
+    };
+
+    bool start_thread();
+    void stop_thread();
+
+    void run();
+    void dispatch(int id, bool priority = false);
+    void handle_udev_event();
+
+    std::mutex mtx_;
+    std::condition_variable dispatch_done_;
+
+    std::thread thread_;
+    bool continue_thread_ = false;
+
+    int epoll_fd_ = -1;
+    int wakeup_fd_ = -1;
+
+    udev* udev_ = nullptr;
+    udev_monitor* udev_monitor_ = nullptr;
+
+    int next_id_ = 1;
+    int dispatching_id_ = -1;
+    std::map<int, entry> entries_;
+};
+
+} // namespace tcam::v4l2
+
+VISIBILITY_POP
+
+#endif /* TCAM_V4L2_EVENTLOOP_H */
@@ -23,10 +23,13 @@
 #include <fcntl.h>
 #include <fstream>
 #include <limits.h> // LONG_MAX
+#include <map>
+#include <mutex>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_set>
 #include <uuid/uuid.h>
 #include <stdlib.h> // getenv
 
@@ -58,10 +61,30 @@ int tcam::uvc::map(int fd, uvc_xu_control_mapping* ctrl)
 }
 
 
+// ids of all controls the device already has
+// one enumeration is cheaper than letting every mapping fail with EEXIST
+static std::unordered_set<__u32> query_control_ids(int fd)
+{
+    std::unordered_set<__u32> ids;
+
+    v4l2_queryctrl qctrl = {};
+    qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
+
+    while (xioctl(fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
+    {
+        ids.insert(qctrl.id);
+        qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
+    }
+    return ids;
+}
+
+
 void tcam::uvc::apply_mappings(int fd,
                                std::vector<tcam::uvc::description>& mappings,
                                std::function<void(const std::string&)> cb)
 {
+    // uvcvideo only accepts one mapping per UVCIOC_CTRL_MAP,
+    // so everything is prepared first and the ioctls are issued back to back
     for (auto& m : mappings)
     {
         if (m.mapping.v4l2_type == V4L2_CTRL_TYPE_MENU)
@@ -69,6 +92,17 @@ void tcam::uvc::apply_mappings(int fd,
             m.mapping.menu_info = m.entries.data();
             m.mapping.menu_count = m.entries.size();
         }
+    }
+
+    const auto existing = query_control_ids(fd);
+
+    for (auto& m : mappings)
+    {
+        if (existing.count(m.mapping.id))
+        {
+            // mapped by an earlier run, e.g. the udev rule
+            continue;
+        }
 
         int ret = map(fd, &m.mapping);
 
@@ -248,10 +282,12 @@ std::string tcam::uvc::determine_extension_file(const std::string& pid_in)
 }
 
 
-std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
+static std::vector<tcam::uvc::description> parse_description_file(
     const std::string& filename,
     std::function<void(const std::string&)> cb)
 {
+    using tcam::uvc::description;
+
     static const int max_string_length = 31;
 
     uuid_t guid;
@@ -357,3 +393,63 @@ std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
 
     return mappings;
 }
+
+
+namespace
+{
+
+struct parsed_file
+{
+    // the file changed when one of these differs
+    time_t mtime = 0;
+    off_t size = 0;
+
+    std::vector<tcam::uvc::description> mappings;
+    // replayed for every caller, they all see the same warnings
+    std::vector<std::string> messages;
+};
+
+std::mutex parsed_files_mtx;
+std::map<std::string, parsed_file> parsed_files;
+
+} // namespace
+
+
+std::vector<tcam::uvc::description> tcam::uvc::load_description_file(
+    const std::string& filename,
+    std::function<void(const std::string&)> cb)
+{
+    // opening several cameras of the same type parses their file only once
+    struct stat st = {};
+    if (stat(filename.c_str(), &st) != 0)
+    {
+        return {};
+    }
+
+    std::scoped_lock lck { parsed_files_mtx };
+
+    auto iter = parsed_files.find(filename);
+    if (iter == parsed_files.end() || iter->second.mtime != st.st_mtime
+        || iter->second.size != st.st_size)
+    {
+        parsed_file entry;
+        entry.mtime = st.st_mtime;
+        entry.size = st.st_size;
+        entry.mappings = parse_description_file(
+            filename, [&entry](const std::string& msg) { entry.messages.push_back(msg); });
+
+        if (entry.mappings.empty())
+        {
+            // keep failures out of the cache, the file may be fixed in place
+            for (const auto& msg : entry.messages) { cb(msg); }
+            parsed_files.erase(filename);
+            return {};
+        }
+        iter = parsed_files.insert_or_assign(filename, std::move(entry)).first;
+    }
+
+    for (const auto& msg : iter->second.messages) { cb(msg); }
+
+    // menu pointers are set by apply_mappings on the copy
+    return iter->second.mappings;
+}
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "uvc_metadata.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <glob.h>
+#include <iterator>
+#include <linux/usb/ch9.h>
+#include <linux/usb/video.h>
+#include <linux/uvcvideo.h>
+#include <linux/videodev2.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace tcam::v4l2;
+
+namespace
+{
+
+constexpr unsigned int metadata_buffer_count = 8;
+
+// the driver copies the payload header from bHeaderLength on,
+// so a block is the host fields followed by length header bytes
+constexpr size_t meta_block_prefix = offsetof(struct uvc_meta_buf, length);
+
+// the estimation ends after this baseline, later changes would bend the device time line
+constexpr uint64_t estimation_min_ns = 1000ull * 1000 * 1000;
+constexpr uint64_t estimation_max_ns = 10 * estimation_min_ns;
+
+uint32_t read_le32(const uint8_t* p) noexcept
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)
+           | ((uint32_t)p[3] << 24);
+}
+
+uint16_t read_le16(const uint8_t* p) noexcept
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+std::string node_name(const std::string& node)
+{
+    const auto pos = node.rfind('/');
+    return pos == std::string::npos ? node : node.substr(pos + 1);
+}
+
+// dwClockFrequency of the VideoControl interface header, 0 when the device reports none
+uint64_t read_clock_frequency(const std::string& video_name)
+{
+    // device is the usb interface, its parent the usb device with the raw descriptors
+    std::ifstream file("/sys/class/video4linux/" + video_name + "/device/../descriptors",
+                       std::ios::binary);
+    if (!file)
+    {
+        return 0;
+    }
+    const std::vector<uint8_t> desc { std::istreambuf_iterator<char>(file),
+                                      std::istreambuf_iterator<char>() };
+
+    bool in_video_control = false;
+    for (size_t i = 0; i + 2 <= desc.size();)
+    {
+        const size_t length = desc[i];
+        const uint8_t type = desc[i + 1];
+        if (length < 2 || i + length > desc.size())
+        {
+            break;
+        }
+
+        if (type == USB_DT_INTERFACE && length >= 9)
+        {
+            in_video_control = desc[i + 5] == USB_CLASS_VIDEO && desc[i + 6] == UVC_SC_VIDEOCONTROL;
+        }
+        else if (in_video_control && type == USB_DT_CS_INTERFACE && length >= 11
+                 && desc[i + 2] == UVC_VC_HEADER)
+        {
+            return read_le32(&desc[i + 7]);
+        }
+        i += length;
+    }
+    return 0;
+}
+
+// the metadata node of the same usb interface, -1 when there is none
+int open_metadata_node(const std::string& video_name, std::string& node)
+{
+    glob_t result = {};
+    const auto pattern = "/sys/class/video4linux/" + video_name + "/device/video4linux/video*";
+    if (glob(pattern.c_str(), 0, nullptr, &result) != 0)
+    {
+        globfree(&result);
+        return -1;
+    }
+
+    int ret = -1;
+    for (size_t i = 0; i < result.gl_pathc && ret == -1; ++i)
+    {
+        const auto name = node_name(result.gl_pathv[i]);
+        if (name == video_name)
+        {
+            continue;
+        }
+
+        const auto dev_node = "/dev/" + name;
+        int fd = ::open(dev_node.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd == -1)
+        {
+            SPDLOG_DEBUG("Unable to open {}: {}", dev_node, strerror(errno));
+            continue;
+        }
+
+        struct v4l2_capability cap = {};
+        struct v4l2_format fmt = {};
+        fmt.type = V4L2_BUF_TYPE_META_CAPTURE;
+        fmt.fmt.meta.dataformat = V4L2_META_FMT_UVC;
+
+        if (tcam::tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) == 0
+            && (cap.device_caps & V4L2_CAP_META_CAPTURE)
+            && (cap.device_caps & V4L2_CAP_STREAMING)
+            && tcam::tcam_xioctl(fd, VIDIOC_S_FMT, &fmt) == 0
+            && fmt.fmt.meta.dataformat == V4L2_META_FMT_UVC)
+        {
+            node = dev_node;
+            ret = fd;
+        }
+        else
+        {
+            ::close(fd);
+        }
+    }
+    globfree(&result);
+
+    return ret;
+}
+
+} // namespace
+
+
+uvc_metadata_stream::~uvc_metadata_stream()
+{
+    close();
+}
+
+
+bool uvc_metadata_stream::open(const std::string& video_node)
+{
+    close();
+
+    const auto video_name = node_name(video_node);
+
+    fd_ = open_metadata_node(video_name, node_);
+    if (fd_ == -1)
+    {
+        SPDLOG_WARN("{} has no usable UVC metadata node.", video_node);
+        return false;
+    }
+
+    struct v4l2_requestbuffers req = {};
+    req.count = metadata_buffer_count;
+    req.type = V4L2_BUF_TYPE_META_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (tcam::tcam_xioctl(fd_, VIDIOC_REQBUFS, &req) == -1 || req.count == 0)
+    {
+        SPDLOG_WARN("Unable to request buffers for {}: {}", node_, strerror(errno));
+        close();
+        return false;
+    }
+
+    for (unsigned int i = 0; i < req.count; ++i)
+    {
+        struct v4l2_buffer buf = {};
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (tcam::tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            SPDLOG_WARN("Unable to query buffer {} of {}: {}", i, node_, strerror(errno));
+            close();
+            return false;
+        }
+
+        void* data = mmap(nullptr, buf.length, PROT_READ, MAP_SHARED, fd_, buf.m.offset);
+        if (data == MAP_FAILED)
+        {
+            SPDLOG_WARN("Unable to map buffer {} of {}: {}", i, node_, strerror(errno));
+            close();
+            return false;
+        }
+        buffers_.push_back({ data, buf.length });
+    }
+
+    clock_frequency_ = read_clock_frequency(video_name);
+    frequency_from_descriptor_ = clock_frequency_ != 0;
+
+    SPDLOG_INFO("Capturing UVC payload headers from {}, the device clock {}",
+                node_,
+                frequency_from_descriptor_ ? fmt::format("runs at {} Hz", clock_frequency_)
+                                           : std::string("frequency is estimated"));
+
+    return true;
+}
+
+
+void uvc_metadata_stream::close()
+{
+    stop();
+
+    for (auto& b : buffers_) { munmap(b.data, b.length); }
+    buffers_.clear();
+
+    if (fd_ != -1)
+    {
+        struct v4l2_requestbuffers req = {};
+        req.type = V4L2_BUF_TYPE_META_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        tcam::tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
+
+        ::close(fd_);
+        fd_ = -1;
+    }
+    node_.clear();
+}
+
+
+bool uvc_metadata_stream::start()
+{
+    if (fd_ == -1 || is_streaming_)
+    {
+        return is_streaming_;
+    }
+
+    for (unsigned int i = 0; i < buffers_.size(); ++i)
+    {
+        struct v4l2_buffer buf = {};
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+
+        if (tcam::tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        {
+            SPDLOG_WARN("Unable to queue buffer {} of {}: {}", i, node_, strerror(errno));
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_META_CAPTURE;
+    if (tcam::tcam_xioctl(fd_, VIDIOC_STREAMON, &type) == -1)
+    {
+        SPDLOG_WARN("Unable to start {}: {}", node_, strerror(errno));
+        return false;
+    }
+    is_streaming_ = true;
+
+    has_pts_ = false;
+    pts_ticks_ = 0;
+    entries_ = {};
+    next_entry_ = 0;
+
+    if (!frequency_from_descriptor_)
+    {
+        clock_frequency_ = 0;
+        has_estimation_start_ = false;
+        estimation_ticks_ = 0;
+    }
+
+    return true;
+}
+
+
+void uvc_metadata_stream::stop()
+{
+    if (!is_streaming_)
+    {
+        return;
+    }
+
+    // returns all buffers to the application
+    v4l2_buf_type type = V4L2_BUF_TYPE_META_CAPTURE;
+    tcam::tcam_xioctl(fd_, VIDIOC_STREAMOFF, &type);
+    is_streaming_ = false;
+}
+
+
+void uvc_metadata_stream::drain()
+{
+    if (!is_streaming_)
+    {
+        return;
+    }
+
+    struct v4l2_buffer buf = {};
+    buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+
+    while (tcam::tcam_xioctl(fd_, VIDIOC_DQBUF, &buf) == 0)
+    {
+        if (!(buf.flags & V4L2_BUF_FLAG_ERROR) && buf.index < buffers_.size())
+        {
+            const auto& b = buffers_[buf.index];
+            parse((const uint8_t*)b.data, std::min<size_t>(buf.bytesused, b.length), buf.sequence);
+        }
+
+        if (tcam::tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        {
+            SPDLOG_WARN("Unable to requeue buffer {} of {}: {}",
+                        buf.index,
+                        node_,
+                        strerror(errno));
+        }
+
+        buf = {};
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+    }
+}
+
+
+std::optional<uvc_metadata_stream::frame_times> uvc_metadata_stream::take(uint32_t sequence)
+{
+    for (auto& e : entries_)
+    {
+        if (e.valid && e.sequence == sequence)
+        {
+            e.valid = false;
+            return e.times;
+        }
+    }
+    return std::nullopt;
+}
+
+
+void uvc_metadata_stream::parse(const uint8_t* data, size_t size, uint32_t sequence)
+{
+    // the first header of the frame has the PTS, the first SCR is the closest to it
+    std::optional<uint32_t> pts;
+    std::optional<uint32_t> stc;
+    uint16_t stc_sof = 0;
+    uint64_t stc_host_ns = 0;
+    uint16_t stc_host_sof = 0;
+
+    for (size_t offset = 0; offset + sizeof(struct uvc_meta_buf) <= size;)
+    {
+        struct uvc_meta_buf meta;
+        memcpy(&meta, data + offset, sizeof(meta));
+
+        const size_t block_size = meta_block_prefix + meta.length;
+        if (meta.length < 2 || offset + block_size > size)
+        {
+            break;
+        }
+
+        const uint8_t* header = data + offset + sizeof(struct uvc_meta_buf);
+        size_t header_size = meta.length - 2;
+        if ((meta.flags & UVC_STREAM_PTS) && header_size >= 4)
+        {
+            if (!pts)
+            {
+                pts = read_le32(header);
+            }
+            header += 4;
+            header_size -= 4;
+        }
+        if ((meta.flags & UVC_STREAM_SCR) && header_size >= 6 && !stc)
+        {
+            stc = read_le32(header);
+            stc_sof = read_le16(header + 4) & 0x7ff;
+            stc_host_ns = meta.ns;
+            stc_host_sof = meta.sof & 0x7ff;
+        }
+
+        offset += block_size;
+    }
+
+    if (stc)
+    {
+        estimate_frequency(*stc, stc_host_ns);
+    }
+
+    if (!pts)
+    {
+        return;
+    }
+
+    if (has_pts_)
+    {
+        // unsigned arithmetic handles the wrap around
+        pts_ticks_ += (uint32_t)(*pts - last_pts_);
+    }
+    else
+    {
+        pts_ticks_ = *pts;
+        has_pts_ = true;
+    }
+    last_pts_ = *pts;
+
+    if (clock_frequency_ == 0)
+    {
+        return;
+    }
+
+    frame_times times;
+    times.camera_time_ns = ticks_to_ns(pts_ticks_);
+
+    if (stc)
+    {
+        // the STC was sampled at the SOF token stc_sof, the driver received it in stc_host_sof
+        const unsigned int delay_ms = (stc_host_sof - stc_sof) & 0x7ff;
+        const uint32_t exposure_ticks = *stc - *pts;
+        const uint64_t host_ns = stc_host_ns - (delay_ms < 32 ? delay_ms * 1000000ull : 0);
+        const uint64_t exposure_ns = ticks_to_ns(exposure_ticks);
+
+        // the header is sent after the exposure started, anything above a second is garbage
+        if (exposure_ticks < clock_frequency_ && exposure_ns < host_ns)
+        {
+            times.exposure_start_ns = host_ns - exposure_ns;
+        }
+    }
+
+    entries_[next_entry_] = { true, sequence, times };
+    next_entry_ = (next_entry_ + 1) % entries_.size();
+}
+
+
+uint64_t uvc_metadata_stream::ticks_to_ns(uint64_t ticks) const noexcept
+{
+    // split so that the multiplication does not overflow, the remainder is below the frequency
+    const uint64_t seconds = ticks / clock_frequency_;
+    const uint64_t rest = ticks % clock_frequency_;
+    return seconds * 1000000000u + rest * 1000000000u / clock_frequency_;
+}
+
+
+void uvc_metadata_stream::estimate_frequency(uint32_t stc, uint64_t host_ns)
+{
+    if (frequency_from_descriptor_)
+    {
+        return;
+    }
+
+    if (!has_estimation_start_)
+    {
+        has_estimation_start_ = true;
+        estimation_start_ns_ = host_ns;
+        estimation_last_stc_ = stc;
+        estimation_ticks_ = 0;
+        return;
+    }
+
+    const uint64_t elapsed_ns = host_ns - estimation_start_ns_;
+    if (elapsed_ns > estimation_max_ns)
+    {
+        return;
+    }
+
+    estimation_ticks_ += (uint32_t)(stc - estimation_last_stc_);
+    estimation_last_stc_ = stc;
+
+    if (elapsed_ns >= estimation_min_ns)
+    {
+        clock_frequency_ = (uint64_t)((double)estimation_ticks_ * 1e9 / (double)elapsed_ns);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../compiler_defines.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::v4l2
+{
+
+/**
+ * Streams the UVC metadata node of a camera next to its video node.
+ *
+ * uvcvideo fills one metadata buffer with the payload headers of every video frame
+ * and gives it the sequence number of that frame.
+ * The PTS of a header is the start of the exposure in device clock ticks,
+ * the SCR pairs a device clock value with the host time the header was received.
+ * The device clock frequency is the dwClockFrequency of the VideoControl interface,
+ * devices that report none get it estimated from the SCR over the first seconds.
+ *
+ * The buffers are mmapped and requeued right after they were parsed.
+ * Not thread safe, it is used by the thread that dequeues the video buffers.
+ */
+class uvc_metadata_stream
+{
+public:
+    struct frame_times
+    {
+        // PTS in nanoseconds on the device clock, continues across the 32 bit wrap around
+        uint64_t camera_time_ns = 0;
+        // start of the exposure in CLOCK_MONOTONIC, 0 when the header had no SCR
+        uint64_t exposure_start_ns = 0;
+    };
+
+    uvc_metadata_stream() = default;
+    ~uvc_metadata_stream();
+
+    uvc_metadata_stream(const uvc_metadata_stream&) = delete;
+    uvc_metadata_stream& operator=(const uvc_metadata_stream&) = delete;
+
+    // video_node is e.g. /dev/video0; false when the camera has no usable metadata node
+    bool open(const std::string& video_node);
+
+    // before VIDIOC_STREAMON of the video node, so that no frame is missed
+    bool start();
+    void stop();
+
+    // dequeues and parses every completed buffer, does not block
+    void drain();
+
+    // times of the video frame with sequence, std::nullopt when its metadata is not known
+    std::optional<frame_times> take(uint32_t sequence);
+
+    const std::string& get_node() const noexcept
+    {
+        return node_;
+    }
+
+private:
+    void close();
+    void parse(const uint8_t* data, size_t size, uint32_t sequence);
+    uint64_t ticks_to_ns(uint64_t ticks) const noexcept;
+    void estimate_frequency(uint32_t stc, uint64_t host_ns);
+
+    std::string node_;
+    int fd_ = -1;
+    bool is_streaming_ = false;
+
+    struct mapping
+    {
+        void* data = nullptr;
+        size_t length = 0;
+    };
+    std::vector<mapping> buffers_;
+
+    // 0 until it is known
+    uint64_t clock_frequency_ = 0;
+    bool frequency_from_descriptor_ = false;
+
+    // PTS continued to 64 bit
+    bool has_pts_ = false;
+    uint32_t last_pts_ = 0;
+    uint64_t pts_ticks_ = 0;
+
+    // first SCR of the estimation and the STC continued to 64 bit since then
+    bool has_estimation_start_ = false;
+    uint64_t estimation_start_ns_ = 0;
+    uint32_t estimation_last_stc_ = 0;
+    uint64_t estimation_ticks_ = 0;
+
+    struct entry
+    {
+        bool valid = false;
+        uint32_t sequence = 0;
+        frame_times times;
+    };
+    // a few frames, the video buffer is usually dequeued right after its metadata
+    std::array<entry, 8> entries_ = {};
+    size_t next_entry_ = 0;
+};
+
+} // namespace tcam::v4l2
+
+VISIBILITY_POP
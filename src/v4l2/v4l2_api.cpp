@@ -17,6 +17,7 @@
 #include "v4l2_api.h"
 
 #include "V4l2Device.h"
+#include "V4l2EventLoop.h"
 #include "v4l2_utils.h"
 
 
@@ -29,3 +30,31 @@ std::vector<tcam::DeviceInfo> tcam::V4L2Backend::get_device_list()
 {
     return get_v4l2_device_list();
 }
+
+std::optional<tcam::DeviceInfo> tcam::V4L2Backend::find_device(const std::string& serial)
+{
+    return find_v4l2_device(serial);
+}
+
+
+bool tcam::V4L2Backend::set_hotplug_callback(std::function<void()> cb)
+{
+    std::scoped_lock lock(hotplug_mtx_);
+
+    auto& loop = tcam::v4l2::V4l2EventLoop::get_instance();
+
+    if (hotplug_id_ != -1)
+    {
+        loop.remove(hotplug_id_);
+        hotplug_id_ = -1;
+    }
+
+    if (!cb)
+    {
+        return true;
+    }
+
+    hotplug_id_ = loop.add_hotplug_cb(std::move(cb));
+
+    return hotplug_id_ != -1;
+}
@@ -18,6 +18,8 @@
 
 #include "../devicelibrary.h"
 
+#include <mutex>
+
 namespace tcam
 {
 
@@ -30,12 +32,19 @@ public:
     };
     std::shared_ptr<DeviceInterface> open_device(const tcam::DeviceInfo&) final;
     std::vector<DeviceInfo> get_device_list() final;
+    std::optional<DeviceInfo> find_device(const std::string& serial) final;
+
+    bool set_hotplug_callback(std::function<void()> cb) final;
 
     static V4L2Backend* get_instance()
     {
         static V4L2Backend b;
         return &b;
     };
+
+private:
+    std::mutex hotplug_mtx_;
+    int hotplug_id_ = -1;
 };
 
 } // namespace tcam
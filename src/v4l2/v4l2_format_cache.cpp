@@ -0,0 +1,476 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "v4l2_format_cache.h"
+
+#include "../logging.h"
+#include "../scaling_cache.h"
+#include "../utils.h"
+
+#include <cctype>
+#include <cstdio> // std::rename
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr uint32_t cache_magic = 0x46433254; // "T2CF"
+constexpr uint32_t cache_version = 2;
+
+// a device has a few dozen formats/sizes, anything above is a broken file
+constexpr uint32_t max_entries = 4096;
+
+std::string cache_dir()
+{
+    return tcam::get_environment_variable("TCAM_V4L2_FORMAT_CACHE_DIR", "");
+}
+
+
+// kind separates the formats and controls of the same device
+std::string cache_file(const tcam::DeviceInfo& dev, const char* kind)
+{
+    std::string name = dev.get_serial();
+    for (auto& c : name)
+    {
+        if (!isalnum((unsigned char)c))
+        {
+            c = '_';
+        }
+    }
+    return cache_dir() + "/v4l2-" + name + "-" + kind + ".cache";
+}
+
+
+// bcdDevice is the firmware revision of usb cameras
+std::string read_firmware_revision(const tcam::DeviceInfo& dev)
+{
+    std::string identifier = dev.get_identifier();
+    auto pos = identifier.rfind('/');
+    if (pos == std::string::npos)
+    {
+        return {};
+    }
+
+    // device points to the usb interface, the attribute lives on the usb device
+    std::ifstream f("/sys/class/video4linux/" + identifier.substr(pos + 1)
+                    + "/device/../bcdDevice");
+    std::string ret;
+    std::getline(f, ret);
+    return ret;
+}
+
+
+class reader
+{
+public:
+    explicit reader(std::istream& stream) : stream_(stream) {}
+
+    template<class T> bool read(T& value)
+    {
+        stream_.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return stream_.good();
+    }
+
+    bool read(std::string& str)
+    {
+        uint32_t size = 0;
+        if (!read(size) || size > 4096)
+        {
+            return false;
+        }
+        str.resize(size);
+        stream_.read(str.data(), size);
+        return stream_.good();
+    }
+
+private:
+    std::istream& stream_;
+};
+
+
+class writer
+{
+public:
+    explicit writer(std::ostream& stream) : stream_(stream) {}
+
+    template<class T> void write(const T& value)
+    {
+        stream_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& str)
+    {
+        write((uint32_t)str.size());
+        stream_.write(str.data(), str.size());
+    }
+
+private:
+    std::ostream& stream_;
+};
+
+
+// true when the file was written by this version for key, r then points to the payload
+bool read_header(reader& r, const tcam::DeviceInfo& dev, const std::string& key)
+{
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    std::string file_key;
+
+    if (!r.read(magic) || magic != cache_magic || !r.read(version) || version != cache_version
+        || !r.read(file_key))
+    {
+        SPDLOG_DEBUG("Ignoring invalid cache for {}", dev.get_serial());
+        return false;
+    }
+
+    if (file_key != key)
+    {
+        SPDLOG_INFO("Cache for {} is outdated.", dev.get_serial());
+        return false;
+    }
+    return true;
+}
+
+
+bool read_count(reader& r, uint32_t& count)
+{
+    return r.read(count) && count <= max_entries;
+}
+
+
+// write_payload is called with a writer positioned after the header
+template<class TFunc>
+void write_cache_file(const std::string& filename, const std::string& key, TFunc&& write_payload)
+{
+    // another process opening the same camera may read the file concurrently
+    const std::string tmp_filename = filename + "." + std::to_string(getpid());
+
+    {
+        std::ofstream f(tmp_filename, std::ios::binary | std::ios::trunc);
+        if (!f)
+        {
+            SPDLOG_WARN("Unable to write cache '{}'", filename);
+            return;
+        }
+
+        writer w(f);
+
+        w.write(cache_magic);
+        w.write(cache_version);
+        w.write(key);
+
+        write_payload(w);
+
+        if (!f.good())
+        {
+            f.close();
+            unlink(tmp_filename.c_str());
+            SPDLOG_WARN("Unable to write cache '{}'", filename);
+            return;
+        }
+    }
+
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    {
+        unlink(tmp_filename.c_str());
+    }
+}
+
+} // namespace
+
+
+std::string tcam::v4l2::device_cache_key(int fd, const DeviceInfo& dev)
+{
+    if (cache_dir().empty())
+    {
+        return {};
+    }
+
+    struct v4l2_capability cap = {};
+    if (tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) == -1)
+    {
+        return {};
+    }
+
+    // kernel updates can change the formats the driver offers,
+    // firmware updates what the camera offers
+    return fmt::format("{}|{}|{}|{}|{:x}|{}",
+                       dev.get_name(),
+                       dev.get_serial(),
+                       dev.get_info().additional_identifier,
+                       (const char*)cap.driver,
+                       cap.version,
+                       read_firmware_revision(dev));
+}
+
+
+std::optional<std::vector<tcam::v4l2::enumerated_format>> tcam::v4l2::load_format_cache(
+    const DeviceInfo& dev,
+    const std::string& key)
+{
+    std::ifstream f(cache_file(dev, "formats"), std::ios::binary);
+    if (!f)
+    {
+        return std::nullopt;
+    }
+
+    reader r(f);
+
+    if (!read_header(r, dev, key))
+    {
+        return std::nullopt;
+    }
+
+    std::vector<enumerated_format> ret;
+
+    uint32_t format_count = 0;
+    if (!read_count(r, format_count))
+    {
+        return std::nullopt;
+    }
+
+    ret.resize(format_count);
+    for (auto& fmt : ret)
+    {
+        uint32_t size_count = 0;
+        if (!r.read(fmt.desc) || !read_count(r, size_count))
+        {
+            return std::nullopt;
+        }
+
+        fmt.sizes.resize(size_count);
+        for (auto& s : fmt.sizes)
+        {
+            uint32_t interval_count = 0;
+            if (!r.read(s.width) || !r.read(s.height) || !read_count(r, interval_count))
+            {
+                return std::nullopt;
+            }
+
+            s.intervals.resize(interval_count);
+            for (auto& i : s.intervals)
+            {
+                if (!r.read(i))
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+    }
+
+    SPDLOG_DEBUG("Using cached formats for {}", dev.get_serial());
+
+    return ret;
+}
+
+
+void tcam::v4l2::store_format_cache(const DeviceInfo& dev,
+                                    const std::string& key,
+                                    const std::vector<enumerated_format>& formats)
+{
+    write_cache_file(cache_file(dev, "formats"),
+                     key,
+                     [&formats](writer& w)
+                     {
+                         w.write((uint32_t)formats.size());
+                         for (const auto& fmt : formats)
+                         {
+                             w.write(fmt.desc);
+                             w.write((uint32_t)fmt.sizes.size());
+                             for (const auto& s : fmt.sizes)
+                             {
+                                 w.write(s.width);
+                                 w.write(s.height);
+                                 w.write((uint32_t)s.intervals.size());
+                                 for (const auto& i : s.intervals) { w.write(i); }
+                             }
+                         }
+                     });
+}
+
+
+std::string tcam::v4l2::control_cache_key(const std::string& device_key,
+                                          const std::string& extension_file)
+{
+    if (device_key.empty())
+    {
+        return {};
+    }
+
+    struct stat st = {};
+    if (extension_file.empty() || stat(extension_file.c_str(), &st) != 0)
+    {
+        return device_key + "|";
+    }
+    return fmt::format("{}|{}|{}|{}", device_key, extension_file, st.st_mtime, st.st_size);
+}
+
+
+std::optional<tcam::v4l2::control_cache> tcam::v4l2::load_control_cache(const DeviceInfo& dev,
+                                                                        const std::string& key)
+{
+    std::ifstream f(cache_file(dev, "controls"), std::ios::binary);
+    if (!f)
+    {
+        return std::nullopt;
+    }
+
+    reader r(f);
+
+    if (!read_header(r, dev, key))
+    {
+        return std::nullopt;
+    }
+
+    control_cache ret;
+
+    uint32_t count = 0;
+    if (!read_count(r, count))
+    {
+        return std::nullopt;
+    }
+
+    ret.controls.resize(count);
+    for (auto& qctrl : ret.controls)
+    {
+        if (!r.read(qctrl))
+        {
+            return std::nullopt;
+        }
+    }
+
+    if (!read_count(r, count))
+    {
+        return std::nullopt;
+    }
+
+    for (uint32_t m = 0; m < count; ++m)
+    {
+        int32_t id = 0;
+        uint32_t entry_count = 0;
+        if (!r.read(id) || !read_count(r, entry_count))
+        {
+            return std::nullopt;
+        }
+
+        auto& entries = ret.menus[id];
+        entries.resize(entry_count);
+        for (auto& e : entries)
+        {
+            int32_t value = 0;
+            if (!r.read(value) || !r.read(e.entry_name))
+            {
+                return std::nullopt;
+            }
+            e.value = value;
+        }
+    }
+
+    if (!read_count(r, count))
+    {
+        return std::nullopt;
+    }
+
+    ret.extension_mappings.resize(count);
+    for (auto& desc : ret.extension_mappings)
+    {
+        uint32_t entry_count = 0;
+        if (!r.read(desc.mapping) || !read_count(r, entry_count))
+        {
+            return std::nullopt;
+        }
+        // set by tcam::uvc::apply_mappings
+        desc.mapping.menu_info = nullptr;
+        desc.mapping.menu_count = 0;
+
+        desc.entries.resize(entry_count);
+        for (auto& e : desc.entries)
+        {
+            if (!r.read(e))
+            {
+                return std::nullopt;
+            }
+        }
+    }
+
+    SPDLOG_DEBUG("Using cached controls for {}", dev.get_serial());
+
+    return ret;
+}
+
+
+void tcam::v4l2::store_control_cache(const DeviceInfo& dev,
+                                     const std::string& key,
+                                     const control_cache& controls)
+{
+    write_cache_file(cache_file(dev, "controls"),
+                     key,
+                     [&controls](writer& w)
+                     {
+                         w.write((uint32_t)controls.controls.size());
+                         for (const auto& qctrl : controls.controls) { w.write(qctrl); }
+
+                         w.write((uint32_t)controls.menus.size());
+                         for (const auto& [id, entries] : controls.menus)
+                         {
+                             w.write((int32_t)id);
+                             w.write((uint32_t)entries.size());
+                             for (const auto& e : entries)
+                             {
+                                 w.write((int32_t)e.value);
+                                 w.write(e.entry_name);
+                             }
+                         }
+
+                         w.write((uint32_t)controls.extension_mappings.size());
+                         for (const auto& desc : controls.extension_mappings)
+                         {
+                             // the menu pointer is only valid in this process
+                             auto mapping = desc.mapping;
+                             mapping.menu_info = nullptr;
+                             mapping.menu_count = 0;
+
+                             w.write(mapping);
+                             w.write((uint32_t)desc.entries.size());
+                             for (const auto& e : desc.entries) { w.write(e); }
+                         }
+                     });
+}
+
+
+std::string tcam::v4l2::scaling_cache_key(int fd, const DeviceInfo& dev)
+{
+    if (!tcam::is_scaling_cache_enabled())
+    {
+        return {};
+    }
+
+    struct v4l2_capability cap = {};
+    if (tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) == -1)
+    {
+        return {};
+    }
+
+    // no serial, the scanning modes are the same for all cameras of a model
+    return fmt::format("v4l2|{}|{}|{}|{:x}|{}",
+                       dev.get_name(),
+                       dev.get_info().additional_identifier,
+                       (const char*)cap.driver,
+                       cap.version,
+                       read_firmware_revision(dev));
+}
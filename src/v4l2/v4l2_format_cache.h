@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../DeviceInfo.h"
+#include "../compiler_defines.h"
+#include "uvc-extension-loader.h"
+#include "v4l2_genicam_conversion.h"
+
+#include <linux/videodev2.h>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::v4l2
+{
+
+/**
+ * Result of VIDIOC_ENUM_FMT/ENUM_FRAMESIZES/ENUM_FRAMEINTERVALS,
+ * only discrete sizes and intervals are kept.
+ */
+struct enumerated_frame_size
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<v4l2_fract> intervals;
+};
+
+struct enumerated_format
+{
+    v4l2_fmtdesc desc;
+    std::vector<enumerated_frame_size> sizes;
+};
+
+/**
+ * Result of VIDIOC_QUERYCTRL/QUERYMENU and the uvc extension unit mappings.
+ * Properties only read the control description when they are created,
+ * the cached description is therefore equivalent to a fresh query.
+ */
+struct control_cache
+{
+    std::vector<v4l2_queryctrl> controls;
+    std::map<int, std::vector<menu_entry>> menus;
+    // empty when the extension unit was already mapped, e.g. by the udev rule
+    std::vector<tcam::uvc::description> extension_mappings;
+};
+
+/**
+ * Identifies the device, firmware and driver the cached formats and controls belong to.
+ * Returns an empty string when the cache is disabled.
+ * Enabled by setting TCAM_V4L2_FORMAT_CACHE_DIR to a writable directory.
+ *
+ * GigE cameras are not covered, aravis downloads the GenICam description inside
+ * arv_camera_new and offers no way to hand it a stored copy.
+ */
+std::string device_cache_key(int fd, const DeviceInfo& dev);
+
+/**
+ * @return cached formats when a cache file for dev exists and was written for key
+ */
+std::optional<std::vector<enumerated_format>> load_format_cache(const DeviceInfo& dev,
+                                                                const std::string& key);
+
+void store_format_cache(const DeviceInfo& dev,
+                        const std::string& key,
+                        const std::vector<enumerated_format>& formats);
+
+/**
+ * Key for the control cache, device_key extended by path and modification time
+ * of the uvc extension file, its mappings define the extension unit controls.
+ * Returns an empty string when device_key is empty.
+ */
+std::string control_cache_key(const std::string& device_key, const std::string& extension_file);
+
+/**
+ * @return cached controls when a cache file for dev exists and was written for key
+ */
+std::optional<control_cache> load_control_cache(const DeviceInfo& dev, const std::string& key);
+
+void store_control_cache(const DeviceInfo& dev,
+                         const std::string& key,
+                         const control_cache& controls);
+
+/**
+ * Key for tcam::load_scaling_cache, identifies model, firmware and driver.
+ * Returns an empty string when the scaling cache is disabled.
+ */
+std::string scaling_cache_key(int fd, const DeviceInfo& dev);
+
+} // namespace tcam::v4l2
+
+VISIBILITY_POP
@@ -128,7 +128,11 @@ void tcam::v4l2::V4L2PropertyLockImpl::update_dependent_lock_state()
     if (dependent_controls_.empty())
         return;
 
-    bool new_locked_state = should_set_dependent_locked();
+    update_dependent_lock_state(should_set_dependent_locked());
+}
+
+void tcam::v4l2::V4L2PropertyLockImpl::update_dependent_lock_state(bool new_locked_state)
+{
     for (auto& dep : dependent_controls_)
     {
         if (auto d = dep.lock())
@@ -324,7 +328,13 @@ outcome::result<void> tcam::v4l2::V4L2PropertyDoubleImpl::set_value(double new_v
         }
     }
 
-    return backend_.set_backend_value(converter_.to_device(new_value));
+    OUTCOME_TRY(backend_.set_backend_value(converter_.to_device(new_value)));
+
+    if (write_observer_)
+    {
+        write_observer_(new_value);
+    }
+    return outcome::success();
 }
 
 tcam::v4l2::V4L2PropertyBoolImpl::V4L2PropertyBoolImpl(
@@ -376,7 +386,13 @@ tcam::v4l2::V4L2PropertyCommandImpl::V4L2PropertyCommandImpl(
 
 outcome::result<void> tcam::v4l2::V4L2PropertyCommandImpl::execute()
 {
-    return backend_.set_backend_value(1);
+    OUTCOME_TRY(backend_.set_backend_value(1));
+
+    if (write_observer_)
+    {
+        write_observer_();
+    }
+    return outcome::success();
 }
 
 tcam::v4l2::V4L2PropertyEnumImpl::V4L2PropertyEnumImpl(
@@ -425,8 +441,15 @@ outcome::result<void> tcam::v4l2::V4L2PropertyEnumImpl::set_value(
         return ret.error();
     }
 
-    update_dependent_lock_state();
+    if (auto dep_entry = get_dependency_entry())
+    {
+        update_dependent_lock_state(dep_entry->locks_dependents(new_value));
+    }
 
+    if (write_observer_)
+    {
+        write_observer_(new_value);
+    }
     return outcome::success();
 }
 
@@ -487,7 +510,7 @@ bool tcam::v4l2::V4L2PropertyEnumImpl::should_set_dependent_locked() const
     if (res.has_error())
         return false;
 
-    return res.value() == dep_entry->prop_enum_state_for_locked;
+    return dep_entry->locks_dependents(res.value());
 }
 
 static auto fetch_balance_white_entries()
@@ -22,6 +22,7 @@
 #include "../property_dependencies.h"
 #include "v4l2_genicam_conversion.h"
 
+#include <functional>
 #include <linux/videodev2.h>
 #include <memory>
 #include <string>
@@ -81,6 +82,8 @@ protected:
 
 protected:
     void update_dependent_lock_state();
+    // for callers that already know the new state, e.g. from the value they just wrote
+    void update_dependent_lock_state(bool new_locked_state);
 
     auto get_dependency_entry() const noexcept
     {
@@ -205,7 +208,16 @@ public:
     outcome::result<double> get_value() const override;
     outcome::result<void> set_value(double new_value) override;
 
+    // called after every successful set_value with the written value
+    // lets the device track state it needs while streaming without reading the control
+    void set_write_observer(std::function<void(double)> func)
+    {
+        write_observer_ = std::move(func);
+    }
+
 private:
+    std::function<void(double)> write_observer_;
+
     tcam::v4l2::converter_scale converter_;
 
     tcamprop1::prop_range_float range_;
@@ -249,7 +261,14 @@ public:
 
     outcome::result<void> execute() override;
 
+    void set_write_observer(std::function<void()> func)
+    {
+        write_observer_ = std::move(func);
+    }
+
 private:
+    std::function<void()> write_observer_;
+
     //const tcamprop1::prop_static_info_command* p_static_info = nullptr;
 };
 
@@ -277,7 +296,14 @@ public:
 
     bool should_set_dependent_locked() const final;
 
+    void set_write_observer(std::function<void(std::string_view)> func)
+    {
+        write_observer_ = std::move(func);
+    }
+
 private:
+    std::function<void(std::string_view)> write_observer_;
+
     std::string_view get_entry_name(int value) const;
     outcome::result<int64_t> get_entry_value(std::string_view name) const;
 
@@ -23,29 +23,135 @@
 #include <libudev.h>
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <glob.h>
 #include <linux/videodev2.h>
+#include <optional>
 #include <regex>
 
-std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list()
+namespace
 {
-    struct udev* udev = udev_new();
-    if (!udev)
-    {
-        return {};
-    }
 
+bool is_blacklisted(const char* product_id)
+{
     static const std::regex device_blacklist[] = {
         std::regex("81.."), // 21/31/41
         std::regex("84.."), // 23U, AFU130
         std::regex("8221"), // DFK 73
     };
 
+    for (const auto& bl_entry : device_blacklist)
+    {
+        if (std::regex_search(product_id, bl_entry))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Creates the DeviceInfo for a video4linux node.
+ * Returns std::nullopt for nodes that do not belong to a supported TIS usb device.
+ */
+std::optional<tcam::DeviceInfo> device_info_from_udev(struct udev_device* dev,
+                                                      bool disable_blacklist)
+{
+    /* we need to copy the devnode (/dev/videoX) before the path
+       is changed to the path of the usb device behind it (/sys/class/....) */
+    const char* devnode = udev_device_get_devnode(dev);
+    if (!devnode)
+    {
+        return std::nullopt;
+    }
+
+    /* The device pointed to by dev contains information about
+       the video4linux node. In order to get information about the
+       USB device, get the parent device with the
+       subsystem/devtype pair of "usb"/"usb_device". This will
+       be several levels up the tree, but the function will find
+       it.*/
+    struct udev_device* parent_device =
+        udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+
+    /* skip this device if we can't get the usb parent */
+    if (!parent_device)
+    {
+        return std::nullopt;
+    }
+
+    /* From here, we can call get_sysattr_value() for each file
+       in the device's /sys entry. The strings passed into these
+       functions (idProduct, idVendor, serial, etc.) correspond
+       directly to the files in the directory which represents
+       the USB device. Note that USB strings are Unicode, UCS2
+       encoded, but the strings returned from
+       udev_device_get_sysattr_value() are UTF-8 encoded. */
+
+    static const char* TCAM_VENDOR_ID_STRING = "199e";
+
+    const char* vendor = udev_device_get_sysattr_value(parent_device, "idVendor");
+    if (!vendor || strcmp(vendor, TCAM_VENDOR_ID_STRING) != 0)
+    {
+        return std::nullopt;
+    }
+
+    const char* product = udev_device_get_sysattr_value(parent_device, "product");
+
+    // S-Video to USB-2.0 converter. // 199e:8002 The Imaging Source Europe GmbH DFG/USB2pro
+    // Name is best option for filtering this device.
+    // Support not viable. Considered legacy product since tiscamera came to be.
+    if (product && strcmp(product, "DFG/USB2pro") == 0)
+    {
+        return std::nullopt;
+    }
+
+    tcam::tcam_device_info info = {};
+    info.type = tcam::TCAM_DEVICE_TYPE_V4L2;
+    strncpy(info.identifier, devnode, sizeof(info.identifier) - 1);
+
+    if (const char* product_id = udev_device_get_sysattr_value(parent_device, "idProduct");
+        product_id != NULL)
+    {
+        if (!disable_blacklist && is_blacklisted(product_id))
+        {
+            return std::nullopt;
+        }
+
+        strncpy(info.additional_identifier, product_id, sizeof(info.additional_identifier) - 1);
+    }
+
+    if (product != NULL)
+    {
+        strncpy(info.name, product, sizeof(info.name) - 1);
+    }
+    if (udev_device_get_sysattr_value(parent_device, "serial") != NULL)
+    {
+        std::string tmp = udev_device_get_sysattr_value(parent_device, "serial");
+        tmp.erase(remove_if(tmp.begin(), tmp.end(), isspace), tmp.end());
+        strncpy(info.serial_number, tmp.c_str(), sizeof(info.serial_number) - 1);
+    }
+
+    return tcam::DeviceInfo(info);
+}
+
+
+/*
+ * Calls func for every supported video4linux node until it returns false.
+ */
+template<typename TFunc> void for_each_v4l2_device(TFunc&& func)
+{
+    struct udev* udev = udev_new();
+    if (!udev)
+    {
+        return;
+    }
+
     // check here to prevent multiple checks while iterating devices
     bool disable_blacklist = tcam::is_environment_variable_set("TCAM_DISABLE_DEVICE_BLACKLIST");
 
-    std::vector<tcam::DeviceInfo> device_list;
-
     /* Create a list of the devices in the 'video4linux' subsystem. */
     struct udev_enumerate* enumerate = udev_enumerate_new(udev);
     udev_enumerate_add_match_subsystem(enumerate, "video4linux");
@@ -53,130 +159,77 @@ std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list()
     struct udev_list_entry* devices = udev_enumerate_get_list_entry(enumerate);
     struct udev_list_entry* dev_list_entry = nullptr;
 
-    auto device_is_known = [&device_list](const DeviceInfo& info)
-    {
-        for (const auto& dev : device_list)
-        {
-            if (dev.get_serial() == info.get_serial())
-            {
-                return true;
-            }
-        }
-        return false;
-    };
-
     udev_list_entry_foreach(dev_list_entry, devices)
     {
-        const char* path;
-        char needed_path[100];
-
         /* Get the filename of the /sys entry for the device
            and create a udev_device object (dev) representing it */
-        path = udev_list_entry_get_name(dev_list_entry);
+        const char* path = udev_list_entry_get_name(dev_list_entry);
         struct udev_device* dev = udev_device_new_from_syspath(udev, path);
+        if (!dev)
+        {
+            continue;
+        }
 
-        /* The device pointed to by dev contains information about
-           the hidraw device. In order to get information about the
-           USB device, get the parent device with the
-           subsystem/devtype pair of "usb"/"usb_device". This will
-           be several levels up the tree, but the function will find
-           it.*/
-
-        /* we need to copy the devnode (/dev/videoX) before the path
-           is changed to the path of the usb device behind it (/sys/class/....) */
-        strcpy(needed_path, udev_device_get_devnode(dev));
+        auto info = device_info_from_udev(dev, disable_blacklist);
 
-        struct udev_device* parent_device =
-            udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+        udev_device_unref(dev);
 
-        /* skip this device if we can't get the usb parent */
-        if (!parent_device)
+        if (info && !func(info.value()))
         {
-            udev_device_unref(dev);
-            continue;
+            break;
         }
+    }
 
-        /* From here, we can call get_sysattr_value() for each file
-           in the device's /sys entry. The strings passed into these
-           functions (idProduct, idVendor, serial, etc.) correspond
-           directly to the files in the directory which represents
-           the USB device. Note that USB strings are Unicode, UCS2
-           encoded, but the strings returned from
-           udev_device_get_sysattr_value() are UTF-8 encoded. */
+    /* Free the enumerator object */
+    udev_enumerate_unref(enumerate);
 
-        static const char* TCAM_VENDOR_ID_STRING = "199e";
+    udev_unref(udev);
+}
 
-        if (strcmp(udev_device_get_sysattr_value(parent_device, "idVendor"), TCAM_VENDOR_ID_STRING)
-            == 0)
-        {
-            // S-Video to USB-2.0 converter. // 199e:8002 The Imaging Source Europe GmbH DFG/USB2pro
-            // Name is best option for filtering this device.
-            // Support not viable. Considered legacy product since tiscamera came to be.
-            if (strcmp(udev_device_get_sysattr_value(parent_device, "product"), "DFG/USB2pro") == 0)
-            {
-                continue;
-            }
-            tcam_device_info info = {};
-            info.type = TCAM_DEVICE_TYPE_V4L2;
-            strncpy(info.identifier, needed_path, sizeof(info.identifier));
+} // namespace
 
-            if (udev_device_get_sysattr_value(parent_device, "idProduct") != NULL)
-            {
-                auto is_blacklisted = [disable_blacklist](const char* idp)
-                {
-                    if (disable_blacklist)
-                    {
-                        return false;
-                    }
-                    for (const auto& bl_entry : device_blacklist)
-                    {
-                        if (std::regex_search(idp, bl_entry))
-                        {
-                            return true;
-                        }
-                    }
-                    return false;
-                };
-
-                if (is_blacklisted(udev_device_get_sysattr_value(parent_device, "idProduct")))
-                {
-                    continue;
-                }
-
-                strncpy(info.additional_identifier,
-                        udev_device_get_sysattr_value(parent_device, "idProduct"),
-                        sizeof(info.additional_identifier) - 1);
-            }
 
-            if (udev_device_get_sysattr_value(parent_device, "product") != NULL)
-            {
-                strncpy(info.name,
-                        udev_device_get_sysattr_value(parent_device, "product"),
-                        sizeof(info.name) - 1);
-            }
-            if (udev_device_get_sysattr_value(parent_device, "serial") != NULL)
-            {
-                std::string tmp = udev_device_get_sysattr_value(parent_device, "serial");
-                tmp.erase(remove_if(tmp.begin(), tmp.end(), isspace), tmp.end());
-                strncpy(info.serial_number, tmp.c_str(), sizeof(info.serial_number) - 1);
-            }
+std::vector<tcam::DeviceInfo> tcam::get_v4l2_device_list()
+{
+    std::vector<tcam::DeviceInfo> device_list;
 
-            auto new_dev = DeviceInfo(info);
-            if (!device_is_known(new_dev))
+    for_each_v4l2_device(
+        [&device_list](const DeviceInfo& info)
+        {
+            // one camera has multiple nodes (e.g. metadata), only the first one is listed
+            auto known = std::any_of(device_list.begin(),
+                                     device_list.end(),
+                                     [&info](const DeviceInfo& dev)
+                                     { return dev.get_serial() == info.get_serial(); });
+            if (!known)
             {
-                device_list.push_back(new_dev);
+                device_list.push_back(info);
             }
-        }
+            return true;
+        });
 
-        udev_device_unref(dev);
-    }
+    return device_list;
+}
 
-    /* Free the enumerator object */
-    udev_enumerate_unref(enumerate);
 
-    udev_unref(udev);
+std::optional<tcam::DeviceInfo> tcam::find_v4l2_device(const std::string& serial)
+{
+    std::optional<tcam::DeviceInfo> ret;
 
-    return device_list;
+    // only reads the sysfs attributes until the serial matches,
+    // nodes are not opened
+    for_each_v4l2_device(
+        [&ret, &serial](const DeviceInfo& info)
+        {
+            if (info.get_serial() != serial)
+            {
+                return true;
+            }
+            ret = info;
+            return false;
+        });
+
+    return ret;
 }
 
 tcam::v4l2::v4l2_device_type tcam::v4l2::get_device_type(const DeviceInfo& info)
@@ -20,6 +20,7 @@
 #include "../DeviceInfo.h"
 #include "../compiler_defines.h"
 
+#include <optional>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -51,6 +52,9 @@ uint32_t fetch_product_id(const DeviceInfo&);
  */
 std::vector<DeviceInfo> get_v4l2_device_list();
 
+// the node of the camera with serial, without building the complete list
+std::optional<DeviceInfo> find_v4l2_device(const std::string& serial);
+
 } /* namespace tcam */
 
 VISIBILITY_POP
@@ -17,6 +17,8 @@
 #include "bayer_generator.h"
 #include "dutils_img/image_fourcc_enum.h"
 
+#include <algorithm>
+
 namespace {
 struct bayer8
 {
@@ -66,20 +68,22 @@ void fill_image_base(img::img_descriptor dst,
 
     //SPDLOG_INFO("filling with [ {},{} : {},{} ]", even.v0, even.v1, odd.v0, odd.v1);
 
-    for (int y = 0; y < dst.dim.cy; y += 2)
+    const int line_count = std::min(dst.dim.cy, 2);
+    for (int y = 0; y < line_count; ++y)
     {
-        auto line_start0 = img::get_line_start<TStructType>(dst, y + 0);
-        auto line_start1 = img::get_line_start<TStructType>(dst, y + 1);
+        auto line_start = img::get_line_start<TStructType>(dst, y);
+        const TStructType value = y == 0 ? struct_even : struct_odd;
 
         int struct_index = 0;
         for (int x = 0; x < dst.dim.cx; x += x_step_size)
         {
-            line_start0[struct_index] = struct_even;
-            line_start1[struct_index] = struct_odd;
+            line_start[struct_index] = value;
 
             struct_index += struct_step_size;
         }
     }
+
+    tcam::generator::repeat_lines(dst, 2);
 }
 
 } // namespace
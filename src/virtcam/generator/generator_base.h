@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include "dutils_img/image_fourcc_func.h"
 #include "dutils_img/image_transform_base.h"
 
+#include <cstring>
+
 namespace tcam::generator
 {
 
@@ -36,4 +39,17 @@ public:
     virtual void fill_image(img::img_descriptor& dst) = 0;
 };
 
+
+// repeats the first period lines over the whole image
+// the patterns are the same for every line (pair), copying them is much faster than generating
+inline void repeat_lines(img::img_descriptor& dst, int period)
+{
+    const int line_size = img::calc_minimum_pitch(dst.fourcc_type(), dst.dim.cx);
+
+    for (int y = period; y < dst.dim.cy; ++y)
+    {
+        memcpy(img::get_line_start(dst, y), img::get_line_start(dst, y % period), line_size);
+    }
+}
+
 } // namespace tcam::generator
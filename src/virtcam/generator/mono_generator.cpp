@@ -16,59 +16,27 @@
 
 #include "mono_generator.h"
 
-using namespace img::pixel_type;
+#include <cstring>
 
 tcam::generator::MonoGenerator::MonoGenerator(img::fourcc fcc)
     : fourcc_(fcc)
 {
-    uint16_t max = pow(2, img::get_bits_per_pixel(fourcc_)) - 1;
-    pattern_gen_ = pattern::WhiteNoise(max);
 }
 
 
 void tcam::generator::MonoGenerator::fill_image(img::img_descriptor& dst)
 {
-
-    if (fourcc_ == img::fourcc::MONO8)
+    if (fourcc_ != img::fourcc::MONO8
+        && fourcc_ != img::fourcc::MONO12_MIPI_PACKED
+        && fourcc_ != img::fourcc::MONO16)
     {
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<Y8>(dst, y);
-
-            for (int x = 0; x < dst.dim.cx; x++)
-            {
-                line[x] = { static_cast<uint8_t>(pattern_gen_.get_pixel()) };
-            }
-        }
+        return;
     }
-    else if (fourcc_ == img::fourcc::MONO12_MIPI_PACKED)
-    {
-
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<RAW12_MIPI_PACKED>(dst, y);
 
-            for (int x = 0; x < dst.dim.cx; x++)
-            {
-                auto v0 = pattern_gen_.get_pixel();
-                auto v1 = pattern_gen_.get_pixel();
+    const int line_size = img::calc_minimum_pitch(dst.fourcc_type(), dst.dim.cx);
 
-                RAW12_MIPI_PACKED pix = { static_cast<uint8_t>(v0 >> 4),
-                                          static_cast<uint8_t>(v1 >> 4),
-                                          static_cast<uint8_t>((v0 >> 4 & 0x0F)
-                                                               | (v1 >> 4 & 0x0F) << 4) };
-
-                line[x] = { pix };
-            }
-        }
-    }
-    else if (fourcc_ == img::fourcc::MONO16)
+    for (int y = 0; y < dst.dim.cy; y++)
     {
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<Y16_LE>(dst, y);
-
-            for (int x = 0; x < dst.dim.cx; x++) { line[x] = { pattern_gen_.get_pixel() }; }
-        }
+        memcpy(img::get_line_start(dst, y), pattern_gen_.get_line(line_size), line_size);
     }
 }
@@ -36,7 +36,7 @@ class MonoGenerator : public IGenerator
 
 private:
 
-    pattern::WhiteNoise pattern_gen_;
+    pattern::NoiseTable pattern_gen_;
     img::fourcc fourcc_;
 
 public:
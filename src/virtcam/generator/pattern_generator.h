@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <random>
+#include <vector>
 
 namespace tcam::generator::pattern
 {
@@ -226,4 +227,43 @@ public:
 }; // class WhiteNoise
 
 
+//
+// Random bytes that lines are copied from
+//
+// Drawing every pixel from the rng is too slow for large images at high rates.
+// Each line starts at a random offset of the table instead, which keeps the images noisy.
+// Random bytes are valid pixels for 8/16 bit and packed formats alike.
+//
+class NoiseTable
+{
+private:
+    std::default_random_engine rng_;
+    std::vector<uint8_t> data_;
+
+public:
+
+    NoiseTable()
+    {
+        std::random_device rd; // only used once to initialise (seed) engine
+        rng_ = std::default_random_engine(rd());
+    }
+
+    // returns line_size random bytes
+    const uint8_t* get_line(size_t line_size)
+    {
+        const size_t table_size = std::max(line_size * 16, size_t(256 * 1024));
+        if (data_.size() < table_size)
+        {
+            WhiteNoise gen(0xFF);
+            data_.resize(table_size);
+            for (auto& v : data_) { v = static_cast<uint8_t>(gen.get_pixel()); }
+        }
+
+        std::uniform_int_distribution<size_t> offset(0, data_.size() - line_size);
+        return data_.data() + offset(rng_);
+    }
+
+}; // class NoiseTable
+
+
 } // namespace tcam::generator::pattern
@@ -57,12 +57,8 @@ void tcam::generator::RGBGenerator::fill_image(img::img_descriptor& dst)
             static_cast<uint8_t>(pix.g),
             static_cast<uint8_t>(pix.r) };
 
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<img::pixel_type::B8G8R8>(dst, y);
-
-            for (int x = 0; x < dst.dim.cx; x++) { line[x] = data; }
-        }
+        auto line = img::get_line_start<img::pixel_type::B8G8R8>(dst, 0);
+        for (int x = 0; x < dst.dim.cx; x++) { line[x] = data; }
     }
     else if (fourcc_ == img::fourcc::BGRA32)
     {
@@ -72,21 +68,19 @@ void tcam::generator::RGBGenerator::fill_image(img::img_descriptor& dst)
             static_cast<uint8_t>(pix.r),
             0 };
 
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<img::pixel_type::BGRA32>(dst, y);
-
-            for (int x = 0; x < dst.dim.cx; x++) { line[x] = data; }
-        }
+        auto line = img::get_line_start<img::pixel_type::BGRA32>(dst, 0);
+        for (int x = 0; x < dst.dim.cx; x++) { line[x] = data; }
     }
     else if (fourcc_ == img::fourcc::BGRA64)
     {
         auto pix = pattern_generator_.get_pixel();
-        for (int y = 0; y < dst.dim.cy; y++)
-        {
-            auto line = img::get_line_start<img::pixel_type::BGRA64>(dst, y);
-
-            for (int x = 0; x < dst.dim.cx; x++) { line[x] = pix; }
-        }
+        auto line = img::get_line_start<img::pixel_type::BGRA64>(dst, 0);
+        for (int x = 0; x < dst.dim.cx; x++) { line[x] = pix; }
     }
+    else
+    {
+        return;
+    }
+
+    repeat_lines(dst, 1);
 }
@@ -0,0 +1,355 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replay_device.h"
+
+#include "../latency_tracing.h"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr char replay_magic[8] = { 'T', 'C', 'A', 'M', 'R', 'A', 'W', '1' };
+
+// a realtime stream that is further behind than this restarts its clock instead of bursting
+constexpr auto max_replay_lag = std::chrono::seconds(1);
+
+} // namespace
+
+
+tcam::virtcam::ReplayDevice::ReplayDevice(const DeviceInfo& info)
+{
+    device = info;
+
+    auto mode = tcam::get_environment_variable("TCAM_VIRTCAM_REPLAY_MODE", "realtime");
+    if (mode == "fast")
+    {
+        pacing_ = replay_pacing::fast;
+    }
+    else if (mode != "realtime")
+    {
+        SPDLOG_WARN("Unknown TCAM_VIRTCAM_REPLAY_MODE '{}'. Using realtime.", mode);
+    }
+
+    map_file(info.get_identifier());
+
+    tcam_resolution_description res = {
+        TCAM_RESOLUTION_TYPE_FIXED,
+        { header_.width, header_.height },
+        { header_.width, header_.height },
+        0, 0,
+        image_scaling {},
+    };
+    framerate_mapping m = { res, { header_.framerate } };
+
+    tcam_video_format_description desc = { header_.fourcc, "" };
+    available_videoformats_.push_back(tcam::VideoFormatDescription(nullptr, desc, { m }));
+
+    tcam_video_format fmt = {};
+    fmt.fourcc = header_.fourcc;
+    fmt.width = header_.width;
+    fmt.height = header_.height;
+    fmt.framerate = header_.framerate;
+    active_video_format_ = VideoFormat(fmt);
+}
+
+
+tcam::virtcam::ReplayDevice::~ReplayDevice()
+{
+    stop_stream();
+
+    if (mapping_)
+    {
+        munmap(const_cast<uint8_t*>(mapping_), mapping_size_);
+    }
+}
+
+
+void tcam::virtcam::ReplayDevice::map_file(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error(fmt::format("Unable to open replay file '{}': {}", filename, strerror(errno)));
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(replay_file_header))
+    {
+        close(fd);
+        throw std::runtime_error(fmt::format("Replay file '{}' is too small", filename));
+    }
+
+    void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        throw std::runtime_error(fmt::format("Unable to map replay file '{}': {}", filename, strerror(errno)));
+    }
+
+    mapping_ = static_cast<const uint8_t*>(ptr);
+    mapping_size_ = st.st_size;
+
+    // frames are read front to back, possibly more than once
+    madvise(ptr, mapping_size_, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    memcpy(&header_, mapping_, sizeof(header_));
+
+    if (memcmp(header_.magic, replay_magic, sizeof(replay_magic)) != 0 || header_.version != 1)
+    {
+        throw std::runtime_error(fmt::format("'{}' is not a raw stream file", filename));
+    }
+
+    const uint64_t index_size = header_.frame_count * sizeof(replay_index_entry);
+    if (header_.frame_count == 0 || header_.index_offset % alignof(replay_index_entry) != 0
+        || header_.index_offset > mapping_size_ || index_size > mapping_size_ - header_.index_offset)
+    {
+        throw std::runtime_error(fmt::format("Replay file '{}' has an invalid index", filename));
+    }
+
+    index_ = reinterpret_cast<const replay_index_entry*>(mapping_ + header_.index_offset);
+
+    for (uint64_t i = 0; i < header_.frame_count; ++i)
+    {
+        const auto& entry = index_[i];
+        if (entry.offset > mapping_size_ || entry.length > mapping_size_ - entry.offset)
+        {
+            throw std::runtime_error(
+                fmt::format("Frame {} of replay file '{}' is outside of the file", i, filename));
+        }
+    }
+
+    if (header_.framerate <= 0.0)
+    {
+        header_.framerate = 30.0;
+    }
+
+    SPDLOG_INFO("Replaying {} frames {}x{} from '{}'",
+                header_.frame_count,
+                header_.width,
+                header_.height,
+                filename);
+}
+
+
+tcam::DeviceInfo tcam::virtcam::ReplayDevice::get_device_description() const
+{
+    return device;
+}
+
+
+bool tcam::virtcam::ReplayDevice::set_video_format(const VideoFormat& fmt)
+{
+    if (fmt.get_fourcc() != header_.fourcc || fmt.get_size().width != header_.width
+        || fmt.get_size().height != header_.height)
+    {
+        SPDLOG_ERROR("Replay device only supports the recorded format.");
+        return false;
+    }
+    active_video_format_ = fmt;
+    return true;
+}
+
+
+tcam::VideoFormat tcam::virtcam::ReplayDevice::get_active_video_format() const
+{
+    return active_video_format_;
+}
+
+
+std::vector<tcam::VideoFormatDescription> tcam::virtcam::ReplayDevice::get_available_video_formats()
+{
+    return available_videoformats_;
+}
+
+
+bool tcam::virtcam::ReplayDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
+{
+    std::scoped_lock lck { buffer_queue_mutex_ };
+
+    buffer_queue_.clear();
+    for (auto& weak_buffer : pool->get_buffer())
+    {
+        if (auto buf = weak_buffer.lock())
+        {
+            buffer_queue_.push_back(buf);
+        }
+    }
+    return true;
+}
+
+
+bool tcam::virtcam::ReplayDevice::release_buffers()
+{
+    std::scoped_lock lck { buffer_queue_mutex_ };
+    buffer_queue_.clear();
+    return true;
+}
+
+
+void tcam::virtcam::ReplayDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
+{
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        buffer_queue_.push_back(buf);
+    }
+    buffer_queue_cv_.notify_one();
+}
+
+
+bool tcam::virtcam::ReplayDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
+{
+    stop_stream();
+
+    stream_sink_ = sink;
+    frames_dropped_ = 0;
+    drops_ = {};
+    frames_delivered_ = 0;
+
+    stream_thread_ended_ = false;
+    stream_thread_ = std::thread([this] { stream_thread_main(); });
+
+    return true;
+}
+
+
+void tcam::virtcam::ReplayDevice::stop_stream()
+{
+    if (!stream_thread_.joinable())
+    {
+        return;
+    }
+
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        stream_thread_ended_ = true;
+    }
+    buffer_queue_cv_.notify_all();
+
+    stream_thread_.join();
+}
+
+
+std::shared_ptr<tcam::ImageBuffer> tcam::virtcam::ReplayDevice::fetch_free_buffer(bool wait)
+{
+    std::unique_lock lck { buffer_queue_mutex_ };
+
+    if (wait)
+    {
+        buffer_queue_cv_.wait(lck, [this] { return stream_thread_ended_ || !buffer_queue_.empty(); });
+    }
+
+    if (buffer_queue_.empty() || stream_thread_ended_)
+    {
+        return {};
+    }
+    auto buf = buffer_queue_.front();
+    buffer_queue_.erase(buffer_queue_.begin());
+
+    return buf;
+}
+
+
+void tcam::virtcam::ReplayDevice::stream_thread_main()
+{
+    tcam::set_thread_name("tcam_replay");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    const auto frame_period = std::chrono::nanoseconds(
+        static_cast<int64_t>(1'000'000'000 / active_video_format_.get_framerate()));
+    const size_t image_size = active_video_format_.get_required_buffer_size();
+
+    const auto start_time = std::chrono::steady_clock::now();
+    auto next_time = start_time;
+
+    for (uint64_t n = 0; !stream_thread_ended_; ++n)
+    {
+        const uint64_t i = n % header_.frame_count;
+        const auto& entry = index_[i];
+
+        if (pacing_ == replay_pacing::realtime)
+        {
+            {
+                std::unique_lock lck { buffer_queue_mutex_ };
+                buffer_queue_cv_.wait_until(lck, next_time, [this] { return stream_thread_ended_.load(); });
+            }
+
+            // recorded differences, the wrap around and broken timestamps use the framerate
+            auto interval = frame_period;
+            if (i + 1 < header_.frame_count && index_[i + 1].timestamp_ns > entry.timestamp_ns)
+            {
+                interval = std::chrono::nanoseconds(index_[i + 1].timestamp_ns - entry.timestamp_ns);
+            }
+            next_time += interval;
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - next_time > max_replay_lag)
+            {
+                next_time = now;
+            }
+        }
+
+        auto buf = fetch_free_buffer(pacing_ == replay_pacing::fast);
+        if (!buf)
+        {
+            if (!stream_thread_ended_)
+            {
+                ++frames_dropped_;
+                ++drops_.no_buffer;
+            }
+            continue;
+        }
+
+        const size_t length = std::min<size_t>(entry.length, buf->get_image_buffer_size());
+        memcpy(buf->get_image_buffer_ptr(), mapping_ + entry.offset, length);
+
+        tcam_stream_statistics stats = {};
+        stats.frame_count = frames_delivered_;
+        stats.frames_dropped = frames_dropped_;
+        stats.drops = drops_;
+        stats.dequeue_time_ns = tcam::latency::stamp();
+        stats.camera_time_ns = entry.timestamp_ns;
+        stats.capture_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start_time)
+                                    .count();
+        stats.is_damaged = length < image_size;
+
+        if (stats.is_damaged && drop_incomplete_frames_)
+        {
+            ++frames_dropped_;
+            ++drops_.incomplete;
+            requeue_buffer(buf);
+            continue;
+        }
+
+        buf->set_statistics(stats);
+        buf->set_valid_data_length(length);
+
+        stream_sink_->push_image(buf);
+        ++frames_delivered_;
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../DeviceInterface.h"
+#include "../VideoFormatDescription.h"
+#include "../compiler_defines.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::virtcam
+{
+
+/*
+ * Layout of a raw stream file, all values are little endian.
+ *
+ * The file starts with replay_file_header, the frames can be anywhere after it.
+ * index_offset points to frame_count replay_index_entry.
+ */
+struct replay_file_header
+{
+    char magic[8]; // "TCAMRAW1"
+    uint32_t version; // 1
+    uint32_t fourcc;
+    uint32_t width;
+    uint32_t height;
+    double framerate;
+    uint64_t frame_count;
+    uint64_t index_offset;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(replay_file_header) == 64);
+
+struct replay_index_entry
+{
+    uint64_t offset;
+    uint64_t length;
+    // capture time of the frame, only differences are used
+    uint64_t timestamp_ns;
+};
+static_assert(sizeof(replay_index_entry) == 24);
+
+enum class replay_pacing
+{
+    // frames are sent with the recorded time differences
+    realtime,
+    // frames are sent as soon as a buffer is free, nothing is dropped
+    fast,
+};
+
+/*
+ * Virtual device that replays a raw stream file.
+ *
+ * The file is memory mapped, frames are copied from the page cache into the pool buffers.
+ * The stream loops when the end of the file is reached.
+ */
+class ReplayDevice : public DeviceInterface
+{
+public:
+    // throws std::runtime_error when the file cannot be used
+    explicit ReplayDevice(const DeviceInfo&);
+
+    ReplayDevice() = delete;
+
+    ~ReplayDevice();
+
+    DeviceInfo get_device_description() const final;
+
+    std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties() final
+    {
+        return {};
+    }
+
+    bool set_video_format(const VideoFormat&) final;
+
+    VideoFormat get_active_video_format() const final;
+
+    std::vector<VideoFormatDescription> get_available_video_formats() final;
+
+    std::shared_ptr<tcam::AllocatorInterface> get_allocator() final
+    {
+        return get_default_allocator();
+    };
+
+    bool initialize_buffers(std::shared_ptr<BufferPool>) final;
+
+    bool release_buffers() final;
+
+    void requeue_buffer(const std::shared_ptr<ImageBuffer>&) final;
+
+    bool start_stream(const std::shared_ptr<IImageBufferSink>&) final;
+
+    void stop_stream() final;
+
+private:
+    void map_file(const std::string& filename);
+
+    void stream_thread_main();
+
+    // blocks in fast mode until a buffer is free or the stream stops
+    std::shared_ptr<ImageBuffer> fetch_free_buffer(bool wait);
+
+    replay_pacing pacing_ = replay_pacing::realtime;
+
+    const uint8_t* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    replay_file_header header_ = {};
+    const replay_index_entry* index_ = nullptr;
+
+    VideoFormat active_video_format_;
+    std::vector<VideoFormatDescription> available_videoformats_;
+
+    std::thread stream_thread_;
+    std::atomic<bool> stream_thread_ended_ { false };
+
+    std::shared_ptr<IImageBufferSink> stream_sink_;
+
+    std::vector<std::shared_ptr<ImageBuffer>> buffer_queue_;
+    std::mutex buffer_queue_mutex_;
+    // signaled on requeue and stop
+    std::condition_variable buffer_queue_cv_;
+
+    uint64_t frames_dropped_ = 0;
+    tcam_drop_statistics drops_ = {};
+    uint64_t frames_delivered_ = 0;
+};
+
+} // namespace tcam::virtcam
+
+VISIBILITY_POP
@@ -16,12 +16,19 @@
 
 #include "virtcam_api.h"
 
+#include "replay_device.h"
 #include "virtcam_device.h"
 
+#include "../logging.h"
 #include "../utils.h"
 
+#include <string_view>
+
 using namespace tcam;
 
+// additional_identifier of devices that replay a raw stream file
+static constexpr const char* replay_identifier = "replay";
+
 static std::vector<tcam::DeviceInfo> get_virtcam_device_list()
 {
     std::vector<tcam::DeviceInfo> rval;
@@ -54,13 +61,62 @@ static std::vector<tcam::DeviceInfo> get_virtcam_device_list()
     return rval;
 }
 
+static std::vector<tcam::DeviceInfo> get_replay_device_list()
+{
+    std::vector<tcam::DeviceInfo> rval;
+
+    auto env_files = tcam::get_environment_variable( "TCAM_VIRTCAM_REPLAY", "" );
+    if (env_files.empty())
+    {
+        return rval;
+    }
+
+    int index = 0;
+    for (const auto& file : split_string( env_files, ":" ))
+    {
+        if (file.size() >= sizeof(tcam_device_info::identifier))
+        {
+            SPDLOG_ERROR("Replay file path '{}' is too long.", file);
+            continue;
+        }
+
+        std::string serial = "7151" + std::to_string( index++ );
+        std::string name = file.substr(file.find_last_of('/') + 1);
+
+        tcam_device_info tmp = {};
+        tmp.type = TCAM_DEVICE_TYPE::TCAM_DEVICE_TYPE_VIRTCAM;
+        strncpy(tmp.name, name.c_str(), sizeof(tmp.name) - 1);
+        strncpy(tmp.identifier, file.c_str(), sizeof(tmp.identifier) - 1);
+        strncpy(tmp.serial_number, serial.c_str(), sizeof(tmp.serial_number) - 1);
+        strncpy(tmp.additional_identifier, replay_identifier, sizeof(tmp.additional_identifier) - 1);
+
+        rval.push_back( DeviceInfo(tmp) );
+    }
+    return rval;
+}
+
 std::shared_ptr<tcam::DeviceInterface> tcam::virtcam::VirtBackend::open_device(const tcam::DeviceInfo& device)
 {
+    if (device.get_info().additional_identifier == std::string_view(replay_identifier))
+    {
+        try
+        {
+            return std::make_shared<ReplayDevice>(device);
+        }
+        catch (const std::exception& err)
+        {
+            SPDLOG_ERROR("Unable to open replay device: {}", err.what());
+            return nullptr;
+        }
+    }
 
     return std::shared_ptr<DeviceInterface>(new VirtcamDevice(device));
 }
 
 std::vector<tcam::DeviceInfo> tcam::virtcam::VirtBackend::get_device_list()
 {
-    return get_virtcam_device_list();
+    auto rval = get_virtcam_device_list();
+    auto replay = get_replay_device_list();
+    rval.insert(rval.end(), replay.begin(), replay.end());
+    return rval;
 }
@@ -0,0 +1,260 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../latency_stamp.h"
+#include "../latency_tracing.h"
+#include "../logging.h"
+#include "../utils.h"
+#include "virtcam_device.h"
+#include "virtcam_generator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <dutils_img/image_transform_base.h>
+#include <random>
+
+namespace
+{
+
+// longest single sleep, so that stop_stream does not wait for slow framerates
+constexpr int64_t max_sleep_ns = 10'000'000;
+
+
+int64_t monotonic_now_ns()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+
+// formats without a generator get a moving byte ramp
+void fill_pattern(std::vector<uint8_t>& data, size_t frame)
+{
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<uint8_t>(i + frame * 7); }
+}
+
+} // namespace
+
+
+std::optional<tcam::virtcam::benchmark_options> tcam::virtcam::get_benchmark_options()
+{
+    if (!tcam::is_environment_variable_set("TCAM_VIRTCAM_BENCHMARK"))
+    {
+        return std::nullopt;
+    }
+
+    benchmark_options ret;
+
+    auto env = tcam::get_environment_variable("TCAM_VIRTCAM_BENCHMARK", "");
+
+    for (const auto& entry : tcam::split_string(env, ","))
+    {
+        auto pos = entry.find('=');
+        if (pos == std::string::npos)
+        {
+            // e.g. TCAM_VIRTCAM_BENCHMARK=1
+            continue;
+        }
+
+        const std::string key = entry.substr(0, pos);
+        const std::string value = entry.substr(pos + 1);
+
+        try
+        {
+            if (key == "ring")
+            {
+                ret.ring_size = std::max(1, std::stoi(value));
+            }
+            else if (key == "copy")
+            {
+                ret.copy = std::stoi(value) != 0;
+            }
+            else if (key == "jitter")
+            {
+                ret.jitter_us = std::max(0, std::stoi(value));
+            }
+            else if (key == "drop")
+            {
+                ret.drop_probability = std::clamp(std::stod(value), 0.0, 1.0);
+            }
+            else if (key == "incomplete")
+            {
+                ret.incomplete_probability = std::clamp(std::stod(value), 0.0, 1.0);
+            }
+            else if (key == "seed")
+            {
+                ret.seed = std::stoul(value);
+            }
+            else if (key == "stamp")
+            {
+                ret.stamp = std::stoi(value) != 0;
+            }
+            else
+            {
+                SPDLOG_WARN("Unknown TCAM_VIRTCAM_BENCHMARK option '{}'", key);
+            }
+        }
+        catch (const std::exception&)
+        {
+            SPDLOG_WARN("Unable to interpret TCAM_VIRTCAM_BENCHMARK option '{}'", entry);
+        }
+    }
+    return ret;
+}
+
+
+void tcam::virtcam::VirtcamDevice::benchmark_thread_main()
+{
+    tcam::set_thread_name("tcam_virt_bench");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    const auto& opt = *benchmark_;
+
+    const double fps = active_video_format_.get_framerate();
+    const int64_t period_ns = static_cast<int64_t>(1'000'000'000 / (fps > 0.0 ? fps : 30.0));
+    const size_t image_size = active_video_format_.get_required_buffer_size();
+
+    // all image data is created before the first frame
+    std::vector<std::vector<uint8_t>> ring(opt.ring_size, std::vector<uint8_t>(image_size));
+    for (size_t i = 0; i < ring.size(); ++i)
+    {
+        if (generator_)
+        {
+            auto dst = img::make_img_desc_from_linear_memory(active_video_format_.get_img_type(),
+                                                             ring.at(i).data());
+            generator_->step();
+            generator_->fill_image(dst);
+        }
+        else
+        {
+            fill_pattern(ring.at(i), i);
+        }
+    }
+
+    if (!opt.copy)
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        for (size_t i = 0; i < buffer_queue_.size(); ++i)
+        {
+            auto& buf = buffer_queue_.at(i);
+            memcpy(buf->get_image_buffer_ptr(),
+                   ring.at(i % ring.size()).data(),
+                   std::min(image_size, buf->get_image_buffer_size()));
+        }
+    }
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> probability(0.0, 1.0);
+    std::uniform_int_distribution<int64_t> jitter(-opt.jitter_us * 1000ll, opt.jitter_us * 1000ll);
+
+    const int64_t start_ns = monotonic_now_ns();
+
+    for (uint64_t frame = 0; !stream_thread_ended_; ++frame)
+    {
+        const int64_t due_ns =
+            start_ns + (int64_t)frame * period_ns + (opt.jitter_us > 0 ? jitter(rng) : 0);
+
+        int64_t now_ns = monotonic_now_ns();
+        while (now_ns < due_ns && !stream_thread_ended_)
+        {
+            const int64_t wake_ns = std::min(due_ns, now_ns + max_sleep_ns);
+
+            struct timespec ts = {};
+            ts.tv_sec = wake_ns / 1'000'000'000;
+            ts.tv_nsec = wake_ns % 1'000'000'000;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+
+            now_ns = monotonic_now_ns();
+        }
+
+        if (stream_thread_ended_)
+        {
+            break;
+        }
+
+        // a real sensor does not wait for us, frames that could not be sent in time are lost
+        if (now_ns - due_ns > period_ns)
+        {
+            const uint64_t missed = (now_ns - due_ns) / period_ns;
+            frames_dropped_ += missed;
+            drops_.transport += missed;
+            frame += missed;
+        }
+
+        if (trigger_mode_ && !trigger_next_image_.exchange(false))
+        {
+            continue;
+        }
+
+        if (opt.drop_probability > 0.0 && probability(rng) < opt.drop_probability)
+        {
+            ++frames_dropped_;
+            ++drops_.transport;
+            continue;
+        }
+
+        auto buf = fetch_free_buffer();
+        if (!buf)
+        {
+            ++frames_dropped_;
+            ++drops_.no_buffer;
+            continue;
+        }
+
+        const bool incomplete =
+            opt.incomplete_probability > 0.0 && probability(rng) < opt.incomplete_probability;
+
+        if (incomplete && drop_incomplete_frames_)
+        {
+            ++frames_dropped_;
+            ++drops_.incomplete;
+            requeue_buffer(buf);
+            continue;
+        }
+
+        if (opt.copy)
+        {
+            memcpy(buf->get_image_buffer_ptr(),
+                   ring.at(frame % ring.size()).data(),
+                   std::min(image_size, buf->get_image_buffer_size()));
+        }
+
+        if (opt.stamp)
+        {
+            tcam::latency::write_frame_stamp(buf->get_img_descriptor(), tcam::latency::now_ns());
+        }
+
+        tcam_stream_statistics stats = {};
+        stats.frame_count = frames_delivered_;
+        stats.frames_dropped = frames_dropped_;
+        stats.drops = drops_;
+        stats.dequeue_time_ns = tcam::latency::stamp();
+        stats.camera_time_ns = due_ns - start_ns;
+        stats.is_damaged = incomplete;
+
+        auto end = std::chrono::high_resolution_clock::now();
+        stats.capture_time_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_).count();
+
+        buf->set_statistics(stats);
+        buf->set_valid_data_length(incomplete ? image_size / 2 : image_size);
+
+        stream_sink_->push_image(buf);
+        ++frames_delivered_;
+    }
+}
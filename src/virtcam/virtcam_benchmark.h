@@ -0,0 +1,53 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace tcam::virtcam
+{
+
+/*
+ * Options of the virtcam load generator.
+ *
+ * In benchmark mode the frames are generated before the stream starts and are sent
+ * at absolute deadlines, so that the pipeline and not the generator is measured.
+ */
+struct benchmark_options
+{
+    // number of precomputed frames that are cycled through
+    int ring_size = 8;
+    // false: the image buffers are filled once, frames are delivered without memcpy
+    bool copy = true;
+    // maximum deviation of a frame from its deadline
+    int jitter_us = 0;
+    double drop_probability = 0.0;
+    // incomplete frames are delivered with half of their data and marked as damaged
+    double incomplete_probability = 0.0;
+    uint32_t seed = 0;
+    // renders the delivery time into the pixels, see latency_stamp.h and tcamlatencysink
+    bool stamp = false;
+};
+
+/**
+ * Parse TCAM_VIRTCAM_BENCHMARK.
+ * @return nullopt when the environment variable is not set
+ */
+std::optional<benchmark_options> get_benchmark_options();
+
+} // namespace tcam::virtcam
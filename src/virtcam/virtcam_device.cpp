@@ -16,6 +16,8 @@
 
 #include "virtcam_device.h"
 
+#include "../latency_tracing.h"
+#include "../scope_tracing.h"
 #include "../logging.h"
 #include "../utils.h"
 #include "dutils_img/image_fourcc.h"
@@ -41,6 +43,7 @@ using namespace img::by_transform;
 tcam::virtcam::VirtcamDevice::VirtcamDevice(const DeviceInfo& info)
 {
     device = info;
+    benchmark_ = get_benchmark_options();
 
     tcam_resolution_description res_type = {
         TCAM_RESOLUTION_TYPE_RANGE,
@@ -51,6 +54,16 @@ tcam::virtcam::VirtcamDevice::VirtcamDevice(const DeviceInfo& info)
     };
     framerate_mapping m = { res_type, { 15., 30., 60.} };
 
+    if (benchmark_)
+    {
+        // allow tiny high rate and huge frames to find the limits of a pipeline
+        res_type.min_size = { 16, 16 };
+        res_type.max_size = { 8192, 8192 };
+        res_type.width_step_size = 2;
+        res_type.height_step_size = 2;
+        m = { res_type, { 15., 30., 60., 120., 240., 500., 1000., 2000., 5000., 10000. } };
+    }
+
     for (auto&& d : get_supported_fourcc())
     {
         tcam_video_format_description desc = { (uint32_t)d, "" };
@@ -63,6 +76,7 @@ tcam::virtcam::VirtcamDevice::VirtcamDevice(const DeviceInfo& info)
 tcam::virtcam::VirtcamDevice::VirtcamDevice(const DeviceInfo& info, const std::vector<tcam::VideoFormatDescription>& desc)
 {
     device = info;
+    benchmark_ = get_benchmark_options();
     available_videoformats_ = desc;
 }
 
@@ -101,6 +115,8 @@ bool tcam::virtcam::VirtcamDevice::initialize_buffers(std::shared_ptr<BufferPool
 
     buffer_queue_.clear();
     buffer_queue_.reserve(b.size());
+    filled_queue_.clear();
+    filled_queue_.reserve(b.size());
 
     for (auto& weak_buffer : b)
     {
@@ -116,6 +132,7 @@ bool tcam::virtcam::VirtcamDevice::initialize_buffers(std::shared_ptr<BufferPool
 bool tcam::virtcam::VirtcamDevice::release_buffers()
 {
     buffer_queue_.clear();
+    filled_queue_.clear();
     return true;
 }
 
@@ -123,6 +140,7 @@ void tcam::virtcam::VirtcamDevice::requeue_buffer(const std::shared_ptr<ImageBuf
 {
     std::scoped_lock lck { buffer_queue_mutex_ };
     buffer_queue_.push_back(buf);
+    buffer_queue_cv_.notify_all();
 }
 
 bool tcam::virtcam::VirtcamDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
@@ -132,11 +150,19 @@ bool tcam::virtcam::VirtcamDevice::start_stream(const std::shared_ptr<IImageBuff
 
     stream_sink_ = sink;
 
-    stream_thread_ended_ = false;
-    stream_thread_ = std::thread([this] { stream_thread_main(); });
-
     start_time_ = std::chrono::high_resolution_clock::now();
 
+    stream_thread_ended_ = false;
+    if (benchmark_)
+    {
+        stream_thread_ = std::thread([this] { benchmark_thread_main(); });
+    }
+    else
+    {
+        generate_thread_ = std::thread([this] { generate_thread_main(); });
+        stream_thread_ = std::thread([this] { stream_thread_main(); });
+    }
+
     return true;
 }
 
@@ -150,8 +176,20 @@ void tcam::virtcam::VirtcamDevice::stop_stream()
         stream_thread_ended_ = true;
         stream_thread_cv_.notify_all();
     }
+    {
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        buffer_queue_cv_.notify_all();
+    }
 
     stream_thread_.join();
+    if (generate_thread_.joinable())
+    {
+        generate_thread_.join();
+    }
+
+    std::scoped_lock lck { buffer_queue_mutex_ };
+    buffer_queue_.insert(buffer_queue_.end(), filled_queue_.begin(), filled_queue_.end());
+    filled_queue_.clear();
 }
 
 void tcam::virtcam::VirtcamDevice::trigger_device_lost ()
@@ -163,6 +201,9 @@ void tcam::virtcam::VirtcamDevice::trigger_device_lost ()
 
 void tcam::virtcam::VirtcamDevice::stream_thread_main()
 {
+    tcam::set_thread_name("tcam_virt_strm");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
     const int64_t timeout_in_us = 1'000'000 / active_video_format_.get_framerate();
 
     const auto send_interval = std::chrono::microseconds(timeout_in_us);
@@ -204,19 +245,28 @@ void tcam::virtcam::VirtcamDevice::stream_thread_main()
         {
             next_time = std::chrono::steady_clock::now() + send_interval;
 
-            std::shared_ptr<ImageBuffer> buf = fetch_free_buffer();
-            if (buf)
+            std::shared_ptr<ImageBuffer> buf;
+            bool generator_behind = false;
             {
-                // SPDLOG_ERROR("next image"); //
-
-                auto dst = buf->get_img_descriptor();
-
-                generator_->step();
-                generator_->fill_image(dst);
+                std::scoped_lock lck { buffer_queue_mutex_ };
+                if (!filled_queue_.empty())
+                {
+                    buf = filled_queue_.front();
+                    filled_queue_.erase(filled_queue_.begin());
+                }
+                else
+                {
+                    generator_behind = !buffer_queue_.empty();
+                }
+            }
 
+            if (buf)
+            {
                 tcam_stream_statistics stats = {};
                 stats.frame_count = frames_delivered_;
                 stats.frames_dropped = frames_dropped_;
+                stats.drops = drops_;
+                stats.dequeue_time_ns = tcam::latency::stamp();
 
                 auto end = std::chrono::high_resolution_clock::now();
                 stats.capture_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_).count();
@@ -227,15 +277,59 @@ void tcam::virtcam::VirtcamDevice::stream_thread_main()
                 stream_sink_->push_image(buf);
                 ++frames_delivered_;
             }
+            else if (generator_behind)
+            {
+                // the image was not ready in time, like a frame lost in transmission
+                ++frames_dropped_;
+                ++drops_.transport;
+            }
             else
             {
                 ++frames_dropped_;
+                ++drops_.no_buffer;
             }
         }
     }
 }
 
 
+// fills free buffers ahead of their delivery, so that a slow generator does not delay frames
+void tcam::virtcam::VirtcamDevice::generate_thread_main()
+{
+    tcam::set_thread_name("tcam_virt_gen");
+    tcam::apply_thread_config(tcam::thread_role::capture);
+
+    while (true)
+    {
+        std::shared_ptr<ImageBuffer> buf;
+        {
+            std::unique_lock lck { buffer_queue_mutex_ };
+            buffer_queue_cv_.wait(lck,
+                                  [this] { return stream_thread_ended_ || !buffer_queue_.empty(); });
+            if (stream_thread_ended_)
+            {
+                break;
+            }
+            buf = buffer_queue_.front();
+            buffer_queue_.erase(buffer_queue_.begin());
+        }
+
+        if (generator_)
+        {
+            TCAM_TRACE_SCOPE("virtcam generate image");
+
+            auto dst = buf->get_img_descriptor();
+
+            generator_->step();
+            generator_->fill_image(dst);
+        }
+
+        std::scoped_lock lck { buffer_queue_mutex_ };
+        filled_queue_.push_back(buf);
+    }
+}
+
+
 std::shared_ptr<tcam::ImageBuffer> tcam::virtcam::VirtcamDevice::fetch_free_buffer()
 {
     std::scoped_lock lck { buffer_queue_mutex_ };
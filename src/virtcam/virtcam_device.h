@@ -18,11 +18,13 @@
 
 #include "../DeviceInterface.h"
 #include "../VideoFormatDescription.h"
+#include "virtcam_benchmark.h"
 
 #include <condition_variable> // std::condition_variable
 #include <memory>
 #include <chrono>
 #include <mutex> // std::mutex, std::unique_lock
+#include <optional>
 #include <thread>
 
 
@@ -85,9 +87,10 @@ private:
     std::thread stream_thread_;
     std::condition_variable stream_thread_cv_;
     std::mutex stream_thread_mutex_;
-    bool stream_thread_ended_ = false;
+    std::atomic<bool> stream_thread_ended_ { false };
 
     int frames_dropped_ = 0;
+    tcam_drop_statistics drops_ = {};
     int frames_delivered_ = 0;
     std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
 
@@ -109,12 +112,24 @@ private:
 
     std::vector<std::shared_ptr<ImageBuffer>> buffer_queue_;
     std::mutex buffer_queue_mutex_;
+    std::condition_variable buffer_queue_cv_;
+
+    // buffers the generate thread already filled, the stream thread only has to deliver them
+    // shares buffer_queue_mutex_
+    std::vector<std::shared_ptr<ImageBuffer>> filled_queue_;
+    std::thread generate_thread_;
 
     std::shared_ptr<IImageBufferSink> stream_sink_;
 
     std::unique_ptr<tcam::generator::IGenerator> generator_;
 
+    // set when TCAM_VIRTCAM_BENCHMARK is present
+    std::optional<benchmark_options> benchmark_;
+
     void stream_thread_main();
+    void generate_thread_main();
+    // defined in virtcam_benchmark.cpp
+    void benchmark_thread_main();
 
     std::shared_ptr<ImageBuffer> fetch_free_buffer();
 
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Streams tcamsrc ! tcamconvert ! fakesink and counts the heap allocations of the whole process
+ * once the stream runs. The steady state should not allocate, every allocation per frame costs
+ * a lock in malloc and makes the latency depend on the other threads of the application.
+ *
+ * Allocations are counted by replacing malloc and friends, see common/allocation_counter.h.
+ */
+
+#include "../common/allocation_counter.h"
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <gst/gst.h>
+#include <mutex>
+#include <string>
+
+namespace
+{
+
+struct measurement
+{
+    uint64_t warmup = 0;
+    uint64_t frames = 0;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    uint64_t buffers = 0;
+    uint64_t last_count = 0;
+    uint64_t begin_count = 0;
+    uint64_t end_count = 0;
+    uint64_t max_frame_allocations = 0;
+    bool done = false;
+
+    // called from the streaming thread, must not allocate itself
+    void on_buffer()
+    {
+        const uint64_t count = tcam::tests::get_allocation_count();
+
+        std::unique_lock lck { mtx };
+        if (done)
+        {
+            return;
+        }
+
+        buffers++;
+        if (buffers == warmup)
+        {
+            begin_count = count;
+        }
+        else if (buffers > warmup)
+        {
+            max_frame_allocations = std::max(max_frame_allocations, count - last_count);
+        }
+        last_count = count;
+
+        if (buffers == warmup + frames)
+        {
+            end_count = count;
+            done = true;
+            lck.unlock();
+            cv.notify_all();
+        }
+    }
+} result;
+
+
+GstPadProbeReturn buffer_probe(GstPad* /*pad*/, GstPadProbeInfo* /*info*/, gpointer /*data*/)
+{
+    result.on_buffer();
+    return GST_PAD_PROBE_OK;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    gst_init(&argc, &argv);
+
+    CLI::App app { "Counts the heap allocations per frame of a running tcamsrc ! tcamconvert stream" };
+
+    std::string serial;
+    app.add_option("-s,--serial", serial, "Serial of the camera to use, e.g. 71500 for the virtcam");
+
+    std::string caps;
+    app.add_option("--caps", caps, "Caps between tcamsrc and tcamconvert, e.g. video/x-bayer");
+
+    result.warmup = 100;
+    app.add_option("--warmup", result.warmup, "Frames until the stream counts as steady", true);
+
+    result.frames = 300;
+    app.add_option("-n,--frames", result.frames, "Frames to count the allocations of", true);
+
+    double max_per_frame = 0.0;
+    app.add_option("--max-allocations-per-frame",
+                   max_per_frame,
+                   "Average allocations per frame above which the test fails",
+                   true);
+
+    int timeout_s = 60;
+    app.add_option("--timeout", timeout_s, "Seconds until the stream counts as stalled", true);
+
+    CLI11_PARSE(app, argc, argv);
+
+    result.warmup = std::max<uint64_t>(result.warmup, 1);
+    result.frames = std::max<uint64_t>(result.frames, 1);
+
+    std::string pipeline_str = "tcamsrc name=source";
+    if (!serial.empty())
+    {
+        pipeline_str += " serial=" + serial;
+    }
+    if (!caps.empty())
+    {
+        pipeline_str += " ! " + caps;
+    }
+    // last-sample would keep a reference and make the pool allocate
+    pipeline_str += " ! tcamconvert ! fakesink name=sink sync=false enable-last-sample=false";
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipeline_str.c_str(), &err);
+    if (!pipeline)
+    {
+        printf("Unable to create pipeline: %s\n", err ? err->message : "unknown error");
+        g_clear_error(&err);
+        return 1;
+    }
+
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstPad* pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, nullptr, nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(sink);
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        printf("Unable to start pipeline\n");
+        gst_object_unref(pipeline);
+        return 1;
+    }
+
+    bool finished = false;
+    {
+        std::unique_lock lck { result.mtx };
+        finished = result.cv.wait_for(
+            lck, std::chrono::seconds(timeout_s), [] { return result.done; });
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    if (!finished)
+    {
+        printf("FAIL stream stalled after %llu buffers\n", (unsigned long long)result.buffers);
+        return 1;
+    }
+
+    const uint64_t total = result.end_count - result.begin_count;
+    const double per_frame = double(total) / result.frames;
+
+    printf("%llu allocations in %llu frames, %.2f per frame, at most %llu in one frame\n",
+           (unsigned long long)total,
+           (unsigned long long)result.frames,
+           per_frame,
+           (unsigned long long)result.max_frame_allocations);
+
+    if (per_frame > max_per_frame)
+    {
+        printf("FAIL more than %.2f allocations per frame\n", max_per_frame);
+        return 1;
+    }
+    return 0;
+}
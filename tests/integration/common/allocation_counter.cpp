@@ -0,0 +1,104 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace
+{
+
+std::atomic<uint64_t> allocation_count = 0;
+
+inline void count_allocation() noexcept
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+
+uint64_t tcam::tests::get_allocation_count() noexcept
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+
+extern "C"
+{
+
+void* malloc(size_t size) noexcept
+{
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+
+void* calloc(size_t count, size_t size) noexcept
+{
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+
+void* realloc(void* ptr, size_t size) noexcept
+{
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+
+void* memalign(size_t alignment, size_t size) noexcept
+{
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) noexcept
+{
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    count_allocation();
+    void* mem = __libc_memalign(alignment, size);
+    if (!mem)
+    {
+        return ENOMEM;
+    }
+    *ptr = mem;
+    return 0;
+}
+
+} // extern "C"
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace tcam::tests
+{
+
+/**
+ * Heap allocations of the whole process since it started.
+ *
+ * Counted by replacing malloc and its variants, the replacements forward to glibc.
+ * allocation_counter.cpp has to be compiled into the executable itself,
+ * so that the replacements are found before the ones of libc.
+ * Does not allocate.
+ */
+uint64_t get_allocation_count() noexcept;
+
+} // namespace tcam::tests
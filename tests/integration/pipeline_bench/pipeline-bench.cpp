@@ -0,0 +1,527 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs a fixed set of pipelines on virtual cameras in benchmark mode and measures, per pipeline,
+ * the frames/s at the sinks, the cpu time and heap allocations of the whole process per frame
+ * and the percentiles of the latency from the backend to the sink.
+ *
+ * The results are printed as JSON. A baseline file limits them, so that a feature
+ * gets a before/after number on the same machine and regressions fail the run.
+ *
+ * Allocations are counted by replacing malloc and friends, see common/allocation_counter.h.
+ */
+
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../common/allocation_counter.h"
+#include "CaptureDevice.h"
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <gst/gst.h>
+#include <json.hpp>
+#include <mutex>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+namespace
+{
+
+// serials of the first two entries of TCAM_VIRTCAM_DEVICES
+const char* serial_0 = "71500";
+const char* serial_1 = "71501";
+
+// FOURCC_MONO8
+constexpr uint32_t fourcc_mono8 = 'Y' | ('8' << 8) | ('0' << 16) | ('0' << 24);
+
+const char* full_hd_gray8 = "video/x-raw,format=GRAY8,width=1920,height=1080,framerate=60/1";
+
+struct scenario
+{
+    std::string name;
+    // gst-launch syntax, the sinks are named sink0, sink1, ...; empty for the direct API
+    std::string pipeline;
+};
+
+
+std::vector<scenario> get_scenarios()
+{
+    // last-sample would keep a reference and make the pool allocate
+    const std::string sink = " ! fakesink sync=false enable-last-sample=false name=";
+
+    return {
+        { "tcamsrc_fakesink",
+          std::string("tcamsrc serial=") + serial_0 + " ! " + full_hd_gray8 + sink + "sink0" },
+        { "tcambin_bgrx",
+          std::string("tcambin serial=") + serial_0
+              + " ! video/x-raw,format=BGRx,width=1920,height=1080,framerate=60/1" + sink
+              + "sink0" },
+        { "packed12_bgra",
+          std::string("tcamsrc serial=") + serial_0
+              + " ! video/x-bayer,format=rggb12m,width=1920,height=1080,framerate=60/1"
+              + " ! tcamconvert ! video/x-raw,format=BGRA" + sink + "sink0" },
+        { "multi_camera",
+          std::string("tcamsrc serial=") + serial_0 + " ! " + full_hd_gray8 + sink + "sink0 "
+              + "tcamsrc serial=" + serial_1 + " ! " + full_hd_gray8 + sink + "sink1" },
+        { "small_roi_high_fps",
+          std::string("tcamsrc serial=") + serial_0
+              + " ! video/x-raw,format=GRAY8,width=64,height=64,framerate=2000/1" + sink
+              + "sink0" },
+        { "direct_api", "" },
+    };
+}
+
+
+uint64_t monotonic_ns()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+
+uint64_t process_cpu_ns()
+{
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+
+    auto to_ns = [](const timeval& tv)
+    {
+        return static_cast<uint64_t>(tv.tv_sec) * 1'000'000'000 + tv.tv_usec * 1000;
+    };
+    return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+}
+
+
+// frames and latencies during the measurement window
+class measurement
+{
+public:
+    explicit measurement(size_t expected_frames)
+    {
+        // the streaming threads must not allocate for the measurement itself
+        latencies_.reserve(expected_frames);
+    }
+
+    // called from the streaming threads
+    void on_frame(uint64_t dequeue_time_ns)
+    {
+        if (!measuring_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        const uint64_t now = monotonic_ns();
+
+        std::scoped_lock lck { mtx_ };
+        frames_++;
+        if (dequeue_time_ns != 0 && now >= dequeue_time_ns
+            && latencies_.size() < latencies_.capacity())
+        {
+            latencies_.push_back(now - dequeue_time_ns);
+        }
+    }
+
+    nlohmann::json run(unsigned int warmup_s, unsigned int seconds)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(warmup_s));
+
+        const uint64_t begin_ns = monotonic_ns();
+        const uint64_t begin_cpu = process_cpu_ns();
+        const uint64_t begin_allocations = tcam::tests::get_allocation_count();
+        measuring_ = true;
+
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+
+        measuring_ = false;
+        const uint64_t end_allocations = tcam::tests::get_allocation_count();
+        const uint64_t end_cpu = process_cpu_ns();
+        const uint64_t end_ns = monotonic_ns();
+
+        std::scoped_lock lck { mtx_ };
+
+        nlohmann::json ret;
+        ret["frames"] = frames_;
+        ret["fps"] = frames_ * 1e9 / (end_ns - begin_ns);
+        if (frames_ == 0)
+        {
+            return ret;
+        }
+        ret["cpu_us_per_frame"] = (end_cpu - begin_cpu) / 1000. / frames_;
+        ret["allocations_per_frame"] = double(end_allocations - begin_allocations) / frames_;
+
+        if (!latencies_.empty())
+        {
+            std::sort(latencies_.begin(), latencies_.end());
+            auto at = [this](double p)
+            {
+                return latencies_.at(static_cast<size_t>(p * (latencies_.size() - 1))) / 1000.;
+            };
+            ret["latency_p50_us"] = at(0.5);
+            ret["latency_p90_us"] = at(0.9);
+            ret["latency_p99_us"] = at(0.99);
+            ret["latency_max_us"] = latencies_.back() / 1000.;
+        }
+        return ret;
+    }
+
+private:
+    std::atomic<bool> measuring_ = false;
+
+    std::mutex mtx_;
+    uint64_t frames_ = 0;
+    std::vector<uint64_t> latencies_;
+};
+
+
+GstPadProbeReturn buffer_probe(GstPad* /*pad*/, GstPadProbeInfo* info, gpointer data)
+{
+    uint64_t dequeue_time_ns = 0;
+    if (auto meta = gst_buffer_get_tcam_statistics_values_meta(GST_PAD_PROBE_INFO_BUFFER(info)))
+    {
+        dequeue_time_ns = meta->values.dequeue_time_ns;
+    }
+    static_cast<measurement*>(data)->on_frame(dequeue_time_ns);
+    return GST_PAD_PROBE_OK;
+}
+
+
+nlohmann::json run_gstreamer(const scenario& s, unsigned int warmup_s, unsigned int seconds)
+{
+    nlohmann::json ret;
+    ret["pipeline"] = s.pipeline;
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(s.pipeline.c_str(), &err);
+    if (!pipeline || err)
+    {
+        ret["error"] = err ? err->message : "unknown error";
+        g_clear_error(&err);
+        if (pipeline)
+        {
+            gst_object_unref(pipeline);
+        }
+        return ret;
+    }
+
+    // 2000 fps of the small roi pipeline, generously
+    measurement meas(3000 * static_cast<size_t>(seconds) + 1000);
+
+    for (int i = 0;; ++i)
+    {
+        GstElement* sink =
+            gst_bin_get_by_name(GST_BIN(pipeline), ("sink" + std::to_string(i)).c_str());
+        if (!sink)
+        {
+            break;
+        }
+        GstPad* pad = gst_element_get_static_pad(sink, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, &meas, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(sink);
+    }
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        ret["error"] = "Unable to start the pipeline";
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+        return ret;
+    }
+
+    ret["result"] = meas.run(warmup_s, seconds);
+
+    // errors are only looked at afterwards, polling the bus would allocate during the window
+    GstBus* bus = gst_element_get_bus(pipeline);
+    if (GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR))
+    {
+        GError* msg_err = nullptr;
+        gst_message_parse_error(msg, &msg_err, nullptr);
+        ret["error"] = msg_err ? msg_err->message : "unknown error";
+        g_clear_error(&msg_err);
+        gst_message_unref(msg);
+    }
+    gst_object_unref(bus);
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    return ret;
+}
+
+
+nlohmann::json run_library(unsigned int warmup_s, unsigned int seconds)
+{
+    nlohmann::json ret;
+
+    auto dev = tcam::open_device(serial_0, tcam::TCAM_DEVICE_TYPE_VIRTCAM);
+    if (!dev)
+    {
+        ret["error"] = "Unable to open device";
+        return ret;
+    }
+
+    tcam::VideoFormat fmt(fourcc_mono8, { 1920, 1080 });
+    fmt.set_framerate(60.0);
+    ret["format"] = fmt.to_string();
+
+    measurement meas(100 * static_cast<size_t>(seconds) + 1000);
+
+    tcam::ImageSink* sink_ptr = nullptr;
+    auto sink = std::make_shared<tcam::ImageSink>(
+        [&](const std::shared_ptr<tcam::ImageBuffer>& buffer)
+        {
+            meas.on_frame(buffer->get_statistics().dequeue_time_ns);
+            sink_ptr->requeue_buffer(buffer);
+        },
+        fmt,
+        10);
+    sink_ptr = sink.get();
+
+    if (!dev->configure_stream(fmt, sink, nullptr) || !dev->start_stream())
+    {
+        dev->free_stream();
+        ret["error"] = "Unable to start the stream";
+        return ret;
+    }
+
+    ret["result"] = meas.run(warmup_s, seconds);
+
+    dev->stop_stream();
+    dev->free_stream();
+
+    return ret;
+}
+
+
+// every limit of the baseline is either { "min": x } or { "max": x }
+bool check_baseline(const nlohmann::json& results, const nlohmann::json& baseline)
+{
+    bool ret = true;
+    for (const auto& [name, limits] : baseline.items())
+    {
+        if (!results.contains(name))
+        {
+            continue;
+        }
+        const auto& run = results[name];
+
+        if (run.contains("error"))
+        {
+            printf("FAIL %s: %s\n", name.c_str(), run["error"].get<std::string>().c_str());
+            ret = false;
+            continue;
+        }
+
+        const auto& result = run["result"];
+        for (const auto& [key, limit] : limits.items())
+        {
+            if (!result.contains(key))
+            {
+                printf("FAIL %s.%s: not measured\n", name.c_str(), key.c_str());
+                ret = false;
+                continue;
+            }
+
+            const double value = result[key].get<double>();
+            if (limit.contains("min") && value < limit["min"].get<double>())
+            {
+                printf("FAIL %s.%s: %.2f < %.2f\n",
+                       name.c_str(),
+                       key.c_str(),
+                       value,
+                       limit["min"].get<double>());
+                ret = false;
+            }
+            if (limit.contains("max") && value > limit["max"].get<double>())
+            {
+                printf("FAIL %s.%s: %.2f > %.2f\n",
+                       name.c_str(),
+                       key.c_str(),
+                       value,
+                       limit["max"].get<double>());
+                ret = false;
+            }
+        }
+    }
+    return ret;
+}
+
+
+// limits from the results of this machine, tolerance as fraction
+nlohmann::json make_baseline(const nlohmann::json& results, double tolerance)
+{
+    nlohmann::json ret = nlohmann::json::object();
+    for (const auto& [name, run] : results.items())
+    {
+        if (run.contains("error") || !run.contains("result"))
+        {
+            continue;
+        }
+
+        nlohmann::json limits = nlohmann::json::object();
+        for (const auto& [key, value] : run["result"].items())
+        {
+            if (key == "frames")
+            {
+                continue;
+            }
+
+            const double v = value.get<double>();
+            if (key == "fps")
+            {
+                limits[key] = { { "min", v * (1.0 - tolerance) } };
+            }
+            else if (key == "allocations_per_frame")
+            {
+                // steady state allocations are a count, rounding must not make 0 fail
+                limits[key] = { { "max", v * (1.0 + tolerance) + 0.01 } };
+            }
+            else
+            {
+                limits[key] = { { "max", v * (1.0 + tolerance) } };
+            }
+        }
+        ret[name] = limits;
+    }
+    return ret;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "Benchmarks a fixed set of pipelines on virtual cameras" };
+
+    unsigned int seconds = 5;
+    app.add_option("-d,--duration", seconds, "Seconds every pipeline is measured", true);
+
+    unsigned int warmup_s = 1;
+    app.add_option("--warmup", warmup_s, "Seconds until a pipeline counts as steady", true);
+
+    std::vector<std::string> selection;
+    app.add_option("--scenario", selection, "Only run these scenarios, default is all");
+
+    std::string baseline_file;
+    app.add_option("--baseline", baseline_file, "JSON file with the limits of the measured values")
+        ->check(CLI::ExistingFile);
+
+    std::string output_file;
+    app.add_option("-o,--output", output_file, "Write the results as JSON to this file");
+
+    std::string write_baseline_file;
+    app.add_option("--write-baseline",
+                   write_baseline_file,
+                   "Write limits derived from this run to this file, for --baseline");
+
+    double tolerance = 0.25;
+    app.add_option(
+        "--tolerance", tolerance, "Fraction the values of --write-baseline may regress", true);
+
+    bool list = false;
+    app.add_flag("-l,--list", list, "List the scenarios and their pipelines");
+
+    // allow --gst-debug etc
+    app.allow_extras(true);
+
+    CLI11_PARSE(app, argc, argv);
+
+    const auto scenarios = get_scenarios();
+    if (list)
+    {
+        for (const auto& s : scenarios)
+        {
+            printf("%s: %s\n",
+                   s.name.c_str(),
+                   s.pipeline.empty() ? "direct API" : s.pipeline.c_str());
+        }
+        return 0;
+    }
+
+    // read by libtcam when the first device is indexed, values of the caller take precedence
+    setenv("TCAM_VIRTCAM_DEVICES", "virt0001:virt0002", 0);
+    setenv("TCAM_VIRTCAM_BENCHMARK", "1", 0);
+    setenv("TCAM_LATENCY_TRACING", "1", 0);
+
+    gst_init(&argc, &argv);
+
+    nlohmann::json results = nlohmann::json::object();
+    for (const auto& s : scenarios)
+    {
+        if (!selection.empty()
+            && std::find(selection.begin(), selection.end(), s.name) == selection.end())
+        {
+            continue;
+        }
+
+        fprintf(stderr, "Running %s...\n", s.name.c_str());
+        results[s.name] = s.pipeline.empty() ? run_library(warmup_s, seconds)
+                                             : run_gstreamer(s, warmup_s, seconds);
+    }
+
+    nlohmann::json report;
+    report["environment"] = {
+        { "TCAM_VIRTCAM_BENCHMARK", getenv("TCAM_VIRTCAM_BENCHMARK") },
+        { "hardware_concurrency", std::thread::hardware_concurrency() },
+    };
+    report["duration_s"] = seconds;
+    report["results"] = results;
+
+    printf("%s\n", report.dump(4).c_str());
+
+    if (!output_file.empty())
+    {
+        std::ofstream ofs(output_file);
+        ofs << report.dump(4) << std::endl;
+    }
+
+    if (!write_baseline_file.empty())
+    {
+        std::ofstream ofs(write_baseline_file);
+        ofs << make_baseline(results, tolerance).dump(4) << std::endl;
+    }
+
+    if (!baseline_file.empty())
+    {
+        std::ifstream ifs(baseline_file);
+        nlohmann::json baseline;
+        try
+        {
+            ifs >> baseline;
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            printf("Unable to parse baseline file: %s\n", e.what());
+            return 1;
+        }
+
+        if (!check_baseline(results, baseline))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
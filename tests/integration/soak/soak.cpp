@@ -0,0 +1,442 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Streams one or more cameras at their highest framerate through libtcam for a long time.
+ * Checks the frame_count continuity of every stream and tracks memory, file descriptors and cpu usage.
+ */
+
+#include "CaptureDevice.h"
+#include "public_utils.h"
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <json.hpp>
+#include <mutex>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+struct stream_counters
+{
+    uint64_t frames = 0;
+    uint64_t frame_count_gaps = 0; // frames missing according to frame_count
+    uint64_t frames_dropped = 0; // sum of the reported frames_dropped increments
+    uint64_t frames_damaged = 0;
+    uint64_t frame_count_resets = 0; // frame_count went backwards
+};
+
+
+class stream
+{
+public:
+    explicit stream(std::string serial) : serial_(std::move(serial)) {}
+
+    bool open(const std::string& fourcc)
+    {
+        auto type = tcam::TCAM_DEVICE_TYPE_UNKNOWN;
+        std::string serial = serial_;
+
+        // accept the <serial>-<type> notation of 'tcam-ctrl --list-serial-long'
+        if (auto pos = serial_.rfind('-'); pos != std::string::npos)
+        {
+            auto t = tcam::tcam_device_from_string(serial_.substr(pos + 1));
+            if (t != tcam::TCAM_DEVICE_TYPE_UNKNOWN)
+            {
+                type = t;
+                serial = serial_.substr(0, pos);
+            }
+        }
+
+        device_ = tcam::open_device(serial, type);
+        if (!device_)
+        {
+            printf("%s: unable to open device\n", serial_.c_str());
+            return false;
+        }
+
+        // the largest resolution of the first matching format at its highest framerate
+        for (const auto& desc : device_->get_available_video_formats())
+        {
+            tcam::VideoFormat fmt(desc.get_fourcc(), {});
+            if (!fourcc.empty() && fmt.get_fourcc_string() != fourcc)
+            {
+                continue;
+            }
+
+            for (const auto& res : desc.get_resolutions())
+            {
+                tcam::VideoFormat candidate(desc.get_fourcc(), res.max_size, res.scaling);
+                auto rates = desc.get_framerates(candidate);
+                if (rates.empty())
+                {
+                    continue;
+                }
+                candidate.set_framerate(*std::max_element(rates.begin(), rates.end()));
+
+                auto size = candidate.get_size();
+                auto best = format_.get_size();
+                if (format_.is_empty() || size.width * size.height > best.width * best.height)
+                {
+                    format_ = candidate;
+                }
+            }
+            break;
+        }
+
+        if (format_.is_empty())
+        {
+            printf("%s: no usable format\n", serial_.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool start()
+    {
+        sink_ = std::make_shared<tcam::ImageSink>(
+            [this](const std::shared_ptr<tcam::ImageBuffer>& buffer)
+            {
+                on_image(buffer->get_statistics());
+                sink_->requeue_buffer(buffer);
+            },
+            format_,
+            10);
+
+        if (!device_->configure_stream(format_, sink_, nullptr) || !device_->start_stream())
+        {
+            printf("%s: unable to start stream with %s\n", serial_.c_str(), format_.to_string().c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void stop()
+    {
+        device_->stop_stream();
+        device_->free_stream();
+        // the sink callback references this
+        sink_.reset();
+    }
+
+    stream_counters counters() const
+    {
+        std::scoped_lock lck { mtx_ };
+        return counters_;
+    }
+
+    const std::string& serial() const noexcept
+    {
+        return serial_;
+    }
+
+    const tcam::VideoFormat& format() const noexcept
+    {
+        return format_;
+    }
+
+private:
+    void on_image(const tcam::tcam_stream_statistics& stats)
+    {
+        std::scoped_lock lck { mtx_ };
+
+        counters_.frames++;
+        if (stats.is_damaged)
+        {
+            counters_.frames_damaged++;
+        }
+
+        if (has_last_)
+        {
+            if (stats.frame_count > last_frame_count_)
+            {
+                counters_.frame_count_gaps += stats.frame_count - last_frame_count_ - 1;
+            }
+            else
+            {
+                counters_.frame_count_resets++;
+            }
+            if (stats.frames_dropped > last_frames_dropped_)
+            {
+                counters_.frames_dropped += stats.frames_dropped - last_frames_dropped_;
+            }
+        }
+        has_last_ = true;
+        last_frame_count_ = stats.frame_count;
+        last_frames_dropped_ = stats.frames_dropped;
+    }
+
+    std::string serial_;
+    std::shared_ptr<tcam::CaptureDevice> device_;
+    tcam::VideoFormat format_;
+    std::shared_ptr<tcam::ImageSink> sink_;
+
+    mutable std::mutex mtx_;
+    stream_counters counters_;
+    bool has_last_ = false;
+    uint64_t last_frame_count_ = 0;
+    uint64_t last_frames_dropped_ = 0;
+};
+
+
+uint64_t read_rss_kb()
+{
+    std::ifstream ifs("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    ifs >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+
+int count_open_fds()
+{
+    int ret = 0;
+    if (DIR* dir = opendir("/proc/self/fd"))
+    {
+        while (auto entry = readdir(dir))
+        {
+            if (entry->d_name[0] != '.')
+            {
+                ret++;
+            }
+        }
+        closedir(dir);
+        // the descriptor of dir itself
+        ret--;
+    }
+    return ret;
+}
+
+
+double process_cpu_seconds()
+{
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec
+           + usage.ru_stime.tv_usec / 1e6;
+}
+
+
+nlohmann::json to_json(const stream_counters& c)
+{
+    return {
+        { "frames", c.frames },
+        { "frame_count_gaps", c.frame_count_gaps },
+        { "frames_dropped", c.frames_dropped },
+        { "frames_damaged", c.frames_damaged },
+        { "frame_count_resets", c.frame_count_resets },
+    };
+}
+
+
+std::atomic<bool> stop_requested = false;
+
+void handle_signal(int /*sig*/)
+{
+    stop_requested = true;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "soak test, streams cameras for a long time and reports drops and resource usage" };
+
+    std::vector<std::string> serials;
+    app.add_option("-s,--serial", serials, "Serials of the cameras to stream, <serial> or <serial>-<type>")
+        ->required();
+
+    std::string fourcc;
+    app.add_option("--fourcc", fourcc, "Fourcc of the format to use, default is the first format");
+
+    unsigned int duration_s = 3600;
+    app.add_option("-d,--duration", duration_s, "Test duration in seconds", true);
+
+    unsigned int interval_s = 60;
+    app.add_option("-i,--interval", interval_s, "Seconds between two report samples", true);
+
+    unsigned int warmup_s = 60;
+    app.add_option("--warmup", warmup_s, "Seconds after which memory and fds are the reference", true);
+
+    uint64_t max_rss_growth_kb = 16 * 1024;
+    app.add_option("--max-rss-growth", max_rss_growth_kb, "Allowed RSS growth after the warmup in KiB", true);
+
+    std::string report_file;
+    app.add_option("-o,--report", report_file, "Write the JSON report to this file");
+
+    CLI11_PARSE(app, argc, argv);
+
+    interval_s = std::max(interval_s, 1u);
+
+    std::vector<std::unique_ptr<stream>> streams;
+    for (const auto& s : serials)
+    {
+        auto ptr = std::make_unique<stream>(s);
+        if (!ptr->open(fourcc))
+        {
+            return 1;
+        }
+        streams.push_back(std::move(ptr));
+    }
+
+    for (auto& s : streams)
+    {
+        if (!s->start())
+        {
+            return 1;
+        }
+    }
+
+    nlohmann::json report;
+    for (const auto& s : streams)
+    {
+        report["streams"].push_back({ { "serial", s->serial() }, { "format", s->format().to_string() } });
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    double last_cpu = process_cpu_seconds();
+    auto last_sample = begin;
+    std::vector<stream_counters> last_counters(streams.size());
+
+    uint64_t reference_rss = 0;
+    int reference_fds = 0;
+    bool has_reference = false;
+
+    // ctrl-c ends the test early, the report is still written
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    auto samples = nlohmann::json::array();
+    while (!stop_requested)
+    {
+        for (unsigned int i = 0; i < interval_s && !stop_requested; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - begin).count();
+        const double interval = std::chrono::duration<double>(now - last_sample).count();
+        const double cpu = process_cpu_seconds();
+
+        nlohmann::json sample;
+        sample["time_s"] = elapsed;
+        sample["rss_kb"] = read_rss_kb();
+        sample["fds"] = count_open_fds();
+        sample["cpu_percent"] = (cpu - last_cpu) / interval * 100.;
+
+        for (size_t i = 0; i < streams.size(); ++i)
+        {
+            auto c = streams[i]->counters();
+            auto j = to_json(c);
+            j["fps"] = (c.frames - last_counters[i].frames) / interval;
+            sample["streams"].push_back(j);
+            last_counters[i] = c;
+        }
+
+        if (!has_reference && elapsed >= warmup_s)
+        {
+            reference_rss = sample["rss_kb"];
+            reference_fds = sample["fds"];
+            has_reference = true;
+        }
+
+        printf("%s\n", sample.dump().c_str());
+        fflush(stdout);
+        samples.push_back(sample);
+
+        last_cpu = cpu;
+        last_sample = now;
+
+        if (elapsed >= duration_s)
+        {
+            break;
+        }
+    }
+
+    for (auto& s : streams)
+    {
+        s->stop();
+    }
+
+    report["samples"] = samples;
+
+    // gaps that the device did not report as dropped went missing inside the library
+    auto failures = nlohmann::json::array();
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        const auto c = streams[i]->counters();
+        report["streams"][i]["result"] = to_json(c);
+
+        if (c.frames == 0)
+        {
+            failures.push_back(streams[i]->serial() + ": no frames received");
+        }
+        if (c.frame_count_gaps > c.frames_dropped)
+        {
+            failures.push_back(streams[i]->serial() + ": "
+                               + std::to_string(c.frame_count_gaps - c.frames_dropped)
+                               + " frames missing without being reported as dropped");
+        }
+    }
+
+    if (has_reference && !samples.empty())
+    {
+        const uint64_t rss = samples.back()["rss_kb"];
+        const int fds = samples.back()["fds"];
+
+        report["rss_growth_kb"] = static_cast<int64_t>(rss) - static_cast<int64_t>(reference_rss);
+        report["fd_growth"] = fds - reference_fds;
+
+        if (rss > reference_rss + max_rss_growth_kb)
+        {
+            failures.push_back("RSS grew by " + std::to_string(rss - reference_rss) + " KiB");
+        }
+        if (fds > reference_fds)
+        {
+            failures.push_back("file descriptors grew by " + std::to_string(fds - reference_fds));
+        }
+    }
+
+    const bool passed = failures.empty();
+    report["failures"] = failures;
+    report["passed"] = passed;
+
+    if (!report_file.empty())
+    {
+        std::ofstream ofs(report_file);
+        ofs << report.dump(4) << std::endl;
+    }
+
+    for (const auto& f : failures)
+    {
+        printf("FAIL %s\n", f.get<std::string>().c_str());
+    }
+
+    return passed ? 0 : 1;
+}
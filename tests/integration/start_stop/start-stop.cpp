@@ -15,27 +15,101 @@
  */
 
 #include <CLI11.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <fstream>
 #include <gst/gst.h>
+#include <json.hpp>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <unistd.h>
+#include <vector>
 
 
 GstElement* pipeline;
 
+using clock_type = std::chrono::steady_clock;
+
+// how long to wait for the first buffer or a state change before the run counts as failed
+constexpr auto first_buffer_timeout = std::chrono::seconds(10);
+
+struct first_buffer_waiter
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool received = false;
+    clock_type::time_point time;
+
+    void reset()
+    {
+        std::scoped_lock lck { mtx };
+        received = false;
+    }
+
+    void notify()
+    {
+        {
+            std::scoped_lock lck { mtx };
+            if (received)
+            {
+                return;
+            }
+            received = true;
+            time = clock_type::now();
+        }
+        cv.notify_all();
+    }
+
+    // returns the arrival time of the first buffer since the last reset
+    std::optional<clock_type::time_point> wait()
+    {
+        std::unique_lock lck { mtx };
+        if (!cv.wait_for(lck, first_buffer_timeout, [this] { return received; }))
+        {
+            return std::nullopt;
+        }
+        return time;
+    }
+} first_buffer;
+
+
+static GstPadProbeReturn buffer_probe(GstPad* /*pad*/, GstPadProbeInfo* /*info*/, gpointer /*data*/)
+{
+    first_buffer.notify();
+    return GST_PAD_PROBE_OK;
+}
+
+
 static void create_pipeline()
 {
     GError* err = NULL;
     pipeline = gst_parse_launch("tcambin name=tcam \
                                 ! videoconvert \
-                                ! fakesink",
+                                ! fakesink name=sink",
                                 &err);
 
     if (pipeline == NULL)
     {
         printf("Unable to create pipeline.\n");
-        return;
+        exit(1);
     }
+
+    GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstPad* pad = gst_element_get_static_pad(sink, "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, nullptr, nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(sink);
+}
+
+
+static void destroy_pipeline()
+{
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    pipeline = nullptr;
 }
 
 
@@ -50,6 +124,7 @@ static void set_caps(const std::string& caps)
     }
 
     g_object_set(G_OBJECT(tcam), "device-caps", caps.c_str(), nullptr);
+    gst_object_unref(tcam);
 }
 
 
@@ -60,6 +135,7 @@ static void set_serial(const char* serial)
     if (tcam)
     {
         g_object_set(G_OBJECT(tcam), "serial", serial, nullptr);
+        gst_object_unref(tcam);
     }
     else
     {
@@ -69,6 +145,130 @@ static void set_serial(const char* serial)
 }
 
 
+static bool set_state_and_wait(GstState state)
+{
+    if (gst_element_set_state(pipeline, state) == GST_STATE_CHANGE_FAILURE)
+    {
+        return false;
+    }
+    const auto timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(first_buffer_timeout);
+    return gst_element_get_state(pipeline, nullptr, nullptr, timeout.count())
+           == GST_STATE_CHANGE_SUCCESS;
+}
+
+
+static double ms_since(clock_type::time_point begin, clock_type::time_point end = clock_type::now())
+{
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+
+// PLAYING until the first buffer arrived at the sink, in ms
+static std::optional<double> start_to_first_buffer(clock_type::time_point begin)
+{
+    first_buffer.reset();
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+    {
+        return std::nullopt;
+    }
+    auto arrival = first_buffer.wait();
+    if (!arrival)
+    {
+        return std::nullopt;
+    }
+    return ms_since(begin, *arrival);
+}
+
+
+struct measurement
+{
+    std::vector<double> samples_ms;
+    int failures = 0;
+
+    void add(std::optional<double> ms)
+    {
+        if (ms)
+        {
+            samples_ms.push_back(*ms);
+        }
+        else
+        {
+            failures++;
+        }
+    }
+
+    nlohmann::json percentiles() const
+    {
+        nlohmann::json ret;
+        ret["count"] = samples_ms.size();
+        ret["failures"] = failures;
+        if (samples_ms.empty())
+        {
+            return ret;
+        }
+
+        auto sorted = samples_ms;
+        std::sort(sorted.begin(), sorted.end());
+        auto at = [&sorted](double p)
+        {
+            return sorted.at(static_cast<size_t>(p * (sorted.size() - 1)));
+        };
+        ret["p50"] = at(0.5);
+        ret["p90"] = at(0.9);
+        ret["max"] = sorted.back();
+        return ret;
+    }
+};
+
+
+/*
+ * Baseline files contain the allowed upper limits in ms, e.g.
+ * { "start_to_first_buffer": { "p90": 800, "max": 1500 }, "teardown": { "p90": 300 } }
+ * Measurements or keys that are missing are not checked.
+ */
+static bool check_baseline(const nlohmann::json& results, const nlohmann::json& baseline)
+{
+    bool ret = true;
+    for (const auto& entry : baseline.items())
+    {
+        const std::string& name = entry.key();
+        const auto& limits = entry.value();
+        if (!results.contains(name))
+        {
+            continue;
+        }
+        const auto& result = results[name];
+
+        if (result.value("failures", 0) > 0)
+        {
+            printf("FAIL %s: %d runs did not complete\n", name.c_str(), result["failures"].get<int>());
+            ret = false;
+        }
+
+        for (const auto& limit_entry : limits.items())
+        {
+            const std::string& key = limit_entry.key();
+            const auto& limit = limit_entry.value();
+            if (!result.contains(key))
+            {
+                continue;
+            }
+            const double value = result[key].get<double>();
+            if (value > limit.get<double>())
+            {
+                printf("FAIL %s.%s: %.1f ms > %.1f ms\n",
+                       name.c_str(),
+                       key.c_str(),
+                       value,
+                       limit.get<double>());
+                ret = false;
+            }
+        }
+    }
+    return ret;
+}
+
+
 int main(int argc, char* argv[])
 {
     CLI::App app { "start-stop test" };
@@ -79,6 +279,12 @@ int main(int argc, char* argv[])
     std::string caps_str;
     app.add_option("-c,--caps", caps_str, "GStreamer caps the device shall use.", false);
 
+    std::string alt_caps_str;
+    app.add_option("--switch-caps",
+                   alt_caps_str,
+                   "Second caps, measures switching between --caps and these.",
+                   false);
+
     GstState rest_state { GST_STATE_NULL };
 
     std::map<std::string, GstState> state_map { { "NULL", GST_STATE_NULL },
@@ -87,6 +293,19 @@ int main(int argc, char* argv[])
     app.add_option("-r,--rest", rest_state, "\"Stop\" state that shall be used", "NULL")
         ->transform(CLI::CheckedTransformer(state_map, CLI::ignore_case));
 
+    unsigned int iterations = 5;
+    app.add_option("-n,--iterations", iterations, "How often every transition is measured", true);
+
+    unsigned int playing_time = 5;
+    app.add_option("--playing-time", playing_time, "Seconds to stay in PLAYING per iteration", true);
+
+    std::string baseline_file;
+    app.add_option("--baseline", baseline_file, "JSON file with the allowed latencies in ms", false)
+        ->check(CLI::ExistingFile);
+
+    std::string output_file;
+    app.add_option("--output", output_file, "Write the measured latencies as JSON to this file", false);
+
     // allow --gst-debug etc
     app.allow_extras(true);
 
@@ -98,27 +317,113 @@ int main(int argc, char* argv[])
 
     gst_init(&argc, &argv);
 
-    create_pipeline();
+    auto setup_pipeline = [&]()
+    {
+        create_pipeline();
+
+        if (!serial.empty())
+        {
+            set_serial(serial.c_str());
+        }
+
+        if (!caps_str.empty())
+        {
+            set_caps(caps_str);
+        }
+    };
+
+    setup_pipeline();
+
+    measurement start;
+    measurement teardown;
+    measurement caps_switch;
+    measurement reopen;
 
-    if (!serial.empty())
+    for (unsigned int i = 0; i < iterations; ++i)
     {
-        set_serial(serial.c_str());
+        start.add(start_to_first_buffer(clock_type::now()));
+
+        sleep(playing_time);
+
+        auto begin = clock_type::now();
+        if (set_state_and_wait(rest_state))
+        {
+            teardown.add(ms_since(begin));
+        }
+        else
+        {
+            teardown.add(std::nullopt);
+        }
     }
 
-    if (!caps_str.empty())
+    // stop, set the other caps and wait for its first buffer
+    for (unsigned int i = 0; !alt_caps_str.empty() && i < iterations; ++i)
     {
-        set_caps(caps_str);
+        if (!start_to_first_buffer(clock_type::now()))
+        {
+            caps_switch.add(std::nullopt);
+            continue;
+        }
+
+        // device-caps are only evaluated when tcambin leaves NULL
+        auto begin = clock_type::now();
+        set_state_and_wait(GST_STATE_NULL);
+        set_caps(i % 2 == 0 ? alt_caps_str : caps_str);
+        caps_switch.add(start_to_first_buffer(begin));
+
+        set_state_and_wait(GST_STATE_NULL);
     }
 
-    for (unsigned int i = 0; i < 5; ++i)
+    // a new pipeline has to open the device again
+    for (unsigned int i = 0; i < iterations; ++i)
     {
-        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        destroy_pipeline();
 
-        sleep(5);
+        auto begin = clock_type::now();
+        setup_pipeline();
+        reopen.add(start_to_first_buffer(begin));
 
-        gst_element_set_state(pipeline, rest_state);
+        set_state_and_wait(rest_state);
     }
+
     gst_element_set_state(pipeline, GST_STATE_NULL);
 
+    nlohmann::json results;
+    results["start_to_first_buffer"] = start.percentiles();
+    results["teardown"] = teardown.percentiles();
+    if (!alt_caps_str.empty())
+    {
+        results["caps_switch"] = caps_switch.percentiles();
+    }
+    results["device_reopen"] = reopen.percentiles();
+
+    printf("%s\n", results.dump(4).c_str());
+
+    if (!output_file.empty())
+    {
+        std::ofstream ofs(output_file);
+        ofs << results.dump(4) << std::endl;
+    }
+
+    if (!baseline_file.empty())
+    {
+        std::ifstream ifs(baseline_file);
+        nlohmann::json baseline;
+        try
+        {
+            ifs >> baseline;
+        }
+        catch (const nlohmann::json::exception& e)
+        {
+            printf("Unable to parse baseline file: %s\n", e.what());
+            return 1;
+        }
+
+        if (!check_baseline(results, baseline))
+        {
+            return 1;
+        }
+    }
+
     return 0;
 }
@@ -38,10 +38,14 @@ struct TcamCaptureConfig
     // if a capsfilter element named device-caps exists it will have the configured caps set
     // all tcam-property elements are named: tcam0, tcam1, etc
     // tcam0 is always source
+    // optional: videorate preview-rate and capsfilter preview-caps
+    // throttle and scale the display branch only
     QString pipeline =
         "tcambin name=tcam0 ! video/x-raw,format=BGRx "
         " ! tee name=capture-tee "
         " ! queue leaky=1 max-size-time=0 max-size-bytes=0 max-size-buffers=0"
+        " ! videorate name=preview-rate drop-only=true "
+        " ! videoscale n-threads=4 ! capsfilter name=preview-caps "
         " ! videoconvert n-threads=4 "
         " ! fpsdisplaysink video-sink={video-sink-element} sync=false name=sink "
         "text-overlay=false signal-fps-measurements=true";
@@ -54,12 +58,19 @@ struct TcamCaptureConfig
     QString save_video_filename_structure = "tcam-capture-{serial}-{caps}-{timestamp}.{extension}";
     VideoCodec save_video_type = VideoCodec::H264;
 
+    // scale the display branch down to the size of the display widget
+    bool preview_scale = true;
+    // 0 displays every frame
+    int preview_max_fps = 0;
+
     void save()
     {
         QSettings s;
 
         s.setValue("format_selection_type", (int)format_selection_type);
         s.setValue("conversion_element", (int)conversion_element);
+        s.setValue("preview_scale", preview_scale);
+        s.setValue("preview_max_fps", preview_max_fps);
 
         s.setValue("save_image_type", (int)save_image_type);
         s.setValue("save_image_location", save_image_location);
@@ -88,6 +99,8 @@ struct TcamCaptureConfig
 
         format_selection_type = (FormatHandling)s.value("format_selection_type", (int)format_selection_type).toInt();
         conversion_element = (ConversionElement)s.value("conversion_element", (int)conversion_element).toInt();
+        preview_scale = s.value("preview_scale", preview_scale).toBool();
+        preview_max_fps = s.value("preview_max_fps", preview_max_fps).toInt();
 
         auto tmp = s.value("pipeline", "").toString();
         if (!tmp.isEmpty())
@@ -56,6 +56,8 @@ enum class VideoCodec
     H264,
     //H265,
     MJPEG,
+    // unconverted buffers of the source, see raw_recorder.h
+    RAW,
 };
 
 
@@ -98,6 +100,10 @@ inline QString video_codec_to_string(VideoCodec c)
         {
             return "MJPEG";
         }
+        case VideoCodec::RAW:
+        {
+            return "RAW";
+        }
     }
     return "";
 }
@@ -113,6 +119,10 @@ inline QString video_codec_file_extension(QString c)
     {
         return "avi";
     }
+    if (c == video_codec_to_string(VideoCodec::RAW))
+    {
+        return "tcamraw";
+    }
     return "";
 }
 
@@ -128,6 +138,10 @@ inline QString video_codec_file_extension(VideoCodec c)
         {
             return "avi";
         }
+        case VideoCodec::RAW:
+        {
+            return "tcamraw";
+        }
     }
     return "";
 }
@@ -190,5 +204,6 @@ inline std::vector<QString> get_video_codec_names()
     return {
         "h264",
         "MJPEG",
+        "RAW",
     };
 }
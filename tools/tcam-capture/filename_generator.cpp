@@ -82,6 +82,7 @@ QString FileNameGenerator::get_help_text()
         "\t{serial} - Serial number of the used device\n"
         "\t{caps} - Used GstCaps\n"
         "\t{timestamp} - ISO datetime with ms YYYYmmDDTHHMMSS_zzz\n"
+        "\t{sequence} - Number of the image within a sequence, 000000, 000001, ...\n"
         "\t{extension} - File format";
 
 }
@@ -94,6 +95,7 @@ QString FileNameGenerator::preview(const QString &format)
     auto r = ret.replace(QString("{caps}"), QString("rggb_1920x1080@30_1"));
     qInfo("%s", r.toStdString().c_str());
     ret.replace(QString("{timestamp}"), QString("19990229T185534_456"));
+    ret.replace(QString("{sequence}"), QString("000001"));
 
     ret.replace(QString("{extension}"), file_extension_);
 
@@ -113,9 +115,22 @@ QString FileNameGenerator::generate()
 
     ret.replace(QString("{timestamp}"), current.toString("yyyyMMddThhmmss_zzz"));
 
+    // the counter only advances for patterns that use it
+    if (ret.contains(QString("{sequence}")))
+    {
+        ret.replace(QString("{sequence}"),
+                    QString("%1").arg(sequence_counter_++, 6, 10, QChar('0')));
+    }
+
     ret.replace(QString("{extension}"), file_extension_);
 
     return ret;
 }
 
+
+void FileNameGenerator::reset_sequence()
+{
+    sequence_counter_ = 0;
+}
+
 }
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "imagesequencesaver.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <QImage>
+#include <algorithm>
+#include <gst/video/video.h>
+
+namespace
+{
+
+constexpr unsigned int max_worker_count = 8;
+
+// images in flight per worker, limits the memory of buffered frames
+constexpr size_t pending_per_worker = 2;
+
+
+bool to_qimage_format(GstVideoFormat fmt, QImage::Format& out)
+{
+    switch (fmt)
+    {
+        case GST_VIDEO_FORMAT_BGRx:
+        {
+            // the padding byte is not an alpha value
+            out = QImage::Format_RGB32;
+            return true;
+        }
+        case GST_VIDEO_FORMAT_BGRA:
+        {
+            out = QImage::Format_ARGB32;
+            return true;
+        }
+        case GST_VIDEO_FORMAT_GRAY8:
+        {
+            out = QImage::Format_Grayscale8;
+            return true;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+} // namespace
+
+
+tcam::tools::capture::ImageSequenceSaver::ImageSequenceSaver(GstPipeline* pipeline,
+                                                             const QString& location,
+                                                             ImageSaveType type,
+                                                             const FileNameGenerator& generator,
+                                                             unsigned int worker_count)
+    : location_(location), generator_(generator), worker_count_(worker_count)
+{
+    format_ = image_save_type_to_string(type).toLower().toUtf8();
+
+    // every image needs its own name, timestamps are not unique at high frame rates
+    auto pattern = generator_.get_base_pattern();
+    if (!pattern.contains("{sequence}"))
+    {
+        const QString ext = ".{extension}";
+        if (pattern.endsWith(ext))
+        {
+            pattern.insert(pattern.size() - ext.size(), "-{sequence}");
+        }
+        else
+        {
+            pattern += "-{sequence}";
+        }
+        generator_.set_base_pattern(pattern);
+    }
+    generator_.reset_sequence();
+
+    if (worker_count_ == 0)
+    {
+        worker_count_ = std::clamp(std::thread::hardware_concurrency(), 1u, max_worker_count);
+    }
+    max_pending_ = worker_count_ * pending_per_worker;
+
+    if (GstElement* tee = gst_bin_get_by_name(GST_BIN(pipeline), "capture-tee"))
+    {
+        pad_ = gst_element_get_static_pad(tee, "sink");
+        gst_object_unref(tee);
+    }
+}
+
+
+tcam::tools::capture::ImageSequenceSaver::~ImageSequenceSaver()
+{
+    stop();
+
+    if (pad_)
+    {
+        gst_object_unref(pad_);
+    }
+}
+
+
+bool tcam::tools::capture::ImageSequenceSaver::start()
+{
+    if (!pad_)
+    {
+        qWarning("Saving image sequences needs an element named capture-tee");
+        return false;
+    }
+
+    stop_ = false;
+    for (unsigned int i = 0; i < worker_count_; ++i)
+    {
+        workers_.emplace_back(&ImageSequenceSaver::worker_loop, this);
+    }
+
+    probe_id_ = gst_pad_add_probe(pad_, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, this, nullptr);
+
+    qDebug("Saving image sequence to %s with %u workers",
+           location_.toStdString().c_str(),
+           worker_count_);
+    return true;
+}
+
+
+void tcam::tools::capture::ImageSequenceSaver::stop()
+{
+    if (probe_id_)
+    {
+        gst_pad_remove_probe(pad_, probe_id_);
+        probe_id_ = 0;
+    }
+
+    if (workers_.empty())
+    {
+        return;
+    }
+
+    {
+        std::unique_lock lck { mtx_ };
+        // accepted images are still saved
+        idle_cv_.wait(lck, [this] { return pending_ == 0; });
+        stop_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto& w : workers_) { w.join(); }
+    workers_.clear();
+
+    qDebug("Image sequence finished. %lu images saved, %lu dropped, %lu failed",
+           (unsigned long)images_saved_,
+           (unsigned long)images_dropped_,
+           (unsigned long)images_failed_);
+}
+
+
+GstPadProbeReturn tcam::tools::capture::ImageSequenceSaver::buffer_probe(GstPad* pad,
+                                                                         GstPadProbeInfo* info,
+                                                                         gpointer user_data)
+{
+    auto self = static_cast<ImageSequenceSaver*>(user_data);
+    self->push(pad, GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+
+void tcam::tools::capture::ImageSequenceSaver::push(GstPad* pad, GstBuffer* buffer)
+{
+    {
+        std::scoped_lock lck { mtx_ };
+        if (pending_ >= max_pending_ || stop_)
+        {
+            images_dropped_++;
+            return;
+        }
+        pending_++;
+    }
+
+    // keeping a reference would hold the buffer back from the pool of the source
+    GstBuffer* copy = gst_buffer_copy_deep(buffer);
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+
+    job j;
+    j.sample = gst_sample_new(copy, caps, nullptr, nullptr);
+    gst_buffer_unref(copy);
+    if (caps)
+    {
+        gst_caps_unref(caps);
+    }
+
+    {
+        std::scoped_lock lck { mtx_ };
+        // only the streaming thread generates names, they follow the frame order
+        j.sequence = next_sequence_++;
+        j.filename = location_ + "/" + generator_.generate();
+        queue_.push_back(std::move(j));
+    }
+    cv_.notify_one();
+}
+
+
+void tcam::tools::capture::ImageSequenceSaver::worker_loop()
+{
+    while (true)
+    {
+        job j;
+        {
+            std::unique_lock lck { mtx_ };
+            cv_.wait(lck, [this] { return !queue_.empty() || stop_; });
+            if (queue_.empty())
+            {
+                return;
+            }
+            j = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        encode(j);
+
+        gst_sample_unref(j.sample);
+        j.sample = nullptr;
+
+        finish(std::move(j));
+    }
+}
+
+
+void tcam::tools::capture::ImageSequenceSaver::encode(job& j) const
+{
+    GstVideoInfo info;
+    if (!gst_video_info_from_caps(&info, gst_sample_get_caps(j.sample)))
+    {
+        return;
+    }
+
+    QImage::Format format;
+    if (!to_qimage_format(GST_VIDEO_INFO_FORMAT(&info), format))
+    {
+        qWarning("Unable to save images in format %s", GST_VIDEO_INFO_NAME(&info));
+        return;
+    }
+
+    GstBuffer* buffer = gst_sample_get_buffer(j.sample);
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+    {
+        return;
+    }
+
+    // wraps the mapped memory, the buffer outlives the image
+    const QImage image(map.data,
+                       GST_VIDEO_INFO_WIDTH(&info),
+                       GST_VIDEO_INFO_HEIGHT(&info),
+                       GST_VIDEO_INFO_PLANE_STRIDE(&info, 0),
+                       format);
+
+    QBuffer output(&j.data);
+    output.open(QIODevice::WriteOnly);
+    if (!image.save(&output, format_.constData()))
+    {
+        j.data.clear();
+    }
+
+    gst_buffer_unmap(buffer, &map);
+}
+
+
+void tcam::tools::capture::ImageSequenceSaver::finish(job&& j)
+{
+    std::unique_lock lck { mtx_ };
+    finished_.emplace(j.sequence, std::move(j));
+
+    if (writing_)
+    {
+        // the writing thread picks it up once the predecessors are written
+        return;
+    }
+    writing_ = true;
+
+    while (!finished_.empty() && finished_.begin()->first == next_write_)
+    {
+        job next = std::move(finished_.begin()->second);
+        finished_.erase(finished_.begin());
+        lck.unlock();
+
+        bool written = false;
+        if (!next.data.isEmpty())
+        {
+            QFile file(next.filename);
+            written = file.open(QIODevice::WriteOnly)
+                      && file.write(next.data) == next.data.size();
+        }
+        if (written)
+        {
+            images_saved_++;
+        }
+        else
+        {
+            qWarning("Unable to save %s", next.filename.toStdString().c_str());
+            images_failed_++;
+        }
+
+        lck.lock();
+        next_write_++;
+        pending_--;
+    }
+
+    writing_ = false;
+    if (pending_ == 0)
+    {
+        idle_cv_.notify_all();
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "definitions.h"
+#include "filename_generator.h"
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <gst/gst.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcam::tools::capture
+{
+
+/*
+ * Saves every frame of the capture-tee as a separate image file.
+ *
+ * The streaming thread only copies the buffer and assigns the next filename,
+ * a pool of worker threads encodes the images in parallel.
+ * Encoded images are written in the order they arrived.
+ * Frames that arrive while max_pending images are in flight are dropped and counted,
+ * the pipeline is never blocked.
+ */
+class ImageSequenceSaver
+{
+public:
+    // worker_count 0 uses one worker per core, at most 8
+    ImageSequenceSaver(GstPipeline* pipeline,
+                       const QString& location,
+                       ImageSaveType type,
+                       const FileNameGenerator& generator,
+                       unsigned int worker_count = 0);
+    ~ImageSequenceSaver();
+
+    ImageSequenceSaver(const ImageSequenceSaver&) = delete;
+    ImageSequenceSaver& operator=(const ImageSequenceSaver&) = delete;
+
+    bool start();
+    // waits until all accepted images are written
+    void stop();
+
+    uint64_t images_saved() const
+    {
+        return images_saved_;
+    }
+    uint64_t images_dropped() const
+    {
+        return images_dropped_;
+    }
+    // encoding or writing failed
+    uint64_t images_failed() const
+    {
+        return images_failed_;
+    }
+
+private:
+    struct job
+    {
+        uint64_t sequence = 0;
+        GstSample* sample = nullptr;
+        QString filename;
+        // encoded image, empty when encoding failed
+        QByteArray data;
+    };
+
+    static GstPadProbeReturn buffer_probe(GstPad*, GstPadProbeInfo*, gpointer);
+
+    void push(GstPad* pad, GstBuffer* buffer);
+    void worker_loop();
+    void encode(job& j) const;
+    // hands the encoded job to the writer, writes when it is the next in sequence
+    void finish(job&& j);
+
+    GstPad* pad_ = nullptr;
+    gulong probe_id_ = 0;
+
+    QString location_;
+    QByteArray format_;
+    FileNameGenerator generator_;
+
+    unsigned int worker_count_ = 0;
+    size_t max_pending_ = 0;
+    std::vector<std::thread> workers_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<job> queue_;
+    // encoded images waiting for their predecessors
+    std::map<uint64_t, job> finished_;
+    // queued, being encoded or waiting in finished_
+    size_t pending_ = 0;
+    uint64_t next_sequence_ = 0;
+    uint64_t next_write_ = 0;
+    // only one thread writes at a time, the others leave their images in finished_
+    bool writing_ = false;
+    bool stop_ = false;
+
+    std::atomic<uint64_t> images_saved_ = 0;
+    std::atomic<uint64_t> images_dropped_ = 0;
+    std::atomic<uint64_t> images_failed_ = 0;
+};
+
+} // namespace tcam::tools::capture
@@ -22,6 +22,7 @@
 #include <QErrorMessage>
 #include <QMenu>
 #include <QMessageBox>
+#include <algorithm>
 // #include <QVideoWidget>
 #include "aboutdialog.h"
 #include "caps.h"
@@ -117,6 +118,14 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
     connect(p_action_save_image, &QAction::triggered, this, &MainWindow::save_image_triggered);
     p_toolbar->addAction(p_action_save_image);
 
+    p_action_save_image_sequence = new QAction(QIcon(":/images/snap.png"), "Record Images");
+    p_action_save_image_sequence->setToolTip("Save every frame as an image");
+    connect(p_action_save_image_sequence,
+            &QAction::triggered,
+            this,
+            &MainWindow::save_image_sequence_triggered);
+    p_toolbar->addAction(p_action_save_image_sequence);
+
     p_action_save_video = new QAction(QIcon(":/images/start_capture.png"), "Record Video");
     connect(p_action_save_video, &QAction::triggered, this, &MainWindow::save_video_triggered);
     p_toolbar->addAction(p_action_save_video);
@@ -130,6 +139,12 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     this->statusBar()->addPermanentWidget(p_fps_label);
 
+    p_image_sequence_timer = new QTimer(this);
+    connect(p_image_sequence_timer,
+            &QTimer::timeout,
+            this,
+            &MainWindow::update_image_sequence_status);
+
     enable_device_gui_elements(false);
 
     // open device dialog to make it more obvious what to do next
@@ -321,6 +336,32 @@ GstPadProbeReturn MainWindow::pad_probe_callback (GstPad* /*pad*/,
 }
 
 
+GstPadProbeReturn MainWindow::tee_probe_callback(GstPad* pad,
+                                                GstPadProbeInfo* info,
+                                                gpointer user_data)
+{
+    MainWindow* self = (MainWindow*)user_data;
+
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    GstSample* sample = gst_sample_new(GST_PAD_PROBE_INFO_BUFFER(info), caps, nullptr, nullptr);
+    if (caps)
+    {
+        gst_caps_unref(caps);
+    }
+
+    {
+        std::scoped_lock lck { self->m_last_sample_mtx };
+        std::swap(sample, self->p_last_sample);
+    }
+    if (sample)
+    {
+        gst_sample_unref(sample);
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+
 void MainWindow::on_actionOpen_Device_triggered()
 {
     DeviceDialog dialog(m_index);
@@ -614,6 +655,8 @@ void MainWindow::open_pipeline(FormatHandling handling)
         }
 
     }
+    configure_preview();
+
     gst_element_set_state(p_pipeline, GST_STATE_PLAYING);
 
     connect(&m_fps_counter, &FPSCounter::new_fps_measurement, this, &MainWindow::fps_tick);
@@ -673,6 +716,8 @@ void MainWindow::close_pipeline()
 
     enable_device_gui_elements(false);
 
+    stop_image_sequence();
+
     if (p_pipeline)
     {
         gst_element_set_state(p_pipeline, GST_STATE_NULL);
@@ -689,6 +734,14 @@ void MainWindow::close_pipeline()
         m_device_caps.clear();
 
         p_source = nullptr;
+        m_tee_probe_id = 0;
+
+        std::scoped_lock lck { m_last_sample_mtx };
+        if (p_last_sample)
+        {
+            gst_sample_unref(p_last_sample);
+            p_last_sample = nullptr;
+        }
     }
 
     reset_fps_tick();
@@ -700,6 +753,77 @@ void MainWindow::close_pipeline()
 }
 
 
+void MainWindow::configure_preview()
+{
+    if (GstElement* rate = gst_bin_get_by_name(GST_BIN(p_pipeline), "preview-rate"))
+    {
+        int max_rate = m_config.preview_max_fps > 0 ? m_config.preview_max_fps : G_MAXINT;
+        g_object_set(rate, "max-rate", max_rate, nullptr);
+        gst_object_unref(rate);
+    }
+
+    GstElement* tee = gst_bin_get_by_name(GST_BIN(p_pipeline), "capture-tee");
+    if (tee && m_tee_probe_id == 0)
+    {
+        GstPad* pad = gst_element_get_static_pad(tee, "sink");
+        m_tee_probe_id =
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, tee_probe_callback, this, nullptr);
+        gst_object_unref(pad);
+    }
+    if (tee)
+    {
+        gst_object_unref(tee);
+    }
+
+    GstElement* capsfilter = gst_bin_get_by_name(GST_BIN(p_pipeline), "preview-caps");
+    if (!capsfilter)
+    {
+        return;
+    }
+
+    int width = 0;
+    int height = 0;
+    if (p_selected_caps && !gst_caps_is_empty(p_selected_caps))
+    {
+        GstStructure* s = gst_caps_get_structure(p_selected_caps, 0);
+        gst_structure_get_int(s, "width", &width);
+        gst_structure_get_int(s, "height", &height);
+    }
+
+    // decimate by an integer factor so that the image fits the widget
+    // resizing the window afterwards is handled by the video sink
+    const double ratio = ui->widget->devicePixelRatioF();
+    const int widget_width = std::max(1, (int)(ui->widget->width() * ratio));
+    const int widget_height = std::max(1, (int)(ui->widget->height() * ratio));
+
+    int factor = 1;
+    if (m_config.preview_scale && width > 0 && height > 0)
+    {
+        factor = std::max((width + widget_width - 1) / widget_width,
+                          (height + widget_height - 1) / widget_height);
+    }
+
+    GstCaps* caps = nullptr;
+    if (factor > 1)
+    {
+        caps = gst_caps_new_simple("video/x-raw",
+                                   "width", G_TYPE_INT, width / factor,
+                                   "height", G_TYPE_INT, height / factor,
+                                   nullptr);
+        qInfo("Preview is decimated by %d to %dx%d", factor, width / factor, height / factor);
+    }
+    else
+    {
+        caps = gst_caps_new_any();
+    }
+
+    g_object_set(capsfilter, "caps", caps, nullptr);
+
+    gst_caps_unref(caps);
+    gst_object_unref(capsfilter);
+}
+
+
 void MainWindow::load_settings()
 {
     m_config.load();
@@ -818,6 +942,7 @@ void MainWindow::enable_device_gui_elements(bool toggle)
     p_action_format_dialog->setEnabled(toggle);
 
     p_action_save_image->setEnabled(toggle);
+    p_action_save_image_sequence->setEnabled(toggle);
     p_action_save_video->setEnabled(toggle);
 
     if (p_about)
@@ -893,9 +1018,22 @@ void MainWindow::fps_tick(double new_fps)
         // if you need the associated caps
         // GstCaps* c = gst_sample_get_caps(sample);
 
+        // the structure meta is only attached when tcamsrc has statistics-structure=true
+        GstMeta* meta = nullptr;
         auto meta_api = g_type_from_name("TcamStatisticsMetaApi");
+        if (meta_api != 0)
+        {
+            meta = gst_buffer_get_meta(buffer, meta_api);
+        }
+
+        GstMeta* values_meta = nullptr;
+        auto values_meta_api = g_type_from_name("TcamStatisticsValuesMetaApi");
+        if (values_meta_api != 0)
+        {
+            values_meta = gst_buffer_get_meta(buffer, values_meta_api);
+        }
 
-        if (meta_api == 0)
+        if (meta_api == 0 && values_meta_api == 0)
         {
             // this means TcamStatistics is not a registered type
             // tegrasrc or similar might cause this
@@ -903,8 +1041,6 @@ void MainWindow::fps_tick(double new_fps)
             return;
         }
 
-        GstMeta* meta = gst_buffer_get_meta(buffer, meta_api);
-
         if (meta)
         {
             GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
@@ -912,6 +1048,29 @@ void MainWindow::fps_tick(double new_fps)
             // will be freed by receiver
             emit new_meta(gst_structure_copy(struc));
         }
+        else if (values_meta)
+        {
+            const TcamStatisticsValues& values = ((TcamStatisticsValuesMeta*)values_meta)->values;
+
+            // will be freed by receiver
+            emit new_meta(gst_structure_new("TcamStatistics",
+                                            "frame_count",
+                                            G_TYPE_UINT64,
+                                            values.frame_count,
+                                            "frames_dropped",
+                                            G_TYPE_UINT64,
+                                            values.frames_dropped,
+                                            "capture_time_ns",
+                                            G_TYPE_UINT64,
+                                            values.capture_time_ns,
+                                            "camera_time_ns",
+                                            G_TYPE_UINT64,
+                                            values.camera_time_ns,
+                                            "is_damaged",
+                                            G_TYPE_BOOLEAN,
+                                            values.is_damaged,
+                                            nullptr));
+        }
         else
         {
             static bool sample_warning_issued;
@@ -1080,7 +1239,18 @@ void MainWindow::save_image_triggered()
     GstSample* sample = nullptr;
     /* Retrieve the buffer */
 
-    g_object_get(sink, "last-sample", &sample, nullptr);
+    {
+        std::scoped_lock lck { m_last_sample_mtx };
+        if (p_last_sample)
+        {
+            sample = gst_sample_ref(p_last_sample);
+        }
+    }
+
+    if (!sample)
+    {
+        g_object_get(sink, "last-sample", &sample, nullptr);
+    }
 
     if (sample)
     {
@@ -1156,6 +1326,85 @@ void MainWindow::save_image_triggered()
 }
 
 
+void MainWindow::save_image_sequence_triggered()
+{
+    if (image_sequence_saver_)
+    {
+        stop_image_sequence();
+        return;
+    }
+
+    QString caps_str;
+    if (p_selected_caps)
+    {
+        caps_str = tcam::tools::capture::caps_to_file_str(*p_selected_caps);
+    }
+
+    auto fng = tcam::tools::capture::FileNameGenerator(m_selected_device.serial_long().c_str(),
+                                                       caps_str);
+    fng.set_base_pattern(m_config.save_image_filename_structure);
+    fng.set_file_extension(image_save_type_to_string(m_config.save_image_type).toLower());
+
+    image_sequence_saver_ = std::make_unique<tcam::tools::capture::ImageSequenceSaver>(
+        GST_PIPELINE(p_pipeline), m_config.save_image_location, m_config.save_image_type, fng);
+
+    if (!image_sequence_saver_->start())
+    {
+        image_sequence_saver_ = nullptr;
+        statusBar()->showMessage("ERROR! Unable to save images.", 5000);
+        return;
+    }
+
+    p_action_save_image_sequence->setText("Stop Recording Images");
+    p_action_save_image_sequence->setIcon(QIcon(":/images/stop.png"));
+
+    update_image_sequence_status();
+    p_image_sequence_timer->start(500);
+}
+
+
+void MainWindow::update_image_sequence_status()
+{
+    if (!image_sequence_saver_)
+    {
+        return;
+    }
+
+    statusBar()->showMessage(QString("Saving images to %1: %2 saved, %3 dropped")
+                                 .arg(m_config.save_image_location)
+                                 .arg(image_sequence_saver_->images_saved())
+                                 .arg(image_sequence_saver_->images_dropped()));
+}
+
+
+void MainWindow::stop_image_sequence()
+{
+    if (!image_sequence_saver_)
+    {
+        return;
+    }
+
+    p_image_sequence_timer->stop();
+
+    // writes the images that are still being encoded
+    image_sequence_saver_->stop();
+
+    QString msg = QString("Saved %1 images, %2 dropped")
+                      .arg(image_sequence_saver_->images_saved())
+                      .arg(image_sequence_saver_->images_dropped());
+    if (image_sequence_saver_->images_failed() > 0)
+    {
+        msg += QString(", %1 failed").arg(image_sequence_saver_->images_failed());
+    }
+    statusBar()->showMessage(msg, 5000);
+
+    image_sequence_saver_ = nullptr;
+
+    p_action_save_image_sequence->setText("Record Images");
+    p_action_save_image_sequence->setIcon(QIcon(":/images/snap.png"));
+}
+
+
 void MainWindow::save_video_triggered()
 {
     if (!video_saver_)
@@ -1178,7 +1427,14 @@ void MainWindow::save_video_triggered()
         p_action_save_video->setText("Stop Recording");
         p_action_save_video->setIcon(QIcon(":/images/stop.png"));
 
-        statusBar()->showMessage("Saving video: " + name);
+        if (video_saver_->is_passthrough())
+        {
+            statusBar()->showMessage("Saving video without re-encoding: " + name);
+        }
+        else
+        {
+            statusBar()->showMessage("Saving video: " + name);
+        }
     }
     else
     {
@@ -1188,6 +1444,13 @@ void MainWindow::save_video_triggered()
         // do not delete saver
         // still need to wait on EOS
         //video_saver_ = nullptr;
+        if (!video_saver_->waits_for_eos())
+        {
+            video_saver_->destroy_pipeline();
+            video_saver_ = nullptr;
+
+            statusBar()->showMessage("Saved video. ", 5000);
+        }
 
         // Reset GUI
 
@@ -21,6 +21,7 @@
 #include "config.h"
 #include "definitions.h"
 #include "fpscounter.h"
+#include "imagesequencesaver.h"
 #include "indexer.h"
 #include "tcamcollection.h"
 #include "videosaver.h"
@@ -32,6 +33,7 @@
 #include <QToolBar>
 #include <gst/gst.h>
 #include <memory>
+#include <mutex>
 
 class PropertyDialog;
 
@@ -66,6 +68,7 @@ public slots:
     void device_lost_cb(const Device& dev);
 
     void save_image_triggered();
+    void save_image_sequence_triggered();
     void save_video_triggered();
 
 private slots:
@@ -111,6 +114,7 @@ private:
     QToolBar* p_toolbar = nullptr;
     QAction* p_action_save_video = nullptr;
     QAction* p_action_save_image = nullptr;
+    QAction* p_action_save_image_sequence = nullptr;
 
     QAction* p_action_property_dialog = nullptr;
     QAction* p_action_format_dialog = nullptr;
@@ -132,16 +136,27 @@ private:
 
     std::unique_ptr<tcam::tools::capture::VideoSaver> video_saver_ = nullptr;
 
+    std::unique_ptr<tcam::tools::capture::ImageSequenceSaver> image_sequence_saver_ = nullptr;
+    // shows saved and dropped images while a sequence is saved
+    QTimer* p_image_sequence_timer = nullptr;
+    void update_image_sequence_status();
+    void stop_image_sequence();
+
     static gboolean bus_callback(GstBus* /*bus*/, GstMessage* message, gpointer user_data);
     static GstPadProbeReturn pad_probe_callback(GstPad* pad,
                                                 GstPadProbeInfo* info,
                                                 gpointer user_data);
+    static GstPadProbeReturn tee_probe_callback(GstPad* pad,
+                                                GstPadProbeInfo* info,
+                                                gpointer user_data);
 
     void reset_fps_tick();
     GstCaps* open_format_dialog();
 
     void open_pipeline(FormatHandling);
     void close_pipeline();
+    // throttle and scale the display branch, see TcamCaptureConfig::pipeline
+    void configure_preview();
 
     void load_settings();
     void save_settings();
@@ -150,5 +165,10 @@ private:
 
     GstCaps* p_selected_caps = nullptr;
     QString m_device_caps;
+
+    // full resolution image for saving, the display sink may only see a scaled preview
+    std::mutex m_last_sample_mtx;
+    GstSample* p_last_sample = nullptr;
+    gulong m_tee_probe_id = 0;
 };
 #endif // MAINWINDOW_H
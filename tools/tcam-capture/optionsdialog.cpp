@@ -93,6 +93,9 @@ void OptionsDialog::setup_general()
     }
 
     ui->combo_convert_options->setCurrentIndex(active_index);
+
+    ui->previewScaleCheckBox->setChecked(app_config.preview_scale);
+    ui->previewFpsSpinBox->setValue(app_config.preview_max_fps);
 }
 
 void OptionsDialog::setup_image()
@@ -295,6 +298,8 @@ void OptionsDialog::update_video_filename_extension_preview(const QString& new_e
 TcamCaptureConfig OptionsDialog::get_config()
 {
     app_config.conversion_element = (ConversionElement)ui->combo_convert_options->currentIndex();
+    app_config.preview_scale = ui->previewScaleCheckBox->isChecked();
+    app_config.preview_max_fps = ui->previewFpsSpinBox->value();
 
     // save image settings
     app_config.save_image_type = (ImageSaveType)ui->saveImageAsComboBox->currentIndex();
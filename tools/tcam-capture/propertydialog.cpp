@@ -66,6 +66,7 @@ PropertyDialog::PropertyDialog(TcamCollection& collection, QWidget* parent)
     p_work_thread = new QThread(this);
     p_work_thread->start();
     p_worker = new PropertyWorker();
+    p_worker->connect_change_notification(collection);
 
     p_worker->moveToThread(p_work_thread);
 
@@ -84,6 +85,9 @@ PropertyDialog::~PropertyDialog()
         p_work_thread->quit();
     }
     p_work_thread->wait();
+
+    // disconnects from the change notifications
+    delete p_worker;
 }
 
 
@@ -95,15 +99,30 @@ void PropertyDialog::notify_device_lost(const QString& info)
 
 void PropertyDialog::update_tab(int index)
 {
+    // only the visible tab is refreshed
     auto name = ui->tabWidget->tabText(index);
-    emit this->update_category(name);
+    emit this->visible_category_changed(name);
 }
 
 
 void PropertyDialog::refresh()
 {
     int index = ui->tabWidget->currentIndex();
-    update_tab(index);
+    emit this->update_category(ui->tabWidget->tabText(index));
+}
+
+
+void PropertyDialog::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    update_tab(ui->tabWidget->currentIndex());
+}
+
+
+void PropertyDialog::hideEvent(QHideEvent* event)
+{
+    emit this->visible_category_changed("");
+    QDialog::hideEvent(event);
 }
 
 
@@ -292,6 +311,7 @@ void PropertyDialog::initialize_dialog(TcamCollection& collection)
     connect(ui->tabWidget, &QTabWidget::currentChanged, this, &PropertyDialog::update_tab);
     // updates shall be done in another context
     connect(this, &PropertyDialog::update_category, p_worker, &PropertyWorker::update_category);
+    connect(this, &PropertyDialog::visible_category_changed, p_worker, &PropertyWorker::set_visible_category);
 
     // connect buttons
     connect(ui->button_update, &QPushButton::clicked, this, &PropertyDialog::refresh);
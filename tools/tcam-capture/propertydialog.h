@@ -62,10 +62,17 @@ public slots:
 
     void keyPressEvent(QKeyEvent* event);
 
+protected:
+
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 signals:
 
     void device_lost(const QString& info);
     void update_category(QString name);
+    // empty when the dialog is hidden
+    void visible_category_changed(QString name);
 
 private:
     void initialize_dialog(TcamCollection& collection);
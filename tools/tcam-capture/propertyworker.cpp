@@ -17,10 +17,64 @@
 #include "propertyworker.h"
 
 #include "propertywidget.h"
+#include "tcamcollection.h"
+
 #include <QThread>
 
+namespace
+{
+// how long refresh requests are collected
+// sources without 'tcam-properties-changed' only show changes through these refreshes
+constexpr int update_interval_ms = 100;
+// a write refreshes its whole category when no change notification arrives in this time,
+// the sources only notify while streaming
+constexpr int notification_timeout_ms = 500;
+} // namespace
+
+
 PropertyWorker::PropertyWorker()
-{}
+    : p_update_timer(new QTimer(this))
+{
+    p_update_timer->setSingleShot(true);
+    p_update_timer->setInterval(update_interval_ms);
+    connect(p_update_timer, &QTimer::timeout, this, &PropertyWorker::flush_updates);
+}
+
+
+PropertyWorker::~PropertyWorker()
+{
+    for (auto& [element, id] : m_change_handlers)
+    {
+        g_signal_handler_disconnect(element, id);
+        gst_object_unref(element);
+    }
+}
+
+
+void PropertyWorker::connect_change_notification(const TcamCollection& collection)
+{
+    for (auto* element : collection.get_property_change_sources())
+    {
+        auto id = g_signal_connect(element,
+                                   "tcam-properties-changed",
+                                   G_CALLBACK(&PropertyWorker::on_properties_changed),
+                                   this);
+        m_change_handlers.emplace_back(element, id);
+    }
+}
+
+
+// called from the streaming thread
+void PropertyWorker::on_properties_changed(GstElement* /*element*/,
+                                           gchar** names,
+                                           PropertyWorker* self)
+{
+    QStringList list;
+    for (gchar** n = names; n && *n; ++n) { list.append(QString(*n)); }
+
+    QMetaObject::invokeMethod(
+        self, [self, list] { self->refresh_changed(list); }, Qt::QueuedConnection);
+}
 
 
 void PropertyWorker::add_properties(const std::vector<Property*>& new_props)
@@ -33,12 +87,80 @@ void PropertyWorker::write_property(Property* p)
 {
     p->set_in_backend();
 
-    const auto cat = p->get_category();
-    const auto name = p->get_name();
+    // other properties of the category may have changed as well
+    request_update(p->get_category(), p->get_name());
+}
+
+
+void PropertyWorker::update_category(QString category)
+{
+    request_update(category.toStdString());
+}
+
+
+void PropertyWorker::set_visible_category(QString category)
+{
+    m_visible_category = category.toStdString();
+
+    // a pending refresh of the previous category is obsolete
+    m_update_pending = false;
+
+    if (!m_visible_category.empty())
+    {
+        request_update(m_visible_category);
+    }
+}
+
+
+void PropertyWorker::request_update(const std::string& category, const QString& written)
+{
+    if (category != m_visible_category)
+    {
+        return;
+    }
+
+    // the notification names everything the write affected
+    const bool notified = !written.isEmpty() && !m_change_handlers.empty();
+
+    if (!m_update_pending)
+    {
+        m_skip_name = written;
+        m_wait_for_notification = notified;
+    }
+    else
+    {
+        if (m_skip_name != written)
+        {
+            m_skip_name.clear();
+        }
+        m_wait_for_notification = m_wait_for_notification && notified;
+    }
+    m_update_pending = true;
+
+    const int interval = m_wait_for_notification ? notification_timeout_ms : update_interval_ms;
+    if (!p_update_timer->isActive() || p_update_timer->remainingTime() > interval)
+    {
+        p_update_timer->start(interval);
+    }
+}
+
+
+void PropertyWorker::refresh_changed(QStringList names)
+{
+    if (m_update_pending && m_wait_for_notification)
+    {
+        p_update_timer->stop();
+        m_update_pending = false;
+        m_skip_name.clear();
+    }
 
     for (auto& prop : m_properties)
     {
-        if (name != prop->get_name() && prop->get_category() == cat)
+        if (prop->get_category() != m_visible_category)
+        {
+            continue;
+        }
+        if (names.contains(prop->get_name()))
         {
             prop->update();
         }
@@ -46,13 +168,25 @@ void PropertyWorker::write_property(Property* p)
 }
 
 
-void PropertyWorker::update_category(QString category)
+void PropertyWorker::flush_updates()
 {
+    if (!m_update_pending)
+    {
+        return;
+    }
+    m_update_pending = false;
+
     for (auto& prop : m_properties)
     {
-        if (prop->get_category() == category.toStdString())
+        if (prop->get_category() != m_visible_category)
         {
-            prop->update();
+            continue;
+        }
+        if (!m_skip_name.isEmpty() && prop->get_name() == m_skip_name)
+        {
+            continue;
         }
+        prop->update();
     }
+    m_skip_name.clear();
 }
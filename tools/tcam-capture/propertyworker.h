@@ -17,27 +17,70 @@
 #ifndef PROPERTYWORKER_H
 #define PROPERTYWORKER_H
 
+#include <QStringList>
 #include <QTimer>
+#include <gst/gst.h>
+#include <string>
+#include <utility>
 #include <vector>
 
 class Property;
+class TcamCollection;
 
+/*
+ * Reads and writes properties outside of the GUI thread.
+ *
+ * Sources that emit 'tcam-properties-changed' name the properties that changed,
+ * only those are read again.
+ * Everything else, explicit refreshes and sources without the signal,
+ * is collected and handled once per tick with a single read per property.
+ * Only the category that is currently visible is refreshed.
+ */
 class PropertyWorker : public QObject
 {
     Q_OBJECT
 public:
     PropertyWorker();
+    ~PropertyWorker();
 
     void add_properties(const std::vector<Property*>& new_props);
 
+    // call before the worker is moved to its thread
+    void connect_change_notification(const TcamCollection& collection);
+
 public slots:
 
     void update_category(QString category);
 
     void write_property(Property* p);
 
+    // empty when no category is shown
+    void set_visible_category(QString category);
+
+private slots:
+
+    void flush_updates();
+
+    void refresh_changed(QStringList names);
+
 private:
+    void request_update(const std::string& category, const QString& written = {});
+
+    static void on_properties_changed(GstElement* element, gchar** names, PropertyWorker* self);
+
     std::vector<Property*> m_properties;
+
+    std::vector<std::pair<GstElement*, gulong>> m_change_handlers;
+
+    QTimer* p_update_timer = nullptr;
+    std::string m_visible_category;
+    bool m_update_pending = false;
+    // the pending update only exists because of writes,
+    // a change notification makes it obsolete
+    bool m_wait_for_notification = false;
+    // a written property already shows its new value,
+    // only valid while it is the only reason for the pending update
+    QString m_skip_name;
 };
 
 #endif // PROPERTYWORKER_H
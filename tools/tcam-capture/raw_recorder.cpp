@@ -0,0 +1,342 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "raw_recorder.h"
+
+#include <QDebug>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace
+{
+
+using tcam::tools::capture::raw_block_size;
+
+// grow the file in large steps, keeps the extents contiguous
+constexpr uint64_t prealloc_chunk = 1024ull * 1024 * 1024;
+
+constexpr size_t min_slot_count = 4;
+
+size_t align_up(size_t value)
+{
+    return (value + raw_block_size - 1) / raw_block_size * raw_block_size;
+}
+
+} // namespace
+
+
+tcam::tools::capture::RawRecorder::RawRecorder(GstElement* source,
+                                               const QString& filename,
+                                               size_t ring_size)
+    : filename_(filename), ring_size_(ring_size)
+{
+    if (source)
+    {
+        pad_ = gst_element_get_static_pad(source, "src");
+    }
+}
+
+
+tcam::tools::capture::RawRecorder::~RawRecorder()
+{
+    stop();
+
+    if (pad_)
+    {
+        gst_object_unref(pad_);
+    }
+    free(ring_);
+    free(file_header_);
+}
+
+
+bool tcam::tools::capture::RawRecorder::start()
+{
+    if (!pad_)
+    {
+        qWarning("Raw recording needs a source element");
+        return false;
+    }
+
+    auto name = filename_.toStdString();
+
+    fd_ = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    direct_io_ = fd_ >= 0;
+    if (fd_ < 0 && errno == EINVAL)
+    {
+        // tmpfs and some network file systems do not support O_DIRECT
+        fd_ = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    if (fd_ < 0)
+    {
+        qWarning("Unable to open %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (posix_memalign((void**)&file_header_, raw_block_size, sizeof(raw_file_header)) != 0)
+    {
+        return false;
+    }
+    memset(file_header_, 0, sizeof(raw_file_header));
+    memcpy(file_header_->magic, "TCAMRAW", 8);
+    file_header_->version = 1;
+    file_header_->block_size = raw_block_size;
+
+    GstCaps* caps = gst_pad_get_current_caps(pad_);
+    if (caps)
+    {
+        gchar* str = gst_caps_to_string(caps);
+        strncpy(file_header_->caps, str, sizeof(file_header_->caps) - 1);
+        g_free(str);
+        gst_caps_unref(caps);
+    }
+
+    // the slots are carved out once the first buffer size is known,
+    // the pages are only touched when they are filled
+    ring_size_ = align_up(ring_size_);
+    if (posix_memalign((void**)&ring_, raw_block_size, ring_size_) != 0)
+    {
+        qWarning("Unable to allocate %zu bytes for raw recording", ring_size_);
+        ring_ = nullptr;
+        return false;
+    }
+
+    if (!write_header())
+    {
+        return false;
+    }
+
+    stop_ = false;
+    writer_ = std::thread(&RawRecorder::writer_loop, this);
+
+    probe_id_ = gst_pad_add_probe(pad_, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, this, nullptr);
+
+    qDebug("Raw recording to %s, direct io: %d", name.c_str(), direct_io_);
+    return true;
+}
+
+
+void tcam::tools::capture::RawRecorder::stop()
+{
+    if (probe_id_)
+    {
+        gst_pad_remove_probe(pad_, probe_id_);
+        probe_id_ = 0;
+    }
+
+    if (writer_.joinable())
+    {
+        {
+            std::scoped_lock lck { mtx_ };
+            stop_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+    }
+
+    if (fd_ >= 0)
+    {
+        write_index();
+        write_header();
+
+        close(fd_);
+        fd_ = -1;
+
+        qDebug("Raw recording finished. %lu frames written, %lu dropped",
+               (unsigned long)frames_written_,
+               (unsigned long)frames_dropped_);
+    }
+}
+
+
+GstPadProbeReturn tcam::tools::capture::RawRecorder::buffer_probe(GstPad* /*pad*/,
+                                                                  GstPadProbeInfo* info,
+                                                                  gpointer user_data)
+{
+    auto self = static_cast<RawRecorder*>(user_data);
+    self->push(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+
+void tcam::tools::capture::RawRecorder::push(GstBuffer* buffer)
+{
+    const size_t size = gst_buffer_get_size(buffer);
+
+    if (slot_size_ == 0)
+    {
+        // headroom for formats whose buffer size varies slightly
+        slot_size_ = align_up(sizeof(raw_frame_header) + size + size / 8);
+        slot_count_ = ring_size_ / slot_size_;
+        if (slot_count_ < min_slot_count)
+        {
+            qWarning("Raw recording ring only holds %zu frames", slot_count_);
+        }
+    }
+
+    const uint64_t frame_number = frame_number_++;
+
+    size_t slot = 0;
+    {
+        std::scoped_lock lck { mtx_ };
+        if (sizeof(raw_frame_header) + size > slot_size_ || filled_ >= slot_count_ || stop_)
+        {
+            frames_dropped_++;
+            return;
+        }
+        slot = head_;
+    }
+
+    // only this thread touches the slot at head_ until it is published
+    uint8_t* dst = ring_ + slot * slot_size_;
+
+    auto header = reinterpret_cast<raw_frame_header*>(dst);
+    memset(header, 0, sizeof(raw_frame_header));
+    memcpy(header->magic, "FRME", 4);
+    header->header_size = sizeof(raw_frame_header);
+    header->size = size;
+    header->pts = GST_BUFFER_PTS(buffer);
+    header->frame_number = frame_number;
+
+    gst_buffer_extract(buffer, 0, dst + sizeof(raw_frame_header), size);
+
+    {
+        std::scoped_lock lck { mtx_ };
+        head_ = (head_ + 1) % slot_count_;
+        filled_++;
+    }
+    cv_.notify_one();
+}
+
+
+void tcam::tools::capture::RawRecorder::writer_loop()
+{
+    while (true)
+    {
+        size_t slot = 0;
+        {
+            std::unique_lock lck { mtx_ };
+            cv_.wait(lck, [this] { return filled_ > 0 || stop_; });
+            // write everything that was queued before stopping
+            if (filled_ == 0)
+            {
+                return;
+            }
+            slot = tail_;
+        }
+
+        const uint8_t* src = ring_ + slot * slot_size_;
+        auto header = reinterpret_cast<const raw_frame_header*>(src);
+        const size_t length = align_up(sizeof(raw_frame_header) + header->size);
+
+        if (write_at(src, length, file_offset_))
+        {
+            index_.push_back({ file_offset_, header->size, header->pts });
+            file_offset_ += length;
+            frames_written_++;
+        }
+        else
+        {
+            frames_dropped_++;
+        }
+
+        {
+            std::scoped_lock lck { mtx_ };
+            tail_ = (tail_ + 1) % slot_count_;
+            filled_--;
+        }
+    }
+}
+
+
+bool tcam::tools::capture::RawRecorder::write_at(const void* data, size_t size, uint64_t offset)
+{
+    if (offset + size > allocated_)
+    {
+        // failures are not fatal, not every file system supports preallocation
+        if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, allocated_, prealloc_chunk) == 0)
+        {
+            allocated_ += prealloc_chunk;
+        }
+        else
+        {
+            allocated_ = offset + size;
+        }
+    }
+
+    auto ptr = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        ssize_t ret = pwrite(fd_, ptr, size, offset);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            qWarning("Raw recording write failed: %s", strerror(errno));
+            return false;
+        }
+        ptr += ret;
+        offset += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+
+bool tcam::tools::capture::RawRecorder::write_header()
+{
+    return write_at(file_header_, sizeof(raw_file_header), 0);
+}
+
+
+bool tcam::tools::capture::RawRecorder::write_index()
+{
+    const size_t bytes = index_.size() * sizeof(raw_index_entry);
+    const size_t length = align_up(bytes);
+
+    // O_DIRECT needs an aligned source
+    void* buf = nullptr;
+    if (length > 0)
+    {
+        if (posix_memalign(&buf, raw_block_size, length) != 0)
+        {
+            return false;
+        }
+        memset(buf, 0, length);
+        memcpy(buf, index_.data(), bytes);
+    }
+
+    bool ret = length == 0 || write_at(buf, length, file_offset_);
+    free(buf);
+
+    if (ret)
+    {
+        file_header_->frame_count = index_.size();
+        file_header_->index_offset = file_offset_;
+    }
+
+    // drop the padding and the preallocated space
+    if (ftruncate(fd_, file_offset_ + (ret ? bytes : 0)) != 0)
+    {
+        qWarning("Unable to truncate raw recording: %s", strerror(errno));
+    }
+    return ret;
+}
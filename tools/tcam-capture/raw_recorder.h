@@ -0,0 +1,146 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <gst/gst.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcam::tools::capture
+{
+
+/*
+ * tcamraw container, all values are little endian
+ *
+ * offset 0:            raw_file_header, padded to raw_block_size
+ * offset raw_block_size: frames, every frame starts at a multiple of raw_block_size
+ *                      with a raw_frame_header followed by the unconverted buffer
+ * index_offset:        frame_count raw_index_entry
+ *
+ * index_offset is 0 when the recording was not closed properly,
+ * the frames can still be found by following the frame headers.
+ */
+
+constexpr uint32_t raw_block_size = 4096;
+
+struct raw_file_header
+{
+    char magic[8]; // "TCAMRAW"
+    uint32_t version;
+    uint32_t block_size;
+    uint64_t frame_count;
+    uint64_t index_offset;
+    // caps of the source pad, null terminated
+    char caps[raw_block_size - 32];
+};
+
+struct raw_frame_header
+{
+    char magic[4]; // "FRME"
+    uint32_t header_size;
+    uint64_t size;
+    uint64_t pts;
+    uint64_t frame_number;
+    uint64_t reserved[4];
+};
+
+struct raw_index_entry
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t pts;
+};
+
+static_assert(sizeof(raw_file_header) == raw_block_size);
+static_assert(sizeof(raw_frame_header) == 64);
+
+
+/*
+ * Records the buffers of the source pad without conversion.
+ *
+ * The streaming thread only copies into a ring of aligned slots,
+ * a separate thread writes them with O_DIRECT into a preallocated file.
+ * Frames that arrive while the ring is full are dropped and counted.
+ */
+class RawRecorder
+{
+public:
+    RawRecorder(GstElement* source, const QString& filename, size_t ring_size = 512 * 1024 * 1024);
+    ~RawRecorder();
+
+    RawRecorder(const RawRecorder&) = delete;
+    RawRecorder& operator=(const RawRecorder&) = delete;
+
+    bool start();
+    void stop();
+
+    uint64_t frames_written() const
+    {
+        return frames_written_;
+    }
+    uint64_t frames_dropped() const
+    {
+        return frames_dropped_;
+    }
+
+private:
+    static GstPadProbeReturn buffer_probe(GstPad*, GstPadProbeInfo*, gpointer);
+
+    void push(GstBuffer* buffer);
+    void writer_loop();
+
+    bool write_at(const void* data, size_t size, uint64_t offset);
+    bool write_header();
+    bool write_index();
+
+    GstPad* pad_ = nullptr;
+    gulong probe_id_ = 0;
+    QString filename_;
+
+    int fd_ = -1;
+    bool direct_io_ = false;
+    uint64_t file_offset_ = raw_block_size;
+    uint64_t allocated_ = 0;
+
+    uint8_t* ring_ = nullptr;
+    size_t ring_size_ = 0;
+    size_t slot_size_ = 0;
+    size_t slot_count_ = 0;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    // next slot to fill, next slot to write, filled slots
+    size_t head_ = 0;
+    size_t tail_ = 0;
+    size_t filled_ = 0;
+    bool stop_ = false;
+    std::thread writer_;
+
+    raw_file_header* file_header_ = nullptr;
+    std::vector<raw_index_entry> index_;
+
+    uint64_t frame_number_ = 0;
+    std::atomic<uint64_t> frames_written_ = 0;
+    std::atomic<uint64_t> frames_dropped_ = 0;
+};
+
+} // namespace tcam::tools::capture
@@ -77,6 +77,48 @@ TcamPropertyBase* TcamCollection::get_property(const std::string& name)
 }
 
 
+std::vector<GstElement*> TcamCollection::get_property_change_sources() const
+{
+    auto has_signal = [](GstElement* e)
+    {
+        return g_signal_lookup("tcam-properties-changed", G_OBJECT_TYPE(e)) != 0;
+    };
+
+    std::vector<GstElement*> ret;
+    for (auto e : m_elements)
+    {
+        if (has_signal(e))
+        {
+            ret.push_back(GST_ELEMENT(gst_object_ref(e)));
+            continue;
+        }
+        if (!GST_IS_BIN(e))
+        {
+            continue;
+        }
+
+        // e.g. tcambin, its source forwards the signal of the inner sources
+        // only the first one is used, so that a change is not reported twice
+        GstIterator* iter = gst_bin_iterate_recurse(GST_BIN(e));
+        GValue item = G_VALUE_INIT;
+        bool found = false;
+        while (!found && gst_iterator_next(iter, &item) == GST_ITERATOR_OK)
+        {
+            auto child = GST_ELEMENT(g_value_get_object(&item));
+            if (has_signal(child))
+            {
+                ret.push_back(GST_ELEMENT(gst_object_ref(child)));
+                found = true;
+            }
+            g_value_reset(&item);
+        }
+        g_value_unset(&item);
+        gst_iterator_free(iter);
+    }
+    return ret;
+}
+
+
 bool TcamCollection::is_trigger_mode_active()
 {
     auto base = get_property("TriggerMode");
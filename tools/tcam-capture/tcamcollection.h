@@ -43,5 +43,8 @@ public:
 
     TcamPropertyBase* get_property(const std::string& name);
 
+    // elements that emit 'tcam-properties-changed', the caller owns the references
+    std::vector<GstElement*> get_property_change_sources() const;
+
     bool is_trigger_mode_active();
 };
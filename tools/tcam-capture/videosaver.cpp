@@ -69,12 +69,51 @@ QString find_codec_pipeline(VideoCodec codec)
                    " ! queue max-size-time=0 max-size-bytes=0 max-size-buffers=0 "
                    " ! filesink async=true name=save-sink";
         }
+        case VideoCodec::RAW:
+        {
+            // handled by RawRecorder
+            break;
+        }
     }
 
     return nullptr;
 }
 
 
+// the compressed buffers of the device are muxed as they are, nothing is decoded or encoded
+// appsrc is used through its signals, tcam-capture does not link gstreamer-app
+const char* passthrough_pipeline =
+    "appsrc name=save-src format=time is-live=true max-bytes=67108864 "
+    " ! avimux name=save-enc "
+    " ! queue max-size-time=0 max-size-bytes=0 max-size-buffers=0 "
+    " ! filesink async=true sync=false name=save-sink";
+
+// buffers are dropped, instead of blocking the source, while appsrc holds more than this
+constexpr guint64 passthrough_max_bytes = 64 * 1024 * 1024;
+
+
+bool is_jpeg_caps(GstCaps* caps)
+{
+    return caps && gst_caps_get_size(caps) > 0
+           && gst_structure_has_name(gst_caps_get_structure(caps, 0), "image/jpeg");
+}
+
+
+// the element producing the unconverted device buffers
+GstElement* find_raw_source(GstElement* pipeline)
+{
+    GstElement* source = gst_bin_get_by_name(GST_BIN(pipeline), "tcam0");
+
+    if (source && GST_IS_BIN(source))
+    {
+        GstElement* src = gst_bin_get_by_name(GST_BIN(source), "tcambin-source");
+        gst_object_unref(source);
+        return src;
+    }
+    return source;
+}
+
+
 } // namespace
 
 tcam::tools::capture::VideoSaver::VideoSaver(GstPipeline* pipeline,
@@ -86,6 +125,28 @@ tcam::tools::capture::VideoSaver::VideoSaver(GstPipeline* pipeline,
 
 void tcam::tools::capture::VideoSaver::start_saving()
 {
+    if (codec_ == VideoCodec::RAW)
+    {
+        GstElement* source = find_raw_source(pipeline_);
+        raw_recorder_ = std::make_unique<RawRecorder>(source, target_file_);
+        if (source)
+        {
+            gst_object_unref(source);
+        }
+
+        if (!raw_recorder_->start())
+        {
+            qWarning("Unable to start raw recording");
+            raw_recorder_ = nullptr;
+        }
+        return;
+    }
+
+    if (codec_ == VideoCodec::MJPEG && start_passthrough())
+    {
+        return;
+    }
+
     auto pipeline_str = find_codec_pipeline(codec_);
 
     save_pipeline_ = gst_parse_launch(pipeline_str.toStdString().c_str(), nullptr);
@@ -117,8 +178,126 @@ void tcam::tools::capture::VideoSaver::start_saving()
 }
 
 
+bool tcam::tools::capture::VideoSaver::start_passthrough()
+{
+    GstElement* source = find_raw_source(pipeline_);
+    if (!source)
+    {
+        return false;
+    }
+    source_pad_ = gst_element_get_static_pad(source, "src");
+    gst_object_unref(source);
+
+    GstCaps* caps = source_pad_ ? gst_pad_get_current_caps(source_pad_) : nullptr;
+    if (!is_jpeg_caps(caps))
+    {
+        if (caps)
+        {
+            gst_caps_unref(caps);
+        }
+        if (source_pad_)
+        {
+            gst_object_unref(source_pad_);
+            source_pad_ = nullptr;
+        }
+        return false;
+    }
+
+    save_pipeline_ = gst_parse_launch(passthrough_pipeline, nullptr);
+    g_object_set(G_OBJECT(save_pipeline_), "message-forward", TRUE, nullptr);
+
+    app_src_ = gst_bin_get_by_name(GST_BIN(save_pipeline_), "save-src");
+    g_object_set(app_src_, "caps", caps, nullptr);
+    gst_caps_unref(caps);
+
+    auto file_sink = gst_bin_get_by_name(GST_BIN(save_pipeline_), "save-sink");
+    g_object_set(file_sink, "location", target_file_.toStdString().c_str(), nullptr);
+    gst_object_unref(file_sink);
+
+    gst_bin_add(GST_BIN(pipeline_), save_pipeline_);
+    gst_element_sync_state_with_parent(save_pipeline_);
+
+    passthrough_ = true;
+    first_pts_ = GST_CLOCK_TIME_NONE;
+    frames_dropped_ = 0;
+    passthrough_probe_ = gst_pad_add_probe(
+        source_pad_, GST_PAD_PROBE_TYPE_BUFFER, passthrough_probe, this, nullptr);
+
+    qDebug("Started MJPEG passthrough saving");
+    return true;
+}
+
+
+GstPadProbeReturn tcam::tools::capture::VideoSaver::passthrough_probe(GstPad* /*pad*/,
+                                                                      GstPadProbeInfo* info,
+                                                                      gpointer user_data)
+{
+    auto self = static_cast<VideoSaver*>(user_data);
+    GstBuffer* buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    guint64 level = 0;
+    g_object_get(self->app_src_, "current-level-bytes", &level, nullptr);
+    if (level > passthrough_max_bytes)
+    {
+        self->frames_dropped_++;
+        return GST_PAD_PROBE_OK;
+    }
+
+    // a copy returns the device buffer right away, a jpeg is small compared to the decoded image
+    GstBuffer* copy = gst_buffer_copy_deep(buffer);
+
+    // the recording starts at 0, not at the running time of the capture pipeline
+    if (!GST_CLOCK_TIME_IS_VALID(self->first_pts_))
+    {
+        self->first_pts_ = GST_BUFFER_PTS(buffer);
+    }
+    if (GST_BUFFER_PTS_IS_VALID(buffer) && GST_CLOCK_TIME_IS_VALID(self->first_pts_))
+    {
+        GST_BUFFER_PTS(copy) = GST_BUFFER_PTS(buffer) - self->first_pts_;
+    }
+    GST_BUFFER_DTS(copy) = GST_BUFFER_PTS(copy);
+
+    GstFlowReturn ret = GST_FLOW_OK;
+    g_signal_emit_by_name(self->app_src_, "push-buffer", copy, &ret);
+    gst_buffer_unref(copy);
+
+    return GST_PAD_PROBE_OK;
+}
+
+
 void tcam::tools::capture::VideoSaver::stop_saving()
 {
+    if (codec_ == VideoCodec::RAW)
+    {
+        if (raw_recorder_)
+        {
+            raw_recorder_->stop();
+            if (raw_recorder_->frames_dropped() > 0)
+            {
+                qWarning("Raw recording dropped %lu frames",
+                         (unsigned long)raw_recorder_->frames_dropped());
+            }
+        }
+        return;
+    }
+
+    if (is_passthrough())
+    {
+        gst_pad_remove_probe(source_pad_, passthrough_probe_);
+        passthrough_probe_ = 0;
+
+        if (frames_dropped_ > 0)
+        {
+            qWarning("MJPEG passthrough recording dropped %lu frames",
+                     (unsigned long)frames_dropped_);
+        }
+
+        GstFlowReturn ret = GST_FLOW_OK;
+        g_signal_emit_by_name(app_src_, "end-of-stream", &ret);
+        qDebug("Stopped video saving. Waiting for EOS.");
+        return;
+    }
+
     gst_element_set_state(save_pipeline_, GST_STATE_PAUSED);
 
 
@@ -138,6 +317,24 @@ void tcam::tools::capture::VideoSaver::stop_saving()
 void tcam::tools::capture::VideoSaver::destroy_pipeline()
 {
     //qDebug("destroy");
+    raw_recorder_ = nullptr;
+
+    if (passthrough_probe_)
+    {
+        gst_pad_remove_probe(source_pad_, passthrough_probe_);
+        passthrough_probe_ = 0;
+    }
+    if (source_pad_)
+    {
+        gst_object_unref(source_pad_);
+        source_pad_ = nullptr;
+    }
+    if (app_src_)
+    {
+        gst_object_unref(app_src_);
+        app_src_ = nullptr;
+    }
+
     if (save_pipeline_)
     {
         gst_element_set_state(save_pipeline_, GST_STATE_NULL);
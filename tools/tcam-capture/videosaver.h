@@ -22,6 +22,10 @@
 #include <gst/gst.h>
 
 #include "config.h"
+#include "raw_recorder.h"
+
+#include <atomic>
+#include <memory>
 
 namespace tcam::tools::capture
 {
@@ -48,8 +52,24 @@ public:
     // typically the sink
     GstObject* gst_pointer() const;
 
+    // raw recordings are complete once stop_saving returns
+    // and do not send an EOS
+    bool waits_for_eos() const
+    {
+        return codec_ != VideoCodec::RAW;
+    }
+
+    // MJPEG recordings of a jpeg device mux the compressed device buffers
+    bool is_passthrough() const
+    {
+        return passthrough_;
+    }
+
 private:
 
+    bool start_passthrough();
+    static GstPadProbeReturn passthrough_probe(GstPad*, GstPadProbeInfo*, gpointer);
+
     GstElement* pipeline_ = nullptr;
     QString target_file_;
     VideoCodec codec_;
@@ -61,6 +81,16 @@ private:
     GstPad* tee_pad_ = nullptr;
     GstElement* queue_ = nullptr;
     GstPad* queue_pad_ = nullptr;
+
+    std::unique_ptr<RawRecorder> raw_recorder_;
+
+    // passthrough, the probe copies the buffers of source_pad_ into save-src
+    bool passthrough_ = false;
+    GstPad* source_pad_ = nullptr;
+    gulong passthrough_probe_ = 0;
+    GstElement* app_src_ = nullptr;
+    GstClockTime first_pts_ = GST_CLOCK_TIME_NONE;
+    std::atomic<uint64_t> frames_dropped_ = 0;
 };
 
 } // namespace tcam::tools::capture
@@ -0,0 +1,375 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "converter.h"
+
+#include "../../src/gstreamer-1.0/tcamconvert/transform_impl.h"
+#include "tiff_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <dutils_img/fcc_to_string.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+
+using namespace tcam::tools::convert;
+
+constexpr size_t buffer_alignment = 4096;
+
+
+size_t align_up(size_t value)
+{
+    return (value + buffer_alignment - 1) / buffer_alignment * buffer_alignment;
+}
+
+
+std::string get_stem(const std::string& filename)
+{
+    auto name = filename.substr(filename.find_last_of('/') + 1);
+    const auto dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot != 0)
+    {
+        name.erase(dot);
+    }
+    return name;
+}
+
+
+std::string get_tiff_filename(const convert_options& options,
+                              const std::string& stem,
+                              size_t frame)
+{
+    char number[32];
+    snprintf(number, sizeof(number), "%06zu", frame);
+    return options.output_dir + "/" + stem + "_" + number + ".tiff";
+}
+
+
+bool write_all(int fd, const uint8_t* data, size_t size, uint64_t offset, std::string& error)
+{
+    while (size > 0)
+    {
+        const ssize_t ret = pwrite(fd, data, size, offset);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            error = strerror(errno);
+            return false;
+        }
+        data += ret;
+        size -= ret;
+        offset += ret;
+    }
+    return true;
+}
+
+
+int open_output(const std::string& filename, std::string& error)
+{
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        error = "Unable to open '" + filename + "': " + strerror(errno);
+    }
+    return fd;
+}
+
+
+/*
+ * Buffers cycle from free_ to a converting thread, to written_ and back to free_.
+ */
+class frame_pipeline
+{
+public:
+    frame_pipeline(const raw_input& input, const convert_options& options)
+        : input_(input), options_(options), stem_(get_stem(input.filename()))
+    {
+        src_type_ = input.type();
+        dst_type_ = img::make_img_type(options.dst_fcc, src_type_.dim);
+
+        if (options.container == output_container::tiff)
+        {
+            if (!can_write_tiff(options.dst_fcc))
+            {
+                throw std::runtime_error("TIFF cannot store "
+                                         + img::fcc_to_string(options.dst_fcc));
+            }
+            header_size_ = calc_tiff_header_size(dst_type_);
+        }
+
+        int thread_count = options.threads;
+        if (thread_count <= 0)
+        {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = static_cast<int>(
+            std::min<size_t>(thread_count, std::max<size_t>(input.frame_count(), 1)));
+
+        slot_size_ = align_up(header_size_ + dst_type_.buffer_length);
+        // twice the threads keeps the writer busy while every thread converts
+        const size_t slot_count =
+            std::clamp<size_t>(options.memory_limit / slot_size_, 1, thread_count * 2);
+
+        pool_.reset(
+            static_cast<uint8_t*>(aligned_alloc(buffer_alignment, slot_size_ * slot_count)));
+        if (!pool_)
+        {
+            throw std::runtime_error("Unable to allocate the output buffers");
+        }
+        for (size_t i = 0; i < slot_count; ++i) { free_.push_back(i); }
+
+        // more threads than buffers would only wait
+        thread_count = static_cast<int>(std::min<size_t>(thread_count, slot_count));
+
+        for (int i = 0; i < thread_count; ++i)
+        {
+            auto ctx = std::make_unique<tcamconvert::transform_context>();
+            ctx->set_thread_count(1);
+            if (!ctx->setup(src_type_, dst_type_))
+            {
+                throw std::runtime_error("Unable to convert "
+                                         + img::fcc_to_string(src_type_.fourcc_type()) + " to "
+                                         + img::fcc_to_string(dst_type_.fourcc_type()));
+            }
+            contexts_.push_back(std::move(ctx));
+        }
+    }
+
+    frame_pipeline(const frame_pipeline&) = delete;
+    frame_pipeline& operator=(const frame_pipeline&) = delete;
+
+    convert_statistics run()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        if (options_.container == output_container::raw)
+        {
+            const auto filename = options_.output_dir + "/" + stem_ + "."
+                                  + img::fcc_to_string(dst_type_.fourcc_type()) + ".raw";
+            raw_fd_ = open_output(filename, stats_.error);
+            if (raw_fd_ < 0)
+            {
+                throw std::runtime_error(stats_.error);
+            }
+            // keeps the extents contiguous, failing is not an error
+            posix_fallocate(raw_fd_, 0, uint64_t(dst_type_.buffer_length) * input_.frame_count());
+        }
+
+        active_threads_ = static_cast<int>(contexts_.size());
+
+        std::vector<std::thread> threads;
+        for (auto& ctx : contexts_)
+        {
+            threads.emplace_back([this, c = ctx.get()] { convert_loop(*c); });
+        }
+
+        write_loop();
+
+        for (auto& t : threads) { t.join(); }
+
+        if (raw_fd_ >= 0)
+        {
+            close(raw_fd_);
+        }
+
+        stats_.seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats_;
+    }
+
+private:
+    uint8_t* slot_memory(size_t slot) const noexcept
+    {
+        return pool_.get() + slot * slot_size_;
+    }
+
+    void convert_loop(tcamconvert::transform_context& ctx)
+    {
+        while (true)
+        {
+            size_t slot = 0;
+            {
+                std::unique_lock lck { mtx_ };
+                free_cv_.wait(lck, [this] { return !free_.empty() || abort_; });
+                if (abort_)
+                {
+                    break;
+                }
+                slot = free_.front();
+                free_.pop_front();
+            }
+
+            const size_t index = next_frame_++;
+            if (index >= input_.frame_count())
+            {
+                std::scoped_lock lck { mtx_ };
+                free_.push_back(slot);
+                break;
+            }
+
+            uint8_t* mem = slot_memory(slot);
+            if (header_size_ != 0)
+            {
+                write_tiff_header(mem, dst_type_);
+            }
+
+            const auto& frame = input_.frame(index);
+            auto src = img::make_img_desc_from_linear_memory(src_type_,
+                                                             const_cast<uint8_t*>(frame.data));
+            auto dst = img::make_img_desc_from_linear_memory(dst_type_, mem + header_size_);
+
+            ctx.transform(src, dst, options_.whitebalance);
+
+            if (options_.container == output_container::tiff)
+            {
+                reorder_for_tiff(dst);
+            }
+
+            input_.release(index);
+
+            {
+                std::scoped_lock lck { mtx_ };
+                written_.push_back({ slot, index });
+            }
+            write_cv_.notify_one();
+        }
+
+        {
+            std::scoped_lock lck { mtx_ };
+            active_threads_--;
+        }
+        // the remaining threads might wait for a buffer this thread returned
+        free_cv_.notify_all();
+        write_cv_.notify_one();
+    }
+
+    void write_loop()
+    {
+        while (true)
+        {
+            std::pair<size_t, size_t> entry;
+            {
+                std::unique_lock lck { mtx_ };
+                write_cv_.wait(lck, [this] { return !written_.empty() || active_threads_ == 0; });
+                if (written_.empty())
+                {
+                    return;
+                }
+                entry = written_.front();
+                written_.pop_front();
+            }
+
+            const auto [slot, index] = entry;
+
+            if (stats_.error.empty() && write_frame(slot_memory(slot), index))
+            {
+                stats_.frames_converted++;
+                stats_.bytes_written += header_size_ + dst_type_.buffer_length;
+            }
+            else
+            {
+                std::scoped_lock lck { mtx_ };
+                abort_ = true;
+                free_cv_.notify_all();
+            }
+
+            {
+                std::scoped_lock lck { mtx_ };
+                free_.push_back(slot);
+            }
+            free_cv_.notify_one();
+        }
+    }
+
+    bool write_frame(const uint8_t* mem, size_t index)
+    {
+        const size_t size = header_size_ + dst_type_.buffer_length;
+
+        if (options_.container == output_container::raw)
+        {
+            // threads finish out of order, every frame has its fixed place
+            return write_all(raw_fd_, mem, size, uint64_t(size) * index, stats_.error);
+        }
+
+        const auto filename = get_tiff_filename(options_, stem_, index);
+        int fd = open_output(filename, stats_.error);
+        if (fd < 0)
+        {
+            return false;
+        }
+        const bool ret = write_all(fd, mem, size, 0, stats_.error);
+        close(fd);
+        return ret;
+    }
+
+    const raw_input& input_;
+    const convert_options& options_;
+    const std::string stem_;
+
+    img::img_type src_type_;
+    img::img_type dst_type_;
+    size_t header_size_ = 0;
+
+    std::vector<std::unique_ptr<tcamconvert::transform_context>> contexts_;
+
+    std::unique_ptr<uint8_t, decltype(&free)> pool_ { nullptr, &free };
+    size_t slot_size_ = 0;
+
+    std::mutex mtx_;
+    std::condition_variable free_cv_;
+    std::condition_variable write_cv_;
+    std::deque<size_t> free_;
+    // buffer and frame index
+    std::deque<std::pair<size_t, size_t>> written_;
+    int active_threads_ = 0;
+    bool abort_ = false;
+
+    std::atomic<size_t> next_frame_ { 0 };
+
+    int raw_fd_ = -1;
+
+    // only touched by the writing thread
+    convert_statistics stats_;
+};
+
+} // namespace
+
+
+tcam::tools::convert::convert_statistics tcam::tools::convert::convert_file(
+    const raw_input& input,
+    const convert_options& options)
+{
+    frame_pipeline pipeline(input, options);
+    return pipeline.run();
+}
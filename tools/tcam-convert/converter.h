@@ -0,0 +1,74 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "raw_input.h"
+
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+#include <dutils_img/image_transform_data_structs.h>
+#include <string>
+
+namespace tcam::tools::convert
+{
+
+enum class output_container
+{
+    // one file per input, the converted frames back to back without headers
+    raw,
+    // one uncompressed tiff per frame
+    tiff,
+};
+
+struct convert_options
+{
+    img::fourcc dst_fcc = img::fourcc::BGRA32;
+    output_container container = output_container::tiff;
+    std::string output_dir = ".";
+
+    // 0 uses one thread per core
+    int threads = 0;
+    // upper limit for converted frames that wait for the writer
+    size_t memory_limit = 1024ull * 1024 * 1024;
+
+    img::whitebalance_params whitebalance;
+};
+
+struct convert_statistics
+{
+    uint64_t frames_converted = 0;
+    uint64_t bytes_written = 0;
+    double seconds = 0.0;
+
+    // first write error, the conversion stops with it
+    std::string error;
+};
+
+/**
+ * Converts all frames of input.
+ *
+ * Every thread converts whole frames with its own transform_context,
+ * so the kernels run single threaded and frames never wait for each other.
+ * Converted frames go through a fixed pool of buffers to the writing thread,
+ * converting threads wait while all buffers are queued for writing.
+ * Frames are dropped from the page cache once converted.
+ *
+ * Throws std::runtime_error when the conversion or the output cannot be set up.
+ */
+convert_statistics convert_file(const raw_input& input, const convert_options& options);
+
+} // namespace tcam::tools::convert
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "formats.h"
+
+#include <dutils_img_lib/dutils_gst_interop.h>
+#include <gst-helper/gst_ptr.h>
+#include <gst-helper/gstcaps_dutils_interop.h>
+#include <gst/gst.h>
+
+img::fourcc tcam::tools::convert::fourcc_from_format_name(const std::string& name)
+{
+    // bayer formats only exist in video/x-bayer, everything else in video/x-raw
+    for (const char* media_type : { "video/x-raw", "video/x-bayer" })
+    {
+        auto fcc = img_lib::gst::gst_caps_string_to_fourcc(media_type, name);
+        if (fcc != img::fourcc::FCC_NULL)
+        {
+            return fcc;
+        }
+    }
+    return img::fourcc::FCC_NULL;
+}
+
+
+img::img_type tcam::tools::convert::img_type_from_caps_string(const std::string& caps)
+{
+    auto ptr = gst_helper::make_ptr(gst_caps_from_string(caps.c_str()));
+    if (!ptr || gst_caps_is_empty(ptr.get()) || !gst_caps_is_fixed(ptr.get()))
+    {
+        return {};
+    }
+    return gst_helper::get_img_type_from_fixated_gstcaps(*ptr);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <dutils_img/dutils_img.h>
+#include <string>
+
+namespace tcam::tools::convert
+{
+
+/**
+ * GStreamer format name, e.g. BGRx, rggb or GRAY16_LE.
+ * @return img::fourcc::FCC_NULL when GStreamer has no such format
+ */
+img::fourcc fourcc_from_format_name(const std::string& name);
+
+/**
+ * @return img_type of the fixated caps; empty when the caps cannot be parsed
+ */
+img::img_type img_type_from_caps_string(const std::string& caps);
+
+} // namespace tcam::tools::convert
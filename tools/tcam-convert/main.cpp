@@ -0,0 +1,143 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "converter.h"
+#include "formats.h"
+#include "raw_input.h"
+
+#include <CLI11.hpp>
+#include <cstdio>
+#include <dutils_img/fcc_to_string.h>
+#include <gst/gst.h>
+#include <iostream>
+#include <stdexcept>
+
+using namespace tcam::tools::convert;
+
+namespace
+{
+
+bool parse_whitebalance(const std::string& str, img::whitebalance_params& params)
+{
+    float r = 0.f;
+    float g = 0.f;
+    float b = 0.f;
+    if (sscanf(str.c_str(), "%f,%f,%f", &r, &g, &b) != 3)
+    {
+        return false;
+    }
+    params = { true, r, g, b, g };
+    return true;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    // only used to parse caps strings, no pipelines are created
+    gst_init(&argc, &argv);
+
+    CLI::App app { "Converts raw recordings of tcam-capture and the virtcam without GStreamer." };
+
+    std::vector<std::string> files;
+    app.add_option("files", files, "tcamraw files to convert")
+        ->required()
+        ->check(CLI::ExistingFile);
+
+    convert_options options;
+
+    app.add_option("-o,--output", options.output_dir, "Directory for the converted files", true)
+        ->check(CLI::ExistingDirectory);
+
+    std::string format = "BGRx";
+    app.add_option("-f,--format",
+                   format,
+                   "GStreamer format of the output, e.g. BGRx, BGR, RGBx64 or GRAY16_LE",
+                   true);
+
+    std::string container = "tiff";
+    app.add_option("--container",
+                   container,
+                   "tiff writes one file per frame, raw one file per input without headers",
+                   true)
+        ->check(CLI::IsMember({ "tiff", "raw" }));
+
+    app.add_option("-j,--threads", options.threads, "Converting threads, 0 for one per core", true);
+
+    size_t memory_mb = options.memory_limit / (1024 * 1024);
+    app.add_option(
+        "--memory", memory_mb, "MiB for converted frames that wait to be written", true);
+
+    std::string whitebalance;
+    app.add_option("--white-balance", whitebalance, "Gains as R,G,B, e.g. 1.6,1.0,2.1");
+
+    CLI11_PARSE(app, argc, argv);
+
+    options.dst_fcc = fourcc_from_format_name(format);
+    if (options.dst_fcc == img::fourcc::FCC_NULL)
+    {
+        std::cerr << "Unknown format '" << format << "'" << std::endl;
+        return 1;
+    }
+    options.container = container == "raw" ? output_container::raw : output_container::tiff;
+    options.memory_limit = memory_mb * 1024 * 1024;
+
+    if (!whitebalance.empty() && !parse_whitebalance(whitebalance, options.whitebalance))
+    {
+        std::cerr << "White balance has to be given as R,G,B" << std::endl;
+        return 1;
+    }
+
+    int ret = 0;
+    for (const auto& file : files)
+    {
+        try
+        {
+            raw_input input(file);
+
+            const auto stats = convert_file(input, options);
+
+            const double fps = stats.seconds > 0 ? stats.frames_converted / stats.seconds : 0.0;
+            const double mb_per_s =
+                stats.seconds > 0 ? stats.bytes_written / stats.seconds / (1024 * 1024) : 0.0;
+
+            printf("%s: %s %dx%d -> %s, %llu of %zu frames in %.2f s (%.1f fps, %.1f MiB/s)\n",
+                   file.c_str(),
+                   img::fcc_to_string(input.type().fourcc_type()).c_str(),
+                   input.type().dim.cx,
+                   input.type().dim.cy,
+                   img::fcc_to_string(options.dst_fcc).c_str(),
+                   (unsigned long long)stats.frames_converted,
+                   input.frame_count(),
+                   stats.seconds,
+                   fps,
+                   mb_per_s);
+
+            if (!stats.error.empty())
+            {
+                std::cerr << file << ": " << stats.error << std::endl;
+                ret = 1;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            ret = 1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "raw_input.h"
+
+#include "formats.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+// the writers are the reference for these layouts, all values are little endian
+
+// tools/tcam-capture/raw_recorder.h
+constexpr char capture_magic[8] = { 'T', 'C', 'A', 'M', 'R', 'A', 'W', '\0' };
+constexpr uint32_t capture_block_size = 4096;
+
+struct capture_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    uint64_t frame_count;
+    uint64_t index_offset;
+    char caps[capture_block_size - 32];
+};
+
+struct capture_frame_header
+{
+    char magic[4]; // "FRME"
+    uint32_t header_size;
+    uint64_t size;
+    uint64_t pts;
+    uint64_t frame_number;
+    uint64_t reserved[4];
+};
+
+struct capture_index_entry
+{
+    // of the frame header
+    uint64_t offset;
+    uint64_t size;
+    uint64_t pts;
+};
+
+static_assert(sizeof(capture_file_header) == capture_block_size);
+static_assert(sizeof(capture_frame_header) == 64);
+
+
+// src/virtcam/replay_device.h
+constexpr char replay_magic[8] = { 'T', 'C', 'A', 'M', 'R', 'A', 'W', '1' };
+
+struct replay_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t fourcc;
+    uint32_t width;
+    uint32_t height;
+    double framerate;
+    uint64_t frame_count;
+    uint64_t index_offset;
+    uint8_t reserved[16];
+};
+
+struct replay_index_entry
+{
+    // of the image data
+    uint64_t offset;
+    uint64_t length;
+    uint64_t timestamp_ns;
+};
+
+static_assert(sizeof(replay_file_header) == 64);
+static_assert(sizeof(replay_index_entry) == 24);
+
+
+uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+
+tcam::tools::convert::raw_input::raw_input(const std::string& filename) : filename_(filename)
+{
+    fd_ = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0)
+    {
+        throw std::runtime_error("Unable to open '" + filename + "': " + strerror(errno));
+    }
+
+    struct stat st = {};
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(replay_file_header))
+    {
+        close(fd_);
+        throw std::runtime_error("'" + filename + "' is too small for a raw recording");
+    }
+
+    void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (ptr == MAP_FAILED)
+    {
+        close(fd_);
+        throw std::runtime_error("Unable to map '" + filename + "': " + strerror(errno));
+    }
+    mapping_ = static_cast<const uint8_t*>(ptr);
+    mapping_size_ = st.st_size;
+
+    // every frame is read once, front to back
+    madvise(ptr, mapping_size_, MADV_SEQUENTIAL);
+
+    try
+    {
+        if (memcmp(mapping_, capture_magic, sizeof(capture_magic)) == 0)
+        {
+            parse_capture_file();
+        }
+        else if (memcmp(mapping_, replay_magic, sizeof(replay_magic)) == 0)
+        {
+            parse_replay_file();
+        }
+        else
+        {
+            throw std::runtime_error("'" + filename + "' is not a raw recording");
+        }
+    }
+    catch (...)
+    {
+        munmap(const_cast<uint8_t*>(mapping_), mapping_size_);
+        close(fd_);
+        throw;
+    }
+}
+
+
+tcam::tools::convert::raw_input::~raw_input()
+{
+    munmap(const_cast<uint8_t*>(mapping_), mapping_size_);
+    close(fd_);
+}
+
+
+void tcam::tools::convert::raw_input::parse_capture_file()
+{
+    if (mapping_size_ < sizeof(capture_file_header))
+    {
+        throw std::runtime_error("'" + filename_ + "' has a truncated header");
+    }
+
+    capture_file_header header;
+    memcpy(&header, mapping_, sizeof(header));
+
+    if (header.version != 1 || header.block_size == 0)
+    {
+        throw std::runtime_error("'" + filename_ + "' has an unsupported version");
+    }
+
+    header.caps[sizeof(header.caps) - 1] = '\0';
+    type_ = img_type_from_caps_string(header.caps);
+    if (type_.empty())
+    {
+        throw std::runtime_error("'" + filename_ + "' has unusable caps: " + header.caps);
+    }
+
+    const uint64_t index_size = header.frame_count * sizeof(capture_index_entry);
+    const bool has_index = header.index_offset != 0 && header.index_offset <= mapping_size_
+                           && index_size <= mapping_size_ - header.index_offset;
+
+    if (has_index)
+    {
+        frames_.reserve(header.frame_count);
+        for (uint64_t i = 0; i < header.frame_count; ++i)
+        {
+            capture_index_entry entry;
+            memcpy(&entry,
+                   mapping_ + header.index_offset + i * sizeof(capture_index_entry),
+                   sizeof(entry));
+            add_frame(entry.offset + sizeof(capture_frame_header), entry.size, entry.pts);
+        }
+        return;
+    }
+
+    // the recording was not stopped, the index is missing
+    uint64_t offset = align_up(sizeof(capture_file_header), header.block_size);
+    while (offset + sizeof(capture_frame_header) <= mapping_size_)
+    {
+        capture_frame_header frame;
+        memcpy(&frame, mapping_ + offset, sizeof(frame));
+        if (memcmp(frame.magic, "FRME", 4) != 0 || frame.header_size < sizeof(frame)
+            || frame.size > mapping_size_ - offset - frame.header_size)
+        {
+            break;
+        }
+        add_frame(offset + frame.header_size, frame.size, frame.pts);
+        offset = align_up(offset + frame.header_size + frame.size, header.block_size);
+    }
+}
+
+
+void tcam::tools::convert::raw_input::parse_replay_file()
+{
+    replay_file_header header;
+    memcpy(&header, mapping_, sizeof(header));
+
+    if (header.version != 1)
+    {
+        throw std::runtime_error("'" + filename_ + "' has an unsupported version");
+    }
+
+    const img::dim dim = { static_cast<int>(header.width), static_cast<int>(header.height) };
+    if (!img::is_known_fcc(header.fourcc) || dim.empty())
+    {
+        throw std::runtime_error("'" + filename_ + "' has an unknown format");
+    }
+    type_ = img::make_img_type(header.fourcc, dim);
+
+    const uint64_t index_size = header.frame_count * sizeof(replay_index_entry);
+    if (header.index_offset > mapping_size_ || index_size > mapping_size_ - header.index_offset)
+    {
+        throw std::runtime_error("'" + filename_ + "' has an invalid index");
+    }
+
+    frames_.reserve(header.frame_count);
+    for (uint64_t i = 0; i < header.frame_count; ++i)
+    {
+        replay_index_entry entry;
+        memcpy(&entry,
+               mapping_ + header.index_offset + i * sizeof(replay_index_entry),
+               sizeof(entry));
+        add_frame(entry.offset, entry.length, entry.timestamp_ns);
+    }
+}
+
+
+void tcam::tools::convert::raw_input::add_frame(uint64_t offset, uint64_t size, uint64_t pts)
+{
+    if (offset > mapping_size_ || size > mapping_size_ - offset
+        || size < static_cast<uint64_t>(type_.buffer_length))
+    {
+        throw std::runtime_error("Frame " + std::to_string(frames_.size()) + " of '" + filename_
+                                 + "' is truncated");
+    }
+    frames_.push_back({ mapping_ + offset, size, pts });
+}
+
+
+void tcam::tools::convert::raw_input::release(size_t index) const noexcept
+{
+    if (index >= frames_.size())
+    {
+        return;
+    }
+
+    static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+
+    const auto& f = frames_[index];
+    const uint64_t offset = f.data - mapping_;
+
+    // only whole pages, the neighbours might still be converted
+    const uint64_t begin = align_up(offset, page_size);
+    const uint64_t end = (offset + f.size) / page_size * page_size;
+    if (end <= begin)
+    {
+        return;
+    }
+
+    madvise(const_cast<uint8_t*>(mapping_) + begin, end - begin, MADV_DONTNEED);
+    posix_fadvise(fd_, begin, end - begin, POSIX_FADV_DONTNEED);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+#include <string>
+#include <vector>
+
+namespace tcam::tools::convert
+{
+
+struct raw_frame
+{
+    const uint8_t* data;
+    uint64_t size;
+    uint64_t pts;
+};
+
+/**
+ * Memory mapped raw recording.
+ *
+ * Reads the tcamraw files of tcam-capture (magic "TCAMRAW", caps string in the header,
+ * see tools/tcam-capture/raw_recorder.h) and the replay files of the virtcam
+ * (magic "TCAMRAW1", see src/virtcam/replay_device.h).
+ * tcamraw files without index, e.g. from a recording that was not stopped,
+ * are read by following the frame headers.
+ *
+ * Throws std::runtime_error when the file cannot be read.
+ */
+class raw_input
+{
+public:
+    explicit raw_input(const std::string& filename);
+    ~raw_input();
+
+    raw_input(const raw_input&) = delete;
+    raw_input& operator=(const raw_input&) = delete;
+
+    const std::string& filename() const noexcept
+    {
+        return filename_;
+    }
+
+    const img::img_type& type() const noexcept
+    {
+        return type_;
+    }
+
+    size_t frame_count() const noexcept
+    {
+        return frames_.size();
+    }
+
+    const raw_frame& frame(size_t index) const
+    {
+        return frames_.at(index);
+    }
+
+    /**
+     * Drops the pages of a frame from the mapping and the page cache.
+     * Keeps the memory use of a pass over a file larger than the RAM bounded.
+     * Pages shared with neighbouring frames are kept.
+     */
+    void release(size_t index) const noexcept;
+
+private:
+    void parse_capture_file();
+    void parse_replay_file();
+
+    void add_frame(uint64_t offset, uint64_t size, uint64_t pts);
+
+    std::string filename_;
+    int fd_ = -1;
+    const uint8_t* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+
+    img::img_type type_ = {};
+    std::vector<raw_frame> frames_;
+};
+
+} // namespace tcam::tools::convert
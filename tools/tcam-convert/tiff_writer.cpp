@@ -0,0 +1,196 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tiff_writer.h"
+
+#include <cstring>
+#include <utility>
+
+namespace
+{
+
+enum tiff_tag : uint16_t
+{
+    ImageWidth = 256,
+    ImageLength = 257,
+    BitsPerSample = 258,
+    Compression = 259,
+    PhotometricInterpretation = 262,
+    StripOffsets = 273,
+    SamplesPerPixel = 277,
+    RowsPerStrip = 278,
+    StripByteCounts = 279,
+    PlanarConfiguration = 284,
+    ExtraSamples = 338,
+};
+
+constexpr uint16_t type_short = 3;
+constexpr uint16_t type_long = 4;
+
+struct sample_layout
+{
+    int samples;
+    int bits;
+};
+
+sample_layout get_sample_layout(img::fourcc fcc) noexcept
+{
+    switch (fcc)
+    {
+        case img::fourcc::MONO8:
+            return { 1, 8 };
+        case img::fourcc::MONO16:
+            return { 1, 16 };
+        case img::fourcc::BGR24:
+            return { 3, 8 };
+        case img::fourcc::BGRA32:
+            return { 4, 8 };
+        case img::fourcc::BGRA64:
+            return { 4, 16 };
+        default:
+            return { 0, 0 };
+    }
+}
+
+int calc_entry_count(const sample_layout& layout) noexcept
+{
+    // the 4th channel is declared as unspecified extra sample
+    return layout.samples == 4 ? 11 : 10;
+}
+
+size_t calc_ifd_size(const sample_layout& layout) noexcept
+{
+    return 2 + calc_entry_count(layout) * 12 + 4;
+}
+
+template<class T> void write_le(uint8_t*& dst, T value) noexcept
+{
+    // all supported platforms are little endian
+    memcpy(dst, &value, sizeof(value));
+    dst += sizeof(value);
+}
+
+void write_entry(uint8_t*& dst, uint16_t tag, uint16_t type, uint32_t count, uint32_t value) noexcept
+{
+    write_le(dst, tag);
+    write_le(dst, type);
+    write_le(dst, count);
+    if (type == type_short && count == 1)
+    {
+        // values are left aligned in the field
+        write_le(dst, static_cast<uint16_t>(value));
+        write_le(dst, uint16_t(0));
+    }
+    else
+    {
+        write_le(dst, value);
+    }
+}
+
+template<class T> void swap_red_blue(const img::img_descriptor& img, int channels) noexcept
+{
+    for (int y = 0; y < img.dim.cy; ++y)
+    {
+        auto line = img::get_line_start<T>(img, y);
+        for (int x = 0; x < img.dim.cx; ++x)
+        {
+            std::swap(line[x * channels], line[x * channels + 2]);
+        }
+    }
+}
+
+} // namespace
+
+
+bool tcam::tools::convert::can_write_tiff(img::fourcc fcc) noexcept
+{
+    return get_sample_layout(fcc).samples != 0;
+}
+
+
+size_t tcam::tools::convert::calc_tiff_header_size(const img::img_type& type) noexcept
+{
+    const auto layout = get_sample_layout(type.fourcc_type());
+    // file header, ifd and the BitsPerSample array, padded so the pixels are aligned
+    const size_t size = 8 + calc_ifd_size(layout) + layout.samples * 2;
+    return (size + 63) / 64 * 64;
+}
+
+
+void tcam::tools::convert::write_tiff_header(uint8_t* dst, const img::img_type& type) noexcept
+{
+    const auto layout = get_sample_layout(type.fourcc_type());
+    const auto header_size = static_cast<uint32_t>(calc_tiff_header_size(type));
+    const auto width = static_cast<uint32_t>(type.dim.cx);
+    const auto height = static_cast<uint32_t>(type.dim.cy);
+    const auto image_size = static_cast<uint32_t>(type.buffer_length);
+
+    memset(dst, 0, header_size);
+
+    uint8_t* p = dst;
+    write_le(p, uint16_t(0x4949)); // "II"
+    write_le(p, uint16_t(42));
+    write_le(p, uint32_t(8));
+
+    const auto bits_offset = static_cast<uint32_t>(8 + calc_ifd_size(layout));
+
+    write_le(p, static_cast<uint16_t>(calc_entry_count(layout)));
+    write_entry(p, ImageWidth, type_long, 1, width);
+    write_entry(p, ImageLength, type_long, 1, height);
+    if (layout.samples == 1)
+    {
+        write_entry(p, BitsPerSample, type_short, 1, layout.bits);
+    }
+    else
+    {
+        write_entry(p, BitsPerSample, type_short, layout.samples, bits_offset);
+    }
+    write_entry(p, Compression, type_short, 1, 1);
+    // BlackIsZero, RGB
+    write_entry(p, PhotometricInterpretation, type_short, 1, layout.samples == 1 ? 1 : 2);
+    write_entry(p, StripOffsets, type_long, 1, header_size);
+    write_entry(p, SamplesPerPixel, type_short, 1, layout.samples);
+    write_entry(p, RowsPerStrip, type_long, 1, height);
+    write_entry(p, StripByteCounts, type_long, 1, image_size);
+    write_entry(p, PlanarConfiguration, type_short, 1, 1);
+    if (layout.samples == 4)
+    {
+        write_entry(p, ExtraSamples, type_short, 1, 0);
+    }
+    // no further ifd
+    write_le(p, uint32_t(0));
+
+    for (int i = 0; i < layout.samples; ++i) { write_le(p, static_cast<uint16_t>(layout.bits)); }
+}
+
+
+void tcam::tools::convert::reorder_for_tiff(const img::img_descriptor& img) noexcept
+{
+    switch (img.fourcc_type())
+    {
+        case img::fourcc::BGR24:
+            swap_red_blue<uint8_t>(img, 3);
+            break;
+        case img::fourcc::BGRA32:
+            swap_red_blue<uint8_t>(img, 4);
+            break;
+        case img::fourcc::BGRA64:
+            swap_red_blue<uint16_t>(img, 4);
+            break;
+        default:
+            break;
+    }
+}
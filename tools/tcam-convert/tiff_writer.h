@@ -0,0 +1,44 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <dutils_img/dutils_img.h>
+
+namespace tcam::tools::convert
+{
+
+/*
+ * Uncompressed baseline TIFF, little endian, one strip.
+ * The pixels directly follow the header, so frames are converted in place
+ * into the memory that is written to the file.
+ */
+
+// MONO8, MONO16, BGR24, BGRA32 and BGRA64
+bool can_write_tiff(img::fourcc fcc) noexcept;
+
+// offset of the pixels in the file
+size_t calc_tiff_header_size(const img::img_type& type) noexcept;
+
+// dst has to hold calc_tiff_header_size bytes
+void write_tiff_header(uint8_t* dst, const img::img_type& type) noexcept;
+
+// swaps blue and red in place, TIFF stores rgb
+void reorder_for_tiff(const img::img_descriptor& img) noexcept;
+
+} // namespace tcam::tools::convert
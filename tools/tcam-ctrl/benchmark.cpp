@@ -0,0 +1,523 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "benchmark.h"
+
+#include "../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
+#include "../../src/CaptureDevice.h"
+#include "general.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <ctime>
+#include <dirent.h>
+#include <fstream>
+#include <gst/gst.h>
+#include <iostream>
+#include <json.hpp>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+
+uint64_t clock_ns(clockid_t clock)
+{
+    struct timespec ts = {};
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+
+struct frame_sample
+{
+    uint64_t arrival_ns; // CLOCK_MONOTONIC
+    uint64_t latency_ns; // UINT64_MAX when the capture time is unknown
+    uint64_t frames_dropped;
+    bool is_damaged;
+};
+
+
+class sample_collector
+{
+public:
+    void reserve(size_t count)
+    {
+        std::scoped_lock lck { mtx_ };
+        samples_.reserve(count);
+    }
+
+    void add(uint64_t capture_time_ns, uint64_t frames_dropped, bool is_damaged)
+    {
+        const uint64_t mono = clock_ns(CLOCK_MONOTONIC);
+
+        // devices stamp with either CLOCK_MONOTONIC (v4l2) or CLOCK_REALTIME (aravis, usb),
+        // the capture time is in the past of the one it was taken from
+        uint64_t latency = UINT64_MAX;
+        if (capture_time_ns != 0)
+        {
+            const uint64_t real = clock_ns(CLOCK_REALTIME);
+            if (mono >= capture_time_ns)
+            {
+                latency = mono - capture_time_ns;
+            }
+            if (real >= capture_time_ns)
+            {
+                latency = std::min(latency, real - capture_time_ns);
+            }
+        }
+
+        std::scoped_lock lck { mtx_ };
+        samples_.push_back({ mono, latency, frames_dropped, is_damaged });
+    }
+
+    std::vector<frame_sample> take()
+    {
+        std::scoped_lock lck { mtx_ };
+        return std::move(samples_);
+    }
+
+private:
+    std::mutex mtx_;
+    std::vector<frame_sample> samples_;
+};
+
+
+struct thread_time
+{
+    std::string name;
+    uint64_t ticks = 0;
+};
+
+// utime + stime of every thread of this process, by tid
+std::map<int, thread_time> read_thread_times()
+{
+    std::map<int, thread_time> ret;
+
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir)
+    {
+        return ret;
+    }
+
+    while (auto entry = readdir(dir))
+    {
+        if (entry->d_name[0] == '.')
+        {
+            continue;
+        }
+
+        std::ifstream ifs(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        std::string line;
+        if (!std::getline(ifs, line))
+        {
+            continue;
+        }
+
+        // the name may contain spaces and parentheses
+        auto name_begin = line.find('(');
+        auto name_end = line.rfind(')');
+        if (name_begin == std::string::npos || name_end == std::string::npos)
+        {
+            continue;
+        }
+
+        // the fields after the name start with 'state', utime and stime follow 11 fields later
+        std::istringstream fields(line.substr(name_end + 2));
+        std::string skip;
+        for (int i = 0; i < 11; ++i)
+        {
+            fields >> skip;
+        }
+        uint64_t utime = 0;
+        uint64_t stime = 0;
+        fields >> utime >> stime;
+
+        ret[std::atoi(entry->d_name)] = {
+            line.substr(name_begin + 1, name_end - name_begin - 1), utime + stime
+        };
+    }
+    closedir(dir);
+
+    return ret;
+}
+
+
+nlohmann::json thread_cpu_usage(const std::map<int, thread_time>& before,
+                                const std::map<int, thread_time>& after,
+                                double seconds)
+{
+    const double ticks_per_second = sysconf(_SC_CLK_TCK);
+
+    auto ret = nlohmann::json::array();
+    for (const auto& [tid, t] : after)
+    {
+        uint64_t ticks = t.ticks;
+        if (auto iter = before.find(tid); iter != before.end())
+        {
+            ticks -= std::min(ticks, iter->second.ticks);
+        }
+        if (ticks == 0)
+        {
+            continue;
+        }
+        ret.push_back({
+            { "tid", tid },
+            { "name", t.name },
+            { "cpu_percent", ticks / ticks_per_second / seconds * 100. },
+        });
+    }
+    return ret;
+}
+
+
+nlohmann::json evaluate(const std::vector<frame_sample>& samples)
+{
+    nlohmann::json ret;
+    ret["frames"] = samples.size();
+
+    if (samples.size() < 2)
+    {
+        ret["fps"] = 0;
+        return ret;
+    }
+
+    const auto& first = samples.front();
+    const auto& last = samples.back();
+
+    ret["fps"] = (samples.size() - 1) * 1e9 / (last.arrival_ns - first.arrival_ns);
+    ret["frames_dropped"] = last.frames_dropped - std::min(first.frames_dropped, last.frames_dropped);
+    ret["frames_damaged"] = std::count_if(
+        samples.begin(), samples.end(), [](const frame_sample& s) { return s.is_damaged; });
+
+    std::vector<uint64_t> intervals;
+    intervals.reserve(samples.size());
+    std::vector<uint64_t> latencies;
+    latencies.reserve(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        if (i > 0)
+        {
+            intervals.push_back(samples[i].arrival_ns - samples[i - 1].arrival_ns);
+        }
+        if (samples[i].latency_ns != UINT64_MAX)
+        {
+            latencies.push_back(samples[i].latency_ns);
+        }
+    }
+
+    // deviation of every interval from the median interval
+    auto sorted = intervals;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    const uint64_t median = sorted[sorted.size() / 2];
+
+    std::vector<uint64_t> jitter;
+    jitter.reserve(intervals.size());
+    for (auto interval : intervals)
+    {
+        jitter.push_back(interval > median ? interval - median : median - interval);
+    }
+
+    ret["frame_interval_us"] = tcam::tools::ctrl::percentiles_us(std::move(intervals));
+    ret["jitter_us"] = tcam::tools::ctrl::percentiles_us(std::move(jitter));
+    ret["latency_us"] = tcam::tools::ctrl::percentiles_us(std::move(latencies));
+
+    return ret;
+}
+
+
+bool is_selected(const std::vector<std::string>& formats, const std::string& name)
+{
+    return formats.empty() || std::find(formats.begin(), formats.end(), name) != formats.end();
+}
+
+
+// the largest resolution of every resolution entry, at the highest framerate
+std::vector<tcam::VideoFormat> collect_library_formats(const tcam::CaptureDevice& dev,
+                                                       const std::vector<std::string>& selection)
+{
+    std::vector<tcam::VideoFormat> ret;
+    for (const auto& desc : dev.get_available_video_formats())
+    {
+        for (const auto& res : desc.get_resolutions())
+        {
+            tcam::VideoFormat fmt(desc.get_fourcc(), res.max_size, res.scaling);
+            if (!is_selected(selection, fmt.get_fourcc_string()))
+            {
+                continue;
+            }
+
+            auto rates = desc.get_framerates(fmt);
+            if (rates.empty())
+            {
+                continue;
+            }
+            fmt.set_framerate(*std::max_element(rates.begin(), rates.end()));
+            ret.push_back(fmt);
+        }
+    }
+    return ret;
+}
+
+
+nlohmann::json run_library(tcam::CaptureDevice& dev, const tcam::VideoFormat& fmt, int seconds)
+{
+    nlohmann::json ret;
+    ret["format"] = fmt.to_string();
+
+    sample_collector collector;
+    collector.reserve(static_cast<size_t>(fmt.get_framerate() * seconds * 1.5) + 16);
+
+    tcam::ImageSink* sink_ptr = nullptr;
+    auto sink = std::make_shared<tcam::ImageSink>(
+        [&](const std::shared_ptr<tcam::ImageBuffer>& buffer)
+        {
+            const auto stats = buffer->get_statistics();
+            collector.add(stats.capture_time_ns, stats.frames_dropped, stats.is_damaged);
+            sink_ptr->requeue_buffer(buffer);
+        },
+        fmt,
+        10);
+    sink_ptr = sink.get();
+
+    if (!dev.configure_stream(fmt, sink, nullptr) || !dev.start_stream())
+    {
+        dev.free_stream();
+        ret["error"] = "Unable to start the stream";
+        return ret;
+    }
+
+    const auto times_before = read_thread_times();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    const auto times_after = read_thread_times();
+
+    dev.stop_stream();
+    dev.free_stream();
+
+    ret["result"] = evaluate(collector.take());
+    ret["threads"] = thread_cpu_usage(times_before, times_after, seconds);
+    return ret;
+}
+
+
+// every caps structure of tcamsrc, fixated to its largest resolution and framerate
+std::vector<std::string> collect_gst_caps(const std::string& serial,
+                                          const std::vector<std::string>& selection)
+{
+    std::vector<std::string> ret;
+
+    auto source = tcam::tools::ctrl::open_element("tcamsrc");
+    if (!source || !tcam::tools::ctrl::set_serial(source, serial))
+    {
+        return ret;
+    }
+
+    tcam::tools::ctrl::ElementStateGuard state_guard(*source.get());
+    if (!state_guard.set_state(GST_STATE_READY))
+    {
+        return ret;
+    }
+
+    auto pad = gst_helper::make_ptr(gst_element_get_static_pad(source.get(), "src"));
+    auto caps = gst_helper::make_ptr(gst_pad_query_caps(pad.get(), nullptr));
+    if (!caps)
+    {
+        return ret;
+    }
+
+    for (unsigned int i = 0; i < gst_caps_get_size(caps.get()); ++i)
+    {
+        auto tmp = gst_helper::make_consume_ptr<GstCaps>(gst_caps_copy_nth(caps.get(), i));
+        GstStructure* struc = gst_caps_get_structure(tmp.get(), 0);
+
+        gst_structure_fixate_field_nearest_int(struc, "width", INT_MAX);
+        gst_structure_fixate_field_nearest_int(struc, "height", INT_MAX);
+        gst_structure_fixate_field_nearest_fraction(struc, "framerate", 10000, 1);
+
+        auto fixated = gst_helper::make_consume_ptr<GstCaps>(gst_caps_fixate(gst_caps_ref(tmp.get())));
+        struc = gst_caps_get_structure(fixated.get(), 0);
+
+        const char* format = gst_structure_get_string(struc, "format");
+        if (!is_selected(selection, format ? format : ""))
+        {
+            continue;
+        }
+
+        char* str = gst_caps_to_string(fixated.get());
+        if (std::find(ret.begin(), ret.end(), str) == ret.end())
+        {
+            ret.push_back(str);
+        }
+        g_free(str);
+    }
+    return ret;
+}
+
+
+void gst_handoff(GstElement* /*sink*/, GstBuffer* buffer, GstPad* /*pad*/, gpointer user_data)
+{
+    auto& collector = *static_cast<sample_collector*>(user_data);
+
+    if (auto meta = gst_buffer_get_tcam_statistics_values_meta(buffer))
+    {
+        collector.add(meta->values.capture_time_ns, meta->values.frames_dropped, meta->values.is_damaged);
+    }
+    else
+    {
+        collector.add(0, 0, false);
+    }
+}
+
+
+nlohmann::json run_gstreamer(const std::string& serial, const std::string& caps, int seconds)
+{
+    nlohmann::json ret;
+    ret["format"] = caps;
+
+    const std::string pipeline_str = "tcambin name=bin serial=\"" + serial + "\" ! capsfilter caps=\""
+                                     + caps + "\" ! fakesink name=sink signal-handoffs=true sync=false";
+
+    GError* err = nullptr;
+    auto pipeline = gst_helper::make_consume_ptr<GstElement>(gst_parse_launch(pipeline_str.c_str(), &err));
+    if (err)
+    {
+        ret["error"] = err->message;
+        g_error_free(err);
+        return ret;
+    }
+
+    sample_collector collector;
+
+    auto sink = gst_helper::make_consume_ptr<GstElement>(gst_bin_get_by_name(GST_BIN(pipeline.get()), "sink"));
+    g_signal_connect(sink.get(), "handoff", G_CALLBACK(gst_handoff), &collector);
+
+    {
+        tcam::tools::ctrl::ElementStateGuard state_guard(*pipeline.get());
+        if (!state_guard.set_state(GST_STATE_PLAYING))
+        {
+            ret["error"] = "Unable to start the pipeline";
+            return ret;
+        }
+
+        const auto times_before = read_thread_times();
+
+        // returns early when the pipeline fails
+        auto bus = gst_helper::make_consume_ptr<GstBus>(gst_element_get_bus(pipeline.get()));
+        GstMessage* msg = gst_bus_timed_pop_filtered(
+            bus.get(), seconds * GST_SECOND, (GstMessageType)(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+        if (msg)
+        {
+            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR)
+            {
+                GError* msg_err = nullptr;
+                gst_message_parse_error(msg, &msg_err, nullptr);
+                ret["error"] = msg_err ? msg_err->message : "unknown";
+                g_clear_error(&msg_err);
+            }
+            gst_message_unref(msg);
+        }
+
+        const auto times_after = read_thread_times();
+        ret["threads"] = thread_cpu_usage(times_before, times_after, seconds);
+    } // state_guard
+
+    ret["result"] = evaluate(collector.take());
+    return ret;
+}
+
+} // namespace
+
+
+nlohmann::json tcam::tools::ctrl::percentiles_us(std::vector<uint64_t> values)
+{
+    if (values.empty())
+    {
+        return nullptr;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    auto at = [&values](double p)
+    {
+        return values.at(static_cast<size_t>(p * (values.size() - 1))) / 1000.;
+    };
+
+    return {
+        { "p50", at(0.5) },
+        { "p90", at(0.9) },
+        { "p99", at(0.99) },
+        { "max", values.back() / 1000. },
+    };
+}
+
+
+int tcam::tools::ctrl::run_benchmark(const benchmark_options& options)
+{
+    if (options.seconds <= 0)
+    {
+        std::cerr << "Benchmark time has to be at least one second." << std::endl;
+        return 1;
+    }
+
+    if (!is_valid_device_serial(options.serial))
+    {
+        std::cerr << "Device with given serial does not exist." << std::endl;
+        return 1;
+    }
+
+    nlohmann::json ret;
+    ret["serial"] = options.serial;
+    ret["seconds_per_format"] = options.seconds;
+
+    if (options.path != BenchmarkPath::GStreamer)
+    {
+        auto results = nlohmann::json::array();
+
+        auto dev = tcam::open_device(options.serial);
+        if (!dev)
+        {
+            std::cerr << "Unable to open device." << std::endl;
+            return 1;
+        }
+
+        for (const auto& fmt : collect_library_formats(*dev, options.formats))
+        {
+            std::cerr << "library: " << fmt.to_string() << std::endl;
+            results.push_back(run_library(*dev, fmt, options.seconds));
+        }
+        ret["library"] = results;
+    }
+
+    // the device is closed again, tcambin opens it on its own
+    if (options.path != BenchmarkPath::Library)
+    {
+        auto results = nlohmann::json::array();
+
+        for (const auto& caps : collect_gst_caps(options.serial, options.formats))
+        {
+            std::cerr << "gstreamer: " << caps << std::endl;
+            results.push_back(run_gstreamer(options.serial, caps, options.seconds));
+        }
+        ret["gstreamer"] = results;
+    }
+
+    std::cout << ret.dump(4) << std::endl;
+    return 0;
+}
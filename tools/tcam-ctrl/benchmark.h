@@ -0,0 +1,59 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <json.hpp>
+#include <string>
+#include <vector>
+
+namespace tcam::tools::ctrl
+{
+
+enum class BenchmarkPath
+{
+    Both,
+    Library,
+    GStreamer,
+};
+
+struct benchmark_options
+{
+    std::string serial;
+
+    // streaming time per format
+    int seconds = 5;
+
+    // fourcc strings (library) or GStreamer format names, empty means all formats
+    std::vector<std::string> formats;
+
+    BenchmarkPath path = BenchmarkPath::Both;
+};
+
+/**
+ * Streams every format of the device once through libtcam
+ * and once through 'tcambin ! fakesink'.
+ * Prints fps, drops, inter frame jitter, arrival latency and
+ * per thread cpu usage as JSON to stdout.
+ * @return 0 on success, otherwise the process exit code
+ */
+int run_benchmark(const benchmark_options& options);
+
+// p50, p90, p99 and max of durations in ns as us, null when values is empty
+nlohmann::json percentiles_us(std::vector<uint64_t> values);
+
+} // namespace tcam::tools::ctrl
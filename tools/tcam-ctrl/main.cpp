@@ -16,6 +16,8 @@
 
 #include "../../src/public_utils.h"
 #include "../../src/version.h"
+#include "benchmark.h"
+#include "property_benchmark.h"
 #include "formats.h"
 #include "general.h"
 #include "properties.h"
@@ -138,6 +140,44 @@ int main(int argc, char* argv[])
                                      "Read a JSON string/file containing properties and their "
                                      "values and set them in the device");
 
+    auto benchmark = app.add_option("--benchmark",
+                                    serial,
+                                    "Stream every format through the library and tcambin, print "
+                                    "fps, drops, jitter, latency and cpu usage as JSON");
+
+    benchmark_options bench_options;
+    app.add_option("--benchmark-seconds", bench_options.seconds, "Streaming time per format", true)
+        ->needs(benchmark);
+    app.add_option("--benchmark-formats",
+                   bench_options.formats,
+                   "Formats to benchmark, fourcc (library) or GStreamer format names")
+        ->delimiter(',')
+        ->needs(benchmark);
+
+    std::string bench_path = "both";
+    app.add_option("--benchmark-path", bench_path, "Which streaming path to benchmark", true)
+        ->check(CLI::IsMember({ "both", "library", "gstreamer" }))
+        ->needs(benchmark);
+
+    auto property_benchmark =
+        app.add_option("--property-benchmark",
+                       serial,
+                       "Measure get and set latency of every property through the library and "
+                       "tcamsrc, idle and while streaming, print the percentiles as JSON");
+
+    property_benchmark_options prop_bench_options;
+    app.add_option("--property-benchmark-iterations",
+                   prop_bench_options.iterations,
+                   "Calls per property and operation",
+                   true)
+        ->needs(property_benchmark);
+
+    std::string prop_bench_path = "both";
+    app.add_option(
+           "--property-benchmark-path", prop_bench_path, "Which property path to benchmark", true)
+        ->check(CLI::IsMember({ "both", "library", "gstreamer" }))
+        ->needs(property_benchmark);
+
     auto list_transform = app.add_subcommand("--transform", "list format transformations of a GstElement");
 
     std::string transform_element = "tcamconvert";
@@ -275,6 +315,32 @@ int main(int argc, char* argv[])
 
         load_state_json_string(serial, json_str);
     }
+    else if (*benchmark)
+    {
+        bench_options.serial = serial;
+        if (bench_path == "library")
+        {
+            bench_options.path = BenchmarkPath::Library;
+        }
+        else if (bench_path == "gstreamer")
+        {
+            bench_options.path = BenchmarkPath::GStreamer;
+        }
+        return run_benchmark(bench_options);
+    }
+    else if (*property_benchmark)
+    {
+        prop_bench_options.serial = serial;
+        if (prop_bench_path == "library")
+        {
+            prop_bench_options.path = BenchmarkPath::Library;
+        }
+        else if (prop_bench_path == "gstreamer")
+        {
+            prop_bench_options.path = BenchmarkPath::GStreamer;
+        }
+        return run_property_benchmark(prop_bench_options);
+    }
     else if (*list_transform)
     {
         std::string caps_str = "";
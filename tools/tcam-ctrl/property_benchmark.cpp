@@ -0,0 +1,572 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "property_benchmark.h"
+
+#include "../../src/CaptureDevice.h"
+#include "general.h"
+
+#include <algorithm>
+#include <chrono>
+#include <gst/gst.h>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <tcam-property-1.0.h>
+#include <thread>
+
+namespace
+{
+
+template<class TFunc> uint64_t measure_ns(TFunc&& func)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+
+struct property_result
+{
+    std::string name;
+    std::string type;
+    // software property of libtcam, only known for the library path
+    bool is_software = false;
+
+    std::vector<uint64_t> get;
+    std::vector<uint64_t> set;
+    // the first get after a write, caches have been invalidated by the write
+    std::vector<uint64_t> get_after_set;
+
+    int errors = 0;
+};
+
+
+// merges the samples of every property of a type
+nlohmann::json summarize(const std::vector<property_result>& results)
+{
+    std::map<std::string, property_result> by_type;
+    for (const auto& res : results)
+    {
+        auto& entry = by_type[res.type];
+        entry.get.insert(entry.get.end(), res.get.begin(), res.get.end());
+        entry.set.insert(entry.set.end(), res.set.begin(), res.set.end());
+        entry.get_after_set.insert(
+            entry.get_after_set.end(), res.get_after_set.begin(), res.get_after_set.end());
+        entry.errors += res.errors;
+    }
+
+    nlohmann::json ret;
+    for (auto& [type, entry] : by_type)
+    {
+        ret[type] = {
+            { "get_us", tcam::tools::ctrl::percentiles_us(std::move(entry.get)) },
+            { "set_us", tcam::tools::ctrl::percentiles_us(std::move(entry.set)) },
+            { "get_after_set_us",
+              tcam::tools::ctrl::percentiles_us(std::move(entry.get_after_set)) },
+            { "errors", entry.errors },
+        };
+    }
+    return ret;
+}
+
+
+nlohmann::json to_json(std::vector<property_result>&& results)
+{
+    auto summary = summarize(results);
+
+    auto properties = nlohmann::json::array();
+    for (auto& res : results)
+    {
+        properties.push_back({
+            { "name", res.name },
+            { "type", res.type },
+            { "software", res.is_software },
+            { "get_us", tcam::tools::ctrl::percentiles_us(std::move(res.get)) },
+            { "set_us", tcam::tools::ctrl::percentiles_us(std::move(res.set)) },
+            { "get_after_set_us", tcam::tools::ctrl::percentiles_us(std::move(res.get_after_set)) },
+            { "errors", res.errors },
+        });
+    }
+    return { { "summary", summary }, { "properties", properties } };
+}
+
+
+bool is_ok(const std::error_code& ec)
+{
+    return !ec;
+}
+
+// outcome::result
+template<class TResult> bool is_ok(const TResult& res)
+{
+    return res.has_value();
+}
+
+
+// set writes the current value back, so that the device state is not changed
+template<class TValue, class TProp>
+void measure_library_value(TProp& prop, bool writable, int iterations, property_result& res)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        bool ok = false;
+        res.get.push_back(measure_ns([&] { ok = is_ok(prop.get_value()); }));
+        res.errors += ok ? 0 : 1;
+    }
+
+    if (!writable)
+    {
+        return;
+    }
+    auto current = prop.get_value();
+    if (!current)
+    {
+        return;
+    }
+    const TValue value { current.value() };
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bool ok = false;
+        res.set.push_back(measure_ns([&] { ok = is_ok(prop.set_value(value)); }));
+        res.errors += ok ? 0 : 1;
+
+        res.get_after_set.push_back(measure_ns([&] { ok = is_ok(prop.get_value()); }));
+        res.errors += ok ? 0 : 1;
+    }
+}
+
+
+std::vector<property_result> measure_library(
+    const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& properties,
+    int iterations)
+{
+    using namespace tcam::property;
+
+    std::vector<property_result> ret;
+    for (const auto& prop : properties)
+    {
+        const auto flags = prop->get_flags();
+        if (!(flags & PropertyFlags::Available)
+            || prop->get_type() == tcamprop1::prop_type::Command)
+        {
+            continue;
+        }
+        const bool writable = !(flags & PropertyFlags::Locked)
+                              && prop->get_static_info().access != tcamprop1::Access_t::RO;
+
+        property_result res;
+        res.name = prop->get_name();
+        res.type = tcamprop1::to_string(prop->get_type());
+        res.is_software = flags & PropertyFlags::External;
+
+        switch (prop->get_type())
+        {
+            case tcamprop1::prop_type::Integer:
+                measure_library_value<int64_t>(
+                    static_cast<IPropertyInteger&>(*prop), writable, iterations, res);
+                break;
+            case tcamprop1::prop_type::Float:
+                measure_library_value<double>(
+                    static_cast<IPropertyFloat&>(*prop), writable, iterations, res);
+                break;
+            case tcamprop1::prop_type::Boolean:
+                measure_library_value<bool>(
+                    static_cast<IPropertyBool&>(*prop), writable, iterations, res);
+                break;
+            case tcamprop1::prop_type::Enumeration:
+                measure_library_value<std::string>(
+                    static_cast<IPropertyEnum&>(*prop), writable, iterations, res);
+                break;
+            case tcamprop1::prop_type::String:
+                measure_library_value<std::string>(
+                    static_cast<IPropertyString&>(*prop), writable, iterations, res);
+                break;
+            case tcamprop1::prop_type::Command:
+                break;
+        }
+        ret.push_back(std::move(res));
+    }
+    return ret;
+}
+
+
+// the first resolution of the first format at its highest framerate
+std::optional<tcam::VideoFormat> select_stream_format(const tcam::CaptureDevice& dev)
+{
+    for (const auto& desc : dev.get_available_video_formats())
+    {
+        for (const auto& res : desc.get_resolutions())
+        {
+            tcam::VideoFormat fmt(desc.get_fourcc(), res.max_size, res.scaling);
+            auto rates = desc.get_framerates(fmt);
+            if (rates.empty())
+            {
+                continue;
+            }
+            fmt.set_framerate(*std::max_element(rates.begin(), rates.end()));
+            return fmt;
+        }
+    }
+    return std::nullopt;
+}
+
+
+nlohmann::json run_library(const std::string& serial, int iterations)
+{
+    nlohmann::json ret;
+
+    auto dev = tcam::open_device(serial);
+    if (!dev)
+    {
+        ret["error"] = "Unable to open device";
+        return ret;
+    }
+
+    const auto properties = dev->get_properties();
+
+    ret["idle"] = to_json(measure_library(properties, iterations));
+
+    auto fmt = select_stream_format(*dev);
+    if (!fmt)
+    {
+        ret["streaming"] = { { "error", "No format to stream" } };
+        return ret;
+    }
+
+    tcam::ImageSink* sink_ptr = nullptr;
+    auto sink = std::make_shared<tcam::ImageSink>(
+        [&](const std::shared_ptr<tcam::ImageBuffer>& buffer) { sink_ptr->requeue_buffer(buffer); },
+        *fmt,
+        10);
+    sink_ptr = sink.get();
+
+    if (!dev->configure_stream(*fmt, sink, nullptr) || !dev->start_stream())
+    {
+        dev->free_stream();
+        ret["streaming"] = { { "error", "Unable to start the stream" } };
+        return ret;
+    }
+
+    // the first frames come with the stream setup, which is not what is measured
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    ret["streaming"] = to_json(measure_library(properties, iterations));
+    ret["streaming"]["format"] = fmt->to_string();
+
+    dev->stop_stream();
+    dev->free_stream();
+    return ret;
+}
+
+
+const char* to_type_string(TcamPropertyType type)
+{
+    switch (type)
+    {
+        case TCAM_PROPERTY_TYPE_INTEGER:
+            return "Integer";
+        case TCAM_PROPERTY_TYPE_FLOAT:
+            return "Float";
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+            return "Enumeration";
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+            return "Boolean";
+        case TCAM_PROPERTY_TYPE_COMMAND:
+            return "Command";
+        case TCAM_PROPERTY_TYPE_STRING:
+            return "String";
+    }
+    return "unknown";
+}
+
+
+// calls func with a GError**, counts the errors
+template<class TFunc> uint64_t measure_gerror_ns(TFunc&& func, int& errors)
+{
+    GError* err = nullptr;
+    const auto ret = measure_ns([&] { func(&err); });
+    if (err)
+    {
+        ++errors;
+        g_error_free(err);
+    }
+    return ret;
+}
+
+
+// get_value returns the value and takes a GError**, set_value takes the value and a GError**
+template<class TGet, class TSet>
+void measure_gst_value(bool writable,
+                       int iterations,
+                       property_result& res,
+                       TGet&& get_value,
+                       TSet&& set_value)
+{
+    for (int i = 0; i < iterations; ++i)
+    {
+        res.get.push_back(measure_gerror_ns([&](GError** err) { get_value(err); }, res.errors));
+    }
+
+    if (!writable)
+    {
+        return;
+    }
+    GError* err = nullptr;
+    auto value = get_value(&err);
+    if (err)
+    {
+        g_error_free(err);
+        return;
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        res.set.push_back(
+            measure_gerror_ns([&](GError** e) { set_value(value, e); }, res.errors));
+        res.get_after_set.push_back(
+            measure_gerror_ns([&](GError** e) { get_value(e); }, res.errors));
+    }
+}
+
+
+property_result measure_gst_property(TcamPropertyBase* base, int iterations)
+{
+    property_result res;
+    res.name = tcam_property_base_get_name(base);
+    res.type = to_type_string(tcam_property_base_get_property_type(base));
+
+    GError* err = nullptr;
+    const bool available = tcam_property_base_is_available(base, &err);
+    g_clear_error(&err);
+    const bool locked = tcam_property_base_is_locked(base, &err);
+    g_clear_error(&err);
+
+    if (!available)
+    {
+        return res;
+    }
+    const bool writable = !locked && tcam_property_base_get_access(base) != TCAM_PROPERTY_ACCESS_RO;
+
+    switch (tcam_property_base_get_property_type(base))
+    {
+        case TCAM_PROPERTY_TYPE_INTEGER:
+        {
+            auto prop = TCAM_PROPERTY_INTEGER(base);
+            measure_gst_value(
+                writable,
+                iterations,
+                res,
+                [prop](GError** e) { return tcam_property_integer_get_value(prop, e); },
+                [prop](gint64 v, GError** e) { tcam_property_integer_set_value(prop, v, e); });
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_FLOAT:
+        {
+            auto prop = TCAM_PROPERTY_FLOAT(base);
+            measure_gst_value(
+                writable,
+                iterations,
+                res,
+                [prop](GError** e) { return tcam_property_float_get_value(prop, e); },
+                [prop](gdouble v, GError** e) { tcam_property_float_set_value(prop, v, e); });
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_BOOLEAN:
+        {
+            auto prop = TCAM_PROPERTY_BOOLEAN(base);
+            measure_gst_value(
+                writable,
+                iterations,
+                res,
+                [prop](GError** e) { return tcam_property_boolean_get_value(prop, e); },
+                [prop](gboolean v, GError** e) { tcam_property_boolean_set_value(prop, v, e); });
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_ENUMERATION:
+        {
+            auto prop = TCAM_PROPERTY_ENUMERATION(base);
+            measure_gst_value(
+                writable,
+                iterations,
+                res,
+                [prop](GError** e)
+                {
+                    const char* v = tcam_property_enumeration_get_value(prop, e);
+                    return std::string { v ? v : "" };
+                },
+                [prop](const std::string& v, GError** e)
+                { tcam_property_enumeration_set_value(prop, v.c_str(), e); });
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_STRING:
+        {
+            auto prop = TCAM_PROPERTY_STRING(base);
+            measure_gst_value(
+                writable,
+                iterations,
+                res,
+                [prop](GError** e)
+                {
+                    char* v = tcam_property_string_get_value(prop, e);
+                    std::string ret { v ? v : "" };
+                    g_free(v);
+                    return ret;
+                },
+                [prop](const std::string& v, GError** e)
+                { tcam_property_string_set_value(prop, v.c_str(), e); });
+            break;
+        }
+        case TCAM_PROPERTY_TYPE_COMMAND:
+            break;
+    }
+    return res;
+}
+
+
+nlohmann::json measure_gst(GstElement* source, int iterations)
+{
+    auto provider = TCAM_PROPERTY_PROVIDER(source);
+
+    GError* err = nullptr;
+    GSList* names = tcam_property_provider_get_tcam_property_names(provider, &err);
+    if (err)
+    {
+        nlohmann::json ret = { { "error", err->message } };
+        g_error_free(err);
+        return ret;
+    }
+
+    std::vector<uint64_t> name_resolution;
+    std::vector<property_result> results;
+    for (GSList* entry = names; entry != nullptr; entry = entry->next)
+    {
+        const char* name = static_cast<const char*>(entry->data);
+
+        int errors = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            name_resolution.push_back(measure_gerror_ns(
+                [&](GError** e)
+                {
+                    if (auto prop = tcam_property_provider_get_tcam_property(provider, name, e))
+                    {
+                        g_object_unref(prop);
+                    }
+                },
+                errors));
+        }
+
+        TcamPropertyBase* base = tcam_property_provider_get_tcam_property(provider, name, &err);
+        if (!base)
+        {
+            g_clear_error(&err);
+            continue;
+        }
+        if (tcam_property_base_get_property_type(base) != TCAM_PROPERTY_TYPE_COMMAND)
+        {
+            auto res = measure_gst_property(base, iterations);
+            res.errors += errors;
+            results.push_back(std::move(res));
+        }
+        g_object_unref(base);
+    }
+    g_slist_free_full(names, g_free);
+
+    auto ret = to_json(std::move(results));
+    ret["name_resolution_us"] = tcam::tools::ctrl::percentiles_us(std::move(name_resolution));
+    return ret;
+}
+
+
+nlohmann::json run_gstreamer(const std::string& serial, int iterations)
+{
+    nlohmann::json ret;
+
+    const std::string pipeline_str =
+        "tcamsrc name=source serial=\"" + serial + "\" ! fakesink sync=false";
+
+    GError* err = nullptr;
+    auto pipeline =
+        gst_helper::make_consume_ptr<GstElement>(gst_parse_launch(pipeline_str.c_str(), &err));
+    if (err)
+    {
+        ret["error"] = err->message;
+        g_error_free(err);
+        return ret;
+    }
+
+    auto source = gst_helper::make_consume_ptr<GstElement>(
+        gst_bin_get_by_name(GST_BIN(pipeline.get()), "source"));
+
+    tcam::tools::ctrl::ElementStateGuard state_guard(*pipeline.get());
+    if (!state_guard.set_state(GST_STATE_READY))
+    {
+        ret["error"] = "Unable to open the device";
+        return ret;
+    }
+    ret["idle"] = measure_gst(source.get(), iterations);
+
+    if (!state_guard.set_state(GST_STATE_PLAYING))
+    {
+        ret["streaming"] = { { "error", "Unable to start the pipeline" } };
+        return ret;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    ret["streaming"] = measure_gst(source.get(), iterations);
+    return ret;
+}
+
+} // namespace
+
+
+int tcam::tools::ctrl::run_property_benchmark(const property_benchmark_options& options)
+{
+    if (options.iterations <= 0)
+    {
+        std::cerr << "At least one iteration is required." << std::endl;
+        return 1;
+    }
+
+    if (!is_valid_device_serial(options.serial))
+    {
+        std::cerr << "Device with given serial does not exist." << std::endl;
+        return 1;
+    }
+
+    nlohmann::json ret;
+    ret["serial"] = options.serial;
+    ret["iterations"] = options.iterations;
+
+    if (options.path != BenchmarkPath::GStreamer)
+    {
+        std::cerr << "library" << std::endl;
+        ret["library"] = run_library(options.serial, options.iterations);
+    }
+
+    // the device is closed again, tcamsrc opens it on its own
+    if (options.path != BenchmarkPath::Library)
+    {
+        std::cerr << "gstreamer" << std::endl;
+        ret["gstreamer"] = run_gstreamer(options.serial, options.iterations);
+    }
+
+    std::cout << ret.dump(4) << std::endl;
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "benchmark.h"
+
+#include <string>
+
+namespace tcam::tools::ctrl
+{
+
+struct property_benchmark_options
+{
+    std::string serial;
+
+    // calls per property and operation
+    int iterations = 100;
+
+    BenchmarkPath path = BenchmarkPath::Both;
+};
+
+/**
+ * Measures get and set of every property through libtcam and through the
+ * TcamPropertyProvider interface of tcamsrc, once with and once without a running stream.
+ * Set writes the current value back, commands are never executed.
+ * For tcamsrc the name resolution with tcam_property_provider_get_tcam_property is measured, too.
+ * Prints the percentiles per property and per property type as JSON to stdout.
+ * @return 0 on success, otherwise the process exit code
+ */
+int run_property_benchmark(const property_benchmark_options& options);
+
+} // namespace tcam::tools::ctrl
@@ -1,10 +1,18 @@
 
 #include "system.h"
 
+#include "../../src/CaptureDevice.h"
+#include "../../src/DeviceIndex.h"
+#include "../../src/UsbBandwidthPlanner.h"
+
+#include <algorithm>
 #include <array>
 #include <cstdio>
+#include <iomanip>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -72,6 +80,125 @@ void check_system_info(const std::string& info)
 }
 
 
+std::optional<tcam::usb_location> find_location(const tcam::DeviceInfo& info)
+{
+    const auto identifier = info.get_identifier();
+    if (info.get_device_type() == tcam::TCAM_DEVICE_TYPE_V4L2)
+    {
+        // /dev/video0 is /sys/class/video4linux/video0/device
+        const auto pos = identifier.rfind('/');
+        if (pos == std::string::npos)
+        {
+            return std::nullopt;
+        }
+        return tcam::find_usb_location("/sys/class/video4linux/" + identifier.substr(pos + 1)
+                                       + "/device");
+    }
+    if (info.get_device_type() == tcam::TCAM_DEVICE_TYPE_LIBUSB && !identifier.empty())
+    {
+        return tcam::find_usb_location("/sys/bus/usb/devices/" + identifier);
+    }
+    return std::nullopt;
+}
+
+
+void print_usb_bandwidth()
+{
+    std::cout << std::endl << "USB cameras and the bandwidth of their active format:" << std::endl;
+
+    tcam::DeviceIndex index;
+
+    std::vector<tcam::usb_stream_demand> demands;
+    for (const auto& info : index.get_device_list())
+    {
+        auto location = find_location(info);
+        if (!location)
+        {
+            continue;
+        }
+
+        // cameras that are streaming in another process cannot be opened
+        auto dev = tcam::open_device(info.get_serial(), info.get_device_type());
+        if (!dev)
+        {
+            std::cout << "  " << info.get_serial()
+                      << ": unable to open, the bandwidth is not known" << std::endl;
+            continue;
+        }
+
+        const auto fmt = dev->get_active_video_format();
+
+        tcam::usb_stream_demand demand;
+        demand.serial = info.get_serial();
+        demand.location = *location;
+        demand.payload_bytes = fmt.get_required_buffer_size();
+        demand.framerate = fmt.get_framerate();
+        demands.push_back(demand);
+    }
+
+    if (demands.empty())
+    {
+        std::cout << "  none" << std::endl;
+        return;
+    }
+
+    const auto plans = tcam::UsbBandwidthPlanner::calculate(demands);
+
+    std::vector<std::string> buses;
+    for (const auto& d : demands)
+    {
+        if (std::find(buses.begin(), buses.end(), d.location.bus) == buses.end())
+        {
+            buses.push_back(d.location.bus);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(0);
+    for (const auto& bus : buses)
+    {
+        double required_mbps = 0.0;
+        uint64_t capacity_mbps = 0;
+        for (size_t i = 0; i < demands.size(); ++i)
+        {
+            const auto& d = demands.at(i);
+            if (d.location.bus != bus)
+            {
+                continue;
+            }
+            if (capacity_mbps == 0)
+            {
+                capacity_mbps = tcam::get_usable_usb_bandwidth_mbps(d.location.bus_speed_mbps);
+                std::cout << "  " << bus << " (controller " << d.location.controller << ", "
+                          << d.location.bus_speed_mbps << " Mbit/s, about " << capacity_mbps
+                          << " Mbit/s usable)" << std::endl;
+            }
+
+            const auto& plan = plans.at(i);
+            required_mbps += plan.required_mbps;
+
+            std::cout << "    " << d.serial << " at " << d.location.device << ", "
+                      << d.location.link_speed_mbps << " Mbit/s link: " << plan.required_mbps
+                      << " Mbit/s";
+            if (!plan.fits)
+            {
+                std::cout << ", does not fit, up to " << std::setprecision(1)
+                          << plan.max_framerate << std::setprecision(0) << " fps would";
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "    total " << required_mbps << " of " << capacity_mbps << " Mbit/s";
+        if (required_mbps > static_cast<double>(capacity_mbps))
+        {
+            std::cout << ", expect dropped frames";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << "  Only the cameras that stream at the same time share the bandwidth."
+              << std::endl;
+}
+
 } // namespace
 
 void tcam::tools::print_packages()
@@ -122,6 +249,8 @@ void tcam::tools::print_system_info_usb()
 
     check_system_info("lsusb");
     check_system_info("lsusb -t");
+
+    print_usb_bandwidth();
 }
 
 
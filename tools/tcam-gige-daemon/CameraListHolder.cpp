@@ -18,60 +18,84 @@
 
 #include "../../src/aravis/aravis_utils.h"
 #include "../../src/tcam-network/CameraDiscovery.h"
-#include "../../src/tcam-semaphores.h"
 #include "gige-daemon.h"
 
+#include <algorithm>
 #include <cstring>
+#include <fcntl.h>
 #include <sstream>
-#include <stdlib.h>
-#include <sys/ipc.h>
-#include <sys/ipc.h> /* general SysV IPC structures          */
-#include <sys/msg.h>
-#include <sys/sem.h> /* semaphore functions and structs.     */
-#include <sys/shm.h>
-#include <sys/types.h> /* various type definitions.            */
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace tis;
 
-
-tcam::tools::gige_daemon::CameraListHolder::CameraListHolder() : continue_loop(true)
+namespace
 {
-    // to understand shared memory use this guide:
-    // https://beej.us/guide/bgipc/html/single/bgipc.html#semaphores
-    // https://beej.us/guide/bgipc/html/single/bgipc.html#mqftok
 
-    errno=0;
+// scan interval after a change and without netlink, also the refresh interval of the list
+constexpr std::chrono::seconds fast_scan_interval = std::chrono::seconds(2);
+constexpr std::chrono::seconds fast_scan_duration = std::chrono::seconds(30);
+constexpr std::chrono::seconds default_poll_interval = std::chrono::seconds(10);
+
+} // namespace
+
 
-    // use LOCK_FILE as ftok key and nothing else
-    // LOCK_FILE is created and deleted by this process
-    // it is thus guaranteed to be a unique file that is not
-    // used by anything else
-    shmkey = ftok(LOCK_FILE, 'G');
+tcam::tools::gige_daemon::CameraListHolder::CameraListHolder()
+    : poll_interval(default_poll_interval), continue_loop(true)
+{
+    // remove leftovers of a daemon that did not shut down cleanly,
+    // clients still mapping it see last_update_ns age and remap
+    shm_unlink(SHM_NAME);
+
+    int fd = shm_open(SHM_NAME, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
 
-    if (shmkey == -1)
+    if (fd == -1)
     {
-        throw std::runtime_error("Unable to generate shmkey");
+        throw std::runtime_error("Unable to create shared memory segment");
     }
 
     /* the daemon should work as a system daemon,
-       thus we require the same rights for all users to prevent 'permission denied'
-       errors due to server/client being run by different users. */
-    shmid = shmget(shmkey, sizeof(struct tcam_gige_device_list), 0666 | IPC_CREAT);
+       clients of all users have to be able to read the list
+       independent of the umask the daemon was started with */
+    fchmod(fd, 0644);
 
-    if (shmid == -1)
+    if (ftruncate(fd, sizeof(tcam_gige_device_list)) != 0)
     {
+        close(fd);
+        shm_unlink(SHM_NAME);
         throw std::runtime_error("Unable to allocate shared memory segment");
     }
 
-    semaphore_key = ftok(LOCK_FILE, 'S');
+    void* ptr =
+        mmap(nullptr, sizeof(tcam_gige_device_list), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
 
-    if (semaphore_key == -1)
+    if (ptr == MAP_FAILED)
     {
-        throw std::runtime_error("Unable to generate semaphore key");
+        shm_unlink(SHM_NAME);
+        throw std::runtime_error("Unable to map shared memory segment");
     }
 
-    semaphore_id = tcam::semaphore::create(semaphore_key);
+    // ftruncate zero filled the segment
+    shared_list = static_cast<tcam_gige_device_list*>(ptr);
+    shared_list->version = SHM_VERSION;
+    shared_list->last_update_ns.store(monotonic_ns(), std::memory_order_relaxed);
+
+    // clients reject the segment until the magic is set
+    std::atomic_thread_fence(std::memory_order_release);
+    shared_list->magic = SHM_MAGIC;
+
+    try
+    {
+        monitor = std::make_unique<tis::InterfaceMonitor>();
+    }
+    catch (const std::runtime_error&)
+    {
+        // without change notifications every poll is a scan
+        monitor = nullptr;
+    }
 
     work_thread = std::thread(&CameraListHolder::index_loop, this);
 }
@@ -79,13 +103,25 @@ tcam::tools::gige_daemon::CameraListHolder::CameraListHolder() : continue_loop(t
 
 tcam::tools::gige_daemon::CameraListHolder::~CameraListHolder()
 {
-    continue_loop = false;
+    stop();
     if (work_thread.joinable())
     {
         work_thread.join();
     }
 
-    shmctl(shmid, IPC_RMID, NULL);
+    if (shared_list)
+    {
+        // clients that keep the mapping see that the daemon is gone
+        shared_list->last_update_ns.store(0, std::memory_order_release);
+        munmap(shared_list, sizeof(tcam_gige_device_list));
+        shm_unlink(SHM_NAME);
+    }
+
+    if (session_cache)
+    {
+        munmap(session_cache, sizeof(tcam_gige_session_cache));
+        shm_unlink(SESSION_SHM_NAME);
+    }
 }
 
 
@@ -99,19 +135,14 @@ tcam::tools::gige_daemon::CameraListHolder& tcam::tools::gige_daemon::CameraList
 
 std::vector<DeviceInfo> tcam::tools::gige_daemon::CameraListHolder::get_camera_list()
 {
-    std::lock_guard<semaphore> lck(semaphore_id);
-
-    struct tcam_gige_device_list* d = (struct tcam_gige_device_list*)shmat(shmid, NULL, 0);
+    std::vector<DeviceInfo> ret;
 
-    if (d == nullptr)
+    // the daemon is the only writer, the sequence is never odd here
+    if (auto list = read_device_list(*shared_list))
     {
-        return std::vector<DeviceInfo>();
+        for (const auto& dev : *list) { ret.push_back(DeviceInfo(dev)); }
     }
 
-    std::vector<DeviceInfo> ret;
-
-    for (unsigned int i = 0; i < d->device_count; ++i) { ret.push_back(DeviceInfo(d->devices[i])); }
-
     return ret;
 }
 
@@ -129,15 +160,79 @@ void tcam::tools::gige_daemon::CameraListHolder::set_interface_list(std::vector<
 }
 
 
+void tcam::tools::gige_daemon::CameraListHolder::set_poll_interval(std::chrono::seconds interval)
+{
+    std::lock_guard<std::mutex> mutex_lock(mtx);
+    poll_interval = std::max(interval, fast_scan_interval);
+}
+
+
+void tcam::tools::gige_daemon::CameraListHolder::enable_session_cache()
+{
+    std::lock_guard<std::mutex> mutex_lock(mtx);
+    if (session_cache)
+    {
+        return;
+    }
+
+    // entries of a previous daemon may belong to cameras that changed in between
+    shm_unlink(SESSION_SHM_NAME);
+
+    int fd = shm_open(SESSION_SHM_NAME, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0666);
+
+    if (fd == -1)
+    {
+        throw std::runtime_error("Unable to create session cache");
+    }
+
+    // clients of all users store the settings they negotiated
+    fchmod(fd, 0666);
+
+    if (ftruncate(fd, sizeof(tcam_gige_session_cache)) != 0)
+    {
+        close(fd);
+        shm_unlink(SESSION_SHM_NAME);
+        throw std::runtime_error("Unable to allocate session cache");
+    }
+
+    void* ptr =
+        mmap(nullptr, sizeof(tcam_gige_session_cache), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        shm_unlink(SESSION_SHM_NAME);
+        throw std::runtime_error("Unable to map session cache");
+    }
+
+    session_cache = static_cast<tcam_gige_session_cache*>(ptr);
+    session_cache->version = SESSION_SHM_VERSION;
+
+    std::atomic_thread_fence(std::memory_order_release);
+    session_cache->magic = SESSION_SHM_MAGIC;
+}
+
+
 void tcam::tools::gige_daemon::CameraListHolder::stop()
 {
-    this->continue_loop = false;
+    {
+        std::lock_guard<std::mutex> mutex_lock(mtx);
+        this->continue_loop = false;
+    }
     cv.notify_all();
+    if (monitor)
+    {
+        monitor->interrupt();
+    }
 }
 
 
 void tcam::tools::gige_daemon::CameraListHolder::index_loop()
 {
+    // the first scan waits like before, so that set_interface_list can be called
+    fast_scan_until = std::chrono::steady_clock::now() + fast_scan_duration;
+    last_scan = std::chrono::steady_clock::now();
+
     while (continue_loop) { loop_function(); }
 }
 
@@ -148,18 +243,28 @@ static std::vector<tcam::DeviceInfo> get_aravis_list()
 }
 
 
-void tcam::tools::gige_daemon::CameraListHolder::loop_function()
+bool tcam::tools::gige_daemon::CameraListHolder::is_relevant_change(
+    const std::set<std::string>& changed_interfaces)
 {
-    std::unique_lock<std::mutex> lck(mtx);
-
-    auto res = cv.wait_for(lck, std::chrono::seconds(2));
+    std::lock_guard<std::mutex> mutex_lock(mtx);
 
-    // preemptiv stop
-    if (res == std::cv_status::no_timeout)
+    // an empty name means that events were lost
+    if (interface_list.empty() || changed_interfaces.count(std::string()))
     {
-        return;
+        return true;
     }
 
+    return std::any_of(interface_list.begin(),
+                       interface_list.end(),
+                       [&changed_interfaces](const std::string& name)
+                       { return changed_interfaces.count(name) != 0; });
+}
+
+
+void tcam::tools::gige_daemon::CameraListHolder::scan()
+{
+    last_scan = std::chrono::steady_clock::now();
+
     std::vector<tcam::DeviceInfo> aravis_list = get_aravis_list();
     std::vector<struct tcam_device_info> arv_list;
     arv_list.reserve(aravis_list.size());
@@ -170,24 +275,72 @@ void tcam::tools::gige_daemon::CameraListHolder::loop_function()
         return;
     }
 
-    std::lock_guard<semaphore> lck2(semaphore_id);
+    // clients are only woken when the list actually differs
+    write_device_list(*shared_list, arv_list);
+
+    std::lock_guard<std::mutex> mutex_lock(mtx);
+    if (session_cache)
+    {
+        prune_session_cache(*session_cache, arv_list);
+    }
+}
 
-    struct tcam_gige_device_list* tmp_ptr = (struct tcam_gige_device_list*)shmat(shmid, NULL, 0);
 
-    tmp_ptr->device_count = arv_list.size();
+void tcam::tools::gige_daemon::CameraListHolder::loop_function()
+{
+    auto now = std::chrono::steady_clock::now();
 
-    struct tcam_device_info* ptr = tmp_ptr->devices;
-    for (const auto& dev : arv_list)
+    std::chrono::steady_clock::duration interval;
     {
-        memcpy(ptr, &dev, sizeof(struct tcam_device_info));
-        ++ptr;
+        std::lock_guard<std::mutex> mutex_lock(mtx);
+        interval = (monitor && now >= fast_scan_until) ? poll_interval : fast_scan_interval;
     }
+    const auto next_scan = last_scan + interval;
 
-    // force update to change time
-    struct shmid_ds ds = {};
-    shmctl(shmid, IPC_STAT, &ds);
-    shmctl(shmid, IPC_SET, &ds);
+    // the list is refreshed at least every fast_scan_interval, even without scanning
+    auto wait_time = std::chrono::duration_cast<std::chrono::milliseconds>(next_scan - now);
+    wait_time = std::clamp(wait_time,
+                           std::chrono::milliseconds(0),
+                           std::chrono::milliseconds(fast_scan_interval));
 
-    // release data ptr
-    shmdt(tmp_ptr);
+    std::set<std::string> changed_interfaces;
+    bool changed = false;
+    if (monitor)
+    {
+        changed = monitor->wait_for_changes((int)wait_time.count(), changed_interfaces);
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        cv.wait_for(lck, wait_time, [this] { return !continue_loop; });
+    }
+
+    // preemptiv stop
+    if (!continue_loop)
+    {
+        return;
+    }
+
+    now = std::chrono::steady_clock::now();
+    if (changed && is_relevant_change(changed_interfaces))
+    {
+        fast_scan_until = now + fast_scan_duration;
+        {
+            // the packet size that passed on the old link may not pass anymore
+            std::lock_guard<std::mutex> mutex_lock(mtx);
+            if (session_cache)
+            {
+                prune_session_cache(*session_cache, {});
+            }
+        }
+        scan();
+    }
+    else if (now >= next_scan)
+    {
+        scan();
+    }
+    else
+    {
+        touch_device_list(*shared_list);
+    }
 }
@@ -15,11 +15,16 @@
  */
 
 
-#include "../../src/tcam-semaphores.h"
+#include "../../src/tcam-network/InterfaceMonitor.h"
 #include "../../src/tcam.h"
+#include "gige-daemon.h"
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -42,6 +47,12 @@ public:
 
     void set_interface_list(std::vector<std::string>&);
 
+    // interval of the scans while no interface changed
+    void set_poll_interval(std::chrono::seconds interval);
+
+    // create the segment in which clients share negotiated connection settings
+    void enable_session_cache();
+
     void stop();
 
 private:
@@ -51,23 +62,32 @@ private:
 
     void loop_function();
 
+    // true when a change on one of the interfaces requires a scan
+    bool is_relevant_change(const std::set<std::string>& changed_interfaces);
+
+    void scan();
+
     std::vector<DeviceInfo> camera_list;
 
     std::vector<std::string> interface_list;
 
-    bool continue_loop = true;
+    // nullptr when netlink is not available, the daemon then scans every 2 seconds
+    std::unique_ptr<tis::InterfaceMonitor> monitor;
+    std::chrono::seconds poll_interval;
+    std::chrono::steady_clock::time_point last_scan;
+    // cameras need a while after a link change until they answer, scan often until then
+    std::chrono::steady_clock::time_point fast_scan_until;
+
+    std::atomic<bool> continue_loop = true;
     std::thread work_thread;
     std::mutex mtx;
     std::mutex real_mutex;
     std::condition_variable cv;
 
-    // memory sharing keys
-    int shmid = 0;
-    key_t shmkey;
-
-    key_t semaphore_key;
-
-    tcam::semaphore semaphore_id;
+    // POSIX shm segment, see gige-daemon.h
+    tcam_gige_device_list* shared_list = nullptr;
+    // only exists after enable_session_cache, guarded by mtx
+    tcam_gige_session_cache* session_cache = nullptr;
 };
 
 } // namespace tcam::tools::gige_daemon
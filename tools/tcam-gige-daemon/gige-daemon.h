@@ -19,20 +19,461 @@
 
 #include "../../src/base_types.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <optional>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
 namespace tcam::tools::gige_daemon
 {
 
 static const size_t TCAM_DEVICE_LIST_MAX = 50;
 
+// POSIX shared memory segment containing a tcam_gige_device_list
+constexpr const char* SHM_NAME = "/tcam-gige-device-list";
+
+constexpr uint32_t SHM_MAGIC = 0x54474456; // "TGDV"
+constexpr uint32_t SHM_VERSION = 2;
+
+// clients ignore a list that has not been refreshed for this long,
+// the daemon refreshes every 2 seconds, also when it did not scan
+constexpr uint64_t SHM_MAX_AGE_NS = 10ull * 1000 * 1000 * 1000;
+
+// an update takes a few microseconds, a sequence that stays odd longer
+// belongs to a daemon that died while writing
+constexpr uint64_t SHM_READ_TIMEOUT_NS = 100ull * 1000 * 1000;
+
+/*
+ * Only the daemon writes, clients never lock.
+ *
+ * sequence is a seqlock: it is odd while the daemon updates the devices
+ * and changes with every update. A reader retries when it differs before
+ * and after copying.
+ * change_counter is incremented when the device list changed
+ * and is the futex word clients block on.
+ */
 struct tcam_gige_device_list
 {
-    unsigned int device_count;
+    uint32_t magic;
+    uint32_t version;
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> change_counter;
+
+    // CLOCK_MONOTONIC of the last sweep, 0 once the daemon stopped
+    std::atomic<uint64_t> last_update_ns;
+
+    uint32_t device_count;
 
     tcam::tcam_device_info devices[TCAM_DEVICE_LIST_MAX];
 };
 
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
 constexpr const char* LOCK_FILE = "/var/lock/tcam-gige-daemon.lock";
 
+
+// optional segment containing a tcam_gige_session_cache, see 'start --session-cache'
+constexpr const char* SESSION_SHM_NAME = "/tcam-gige-session-cache";
+
+constexpr uint32_t SESSION_SHM_MAGIC = 0x54475343; // "TGSC"
+constexpr uint32_t SESSION_SHM_VERSION = 1;
+
+/*
+ * Connection settings a client resolved while opening a camera.
+ * The next client that opens the camera at the same address applies them
+ * instead of negotiating again.
+ *
+ * Unlike the device list, clients write entries.
+ * sequence is a seqlock per entry, writers make it odd with a compare exchange.
+ * A writer that loses the race does not store its settings.
+ * An empty serial_number marks an unused entry.
+ */
+struct tcam_gige_session_entry
+{
+    std::atomic<uint32_t> sequence;
+
+    char serial_number[64];
+    char device_address[128]; // additional_identifier of the tcam_device_info
+
+    uint32_t packet_size; // GevSCPSPacketSize that passed the auto negotiation
+};
+
+/*
+ * The daemon removes entries of cameras that disappeared or changed their address
+ * and clears all entries when one of the queried interfaces changed,
+ * as the usable packet size depends on the link.
+ */
+struct tcam_gige_session_cache
+{
+    uint32_t magic;
+    uint32_t version;
+
+    tcam_gige_session_entry entries[TCAM_DEVICE_LIST_MAX];
+};
+
+
+inline uint64_t monotonic_ns()
+{
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+
+inline bool is_daemon_alive(const tcam_gige_device_list& list)
+{
+    uint64_t last = list.last_update_ns.load(std::memory_order_acquire);
+    return last != 0 && monotonic_ns() - last < SHM_MAX_AGE_NS;
+}
+
+
+/*
+ * Map the device list of a running daemon read only.
+ * Returns nullptr when no daemon created the segment.
+ */
+inline const tcam_gige_device_list* map_device_list()
+{
+    int fd = shm_open(SHM_NAME, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(tcam_gige_device_list))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* ptr = mmap(nullptr, sizeof(tcam_gige_device_list), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto list = static_cast<const tcam_gige_device_list*>(ptr);
+    if (list->magic != SHM_MAGIC || list->version != SHM_VERSION)
+    {
+        munmap(ptr, sizeof(tcam_gige_device_list));
+        return nullptr;
+    }
+    return list;
+}
+
+
+inline void unmap_device_list(const tcam_gige_device_list* list)
+{
+    munmap((void*)list, sizeof(tcam_gige_device_list));
+}
+
+
+/*
+ * Copy the devices without taking a lock.
+ * change_counter receives the counter the copy belongs to,
+ * pass it to wait_for_change to block until the next change.
+ * Returns std::nullopt when the daemon stopped or did not finish
+ * an update within SHM_READ_TIMEOUT_NS.
+ */
+inline std::optional<std::vector<tcam::tcam_device_info>> read_device_list(
+    const tcam_gige_device_list& list,
+    uint32_t* change_counter = nullptr)
+{
+    std::vector<tcam::tcam_device_info> ret;
+
+    const uint64_t deadline = monotonic_ns() + SHM_READ_TIMEOUT_NS;
+
+    while (true)
+    {
+        uint32_t seq = list.sequence.load(std::memory_order_acquire);
+        if (seq & 1)
+        {
+            if (!is_daemon_alive(list) || monotonic_ns() > deadline)
+            {
+                return std::nullopt;
+            }
+            // the daemon is writing, this takes a few microseconds
+            sched_yield();
+            continue;
+        }
+
+        uint32_t counter = list.change_counter.load(std::memory_order_relaxed);
+        size_t count = std::min<size_t>(list.device_count, TCAM_DEVICE_LIST_MAX);
+
+        ret.resize(count);
+        memcpy(ret.data(), list.devices, count * sizeof(tcam::tcam_device_info));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (list.sequence.load(std::memory_order_relaxed) == seq)
+        {
+            if (change_counter)
+            {
+                *change_counter = counter;
+            }
+            return ret;
+        }
+
+        if (monotonic_ns() > deadline)
+        {
+            return std::nullopt;
+        }
+    }
+}
+
+
+/*
+ * Block until change_counter differs from last_counter or timeout_ms passed.
+ * A negative timeout waits forever.
+ */
+inline void wait_for_change(const tcam_gige_device_list& list, uint32_t last_counter, int timeout_ms)
+{
+    struct timespec ts = {};
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000 * 1000;
+
+    // shared futex, the word lives in memory of another process
+    syscall(SYS_futex,
+            (const uint32_t*)&list.change_counter,
+            FUTEX_WAIT,
+            last_counter,
+            timeout_ms < 0 ? nullptr : &ts,
+            nullptr,
+            0);
+}
+
+
+// daemon side
+inline void write_device_list(tcam_gige_device_list& list,
+                              const std::vector<tcam::tcam_device_info>& devices)
+{
+    const size_t count = std::min(devices.size(), TCAM_DEVICE_LIST_MAX);
+
+    bool changed = list.device_count != count
+                   || memcmp(list.devices, devices.data(), count * sizeof(tcam::tcam_device_info)) != 0;
+
+    if (changed)
+    {
+        uint32_t seq = list.sequence.load(std::memory_order_relaxed);
+        list.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        list.device_count = count;
+        memcpy(list.devices, devices.data(), count * sizeof(tcam::tcam_device_info));
+
+        list.sequence.store(seq + 2, std::memory_order_release);
+
+        list.change_counter.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, (uint32_t*)&list.change_counter, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    list.last_update_ns.store(monotonic_ns(), std::memory_order_release);
+}
+
+
+// tells clients that the list is still valid without scanning again
+inline void touch_device_list(tcam_gige_device_list& list)
+{
+    list.last_update_ns.store(monotonic_ns(), std::memory_order_release);
+}
+
+
+/*
+ * Map the session cache of a running daemon read write.
+ * Returns nullptr when the daemon was started without --session-cache.
+ */
+inline tcam_gige_session_cache* map_session_cache()
+{
+    int fd = shm_open(SESSION_SHM_NAME, O_RDWR | O_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return nullptr;
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(tcam_gige_session_cache))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* ptr = mmap(
+        nullptr, sizeof(tcam_gige_session_cache), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto cache = static_cast<tcam_gige_session_cache*>(ptr);
+    if (cache->magic != SESSION_SHM_MAGIC || cache->version != SESSION_SHM_VERSION)
+    {
+        munmap(ptr, sizeof(tcam_gige_session_cache));
+        return nullptr;
+    }
+    return cache;
+}
+
+
+inline void unmap_session_cache(tcam_gige_session_cache* cache)
+{
+    munmap(cache, sizeof(tcam_gige_session_cache));
+}
+
+
+// false when another process currently writes the entry
+inline bool try_lock_session_entry(tcam_gige_session_entry& entry, uint32_t& seq)
+{
+    seq = entry.sequence.load(std::memory_order_relaxed);
+    if ((seq & 1)
+        || !entry.sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed))
+    {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+}
+
+
+inline void unlock_session_entry(tcam_gige_session_entry& entry, uint32_t seq)
+{
+    entry.sequence.store(seq + 2, std::memory_order_release);
+}
+
+
+inline bool session_entry_matches(const tcam_gige_session_entry& entry,
+                                  const char* serial_number,
+                                  const char* device_address)
+{
+    return entry.serial_number[0] != '\0'
+           && strncmp(entry.serial_number, serial_number, sizeof(entry.serial_number)) == 0
+           && strncmp(entry.device_address, device_address, sizeof(entry.device_address)) == 0;
+}
+
+
+/*
+ * Packet size stored for the camera at device_address, without taking a lock.
+ * Returns 0 when no client stored one yet.
+ */
+inline uint32_t read_session_packet_size(const tcam_gige_session_cache& cache,
+                                         const char* serial_number,
+                                         const char* device_address)
+{
+    for (const auto& entry : cache.entries)
+    {
+        while (true)
+        {
+            uint32_t seq = entry.sequence.load(std::memory_order_acquire);
+            if (seq & 1)
+            {
+                sched_yield();
+                continue;
+            }
+
+            bool matches = session_entry_matches(entry, serial_number, device_address);
+            uint32_t packet_size = entry.packet_size;
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) != seq)
+            {
+                continue;
+            }
+            if (matches)
+            {
+                return packet_size;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+
+// client side, the settings are only a hint, so losing a race is not an error
+inline void write_session_packet_size(tcam_gige_session_cache& cache,
+                                      const char* serial_number,
+                                      const char* device_address,
+                                      uint32_t packet_size)
+{
+    // replace the entry of the serial, otherwise take an unused one
+    for (bool take_unused : { false, true })
+    {
+        for (auto& entry : cache.entries)
+        {
+            uint32_t seq = 0;
+            if (!try_lock_session_entry(entry, seq))
+            {
+                continue;
+            }
+
+            bool is_target = take_unused
+                                 ? entry.serial_number[0] == '\0'
+                                 : strncmp(entry.serial_number,
+                                           serial_number,
+                                           sizeof(entry.serial_number)) == 0;
+            if (is_target)
+            {
+                strncpy(entry.serial_number, serial_number, sizeof(entry.serial_number) - 1);
+                strncpy(entry.device_address, device_address, sizeof(entry.device_address) - 1);
+                entry.packet_size = packet_size;
+            }
+
+            unlock_session_entry(entry, seq);
+
+            if (is_target)
+            {
+                return;
+            }
+        }
+    }
+}
+
+
+/*
+ * Daemon side, removes the entries of cameras that are not in devices at the same address.
+ * Passing an empty list removes all entries.
+ */
+inline void prune_session_cache(tcam_gige_session_cache& cache,
+                                const std::vector<tcam::tcam_device_info>& devices)
+{
+    for (auto& entry : cache.entries)
+    {
+        uint32_t seq = 0;
+        // writers hold an entry for a few instructions
+        while (!try_lock_session_entry(entry, seq)) { sched_yield(); }
+
+        bool keep = std::any_of(devices.begin(),
+                                devices.end(),
+                                [&entry](const tcam::tcam_device_info& dev) {
+                                    return session_entry_matches(
+                                        entry, dev.serial_number, dev.additional_identifier);
+                                });
+        if (!keep)
+        {
+            memset(entry.serial_number, 0, sizeof(entry.serial_number));
+            memset(entry.device_address, 0, sizeof(entry.device_address));
+            entry.packet_size = 0;
+        }
+
+        unlock_session_entry(entry, seq);
+    }
+}
+
 } // namespace tcam::tools::gige_daemon
 
 #endif /* TCAM_GIGE_DAEMON_H */
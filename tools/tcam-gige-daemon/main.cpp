@@ -19,13 +19,12 @@
 #include "DaemonClass.h"
 #include "gige-daemon.h"
 
+#include <chrono>
 #include <csignal>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <stdio.h>
-#include <sys/ipc.h>
-#include <sys/msg.h>
-#include <sys/shm.h>
 #include <unistd.h>
 
 using namespace tcam::tools;
@@ -38,53 +37,24 @@ DaemonClass daemon_instance(gige_daemon::LOCK_FILE);
 
 std::vector<struct tcam_device_info> get_camera_list()
 {
+    auto list = gige_daemon::map_device_list();
 
-    key_t shmkey = ftok(gige_daemon::LOCK_FILE, 'G');
-    key_t sem_key = ftok(gige_daemon::LOCK_FILE, 'S');
-
-    if (sem_key < 0)
-    {
-        perror("Unable to get semaphore key.");
-        return {};
-    }
-
-    int sem_id = tcam::semaphore_create(sem_key);
-
-    if (sem_id < 0)
+    if (!list)
     {
-        perror("Cannot create semaphore");
+        std::cerr << "Daemon is not running." << std::endl;
         return {};
     }
 
-    int shmid;
-    if ((shmid = shmget(shmkey, sizeof(gige_daemon::tcam_gige_device_list), 0644 | IPC_CREAT))
-        == -1)
-    {
-        perror("shmget");
-        exit(1);
-    }
-
-    tcam::semaphore_lock(sem_id);
+    auto ret = gige_daemon::read_device_list(*list);
 
-    gige_daemon::tcam_gige_device_list* d = (gige_daemon::tcam_gige_device_list*)shmat(shmid, NULL, 0);
+    gige_daemon::unmap_device_list(list);
 
-    if (d == nullptr)
+    if (!ret)
     {
-        shmdt(d);
-        return std::vector<struct tcam_device_info>();
+        std::cerr << "Daemon is not responding." << std::endl;
+        return {};
     }
-
-    std::vector<struct tcam_device_info> ret;
-
-    ret.reserve(d->device_count);
-
-    for (unsigned int i = 0; i < d->device_count; ++i) { ret.push_back(d->devices[i]); }
-
-    shmdt(d);
-
-    tcam::semaphore_unlock(sem_id);
-
-    return ret;
+    return *ret;
 }
 
 
@@ -107,6 +77,42 @@ void print_camera_list_long()
 }
 
 
+int watch_camera_list()
+{
+    auto list = gige_daemon::map_device_list();
+
+    if (!list)
+    {
+        std::cerr << "Daemon is not running." << std::endl;
+        return 1;
+    }
+
+    while (gige_daemon::is_daemon_alive(*list))
+    {
+        uint32_t counter = 0;
+        auto cam_list = gige_daemon::read_device_list(*list, &counter);
+        if (!cam_list)
+        {
+            break;
+        }
+
+        for (const auto& c : *cam_list) { std::cout << c.identifier << std::endl; }
+        std::cout << std::endl;
+
+        // wake up regularly to notice a stopped daemon
+        while (list->change_counter.load() == counter && gige_daemon::is_daemon_alive(*list))
+        {
+            gige_daemon::wait_for_change(*list, counter, 5000);
+        }
+    }
+
+    gige_daemon::unmap_device_list(list);
+
+    std::cerr << "Daemon stopped." << std::endl;
+    return 1;
+}
+
+
 void print_help(const char* prog_name)
 {
     std::cout << prog_name << " - GigE Indexing daemon\n"
@@ -114,8 +120,11 @@ void print_help(const char* prog_name)
               << "Usage:\n"
               << "\t" << prog_name << " list \t - list camera names\n"
               << "\t" << prog_name << " list-long \t - list camera names, ip, mac\n"
+              << "\t" << prog_name << " watch \t - print camera names whenever the list changes\n"
               << "\t" << prog_name << " start \t - start daemon and fork\n"
               << "\t\t --no-fork \t - run daemon without forking\n"
+              << "\t\t --poll-interval SECONDS \t - scan interval while no interface changed\n"
+              << "\t\t --session-cache \t - let clients share negotiated packet sizes\n"
               << "\t" << prog_name << " stop \t - stop daemon\n"
               << std::endl;
 }
@@ -158,6 +167,10 @@ int main(int argc, char* argv[])
             print_camera_list_long();
             return 0;
         }
+        else if (strcmp("watch", argv[i]) == 0)
+        {
+            return watch_camera_list();
+        }
         else if (strcmp("start", argv[i]) == 0)
         {
             bool daemonize = true;
@@ -186,12 +199,24 @@ int main(int argc, char* argv[])
             }
 
             std::vector<std::string> interfaces;
+            int poll_interval = 0;
+            bool session_cache = false;
             for (int x = (i + 1); x < argc; ++x)
             {
                 if (strcmp("--no-fork", argv[x]) == 0)
                 {
                     continue;
                 }
+                if (strcmp("--poll-interval", argv[x]) == 0 && x + 1 < argc)
+                {
+                    poll_interval = atoi(argv[++x]);
+                    continue;
+                }
+                if (strcmp("--session-cache", argv[x]) == 0)
+                {
+                    session_cache = true;
+                    continue;
+                }
 
                 interfaces.push_back(argv[x]);
             }
@@ -207,6 +232,15 @@ int main(int argc, char* argv[])
             try
             {
                 gige_daemon::CameraListHolder::get_instance().set_interface_list(interfaces);
+                if (poll_interval > 0)
+                {
+                    gige_daemon::CameraListHolder::get_instance().set_poll_interval(
+                        std::chrono::seconds(poll_interval));
+                }
+                if (session_cache)
+                {
+                    gige_daemon::CameraListHolder::get_instance().enable_session_cache();
+                }
             }
             catch (std::runtime_error& e)
             {
@@ -15,15 +15,23 @@
  */
 
 #include <CLI11.hpp>
+#include <json.hpp>
 
 #include "../../src/tcam-network/Camera.h"
 #include "../../src/tcam-network/CameraDiscovery.h"
+#include "../../src/tcam-network/GigE3Progress.h"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>
 #include <iostream>
 #include <mutex>
 #include <memory>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <thread>
 
 namespace
 {
@@ -88,6 +96,119 @@ tis::camera_list get_camera_list()
 
 
 
+std::string format_camera_row(const std::string& format, std::shared_ptr<tis::Camera> cam)
+{
+    std::ostringstream row;
+    row << std::left;
+
+    for (unsigned int i = 0; i < format.size(); ++i)
+    {
+        // width is header number +3 to accomodate ` | `
+        switch (format.at(i))
+        {
+            case 'm':
+            {
+                row << std::setw(23) << cam->getModelName();
+                break;
+            }
+            case 's':
+            {
+                row << std::setw(19) << cam->getSerialNumber();
+                break;
+            }
+            case 'u':
+            {
+                row << std::setw(23) << cam->getUserDefinedName();
+                break;
+            }
+            case 'i':
+            {
+                row << std::setw(20) << cam->getCurrentIP();
+                break;
+            }
+            case 'n':
+            {
+                row << std::setw(20) << cam->getCurrentSubnet();
+                break;
+            }
+            case 'g':
+            {
+                row << std::setw(20) << cam->getCurrentGateway();
+                break;
+            }
+            case 'I':
+            {
+                row << std::setw(20) << cam->getPersistentIP();
+                break;
+            }
+            case 'N':
+            {
+                row << std::setw(23) << cam->getPersistentSubnet();
+                break;
+            }
+            case 'G':
+            {
+                row << std::setw(23) << cam->getPersistentGateway();
+                break;
+            }
+            case 'f':
+            {
+                row << std::setw(15) << cam->getInterfaceName();
+                break;
+            }
+            case 'd':
+            {
+                if (cam->isDHCPactive())
+                {
+                    row << std::setw(13) << "Yes";
+                }
+                else
+                {
+                    row << std::setw(13) << "No";
+                }
+                break;
+            }
+            case 'S':
+            {
+                if (cam->isStaticIPactive())
+                {
+                    row << std::setw(13) << "Yes";
+                }
+                else
+                {
+                    row << std::setw(13) << "No";
+                }
+
+                break;
+            }
+            case 'M':
+            {
+                row << std::setw(21) << cam->getMAC();
+                break;
+            }
+            case 'r':
+            {
+                if (cam->isReachable())
+                {
+                    row << std::setw(13) << "Yes";
+                }
+                else
+                {
+                    row << std::setw(13) << "No";
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    return row.str();
+}
+
+
 void list_cameras(const std::string& format)
 {
     tis::camera_list cameras = get_camera_list();
@@ -195,125 +316,25 @@ void list_cameras(const std::string& format)
     }
     std::cout << std::endl;
 
+    // every camera has its own socket, query them concurrently
+    // so that the request round trips overlap
+    std::vector<std::future<std::string>> rows;
     for (const auto& cam : cameras)
     {
-        for (unsigned int i = 0; i < format.size(); ++i)
-        {
-            // width is header number +3 to accomodate ` | `
-            switch (format.at(i))
-            {
-                case 'm':
-                {
-                    std::cout << std::setw(23) << cam->getModelName();
-                    break;
-                }
-                case 's':
-                {
-                    std::cout << std::setw(19) << cam->getSerialNumber();
-                    break;
-                }
-                case 'u':
-                {
-                    std::cout << std::setw(23) << cam->getUserDefinedName();
-                    break;
-                }
-                case 'i':
-                {
-                    std::cout << std::setw(20) << cam->getCurrentIP();
-                    break;
-                }
-                case 'n':
-                {
-                    std::cout << std::setw(20) << cam->getCurrentSubnet();
-                    break;
-                }
-                case 'g':
-                {
-                    std::cout << std::setw(20) << cam->getCurrentGateway();
-                    break;
-                }
-                case 'I':
-                {
-                    std::cout << std::setw(20) << cam->getPersistentIP();
-                    break;
-                }
-                case 'N':
-                {
-                    std::cout << std::setw(23) << cam->getPersistentSubnet();
-                    break;
-                }
-                case 'G':
-                {
-                    std::cout << std::setw(23) << cam->getPersistentGateway();
-                    break;
-                }
-                case 'f':
-                {
-                    std::cout << std::setw(15) << cam->getInterfaceName();
-                    break;
-                }
-                case 'd':
-                {
-                    if (cam->isDHCPactive())
-                    {
-                        std::cout << std::setw(13) << "Yes";
-                    }
-                    else
-                    {
-                        std::cout << std::setw(13) << "No";
-                    }
-                    break;
-                }
-                case 'S':
-                {
-                    if (cam->isStaticIPactive())
-                    {
-                        std::cout << std::setw(13) << "Yes";
-                    }
-                    else
-                    {
-                        std::cout << std::setw(13) << "No";
-                    }
+        rows.push_back(std::async(std::launch::async, format_camera_row, format, cam));
+    }
 
-                    break;
-                }
-                case 'M':
-                {
-                    std::cout << std::setw(21) << cam->getMAC();
-                    break;
-                }
-                case 'r':
-                {
-                    if (cam->isReachable())
-                    {
-                        std::cout << std::setw(13) << "Yes";
-                    }
-                    else
-                    {
-                        std::cout << std::setw(13) << "No";
-                    }
-                    break;
-                }
-                default:
-                {
-                    break;
-                }
-            }
-        }
-        std::cout << std::endl;
+    for (auto& row : rows)
+    {
+        std::cout << row.get() << std::endl;
     }
 }
 
 
-std::shared_ptr<tis::Camera> findCamera(const std::string& ident)
+// ident may be a serial number, user defined name, MAC or IP address
+std::shared_ptr<tis::Camera> find_camera_in_list(const tis::camera_list& cameras,
+                                                 const std::string& ident)
 {
-    tis::camera_list cameras = get_camera_list();
-
-    if (cameras.size() == 0)
-    {
-        throw std::runtime_error("\nNo cameras found.\n");
-    }
-
     std::shared_ptr<tis::Camera> retv = tis::getCameraFromList(cameras, ident, tis::CAMERA_SERIAL);
 
     if (!retv)
@@ -328,6 +349,20 @@ std::shared_ptr<tis::Camera> findCamera(const std::string& ident)
     {
         retv = tis::getCameraFromList(cameras, ident, tis::CAMERA_IP);
     }
+    return retv;
+}
+
+
+std::shared_ptr<tis::Camera> findCamera(const std::string& ident)
+{
+    tis::camera_list cameras = get_camera_list();
+
+    if (cameras.size() == 0)
+    {
+        throw std::runtime_error("\nNo cameras found.\n");
+    }
+
+    std::shared_ptr<tis::Camera> retv = find_camera_in_list(cameras, ident);
 
     if (!retv)
     {
@@ -410,11 +445,15 @@ int print_camera_information (const CLI::App& app)
               << "\nStatic is: " << (camera->isStaticIPactive() ? "enabled" : "disabled")
               << std::endl;
 
-    if (reachable)
+    std::string persistent_ip;
+    std::string persistent_subnet;
+    std::string persistent_gateway;
+    if (reachable
+        && camera->getPersistentIPConfig(persistent_ip, persistent_subnet, persistent_gateway))
     {
-        std::cout << "\n\nPersistent IP:      " << camera->getPersistentIP()
-                  << "\nPersistent Subnet:  " << camera->getPersistentSubnet()
-                  << "\nPersistent Gateway: " << camera->getPersistentGateway() << "\n"
+        std::cout << "\n\nPersistent IP:      " << persistent_ip
+                  << "\nPersistent Subnet:  " << persistent_subnet
+                  << "\nPersistent Gateway: " << persistent_gateway << "\n"
                   << std::endl;
     }
     return 0;
@@ -791,28 +830,59 @@ int execute_batch_upload (const CLI::App& app)
         cameras = get_interface_cameras(interface);
     }
 
+    int jobs = 8;
+    auto jobs_option = app.get_option("--jobs");
+    if (*jobs_option)
+    {
+        jobs_option->results(jobs);
+    }
+    jobs = std::max(1, std::min(jobs, (int)cameras.size()));
+
     std::cout << "Uploading to " << cameras.size() << " cameras..." << std::endl;
 
-    for (auto& camera : cameras)
+    FirmwareUpdate::GigE3::aggregateProgress progress(
+        [](int pct, const std::string& /* s */) {
+            std::cout << "\r" << std::setw(5) << pct << "%";
+            std::cout.flush();
+        },
+        (int)cameras.size());
+
+    std::mutex failed_lock;
+    std::vector<std::string> failed;
+    std::atomic<size_t> next_camera { 0 };
+
+    // every camera is updated by one thread
+    // the cameras only share the network, not the control channel
+    auto worker = [&]()
     {
-        std::string serial = camera->getSerialNumber();
-        auto func = [&serial] (int progress, const std::string& s) {
-            std::cout << "\r";
+        for (size_t i = next_camera++; i < cameras.size(); i = next_camera++)
+        {
+            auto device_progress = progress.device((int)i);
 
-            std::cout << std::setw(10) << serial << std::setw(5) << progress << "%";
-            if (s != "")
+            int ret = cameras.at(i)->uploadFirmware(firmware_file, "", device_progress);
+            if (ret < 0)
             {
-                std::cout << std::setw(40) << s;
+                std::lock_guard<std::mutex> lck(failed_lock);
+                failed.push_back(cameras.at(i)->getSerialNumber());
             }
-            std::cout.flush();
-        };
-
-        std::cout << std::endl;
-        int ret = camera->uploadFirmware(firmware_file, "", func);
-        if (ret < 0)
-        {
-            std::cerr << "Error while uploading firmware to " << serial << std::endl;
+            device_progress(100, "");
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < jobs; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    std::cout << std::endl;
+
+    for (const auto& serial : failed)
+    {
+        std::cerr << "Error while uploading firmware to " << serial << std::endl;
     }
 
     std::cout << "Done." << std::endl;
@@ -843,24 +913,19 @@ int execute_check_control(const CLI::App& app)
     static constexpr int GEV_PRIMARY_APPLICATION_PORT_REGISTER = 0x0A04;
     static constexpr int GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER = 0x0A14;
     static constexpr int GEV_HEARTBEAT_TIMEOUT_REGISTER = 0x0938;
-    uint32_t port;
-    uint32_t address;
-    uint32_t timeout;
-    if (!camera->sendReadRegister(GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER, &address))
-    {
-        std::cerr << "Unable to read address register from device." << std::endl;
-        return 2;
-    }
-    if (!camera->sendReadRegister(GEV_PRIMARY_APPLICATION_PORT_REGISTER, &port))
-    {
-        std::cerr << "Unable to read port register from device." << std::endl;
-        return 2;
-    }
-    if (!camera->sendReadRegister(GEV_HEARTBEAT_TIMEOUT_REGISTER, &timeout))
-    {
-        std::cerr << "Unable to read timeout register from device." << std::endl;
+    // one readRegisters call, the camera answers all of them in one round trip
+    std::vector<uint32_t> values;
+    if (!camera->readRegisters({ GEV_PRIMARY_APPLICATION_IP_ADDRESS_REGISTER,
+                                 GEV_PRIMARY_APPLICATION_PORT_REGISTER,
+                                 GEV_HEARTBEAT_TIMEOUT_REGISTER },
+                               values))
+    {
+        std::cerr << "Unable to read control registers from device." << std::endl;
         return 2;
     }
+    uint32_t address = values.at(0);
+    uint32_t port = values.at(1);
+    uint32_t timeout = values.at(2);
 
     // hacky fix
     // many firmware versions return a wrong value for the port information
@@ -877,6 +942,328 @@ int execute_check_control(const CLI::App& app)
 }
 
 
+// one camera of a batch
+// the list file has one camera per line: IDENTIFIER[,IP,NETMASK,GATEWAY[,NAME]]
+// empty values are taken from the command line options
+struct batch_entry
+{
+    std::string ident;
+    std::string ip;
+    std::string netmask;
+    std::string gateway;
+    std::string name;
+};
+
+
+std::string trim(const std::string& str)
+{
+    const auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+    {
+        return std::string();
+    }
+    const auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+
+bool read_batch_list(const std::string& filename, std::vector<batch_entry>& entries)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        std::cerr << "Unable to open " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = trim(line);
+        // comments and an optional header
+        if (line.empty() || line.front() == '#' || line.rfind("identifier", 0) == 0)
+        {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ','))
+        {
+            fields.push_back(trim(field));
+        }
+        fields.resize(5);
+
+        entries.push_back({ fields[0], fields[1], fields[2], fields[3], fields[4] });
+    }
+    return true;
+}
+
+
+nlohmann::json camera_info_to_json(tis::Camera& camera)
+{
+    nlohmann::json info;
+    info["model"] = camera.getModelName();
+    info["serial"] = camera.getSerialNumber();
+    info["mac"] = camera.getMAC();
+    info["interface"] = camera.getInterfaceName();
+    info["current_ip"] = camera.getCurrentIP();
+    info["current_netmask"] = camera.getCurrentSubnet();
+    info["current_gateway"] = camera.getCurrentGateway();
+    info["dhcp"] = camera.isDHCPactive();
+    info["static_ip"] = camera.isStaticIPactive();
+    info["reachable"] = camera.isReachable();
+
+    // these have to be read from the camera
+    if (camera.isReachable())
+    {
+        info["firmware"] = camera.getFirmwareVersion();
+        info["user_defined_name"] = camera.getUserDefinedName();
+        std::string ip;
+        std::string netmask;
+        std::string gateway;
+        if (camera.getPersistentIPConfig(ip, netmask, gateway))
+        {
+            info["persistent_ip"] = ip;
+            info["persistent_netmask"] = netmask;
+            info["persistent_gateway"] = gateway;
+        }
+    }
+    return info;
+}
+
+
+struct batch_options
+{
+    std::string action;
+    std::string netmask;
+    std::string gateway;
+    std::string firmware_file;
+    bool has_mode = false;
+    IP_Mode mode = IP_Mode::Static;
+    bool assume_yes = false;
+};
+
+
+// returns an empty string on success, the error otherwise
+std::string execute_batch_entry(const batch_options& options,
+                                const batch_entry& entry,
+                                const std::shared_ptr<tis::Camera>& camera,
+                                nlohmann::json& result)
+{
+    const std::string netmask = entry.netmask.empty() ? options.netmask : entry.netmask;
+    const std::string gateway = entry.gateway.empty() ? options.gateway : entry.gateway;
+
+    if (options.action == "rescue")
+    {
+        std::string mac;
+        if (camera)
+        {
+            mac = camera->getMAC();
+        }
+        else if (tis::isValidMAC(entry.ident))
+        {
+            // the camera did not answer the discovery, which is what rescue is for
+            mac = entry.ident;
+        }
+        else
+        {
+            return "Camera not found";
+        }
+
+        std::string err;
+        if (!tis::verifySettings(entry.ip, netmask, gateway, err) && !options.assume_yes)
+        {
+            return "Settings verification failed: " + err;
+        }
+        tis::sendIpRecovery(mac, tis::ip2int(entry.ip), tis::ip2int(netmask), tis::ip2int(gateway));
+        return std::string();
+    }
+
+    if (!camera)
+    {
+        return "Camera not found";
+    }
+
+    if (options.action == "info")
+    {
+        result["info"] = camera_info_to_json(*camera);
+        return std::string();
+    }
+
+    if (!camera->isReachable())
+    {
+        return "Camera is not reachable";
+    }
+
+    if (options.action == "upload")
+    {
+        if (camera->uploadFirmware(options.firmware_file, "", [](int, const std::string&) {}) < 0)
+        {
+            return "Firmware upload failed";
+        }
+        return std::string();
+    }
+
+    // set
+    if (!entry.name.empty() && !camera->setUserDefinedName(entry.name))
+    {
+        return "Unable to set the user defined name";
+    }
+
+    if (!entry.ip.empty())
+    {
+        std::string err;
+        if (!tis::verifySettings(entry.ip, netmask, gateway, err))
+        {
+            return "Settings verification failed: " + err;
+        }
+        if (!camera->setPersistentIP(entry.ip) || !camera->setPersistentSubnet(netmask)
+            || !camera->setPersistentGateway(gateway))
+        {
+            return "Unable to set the persistent IP configuration";
+        }
+    }
+
+    if (options.has_mode)
+    {
+        const bool dhcp = options.mode == IP_Mode::DHCP;
+        const bool static_ip = options.mode == IP_Mode::Static;
+        if (!camera->setIPconfigState(dhcp, static_ip))
+        {
+            return "Unable to set the IP configuration mode";
+        }
+    }
+    return std::string();
+}
+
+
+int execute_batch(const CLI::App& app)
+{
+    batch_options options;
+    app.get_option("action")->results(options.action);
+
+    std::vector<batch_entry> entries;
+
+    auto list = app.get_option("--list");
+    if (*list)
+    {
+        std::string list_file;
+        list->results(list_file);
+        if (!read_batch_list(list_file, entries))
+        {
+            return 1;
+        }
+    }
+    for (const auto& ident : app.remaining())
+    {
+        entries.push_back({ ident, "", "", "", "" });
+    }
+
+    if (entries.empty())
+    {
+        std::cerr << "No cameras given. Use --list or pass identifiers." << std::endl;
+        return 1;
+    }
+
+    auto netmask = app.get_option("--netmask");
+    if (*netmask)
+    {
+        netmask->results(options.netmask);
+    }
+    auto gateway = app.get_option("--gateway");
+    if (*gateway)
+    {
+        gateway->results(options.gateway);
+    }
+    auto mode = app.get_option("--mode");
+    if (*mode)
+    {
+        mode->results(options.mode);
+        options.has_mode = true;
+    }
+    auto firmware = app.get_option("--file");
+    if (*firmware)
+    {
+        firmware->results(options.firmware_file);
+    }
+    else if (options.action == "upload")
+    {
+        std::cerr << "upload requires --file" << std::endl;
+        return 1;
+    }
+    options.assume_yes = *app.get_option("--yes");
+
+    int jobs = 8;
+    auto jobs_option = app.get_option("--jobs");
+    if (*jobs_option)
+    {
+        jobs_option->results(jobs);
+    }
+    jobs = std::max(1, std::min(jobs, (int)entries.size()));
+
+    // one discovery for all cameras
+    const auto cameras = get_camera_list();
+
+    std::vector<nlohmann::json> results(entries.size());
+    std::atomic<size_t> next_entry { 0 };
+
+    // every camera has its own socket, so the control channels do not wait for each other
+    auto worker = [&]()
+    {
+        for (size_t i = next_entry++; i < entries.size(); i = next_entry++)
+        {
+            const auto& entry = entries.at(i);
+            auto camera = find_camera_in_list(cameras, entry.ident);
+
+            auto& result = results.at(i);
+            result["identifier"] = entry.ident;
+            result["action"] = options.action;
+            if (camera)
+            {
+                result["serial"] = camera->getSerialNumber();
+                result["mac"] = camera->getMAC();
+            }
+
+            std::string err;
+            try
+            {
+                err = execute_batch_entry(options, entry, camera, result);
+            }
+            catch (const std::exception& e)
+            {
+                err = e.what();
+            }
+
+            result["success"] = err.empty();
+            if (!err.empty())
+            {
+                result["error"] = err;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < jobs; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    std::cout << nlohmann::json(results).dump(4) << std::endl;
+
+    const bool all_succeeded =
+        std::all_of(results.begin(),
+                    results.end(),
+                    [](const nlohmann::json& r) { return r["success"] == true; });
+    return all_succeeded ? 0 : 1;
+}
+
+
 // all allowed characters
 static const std::string list_format_chars = "msuingINGfdSMr";
 
@@ -970,9 +1357,20 @@ int main(int argc, char* argv[])
     auto app_batch_fw = app.add_subcommand("batchupload", "upload firmware to camera");
     app_batch_fw->add_option("--file", "Firmware file to use")->check(CLI::ExistingFile)->required();
     app_batch_fw->add_option("-b,--baseaddress", "Firmware file to use")->check(CLI::ExistingFile)->required();
+    app_batch_fw->add_option("-j,--jobs", "Number of cameras that are updated at the same time, default 8");
 
     auto check_control = app.add_subcommand("check-control", "find IP of controlling PC");
 
+    auto app_batch = app.add_subcommand("batch", "run info, set, rescue or upload for several cameras at the same time");
+    app_batch->add_option("action", "info, set, rescue or upload")->check(CLI::IsMember({ "info", "set", "rescue", "upload" }))->required();
+    app_batch->add_option("-l,--list", "File with one camera per line: IDENTIFIER[,IP,NETMASK,GATEWAY[,NAME]]")->check(CLI::ExistingFile);
+    app_batch->add_option("-j,--jobs", "Number of cameras that are handled at the same time, default 8");
+    app_batch->add_option("--netmask", "IPv4 netmask for entries without one")->check(CLI::ValidIPV4);
+    app_batch->add_option("--gateway", "IPv4 gateway address for entries without one")->check(CLI::ValidIPV4);
+    app_batch->add_option("--mode", "IP configuration mode for set")->transform(CLI::CheckedTransformer(ip_mode_map, CLI::ignore_case));
+    app_batch->add_option("--file", "Firmware file for upload")->check(CLI::ExistingFile);
+    app_batch->add_flag("--yes", "Send rescue packets even when the settings verification fails");
+
     app.require_subcommand();
     // CLI11 uses "TEXT" as a filler for the option string arguments
     // replace it with "SERIAL" to make the help text more intuitive.
@@ -1014,6 +1412,10 @@ int main(int argc, char* argv[])
     {
         return execute_check_control(*check_control);
     }
+    else if (*app_batch)
+    {
+        return execute_batch(*app_batch);
+    }
 
     return 0;
 }